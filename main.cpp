@@ -18,22 +18,35 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <getopt.h>
 #include <memory>
 #include <unistd.h>
 
 #include <libsigrokcxx/libsigrokcxx.hpp>
 
-#include <QDateTime>
+#include <QCoreApplication>
 #include <QDebug>
 #include <QSettings>
+#include <QString>
+#include <QStringList>
 
 #include "config.h"
 #include "src/application.hpp"
 #include "src/devicemanager.hpp"
+#include "src/executor.hpp"
 #include "src/session.hpp"
 #include "src/settingsmanager.hpp"
+#include "src/soaktest.hpp"
+#include "src/tracer.hpp"
+#include "src/util.hpp"
+#include "src/watchdog.hpp"
+#include "src/data/remoteserver.hpp"
 #include "src/mainwindow.hpp"
+#include "src/plugins/pluginmanager.hpp"
+#include "src/python/smuscriptrunner.hpp"
 #include "src/ui/tabs/smuscripttab.hpp"
 
 #ifdef ENABLE_SIGNALS
@@ -68,6 +81,38 @@ void usage()
 		"  -D, --dont-scan            Don't auto-scan for devices, use -d spec only\n"
 		"  -s, --script               Specify the SmuScript to load and execute\n"
 		"  -c, --clean                Don't restore previous settings on startup\n"
+		"  -m, --memory-budget        Limit the memory of all signals (in MiB)\n"
+		"  -S, --spill-to-disk        Spill signals to disk, when the memory\n"
+		"                             budget is exceeded\n"
+		"  -P, --profile-plots        Show the frame statistics of the plots\n"
+		"  -t, --trace                Record trace events and save them to the\n"
+		"                             Chrome trace (JSON) file on exit\n"
+		"  -w, --watchdog             Log stalls of the GUI thread above this\n"
+		"                             time (in ms, default: 250, 0: disabled)\n"
+		"  -M, --metrics-port         Export the performance counters for\n"
+		"                             Prometheus on this [host:]port at\n"
+		"                             /metrics. Only local scrapers can\n"
+		"                             connect, unless a host (e.g. 0.0.0.0)\n"
+		"                             is given\n"
+		"      --headless             Run the SmuScript without the main window\n"
+		"                             and quit, when the script has finished\n"
+		"      --soak                 Run a soak test with synthetic load, e.g.\n"
+		"                             devices=8:samplerate=10000:duration=86400\n"
+		"      --serve                Serve the signals to remote SmuView clients\n"
+		"                             on this [host:]port. Only clients on this\n"
+		"                             machine can connect, unless a host (e.g.\n"
+		"                             0.0.0.0) is given to serve the network\n"
+		"      --serve-remote-writes  Accept the property writes of remote\n"
+		"                             clients on other machines (no\n"
+		"                             authentication!)\n"
+		"      --remote               Mirror the signals of a remote SmuView\n"
+		"                             server (host:port)\n"
+		"      --checkpoint           Checkpoint all signals to this file every\n"
+		"                             minute and resume them from it on start\n"
+		"      --auto-retention       Drop the samples, that no view, math\n"
+		"                             channel or recorder needs any more\n"
+		"      --plugin-dir           Load the native plugins in this directory\n"
+		"                             (in addition to the default directory)\n"
 		/* Disable cmd line options i and I
 		"  -i, --input-file           Load input from file\n"
 		"  -I, --input-format         Input format\n"
@@ -80,8 +125,137 @@ void usage()
 		"\n"
 		"  %s --driver voltcraft-k204:conn=/dev/ttyUSB0 \\\n"
 		"     --driver uni-t-ut61d:conn=1a86.e008 \\\n"
-		"     --driver uni-t-ut61e-ser:conn=/dev/ttyUSB1\n",
-		SV_BIN_NAME, SV_BIN_NAME, SV_BIN_NAME, SV_BIN_NAME);
+		"     --driver uni-t-ut61e-ser:conn=/dev/ttyUSB1\n"
+		"\n"
+		"  %s --headless --soak duration=604800:report=soak.csv\n"
+		"\n"
+		"  %s --headless --serve 0.0.0.0:5025 \\\n"
+		"     --driver uni-t-ut61e:conn=1a86.e008\n"
+		"  %s --remote bench-pc:5025\n",
+		SV_BIN_NAME, SV_BIN_NAME, SV_BIN_NAME, SV_BIN_NAME, SV_BIN_NAME,
+		SV_BIN_NAME, SV_BIN_NAME);
+}
+
+/**
+ * Run the script without a main window. The UiProxy calls of the script
+ * return empty ids and the dialogs are canceled, the plots and panels are
+ * not refreshed at all. The output of the script goes to stdout/stderr.
+ *
+ * @return 0 if the script has finished without an error.
+ */
+int run_headless(shared_ptr<sv::Session> session, const string &script_file)
+{
+	bool script_failed = false;
+	auto script_runner = session->smu_script_runner();
+
+	QObject::connect(script_runner.get(),
+		&sv::python::SmuScriptRunner::send_py_stdout,
+		[](const std::string &, const std::string &text) {
+			// The text are complete lines, without the trailing '\n'
+			fputs(text.c_str(), stdout);
+			fputc('\n', stdout);
+			fflush(stdout);
+		});
+	QObject::connect(script_runner.get(),
+		&sv::python::SmuScriptRunner::send_py_stderr,
+		[](const std::string &, const std::string &text) {
+			fputs(text.c_str(), stderr);
+			fputc('\n', stderr);
+			fflush(stderr);
+		});
+	// Both signals are queued, so the error is handled before the quit
+	QObject::connect(script_runner.get(),
+		&sv::python::SmuScriptRunner::script_error, qApp,
+		[&script_failed](const std::string &, const std::string &) {
+			script_failed = true;
+		}, Qt::QueuedConnection);
+	QObject::connect(script_runner.get(),
+		&sv::python::SmuScriptRunner::script_finished,
+		qApp, &QCoreApplication::quit, Qt::QueuedConnection);
+
+#ifdef ENABLE_SIGNALS
+	if (SignalHandler::prepare_signals()) {
+		SignalHandler *const handler = new SignalHandler(qApp);
+		QObject::connect(handler, SIGNAL(int_received()),
+			qApp, SLOT(quit()));
+		QObject::connect(handler, SIGNAL(term_received()),
+			qApp, SLOT(quit()));
+	}
+	else {
+		qWarning() << "Could not prepare signal handler.";
+	}
+#endif
+
+	if (!script_runner->run(script_file))
+		return 1;
+
+	const int ret = Application::exec();
+	return script_failed ? 1 : ret;
+}
+
+/**
+ * Run the soak test without a main window, so without plots, until its
+ * duration has passed or SmuView is interrupted.
+ *
+ * @return 0 if the test found no leak and no performance decay.
+ */
+int run_headless_soak_test(shared_ptr<sv::Session> session,
+	const sv::SoakConfig &soak_config)
+{
+	auto soak_test = session->start_soak_test(soak_config);
+	if (!soak_test)
+		return 1;
+	QObject::connect(soak_test.get(), &sv::SoakTest::finished,
+		qApp, &QCoreApplication::quit, Qt::QueuedConnection);
+
+#ifdef ENABLE_SIGNALS
+	if (SignalHandler::prepare_signals()) {
+		SignalHandler *const handler = new SignalHandler(qApp);
+		QObject::connect(handler, SIGNAL(int_received()),
+			qApp, SLOT(quit()));
+		QObject::connect(handler, SIGNAL(term_received()),
+			qApp, SLOT(quit()));
+	}
+	else {
+		qWarning() << "Could not prepare signal handler.";
+	}
+#endif
+
+	const int ret = Application::exec();
+	soak_test->stop();
+	return soak_test->passed() ? ret : 1;
+}
+
+/**
+ * Run the remote server without a main window, until SmuView is
+ * interrupted. The devices are acquired as usual, the clients get the
+ * samples over the network.
+ *
+ * @return 0 if the server was stopped by a signal.
+ */
+int run_headless_server(shared_ptr<sv::data::RemoteServer> remote_server)
+{
+	if (!remote_server)
+		return 1;
+	fprintf(stdout, "Serving on port %u.\n", (unsigned)remote_server->port());
+	fflush(stdout);
+
+#ifdef ENABLE_SIGNALS
+	if (SignalHandler::prepare_signals()) {
+		SignalHandler *const handler = new SignalHandler(qApp);
+		QObject::connect(handler, SIGNAL(int_received()),
+			qApp, SLOT(quit()));
+		QObject::connect(handler, SIGNAL(term_received()),
+			qApp, SLOT(quit()));
+	}
+	else {
+		qWarning() << "Could not prepare signal handler.";
+	}
+#endif
+
+	const int ret = Application::exec();
+	remote_server->stop();
+	return ret;
 }
 
 int main(int argc, char *argv[])
@@ -95,8 +269,38 @@ int main(int argc, char *argv[])
 	bool do_scan = true;
 	string script_file;
 	bool restore_settings = true;
+	size_t memory_budget = 0;
+	bool memory_budget_spill = false;
+	bool profile_plots = false;
+	bool headless = false;
+	string trace_file;
+	int watchdog_threshold = 250;
+	int metrics_port = 0;
+	string metrics_host = "127.0.0.1";
+	bool soak = false;
+	sv::SoakConfig soak_config;
+	int serve_port = -1;
+	string serve_host = "127.0.0.1";
+	bool serve_remote_writes = false;
+	string remote_host;
+	uint16_t remote_port = 0;
+	string checkpoint_file;
+	bool auto_retention = false;
+	QStringList plugin_dirs;
+
+	// The platform must be chosen before the application is created. In
+	// headless mode, no window is shown, so no display is needed.
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--headless") == 0) {
+			headless = true;
+			if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+				qputenv("QT_QPA_PLATFORM", "offscreen");
+			break;
+		}
+	}
 
 	Application app(argc, argv);
+	SV_TRACE_THREAD_NAME("GUI");
 
 	// Parse arguments
 	while (true) {
@@ -108,6 +312,20 @@ int main(int argc, char *argv[])
 			{ "dont-scan", no_argument, nullptr, 'D' },
 			{ "script", required_argument, nullptr, 's' },
 			{ "clean", no_argument, nullptr, 'c' },
+			{ "memory-budget", required_argument, nullptr, 'm' },
+			{ "spill-to-disk", no_argument, nullptr, 'S' },
+			{ "profile-plots", no_argument, nullptr, 'P' },
+			{ "headless", no_argument, nullptr, 'H' },
+			{ "trace", required_argument, nullptr, 't' },
+			{ "watchdog", required_argument, nullptr, 'w' },
+			{ "metrics-port", required_argument, nullptr, 'M' },
+			{ "soak", required_argument, nullptr, 'K' },
+			{ "serve", required_argument, nullptr, 'R' },
+			{ "serve-remote-writes", no_argument, nullptr, 'W' },
+			{ "remote", required_argument, nullptr, 'C' },
+			{ "checkpoint", required_argument, nullptr, 'k' },
+			{ "auto-retention", no_argument, nullptr, 'A' },
+			{ "plugin-dir", required_argument, nullptr, 'p' },
 			/* Disable cmd line options i and I
 			{ "input-file", required_argument, nullptr, 'i' },
 			{ "input-format", required_argument, nullptr, 'I' },
@@ -120,7 +338,7 @@ int main(int argc, char *argv[])
 			"l:Vhc?d:i:I:", long_options, nullptr);
 		*/
 		const int c = getopt_long(argc, argv,
-			"h?VDl:d:s:c", long_options, nullptr);
+			"h?VDl:d:s:cm:SPt:w:M:", long_options, nullptr);
 
 		if (c == -1)
 			break;
@@ -163,6 +381,85 @@ int main(int argc, char *argv[])
 			restore_settings = false;
 			break;
 
+		case 'm':
+			memory_budget = (size_t)strtoull(optarg, nullptr, 10) << 20;
+			break;
+
+		case 'S':
+			memory_budget_spill = true;
+			break;
+
+		case 'P':
+			profile_plots = true;
+			break;
+
+		case 'H':
+			// Already handled above
+			break;
+
+		case 't':
+			trace_file = optarg;
+			break;
+
+		case 'w':
+			watchdog_threshold = atoi(optarg);
+			break;
+
+		case 'M':
+			if (!sv::util::parse_host_port(optarg, metrics_host, metrics_port)) {
+				fprintf(stderr, "Invalid metrics port %s, use [host:]port.\n",
+					optarg);
+				return 1;
+			}
+			break;
+
+		case 'K':
+			soak = true;
+			if (!soak_config.parse(optarg)) {
+				fprintf(stderr, "Invalid soak test spec %s.\n", optarg);
+				return 1;
+			}
+			break;
+
+		case 'R':
+			if (!sv::util::parse_host_port(optarg, serve_host, serve_port)) {
+				fprintf(stderr, "Invalid port %s, use [host:]port.\n", optarg);
+				return 1;
+			}
+			break;
+
+		case 'W':
+			serve_remote_writes = true;
+			break;
+
+		case 'C':
+		{
+			const string remote = optarg;
+			const size_t colon = remote.rfind(':');
+			const int port = colon == string::npos ?
+				0 : atoi(remote.substr(colon + 1).c_str());
+			if (colon == 0 || port <= 0 || port > 65535) {
+				fprintf(stderr, "Invalid remote server %s, use host:port.\n",
+					optarg);
+				return 1;
+			}
+			remote_host = remote.substr(0, colon);
+			remote_port = (uint16_t)port;
+			break;
+		}
+
+		case 'k':
+			checkpoint_file = optarg;
+			break;
+
+		case 'A':
+			auto_retention = true;
+			break;
+
+		case 'p':
+			plugin_dirs << QString::fromLocal8Bit(optarg);
+			break;
+
 		/* Disable cmd line options i and I
 		case 'i':
 			open_file = optarg;
@@ -175,6 +472,12 @@ int main(int argc, char *argv[])
 		}
 	}
 
+	if (headless && script_file.empty() && !soak && serve_port < 0) {
+		fprintf(stderr, "--headless needs a script (-s), a soak test "
+			"(--soak) or a server (--serve).\n");
+		return 1;
+	}
+
 	/* Disable cmd line options i and I
 	if (argc - optind > 1) {
 		fprintf(stderr, "Only one file can be opened.\n");
@@ -185,10 +488,24 @@ int main(int argc, char *argv[])
 		open_file = argv[argc - 1];
 	*/
 
+	if (!trace_file.empty()) {
+#ifndef ENABLE_TRACING
+		fprintf(stderr, "Built without ENABLE_TRACING, the trace is empty.\n");
+#endif
+		sv::Tracer::start();
+	}
+
+	// The thread pools, that are shared by the whole application
+	sv::Executor::init();
+
 	// Initialise libsigrok
 	context = sigrok::Context::create();
 	sv::Session::sr_context = context;
 
+	// The plugins are loaded once, they stay loaded until the exit
+	plugin_dirs.prepend(sv::plugins::PluginManager::default_plugin_dir());
+	sv::plugins::PluginManager::load_plugins(plugin_dirs);
+
 	do {
 		try {
 			if (loglevel >= 0)
@@ -197,23 +514,90 @@ int main(int argc, char *argv[])
 			sv::SettingsManager::set_restore_settings(restore_settings);
 
 			// Initialize global start timestamp
-			// TODO: use std::chrono / std::time
-			sv::Session::session_start_timestamp =
-				(double)QDateTime::currentMSecsSinceEpoch() / (double)1000;
+			sv::Session::init_session_start_timestamp();
 
 			// Create the device manager, initialise the drivers
 			sv::DeviceManager device_manager(context, drivers, do_scan);
 
 			// Initialise the session.
-			auto session = make_shared<sv::Session>(device_manager);
+			auto session = make_shared<sv::Session>(
+				device_manager, checkpoint_file);
+			if (!checkpoint_file.empty() && !session->session_checkpoint()) {
+				fprintf(stderr, "Could not open the checkpoint file %s.\n",
+					checkpoint_file.c_str());
+			}
+			session->set_memory_budget(memory_budget);
+			session->set_memory_budget_spill(memory_budget_spill);
+			session->set_auto_retention(auto_retention);
+			if (watchdog_threshold > 0)
+				session->watchdog()->start(watchdog_threshold);
+			if (metrics_port > 0 && !session->export_metrics(
+					(uint16_t)metrics_port, {}, metrics_host)) {
+				fprintf(stderr, "Could not export the metrics on %s:%d.\n",
+					metrics_host.c_str(), metrics_port);
+			}
+			shared_ptr<sv::data::RemoteServer> remote_server;
+			if (serve_port >= 0) {
+				remote_server = session->serve_remote(
+					(uint16_t)serve_port, .1, serve_host);
+				if (!remote_server) {
+					fprintf(stderr, "Could not serve on %s:%d.\n",
+						serve_host.c_str(), serve_port);
+					ret = 1;
+					break;
+				}
+				remote_server->set_remote_writes_allowed(serve_remote_writes);
+			}
+			if (!remote_host.empty())
+				session->connect_remote(remote_host, remote_port);
+
+			if (headless && script_file.empty() && !soak) {
+				ret = run_headless_server(remote_server);
+				break;
+			}
+			if (headless && script_file.empty()) {
+				ret = run_headless_soak_test(session, soak_config);
+				break;
+			}
+			if (headless) {
+				// The soak test runs along the script
+				shared_ptr<sv::SoakTest> soak_test;
+				if (soak) {
+					soak_test = session->start_soak_test(soak_config);
+					if (!soak_test) {
+						ret = 1;
+						break;
+					}
+				}
+				ret = run_headless(session, script_file);
+				if (soak_test) {
+					soak_test->stop();
+					if (!soak_test->passed())
+						ret = 1;
+				}
+				break;
+			}
 
 			// Initialise the main window.
 			sv::MainWindow w(device_manager, session);
 			w.show();
+			if (profile_plots)
+				w.show_plot_profiler();
 
 			if (!script_file.empty())
 				w.add_smuscript_tab(script_file)->run_script();
 
+			shared_ptr<sv::SoakTest> soak_test;
+			if (soak) {
+				soak_test = session->start_soak_test(soak_config);
+				if (!soak_test) {
+					ret = 1;
+					break;
+				}
+				QObject::connect(soak_test.get(), &sv::SoakTest::finished,
+					&w, &QWidget::close, Qt::QueuedConnection);
+			}
+
 #ifdef ENABLE_SIGNALS
 			if (SignalHandler::prepare_signals()) {
 				SignalHandler *const handler =
@@ -232,6 +616,13 @@ int main(int argc, char *argv[])
 
 			// Run the application
 			ret = Application::exec();
+
+			// Stop the test, before the main window with its plots is gone
+			if (soak_test) {
+				soak_test->stop();
+				if (!soak_test->passed())
+					ret = 1;
+			}
 		}
 		catch (exception &e) {
 			 qCritical() << "main() failed: " << e.what();
@@ -240,5 +631,15 @@ int main(int argc, char *argv[])
 	}
 	while (false);
 
+	sv::Executor::shutdown();
+
+	if (!trace_file.empty()) {
+		sv::Tracer::stop();
+		if (!sv::Tracer::save_chrome_trace(trace_file)) {
+			fprintf(stderr, "Could not save the trace to %s.\n",
+				trace_file.c_str());
+		}
+	}
+
 	return ret;
 }
@@ -28,6 +28,7 @@
 #include <QSocketNotifier>
 
 #include "signalhandler.hpp"
+#include "src/watchdog.hpp"
 
 int SignalHandler::sockets_[2];
 
@@ -70,6 +71,7 @@ void SignalHandler::on_socket_notifier_activated()
 		qDebug() << "Failed to catch signal";
 		abort();
 	}
+	sv::Watchdog::signal_handled();
 
 	switch (sig_number) {
 	case SIGINT:
@@ -85,6 +87,8 @@ void SignalHandler::on_socket_notifier_activated()
 
 void SignalHandler::handle_signals(int sig_number)
 {
+	// Lets the watchdog report signals, that are stuck behind a stall
+	sv::Watchdog::signal_received();
 	if (write(sockets_[0], &sig_number, sizeof(int)) != sizeof(int)) {
 		// Failed to handle signal
 		abort();
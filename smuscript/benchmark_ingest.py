@@ -0,0 +1,119 @@
+# This file is part of the SmuView project.
+#
+# Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+
+#
+# End-to-end ingest benchmark with the sigrok demo driver: The demo device
+# generates N analog channels at a configurable samplerate, the packets go
+# through the complete datafeed (HardwareDevice::feed_in_analog(), the ingest
+# queue and HardwareChannel::push_interleaved_samples()) like from real
+# hardware. For every samplerate the sustained throughput, the latency
+# percentiles from receiving a packet until its samples are stored, the
+# dropped packets and the memory growth are printed.
+#
+# Start it without the main window:
+#   smuview --headless -s benchmark_ingest.py
+#
+
+import resource
+import time
+import smuview
+
+CHANNELS = 4
+SAMPLERATES = [1000, 10000, 100000, 1000000, 10000000]
+DURATION = 10
+PERCENTILES = [50, 90, 99, 99.9]
+BUCKET_COUNT = 24
+
+
+def bucket_limit(bucket):
+    """The upper limit of a latency bucket in seconds, see latency_histogram."""
+    if bucket >= BUCKET_COUNT - 1:
+        return float("inf")
+    return 1e-6 * (1 << bucket)
+
+
+def percentile(histogram, p):
+    total = sum(histogram)
+    if total == 0:
+        return float("nan")
+    limit = total * p / 100.
+    count = 0
+    for bucket, n in enumerate(histogram):
+        count += n
+        if count >= limit:
+            return bucket_limit(bucket)
+    return float("inf")
+
+
+def format_time(seconds):
+    if seconds == float("inf"):
+        return "  > {:7.1f} ms".format(bucket_limit(BUCKET_COUNT - 2) * 1000)
+    return "<= {:8.3f} ms".format(seconds * 1000)
+
+
+def rss_mib():
+    # ru_maxrss is in KiB on Linux
+    return resource.getrusage(resource.RUSAGE_SELF).ru_maxrss / 1024.
+
+
+device = Session.connect_device(
+    "demo:analog_channels={}:logic_channels=0".format(CHANNELS))[0]
+configurable = device.configurables()[""]
+
+print("{} analog channels, {} s per samplerate".format(CHANNELS, DURATION))
+for samplerate in SAMPLERATES:
+    configurable.set_config(smuview.ConfigKey.Samplerate, samplerate)
+    # Let the new samplerate settle
+    time.sleep(1)
+
+    start = device.acquisition_summary()
+    start_time = time.perf_counter()
+    start_memory = Session.memory_size()
+    start_rss = rss_mib()
+    time.sleep(DURATION)
+    end = device.acquisition_summary()
+    elapsed = time.perf_counter() - start_time
+
+    samples = end.sample_count - start.sample_count
+    packets = end.packet_count - start.packet_count
+    histogram = [e - s for e, s in
+        zip(end.latency_histogram, start.latency_histogram)]
+    print("Samplerate {} Hz:".format(samplerate))
+    print("  Throughput: {:12.0f} samples/s, {:8.0f} packets/s".format(
+        samples / elapsed, packets / elapsed))
+    print("  Dropped:    {} packets, {} samples, queue high water {}".format(
+        end.dropped_packet_count - start.dropped_packet_count,
+        end.dropped_sample_count - start.dropped_sample_count,
+        end.queue_high_water))
+    print("  Feed time:  {:8.3f} % of the time, max {:8.3f} ms".format(
+        (end.feed_time - start.feed_time) / elapsed * 100,
+        end.max_feed_time * 1000))
+    for p in PERCENTILES:
+        print("  Latency p{:<5} {}".format(p, format_time(percentile(histogram, p))))
+    memory = Session.memory_size() - start_memory
+    print("  Memory:     {:8.1f} MiB signals, {:8.1f} bytes/sample, max RSS +{:.1f} MiB".format(
+        memory / 1024. / 1024., memory / samples if samples else 0.,
+        rss_mib() - start_rss))
+
+Session.remove_device(device)
+print("Benchmark finished")
@@ -0,0 +1,108 @@
+# This file is part of the SmuView project.
+#
+# Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+
+#
+# Plot rendering benchmark: Time plots and XY plots with K curves of N points
+# each are updated with new samples, while the frame profiler of the plot
+# measures the frame times, the replots and the incremental paints. The time
+# plots are measured in every update mode.
+#
+# The main window is needed, but it can be rendered offscreen:
+#   QT_QPA_PLATFORM=offscreen smuview -s benchmark_plot.py
+#
+
+import time
+import numpy
+import smuview
+
+CURVES = [1, 4, 16]
+POINTS = [1000, 100000, 1000000]
+SAMPLERATE = 1000.
+# The samples per update, while the plots are measured
+UPDATE_SIZE = 100
+UPDATE_INTERVAL = 0.1
+DURATION = 10
+UPDATE_MODES = [smuview.PlotUpdateMode.Additive,
+    smuview.PlotUpdateMode.Rolling, smuview.PlotUpdateMode.Oscilloscope]
+
+
+def push(channel, pos, count, start_ts):
+    values = numpy.sin(numpy.arange(pos, pos + count) / 100.)
+    channel.push_samples(values, SAMPLERATE, start_ts + pos / SAMPLERATE,
+        smuview.Quantity.Voltage, set(), smuview.Unit.Volt, 7, 6)
+
+
+def measure(name, tab, view, channels, pos, start_ts):
+    """Update the channels for DURATION seconds and print the profile."""
+    UiProxy.get_plot_profile(tab, view, True)
+    end = time.perf_counter() + DURATION
+    while time.perf_counter() < end:
+        for channel in channels:
+            push(channel, pos, UPDATE_SIZE, start_ts)
+        pos += UPDATE_SIZE
+        time.sleep(UPDATE_INTERVAL)
+    profile = UiProxy.get_plot_profile(tab, view, False)
+    if profile is None:
+        print("{:<40} no profile".format(name))
+        return pos
+    print("{:<40} frame {:8.3f} ms (max {:8.3f}), replot {:8.3f} ms, "
+        "{:5} replots, {:5} incremental, {:10.0f} points, lateness {:8.3f} ms".format(
+        name, profile["mean_frame_time"], profile["max_frame_time"],
+        profile["mean_replot_time"], profile["total_replots"],
+        profile["total_incremental_paints"], profile["mean_points"],
+        profile["mean_lateness"]))
+    return pos
+
+
+for curve_count in CURVES:
+    for point_count in POINTS:
+        start_ts = time.time()
+        device = Session.add_user_device()
+        channels = []
+        for i in range(curve_count):
+            channel = device.add_user_channel("CH{}".format(i), "")
+            push(channel, 0, point_count, start_ts)
+            channels.append(channel)
+        tab = UiProxy.add_device_tab(device)
+
+        name = "{} x {}".format(curve_count, point_count)
+        pos = point_count
+        time_plot = UiProxy.add_time_plot_view(tab, smuview.DockArea.TopDockArea)
+        for channel in channels:
+            UiProxy.add_curve_to_time_plot_view(tab, time_plot, channel.actual_signal())
+        for update_mode in UPDATE_MODES:
+            UiProxy.set_plot_update_mode(tab, time_plot, update_mode)
+            pos = measure("Time plot {} {}".format(name, update_mode.name),
+                tab, time_plot, channels, pos, start_ts)
+
+        # The XY curves combine the first channel with every channel
+        xy_plot = UiProxy.add_xy_plot_view(tab, smuview.DockArea.BottomDockArea)
+        for channel in channels:
+            UiProxy.add_curve_to_xy_plot_view(tab, xy_plot,
+                channels[0].actual_signal(), channel.actual_signal())
+        pos = measure("XY plot {}".format(name), tab, xy_plot, channels,
+            pos, start_ts)
+
+        Session.remove_device(device)
+
+print("Benchmark finished")
@@ -0,0 +1,159 @@
+# This file is part of the SmuView project.
+#
+# Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+
+#
+# Benchmark of the signal data path: Storing, reading and searching samples of
+# AnalogTimeSignals, the combination of signals and the math channels.
+# Start it with "smuview -s benchmark_signal_data_path.py", the results are
+# printed to the console.
+#
+
+import time
+import numpy
+import smuview
+
+# The number of samples per signal. 1e8 samples need about 1.6 GiB of memory.
+SIZES = [1000, 100000, 10000000]
+#SIZES.append(100000000)
+SAMPLERATE = 1000.
+BLOCK_SIZE = 100000
+READ_COUNT = 10000
+TIMEOUT = 600
+
+user_device = Session.add_user_device()
+
+
+def report(name, size, duration, count):
+    print("{:<36} {:>10} samples: {:10.3f} ms, {:12.0f} /s".format(
+        name, size, duration * 1000, count / duration))
+
+
+def wait_for_count(channel, count):
+    """Wait until the math channel has calculated count samples."""
+    deadline = time.perf_counter() + TIMEOUT
+    while time.perf_counter() < deadline:
+        signal = channel.actual_signal()
+        if signal is not None:
+            if signal.sample_count() >= count:
+                return True
+            signal.wait_for_samples(1, 0.1)
+        else:
+            time.sleep(0.01)
+    print("Timeout while waiting for {}".format(channel.name()))
+    return False
+
+
+def push(channel, size, start_ts, explicit_timestamps):
+    """Push size samples in blocks, returns the duration."""
+    duration = 0.
+    for pos in range(0, size, BLOCK_SIZE):
+        n = min(BLOCK_SIZE, size - pos)
+        values = numpy.sin(numpy.arange(pos, pos + n) / 100.)
+        if explicit_timestamps:
+            # Jitter breaks the runs of the time base
+            timestamps = start_ts + (numpy.arange(pos, pos + n) +
+                numpy.random.uniform(-0.1, 0.1, n)) / SAMPLERATE
+            t = time.perf_counter()
+            channel.push_samples(values, timestamps, smuview.Quantity.Voltage,
+                set(), smuview.Unit.Volt, 7, 6)
+        else:
+            t = time.perf_counter()
+            channel.push_samples(values, SAMPLERATE, start_ts + pos / SAMPLERATE,
+                smuview.Quantity.Voltage, set(), smuview.Unit.Volt, 7, 6)
+        duration += time.perf_counter() - t
+    return duration
+
+
+def bench_push(size, start_ts):
+    channel = user_device.add_user_channel("Rate_{}".format(size), "Push")
+    report("push_samples() samplerate", size,
+        push(channel, size, start_ts, False), size)
+    channel_ts = user_device.add_user_channel("Timestamps_{}".format(size), "Push")
+    report("push_samples() timestamps", size,
+        push(channel_ts, size, start_ts, True), size)
+    return channel.actual_signal(), channel_ts.actual_signal()
+
+
+def bench_read(name, signal, size, start_ts):
+    positions = numpy.random.randint(0, size, READ_COUNT)
+    t = time.perf_counter()
+    for pos in positions:
+        signal.get_sample(int(pos), False)
+    report("get_sample() " + name, size, time.perf_counter() - t, READ_COUNT)
+
+    timestamps = start_ts + numpy.random.uniform(0, size / SAMPLERATE, READ_COUNT)
+    t = time.perf_counter()
+    for ts in timestamps:
+        signal.lower_index(float(ts), False)
+    report("lower_index() " + name, size, time.perf_counter() - t, READ_COUNT)
+
+    t = time.perf_counter()
+    signal.to_numpy(False)
+    report("to_numpy() " + name, size, time.perf_counter() - t, size)
+
+
+def bench_math(name, size, start_ts, add_channel, expected_count):
+    """Push size samples to a new source and wait for the math channel."""
+    source = user_device.add_user_channel("{}_Source_{}".format(name, size), "Math")
+    source.add_signal(smuview.Quantity.Voltage, set(), smuview.Unit.Volt)
+    channel = add_channel(source.actual_signal(), "{}_{}".format(name, size))
+    t = time.perf_counter()
+    push(source, size, start_ts, False)
+    if wait_for_count(channel, expected_count(size)):
+        report(name, size, time.perf_counter() - t, size)
+
+
+def bench_combine(size, start_ts, signal, signal_ts):
+    """The expression channel combines the two signals by their timestamps."""
+    t = time.perf_counter()
+    channel = user_device.add_expression_channel([signal, signal_ts], "v1 - v2",
+        smuview.Quantity.Voltage, set(), smuview.Unit.Volt,
+        "Combine_{}".format(size), "Combine")
+    if wait_for_count(channel, size - 1):
+        report("combine 2 signals", size, time.perf_counter() - t, size)
+
+
+math_channels = [
+    ("Expression", lambda s, n: user_device.add_expression_channel([s], "2 * v1 + 1",
+        smuview.Quantity.Voltage, set(), smuview.Unit.Volt, n, "Math"), lambda n: n),
+    ("Python", lambda s, n: user_device.add_math_channel([s], lambda ts, v1: 2 * v1 + 1,
+        smuview.Quantity.Voltage, set(), smuview.Unit.Volt, n, "Math"), lambda n: n),
+    ("EMA", lambda s, n: user_device.add_ema_channel(s, 0.1, n, "Math"), lambda n: n),
+    ("MovingMedian", lambda s, n: user_device.add_moving_median_channel(s, 100, n, "Math"), lambda n: n),
+    ("MinMaxHold", lambda s, n: user_device.add_min_max_hold_channel(
+        s, smuview.MinMaxHoldType.Max, 100, n, "Math"), lambda n: n),
+    ("RMS", lambda s, n: user_device.add_rms_channel(s, 100, n, "Math"), lambda n: n),
+    ("Resample", lambda s, n: user_device.add_resample_channel(
+        s, SAMPLERATE / 10, smuview.ResampleMethod.Linear, n, "Math"), lambda n: n // 10 - 1),
+]
+
+for size in SIZES:
+    start_ts = time.time()
+    signal, signal_ts = bench_push(size, start_ts)
+    bench_read("samplerate", signal, size, start_ts)
+    bench_read("timestamps", signal_ts, size, start_ts)
+    bench_combine(size, start_ts, signal, signal_ts)
+    for name, add_channel, expected_count in math_channels:
+        bench_math(name, size, start_ts, add_channel, expected_count)
+
+print("Benchmark finished")
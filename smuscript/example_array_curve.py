@@ -0,0 +1,43 @@
+# This file is part of the SmuView project.
+#
+# Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+
+import math
+import smuview
+
+# Plot precomputed samples (e.g. a fit or a model) without a signal. The x
+# and y values may be lists or numpy arrays.
+
+user_dev = Session.add_user_device()
+user_dev_tab = UiProxy.add_device_tab(user_dev)
+xy_plot = UiProxy.add_xy_plot_view(user_dev_tab, smuview.DockArea.TopDockArea)
+
+# Shockley diode model with Is = 1nA, n = 1.8
+voltages = [i * 0.001 for i in range(800)]
+currents = [1e-9 * (math.exp(v / (1.8 * 0.02585)) - 1.) for v in voltages]
+
+curve = UiProxy.add_array_curve_to_plot_view(user_dev_tab, xy_plot,
+    voltages, currents,
+    smuview.Quantity.Voltage, {smuview.QuantityFlag.DC}, smuview.Unit.Volt,
+    smuview.Quantity.Current, {smuview.QuantityFlag.DC}, smuview.Unit.Ampere,
+    "Diode model")
+UiProxy.set_curve_color(user_dev_tab, xy_plot, curve, (0, 128, 255))
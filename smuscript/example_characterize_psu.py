@@ -61,15 +61,24 @@ UiProxy.add_curve_to_time_plot(user_dev_tab, p_plot, p_out_sig)
 xy_plot = UiProxy.add_xy_plot_view(user_dev_tab, smuview.DockArea.TopDockArea)
 UiProxy.add_curve_to_xy_plot_view(user_dev_tab, xy_plot, p_out_sig, eff_sig)
 
+u_in_sig = psu_dev.channels()["V1"].actual_signal()
+i_in_sig = dmm_dev.channels()["P1"].actual_signal()
+u_out_sig = load_dev.channels()["V"].actual_signal()
+i_out_sig = load_dev.channels()["I"].actual_signal()
+
 d = .0
 while d <= 2.0:
     load_conf.set_config(smuview.ConfigKey.CurrentLimit, d)
-    time.sleep(0.5)
-    u_in = psu_dev.channels()["V1"].actual_signal().get_last_sample(True)[1]
-    i_in = dmm_dev.channels()["P1"].actual_signal().get_last_sample(True)[1]
+    # Wait until the load current has settled, then average the next samples
+    i_out_sig.wait_stable(0.002, 0.2, 2.0)
+    ts = time.time()
+    i_out_sig.wait_for_samples(5, 2.0)
+    i_in_sig.wait_for_samples(1, 2.0)
+    u_in = u_in_sig.mean_since(ts)
+    i_in = i_in_sig.mean_since(ts)
     power_in = u_in * i_in
-    u_out = load_dev.channels()["V"].actual_signal().get_last_sample(True)[1]
-    i_out = load_dev.channels()["I"].actual_signal().get_last_sample(True)[1]
+    u_out = u_out_sig.mean_since(ts)
+    i_out = i_out_sig.mean_since(ts)
     # MathChannels are not in the python bindings yet, so we have to calculate by our own.
     power_out = u_out * i_out
     eff = (power_out / power_in) * 100
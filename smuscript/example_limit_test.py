@@ -0,0 +1,55 @@
+# This file is part of the SmuView project.
+#
+# Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+
+import smuview
+import time
+
+# Connect the PSU and wait for its signals
+psu_dev = Session.connect_device("scpi-pps:conn=libgpib/hp6632b")[0]
+psu_conf = psu_dev.configurables()["1"]
+time.sleep(1)
+u_out_sig = psu_dev.channels()["V1"].actual_signal()
+
+# The limit engine checks every sample of the steps in C++, the script only
+# switches the steps and reads the results.
+limits = Session.add_limit_engine(u_out_sig)
+limits.add_tolerance_rule(5.0, 0.02, True, "5 V +/- 2%")
+# The output must settle into +/- 50 mV within 0.5 s and stay there
+limits.add_mask_rule([(0.0, 0.0, 6.0), (0.5, 4.95, 5.05), (10.0, 4.95, 5.05)],
+                     "Settling")
+
+psu_conf.set_config(smuview.ConfigKey.VoltageTarget, 5.0)
+psu_conf.set_config(smuview.ConfigKey.CurrentLimit, 1.0)
+psu_conf.set_config(smuview.ConfigKey.Enabled, True)
+
+for current_limit in [0.1, 0.5, 1.0]:
+    psu_conf.set_config(smuview.ConfigKey.CurrentLimit, current_limit)
+    limits.begin_step("I_lim = %.1f A" % current_limit)
+    u_out_sig.wait_for_samples(20, 5.0)
+    result = limits.end_step()
+    print("%s: %s" % (result.name, "PASS" if result.passed else "FAIL"))
+
+psu_conf.set_config(smuview.ConfigKey.Enabled, False)
+
+print(limits.report())
+print("Device %s" % ("PASSED" if limits.passed() else "FAILED"))
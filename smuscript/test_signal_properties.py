@@ -0,0 +1,261 @@
+# This file is part of the SmuView project.
+#
+# Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+
+#
+# Randomized property tests of the signal data path against reference
+# implementations in NumPy: The combination of signals (by the expression
+# channel, that merges the signals like AnalogTimeSignal::combine_signals()),
+# the timestamp search and the math channels. Every round uses new random
+# timestamps (with gaps and equal timestamps), values and NaNs.
+#
+# It needs no user interface:
+#   smuview --headless -s test_signal_properties.py
+#
+# This complements the unit tests in test/ (make test), that check the same
+# data classes without a device, with the devices of a running SmuView.
+#
+
+import time
+import numpy
+import smuview
+
+ROUNDS = 20
+SAMPLES = 2000
+WINDOW = 16
+EMA_TIME_CONSTANT = 0.05
+RESAMPLE_RATE = 100.
+TIMEOUT = 10
+SEED = int(time.time())
+
+rng = numpy.random.default_rng(SEED)
+device = Session.add_user_device()
+failures = []
+
+
+def check(name, ok, message=""):
+    if not ok:
+        failures.append("{}: {}".format(name, message))
+        print("FAILED {} {}".format(name, message))
+
+
+def random_timestamps(start_ts, count):
+    """Random increasing timestamps with gaps and runs of equal timestamps."""
+    steps = rng.exponential(0.01, count)
+    steps[rng.random(count) < 0.05] = 0.
+    steps[rng.random(count) < 0.01] *= 100.
+    return start_ts + numpy.cumsum(steps)
+
+
+def random_values(count, nan_fraction):
+    values = rng.normal(0., 10., count)
+    values[rng.random(count) < nan_fraction] = numpy.nan
+    return values
+
+
+def new_source(name):
+    channel = device.add_user_channel(name, "Test")
+    channel.add_signal(smuview.Quantity.Voltage, set(), smuview.Unit.Volt)
+    return channel
+
+
+def push(channel, values, timestamps):
+    channel.push_samples(values, timestamps, smuview.Quantity.Voltage, set(),
+        smuview.Unit.Volt, 7, 6)
+
+
+def wait_until_stable(channel):
+    """Wait until the math channel doesn't calculate new samples any more."""
+    deadline = time.perf_counter() + TIMEOUT
+    count = -1
+    while time.perf_counter() < deadline:
+        signal = channel.actual_signal()
+        new_count = signal.sample_count() if signal is not None else 0
+        if new_count == count:
+            break
+        count = new_count
+        time.sleep(0.2)
+    signal = channel.actual_signal()
+    if signal is None:
+        return numpy.empty(0), numpy.empty(0)
+    return signal.to_numpy(False)
+
+
+def compare(name, timestamps, values, ref_timestamps, ref_values):
+    if len(timestamps) != len(ref_timestamps):
+        check(name, False, "{} samples, expected {}".format(
+            len(timestamps), len(ref_timestamps)))
+        return
+    check(name + " timestamps", numpy.array_equal(timestamps, ref_timestamps))
+    check(name + " values", numpy.allclose(values, ref_values,
+        rtol=1e-9, atol=1e-9, equal_nan=True), "max error {}".format(
+        numpy.nanmax(numpy.abs(values - ref_values)) if len(values) else 0))
+
+
+def ref_window(timestamps, values, func):
+    """Apply func to the last WINDOW finite samples, for every finite sample."""
+    finite = numpy.isfinite(values)
+    ts = timestamps[finite]
+    vs = values[finite]
+    results = numpy.array([func(vs[max(0, i - WINDOW + 1):i + 1])
+        for i in range(len(vs))])
+    return ts, results
+
+
+def ref_ema(timestamps, values):
+    finite = numpy.isfinite(values)
+    ts = timestamps[finite]
+    vs = values[finite]
+    results = numpy.empty(len(vs))
+    for i in range(len(vs)):
+        if i == 0:
+            value = vs[0]
+        elif ts[i] > ts[i - 1]:
+            alpha = 1. - numpy.exp(-(ts[i] - ts[i - 1]) / EMA_TIME_CONSTANT)
+            value += alpha * (vs[i] - value)
+        results[i] = value
+    return ts, results
+
+
+def ref_resample(timestamps, values):
+    finite = numpy.isfinite(values)
+    ts = timestamps[finite]
+    vs = values[finite]
+    # Samples, that don't go forward in time, are skipped
+    keep = numpy.concatenate(([True], numpy.diff(ts) > 0))
+    ts = ts[keep]
+    vs = vs[keep]
+    first = int(numpy.ceil(ts[0] * RESAMPLE_RATE))
+    if first / RESAMPLE_RATE < ts[0]:
+        first += 1
+    grid = numpy.arange(first, int(numpy.ceil(ts[-1] * RESAMPLE_RATE)) + 1) / RESAMPLE_RATE
+    grid = grid[grid < ts[-1]]
+    return grid, numpy.interp(grid, ts, vs)
+
+
+def ref_combine(ts1, vs1, ts2, vs2):
+    """The union of the timestamps, where both signals can be interpolated."""
+    begin = max(ts1[0], ts2[0])
+    end = min(ts1[-1], ts2[-1])
+    grid = numpy.union1d(ts1, ts2)
+    grid = grid[(grid >= begin) & (grid <= end)]
+    return grid, numpy.interp(grid, ts1, vs1), numpy.interp(grid, ts2, vs2)
+
+
+def test_lower_index(name, signal, timestamps):
+    probes = rng.uniform(timestamps[0] - 1, timestamps[-1] + 1, 200)
+    probes = numpy.concatenate((probes, rng.choice(timestamps, 50)))
+    for probe in probes:
+        pos = signal.lower_index(float(probe), False)
+        ref = int(numpy.searchsorted(timestamps, probe, side="left"))
+        if pos != ref:
+            check(name, False, "lower_index({}) = {}, expected {}".format(
+                probe, pos, ref))
+            return
+
+
+def run_round(round):
+    start_ts = time.time()
+    prefix = "R{}_".format(round)
+    src1 = new_source(prefix + "S1")
+    src2 = new_source(prefix + "S2")
+    sig1 = src1.actual_signal()
+    sig2 = src2.actual_signal()
+
+    math_channels = {
+        "Expression": device.add_expression_channel([sig1], "2 * v1 + 1",
+            smuview.Quantity.Voltage, set(), smuview.Unit.Volt, prefix + "Expr", "Test"),
+        "Combine1": device.add_expression_channel([sig1, sig2], "v1",
+            smuview.Quantity.Voltage, set(), smuview.Unit.Volt, prefix + "C1", "Test"),
+        "Combine2": device.add_expression_channel([sig1, sig2], "v2",
+            smuview.Quantity.Voltage, set(), smuview.Unit.Volt, prefix + "C2", "Test"),
+        "EMA": device.add_ema_channel(sig1, EMA_TIME_CONSTANT, prefix + "EMA", "Test"),
+        "MovingMedian": device.add_moving_median_channel(sig1, WINDOW, prefix + "Median", "Test"),
+        "Min": device.add_min_max_hold_channel(sig1, smuview.MinMaxHoldType.Min, WINDOW, prefix + "Min", "Test"),
+        "Max": device.add_min_max_hold_channel(sig1, smuview.MinMaxHoldType.Max, WINDOW, prefix + "Max", "Test"),
+        "RMS": device.add_rms_channel(sig1, WINDOW, prefix + "RMS", "Test"),
+        "Resample": device.add_resample_channel(sig1, RESAMPLE_RATE,
+            smuview.ResampleMethod.Linear, prefix + "Resample", "Test"),
+    }
+
+    ts1 = random_timestamps(start_ts, SAMPLES)
+    vs1 = random_values(SAMPLES, 0.02)
+    # Signal 2 has no equal timestamps, so the reference can interpolate it
+    ts2 = numpy.unique(random_timestamps(start_ts + rng.uniform(-1, 1), SAMPLES // 2))
+    vs2 = random_values(len(ts2), 0.)
+    # Push in random blocks, so the math channels get partial windows
+    for values, timestamps, channel in ((vs1, ts1, src1), (vs2, ts2, src2)):
+        pos = 0
+        while pos < len(values):
+            n = int(rng.integers(1, 300))
+            push(channel, values[pos:pos + n], timestamps[pos:pos + n])
+            pos += n
+
+    stored_ts, stored_vs = sig1.to_numpy(False)
+    compare("Stored samples", stored_ts, stored_vs, ts1, vs1)
+    test_lower_index("lower_index", sig1, ts1)
+
+    results = {name: wait_until_stable(channel)
+        for name, channel in math_channels.items()}
+
+    finite = numpy.isfinite(vs1)
+    compare("Expression", *results["Expression"], ts1, 2 * vs1 + 1)
+    compare("EMA", *results["EMA"], *ref_ema(ts1, vs1))
+    compare("MovingMedian", *results["MovingMedian"],
+        *ref_window(ts1, vs1, numpy.median))
+    compare("Min", *results["Min"], *ref_window(ts1, vs1, numpy.min))
+    compare("Max", *results["Max"], *ref_window(ts1, vs1, numpy.max))
+    compare("RMS", *results["RMS"],
+        *ref_window(ts1, vs1, lambda w: numpy.sqrt(numpy.mean(w * w))))
+    compare("Resample", *results["Resample"], *ref_resample(ts1, vs1))
+
+    # The NaNs of signal 1 would spoil the interpolation of the reference
+    ref_ts, ref_v1, ref_v2 = ref_combine(ts1[finite], vs1[finite], ts2, vs2)
+    c1_ts, c1_vs = results["Combine1"]
+    c2_ts, c2_vs = results["Combine2"]
+    c1_finite = numpy.isin(c1_ts, ref_ts)
+    c2_finite = numpy.isin(c2_ts, ref_ts)
+    check("Combine timestamps", numpy.array_equal(c1_ts, c2_ts))
+    check("Combine coverage", numpy.all(numpy.isin(ref_ts[1:-1], c1_ts)),
+        "missing rows")
+    idx = numpy.searchsorted(ref_ts, c1_ts[c1_finite])
+    check("Combine v2", numpy.allclose(c2_vs[c2_finite], ref_v2[idx],
+        rtol=1e-9, atol=1e-9))
+    # Rows at or next to a NaN of signal 1 are NaN. At equal timestamps of
+    # signal 1, every sample gets its own row, the reference has only one.
+    unique_ts, ts_counts = numpy.unique(ts1, return_counts=True)
+    single = ~numpy.isin(c1_ts[c1_finite], unique_ts[ts_counts > 1])
+    v1 = c1_vs[c1_finite][single]
+    ok = numpy.isnan(v1) | numpy.isclose(v1, ref_v1[idx][single],
+        rtol=1e-9, atol=1e-9)
+    check("Combine v1", numpy.all(ok))
+
+
+print("Seed {}".format(SEED))
+for round in range(ROUNDS):
+    run_round(round)
+Session.remove_device(device)
+
+if failures:
+    raise AssertionError("{} checks failed (seed {}):\n{}".format(
+        len(failures), SEED, "\n".join(failures)))
+print("All checks passed")
@@ -0,0 +1,211 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#include "allocationcounter.hpp"
+
+namespace sv {
+
+namespace {
+
+const size_t domain_count = 2;
+
+/**
+ * The counters are plain atomics with constant initialization, so the
+ * global operator new can use them before main() and after the static
+ * destructors.
+ */
+struct Counters
+{
+	std::atomic<uint64_t> allocations;
+	std::atomic<uint64_t> deallocations;
+	std::atomic<uint64_t> allocated_bytes;
+	std::atomic<uint64_t> freed_bytes;
+};
+
+Counters global_counters;
+Counters domain_counters[domain_count];
+
+thread_local uint64_t thread_allocations = 0;
+thread_local uint64_t thread_deallocations = 0;
+thread_local uint64_t thread_allocated_bytes = 0;
+
+AllocationCounts load(const Counters &counters)
+{
+	AllocationCounts counts;
+	counts.allocations = counters.allocations.load(std::memory_order_relaxed);
+	counts.deallocations =
+		counters.deallocations.load(std::memory_order_relaxed);
+	counts.allocated_bytes =
+		counters.allocated_bytes.load(std::memory_order_relaxed);
+	const uint64_t freed_bytes =
+		counters.freed_bytes.load(std::memory_order_relaxed);
+	counts.live_bytes = counts.allocated_bytes > freed_bytes ?
+		counts.allocated_bytes - freed_bytes : 0;
+	return counts;
+}
+
+} // namespace
+
+bool AllocationCounter::has_global_counters()
+{
+#ifdef ENABLE_ALLOCATION_COUNTERS
+	return true;
+#else
+	return false;
+#endif
+}
+
+AllocationCounts AllocationCounter::global_counts()
+{
+	AllocationCounts counts = load(global_counters);
+	counts.live_bytes = 0;
+	return counts;
+}
+
+AllocationCounts AllocationCounter::domain_counts(AllocationDomain domain)
+{
+	return load(domain_counters[(size_t)domain]);
+}
+
+AllocationCounts AllocationCounter::thread_counts()
+{
+	AllocationCounts counts;
+	counts.allocations = thread_allocations;
+	counts.deallocations = thread_deallocations;
+	counts.allocated_bytes = thread_allocated_bytes;
+	counts.live_bytes = 0;
+	return counts;
+}
+
+void *AllocationCounter::allocate(AllocationDomain domain, size_t bytes)
+{
+	// With global counters, operator new also counts the thread
+	void *ptr = ::operator new(bytes);
+	Counters &counters = domain_counters[(size_t)domain];
+	counters.allocations.fetch_add(1, std::memory_order_relaxed);
+	counters.allocated_bytes.fetch_add(bytes, std::memory_order_relaxed);
+	if (!has_global_counters()) {
+		++thread_allocations;
+		thread_allocated_bytes += bytes;
+	}
+	return ptr;
+}
+
+void AllocationCounter::deallocate(AllocationDomain domain, void *ptr,
+	size_t bytes)
+{
+	if (ptr == nullptr)
+		return;
+	::operator delete(ptr);
+	Counters &counters = domain_counters[(size_t)domain];
+	counters.deallocations.fetch_add(1, std::memory_order_relaxed);
+	counters.freed_bytes.fetch_add(bytes, std::memory_order_relaxed);
+	if (!has_global_counters())
+		++thread_deallocations;
+}
+
+void AllocationCounter::count_global_allocation(size_t bytes)
+{
+	global_counters.allocations.fetch_add(1, std::memory_order_relaxed);
+	global_counters.allocated_bytes.fetch_add(bytes, std::memory_order_relaxed);
+	++thread_allocations;
+	thread_allocated_bytes += bytes;
+}
+
+void AllocationCounter::count_global_deallocation()
+{
+	global_counters.deallocations.fetch_add(1, std::memory_order_relaxed);
+	++thread_deallocations;
+}
+
+} // namespace sv
+
+#ifdef ENABLE_ALLOCATION_COUNTERS
+
+/*
+ * The replaced global operators. The array and nothrow variants are
+ * replaced too, because the standard library doesn't guarantee, that they
+ * call the plain operators.
+ */
+
+void *operator new(std::size_t size)
+{
+	if (size == 0)
+		size = 1;
+	void *ptr;
+	while ((ptr = std::malloc(size)) == nullptr) {
+		std::new_handler handler = std::get_new_handler();
+		if (handler == nullptr)
+			throw std::bad_alloc();
+		handler();
+	}
+	sv::AllocationCounter::count_global_allocation(size);
+	return ptr;
+}
+
+void *operator new[](std::size_t size)
+{
+	return ::operator new(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+	try {
+		return ::operator new(size);
+	}
+	catch (const std::bad_alloc &) {
+		return nullptr;
+	}
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+	return ::operator new(size, std::nothrow);
+}
+
+void operator delete(void *ptr) noexcept
+{
+	if (ptr == nullptr)
+		return;
+	sv::AllocationCounter::count_global_deallocation();
+	std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+	::operator delete(ptr);
+}
+
+void operator delete(void *ptr, const std::nothrow_t &) noexcept
+{
+	::operator delete(ptr);
+}
+
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept
+{
+	::operator delete(ptr);
+}
+
+#endif
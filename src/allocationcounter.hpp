@@ -0,0 +1,178 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ALLOCATIONCOUNTER_HPP
+#define ALLOCATIONCOUNTER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using std::vector;
+
+namespace sv {
+
+/**
+ * The allocation domains, that are counted by the CountingAllocator.
+ */
+enum class AllocationDomain
+{
+	/** The chunks of the signal storage, see data::ChunkedBuffer. */
+	Storage = 0,
+	/** The reused buffers of the data path, e.g. the decoded packets. */
+	Scratch = 1,
+};
+
+/**
+ * A snapshot of allocation counters.
+ */
+struct AllocationCounts
+{
+	uint64_t allocations;
+	uint64_t deallocations;
+	/** The allocated bytes, also of the already freed allocations. */
+	uint64_t allocated_bytes;
+	/**
+	 * The allocated bytes, that were not freed yet. Unknown (0) for the
+	 * global counters, the global operator delete doesn't know the size.
+	 */
+	uint64_t live_bytes;
+};
+
+/**
+ * Counts the heap allocations, to verify that the data path doesn't
+ * allocate in the steady state.
+ *
+ * The allocations of the signal storage and the scratch buffers are always
+ * counted by the CountingAllocator, that costs one relaxed atomic add per
+ * chunk. With ENABLE_ALLOCATION_COUNTERS (always set in debug builds), the
+ * global operator new and delete are replaced and count every allocation of
+ * the application, which slows down all allocations a bit.
+ *
+ * Additionally every thread counts its own allocations, so that a code
+ * section can measure the allocations it did with an AllocationScope.
+ */
+class AllocationCounter
+{
+public:
+	/** Return true if the global operator new and delete are counted. */
+	static bool has_global_counters();
+	/** Return the counts of all allocations or 0 without global counters. */
+	static AllocationCounts global_counts();
+	static AllocationCounts domain_counts(AllocationDomain domain);
+	/**
+	 * Return the allocations of the calling thread. These are all
+	 * allocations with global counters, else only those of the domains.
+	 */
+	static AllocationCounts thread_counts();
+
+	static void *allocate(AllocationDomain domain, size_t bytes);
+	static void deallocate(AllocationDomain domain, void *ptr, size_t bytes);
+
+	/** Only for the global operator new and delete. */
+	static void count_global_allocation(size_t bytes);
+	static void count_global_deallocation();
+
+};
+
+/**
+ * Measures the allocations of the calling thread between the construction
+ * of the scope and the calls of allocations() and allocated_bytes().
+ */
+class AllocationScope
+{
+public:
+	AllocationScope() :
+		begin_(AllocationCounter::thread_counts())
+	{
+	}
+
+	uint64_t allocations() const
+	{
+		return AllocationCounter::thread_counts().allocations -
+			begin_.allocations;
+	}
+
+	uint64_t allocated_bytes() const
+	{
+		return AllocationCounter::thread_counts().allocated_bytes -
+			begin_.allocated_bytes;
+	}
+
+private:
+	const AllocationCounts begin_;
+
+};
+
+/**
+ * A standard allocator, that counts its allocations in a domain of the
+ * AllocationCounter.
+ */
+template<typename T, AllocationDomain Domain>
+class CountingAllocator
+{
+public:
+	typedef T value_type;
+
+	template<typename U>
+	struct rebind
+	{
+		typedef CountingAllocator<U, Domain> other;
+	};
+
+	CountingAllocator() = default;
+
+	template<typename U>
+	CountingAllocator(const CountingAllocator<U, Domain> &)
+	{
+	}
+
+	T *allocate(size_t n)
+	{
+		return static_cast<T *>(
+			AllocationCounter::allocate(Domain, n * sizeof(T)));
+	}
+
+	void deallocate(T *ptr, size_t n)
+	{
+		AllocationCounter::deallocate(Domain, ptr, n * sizeof(T));
+	}
+
+	template<typename U>
+	bool operator==(const CountingAllocator<U, Domain> &) const
+	{
+		return true;
+	}
+
+	template<typename U>
+	bool operator!=(const CountingAllocator<U, Domain> &) const
+	{
+		return false;
+	}
+
+};
+
+/** A vector of the scratch buffers of the data path. */
+template<typename T>
+using ScratchVector =
+	vector<T, CountingAllocator<T, AllocationDomain::Scratch>>;
+
+} // namespace sv
+
+#endif // ALLOCATIONCOUNTER_HPP
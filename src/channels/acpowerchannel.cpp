@@ -0,0 +1,307 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <QDebug>
+
+#include "acpowerchannel.hpp"
+#include "src/channels/basechannel.hpp"
+#include "src/channels/mathchannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/datautil.hpp"
+#include "src/data/samplekernels.hpp"
+#include "src/data/signalcombinecache.hpp"
+#include "src/devices/basedevice.hpp"
+
+using std::set;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace channels {
+
+namespace {
+
+/** The hysteresis of the crossings relative to the AC RMS of the voltage. */
+const double hysteresis_factor = 0.1;
+
+}
+
+const double AcPowerChannel::max_cycle_time_ = 1.;
+
+AcPowerChannel::AcPowerChannel(
+		data::Quantity quantity,
+		const set<data::QuantityFlag> &quantity_flags,
+		data::Unit unit,
+		shared_ptr<data::AnalogTimeSignal> voltage_signal,
+		shared_ptr<data::AnalogTimeSignal> current_signal,
+		AcPowerValue value,
+		uint cycle_count,
+		shared_ptr<devices::BaseDevice> parent_device,
+		const set<string> &channel_group_names,
+		const string &channel_name,
+		double channel_start_timestamp) :
+	MathChannel(quantity, quantity_flags, unit,
+		parent_device, channel_group_names, channel_name,
+		channel_start_timestamp),
+	voltage_signal_(voltage_signal),
+	current_signal_(current_signal),
+	value_(value),
+	cycle_count_(std::max(1u, cycle_count)),
+	combine_cursor_({ voltage_signal, current_signal }),
+	current_values_(sample_block_size_),
+	weights_(sample_block_size_),
+	result_timestamps_(sample_block_size_),
+	last_row_timestamp_(std::numeric_limits<double>::quiet_NaN()),
+	prev_timestamp_(0.),
+	prev_voltage_(0.),
+	armed_(false),
+	level_(0.),
+	hysteresis_(0.),
+	sums_start_(std::numeric_limits<double>::quiet_NaN()),
+	window_start_(std::numeric_limits<double>::quiet_NaN()),
+	window_cycles_(0)
+{
+	assert(voltage_signal_);
+	assert(current_signal_);
+
+	std::fill(sums_, sums_ + 5, 0.);
+
+	add_source_signal(voltage_signal_);
+	add_source_signal(current_signal_);
+}
+
+AcPowerValue AcPowerChannel::value() const
+{
+	return value_;
+}
+
+uint AcPowerChannel::cycle_count() const
+{
+	return cycle_count_;
+}
+
+void AcPowerChannel::value_quantity(AcPowerValue value,
+	shared_ptr<data::AnalogTimeSignal> voltage_signal,
+	shared_ptr<data::AnalogTimeSignal> current_signal,
+	data::Quantity &quantity, set<data::QuantityFlag> &quantity_flags,
+	data::Unit &unit)
+{
+	quantity_flags.clear();
+	switch (value) {
+	case AcPowerValue::RealPower:
+		quantity = data::Quantity::Power;
+		unit = data::Unit::Watt;
+		break;
+	case AcPowerValue::ApparentPower:
+		quantity = data::Quantity::ApparentPower;
+		unit = data::Unit::VoltAmpere;
+		break;
+	case AcPowerValue::ReactivePower:
+		// There is no var in libsigrok
+		quantity = data::Quantity::Power;
+		unit = data::Unit::VoltAmpere;
+		break;
+	case AcPowerValue::PowerFactor:
+		quantity = data::Quantity::PowerFactor;
+		unit = data::Unit::Unitless;
+		break;
+	case AcPowerValue::VoltageRms:
+		quantity = data::Quantity::Voltage;
+		unit = data::Unit::Volt;
+		if (voltage_signal) {
+			quantity = voltage_signal->quantity();
+			quantity_flags = voltage_signal->quantity_flags();
+			unit = voltage_signal->unit();
+		}
+		quantity_flags.insert(data::QuantityFlag::RMS);
+		break;
+	case AcPowerValue::CurrentRms:
+		quantity = data::Quantity::Current;
+		unit = data::Unit::Ampere;
+		if (current_signal) {
+			quantity = current_signal->quantity();
+			quantity_flags = current_signal->quantity_flags();
+			unit = current_signal->unit();
+		}
+		quantity_flags.insert(data::QuantityFlag::RMS);
+		break;
+	case AcPowerValue::Frequency:
+	default:
+		quantity = data::Quantity::Frequency;
+		unit = data::Unit::Hertz;
+		break;
+	}
+}
+
+void AcPowerChannel::accumulate(size_t begin, size_t end)
+{
+	if (end <= begin)
+		return;
+	if (std::isnan(sums_start_))
+		sums_start_ = block_timestamps_[begin];
+	data::samplekernels::power_sums(block_values_.data() + begin,
+		current_values_.data() + begin, weights_.data() + begin,
+		end - begin, sums_);
+}
+
+void AcPowerChannel::on_crossing(double timestamp, size_t &result_count)
+{
+	// The samples before the first crossing don't make a cycle
+	if (!std::isnan(window_start_)) {
+		if (++window_cycles_ < cycle_count_)
+			return;
+
+		block_results_[result_count] = result(timestamp - window_start_);
+		result_timestamps_[result_count] = timestamp;
+		++result_count;
+		update_level();
+	}
+
+	std::fill(sums_, sums_ + 5, 0.);
+	sums_start_ = timestamp;
+	window_start_ = timestamp;
+	window_cycles_ = 0;
+}
+
+double AcPowerChannel::result(double window_time) const
+{
+	const double weight = sums_[0];
+	if (!(weight > 0.))
+		return std::numeric_limits<double>::quiet_NaN();
+
+	const double real_power = sums_[4] / weight;
+	const double voltage_rms = std::sqrt(std::max(0., sums_[2] / weight));
+	const double current_rms = std::sqrt(std::max(0., sums_[3] / weight));
+	const double apparent_power = voltage_rms * current_rms;
+	switch (value_) {
+	case AcPowerValue::RealPower:
+		return real_power;
+	case AcPowerValue::ApparentPower:
+		return apparent_power;
+	case AcPowerValue::ReactivePower:
+		return std::sqrt(std::max(0.,
+			apparent_power * apparent_power - real_power * real_power));
+	case AcPowerValue::PowerFactor:
+		if (apparent_power > 0.)
+			return real_power / apparent_power;
+		return std::numeric_limits<double>::quiet_NaN();
+	case AcPowerValue::VoltageRms:
+		return voltage_rms;
+	case AcPowerValue::CurrentRms:
+		return current_rms;
+	case AcPowerValue::Frequency:
+	default:
+		if (window_time > 0.)
+			return (double)window_cycles_ / window_time;
+		return std::numeric_limits<double>::quiet_NaN();
+	}
+}
+
+void AcPowerChannel::update_level()
+{
+	const double weight = sums_[0];
+	if (!(weight > 0.))
+		return;
+
+	const double mean = sums_[1] / weight;
+	const double ac_square = sums_[2] / weight - mean * mean;
+	level_ = mean;
+	hysteresis_ = hysteresis_factor * std::sqrt(std::max(0., ac_square));
+}
+
+void AcPowerChannel::on_sample_appended()
+{
+	if (is_suspended())
+		return;
+
+	double *values[] = { block_values_.data(), current_values_.data() };
+	size_t count;
+	while ((count = combine_cursor_.combine(sample_block_size_,
+			block_timestamps_.data(), values)) > 0) {
+		// The weight of a row is the interval since the previous row
+		weights_[0] = std::isnan(last_row_timestamp_) ?
+			0. : block_timestamps_[0] - last_row_timestamp_;
+		for (size_t k = 1; k < count; ++k)
+			weights_[k] = block_timestamps_[k] - block_timestamps_[k - 1];
+		last_row_timestamp_ = block_timestamps_[count - 1];
+
+		// Only the crossings are searched sample by sample, the sums of the
+		// rows between them are accumulated at once.
+		size_t result_count = 0;
+		size_t begin = 0;
+		const double max_window_time = max_cycle_time_ * cycle_count_;
+		for (size_t k = 0; k < count; ++k) {
+			const double timestamp = block_timestamps_[k];
+			const double voltage = block_values_[k];
+			if (!std::isfinite(voltage))
+				continue;
+
+			if (!armed_) {
+				if (voltage < level_ - hysteresis_)
+					armed_ = true;
+			}
+			else if (voltage >= level_) {
+				// The crossing is interpolated between the two samples
+				double crossing = timestamp;
+				if (voltage > prev_voltage_) {
+					crossing = prev_timestamp_ +
+						(level_ - prev_voltage_) / (voltage - prev_voltage_) *
+						(timestamp - prev_timestamp_);
+				}
+				accumulate(begin, k);
+				begin = k;
+				on_crossing(crossing, result_count);
+				armed_ = false;
+			}
+			prev_timestamp_ = timestamp;
+			prev_voltage_ = voltage;
+
+			// No crossings, e.g. a DC signal or a wrong level. The level is
+			// set again from the samples without a crossing.
+			if (timestamp - sums_start_ > max_window_time) {
+				accumulate(begin, k);
+				begin = k;
+				update_level();
+				std::fill(sums_, sums_ + 5, 0.);
+				sums_start_ = timestamp;
+				window_start_ = std::numeric_limits<double>::quiet_NaN();
+				armed_ = false;
+			}
+		}
+		accumulate(begin, count);
+
+		if (result_count > 0) {
+			push_samples(block_results_.data(), result_timestamps_.data(),
+				result_count);
+		}
+	}
+}
+
+} // namespace channels
+} // namespace sv
@@ -0,0 +1,178 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CHANNELS_ACPOWERCHANNEL_HPP
+#define CHANNELS_ACPOWERCHANNEL_HPP
+
+#include <cstddef>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <QObject>
+
+#include "src/channels/basechannel.hpp"
+#include "src/channels/mathchannel.hpp"
+#include "src/data/datautil.hpp"
+#include "src/data/signalcombinecache.hpp"
+
+using std::set;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+
+namespace data {
+class AnalogTimeSignal;
+}
+
+namespace devices {
+class BaseDevice;
+}
+
+namespace channels {
+
+/** The result of the AC power analysis, that is output by the channel. */
+enum class AcPowerValue {
+	/** The active power P in W. */
+	RealPower,
+	/** The apparent power S = Vrms * Irms in VA. */
+	ApparentPower,
+	/**
+	 * The reactive (non active) power Q = sqrt(S^2 - P^2) in VA. Like the
+	 * apparent power, it doesn't have a sign.
+	 */
+	ReactivePower,
+	/** The power factor P / S. */
+	PowerFactor,
+	VoltageRms,
+	CurrentRms,
+	/** The frequency of the voltage in Hz. */
+	Frequency,
+};
+
+/**
+ * The AC power analysis of sampled voltage and current waveforms, e.g. for
+ * mains or AC load tests.
+ *
+ * The samples of both signals are combined (see data::SignalCombiner) and
+ * the periods are detected by the rising zero crossings of the voltage. The
+ * crossings have a hysteresis of 10% of the AC RMS of the last window, the
+ * level is the mean of the last window, so a DC offset doesn't matter. For
+ * every window of cycle_count cycles, one result is output with the
+ * timestamp of the closing crossing. So the channel is a low rate signal and
+ * the raw waveforms don't have to be kept or plotted for these numbers.
+ *
+ * The weighted sums of a window are accumulated in blocks with the
+ * vectorized data::samplekernels::power_sums(). When no crossing is found
+ * for a second per cycle (e.g. a DC signal), the accumulation is restarted
+ * with a new level and hysteresis and nothing is output.
+ */
+class AcPowerChannel : public MathChannel
+{
+	Q_OBJECT
+
+public:
+	AcPowerChannel(
+		data::Quantity quantity,
+		const set<data::QuantityFlag> &quantity_flags,
+		data::Unit unit,
+		shared_ptr<data::AnalogTimeSignal> voltage_signal,
+		shared_ptr<data::AnalogTimeSignal> current_signal,
+		AcPowerValue value,
+		uint cycle_count,
+		shared_ptr<devices::BaseDevice> parent_device,
+		const set<string> &channel_group_names,
+		const string &channel_name,
+		double channel_start_timestamp);
+
+	AcPowerValue value() const;
+	/** The number of cycles of a window, 1 gives a result per cycle. */
+	uint cycle_count() const;
+
+	/**
+	 * Return the quantity, the quantity flags and the unit of the signal
+	 * for the result value of the analysis of the voltage and the current
+	 * signal. Without signals, a voltage in V and a current in A are
+	 * assumed.
+	 */
+	static void value_quantity(AcPowerValue value,
+		shared_ptr<data::AnalogTimeSignal> voltage_signal,
+		shared_ptr<data::AnalogTimeSignal> current_signal,
+		data::Quantity &quantity, set<data::QuantityFlag> &quantity_flags,
+		data::Unit &unit);
+
+private:
+	/** Process the combined rows [begin, end) of the block. */
+	void accumulate(size_t begin, size_t end);
+	/**
+	 * Close the cycle at a crossing at timestamp and add the result of the
+	 * window to the block results, when the window is complete.
+	 */
+	void on_crossing(double timestamp, size_t &result_count);
+	/** Calculate the result value from the sums of the window. */
+	double result(double window_time) const;
+	/** Set the level and the hysteresis of the crossings from the sums. */
+	void update_level();
+
+	/**
+	 * The maximum time of a cycle. Without a crossing, the window is
+	 * restarted after cycle_count_ times this time.
+	 */
+	static const double max_cycle_time_;
+
+	shared_ptr<data::AnalogTimeSignal> voltage_signal_;
+	shared_ptr<data::AnalogTimeSignal> current_signal_;
+	AcPowerValue value_;
+	uint cycle_count_;
+	data::SignalCombineCursor combine_cursor_;
+	/** The combined currents, the voltages are in block_values_. */
+	vector<double> current_values_;
+	/** The intervals of the combined rows. */
+	vector<double> weights_;
+	/** The timestamps of the results in block_results_. */
+	vector<double> result_timestamps_;
+
+	/** The timestamp of the last combined row, for the weights. */
+	double last_row_timestamp_;
+	/** The last finite voltage sample, for the crossings. */
+	double prev_timestamp_;
+	double prev_voltage_;
+	/** True when the voltage was below the level minus the hysteresis. */
+	bool armed_;
+	double level_;
+	double hysteresis_;
+	/** The weighted sums of the window, see samplekernels::power_sums(). */
+	double sums_[5];
+	/** The start of the sums and of the window, NaN without a crossing. */
+	double sums_start_;
+	double window_start_;
+	uint window_cycles_;
+
+private Q_SLOTS:
+	void on_sample_appended() override;
+
+};
+
+} // namespace channels
+} // namespace sv
+
+#endif // CHANNELS_ACPOWERCHANNEL_HPP
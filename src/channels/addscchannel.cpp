@@ -59,19 +59,20 @@ AddSCChannel::AddSCChannel(
 	digits_ = signal_->digits();
 	decimal_places_ = signal_->decimal_places();
 
-	connect(signal_.get(), SIGNAL(sample_appended()),
-		this, SLOT(on_sample_appended()));
+	add_source_signal(signal_);
 }
 
 void AddSCChannel::on_sample_appended()
 {
-	size_t signal_sample_count = signal_->sample_count();
-	while (next_signal_pos_ < signal_sample_count) {
-		auto sample = signal_->get_sample(next_signal_pos_, false);
-		double time = sample.first;
-		double value = sample.second + constant_;
-		push_sample(value, time);
-		++next_signal_pos_;
+	if (is_suspended())
+		return;
+
+	size_t count;
+	while ((count = read_sample_block(signal_, next_signal_pos_)) > 0) {
+		for (size_t i=0; i<count; ++i) {
+			double value = block_values_[i] + constant_;
+			push_sample(value, block_timestamps_[i]);
+		}
 	}
 }
 
@@ -36,9 +36,11 @@
 #include "src/data/analogtimesignal.hpp"
 #include "src/data/basesignal.hpp"
 #include "src/data/datautil.hpp"
+#include "src/data/sampledecimator.hpp"
 #include "src/devices/basedevice.hpp"
 
 using std::make_pair;
+using std::dynamic_pointer_cast;
 using std::make_shared;
 using std::set;
 using std::shared_ptr;
@@ -61,9 +63,13 @@ BaseChannel::BaseChannel(
 	parent_device_(parent_device),
 	channel_group_names_(channel_group_names),
 	fixed_signal_(false),
+	decimation_mode_(data::DecimationMode::Off),
+	decimation_factor_(1),
+	decimation_tolerance_(0.),
 	actual_signal_(nullptr)
 {
 	name_ = (sr_channel_) ? sr_channel_->name() : "";
+	display_name_ = QString::fromStdString(name_);
 
 	qWarning() << "Init channel " << QString::fromStdString(name_)
 		<< ", channel_start_timestamp = "
@@ -92,12 +98,13 @@ void BaseChannel::set_name(const string &name)
 		sr_channel_->set_name(name);
 
 	name_ = name;
+	display_name_ = QString::fromStdString(name_);
 	Q_EMIT name_changed(name);
 }
 
 QString BaseChannel::display_name() const
 {
-	return QString::fromStdString(name_);
+	return display_name_;
 }
 
 unsigned int BaseChannel::index() const
@@ -167,6 +174,9 @@ void BaseChannel::add_signal(shared_ptr<data::AnalogTimeSignal> signal)
 
 	connect(this, SIGNAL(channel_start_timestamp_changed(double)),
 			signal.get(), SLOT(on_channel_start_timestamp_changed(double)));
+	if (decimation_mode_ != data::DecimationMode::Off)
+		signal->set_decimation(decimation_mode_, decimation_factor_,
+			decimation_tolerance_);
 
 	measured_quantity_t mq = make_pair(
 		signal->quantity(), signal->quantity_flags());
@@ -206,8 +216,8 @@ shared_ptr<data::BaseSignal> BaseChannel::actual_signal()
 	return actual_signal_;
 }
 
-map<measured_quantity_t, vector<shared_ptr<data::BaseSignal>>>
-	BaseChannel::signal_map()
+const map<measured_quantity_t, vector<shared_ptr<data::BaseSignal>>> &
+	BaseChannel::signal_map() const
 {
 	return signal_map_;
 }
@@ -222,6 +232,57 @@ vector<shared_ptr<data::BaseSignal>> BaseChannel::signals()
 	return signals;
 }
 
+size_t BaseChannel::memory_size() const
+{
+	size_t size = 0;
+	for (const auto &signal_pair : signal_map_) {
+		for (const auto &signal : signal_pair.second)
+			size += signal->memory_size();
+	}
+	return size;
+}
+
+size_t BaseChannel::spilled_size() const
+{
+	size_t size = 0;
+	for (const auto &signal_pair : signal_map_) {
+		for (const auto &signal : signal_pair.second)
+			size += signal->spilled_size();
+	}
+	return size;
+}
+
+void BaseChannel::set_decimation(data::DecimationMode mode, size_t factor,
+	double tolerance)
+{
+	decimation_mode_ = mode;
+	decimation_factor_ = factor > 0 ? factor : 1;
+	decimation_tolerance_ = tolerance;
+	for (const auto &signal_pair : signal_map_) {
+		for (const auto &signal : signal_pair.second) {
+			auto a_signal = dynamic_pointer_cast<data::AnalogTimeSignal>(signal);
+			if (a_signal)
+				a_signal->set_decimation(decimation_mode_, decimation_factor_,
+					decimation_tolerance_);
+		}
+	}
+}
+
+data::DecimationMode BaseChannel::decimation_mode() const
+{
+	return decimation_mode_;
+}
+
+size_t BaseChannel::decimation_factor() const
+{
+	return decimation_factor_;
+}
+
+double BaseChannel::decimation_tolerance() const
+{
+	return decimation_tolerance_;
+}
+
 void BaseChannel::clear_signals()
 {
 	/* TODO
@@ -32,6 +32,7 @@
 #include <QString>
 
 #include "src/data/datautil.hpp"
+#include "src/data/sampledecimator.hpp"
 
 using std::map;
 using std::set;
@@ -182,7 +183,8 @@ public:
 	 * has one corresponding signal, but for user channels this can be
 	 * different.
 	 */
-	map<measured_quantity_t, vector<shared_ptr<data::BaseSignal>>> signal_map();
+	const map<measured_quantity_t, vector<shared_ptr<data::BaseSignal>>> &
+		signal_map() const;
 
 	/**
 	 * Get all signals for this channel.
@@ -190,6 +192,24 @@ public:
 	 */
 	vector<shared_ptr<data::BaseSignal>> signals();
 
+	/**
+	 * Return the number of bytes, that are used by all signals of this
+	 * channel in memory (memory_size()) and in spill files (spilled_size()).
+	 */
+	size_t memory_size() const;
+	size_t spilled_size() const;
+
+	/**
+	 * Set the ingest decimation for all analog time signals of this channel,
+	 * including the signals, that are added later. See
+	 * AnalogTimeSignal::set_decimation().
+	 */
+	void set_decimation(data::DecimationMode mode, size_t factor,
+		double tolerance = 0.);
+	data::DecimationMode decimation_mode() const;
+	size_t decimation_factor() const;
+	double decimation_tolerance() const;
+
 	/**
 	 * Delete all signals from this channel
 	 */
@@ -205,6 +225,8 @@ protected:
 	shared_ptr<sigrok::Channel> sr_channel_;
 	/** Name of this channel. */
 	string name_;
+	/** name_ as QString, must be set together with name_. */
+	QString display_name_;
 	/** Index of this channel. */
 	unsigned int index_;
 	/** Type of this channel. */
@@ -218,6 +240,9 @@ protected:
 	set<string> channel_group_names_;
 
 	bool fixed_signal_;
+	data::DecimationMode decimation_mode_;
+	size_t decimation_factor_;
+	double decimation_tolerance_;
 	shared_ptr<data::BaseSignal> actual_signal_;
 	map<measured_quantity_t, vector<shared_ptr<data::BaseSignal>>> signal_map_;
 
@@ -0,0 +1,99 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+
+#include <QDebug>
+
+#include "calibrationchannel.hpp"
+#include "src/channels/basechannel.hpp"
+#include "src/channels/mathchannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/calibrationcurve.hpp"
+#include "src/data/datautil.hpp"
+#include "src/devices/basedevice.hpp"
+
+using std::lock_guard;
+using std::set;
+using std::string;
+
+namespace sv {
+namespace channels {
+
+CalibrationChannel::CalibrationChannel(
+		data::Quantity quantity,
+		const set<data::QuantityFlag> &quantity_flags,
+		data::Unit unit,
+		shared_ptr<data::AnalogTimeSignal> signal,
+		shared_ptr<data::CalibrationCurve> curve,
+		shared_ptr<devices::BaseDevice> parent_device,
+		const set<string> &channel_group_names,
+		const string &channel_name,
+		double channel_start_timestamp) :
+	MathChannel(quantity, quantity_flags, unit,
+		parent_device, channel_group_names, channel_name,
+		channel_start_timestamp),
+	signal_(signal),
+	curve_(curve),
+	next_signal_pos_(0)
+{
+	assert(signal_);
+	assert(curve_);
+
+	digits_ = signal_->digits();
+	decimal_places_ = signal_->decimal_places();
+
+	add_source_signal(signal_);
+}
+
+void CalibrationChannel::set_curve(shared_ptr<data::CalibrationCurve> curve)
+{
+	if (!curve)
+		return;
+
+	lock_guard<mutex> lock(sample_append_mutex_);
+	curve_ = curve;
+}
+
+shared_ptr<data::CalibrationCurve> CalibrationChannel::curve() const
+{
+	lock_guard<mutex> lock(sample_append_mutex_);
+	return curve_;
+}
+
+void CalibrationChannel::on_sample_appended()
+{
+	if (is_suspended())
+		return;
+
+	lock_guard<mutex> lock(sample_append_mutex_);
+
+	size_t count;
+	while ((count = read_sample_block(signal_, next_signal_pos_)) > 0) {
+		curve_->apply(block_values_.data(), count, block_results_.data());
+		push_samples(block_results_.data(), block_timestamps_.data(), count);
+	}
+}
+
+} // namespace channels
+} // namespace sv
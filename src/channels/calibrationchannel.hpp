@@ -0,0 +1,97 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CHANNELS_CALIBRATIONCHANNEL_HPP
+#define CHANNELS_CALIBRATIONCHANNEL_HPP
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+
+#include <QObject>
+
+#include "src/channels/basechannel.hpp"
+#include "src/channels/mathchannel.hpp"
+#include "src/data/datautil.hpp"
+
+using std::mutex;
+using std::set;
+using std::shared_ptr;
+using std::string;
+
+namespace sv {
+
+namespace data {
+class AnalogTimeSignal;
+class CalibrationCurve;
+}
+
+namespace devices {
+class BaseDevice;
+}
+
+namespace channels {
+
+/**
+ * A signal, that is linearised with a calibration curve (polynomial or
+ * lookup table, see data::CalibrationCurve), e.g. the temperature of a
+ * thermocouple from its voltage. Like MultiplySFChannel and AddSCChannel,
+ * but with a real calibration curve. The samples are calibrated in blocks.
+ */
+class CalibrationChannel : public MathChannel
+{
+	Q_OBJECT
+
+public:
+	CalibrationChannel(
+		data::Quantity quantity,
+		const set<data::QuantityFlag> &quantity_flags,
+		data::Unit unit,
+		shared_ptr<data::AnalogTimeSignal> signal,
+		shared_ptr<data::CalibrationCurve> curve,
+		shared_ptr<devices::BaseDevice> parent_device,
+		const set<string> &channel_group_names,
+		const string &channel_name,
+		double channel_start_timestamp);
+
+	/**
+	 * Replace the calibration curve, e.g. after a recalibration. The curve
+	 * is used for the following samples.
+	 */
+	void set_curve(shared_ptr<data::CalibrationCurve> curve);
+	shared_ptr<data::CalibrationCurve> curve() const;
+
+private:
+	shared_ptr<data::AnalogTimeSignal> signal_;
+	shared_ptr<data::CalibrationCurve> curve_;
+	size_t next_signal_pos_;
+	/** Guards curve_. */
+	mutable mutex sample_append_mutex_;
+
+private Q_SLOTS:
+	void on_sample_appended() override;
+
+};
+
+} // namespace channels
+} // namespace sv
+
+#endif // CHANNELS_CALIBRATIONCHANNEL_HPP
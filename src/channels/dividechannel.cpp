@@ -22,6 +22,7 @@
 #include <mutex>
 #include <set>
 #include <string>
+#include <vector>
 
 #include <QDebug>
 
@@ -30,13 +31,14 @@
 #include "src/channels/mathchannel.hpp"
 #include "src/data/analogtimesignal.hpp"
 #include "src/data/datautil.hpp"
+#include "src/data/signalcombinecache.hpp"
 #include "src/devices/basedevice.hpp"
 
 using std::lock_guard;
-using std::make_shared;
 using std::mutex;
 using std::set;
 using std::string;
+using std::vector;
 
 namespace sv {
 namespace channels {
@@ -56,8 +58,8 @@ DivideChannel::DivideChannel(
 		channel_start_timestamp),
 	dividend_signal_(dividend_signal),
 	divisor_signal_(divisor_signal),
-	dividend_signal_pos_(0),
-	divisor_signal_pos_(0)
+	combine_cursor_({ dividend_signal, divisor_signal }),
+	divisor_signal_values_(sample_block_size_)
 {
 	assert(dividend_signal_);
 	assert(divisor_signal_);
@@ -72,38 +74,39 @@ DivideChannel::DivideChannel(
 	else
 		decimal_places_ = divisor_signal->decimal_places();
 
-	connect(dividend_signal_.get(), SIGNAL(sample_appended()),
-		this, SLOT(on_sample_appended()));
-	connect(divisor_signal_.get(), SIGNAL(sample_appended()),
-		this, SLOT(on_sample_appended()));
+	add_source_signal(dividend_signal_);
+	add_source_signal(divisor_signal_);
 }
 
 void DivideChannel::on_sample_appended()
 {
-	lock_guard<mutex> lock(sample_append_mutex_);
-
-	shared_ptr<vector<double>> time = make_shared<vector<double>>();
-	shared_ptr<vector<double>> dividend_data = make_shared<vector<double>>();
-	shared_ptr<vector<double>> divisor_data = make_shared<vector<double>>();
+	if (is_suspended())
+		return;
 
-	sv::data::AnalogTimeSignal::combine_signals(
-		dividend_signal_, dividend_signal_pos_,
-		divisor_signal_, divisor_signal_pos_,
-		time, dividend_data, divisor_data);
+	lock_guard<mutex> lock(sample_append_mutex_);
 
-	for (size_t i=0; i<time->size(); i++) {
-		// Division
-		double value;
-		if (divisor_data->at(i) == 0) {
-			if (dividend_data->at(i) > 0)
-				value = std::numeric_limits<double>::max();
-			else
-				value = std::numeric_limits<double>::lowest();
-		}
-		else {
-			value = dividend_data->at(i) / divisor_data->at(i);
+	double *values[] = {
+		block_values_.data(), divisor_signal_values_.data() };
+	size_t count;
+	while ((count = combine_cursor_.combine(sample_block_size_,
+			block_timestamps_.data(), values)) > 0) {
+		for (size_t i=0; i<count; i++) {
+			// Division
+			const double dividend = block_values_[i];
+			const double divisor = divisor_signal_values_[i];
+			double value;
+			if (divisor == 0) {
+				if (dividend > 0)
+					value = std::numeric_limits<double>::max();
+				else
+					value = std::numeric_limits<double>::lowest();
+			}
+			else {
+				value = dividend / divisor;
+			}
+			block_results_[i] = value;
 		}
-		push_sample(value, time->at(i));
+		push_samples(block_results_.data(), block_timestamps_.data(), count);
 	}
 }
 
@@ -24,17 +24,20 @@
 #include <mutex>
 #include <set>
 #include <string>
+#include <vector>
 
 #include <QObject>
 
 #include "src/channels/basechannel.hpp"
 #include "src/channels/mathchannel.hpp"
 #include "src/data/datautil.hpp"
+#include "src/data/signalcombinecache.hpp"
 
 using std::mutex;
 using std::set;
 using std::shared_ptr;
 using std::string;
+using std::vector;
 
 namespace sv {
 
@@ -67,12 +70,16 @@ public:
 private:
 	shared_ptr<data::AnalogTimeSignal> dividend_signal_;
 	shared_ptr<data::AnalogTimeSignal> divisor_signal_;
-	size_t dividend_signal_pos_;
-	size_t divisor_signal_pos_;
+	data::SignalCombineCursor combine_cursor_;
+	/**
+	 * The combined values of divisor_signal_, the combined values of
+	 * dividend_signal_ are in block_values_.
+	 */
+	vector<double> divisor_signal_values_;
 	mutex sample_append_mutex_;
 
 private Q_SLOTS:
-	void on_sample_appended();
+	void on_sample_appended() override;
 
 };
 
@@ -0,0 +1,130 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <QDebug>
+
+#include "emachannel.hpp"
+#include "src/channels/basechannel.hpp"
+#include "src/channels/mathchannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/datautil.hpp"
+#include "src/devices/basedevice.hpp"
+
+using std::set;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace channels {
+
+EmaChannel::EmaChannel(
+		data::Quantity quantity,
+		const set<data::QuantityFlag> &quantity_flags,
+		data::Unit unit,
+		shared_ptr<data::AnalogTimeSignal> signal,
+		double time_constant,
+		shared_ptr<devices::BaseDevice> parent_device,
+		const set<string> &channel_group_names,
+		const string &channel_name,
+		double channel_start_timestamp) :
+	MathChannel(quantity, quantity_flags, unit,
+		parent_device, channel_group_names, channel_name,
+		channel_start_timestamp),
+	signal_(signal),
+	time_constant_(time_constant),
+	next_signal_pos_(0),
+	has_value_(false),
+	last_timestamp_(0.),
+	value_(0.)
+{
+	assert(signal_);
+	assert(time_constant_ > 0);
+
+	digits_ = signal_->digits();
+	decimal_places_ = signal_->decimal_places();
+
+	add_source_signal(signal_);
+}
+
+double EmaChannel::time_constant() const
+{
+	return time_constant_;
+}
+
+vector<double> EmaChannel::state() const
+{
+	return vector<double>{ has_value_ ? 1. : 0., last_timestamp_, value_ };
+}
+
+bool EmaChannel::restore_state(const vector<double> &state)
+{
+	if (state.size() != 3)
+		return false;
+
+	has_value_ = state[0] != 0.;
+	last_timestamp_ = state[1];
+	value_ = state[2];
+	return true;
+}
+
+void EmaChannel::on_sample_appended()
+{
+	if (is_suspended())
+		return;
+
+	size_t count;
+	while ((count = read_sample_block(signal_, next_signal_pos_)) > 0) {
+		size_t result_count = 0;
+		for (size_t i=0; i<count; ++i) {
+			const double timestamp = block_timestamps_[i];
+			const double value = block_values_[i];
+			// A NaN or an overflow would stay in the average forever
+			if (!std::isfinite(value))
+				continue;
+
+			if (!has_value_) {
+				// The first sample initializes the average
+				value_ = value;
+				has_value_ = true;
+			}
+			else if (timestamp > last_timestamp_) {
+				const double alpha =
+					1. - std::exp(-(timestamp - last_timestamp_) / time_constant_);
+				value_ += alpha * (value - value_);
+			}
+			last_timestamp_ = timestamp;
+			block_timestamps_[result_count] = timestamp;
+			block_results_[result_count] = value_;
+			++result_count;
+		}
+		push_samples(block_results_.data(), block_timestamps_.data(),
+			result_count);
+	}
+}
+
+} // namespace channels
+} // namespace sv
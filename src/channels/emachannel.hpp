@@ -0,0 +1,97 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CHANNELS_EMACHANNEL_HPP
+#define CHANNELS_EMACHANNEL_HPP
+
+#include <cstddef>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <QObject>
+
+#include "src/channels/basechannel.hpp"
+#include "src/channels/mathchannel.hpp"
+#include "src/data/datautil.hpp"
+
+using std::set;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+
+namespace data {
+class AnalogTimeSignal;
+}
+
+namespace devices {
+class BaseDevice;
+}
+
+namespace channels {
+
+/**
+ * The exponential moving average of a signal. The weight of a sample is
+ * calculated from its distance to the previous sample, so the time constant
+ * is independent of the samplerate and irregular samples are weighted
+ * correctly. Non-finite samples (NaN, overflow) are skipped.
+ */
+class EmaChannel : public MathChannel
+{
+	Q_OBJECT
+
+public:
+	EmaChannel(
+		data::Quantity quantity,
+		const set<data::QuantityFlag> &quantity_flags,
+		data::Unit unit,
+		shared_ptr<data::AnalogTimeSignal> signal,
+		double time_constant,
+		shared_ptr<devices::BaseDevice> parent_device,
+		const set<string> &channel_group_names,
+		const string &channel_name,
+		double channel_start_timestamp);
+
+	/** The time constant in seconds. */
+	double time_constant() const;
+
+protected:
+	vector<double> state() const override;
+	bool restore_state(const vector<double> &state) override;
+
+private:
+	shared_ptr<data::AnalogTimeSignal> signal_;
+	double time_constant_;
+	size_t next_signal_pos_;
+	bool has_value_;
+	double last_timestamp_;
+	double value_;
+
+private Q_SLOTS:
+	void on_sample_appended() override;
+
+};
+
+} // namespace channels
+} // namespace sv
+
+#endif // CHANNELS_EMACHANNEL_HPP
@@ -0,0 +1,115 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <QDebug>
+
+#include "expressionchannel.hpp"
+#include "src/channels/basechannel.hpp"
+#include "src/channels/mathchannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/datautil.hpp"
+#include "src/data/expression.hpp"
+#include "src/data/signalcombinecache.hpp"
+#include "src/devices/basedevice.hpp"
+
+using std::lock_guard;
+using std::mutex;
+using std::set;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace channels {
+
+ExpressionChannel::ExpressionChannel(
+		data::Quantity quantity,
+		const set<data::QuantityFlag> &quantity_flags,
+		data::Unit unit,
+		const vector<shared_ptr<data::AnalogTimeSignal>> &signals,
+		const string &expression,
+		shared_ptr<devices::BaseDevice> parent_device,
+		const set<string> &channel_group_names,
+		const string &channel_name,
+		double channel_start_timestamp) :
+	MathChannel(quantity, quantity_flags, unit,
+		parent_device, channel_group_names, channel_name,
+		channel_start_timestamp),
+	signals_(signals),
+	combine_cursor_(signals),
+	data_(signals.size(), vector<double>(sample_block_size_)),
+	data_ptrs_(signals.size(), nullptr),
+	variables_(signals.size(), nullptr)
+{
+	assert(!signals_.empty());
+
+	for (size_t i = 0; i < data_.size(); ++i) {
+		data_ptrs_[i] = data_[i].data();
+		variables_[i] = data_[i].data();
+	}
+
+	if (!expression_.compile(expression, signals_.size())) {
+		qWarning() << "ExpressionChannel::ExpressionChannel(): " <<
+			QString::fromStdString(expression_.error());
+	}
+
+	digits_ = 0;
+	decimal_places_ = 0;
+	for (const auto &signal : signals_) {
+		assert(signal);
+		digits_ = std::max(digits_, signal->digits());
+		decimal_places_ = std::max(decimal_places_, signal->decimal_places());
+
+		add_source_signal(signal);
+	}
+}
+
+string ExpressionChannel::expression() const
+{
+	return expression_.formula();
+}
+
+void ExpressionChannel::on_sample_appended()
+{
+	if (is_suspended())
+		return;
+
+	lock_guard<mutex> lock(sample_append_mutex_);
+
+	if (!expression_.is_valid())
+		return;
+
+	size_t count;
+	while ((count = combine_cursor_.combine(sample_block_size_,
+			block_timestamps_.data(), data_ptrs_.data())) > 0) {
+		expression_.evaluate(variables_, count, block_results_.data());
+		push_samples(block_results_.data(), block_timestamps_.data(), count);
+	}
+}
+
+} // namespace channels
+} // namespace sv
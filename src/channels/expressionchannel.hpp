@@ -0,0 +1,104 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CHANNELS_EXPRESSIONCHANNEL_HPP
+#define CHANNELS_EXPRESSIONCHANNEL_HPP
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <QObject>
+
+#include "src/channels/basechannel.hpp"
+#include "src/channels/mathchannel.hpp"
+#include "src/data/datautil.hpp"
+#include "src/data/expression.hpp"
+#include "src/data/signalcombinecache.hpp"
+
+using std::mutex;
+using std::set;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+
+namespace data {
+class AnalogTimeSignal;
+}
+
+namespace devices {
+class BaseDevice;
+}
+
+namespace channels {
+
+/**
+ * A math channel, that calculates a formula over N signals, e.g.
+ * "(v1 - v2) / 0.1 * 1000". The signals are v1 to vN in the order of the
+ * signals vector, see data::Expression for the syntax.
+ *
+ * The signals are merged with a data::SignalCombiner and the formula is
+ * evaluated over the combined blocks.
+ */
+class ExpressionChannel : public MathChannel
+{
+	Q_OBJECT
+
+public:
+	/**
+	 * The expression must be valid for signals.size() variables, check it
+	 * with data::Expression::compile() first.
+	 */
+	ExpressionChannel(
+		data::Quantity quantity,
+		const set<data::QuantityFlag> &quantity_flags,
+		data::Unit unit,
+		const vector<shared_ptr<data::AnalogTimeSignal>> &signals,
+		const string &expression,
+		shared_ptr<devices::BaseDevice> parent_device,
+		const set<string> &channel_group_names,
+		const string &channel_name,
+		double channel_start_timestamp);
+
+	string expression() const;
+
+private:
+	vector<shared_ptr<data::AnalogTimeSignal>> signals_;
+	data::SignalCombineCursor combine_cursor_;
+	data::Expression expression_;
+	/** One block of combined values per signal. */
+	vector<vector<double>> data_;
+	vector<double *> data_ptrs_;
+	vector<const double *> variables_;
+	mutex sample_append_mutex_;
+
+private Q_SLOTS:
+	void on_sample_appended() override;
+
+};
+
+} // namespace channels
+} // namespace sv
+
+#endif // CHANNELS_EXPRESSIONCHANNEL_HPP
@@ -22,110 +22,161 @@
 #include <set>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include <QDebug>
+#include <QString>
 
 #include <libsigrokcxx/libsigrokcxx.hpp>
 
 #include "hardwarechannel.hpp"
 #include "src/session.hpp"
+#include "src/tracer.hpp"
 #include "src/util.hpp"
 #include "src/channels/basechannel.hpp"
+#include "src/data/analogsegmentsignal.hpp"
 #include "src/data/analogtimesignal.hpp"
 #include "src/data/datautil.hpp"
+#include "src/data/timebase.hpp"
+#include "src/data/valuebuffer.hpp"
 #include "src/devices/basedevice.hpp"
 
 using std::make_pair;
+using std::make_shared;
 using std::set;
 using std::static_pointer_cast;
 using std::string;
-using std::unique_ptr;
 using sv::data::measured_quantity_t;
 
 namespace sv {
 namespace channels {
 
+const size_t HardwareChannel::frame_retention_ = 256;
+
 HardwareChannel::HardwareChannel(
 		shared_ptr<sigrok::Channel> sr_channel,
 		shared_ptr<devices::BaseDevice> parent_device,
 		const set<string> &channel_group_names,
 		double channel_start_timestamp) :
 	BaseChannel(sr_channel, parent_device, channel_group_names,
-		channel_start_timestamp)
+		channel_start_timestamp),
+	meaning_id_(0),
+	frame_capture_(false),
+	frame_signal_(nullptr),
+	frame_digits_(0),
+	frame_decimal_places_(0)
 {
 	assert(sr_channel);
 
 	type_ = ChannelType::AnalogChannel;
 	name_ = sr_channel_->name();
+	display_name_ = QString::fromStdString(name_);
 }
 
-void HardwareChannel::push_interleaved_samples(const float *data,
-	size_t sample_count, size_t stride, double timestamp, uint64_t samplerate,
-	shared_ptr<sigrok::Analog> sr_analog)
+shared_ptr<data::AnalogTimeSignal> HardwareChannel::push_interleaved_samples(
+	const float *data, size_t sample_count, size_t stride, double timestamp,
+	uint64_t samplerate, const AnalogMeaning &meaning,
+	shared_ptr<data::TimeColumn> time_column, bool publish)
 {
+	SV_TRACE_SCOPE("HardwareChannel::push_interleaved_samples");
+
 	//lock_guard<recursive_mutex> lock(mutex_);
 
-	/*
-	 * NOTE: Sometimes the mq is not set (e.g. for the demo driver in
-	 *       sigrok 6.0.0) and mq() just throws an exception, without a
-	 *       possibility to check if mq is set or not.
-	 */
-	data::Quantity quantity;
-	try {
-		quantity = data::datautil::get_quantity(sr_analog->mq());
-	}
-	catch(sigrok::Error &e) {
-		quantity = data::Quantity::Unknown;
+	// In the steady state neither the meaning nor the signal changes
+	if (!actual_signal_ || meaning.id != meaning_id_ ||
+			actual_signal_ != meaning_signal_) {
+		select_signal(meaning, time_column);
+		meaning_id_ = meaning.id;
+		meaning_signal_ = actual_signal_;
 	}
-	set<data::QuantityFlag> quantity_flags =
-		data::datautil::get_quantity_flags(sr_analog->mq_flags());
-
-	if (!actual_signal_ || actual_signal_->quantity() != quantity ||
-		actual_signal_->quantity_flags() != quantity_flags) {
-
-		/* actual_signal_ not set or doesn't match the mq/mqf */
-		measured_quantity_t mq = make_pair(quantity, quantity_flags);
-		size_t signals_count = signal_map_.count(mq);
-		if (signals_count == 0) {
-			data::Unit unit = data::datautil::get_unit(sr_analog->unit());
-			add_signal(quantity, quantity_flags, unit);
-			qWarning() << "HardwareChannel::push_sample_sr_analog(): "
-				<< display_name()
-				<< " - Signal was not found and was therefore created: "
-				<< actual_signal_->display_name();
-		}
-		else if (signals_count > 1) {
-			throw ("More than one signal found for " + name());
-		}
-
-		actual_signal_ = signal_map_[mq][0];
-		Q_EMIT signal_changed(actual_signal_);
+
+	// The samples were converted to float by sigrok::Analog::
+	// get_data_as_float(), independent of the unit size of the packet. The
+	// signal deinterleaves them block wise while storing them.
+	auto signal = static_pointer_cast<data::AnalogTimeSignal>(actual_signal_);
+	signal->push_strided_samples(data, sample_count, stride, timestamp,
+		samplerate, meaning.digits, meaning.decimal_places, publish);
+	return signal;
+}
+
+void HardwareChannel::set_frame_capture(bool frame_capture)
+{
+	frame_capture_ = frame_capture;
+}
+
+bool HardwareChannel::frame_capture() const
+{
+	return frame_capture_;
+}
+
+shared_ptr<data::AnalogSegmentSignal> HardwareChannel::frame_signal() const
+{
+	return std::atomic_load(&frame_signal_);
+}
+
+void HardwareChannel::capture_frame_samples(const float *data,
+	size_t sample_count, size_t stride, double timestamp, uint64_t samplerate,
+	const AnalogMeaning &meaning)
+{
+	SV_TRACE_SCOPE("HardwareChannel::capture_frame_samples");
+
+	auto signal = std::atomic_load(&frame_signal_);
+	if (!signal) {
+		signal = make_shared<data::AnalogSegmentSignal>(
+			meaning.quantity, meaning.quantity_flags, meaning.unit,
+			shared_from_this());
+		// The frame signal isn't seen by the memory budget of the session
+		signal->set_retention_max_frames(frame_retention_);
+		std::atomic_store(&frame_signal_, signal);
+		Q_EMIT frame_signal_added();
 	}
 
-	/*
-	 * Number of significant digits after the decimal point if positive, or
-	 * number of non-significant digits before the decimal point if negative
-	 * (refers to the value we actually read on the wire).
-	 */
-	int digits = 7;
-	int decimal_places = -1;
-	if (sr_analog->digits() >= 0)
-		decimal_places = sr_analog->digits();
-	else
-		digits = -1 * sr_analog->digits(); // TODO
-
-	// Deinterleave the samples and add them
-	unique_ptr<float[]> deint_data(new float[sample_count]);
-	float *deint_data_ptr = deint_data.get();
-	for (size_t i = 0; i < sample_count; i++) {
-		*deint_data_ptr = (float)(*data);
-		deint_data_ptr++;
-		data += stride;
+	// All packets of a frame have the timestamp of the frame begin
+	if (!signal->in_frame())
+		signal->begin_frame(timestamp, samplerate);
+	signal->append_frame_samples(data, sample_count, stride);
+	frame_digits_ = meaning.digits;
+	frame_decimal_places_ = meaning.decimal_places;
+}
+
+void HardwareChannel::end_frame_capture()
+{
+	auto signal = std::atomic_load(&frame_signal_);
+	if (signal && signal->in_frame())
+		signal->end_frame(frame_digits_, frame_decimal_places_);
+}
+
+void HardwareChannel::select_signal(const AnalogMeaning &meaning,
+	shared_ptr<data::TimeColumn> time_column)
+{
+	if (actual_signal_ &&
+			actual_signal_->measured_quantity() == meaning.measured_quantity)
+		return;
+
+	/* actual_signal_ not set or doesn't match the mq/mqf */
+	measured_quantity_t mq =
+		make_pair(meaning.quantity, meaning.quantity_flags);
+	size_t signals_count = signal_map_.count(mq);
+	if (signals_count == 0) {
+		auto signal = static_pointer_cast<data::AnalogTimeSignal>(add_signal(
+			meaning.quantity, meaning.quantity_flags, meaning.unit));
+		// The samples are delivered as float, so don't waste memory.
+		// Values of long running measurements compress very well.
+		signal->set_value_storage(data::ValueStorage::Float32);
+		signal->set_compression(true);
+		if (time_column)
+			signal->set_time_column(time_column);
+		qWarning() << "HardwareChannel::select_signal(): "
+			<< display_name()
+			<< " - Signal was not found and was therefore created: "
+			<< actual_signal_->display_name();
+	}
+	else if (signals_count > 1) {
+		throw ("More than one signal found for " + name());
 	}
 
-	static_pointer_cast<data::AnalogTimeSignal>(actual_signal_)->push_samples(
-		deint_data.get(), sample_count, timestamp, samplerate,
-		sr_analog->unitsize(), digits, decimal_places);
+	actual_signal_ = signal_map_[mq][0];
+	Q_EMIT signal_changed(actual_signal_);
 }
 
 } // namespace channels
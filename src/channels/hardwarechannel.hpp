@@ -20,6 +20,7 @@
 #ifndef CHANNELS_HARDWARECHANNEL_HPP
 #define CHANNELS_HARDWARECHANNEL_HPP
 
+#include <atomic>
 #include <memory>
 #include <set>
 #include <string>
@@ -27,6 +28,7 @@
 #include <QObject>
 
 #include "src/channels/basechannel.hpp"
+#include "src/data/datautil.hpp"
 
 using std::set;
 using std::shared_ptr;
@@ -39,12 +41,37 @@ class Channel;
 
 namespace sv {
 
+namespace data {
+class AnalogSegmentSignal;
+class AnalogTimeSignal;
+class TimeColumn;
+}
+
 namespace devices {
 class BaseDevice;
 }
 
 namespace channels {
 
+/**
+ * The decoded meaning (quantity, flags, unit and digits) of a sigrok::Analog
+ * packet. All channels of a packet share the same meaning, so it is only
+ * decoded once per packet by the device and only re-resolved, when the
+ * packet meaning changes.
+ */
+struct AnalogMeaning
+{
+	data::Quantity quantity;
+	set<data::QuantityFlag> quantity_flags;
+	/** quantity and quantity_flags for the allocation free comparison. */
+	data::MeasuredQuantity measured_quantity;
+	data::Unit unit;
+	int digits;
+	int decimal_places;
+	/** A new id is assigned, whenever the meaning changes. 0 is invalid. */
+	unsigned int id;
+};
+
 class HardwareChannel : public BaseChannel
 {
 	Q_OBJECT
@@ -62,11 +89,78 @@ public:
 
 public:
 	/**
-	 * Add one or more interleaved samples with timestamps to the channel
+	 * Add one or more interleaved samples with timestamps to the channel.
+	 *
+	 * If time_column is set, a newly created signal stores its timestamps
+	 * in that column, that is shared with the other channels of the frame.
+	 * If publish is false, the samples are published later by
+	 * AnalogTimeSignal::publish_samples(), see AnalogTimeSignal::push_samples().
+	 *
+	 * @return The signal, that the samples were pushed to.
+	 */
+	shared_ptr<data::AnalogTimeSignal> push_interleaved_samples(
+		const float *data, size_t sample_count,
+		size_t stride, double timestamp, uint64_t samplerate,
+		const AnalogMeaning &meaning,
+		shared_ptr<data::TimeColumn> time_column = nullptr,
+		bool publish = true);
+
+	/**
+	 * Also store the samples, that are delivered in frames (e.g. by a scope),
+	 * frame by frame in a data::AnalogSegmentSignal. The frame signal is
+	 * created with the first frame after the capture was enabled and is
+	 * never replaced. It is not part of the signal map of the channel.
+	 */
+	void set_frame_capture(bool frame_capture);
+	bool frame_capture() const;
+	/**
+	 * Return the frame signal or nullptr, if no frame was captured yet.
+	 */
+	shared_ptr<data::AnalogSegmentSignal> frame_signal() const;
+
+	/**
+	 * Append the samples of a frame to the frame signal, see
+	 * push_interleaved_samples(). Only called by the ingest thread of the
+	 * device, if frame_capture() is enabled.
 	 */
-	void push_interleaved_samples(const float *data, size_t sample_count,
+	void capture_frame_samples(const float *data, size_t sample_count,
 		size_t stride, double timestamp, uint64_t samplerate,
-		shared_ptr<sigrok::Analog> sr_analog);
+		const AnalogMeaning &meaning);
+	/**
+	 * End the frame in the frame signal. Only called by the ingest thread of
+	 * the device.
+	 */
+	void end_frame_capture();
+
+private:
+	/**
+	 * Select (or create) the signal for the meaning as actual signal.
+	 */
+	void select_signal(const AnalogMeaning &meaning,
+		shared_ptr<data::TimeColumn> time_column);
+
+	/**
+	 * The id of the meaning, that actual_signal_ was selected for. As long
+	 * as the id and actual_signal_ don't change, the signal lookup is
+	 * skipped.
+	 */
+	unsigned int meaning_id_;
+	shared_ptr<data::BaseSignal> meaning_signal_;
+	std::atomic<bool> frame_capture_;
+	/** Written once by the ingest thread, accessed with std::atomic_load(). */
+	shared_ptr<data::AnalogSegmentSignal> frame_signal_;
+	/** The digits of the last captured frame. */
+	int frame_digits_;
+	int frame_decimal_places_;
+	/** The number of frames, that are kept in the frame signal. */
+	static const size_t frame_retention_;
+
+Q_SIGNALS:
+	/**
+	 * The frame signal was created by the first captured frame, see
+	 * frame_signal().
+	 */
+	void frame_signal_added();
 
 };
 
@@ -18,9 +18,11 @@
  */
 
 #include <cassert>
+#include <cmath>
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 #include <QDebug>
 
@@ -33,6 +35,7 @@
 
 using std::set;
 using std::string;
+using std::vector;
 
 namespace sv {
 namespace channels {
@@ -42,6 +45,7 @@ IntegrateChannel::IntegrateChannel(
 		const set<data::QuantityFlag> &quantity_flags,
 		data::Unit unit,
 		shared_ptr<data::AnalogTimeSignal> int_signal,
+		IntegrationMethod method,
 		shared_ptr<devices::BaseDevice> parent_device,
 		const set<string> &channel_group_names,
 		const string &channel_name,
@@ -50,9 +54,16 @@ IntegrateChannel::IntegrateChannel(
 		parent_device, channel_group_names, channel_name,
 		channel_start_timestamp),
 	int_signal_(int_signal),
+	method_(method),
 	next_int_signal_pos_(0),
 	last_timestamp_(channel_start_timestamp),
-	last_value_(0.)
+	last_value_(0.),
+	has_last_sample_(false),
+	panel_timestamp_(0.),
+	panel_value_(0.),
+	panel_open_(false),
+	sum_(0.),
+	sum_compensation_(0.)
 {
 	assert(int_signal_);
 
@@ -61,8 +72,7 @@ IntegrateChannel::IntegrateChannel(
 
 	connect(this, SIGNAL(channel_start_timestamp_changed(double)),
 		this, SLOT(on_channel_start_timestamp_changed(double)));
-	connect(int_signal_.get(), SIGNAL(sample_appended()),
-		this, SLOT(on_sample_appended()));
+	add_source_signal(int_signal_);
 }
 
 void IntegrateChannel::on_channel_start_timestamp_changed(double timestamp)
@@ -72,21 +82,109 @@ void IntegrateChannel::on_channel_start_timestamp_changed(double timestamp)
 		last_timestamp_ = timestamp;
 }
 
+IntegrationMethod IntegrateChannel::method() const
+{
+	return method_;
+}
+
+vector<double> IntegrateChannel::state() const
+{
+	return vector<double>{ last_timestamp_, last_value_,
+		has_last_sample_ ? 1. : 0., panel_timestamp_, panel_value_,
+		panel_open_ ? 1. : 0., sum_, sum_compensation_ };
+}
+
+bool IntegrateChannel::restore_state(const vector<double> &state)
+{
+	if (state.size() != 8)
+		return false;
+
+	last_timestamp_ = state[0];
+	last_value_ = state[1];
+	has_last_sample_ = state[2] != 0.;
+	panel_timestamp_ = state[3];
+	panel_value_ = state[4];
+	panel_open_ = state[5] != 0.;
+	sum_ = state[6];
+	sum_compensation_ = state[7];
+	return true;
+}
+
+void IntegrateChannel::add_to_sum(double area)
+{
+	const double sum = sum_ + area;
+	if (std::abs(sum_) >= std::abs(area))
+		sum_compensation_ += (sum_ - sum) + area;
+	else
+		sum_compensation_ += (area - sum) + sum_;
+	sum_ = sum;
+}
+
+double IntegrateChannel::integral(double pending_area) const
+{
+	return (sum_ + (sum_compensation_ + pending_area)) / (double)3600;
+}
+
 void IntegrateChannel::on_sample_appended()
 {
-	// Integrate
-	size_t int_signal_sample_count = int_signal_->sample_count();
-	while (next_int_signal_pos_ < int_signal_sample_count) {
-		auto sample = int_signal_->get_sample(next_int_signal_pos_, false);
-		double time = sample.first;
-		double elapsed_time_hours = (time - last_timestamp_) / (double)3600;
-		double value = last_value_ + (sample.second * elapsed_time_hours);
-
-		push_sample(value, time);
-
-		last_timestamp_ = time;
-		last_value_ = value;
-		++next_int_signal_pos_;
+	if (is_suspended())
+		return;
+
+	size_t count;
+	while ((count = read_sample_block(
+			int_signal_, next_int_signal_pos_)) > 0) {
+		size_t result_count = 0;
+		for (size_t i=0; i<count; ++i) {
+			const double time = block_timestamps_[i];
+			const double value = block_values_[i];
+			if (!std::isfinite(value))
+				continue;
+
+			const double elapsed_time = time - last_timestamp_;
+			double pending_area = 0.;
+			if (!has_last_sample_ || method_ == IntegrationMethod::Rectangle) {
+				// The first sample has no predecessor
+				add_to_sum(value * elapsed_time);
+				has_last_sample_ = true;
+			}
+			else if (method_ == IntegrationMethod::Trapezoid) {
+				add_to_sum((last_value_ + value) / 2. * elapsed_time);
+			}
+			else if (!panel_open_) {
+				// The new sample is the middle of the next panel
+				panel_timestamp_ = last_timestamp_;
+				panel_value_ = last_value_;
+				panel_open_ = true;
+				pending_area = (last_value_ + value) / 2. * elapsed_time;
+			}
+			else {
+				const double h0 = last_timestamp_ - panel_timestamp_;
+				const double h1 = elapsed_time;
+				// Simpson's rule for uneven intervals gets unstable, when
+				// the intervals differ too much (e.g. after a pause).
+				if (h0 > 0 && h1 > 0 && h0 <= 2 * h1 && h1 <= 2 * h0) {
+					const double h = h0 + h1;
+					add_to_sum(h / 6. * (
+						(2. - h1 / h0) * panel_value_ +
+						h * h / (h0 * h1) * last_value_ +
+						(2. - h0 / h1) * value));
+				}
+				else {
+					add_to_sum((panel_value_ + last_value_) / 2. * h0);
+					add_to_sum((last_value_ + value) / 2. * h1);
+				}
+				panel_open_ = false;
+			}
+
+			last_timestamp_ = time;
+			last_value_ = value;
+
+			block_timestamps_[result_count] = time;
+			block_results_[result_count] = integral(pending_area);
+			++result_count;
+		}
+		push_samples(block_results_.data(), block_timestamps_.data(),
+			result_count);
 	}
 }
 
@@ -23,6 +23,7 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 #include <QObject>
 
@@ -33,6 +34,7 @@
 using std::set;
 using std::shared_ptr;
 using std::string;
+using std::vector;
 
 namespace sv {
 
@@ -46,6 +48,25 @@ class BaseDevice;
 
 namespace channels {
 
+enum class IntegrationMethod {
+	/** The value of a sample times the time since the previous sample. */
+	Rectangle,
+	/** The mean of two consecutive samples times their distance. */
+	Trapezoid,
+	/**
+	 * Simpson's rule over two intervals, also for uneven intervals. Until a
+	 * pair of intervals is complete, the last interval is a trapezoid.
+	 */
+	Simpson,
+};
+
+/**
+ * The integral of a signal over time (in hours, e.g. for Wh and Ah).
+ *
+ * The integral is accumulated with Neumaier's compensated summation, so
+ * it doesn't drift over a long time at high sample rates. Non finite
+ * samples are skipped.
+ */
 class IntegrateChannel : public MathChannel
 {
 	Q_OBJECT
@@ -56,20 +77,41 @@ public:
 		const set<data::QuantityFlag> &quantity_flags,
 		data::Unit unit,
 		shared_ptr<data::AnalogTimeSignal> int_signal,
+		IntegrationMethod method,
 		shared_ptr<devices::BaseDevice> parent_device,
 		const set<string> &channel_group_names,
 		const string &channel_name,
 		double channel_start_timestamp);
 
+	IntegrationMethod method() const;
+
+protected:
+	vector<double> state() const override;
+	bool restore_state(const vector<double> &state) override;
+
 private:
+	/** Add an area (value * seconds) to the compensated sum. */
+	void add_to_sum(double area);
+	/** Return the integral in hours including the pending area. */
+	double integral(double pending_area) const;
+
 	shared_ptr<data::AnalogTimeSignal> int_signal_;
+	const IntegrationMethod method_;
 	size_t next_int_signal_pos_;
 	double last_timestamp_;
 	double last_value_;
+	bool has_last_sample_;
+	/** The first sample of an open Simpson panel ... */
+	double panel_timestamp_;
+	double panel_value_;
+	/** ... and the last sample is its middle. */
+	bool panel_open_;
+	double sum_;
+	double sum_compensation_;
 
 private Q_SLOTS:
 	void on_channel_start_timestamp_changed(double timestamp);
-	void on_sample_appended();
+	void on_sample_appended() override;
 
 };
 
@@ -17,28 +17,44 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <cassert>
+#include <cstddef>
+#include <limits>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
+#include <vector>
 
 #include <QDebug>
+#include <QString>
+#include <QThread>
 
 #include "mathchannel.hpp"
 #include "src/channels/basechannel.hpp"
+#include "src/data/analogbasesignal.hpp"
 #include "src/data/analogtimesignal.hpp"
 #include "src/data/basesignal.hpp"
 #include "src/data/datautil.hpp"
+#include "src/data/samplebus.hpp"
 #include "src/devices/basedevice.hpp"
+#include "src/tracer.hpp"
 
+using std::dynamic_pointer_cast;
+using std::lock_guard;
+using std::mutex;
 using std::set;
 using std::static_pointer_cast;
 using std::string;
+using std::vector;
 using sv::data::measured_quantity_t;
 
 namespace sv {
 namespace channels {
 
+mutex MathChannel::graph_mutex_;
+
 MathChannel::MathChannel(
 		data::Quantity quantity,
 		const set<data::QuantityFlag> &quantity_flags,
@@ -53,9 +69,17 @@ MathChannel::MathChannel(
 	decimal_places_(-1),
 	quantity_(quantity),
 	quantity_flags_(quantity_flags),
-	unit_(unit)
+	unit_(unit),
+	block_timestamps_(sample_block_size_),
+	block_values_(sample_block_size_),
+	block_results_(sample_block_size_),
+	lazy_(false),
+	observation_connected_(false),
+	observing_sources_(true),
+	resume_timestamp_(-std::numeric_limits<double>::infinity())
 {
 	name_ = channel_name;
+	display_name_ = QString::fromStdString(name_);
 	type_ = ChannelType::MathChannel;
 	index_ = parent_device->next_channel_index();
 	fixed_signal_ = true;
@@ -91,11 +115,259 @@ data::Unit MathChannel::unit()
 	return unit_;
 }
 
+MathChannel::~MathChannel()
+{
+	if (observing_sources_) {
+		for (const auto &signal : source_signals_) {
+			signal->clear_observer_history(this);
+			signal->remove_observer();
+		}
+	}
+}
+
+void MathChannel::set_lazy(bool lazy)
+{
+	if (!actual_signal_) {
+		qWarning() << "MathChannel::set_lazy(): " <<
+			QString::fromStdString(name_) << " has no signal yet";
+		return;
+	}
+
+	lazy_ = lazy;
+	if (!observation_connected_) {
+		connect(actual_signal_.get(), &data::BaseSignal::observed_changed,
+			this, &MathChannel::update_observation);
+		observation_connected_ = true;
+	}
+	// The observation state belongs to the (worker) thread of the channel
+	QMetaObject::invokeMethod(this, "update_observation", Qt::QueuedConnection);
+}
+
+bool MathChannel::is_lazy() const
+{
+	return lazy_;
+}
+
+vector<shared_ptr<MathChannel>> MathChannel::source_channels() const
+{
+	vector<shared_ptr<MathChannel>> channels;
+	for (const auto &signal : source_signals_) {
+		auto channel =
+			dynamic_pointer_cast<MathChannel>(signal->parent_channel());
+		if (channel && std::find(channels.begin(), channels.end(), channel) ==
+				channels.end())
+			channels.push_back(channel);
+	}
+	return channels;
+}
+
+void MathChannel::add_dependent(shared_ptr<MathChannel> dependent)
+{
+	lock_guard<mutex> lock(graph_mutex_);
+	dependents_.push_back(dependent);
+}
+
+vector<double> MathChannel::checkpoint_state(
+	data::RunningStatisticsState &statistics, size_t &end_pos)
+{
+	lock_guard<mutex> lock(state_mutex_);
+	auto signal = static_pointer_cast<data::AnalogTimeSignal>(actual_signal_);
+	statistics = signal->statistics_state(end_pos);
+	return state();
+}
+
+bool MathChannel::resume(const vector<double> &state, double resume_timestamp)
+{
+	lock_guard<mutex> lock(state_mutex_);
+	resume_timestamp_ = resume_timestamp;
+	if (state.empty())
+		return true;
+	if (!restore_state(state)) {
+		qWarning() << "MathChannel::resume(): Invalid state for" <<
+			QString::fromStdString(name_);
+		return false;
+	}
+	return true;
+}
+
+vector<double> MathChannel::state() const
+{
+	return vector<double>();
+}
+
+bool MathChannel::restore_state(const vector<double> &state)
+{
+	return state.empty();
+}
+
+double MathChannel::source_history() const
+{
+	return 0.;
+}
+
+void MathChannel::add_source_signal(shared_ptr<data::AnalogTimeSignal> signal)
+{
+	source_signals_.push_back(signal);
+	source_epochs_.push_back(signal->clear_epoch());
+	if (observing_sources_) {
+		signal->add_observer();
+		signal->set_observer_history(this, source_history());
+	}
+
+	const data::AnalogBaseSignal *source = signal.get();
+	source_subscriptions_.push_back(signal->subscribe_samples(
+		[this, source](size_t, size_t) {
+			on_source_samples_appended(source);
+		},
+		nullptr, data::SampleExecutor::Context, this));
+}
+
+bool MathChannel::is_suspended() const
+{
+	return !observing_sources_;
+}
+
+void MathChannel::update_observation()
+{
+	const bool observe = !lazy_ || actual_signal_->is_observed();
+	if (observe == observing_sources_)
+		return;
+
+	observing_sources_ = observe;
+	for (const auto &signal : source_signals_) {
+		if (observe) {
+			signal->add_observer();
+			signal->set_observer_history(this, source_history());
+		}
+		else {
+			signal->clear_observer_history(this);
+			signal->remove_observer();
+		}
+	}
+
+	// Catch up with the samples, that arrived while suspended
+	if (observe)
+		evaluate();
+}
+
+void MathChannel::collect_dependents(QThread *thread,
+	set<MathChannel *> &visited, vector<shared_ptr<MathChannel>> &post_order)
+{
+	for (const auto &weak_dependent : dependents_) {
+		auto dependent = weak_dependent.lock();
+		if (!dependent || dependent->thread() != thread ||
+				!visited.insert(dependent.get()).second)
+			continue;
+		dependent->collect_dependents(thread, visited, post_order);
+		post_order.push_back(dependent);
+	}
+}
+
+void MathChannel::evaluate()
+{
+	SV_TRACE_SCOPE("MathChannel::evaluate");
+
+	// The reversed post order of a depth first search is a topological order
+	vector<shared_ptr<MathChannel>> post_order;
+	{
+		lock_guard<mutex> lock(graph_mutex_);
+		set<MathChannel *> visited{ this };
+		collect_dependents(thread(), visited, post_order);
+	}
+
+	calculate();
+	for (auto it = post_order.rbegin(); it != post_order.rend(); ++it)
+		(*it)->calculate();
+}
+
+void MathChannel::calculate()
+{
+	lock_guard<mutex> lock(state_mutex_);
+	on_sample_appended();
+}
+
+void MathChannel::on_source_samples_appended(
+	const data::AnalogBaseSignal *source)
+{
+	// The signals of source channels in this thread are already handled by
+	// the evaluation of the source channel.
+	for (const auto &channel : source_channels()) {
+		if (channel->thread() == thread() &&
+				channel->actual_signal().get() == source)
+			return;
+	}
+
+	evaluate();
+}
+
 void MathChannel::push_sample(double sample, double timestamp)
 {
+	// Results of restored samples, see resume()
+	if (timestamp <= resume_timestamp_.load(std::memory_order_relaxed))
+		return;
+
 	auto signal = static_pointer_cast<data::AnalogTimeSignal>(actual_signal_);
-	signal->push_sample(&sample, timestamp,
-		size_of_double_, digits_, decimal_places_);
+	signal->push_sample(sample, timestamp, digits_, decimal_places_);
+}
+
+void MathChannel::push_samples(const double *samples,
+	const double *timestamps, size_t count)
+{
+	const double resume_timestamp =
+		resume_timestamp_.load(std::memory_order_relaxed);
+	while (count > 0 && timestamps[0] <= resume_timestamp) {
+		++samples;
+		++timestamps;
+		--count;
+	}
+	if (count == 0)
+		return;
+
+	auto signal = static_pointer_cast<data::AnalogTimeSignal>(actual_signal_);
+	signal->push_samples(timestamps, samples, count,
+		digits_, decimal_places_);
+}
+
+size_t MathChannel::read_sample_block(
+	shared_ptr<data::AnalogTimeSignal> signal, size_t &pos)
+{
+	for (size_t i = 0; i < source_signals_.size(); ++i) {
+		if (source_signals_[i] != signal)
+			continue;
+		const unsigned int epoch = signal->clear_epoch();
+		if (epoch != source_epochs_[i]) {
+			source_epochs_[i] = epoch;
+			pos = 0;
+		}
+		break;
+	}
+
+	// Skip samples, that were already dropped by the retention policy
+	if (pos < signal->first_sample_pos())
+		pos = signal->first_sample_pos();
+
+	// Source samples up to the resume timestamp were already calculated
+	// before the checkpoint, see resume()
+	const double resume_timestamp =
+		resume_timestamp_.load(std::memory_order_relaxed);
+	while (true) {
+		const size_t count = signal->copy_samples(pos, sample_block_size_,
+			false, block_timestamps_.data(), block_values_.data());
+		pos += count;
+		if (count == 0 || block_timestamps_[0] > resume_timestamp)
+			return count;
+
+		size_t skip = 0;
+		while (skip < count && block_timestamps_[skip] <= resume_timestamp)
+			++skip;
+		if (skip < count) {
+			std::copy(block_timestamps_.begin() + skip,
+				block_timestamps_.begin() + count, block_timestamps_.begin());
+			std::copy(block_values_.begin() + skip,
+				block_values_.begin() + count, block_values_.begin());
+			return count - skip;
+		}
+	}
 }
 
 } // namespace channels
@@ -20,24 +20,35 @@
 #ifndef CHANNELS_MATHCHANNEL_HPP
 #define CHANNELS_MATHCHANNEL_HPP
 
+#include <atomic>
+#include <cstddef>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <vector>
 
 #include <QObject>
 
+class QThread;
+
 #include "src/channels/basechannel.hpp"
 #include "src/data/datautil.hpp"
+#include "src/data/runningstatistics.hpp"
+#include "src/data/samplebus.hpp"
 
 using std::set;
 using std::shared_ptr;
 using std::string;
+using std::unique_ptr;
 using std::vector;
+using std::weak_ptr;
 
 namespace sv {
 
 namespace data {
+class AnalogBaseSignal;
+class AnalogTimeSignal;
 class BaseSignal;
 }
 
@@ -60,6 +71,7 @@ public:
 		const set<string> &channel_group_names,
 		const string &channel_name,
 		double channel_start_timestamp);
+	~MathChannel();
 
 	/**
 	 * Get the quantity of the math channel.
@@ -79,18 +91,173 @@ public:
 	 */
 	data::Unit unit();
 
+	/**
+	 * A lazy math channel only calculates its signal, while the signal is
+	 * observed (see data::BaseSignal::add_observer()), e.g. by a plot or by
+	 * another math channel, that isn't lazy. When it is observed again, the
+	 * samples, that arrived in the meantime and are still retained by the
+	 * source signals, are calculated at once.
+	 *
+	 * This must be set after the channel was added to a device.
+	 */
+	void set_lazy(bool lazy);
+	bool is_lazy() const;
+
+	/**
+	 * Return the math channels, whose signals this channel is calculated
+	 * from.
+	 */
+	vector<shared_ptr<MathChannel>> source_channels() const;
+
+	/**
+	 * Register a math channel, that is calculated from the signal of this
+	 * channel. When both channels are calculated in the same thread, the
+	 * dependent channel is evaluated together with this channel (see
+	 * evaluate()) and not by the notification of the signal.
+	 */
+	void add_dependent(shared_ptr<MathChannel> dependent);
+
+	/**
+	 * Return the state of the calculation for a checkpoint, together with
+	 * the state of the running statistics of the signal and the end
+	 * position of the signal samples, that both belong to. The calculation
+	 * waits meanwhile. See CaptureWriter::write_checkpoint().
+	 */
+	vector<double> checkpoint_state(data::RunningStatisticsState &statistics,
+		size_t &end_pos);
+
+	/**
+	 * Continue the calculation from a checkpoint, after the samples of the
+	 * signal up to resume_timestamp were restored. Source samples up to the
+	 * timestamp are skipped and results up to it are dropped, so nothing is
+	 * calculated twice. This must be called before the channel calculates
+	 * the first samples.
+	 *
+	 * @return false if the state doesn't fit the channel, the calculation
+	 *         then starts with the initial state after the timestamp.
+	 */
+	bool resume(const vector<double> &state, double resume_timestamp);
+
 protected:
+	/**
+	 * Register a signal, that the channel is calculated from. The channel is
+	 * evaluated, when samples are appended to the signal. The source signals
+	 * are observed, as long as the channel is calculated.
+	 */
+	void add_source_signal(shared_ptr<data::AnalogTimeSignal> signal);
+
+	/**
+	 * Return true, if the calculation is suspended, because the channel is
+	 * lazy and not observed.
+	 */
+	bool is_suspended() const;
+
 	/**
 	 * Add a single sample with timestamp to the channel/signal
 	 */
 	void push_sample(double sample, double timestamp);
 
+	/**
+	 * Add count samples with their timestamps to the channel/signal at once
+	 */
+	void push_samples(const double *samples, const double *timestamps,
+		size_t count);
+
+	/**
+	 * Copy the next block of samples from signal, starting at pos, to
+	 * block_timestamps_ and block_values_. Samples, that were already dropped
+	 * by the retention policy, are skipped. pos is advanced behind the block.
+	 * After the source signal was cleared, pos starts again at 0.
+	 *
+	 * @return The number of samples in the block, 0 if there are no more.
+	 */
+	size_t read_sample_block(
+		shared_ptr<data::AnalogTimeSignal> signal, size_t &pos);
+
+	/**
+	 * Return the state of the calculation (e.g. accumulators), that is
+	 * needed to continue it from a checkpoint. The default is no state,
+	 * channels over a window of samples just fill their window again.
+	 */
+	virtual vector<double> state() const;
+	/**
+	 * Restore a state, that was returned by state().
+	 *
+	 * @return false if the state is invalid.
+	 */
+	virtual bool restore_state(const vector<double> &state);
+
+	/**
+	 * Return the history of the source signals in seconds, that this
+	 * channel needs, see data::BaseSignal::set_observer_history(). The
+	 * samples are calculated as they arrive, so the default is 0, channels
+	 * over a time window need the window to fill it again after a resume.
+	 */
+	virtual double source_history() const;
+
 	int digits_;
 	int decimal_places_;
 	data::Quantity quantity_;
 	set<data::QuantityFlag> quantity_flags_;
 	data::Unit unit_;
 
+	/** Number of samples, that are read from a source signal at once. */
+	static const size_t sample_block_size_ = 256;
+	vector<double> block_timestamps_;
+	vector<double> block_values_;
+	/** The results for a block, that are pushed with push_samples(). */
+	vector<double> block_results_;
+
+private:
+	/**
+	 * Calculate the new samples with the state locked, see
+	 * checkpoint_state().
+	 */
+	void calculate();
+	/**
+	 * Calculate this channel and then all dependent channels in this thread
+	 * in topological order, so every channel of the graph is calculated once
+	 * per batch of new samples.
+	 */
+	void evaluate();
+	/**
+	 * Add the dependent channels in thread, that are not yet visited, to
+	 * post_order (depth first). graph_mutex_ must be locked.
+	 */
+	void collect_dependents(QThread *thread, set<MathChannel *> &visited,
+		vector<shared_ptr<MathChannel>> &post_order);
+	/**
+	 * Called in the thread of the channel with the (merged) new samples of
+	 * the source signal source.
+	 */
+	void on_source_samples_appended(const data::AnalogBaseSignal *source);
+
+	/** Protects dependents_ of all math channels. */
+	static std::mutex graph_mutex_;
+
+	/** Held while the channel calculates, see checkpoint_state(). */
+	std::mutex state_mutex_;
+	/** Samples up to this timestamp were restored, see resume(). */
+	std::atomic<double> resume_timestamp_;
+
+	vector<shared_ptr<data::AnalogTimeSignal>> source_signals_;
+	/** The clear epochs of the source signals at the last read. */
+	vector<unsigned int> source_epochs_;
+	vector<unique_ptr<data::SampleBusSubscription>> source_subscriptions_;
+	vector<weak_ptr<MathChannel>> dependents_;
+	std::atomic<bool> lazy_;
+	bool observation_connected_;
+	/** Only changed in the thread of the channel. */
+	bool observing_sources_;
+
+protected Q_SLOTS:
+	/** Calculate the new samples of the source signals. */
+	virtual void on_sample_appended() = 0;
+
+private Q_SLOTS:
+	/** Start or stop the calculation, depending on lazy_ and observers. */
+	void update_observation();
+
 };
 
 } // namespace channels
@@ -0,0 +1,152 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <QDebug>
+
+#include "minmaxholdchannel.hpp"
+#include "src/channels/basechannel.hpp"
+#include "src/channels/mathchannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/datautil.hpp"
+#include "src/devices/basedevice.hpp"
+
+using std::make_pair;
+using std::set;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace channels {
+
+MinMaxHoldChannel::MinMaxHoldChannel(
+		data::Quantity quantity,
+		const set<data::QuantityFlag> &quantity_flags,
+		data::Unit unit,
+		shared_ptr<data::AnalogTimeSignal> signal,
+		MinMaxHoldType type,
+		uint window_sample_count,
+		shared_ptr<devices::BaseDevice> parent_device,
+		const set<string> &channel_group_names,
+		const string &channel_name,
+		double channel_start_timestamp) :
+	MathChannel(quantity, quantity_flags, unit,
+		parent_device, channel_group_names, channel_name,
+		channel_start_timestamp),
+	signal_(signal),
+	type_(type),
+	window_sample_count_(window_sample_count),
+	next_signal_pos_(0),
+	sample_pos_(0)
+{
+	assert(signal_);
+
+	digits_ = signal_->digits();
+	decimal_places_ = signal_->decimal_places();
+
+	add_source_signal(signal_);
+}
+
+MinMaxHoldType MinMaxHoldChannel::type() const
+{
+	return type_;
+}
+
+uint MinMaxHoldChannel::window_sample_count() const
+{
+	return window_sample_count_;
+}
+
+vector<double> MinMaxHoldChannel::state() const
+{
+	// The positions are exact as doubles up to 2^53
+	vector<double> state;
+	state.reserve(1 + 2 * candidates_.size());
+	state.push_back((double)sample_pos_);
+	for (const auto &candidate : candidates_) {
+		state.push_back((double)candidate.first);
+		state.push_back(candidate.second);
+	}
+	return state;
+}
+
+bool MinMaxHoldChannel::restore_state(const vector<double> &state)
+{
+	if (state.empty() || state.size() % 2 != 1)
+		return false;
+
+	sample_pos_ = (size_t)state[0];
+	candidates_.clear();
+	for (size_t i = 1; i < state.size(); i += 2)
+		candidates_.push_back(make_pair((size_t)state[i], state[i + 1]));
+	return true;
+}
+
+bool MinMaxHoldChannel::is_better(double value1, double value2) const
+{
+	if (type_ == MinMaxHoldType::Min)
+		return value1 <= value2;
+	return value1 >= value2;
+}
+
+void MinMaxHoldChannel::on_sample_appended()
+{
+	if (is_suspended())
+		return;
+
+	size_t count;
+	while ((count = read_sample_block(signal_, next_signal_pos_)) > 0) {
+		size_t result_count = 0;
+		for (size_t i=0; i<count; ++i) {
+			const double value = block_values_[i];
+			if (std::isnan(value))
+				continue;
+
+			// Samples, that are beaten by the new sample, can't become the
+			// extreme value any more, as they leave the window first.
+			while (!candidates_.empty() &&
+					is_better(value, candidates_.back().second))
+				candidates_.pop_back();
+			candidates_.push_back(make_pair(sample_pos_, value));
+			if (window_sample_count_ > 0 &&
+					candidates_.front().first + window_sample_count_ <=
+						sample_pos_)
+				candidates_.pop_front();
+			++sample_pos_;
+
+			block_timestamps_[result_count] = block_timestamps_[i];
+			block_results_[result_count] = candidates_.front().second;
+			++result_count;
+		}
+		push_samples(block_results_.data(), block_timestamps_.data(),
+			result_count);
+	}
+}
+
+} // namespace channels
+} // namespace sv
@@ -0,0 +1,118 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CHANNELS_MINMAXHOLDCHANNEL_HPP
+#define CHANNELS_MINMAXHOLDCHANNEL_HPP
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <QObject>
+
+#include "src/channels/basechannel.hpp"
+#include "src/channels/mathchannel.hpp"
+#include "src/data/datautil.hpp"
+
+using std::deque;
+using std::pair;
+using std::set;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+
+namespace data {
+class AnalogTimeSignal;
+}
+
+namespace devices {
+class BaseDevice;
+}
+
+namespace channels {
+
+enum class MinMaxHoldType {
+	Min,
+	Max,
+};
+
+/**
+ * The minimum or maximum of the last window_sample_count samples of a
+ * signal, or of all samples since the channel was created (hold).
+ *
+ * The candidates of the window are kept in a monotonic deque, so a new
+ * sample costs O(1) amortized. NaN samples are skipped.
+ */
+class MinMaxHoldChannel : public MathChannel
+{
+	Q_OBJECT
+
+public:
+	MinMaxHoldChannel(
+		data::Quantity quantity,
+		const set<data::QuantityFlag> &quantity_flags,
+		data::Unit unit,
+		shared_ptr<data::AnalogTimeSignal> signal,
+		MinMaxHoldType type,
+		uint window_sample_count,
+		shared_ptr<devices::BaseDevice> parent_device,
+		const set<string> &channel_group_names,
+		const string &channel_name,
+		double channel_start_timestamp);
+
+	MinMaxHoldType type() const;
+	/** The number of samples in the window, 0 holds forever. */
+	uint window_sample_count() const;
+
+protected:
+	vector<double> state() const override;
+	bool restore_state(const vector<double> &state) override;
+
+private:
+	/** Return true if value1 replaces value2 as extreme value. */
+	bool is_better(double value1, double value2) const;
+
+	shared_ptr<data::AnalogTimeSignal> signal_;
+	MinMaxHoldType type_;
+	uint window_sample_count_;
+	size_t next_signal_pos_;
+
+	/**
+	 * The positions and values of the samples, that can still become the
+	 * extreme value of the window. The values are monotonic, the front is
+	 * the extreme value.
+	 */
+	deque<pair<size_t, double>> candidates_;
+	size_t sample_pos_;
+
+private Q_SLOTS:
+	void on_sample_appended() override;
+
+};
+
+} // namespace channels
+} // namespace sv
+
+#endif // CHANNELS_MINMAXHOLDCHANNEL_HPP
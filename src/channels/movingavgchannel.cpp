@@ -17,10 +17,14 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <cstddef>
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 #include <QDebug>
 
@@ -33,16 +37,27 @@
 
 using std::set;
 using std::string;
+using std::vector;
 
 namespace sv {
 namespace channels {
 
+namespace {
+
+/** The initial capacity of the ring buffer of a time window. */
+const size_t initial_window_capacity = 256;
+/** The minimum number of removals between two renormalizations. */
+const size_t min_renormalize_interval = 1024;
+
+}
+
 MovingAvgChannel::MovingAvgChannel(
 		data::Quantity quantity,
 		const set<data::QuantityFlag> &quantity_flags,
 		data::Unit unit,
 		shared_ptr<data::AnalogTimeSignal> signal,
 		uint avg_sample_count,
+		double avg_time_span,
 		shared_ptr<devices::BaseDevice> parent_device,
 		const set<string> &channel_group_names,
 		const string &channel_name,
@@ -52,35 +67,136 @@ MovingAvgChannel::MovingAvgChannel(
 		channel_start_timestamp),
 	signal_(signal),
 	avg_sample_count_(avg_sample_count),
-	next_signal_pos_(0)
+	avg_time_span_(avg_time_span),
+	next_signal_pos_(0),
+	window_begin_(0),
+	window_size_(0),
+	sum_(0.),
+	sum_compensation_(0.),
+	removed_count_(0)
 {
 	assert(signal_);
+	assert(avg_sample_count_ > 0 || avg_time_span_ > 0);
 
 	digits_ = signal_->digits();
 	decimal_places_ = signal_->decimal_places();
 
-	// Init (ring) buffer
-	avg_samples_.reserve(avg_sample_count_);
-	for (size_t i=0; i<avg_sample_count_; ++i)
-		avg_samples_[i] = 0;
+	// Init ring buffer. A sample count window has a fixed size, a time
+	// window grows with the samplerate of the signal.
+	size_t capacity = avg_sample_count_;
+	if (avg_time_span_ > 0 &&
+			(capacity == 0 || capacity > initial_window_capacity))
+		capacity = initial_window_capacity;
+	window_timestamps_.resize(capacity, 0.);
+	window_values_.resize(capacity, 0.);
+
+	add_source_signal(signal_);
+}
+
+uint MovingAvgChannel::avg_sample_count() const
+{
+	return avg_sample_count_;
+}
+
+double MovingAvgChannel::avg_time_span() const
+{
+	return avg_time_span_;
+}
+
+double MovingAvgChannel::source_history() const
+{
+	return avg_time_span_;
+}
 
-	connect(signal_.get(), SIGNAL(sample_appended()),
-		this, SLOT(on_sample_appended()));
+void MovingAvgChannel::add_to_sum(double value)
+{
+	const double y = value - sum_compensation_;
+	const double t = sum_ + y;
+	sum_compensation_ = (t - sum_) - y;
+	sum_ = t;
+}
+
+void MovingAvgChannel::remove_oldest()
+{
+	add_to_sum(-window_values_[window_begin_]);
+	window_begin_ = (window_begin_ + 1) % window_values_.size();
+	--window_size_;
+	++removed_count_;
+}
+
+void MovingAvgChannel::renormalize_sum()
+{
+	sum_ = 0.;
+	sum_compensation_ = 0.;
+	for (size_t i = 0; i < window_size_; ++i)
+		add_to_sum(window_values_[(window_begin_ + i) % window_values_.size()]);
+	removed_count_ = 0;
+}
+
+void MovingAvgChannel::grow_window()
+{
+	// Unroll the ring into the new buffer, starting at position 0
+	const size_t capacity = window_values_.size();
+	size_t new_capacity = capacity * 2;
+	if (avg_sample_count_ > 0)
+		new_capacity = std::min(new_capacity, (size_t)avg_sample_count_);
+	vector<double> timestamps(new_capacity, 0.);
+	vector<double> values(new_capacity, 0.);
+	for (size_t i = 0; i < window_size_; ++i) {
+		timestamps[i] = window_timestamps_[(window_begin_ + i) % capacity];
+		values[i] = window_values_[(window_begin_ + i) % capacity];
+	}
+	window_timestamps_.swap(timestamps);
+	window_values_.swap(values);
+	window_begin_ = 0;
 }
 
 void MovingAvgChannel::on_sample_appended()
 {
-	size_t signal_sample_count = signal_->sample_count();
-	while (next_signal_pos_ < signal_sample_count) {
-		auto sample = signal_->get_sample(next_signal_pos_, false);
-		avg_samples_[next_signal_pos_%avg_sample_count_] = sample.second;
-		double value = 0.;
-		for (size_t i=0; i<avg_sample_count_; ++i) {
-			value += avg_samples_[i];
+	if (is_suspended())
+		return;
+
+	size_t count;
+	while ((count = read_sample_block(signal_, next_signal_pos_)) > 0) {
+		size_t result_count = 0;
+		for (size_t i=0; i<count; ++i) {
+			const double timestamp = block_timestamps_[i];
+			// A NaN or an overflow would spoil the running sum
+			if (!std::isfinite(block_values_[i]))
+				continue;
+
+			// Drop the samples, that are older than the time span
+			if (avg_time_span_ > 0) {
+				while (window_size_ > 0 && window_timestamps_[window_begin_] <=
+						timestamp - avg_time_span_)
+					remove_oldest();
+			}
+			// Make room for the new sample
+			if (window_size_ == window_values_.size()) {
+				if (avg_sample_count_ > 0 &&
+						window_size_ >= (size_t)avg_sample_count_)
+					remove_oldest();
+				else
+					grow_window();
+			}
+
+			const size_t end =
+				(window_begin_ + window_size_) % window_values_.size();
+			window_timestamps_[end] = timestamp;
+			window_values_[end] = block_values_[i];
+			++window_size_;
+			add_to_sum(block_values_[i]);
+
+			if (removed_count_ >=
+					std::max(window_size_, min_renormalize_interval))
+				renormalize_sum();
+
+			block_timestamps_[result_count] = timestamp;
+			block_results_[result_count] = sum_ / (double)window_size_;
+			++result_count;
 		}
-		value /= avg_sample_count_;
-		push_sample(value, sample.first);
-		++next_signal_pos_;
+		push_samples(block_results_.data(), block_timestamps_.data(),
+			result_count);
 	}
 }
 
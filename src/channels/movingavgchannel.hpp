@@ -20,9 +20,11 @@
 #ifndef CHANNELS_MOVINGACGCHANNEL_HPP
 #define CHANNELS_MOVINGACGCHANNEL_HPP
 
+#include <cstddef>
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 #include <QObject>
 
@@ -33,6 +35,7 @@
 using std::set;
 using std::shared_ptr;
 using std::string;
+using std::vector;
 
 namespace sv {
 
@@ -46,6 +49,15 @@ class BaseDevice;
 
 namespace channels {
 
+/**
+ * The moving average of a signal over the last avg_sample_count samples
+ * and/or over the samples of the last avg_time_span seconds.
+ *
+ * The samples of the window are kept in a ring buffer and the average is
+ * calculated from a running (compensated) sum, so the cost per sample does
+ * not depend on the window size. Non-finite samples (NaN, overflow) are
+ * skipped.
+ */
 class MovingAvgChannel : public MathChannel
 {
 	Q_OBJECT
@@ -57,19 +69,52 @@ public:
 		data::Unit unit,
 		shared_ptr<data::AnalogTimeSignal> signal,
 		uint avg_sample_count,
+		double avg_time_span,
 		shared_ptr<devices::BaseDevice> parent_device,
 		const set<string> &channel_group_names,
 		const string &channel_name,
 		double channel_start_timestamp);
 
+	/** The maximum number of samples in the window, 0 is unlimited. */
+	uint avg_sample_count() const;
+	/** The time span of the window in seconds, 0 is unlimited. */
+	double avg_time_span() const;
+
+protected:
+	/** The time span of the window. */
+	double source_history() const override;
+
 private:
+	void add_to_sum(double value);
+	void remove_oldest();
+	/** Recalculate the running sum from the samples in the window. */
+	void renormalize_sum();
+	void grow_window();
+
 	shared_ptr<data::AnalogTimeSignal> signal_;
 	uint avg_sample_count_;
-	vector<double> avg_samples_;
+	double avg_time_span_;
 	size_t next_signal_pos_;
 
+	/** Ring buffer with the samples of the window. */
+	vector<double> window_timestamps_;
+	vector<double> window_values_;
+	size_t window_begin_;
+	size_t window_size_;
+
+	/** Kahan sum of the values in the window. */
+	double sum_;
+	double sum_compensation_;
+	/**
+	 * The removals from the running sum since the last renormalization.
+	 * Removing values from a running sum accumulates rounding errors, that
+	 * the compensation can't correct (e.g. after a big outlier has left the
+	 * window), so the sum is recalculated every window length.
+	 */
+	size_t removed_count_;
+
 private Q_SLOTS:
-	void on_sample_appended();
+	void on_sample_appended() override;
 
 };
 
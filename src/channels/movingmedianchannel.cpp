@@ -0,0 +1,155 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <QDebug>
+
+#include "movingmedianchannel.hpp"
+#include "src/channels/basechannel.hpp"
+#include "src/channels/mathchannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/datautil.hpp"
+#include "src/devices/basedevice.hpp"
+
+using std::multiset;
+using std::set;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace channels {
+
+MovingMedianChannel::MovingMedianChannel(
+		data::Quantity quantity,
+		const set<data::QuantityFlag> &quantity_flags,
+		data::Unit unit,
+		shared_ptr<data::AnalogTimeSignal> signal,
+		uint window_sample_count,
+		shared_ptr<devices::BaseDevice> parent_device,
+		const set<string> &channel_group_names,
+		const string &channel_name,
+		double channel_start_timestamp) :
+	MathChannel(quantity, quantity_flags, unit,
+		parent_device, channel_group_names, channel_name,
+		channel_start_timestamp),
+	signal_(signal),
+	window_sample_count_(window_sample_count),
+	next_signal_pos_(0),
+	window_(window_sample_count, 0.),
+	window_begin_(0),
+	window_size_(0)
+{
+	assert(signal_);
+	assert(window_sample_count_ > 0);
+
+	digits_ = signal_->digits();
+	decimal_places_ = signal_->decimal_places();
+
+	add_source_signal(signal_);
+}
+
+uint MovingMedianChannel::window_sample_count() const
+{
+	return window_sample_count_;
+}
+
+void MovingMedianChannel::insert(double value)
+{
+	// The lower half can be empty after the oldest sample was erased
+	bool is_lower;
+	if (!lower_.empty())
+		is_lower = value <= *lower_.rbegin();
+	else
+		is_lower = upper_.empty() || value <= *upper_.begin();
+
+	if (is_lower)
+		lower_.insert(value);
+	else
+		upper_.insert(value);
+}
+
+void MovingMedianChannel::erase(double value)
+{
+	// Erase only one of equal values
+	if (value <= *lower_.rbegin())
+		lower_.erase(lower_.find(value));
+	else
+		upper_.erase(upper_.find(value));
+}
+
+void MovingMedianChannel::rebalance()
+{
+	if (lower_.size() > upper_.size() + 1) {
+		auto it = std::prev(lower_.end());
+		upper_.insert(*it);
+		lower_.erase(it);
+	}
+	else if (upper_.size() > lower_.size()) {
+		auto it = upper_.begin();
+		lower_.insert(*it);
+		upper_.erase(it);
+	}
+}
+
+void MovingMedianChannel::on_sample_appended()
+{
+	if (is_suspended())
+		return;
+
+	size_t count;
+	while ((count = read_sample_block(signal_, next_signal_pos_)) > 0) {
+		size_t result_count = 0;
+		for (size_t i=0; i<count; ++i) {
+			const double value = block_values_[i];
+			if (std::isnan(value))
+				continue;
+
+			if (window_size_ == window_sample_count_) {
+				erase(window_[window_begin_]);
+				window_begin_ = (window_begin_ + 1) % window_sample_count_;
+				--window_size_;
+			}
+			window_[(window_begin_ + window_size_) % window_sample_count_] =
+				value;
+			++window_size_;
+			insert(value);
+			rebalance();
+
+			double median = *lower_.rbegin();
+			if (lower_.size() == upper_.size())
+				median = (median + *upper_.begin()) / 2.;
+			block_timestamps_[result_count] = block_timestamps_[i];
+			block_results_[result_count] = median;
+			++result_count;
+		}
+		push_samples(block_results_.data(), block_timestamps_.data(),
+			result_count);
+	}
+}
+
+} // namespace channels
+} // namespace sv
@@ -0,0 +1,103 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CHANNELS_MOVINGMEDIANCHANNEL_HPP
+#define CHANNELS_MOVINGMEDIANCHANNEL_HPP
+
+#include <cstddef>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <QObject>
+
+#include "src/channels/basechannel.hpp"
+#include "src/channels/mathchannel.hpp"
+#include "src/data/datautil.hpp"
+
+using std::multiset;
+using std::set;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+
+namespace data {
+class AnalogTimeSignal;
+}
+
+namespace devices {
+class BaseDevice;
+}
+
+namespace channels {
+
+/**
+ * The median of the last window_sample_count samples of a signal.
+ *
+ * The window is split into a lower and an upper half (two sorted trees),
+ * so a new sample costs O(log window_sample_count). NaN samples can't be
+ * sorted and are skipped.
+ */
+class MovingMedianChannel : public MathChannel
+{
+	Q_OBJECT
+
+public:
+	MovingMedianChannel(
+		data::Quantity quantity,
+		const set<data::QuantityFlag> &quantity_flags,
+		data::Unit unit,
+		shared_ptr<data::AnalogTimeSignal> signal,
+		uint window_sample_count,
+		shared_ptr<devices::BaseDevice> parent_device,
+		const set<string> &channel_group_names,
+		const string &channel_name,
+		double channel_start_timestamp);
+
+	uint window_sample_count() const;
+
+private:
+	void insert(double value);
+	void erase(double value);
+	/** Keep the lower half equal to or one bigger than the upper half. */
+	void rebalance();
+
+	shared_ptr<data::AnalogTimeSignal> signal_;
+	uint window_sample_count_;
+	size_t next_signal_pos_;
+
+	/** Ring buffer with the samples of the window, in their order. */
+	vector<double> window_;
+	size_t window_begin_;
+	size_t window_size_;
+	multiset<double> lower_;
+	multiset<double> upper_;
+
+private Q_SLOTS:
+	void on_sample_appended() override;
+
+};
+
+} // namespace channels
+} // namespace sv
+
+#endif // CHANNELS_MOVINGMEDIANCHANNEL_HPP
@@ -68,7 +68,7 @@ private:
 	size_t next_signal_pos_;
 
 private Q_SLOTS:
-	void on_sample_appended();
+	void on_sample_appended() override;
 
 };
 
@@ -22,6 +22,7 @@
 #include <mutex>
 #include <set>
 #include <string>
+#include <vector>
 
 #include <QDebug>
 
@@ -30,13 +31,14 @@
 #include "src/channels/mathchannel.hpp"
 #include "src/data/analogtimesignal.hpp"
 #include "src/data/datautil.hpp"
+#include "src/data/signalcombinecache.hpp"
 #include "src/devices/basedevice.hpp"
 
 using std::lock_guard;
-using std::make_shared;
 using std::mutex;
 using std::set;
 using std::string;
+using std::vector;
 
 namespace sv {
 namespace channels {
@@ -56,8 +58,8 @@ MultiplySSChannel::MultiplySSChannel(
 		channel_start_timestamp),
 	signal1_(signal1),
 	signal2_(signal2),
-	signal1_pos_(0),
-	signal2_pos_(0)
+	combine_cursor_({ signal1, signal2 }),
+	signal2_values_(sample_block_size_)
 {
 	assert(signal1_);
 	assert(signal2_);
@@ -72,27 +74,24 @@ MultiplySSChannel::MultiplySSChannel(
 	else
 		decimal_places_ = signal2_->decimal_places();
 
-	connect(signal1_.get(), SIGNAL(sample_appended()),
-		this, SLOT(on_sample_appended()));
-	connect(signal2_.get(), SIGNAL(sample_appended()),
-		this, SLOT(on_sample_appended()));
+	add_source_signal(signal1_);
+	add_source_signal(signal2_);
 }
 
 void MultiplySSChannel::on_sample_appended()
 {
-	lock_guard<mutex> lock(sample_append_mutex_);
-
-	shared_ptr<vector<double>> time = make_shared<vector<double>>();
-	shared_ptr<vector<double>> signal1_data = make_shared<vector<double>>();
-	shared_ptr<vector<double>> signal2_data = make_shared<vector<double>>();
+	if (is_suspended())
+		return;
 
-	sv::data::AnalogTimeSignal::combine_signals(
-		signal1_, signal1_pos_,
-		signal2_, signal2_pos_,
-		time, signal1_data, signal2_data);
+	lock_guard<mutex> lock(sample_append_mutex_);
 
-	for (size_t i=0; i<time->size(); i++) {
-		push_sample(signal1_data->at(i) * signal2_data->at(i), time->at(i));
+	double *values[] = { block_values_.data(), signal2_values_.data() };
+	size_t count;
+	while ((count = combine_cursor_.combine(sample_block_size_,
+			block_timestamps_.data(), values)) > 0) {
+		for (size_t i=0; i<count; i++)
+			block_results_[i] = block_values_[i] * signal2_values_[i];
+		push_samples(block_results_.data(), block_timestamps_.data(), count);
 	}
 }
 
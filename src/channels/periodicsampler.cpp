@@ -0,0 +1,170 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <set>
+#include <thread>
+
+#include <QDebug>
+
+#include "periodicsampler.hpp"
+#include "src/session.hpp"
+#include "src/channels/userchannel.hpp"
+#include "src/data/datautil.hpp"
+
+using std::lock_guard;
+using std::set;
+using std::unique_lock;
+
+namespace sv {
+namespace channels {
+
+PeriodicSampler::PeriodicSampler(UserChannel *channel,
+		read_function_t read_function, double interval,
+		data::Quantity quantity, const set<data::QuantityFlag> &quantity_flags,
+		data::Unit unit, int digits, int decimal_places) :
+	channel_(channel),
+	read_function_(read_function),
+	interval_(std::chrono::nanoseconds((int64_t)(interval * 1e9))),
+	quantity_(quantity),
+	quantity_flags_(quantity_flags),
+	unit_(unit),
+	digits_(digits),
+	decimal_places_(decimal_places),
+	stop_(false),
+	running_(false),
+	sample_count_(0),
+	missed_count_(0),
+	error_count_(0),
+	max_jitter_ns_(0)
+{
+}
+
+PeriodicSampler::~PeriodicSampler()
+{
+	stop();
+}
+
+void PeriodicSampler::start()
+{
+	if (thread_.joinable() || interval_.count() <= 0)
+		return;
+
+	stop_ = false;
+	running_ = true;
+	thread_ = std::thread(&PeriodicSampler::thread_proc, this);
+}
+
+void PeriodicSampler::stop()
+{
+	if (!thread_.joinable())
+		return;
+
+	{
+		lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+	}
+	stop_cond_.notify_one();
+	thread_.join();
+	running_ = false;
+}
+
+bool PeriodicSampler::is_running() const
+{
+	return running_;
+}
+
+double PeriodicSampler::interval() const
+{
+	return (double)interval_.count() / 1e9;
+}
+
+uint64_t PeriodicSampler::sample_count() const
+{
+	return sample_count_;
+}
+
+uint64_t PeriodicSampler::missed_count() const
+{
+	return missed_count_;
+}
+
+uint64_t PeriodicSampler::error_count() const
+{
+	return error_count_;
+}
+
+double PeriodicSampler::max_jitter() const
+{
+	return (double)max_jitter_ns_ / 1e9;
+}
+
+void PeriodicSampler::thread_proc()
+{
+	auto next_time = std::chrono::steady_clock::now();
+	while (true) {
+		{
+			unique_lock<std::mutex> lock(mutex_);
+			if (stop_cond_.wait_until(lock, next_time, [this] { return stop_; }))
+				break;
+		}
+
+		const auto read_time = std::chrono::steady_clock::now();
+		const double timestamp = Session::timestamp();
+		const int64_t jitter_ns = std::chrono::duration_cast<
+			std::chrono::nanoseconds>(read_time - next_time).count();
+		if (jitter_ns > max_jitter_ns_)
+			max_jitter_ns_ = jitter_ns;
+
+		double value;
+		bool ok;
+		try {
+			ok = read_function_(value);
+		}
+		catch (const std::exception &e) {
+			qWarning() << "PeriodicSampler::thread_proc(): " << e.what();
+			ok = false;
+		}
+		if (ok) {
+			channel_->push_sample(value, timestamp, quantity_, quantity_flags_,
+				unit_, digits_, decimal_places_);
+			++sample_count_;
+		}
+		else {
+			++error_count_;
+		}
+
+		// Schedule on the fixed grid. A late sampling time is still sampled,
+		// the times, that were missed completely, are skipped.
+		next_time += interval_;
+		const auto missed =
+			(std::chrono::steady_clock::now() - next_time) / interval_;
+		if (missed > 0) {
+			missed_count_ += (uint64_t)missed;
+			next_time += interval_ * missed;
+		}
+	}
+}
+
+} // namespace channels
+} // namespace sv
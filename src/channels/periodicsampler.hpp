@@ -0,0 +1,117 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CHANNELS_PERIODICSAMPLER_HPP
+#define CHANNELS_PERIODICSAMPLER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <thread>
+
+#include "src/data/datautil.hpp"
+
+using std::set;
+
+namespace sv {
+namespace channels {
+
+class UserChannel;
+
+/**
+ * Samples a value at a fixed rate in a dedicated thread and pushes it to a
+ * user channel, e.g. a config key of a device, that has no acquisition of
+ * its own, or the last value of a signal.
+ *
+ * The sampling times are scheduled on a steady clock, so the interval
+ * doesn't drift. When a read takes longer than the interval, the missed
+ * sampling times are skipped and counted.
+ */
+class PeriodicSampler
+{
+public:
+	/**
+	 * Read the current value. Returns false, if no value is available.
+	 */
+	typedef std::function<bool(double &value)> read_function_t;
+
+	/**
+	 * @param channel The channel, that gets the samples. It owns the sampler.
+	 * @param read_function Reads the value in the sampler thread.
+	 * @param interval The sampling interval in seconds.
+	 */
+	PeriodicSampler(UserChannel *channel, read_function_t read_function,
+		double interval, data::Quantity quantity,
+		const set<data::QuantityFlag> &quantity_flags, data::Unit unit,
+		int digits, int decimal_places);
+	~PeriodicSampler();
+
+	PeriodicSampler(const PeriodicSampler &) = delete;
+	PeriodicSampler &operator=(const PeriodicSampler &) = delete;
+
+	void start();
+	void stop();
+	bool is_running() const;
+
+	/** Return the sampling interval in seconds. */
+	double interval() const;
+	/** Return the number of samples, that were pushed to the channel. */
+	uint64_t sample_count() const;
+	/** Return the number of sampling times, that were skipped. */
+	uint64_t missed_count() const;
+	/** Return the number of reads, that failed. */
+	uint64_t error_count() const;
+	/**
+	 * Return the maximum delay in seconds between the scheduled sampling
+	 * time and the read of the value.
+	 */
+	double max_jitter() const;
+
+private:
+	void thread_proc();
+
+	UserChannel *channel_;
+	const read_function_t read_function_;
+	const std::chrono::nanoseconds interval_;
+	const data::Quantity quantity_;
+	const set<data::QuantityFlag> quantity_flags_;
+	const data::Unit unit_;
+	const int digits_;
+	const int decimal_places_;
+
+	std::thread thread_;
+	std::mutex mutex_;
+	std::condition_variable stop_cond_;
+	bool stop_;
+	std::atomic<bool> running_;
+	std::atomic<uint64_t> sample_count_;
+	std::atomic<uint64_t> missed_count_;
+	std::atomic<uint64_t> error_count_;
+	std::atomic<int64_t> max_jitter_ns_;
+
+};
+
+} // namespace channels
+} // namespace sv
+
+#endif // CHANNELS_PERIODICSAMPLER_HPP
@@ -0,0 +1,153 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <QDebug>
+#include <QString>
+
+#include "pluginchannel.hpp"
+#include "src/channels/basechannel.hpp"
+#include "src/channels/mathchannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/datautil.hpp"
+#include "src/data/signalcombinecache.hpp"
+#include "src/devices/basedevice.hpp"
+#include "src/plugins/smuviewplugin.h"
+
+using std::lock_guard;
+using std::mutex;
+using std::set;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace channels {
+
+PluginChannel::PluginChannel(
+		data::Quantity quantity,
+		const set<data::QuantityFlag> &quantity_flags,
+		data::Unit unit,
+		const vector<shared_ptr<data::AnalogTimeSignal>> &signals,
+		const sv_math_processor *processor,
+		const string &args,
+		shared_ptr<devices::BaseDevice> parent_device,
+		const set<string> &channel_group_names,
+		const string &channel_name,
+		double channel_start_timestamp) :
+	MathChannel(quantity, quantity_flags, unit,
+		parent_device, channel_group_names, channel_name,
+		channel_start_timestamp),
+	signals_(signals),
+	combine_cursor_(signals),
+	processor_(processor),
+	args_(args),
+	instance_(nullptr),
+	failed_(false),
+	data_(signals.size(), vector<double>(sample_block_size_)),
+	data_ptrs_(signals.size(), nullptr),
+	inputs_(signals.size(), nullptr)
+{
+	assert(!signals_.empty());
+	assert(processor_);
+
+	for (size_t i = 0; i < data_.size(); ++i) {
+		data_ptrs_[i] = data_[i].data();
+		inputs_[i] = data_[i].data();
+	}
+
+	if (processor_->input_count == 0 ||
+			processor_->input_count == signals_.size()) {
+		instance_ = processor_->create(
+			(unsigned int)signals_.size(), args_.c_str());
+	}
+	if (!instance_) {
+		qWarning() << "PluginChannel::PluginChannel(): Can't create the" <<
+			"math processor" << processor_->id << "for" << signals_.size() <<
+			"signals with the arguments" << QString::fromStdString(args_);
+		failed_ = true;
+	}
+
+	digits_ = 0;
+	decimal_places_ = 0;
+	for (const auto &signal : signals_) {
+		assert(signal);
+		digits_ = std::max(digits_, signal->digits());
+		decimal_places_ = std::max(decimal_places_, signal->decimal_places());
+
+		add_source_signal(signal);
+	}
+}
+
+PluginChannel::~PluginChannel()
+{
+	lock_guard<mutex> lock(sample_append_mutex_);
+	if (instance_)
+		processor_->destroy(instance_);
+}
+
+bool PluginChannel::is_valid() const
+{
+	return instance_ != nullptr;
+}
+
+string PluginChannel::processor_id() const
+{
+	return processor_->id;
+}
+
+string PluginChannel::args() const
+{
+	return args_;
+}
+
+void PluginChannel::on_sample_appended()
+{
+	if (is_suspended())
+		return;
+
+	lock_guard<mutex> lock(sample_append_mutex_);
+
+	if (failed_)
+		return;
+
+	size_t count;
+	while ((count = combine_cursor_.combine(sample_block_size_,
+			block_timestamps_.data(), data_ptrs_.data())) > 0) {
+		if (processor_->process(instance_, count, block_timestamps_.data(),
+				inputs_.data(), block_results_.data()) != 0) {
+			qWarning() << "PluginChannel::on_sample_appended(): The math" <<
+				"processor" << processor_->id << "of" << display_name() <<
+				"has failed, the channel stops calculating";
+			failed_ = true;
+			return;
+		}
+		push_samples(block_results_.data(), block_timestamps_.data(), count);
+	}
+}
+
+} // namespace channels
+} // namespace sv
@@ -0,0 +1,112 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CHANNELS_PLUGINCHANNEL_HPP
+#define CHANNELS_PLUGINCHANNEL_HPP
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <QObject>
+
+#include "src/channels/basechannel.hpp"
+#include "src/channels/mathchannel.hpp"
+#include "src/data/datautil.hpp"
+#include "src/data/signalcombinecache.hpp"
+#include "src/plugins/smuviewplugin.h"
+
+using std::mutex;
+using std::set;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+
+namespace data {
+class AnalogTimeSignal;
+}
+
+namespace devices {
+class BaseDevice;
+}
+
+namespace channels {
+
+/**
+ * A math channel, that is calculated by the math processor of a native
+ * plugin over N signals, see plugins::PluginManager.
+ *
+ * Like the ExpressionChannel, the signals are merged with a
+ * data::SignalCombiner and the processor is called with the aligned value
+ * blocks. If the processor fails, the channel stops calculating.
+ */
+class PluginChannel : public MathChannel
+{
+	Q_OBJECT
+
+public:
+	/**
+	 * The instance of the processor is created with args, check it with
+	 * is_valid().
+	 */
+	PluginChannel(
+		data::Quantity quantity,
+		const set<data::QuantityFlag> &quantity_flags,
+		data::Unit unit,
+		const vector<shared_ptr<data::AnalogTimeSignal>> &signals,
+		const sv_math_processor *processor,
+		const string &args,
+		shared_ptr<devices::BaseDevice> parent_device,
+		const set<string> &channel_group_names,
+		const string &channel_name,
+		double channel_start_timestamp);
+	~PluginChannel();
+
+	/** Return false, if the instance of the processor couldn't be created. */
+	bool is_valid() const;
+	string processor_id() const;
+	string args() const;
+
+private:
+	vector<shared_ptr<data::AnalogTimeSignal>> signals_;
+	data::SignalCombineCursor combine_cursor_;
+	const sv_math_processor *processor_;
+	const string args_;
+	void *instance_;
+	bool failed_;
+	/** One block of combined values per signal. */
+	vector<vector<double>> data_;
+	vector<double *> data_ptrs_;
+	vector<const double *> inputs_;
+	mutex sample_append_mutex_;
+
+private Q_SLOTS:
+	void on_sample_appended() override;
+
+};
+
+} // namespace channels
+} // namespace sv
+
+#endif // CHANNELS_PLUGINCHANNEL_HPP
@@ -0,0 +1,145 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <string>
+
+#include <QDebug>
+
+#include "resamplechannel.hpp"
+#include "src/channels/basechannel.hpp"
+#include "src/channels/mathchannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/datautil.hpp"
+#include "src/devices/basedevice.hpp"
+
+using std::set;
+using std::string;
+
+namespace sv {
+namespace channels {
+
+ResampleChannel::ResampleChannel(
+		data::Quantity quantity,
+		const set<data::QuantityFlag> &quantity_flags,
+		data::Unit unit,
+		shared_ptr<data::AnalogTimeSignal> signal,
+		double rate,
+		ResampleMethod method,
+		shared_ptr<devices::BaseDevice> parent_device,
+		const set<string> &channel_group_names,
+		const string &channel_name,
+		double channel_start_timestamp) :
+	MathChannel(quantity, quantity_flags, unit,
+		parent_device, channel_group_names, channel_name,
+		channel_start_timestamp),
+	signal_(signal),
+	rate_(rate),
+	method_(method),
+	next_signal_pos_(0),
+	next_grid_index_(0),
+	last_timestamp_(0.),
+	last_value_(0.),
+	has_last_sample_(false),
+	grid_timestamps_(sample_block_size_, 0.),
+	result_count_(0)
+{
+	assert(signal_);
+	assert(rate_ > 0);
+
+	digits_ = signal_->digits();
+	decimal_places_ = signal_->decimal_places();
+
+	add_source_signal(signal_);
+}
+
+double ResampleChannel::rate() const
+{
+	return rate_;
+}
+
+ResampleMethod ResampleChannel::method() const
+{
+	return method_;
+}
+
+void ResampleChannel::flush_results()
+{
+	push_samples(block_results_.data(), grid_timestamps_.data(),
+		result_count_);
+	result_count_ = 0;
+}
+
+void ResampleChannel::on_sample_appended()
+{
+	if (is_suspended())
+		return;
+
+	size_t count;
+	while ((count = read_sample_block(signal_, next_signal_pos_)) > 0) {
+		for (size_t i=0; i<count; ++i) {
+			const double timestamp = block_timestamps_[i];
+			const double value = block_values_[i];
+			if (!std::isfinite(value) || !std::isfinite(timestamp))
+				continue;
+
+			if (!has_last_sample_) {
+				// The first grid point at or behind the first sample
+				next_grid_index_ = (int64_t)std::ceil(timestamp * rate_);
+				if ((double)next_grid_index_ / rate_ < timestamp)
+					++next_grid_index_;
+				last_timestamp_ = timestamp;
+				last_value_ = value;
+				has_last_sample_ = true;
+				continue;
+			}
+			// Samples, that go back in time, can't be interpolated
+			if (timestamp <= last_timestamp_)
+				continue;
+
+			// All grid points in [last_timestamp_, timestamp)
+			const double slope = (value - last_value_) /
+				(timestamp - last_timestamp_);
+			double grid_timestamp;
+			while ((grid_timestamp = (double)next_grid_index_ / rate_) <
+					timestamp) {
+				double result = last_value_;
+				if (method_ == ResampleMethod::Linear)
+					result += slope * (grid_timestamp - last_timestamp_);
+				grid_timestamps_[result_count_] = grid_timestamp;
+				block_results_[result_count_] = result;
+				++next_grid_index_;
+				if (++result_count_ == sample_block_size_)
+					flush_results();
+			}
+
+			last_timestamp_ = timestamp;
+			last_value_ = value;
+		}
+	}
+	if (result_count_ > 0)
+		flush_results();
+}
+
+} // namespace channels
+} // namespace sv
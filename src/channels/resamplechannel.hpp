@@ -0,0 +1,116 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CHANNELS_RESAMPLECHANNEL_HPP
+#define CHANNELS_RESAMPLECHANNEL_HPP
+
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <QObject>
+
+#include "src/channels/basechannel.hpp"
+#include "src/channels/mathchannel.hpp"
+#include "src/data/datautil.hpp"
+
+using std::set;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+
+namespace data {
+class AnalogTimeSignal;
+}
+
+namespace devices {
+class BaseDevice;
+}
+
+namespace channels {
+
+enum class ResampleMethod {
+	/** Interpolate linearly between the two neighbouring samples. */
+	Linear,
+	/** Hold the value of the previous sample. */
+	ZeroOrderHold,
+};
+
+/**
+ * A signal resampled onto a uniform grid with a fixed rate.
+ *
+ * The grid points are the multiples of 1/rate seconds, so all signals that
+ * are resampled with the same rate share the same timestamps and can be
+ * combined sample by sample. A grid point is calculated, as soon as the
+ * first sample behind it arrives. Non finite samples are skipped.
+ */
+class ResampleChannel : public MathChannel
+{
+	Q_OBJECT
+
+public:
+	ResampleChannel(
+		data::Quantity quantity,
+		const set<data::QuantityFlag> &quantity_flags,
+		data::Unit unit,
+		shared_ptr<data::AnalogTimeSignal> signal,
+		double rate,
+		ResampleMethod method,
+		shared_ptr<devices::BaseDevice> parent_device,
+		const set<string> &channel_group_names,
+		const string &channel_name,
+		double channel_start_timestamp);
+
+	/** The rate of the grid in Hz. */
+	double rate() const;
+	ResampleMethod method() const;
+
+private:
+	/** Push the collected grid points. */
+	void flush_results();
+
+	shared_ptr<data::AnalogTimeSignal> signal_;
+	const double rate_;
+	const ResampleMethod method_;
+	size_t next_signal_pos_;
+	/**
+	 * The index of the next grid point. The index is used instead of adding
+	 * up the period, so the grid doesn't drift.
+	 */
+	int64_t next_grid_index_;
+	double last_timestamp_;
+	double last_value_;
+	bool has_last_sample_;
+	/** The timestamps of the collected grid points for block_results_. */
+	vector<double> grid_timestamps_;
+	size_t result_count_;
+
+private Q_SLOTS:
+	void on_sample_appended() override;
+
+};
+
+} // namespace channels
+} // namespace sv
+
+#endif // CHANNELS_RESAMPLECHANNEL_HPP
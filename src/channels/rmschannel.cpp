@@ -0,0 +1,147 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <QDebug>
+
+#include "rmschannel.hpp"
+#include "src/channels/basechannel.hpp"
+#include "src/channels/mathchannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/datautil.hpp"
+#include "src/devices/basedevice.hpp"
+
+using std::set;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace channels {
+
+namespace {
+
+/** The minimum number of removals between two renormalizations. */
+const size_t min_renormalize_interval = 1024;
+
+}
+
+RmsChannel::RmsChannel(
+		data::Quantity quantity,
+		const set<data::QuantityFlag> &quantity_flags,
+		data::Unit unit,
+		shared_ptr<data::AnalogTimeSignal> signal,
+		uint window_sample_count,
+		shared_ptr<devices::BaseDevice> parent_device,
+		const set<string> &channel_group_names,
+		const string &channel_name,
+		double channel_start_timestamp) :
+	MathChannel(quantity, quantity_flags, unit,
+		parent_device, channel_group_names, channel_name,
+		channel_start_timestamp),
+	signal_(signal),
+	window_sample_count_(window_sample_count),
+	next_signal_pos_(0),
+	window_(window_sample_count, 0.),
+	window_begin_(0),
+	window_size_(0),
+	sum_(0.),
+	sum_compensation_(0.),
+	removed_count_(0)
+{
+	assert(signal_);
+	assert(window_sample_count_ > 0);
+
+	digits_ = signal_->digits();
+	decimal_places_ = signal_->decimal_places();
+
+	add_source_signal(signal_);
+}
+
+uint RmsChannel::window_sample_count() const
+{
+	return window_sample_count_;
+}
+
+void RmsChannel::add_to_sum(double value)
+{
+	const double y = value - sum_compensation_;
+	const double t = sum_ + y;
+	sum_compensation_ = (t - sum_) - y;
+	sum_ = t;
+}
+
+void RmsChannel::renormalize_sum()
+{
+	sum_ = 0.;
+	sum_compensation_ = 0.;
+	for (size_t i = 0; i < window_size_; ++i)
+		add_to_sum(window_[(window_begin_ + i) % window_sample_count_]);
+	removed_count_ = 0;
+}
+
+void RmsChannel::on_sample_appended()
+{
+	if (is_suspended())
+		return;
+
+	size_t count;
+	while ((count = read_sample_block(signal_, next_signal_pos_)) > 0) {
+		size_t result_count = 0;
+		for (size_t i=0; i<count; ++i) {
+			// A NaN or an overflow would spoil the running sum
+			if (!std::isfinite(block_values_[i]))
+				continue;
+
+			const double square = block_values_[i] * block_values_[i];
+			if (window_size_ == window_sample_count_) {
+				add_to_sum(-window_[window_begin_]);
+				window_begin_ = (window_begin_ + 1) % window_sample_count_;
+				--window_size_;
+				++removed_count_;
+			}
+			window_[(window_begin_ + window_size_) % window_sample_count_] =
+				square;
+			++window_size_;
+			add_to_sum(square);
+
+			// See MovingAvgChannel
+			if (removed_count_ >= std::max(window_size_, min_renormalize_interval))
+				renormalize_sum();
+
+			// The running sum can get slightly negative by rounding
+			block_timestamps_[result_count] = block_timestamps_[i];
+			block_results_[result_count] =
+				std::sqrt(std::max(sum_, 0.) / (double)window_size_);
+			++result_count;
+		}
+		push_samples(block_results_.data(), block_timestamps_.data(),
+			result_count);
+	}
+}
+
+} // namespace channels
+} // namespace sv
@@ -0,0 +1,101 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CHANNELS_RMSCHANNEL_HPP
+#define CHANNELS_RMSCHANNEL_HPP
+
+#include <cstddef>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <QObject>
+
+#include "src/channels/basechannel.hpp"
+#include "src/channels/mathchannel.hpp"
+#include "src/data/datautil.hpp"
+
+using std::set;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+
+namespace data {
+class AnalogTimeSignal;
+}
+
+namespace devices {
+class BaseDevice;
+}
+
+namespace channels {
+
+/**
+ * The root mean square of the last window_sample_count samples of a signal.
+ *
+ * The squares of the window are kept in a ring buffer with a running
+ * (compensated) sum like in MovingAvgChannel, so a new sample costs O(1)
+ * amortized. Non-finite samples (NaN, overflow) are skipped.
+ */
+class RmsChannel : public MathChannel
+{
+	Q_OBJECT
+
+public:
+	RmsChannel(
+		data::Quantity quantity,
+		const set<data::QuantityFlag> &quantity_flags,
+		data::Unit unit,
+		shared_ptr<data::AnalogTimeSignal> signal,
+		uint window_sample_count,
+		shared_ptr<devices::BaseDevice> parent_device,
+		const set<string> &channel_group_names,
+		const string &channel_name,
+		double channel_start_timestamp);
+
+	uint window_sample_count() const;
+
+private:
+	void add_to_sum(double value);
+	void renormalize_sum();
+
+	shared_ptr<data::AnalogTimeSignal> signal_;
+	uint window_sample_count_;
+	size_t next_signal_pos_;
+
+	/** Ring buffer with the squares of the window. */
+	vector<double> window_;
+	size_t window_begin_;
+	size_t window_size_;
+	double sum_;
+	double sum_compensation_;
+	size_t removed_count_;
+
+private Q_SLOTS:
+	void on_sample_appended() override;
+
+};
+
+} // namespace channels
+} // namespace sv
+
+#endif // CHANNELS_RMSCHANNEL_HPP
@@ -18,23 +18,34 @@
  */
 
 #include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 #include <QDebug>
+#include <QString>
 
 #include "userchannel.hpp"
 #include "src/channels/basechannel.hpp"
+#include "src/channels/periodicsampler.hpp"
 #include "src/data/analogtimesignal.hpp"
 #include "src/data/basesignal.hpp"
 #include "src/data/datautil.hpp"
+#include "src/data/properties/baseproperty.hpp"
 #include "src/devices/basedevice.hpp"
+#include "src/devices/configurable.hpp"
+#include "src/devices/deviceutil.hpp"
 
 using std::make_pair;
+using std::make_shared;
 using std::set;
 using std::static_pointer_cast;
 using std::string;
+using std::vector;
 
 namespace sv {
 namespace channels {
@@ -48,6 +59,7 @@ UserChannel::UserChannel(
 		channel_start_timestamp)
 {
 	name_ = channel_name;
+	display_name_ = QString::fromStdString(name_);
 	type_ = ChannelType::UserChannel;
 	index_ = parent_device->next_channel_index();
 	fixed_signal_ = false;
@@ -60,31 +72,147 @@ UserChannel::UserChannel(
 	}
 }
 
+UserChannel::~UserChannel()
+{
+	stop_sampling();
+}
+
 void UserChannel::push_sample(double sample, double timestamp,
 	data::Quantity quantity, set<data::QuantityFlag> quantity_flags,
 	data::Unit unit, int digits, int decimal_places)
 {
-	if (!actual_signal_ || actual_signal_->quantity() != quantity ||
-		actual_signal_->quantity_flags() != quantity_flags) {
+	select_signal(quantity, quantity_flags, unit)->push_sample(
+		sample, timestamp, digits, decimal_places);
+}
+
+void UserChannel::push_samples(const double *values,
+	const double *timestamps, size_t count, data::Quantity quantity,
+	set<data::QuantityFlag> quantity_flags, data::Unit unit,
+	int digits, int decimal_places)
+{
+	if (count == 0)
+		return;
+
+	select_signal(quantity, quantity_flags, unit)->push_samples(
+		timestamps, values, count, digits, decimal_places);
+}
+
+void UserChannel::push_samples(const double *values, size_t count,
+	double timestamp, double samplerate, data::Quantity quantity,
+	set<data::QuantityFlag> quantity_flags, data::Unit unit,
+	int digits, int decimal_places)
+{
+	if (count == 0)
+		return;
+	if (samplerate <= 0) {
+		qWarning() << "UserChannel::push_samples(): " << display_name() <<
+			" - Invalid samplerate " << samplerate;
+		return;
+	}
+
+	auto signal = select_signal(quantity, quantity_flags, unit);
+	if (samplerate == std::floor(samplerate) &&
+			samplerate <= (double)std::numeric_limits<uint64_t>::max()) {
+		// The timestamps are stored as one run, see TimeBase
+		signal->push_samples(values, count, timestamp,
+			(uint64_t)samplerate, digits, decimal_places);
+		return;
+	}
+
+	vector<double> timestamps(count);
+	for (size_t i = 0; i < count; ++i)
+		timestamps[i] = timestamp + (double)i / samplerate;
+	signal->push_samples(
+		timestamps.data(), values, count, digits, decimal_places);
+}
+
+shared_ptr<data::AnalogTimeSignal> UserChannel::select_signal(
+	data::Quantity quantity, const set<data::QuantityFlag> &quantity_flags,
+	data::Unit unit)
+{
+	if (!actual_signal_ || actual_signal_->measured_quantity() !=
+			data::MeasuredQuantity(quantity,
+				data::datautil::get_quantity_flags_mask(quantity_flags))) {
 
 		measured_quantity_t mq = make_pair(quantity, quantity_flags);
 		size_t signals_count = signal_map_.count(mq);
 		if (signals_count == 0) {
 			actual_signal_ = add_signal(quantity, quantity_flags, unit);
-			qWarning() << "UserChannel::push_sample(): " << display_name() <<
+			qWarning() << "UserChannel::select_signal(): " << display_name() <<
 				" - No signal found: " << actual_signal_->display_name();
 		}
 		else if (signals_count > 1) {
 			actual_signal_ = signal_map_[mq][0];
-			qWarning() << "UserChannel::push_sample(): " << display_name() <<
+			qWarning() << "UserChannel::select_signal(): " << display_name() <<
 				" - More than one signal found, using first found signal: " <<
 				actual_signal_->display_name();
 		}
 		Q_EMIT signal_changed(actual_signal_);
 	}
 
-	static_pointer_cast<data::AnalogTimeSignal>(actual_signal_)->push_sample(
-		&sample, timestamp, size_of_double_, digits, decimal_places);
+	return static_pointer_cast<data::AnalogTimeSignal>(actual_signal_);
+}
+
+void UserChannel::start_config_sampling(
+	shared_ptr<devices::Configurable> configurable,
+	devices::ConfigKey config_key, double interval,
+	data::Quantity quantity, set<data::QuantityFlag> quantity_flags,
+	data::Unit unit, int digits, int decimal_places)
+{
+	auto property = configurable->get_property(config_key);
+	if (!property || !configurable->has_get_config(config_key)) {
+		qWarning() << "UserChannel::start_config_sampling(): " <<
+			display_name() << " - Config key is not readable: " <<
+			devices::deviceutil::format_config_key(config_key);
+		return;
+	}
+
+	start_sampler(make_shared<PeriodicSampler>(this,
+		[property](double &value) {
+			bool ok;
+			// The sampler needs a fresh value, not the cached one
+			value = property->read_value().toDouble(&ok);
+			return ok;
+		},
+		interval, quantity, quantity_flags, unit, digits, decimal_places));
+}
+
+void UserChannel::start_signal_sampling(
+	shared_ptr<data::AnalogTimeSignal> signal, double interval)
+{
+	start_sampler(make_shared<PeriodicSampler>(this,
+		[signal](double &value) {
+			if (signal->sample_count() == 0)
+				return false;
+			value = signal->last_value();
+			return true;
+		},
+		interval, signal->quantity(), signal->quantity_flags(), signal->unit(),
+		signal->digits(), signal->decimal_places()));
+}
+
+void UserChannel::start_sampler(shared_ptr<PeriodicSampler> sampler)
+{
+	if (sampler->interval() <= 0) {
+		qWarning() << "UserChannel::start_sampler(): " << display_name() <<
+			" - Invalid interval " << sampler->interval();
+		return;
+	}
+
+	stop_sampling();
+	sampler_ = sampler;
+	sampler_->start();
+}
+
+void UserChannel::stop_sampling()
+{
+	if (sampler_)
+		sampler_->stop();
+}
+
+shared_ptr<PeriodicSampler> UserChannel::sampler() const
+{
+	return sampler_;
 }
 
 } // namespace channels
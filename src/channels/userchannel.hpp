@@ -29,6 +29,7 @@
 
 #include "src/channels/basechannel.hpp"
 #include "src/data/datautil.hpp"
+#include "src/devices/deviceutil.hpp"
 
 using std::set;
 using std::shared_ptr;
@@ -38,15 +39,19 @@ using std::vector;
 namespace sv {
 
 namespace data {
+class AnalogTimeSignal;
 class BaseSignal;
 }
 
 namespace devices {
 class BaseDevice;
+class Configurable;
 }
 
 namespace channels {
 
+class PeriodicSampler;
+
 class UserChannel : public BaseChannel
 {
 	Q_OBJECT
@@ -57,6 +62,7 @@ public:
 		const set<string> &channel_group_names,
 		shared_ptr<devices::BaseDevice> parent_device,
 		double channel_start_timestamp);
+	~UserChannel();
 
 	/**
 	 * Add a single sample with timestamp to the channel/signal
@@ -66,6 +72,61 @@ public:
 		data::Quantity quantity, set<data::QuantityFlag> quantity_flags,
 		data::Unit unit, int digits, int decimal_places);
 
+	/**
+	 * Add count samples with explicit timestamps to the channel/signal. The
+	 * samples are stored and published at once.
+	 */
+	void push_samples(const double *values, const double *timestamps,
+		size_t count, data::Quantity quantity,
+		set<data::QuantityFlag> quantity_flags, data::Unit unit,
+		int digits, int decimal_places);
+
+	/**
+	 * Add count samples with a fixed samplerate, starting at timestamp, to
+	 * the channel/signal. The samples are stored and published at once.
+	 */
+	void push_samples(const double *values, size_t count, double timestamp,
+		double samplerate, data::Quantity quantity,
+		set<data::QuantityFlag> quantity_flags, data::Unit unit,
+		int digits, int decimal_places);
+
+	/**
+	 * Sample the value of a config key in a dedicated thread every interval
+	 * seconds and push it to this channel. A running sampling is replaced.
+	 */
+	void start_config_sampling(shared_ptr<devices::Configurable> configurable,
+		devices::ConfigKey config_key, double interval,
+		data::Quantity quantity, set<data::QuantityFlag> quantity_flags,
+		data::Unit unit, int digits, int decimal_places);
+
+	/**
+	 * Sample the last value of the signal in a dedicated thread every
+	 * interval seconds and push it to this channel. A running sampling is
+	 * replaced.
+	 */
+	void start_signal_sampling(shared_ptr<data::AnalogTimeSignal> signal,
+		double interval);
+
+	void stop_sampling();
+
+	/**
+	 * Return the sampler of this channel or nullptr, if the channel was
+	 * never sampled.
+	 */
+	shared_ptr<PeriodicSampler> sampler() const;
+
+private:
+	/**
+	 * Return the signal for the given quantity and make it the actual
+	 * signal. A new signal is added, if there is none.
+	 */
+	shared_ptr<data::AnalogTimeSignal> select_signal(data::Quantity quantity,
+		const set<data::QuantityFlag> &quantity_flags, data::Unit unit);
+
+	void start_sampler(shared_ptr<PeriodicSampler> sampler);
+
+	shared_ptr<PeriodicSampler> sampler_;
+
 };
 
 } // namespace channels
@@ -20,6 +20,7 @@
 #include <algorithm>
 #include <cassert>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 
@@ -31,8 +32,14 @@
 #include "src/channels/basechannel.hpp"
 #include "src/data/basesignal.hpp"
 #include "src/data/datautil.hpp"
+#include "src/data/runningstatistics.hpp"
+#include "src/data/samplebus.hpp"
+#include "src/data/samplenotifier.hpp"
+#include "src/data/valuebuffer.hpp"
 
+using std::lock_guard;
 using std::make_shared;
+using std::mutex;
 using std::set;
 using std::shared_ptr;
 using std::string;
@@ -56,7 +63,14 @@ AnalogBaseSignal::AnalogBaseSignal(
 	max_value_(std::numeric_limits<double>::lowest())
 {
 	qWarning() << "Init analog base signal " << display_name();
-	data_ = make_shared<vector<double>>();
+	data_ = make_shared<ValueBuffer>();
+
+	// The notifier lives in the thread of the signal, so the coalesced
+	// notifications are emitted there and not in the acquisition thread.
+	notifier_ = new SampleNotifier(this);
+	connect(notifier_, &SampleNotifier::samples_appended,
+		this, &AnalogBaseSignal::on_samples_notified);
+	sample_bus_ = make_shared<SampleBus>();
 }
 
 size_t AnalogBaseSignal::sample_count() const
@@ -188,6 +202,22 @@ void AnalogSignal::push_sample(void *sample, double timestamp,
 }
 */
 
+bool AnalogBaseSignal::set_value_storage(ValueStorage storage)
+{
+	lock_guard<mutex> lock(write_mutex_);
+	if (!data_->set_storage(storage)) {
+		qWarning() << "AnalogBaseSignal::set_value_storage(): "
+			<< display_name() << ": Signal already contains samples!";
+		return false;
+	}
+	return true;
+}
+
+ValueStorage AnalogBaseSignal::value_storage() const
+{
+	return data_->storage();
+}
+
 int AnalogBaseSignal::digits() const
 {
 	return digits_;
@@ -213,6 +243,78 @@ double AnalogBaseSignal::max_value() const
 	return max_value_;
 }
 
+AnalogStatistics AnalogBaseSignal::statistics() const
+{
+	return statistics_.statistics();
+}
+
+double AnalogBaseSignal::mean_value() const
+{
+	return statistics_.statistics().mean;
+}
+
+double AnalogBaseSignal::rms_value() const
+{
+	return statistics_.statistics().rms;
+}
+
+double AnalogBaseSignal::stddev_value() const
+{
+	return statistics_.statistics().stddev;
+}
+
+RunningStatisticsState AnalogBaseSignal::statistics_state(size_t &end_pos) const
+{
+	lock_guard<mutex> lock(write_mutex_);
+	end_pos = sample_count_;
+	return statistics_.state();
+}
+
+void AnalogBaseSignal::restore_statistics(const RunningStatisticsState &state)
+{
+	lock_guard<mutex> lock(write_mutex_);
+	statistics_.restore(state);
+}
+
+void AnalogBaseSignal::set_notification_interval(int interval)
+{
+	notifier_->set_interval(interval);
+}
+
+int AnalogBaseSignal::notification_interval() const
+{
+	return notifier_->interval();
+}
+
+void AnalogBaseSignal::set_notification_batch_size(size_t batch_size)
+{
+	notifier_->set_batch_size(batch_size);
+}
+
+size_t AnalogBaseSignal::notification_batch_size() const
+{
+	return notifier_->batch_size();
+}
+
+unique_ptr<SampleBusSubscription> AnalogBaseSignal::subscribe_samples(
+	SampleBus::AppendedCallback appended, SampleBus::ClearedCallback cleared,
+	SampleExecutor executor, QObject *context)
+{
+	return sample_bus_->subscribe(std::move(appended), std::move(cleared),
+		executor, context);
+}
+
+size_t AnalogBaseSignal::pending_sample_pos() const
+{
+	return sample_bus_->pending_pos();
+}
+
+void AnalogBaseSignal::on_samples_notified(size_t first, size_t last)
+{
+	sample_bus_->publish_appended(first, last);
+	Q_EMIT samples_appended(first, last);
+}
+
 /*
 void AnalogSignal::combine_signals(
 	shared_ptr<AnalogSignal> signal1, size_t &signal1_pos,
@@ -20,7 +20,9 @@
 #ifndef DATA_ANALOGBASESIGNAL_HPP
 #define DATA_ANALOGBASESIGNAL_HPP
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <utility>
@@ -30,11 +32,16 @@
 
 #include "src/data/basesignal.hpp"
 #include "src/data/datautil.hpp"
+#include "src/data/runningstatistics.hpp"
+#include "src/data/samplebus.hpp"
+#include "src/data/samplenotifier.hpp"
+#include "src/data/valuebuffer.hpp"
 
 using std::pair;
 using std::set;
 using std::shared_ptr;
 using std::string;
+using std::unique_ptr;
 using std::vector;
 
 namespace sv {
@@ -86,12 +93,69 @@ public:
 		size_t unit_size, int digits, int decimal_places);
 	 */
 
+	/**
+	 * Select the type, that is used to store the values of this signal. The
+	 * type can only be changed as long as no samples were pushed to the
+	 * signal (or after clear()).
+	 *
+	 * @return true if the storage type was changed.
+	 */
+	bool set_value_storage(ValueStorage storage);
+	ValueStorage value_storage() const;
+
 	int digits() const;
 	int decimal_places() const;
 	double last_value() const;
 	double min_value() const;
 	double max_value() const;
 
+	/**
+	 * Return the running statistics (mean, variance, standard deviation and
+	 * RMS) of all finite values, that were pushed since the last clear().
+	 * Samples, that were dropped by a retention policy, are still included.
+	 */
+	AnalogStatistics statistics() const;
+	double mean_value() const;
+	double rms_value() const;
+	double stddev_value() const;
+	/**
+	 * Return the raw state of the running statistics and the end position of
+	 * the samples, that it includes, in &end_pos. Both are read together,
+	 * while no samples are pushed, e.g. for a checkpoint.
+	 */
+	RunningStatisticsState statistics_state(size_t &end_pos) const;
+	/**
+	 * Replace the running statistics, e.g. with the state of a checkpoint,
+	 * see CaptureWriter::write_checkpoint().
+	 */
+	void restore_statistics(const RunningStatisticsState &state);
+
+	/**
+	 * Set the minimal interval between two samples_appended() signals in
+	 * milliseconds and the number of appended samples, that trigger the
+	 * signal earlier. See SampleNotifier.
+	 */
+	void set_notification_interval(int interval);
+	int notification_interval() const;
+	void set_notification_batch_size(size_t batch_size);
+	size_t notification_batch_size() const;
+
+	/**
+	 * Subscribe to the (coalesced) appended and cleared samples with typed
+	 * callbacks, e.g. for a math channel or an analyzer. See SampleBus. The
+	 * Qt signals samples_appended() and samples_cleared() are meant for the
+	 * UI.
+	 */
+	unique_ptr<SampleBusSubscription> subscribe_samples(
+		SampleBus::AppendedCallback appended,
+		SampleBus::ClearedCallback cleared, SampleExecutor executor,
+		QObject *context = nullptr);
+	/**
+	 * Return the position of the first sample, that a queued subscriber
+	 * didn't process yet, see SampleBus::pending_pos().
+	 */
+	size_t pending_sample_pos() const;
+
 	/*
 	static void combine_signals(
 		shared_ptr<AnalogSignal> signal1, size_t &signal1_pos,
@@ -102,20 +166,53 @@ public:
 	*/
 
 protected:
-	shared_ptr<vector<double>> data_;
-	size_t sample_count_;
-	int digits_;
-	int decimal_places_;
-	double last_value_;
-	double min_value_;
-	double max_value_;
+	shared_ptr<ValueBuffer> data_;
+	/**
+	 * The number of published samples. Writers store it (release) after the
+	 * sample data is written, readers load it (acquire) before reading.
+	 */
+	std::atomic<size_t> sample_count_;
+	std::atomic<int> digits_;
+	std::atomic<int> decimal_places_;
+	std::atomic<double> last_value_;
+	std::atomic<double> min_value_;
+	std::atomic<double> max_value_;
+	RunningStatistics statistics_;
+	/**
+	 * Coalesces the notifications about appended samples. Writers call
+	 * notifier_->notify() while holding write_mutex_.
+	 */
+	SampleNotifier *notifier_;
+	/** The typed subscribers of the notifications. */
+	shared_ptr<SampleBus> sample_bus_;
+	/**
+	 * Serializes the writers (acquisition thread, clear() from the GUI,
+	 * ...). Readers never lock this mutex.
+	 */
+	mutable std::mutex write_mutex_;
 
 	static const size_t size_of_float_ = sizeof(float);
 	static const size_t size_of_double_ = sizeof(double);
 
+protected Q_SLOTS:
+	/**
+	 * Called by notifier_ in the thread of the signal, publishes the samples
+	 * to sample_bus_ and emits samples_appended().
+	 */
+	virtual void on_samples_notified(size_t first, size_t last);
+
 Q_SIGNALS:
 	void samples_cleared();
-	void sample_appended();
+	/**
+	 * The oldest samples were dropped by the retention policy, the first
+	 * remaining sample is at first_sample_pos.
+	 */
+	void samples_dropped(size_t first_sample_pos);
+	/**
+	 * The samples in the absolute range [first, last) were appended. The
+	 * signal is coalesced, see set_notification_interval().
+	 */
+	void samples_appended(size_t first, size_t last);
 	void digits_changed(const int digits, const int decimal_places);
 
 };
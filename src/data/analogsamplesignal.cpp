@@ -20,6 +20,7 @@
 #include <algorithm>
 #include <cassert>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 
@@ -31,9 +32,13 @@
 #include "src/channels/basechannel.hpp"
 #include "src/data/basesignal.hpp"
 #include "src/data/datautil.hpp"
+#include "src/data/spillfile.hpp"
+#include "src/data/timebase.hpp"
 
+using std::lock_guard;
 using std::make_pair;
 using std::make_shared;
+using std::mutex;
 using std::set;
 using std::shared_ptr;
 using std::string;
@@ -49,19 +54,27 @@ AnalogSampleSignal::AnalogSampleSignal(
 		shared_ptr<channels::BaseChannel> parent_channel,
 		const string &custom_name) :
 	AnalogBaseSignal(quantity, quantity_flags, unit, parent_channel, custom_name),
-	last_pos_(0)
+	last_pos_(0),
+	retention_max_samples_(0),
+	spill_to_disk_(false)
 {
 	qWarning() << "Init analog sample signal " << display_name();
-	pos_ = make_shared<vector<uint32_t>>();
+	pos_ = make_shared<TimeBase>();
 }
 
 void AnalogSampleSignal::clear()
 {
-	// TODO: mutex
-	pos_->clear();
-	data_->clear();
-	sample_count_ = 0;
+	{
+		lock_guard<mutex> lock(write_mutex_);
+		sample_count_.store(0, std::memory_order_release);
+		pos_->clear();
+		data_->clear();
+		statistics_.clear();
+		notifier_->reset();
+		clear_epoch_.fetch_add(1, std::memory_order_release);
+	}
 
+	sample_bus_->publish_cleared();
 	Q_EMIT samples_cleared();
 }
 
@@ -72,10 +85,17 @@ analog_pos_sample_t AnalogSampleSignal::get_sample(uint32_t pos) const
 	//qWarning() << "AnalogSampleSignal::get_sample(" << pos
 	//	<< "): sample_count_ = " << sample_count_;
 
-	if (pos < sample_count_) {
+	// The key buffer is always dropped/cleared before the data buffer, so
+	// validating the read against the key buffer covers both buffers.
+	const unsigned int generation = pos_->generation();
+	if (pos >= pos_->begin_pos() &&
+			pos < sample_count_.load(std::memory_order_acquire)) {
+		const uint32_t key = (uint32_t)pos_->timestamp(pos);
+		double value = (*data_)[pos];
 		//qWarning() << "AnalogSampleSignal::get_sample(" << pos
-		//	<< "): value = " << data_->at(pos);
-		return make_pair(pos, data_->at(pos));
+		//	<< "): value = " << value;
+		if (pos_->is_valid_read(pos, generation))
+			return make_pair(key, value);
 	}
 
 	return make_pair(0, 0.);
@@ -84,11 +104,22 @@ analog_pos_sample_t AnalogSampleSignal::get_sample(uint32_t pos) const
 void AnalogSampleSignal::push_sample(void *sample, uint32_t pos,
 		size_t unit_size, int digits, int decimal_places)
 {
-	double dsample = 0.;
-	if (unit_size == size_of_float_)
-		dsample = (double) *(float *)sample;
-	else if (unit_size == size_of_double_)
-		dsample = *(double *)sample;
+	if (unit_size == size_of_float_) {
+		push_sample((double)*(float *)sample, pos, digits, decimal_places);
+	}
+	else if (unit_size == size_of_double_) {
+		push_sample(*(double *)sample, pos, digits, decimal_places);
+	}
+	else {
+		qWarning() << "AnalogSampleSignal::push_sample(): " << name_
+			<< ": Unsupported unit size " << unit_size;
+	}
+}
+
+void AnalogSampleSignal::push_sample(double sample, uint32_t pos,
+		int digits, int decimal_places)
+{
+	const double dsample = sample;
 
 	/*
 	qWarning() << "AnalogSampleSignal::push_sample(): " << name_
@@ -97,64 +128,200 @@ void AnalogSampleSignal::push_sample(void *sample, uint32_t pos,
 		<< ": sample_count_ = " << sample_count_+1;
 	*/
 
-	// TODO: Mutex?
-	last_pos_ = pos;
-	last_value_ = dsample;
-	if (min_value_ > dsample)
-		min_value_ = dsample;
-	// Ignore infinitiy (overflow) as max value.
-	if (max_value_ < dsample &&
-		dsample != std::numeric_limits<double>::infinity()) {
+	bool dropped;
+	bool digits_chngd = false;
+	{
+		lock_guard<mutex> lock(write_mutex_);
+
+		last_pos_ = pos;
+		last_value_ = dsample;
+		if (min_value_ > dsample)
+			min_value_ = dsample;
+		// Ignore infinitiy (overflow) as max value.
+		if (max_value_ < dsample &&
+			dsample != std::numeric_limits<double>::infinity()) {
+
+			max_value_ = dsample;
+		}
 
-		max_value_ = dsample;
+		/*
+		qWarning() << "AnalogSampleSignal::push_sample(): " << name_
+			<< ":last_pos_ = " << last_pos_;
+		qWarning() << "AnalogSampleSignal::push_sample(): " << name_
+			<< ":last_value_ = " << last_value_;
+		qWarning() << "AnalogSampleSignal::push_sample(): " << name_
+			<< ":min_value_ = " << min_value_;
+		qWarning() << "AnalogSampleSignal::push_sample(): " << name_
+			<< ":max_value_ = " << max_value_;
+		*/
+
+		// The scale of ScaledInt32 values is taken from the first sample
+		if (data_->end_pos() == 0)
+			data_->set_decimal_places(decimal_places);
+
+		// Write the sample first and then publish it to the readers
+		pos_->push_back((double)pos);
+		data_->push_back(dsample);
+		statistics_.add(dsample);
+		statistics_.publish();
+		sample_count_.store(pos_->end_pos(), std::memory_order_release);
+		notifier_->notify(pos_->end_pos());
+		dropped = apply_retention();
+
+		if (digits != digits_) {
+			digits_ = digits;
+			digits_chngd = true;
+		}
+		if (decimal_places != decimal_places_) {
+			decimal_places_ = decimal_places;
+			digits_chngd = true;
+		}
 	}
 
-	/*
-	qWarning() << "AnalogSampleSignal::push_sample(): " << name_
-		<< ":last_pos_ = " << last_pos_;
-	qWarning() << "AnalogSampleSignal::push_sample(): " << name_
-		<< ":last_value_ = " << last_value_;
-	qWarning() << "AnalogSampleSignal::push_sample(): " << name_
-		<< ":min_value_ = " << min_value_;
-	qWarning() << "AnalogSampleSignal::push_sample(): " << name_
-		<< ":max_value_ = " << max_value_;
-	*/
-
-	// TODO: Mutex?
-	pos_->push_back(pos);
-	data_->push_back(dsample);
-	sample_count_++;
-	Q_EMIT sample_appended();
-
-	bool digits_chngd = false;
-	if (digits != digits_) {
-		digits_ = digits;
-		digits_chngd = true;
-	}
-	if (decimal_places != decimal_places_) {
-		decimal_places_ = decimal_places;
-		digits_chngd = true;
-	}
+	if (dropped)
+		Q_EMIT samples_dropped(pos_->begin_pos());
 	if (digits_chngd)
-		Q_EMIT digits_changed(digits_, decimal_places_);
+		Q_EMIT digits_changed(digits, decimal_places);
 }
 
 uint32_t AnalogSampleSignal::first_pos() const
 {
-	if (pos_->empty())
-		return 0;
-
-	return pos_->front();
+	while (true) {
+		const unsigned int generation = pos_->generation();
+		const size_t pos = pos_->begin_pos();
+		if (pos >= sample_count_.load(std::memory_order_acquire))
+			return 0;
+		// Retry if the first sample was dropped while reading it
+		const uint32_t key = (uint32_t)pos_->timestamp(pos);
+		if (pos_->is_valid_read(pos, generation))
+			return key;
+	}
 }
 
 uint32_t AnalogSampleSignal::last_pos() const
 {
-	if (pos_->empty())
+	if (sample_count_.load(std::memory_order_acquire) == 0)
 		return 0;
 
 	return last_pos_;
 }
 
+size_t AnalogSampleSignal::first_sample_pos() const
+{
+	return pos_->begin_pos();
+}
+
+size_t AnalogSampleSignal::retained_sample_count() const
+{
+	const size_t begin_pos = pos_->begin_pos();
+	const size_t end_pos = sample_count_.load(std::memory_order_acquire);
+	return end_pos > begin_pos ? end_pos - begin_pos : 0;
+}
+
+void AnalogSampleSignal::set_retention_max_samples(size_t max_samples)
+{
+	bool dropped;
+	{
+		lock_guard<mutex> lock(write_mutex_);
+		retention_max_samples_ = max_samples;
+		dropped = apply_retention();
+	}
+	if (dropped)
+		Q_EMIT samples_dropped(pos_->begin_pos());
+}
+
+size_t AnalogSampleSignal::retention_max_samples() const
+{
+	return retention_max_samples_;
+}
+
+bool AnalogSampleSignal::set_spill_to_disk(bool spill_to_disk)
+{
+	lock_guard<mutex> lock(write_mutex_);
+	if (spill_to_disk == spill_to_disk_)
+		return true;
+
+	shared_ptr<SpillFile> spill_file;
+	if (spill_to_disk) {
+		if (!spill_file_)
+			spill_file_ = make_shared<SpillFile>();
+		if (!spill_file_->open()) {
+			qWarning() << "AnalogSampleSignal::set_spill_to_disk(): "
+				<< display_name() << ": Can't create spill file!";
+			return false;
+		}
+		spill_file = spill_file_;
+	}
+	pos_->set_spill_file(spill_file);
+	data_->set_spill_file(spill_file);
+	spill_to_disk_ = spill_to_disk;
+	return true;
+}
+
+bool AnalogSampleSignal::spill_to_disk() const
+{
+	return spill_to_disk_;
+}
+
+bool AnalogSampleSignal::set_compression(bool compression)
+{
+	lock_guard<mutex> lock(write_mutex_);
+	if (!pos_->set_compressed(compression) ||
+			!data_->set_compressed(compression)) {
+		qWarning() << "AnalogSampleSignal::set_compression(): "
+			<< display_name() << ": Signal already contains samples!";
+		return false;
+	}
+	return true;
+}
+
+bool AnalogSampleSignal::compression() const
+{
+	return data_->compressed();
+}
+
+size_t AnalogSampleSignal::memory_size() const
+{
+	return pos_->memory_size() + data_->memory_size();
+}
+
+size_t AnalogSampleSignal::spilled_size() const
+{
+	return pos_->spilled_size() + data_->spilled_size();
+}
+
+bool AnalogSampleSignal::apply_retention()
+{
+	const size_t max_samples = retention_max_samples_;
+	if (max_samples == 0 || pos_->size() <= max_samples)
+		return false;
+
+	drop_samples(pos_->size() - max_samples);
+	return true;
+}
+
+void AnalogSampleSignal::drop_samples(size_t count)
+{
+	// The key buffer must be dropped first, see get_sample()
+	pos_->drop_front(count);
+	data_->drop_front(count);
+}
+
+size_t AnalogSampleSignal::evict_samples(size_t count)
+{
+	{
+		lock_guard<mutex> lock(write_mutex_);
+		// Always keep the last sample
+		const size_t size = pos_->size();
+		count = std::min(count, size > 0 ? size - 1 : 0);
+		if (count > 0)
+			drop_samples(count);
+	}
+	if (count > 0)
+		Q_EMIT samples_dropped(pos_->begin_pos());
+	return count;
+}
+
 /*
 void AnalogSampleSignal::combine_signals(
 	shared_ptr<AnalogSampleSignal> signal1, size_t &signal1_pos,
@@ -20,6 +20,7 @@
 #ifndef DATA_ANALOGSAMPLESIGNAL_HPP
 #define DATA_ANALOGSAMPLESIGNAL_HPP
 
+#include <atomic>
 #include <memory>
 #include <set>
 #include <string>
@@ -30,6 +31,8 @@
 
 #include "src/data/analogbasesignal.hpp"
 #include "src/data/datautil.hpp"
+#include "src/data/spillfile.hpp"
+#include "src/data/timebase.hpp"
 
 using std::pair;
 using std::set;
@@ -61,18 +64,60 @@ public:
 
 	/**
 	 * Return the sample at the given position.
+	 *
+	 * Like in AnalogTimeSignal, sample positions are absolute and stay
+	 * stable, even when old samples are dropped by the retention policy.
+	 * All read functions are lock-free and can be called from any thread.
 	 */
 	analog_pos_sample_t get_sample(uint32_t pos) const;
 
 	/**
 	 * Push a single sample to the signal.
 	 */
+	void push_sample(double sample, uint32_t pos,
+		int digits, int decimal_places);
+
+	/**
+	 * Push a single sample of unit_size (float or double) to the signal.
+	 * Prefer push_sample(double, ...), this only dispatches to it.
+	 */
 	void push_sample(void *sample, uint32_t pos,
 		size_t unit_size, int digits, int decimal_places);
 
+	/** Return the key of the oldest retained and of the newest sample. */
 	uint32_t first_pos() const;
 	uint32_t last_pos() const;
 
+	/**
+	 * Return the position of the oldest sample, that is still stored in the
+	 * signal. This is 0 until samples are dropped by the retention policy.
+	 */
+	size_t first_sample_pos() const;
+	size_t retained_sample_count() const override;
+
+	/**
+	 * Limit the number of samples stored in the signal. When the limit is
+	 * exceeded, the oldest samples are dropped.
+	 *
+	 * @param max_samples The maximum number of samples. 0 means unlimited.
+	 */
+	void set_retention_max_samples(size_t max_samples);
+	size_t retention_max_samples() const;
+
+	/** See AnalogTimeSignal::set_spill_to_disk(). */
+	bool set_spill_to_disk(bool spill_to_disk) override;
+	bool spill_to_disk() const override;
+
+	/** See AnalogTimeSignal::set_compression(). */
+	bool set_compression(bool compression);
+	bool compression() const;
+
+	size_t memory_size() const override;
+	size_t spilled_size() const override;
+
+	/** See BaseSignal::evict_samples(). */
+	size_t evict_samples(size_t count) override;
+
 	/*
 	static void combine_signals(
 		shared_ptr<AnalogSampleSignal> signal1, size_t &signal1_pos,
@@ -83,8 +128,29 @@ public:
 	*/
 
 private:
-	shared_ptr<vector<uint32_t>> pos_;
-	uint32_t last_pos_;
+	/**
+	 * Drop the oldest samples until the retention policy is satisfied.
+	 * write_mutex_ must be locked by the caller.
+	 *
+	 * @return true if samples were dropped.
+	 */
+	bool apply_retention();
+
+	/**
+	 * Drop the count oldest samples. write_mutex_ must be locked by the
+	 * caller.
+	 */
+	void drop_samples(size_t count);
+
+	/**
+	 * The keys of the samples. They are stored like timestamps, so
+	 * consecutive keys only need a single run.
+	 */
+	shared_ptr<TimeBase> pos_;
+	std::atomic<uint32_t> last_pos_;
+	std::atomic<size_t> retention_max_samples_;
+	shared_ptr<SpillFile> spill_file_;
+	std::atomic<bool> spill_to_disk_;
 
 };
 
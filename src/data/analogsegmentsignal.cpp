@@ -0,0 +1,386 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+
+#include <QDebug>
+
+#include "analogsegmentsignal.hpp"
+#include "src/channels/basechannel.hpp"
+#include "src/data/basesignal.hpp"
+#include "src/data/datautil.hpp"
+#include "src/data/samplekernels.hpp"
+#include "src/data/spillfile.hpp"
+#include "src/data/valuebuffer.hpp"
+
+using std::lock_guard;
+using std::make_shared;
+using std::mutex;
+using std::set;
+using std::shared_ptr;
+using std::string;
+
+namespace sv {
+namespace data {
+
+const size_t AnalogSegmentSignal::strided_block_size_ = 1024;
+
+AnalogSegmentSignal::AnalogSegmentSignal(
+		data::Quantity quantity,
+		const set<data::QuantityFlag> &quantity_flags,
+		data::Unit unit,
+		shared_ptr<channels::BaseChannel> parent_channel,
+		const string &custom_name) :
+	AnalogBaseSignal(quantity, quantity_flags, unit, parent_channel, custom_name),
+	frames_(10),
+	frame_open_(false),
+	retention_max_frames_(0),
+	spill_to_disk_(false)
+{
+	qWarning() << "Init analog segment signal " << display_name();
+
+	// The values of scope like devices don't need double precision
+	data_->set_storage(ValueStorage::Float32);
+	open_frame_ = { 0, 0, 0., 0 };
+}
+
+void AnalogSegmentSignal::clear()
+{
+	{
+		lock_guard<mutex> lock(write_mutex_);
+		sample_count_.store(0, std::memory_order_release);
+		frame_open_ = false;
+		frames_.clear();
+		data_->clear();
+		statistics_.clear();
+		notifier_->reset();
+		clear_epoch_.fetch_add(1, std::memory_order_release);
+	}
+
+	sample_bus_->publish_cleared();
+	Q_EMIT samples_cleared();
+}
+
+template<typename T>
+void AnalogSegmentSignal::push_frame(const T *data, size_t count,
+	double timestamp, uint64_t samplerate, int digits, int decimal_places)
+{
+	bool dropped = false;
+	bool digits_chngd;
+	{
+		lock_guard<mutex> lock(write_mutex_);
+
+		// The scale of ScaledInt32 values is taken from the first sample
+		if (data_->end_pos() == 0)
+			data_->set_decimal_places(decimal_places);
+
+		if (frame_open_)
+			dropped = finish_frame();
+		open_frame_ = { data_->end_pos(), 0, timestamp, samplerate };
+		frame_open_ = true;
+		append_values(data, count);
+		dropped = finish_frame() || dropped;
+		digits_chngd = set_digits(digits, decimal_places);
+	}
+
+	if (dropped)
+		Q_EMIT samples_dropped(data_->begin_pos());
+	if (digits_chngd)
+		Q_EMIT digits_changed(digits, decimal_places);
+}
+
+template void AnalogSegmentSignal::push_frame<float>(const float *, size_t,
+	double, uint64_t, int, int);
+template void AnalogSegmentSignal::push_frame<double>(const double *, size_t,
+	double, uint64_t, int, int);
+
+void AnalogSegmentSignal::begin_frame(double timestamp, uint64_t samplerate)
+{
+	bool dropped = false;
+	{
+		lock_guard<mutex> lock(write_mutex_);
+		if (frame_open_)
+			dropped = finish_frame();
+		open_frame_ = { data_->end_pos(), 0, timestamp, samplerate };
+		frame_open_ = true;
+	}
+
+	if (dropped)
+		Q_EMIT samples_dropped(data_->begin_pos());
+}
+
+template<typename T>
+void AnalogSegmentSignal::append_frame_samples(const T *data, size_t count,
+	size_t stride)
+{
+	lock_guard<mutex> lock(write_mutex_);
+	if (!frame_open_) {
+		qWarning() << "AnalogSegmentSignal::append_frame_samples(): "
+			<< display_name() << ": No frame was begun!";
+		return;
+	}
+
+	if (stride <= 1) {
+		append_values(data, count);
+		return;
+	}
+
+	// Deinterleave the samples in blocks on the stack
+	T block[strided_block_size_];
+	for (size_t offset = 0; offset < count; offset += strided_block_size_) {
+		const size_t n = std::min(count - offset, strided_block_size_);
+		samplekernels::deinterleave(data + offset * stride, n, stride, block);
+		append_values(block, n);
+	}
+}
+
+template void AnalogSegmentSignal::append_frame_samples<float>(
+	const float *, size_t, size_t);
+template void AnalogSegmentSignal::append_frame_samples<double>(
+	const double *, size_t, size_t);
+
+void AnalogSegmentSignal::end_frame(int digits, int decimal_places)
+{
+	bool dropped = false;
+	bool digits_chngd;
+	{
+		lock_guard<mutex> lock(write_mutex_);
+		if (frame_open_)
+			dropped = finish_frame();
+		digits_chngd = set_digits(digits, decimal_places);
+	}
+
+	if (dropped)
+		Q_EMIT samples_dropped(data_->begin_pos());
+	if (digits_chngd)
+		Q_EMIT digits_changed(digits, decimal_places);
+}
+
+bool AnalogSegmentSignal::in_frame() const
+{
+	return frame_open_;
+}
+
+template<typename T>
+void AnalogSegmentSignal::append_values(const T *data, size_t count)
+{
+	if (count == 0)
+		return;
+
+	double min = min_value_;
+	double max = max_value_;
+	samplekernels::min_max(data, count, min, max);
+	min_value_ = min;
+	max_value_ = max;
+	last_value_ = (double)data[count - 1];
+	for (size_t i = 0; i < count; ++i)
+		statistics_.add((double)data[i]);
+
+	data_->push_back(data, count);
+	open_frame_.sample_count += count;
+}
+
+bool AnalogSegmentSignal::finish_frame()
+{
+	frame_open_ = false;
+	if (open_frame_.sample_count == 0)
+		return false;
+
+	// The values are already written, publish them with the frame header
+	frames_.push_back(open_frame_);
+	statistics_.publish();
+	sample_count_.store(data_->end_pos(), std::memory_order_release);
+	notifier_->notify(data_->end_pos());
+
+	const size_t max_frames = retention_max_frames_;
+	if (max_frames == 0 || frames_.size() <= max_frames)
+		return false;
+	drop_frames(frames_.size() - max_frames);
+	return true;
+}
+
+void AnalogSegmentSignal::drop_frames(size_t count)
+{
+	count = std::min(count, frames_.size());
+	if (count == 0)
+		return;
+
+	// The first value, that is still needed, is the first value of the next
+	// frame or of the open frame.
+	const size_t next_pos = frames_.begin_pos() + count;
+	const size_t value_pos = next_pos < frames_.end_pos() ?
+		frames_[next_pos].first_pos : open_frame_.first_pos;
+
+	// The frame buffer must be dropped first, see copy_frame_values()
+	frames_.drop_front(count);
+	if (value_pos > data_->begin_pos())
+		data_->drop_front(value_pos - data_->begin_pos());
+}
+
+bool AnalogSegmentSignal::set_digits(int digits, int decimal_places)
+{
+	bool digits_chngd = false;
+	if (digits != digits_) {
+		digits_ = digits;
+		digits_chngd = true;
+	}
+	if (decimal_places != decimal_places_) {
+		decimal_places_ = decimal_places;
+		digits_chngd = true;
+	}
+	return digits_chngd;
+}
+
+size_t AnalogSegmentSignal::frame_count() const
+{
+	return frames_.end_pos();
+}
+
+size_t AnalogSegmentSignal::first_frame_pos() const
+{
+	return frames_.begin_pos();
+}
+
+bool AnalogSegmentSignal::get_frame(size_t frame_pos, AnalogFrame &frame) const
+{
+	const unsigned int generation = frames_.generation();
+	if (frame_pos < frames_.begin_pos() || frame_pos >= frames_.end_pos())
+		return false;
+
+	frame = frames_[frame_pos];
+	return frames_.is_valid_read(frame_pos, generation);
+}
+
+size_t AnalogSegmentSignal::copy_frame_values(size_t frame_pos,
+	size_t offset, size_t count, double *values) const
+{
+	// Frames are dropped before their values, so a value range, that is
+	// still valid after the copy, belongs to the frame.
+	const unsigned int generation = data_->generation();
+	AnalogFrame frame;
+	if (!get_frame(frame_pos, frame) || offset >= frame.sample_count)
+		return 0;
+
+	count = std::min(count, frame.sample_count - offset);
+	const size_t pos = frame.first_pos + offset;
+	if (pos < data_->begin_pos())
+		return 0;
+	data_->copy(pos, count, values);
+	if (!data_->is_valid_read(pos, generation))
+		return 0;
+	return count;
+}
+
+size_t AnalogSegmentSignal::retained_sample_count() const
+{
+	const size_t begin_pos = data_->begin_pos();
+	const size_t end_pos = sample_count_.load(std::memory_order_acquire);
+	return end_pos > begin_pos ? end_pos - begin_pos : 0;
+}
+
+void AnalogSegmentSignal::set_retention_max_frames(size_t max_frames)
+{
+	bool dropped = false;
+	{
+		lock_guard<mutex> lock(write_mutex_);
+		retention_max_frames_ = max_frames;
+		if (max_frames > 0 && frames_.size() > max_frames) {
+			drop_frames(frames_.size() - max_frames);
+			dropped = true;
+		}
+	}
+	if (dropped)
+		Q_EMIT samples_dropped(data_->begin_pos());
+}
+
+size_t AnalogSegmentSignal::retention_max_frames() const
+{
+	return retention_max_frames_;
+}
+
+bool AnalogSegmentSignal::set_spill_to_disk(bool spill_to_disk)
+{
+	lock_guard<mutex> lock(write_mutex_);
+	if (spill_to_disk == spill_to_disk_)
+		return true;
+
+	shared_ptr<SpillFile> spill_file;
+	if (spill_to_disk) {
+		if (!spill_file_)
+			spill_file_ = make_shared<SpillFile>();
+		if (!spill_file_->open()) {
+			qWarning() << "AnalogSegmentSignal::set_spill_to_disk(): "
+				<< display_name() << ": Can't create spill file!";
+			return false;
+		}
+		spill_file = spill_file_;
+	}
+	// The frame headers are small and stay in memory
+	data_->set_spill_file(spill_file);
+	spill_to_disk_ = spill_to_disk;
+	return true;
+}
+
+bool AnalogSegmentSignal::spill_to_disk() const
+{
+	return spill_to_disk_;
+}
+
+size_t AnalogSegmentSignal::memory_size() const
+{
+	return frames_.memory_size() + data_->memory_size();
+}
+
+size_t AnalogSegmentSignal::spilled_size() const
+{
+	return data_->spilled_size();
+}
+
+size_t AnalogSegmentSignal::evict_samples(size_t count)
+{
+	size_t dropped = 0;
+	{
+		lock_guard<mutex> lock(write_mutex_);
+		// Only whole frames are dropped and the newest frame is always kept
+		const size_t begin_pos = frames_.begin_pos();
+		const size_t end_pos = frames_.end_pos();
+		size_t frames = 0;
+		while (dropped < count && begin_pos + frames + 1 < end_pos) {
+			dropped += frames_[begin_pos + frames].sample_count;
+			++frames;
+		}
+		if (frames > 0) {
+			const size_t value_begin = data_->begin_pos();
+			drop_frames(frames);
+			dropped = data_->begin_pos() - value_begin;
+		}
+	}
+	if (dropped > 0)
+		Q_EMIT samples_dropped(data_->begin_pos());
+	return dropped;
+}
+
+} // namespace data
+} // namespace sv
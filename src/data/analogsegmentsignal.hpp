@@ -0,0 +1,213 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_ANALOGSEGMENTSIGNAL_HPP
+#define DATA_ANALOGSEGMENTSIGNAL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <string>
+
+#include <QObject>
+
+#include "src/data/analogbasesignal.hpp"
+#include "src/data/chunkedbuffer.hpp"
+#include "src/data/datautil.hpp"
+#include "src/data/spillfile.hpp"
+
+using std::set;
+using std::shared_ptr;
+using std::string;
+
+namespace sv {
+namespace data {
+
+/**
+ * The header of a frame in an AnalogSegmentSignal.
+ */
+struct AnalogFrame
+{
+	/** The absolute position of the first value of the frame. */
+	size_t first_pos;
+	size_t sample_count;
+	/** The absolute timestamp of the first value. */
+	double timestamp;
+	uint64_t samplerate;
+};
+
+/**
+ * A signal, that stores whole acquisition frames of a scope like device: N
+ * values with a known samplerate and the timestamp of the frame.
+ *
+ * The values of all frames are stored contiguously in one value buffer
+ * (as float by default) and each frame only adds one header. Unlike
+ * AnalogTimeSignal there are no per sample timestamps, summaries or runs,
+ * so high rate captures (kS/s to MS/s) need about 4 bytes per value and
+ * appending a frame is a copy.
+ *
+ * A frame is either pushed at once with push_frame() or streamed with
+ * begin_frame(), append_frame_samples() and end_frame(), e.g. from the
+ * packets of a device. The frame is published to the readers, when it is
+ * complete. Like the other signals, there is one (serialized) writer and
+ * any number of lock-free readers. Frames are addressed by their absolute
+ * position, which stays stable when old frames are dropped.
+ */
+class AnalogSegmentSignal : public AnalogBaseSignal
+{
+	Q_OBJECT
+
+public:
+	AnalogSegmentSignal(
+		data::Quantity quantity,
+		const set<data::QuantityFlag> &quantity_flags,
+		data::Unit unit,
+		shared_ptr<channels::BaseChannel> parent_channel,
+		const string &custom_name = "");
+
+	/**
+	 * Clear all frames from this signal.
+	 */
+	void clear() override;
+
+	/**
+	 * Push a complete frame of count values. T is float or double.
+	 */
+	template<typename T>
+	void push_frame(const T *data, size_t count, double timestamp,
+		uint64_t samplerate, int digits, int decimal_places);
+
+	/**
+	 * Start a new frame, an open frame is ended first.
+	 */
+	void begin_frame(double timestamp, uint64_t samplerate);
+
+	/**
+	 * Append count values, that are stride values apart, to the open frame.
+	 * T is float or double. The values are not visible, until the frame is
+	 * ended.
+	 */
+	template<typename T>
+	void append_frame_samples(const T *data, size_t count, size_t stride = 1);
+
+	/**
+	 * End and publish the open frame. An empty frame is discarded.
+	 */
+	void end_frame(int digits, int decimal_places);
+
+	/** Return true if a frame was begun and not ended yet. */
+	bool in_frame() const;
+
+	/**
+	 * Return the number of published frames, i.e. the position behind the
+	 * newest frame.
+	 */
+	size_t frame_count() const;
+
+	/** Return the position of the oldest frame, that is still stored. */
+	size_t first_frame_pos() const;
+
+	/**
+	 * Return the header of the frame at the absolute position frame_pos in
+	 * &frame.
+	 *
+	 * @return false if the frame was dropped or doesn't exist yet.
+	 */
+	bool get_frame(size_t frame_pos, AnalogFrame &frame) const;
+
+	/**
+	 * Copy up to count values of the frame at frame_pos, starting at the
+	 * value offset in the frame, to values.
+	 *
+	 * @return The number of copied values. 0 if the frame doesn't exist or
+	 *         was dropped while copying it.
+	 */
+	size_t copy_frame_values(size_t frame_pos, size_t offset, size_t count,
+		double *values) const;
+
+	size_t retained_sample_count() const override;
+
+	/**
+	 * Limit the number of frames stored in the signal. When the limit is
+	 * exceeded, the oldest frames are dropped.
+	 *
+	 * @param max_frames The maximum number of frames. 0 means unlimited.
+	 */
+	void set_retention_max_frames(size_t max_frames);
+	size_t retention_max_frames() const;
+
+	/** See AnalogTimeSignal::set_spill_to_disk(). */
+	bool set_spill_to_disk(bool spill_to_disk) override;
+	bool spill_to_disk() const override;
+
+	size_t memory_size() const override;
+	size_t spilled_size() const override;
+
+	/**
+	 * Drop the oldest frames, until at least count values are dropped. The
+	 * newest frame is always kept. See BaseSignal::evict_samples().
+	 */
+	size_t evict_samples(size_t count) override;
+
+private:
+	/**
+	 * Publish the open frame. write_mutex_ must be locked by the caller.
+	 *
+	 * @return true if frames were dropped by the retention policy.
+	 */
+	bool finish_frame();
+
+	/**
+	 * Store count contiguous values in the open frame. write_mutex_ must be
+	 * locked by the caller.
+	 */
+	template<typename T>
+	void append_values(const T *data, size_t count);
+
+	/**
+	 * Drop the count oldest frames. write_mutex_ must be locked by the
+	 * caller.
+	 */
+	void drop_frames(size_t count);
+
+	/** Update digits_ and decimal_places_, returns true if they changed. */
+	bool set_digits(int digits, int decimal_places);
+
+	/**
+	 * The number of values, that are deinterleaved at once on the stack by
+	 * append_frame_samples().
+	 */
+	static const size_t strided_block_size_;
+
+	ChunkedBuffer<AnalogFrame> frames_;
+	/** The header of the open frame, only used by the writer. */
+	AnalogFrame open_frame_;
+	std::atomic<bool> frame_open_;
+	std::atomic<size_t> retention_max_frames_;
+	shared_ptr<SpillFile> spill_file_;
+	std::atomic<bool> spill_to_disk_;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_ANALOGSEGMENTSIGNAL_HPP
@@ -19,29 +19,50 @@
 
 #include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <limits>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 
 #include <QDebug>
+#include <QMetaMethod>
+#include <QMetaType>
 #include <QString>
 
 #include "analogtimesignal.hpp"
+#include "src/tracer.hpp"
 #include "src/util.hpp"
 #include "src/channels/basechannel.hpp"
+#include "src/data/analogtimesnapshot.hpp"
 #include "src/data/basesignal.hpp"
+#include "src/data/chunkedbuffer.hpp"
 #include "src/data/datautil.hpp"
+#include "src/data/minmaxpyramid.hpp"
+#include "src/data/samplekernels.hpp"
+#include "src/data/spillfile.hpp"
+#include "src/data/timebase.hpp"
+#include "src/data/valuebuffer.hpp"
 
+using std::lock_guard;
 using std::make_pair;
 using std::make_shared;
+using std::mutex;
 using std::set;
 using std::shared_ptr;
 using std::string;
+using std::unique_lock;
 using std::vector;
 
 namespace sv {
 namespace data {
 
+const size_t AnalogTimeSignal::combine_block_size_ = 4096;
+const size_t AnalogTimeSignal::strided_block_size_ = 1024;
+
 AnalogTimeSignal::AnalogTimeSignal(
 		data::Quantity quantity,
 		const set<data::QuantityFlag> &quantity_flags,
@@ -50,26 +71,74 @@ AnalogTimeSignal::AnalogTimeSignal(
 		double signal_start_timestamp,
 		const string &custom_name) :
 	AnalogBaseSignal(quantity, quantity_flags, unit, parent_channel, custom_name),
+	lower_index_hint_(0),
 	signal_start_timestamp_(signal_start_timestamp),
-	last_timestamp_(0.)
+	last_timestamp_(0.),
+	time_skew_(0.),
+	retention_max_samples_(0),
+	retention_max_age_(0.),
+	spill_to_disk_(false),
+	snapshot_pins_(0),
+	full_rate_signal_(nullptr),
+	full_rate_pre_trigger_(0.),
+	full_rate_post_trigger_(0.),
+	full_rate_timestamps_(10),
+	full_rate_values_(10),
+	full_rate_promote_until_(-std::numeric_limits<double>::infinity()),
+	full_rate_last_timestamp_(-std::numeric_limits<double>::infinity()),
+	waiter_count_(0)
 {
 	qWarning() << "Init analog time signal " << display_name()
 		<< ", signal_start_timestamp_ = "
 		<< util::format_time_date(signal_start_timestamp_);
 
-	time_ = make_shared<vector<double>>();
+	time_ = make_shared<TimeBase>();
+	pyramid_ = make_shared<MinMaxPyramid>();
+
+	qRegisterMetaType<shared_ptr<const AnalogTimeSampleRange>>();
 }
 
 void AnalogTimeSignal::clear()
 {
-	// TODO: mutex
-	time_->clear();
-	data_->clear();
-	sample_count_ = 0;
+	{
+		lock_guard<mutex> lock(write_mutex_);
+		sample_count_.store(0, std::memory_order_release);
+		time_->clear();
+		data_->clear();
+		pyramid_->clear();
+		statistics_.clear();
+		notifier_->reset();
+		decimator_.reset();
+		clear_full_rate_ring();
+		promoted_timestamps_.clear();
+		promoted_values_.clear();
+		full_rate_promote_until_ = -std::numeric_limits<double>::infinity();
+		full_rate_last_timestamp_ = -std::numeric_limits<double>::infinity();
+		if (shared_memory_ring_)
+			shared_memory_ring_->reset(0);
+		clear_epoch_.fetch_add(1, std::memory_order_release);
+		notify_waiters();
+	}
 
+	sample_bus_->publish_cleared();
 	Q_EMIT samples_cleared();
 }
 
+bool AnalogTimeSignal::read_sample(
+	size_t pos, double &timestamp, double &value) const
+{
+	// The time buffer is always dropped/cleared before the data buffer, so
+	// validating the read against the time buffer covers both buffers.
+	const unsigned int generation = time_->generation();
+	if (pos < time_->begin_pos() ||
+			pos >= sample_count_.load(std::memory_order_acquire))
+		return false;
+
+	timestamp = time_->timestamp(pos);
+	value = (*data_)[pos];
+	return time_->is_valid_read(pos, generation);
+}
+
 analog_time_sample_t AnalogTimeSignal::get_sample(
 	size_t pos, bool relative_time) const
 {
@@ -78,199 +147,792 @@ analog_time_sample_t AnalogTimeSignal::get_sample(
 	//qWarning() << "AnalogSignal::get_sample(" << pos
 	//	<< "): sample_count_ = " << sample_count_;
 
-	if (pos < sample_count_) {
-		double timestamp = time_->at(pos);
+	double timestamp;
+	double value;
+	if (read_sample(pos, timestamp, value)) {
 		if (relative_time)
 			timestamp -= signal_start_timestamp_;
 		//qWarning() << "AnalogSignal::get_sample(" << pos
-		//	<< "): sample = " << timestamp << ", " << data_->at(pos);
-		return make_pair(timestamp, data_->at(pos));
+		//	<< "): sample = " << timestamp << ", " << value;
+		return make_pair(timestamp, value);
 	}
 
 	return make_pair(0., 0.);
 }
 
+size_t AnalogTimeSignal::copy_samples(size_t pos, size_t count,
+	bool relative_time, double *timestamps, double *values) const
+{
+	const unsigned int generation = time_->generation();
+	const size_t end_pos = sample_count_.load(std::memory_order_acquire);
+	if (pos < time_->begin_pos() || pos >= end_pos)
+		return 0;
+
+	count = std::min(count, end_pos - pos);
+	if (timestamps != nullptr)
+		time_->copy(pos, count, timestamps);
+	if (values != nullptr)
+		data_->copy(pos, count, values);
+	if (!time_->is_valid_read(pos, generation))
+		return 0;
+
+	if (relative_time && timestamps != nullptr) {
+		const double start_timestamp = signal_start_timestamp_;
+		for (size_t i = 0; i < count; ++i)
+			timestamps[i] -= start_timestamp;
+	}
+	return count;
+}
+
+vector<analog_time_sample_t> AnalogTimeSignal::get_samples(
+	size_t pos, size_t count, bool relative_time) const
+{
+	vector<analog_time_sample_t> samples;
+
+	const size_t end_pos = sample_count_.load(std::memory_order_acquire);
+	if (pos >= end_pos)
+		return samples;
+	count = std::min(count, end_pos - pos);
+
+	vector<double> timestamps(count);
+	vector<double> values(count);
+	count = copy_samples(pos, count, relative_time,
+		timestamps.data(), values.data());
+	samples.reserve(count);
+	for (size_t i = 0; i < count; ++i)
+		samples.push_back(make_pair(timestamps[i], values[i]));
+	return samples;
+}
+
 analog_time_sample_t AnalogTimeSignal::get_last_sample(bool relative_time) const
 {
 	// TODO: retrun reference (&double)? See get_value_at_timestamp()
-	if (sample_count_ == 0)
+	const size_t count = sample_count_.load(std::memory_order_acquire);
+	double timestamp;
+	double value;
+	if (count == 0 || !read_sample(count - 1, timestamp, value))
 		return make_pair(0., 0.);
 
-	size_t pos = sample_count_ - 1;
-	double timestamp = time_->at(pos);
 	if (relative_time)
 		timestamp -= signal_start_timestamp_;
-	return make_pair(timestamp, data_->at(pos));
+	return make_pair(timestamp, value);
 }
 
 bool AnalogTimeSignal::get_value_at_timestamp(
 	double timestamp, double &value, bool relative_time) const
 {
-	if (time_->empty())
-		return false;
-	if (timestamp < time_->at(0))
-		return false;
-	if (timestamp > time_->back())
+	const unsigned int generation = time_->generation();
+	const size_t begin_pos = time_->begin_pos();
+	const size_t end_pos = sample_count_.load(std::memory_order_acquire);
+	if (end_pos <= begin_pos)
 		return false;
 
 	if (relative_time)
 		timestamp += signal_start_timestamp_;
 
-	auto lower = std::lower_bound(time_->begin(), time_->end(), timestamp);
+	if (timestamp < time_->timestamp(begin_pos))
+		return false;
+	if (timestamp > time_->timestamp(end_pos - 1))
+		return false;
+
+	size_t lower_pos = time_->lower_bound(timestamp, begin_pos, end_pos);
 
 	// Check if timestamp and found timestamp match
-	if (timestamp == *lower) {
-		value = *lower;
-		return true;
+	if (timestamp == time_->timestamp(lower_pos)) {
+		value = (*data_)[lower_pos];
+		return time_->is_valid_read(begin_pos, generation);
 	}
 
-	size_t lower_pos = lower - time_->begin();
-
 	// Get the previous timestamp for linear interpolation
-	if (lower_pos > 0)
+	if (lower_pos > begin_pos)
 		--lower_pos;
 
-	double lower_ts = time_->at(lower_pos);
-	double lower_data = data_->at(lower_pos);
+	double lower_ts = time_->timestamp(lower_pos);
+	double lower_data = (*data_)[lower_pos];
 	size_t upper_pos = lower_pos + 1;
-	double upper_ts = time_->at(upper_pos);
+	double upper_ts = time_->timestamp(upper_pos);
 
 	// Use linear interpolation to get the value beetween time stamps
 	double ts_factor = (timestamp - lower_ts) / (upper_ts - lower_ts);
-	double data_diff = data_->at(upper_pos) - lower_data;
+	double data_diff = (*data_)[upper_pos] - lower_data;
 	double lininter_data = lower_data + (data_diff * ts_factor);
 
+	// All reads were done at positions >= begin_pos
+	if (!time_->is_valid_read(begin_pos, generation))
+		return false;
+
 	value = lininter_data;
 	return true;
 }
 
+size_t AnalogTimeSignal::lower_index_unchecked(double timestamp,
+	size_t begin_pos, size_t end_pos) const
+{
+	size_t hint = lower_index_hint_.load(std::memory_order_relaxed);
+	if (hint < begin_pos || hint > end_pos)
+		return time_->lower_bound(timestamp, begin_pos, end_pos);
+
+	// Gallop from the hint towards the timestamp
+	if (hint > begin_pos && time_->timestamp(hint - 1) >= timestamp) {
+		size_t step = 1;
+		size_t upper = hint - 1;
+		while (upper - begin_pos >= step &&
+				time_->timestamp(upper - step) >= timestamp) {
+			upper -= step;
+			step *= 2;
+		}
+		const size_t lower = upper - begin_pos >= step ?
+			upper - step : begin_pos;
+		return time_->lower_bound(timestamp, lower, upper);
+	}
+	if (hint < end_pos && time_->timestamp(hint) < timestamp) {
+		size_t step = 1;
+		size_t lower = hint + 1;
+		while (end_pos - lower > step &&
+				time_->timestamp(lower + step - 1) < timestamp) {
+			lower += step;
+			step *= 2;
+		}
+		const size_t upper = std::min(lower + step, end_pos);
+		return time_->lower_bound(timestamp, lower, upper);
+	}
+	return hint;
+}
+
+size_t AnalogTimeSignal::lower_index(double timestamp, bool relative_time) const
+{
+	if (relative_time)
+		timestamp += signal_start_timestamp_;
+
+	while (true) {
+		const unsigned int generation = time_->generation();
+		const size_t begin_pos = time_->begin_pos();
+		const size_t end_pos = sample_count_.load(std::memory_order_acquire);
+		if (end_pos <= begin_pos)
+			return end_pos;
+
+		const size_t pos = lower_index_unchecked(timestamp, begin_pos, end_pos);
+		// Retry if samples were dropped/cleared while searching
+		if (time_->is_valid_read(begin_pos, generation)) {
+			lower_index_hint_.store(pos, std::memory_order_relaxed);
+			return pos;
+		}
+	}
+}
+
+pair<size_t, size_t> AnalogTimeSignal::index_range(double start_timestamp,
+	double end_timestamp, bool relative_time) const
+{
+	if (relative_time) {
+		start_timestamp += signal_start_timestamp_;
+		end_timestamp += signal_start_timestamp_;
+	}
+
+	while (true) {
+		const unsigned int generation = time_->generation();
+		const size_t begin_pos = time_->begin_pos();
+		const size_t end_pos = sample_count_.load(std::memory_order_acquire);
+		if (end_pos <= begin_pos || end_timestamp < start_timestamp)
+			return make_pair(end_pos, end_pos);
+
+		const size_t first_pos =
+			lower_index_unchecked(start_timestamp, begin_pos, end_pos);
+		// The end timestamp is part of the range
+		size_t last_pos = time_->lower_bound(end_timestamp, first_pos, end_pos);
+		if (last_pos < end_pos && time_->timestamp(last_pos) == end_timestamp)
+			++last_pos;
+
+		if (time_->is_valid_read(begin_pos, generation)) {
+			lower_index_hint_.store(first_pos, std::memory_order_relaxed);
+			return make_pair(first_pos, last_pos);
+		}
+	}
+}
+
+bool AnalogTimeSignal::get_summary(size_t first_pos, size_t last_pos,
+	bool relative_time, AnalogSummary &summary) const
+{
+	const unsigned int generation = time_->generation();
+	first_pos = std::max(first_pos, time_->begin_pos());
+	last_pos = std::min(
+		last_pos, sample_count_.load(std::memory_order_acquire));
+	if (first_pos >= last_pos)
+		return false;
+
+	pyramid_->summarize(*time_, *data_, first_pos, last_pos, summary);
+	summary.start_timestamp = time_->timestamp(first_pos);
+	summary.end_timestamp = time_->timestamp(last_pos - 1);
+	if (relative_time) {
+		summary.start_timestamp -= signal_start_timestamp_;
+		summary.end_timestamp -= signal_start_timestamp_;
+	}
+
+	return time_->is_valid_read(first_pos, generation);
+}
+
+bool AnalogTimeSignal::get_range_summary(double start_timestamp,
+	double end_timestamp, bool relative_time, AnalogSummary &summary) const
+{
+	// Retry if samples were dropped/cleared while reading the summary
+	while (true) {
+		const auto range =
+			index_range(start_timestamp, end_timestamp, relative_time);
+		if (range.first >= range.second)
+			return false;
+		if (get_summary(range.first, range.second, relative_time, summary))
+			return true;
+	}
+}
+
+vector<AnalogSummary> AnalogTimeSignal::get_summaries(double start_timestamp,
+	double end_timestamp, size_t count, bool relative_time) const
+{
+	vector<AnalogSummary> summaries;
+
+	const unsigned int generation = time_->generation();
+	const size_t begin_pos = time_->begin_pos();
+	const size_t end_pos = sample_count_.load(std::memory_order_acquire);
+	if (count == 0 || end_pos <= begin_pos || end_timestamp < start_timestamp)
+		return summaries;
+
+	if (relative_time) {
+		start_timestamp += signal_start_timestamp_;
+		end_timestamp += signal_start_timestamp_;
+	}
+
+	// The end timestamp is part of the range
+	size_t last_pos = time_->lower_bound(end_timestamp, begin_pos, end_pos);
+	if (last_pos < end_pos && time_->timestamp(last_pos) == end_timestamp)
+		++last_pos;
+
+	summaries.reserve(count);
+	const double bin_length = (end_timestamp - start_timestamp) / (double)count;
+	size_t bin_first_pos =
+		time_->lower_bound(start_timestamp, begin_pos, last_pos);
+	for (size_t i = 1; i <= count && bin_first_pos < last_pos; ++i) {
+		size_t bin_last_pos = last_pos;
+		if (i < count) {
+			bin_last_pos = time_->lower_bound(
+				start_timestamp + (double)i * bin_length,
+				bin_first_pos, last_pos);
+		}
+		if (bin_last_pos <= bin_first_pos)
+			continue;
+
+		AnalogSummary summary;
+		pyramid_->summarize(*time_, *data_, bin_first_pos, bin_last_pos,
+			summary);
+		summary.start_timestamp = time_->timestamp(bin_first_pos);
+		summary.end_timestamp = time_->timestamp(bin_last_pos - 1);
+		if (relative_time) {
+			summary.start_timestamp -= signal_start_timestamp_;
+			summary.end_timestamp -= signal_start_timestamp_;
+		}
+		summaries.push_back(summary);
+
+		bin_first_pos = bin_last_pos;
+	}
+
+	// Samples were dropped/cleared while reading, the result is invalid
+	if (!time_->is_valid_read(begin_pos, generation))
+		summaries.clear();
+
+	return summaries;
+}
+
+vector<AnalogSummary> AnalogTimeSignal::get_interval_summaries(
+	double start_timestamp, double interval, size_t first_bin, size_t count,
+	bool relative_time) const
+{
+	const unsigned int generation = time_->generation();
+	const size_t begin_pos = time_->begin_pos();
+	const size_t end_pos = sample_count_.load(std::memory_order_acquire);
+	auto summaries = interval_summaries_unchecked(begin_pos, end_pos,
+		start_timestamp, interval, first_bin, count, relative_time);
+
+	// Samples were dropped/cleared while reading, the result is invalid
+	if (!time_->is_valid_read(begin_pos, generation))
+		summaries.clear();
+
+	return summaries;
+}
+
+vector<AnalogSummary> AnalogTimeSignal::interval_summaries_unchecked(
+	size_t first_pos, size_t last_pos, double start_timestamp,
+	double interval, size_t first_bin, size_t count, bool relative_time) const
+{
+	vector<AnalogSummary> summaries;
+	if (count == 0 || !(interval > 0.))
+		return summaries;
+
+	const double offset = relative_time ? signal_start_timestamp_ : 0.;
+	start_timestamp += offset;
+	const double nan = std::numeric_limits<double>::quiet_NaN();
+
+	summaries.reserve(count);
+	double bin_start = start_timestamp + (double)first_bin * interval;
+	size_t bin_first_pos = first_pos < last_pos ?
+		time_->lower_bound(bin_start, first_pos, last_pos) : last_pos;
+	for (size_t i = 0; i < count; ++i) {
+		const double bin_end =
+			start_timestamp + (double)(first_bin + i + 1) * interval;
+		const size_t bin_last_pos = bin_first_pos < last_pos ?
+			time_->lower_bound(bin_end, bin_first_pos, last_pos) : last_pos;
+
+		AnalogSummary summary;
+		if (bin_last_pos > bin_first_pos) {
+			pyramid_->summarize(*time_, *data_, bin_first_pos, bin_last_pos,
+				summary);
+			summary.start_timestamp = time_->timestamp(bin_first_pos) - offset;
+			summary.end_timestamp = time_->timestamp(bin_last_pos - 1) - offset;
+		}
+		else {
+			summary = AnalogSummary{ bin_start - offset, bin_end - offset,
+				nan, nan, nan, nan, 0., 0., 0 };
+		}
+		summaries.push_back(summary);
+
+		bin_start = bin_end;
+		bin_first_pos = bin_last_pos;
+	}
+
+	return summaries;
+}
+
+double AnalogTimeSignal::mean_since(double timestamp,
+	bool relative_time) const
+{
+	AnalogSummary summary;
+	if (!get_range_summary(timestamp, std::numeric_limits<double>::infinity(),
+			relative_time, summary))
+		return std::numeric_limits<double>::quiet_NaN();
+	return summary.mean;
+}
+
+bool AnalogTimeSignal::wait_for_samples(size_t count, double timeout) const
+{
+	const auto deadline = std::chrono::steady_clock::now() +
+		std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+			std::chrono::duration<double>(timeout));
+
+	unsigned int epoch = clear_epoch();
+	size_t start_pos = sample_count();
+	size_t end_pos = start_pos;
+	while (true) {
+		// After a clear(), the positions start at 0 again
+		if (clear_epoch() != epoch || end_pos < start_pos) {
+			epoch = clear_epoch();
+			start_pos = 0;
+			end_pos = sample_count();
+		}
+		if (end_pos - start_pos >= count)
+			return true;
+		if (!wait_for_change(end_pos, deadline))
+			return false;
+		end_pos = sample_count();
+	}
+}
+
+bool AnalogTimeSignal::wait_for_sample_count(size_t count,
+	double timeout) const
+{
+	return wait_for_change(count, std::chrono::steady_clock::now() +
+		std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+			std::chrono::duration<double>(timeout)));
+}
+
+bool AnalogTimeSignal::wait_stable(double tolerance, double duration,
+	double timeout) const
+{
+	const auto deadline = std::chrono::steady_clock::now() +
+		std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+			std::chrono::duration<double>(timeout));
+
+	size_t start_pos = sample_count();
+	size_t end_pos = start_pos;
+	while (true) {
+		if (end_pos < start_pos)
+			start_pos = 0;
+		start_pos = std::max(start_pos, first_sample_pos());
+		double first_timestamp;
+		double last_timestamp;
+		double value;
+		if (end_pos > start_pos &&
+				read_sample(start_pos, first_timestamp, value) &&
+				read_sample(end_pos - 1, last_timestamp, value) &&
+				last_timestamp - first_timestamp >= duration) {
+			// The window of the last duration seconds
+			const size_t first_pos = std::max(start_pos, lower_index(
+				last_timestamp - duration, false));
+			AnalogSummary summary;
+			if (get_summary(first_pos, end_pos, false, summary) &&
+					summary.max - summary.min <= tolerance)
+				return true;
+		}
+		if (!wait_for_change(end_pos, deadline))
+			return false;
+		end_pos = sample_count();
+	}
+}
+
 void AnalogTimeSignal::push_sample(void *sample, double timestamp,
 	size_t unit_size, int digits, int decimal_places)
 {
-	double dsample = 0.;
-	if (unit_size == size_of_float_)
-		dsample = (double) *(float *)sample;
-	else if (unit_size == size_of_double_)
-		dsample = *(double *)sample;
+	if (unit_size == size_of_float_) {
+		push_sample((double)*(float *)sample, timestamp,
+			digits, decimal_places);
+	}
+	else if (unit_size == size_of_double_) {
+		push_sample(*(double *)sample, timestamp, digits, decimal_places);
+	}
+	else {
+		qWarning() << "AnalogTimeSignal::push_sample(): "
+			<< display_name() << ": Unsupported unit size " << unit_size;
+	}
+}
 
+void AnalogTimeSignal::push_sample(double sample, double timestamp,
+	int digits, int decimal_places)
+{
 	/*
 	qWarning() << "AnalogTimeSignal::push_sample(): " << display_name()
-		<< ": sample = " << dsample << " @ " <<  timestamp;
+		<< ": sample = " << sample << " @ " <<  timestamp;
 	qWarning() << "AnalogTimeSignal::push_sample(): " << display_name()
 		<< ": sample_count_ = " << sample_count_+1;
 	*/
 
-	// TODO: Mutex?
+	bool dropped;
+	bool digits_chngd = false;
+	{
+		lock_guard<mutex> lock(write_mutex_);
+
+		// The scale of ScaledInt32 values is taken from the first sample
+		if (data_->end_pos() == 0)
+			data_->set_decimal_places(decimal_places);
+
+		// Write the sample first and then publish it to the readers
+		if (decimator_.is_active())
+			append_decimated_sample(timestamp, sample);
+		else
+			append_sample(timestamp, sample);
+		statistics_.publish();
+		flush_full_rate_samples();
+		write_shared_memory_ring(time_->end_pos());
+		sample_count_.store(time_->end_pos(), std::memory_order_release);
+		notifier_->notify(time_->end_pos());
+		notify_waiters();
+		dropped = apply_retention();
+
+		if (digits != digits_) {
+			digits_ = digits;
+			digits_chngd = true;
+		}
+		if (decimal_places != decimal_places_) {
+			decimal_places_ = decimal_places;
+			digits_chngd = true;
+		}
+	}
+
+	if (dropped)
+		Q_EMIT samples_dropped(time_->begin_pos());
+	if (digits_chngd)
+		Q_EMIT digits_changed(digits, decimal_places);
+}
+
+void AnalogTimeSignal::append_sample(double timestamp, double value)
+{
+	// The summaries must match the values, that are read back later
+	value = data_->stored_value(value);
 	last_timestamp_ = timestamp;
-	last_value_ = dsample;
-	if (min_value_ > dsample)
-		min_value_ = dsample;
+	last_value_ = value;
+	if (min_value_ > value)
+		min_value_ = value;
 	// Ignore infinitiy (overflow) as max value.
-	if (max_value_ < dsample &&
-		dsample != std::numeric_limits<double>::infinity()) {
+	if (max_value_ < value &&
+		value != std::numeric_limits<double>::infinity()) {
 
-		max_value_ = dsample;
+		max_value_ = value;
 	}
 
-	/*
-	qWarning() << "AnalogTimeSignal::push_sample(): " << display_name()
-		<< ": last_timestamp_ = " << last_timestamp_;
-	qWarning() << "AnalogTimeSignal::push_sample(): " << display_name()
-		<< ": last_value_ = " << last_value_;
-	qWarning() << "AnalogTimeSignal::push_sample(): " << display_name()
-		<< ": min_value_ = " << min_value_;
-	qWarning() << "AnalogTimeSignal::push_sample(): " << display_name()
-		<< ": max_value_ = " << max_value_;
-	*/
-
-	// TODO: Mutex?
 	time_->push_back(timestamp);
-	data_->push_back(dsample);
-	sample_count_++;
-	Q_EMIT sample_appended();
+	data_->push_back(value);
+	pyramid_->push_back(timestamp, value);
+	statistics_.add(value);
+}
 
-	bool digits_chngd = false;
-	if (digits != digits_) {
-		digits_ = digits;
-		digits_chngd = true;
-	}
-	if (decimal_places != decimal_places_) {
-		decimal_places_ = decimal_places;
-		digits_chngd = true;
+bool AnalogTimeSignal::append_external_chunk(const double *timestamps,
+	const double *values, shared_ptr<const void> owner)
+{
+	const size_t chunk_size = data_->chunk_size();
+	if (time_->chunk_size() != chunk_size ||
+			!time_->can_push_back_external() ||
+			!data_->can_push_back_external())
+		return false;
+
+	// The summaries still need all values, but no copy of them. External
+	// chunks are only possible with the double storage, so the values are
+	// stored unchanged.
+	for (size_t i = 0; i < chunk_size; ++i) {
+		const double value = values[i];
+		if (min_value_ > value)
+			min_value_ = value;
+		// Ignore infinitiy (overflow) as max value.
+		if (max_value_ < value &&
+			value != std::numeric_limits<double>::infinity()) {
+
+			max_value_ = value;
+		}
+		pyramid_->push_back(timestamps[i], value);
+		statistics_.add(value);
 	}
-	if (digits_chngd)
-		Q_EMIT digits_changed(digits_, decimal_places_);
+	last_timestamp_ = timestamps[chunk_size - 1];
+	last_value_ = values[chunk_size - 1];
+
+	time_->push_back_external(timestamps, owner);
+	data_->push_back_external(values, owner);
+	return true;
+}
+
+void AnalogTimeSignal::append_decimated_sample(double timestamp, double value)
+{
+	if (full_rate_signal_)
+		append_full_rate_sample(timestamp, value);
+
+	double timestamps[SampleDecimator::max_output_count];
+	double values[SampleDecimator::max_output_count];
+	const size_t count = decimator_.add(timestamp, value, timestamps, values);
+	for (size_t i = 0; i < count; ++i)
+		append_sample(timestamps[i], values[i]);
 }
 
 void AnalogTimeSignal::push_samples(void *data,
 	uint64_t samples, double timestamp, uint64_t samplerate, size_t unit_size,
-	int digits, int decimal_places)
+	int digits, int decimal_places, bool publish)
+{
+	// Dispatch once for all samples
+	if (unit_size == size_of_float_) {
+		push_samples((const float *)data, (size_t)samples, timestamp,
+			samplerate, digits, decimal_places, publish);
+	}
+	else if (unit_size == size_of_double_) {
+		push_samples((const double *)data, (size_t)samples, timestamp,
+			samplerate, digits, decimal_places, publish);
+	}
+	else {
+		qWarning() << "AnalogTimeSignal::push_samples(): "
+			<< display_name() << ": Unsupported unit size " << unit_size;
+	}
+}
+
+template<typename T>
+void AnalogTimeSignal::push_samples(const T *data, size_t count,
+	double timestamp, uint64_t samplerate, int digits, int decimal_places,
+	bool publish)
+{
+	push_strided_samples(data, count, 1, timestamp, samplerate,
+		digits, decimal_places, publish);
+}
+
+template<typename T>
+void AnalogTimeSignal::push_strided_samples(const T *data, size_t count,
+	size_t stride, double timestamp, uint64_t samplerate, int digits,
+	int decimal_places, bool publish)
 {
-	//lock_guard<recursive_mutex> lock(mutex_);
+	SV_TRACE_SCOPE("AnalogTimeSignal::push_samples");
 
-	double dsample = 0.0;
-	uint64_t pos = 0;
 	double time_stride = 0.0;
 	if (samplerate > 0)
 		time_stride = 1 / (double)samplerate;
 
-	/*
-	if (timestamp < last_timestamp_) {
-		qWarning() << "AnalogSignal::push_samples(): samples = " << samples
-			<<  ", timestamp < last_timestamp = "
-			<< timestamp-signal_start_timestamp_ << " < "
-			<< last_timestamp_-signal_start_timestamp_;
+	bool dropped;
+	bool digits_chngd = false;
+	{
+		lock_guard<mutex> lock(write_mutex_);
+
+		// The scale of ScaledInt32 values is taken from the first sample
+		if (data_->end_pos() == 0)
+			data_->set_decimal_places(decimal_places);
+
+		if (stride > 1)
+			append_strided_samples(data, count, stride, timestamp, time_stride);
+		else
+			append_samples(data, count, timestamp, time_stride);
+		statistics_.publish();
+		flush_full_rate_samples();
+		// Publish all new samples at once
+		if (publish) {
+			write_shared_memory_ring(time_->end_pos());
+			sample_count_.store(time_->end_pos(), std::memory_order_release);
+			notifier_->notify(time_->end_pos());
+			notify_waiters();
+		}
+		dropped = apply_retention();
+
+		if (digits != digits_) {
+			digits_ = digits;
+			digits_chngd = true;
+		}
+		if (decimal_places != decimal_places_) {
+			decimal_places_ = decimal_places;
+			digits_chngd = true;
+		}
 	}
-	*/
 
-	while (pos < samples) {
-		if (unit_size == size_of_float_)
-			dsample = (double) ((float *)data)[pos];
-		else if (unit_size == size_of_double_)
-			dsample = ((double *)data)[pos];
-
-		/*
-		qWarning() << "AnalogSignal::push_samples(): " << name_
-			<< ": sample = " << dsample << " @ "
-			<<  timestamp - signal_start_timestamp_;
-		qWarning() << "AnalogSignal::push_samples(): " << name_
-			<< ": remaining_samples = " << remaining_samples;
-		*/
-
-		// TODO: Mutex?
-		if (min_value_ > dsample)
-			min_value_ = dsample;
-		// Ignore infinitiy (overflow) as max value.
-		if (max_value_ < dsample &&
-			dsample != std::numeric_limits<double>::infinity()) {
+	if (dropped)
+		Q_EMIT samples_dropped(time_->begin_pos());
+	if (digits_chngd)
+		Q_EMIT digits_changed(digits, decimal_places);
+}
+
+template void AnalogTimeSignal::push_samples<float>(const float *, size_t,
+	double, uint64_t, int, int, bool);
+template void AnalogTimeSignal::push_samples<double>(const double *, size_t,
+	double, uint64_t, int, int, bool);
+template void AnalogTimeSignal::push_strided_samples<float>(const float *,
+	size_t, size_t, double, uint64_t, int, int, bool);
+template void AnalogTimeSignal::push_strided_samples<double>(const double *,
+	size_t, size_t, double, uint64_t, int, int, bool);
+
+void AnalogTimeSignal::push_samples(const double *timestamps,
+	const double *values, size_t count, int digits, int decimal_places,
+	shared_ptr<const void> owner)
+{
+	SV_TRACE_SCOPE("AnalogTimeSignal::push_samples");
 
-			max_value_ = dsample;
+	if (count == 0)
+		return;
+
+	bool dropped;
+	bool digits_chngd = false;
+	{
+		lock_guard<mutex> lock(write_mutex_);
+
+		// The scale of ScaledInt32 values is taken from the first sample
+		if (data_->end_pos() == 0)
+			data_->set_decimal_places(decimal_places);
+
+		const size_t chunk_size = data_->chunk_size();
+		size_t i = 0;
+		while (i < count) {
+			// Reference the chunks, that start at a chunk boundary
+			if (owner && !decimator_.is_active() && count - i >= chunk_size &&
+					append_external_chunk(
+						timestamps + i, values + i, owner)) {
+				i += chunk_size;
+				continue;
+			}
+			if (decimator_.is_active())
+				append_decimated_sample(timestamps[i], values[i]);
+			else
+				append_sample(timestamps[i], values[i]);
+			++i;
 		}
+		statistics_.publish();
+		flush_full_rate_samples();
+		write_shared_memory_ring(time_->end_pos());
+		sample_count_.store(time_->end_pos(), std::memory_order_release);
+		notifier_->notify(time_->end_pos());
+		notify_waiters();
+		dropped = apply_retention();
 
-		// TODO: Limit memory!
-		time_->push_back(timestamp);
-		data_->push_back(dsample);
+		if (digits != digits_) {
+			digits_ = digits;
+			digits_chngd = true;
+		}
+		if (decimal_places != decimal_places_) {
+			decimal_places_ = decimal_places;
+			digits_chngd = true;
+		}
+	}
 
-		timestamp += time_stride;
-		++pos;
-		++sample_count_;
+	if (dropped)
+		Q_EMIT samples_dropped(time_->begin_pos());
+	if (digits_chngd)
+		Q_EMIT digits_changed(digits, decimal_places);
+}
+
+void AnalogTimeSignal::publish_samples()
+{
+	lock_guard<mutex> lock(write_mutex_);
+
+	const size_t end_pos = time_->end_pos();
+	if (end_pos == sample_count_.load(std::memory_order_relaxed))
+		return;
+	write_shared_memory_ring(end_pos);
+	sample_count_.store(end_pos, std::memory_order_release);
+	notifier_->notify(end_pos);
+	notify_waiters();
+}
+
+template<typename T>
+void AnalogTimeSignal::append_samples(const T *data, size_t count,
+	double timestamp, double time_stride)
+{
+	if (count == 0)
+		return;
+
+	if (decimator_.is_active()) {
+		// The decimated timestamps don't form a fixed stride in general,
+		// they are stored as single timestamps. See TimeBase.
+		for (size_t i = 0; i < count; ++i) {
+			append_decimated_sample(
+				timestamp + (double)i * time_stride, (double)data[i]);
+		}
+		return;
 	}
 
-	last_timestamp_ = timestamp - time_stride;
-	last_value_ = dsample;
-	Q_EMIT sample_appended();
+	// The values are copied block wise into the chunks of the value buffer
+	data_->push_back(data, count);
 
-	bool digits_chngd = false;
-	if (digits != digits_) {
-		digits_ = digits;
-		digits_chngd = true;
+	double min_value = min_value_;
+	double max_value = max_value_;
+	if (data_->storage() == ValueStorage::Double) {
+		samplekernels::min_max(data, count, min_value, max_value);
+		for (size_t i = 0; i < count; ++i) {
+			const double value = (double)data[i];
+			pyramid_->push_back(timestamp + (double)i * time_stride, value);
+			statistics_.add(value);
+		}
+		last_value_ = (double)data[count - 1];
 	}
-	if (decimal_places != decimal_places_) {
-		decimal_places_ = decimal_places;
-		digits_chngd = true;
+	else {
+		// The summaries must match the rounded and saturated values, that
+		// are read back from the value buffer, not the raw values.
+		double block[strided_block_size_];
+		for (size_t offset = 0; offset < count;
+				offset += strided_block_size_) {
+			const size_t n = std::min(count - offset, strided_block_size_);
+			for (size_t i = 0; i < n; ++i)
+				block[i] = data_->stored_value((double)data[offset + i]);
+			samplekernels::min_max(block, n, min_value, max_value);
+			for (size_t i = 0; i < n; ++i) {
+				pyramid_->push_back(
+					timestamp + (double)(offset + i) * time_stride, block[i]);
+				statistics_.add(block[i]);
+			}
+			last_value_ = block[n - 1];
+		}
+	}
+	min_value_ = min_value;
+	max_value_ = max_value;
+
+	// The timestamps are not stored per sample, but as a run of
+	// timestamp + n * time_stride. See TimeBase.
+	time_->push_back(timestamp, time_stride, count);
+	last_timestamp_ = timestamp + (double)(count - 1) * time_stride;
+}
+
+template<typename T>
+void AnalogTimeSignal::append_strided_samples(const T *data, size_t count,
+	size_t stride, double timestamp, double time_stride)
+{
+	T block[strided_block_size_];
+	for (size_t offset = 0; offset < count; offset += strided_block_size_) {
+		const size_t n = std::min(count - offset, strided_block_size_);
+		samplekernels::deinterleave(data + offset * stride, n, stride, block);
+		append_samples((const T *)block, n,
+			timestamp + (double)offset * time_stride, time_stride);
 	}
-	if (digits_chngd)
-		Q_EMIT digits_changed(digits_, decimal_places_);
 }
 
 double AnalogTimeSignal::signal_start_timestamp() const
@@ -280,18 +942,26 @@ double AnalogTimeSignal::signal_start_timestamp() const
 
 double AnalogTimeSignal::first_timestamp(bool relative_time) const
 {
-	if (time_->empty())
-		return 0.;
+	double timestamp;
+	double value;
+	while (true) {
+		const size_t pos = time_->begin_pos();
+		if (pos >= sample_count_.load(std::memory_order_acquire))
+			return 0.;
+		// Retry if the first sample was dropped while reading it
+		if (read_sample(pos, timestamp, value))
+			break;
+	}
 
 	if (relative_time)
-		return time_->front() - signal_start_timestamp_;
+		return timestamp - signal_start_timestamp_;
 	else // NOLINT
-		return time_->front();
+		return timestamp;
 }
 
 double AnalogTimeSignal::last_timestamp(bool relative_time) const
 {
-	if (time_->empty())
+	if (sample_count_.load(std::memory_order_acquire) == 0)
 		return 0.;
 
 	if (relative_time)
@@ -300,6 +970,469 @@ double AnalogTimeSignal::last_timestamp(bool relative_time) const
 		return last_timestamp_;
 }
 
+size_t AnalogTimeSignal::first_sample_pos() const
+{
+	return time_->begin_pos();
+}
+
+AnalogTimeSnapshot AnalogTimeSignal::snapshot()
+{
+	return AnalogTimeSnapshot(shared_from_this());
+}
+
+size_t AnalogTimeSignal::retained_sample_count() const
+{
+	const size_t begin_pos = time_->begin_pos();
+	const size_t end_pos = sample_count_.load(std::memory_order_acquire);
+	return end_pos > begin_pos ? end_pos - begin_pos : 0;
+}
+
+void AnalogTimeSignal::set_retention_max_samples(size_t max_samples)
+{
+	bool dropped;
+	{
+		lock_guard<mutex> lock(write_mutex_);
+		retention_max_samples_ = max_samples;
+		dropped = apply_retention();
+	}
+	if (dropped)
+		Q_EMIT samples_dropped(time_->begin_pos());
+}
+
+size_t AnalogTimeSignal::retention_max_samples() const
+{
+	return retention_max_samples_;
+}
+
+void AnalogTimeSignal::set_retention_max_age(double max_age)
+{
+	bool dropped;
+	{
+		lock_guard<mutex> lock(write_mutex_);
+		retention_max_age_ = max_age;
+		dropped = apply_retention();
+	}
+	if (dropped)
+		Q_EMIT samples_dropped(time_->begin_pos());
+}
+
+double AnalogTimeSignal::retention_max_age() const
+{
+	return retention_max_age_;
+}
+
+bool AnalogTimeSignal::set_spill_to_disk(bool spill_to_disk)
+{
+	lock_guard<mutex> lock(write_mutex_);
+	if (spill_to_disk == spill_to_disk_)
+		return true;
+
+	shared_ptr<SpillFile> spill_file;
+	if (spill_to_disk) {
+		if (!spill_file_)
+			spill_file_ = make_shared<SpillFile>();
+		if (!spill_file_->open()) {
+			qWarning() << "AnalogTimeSignal::set_spill_to_disk(): "
+				<< display_name() << ": Can't create spill file!";
+			return false;
+		}
+		spill_file = spill_file_;
+	}
+	time_->set_spill_file(spill_file);
+	data_->set_spill_file(spill_file);
+	spill_to_disk_ = spill_to_disk;
+	return true;
+}
+
+bool AnalogTimeSignal::spill_to_disk() const
+{
+	return spill_to_disk_;
+}
+
+bool AnalogTimeSignal::export_shared_memory(const string &name,
+	size_t capacity)
+{
+	lock_guard<mutex> lock(write_mutex_);
+	shared_memory_ring_.reset();
+
+	unique_ptr<SharedMemoryRing> ring(new SharedMemoryRing());
+	const size_t begin_pos = time_->begin_pos();
+	const size_t end_pos = sample_count_.load(std::memory_order_relaxed);
+	if (!ring->open(name, capacity, end_pos, signal_start_timestamp_,
+			display_name().toStdString(), unit_name().toStdString())) {
+		qWarning() << "AnalogTimeSignal::export_shared_memory(): "
+			<< display_name() << ": Can't create the shared memory!";
+		return false;
+	}
+	shared_memory_ring_ = std::move(ring);
+
+	// Start with the latest samples, the ring keeps the last capacity
+	const size_t count = std::min(end_pos - begin_pos,
+		shared_memory_ring_->capacity());
+	shared_memory_ring_->reset(end_pos - count);
+	write_shared_memory_ring(end_pos);
+	return true;
+}
+
+void AnalogTimeSignal::stop_shared_memory_export()
+{
+	lock_guard<mutex> lock(write_mutex_);
+	shared_memory_ring_.reset();
+}
+
+string AnalogTimeSignal::shared_memory_name() const
+{
+	lock_guard<mutex> lock(write_mutex_);
+	return shared_memory_ring_ ? shared_memory_ring_->name() : "";
+}
+
+void AnalogTimeSignal::write_shared_memory_ring(size_t end_pos)
+{
+	if (!shared_memory_ring_)
+		return;
+
+	// Samples, that were dropped in the meantime, are skipped
+	const size_t pos = std::max(shared_memory_ring_->write_pos(),
+		time_->begin_pos());
+	if (pos >= end_pos)
+		return;
+	shared_memory_ring_->write(pos, end_pos - pos,
+		[this](size_t pos, size_t count, double *timestamps, double *values) {
+			time_->copy(pos, count, timestamps);
+			data_->copy(pos, count, values);
+		});
+}
+
+bool AnalogTimeSignal::set_compression(bool compression)
+{
+	lock_guard<mutex> lock(write_mutex_);
+	if (!time_->set_compressed(compression) ||
+			!data_->set_compressed(compression)) {
+		qWarning() << "AnalogTimeSignal::set_compression(): "
+			<< display_name() << ": Signal already contains samples!";
+		return false;
+	}
+	return true;
+}
+
+bool AnalogTimeSignal::compression() const
+{
+	return data_->compressed();
+}
+
+void AnalogTimeSignal::set_decimation(DecimationMode mode, size_t factor,
+	double tolerance)
+{
+	lock_guard<mutex> lock(write_mutex_);
+	decimator_.set_mode(mode, factor, tolerance);
+}
+
+DecimationMode AnalogTimeSignal::decimation_mode() const
+{
+	lock_guard<mutex> lock(write_mutex_);
+	return decimator_.mode();
+}
+
+size_t AnalogTimeSignal::decimation_factor() const
+{
+	lock_guard<mutex> lock(write_mutex_);
+	return decimator_.factor();
+}
+
+double AnalogTimeSignal::decimation_tolerance() const
+{
+	lock_guard<mutex> lock(write_mutex_);
+	return decimator_.tolerance();
+}
+
+void AnalogTimeSignal::set_full_rate_capture(
+	shared_ptr<AnalogTimeSignal> target, double pre_trigger, double post_trigger)
+{
+	if (target.get() == this) {
+		qWarning() << "AnalogTimeSignal::set_full_rate_capture(): "
+			<< display_name() << ": Can't capture to the signal itself!";
+		return;
+	}
+
+	lock_guard<mutex> lock(write_mutex_);
+	full_rate_signal_ = target;
+	full_rate_pre_trigger_ = std::max(pre_trigger, 0.);
+	full_rate_post_trigger_ = std::max(post_trigger, 0.);
+	clear_full_rate_ring();
+	promoted_timestamps_.clear();
+	promoted_values_.clear();
+	full_rate_promote_until_ = -std::numeric_limits<double>::infinity();
+	full_rate_last_timestamp_ = -std::numeric_limits<double>::infinity();
+}
+
+shared_ptr<AnalogTimeSignal> AnalogTimeSignal::full_rate_signal() const
+{
+	lock_guard<mutex> lock(write_mutex_);
+	return full_rate_signal_;
+}
+
+bool AnalogTimeSignal::capture_full_rate(double timestamp)
+{
+	lock_guard<mutex> lock(write_mutex_);
+	if (!full_rate_signal_)
+		return false;
+
+	// The ring holds the samples up to now, including the samples after
+	// the trigger, that arrived until the trigger was evaluated.
+	const size_t end_pos = full_rate_timestamps_.end_pos();
+	size_t pos = full_rate_timestamps_.lower_bound(
+		timestamp - full_rate_pre_trigger_);
+	for (; pos < end_pos; ++pos) {
+		const double sample_timestamp = full_rate_timestamps_[pos];
+		if (sample_timestamp <= full_rate_last_timestamp_)
+			continue;
+		promoted_timestamps_.push_back(sample_timestamp);
+		promoted_values_.push_back(full_rate_values_[pos]);
+		full_rate_last_timestamp_ = sample_timestamp;
+	}
+	clear_full_rate_ring();
+
+	full_rate_promote_until_ = std::max(full_rate_promote_until_,
+		timestamp + full_rate_post_trigger_);
+	flush_full_rate_samples();
+	return true;
+}
+
+void AnalogTimeSignal::append_full_rate_sample(double timestamp, double value)
+{
+	if (timestamp <= full_rate_promote_until_) {
+		if (timestamp > full_rate_last_timestamp_) {
+			promoted_timestamps_.push_back(timestamp);
+			promoted_values_.push_back(value);
+			full_rate_last_timestamp_ = timestamp;
+		}
+		return;
+	}
+
+	full_rate_timestamps_.push_back(timestamp);
+	full_rate_values_.push_back(value);
+
+	// A trigger can be evaluated up to the post trigger window late, so the
+	// ring keeps both windows. The old samples are dropped chunk wise.
+	if (full_rate_timestamps_.end_pos() % full_rate_timestamps_.chunk_size())
+		return;
+	const size_t pos = full_rate_timestamps_.lower_bound(
+		timestamp - full_rate_pre_trigger_ - full_rate_post_trigger_);
+	const size_t count = pos - full_rate_timestamps_.begin_pos();
+	full_rate_timestamps_.drop_front(count);
+	full_rate_values_.drop_front(count);
+}
+
+void AnalogTimeSignal::flush_full_rate_samples()
+{
+	if (!full_rate_signal_ || promoted_timestamps_.empty())
+		return;
+
+	full_rate_signal_->push_samples(promoted_timestamps_.data(),
+		promoted_values_.data(), promoted_timestamps_.size(),
+		digits_, decimal_places_);
+	promoted_timestamps_.clear();
+	promoted_values_.clear();
+}
+
+void AnalogTimeSignal::clear_full_rate_ring()
+{
+	full_rate_timestamps_.drop_front(full_rate_timestamps_.size());
+	full_rate_values_.drop_front(full_rate_values_.size());
+}
+
+bool AnalogTimeSignal::set_time_column(shared_ptr<TimeColumn> time_column)
+{
+	lock_guard<mutex> lock(write_mutex_);
+	if (!time_->set_time_column(time_column)) {
+		qWarning() << "AnalogTimeSignal::set_time_column(): "
+			<< display_name() << ": Signal already contains samples!";
+		return false;
+	}
+	return true;
+}
+
+shared_ptr<TimeColumn> AnalogTimeSignal::time_column() const
+{
+	return time_->time_column();
+}
+
+bool AnalogTimeSignal::shares_time_column(const AnalogTimeSignal &other) const
+{
+	const auto column = time_column();
+	return column && column == other.time_column();
+}
+
+void AnalogTimeSignal::set_time_skew(double time_skew)
+{
+	time_skew_ = time_skew;
+}
+
+double AnalogTimeSignal::time_skew() const
+{
+	return time_skew_;
+}
+
+size_t AnalogTimeSignal::memory_size() const
+{
+	return time_->memory_size() + data_->memory_size() +
+		pyramid_->memory_size() + full_rate_timestamps_.memory_size() +
+		full_rate_values_.memory_size();
+}
+
+size_t AnalogTimeSignal::spilled_size() const
+{
+	return time_->spilled_size() + data_->spilled_size();
+}
+
+bool AnalogTimeSignal::apply_retention()
+{
+	const size_t max_samples = retention_max_samples_;
+	const double max_age = retention_max_age_;
+	if (max_samples == 0 && max_age <= 0.)
+		return false;
+	// Snapshots pin all samples
+	if (snapshot_pins_ > 0)
+		return false;
+
+	// Dropping from the front of the chunked buffers doesn't move the
+	// remaining samples, so the absolute positions stay valid.
+	size_t dropped = 0;
+	if (max_samples > 0 && time_->size() > max_samples)
+		dropped = time_->size() - max_samples;
+	if (max_age > 0. && !time_->empty()) {
+		const double min_timestamp = last_timestamp_ - max_age;
+		// Always keep the last sample.
+		size_t pos = std::min(
+			time_->lower_bound(min_timestamp), time_->end_pos() - 1);
+		if (pos - time_->begin_pos() > dropped)
+			dropped = pos - time_->begin_pos();
+	}
+
+	if (dropped == 0)
+		return false;
+
+	drop_samples(dropped);
+	return true;
+}
+
+void AnalogTimeSignal::drop_samples(size_t count)
+{
+	// The time buffer must be dropped first, see read_sample()
+	time_->drop_front(count);
+	data_->drop_front(count);
+	pyramid_->drop_front(time_->begin_pos());
+}
+
+size_t AnalogTimeSignal::evict_samples(size_t count)
+{
+	{
+		lock_guard<mutex> lock(write_mutex_);
+		// Always keep the last sample. Snapshots pin all samples.
+		const size_t size = time_->size();
+		count = std::min(count, size > 0 ? size - 1 : 0);
+		if (snapshot_pins_ > 0)
+			count = 0;
+		if (count > 0)
+			drop_samples(count);
+	}
+	if (count > 0)
+		Q_EMIT samples_dropped(time_->begin_pos());
+	return count;
+}
+
+size_t AnalogTimeSignal::evict_samples_older_than(double max_age,
+	size_t keep_pos)
+{
+	size_t count = 0;
+	{
+		lock_guard<mutex> lock(write_mutex_);
+		// Snapshots pin all samples
+		if (snapshot_pins_ > 0 || !(max_age >= 0.) || time_->empty())
+			return 0;
+		const double min_timestamp = last_timestamp_ - max_age;
+		// Always keep the last sample.
+		size_t pos = std::min(
+			time_->lower_bound(min_timestamp), time_->end_pos() - 1);
+		pos = std::max(std::min(pos, keep_pos), time_->begin_pos());
+		count = pos - time_->begin_pos();
+		if (count > 0)
+			drop_samples(count);
+	}
+	if (count > 0)
+		Q_EMIT samples_dropped(time_->begin_pos());
+	return count;
+}
+
+bool AnalogTimeSignal::wait_for_change(size_t count,
+	std::chrono::steady_clock::time_point deadline) const
+{
+	// The fences pair with notify_waiters(): Either the writer sees the
+	// waiter or the waiter sees the new sample count.
+	waiter_count_.fetch_add(1);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	bool changed;
+	{
+		unique_lock<mutex> lock(wait_mutex_);
+		changed = wait_cond_.wait_until(lock, deadline, [this, count]() {
+			return sample_count() != count;
+		});
+	}
+	waiter_count_.fetch_sub(1);
+	return changed;
+}
+
+void AnalogTimeSignal::notify_waiters()
+{
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (waiter_count_.load(std::memory_order_relaxed) == 0)
+		return;
+
+	// Locking the mutex ensures, that a waiter, which has checked the old
+	// sample count, is already waiting.
+	{
+		lock_guard<mutex> lock(wait_mutex_);
+	}
+	wait_cond_.notify_all();
+}
+
+void AnalogTimeSignal::on_samples_notified(size_t first, size_t last)
+{
+	// Only take the snapshot, if somebody is interested in it
+	static const QMetaMethod range_signal =
+		QMetaMethod::fromSignal(&AnalogTimeSignal::sample_range_appended);
+	if (isSignalConnected(range_signal)) {
+		auto samples = make_shared<AnalogTimeSampleRange>();
+		samples->first = first;
+		while (true) {
+			// Skip samples, that were already dropped by the retention policy
+			samples->first = std::max(first, first_sample_pos());
+			if (samples->first >= last || samples->first >= sample_count()) {
+				samples->first = last;
+				break;
+			}
+			const size_t count = last - samples->first;
+			samples->timestamps.resize(count);
+			samples->values.resize(count);
+			// Retry if the samples were dropped while copying them
+			const size_t copied = copy_samples(samples->first, count, false,
+				samples->timestamps.data(), samples->values.data());
+			if (copied > 0) {
+				samples->timestamps.resize(copied);
+				samples->values.resize(copied);
+				break;
+			}
+		}
+		if (samples->first == last) {
+			samples->timestamps.clear();
+			samples->values.clear();
+		}
+		Q_EMIT sample_range_appended(first, last, samples);
+	}
+
+	AnalogBaseSignal::on_samples_notified(first, last);
+}
+
 void AnalogTimeSignal::on_channel_start_timestamp_changed(double timestamp)
 {
 	signal_start_timestamp_ = timestamp;
@@ -318,73 +1451,123 @@ void AnalogTimeSignal::combine_signals(
 	if (signal2 == nullptr || signal2->sample_count() == 0)
 		return;
 
-	// Ignore the first sample(s)
-	if (signal1_pos == 0 || signal2_pos == 0) {
-		if (signal1->sample_count() <= signal1_pos ||
-				signal2->sample_count() <= signal2_pos)
-			return;
-
-		double signal1_ts = signal1->get_sample(signal1_pos, false).first;
-		double signal2_ts = signal2->get_sample(signal2_pos, false).first;
-		if (signal1_ts < signal2_ts) {
-			while (signal1_ts < signal2_ts &&
-					signal1->sample_count() > signal1_pos+1)
-				signal1_ts = signal1->get_sample(++signal1_pos, false).first;
-		}
-		else if (signal1_ts > signal2_ts) {
-			while (signal1_ts > signal2_ts &&
-					signal2->sample_count() > signal2_pos+1)
-				signal2_ts = signal2->get_sample(++signal2_pos, false).first;
-		}
-	}
+	// Skip samples, that were already dropped by the retention policy
+	if (signal1_pos < signal1->first_sample_pos())
+		signal1_pos = signal1->first_sample_pos();
+	if (signal2_pos < signal2->first_sample_pos())
+		signal2_pos = signal2->first_sample_pos();
+
+	// The samples before the cursors are needed for the interpolation. If
+	// there is no such sample, the samples of the other signal, that are
+	// older than the first sample of this signal, can't be combined and
+	// are skipped.
+	CombineCursor cursor1;
+	CombineCursor cursor2;
+	cursor1.has_prev = signal1_pos > 0 && signal1->read_sample(
+		signal1_pos - 1, cursor1.prev_timestamp, cursor1.prev_value);
+	cursor2.has_prev = signal2_pos > 0 && signal2->read_sample(
+		signal2_pos - 1, cursor2.prev_timestamp, cursor2.prev_value);
+	if (cursor1.has_prev)
+		cursor1.prev_timestamp -= signal1->time_skew();
+	if (cursor2.has_prev)
+		cursor2.prev_timestamp -= signal2->time_skew();
 
 	while (true) {
-		if (signal1->sample_count() <= signal1_pos ||
-				signal2->sample_count() <= signal2_pos)
+		if (!cursor1.fetch(*signal1, signal1_pos) ||
+				!cursor2.fetch(*signal2, signal2_pos))
 			break;
 
-		double time;
-		double value1;
-		double value2;
-
-		auto signal1_sample = signal1->get_sample(signal1_pos, false);
-		auto signal1_ts = signal1_sample.first;
-		auto signal2_sample = signal2->get_sample(signal2_pos, false);
-		auto signal2_ts = signal2_sample.first;
-
-		if (signal1_ts == signal2_ts) {
-			time = signal1_ts;
-			value1 = signal1_sample.second;
-			value2 = signal2_sample.second;
-			++signal1_pos;
-			++signal2_pos;
-		}
-		else if (signal1_ts < signal2_ts &&
-			signal2->sample_count() > signal2_pos) {
-
-			time = signal1_ts;
-			if (!signal2->get_value_at_timestamp(time, value2, false))
-				return;
-			value1 = signal1_sample.second;
-			++signal1_pos;
-		}
-		else if (signal1_ts > signal2_ts &&
-			signal1->sample_count() > signal1_pos) {
-
-			time = signal2_ts;
-			if (!signal1->get_value_at_timestamp(time, value1, false))
-				return;
-			value2 = signal2_sample.second;
-			++signal2_pos;
-		}
-		else {
-			return;
+		size_t i = 0;
+		size_t j = 0;
+		while (i < cursor1.count && j < cursor2.count) {
+			const double signal1_ts = cursor1.timestamps[i];
+			const double signal2_ts = cursor2.timestamps[j];
+
+			if (signal1_ts == signal2_ts) {
+				// Append the whole run of equal timestamps at once. This is
+				// the common case for signals, that share a time column.
+				const size_t max_run =
+					std::min(cursor1.count - i, cursor2.count - j);
+				const size_t run = std::mismatch(
+					cursor1.timestamps.begin() + i,
+					cursor1.timestamps.begin() + i + max_run,
+					cursor2.timestamps.begin() + j).first -
+					(cursor1.timestamps.begin() + i);
+				time_vector->insert(time_vector->end(),
+					cursor1.timestamps.begin() + i,
+					cursor1.timestamps.begin() + i + run);
+				data1_vector->insert(data1_vector->end(),
+					cursor1.values.begin() + i,
+					cursor1.values.begin() + i + run);
+				data2_vector->insert(data2_vector->end(),
+					cursor2.values.begin() + j,
+					cursor2.values.begin() + j + run);
+				i += run;
+				j += run;
+				cursor1.set_prev(i - 1);
+				cursor2.set_prev(j - 1);
+			}
+			else if (signal1_ts < signal2_ts) {
+				if (cursor2.has_prev && cursor2.prev_timestamp <= signal1_ts) {
+					time_vector->push_back(signal1_ts);
+					data1_vector->push_back(cursor1.values[i]);
+					data2_vector->push_back(
+						cursor2.interpolate(j, signal1_ts));
+				}
+				cursor1.set_prev(i);
+				++i;
+			}
+			else {
+				if (cursor1.has_prev && cursor1.prev_timestamp <= signal2_ts) {
+					time_vector->push_back(signal2_ts);
+					data1_vector->push_back(
+						cursor1.interpolate(i, signal2_ts));
+					data2_vector->push_back(cursor2.values[j]);
+				}
+				cursor2.set_prev(j);
+				++j;
+			}
 		}
+		signal1_pos += i;
+		signal2_pos += j;
+	}
+}
+
+bool AnalogTimeSignal::CombineCursor::fetch(
+	const AnalogTimeSignal &signal, size_t pos)
+{
+	const size_t end_pos = signal.sample_count();
+	if (pos >= end_pos)
+		return false;
+
+	count = std::min(end_pos - pos, combine_block_size_);
+	timestamps.resize(count);
+	values.resize(count);
+	count = signal.copy_samples(pos, count, false,
+		timestamps.data(), values.data());
 
-		time_vector->push_back(time);
-		data1_vector->push_back(value1);
-		data2_vector->push_back(value2);
+	const double time_skew = signal.time_skew();
+	if (time_skew != 0.) {
+		for (size_t i = 0; i < count; ++i)
+			timestamps[i] -= time_skew;
 	}
+	return count > 0;
+}
+
+void AnalogTimeSignal::CombineCursor::set_prev(size_t i)
+{
+	prev_timestamp = timestamps[i];
+	prev_value = values[i];
+	has_prev = true;
+}
+
+double AnalogTimeSignal::CombineCursor::interpolate(
+	size_t i, double timestamp) const
+{
+	// Use linear interpolation to get the value beetween time stamps
+	const double ts_factor =
+		(timestamp - prev_timestamp) / (timestamps[i] - prev_timestamp);
+	return prev_value + ((values[i] - prev_value) * ts_factor);
 }
 
 } // namespace data
@@ -20,29 +20,58 @@
 #ifndef DATA_ANALOGTIMESIGNAL_HPP
 #define DATA_ANALOGTIMESIGNAL_HPP
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <limits>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include <QMetaType>
 #include <QObject>
 
 #include "src/data/analogbasesignal.hpp"
+#include "src/data/chunkedbuffer.hpp"
 #include "src/data/datautil.hpp"
+#include "src/data/minmaxpyramid.hpp"
+#include "src/data/sampledecimator.hpp"
+#include "src/data/sharedmemoryring.hpp"
+#include "src/data/spillfile.hpp"
+#include "src/data/timebase.hpp"
 
 using std::pair;
 using std::set;
 using std::shared_ptr;
 using std::string;
+using std::unique_ptr;
 using std::vector;
 
 namespace sv {
 namespace data {
 
+class AnalogTimeSnapshot;
+
 typedef pair<double, double> analog_time_sample_t;
 
-class AnalogTimeSignal : public AnalogBaseSignal
+/**
+ * A snapshot of appended samples, that is shared by all receivers of
+ * AnalogTimeSignal::sample_range_appended(). The timestamps are absolute.
+ */
+struct AnalogTimeSampleRange
+{
+	/** Absolute position of the first sample in the snapshot. */
+	size_t first;
+	vector<double> timestamps;
+	vector<double> values;
+};
+
+class AnalogTimeSignal :
+	public AnalogBaseSignal,
+	public std::enable_shared_from_this<AnalogTimeSignal>
 {
 	Q_OBJECT
 
@@ -62,9 +91,33 @@ public:
 
 	/**
 	 * Return the sample at the given position.
+	 *
+	 * Sample positions are absolute and stay stable, even when old samples
+	 * are dropped by the retention policy. Positions of dropped samples (see
+	 * first_sample_pos()) are handled like positions out of range.
+	 *
+	 * All read functions are lock-free and can be called from any thread
+	 * while the acquisition thread is appending samples.
 	 */
 	analog_time_sample_t get_sample(size_t pos, bool relative_time) const;
 
+	/**
+	 * Copy up to count samples, starting at the position pos, to the arrays
+	 * timestamps and values (either may be nullptr). This is much faster
+	 * than calling get_sample() for every sample.
+	 *
+	 * @return The number of copied samples. 0 if pos is out of range or if
+	 *         the samples were dropped while copying them.
+	 */
+	size_t copy_samples(size_t pos, size_t count, bool relative_time,
+		double *timestamps, double *values) const;
+
+	/**
+	 * Return up to count samples, starting at the position pos.
+	 */
+	vector<analog_time_sample_t> get_samples(
+		size_t pos, size_t count, bool relative_time) const;
+
 	/**
 	 * Return the last captured sample.
 	 */
@@ -87,23 +140,353 @@ public:
 		double timestamp, double &value, bool relative_time) const;
 
 	/**
-	 * Push a single sample to the signal.
+	 * Return the position of the first sample with a timestamp not less than
+	 * the given timestamp. If all samples are older, sample_count() is
+	 * returned. The search is O(log n) and uses the result of the last query
+	 * as hint, so monotonic queries (e.g. while scrolling) are even faster.
+	 */
+	size_t lower_index(double timestamp, bool relative_time) const;
+
+	/**
+	 * Return the position range [first, last) of all samples with
+	 * start_timestamp <= timestamp <= end_timestamp.
+	 */
+	pair<size_t, size_t> index_range(double start_timestamp,
+		double end_timestamp, bool relative_time) const;
+
+	/**
+	 * Return min, max, mean and integral of the samples in the position
+	 * range [first_pos, last_pos) in &summary. The calculation uses the
+	 * min/max pyramid of the signal and is O(log n).
+	 *
+	 * @return true if the range contains samples, false if not.
+	 */
+	bool get_summary(size_t first_pos, size_t last_pos, bool relative_time,
+		AnalogSummary &summary) const;
+
+	/**
+	 * Return min, max, mean and integral of all samples with
+	 * start_timestamp <= timestamp <= end_timestamp in &summary, e.g. for
+	 * the range between two plot markers. This is O(log n).
+	 *
+	 * @return true if the time range contains samples, false if not.
+	 */
+	bool get_range_summary(double start_timestamp, double end_timestamp,
+		bool relative_time, AnalogSummary &summary) const;
+
+	/**
+	 * Divide the time range [start_timestamp, end_timestamp] into count
+	 * bins of equal length and return the min/max/mean of every bin, that
+	 * contains samples. This is O(count * log n), independent of the number
+	 * of samples in the time range.
+	 */
+	vector<AnalogSummary> get_summaries(double start_timestamp,
+		double end_timestamp, size_t count, bool relative_time) const;
+
+	/**
+	 * Return the min/max/mean of count consecutive intervals of the same
+	 * length, e.g. per second averages for an export. The bin i covers
+	 * [start_timestamp + (first_bin + i) * interval, start_timestamp +
+	 * (first_bin + i + 1) * interval), so the bins of consecutive calls
+	 * line up exactly. Unlike get_summaries(), a summary is returned for
+	 * every bin, bins without samples have a sample_count of 0. This is
+	 * O(count * log n), the samples themselves are not read.
+	 *
+	 * @return The summaries or no summaries, if samples were dropped while
+	 *         reading.
+	 */
+	vector<AnalogSummary> get_interval_summaries(double start_timestamp,
+		double interval, size_t first_bin, size_t count,
+		bool relative_time) const;
+
+	/**
+	 * Return the mean of all samples with a timestamp not less than the
+	 * given timestamp, e.g. the samples since a new output value was set.
+	 * This is O(log n) like get_range_summary().
+	 *
+	 * @return The mean or NaN if there are no such samples.
+	 */
+	double mean_since(double timestamp, bool relative_time) const;
+
+	/**
+	 * Block until count samples were appended after the call. The waiting
+	 * thread is woken up by the writer, the signal is not polled. Can be
+	 * called from any thread but the one, that pushes the samples.
+	 *
+	 * @param timeout The maximum time to wait in seconds.
+	 *
+	 * @return false if the timeout has elapsed.
+	 */
+	bool wait_for_samples(size_t count, double timeout) const;
+
+	/**
+	 * Block until sample_count() differs from count, e.g. the sample count
+	 * of the last read. Unlike wait_for_samples(), a sample, that is
+	 * appended between the read and the call, doesn't get lost.
+	 *
+	 * @param timeout The maximum time to wait in seconds.
+	 *
+	 * @return false if the timeout has elapsed.
+	 */
+	bool wait_for_sample_count(size_t count, double timeout) const;
+
+	/**
+	 * Block until the signal is stable: The samples of the last duration
+	 * seconds differ by no more than tolerance (max - min). Only samples,
+	 * that are appended after the call, are taken into account, so samples
+	 * from before e.g. a new output value was set don't count. The check
+	 * uses the min/max pyramid and is O(log n) per appended block.
+	 *
+	 * @param timeout The maximum time to wait in seconds.
 	 *
-	 * TODO: Can this be removed?
+	 * @return false if the timeout has elapsed.
+	 */
+	bool wait_stable(double tolerance, double duration, double timeout) const;
+
+	/**
+	 * Push a single sample to the signal.
+	 */
+	void push_sample(double sample, double timestamp,
+		int digits, int decimal_places);
+
+	/**
+	 * Push a single sample of unit_size (float or double) to the signal.
+	 * Prefer push_sample(double, ...), this only dispatches to it.
 	 */
 	void push_sample(void *sample, double timestamp,
 		size_t unit_size, int digits, int decimal_places);
 
 	/**
-	 * Push multiple samples to the signal.
+	 * Push count samples with the timestamps timestamp + n / samplerate to
+	 * the signal. T is float or double, the type is resolved at compile
+	 * time, so the loops over the samples have no per sample branches.
+	 *
+	 * If publish is false, the samples are stored, but sample_count() and
+	 * the samples_appended() notification are held back, until
+	 * publish_samples() is called. The samples of all channels of a frame
+	 * are published together this way.
+	 */
+	template<typename T>
+	void push_samples(const T *data, size_t count, double timestamp,
+		uint64_t samplerate, int digits, int decimal_places,
+		bool publish = true);
+
+	/**
+	 * Like push_samples(), but the samples are stride values apart, e.g.
+	 * the values of one channel in an interleaved frame of a device. They
+	 * are deinterleaved block wise on the stack.
+	 */
+	template<typename T>
+	void push_strided_samples(const T *data, size_t count, size_t stride,
+		double timestamp, uint64_t samplerate, int digits, int decimal_places,
+		bool publish = true);
+
+	/**
+	 * Push multiple samples of unit_size (float or double) to the signal.
+	 * Prefer the typed push_samples(), this only dispatches to it.
 	 */
 	void push_samples(void *data, uint64_t samples, double timestamp,
-		uint64_t samplerate, size_t unit_size, int digits, int decimal_places);
+		uint64_t samplerate, size_t unit_size, int digits, int decimal_places,
+		bool publish = true);
+
+	/**
+	 * Push count samples with explicit timestamps to the signal, e.g. the
+	 * results of a math channel for a block of source samples. The samples
+	 * are published at once.
+	 *
+	 * If owner is set, the timestamps and values stay valid and unchanged
+	 * as long as owner exists (e.g. a memory mapped file). Full chunks are
+	 * then referenced instead of copied, if the signal stores uncompressed
+	 * doubles and doesn't decimate, see ChunkedBuffer::push_back_external().
+	 */
+	void push_samples(const double *timestamps, const double *values,
+		size_t count, int digits, int decimal_places,
+		shared_ptr<const void> owner = nullptr);
+
+	/**
+	 * Publish all samples, that were pushed without publishing them.
+	 */
+	void publish_samples();
 
 	double signal_start_timestamp() const;
 	double first_timestamp(bool relative_time) const;
 	double last_timestamp(bool relative_time) const;
 
+	/**
+	 * Return the position of the oldest sample, that is still stored in the
+	 * signal. This is 0 until samples are dropped by the retention policy.
+	 */
+	size_t first_sample_pos() const;
+
+	/**
+	 * Return a snapshot of all samples, that are currently in the signal.
+	 * See AnalogTimeSnapshot.
+	 */
+	AnalogTimeSnapshot snapshot();
+
+	/**
+	 * Return the number of samples, that are actually stored in the signal,
+	 * i.e. sample_count() - first_sample_pos().
+	 */
+	size_t retained_sample_count() const override;
+
+	/**
+	 * Limit the number of samples stored in the signal. When the limit is
+	 * exceeded, the oldest samples are dropped.
+	 *
+	 * @param max_samples The maximum number of samples. 0 means unlimited.
+	 */
+	void set_retention_max_samples(size_t max_samples);
+	size_t retention_max_samples() const;
+
+	/**
+	 * Limit the age of the samples stored in the signal. Samples that are
+	 * older than max_age (relative to the last timestamp) are dropped.
+	 *
+	 * @param max_age The maximum age in seconds. 0 means unlimited.
+	 */
+	void set_retention_max_age(double max_age);
+	double retention_max_age() const;
+
+	/**
+	 * Store the following chunks of timestamps and values in a memory
+	 * mapped temporary file, so long captures can outgrow the RAM. Sealed
+	 * chunks are paged out by the operating system and paged back in on
+	 * demand, all accessors work unchanged. When disabled again, the chunks
+	 * in the file stay there.
+	 *
+	 * @return false if the temporary file couldn't be created.
+	 */
+	bool set_spill_to_disk(bool spill_to_disk) override;
+	bool spill_to_disk() const override;
+
+	/**
+	 * Write the samples, while they are published, also to a ring in a
+	 * named shared memory object, so other processes on the same machine
+	 * can read them without a copy, see SharedMemoryRing. The ring starts
+	 * with the latest stored samples. An existing export is replaced.
+	 *
+	 * @param name The name of the shared memory object.
+	 * @param capacity The number of samples in the ring.
+	 *
+	 * @return false if the shared memory object couldn't be created.
+	 */
+	bool export_shared_memory(const string &name, size_t capacity);
+	void stop_shared_memory_export();
+	/** Return the name of the shared memory object or "" if not exported. */
+	string shared_memory_name() const;
+
+	/**
+	 * Store the timestamps and values losslessly compressed, see
+	 * CompactBuffer. The compression can only be changed as long as no
+	 * samples were pushed to the signal (or after clear()).
+	 *
+	 * @return true if the compression was changed.
+	 */
+	bool set_compression(bool compression);
+	bool compression() const;
+
+	/**
+	 * Reduce the pushed samples before they are stored, see
+	 * SampleDecimator. Only the following samples are decimated, the
+	 * incomplete group of the previous setting is discarded.
+	 *
+	 * With DecimationMode::DeadBand and DecimationMode::SwingingDoor only
+	 * the samples, that are needed to reconstruct the signal within the
+	 * tolerance, are stored. get_value_at_timestamp() interpolates across
+	 * the gaps.
+	 *
+	 * @param mode The decimation mode.
+	 * @param factor The number of samples, that are reduced to one sample.
+	 *               0 or 1 disables the decimation. For DeadBand and
+	 *               SwingingDoor the maximum number of samples between two
+	 *               stored samples, 0 or 1 for no limit.
+	 * @param tolerance The tolerance of DeadBand and SwingingDoor.
+	 */
+	void set_decimation(DecimationMode mode, size_t factor,
+		double tolerance = 0.);
+	DecimationMode decimation_mode() const;
+	size_t decimation_factor() const;
+	double decimation_tolerance() const;
+
+	/**
+	 * Keep the samples, that are reduced by the decimation, at full rate in
+	 * a ring of the last pre_trigger + post_trigger seconds. When
+	 * capture_full_rate() is called (e.g. by a TriggerEngine, see
+	 * TriggerEngine::set_capture_full_rate()), the full rate samples from
+	 * pre_trigger seconds before to post_trigger seconds after the trigger
+	 * are pushed to the target signal, that stores them permanently. Without
+	 * decimation all samples are stored at full rate and nothing is
+	 * captured.
+	 *
+	 * The target is written while the write lock of this signal is held, so
+	 * it must not capture the full rate samples of this signal itself.
+	 *
+	 * @param target The signal for the full rate samples. nullptr disables
+	 *               the capture.
+	 * @param pre_trigger The seconds before the trigger.
+	 * @param post_trigger The seconds after the trigger.
+	 */
+	void set_full_rate_capture(shared_ptr<AnalogTimeSignal> target,
+		double pre_trigger, double post_trigger);
+	shared_ptr<AnalogTimeSignal> full_rate_signal() const;
+
+	/**
+	 * Promote the full rate samples around the timestamp to the target
+	 * signal of set_full_rate_capture(). Overlapping windows are merged.
+	 *
+	 * @return false if no full rate capture is set.
+	 */
+	bool capture_full_rate(double timestamp);
+
+	/**
+	 * Store the explicit timestamps in a column, that is shared with other
+	 * signals, that are sampled at the same timestamps. See TimeColumn. The
+	 * column can only be set as long as no samples were pushed to the signal
+	 * (or after clear()).
+	 *
+	 * @return true if the column was set.
+	 */
+	bool set_time_column(shared_ptr<TimeColumn> time_column);
+	shared_ptr<TimeColumn> time_column() const;
+
+	/**
+	 * Return true, if both signals store their timestamps in the same time
+	 * column.
+	 */
+	bool shares_time_column(const AnalogTimeSignal &other) const;
+
+	/**
+	 * Set the skew of this signal against other signals in seconds, e.g. as
+	 * estimated by a SkewEstimator. A positive skew means, that the samples
+	 * are late. The skew is subtracted from the timestamps, when the signal
+	 * is combined with other signals (see combine_signals() and
+	 * SignalCombiner), the stored timestamps are not changed.
+	 */
+	void set_time_skew(double time_skew);
+	double time_skew() const;
+
+	/**
+	 * Return the number of bytes, that are used by the samples of this
+	 * signal on the heap (memory_size()) and in the spill file
+	 * (spilled_size()).
+	 */
+	size_t memory_size() const override;
+	size_t spilled_size() const override;
+
+	/** See BaseSignal::evict_samples(). */
+	size_t evict_samples(size_t count) override;
+	/**
+	 * Drop the samples, that are older than max_age (relative to the last
+	 * timestamp), once. Unlike set_retention_max_age(), the following
+	 * samples are not dropped. The newest sample is always kept, as well as
+	 * the samples from the absolute position keep_pos on.
+	 *
+	 * @return The number of dropped samples.
+	 */
+	size_t evict_samples_older_than(double max_age,
+		size_t keep_pos = std::numeric_limits<size_t>::max());
+
 	/**
 	 * Combine two signals with each other.
 	 *
@@ -120,7 +503,16 @@ public:
 	 *   10 |    |  8 |             |             |
 	 *   12 |    |  7 |             |             |
 	 *
-	 * TODO: Use std::deque<double>& instead of shared_ptr<vector<double>>?
+	 * Both signals are merged with one cursor per signal, so the costs are
+	 * linear in the number of new samples. Runs of equal timestamps (e.g.
+	 * from signals, that share a time column) are appended without any
+	 * interpolation.
+	 *
+	 * The time skew of each signal (see set_time_skew()) is taken off its
+	 * timestamps, before they are merged.
+	 *
+	 * To combine more than two signals or to combine without allocations,
+	 * use a SignalCombiner.
 	 */
 	static void combine_signals(
 		shared_ptr<AnalogTimeSignal> signal1, size_t &signal1_pos,
@@ -130,19 +522,211 @@ public:
 		shared_ptr<vector<double>> data2_vector);
 
 private:
-	shared_ptr<vector<double>> time_;
-	double signal_start_timestamp_;
-	double last_timestamp_;
+	/**
+	 * A block of samples of one signal and the sample before the block,
+	 * used by combine_signals().
+	 */
+	struct CombineCursor
+	{
+		/**
+		 * Copy the next block of samples, starting at pos, with the time
+		 * skew of the signal taken off. Returns false if there are no
+		 * samples at pos.
+		 */
+		bool fetch(const AnalogTimeSignal &signal, size_t pos);
+		/** Remember the sample at the block position i as previous sample. */
+		void set_prev(size_t i);
+		/**
+		 * Interpolate the value at timestamp between the previous sample and
+		 * the sample at the block position i.
+		 */
+		double interpolate(size_t i, double timestamp) const;
+
+		vector<double> timestamps;
+		vector<double> values;
+		size_t count = 0;
+		bool has_prev = false;
+		double prev_timestamp = 0.;
+		double prev_value = 0.;
+	};
+
+	/** The number of samples, that are merged per block. */
+	static const size_t combine_block_size_;
+
+	/**
+	 * Read the sample at the given position without locking. Returns false
+	 * if the position is out of range or if the sample was dropped/cleared
+	 * while reading it.
+	 */
+	bool read_sample(size_t pos, double &timestamp, double &value) const;
+
+	/**
+	 * Search the lower bound of timestamp in [begin_pos, end_pos) starting
+	 * at the hint from the last query. The read must be validated by the
+	 * caller.
+	 */
+	size_t lower_index_unchecked(double timestamp,
+		size_t begin_pos, size_t end_pos) const;
+
+	/**
+	 * See get_interval_summaries(), only the samples in the position range
+	 * [first_pos, last_pos) are summarized. The read must be validated by
+	 * the caller.
+	 */
+	vector<AnalogSummary> interval_summaries_unchecked(size_t first_pos,
+		size_t last_pos, double start_timestamp, double interval,
+		size_t first_bin, size_t count, bool relative_time) const;
+
+	/**
+	 * Drop the oldest samples until the retention policy is satisfied.
+	 * write_mutex_ must be locked by the caller.
+	 *
+	 * @return true if samples were dropped.
+	 */
+	bool apply_retention();
+
+	/**
+	 * Drop the count oldest samples. write_mutex_ must be locked by the
+	 * caller.
+	 */
+	void drop_samples(size_t count);
+
+	/**
+	 * Store a single sample without publishing it. write_mutex_ must be
+	 * locked by the caller.
+	 */
+	void append_sample(double timestamp, double value);
+
+	/**
+	 * Store a chunk of samples, that is referenced by the buffers, without
+	 * publishing them. Returns false if the buffers can't reference a
+	 * chunk at their current end. write_mutex_ must be locked by the caller.
+	 */
+	bool append_external_chunk(const double *timestamps,
+		const double *values, shared_ptr<const void> owner);
+
+	/**
+	 * Pass a sample through the decimator and store the resulting samples
+	 * without publishing them. write_mutex_ must be locked by the caller.
+	 */
+	void append_decimated_sample(double timestamp, double value);
+
+	/**
+	 * Keep a sample, that is passed to the decimator, for the full rate
+	 * capture. write_mutex_ must be locked by the caller.
+	 */
+	void append_full_rate_sample(double timestamp, double value);
+
+	/**
+	 * Push the promoted full rate samples to the target signal.
+	 * write_mutex_ must be locked by the caller.
+	 */
+	void flush_full_rate_samples();
+
+	/** Drop all samples from the full rate ring. */
+	void clear_full_rate_ring();
+
+	/**
+	 * Store count samples with the timestamps timestamp + n * time_stride
+	 * without publishing them. write_mutex_ must be locked by the caller.
+	 */
+	template<typename T>
+	void append_samples(const T *data, size_t count,
+		double timestamp, double time_stride);
+
+	/**
+	 * Like append_samples(), for samples that are stride values apart.
+	 * write_mutex_ must be locked by the caller.
+	 */
+	template<typename T>
+	void append_strided_samples(const T *data, size_t count, size_t stride,
+		double timestamp, double time_stride);
+
+	/**
+	 * The number of samples, that append_strided_samples() deinterleaves
+	 * at once on the stack.
+	 */
+	static const size_t strided_block_size_;
+
+	/**
+	 * Write the samples up to end_pos to the shared memory ring.
+	 * write_mutex_ must be locked by the caller.
+	 */
+	void write_shared_memory_ring(size_t end_pos);
+
+	/**
+	 * Block until sample_count() differs from count or the deadline has
+	 * passed. Returns false on timeout.
+	 */
+	bool wait_for_change(size_t count,
+		std::chrono::steady_clock::time_point deadline) const;
+
+	/**
+	 * Wake up the threads in wait_for_change(). Called by the writers after
+	 * sample_count_ was changed, this is only a fence and a load, if nobody
+	 * waits.
+	 */
+	void notify_waiters();
+
+	shared_ptr<TimeBase> time_;
+	shared_ptr<MinMaxPyramid> pyramid_;
+	/** Result of the last lower_index() query. */
+	mutable std::atomic<size_t> lower_index_hint_;
+	std::atomic<double> signal_start_timestamp_;
+	std::atomic<double> last_timestamp_;
+	std::atomic<double> time_skew_;
+	std::atomic<size_t> retention_max_samples_;
+	std::atomic<double> retention_max_age_;
+	shared_ptr<SpillFile> spill_file_;
+	std::atomic<bool> spill_to_disk_;
+	/** Guarded by write_mutex_. */
+	unique_ptr<SharedMemoryRing> shared_memory_ring_;
+	/** Number of AnalogTimeSnapshots, no samples are dropped while > 0. */
+	std::atomic<size_t> snapshot_pins_;
+	/** Guarded by write_mutex_. */
+	SampleDecimator decimator_;
+	/** The full rate capture, guarded by write_mutex_. */
+	shared_ptr<AnalogTimeSignal> full_rate_signal_;
+	double full_rate_pre_trigger_;
+	double full_rate_post_trigger_;
+	ChunkedBuffer<double> full_rate_timestamps_;
+	ChunkedBuffer<double> full_rate_values_;
+	/** The following samples up to this timestamp are promoted directly. */
+	double full_rate_promote_until_;
+	/** The timestamp of the last promoted sample. */
+	double full_rate_last_timestamp_;
+	vector<double> promoted_timestamps_;
+	vector<double> promoted_values_;
+	/** The number of threads in wait_for_change(). */
+	mutable std::atomic<size_t> waiter_count_;
+	mutable std::mutex wait_mutex_;
+	mutable std::condition_variable wait_cond_;
+
+	friend class AnalogTimeSnapshot;
+
+protected Q_SLOTS:
+	void on_samples_notified(size_t first, size_t last) override;
 
 public Q_SLOTS:
 	void on_channel_start_timestamp_changed(double timestamp);
 
 Q_SIGNALS:
 	void signal_start_timestamp_changed(double timestamp);
+	/**
+	 * The samples in the absolute range [first, last) were appended. The
+	 * snapshot holds a copy of the samples, so receivers don't have to read
+	 * them from the signal. The snapshot is only created, if the signal is
+	 * connected. If samples were dropped by the retention policy before the
+	 * snapshot was taken, samples->first is bigger than first.
+	 */
+	void sample_range_appended(size_t first, size_t last,
+		shared_ptr<const sv::data::AnalogTimeSampleRange> samples);
 
 };
 
 } // namespace data
 } // namespace sv
 
+Q_DECLARE_METATYPE(shared_ptr<const sv::data::AnalogTimeSampleRange>)
+
 #endif // DATA_ANALOGTIMESIGNAL_HPP
@@ -0,0 +1,170 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "analogtimesnapshot.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/timebase.hpp"
+
+using std::lock_guard;
+using std::make_pair;
+using std::make_shared;
+using std::mutex;
+using std::shared_ptr;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+AnalogTimeSnapshot::Pin::Pin(shared_ptr<AnalogTimeSignal> signal) :
+	signal(signal)
+{
+	// Constructed with the write_mutex_ locked, see ChunkedBuffer::hold()
+	signal->data_->hold();
+}
+
+AnalogTimeSnapshot::Pin::~Pin()
+{
+	signal->data_->release_hold();
+	--signal->snapshot_pins_;
+}
+
+AnalogTimeSnapshot::AnalogTimeSnapshot(shared_ptr<AnalogTimeSignal> signal) :
+	first_(0),
+	last_(0),
+	generation_(0)
+{
+	assert(signal);
+
+	// Lock the writer for a moment, so no samples are dropped between
+	// reading the range and pinning it.
+	lock_guard<mutex> lock(signal->write_mutex_);
+	++signal->snapshot_pins_;
+	pin_ = make_shared<Pin>(signal);
+	generation_ = signal->time_->generation();
+	first_ = signal->time_->begin_pos();
+	last_ = signal->sample_count_.load(std::memory_order_acquire);
+}
+
+shared_ptr<AnalogTimeSignal> AnalogTimeSnapshot::signal() const
+{
+	return pin_->signal;
+}
+
+size_t AnalogTimeSnapshot::first_sample_pos() const
+{
+	return first_;
+}
+
+size_t AnalogTimeSnapshot::sample_count() const
+{
+	return last_;
+}
+
+size_t AnalogTimeSnapshot::size() const
+{
+	return last_ - first_;
+}
+
+bool AnalogTimeSnapshot::empty() const
+{
+	return last_ == first_;
+}
+
+bool AnalogTimeSnapshot::is_valid() const
+{
+	return pin_->signal->time_->generation() == generation_;
+}
+
+bool AnalogTimeSnapshot::read_sample(size_t pos, bool relative_time,
+	double &timestamp, double &value) const
+{
+	return copy_samples(pos, 1, relative_time, &timestamp, &value) == 1;
+}
+
+size_t AnalogTimeSnapshot::copy_samples(size_t pos, size_t count,
+	bool relative_time, double *timestamps, double *values) const
+{
+	if (pos < first_ || pos >= last_)
+		return 0;
+
+	count = std::min(count, last_ - pos);
+	count = pin_->signal->copy_samples(
+		pos, count, relative_time, timestamps, values);
+	// The signal validates its own read. If the generation still matches
+	// the snapshot, there was no clear() in between.
+	if (!is_valid())
+		return 0;
+	return count;
+}
+
+vector<analog_time_sample_t> AnalogTimeSnapshot::get_samples(
+	size_t pos, size_t count, bool relative_time) const
+{
+	vector<analog_time_sample_t> samples;
+	if (pos < first_ || pos >= last_)
+		return samples;
+
+	count = std::min(count, last_ - pos);
+	vector<double> timestamps(count);
+	vector<double> values(count);
+	count = copy_samples(pos, count, relative_time,
+		timestamps.data(), values.data());
+	samples.reserve(count);
+	for (size_t i = 0; i < count; ++i)
+		samples.push_back(make_pair(timestamps[i], values[i]));
+	return samples;
+}
+
+const double *AnalogTimeSnapshot::value_span(size_t pos, size_t &count) const
+{
+	if (pos < first_ || pos >= last_) {
+		count = 0;
+		return nullptr;
+	}
+
+	count = std::min(count, last_ - pos);
+	const double *values = pin_->signal->data_->span(pos, count);
+	// A racing clear() can't release the chunk, because it is held by the
+	// pin. The values are only part of the snapshot, if there was no clear.
+	if (!values || !is_valid())
+		return nullptr;
+	return values;
+}
+
+vector<AnalogSummary> AnalogTimeSnapshot::get_interval_summaries(
+	double start_timestamp, double interval, size_t first_bin, size_t count,
+	bool relative_time) const
+{
+	auto summaries = pin_->signal->interval_summaries_unchecked(
+		first_, last_, start_timestamp, interval, first_bin, count,
+		relative_time);
+	// The pinned samples can't be dropped, only clear() invalidates them
+	if (!is_valid())
+		summaries.clear();
+	return summaries;
+}
+
+} // namespace data
+} // namespace sv
@@ -0,0 +1,135 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_ANALOGTIMESNAPSHOT_HPP
+#define DATA_ANALOGTIMESNAPSHOT_HPP
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "src/data/analogtimesignal.hpp"
+
+using std::shared_ptr;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+/**
+ * An immutable view of the samples [first_sample_pos(), sample_count()) of
+ * an AnalogTimeSignal at the time the snapshot was created.
+ *
+ * Creating a snapshot doesn't copy any samples. While a snapshot (or one of
+ * its copies) exists, the retention policy and the memory budget don't drop
+ * any samples of the signal, so all samples of the snapshot stay readable.
+ * New samples are still appended to the signal, but they are not part of
+ * the snapshot. Retention is applied again with the next sample, after the
+ * last snapshot is gone.
+ *
+ * Only clear() invalidates a snapshot, all reads return no samples then.
+ * The memory of the values isn't reused while the snapshot exists, so the
+ * pointers returned by value_span() stay valid even after a clear().
+ */
+class AnalogTimeSnapshot
+{
+public:
+	explicit AnalogTimeSnapshot(shared_ptr<AnalogTimeSignal> signal);
+
+	shared_ptr<AnalogTimeSignal> signal() const;
+
+	/** Absolute positions of the first sample and behind the last sample. */
+	size_t first_sample_pos() const;
+	size_t sample_count() const;
+	size_t size() const;
+	bool empty() const;
+
+	/**
+	 * Return false, if the signal was cleared after the snapshot was taken.
+	 */
+	bool is_valid() const;
+
+	/**
+	 * Read the sample at the absolute position pos.
+	 *
+	 * @return false if pos is not part of the snapshot or the snapshot is
+	 *         not valid any more.
+	 */
+	bool read_sample(size_t pos, bool relative_time,
+		double &timestamp, double &value) const;
+
+	/**
+	 * Copy up to count samples, starting at the absolute position pos,
+	 * see AnalogTimeSignal::copy_samples(). Only samples, that are part of
+	 * the snapshot, are copied.
+	 *
+	 * @return The number of copied samples.
+	 */
+	size_t copy_samples(size_t pos, size_t count, bool relative_time,
+		double *timestamps, double *values) const;
+
+	/**
+	 * Return up to count samples, starting at the absolute position pos.
+	 */
+	vector<analog_time_sample_t> get_samples(
+		size_t pos, size_t count, bool relative_time) const;
+
+	/**
+	 * Return a pointer to the values in the signal, starting at the
+	 * absolute position pos, without copying them. count is reduced to the
+	 * number of values, that are stored contiguously behind pos. The values
+	 * stay readable as long as the snapshot (or one of its copies) exists.
+	 *
+	 * @return nullptr if the values are not stored in place (compressed or
+	 *         not as double), pos is not part of the snapshot or the
+	 *         snapshot is not valid any more. Use copy_samples() then.
+	 */
+	const double *value_span(size_t pos, size_t &count) const;
+
+	/**
+	 * Return the min/max/mean of count consecutive intervals, see
+	 * AnalogTimeSignal::get_interval_summaries(). Only the samples of the
+	 * snapshot are summarized.
+	 */
+	vector<AnalogSummary> get_interval_summaries(double start_timestamp,
+		double interval, size_t first_bin, size_t count,
+		bool relative_time) const;
+
+private:
+	/** Releases the pinned samples and the held value chunks of the signal,
+	 * when the last copy of the snapshot is destroyed. */
+	struct Pin
+	{
+		explicit Pin(shared_ptr<AnalogTimeSignal> signal);
+		~Pin();
+
+		shared_ptr<AnalogTimeSignal> signal;
+	};
+
+	shared_ptr<Pin> pin_;
+	size_t first_;
+	size_t last_;
+	unsigned int generation_;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_ANALOGTIMESNAPSHOT_HPP
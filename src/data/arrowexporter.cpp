@@ -0,0 +1,507 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <QDebug>
+
+#include "arrowexporter.hpp"
+#include "src/channels/basechannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/analogtimesnapshot.hpp"
+#include "src/data/datautil.hpp"
+#include "src/data/flatbuffer.hpp"
+#include "src/data/mergedtimeindex.hpp"
+#include "src/devices/basedevice.hpp"
+
+using std::make_pair;
+using std::map;
+using std::pair;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+namespace {
+
+/** The magic at the start (padded to 8 bytes) and the end of the file. */
+const char file_magic[8] = { 'A', 'R', 'R', 'O', 'W', '1', '\0', '\0' };
+const size_t file_magic_size = 6;
+/** Marks the start of an encapsulated message. */
+const uint32_t continuation_marker = 0xFFFFFFFF;
+
+// Values of the Arrow format (Schema.fbs, Message.fbs and File.fbs)
+const int16_t metadata_version_v5 = 4;
+const uint8_t message_header_schema = 1;
+const uint8_t message_header_record_batch = 3;
+const uint8_t type_floating_point = 3;
+const int16_t precision_double = 2;
+const int16_t endianness_little = 0;
+
+typedef vector<pair<string, string>> metadata_t;
+
+template<typename T>
+void append_pod(string &buffer, const T value)
+{
+	buffer.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+void pad_to(string &buffer, size_t alignment)
+{
+	while (buffer.size() % alignment != 0)
+		buffer.push_back('\0');
+}
+
+bool is_little_endian()
+{
+	const uint16_t value = 1;
+	return *reinterpret_cast<const uint8_t *>(&value) == 1;
+}
+
+/** Create a table KeyValue { key, value }. */
+shared_ptr<FlatObject> key_value(const string &key, const string &value)
+{
+	auto object = FlatObject::table();
+	object->set_object(0, FlatObject::string_object(key));
+	object->set_object(1, FlatObject::string_object(value));
+	return object;
+}
+
+/** Create a nullable float64 field (table Field). */
+shared_ptr<FlatObject> double_field(
+	const string &name, const metadata_t &metadata)
+{
+	auto type = FlatObject::table();
+	type->set_scalar<int16_t>(0, precision_double);
+
+	vector<shared_ptr<FlatObject>> key_values;
+	for (const auto &entry : metadata)
+		key_values.push_back(key_value(entry.first, entry.second));
+
+	auto field = FlatObject::table();
+	field->set_object(0, FlatObject::string_object(name));
+	field->set_scalar<uint8_t>(1, 1); // nullable
+	field->set_scalar<uint8_t>(2, type_floating_point);
+	field->set_object(3, type);
+	// Readers expect the children, also if there are none
+	field->set_object(5, FlatObject::vector_object({}));
+	field->set_object(6, FlatObject::vector_object(key_values));
+	return field;
+}
+
+}
+
+const size_t ArrowExporter::batch_rows_ = 65536;
+
+ArrowExporter::ArrowExporter(const vector<AnalogTimeSnapshot> &snapshots,
+		const ArrowExportOptions &options) :
+	QObject(),
+	snapshots_(snapshots),
+	options_(options),
+	file_pos_(0),
+	progress_(-1),
+	row_count_(0),
+	cancel_(false),
+	running_(false)
+{
+}
+
+ArrowExporter::~ArrowExporter()
+{
+	cancel();
+}
+
+bool ArrowExporter::start(const QString &file_name)
+{
+	// A finished export must still be joined
+	wait();
+
+	// The columns are written in the byte order of the machine, but Arrow
+	// readers only support little endian files.
+	if (!is_little_endian()) {
+		qWarning() << "ArrowExporter::start(): Big endian is not supported";
+		return false;
+	}
+
+	file_name_ = file_name.toStdString();
+	output_file_.open(file_name_, std::ios::out | std::ios::binary);
+	if (!output_file_.is_open()) {
+		qWarning() << "ArrowExporter::start(): Could not open file" <<
+			file_name;
+		return false;
+	}
+
+	file_pos_ = 0;
+	batch_blocks_.clear();
+	progress_ = -1;
+	row_count_ = 0;
+	create_schema();
+
+	cancel_ = false;
+	running_ = true;
+	thread_ = std::thread(&ArrowExporter::thread_proc, this);
+	return true;
+}
+
+void ArrowExporter::cancel()
+{
+	cancel_ = true;
+	wait();
+}
+
+void ArrowExporter::wait()
+{
+	if (thread_.joinable())
+		thread_.join();
+	running_ = false;
+}
+
+bool ArrowExporter::is_running() const
+{
+	return running_;
+}
+
+size_t ArrowExporter::row_count() const
+{
+	return row_count_;
+}
+
+void ArrowExporter::create_schema()
+{
+	const metadata_t time_metadata = {
+		make_pair("unit", "s"),
+		make_pair("reference",
+			options_.relative_time ? "session start" : "unix epoch"),
+	};
+
+	// The columns of the signals are named "<channel> <signal>". The device
+	// is only added, when the name is not unique.
+	vector<string> names;
+	map<string, size_t> name_counts;
+	for (const auto &snapshot : snapshots_) {
+		const auto signal = snapshot.signal();
+		const auto channel = signal->parent_channel();
+		names.push_back(channel->name() + " " + signal->name());
+		++name_counts[names.back()];
+	}
+	map<string, size_t> unique_names;
+	for (size_t i = 0; i < names.size(); ++i) {
+		if (name_counts[names[i]] > 1) {
+			names[i] = snapshots_[i].signal()->parent_channel()->
+				parent_device()->name() + " " + names[i];
+		}
+		const size_t n = ++unique_names[names[i]];
+		if (n > 1)
+			names[i] += " " + std::to_string(n);
+	}
+
+	vector<shared_ptr<FlatObject>> fields;
+	if (options_.combined)
+		fields.push_back(double_field("Time", time_metadata));
+	for (size_t i = 0; i < snapshots_.size(); ++i) {
+		const auto signal = snapshots_[i].signal();
+		const auto channel = signal->parent_channel();
+
+		string channel_groups;
+		for (const auto &chg_name : channel->channel_group_names()) {
+			if (!channel_groups.empty())
+				channel_groups += ", ";
+			channel_groups += chg_name;
+		}
+
+		const metadata_t value_metadata = {
+			make_pair("device", channel->parent_device()->name()),
+			make_pair("channel_groups", channel_groups),
+			make_pair("channel", channel->name()),
+			make_pair("signal", signal->name()),
+			make_pair("quantity", signal->quantity_name().toStdString()),
+			make_pair("quantity_flags", datautil::format_quantity_flags(
+				signal->quantity_flags(), ", ").toStdString()),
+			make_pair("unit", signal->unit_name().toStdString()),
+		};
+
+		if (!options_.combined)
+			fields.push_back(double_field("Time " + names[i], time_metadata));
+		fields.push_back(double_field(names[i], value_metadata));
+	}
+
+	schema_ = FlatObject::table();
+	schema_->set_scalar<int16_t>(0, endianness_little);
+	schema_->set_object(1, FlatObject::vector_object(fields));
+	columns_.resize(fields.size());
+}
+
+void ArrowExporter::thread_proc()
+{
+	Block schema_block;
+	bool success = write(file_magic, sizeof(file_magic)) &&
+		write_message(message_header_schema, schema_, string(), schema_block);
+	if (success)
+		success = options_.combined ? export_combined() : export_separate();
+	if (success)
+		success = write_footer();
+	output_file_.close();
+
+	if (cancel_) {
+		// Don't leave a truncated file behind
+		std::remove(file_name_.c_str());
+		running_ = false;
+		return;
+	}
+	if (!success) {
+		qWarning() << "ArrowExporter: Writing the file" <<
+			QString::fromStdString(file_name_) << "failed";
+	}
+	update_progress(1, 1);
+	running_ = false;
+	Q_EMIT finished(success);
+}
+
+bool ArrowExporter::export_separate()
+{
+	size_t max_sample_count = 0;
+	for (const auto &snapshot : snapshots_)
+		max_sample_count = std::max(max_sample_count, snapshot.size());
+
+	for (size_t row = 0; row < max_sample_count; row += batch_rows_) {
+		if (cancel_)
+			return false;
+
+		// The samples are copied directly into the columns
+		const size_t rows = std::min(batch_rows_, max_sample_count - row);
+		clear_batch(rows);
+		for (size_t j = 0; j < snapshots_.size(); ++j) {
+			const auto &snapshot = snapshots_[j];
+			if (row >= snapshot.size())
+				continue;
+			const size_t count = snapshot.copy_samples(
+				snapshot.first_sample_pos() + row, rows, options_.relative_time,
+				columns_[2 * j].values.data(),
+				columns_[2 * j + 1].values.data());
+			set_valid(2 * j, count);
+			set_valid(2 * j + 1, count);
+		}
+		if (!write_batch(rows))
+			return false;
+
+		row_count_ += rows;
+		update_progress(row + rows, max_sample_count);
+	}
+	return true;
+}
+
+bool ArrowExporter::export_combined()
+{
+	size_t total_sample_count = 0;
+	for (const auto &snapshot : snapshots_)
+		total_sample_count += snapshot.size();
+	size_t sample_count = 0;
+
+	// Data, merged in batches of rows. The last row stays in the index,
+	// until the next batch is merged, because samples of the next batch can
+	// still join it.
+	MergedTimeIndex index(snapshots_, options_.relative_time);
+	index.set_timeframe(options_.combined_timeframe);
+	vector<uint8_t> valid(batch_rows_);
+	while (true) {
+		if (cancel_)
+			return false;
+
+		const size_t rows = index.flush(batch_rows_);
+		const size_t begin = index.begin_pos();
+		const size_t end = rows > 0 ? index.end_pos() - 1 : index.end_pos();
+		const size_t batch_rows = end - begin;
+		clear_batch(batch_rows);
+		for (size_t row = begin; row < end; ++row)
+			set_value(0, row - begin, index.timestamp(row));
+
+		// The values are copied directly into the columns
+		for (size_t k = 0; k < snapshots_.size(); ++k) {
+			Column &column = columns_[k + 1];
+			sample_count += index.copy_values(
+				begin, end, k, column.values.data(), valid.data());
+			for (size_t i = 0; i < batch_rows; ++i) {
+				if (valid[i])
+					set_value(k + 1, i, column.values[i]);
+			}
+		}
+		if (batch_rows > 0 && !write_batch(batch_rows))
+			return false;
+
+		row_count_ += batch_rows;
+		update_progress(sample_count, total_sample_count);
+		index.drop_front(batch_rows);
+		if (rows == 0)
+			break;
+	}
+	return true;
+}
+
+void ArrowExporter::clear_batch(size_t rows)
+{
+	for (auto &column : columns_) {
+		column.values.assign(rows, 0.);
+		column.validity.assign((rows + 7) / 8, 0);
+		column.null_count = rows;
+	}
+}
+
+void ArrowExporter::set_value(size_t column, size_t row, double value)
+{
+	Column &c = columns_[column];
+	c.values[row] = value;
+	const uint8_t bit = (uint8_t)(1 << (row % 8));
+	if ((c.validity[row / 8] & bit) == 0) {
+		c.validity[row / 8] |= bit;
+		--c.null_count;
+	}
+}
+
+void ArrowExporter::set_valid(size_t column, size_t count)
+{
+	// Only used for the first rows of a cleared batch
+	Column &c = columns_[column];
+	std::fill(c.validity.begin(), c.validity.begin() + count / 8, 0xFF);
+	if (count % 8 != 0)
+		c.validity[count / 8] = (uint8_t)((1 << (count % 8)) - 1);
+	c.null_count = c.values.size() - count;
+}
+
+bool ArrowExporter::write_batch(size_t rows)
+{
+	// The body holds the validity bitmap (only with nulls) and the values
+	// of every column, every buffer is aligned to 8 bytes.
+	string nodes;
+	string buffers;
+	body_.clear();
+	for (const auto &column : columns_) {
+		append_pod<int64_t>(nodes, (int64_t)rows);
+		append_pod<int64_t>(nodes, (int64_t)column.null_count);
+
+		const size_t validity_size =
+			column.null_count > 0 ? column.validity.size() : 0;
+		append_pod<int64_t>(buffers, (int64_t)body_.size());
+		append_pod<int64_t>(buffers, (int64_t)validity_size);
+		body_.append(reinterpret_cast<const char *>(column.validity.data()),
+			validity_size);
+		pad_to(body_, 8);
+
+		append_pod<int64_t>(buffers, (int64_t)body_.size());
+		append_pod<int64_t>(buffers, (int64_t)(rows * sizeof(double)));
+		body_.append(reinterpret_cast<const char *>(column.values.data()),
+			rows * sizeof(double));
+	}
+
+	auto batch = FlatObject::table();
+	batch->set_scalar<int64_t>(0, (int64_t)rows);
+	batch->set_object(1, FlatObject::struct_vector(
+		nodes, columns_.size(), sizeof(int64_t)));
+	batch->set_object(2, FlatObject::struct_vector(
+		buffers, 2 * columns_.size(), sizeof(int64_t)));
+
+	Block block;
+	if (!write_message(message_header_record_batch, batch, body_, block))
+		return false;
+	batch_blocks_.push_back(block);
+	return true;
+}
+
+bool ArrowExporter::write_message(uint8_t header_type,
+	shared_ptr<FlatObject> header, const string &body, Block &block)
+{
+	auto message = FlatObject::table();
+	message->set_scalar<int16_t>(0, metadata_version_v5);
+	message->set_scalar<uint8_t>(1, header_type);
+	message->set_object(2, header);
+	message->set_scalar<int64_t>(3, (int64_t)body.size());
+	const string metadata = message->finish();
+
+	string prefix;
+	append_pod<uint32_t>(prefix, continuation_marker);
+	append_pod<int32_t>(prefix, (int32_t)metadata.size());
+
+	block.offset = (int64_t)file_pos_;
+	block.metadata_size = (int32_t)(prefix.size() + metadata.size());
+	block.body_size = (int64_t)body.size();
+	return write(prefix.data(), prefix.size()) &&
+		write(metadata.data(), metadata.size()) &&
+		write(body.data(), body.size());
+}
+
+bool ArrowExporter::write_footer()
+{
+	// End of the stream
+	string eos;
+	append_pod<uint32_t>(eos, continuation_marker);
+	append_pod<int32_t>(eos, 0);
+
+	// struct Block { offset: long; metaDataLength: int; bodyLength: long; }
+	string blocks;
+	for (const auto &block : batch_blocks_) {
+		append_pod<int64_t>(blocks, block.offset);
+		append_pod<int32_t>(blocks, block.metadata_size);
+		append_pod<int32_t>(blocks, 0);
+		append_pod<int64_t>(blocks, block.body_size);
+	}
+
+	auto footer = FlatObject::table();
+	footer->set_scalar<int16_t>(0, metadata_version_v5);
+	footer->set_object(1, schema_);
+	footer->set_object(2, FlatObject::struct_vector("", 0, sizeof(int64_t)));
+	footer->set_object(3, FlatObject::struct_vector(
+		blocks, batch_blocks_.size(), sizeof(int64_t)));
+	const string footer_data = footer->finish();
+
+	string trailer;
+	append_pod<int32_t>(trailer, (int32_t)footer_data.size());
+	trailer.append(file_magic, file_magic_size);
+	return write(eos.data(), eos.size()) &&
+		write(footer_data.data(), footer_data.size()) &&
+		write(trailer.data(), trailer.size());
+}
+
+bool ArrowExporter::write(const char *data, size_t size)
+{
+	output_file_.write(data, (std::streamsize)size);
+	file_pos_ += size;
+	return output_file_.good();
+}
+
+void ArrowExporter::update_progress(size_t done, size_t total)
+{
+	const int progress = total > 0 ? (int)(done * 100 / total) : 100;
+	if (progress == progress_)
+		return;
+
+	progress_ = progress;
+	Q_EMIT progress_changed(progress);
+}
+
+} // namespace data
+} // namespace sv
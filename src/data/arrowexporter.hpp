@@ -0,0 +1,178 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_ARROWEXPORTER_HPP
+#define DATA_ARROWEXPORTER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <QObject>
+#include <QString>
+
+#include "src/data/analogtimesnapshot.hpp"
+
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+class FlatObject;
+
+/**
+ * Options for the Arrow export of signals.
+ */
+struct ArrowExportOptions
+{
+	/**
+	 * Export the timestamps relative to the session start or as seconds
+	 * since the epoch.
+	 */
+	bool relative_time;
+	/** Merge the timestamps of all signals in one time column. */
+	bool combined;
+	/** The combination time frame in seconds, see MergedTimeIndex. */
+	double combined_timeframe;
+};
+
+/**
+ * Exports the snapshots of signals to an Apache Arrow IPC file (also known
+ * as Feather V2) in a worker thread. The file can be read directly by
+ * pandas (read_feather()), Polars (read_ipc()) or pyarrow.
+ *
+ * All columns are float64 columns, the timestamps are seconds. Like the
+ * CSV export, every signal gets a time and a value column, or all signals
+ * share one time column, when the timestamps are combined. Missing samples
+ * are null. The device, channel, quantity and unit of a signal are stored
+ * in the metadata of its value column.
+ *
+ * The rows are written in record batches of batch_rows_ rows, so the
+ * memory use doesn't depend on the number of samples. The samples are read
+ * block by block from the snapshots, the signals can keep acquiring while
+ * the export is running. The schema is created by start(), in the thread
+ * of the caller.
+ */
+class ArrowExporter : public QObject
+{
+	Q_OBJECT
+
+public:
+	ArrowExporter(const vector<AnalogTimeSnapshot> &snapshots,
+		const ArrowExportOptions &options);
+	/** Cancels an unfinished export. */
+	~ArrowExporter();
+
+	/**
+	 * Start the export to the file.
+	 *
+	 * @return false if the file couldn't be opened.
+	 */
+	bool start(const QString &file_name);
+	/**
+	 * Cancel the export and remove the unfinished file. Returns when the
+	 * worker thread is finished.
+	 */
+	void cancel();
+	/** Wait until the export is finished. */
+	void wait();
+	bool is_running() const;
+	/** Return the number of exported rows. */
+	size_t row_count() const;
+
+private:
+	/** The position of a record batch in the file, see Arrow Block. */
+	struct Block
+	{
+		int64_t offset;
+		int32_t metadata_size;
+		int64_t body_size;
+	};
+
+	/** The values of a column in the current record batch. */
+	struct Column
+	{
+		vector<double> values;
+		/** One bit per row, set if the value is valid. */
+		vector<uint8_t> validity;
+		size_t null_count;
+	};
+
+	void create_schema();
+	void thread_proc();
+	/** Return false when the export was canceled or failed. */
+	bool export_separate();
+	bool export_combined();
+
+	/** Clear the values of all columns for a batch of rows. */
+	void clear_batch(size_t rows);
+	void set_value(size_t column, size_t row, double value);
+	/** Mark the first count rows of a cleared column as valid. */
+	void set_valid(size_t column, size_t count);
+	bool write_batch(size_t rows);
+	/** Write an encapsulated message with the header table and body. */
+	bool write_message(uint8_t header_type, shared_ptr<FlatObject> header,
+		const string &body, Block &block);
+	bool write_footer();
+	bool write(const char *data, size_t size);
+	void update_progress(size_t done, size_t total);
+
+	/** The number of rows in a record batch. */
+	static const size_t batch_rows_;
+
+	const vector<AnalogTimeSnapshot> snapshots_;
+	const ArrowExportOptions options_;
+	/** The schema table, that is also written to the footer. */
+	shared_ptr<FlatObject> schema_;
+	vector<Column> columns_;
+	string file_name_;
+	std::ofstream output_file_;
+	size_t file_pos_;
+	vector<Block> batch_blocks_;
+	string body_;
+	int progress_;
+	std::atomic<size_t> row_count_;
+
+	std::thread thread_;
+	std::atomic<bool> cancel_;
+	std::atomic<bool> running_;
+
+Q_SIGNALS:
+	/** The progress of the export in percent. */
+	void progress_changed(int percent);
+	/**
+	 * The export is finished. Not emitted, when the export is canceled.
+	 *
+	 * @param success false if writing the file failed.
+	 */
+	void finished(bool success);
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_ARROWEXPORTER_HPP
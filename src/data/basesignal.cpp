@@ -19,7 +19,10 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <cassert>
+#include <limits>
+#include <mutex>
 #include <string>
 
 #include <QDebug>
@@ -29,6 +32,7 @@
 #include "src/channels/basechannel.hpp"
 #include "src/data/datautil.hpp"
 
+using std::lock_guard;
 using std::set;
 using std::shared_ptr;
 using std::string;
@@ -44,8 +48,13 @@ BaseSignal::BaseSignal(
 		const string &custom_name) :
 	quantity_(quantity),
 	quantity_flags_(quantity_flags),
+	measured_quantity_(quantity,
+		data::datautil::get_quantity_flags_mask(quantity_flags)),
 	unit_(unit),
-	parent_channel_(parent_channel)
+	parent_channel_(parent_channel),
+	memory_priority_(0),
+	observer_count_(0),
+	clear_epoch_(0)
 {
 	/* TODO
 	if (!util::is_valid_sr_quantity(sr_quantity_))
@@ -66,6 +75,7 @@ BaseSignal::BaseSignal(
 	else {
 		name_ = custom_name;
 	}
+	display_name_ = QString::fromStdString(name_);
 }
 
 BaseSignal::~BaseSignal()
@@ -88,6 +98,11 @@ set<data::QuantityFlag> BaseSignal::quantity_flags() const
 	return quantity_flags_;
 }
 
+data::MeasuredQuantity BaseSignal::measured_quantity() const
+{
+	return measured_quantity_;
+}
+
 QString BaseSignal::quantity_flags_name() const
 {
 	return quantity_flags_name_;
@@ -112,6 +127,7 @@ void BaseSignal::set_name(const string &custom_name)
 {
 	if (!custom_name.empty()) {
 		name_ = custom_name;
+		display_name_ = QString::fromStdString(name_);
 		Q_EMIT name_changed(name_);
 	}
 }
@@ -123,7 +139,65 @@ string BaseSignal::name() const
 
 QString BaseSignal::display_name() const
 {
-	return QString::fromStdString(name_);
+	return display_name_;
+}
+
+unsigned int BaseSignal::clear_epoch() const
+{
+	return clear_epoch_.load(std::memory_order_acquire);
+}
+
+void BaseSignal::set_memory_priority(int memory_priority)
+{
+	memory_priority_ = memory_priority;
+}
+
+int BaseSignal::memory_priority() const
+{
+	return memory_priority_;
+}
+
+void BaseSignal::add_observer()
+{
+	if (observer_count_.fetch_add(1) == 0)
+		Q_EMIT observed_changed(true);
+}
+
+void BaseSignal::remove_observer()
+{
+	if (observer_count_.fetch_sub(1) == 1)
+		Q_EMIT observed_changed(false);
+}
+
+bool BaseSignal::is_observed() const
+{
+	return observer_count_ > 0;
+}
+
+void BaseSignal::set_observer_history(const void *observer, double history)
+{
+	lock_guard<std::mutex> lock(history_mutex_);
+	observer_histories_[observer] = history > 0. ? history : 0.;
+}
+
+void BaseSignal::clear_observer_history(const void *observer)
+{
+	lock_guard<std::mutex> lock(history_mutex_);
+	observer_histories_.erase(observer);
+}
+
+double BaseSignal::required_history() const
+{
+	lock_guard<std::mutex> lock(history_mutex_);
+	const int observer_count = observer_count_;
+	if (observer_count <= 0 ||
+			observer_histories_.size() < (size_t)observer_count)
+		return std::numeric_limits<double>::infinity();
+
+	double history = 0.;
+	for (const auto &observer_history : observer_histories_)
+		history = std::max(history, observer_history.second);
+	return history;
 }
 
 } // namespace data
@@ -22,7 +22,11 @@
 #ifndef DATA_BASESIGNAL_HPP
 #define DATA_BASESIGNAL_HPP
 
+#include <atomic>
+#include <cstddef>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 
@@ -32,6 +36,7 @@
 
 #include "src/data/datautil.hpp"
 
+using std::map;
 using std::set;
 using std::shared_ptr;
 using std::string;
@@ -63,11 +68,86 @@ public:
 	 */
 	virtual void clear() = 0;
 
+	/**
+	 * Return the number of clear() calls. Consumers, that keep positions
+	 * of samples (cursors, caches, indices), compare the epoch with the one
+	 * of their last read and start again at position 0, when it changed.
+	 * Unlike comparing the sample count, this also detects a clear(), after
+	 * which the signal was filled again. The epoch is incremented after
+	 * the samples were cleared.
+	 */
+	unsigned int clear_epoch() const;
+
 	/**
 	 * Return the number of samples in this signal.
 	 */
 	virtual size_t sample_count() const = 0;
 
+	/**
+	 * Return the number of samples, that are actually stored in the signal
+	 * and weren't dropped by the retention policy or evict_samples().
+	 */
+	virtual size_t retained_sample_count() const = 0;
+
+	/**
+	 * Return the number of bytes, that are used by the samples of this
+	 * signal in memory (memory_size()) and in the spill file
+	 * (spilled_size()).
+	 */
+	virtual size_t memory_size() const = 0;
+	virtual size_t spilled_size() const = 0;
+
+	/**
+	 * Store the following samples in a memory mapped temporary file.
+	 *
+	 * @return false if the temporary file couldn't be created.
+	 */
+	virtual bool set_spill_to_disk(bool spill_to_disk) = 0;
+	virtual bool spill_to_disk() const = 0;
+
+	/**
+	 * Drop the count oldest samples of the signal to free memory. The
+	 * newest sample is always kept.
+	 *
+	 * @return The number of dropped samples.
+	 */
+	virtual size_t evict_samples(size_t count) = 0;
+
+	/**
+	 * Set the priority of this signal for the memory budget of the session.
+	 * When the budget is exceeded, the signals with the lowest priority are
+	 * spilled or evicted first. The default priority is 0.
+	 */
+	void set_memory_priority(int memory_priority);
+	int memory_priority() const;
+
+	/**
+	 * Register a consumer (view, plot, math channel, ...), that reads the
+	 * samples of this signal. Lazy math channels only calculate their
+	 * signal, while it has observers. Every add_observer() must be paired
+	 * with a remove_observer().
+	 */
+	void add_observer();
+	void remove_observer();
+	bool is_observed() const;
+
+	/**
+	 * Declare, that the observer only needs the samples of the last history
+	 * seconds, e.g. a plot in rolling mode its time span. A history of 0
+	 * means, that only the new samples are needed. Calling it again updates
+	 * the history. The history must be cleared with clear_observer_history(),
+	 * before the observer calls remove_observer().
+	 */
+	void set_observer_history(const void *observer, double history);
+	void clear_observer_history(const void *observer);
+	/**
+	 * Return the longest history, that is needed by the observers of this
+	 * signal. This is infinity, if the signal isn't observed or if an
+	 * observer didn't declare its history, so unobserved signals are kept
+	 * for future observers. Used by the automatic retention of the session.
+	 */
+	double required_history() const;
+
 	/**
 	 * Return the quantity of this signal.
 	 */
@@ -83,6 +163,12 @@ public:
 	 */
 	set<data::QuantityFlag> quantity_flags() const;
 
+	/**
+	 * Return the quantity and the quantity flags of this signal as compact
+	 * MeasuredQuantity
+	 */
+	data::MeasuredQuantity measured_quantity() const;
+
 	/**
 	 * Return the quantity flags of this signal as string
 	 */
@@ -123,14 +209,25 @@ protected:
 	QString quantity_name_;
 	set<data::QuantityFlag> quantity_flags_;
 	QString quantity_flags_name_;
+	data::MeasuredQuantity measured_quantity_;
 	data::Unit unit_;
 	QString unit_name_;
 	shared_ptr<channels::BaseChannel> parent_channel_;
 
 	string name_;
+	/** name_ as QString, so display_name() doesn't convert it every time. */
+	QString display_name_;
+	std::atomic<int> memory_priority_;
+	std::atomic<int> observer_count_;
+	/** Incremented by clear() of the derived signals. */
+	std::atomic<unsigned int> clear_epoch_;
+	mutable std::mutex history_mutex_;
+	map<const void *, double> observer_histories_;
 
 Q_SIGNALS:
 	void name_changed(const std::string &name);
+	/** Emitted, when the first observer is added or the last is removed. */
+	void observed_changed(bool observed);
 
 };
 
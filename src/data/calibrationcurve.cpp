@@ -0,0 +1,232 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <QDebug>
+#include <QString>
+
+#include "calibrationcurve.hpp"
+#include "src/data/csvreader.hpp"
+#include "src/data/samplekernels.hpp"
+
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+const size_t CalibrationCurve::max_table_size = 1 << 16;
+
+CalibrationCurve::CalibrationCurve(CalibrationType type,
+		const vector<double> &values, double table_begin, double table_step) :
+	type_(type),
+	values_(values),
+	table_begin_(table_begin),
+	table_step_(table_step),
+	table_step_inverse_(table_step > 0. ? 1. / table_step : 0.)
+{
+}
+
+shared_ptr<CalibrationCurve> CalibrationCurve::polynomial(
+	const vector<double> &coefficients)
+{
+	if (coefficients.empty())
+		return nullptr;
+	for (const double coefficient : coefficients) {
+		if (!std::isfinite(coefficient))
+			return nullptr;
+	}
+
+	return shared_ptr<CalibrationCurve>(new CalibrationCurve(
+		CalibrationType::Polynomial, coefficients, 0., 0.));
+}
+
+shared_ptr<CalibrationCurve> CalibrationCurve::uniform_lookup_table(
+	double begin, double step, const vector<double> &table)
+{
+	if (table.size() < 2 || !(step > 0.) || !std::isfinite(step) ||
+			!std::isfinite(begin))
+		return nullptr;
+
+	return shared_ptr<CalibrationCurve>(new CalibrationCurve(
+		CalibrationType::LookupTable, table, begin, step));
+}
+
+shared_ptr<CalibrationCurve> CalibrationCurve::lookup_table(
+	const vector<double> &x, const vector<double> &y)
+{
+	const size_t size = x.size();
+	if (size < 2 || y.size() != size)
+		return nullptr;
+
+	double min_step = x[1] - x[0];
+	for (size_t i = 1; i < size; ++i) {
+		const double step = x[i] - x[i - 1];
+		if (!(step > 0.) || !std::isfinite(step))
+			return nullptr;
+		min_step = std::min(min_step, step);
+	}
+
+	// Equidistant points are used as they are
+	const double span = x[size - 1] - x[0];
+	const double step = span / (double)(size - 1);
+	bool is_uniform = true;
+	for (size_t i = 1; i < size; ++i) {
+		const double expected = x[0] + (double)i * step;
+		if (std::fabs(x[i] - expected) > 1e-6 * step) {
+			is_uniform = false;
+			break;
+		}
+	}
+	if (is_uniform)
+		return uniform_lookup_table(x[0], step, y);
+
+	// Resample the segments onto the smallest distance of the points
+	size_t table_size = (size_t)std::ceil(span / min_step) + 1;
+	table_size = std::min(table_size, max_table_size);
+	const double table_step = span / (double)(table_size - 1);
+	vector<double> table(table_size);
+	size_t segment = 0;
+	for (size_t j = 0; j < table_size; ++j) {
+		const double table_x = x[0] + (double)j * table_step;
+		while (segment + 2 < size && x[segment + 1] < table_x)
+			++segment;
+		const double fraction = (table_x - x[segment]) /
+			(x[segment + 1] - x[segment]);
+		table[j] = y[segment] + fraction * (y[segment + 1] - y[segment]);
+	}
+	// Hit the last point exactly
+	table[table_size - 1] = y[size - 1];
+
+	return uniform_lookup_table(x[0], table_step, table);
+}
+
+shared_ptr<CalibrationCurve> CalibrationCurve::load(const string &file_name)
+{
+	CsvReader reader("");
+	if (!reader.open(file_name)) {
+		qWarning() << "CalibrationCurve::load(): Can't open" <<
+			QString::fromStdString(file_name);
+		return nullptr;
+	}
+
+	vector<double> x;
+	vector<double> y;
+	bool is_first_record = true;
+	while (reader.read_record()) {
+		if (reader.field_count() == 0 || reader.field_empty(0) ||
+				reader.field_data(0)[0] == '#')
+			continue;
+		const bool is_header = is_first_record;
+		is_first_record = false;
+
+		if (reader.field(0) == "polynomial") {
+			vector<double> coefficients;
+			for (size_t i = 1; i < reader.field_count(); ++i) {
+				double coefficient;
+				if (reader.field_empty(i))
+					continue;
+				if (!reader.field_double(i, coefficient)) {
+					qWarning() << "CalibrationCurve::load(): Invalid" <<
+						"coefficient in line" << reader.line_number();
+					return nullptr;
+				}
+				coefficients.push_back(coefficient);
+			}
+			return polynomial(coefficients);
+		}
+
+		double point_x;
+		double point_y;
+		if (!reader.field_double(0, point_x) ||
+				!reader.field_double(1, point_y)) {
+			if (is_header)
+				continue;
+			qWarning() << "CalibrationCurve::load(): Invalid point in line" <<
+				reader.line_number();
+			return nullptr;
+		}
+		x.push_back(point_x);
+		y.push_back(point_y);
+	}
+
+	auto curve = lookup_table(x, y);
+	if (!curve) {
+		qWarning() << "CalibrationCurve::load(): The points in" <<
+			QString::fromStdString(file_name) << "are no valid table";
+	}
+	return curve;
+}
+
+CalibrationType CalibrationCurve::type() const
+{
+	return type_;
+}
+
+const vector<double> &CalibrationCurve::coefficients() const
+{
+	return values_;
+}
+
+double CalibrationCurve::table_begin() const
+{
+	return table_begin_;
+}
+
+double CalibrationCurve::table_step() const
+{
+	return table_step_;
+}
+
+const vector<double> &CalibrationCurve::table() const
+{
+	return values_;
+}
+
+double CalibrationCurve::apply(double value) const
+{
+	double result;
+	apply(&value, 1, &result);
+	return result;
+}
+
+void CalibrationCurve::apply(const double *values, size_t count,
+	double *dest) const
+{
+	switch (type_) {
+	case CalibrationType::Polynomial:
+		samplekernels::polynomial(values_.data(), values_.size(),
+			values, count, dest);
+		break;
+	case CalibrationType::LookupTable:
+		samplekernels::lookup_linear(values_.data(), values_.size(),
+			table_begin_, table_step_inverse_, values, count, dest);
+		break;
+	}
+}
+
+} // namespace data
+} // namespace sv
@@ -0,0 +1,123 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_CALIBRATIONCURVE_HPP
+#define DATA_CALIBRATIONCURVE_HPP
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+enum class CalibrationType {
+	Polynomial,
+	LookupTable,
+};
+
+/**
+ * A calibration/linearisation curve, e.g. for a thermocouple or a shunt.
+ * The curve is either a polynomial or a piecewise linear lookup table with
+ * equidistant points, so the segment of a value is indexed directly. Both
+ * are evaluated for blocks of samples with the kernels in samplekernels.
+ *
+ * A curve is immutable, so it can be shared between threads.
+ */
+class CalibrationCurve
+{
+public:
+	/**
+	 * Create a polynomial c0 + c1 * x + c2 * x^2 + ...
+	 *
+	 * @return nullptr if there are no coefficients or a coefficient is not
+	 *         finite.
+	 */
+	static shared_ptr<CalibrationCurve> polynomial(
+		const vector<double> &coefficients);
+
+	/**
+	 * Create a lookup table with points, that are step apart, starting at
+	 * begin.
+	 *
+	 * @return nullptr if there are less than 2 points or the step is not
+	 *         positive.
+	 */
+	static shared_ptr<CalibrationCurve> uniform_lookup_table(
+		double begin, double step, const vector<double> &table);
+
+	/**
+	 * Create a lookup table from the points (x[i], y[i]), e.g. a reference
+	 * table. Points, that are not equidistant, are resampled onto the
+	 * smallest distance of the points, up to max_table_size points.
+	 *
+	 * @return nullptr if there are less than 2 points, the sizes differ or
+	 *         the x values are not strictly ascending.
+	 */
+	static shared_ptr<CalibrationCurve> lookup_table(
+		const vector<double> &x, const vector<double> &y);
+
+	/**
+	 * Load a curve from a CSV file. A record "polynomial,c0,c1,..." is a
+	 * polynomial, all other records are "x,y" points of a lookup table. A
+	 * first record, that is not a number, is skipped as header.
+	 *
+	 * @return nullptr if the file couldn't be read or is invalid.
+	 */
+	static shared_ptr<CalibrationCurve> load(const string &file_name);
+
+	CalibrationType type() const;
+	/** The coefficients of a polynomial in ascending order. */
+	const vector<double> &coefficients() const;
+	/** The first x value of a lookup table. */
+	double table_begin() const;
+	/** The distance of the x values of a lookup table. */
+	double table_step() const;
+	/** The y values of a lookup table. */
+	const vector<double> &table() const;
+
+	double apply(double value) const;
+	/** Apply the curve to count values. dest may be values. */
+	void apply(const double *values, size_t count, double *dest) const;
+
+	/** The maximum size of a resampled lookup table. */
+	static const size_t max_table_size;
+
+private:
+	CalibrationCurve(CalibrationType type, const vector<double> &values,
+		double table_begin, double table_step);
+
+	const CalibrationType type_;
+	/** The coefficients or the table. */
+	const vector<double> values_;
+	const double table_begin_;
+	const double table_step_;
+	const double table_step_inverse_;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_CALIBRATIONCURVE_HPP
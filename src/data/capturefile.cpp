@@ -0,0 +1,761 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <QByteArray>
+#include <QDebug>
+#include <QFile>
+#include <QString>
+
+#include "capturefile.hpp"
+#include "src/channels/basechannel.hpp"
+#include "src/channels/mathchannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/analogtimesnapshot.hpp"
+#include "src/data/datautil.hpp"
+#include "src/devices/basedevice.hpp"
+
+using std::dynamic_pointer_cast;
+using std::set;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+namespace capturefile {
+
+const char magic[8] = { 'S', 'V', 'C', 'A', 'P', 'T', 'R', '\0' };
+const uint32_t byte_order_mark = 0x01020304;
+const uint32_t version = 1;
+const size_t chunk_size = 65536;
+
+}
+
+namespace {
+
+const uint32_t record_type_signal = 1;
+const uint32_t record_type_chunk = 2;
+const uint32_t record_type_state = 3;
+const uint32_t chunk_flag_compressed = 1;
+
+/** magic, byte order mark and version */
+const size_t file_header_size = 16;
+/** type, reserved and payload size */
+const size_t record_header_size = 16;
+/** signal id, flags, sample count, first/last timestamp and min/max */
+const size_t chunk_header_size = 48;
+const size_t no_state = std::numeric_limits<size_t>::max();
+
+template<typename T>
+void append_pod(string &buffer, const T value)
+{
+	buffer.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+void append_string(string &buffer, const string &str)
+{
+	append_pod<uint32_t>(buffer, (uint32_t)str.size());
+	buffer.append(str);
+}
+
+/**
+ * Reads numbers and strings from a record. All reads are checked against
+ * the size of the record, ok() returns false after a read past its end.
+ */
+class RecordReader
+{
+public:
+	RecordReader(const unsigned char *data, size_t size) :
+		data_(data), size_(size), pos_(0), ok_(true)
+	{
+	}
+
+	template<typename T>
+	T read()
+	{
+		T value = T();
+		if (!ok_ || size_ - pos_ < sizeof(T)) {
+			ok_ = false;
+			return value;
+		}
+		std::memcpy(&value, data_ + pos_, sizeof(T));
+		pos_ += sizeof(T);
+		return value;
+	}
+
+	string read_string()
+	{
+		const uint32_t len = read<uint32_t>();
+		if (!ok_ || size_ - pos_ < len) {
+			ok_ = false;
+			return string();
+		}
+		string str(reinterpret_cast<const char *>(data_ + pos_), len);
+		pos_ += len;
+		return str;
+	}
+
+	size_t pos() const { return pos_; }
+	bool ok() const { return ok_; }
+
+private:
+	const unsigned char *data_;
+	const size_t size_;
+	size_t pos_;
+	bool ok_;
+
+};
+
+}
+
+CaptureWriter::CaptureWriter() :
+	file_(nullptr),
+	compressed_(false),
+	next_id_(0),
+	written_sample_count_(0)
+{
+}
+
+CaptureWriter::~CaptureWriter()
+{
+	close();
+}
+
+bool CaptureWriter::open(const string &file_name, bool compressed)
+{
+	close();
+
+	file_ = std::fopen(file_name.c_str(), "wb");
+	if (!file_) {
+		qWarning() << "CaptureWriter::open(): Can't create" <<
+			QString::fromStdString(file_name);
+		return false;
+	}
+	compressed_ = compressed;
+	next_id_ = 0;
+	written_sample_count_ = 0;
+
+	string header(capturefile::magic, sizeof(capturefile::magic));
+	append_pod<uint32_t>(header, capturefile::byte_order_mark);
+	append_pod<uint32_t>(header, capturefile::version);
+	return write(header.data(), header.size());
+}
+
+bool CaptureWriter::open_append(const string &file_name, uint32_t next_id,
+	bool compressed)
+{
+	close();
+
+	file_ = std::fopen(file_name.c_str(), "ab");
+	if (!file_) {
+		qWarning() << "CaptureWriter::open_append(): Can't open" <<
+			QString::fromStdString(file_name);
+		return false;
+	}
+	compressed_ = compressed;
+	next_id_ = next_id;
+	written_sample_count_ = 0;
+	return true;
+}
+
+void CaptureWriter::close()
+{
+	if (!file_)
+		return;
+
+	std::fclose(file_);
+	file_ = nullptr;
+	entries_.clear();
+}
+
+bool CaptureWriter::is_open() const
+{
+	return file_ != nullptr;
+}
+
+bool CaptureWriter::add_signal(shared_ptr<AnalogTimeSignal> signal)
+{
+	if (!file_ || !signal)
+		return false;
+
+	const auto channel = signal->parent_channel();
+	Entry entry{ signal, next_id_, 0, 0,
+		-std::numeric_limits<double>::infinity() };
+
+	string payload;
+	append_pod<uint32_t>(payload, entry.id);
+	append_pod<int32_t>(payload, (int32_t)signal->quantity());
+	append_pod<int32_t>(payload, (int32_t)signal->unit());
+	append_pod<int32_t>(payload, (int32_t)signal->digits());
+	append_pod<int32_t>(payload, (int32_t)signal->decimal_places());
+	const auto quantity_flags = signal->quantity_flags();
+	append_pod<uint32_t>(payload, (uint32_t)quantity_flags.size());
+	for (const auto &quantity_flag : quantity_flags)
+		append_pod<int32_t>(payload, (int32_t)quantity_flag);
+	append_pod<double>(payload, signal->signal_start_timestamp());
+	append_string(payload, channel && channel->parent_device() ?
+		channel->parent_device()->name() : "");
+	const auto channel_group_names = channel ?
+		channel->channel_group_names() : set<string>();
+	append_pod<uint32_t>(payload, (uint32_t)channel_group_names.size());
+	for (const auto &channel_group_name : channel_group_names)
+		append_string(payload, channel_group_name);
+	append_string(payload, channel ? channel->name() : "");
+	append_string(payload, signal->name());
+	// Keep the uncompressed columns of the following chunks 8 byte aligned,
+	// so the reader can use them directly from the mapped file
+	payload.resize((payload.size() + 7) & ~(size_t)7, '\0');
+
+	if (!write_record(record_type_signal, payload))
+		return false;
+	entries_.push_back(entry);
+	++next_id_;
+	return true;
+}
+
+bool CaptureWriter::resume_signal(shared_ptr<AnalogTimeSignal> signal,
+	uint32_t id, size_t file_sample_count, double last_timestamp)
+{
+	if (!file_ || !signal)
+		return false;
+
+	// The signal may have been added as a new signal in the meantime
+	entries_.erase(std::remove_if(entries_.begin(), entries_.end(),
+		[&signal](const Entry &entry) { return entry.signal == signal; }),
+		entries_.end());
+	entries_.push_back(Entry{ signal, id, signal->sample_count(),
+		file_sample_count, last_timestamp });
+	next_id_ = std::max(next_id_, id + 1);
+	return true;
+}
+
+bool CaptureWriter::has_signal(const shared_ptr<AnalogTimeSignal> &signal) const
+{
+	return std::any_of(entries_.begin(), entries_.end(),
+		[&signal](const Entry &entry) { return entry.signal == signal; });
+}
+
+bool CaptureWriter::write_new_samples()
+{
+	if (!file_)
+		return false;
+
+	for (auto &entry : entries_) {
+		if (!write_samples(entry, entry.signal->sample_count()))
+			return false;
+	}
+
+	return std::fflush(file_) == 0;
+}
+
+bool CaptureWriter::write_checkpoint()
+{
+	if (!file_)
+		return false;
+
+	for (auto &entry : entries_) {
+		// The state and the position, that it belongs to, are taken
+		// together. A math channel pauses its calculation meanwhile.
+		RunningStatisticsState statistics;
+		vector<double> channel_state;
+		size_t end_pos;
+		auto math_channel = dynamic_pointer_cast<channels::MathChannel>(
+			entry.signal->parent_channel());
+		if (math_channel && math_channel->actual_signal() == entry.signal)
+			channel_state = math_channel->checkpoint_state(statistics, end_pos);
+		else
+			statistics = entry.signal->statistics_state(end_pos);
+
+		if (!write_samples(entry, end_pos) ||
+				!write_state(entry, statistics, channel_state))
+			return false;
+	}
+
+	return std::fflush(file_) == 0;
+}
+
+bool CaptureWriter::write_samples(Entry &entry, size_t end_pos)
+{
+	vector<double> timestamps(capturefile::chunk_size);
+	vector<double> values(capturefile::chunk_size);
+	const auto snapshot = entry.signal->snapshot();
+	if (entry.next_pos < snapshot.first_sample_pos()) {
+		qWarning() << "CaptureWriter::write_samples():" <<
+			snapshot.first_sample_pos() - entry.next_pos <<
+			"samples were dropped before they were written";
+		entry.next_pos = snapshot.first_sample_pos();
+	}
+	end_pos = std::min(end_pos, snapshot.sample_count());
+	while (entry.next_pos < end_pos) {
+		const size_t count = std::min(capturefile::chunk_size,
+			end_pos - entry.next_pos);
+		const size_t copied = snapshot.copy_samples(entry.next_pos, count,
+			false, timestamps.data(), values.data());
+		if (copied == 0)
+			break;
+		entry.next_pos += copied;
+
+		// Samples of a resumed signal, that are already in the file, e.g.
+		// recalculated results of a math channel
+		size_t skip = 0;
+		while (skip < copied && timestamps[skip] <= entry.written_timestamp)
+			++skip;
+		if (skip == copied)
+			continue;
+		if (!write_chunk(entry, timestamps.data() + skip,
+				values.data() + skip, copied - skip))
+			return false;
+	}
+	return true;
+}
+
+bool CaptureWriter::write_state(const Entry &entry,
+	const RunningStatisticsState &statistics,
+	const vector<double> &channel_state)
+{
+	string payload;
+	append_pod<uint32_t>(payload, entry.id);
+	append_pod<uint32_t>(payload, 0);
+	append_pod<uint64_t>(payload, (uint64_t)entry.file_sample_count);
+	append_pod<uint64_t>(payload, (uint64_t)statistics.count);
+	append_pod<double>(payload, statistics.mean);
+	append_pod<double>(payload, statistics.m2);
+	append_pod<uint32_t>(payload, (uint32_t)channel_state.size());
+	for (const double value : channel_state)
+		append_pod<double>(payload, value);
+	// Keep the following chunks 8 byte aligned, see add_signal()
+	payload.resize((payload.size() + 7) & ~(size_t)7, '\0');
+	return write_record(record_type_state, payload);
+}
+
+bool CaptureWriter::sync()
+{
+	if (!file_ || std::fflush(file_) != 0)
+		return false;
+
+#ifdef _WIN32
+	return _commit(_fileno(file_)) == 0;
+#else
+	return fsync(fileno(file_)) == 0;
+#endif
+}
+
+size_t CaptureWriter::written_sample_count() const
+{
+	return written_sample_count_;
+}
+
+bool CaptureWriter::write(const char *data, size_t size)
+{
+	return std::fwrite(data, 1, size, file_) == size;
+}
+
+bool CaptureWriter::write_record(uint32_t type, const string &payload)
+{
+	string header;
+	append_pod<uint32_t>(header, type);
+	append_pod<uint32_t>(header, 0);
+	append_pod<uint64_t>(header, (uint64_t)payload.size());
+	return write(header.data(), header.size()) &&
+		write(payload.data(), payload.size());
+}
+
+bool CaptureWriter::write_chunk(Entry &entry,
+	const double *timestamps, const double *values, size_t count)
+{
+	double min = std::numeric_limits<double>::max();
+	double max = std::numeric_limits<double>::lowest();
+	for (size_t i = 0; i < count; ++i) {
+		if (std::isnan(values[i]))
+			continue;
+		min = std::min(min, values[i]);
+		max = std::max(max, values[i]);
+	}
+
+	// Columnar: All timestamps, then all values
+	QByteArray data;
+	data.reserve((int)(count * 2 * sizeof(double)));
+	data.append(reinterpret_cast<const char *>(timestamps),
+		(int)(count * sizeof(double)));
+	data.append(reinterpret_cast<const char *>(values),
+		(int)(count * sizeof(double)));
+	if (compressed_)
+		data = qCompress(data);
+
+	string payload;
+	payload.reserve(chunk_header_size + (size_t)data.size());
+	append_pod<uint32_t>(payload, entry.id);
+	append_pod<uint32_t>(payload, compressed_ ? chunk_flag_compressed : 0);
+	append_pod<uint64_t>(payload, (uint64_t)count);
+	append_pod<double>(payload, timestamps[0]);
+	append_pod<double>(payload, timestamps[count - 1]);
+	append_pod<double>(payload, min);
+	append_pod<double>(payload, max);
+	payload.append(data.constData(), (size_t)data.size());
+
+	if (!write_record(record_type_chunk, payload))
+		return false;
+	written_sample_count_ += count;
+	entry.file_sample_count += count;
+	entry.written_timestamp = timestamps[count - 1];
+	return true;
+}
+
+CaptureReader::CaptureReader() :
+	data_(nullptr),
+	size_(0),
+	valid_size_(0)
+{
+}
+
+CaptureReader::~CaptureReader()
+{
+	close();
+}
+
+bool CaptureReader::open(const string &file_name)
+{
+	close();
+
+	file_.reset(new QFile(QString::fromStdString(file_name)));
+	if (!file_->open(QIODevice::ReadOnly)) {
+		qWarning() << "CaptureReader::open(): Can't open" <<
+			QString::fromStdString(file_name);
+		close();
+		return false;
+	}
+	size_ = (size_t)file_->size();
+	if (size_ > 0)
+		data_ = file_->map(0, file_->size());
+	if (!data_ || size_ < file_header_size ||
+			std::memcmp(data_, capturefile::magic,
+				sizeof(capturefile::magic)) != 0) {
+		qWarning() << "CaptureReader::open(): Not a capture file:" <<
+			QString::fromStdString(file_name);
+		close();
+		return false;
+	}
+
+	RecordReader header(data_ + sizeof(capturefile::magic),
+		file_header_size - sizeof(capturefile::magic));
+	const uint32_t byte_order_mark = header.read<uint32_t>();
+	const uint32_t version = header.read<uint32_t>();
+	if (byte_order_mark != capturefile::byte_order_mark ||
+			version > capturefile::version) {
+		qWarning() << "CaptureReader::open(): Unsupported byte order or "
+			"version" << version << "in" << QString::fromStdString(file_name);
+		close();
+		return false;
+	}
+
+	size_t pos = file_header_size;
+	valid_size_ = pos;
+	while (size_ - pos >= record_header_size) {
+		RecordReader record(data_ + pos, record_header_size);
+		const uint32_t type = record.read<uint32_t>();
+		record.read<uint32_t>();
+		const uint64_t payload_size = record.read<uint64_t>();
+		pos += record_header_size;
+		// An incomplete record at the end, e.g. after a crash
+		if (payload_size > size_ - pos)
+			break;
+
+		bool ok = true;
+		if (type == record_type_signal)
+			ok = parse_signal(data_ + pos, (size_t)payload_size);
+		else if (type == record_type_chunk)
+			ok = parse_chunk(data_ + pos, (size_t)payload_size, pos);
+		else if (type == record_type_state)
+			ok = parse_state(data_ + pos, (size_t)payload_size);
+		// Unknown records from newer versions are skipped
+		if (!ok) {
+			qWarning() << "CaptureReader::open(): Invalid record at" << pos <<
+				"in" << QString::fromStdString(file_name);
+			close();
+			return false;
+		}
+		pos += (size_t)payload_size;
+		valid_size_ = pos;
+	}
+
+	return true;
+}
+
+void CaptureReader::close()
+{
+	if (file_ && data_)
+		file_->unmap(const_cast<unsigned char *>(data_));
+	file_.reset();
+	data_ = nullptr;
+	size_ = 0;
+	signal_infos_.clear();
+	chunk_infos_.clear();
+	signal_states_.clear();
+	valid_size_ = 0;
+}
+
+const vector<CaptureSignalInfo> &CaptureReader::signal_infos() const
+{
+	return signal_infos_;
+}
+
+const vector<CaptureChunkInfo> &CaptureReader::chunk_infos() const
+{
+	return chunk_infos_;
+}
+
+const CaptureSignalState *CaptureReader::signal_state(size_t signal) const
+{
+	if (signal >= signal_states_.size() ||
+			signal_states_[signal].sample_count == no_state)
+		return nullptr;
+	return &signal_states_[signal];
+}
+
+size_t CaptureReader::valid_size() const
+{
+	return valid_size_;
+}
+
+uint32_t CaptureReader::next_signal_id() const
+{
+	uint32_t next_id = 0;
+	for (const auto &info : signal_infos_)
+		next_id = std::max(next_id, info.id + 1);
+	return next_id;
+}
+
+bool CaptureReader::read_chunk(size_t chunk,
+	vector<double> &timestamps, vector<double> &values) const
+{
+	const CaptureChunkInfo &info = chunk_infos_[chunk];
+	const size_t column_size = info.sample_count * sizeof(double);
+
+	QByteArray uncompressed;
+	const char *data = reinterpret_cast<const char *>(data_ + info.offset);
+	if (info.compressed) {
+		// qUncompress() allocates the size in the (big endian) header of
+		// the data, so check it before. parse_chunk() has bounded
+		// sample_count and size to fit into an int.
+		if (info.size < 4)
+			return false;
+		const unsigned char *header = data_ + info.offset;
+		const size_t expected_size = ((size_t)header[0] << 24) |
+			((size_t)header[1] << 16) | ((size_t)header[2] << 8) |
+			(size_t)header[3];
+		if (expected_size != 2 * column_size)
+			return false;
+		uncompressed = qUncompress(
+			reinterpret_cast<const uchar *>(data), (int)info.size);
+		data = uncompressed.constData();
+		if ((size_t)uncompressed.size() != 2 * column_size)
+			return false;
+	}
+	else if (info.size != 2 * column_size) {
+		return false;
+	}
+
+	timestamps.resize(info.sample_count);
+	values.resize(info.sample_count);
+	if (info.sample_count == 0)
+		return true;
+	std::memcpy(timestamps.data(), data, column_size);
+	std::memcpy(values.data(), data + column_size, column_size);
+	return true;
+}
+
+bool CaptureReader::is_mapped(size_t chunk) const
+{
+	const CaptureChunkInfo &info = chunk_infos_[chunk];
+	return !info.compressed && info.sample_count > 0 &&
+		info.size == 2 * info.sample_count * sizeof(double) &&
+		info.offset % sizeof(double) == 0;
+}
+
+const double *CaptureReader::mapped_timestamps(size_t chunk) const
+{
+	if (!is_mapped(chunk))
+		return nullptr;
+	return reinterpret_cast<const double *>(data_ + chunk_infos_[chunk].offset);
+}
+
+const double *CaptureReader::mapped_values(size_t chunk) const
+{
+	if (!is_mapped(chunk))
+		return nullptr;
+	return mapped_timestamps(chunk) + chunk_infos_[chunk].sample_count;
+}
+
+bool CaptureReader::push_samples(size_t signal,
+	shared_ptr<AnalogTimeSignal> dest, shared_ptr<const void> owner,
+	size_t first, size_t last) const
+{
+	const CaptureSignalInfo &info = signal_infos_[signal];
+	vector<double> timestamps;
+	vector<double> values;
+	// The position of the first sample of the chunk in the signal
+	size_t chunk_pos = 0;
+	for (size_t i = 0; i < chunk_infos_.size() && chunk_pos < last; ++i) {
+		if (chunk_infos_[i].signal != signal)
+			continue;
+		const size_t count = chunk_infos_[i].sample_count;
+		const size_t begin = first > chunk_pos ? first - chunk_pos : 0;
+		const size_t end = std::min(count, last - chunk_pos);
+		chunk_pos += count;
+		if (begin >= end)
+			continue;
+
+		if (is_mapped(i)) {
+			dest->push_samples(mapped_timestamps(i) + begin,
+				mapped_values(i) + begin, end - begin,
+				info.digits, info.decimal_places, owner);
+			continue;
+		}
+		if (!read_chunk(i, timestamps, values)) {
+			qWarning() << "CaptureReader::push_samples(): Invalid chunk" << i;
+			return false;
+		}
+		dest->push_samples(timestamps.data() + begin, values.data() + begin,
+			end - begin, info.digits, info.decimal_places);
+	}
+	return true;
+}
+
+bool CaptureReader::parse_signal(const unsigned char *data, size_t size)
+{
+	RecordReader record(data, size);
+	CaptureSignalInfo info;
+	info.id = record.read<uint32_t>();
+	info.quantity = (Quantity)record.read<int32_t>();
+	info.unit = (Unit)record.read<int32_t>();
+	info.digits = record.read<int32_t>();
+	info.decimal_places = record.read<int32_t>();
+	const uint32_t flag_count = record.read<uint32_t>();
+	for (uint32_t i = 0; i < flag_count && record.ok(); ++i)
+		info.quantity_flags.insert((QuantityFlag)record.read<int32_t>());
+	info.signal_start_timestamp = record.read<double>();
+	info.device_name = record.read_string();
+	const uint32_t group_count = record.read<uint32_t>();
+	for (uint32_t i = 0; i < group_count && record.ok(); ++i)
+		info.channel_group_names.insert(record.read_string());
+	info.channel_name = record.read_string();
+	info.name = record.read_string();
+	info.sample_count = 0;
+	if (!record.ok())
+		return false;
+
+	signal_infos_.push_back(info);
+	CaptureSignalState state;
+	state.sample_count = no_state;
+	signal_states_.push_back(state);
+	return true;
+}
+
+bool CaptureReader::parse_chunk(
+	const unsigned char *data, size_t size, size_t offset)
+{
+	RecordReader record(data, size);
+	const uint32_t id = record.read<uint32_t>();
+	const uint32_t flags = record.read<uint32_t>();
+	CaptureChunkInfo info;
+	info.sample_count = (size_t)record.read<uint64_t>();
+	info.first_timestamp = record.read<double>();
+	info.last_timestamp = record.read<double>();
+	info.min = record.read<double>();
+	info.max = record.read<double>();
+	info.compressed = (flags & chunk_flag_compressed) != 0;
+	info.offset = offset + record.pos();
+	info.size = size - record.pos();
+	if (!record.ok())
+		return false;
+
+	// sample_count comes from the file, so it must fit into the chunk,
+	// before any size is calculated from it. Compressed chunks are
+	// uncompressed into a QByteArray, whose size is an int.
+	const size_t sample_size = 2 * sizeof(double);
+	if (info.compressed) {
+		const size_t max_size = (size_t)std::numeric_limits<int>::max();
+		if (info.size > max_size || info.sample_count > max_size / sample_size)
+			return false;
+	}
+	else if (info.sample_count > info.size / sample_size) {
+		return false;
+	}
+
+	// The signal record is always written before the chunks of the signal
+	auto it = std::find_if(signal_infos_.begin(), signal_infos_.end(),
+		[id](const CaptureSignalInfo &signal_info) {
+			return signal_info.id == id;
+		});
+	if (it == signal_infos_.end())
+		return false;
+	info.signal = (size_t)(it - signal_infos_.begin());
+	it->sample_count += info.sample_count;
+
+	chunk_infos_.push_back(info);
+	return true;
+}
+
+bool CaptureReader::parse_state(const unsigned char *data, size_t size)
+{
+	RecordReader record(data, size);
+	const uint32_t id = record.read<uint32_t>();
+	record.read<uint32_t>();
+	CaptureSignalState state;
+	state.sample_count = (size_t)record.read<uint64_t>();
+	state.statistics.count = (size_t)record.read<uint64_t>();
+	state.statistics.mean = record.read<double>();
+	state.statistics.m2 = record.read<double>();
+	const uint32_t state_size = record.read<uint32_t>();
+	for (uint32_t i = 0; i < state_size && record.ok(); ++i)
+		state.channel_state.push_back(record.read<double>());
+	if (!record.ok())
+		return false;
+
+	auto it = std::find_if(signal_infos_.begin(), signal_infos_.end(),
+		[id](const CaptureSignalInfo &signal_info) {
+			return signal_info.id == id;
+		});
+	if (it == signal_infos_.end())
+		return false;
+	// The last state of a signal counts
+	signal_states_[(size_t)(it - signal_infos_.begin())] = state;
+	return true;
+}
+
+} // namespace data
+} // namespace sv
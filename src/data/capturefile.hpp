@@ -0,0 +1,345 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_CAPTUREFILE_HPP
+#define DATA_CAPTUREFILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "src/data/datautil.hpp"
+#include "src/data/runningstatistics.hpp"
+
+using std::set;
+using std::shared_ptr;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+class QFile;
+
+namespace sv {
+namespace data {
+
+class AnalogTimeSignal;
+
+/**
+ * The metadata of a signal in a capture file.
+ */
+struct CaptureSignalInfo
+{
+	/** The id of the signal in the file. */
+	uint32_t id;
+	Quantity quantity;
+	set<QuantityFlag> quantity_flags;
+	Unit unit;
+	int digits;
+	int decimal_places;
+	double signal_start_timestamp;
+	string device_name;
+	set<string> channel_group_names;
+	string channel_name;
+	string name;
+	/** The number of samples in all chunks of the signal. */
+	size_t sample_count;
+};
+
+/**
+ * The index entry of a chunk of samples in a capture file.
+ */
+struct CaptureChunkInfo
+{
+	/** The index of the signal in CaptureReader::signal_infos(). */
+	size_t signal;
+	size_t sample_count;
+	double first_timestamp;
+	double last_timestamp;
+	double min;
+	double max;
+	bool compressed;
+	/** The position and size of the (compressed) samples in the file. */
+	size_t offset;
+	size_t size;
+};
+
+/**
+ * The checkpoint state of a signal in a capture file, see
+ * CaptureWriter::write_checkpoint().
+ */
+struct CaptureSignalState
+{
+	/**
+	 * The number of samples of the signal in the file, that the state
+	 * belongs to. Samples behind them were written after the state.
+	 */
+	size_t sample_count;
+	RunningStatisticsState statistics;
+	/** The calculation state of a math channel, see MathChannel::state(). */
+	vector<double> channel_state;
+};
+
+/**
+ * The binary capture file format of SmuView.
+ *
+ * A capture file starts with a header (magic, byte order mark, version)
+ * and is followed by records, that are only appended: A signal record
+ * holds the metadata of a signal, a chunk record holds up to chunk_size
+ * samples of a signal as a column of (absolute) timestamps followed by a
+ * column of values. Every chunk has its sample count, time range and
+ * min/max values in its header, so the file can be indexed without reading
+ * the samples. The samples of a chunk can be compressed with qCompress().
+ * A state record holds the checkpoint state of a signal (the running
+ * statistics and the state of a math channel), the last one counts.
+ *
+ * Because records are only appended, samples can be written while the
+ * signals are still acquiring. An incomplete record at the end of the file
+ * (e.g. after a crash) is ignored by the reader. The numbers are stored in
+ * the byte order of the writer, the reader rejects files with a different
+ * byte order.
+ */
+namespace capturefile {
+
+extern const char magic[8];
+extern const uint32_t byte_order_mark;
+extern const uint32_t version;
+/** The default number of samples in a chunk. */
+extern const size_t chunk_size;
+
+}
+
+/**
+ * Writes signals to a capture file, see capturefile. The writer is not
+ * thread-safe.
+ */
+class CaptureWriter
+{
+public:
+	CaptureWriter();
+	~CaptureWriter();
+
+	CaptureWriter(const CaptureWriter &) = delete;
+	CaptureWriter &operator=(const CaptureWriter &) = delete;
+
+	/**
+	 * Create the file and write the file header.
+	 *
+	 * @param compressed Compress the samples of the chunks.
+	 * @return false if the file couldn't be created.
+	 */
+	bool open(const string &file_name, bool compressed = false);
+	/**
+	 * Open an existing capture file to append records to it. The file must
+	 * end with a complete record (see CaptureReader::valid_size()). The
+	 * signals of the file are continued with resume_signal(), new signals
+	 * get ids from next_id on.
+	 *
+	 * @return false if the file couldn't be opened.
+	 */
+	bool open_append(const string &file_name, uint32_t next_id,
+		bool compressed = false);
+	void close();
+	bool is_open() const;
+
+	/**
+	 * Write the metadata of the signal. The samples are written by
+	 * write_new_samples().
+	 *
+	 * @return false if the file is not open or writing failed.
+	 */
+	bool add_signal(shared_ptr<AnalogTimeSignal> signal);
+	/**
+	 * Continue a signal of the file (opened with open_append()), after its
+	 * samples were restored. The samples of the signal up to now count as
+	 * written and samples up to last_timestamp (the last timestamp of the
+	 * signal in the file) are not written again.
+	 *
+	 * @param file_sample_count The number of samples of the signal in the
+	 *        file.
+	 * @return false if the file is not open.
+	 */
+	bool resume_signal(shared_ptr<AnalogTimeSignal> signal, uint32_t id,
+		size_t file_sample_count, double last_timestamp);
+	/** Return true if the signal was added or resumed. */
+	bool has_signal(const shared_ptr<AnalogTimeSignal> &signal) const;
+
+	/**
+	 * Write the samples of all signals, that were acquired since the last
+	 * call, and flush the file. This can be called periodically, while
+	 * the signals are acquiring.
+	 *
+	 * @return false if writing failed.
+	 */
+	bool write_new_samples();
+
+	/**
+	 * Write a checkpoint: The new samples of all signals, each followed by
+	 * a state record with its running statistics and, for the signal of a
+	 * math channel, the state of the calculation. The samples are written
+	 * up to the position, that the state belongs to, so a resumed signal
+	 * continues exactly from the state. The file is flushed.
+	 *
+	 * @return false if writing failed.
+	 */
+	bool write_checkpoint();
+
+	/**
+	 * Flush the file and force the operating system to write it to the
+	 * disk (fsync()), so the written samples survive a crash of the system.
+	 *
+	 * @return false if syncing failed.
+	 */
+	bool sync();
+
+	/** Return the number of written samples of all signals. */
+	size_t written_sample_count() const;
+
+private:
+	struct Entry
+	{
+		shared_ptr<AnalogTimeSignal> signal;
+		uint32_t id;
+		/** The position of the next sample, that is written. */
+		size_t next_pos;
+		/** The number of samples of the signal in the file. */
+		size_t file_sample_count;
+		/** Samples up to this timestamp are already in the file. */
+		double written_timestamp;
+	};
+
+	/** Write the samples of the entry up to the position end_pos. */
+	bool write_samples(Entry &entry, size_t end_pos);
+	bool write_state(const Entry &entry,
+		const RunningStatisticsState &statistics,
+		const vector<double> &channel_state);
+	bool write(const char *data, size_t size);
+	bool write_record(uint32_t type, const string &payload);
+	bool write_chunk(Entry &entry, const double *timestamps,
+		const double *values, size_t count);
+
+	std::FILE *file_;
+	bool compressed_;
+	vector<Entry> entries_;
+	uint32_t next_id_;
+	size_t written_sample_count_;
+
+};
+
+/**
+ * Reads a capture file, see capturefile. The file is mapped into memory,
+ * so opening a file only reads the record headers for the index. The
+ * samples are read on demand, chunk by chunk. Uncompressed chunks can be
+ * used directly from the mapping, see is_mapped().
+ */
+class CaptureReader
+{
+public:
+	CaptureReader();
+	~CaptureReader();
+
+	CaptureReader(const CaptureReader &) = delete;
+	CaptureReader &operator=(const CaptureReader &) = delete;
+
+	/**
+	 * Map the file and index the signals and chunks.
+	 *
+	 * @return false if the file is not a valid capture file.
+	 */
+	bool open(const string &file_name);
+	void close();
+
+	const vector<CaptureSignalInfo> &signal_infos() const;
+	/** Return the chunks of all signals in the order of the file. */
+	const vector<CaptureChunkInfo> &chunk_infos() const;
+	/**
+	 * Return the last checkpoint state of the signal, nullptr if the signal
+	 * has no state record.
+	 */
+	const CaptureSignalState *signal_state(size_t signal) const;
+	/**
+	 * Return the size of the file up to the end of the last complete
+	 * record. An incomplete record behind it (e.g. after a crash) must be
+	 * cut off, before records are appended.
+	 */
+	size_t valid_size() const;
+	/** Return the id for the next signal, that is appended to the file. */
+	uint32_t next_signal_id() const;
+
+	/**
+	 * Read the samples of a chunk.
+	 *
+	 * @return false if the samples couldn't be decompressed.
+	 */
+	bool read_chunk(size_t chunk,
+		vector<double> &timestamps, vector<double> &values) const;
+
+	/**
+	 * Return true if the samples of the chunk are uncompressed and aligned,
+	 * so they can be used directly from the mapped file.
+	 */
+	bool is_mapped(size_t chunk) const;
+	/**
+	 * Return the timestamps/values of a chunk in the mapped file or nullptr
+	 * if the chunk is not mapped, see is_mapped(). The pointers are valid
+	 * until the reader is closed.
+	 */
+	const double *mapped_timestamps(size_t chunk) const;
+	const double *mapped_values(size_t chunk) const;
+
+	/**
+	 * Push all samples of the signal to the given signal, chunk by chunk.
+	 *
+	 * If owner is set, it must keep this reader open (e.g. a shared_ptr to
+	 * the reader). The mapped chunks are then referenced by the signal
+	 * instead of copied, see AnalogTimeSignal::push_samples().
+	 *
+	 * Only the samples in the range [first, last) of the signal are pushed,
+	 * e.g. the samples up to the checkpoint state.
+	 *
+	 * @return false if a chunk couldn't be read.
+	 */
+	bool push_samples(size_t signal, shared_ptr<AnalogTimeSignal> dest,
+		shared_ptr<const void> owner = nullptr, size_t first = 0,
+		size_t last = std::numeric_limits<size_t>::max()) const;
+
+private:
+	bool parse_signal(const unsigned char *data, size_t size);
+	bool parse_chunk(const unsigned char *data, size_t size, size_t offset);
+	bool parse_state(const unsigned char *data, size_t size);
+
+	unique_ptr<QFile> file_;
+	const unsigned char *data_;
+	size_t size_;
+	vector<CaptureSignalInfo> signal_infos_;
+	vector<CaptureChunkInfo> chunk_infos_;
+	/** The states by signal index, sample_count is npos without a state. */
+	vector<CaptureSignalState> signal_states_;
+	size_t valid_size_;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_CAPTUREFILE_HPP
@@ -0,0 +1,220 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <QDebug>
+#include <QString>
+
+#include "capturerecorder.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/capturefile.hpp"
+
+using std::lock_guard;
+using std::shared_ptr;
+using std::string;
+using std::unique_lock;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+const double CaptureRecorder::default_write_interval_ = 1.;
+const double CaptureRecorder::default_sync_interval_ = 10.;
+const double CaptureRecorder::min_write_interval_ = .01;
+
+CaptureRecorder::CaptureRecorder() :
+	write_interval_(default_write_interval_),
+	sync_policy_(CaptureSyncPolicy::Periodic),
+	sync_interval_(default_sync_interval_),
+	stop_(false),
+	running_(false),
+	error_(false),
+	written_sample_count_(0)
+{
+}
+
+CaptureRecorder::~CaptureRecorder()
+{
+	stop();
+}
+
+void CaptureRecorder::set_write_interval(double write_interval)
+{
+	// Don't spin without a write interval
+	write_interval_ = std::max(write_interval, min_write_interval_);
+}
+
+double CaptureRecorder::write_interval() const
+{
+	return write_interval_;
+}
+
+void CaptureRecorder::set_sync_policy(CaptureSyncPolicy sync_policy,
+	double sync_interval)
+{
+	lock_guard<std::mutex> lock(mutex_);
+	sync_policy_ = sync_policy;
+	sync_interval_ = sync_interval > 0. ? sync_interval : 0.;
+}
+
+CaptureSyncPolicy CaptureRecorder::sync_policy() const
+{
+	lock_guard<std::mutex> lock(mutex_);
+	return sync_policy_;
+}
+
+double CaptureRecorder::sync_interval() const
+{
+	lock_guard<std::mutex> lock(mutex_);
+	return sync_interval_;
+}
+
+bool CaptureRecorder::start(const string &file_name,
+	const vector<shared_ptr<AnalogTimeSignal>> &signals, bool compressed)
+{
+	stop();
+
+	error_ = false;
+	written_sample_count_ = 0;
+	if (!writer_.open(file_name, compressed))
+		return false;
+	for (const auto &signal : signals) {
+		if (!writer_.add_signal(signal)) {
+			qWarning() << "CaptureRecorder::start(): Writing the signals to" <<
+				QString::fromStdString(file_name) << "failed";
+			writer_.close();
+			return false;
+		}
+	}
+
+	// The samples are written from now on, so only the last write interval
+	// has to be retained
+	signals_ = signals;
+	for (const auto &signal : signals_) {
+		signal->add_observer();
+		signal->set_observer_history(this, write_interval_);
+	}
+
+	last_sync_ = std::chrono::steady_clock::now();
+	stop_ = false;
+	running_ = true;
+	thread_ = std::thread(&CaptureRecorder::thread_proc, this);
+	return true;
+}
+
+void CaptureRecorder::stop()
+{
+	if (!thread_.joinable())
+		return;
+
+	{
+		lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+	}
+	stop_cond_.notify_one();
+	thread_.join();
+	running_ = false;
+
+	for (const auto &signal : signals_) {
+		signal->clear_observer_history(this);
+		signal->remove_observer();
+	}
+	signals_.clear();
+}
+
+bool CaptureRecorder::is_running() const
+{
+	return running_;
+}
+
+bool CaptureRecorder::has_error() const
+{
+	return error_;
+}
+
+size_t CaptureRecorder::written_sample_count() const
+{
+	return written_sample_count_;
+}
+
+void CaptureRecorder::thread_proc()
+{
+	const auto write_interval = std::chrono::duration_cast<
+		std::chrono::steady_clock::duration>(
+			std::chrono::duration<double>(write_interval_));
+
+	bool stopping = false;
+	while (!stopping) {
+		{
+			unique_lock<std::mutex> lock(mutex_);
+			stop_cond_.wait_for(lock, write_interval, [this]() {
+				return stop_.load();
+			});
+			stopping = stop_;
+		}
+
+		if (!writer_.write_new_samples() || !sync(stopping)) {
+			qWarning() << "CaptureRecorder: Writing the capture file failed";
+			error_ = true;
+			break;
+		}
+		written_sample_count_ = writer_.written_sample_count();
+	}
+
+	writer_.close();
+	running_ = false;
+}
+
+bool CaptureRecorder::sync(bool force)
+{
+	CaptureSyncPolicy sync_policy;
+	double sync_interval;
+	{
+		lock_guard<std::mutex> lock(mutex_);
+		sync_policy = sync_policy_;
+		sync_interval = sync_interval_;
+	}
+
+	const auto now = std::chrono::steady_clock::now();
+	switch (sync_policy) {
+	case CaptureSyncPolicy::EveryWrite:
+		break;
+	case CaptureSyncPolicy::Periodic:
+		if (!force && std::chrono::duration<double>(
+				now - last_sync_).count() < sync_interval)
+			return true;
+		break;
+	case CaptureSyncPolicy::Never:
+	default:
+		return true;
+	}
+
+	last_sync_ = now;
+	return writer_.sync();
+}
+
+} // namespace data
+} // namespace sv
@@ -0,0 +1,147 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_CAPTURERECORDER_HPP
+#define DATA_CAPTURERECORDER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "src/data/capturefile.hpp"
+
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+class AnalogTimeSignal;
+
+/**
+ * When the recorder forces the written samples to the disk, see
+ * CaptureWriter::sync().
+ */
+enum class CaptureSyncPolicy {
+	/** Leave it to the operating system. */
+	Never,
+	/** After every write. */
+	EveryWrite,
+	/** At most every sync interval. */
+	Periodic
+};
+
+/**
+ * Records signals to a capture file, while they are acquiring.
+ *
+ * A background thread appends the new samples of the signals every write
+ * interval, so the samples are on the disk with a bounded latency and a
+ * crash loses at most the samples of one interval. The samples are read
+ * from snapshots of the signals, the acquisition only waits for the
+ * moment, a snapshot is taken. With CaptureSyncPolicy::EveryWrite or
+ * Periodic, the file is also synced, so the samples survive a crash of the
+ * system.
+ *
+ * When the recording is stopped, the remaining samples are written.
+ *
+ * While recording, the recorder observes the signals and only needs the
+ * samples of the last write interval, see BaseSignal::set_observer_history().
+ */
+class CaptureRecorder
+{
+public:
+	CaptureRecorder();
+	/** Stops the recording. */
+	~CaptureRecorder();
+
+	CaptureRecorder(const CaptureRecorder &) = delete;
+	CaptureRecorder &operator=(const CaptureRecorder &) = delete;
+
+	/**
+	 * Set the write interval in seconds, the default is 1 s. This is used
+	 * by the next start().
+	 */
+	void set_write_interval(double write_interval);
+	double write_interval() const;
+	/**
+	 * Set the sync policy, the default is CaptureSyncPolicy::Periodic with
+	 * a sync interval of 10 s. This can be changed while recording.
+	 */
+	void set_sync_policy(CaptureSyncPolicy sync_policy,
+		double sync_interval = 10.);
+	CaptureSyncPolicy sync_policy() const;
+	double sync_interval() const;
+
+	/**
+	 * Create the capture file and start recording the signals. A running
+	 * recording is stopped.
+	 *
+	 * @return false if the file couldn't be created.
+	 */
+	bool start(const string &file_name,
+		const vector<shared_ptr<AnalogTimeSignal>> &signals,
+		bool compressed = false);
+	/** Write the remaining samples and close the file. */
+	void stop();
+	bool is_running() const;
+
+	/** Return true if writing the file failed, the recording is stopped. */
+	bool has_error() const;
+	/** Return the number of written samples of all signals. */
+	size_t written_sample_count() const;
+
+private:
+	void thread_proc();
+	/** Sync the file depending on the policy. */
+	bool sync(bool force);
+
+	static const double default_write_interval_;
+	static const double default_sync_interval_;
+	static const double min_write_interval_;
+
+	CaptureWriter writer_;
+	/** The observed signals while recording. */
+	vector<shared_ptr<AnalogTimeSignal>> signals_;
+	double write_interval_;
+	CaptureSyncPolicy sync_policy_;
+	double sync_interval_;
+	std::chrono::steady_clock::time_point last_sync_;
+
+	std::thread thread_;
+	/** Guards stop_ for the condition and the sync policy. */
+	mutable std::mutex mutex_;
+	std::condition_variable stop_cond_;
+	std::atomic<bool> stop_;
+	std::atomic<bool> running_;
+	std::atomic<bool> error_;
+	std::atomic<size_t> written_sample_count_;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_CAPTURERECORDER_HPP
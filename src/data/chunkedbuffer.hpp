@@ -0,0 +1,663 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_CHUNKEDBUFFER_HPP
+#define DATA_CHUNKEDBUFFER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "src/allocationcounter.hpp"
+#include "src/data/chunkreleaser.hpp"
+#include "src/data/spillfile.hpp"
+
+using std::deque;
+using std::make_pair;
+using std::pair;
+using std::shared_ptr;
+using std::unique_ptr;
+
+namespace sv {
+namespace data {
+
+/**
+ * An append-only buffer, that stores its elements in fixed size chunks.
+ *
+ * Appending never moves already stored elements, so there are no
+ * reallocation stalls for big buffers. Elements are addressed by their
+ * absolute position, which stays stable when the oldest elements are
+ * dropped with drop_front(). Completely dropped chunks are released, so the
+ * buffer can also be used as ring buffer.
+ *
+ * Concurrency: There must only be one writer at a time (push_back(),
+ * drop_front() and clear() must be serialized by the caller), but any number
+ * of readers may access the buffer concurrently without locking. A new
+ * element is published by a release store of end_pos(), so a reader that
+ * has seen a position below end_pos() (acquire) will read the complete
+ * element. Every read of the elements counts as active reader, while it
+ * is running, and re-checks its position against begin_pos() and
+ * end_pos(). Dropped chunks are only freed or reused, when the writer sees
+ * no active reader after retiring them, so a reader racing with
+ * drop_front() or clear() never touches freed memory, no matter how long
+ * it stalls. The reader still must validate its read afterwards by
+ * checking begin_pos() and generation() again (see is_valid_read()). When
+ * many chunks are freed at once, e.g. after a clear() of a big buffer,
+ * they are freed in the background by the ChunkReleaser, so the writer
+ * isn't stalled by it. Replaced chunk tables are kept until the buffer is
+ * destroyed, they are small (one pointer per chunk) and a stalled reader
+ * may still hold one.
+ *
+ * Optionally, new chunks are allocated in a memory mapped SpillFile instead
+ * of the heap. Sealed (full) chunks are then written back to the file by
+ * the operating system and paged in again on demand.
+ */
+template<typename T>
+class ChunkedBuffer
+{
+	static_assert(std::is_trivially_copyable<T>::value,
+		"ChunkedBuffer only supports trivially copyable types");
+
+	/**
+	 * A ring of chunk pointers, indexed by the absolute chunk number modulo
+	 * the capacity. It is replaced by a bigger table, when it is full.
+	 */
+	struct ChunkTable
+	{
+		explicit ChunkTable(size_t cap) :
+			capacity(cap),
+			mask(cap - 1),
+			chunks(new T *[cap]())
+		{
+		}
+
+		const size_t capacity;
+		const size_t mask;
+		unique_ptr<T *[]> chunks;
+	};
+
+	/** Frees a heap chunk, that was counted as signal storage. */
+	struct HeapDeleter
+	{
+		size_t bytes;
+
+		void operator()(T *ptr) const
+		{
+			AllocationCounter::deallocate(AllocationDomain::Storage, ptr, bytes);
+		}
+	};
+
+	/** A live or released chunk, only accessed by the writer. */
+	struct Chunk
+	{
+		unique_ptr<T[], HeapDeleter> heap;
+		/** The chunk in spill_file or external, nullptr for a heap chunk. */
+		T *mapped;
+		shared_ptr<SpillFile> spill_file;
+		/** Keeps the memory of an external chunk alive. */
+		shared_ptr<const void> external;
+
+		T *data() const { return mapped ? mapped : heap.get(); }
+	};
+
+public:
+	/**
+	 * @param chunk_size_exp The size of a chunk as exponent of 2. The
+	 *        default of 2^13 elements are 64 KiB for doubles.
+	 */
+	explicit ChunkedBuffer(unsigned int chunk_size_exp = 13) :
+		chunk_size_exp_(chunk_size_exp),
+		chunk_size_((size_t)1 << chunk_size_exp),
+		chunk_mask_(((size_t)1 << chunk_size_exp) - 1),
+		first_chunk_(0),
+		begin_pos_(0),
+		end_pos_(0),
+		generation_(0),
+		memory_size_(0),
+		spilled_size_(0),
+		holds_(0),
+		readers_(0)
+	{
+		table_.store(new ChunkTable(initial_table_capacity_));
+	}
+
+	~ChunkedBuffer()
+	{
+		for (auto &chunk : chunks_)
+			release_chunk(chunk);
+		for (auto &retired : retired_chunks_)
+			release_chunk(retired);
+		delete table_.load();
+	}
+
+	ChunkedBuffer(const ChunkedBuffer &) = delete;
+	ChunkedBuffer &operator=(const ChunkedBuffer &) = delete;
+
+	/** Return the absolute position of the first (oldest) element. */
+	size_t begin_pos() const
+	{
+		return begin_pos_.load(std::memory_order_acquire);
+	}
+
+	/** Return the absolute position behind the last (newest) element. */
+	size_t end_pos() const
+	{
+		return end_pos_.load(std::memory_order_acquire);
+	}
+
+	/** Return the number of stored elements. */
+	size_t size() const
+	{
+		const size_t end = end_pos();
+		const size_t begin = begin_pos();
+		return end > begin ? end - begin : 0;
+	}
+
+	bool empty() const { return size() == 0; }
+	size_t chunk_size() const { return chunk_size_; }
+
+	/**
+	 * Return the generation of the buffer. The generation is odd while the
+	 * buffer is being cleared and is incremented with every clear().
+	 */
+	unsigned int generation() const
+	{
+		return generation_.load(std::memory_order_acquire);
+	}
+
+	/**
+	 * Check if a lock-free read of the position pos, that was started at the
+	 * given generation, was not disturbed by drop_front() or clear().
+	 */
+	bool is_valid_read(size_t pos, unsigned int generation) const
+	{
+		std::atomic_thread_fence(std::memory_order_acquire);
+		return (generation & 1) == 0 && pos >= begin_pos() &&
+			generation_.load(std::memory_order_relaxed) == generation;
+	}
+
+	/**
+	 * Return the element at the absolute position pos. Throws
+	 * std::out_of_range if pos is not in [begin_pos(), end_pos()).
+	 */
+	T at(size_t pos) const
+	{
+		const unsigned int gen = generation();
+		if (pos < begin_pos() || pos >= end_pos())
+			throw std::out_of_range("ChunkedBuffer::at()");
+		T value = (*this)[pos];
+		if (!is_valid_read(pos, gen))
+			throw std::out_of_range("ChunkedBuffer::at()");
+		return value;
+	}
+
+	/**
+	 * Access to the element at the absolute position pos. The position
+	 * must have been checked against begin_pos() and end_pos(). When the
+	 * element has been dropped or cleared meanwhile, T() is returned and
+	 * the read isn't valid anymore, see is_valid_read().
+	 */
+	T operator[](size_t pos) const
+	{
+		ReadSection section(*this);
+		if (!is_readable(pos, 1))
+			return T();
+		return element(pos);
+	}
+
+	/**
+	 * Copy count elements, starting at the absolute position pos, to dest.
+	 * The elements are converted to U and copied chunk wise. The range must
+	 * have been checked against begin_pos() and end_pos(). When the range
+	 * has been dropped or cleared meanwhile, dest is left unchanged and the
+	 * read isn't valid anymore, see is_valid_read().
+	 */
+	template<typename U>
+	void copy(size_t pos, size_t count, U *dest) const
+	{
+		ReadSection section(*this);
+		if (!is_readable(pos, count))
+			return;
+		const ChunkTable *table = table_.load(std::memory_order_acquire);
+		while (count > 0) {
+			const size_t offset = pos & chunk_mask_;
+			const size_t n = std::min(count, chunk_size_ - offset);
+			const T *src =
+				table->chunks[(pos >> chunk_size_exp_) & table->mask] + offset;
+			copy_elements(src, n, dest);
+			dest += n;
+			pos += n;
+			count -= n;
+		}
+	}
+
+	/**
+	 * Return a pointer to the elements in place, starting at the absolute
+	 * position pos. count is reduced to the number of elements, that follow
+	 * pos in the same chunk. The range must have been checked against
+	 * begin_pos() and end_pos() and the read must be validated with
+	 * is_valid_read() afterwards. The access through the pointer isn't
+	 * counted as active reader, so the pointer stays valid only as long as
+	 * the chunk isn't released, see hold().
+	 */
+	const T *span(size_t pos, size_t &count) const
+	{
+		const ChunkTable *table = table_.load(std::memory_order_acquire);
+		const size_t offset = pos & chunk_mask_;
+		count = std::min(count, chunk_size_ - offset);
+		return table->chunks[(pos >> chunk_size_exp_) & table->mask] + offset;
+	}
+
+	/**
+	 * Don't free or reuse any released chunk until release_hold() is
+	 * called, so pointers returned by span() stay valid, even when the
+	 * elements are dropped or cleared meanwhile. Holds are counted. hold()
+	 * must be serialized with the writer, release_hold() may be called
+	 * from any thread.
+	 */
+	void hold() const
+	{
+		holds_.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void release_hold() const
+	{
+		holds_.fetch_sub(1, std::memory_order_release);
+	}
+
+	T front() const { return (*this)[begin_pos()]; }
+	T back() const { return (*this)[end_pos() - 1]; }
+
+	void push_back(const T &value)
+	{
+		const size_t end = end_pos_.load(std::memory_order_relaxed);
+		if ((end & chunk_mask_) == 0)
+			add_chunk(end >> chunk_size_exp_);
+		ChunkTable *table = table_.load(std::memory_order_relaxed);
+		table->chunks[(end >> chunk_size_exp_) & table->mask]
+			[end & chunk_mask_] = value;
+		end_pos_.store(end + 1, std::memory_order_release);
+	}
+
+	/**
+	 * Append count elements from data. The elements are copied chunk wise.
+	 */
+	void push_back(const T *data, size_t count)
+	{
+		size_t end = end_pos_.load(std::memory_order_relaxed);
+		while (count > 0) {
+			if ((end & chunk_mask_) == 0)
+				add_chunk(end >> chunk_size_exp_);
+			const size_t offset = end & chunk_mask_;
+			const size_t n = std::min(count, chunk_size_ - offset);
+			ChunkTable *table = table_.load(std::memory_order_relaxed);
+			std::memcpy(
+				table->chunks[(end >> chunk_size_exp_) & table->mask] + offset,
+				data, n * sizeof(T));
+			data += n;
+			count -= n;
+			end += n;
+			end_pos_.store(end, std::memory_order_release);
+		}
+	}
+
+	/**
+	 * Return true if push_back_external() is possible, i.e. the next
+	 * element starts a new chunk.
+	 */
+	bool can_push_back_external() const
+	{
+		return (end_pos_.load(std::memory_order_relaxed) & chunk_mask_) == 0;
+	}
+
+	/**
+	 * Append a full chunk of chunk_size() elements, that are stored outside
+	 * of the buffer (e.g. in a memory mapped file), without copying them.
+	 * The external elements are never written. owner keeps the memory
+	 * alive, until the chunk is released.
+	 *
+	 * @return false if the next element doesn't start a new chunk.
+	 */
+	bool push_back_external(const T *data, shared_ptr<const void> owner)
+	{
+		if (!data || !owner || !can_push_back_external())
+			return false;
+
+		const size_t end = end_pos_.load(std::memory_order_relaxed);
+		add_chunk(end >> chunk_size_exp_, data, owner);
+		end_pos_.store(end + chunk_size_, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * Drop the count oldest elements. Chunks, that are not used anymore,
+	 * are released. The positions of the remaining elements don't change.
+	 */
+	void drop_front(size_t count)
+	{
+		const size_t end = end_pos_.load(std::memory_order_relaxed);
+		const size_t begin = std::min(
+			begin_pos_.load(std::memory_order_relaxed) + count, end);
+		begin_pos_.store(begin, std::memory_order_release);
+
+		const size_t begin_chunk = begin >> chunk_size_exp_;
+		while (first_chunk_ < begin_chunk && !chunks_.empty()) {
+			retire_chunk(std::move(chunks_.front()));
+			chunks_.pop_front();
+			++first_chunk_;
+		}
+	}
+
+	/**
+	 * Remove all elements. The absolute positions will start at 0 again.
+	 */
+	void clear()
+	{
+		generation_.fetch_add(1, std::memory_order_acq_rel);
+		begin_pos_.store(0, std::memory_order_release);
+		end_pos_.store(0, std::memory_order_release);
+		while (!chunks_.empty()) {
+			retire_chunk(std::move(chunks_.front()));
+			chunks_.pop_front();
+		}
+		first_chunk_ = 0;
+		generation_.fetch_add(1, std::memory_order_release);
+	}
+
+	/**
+	 * Allocate all following chunks in the given spill file. nullptr
+	 * switches back to heap chunks, already allocated chunks stay where they
+	 * are. Must be serialized with the other writer functions.
+	 */
+	void set_spill_file(shared_ptr<SpillFile> spill_file)
+	{
+		spill_file_ = spill_file;
+	}
+
+	/** Return the number of bytes of the live chunks on the heap. */
+	size_t memory_size() const
+	{
+		return memory_size_.load(std::memory_order_relaxed);
+	}
+
+	/** Return the number of bytes of the live chunks in the spill file. */
+	size_t spilled_size() const
+	{
+		return spilled_size_.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * Return the absolute position of the first element in [first, last)
+	 * that is not less than value. The elements must be sorted ascending.
+	 * Returns last if all elements are less than value.
+	 */
+	size_t lower_bound(const T &value, size_t first, size_t last) const
+	{
+		size_t count = last > first ? last - first : 0;
+		ReadSection section(*this);
+		if (!is_readable(first, count))
+			return last;
+		while (count > 0) {
+			const size_t step = count >> 1;
+			const size_t mid = first + step;
+			if (element(mid) < value) {
+				first = mid + 1;
+				count -= step + 1;
+			}
+			else {
+				count = step;
+			}
+		}
+		return first;
+	}
+
+	size_t lower_bound(const T &value) const
+	{
+		return lower_bound(value, begin_pos(), end_pos());
+	}
+
+private:
+	/**
+	 * Counts a read as active reader, while the section exists. The
+	 * increment is sequentially consistent and pairs with the fence in
+	 * is_quiescent(): Either the writer sees the reader, or the reader sees
+	 * the begin_pos() and end_pos() stored before the chunks were retired.
+	 */
+	class ReadSection
+	{
+	public:
+		explicit ReadSection(const ChunkedBuffer &buffer) :
+			readers_(buffer.readers_)
+		{
+			readers_.fetch_add(1, std::memory_order_seq_cst);
+		}
+
+		~ReadSection()
+		{
+			readers_.fetch_sub(1, std::memory_order_release);
+		}
+
+		ReadSection(const ReadSection &) = delete;
+		ReadSection &operator=(const ReadSection &) = delete;
+
+	private:
+		std::atomic<size_t> &readers_;
+	};
+
+	/**
+	 * Check inside a ReadSection, that [pos, pos + count) wasn't dropped or
+	 * cleared yet, so its chunks can't have been retired before the reader
+	 * was counted.
+	 */
+	bool is_readable(size_t pos, size_t count) const
+	{
+		return pos >= begin_pos_.load(std::memory_order_seq_cst) &&
+			pos + count <= end_pos_.load(std::memory_order_seq_cst);
+	}
+
+	/** Unchecked access, only inside a ReadSection or by the writer. */
+	T element(size_t pos) const
+	{
+		const ChunkTable *table = table_.load(std::memory_order_acquire);
+		return table->chunks[(pos >> chunk_size_exp_) & table->mask]
+			[pos & chunk_mask_];
+	}
+
+	/** Batches of this many chunks are freed by the ChunkReleaser. */
+	static const size_t background_release_count_ = 8;
+	static const size_t initial_table_capacity_ = 16;
+
+	void add_chunk(size_t chunk_no, const T *external = nullptr,
+		shared_ptr<const void> owner = nullptr)
+	{
+		free_retired();
+
+		if (chunks_.empty())
+			first_chunk_ = chunk_no;
+
+		ChunkTable *table = table_.load(std::memory_order_relaxed);
+		if (chunk_no - first_chunk_ >= table->capacity) {
+			// Grow the table and move the live chunks to their new slots
+			ChunkTable *new_table = new ChunkTable(table->capacity * 2);
+			for (size_t i = 0; i < chunks_.size(); ++i) {
+				new_table->chunks[(first_chunk_ + i) & new_table->mask] =
+					chunks_[i].data();
+			}
+			table_.store(new_table, std::memory_order_release);
+			retired_tables_.push_back(unique_ptr<ChunkTable>(table));
+			table = new_table;
+		}
+
+		// Reuse a released chunk if possible, it must be of the right kind
+		Chunk chunk{ nullptr, nullptr, nullptr, nullptr };
+		if (external) {
+			chunk.mapped = const_cast<T *>(external);
+			chunk.external = owner;
+		}
+		else if (!retired_chunks_.empty() && is_quiescent() &&
+				!retired_chunks_.front().external &&
+				retired_chunks_.front().spill_file == spill_file_) {
+			chunk = std::move(retired_chunks_.front());
+			retired_chunks_.pop_front();
+		}
+		else if (spill_file_) {
+			chunk.mapped = static_cast<T *>(
+				spill_file_->allocate(chunk_bytes()));
+			if (chunk.mapped)
+				chunk.spill_file = spill_file_;
+		}
+		// Fall back to the heap, e.g. if the disk is full
+		if (!chunk.data()) {
+			chunk.heap = unique_ptr<T[], HeapDeleter>(
+				static_cast<T *>(AllocationCounter::allocate(
+					AllocationDomain::Storage, chunk_bytes())),
+				HeapDeleter{ chunk_bytes() });
+		}
+		table->chunks[chunk_no & table->mask] = chunk.data();
+		count_chunk(chunk, 1);
+		chunks_.push_back(std::move(chunk));
+	}
+
+	void count_chunk(const Chunk &chunk, int sign)
+	{
+		// External chunks are neither on the heap nor in the spill file
+		if (chunk.external)
+			return;
+		std::atomic<size_t> &size = chunk.mapped ? spilled_size_ : memory_size_;
+		if (sign > 0)
+			size.fetch_add(chunk_bytes(), std::memory_order_relaxed);
+		else
+			size.fetch_sub(chunk_bytes(), std::memory_order_relaxed);
+	}
+
+	size_t chunk_bytes() const { return chunk_size_ * sizeof(T); }
+
+	static void copy_elements(const T *src, size_t count, T *dest)
+	{
+		std::memcpy(dest, src, count * sizeof(T));
+	}
+
+	template<typename U>
+	static void copy_elements(const T *src, size_t count, U *dest)
+	{
+		for (size_t i = 0; i < count; ++i)
+			dest[i] = (U)src[i];
+	}
+
+	void retire_chunk(Chunk chunk)
+	{
+		count_chunk(chunk, -1);
+		retired_chunks_.push_back(std::move(chunk));
+	}
+
+	/**
+	 * Free the retired chunks, if no reader can access them anymore. A
+	 * reader, that is counted later, has already seen the new begin_pos()
+	 * and end_pos() and doesn't access retired chunks. While readers are
+	 * active, the chunks are kept for the next call.
+	 */
+	void free_retired()
+	{
+		if (retired_chunks_.size() < 2 || !is_quiescent())
+			return;
+		// Keep one released chunk for reuse in add_chunk()
+		size_t count = retired_chunks_.size() - 1;
+		if (count < background_release_count_) {
+			for (; count > 0; --count) {
+				release_chunk(retired_chunks_.front());
+				retired_chunks_.pop_front();
+			}
+			return;
+		}
+
+		auto batch = std::make_shared<std::vector<Chunk>>();
+		batch->reserve(count);
+		for (; count > 0; --count) {
+			batch->push_back(std::move(retired_chunks_.front()));
+			retired_chunks_.pop_front();
+		}
+		const size_t bytes = chunk_bytes();
+		ChunkReleaser::release([batch, bytes]() {
+			for (auto &chunk : *batch)
+				release_chunk(chunk, bytes);
+			batch->clear();
+		});
+	}
+
+	/**
+	 * Return true if there is neither a hold() nor an active reader, so
+	 * the chunks retired until now can be freed or reused. Only called by
+	 * the writer.
+	 */
+	bool is_quiescent() const
+	{
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		return holds_.load(std::memory_order_acquire) == 0 &&
+			readers_.load(std::memory_order_acquire) == 0;
+	}
+
+	void release_chunk(Chunk &chunk)
+	{
+		release_chunk(chunk, chunk_bytes());
+	}
+
+	static void release_chunk(Chunk &chunk, size_t bytes)
+	{
+		if (chunk.mapped && chunk.spill_file)
+			chunk.spill_file->release(chunk.mapped, bytes);
+		chunk.mapped = nullptr;
+		chunk.external = nullptr;
+	}
+
+	const unsigned int chunk_size_exp_;
+	const size_t chunk_size_;
+	const size_t chunk_mask_;
+
+	/** The live chunks, only accessed by the writer. */
+	deque<Chunk> chunks_;
+	/** Absolute chunk number of chunks_.front(). */
+	size_t first_chunk_;
+	/** Chunks, that have been dropped or cleared, but not freed yet. */
+	deque<Chunk> retired_chunks_;
+	shared_ptr<SpillFile> spill_file_;
+	deque<unique_ptr<ChunkTable>> retired_tables_;
+
+	std::atomic<ChunkTable *> table_;
+	std::atomic<size_t> begin_pos_;
+	std::atomic<size_t> end_pos_;
+	std::atomic<unsigned int> generation_;
+	std::atomic<size_t> memory_size_;
+	std::atomic<size_t> spilled_size_;
+	/** Number of hold() calls without release_hold(). */
+	mutable std::atomic<size_t> holds_;
+	/** Number of reads in a ReadSection. */
+	mutable std::atomic<size_t> readers_;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_CHUNKEDBUFFER_HPP
@@ -0,0 +1,51 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_CHUNKRELEASER_HPP
+#define DATA_CHUNKRELEASER_HPP
+
+#include <functional>
+
+namespace sv {
+namespace data {
+
+/**
+ * Frees big batches of released chunks of a ChunkedBuffer, e.g. all chunks
+ * of a signal, that was cleared during the acquisition, in the background.
+ * Freeing them (and unmapping their memory) would stall the writer of the
+ * buffer, which is the acquisition most of the time.
+ *
+ * This is the only dependency of ChunkedBuffer on the executors, so the
+ * template header doesn't have to include them.
+ */
+class ChunkReleaser
+{
+public:
+	/**
+	 * Run the task, that frees the chunks, in the compute pool. The task is
+	 * executed directly, after the pools were shut down.
+	 */
+	static void release(std::function<void()> task);
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_CHUNKRELEASER_HPP
@@ -0,0 +1,502 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_COMPACTBUFFER_HPP
+#define DATA_COMPACTBUFFER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+#include "src/data/chunkedbuffer.hpp"
+#include "src/data/spillfile.hpp"
+
+using std::shared_ptr;
+
+namespace sv {
+namespace data {
+
+/**
+ * Mapping of the supported element types to unsigned integer bits for the
+ * block codec of CompactBuffer.
+ *
+ * Floating point values are xor'ed with the first value of a block: slowly
+ * changing values share the sign, the exponent and the upper mantissa bits
+ * and values converted from float have 29 zero bits at the end. Integers
+ * are stored as offset to the smallest value of the block.
+ */
+template<typename T>
+struct CompactTraits;
+
+template<>
+struct CompactTraits<double>
+{
+	static const bool use_xor = true;
+	static uint64_t to_bits(double value)
+	{
+		uint64_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+	static double from_bits(uint64_t bits)
+	{
+		double value;
+		std::memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+};
+
+template<>
+struct CompactTraits<float>
+{
+	static const bool use_xor = true;
+	static uint64_t to_bits(float value)
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+	static float from_bits(uint64_t bits)
+	{
+		const uint32_t bits32 = (uint32_t)bits;
+		float value;
+		std::memcpy(&value, &bits32, sizeof(value));
+		return value;
+	}
+};
+
+template<>
+struct CompactTraits<int32_t>
+{
+	static const bool use_xor = false;
+	// Flip the sign bit, so the order of the values is kept
+	static uint64_t to_bits(int32_t value)
+	{
+		return (uint64_t)((uint32_t)value ^ 0x80000000u);
+	}
+	static int32_t from_bits(uint64_t bits)
+	{
+		return (int32_t)((uint32_t)bits ^ 0x80000000u);
+	}
+};
+
+/**
+ * A ChunkedBuffer, that optionally stores its elements losslessly
+ * compressed.
+ *
+ * New elements are appended to an uncompressed buffer. Every time a block
+ * of 2^block_shift_ elements is complete, it is encoded and removed from the
+ * uncompressed buffer: The elements are converted to codes relative to a
+ * reference value (see CompactTraits), the common trailing zero bits are
+ * removed and the codes are bit packed with the width of the biggest code.
+ * All codes of a block have the same width, so every element can still be
+ * decoded in O(1), which keeps the binary searches and the lock-free
+ * readers working.
+ *
+ * The same concurrency rules as for ChunkedBuffer apply. A reader, that
+ * races with the encoding of a block, notices that the element was removed
+ * from the uncompressed buffer and reads the compressed copy instead.
+ */
+template<typename T>
+class CompactBuffer
+{
+	struct Block
+	{
+		uint64_t reference;
+		/** Position of the first packed word of the block in words_. */
+		size_t first_word;
+		uint8_t width;
+		uint8_t shift;
+	};
+
+public:
+	explicit CompactBuffer(unsigned int chunk_size_exp = 13) :
+		recent_(chunk_size_exp),
+		blocks_(8),
+		compressed_(false),
+		compressed_end_(0),
+		begin_pos_(0),
+		generation_(0)
+	{
+	}
+
+	CompactBuffer(const CompactBuffer &) = delete;
+	CompactBuffer &operator=(const CompactBuffer &) = delete;
+
+	/**
+	 * Enable or disable the compression. This is only possible, while the
+	 * buffer is empty (end_pos() == 0).
+	 *
+	 * @return true if the compression was changed.
+	 */
+	bool set_compressed(bool compressed)
+	{
+		if (compressed == this->compressed())
+			return true;
+		if (end_pos() > 0)
+			return false;
+		compressed_.store(compressed, std::memory_order_release);
+		return true;
+	}
+
+	bool compressed() const
+	{
+		return compressed_.load(std::memory_order_acquire);
+	}
+
+	size_t begin_pos() const
+	{
+		return begin_pos_.load(std::memory_order_acquire);
+	}
+
+	size_t end_pos() const
+	{
+		return recent_.end_pos();
+	}
+
+	size_t size() const
+	{
+		const size_t end = end_pos();
+		const size_t begin = begin_pos();
+		return end > begin ? end - begin : 0;
+	}
+
+	bool empty() const { return size() == 0; }
+
+	unsigned int generation() const
+	{
+		return generation_.load(std::memory_order_acquire);
+	}
+
+	bool is_valid_read(size_t pos, unsigned int generation) const
+	{
+		std::atomic_thread_fence(std::memory_order_acquire);
+		return (generation & 1) == 0 && pos >= begin_pos() &&
+			generation_.load(std::memory_order_relaxed) == generation;
+	}
+
+	/**
+	 * Unchecked access to the element at the absolute position pos. The
+	 * position must have been checked against begin_pos() and end_pos().
+	 */
+	T operator[](size_t pos) const
+	{
+		while (true) {
+			if (pos < compressed_end_.load(std::memory_order_acquire))
+				return decode(pos);
+			const unsigned int generation = recent_.generation();
+			const T value = recent_[pos];
+			if (recent_.is_valid_read(pos, generation))
+				return value;
+			// Dropped by the retention, must be validated by the caller
+			if (pos < begin_pos())
+				return value;
+		}
+	}
+
+	/**
+	 * Return a pointer to the elements in place, see ChunkedBuffer::span().
+	 * Returns nullptr if the buffer is compressed.
+	 */
+	const T *span(size_t pos, size_t &count) const
+	{
+		if (compressed())
+			return nullptr;
+		return recent_.span(pos, count);
+	}
+
+	/** See ChunkedBuffer::hold(). */
+	void hold() const { recent_.hold(); }
+	void release_hold() const { recent_.release_hold(); }
+
+	T front() const { return (*this)[begin_pos()]; }
+	T back() const { return (*this)[end_pos() - 1]; }
+
+	/**
+	 * Copy count elements, starting at the absolute position pos, to dest.
+	 * The range must have been checked against begin_pos() and end_pos().
+	 */
+	template<typename U>
+	void copy(size_t pos, size_t count, U *dest) const
+	{
+		while (count > 0) {
+			const size_t compressed_end =
+				compressed_end_.load(std::memory_order_acquire);
+			size_t n = count;
+			if (pos < compressed_end) {
+				n = std::min(count, compressed_end - pos);
+				for (size_t i = 0; i < n; ++i)
+					dest[i] = (U)decode(pos + i);
+			}
+			else {
+				const unsigned int generation = recent_.generation();
+				recent_.copy(pos, n, dest);
+				if (!recent_.is_valid_read(pos, generation) &&
+						pos >= begin_pos())
+					continue; // Retry, the elements were compressed
+			}
+			dest += n;
+			pos += n;
+			count -= n;
+		}
+	}
+
+	void push_back(const T &value)
+	{
+		recent_.push_back(value);
+		const size_t end = recent_.end_pos();
+		if (compressed_.load(std::memory_order_relaxed) &&
+				(end & block_mask_) == 0)
+			compress_block(end - block_size_);
+	}
+
+	/**
+	 * Append count elements from data. The elements are copied block wise
+	 * into the chunks, see ChunkedBuffer::push_back().
+	 */
+	void push_back(const T *data, size_t count)
+	{
+		const bool compressed = compressed_.load(std::memory_order_relaxed);
+		while (count > 0) {
+			size_t n = count;
+			if (compressed) {
+				const size_t block_left =
+					block_size_ - (recent_.end_pos() & block_mask_);
+				n = std::min(count, block_left);
+			}
+			recent_.push_back(data, n);
+			data += n;
+			count -= n;
+
+			const size_t end = recent_.end_pos();
+			if (compressed && (end & block_mask_) == 0)
+				compress_block(end - block_size_);
+		}
+	}
+
+	size_t chunk_size() const
+	{
+		return recent_.chunk_size();
+	}
+
+	/**
+	 * Return true if push_back_external() is possible. External chunks are
+	 * never compressed.
+	 */
+	bool can_push_back_external() const
+	{
+		return !compressed_.load(std::memory_order_relaxed) &&
+			recent_.can_push_back_external();
+	}
+
+	/**
+	 * Append a full chunk of chunk_size() elements without copying them,
+	 * see ChunkedBuffer::push_back_external().
+	 */
+	bool push_back_external(const T *data, shared_ptr<const void> owner)
+	{
+		if (!can_push_back_external())
+			return false;
+		return recent_.push_back_external(data, owner);
+	}
+
+	void drop_front(size_t count)
+	{
+		const size_t end = end_pos();
+		const size_t begin = std::min(
+			begin_pos_.load(std::memory_order_relaxed) + count, end);
+		begin_pos_.store(begin, std::memory_order_release);
+
+		if (begin > recent_.begin_pos())
+			recent_.drop_front(begin - recent_.begin_pos());
+
+		// Keep the block, that is only partly dropped
+		const size_t begin_block = begin >> block_shift_;
+		if (begin_block > blocks_.begin_pos()) {
+			blocks_.drop_front(begin_block - blocks_.begin_pos());
+			const size_t first_word = blocks_.empty() ?
+				words_.end_pos() : blocks_.front().first_word;
+			if (first_word > words_.begin_pos())
+				words_.drop_front(first_word - words_.begin_pos());
+		}
+	}
+
+	void clear()
+	{
+		generation_.fetch_add(1, std::memory_order_acq_rel);
+		begin_pos_.store(0, std::memory_order_release);
+		compressed_end_.store(0, std::memory_order_release);
+		recent_.clear();
+		blocks_.clear();
+		words_.clear();
+		generation_.fetch_add(1, std::memory_order_release);
+	}
+
+	/**
+	 * Return the absolute position of the first element in [first, last)
+	 * that is not less than value. The elements must be sorted ascending.
+	 */
+	size_t lower_bound(const T &value, size_t first, size_t last) const
+	{
+		size_t count = last > first ? last - first : 0;
+		while (count > 0) {
+			const size_t step = count >> 1;
+			const size_t mid = first + step;
+			if ((*this)[mid] < value) {
+				first = mid + 1;
+				count -= step + 1;
+			}
+			else {
+				count = step;
+			}
+		}
+		return first;
+	}
+
+	/** See ChunkedBuffer::set_spill_file(). */
+	void set_spill_file(shared_ptr<SpillFile> spill_file)
+	{
+		recent_.set_spill_file(spill_file);
+		words_.set_spill_file(spill_file);
+	}
+
+	/** Return the bytes of the buffer on the heap. */
+	size_t memory_size() const
+	{
+		return recent_.memory_size() + blocks_.memory_size() +
+			words_.memory_size();
+	}
+
+	/** Return the bytes of the buffer in the spill file. */
+	size_t spilled_size() const
+	{
+		return recent_.spilled_size() + words_.spilled_size();
+	}
+
+private:
+	/** A block has 256 elements. */
+	static const unsigned int block_shift_ = 8;
+	static const size_t block_size_ = (size_t)1 << block_shift_;
+	static const size_t block_mask_ = block_size_ - 1;
+
+	static unsigned int trailing_zeros(uint64_t bits)
+	{
+		unsigned int count = 0;
+		while (count < 64 && (bits & 1) == 0) {
+			bits >>= 1;
+			++count;
+		}
+		return count;
+	}
+
+	static unsigned int bit_width(uint64_t bits)
+	{
+		unsigned int width = 0;
+		while (bits != 0) {
+			bits >>= 1;
+			++width;
+		}
+		return width;
+	}
+
+	void compress_block(size_t first)
+	{
+		uint64_t codes[block_size_];
+		for (size_t i = 0; i < block_size_; ++i)
+			codes[i] = CompactTraits<T>::to_bits(recent_[first + i]);
+
+		Block block;
+		block.reference = codes[0];
+		if (!CompactTraits<T>::use_xor) {
+			for (size_t i = 1; i < block_size_; ++i)
+				block.reference = std::min(block.reference, codes[i]);
+		}
+		uint64_t all_bits = 0;
+		for (size_t i = 0; i < block_size_; ++i) {
+			if (CompactTraits<T>::use_xor)
+				codes[i] ^= block.reference;
+			else
+				codes[i] -= block.reference;
+			all_bits |= codes[i];
+		}
+		block.shift = (uint8_t)(all_bits ? trailing_zeros(all_bits) : 0);
+		block.width = (uint8_t)bit_width(all_bits >> block.shift);
+		block.first_word = words_.end_pos();
+
+		// Pack the codes, every block starts at a new word
+		uint64_t word = 0;
+		unsigned int word_bits = 0;
+		for (size_t i = 0; i < block_size_ && block.width > 0; ++i) {
+			const uint64_t code = codes[i] >> block.shift;
+			word |= code << word_bits;
+			word_bits += block.width;
+			if (word_bits >= 64) {
+				words_.push_back(word);
+				word_bits -= 64;
+				word = word_bits > 0 ? code >> (block.width - word_bits) : 0;
+			}
+		}
+		if (word_bits > 0)
+			words_.push_back(word);
+		blocks_.push_back(block);
+
+		// Publish the compressed block, then remove it from the recent buffer
+		compressed_end_.store(first + block_size_, std::memory_order_release);
+		if (first + block_size_ > recent_.begin_pos())
+			recent_.drop_front(first + block_size_ - recent_.begin_pos());
+	}
+
+	T decode(size_t pos) const
+	{
+		const Block block = blocks_[pos >> block_shift_];
+		uint64_t code = 0;
+		if (block.width > 0) {
+			const size_t bit = (pos & block_mask_) * block.width;
+			const size_t word_pos = block.first_word + (bit >> 6);
+			const unsigned int offset = (unsigned int)(bit & 63);
+			code = words_[word_pos] >> offset;
+			if (offset + block.width > 64)
+				code |= words_[word_pos + 1] << (64 - offset);
+			if (block.width < 64)
+				code &= ((uint64_t)1 << block.width) - 1;
+			code <<= block.shift;
+		}
+		if (CompactTraits<T>::use_xor)
+			return CompactTraits<T>::from_bits(block.reference ^ code);
+		return CompactTraits<T>::from_bits(block.reference + code);
+	}
+
+	/** The elements, that are not compressed yet. */
+	ChunkedBuffer<T> recent_;
+	ChunkedBuffer<Block> blocks_;
+	ChunkedBuffer<uint64_t> words_;
+	std::atomic<bool> compressed_;
+	/** All elements before this position are compressed. */
+	std::atomic<size_t> compressed_end_;
+	std::atomic<size_t> begin_pos_;
+	std::atomic<unsigned int> generation_;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_COMPACTBUFFER_HPP
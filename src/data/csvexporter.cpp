@@ -0,0 +1,450 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <QDebug>
+
+#include "csvexporter.hpp"
+#include "src/channels/basechannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/analogtimesnapshot.hpp"
+#include "src/data/formatter.hpp"
+#include "src/data/mergedtimeindex.hpp"
+#include "src/data/minmaxpyramid.hpp"
+#include "src/devices/basedevice.hpp"
+
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+const size_t CsvExporter::block_rows_ = 4096;
+const size_t CsvExporter::write_buffer_size_ = 1 << 20;
+
+CsvExporter::CsvExporter(const vector<AnalogTimeSnapshot> &snapshots,
+		const CsvExportOptions &options) :
+	QObject(),
+	snapshots_(snapshots),
+	options_(options),
+	progress_(-1),
+	row_count_(0),
+	cancel_(false),
+	running_(false)
+{
+}
+
+CsvExporter::~CsvExporter()
+{
+	cancel();
+}
+
+bool CsvExporter::start(const QString &file_name)
+{
+	// A finished export must still be joined
+	wait();
+
+	file_name_ = file_name.toStdString();
+	output_file_.open(file_name_);
+	if (!output_file_.is_open()) {
+		qWarning() << "CsvExporter::start(): Could not open file" << file_name;
+		return false;
+	}
+
+	buffer_.clear();
+	buffer_.reserve(write_buffer_size_ + 4096);
+	formatter_ = Formatter();
+	progress_ = -1;
+	row_count_ = 0;
+	write_header();
+
+	cancel_ = false;
+	running_ = true;
+	thread_ = std::thread(&CsvExporter::thread_proc, this);
+	return true;
+}
+
+void CsvExporter::cancel()
+{
+	cancel_ = true;
+	wait();
+}
+
+void CsvExporter::wait()
+{
+	if (thread_.joinable())
+		thread_.join();
+	running_ = false;
+}
+
+bool CsvExporter::is_running() const
+{
+	return running_;
+}
+
+size_t CsvExporter::row_count() const
+{
+	return row_count_;
+}
+
+void CsvExporter::write_header()
+{
+	const string &sep = options_.separator;
+
+	const bool aggregated = options_.aggregate_interval > 0.;
+	const bool combined = options_.combined || aggregated;
+
+	string device_header_line;
+	string chg_name_header_line;
+	string ch_name_header_line;
+	string signal_name_header_line;
+	if (combined) {
+		device_header_line = "Time";
+		chg_name_header_line = "Time";
+		ch_name_header_line = "Time";
+		signal_name_header_line = "Time";
+	}
+
+	string start_sep = combined ? sep : "";
+	for (const auto &snapshot : snapshots_) {
+		const auto signal = snapshot.signal();
+		const string name = signal->name();
+		shared_ptr<sv::channels::BaseChannel> parent_channel =
+			signal->parent_channel();
+
+		string chg_names;
+		string chg_sep;
+		for (const auto &chg_name : parent_channel->channel_group_names()) {
+			chg_names += chg_sep;
+			if (chg_name.empty())
+				chg_names += "\"\"";
+			else
+				chg_names += chg_name;
+			// TODO: Ugly workaround. Implement escaping or quotation characters?
+			chg_sep = sep == "," ? "; " : ", ";
+		}
+
+		const string device_name = parent_channel->parent_device()->name();
+		if (aggregated) {
+			// Mean, min and max columns
+			static const char *const aggregate_names[] = {
+				" mean", " min", " max" };
+			for (const char *aggregate_name : aggregate_names) {
+				device_header_line += start_sep;
+				device_header_line += device_name;
+				chg_name_header_line += start_sep;
+				chg_name_header_line += chg_names;
+				ch_name_header_line += start_sep;
+				ch_name_header_line += parent_channel->name();
+				signal_name_header_line += start_sep;
+				signal_name_header_line += name;
+				signal_name_header_line += aggregate_name;
+			}
+			continue;
+		}
+		if (!options_.combined) {
+			// Time column
+			device_header_line += start_sep;
+			device_header_line += device_name;
+			chg_name_header_line += start_sep;
+			chg_name_header_line += chg_names;
+			ch_name_header_line += start_sep;
+			ch_name_header_line += parent_channel->name();
+			signal_name_header_line += start_sep;
+			signal_name_header_line += "Time ";
+			signal_name_header_line += name;
+			start_sep = sep;
+		}
+
+		// Value column
+		device_header_line += start_sep;
+		device_header_line += device_name;
+		chg_name_header_line += start_sep;
+		chg_name_header_line += chg_names;
+		ch_name_header_line += start_sep;
+		ch_name_header_line += parent_channel->name();
+		signal_name_header_line += start_sep;
+		signal_name_header_line += name;
+		start_sep = sep;
+	}
+
+	buffer_ += device_header_line;
+	buffer_ += '\n';
+	buffer_ += chg_name_header_line;
+	buffer_ += '\n';
+	buffer_ += ch_name_header_line;
+	buffer_ += '\n';
+	buffer_ += signal_name_header_line;
+	buffer_ += '\n';
+}
+
+void CsvExporter::thread_proc()
+{
+	bool success;
+	if (options_.aggregate_interval > 0.)
+		success = export_aggregated();
+	else if (options_.combined)
+		success = export_combined();
+	else
+		success = export_separate();
+	if (success)
+		success = write_buffer(true);
+	output_file_.close();
+
+	if (cancel_) {
+		// Don't leave a truncated file behind
+		std::remove(file_name_.c_str());
+		running_ = false;
+		return;
+	}
+	if (!success) {
+		qWarning() << "CsvExporter: Writing the file" <<
+			QString::fromStdString(file_name_) << "failed";
+	}
+	update_progress(1, 1);
+	running_ = false;
+	Q_EMIT finished(success);
+}
+
+bool CsvExporter::export_separate()
+{
+	const string &sep = options_.separator;
+	const size_t signal_count = snapshots_.size();
+
+	size_t max_sample_count = 0;
+	for (const auto &snapshot : snapshots_)
+		max_sample_count = std::max(max_sample_count, snapshot.size());
+
+	// The samples of a block of rows, block_rows_ per signal
+	vector<double> timestamps(signal_count * block_rows_);
+	vector<double> values(signal_count * block_rows_);
+	vector<size_t> counts(signal_count);
+	for (size_t row = 0; row < max_sample_count; row += block_rows_) {
+		if (cancel_)
+			return false;
+
+		const size_t rows = std::min(block_rows_, max_sample_count - row);
+		for (size_t j = 0; j < signal_count; ++j) {
+			const auto &snapshot = snapshots_[j];
+			counts[j] = row < snapshot.size() ? snapshot.copy_samples(
+				snapshot.first_sample_pos() + row, rows,
+				options_.relative_time, &timestamps[j * block_rows_],
+				&values[j * block_rows_]) : 0;
+		}
+
+		for (size_t i = 0; i < rows; ++i) {
+			for (size_t j = 0; j < signal_count; ++j) {
+				if (j > 0)
+					buffer_ += sep;
+				if (i < counts[j]) {
+					append_time(timestamps[j * block_rows_ + i]);
+					buffer_ += sep;
+					append_value(values[j * block_rows_ + i]);
+				}
+				else {
+					buffer_ += sep;
+				}
+			}
+			buffer_ += '\n';
+			if (!write_buffer(false))
+				return false;
+		}
+
+		row_count_ += rows;
+		update_progress(row + rows, max_sample_count);
+	}
+	return true;
+}
+
+bool CsvExporter::export_combined()
+{
+	const string &sep = options_.separator;
+
+	size_t total_sample_count = 0;
+	for (const auto &snapshot : snapshots_)
+		total_sample_count += snapshot.size();
+	size_t sample_count = 0;
+
+	// Data, merged in blocks of rows. The last row stays in the index, until
+	// the next block is merged, because samples of the next block can
+	// still join it.
+	MergedTimeIndex index(snapshots_, options_.relative_time);
+	index.set_timeframe(options_.combined_timeframe);
+	// The values of a block of rows, block_rows_ per signal
+	const size_t signal_count = snapshots_.size();
+	vector<double> values(signal_count * block_rows_);
+	vector<uint8_t> valid(signal_count * block_rows_);
+	while (true) {
+		if (cancel_)
+			return false;
+
+		const size_t rows = index.flush(block_rows_);
+		const size_t begin = index.begin_pos();
+		const size_t end = rows > 0 ? index.end_pos() - 1 : index.end_pos();
+		for (size_t j = 0; j < signal_count; ++j) {
+			sample_count += index.copy_values(begin, end, j,
+				&values[j * block_rows_], &valid[j * block_rows_]);
+		}
+
+		for (size_t row = begin; row < end; ++row) {
+			append_time(index.timestamp(row));
+
+			const size_t i = row - begin;
+			for (size_t j = 0; j < signal_count; ++j) {
+				buffer_ += sep;
+				if (valid[j * block_rows_ + i])
+					append_value(values[j * block_rows_ + i]);
+			}
+			buffer_ += '\n';
+			if (!write_buffer(false))
+				return false;
+		}
+
+		row_count_ += end - begin;
+		update_progress(sample_count, total_sample_count);
+		index.drop_front(end - begin);
+		if (rows == 0)
+			break;
+	}
+	return true;
+}
+
+bool CsvExporter::export_aggregated()
+{
+	const string &sep = options_.separator;
+	const double interval = options_.aggregate_interval;
+	const size_t signal_count = snapshots_.size();
+
+	// Align the intervals to multiples of their length
+	double first_timestamp = std::numeric_limits<double>::max();
+	double last_timestamp = std::numeric_limits<double>::lowest();
+	for (const auto &snapshot : snapshots_) {
+		double timestamp;
+		double value;
+		if (snapshot.read_sample(snapshot.first_sample_pos(),
+				options_.relative_time, timestamp, value))
+			first_timestamp = std::min(first_timestamp, timestamp);
+		if (snapshot.read_sample(snapshot.sample_count() - 1,
+				options_.relative_time, timestamp, value))
+			last_timestamp = std::max(last_timestamp, timestamp);
+	}
+	if (last_timestamp < first_timestamp)
+		return true;
+	const double start_timestamp =
+		std::floor(first_timestamp / interval) * interval;
+	const size_t bin_count =
+		(size_t)((last_timestamp - start_timestamp) / interval) + 1;
+
+	// The summaries are read from the min/max pyramids of the signals,
+	// block_rows_ intervals per signal at once.
+	vector<vector<AnalogSummary>> summaries(signal_count);
+	for (size_t bin = 0; bin < bin_count; bin += block_rows_) {
+		if (cancel_)
+			return false;
+
+		const size_t rows = std::min(block_rows_, bin_count - bin);
+		for (size_t j = 0; j < signal_count; ++j) {
+			summaries[j] = snapshots_[j].get_interval_summaries(
+				start_timestamp, interval, bin, rows, options_.relative_time);
+		}
+
+		for (size_t i = 0; i < rows; ++i) {
+			// Skip the gaps without any samples
+			bool has_samples = false;
+			for (size_t j = 0; j < signal_count && !has_samples; ++j) {
+				has_samples = i < summaries[j].size() &&
+					summaries[j][i].sample_count > 0;
+			}
+			if (!has_samples)
+				continue;
+
+			append_time(start_timestamp + (double)(bin + i) * interval);
+			for (size_t j = 0; j < signal_count; ++j) {
+				if (i < summaries[j].size() &&
+						summaries[j][i].sample_count > 0) {
+					const auto &summary = summaries[j][i];
+					buffer_ += sep;
+					append_value(summary.mean);
+					buffer_ += sep;
+					append_value(summary.min);
+					buffer_ += sep;
+					append_value(summary.max);
+				}
+				else {
+					buffer_ += sep;
+					buffer_ += sep;
+					buffer_ += sep;
+				}
+			}
+			buffer_ += '\n';
+			++row_count_;
+			if (!write_buffer(false))
+				return false;
+		}
+
+		update_progress(bin + rows, bin_count);
+	}
+	return true;
+}
+
+bool CsvExporter::write_buffer(bool force)
+{
+	if (buffer_.size() < write_buffer_size_ && !force)
+		return true;
+
+	output_file_.write(buffer_.data(), (std::streamsize)buffer_.size());
+	buffer_.clear();
+	return output_file_.good();
+}
+
+void CsvExporter::update_progress(size_t done, size_t total)
+{
+	const int progress = total > 0 ? (int)(done * 100 / total) : 100;
+	if (progress == progress_)
+		return;
+
+	progress_ = progress;
+	Q_EMIT progress_changed(progress);
+}
+
+void CsvExporter::append_time(double timestamp)
+{
+	if (options_.relative_time)
+		Formatter::append_fixed(buffer_, timestamp, 4);
+	else
+		formatter_.append_date_time(buffer_, timestamp);
+}
+
+void CsvExporter::append_value(double value)
+{
+	// Same as QString("%1").arg(value)
+	Formatter::append_general(buffer_, value);
+}
+
+} // namespace data
+} // namespace sv
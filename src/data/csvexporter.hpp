@@ -0,0 +1,149 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_CSVEXPORTER_HPP
+#define DATA_CSVEXPORTER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <QObject>
+#include <QString>
+
+#include "src/data/analogtimesnapshot.hpp"
+#include "src/data/formatter.hpp"
+
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+/**
+ * Options for the CSV export of signals.
+ */
+struct CsvExportOptions
+{
+	string separator;
+	/** Export the timestamps relative to the session start or as dates. */
+	bool relative_time;
+	/** Merge the timestamps of all signals in one time column. */
+	bool combined;
+	/** The combination time frame in seconds, see MergedTimeIndex. */
+	double combined_timeframe;
+	/**
+	 * Export the mean, min and max of every interval of this length in
+	 * seconds instead of the samples, see
+	 * AnalogTimeSignal::get_interval_summaries(). The intervals are aligned
+	 * to multiples of the length and share one time column. 0 exports the
+	 * samples.
+	 */
+	double aggregate_interval;
+};
+
+/**
+ * Exports the snapshots of signals to a CSV file in a worker thread.
+ *
+ * The rows are formatted with snprintf() into a large buffer, that is
+ * written to the file at once, so the file isn't flushed for every line.
+ * The samples are read block by block from the snapshots, the signals
+ * can keep acquiring while the export is running.
+ *
+ * The header lines are created by start(), in the thread of the caller.
+ */
+class CsvExporter : public QObject
+{
+	Q_OBJECT
+
+public:
+	CsvExporter(const vector<AnalogTimeSnapshot> &snapshots,
+		const CsvExportOptions &options);
+	/** Cancels an unfinished export. */
+	~CsvExporter();
+
+	/**
+	 * Start the export to the file.
+	 *
+	 * @return false if the file couldn't be opened.
+	 */
+	bool start(const QString &file_name);
+	/**
+	 * Cancel the export and remove the unfinished file. Returns when the
+	 * worker thread is finished.
+	 */
+	void cancel();
+	/** Wait until the export is finished. */
+	void wait();
+	bool is_running() const;
+	/** Return the number of exported rows. */
+	size_t row_count() const;
+
+private:
+	void write_header();
+	void thread_proc();
+	/** Return false when the export was canceled or failed. */
+	bool export_separate();
+	bool export_combined();
+	bool export_aggregated();
+	/** Write the buffer to the file, if it is filled enough or force. */
+	bool write_buffer(bool force);
+	void update_progress(size_t done, size_t total);
+
+	void append_time(double timestamp);
+	void append_value(double value);
+
+	/** The number of rows, that are read and formatted at once. */
+	static const size_t block_rows_;
+	/** The buffer is written to the file, when it reaches this size. */
+	static const size_t write_buffer_size_;
+
+	const vector<AnalogTimeSnapshot> snapshots_;
+	const CsvExportOptions options_;
+	string file_name_;
+	std::ofstream output_file_;
+	string buffer_;
+	/** Caches the date of the last second of the absolute timestamps. */
+	Formatter formatter_;
+	int progress_;
+	std::atomic<size_t> row_count_;
+
+	std::thread thread_;
+	std::atomic<bool> cancel_;
+	std::atomic<bool> running_;
+
+Q_SIGNALS:
+	/** The progress of the export in percent. */
+	void progress_changed(int percent);
+	/**
+	 * The export is finished. Not emitted, when the export is canceled.
+	 *
+	 * @param success false if writing the file failed.
+	 */
+	void finished(bool success);
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_CSVEXPORTER_HPP
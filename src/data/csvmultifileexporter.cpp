@@ -0,0 +1,255 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+
+#include "csvmultifileexporter.hpp"
+#include "src/channels/basechannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/analogtimesnapshot.hpp"
+#include "src/data/csvexporter.hpp"
+#include "src/devices/basedevice.hpp"
+
+using std::lock_guard;
+using std::mutex;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+CsvMultiFileExporter::CsvMultiFileExporter(
+		const vector<AnalogTimeSnapshot> &snapshots,
+		const CsvExportOptions &options) :
+	QObject(),
+	snapshots_(snapshots),
+	next_export_(0),
+	total_progress_(-1),
+	finished_count_(0),
+	success_(true),
+	cancel_(false)
+{
+	for (size_t i = 0; i < snapshots_.size(); ++i) {
+		exporters_.emplace_back(new CsvExporter({ snapshots_[i] }, options));
+		CsvExporter *exporter = exporters_.back().get();
+		// The exporters emit their signals in their worker threads
+		connect(exporter, &CsvExporter::progress_changed,
+			this, [this, i](int percent) { on_progress_changed(i, percent); },
+			Qt::DirectConnection);
+		connect(exporter, &CsvExporter::finished,
+			this, [this](bool success) { on_finished(success); },
+			Qt::DirectConnection);
+	}
+	progress_.resize(exporters_.size(), 0);
+}
+
+CsvMultiFileExporter::~CsvMultiFileExporter()
+{
+	cancel();
+}
+
+size_t CsvMultiFileExporter::max_parallel_exports()
+{
+	return std::max<size_t>(2, std::thread::hardware_concurrency());
+}
+
+bool CsvMultiFileExporter::start(const QString &file_name)
+{
+	// A finished export must still be joined
+	wait();
+
+	file_names_.clear();
+	for (size_t i = 0; i < snapshots_.size(); ++i)
+		file_names_.push_back(this->file_name(file_name, i, file_names_));
+
+	cancel_ = false;
+	{
+		lock_guard<mutex> lock(mutex_);
+		next_export_ = 0;
+		std::fill(progress_.begin(), progress_.end(), 0);
+		total_progress_ = -1;
+		finished_count_ = 0;
+		success_ = true;
+	}
+
+	if (exporters_.empty()) {
+		Q_EMIT progress_changed(100);
+		Q_EMIT finished(true);
+		return true;
+	}
+
+	bool success = true;
+	{
+		lock_guard<mutex> lock(mutex_);
+		const size_t count =
+			std::min(exporters_.size(), max_parallel_exports());
+		for (size_t i = 0; i < count && success; ++i)
+			success = start_next();
+	}
+	if (!success)
+		cancel();
+	return success;
+}
+
+void CsvMultiFileExporter::cancel()
+{
+	if (!is_running())
+		return;
+
+	cancel_ = true;
+	{
+		// No further exports are started
+		lock_guard<mutex> lock(mutex_);
+		next_export_ = exporters_.size();
+	}
+	for (const auto &exporter : exporters_)
+		exporter->cancel();
+	remove_files();
+}
+
+void CsvMultiFileExporter::wait()
+{
+	// The next exports are started by the finished exports, i.e. before
+	// the threads of the exports with lower indices are finished.
+	for (const auto &exporter : exporters_)
+		exporter->wait();
+}
+
+bool CsvMultiFileExporter::is_running() const
+{
+	for (const auto &exporter : exporters_) {
+		if (exporter->is_running())
+			return true;
+	}
+	return false;
+}
+
+size_t CsvMultiFileExporter::row_count() const
+{
+	size_t row_count = 0;
+	for (const auto &exporter : exporters_)
+		row_count += exporter->row_count();
+	return row_count;
+}
+
+vector<QString> CsvMultiFileExporter::file_names() const
+{
+	return file_names_;
+}
+
+QString CsvMultiFileExporter::file_name(const QString &file_name,
+	size_t index, const vector<QString> &names) const
+{
+	const QFileInfo file_info(file_name);
+	QString suffix = file_info.suffix();
+	if (suffix.isEmpty())
+		suffix = "csv";
+
+	const auto signal = snapshots_[index].signal();
+	const auto channel = signal->parent_channel();
+	QString part = QString("%1_%2_%3").
+		arg(QString::fromStdString(channel->parent_device()->name())).
+		arg(QString::fromStdString(channel->name())).
+		arg(QString::fromStdString(signal->name()));
+	// Only use characters, that are valid in file names on all systems
+	for (auto &c : part) {
+		if (!c.isLetterOrNumber() && c != '-' && c != '.')
+			c = '_';
+	}
+
+	const QString base =
+		file_info.dir().filePath(file_info.completeBaseName() + "_" + part);
+	QString name = base + "." + suffix;
+	for (int i = 2; std::find(names.begin(), names.end(), name) !=
+			names.end(); ++i) {
+		name = QString("%1_%2.%3").arg(base).arg(i).arg(suffix);
+	}
+	return name;
+}
+
+bool CsvMultiFileExporter::start_next()
+{
+	if (next_export_ >= exporters_.size())
+		return true;
+
+	const size_t index = next_export_++;
+	if (!exporters_[index]->start(file_names_[index])) {
+		qWarning() << "CsvMultiFileExporter: Could not open file" <<
+			file_names_[index];
+		return false;
+	}
+	return true;
+}
+
+void CsvMultiFileExporter::remove_files()
+{
+	for (const auto &name : file_names_)
+		std::remove(name.toStdString().c_str());
+}
+
+void CsvMultiFileExporter::on_progress_changed(size_t index, int percent)
+{
+	int total_progress;
+	{
+		lock_guard<mutex> lock(mutex_);
+		progress_[index] = percent;
+		int sum = 0;
+		for (const int progress : progress_)
+			sum += progress;
+		total_progress = sum / (int)progress_.size();
+		if (total_progress == total_progress_)
+			return;
+		total_progress_ = total_progress;
+	}
+	Q_EMIT progress_changed(total_progress);
+}
+
+void CsvMultiFileExporter::on_finished(bool success)
+{
+	bool all_finished;
+	bool all_success;
+	{
+		lock_guard<mutex> lock(mutex_);
+		success_ = success_ && success;
+		// A file, that can't be opened, fails the whole export
+		while (!cancel_ && !start_next()) {
+			success_ = false;
+			++finished_count_;
+		}
+		++finished_count_;
+		all_finished = finished_count_ == exporters_.size();
+		all_success = success_;
+	}
+	if (all_finished && !cancel_)
+		Q_EMIT finished(all_success);
+}
+
+} // namespace data
+} // namespace sv
@@ -0,0 +1,132 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_CSVMULTIFILEEXPORTER_HPP
+#define DATA_CSVMULTIFILEEXPORTER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <QObject>
+#include <QString>
+
+#include "src/data/analogtimesnapshot.hpp"
+#include "src/data/csvexporter.hpp"
+
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+/**
+ * Exports every snapshot to its own CSV file, see CsvExporter.
+ *
+ * Every file is written by its own CsvExporter, i.e. in its own thread
+ * with its own output buffer, so the export of many signals scales across
+ * cores and disks. At most max_parallel_exports() files are written at
+ * once, the next file is started when a file is finished.
+ *
+ * The files are named like the given file name, with the device, channel
+ * and signal name appended to the base name.
+ *
+ * The interface is the same as the one of CsvExporter.
+ */
+class CsvMultiFileExporter : public QObject
+{
+	Q_OBJECT
+
+public:
+	CsvMultiFileExporter(const vector<AnalogTimeSnapshot> &snapshots,
+		const CsvExportOptions &options);
+	/** Cancels an unfinished export. */
+	~CsvMultiFileExporter();
+
+	/**
+	 * Start the export to the files, that are derived from file_name.
+	 *
+	 * @return false if a file couldn't be opened.
+	 */
+	bool start(const QString &file_name);
+	/**
+	 * Cancel the export and remove all files, also the finished ones.
+	 * Returns when all worker threads are finished.
+	 */
+	void cancel();
+	/** Wait until the export is finished. */
+	void wait();
+	bool is_running() const;
+	/** Return the number of exported rows of all files. */
+	size_t row_count() const;
+	/** Return the names of the files, valid after start(). */
+	vector<QString> file_names() const;
+
+	/** Return the maximum number of files, that are written at once. */
+	static size_t max_parallel_exports();
+
+private:
+	/**
+	 * Return the name of the file for the snapshot, names is used to make
+	 * the names unique.
+	 */
+	QString file_name(const QString &file_name, size_t index,
+		const vector<QString> &names) const;
+	/** Start the next pending export. mutex_ must be locked. */
+	bool start_next();
+	void remove_files();
+	/** Called in the worker thread of the export index. */
+	void on_progress_changed(size_t index, int percent);
+	/** Called in the worker thread of a finished export. */
+	void on_finished(bool success);
+
+	const vector<AnalogTimeSnapshot> snapshots_;
+	vector<unique_ptr<CsvExporter>> exporters_;
+	vector<QString> file_names_;
+
+	/** Guards next_export_, progress_, finished_count_ and success_. */
+	mutable std::mutex mutex_;
+	size_t next_export_;
+	/** The progress of every export in percent. */
+	vector<int> progress_;
+	int total_progress_;
+	size_t finished_count_;
+	bool success_;
+	std::atomic<bool> cancel_;
+
+Q_SIGNALS:
+	/** The progress of all exports in percent. */
+	void progress_changed(int percent);
+	/**
+	 * All exports are finished. Not emitted, when the export is canceled.
+	 *
+	 * @param success false if writing a file failed.
+	 */
+	void finished(bool success);
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_CSVMULTIFILEEXPORTER_HPP
@@ -0,0 +1,464 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <locale>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "csvreader.hpp"
+
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+namespace {
+
+// The powers of 10, that are exactly representable as double
+const double exact_powers_of_10[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12,
+	1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+const int max_exact_power_of_10 = 22;
+// Every integer up to 2^53 is exactly representable as double
+const uint64_t max_exact_mantissa = (uint64_t)1 << 53;
+
+bool is_space(char c)
+{
+	return c == ' ' || c == '\t';
+}
+
+bool is_digit(char c)
+{
+	return c >= '0' && c <= '9';
+}
+
+bool equals_ignore_case(const char *begin, const char *end, const char *str)
+{
+	const size_t size = std::strlen(str);
+	if ((size_t)(end - begin) != size)
+		return false;
+	for (size_t i = 0; i < size; ++i) {
+		char c = begin[i];
+		if (c >= 'A' && c <= 'Z')
+			c = (char)(c - 'A' + 'a');
+		if (c != str[i])
+			return false;
+	}
+	return true;
+}
+
+/** The slow path for numbers, that can't be converted exactly. */
+bool parse_double_stream(const char *begin, const char *end, double &value)
+{
+	std::istringstream stream(string(begin, end));
+	stream.imbue(std::locale::classic());
+	stream >> value;
+	return !stream.fail() && stream.eof();
+}
+
+}
+
+const size_t CsvReader::block_size_ = 1 << 20;
+
+CsvReader::CsvReader(const string &separator) :
+	file_(nullptr),
+	separator_(separator),
+	begin_(0),
+	end_(0),
+	eof_(true),
+	line_number_(0),
+	next_line_number_(1)
+{
+}
+
+CsvReader::~CsvReader()
+{
+	close();
+}
+
+bool CsvReader::open(const string &file_name)
+{
+	close();
+	file_ = std::fopen(file_name.c_str(), "rb");
+	if (!file_)
+		return false;
+
+	buffer_.resize(block_size_);
+	begin_ = 0;
+	end_ = 0;
+	eof_ = false;
+	line_number_ = 0;
+	next_line_number_ = 1;
+	field_begin_.clear();
+	field_size_.clear();
+	return true;
+}
+
+void CsvReader::close()
+{
+	if (file_)
+		std::fclose(file_);
+	file_ = nullptr;
+	eof_ = true;
+}
+
+bool CsvReader::is_open() const
+{
+	return file_ != nullptr;
+}
+
+const string &CsvReader::separator() const
+{
+	return separator_;
+}
+
+bool CsvReader::fill()
+{
+	if (eof_)
+		return false;
+
+	if (begin_ > 0) {
+		std::memmove(buffer_.data(), buffer_.data() + begin_, end_ - begin_);
+		end_ -= begin_;
+		begin_ = 0;
+	}
+	if (buffer_.size() - end_ < block_size_)
+		buffer_.resize(end_ + block_size_);
+
+	const size_t count =
+		std::fread(buffer_.data() + end_, 1, buffer_.size() - end_, file_);
+	end_ += count;
+	if (count == 0)
+		eof_ = true;
+	return count > 0;
+}
+
+bool CsvReader::read_record()
+{
+	field_begin_.clear();
+	field_size_.clear();
+	if (!file_)
+		return false;
+
+	// The scan position and state are relative to begin_, because fill()
+	// moves the data to the front of the buffer.
+	size_t scan = 0;
+	bool quoted = false;
+	size_t line_breaks = 0;
+	while (true) {
+		const char *data = buffer_.data();
+		size_t pos = begin_ + scan;
+		while (pos < end_) {
+			const char c = data[pos];
+			if (c == '"')
+				quoted = !quoted;
+			else if (c == '\n') {
+				if (!quoted)
+					break;
+				++line_breaks;
+			}
+			++pos;
+		}
+
+		if (pos == end_ && !eof_) {
+			scan = pos - begin_;
+			fill();
+			continue;
+		}
+		if (pos == end_ && begin_ == end_)
+			return false;
+
+		const size_t next = pos < end_ ? pos + 1 : end_;
+		size_t record_end = pos;
+		if (record_end > begin_ && data[record_end - 1] == '\r')
+			--record_end;
+
+		line_number_ = next_line_number_;
+		next_line_number_ += line_breaks + 1;
+		const size_t record_begin = begin_;
+		begin_ = next;
+
+		// Skip empty lines
+		if (record_end == record_begin) {
+			scan = 0;
+			quoted = false;
+			line_breaks = 0;
+			continue;
+		}
+
+		if (separator_.empty())
+			detect_separator(record_begin, record_end);
+		split_record(record_begin, record_end);
+		return true;
+	}
+}
+
+void CsvReader::detect_separator(size_t begin, size_t end)
+{
+	size_t commas = 0;
+	size_t semicolons = 0;
+	size_t tabs = 0;
+	bool quoted = false;
+	for (size_t pos = begin; pos < end; ++pos) {
+		const char c = buffer_[pos];
+		if (c == '"')
+			quoted = !quoted;
+		else if (quoted)
+			continue;
+		else if (c == ',')
+			++commas;
+		else if (c == ';')
+			++semicolons;
+		else if (c == '\t')
+			++tabs;
+	}
+
+	if (tabs > 0 && tabs >= commas && tabs >= semicolons)
+		separator_ = "\t";
+	else if (semicolons > commas)
+		separator_ = ";";
+	else
+		separator_ = ",";
+}
+
+void CsvReader::split_record(size_t begin, size_t end)
+{
+	char *data = buffer_.data();
+	const char *separator = separator_.data();
+	const size_t separator_size = separator_.size();
+	auto is_separator = [&](size_t pos) {
+		return data[pos] == separator[0] && pos + separator_size <= end &&
+			(separator_size == 1 ||
+				std::memcmp(data + pos, separator, separator_size) == 0);
+	};
+
+	size_t pos = begin;
+	while (true) {
+		const size_t field_begin = pos;
+		size_t out = pos;
+		if (pos < end && data[pos] == '"') {
+			// Unescape the quoted field in place, it can only get shorter
+			++pos;
+			while (pos < end) {
+				if (data[pos] == '"') {
+					if (pos + 1 < end && data[pos + 1] == '"') {
+						data[out++] = '"';
+						pos += 2;
+						continue;
+					}
+					++pos;
+					break;
+				}
+				data[out++] = data[pos++];
+			}
+			// Text between the closing quote and the separator is kept
+			while (pos < end && !is_separator(pos))
+				data[out++] = data[pos++];
+		}
+		else {
+			while (pos < end && !is_separator(pos))
+				++pos;
+			out = pos;
+		}
+
+		field_begin_.push_back(field_begin);
+		field_size_.push_back(out - field_begin);
+		if (pos >= end)
+			break;
+		pos += separator_size;
+		// A separator at the end of the line is followed by an empty field
+		if (pos == end) {
+			field_begin_.push_back(pos);
+			field_size_.push_back(0);
+			break;
+		}
+	}
+}
+
+size_t CsvReader::line_number() const
+{
+	return line_number_;
+}
+
+size_t CsvReader::field_count() const
+{
+	return field_begin_.size();
+}
+
+const char *CsvReader::field_data(size_t i) const
+{
+	return buffer_.data() + field_begin_[i];
+}
+
+size_t CsvReader::field_size(size_t i) const
+{
+	return field_size_[i];
+}
+
+bool CsvReader::field_empty(size_t i) const
+{
+	return i >= field_size_.size() || field_size_[i] == 0;
+}
+
+string CsvReader::field(size_t i) const
+{
+	if (i >= field_begin_.size())
+		return "";
+	return string(field_data(i), field_size_[i]);
+}
+
+bool CsvReader::field_double(size_t i, double &value) const
+{
+	if (i >= field_begin_.size())
+		return false;
+	const char *begin = field_data(i);
+	return parse_double(begin, begin + field_size_[i], value);
+}
+
+int CsvReader::field_decimal_places(size_t i) const
+{
+	if (i >= field_begin_.size())
+		return 0;
+	const char *begin = field_data(i);
+	const char *end = begin + field_size_[i];
+	const char *point = std::find(begin, end, '.');
+	if (point == end)
+		return 0;
+	const char *digits_end = point + 1;
+	while (digits_end < end && is_digit(*digits_end))
+		++digits_end;
+	return (int)(digits_end - point - 1);
+}
+
+bool CsvReader::parse_double(const char *begin, const char *end,
+	double &value)
+{
+	while (begin < end && is_space(*begin))
+		++begin;
+	while (end > begin && is_space(*(end - 1)))
+		--end;
+	if (begin == end)
+		return false;
+
+	const char *pos = begin;
+	bool negative = false;
+	if (*pos == '+' || *pos == '-') {
+		negative = *pos == '-';
+		++pos;
+	}
+
+	uint64_t mantissa = 0;
+	int significant_digits = 0;
+	int exponent = 0;
+	bool has_digits = false;
+	for (; pos < end && is_digit(*pos); ++pos) {
+		has_digits = true;
+		if (mantissa == 0 && *pos == '0')
+			continue;
+		if (significant_digits < 19) {
+			mantissa = mantissa * 10 + (uint64_t)(*pos - '0');
+			++significant_digits;
+		}
+		else
+			return parse_double_stream(begin, end, value);
+	}
+	if (pos < end && *pos == '.') {
+		for (++pos; pos < end && is_digit(*pos); ++pos) {
+			has_digits = true;
+			if (mantissa == 0 && *pos == '0') {
+				--exponent;
+				continue;
+			}
+			if (significant_digits < 19) {
+				mantissa = mantissa * 10 + (uint64_t)(*pos - '0');
+				++significant_digits;
+				--exponent;
+			}
+			else
+				return parse_double_stream(begin, end, value);
+		}
+	}
+	if (!has_digits) {
+		// Accept the special values, that were written by the exporters
+		const char *special = begin + (begin < end &&
+			(*begin == '+' || *begin == '-') ? 1 : 0);
+		if (equals_ignore_case(special, end, "nan")) {
+			value = std::numeric_limits<double>::quiet_NaN();
+			return true;
+		}
+		if (equals_ignore_case(special, end, "inf") ||
+				equals_ignore_case(special, end, "infinity")) {
+			value = negative ? -std::numeric_limits<double>::infinity() :
+				std::numeric_limits<double>::infinity();
+			return true;
+		}
+		return false;
+	}
+
+	if (pos < end && (*pos == 'e' || *pos == 'E')) {
+		++pos;
+		bool negative_exponent = false;
+		if (pos < end && (*pos == '+' || *pos == '-')) {
+			negative_exponent = *pos == '-';
+			++pos;
+		}
+		if (pos == end || !is_digit(*pos))
+			return false;
+		int e = 0;
+		for (; pos < end && is_digit(*pos); ++pos) {
+			if (e < 100000)
+				e = e * 10 + (*pos - '0');
+		}
+		exponent += negative_exponent ? -e : e;
+	}
+	if (pos != end)
+		return false;
+
+	if (mantissa == 0) {
+		value = negative ? -0. : 0.;
+		return true;
+	}
+	// Both factors and the result of the single multiplication/division
+	// are exact or correctly rounded.
+	if (mantissa <= max_exact_mantissa &&
+			exponent >= -max_exact_power_of_10 &&
+			exponent <= max_exact_power_of_10) {
+		value = (double)mantissa;
+		if (exponent < 0)
+			value /= exact_powers_of_10[-exponent];
+		else
+			value *= exact_powers_of_10[exponent];
+		if (negative)
+			value = -value;
+		return true;
+	}
+	return parse_double_stream(begin, end, value);
+}
+
+} // namespace data
+} // namespace sv
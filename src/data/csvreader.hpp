@@ -0,0 +1,143 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_CSVREADER_HPP
+#define DATA_CSVREADER_HPP
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+/**
+ * A streaming reader for CSV and TSV files.
+ *
+ * The file is read in large blocks into one buffer and the records are
+ * split in place: The fields of the current record point into the buffer
+ * and quoted fields are unescaped there, so reading a record doesn't
+ * allocate. The fields are valid until the next call of read_record().
+ *
+ * Quoted fields may contain separators, line breaks and "" for a quote.
+ * Empty lines are skipped and \r\n line endings are accepted.
+ */
+class CsvReader
+{
+public:
+	/**
+	 * @param[in] separator The field separator. An empty separator is
+	 *            detected from the first record (",", ";" or tab).
+	 */
+	explicit CsvReader(const string &separator = ",");
+	~CsvReader();
+
+	CsvReader(const CsvReader &) = delete;
+	CsvReader &operator=(const CsvReader &) = delete;
+
+	/**
+	 * Open the file for reading.
+	 *
+	 * @return false if the file couldn't be opened.
+	 */
+	bool open(const string &file_name);
+	void close();
+	bool is_open() const;
+
+	/** Return the separator, that is used (or was detected). */
+	const string &separator() const;
+
+	/**
+	 * Read the next record.
+	 *
+	 * @return false at the end of the file.
+	 */
+	bool read_record();
+	/** Return the line number of the first line of the current record. */
+	size_t line_number() const;
+
+	size_t field_count() const;
+	/** Return the (not null terminated) data of a field in the buffer. */
+	const char *field_data(size_t i) const;
+	size_t field_size(size_t i) const;
+	/** Return true if the field is missing or empty. */
+	bool field_empty(size_t i) const;
+	/** Return a copy of the field. */
+	string field(size_t i) const;
+	/**
+	 * Parse the field as a number, see parse_double().
+	 *
+	 * @return false if the field is missing or not a number.
+	 */
+	bool field_double(size_t i, double &value) const;
+	/** Return the number of decimal places of a number field. */
+	int field_decimal_places(size_t i) const;
+
+	/**
+	 * Parse a number with the C locale, independent of the locale of the
+	 * application. Surrounding spaces are ignored.
+	 *
+	 * Numbers with up to 15 significant digits and a small exponent, which
+	 * are nearly all numbers in measurement files, are converted exactly
+	 * without any library call.
+	 *
+	 * @return false if the text is not a number.
+	 */
+	static bool parse_double(const char *begin, const char *end,
+		double &value);
+
+private:
+	/**
+	 * Move the unparsed data to the front of the buffer and read the next
+	 * block behind it. The buffer grows, if a record doesn't fit.
+	 *
+	 * @return false if nothing was read.
+	 */
+	bool fill();
+	/** Detect the separator from the record in [begin, end). */
+	void detect_separator(size_t begin, size_t end);
+	/** Split the record in [begin, end) into the fields. */
+	void split_record(size_t begin, size_t end);
+
+	/** The number of bytes, that are read at once. */
+	static const size_t block_size_;
+
+	std::FILE *file_;
+	string separator_;
+	vector<char> buffer_;
+	/** The begin of the unparsed data in buffer_. */
+	size_t begin_;
+	/** The end of the valid data in buffer_. */
+	size_t end_;
+	bool eof_;
+	size_t line_number_;
+	size_t next_line_number_;
+	vector<size_t> field_begin_;
+	vector<size_t> field_size_;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_CSVREADER_HPP
@@ -17,16 +17,277 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <array>
+#include <cstdint>
 #include <set>
 
 #include "datautil.hpp"
 
+using std::make_pair;
 using std::set;
 
 namespace sv {
 namespace data {
 namespace datautil {
 
+namespace {
+
+/** One entry of a mapping table between a sigrok ID and a SmuView enum. */
+template<typename T>
+struct SrIdEntry
+{
+	uint64_t sr_id;
+	T value;
+};
+
+constexpr SrIdEntry<Quantity> sr_quantity_table[] = {
+	{ SR_MQ_VOLTAGE, Quantity::Voltage },
+	{ SR_MQ_CURRENT, Quantity::Current },
+	{ SR_MQ_RESISTANCE, Quantity::Resistance },
+	{ SR_MQ_CAPACITANCE, Quantity::Capacitance },
+	{ SR_MQ_TEMPERATURE, Quantity::Temperature },
+	{ SR_MQ_FREQUENCY, Quantity::Frequency },
+	{ SR_MQ_DUTY_CYCLE, Quantity::DutyCyle },
+	{ SR_MQ_CONTINUITY, Quantity::Continuity },
+	{ SR_MQ_PULSE_WIDTH, Quantity::PulseWidth },
+	{ SR_MQ_CONDUCTANCE, Quantity::Conductance },
+	{ SR_MQ_POWER, Quantity::Power },
+	{ SR_MQ_GAIN, Quantity::Gain },
+	{ SR_MQ_SOUND_PRESSURE_LEVEL, Quantity::SoundPressureLevel },
+	{ SR_MQ_CARBON_MONOXIDE, Quantity::CarbonMonoxide },
+	{ SR_MQ_RELATIVE_HUMIDITY, Quantity::RelativeHumidity },
+	{ SR_MQ_TIME, Quantity::Time },
+	{ SR_MQ_WIND_SPEED, Quantity::WindSpeed },
+	{ SR_MQ_PRESSURE, Quantity::Pressure },
+	{ SR_MQ_PARALLEL_INDUCTANCE, Quantity::ParallelInductance },
+	{ SR_MQ_PARALLEL_CAPACITANCE, Quantity::ParallelCapacitance },
+	{ SR_MQ_PARALLEL_RESISTANCE, Quantity::ParallelResistance },
+	{ SR_MQ_SERIES_INDUCTANCE, Quantity::SeriesInductance },
+	{ SR_MQ_SERIES_CAPACITANCE, Quantity::SeriesCapacitance },
+	{ SR_MQ_SERIES_RESISTANCE, Quantity::SeriesResistance },
+	{ SR_MQ_DISSIPATION_FACTOR, Quantity::DissipationFactor },
+	{ SR_MQ_QUALITY_FACTOR, Quantity::QualityFactor },
+	{ SR_MQ_PHASE_ANGLE, Quantity::PhaseAngle },
+	{ SR_MQ_DIFFERENCE, Quantity::Difference },
+	{ SR_MQ_COUNT, Quantity::Count },
+	{ SR_MQ_POWER_FACTOR, Quantity::PowerFactor },
+	{ SR_MQ_APPARENT_POWER, Quantity::ApparentPower },
+	{ SR_MQ_MASS, Quantity::Mass },
+	{ SR_MQ_HARMONIC_RATIO, Quantity::HarmonicRatio },
+	{ SR_MQ_ENERGY, Quantity::Energy },
+};
+
+constexpr SrIdEntry<QuantityFlag> sr_quantity_flag_table[] = {
+	{ SR_MQFLAG_AC, QuantityFlag::AC },
+	{ SR_MQFLAG_DC, QuantityFlag::DC },
+	{ SR_MQFLAG_RMS, QuantityFlag::RMS },
+	{ SR_MQFLAG_DIODE, QuantityFlag::Diode },
+	{ SR_MQFLAG_HOLD, QuantityFlag::Hold },
+	{ SR_MQFLAG_MAX, QuantityFlag::Max },
+	{ SR_MQFLAG_MIN, QuantityFlag::Min },
+	{ SR_MQFLAG_AUTORANGE, QuantityFlag::Autorange },
+	{ SR_MQFLAG_RELATIVE, QuantityFlag::Relative },
+	{ SR_MQFLAG_SPL_FREQ_WEIGHT_A, QuantityFlag::SplFreqWeightA },
+	{ SR_MQFLAG_SPL_FREQ_WEIGHT_C, QuantityFlag::SplFreqWeightC },
+	{ SR_MQFLAG_SPL_FREQ_WEIGHT_Z, QuantityFlag::SplFreqWeightZ },
+	{ SR_MQFLAG_SPL_FREQ_WEIGHT_FLAT, QuantityFlag::SplFreqWeightFlat },
+	{ SR_MQFLAG_SPL_TIME_WEIGHT_S, QuantityFlag::SplTimeWeightS },
+	{ SR_MQFLAG_SPL_TIME_WEIGHT_F, QuantityFlag::SplTimeWeightF },
+	{ SR_MQFLAG_SPL_LAT, QuantityFlag::SplLAT },
+	{ SR_MQFLAG_SPL_PCT_OVER_ALARM, QuantityFlag::SplPctOverAlarm },
+	{ SR_MQFLAG_DURATION, QuantityFlag::Duration },
+	{ SR_MQFLAG_AVG, QuantityFlag::Avg },
+	{ SR_MQFLAG_REFERENCE, QuantityFlag::Reference },
+	{ SR_MQFLAG_UNSTABLE, QuantityFlag::Unstable },
+	{ SR_MQFLAG_FOUR_WIRE, QuantityFlag::FourWire },
+};
+
+constexpr SrIdEntry<Unit> sr_unit_table[] = {
+	{ SR_UNIT_VOLT, Unit::Volt },
+	{ SR_UNIT_AMPERE, Unit::Ampere },
+	{ SR_UNIT_OHM, Unit::Ohm },
+	{ SR_UNIT_FARAD, Unit::Farad },
+	{ SR_UNIT_KELVIN, Unit::Kelvin },
+	{ SR_UNIT_CELSIUS, Unit::Celsius },
+	{ SR_UNIT_FAHRENHEIT, Unit::Fahrenheit },
+	{ SR_UNIT_HERTZ, Unit::Hertz },
+	{ SR_UNIT_PERCENTAGE, Unit::Percentage },
+	{ SR_UNIT_BOOLEAN, Unit::Boolean },
+	{ SR_UNIT_SECOND, Unit::Second },
+	{ SR_UNIT_SIEMENS, Unit::Siemens },
+	{ SR_UNIT_DECIBEL_MW, Unit::DecibelMW },
+	{ SR_UNIT_DECIBEL_VOLT, Unit::DecibelVolt },
+	{ SR_UNIT_UNITLESS, Unit::Unitless },
+	{ SR_UNIT_DECIBEL_SPL, Unit::DecibelSpl },
+	{ SR_UNIT_CONCENTRATION, Unit::Concentration },
+	{ SR_UNIT_REVOLUTIONS_PER_MINUTE, Unit::RevolutionsPerMinute },
+	{ SR_UNIT_VOLT_AMPERE, Unit::VoltAmpere },
+	{ SR_UNIT_WATT, Unit::Watt },
+	{ SR_UNIT_WATT_HOUR, Unit::WattHour },
+	{ SR_UNIT_METER_SECOND, Unit::MeterPerSecond },
+	{ SR_UNIT_HECTOPASCAL, Unit::HectoPascal },
+	{ SR_UNIT_HUMIDITY_293K, Unit::Humidity293K },
+	{ SR_UNIT_DEGREE, Unit::Degree },
+	{ SR_UNIT_HENRY, Unit::Henry },
+	{ SR_UNIT_GRAM, Unit::Gram },
+	{ SR_UNIT_CARAT, Unit::Carat },
+	{ SR_UNIT_OUNCE, Unit::Ounce },
+	{ SR_UNIT_TROY_OUNCE, Unit::TroyOunce },
+	{ SR_UNIT_POUND, Unit::Pound },
+	{ SR_UNIT_PENNYWEIGHT, Unit::Pennyweight },
+	{ SR_UNIT_GRAIN, Unit::Grain },
+	{ SR_UNIT_TAEL, Unit::Tael },
+	{ SR_UNIT_MOMME, Unit::Momme },
+	{ SR_UNIT_TOLA, Unit::Tola },
+	{ SR_UNIT_PIECE, Unit::Piece },
+	{ SR_UNIT_JOULE, Unit::Joule },
+	{ SR_UNIT_COULOMB, Unit::Coulomb },
+	{ SR_UNIT_AMPERE_HOUR, Unit::AmpereHour },
+};
+
+static_assert((size_t)QuantityFlag::Unknown < 64,
+	"The QuantityFlags must fit into a uint64_t mask");
+
+template<typename T, size_t N>
+constexpr uint64_t min_sr_id(const SrIdEntry<T> (&table)[N], size_t i = 0,
+	uint64_t min = UINT64_MAX)
+{
+	return i == N ? min :
+		min_sr_id(table, i + 1, table[i].sr_id < min ? table[i].sr_id : min);
+}
+
+template<typename T, size_t N>
+constexpr uint64_t max_sr_id(const SrIdEntry<T> (&table)[N], size_t i = 0,
+	uint64_t max = 0)
+{
+	return i == N ? max :
+		max_sr_id(table, i + 1, table[i].sr_id > max ? table[i].sr_id : max);
+}
+
+/**
+ * Flat arrays for both directions of a mapping table. The sigrok IDs of the
+ * quantities and units are contiguous, so a lookup is a range check and an
+ * index instead of a tree search.
+ */
+template<typename T, size_t SrIdCount>
+class SrIdLookup
+{
+public:
+	template<size_t N>
+	explicit SrIdLookup(const SrIdEntry<T> (&table)[N]) :
+		sr_id_base_(min_sr_id(table))
+	{
+		values_.fill(T::Unknown);
+		sr_ids_.fill(0);
+		for (const auto &entry : table) {
+			values_[entry.sr_id - sr_id_base_] = entry.value;
+			sr_ids_[(size_t)entry.value] = entry.sr_id;
+		}
+	}
+
+	T value(uint64_t sr_id) const
+	{
+		// IDs below the base wrap around and fail the range check
+		const uint64_t index = sr_id - sr_id_base_;
+		return index < SrIdCount ? values_[index] : T::Unknown;
+	}
+
+	uint64_t sr_id(T value) const
+	{
+		return sr_ids_[(size_t)value];
+	}
+
+private:
+	const uint64_t sr_id_base_;
+	std::array<T, SrIdCount> values_;
+	std::array<uint64_t, (size_t)T::Unknown + 1> sr_ids_;
+};
+
+typedef SrIdLookup<Quantity, max_sr_id(sr_quantity_table) -
+	min_sr_id(sr_quantity_table) + 1> sr_quantity_lookup_t;
+typedef SrIdLookup<Unit, max_sr_id(sr_unit_table) -
+	min_sr_id(sr_unit_table) + 1> sr_unit_lookup_t;
+
+/**
+ * The sigrok QuantityFlags are single bits, so they are indexed by the bit
+ * position instead.
+ */
+class SrQuantityFlagLookup
+{
+public:
+	SrQuantityFlagLookup()
+	{
+		values_.fill(QuantityFlag::Unknown);
+		sr_ids_.fill(0);
+		for (const auto &entry : sr_quantity_flag_table) {
+			values_[bit_index(entry.sr_id)] = entry.value;
+			sr_ids_[(size_t)entry.value] = entry.sr_id;
+		}
+	}
+
+	QuantityFlag value(uint64_t sr_id) const
+	{
+		if (sr_id == 0 || (sr_id & (sr_id - 1)) != 0)
+			return QuantityFlag::Unknown;
+		return values_[bit_index(sr_id)];
+	}
+
+	uint64_t mask(uint64_t sr_quantity_flags) const
+	{
+		uint64_t mask = 0;
+		for (size_t i = 0; sr_quantity_flags != 0;
+				++i, sr_quantity_flags >>= 1) {
+			if (sr_quantity_flags & 1)
+				mask |= quantity_flag_mask(values_[i]);
+		}
+		return mask;
+	}
+
+	uint64_t sr_id(QuantityFlag quantity_flag) const
+	{
+		return sr_ids_[(size_t)quantity_flag];
+	}
+
+private:
+	static size_t bit_index(uint64_t sr_id)
+	{
+		size_t i = 0;
+		while (sr_id > 1) {
+			sr_id >>= 1;
+			++i;
+		}
+		return i;
+	}
+
+	std::array<QuantityFlag, 64> values_;
+	std::array<uint64_t, (size_t)QuantityFlag::Unknown + 1> sr_ids_;
+};
+
+/*
+ * The lookups are built on first use, so they are also valid during the
+ * static initialization of other translation units.
+ */
+
+const sr_quantity_lookup_t &sr_quantity_lookup()
+{
+	static const sr_quantity_lookup_t lookup(sr_quantity_table);
+	return lookup;
+}
+
+const SrQuantityFlagLookup &sr_quantity_flag_lookup()
+{
+	static const SrQuantityFlagLookup lookup;
+	return lookup;
+}
+
+const sr_unit_lookup_t &sr_unit_lookup()
+{
+	static const sr_unit_lookup_t lookup(sr_unit_table);
+	return lookup;
+}
+
+} // namespace
+
 quantity_name_map_t get_quantity_name_map()
 {
 	return quantity_name_map;
@@ -50,72 +311,103 @@ data_type_name_map_t get_data_type_name_map()
 
 Quantity get_quantity(const sigrok::Quantity *sr_quantity)
 {
-	if (sr_quantity_quantity_map.count(sr_quantity) > 0)
-		return sr_quantity_quantity_map[sr_quantity];
-	return Quantity::Unknown;
+	if (!sr_quantity)
+		return Quantity::Unknown;
+	return sr_quantity_lookup().value((uint32_t)sr_quantity->id());
 }
 
 Quantity get_quantity(uint32_t sr_quantity)
 {
-	const sigrok::Quantity *sr_q = sigrok::Quantity::get(sr_quantity);
-	return get_quantity(sr_q);
+	return sr_quantity_lookup().value(sr_quantity);
 }
 
 uint32_t get_sr_quantity_id(Quantity quantity)
 {
-	if (quantity_sr_quantity_map.count(quantity) > 0)
-		return quantity_sr_quantity_map[quantity]->id();
-	return 0;
+	return (uint32_t)sr_quantity_lookup().sr_id(quantity);
 }
 
 
 QuantityFlag get_quantity_flag(const sigrok::QuantityFlag *sr_quantity_flag)
 {
-	if (sr_quantity_flag_quantity_flag_map.count(sr_quantity_flag) > 0)
-		return sr_quantity_flag_quantity_flag_map[sr_quantity_flag];
-	return QuantityFlag::Unknown;
+	if (!sr_quantity_flag)
+		return QuantityFlag::Unknown;
+	return sr_quantity_flag_lookup().value((uint32_t)sr_quantity_flag->id());
 }
 
 uint64_t get_sr_quantity_flag_id(QuantityFlag quantity_flag)
 {
-	if (quantity_flag_sr_quantity_flag_map.count(quantity_flag) > 0)
-		return quantity_flag_sr_quantity_flag_map[quantity_flag]->id();
-	return 0;
+	return sr_quantity_flag_lookup().sr_id(quantity_flag);
 }
 
 bool is_valid_sr_quantity(data::Quantity quantity)
 {
-	return quantity_sr_quantity_map.count(quantity) > 0;
+	return sr_quantity_lookup().sr_id(quantity) != 0;
 }
 
 set<QuantityFlag> get_quantity_flags(
 	const vector<const sigrok::QuantityFlag *> &sr_quantity_flags)
 {
-	set<data::QuantityFlag> quantity_flag_set;
+	return get_quantity_flags_from_mask(
+		get_quantity_flags_mask(sr_quantity_flags));
+}
+
+set<QuantityFlag> get_quantity_flags(uint64_t sr_quantity_flags)
+{
+	return get_quantity_flags_from_mask(
+		get_quantity_flags_mask(sr_quantity_flags));
+}
+
+uint64_t get_quantity_flags_mask(const set<QuantityFlag> &quantity_flags)
+{
+	uint64_t mask = 0;
+	for (const auto &quantity_flag : quantity_flags)
+		mask |= quantity_flag_mask(quantity_flag);
+	return mask;
+}
+
+uint64_t get_quantity_flags_mask(
+	const vector<const sigrok::QuantityFlag *> &sr_quantity_flags)
+{
+	// TODO: Fix in libsigrokcxx.hpp, template EnumValue:
+	//       Change datatype of id from int to unsigned int.
+	//       See knarfS/libsigrok#v0.6.0-wip
+	uint64_t sr_mask = 0;
 	for (const auto &sr_qf : sr_quantity_flags) {
-		quantity_flag_set.insert(get_quantity_flag(sr_qf));
+		if (sr_qf)
+			sr_mask |= (uint32_t)sr_qf->id();
 	}
-	return quantity_flag_set;
+	return sr_quantity_flag_lookup().mask(sr_mask);
 }
 
-set<QuantityFlag> get_quantity_flags(uint64_t sr_quantity_flags)
+uint64_t get_quantity_flags_mask(uint64_t sr_quantity_flags)
 {
-	set<data::QuantityFlag> quantity_flag_set;
-	uint64_t mask = 1;
-	for (uint i = 0; i < 32; i++, mask <<= 1) {
-		if (!(sr_quantity_flags & mask))
-			continue;
+	return sr_quantity_flag_lookup().mask(sr_quantity_flags);
+}
 
-		// TODO: Fix in libsigrokcxx.hpp, template EnumValue:
-		//       Change datatype of id from int to unsigned int.
-		//       See knarfS/libsigrok#v0.6.0-wip
-		const sigrok::QuantityFlag *sr_qf =
-			sigrok::QuantityFlag::get((int)(sr_quantity_flags & mask));
-		quantity_flag_set.insert(get_quantity_flag(sr_qf));
+set<QuantityFlag> get_quantity_flags_from_mask(uint64_t quantity_flags_mask)
+{
+	set<data::QuantityFlag> quantity_flag_set;
+	for (size_t i = 0; i <= (size_t)QuantityFlag::Unknown; ++i) {
+		if (quantity_flags_mask & quantity_flag_mask((QuantityFlag)i))
+			quantity_flag_set.insert((QuantityFlag)i);
 	}
 	return quantity_flag_set;
 }
 
+MeasuredQuantity get_measured_quantity(
+	const measured_quantity_t &measured_quantity)
+{
+	return MeasuredQuantity(measured_quantity.first,
+		get_quantity_flags_mask(measured_quantity.second));
+}
+
+measured_quantity_t get_measured_quantity_pair(
+	const MeasuredQuantity &measured_quantity)
+{
+	return make_pair(measured_quantity.quantity,
+		get_quantity_flags_from_mask(measured_quantity.quantity_flags));
+}
+
 uint64_t get_sr_quantity_flags_id(const set<QuantityFlag> &quantity_flags)
 {
 	uint64_t sr_qfs_id = 0;
@@ -128,11 +420,15 @@ uint64_t get_sr_quantity_flags_id(const set<QuantityFlag> &quantity_flags)
 
 Unit get_unit(const sigrok::Unit *sr_unit)
 {
-	if (sr_unit_unit_map.count(sr_unit) > 0)
-		return sr_unit_unit_map[sr_unit];
-	return Unit::Unknown;
+	if (!sr_unit)
+		return Unit::Unknown;
+	return sr_unit_lookup().value((uint32_t)sr_unit->id());
 }
 
+Unit get_unit(uint32_t sr_unit)
+{
+	return sr_unit_lookup().value(sr_unit);
+}
 
 DataType get_data_type(const sigrok::DataType *sr_data_type)
 {
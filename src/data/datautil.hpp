@@ -22,6 +22,7 @@
 #ifndef DATA_DATAUTIL_HPP
 #define DATA_DATAUTIL_HPP
 
+#include <cstdint>
 #include <map>
 #include <set>
 #include <vector>
@@ -224,6 +225,38 @@ enum class DataType
 };
 
 typedef pair<Quantity, set<QuantityFlag>> measured_quantity_t;
+
+/**
+ * A compact measured quantity: The quantity and its flags as a bit mask
+ * (see datautil::quantity_flag_mask()). Unlike measured_quantity_t, it is
+ * compared and copied without allocations and is used on the data path.
+ */
+struct MeasuredQuantity
+{
+	constexpr MeasuredQuantity() :
+		quantity(Quantity::Unknown), quantity_flags(0) {}
+	constexpr MeasuredQuantity(Quantity quantity, uint64_t quantity_flags) :
+		quantity(quantity), quantity_flags(quantity_flags) {}
+
+	Quantity quantity;
+	uint64_t quantity_flags;
+};
+
+constexpr bool operator==(const MeasuredQuantity &a, const MeasuredQuantity &b)
+{
+	return a.quantity == b.quantity && a.quantity_flags == b.quantity_flags;
+}
+
+constexpr bool operator!=(const MeasuredQuantity &a, const MeasuredQuantity &b)
+{
+	return !(a == b);
+}
+
+constexpr bool operator<(const MeasuredQuantity &a, const MeasuredQuantity &b)
+{
+	return a.quantity < b.quantity ||
+		(a.quantity == b.quantity && a.quantity_flags < b.quantity_flags);
+}
 typedef pair<double, double> double_range_t;
 /**
  * Normaly <int64_t, uint64_t> should be used, but <uint64_t, uint64_t>
@@ -372,216 +405,6 @@ data_type_name_map_t data_type_name_map = {
 	{ DataType::Unknown, QString("Unknown") },
 };
 
-map<const sigrok::Quantity *, Quantity> sr_quantity_quantity_map = {
-	{ sigrok::Quantity::VOLTAGE, Quantity::Voltage },
-	{ sigrok::Quantity::CURRENT, Quantity::Current },
-	{ sigrok::Quantity::RESISTANCE, Quantity::Resistance },
-	{ sigrok::Quantity::CAPACITANCE, Quantity::Capacitance },
-	{ sigrok::Quantity::TEMPERATURE, Quantity::Temperature },
-	{ sigrok::Quantity::FREQUENCY, Quantity::Frequency },
-	{ sigrok::Quantity::DUTY_CYCLE, Quantity::DutyCyle },
-	{ sigrok::Quantity::CONTINUITY, Quantity::Continuity },
-	{ sigrok::Quantity::PULSE_WIDTH, Quantity::PulseWidth },
-	{ sigrok::Quantity::CONDUCTANCE, Quantity::Conductance },
-	{ sigrok::Quantity::POWER, Quantity::Power },
-	{ sigrok::Quantity::GAIN, Quantity::Gain },
-	{ sigrok::Quantity::SOUND_PRESSURE_LEVEL, Quantity::SoundPressureLevel },
-	{ sigrok::Quantity::CARBON_MONOXIDE, Quantity::CarbonMonoxide },
-	{ sigrok::Quantity::RELATIVE_HUMIDITY, Quantity::RelativeHumidity },
-	{ sigrok::Quantity::TIME, Quantity::Time },
-	{ sigrok::Quantity::WIND_SPEED, Quantity::WindSpeed },
-	{ sigrok::Quantity::PRESSURE, Quantity::Pressure },
-	{ sigrok::Quantity::PARALLEL_INDUCTANCE, Quantity::ParallelInductance },
-	{ sigrok::Quantity::PARALLEL_CAPACITANCE, Quantity::ParallelCapacitance },
-	{ sigrok::Quantity::PARALLEL_RESISTANCE, Quantity::ParallelResistance },
-	{ sigrok::Quantity::SERIES_INDUCTANCE, Quantity::SeriesInductance },
-	{ sigrok::Quantity::SERIES_CAPACITANCE, Quantity::SeriesCapacitance },
-	{ sigrok::Quantity::SERIES_RESISTANCE, Quantity::SeriesResistance },
-	{ sigrok::Quantity::DISSIPATION_FACTOR, Quantity::DissipationFactor },
-	{ sigrok::Quantity::QUALITY_FACTOR, Quantity::QualityFactor },
-	{ sigrok::Quantity::PHASE_ANGLE, Quantity::PhaseAngle },
-	{ sigrok::Quantity::DIFFERENCE, Quantity::Difference },
-	{ sigrok::Quantity::COUNT, Quantity::Count },
-	{ sigrok::Quantity::POWER_FACTOR, Quantity::PowerFactor },
-	{ sigrok::Quantity::APPARENT_POWER, Quantity::ApparentPower },
-	{ sigrok::Quantity::MASS, Quantity::Mass },
-	{ sigrok::Quantity::HARMONIC_RATIO, Quantity::HarmonicRatio },
-	{ sigrok::Quantity::ENERGY, Quantity::Energy },
-};
-
-map<Quantity, const sigrok::Quantity *> quantity_sr_quantity_map = {
-	{ Quantity::Voltage, sigrok::Quantity::VOLTAGE },
-	{ Quantity::Current, sigrok::Quantity::CURRENT },
-	{ Quantity::Resistance, sigrok::Quantity::RESISTANCE },
-	{ Quantity::Capacitance, sigrok::Quantity::CAPACITANCE },
-	{ Quantity::Temperature, sigrok::Quantity::TEMPERATURE },
-	{ Quantity::Frequency, sigrok::Quantity::FREQUENCY },
-	{ Quantity::DutyCyle, sigrok::Quantity::DUTY_CYCLE },
-	{ Quantity::Continuity, sigrok::Quantity::CONTINUITY },
-	{ Quantity::PulseWidth, sigrok::Quantity::PULSE_WIDTH },
-	{ Quantity::Conductance, sigrok::Quantity::CONDUCTANCE },
-	{ Quantity::Power, sigrok::Quantity::POWER },
-	{ Quantity::Gain, sigrok::Quantity::GAIN },
-	{ Quantity::SoundPressureLevel, sigrok::Quantity::SOUND_PRESSURE_LEVEL },
-	{ Quantity::CarbonMonoxide, sigrok::Quantity::CARBON_MONOXIDE },
-	{ Quantity::RelativeHumidity, sigrok::Quantity::RELATIVE_HUMIDITY },
-	{ Quantity::Time, sigrok::Quantity::TIME },
-	{ Quantity::WindSpeed, sigrok::Quantity::WIND_SPEED },
-	{ Quantity::Pressure, sigrok::Quantity::PRESSURE },
-	{ Quantity::ParallelInductance, sigrok::Quantity::PARALLEL_INDUCTANCE },
-	{ Quantity::ParallelCapacitance, sigrok::Quantity::PARALLEL_CAPACITANCE },
-	{ Quantity::ParallelResistance, sigrok::Quantity::PARALLEL_RESISTANCE },
-	{ Quantity::SeriesInductance, sigrok::Quantity::SERIES_INDUCTANCE },
-	{ Quantity::SeriesCapacitance,  sigrok::Quantity::SERIES_CAPACITANCE },
-	{ Quantity::SeriesResistance, sigrok::Quantity::SERIES_RESISTANCE },
-	{ Quantity::DissipationFactor, sigrok::Quantity::DISSIPATION_FACTOR },
-	{ Quantity::QualityFactor, sigrok::Quantity::QUALITY_FACTOR },
-	{ Quantity::PhaseAngle, sigrok::Quantity::PHASE_ANGLE },
-	{ Quantity::Difference, sigrok::Quantity::DIFFERENCE },
-	{ Quantity::Count, sigrok::Quantity::COUNT },
-	{ Quantity::PowerFactor, sigrok::Quantity::POWER_FACTOR },
-	{ Quantity::ApparentPower, sigrok::Quantity::APPARENT_POWER },
-	{ Quantity::Mass, sigrok::Quantity::MASS },
-	{ Quantity::HarmonicRatio, sigrok::Quantity::HARMONIC_RATIO },
-	{ Quantity::Energy, sigrok::Quantity::ENERGY },
-};
-
-map<const sigrok::QuantityFlag *, QuantityFlag> sr_quantity_flag_quantity_flag_map = {
-	{ sigrok::QuantityFlag::AC, QuantityFlag::AC },
-	{ sigrok::QuantityFlag::DC, QuantityFlag::DC },
-	{ sigrok::QuantityFlag::RMS, QuantityFlag::RMS },
-	{ sigrok::QuantityFlag::DIODE, QuantityFlag::Diode },
-	{ sigrok::QuantityFlag::HOLD, QuantityFlag::Hold },
-	{ sigrok::QuantityFlag::MAX, QuantityFlag::Max },
-	{ sigrok::QuantityFlag::MIN, QuantityFlag::Min },
-	{ sigrok::QuantityFlag::AUTORANGE, QuantityFlag::Autorange },
-	{ sigrok::QuantityFlag::RELATIVE, QuantityFlag::Relative },
-	{ sigrok::QuantityFlag::SPL_FREQ_WEIGHT_A, QuantityFlag::SplFreqWeightA },
-	{ sigrok::QuantityFlag::SPL_FREQ_WEIGHT_C, QuantityFlag::SplFreqWeightC },
-	{ sigrok::QuantityFlag::SPL_FREQ_WEIGHT_Z, QuantityFlag::SplFreqWeightZ },
-	{ sigrok::QuantityFlag::SPL_FREQ_WEIGHT_FLAT, QuantityFlag::SplFreqWeightFlat },
-	{ sigrok::QuantityFlag::SPL_TIME_WEIGHT_S, QuantityFlag::SplTimeWeightS },
-	{ sigrok::QuantityFlag::SPL_TIME_WEIGHT_F, QuantityFlag::SplTimeWeightF },
-	{ sigrok::QuantityFlag::SPL_LAT, QuantityFlag::SplLAT },
-	{ sigrok::QuantityFlag::SPL_PCT_OVER_ALARM, QuantityFlag::SplPctOverAlarm },
-	{ sigrok::QuantityFlag::DURATION, QuantityFlag::Duration },
-	{ sigrok::QuantityFlag::AVG, QuantityFlag::Avg },
-	{ sigrok::QuantityFlag::REFERENCE, QuantityFlag::Reference },
-	{ sigrok::QuantityFlag::UNSTABLE, QuantityFlag::Unstable },
-	{ sigrok::QuantityFlag::FOUR_WIRE, QuantityFlag::FourWire },
-};
-
-map<QuantityFlag, const sigrok::QuantityFlag *> quantity_flag_sr_quantity_flag_map = {
-	{ QuantityFlag::AC, sigrok::QuantityFlag::AC },
-	{ QuantityFlag::DC, sigrok::QuantityFlag::DC },
-	{ QuantityFlag::RMS, sigrok::QuantityFlag::RMS },
-	{ QuantityFlag::Diode, sigrok::QuantityFlag::DIODE },
-	{ QuantityFlag::Hold, sigrok::QuantityFlag::HOLD },
-	{ QuantityFlag::Max, sigrok::QuantityFlag::MAX },
-	{ QuantityFlag::Min, sigrok::QuantityFlag::MIN },
-	{ QuantityFlag::Autorange, sigrok::QuantityFlag::AUTORANGE },
-	{ QuantityFlag::Relative, sigrok::QuantityFlag::RELATIVE },
-	{ QuantityFlag::SplFreqWeightA, sigrok::QuantityFlag::SPL_FREQ_WEIGHT_A },
-	{ QuantityFlag::SplFreqWeightC, sigrok::QuantityFlag::SPL_FREQ_WEIGHT_C },
-	{ QuantityFlag::SplFreqWeightZ, sigrok::QuantityFlag::SPL_FREQ_WEIGHT_Z },
-	{ QuantityFlag::SplFreqWeightFlat, sigrok::QuantityFlag::SPL_FREQ_WEIGHT_FLAT },
-	{ QuantityFlag::SplTimeWeightS, sigrok::QuantityFlag::SPL_TIME_WEIGHT_S },
-	{ QuantityFlag::SplTimeWeightF, sigrok::QuantityFlag::SPL_TIME_WEIGHT_F },
-	{ QuantityFlag::SplLAT, sigrok::QuantityFlag::SPL_LAT },
-	{ QuantityFlag::SplPctOverAlarm, sigrok::QuantityFlag::SPL_PCT_OVER_ALARM },
-	{ QuantityFlag::Duration, sigrok::QuantityFlag::DURATION },
-	{ QuantityFlag::Avg, sigrok::QuantityFlag::AVG },
-	{ QuantityFlag::Reference, sigrok::QuantityFlag::REFERENCE },
-	{ QuantityFlag::Unstable, sigrok::QuantityFlag::UNSTABLE },
-	{ QuantityFlag::FourWire, sigrok::QuantityFlag::FOUR_WIRE },
-};
-
-map<const sigrok::Unit *, Unit> sr_unit_unit_map = {
-	{ sigrok::Unit::VOLT, Unit::Volt },
-	{ sigrok::Unit::AMPERE, Unit::Ampere },
-	{ sigrok::Unit::OHM, Unit::Ohm },
-	{ sigrok::Unit::FARAD, Unit::Farad },
-	{ sigrok::Unit::KELVIN, Unit::Kelvin },
-	{ sigrok::Unit::CELSIUS, Unit::Celsius },
-	{ sigrok::Unit::FAHRENHEIT, Unit::Fahrenheit },
-	{ sigrok::Unit::HERTZ, Unit::Hertz },
-	{ sigrok::Unit::PERCENTAGE, Unit::Percentage },
-	{ sigrok::Unit::BOOLEAN, Unit::Boolean },
-	{ sigrok::Unit::SECOND, Unit::Second },
-	{ sigrok::Unit::SIEMENS, Unit::Siemens },
-	{ sigrok::Unit::DECIBEL_MW, Unit::DecibelMW },
-	{ sigrok::Unit::DECIBEL_VOLT, Unit::DecibelVolt },
-	{ sigrok::Unit::UNITLESS, Unit::Unitless },
-	{ sigrok::Unit::DECIBEL_SPL, Unit::DecibelSpl },
-	{ sigrok::Unit::CONCENTRATION, Unit::Concentration },
-	{ sigrok::Unit::REVOLUTIONS_PER_MINUTE, Unit::RevolutionsPerMinute },
-	{ sigrok::Unit::VOLT_AMPERE, Unit::VoltAmpere },
-	{ sigrok::Unit::WATT, Unit::Watt },
-	{ sigrok::Unit::WATT_HOUR, Unit::WattHour },
-	{ sigrok::Unit::METER_SECOND, Unit::MeterPerSecond },
-	{ sigrok::Unit::HECTOPASCAL, Unit::HectoPascal },
-	{ sigrok::Unit::HUMIDITY_293K, Unit::Humidity293K },
-	{ sigrok::Unit::DEGREE, Unit::Degree },
-	{ sigrok::Unit::HENRY, Unit::Henry },
-	{ sigrok::Unit::GRAM, Unit::Gram },
-	{ sigrok::Unit::CARAT, Unit::Carat },
-	{ sigrok::Unit::OUNCE, Unit::Ounce },
-	{ sigrok::Unit::TROY_OUNCE, Unit::TroyOunce },
-	{ sigrok::Unit::POUND, Unit::Pound },
-	{ sigrok::Unit::PENNYWEIGHT, Unit::Pennyweight },
-	{ sigrok::Unit::GRAIN, Unit::Grain },
-	{ sigrok::Unit::TAEL, Unit::Tael },
-	{ sigrok::Unit::MOMME, Unit::Momme },
-	{ sigrok::Unit::TOLA, Unit::Tola },
-	{ sigrok::Unit::PIECE, Unit::Piece },
-	{ sigrok::Unit::JOULE, Unit::Joule },
-	{ sigrok::Unit::COULOMB, Unit::Coulomb },
-	{ sigrok::Unit::AMPERE_HOUR, Unit::AmpereHour },
-};
-
-map<Unit, const sigrok::Unit *> unit_sr_unit_map = {
-	{ Unit::Volt, sigrok::Unit::VOLT },
-	{ Unit::Ampere, sigrok::Unit::AMPERE },
-	{ Unit::Ohm, sigrok::Unit::OHM },
-	{ Unit::Farad, sigrok::Unit::FARAD },
-	{ Unit::Kelvin, sigrok::Unit::KELVIN },
-	{ Unit::Celsius, sigrok::Unit::CELSIUS },
-	{ Unit::Fahrenheit, sigrok::Unit::FAHRENHEIT },
-	{ Unit::Hertz, sigrok::Unit::HERTZ },
-	{ Unit::Percentage, sigrok::Unit::PERCENTAGE },
-	{ Unit::Boolean, sigrok::Unit::BOOLEAN },
-	{ Unit::Second, sigrok::Unit::SECOND },
-	{ Unit::Siemens, sigrok::Unit::SIEMENS },
-	{ Unit::DecibelMW, sigrok::Unit::DECIBEL_MW },
-	{ Unit::DecibelVolt, sigrok::Unit::DECIBEL_VOLT },
-	{ Unit::Unitless, sigrok::Unit::UNITLESS },
-	{ Unit::DecibelSpl, sigrok::Unit::DECIBEL_SPL },
-	{ Unit::Concentration, sigrok::Unit::CONCENTRATION },
-	{ Unit::RevolutionsPerMinute, sigrok::Unit::REVOLUTIONS_PER_MINUTE },
-	{ Unit::VoltAmpere, sigrok::Unit::VOLT_AMPERE },
-	{ Unit::Watt, sigrok::Unit::WATT },
-	{ Unit::WattHour, sigrok::Unit::WATT_HOUR },
-	{ Unit::MeterPerSecond, sigrok::Unit::METER_SECOND },
-	{ Unit::HectoPascal, sigrok::Unit::HECTOPASCAL },
-	{ Unit::Humidity293K, sigrok::Unit::HUMIDITY_293K },
-	{ Unit::Degree, sigrok::Unit::DEGREE },
-	{ Unit::Henry, sigrok::Unit::HENRY },
-	{ Unit::Gram, sigrok::Unit::GRAM },
-	{ Unit::Carat, sigrok::Unit::CARAT },
-	{ Unit::Ounce, sigrok::Unit::OUNCE },
-	{ Unit::TroyOunce, sigrok::Unit::TROY_OUNCE },
-	{ Unit::Pound, sigrok::Unit::POUND },
-	{ Unit::Pennyweight, sigrok::Unit::PENNYWEIGHT },
-	{ Unit::Grain, sigrok::Unit::GRAIN },
-	{ Unit::Tael, sigrok::Unit::TAEL },
-	{ Unit::Momme, sigrok::Unit::MOMME },
-	{ Unit::Tola, sigrok::Unit::TOLA },
-	{ Unit::Piece, sigrok::Unit::PIECE },
-	{ Unit::Joule, sigrok::Unit::JOULE },
-	{ Unit::Coulomb, sigrok::Unit::COULOMB },
-	{ Unit::AmpereHour, sigrok::Unit::AMPERE_HOUR },
-};
-
 map<const sigrok::DataType *, DataType> sr_data_type_data_type_map = {
 	{ sigrok::DataType::UINT64, DataType::UInt64 },
 	{ sigrok::DataType::STRING, DataType::String },
@@ -757,6 +580,76 @@ set<QuantityFlag> get_quantity_flags(
  */
 set<QuantityFlag> get_quantity_flags(uint64_t sr_quantity_flags);
 
+/**
+ * Return the bit of a QuantityFlag in a QuantityFlags mask
+ *
+ * @param quantity_flag The QuantityFlag
+ *
+ * @return The bit of the QuantityFlag.
+ */
+constexpr uint64_t quantity_flag_mask(QuantityFlag quantity_flag)
+{
+	return (uint64_t)1 << (unsigned int)quantity_flag;
+}
+
+/**
+ * Return the QuantityFlags mask for a QuantityFlags set
+ *
+ * @param quantity_flags The QuantityFlags as set
+ *
+ * @return The QuantityFlags as mask.
+ */
+uint64_t get_quantity_flags_mask(const set<QuantityFlag> &quantity_flags);
+
+/**
+ * Return the QuantityFlags mask for the sigrok QuantityFlags vector
+ *
+ * @param sr_quantity_flags The sigrok QuantityFlags as vector
+ *
+ * @return The QuantityFlags as mask.
+ */
+uint64_t get_quantity_flags_mask(
+	const vector<const sigrok::QuantityFlag *> &sr_quantity_flags);
+
+/**
+ * Return the QuantityFlags mask for the sigrok QuantityFlags (uint64_t).
+ * This doesn't allocate and is used on the data path.
+ *
+ * @param sr_quantity_flags The sigrok QuantityFlags as uint64_t
+ *
+ * @return The QuantityFlags as mask.
+ */
+uint64_t get_quantity_flags_mask(uint64_t sr_quantity_flags);
+
+/**
+ * Return the QuantityFlags set for a QuantityFlags mask
+ *
+ * @param quantity_flags_mask The QuantityFlags as mask
+ *
+ * @return The QuantityFlags as set.
+ */
+set<QuantityFlag> get_quantity_flags_from_mask(uint64_t quantity_flags_mask);
+
+/**
+ * Return the compact MeasuredQuantity for a measured_quantity_t
+ *
+ * @param measured_quantity The measured_quantity_t
+ *
+ * @return The MeasuredQuantity.
+ */
+MeasuredQuantity get_measured_quantity(
+	const measured_quantity_t &measured_quantity);
+
+/**
+ * Return the measured_quantity_t for a compact MeasuredQuantity
+ *
+ * @param measured_quantity The MeasuredQuantity
+ *
+ * @return The measured_quantity_t.
+ */
+measured_quantity_t get_measured_quantity_pair(
+	const MeasuredQuantity &measured_quantity);
+
 /**
  * Return the corresponding QuantityFlags as an uint64_t
  *
@@ -776,6 +669,15 @@ uint64_t get_sr_quantity_flags_id(const set<QuantityFlag> &quantity_flags);
  */
 Unit get_unit(const sigrok::Unit *sr_unit);
 
+/**
+ * Return the corresponding Unit for a sigrok Unit ID
+ *
+ * @param sr_unit The sigrok Unit ID
+ *
+ * @return The Unit.
+ */
+Unit get_unit(uint32_t sr_unit);
+
 
 /**
  * Return the corresponding DataType for a sigrok DataType
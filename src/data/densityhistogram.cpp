@@ -0,0 +1,255 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "densityhistogram.hpp"
+
+using std::vector;
+
+namespace sv {
+namespace data {
+
+DensityHistogram::DensityHistogram(size_t columns, size_t rows) :
+	columns_(std::max<size_t>(2, columns + (columns & 1))),
+	rows_(std::max<size_t>(2, rows + (rows & 1))),
+	bins_(columns_ * rows_, 0),
+	max_count_(0),
+	point_count_(0),
+	has_range_(false),
+	x_min_(0.),
+	x_max_(0.),
+	y_min_(0.),
+	y_max_(0.)
+{
+}
+
+void DensityHistogram::add(const double *x, const double *y, size_t count)
+{
+	if (!has_range_)
+		init_range(x, y, count);
+	if (!has_range_)
+		return;
+
+	for (size_t i = 0; i < count; ++i) {
+		if (!std::isfinite(x[i]) || !std::isfinite(y[i]))
+			continue;
+		if ((x[i] < x_min_ || x[i] > x_max_) && !grow_x(x[i]))
+			continue;
+		if ((y[i] < y_min_ || y[i] > y_max_) && !grow_y(y[i]))
+			continue;
+		add_point(x[i], y[i]);
+	}
+}
+
+void DensityHistogram::clear()
+{
+	std::fill(bins_.begin(), bins_.end(), 0);
+	max_count_ = 0;
+	point_count_ = 0;
+	has_range_ = false;
+}
+
+size_t DensityHistogram::columns() const
+{
+	return columns_;
+}
+
+size_t DensityHistogram::rows() const
+{
+	return rows_;
+}
+
+size_t DensityHistogram::point_count() const
+{
+	return point_count_;
+}
+
+bool DensityHistogram::empty() const
+{
+	return point_count_ == 0;
+}
+
+double DensityHistogram::x_min() const
+{
+	return x_min_;
+}
+
+double DensityHistogram::x_max() const
+{
+	return x_max_;
+}
+
+double DensityHistogram::y_min() const
+{
+	return y_min_;
+}
+
+double DensityHistogram::y_max() const
+{
+	return y_max_;
+}
+
+uint32_t DensityHistogram::count(size_t column, size_t row) const
+{
+	return bins_[row * columns_ + column];
+}
+
+const vector<uint32_t> &DensityHistogram::bins() const
+{
+	return bins_;
+}
+
+uint32_t DensityHistogram::max_count() const
+{
+	return max_count_;
+}
+
+void DensityHistogram::init_range(const double *x, const double *y,
+	size_t count)
+{
+	double x_min = std::numeric_limits<double>::max();
+	double x_max = std::numeric_limits<double>::lowest();
+	double y_min = std::numeric_limits<double>::max();
+	double y_max = std::numeric_limits<double>::lowest();
+	for (size_t i = 0; i < count; ++i) {
+		if (!std::isfinite(x[i]) || !std::isfinite(y[i]))
+			continue;
+		x_min = std::min(x_min, x[i]);
+		x_max = std::max(x_max, x[i]);
+		y_min = std::min(y_min, y[i]);
+		y_max = std::max(y_max, y[i]);
+	}
+	if (x_min > x_max)
+		return;
+
+	// A single point (or a line) still needs an extent
+	auto widen = [](double &min, double &max) {
+		if (max - min > 0.)
+			return;
+		const double extent = std::max(std::fabs(min) * 1e-3, 1e-12);
+		min -= extent;
+		max += extent;
+	};
+	widen(x_min, x_max);
+	widen(y_min, y_max);
+
+	x_min_ = x_min;
+	x_max_ = x_max;
+	y_min_ = y_min;
+	y_max_ = y_max;
+	has_range_ = true;
+}
+
+bool DensityHistogram::grow_x(double x)
+{
+	while (x < x_min_ || x > x_max_) {
+		const double width = x_max_ - x_min_;
+		const bool grow_up = x > x_max_;
+		const double new_min = grow_up ? x_min_ : x_min_ - width;
+		const double new_max = grow_up ? x_max_ + width : x_max_;
+		if (!std::isfinite(new_max - new_min))
+			return false;
+
+		// Merge two columns into one. The old range is the lower (or upper)
+		// half of the new range.
+		const size_t half = columns_ / 2;
+		for (size_t row = 0; row < rows_; ++row) {
+			uint32_t *bins = &bins_[row * columns_];
+			if (grow_up) {
+				for (size_t column = 0; column < half; ++column)
+					bins[column] = bins[2 * column] + bins[2 * column + 1];
+				std::fill(bins + half, bins + columns_, 0);
+			}
+			else {
+				for (size_t column = columns_; column-- > half; ) {
+					const size_t old_column = 2 * (column - half);
+					bins[column] = bins[old_column] + bins[old_column + 1];
+				}
+				std::fill(bins, bins + half, 0);
+			}
+		}
+		x_min_ = new_min;
+		x_max_ = new_max;
+		max_count_ = *std::max_element(bins_.begin(), bins_.end());
+	}
+	return true;
+}
+
+bool DensityHistogram::grow_y(double y)
+{
+	while (y < y_min_ || y > y_max_) {
+		const double height = y_max_ - y_min_;
+		const bool grow_up = y > y_max_;
+		const double new_min = grow_up ? y_min_ : y_min_ - height;
+		const double new_max = grow_up ? y_max_ + height : y_max_;
+		if (!std::isfinite(new_max - new_min))
+			return false;
+
+		// Merge two rows into one
+		const size_t half = rows_ / 2;
+		if (grow_up) {
+			for (size_t row = 0; row < half; ++row) {
+				for (size_t column = 0; column < columns_; ++column) {
+					bins_[row * columns_ + column] =
+						bins_[2 * row * columns_ + column] +
+						bins_[(2 * row + 1) * columns_ + column];
+				}
+			}
+			std::fill(bins_.begin() + half * columns_, bins_.end(), 0);
+		}
+		else {
+			for (size_t row = rows_; row-- > half; ) {
+				const size_t old_row = 2 * (row - half);
+				for (size_t column = 0; column < columns_; ++column) {
+					bins_[row * columns_ + column] =
+						bins_[old_row * columns_ + column] +
+						bins_[(old_row + 1) * columns_ + column];
+				}
+			}
+			std::fill(bins_.begin(), bins_.begin() + half * columns_, 0);
+		}
+		y_min_ = new_min;
+		y_max_ = new_max;
+		max_count_ = *std::max_element(bins_.begin(), bins_.end());
+	}
+	return true;
+}
+
+void DensityHistogram::add_point(double x, double y)
+{
+	const double fx = (x - x_min_) / (x_max_ - x_min_) * (double)columns_;
+	const double fy = (y - y_min_) / (y_max_ - y_min_) * (double)rows_;
+	const size_t column = std::min((size_t)fx, columns_ - 1);
+	const size_t row = std::min((size_t)fy, rows_ - 1);
+
+	uint32_t &bin = bins_[row * columns_ + column];
+	if (bin < std::numeric_limits<uint32_t>::max())
+		++bin;
+	max_count_ = std::max(max_count_, bin);
+	++point_count_;
+}
+
+} // namespace data
+} // namespace sv
@@ -0,0 +1,97 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_DENSITYHISTOGRAM_HPP
+#define DATA_DENSITYHISTOGRAM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using std::vector;
+
+namespace sv {
+namespace data {
+
+/**
+ * A 2D histogram of points, e.g. to draw XY curves with millions of points
+ * as a density map (like the persistent phosphor of an analog scope).
+ *
+ * The points are counted in a fixed grid of bins, so adding points costs
+ * O(new points) and the memory doesn't depend on the number of points. The
+ * range of the grid is taken from the first points and is doubled (in the
+ * direction of the new point) when a point is outside of it, by merging
+ * 2x2 bins. Non finite points are skipped.
+ */
+class DensityHistogram
+{
+public:
+	/** The number of columns and rows are rounded up to an even number. */
+	explicit DensityHistogram(size_t columns = 512, size_t rows = 512);
+
+	void add(const double *x, const double *y, size_t count);
+	void clear();
+
+	size_t columns() const;
+	size_t rows() const;
+	/** Return the number of counted points. */
+	size_t point_count() const;
+	bool empty() const;
+
+	/** The range, that is covered by the grid. */
+	double x_min() const;
+	double x_max() const;
+	double y_min() const;
+	double y_max() const;
+
+	/** Return the count of the bin. Row 0 is at y_min(). */
+	uint32_t count(size_t column, size_t row) const;
+	/** The counts of all bins, row by row. */
+	const vector<uint32_t> &bins() const;
+	uint32_t max_count() const;
+
+private:
+	/** Set the initial range from the bounding box of the points. */
+	void init_range(const double *x, const double *y, size_t count);
+	/**
+	 * Double the x range towards x until it contains x.
+	 *
+	 * @return false if the range would overflow.
+	 */
+	bool grow_x(double x);
+	bool grow_y(double y);
+	void add_point(double x, double y);
+
+	size_t columns_;
+	size_t rows_;
+	vector<uint32_t> bins_;
+	uint32_t max_count_;
+	size_t point_count_;
+	bool has_range_;
+	double x_min_;
+	double x_max_;
+	double y_min_;
+	double y_max_;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_DENSITYHISTOGRAM_HPP
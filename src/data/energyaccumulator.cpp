@@ -0,0 +1,207 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "energyaccumulator.hpp"
+#include "src/data/analogbasesignal.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/samplebus.hpp"
+#include "src/data/signalcombinecache.hpp"
+
+using std::lock_guard;
+using std::mutex;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+namespace {
+
+/** Return the timestamp of the newest sample of the signals. */
+double last_timestamp(const AnalogTimeSignal &signal1,
+	const AnalogTimeSignal &signal2)
+{
+	double timestamp = std::numeric_limits<double>::lowest();
+	if (signal1.sample_count() > 0)
+		timestamp = std::max(timestamp, signal1.get_last_sample(false).first);
+	if (signal2.sample_count() > 0)
+		timestamp = std::max(timestamp, signal2.get_last_sample(false).first);
+	return timestamp;
+}
+
+}
+
+const size_t EnergyAccumulator::read_block_size_ = 1024;
+
+EnergyAccumulator::EnergyAccumulator(
+		shared_ptr<AnalogTimeSignal> voltage_signal,
+		shared_ptr<AnalogTimeSignal> current_signal) :
+	QObject(),
+	voltage_signal_(voltage_signal),
+	current_signal_(current_signal),
+	combine_cursor_(
+		new SignalCombineCursor({ voltage_signal, current_signal })),
+	block_timestamps_(read_block_size_),
+	block_voltages_(read_block_size_),
+	block_currents_(read_block_size_)
+{
+	assert(voltage_signal_);
+	assert(current_signal_);
+
+	// Only the samples from now on are accumulated
+	reset_statistics();
+	start_timestamp_ = last_timestamp(*voltage_signal_, *current_signal_);
+
+	voltage_signal_->add_observer();
+	voltage_signal_->set_observer_history(this, 0.);
+	current_signal_->add_observer();
+	current_signal_->set_observer_history(this, 0.);
+	subscriptions_.push_back(voltage_signal_->subscribe_samples(
+		[this](size_t, size_t) { on_samples_appended(); },
+		[this]() { on_samples_cleared(); }, SampleExecutor::Context, this));
+	subscriptions_.push_back(current_signal_->subscribe_samples(
+		[this](size_t, size_t) { on_samples_appended(); },
+		[this]() { on_samples_cleared(); }, SampleExecutor::Context, this));
+}
+
+EnergyAccumulator::~EnergyAccumulator()
+{
+	voltage_signal_->clear_observer_history(this);
+	voltage_signal_->remove_observer();
+	current_signal_->clear_observer_history(this);
+	current_signal_->remove_observer();
+}
+
+shared_ptr<AnalogTimeSignal> EnergyAccumulator::voltage_signal() const
+{
+	return voltage_signal_;
+}
+
+shared_ptr<AnalogTimeSignal> EnergyAccumulator::current_signal() const
+{
+	return current_signal_;
+}
+
+EnergyStatistics EnergyAccumulator::statistics() const
+{
+	lock_guard<mutex> lock(mutex_);
+	return statistics_;
+}
+
+void EnergyAccumulator::reset()
+{
+	lock_guard<mutex> lock(mutex_);
+	reset_statistics();
+	// The samples, that are not yet processed, are skipped
+	start_timestamp_ = last_timestamp(*voltage_signal_, *current_signal_);
+}
+
+void EnergyAccumulator::reset_statistics()
+{
+	statistics_.sample_count = 0;
+	statistics_.voltage_min = std::numeric_limits<double>::max();
+	statistics_.voltage_max = std::numeric_limits<double>::lowest();
+	statistics_.current_min = std::numeric_limits<double>::max();
+	statistics_.current_max = std::numeric_limits<double>::lowest();
+	statistics_.resistance_min = std::numeric_limits<double>::max();
+	statistics_.resistance_max = std::numeric_limits<double>::lowest();
+	statistics_.power_min = std::numeric_limits<double>::max();
+	statistics_.power_max = std::numeric_limits<double>::lowest();
+	statistics_.amp_hours = 0.;
+	statistics_.watt_hours = 0.;
+	has_prev_ = false;
+	prev_timestamp_ = 0.;
+	prev_current_ = 0.;
+	prev_power_ = 0.;
+}
+
+void EnergyAccumulator::add(double timestamp, double voltage, double current)
+{
+	if (timestamp < start_timestamp_ ||
+			std::isnan(voltage) || std::isnan(current))
+		return;
+
+	const double resistance = current == 0. ?
+		std::numeric_limits<double>::max() : voltage / current;
+	const double power = voltage * current;
+
+	EnergyStatistics &s = statistics_;
+	++s.sample_count;
+	s.voltage_min = std::min(s.voltage_min, voltage);
+	s.voltage_max = std::max(s.voltage_max, voltage);
+	s.current_min = std::min(s.current_min, current);
+	s.current_max = std::max(s.current_max, current);
+	s.resistance_min = std::min(s.resistance_min, resistance);
+	s.resistance_max = std::max(s.resistance_max, resistance);
+	s.power_min = std::min(s.power_min, power);
+	s.power_max = std::max(s.power_max, power);
+
+	if (has_prev_) {
+		// Trapezoidal rule, the timestamps are in seconds
+		const double hours = (timestamp - prev_timestamp_) / 3600.;
+		s.amp_hours += (prev_current_ + current) / 2. * hours;
+		s.watt_hours += (prev_power_ + power) / 2. * hours;
+	}
+	has_prev_ = true;
+	prev_timestamp_ = timestamp;
+	prev_current_ = current;
+	prev_power_ = power;
+}
+
+void EnergyAccumulator::on_samples_appended()
+{
+	size_t rows = 0;
+	{
+		lock_guard<mutex> lock(mutex_);
+		double *values[2] = { block_voltages_.data(), block_currents_.data() };
+		while (true) {
+			const size_t count = combine_cursor_->combine(
+				read_block_size_, block_timestamps_.data(), values);
+			if (count == 0)
+				break;
+
+			for (size_t i = 0; i < count; ++i) {
+				add(block_timestamps_[i],
+					block_voltages_[i], block_currents_[i]);
+			}
+			rows += count;
+		}
+	}
+
+	if (rows > 0)
+		Q_EMIT statistics_updated();
+}
+
+void EnergyAccumulator::on_samples_cleared()
+{
+	// The cursor starts again with the first row by itself
+	lock_guard<mutex> lock(mutex_);
+	has_prev_ = false;
+}
+
+} // namespace data
+} // namespace sv
@@ -0,0 +1,133 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_ENERGYACCUMULATOR_HPP
+#define DATA_ENERGYACCUMULATOR_HPP
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <QObject>
+
+#include "src/data/samplebus.hpp"
+
+using std::shared_ptr;
+using std::unique_ptr;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+class AnalogTimeSignal;
+class SignalCombineCursor;
+
+/**
+ * The accumulated values of an EnergyAccumulator.
+ */
+struct EnergyStatistics
+{
+	/** The number of combined voltage/current samples. */
+	size_t sample_count;
+	double voltage_min;
+	double voltage_max;
+	double current_min;
+	double current_max;
+	double resistance_min;
+	double resistance_max;
+	double power_min;
+	double power_max;
+	double amp_hours;
+	double watt_hours;
+};
+
+/**
+ * Integrates the charge (Ah) and the energy (Wh) from the samples of a
+ * voltage and a current signal and tracks the min/max values of voltage,
+ * current, resistance and power.
+ *
+ * The signals are combined onto the union of their timestamps (see
+ * SignalCombineCursor) and integrated with the trapezoidal rule, so every
+ * sample in the signals counts and the result doesn't depend on how often the
+ * statistics are read. Only the samples from the creation (or the last
+ * reset()) on are accumulated.
+ *
+ * The samples are processed in the thread of the accumulator (e.g. a worker
+ * of the WorkerPool), the statistics can be read from any thread.
+ */
+class EnergyAccumulator : public QObject
+{
+	Q_OBJECT
+
+public:
+	EnergyAccumulator(shared_ptr<AnalogTimeSignal> voltage_signal,
+		shared_ptr<AnalogTimeSignal> current_signal);
+	~EnergyAccumulator();
+
+	shared_ptr<AnalogTimeSignal> voltage_signal() const;
+	shared_ptr<AnalogTimeSignal> current_signal() const;
+
+	/** Return a copy of the current statistics. */
+	EnergyStatistics statistics() const;
+
+	/**
+	 * Restart the accumulation with the next samples.
+	 */
+	void reset();
+
+private:
+	/** Reset the statistics. mutex_ must be locked. */
+	void reset_statistics();
+	/** Accumulate one combined sample. mutex_ must be locked. */
+	void add(double timestamp, double voltage, double current);
+
+	static const size_t read_block_size_;
+
+	shared_ptr<AnalogTimeSignal> voltage_signal_;
+	shared_ptr<AnalogTimeSignal> current_signal_;
+	unique_ptr<SignalCombineCursor> combine_cursor_;
+	vector<double> block_timestamps_;
+	vector<double> block_voltages_;
+	vector<double> block_currents_;
+
+	mutable std::mutex mutex_;
+	EnergyStatistics statistics_;
+	/** Samples before this timestamp are not accumulated. */
+	double start_timestamp_;
+	bool has_prev_;
+	double prev_timestamp_;
+	double prev_current_;
+	double prev_power_;
+	vector<unique_ptr<SampleBusSubscription>> subscriptions_;
+
+private Q_SLOTS:
+	void on_samples_appended();
+	void on_samples_cleared();
+
+Q_SIGNALS:
+	/** New samples were accumulated. */
+	void statistics_updated();
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_ENERGYACCUMULATOR_HPP
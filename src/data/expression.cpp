@@ -0,0 +1,530 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <locale>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "expression.hpp"
+
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+namespace {
+
+/**
+ * Return the number of a variable from its decimal digits. Numbers, that
+ * don't fit into a size_t, saturate, so they are out of range for every
+ * variable count instead of throwing like std::stoul().
+ */
+size_t parse_variable_number(const string &digits)
+{
+	const size_t max = std::numeric_limits<size_t>::max();
+	size_t number = 0;
+	for (const char d : digits) {
+		const size_t digit = (size_t)(d - '0');
+		if (number > (max - digit) / 10)
+			return max;
+		number = number * 10 + digit;
+	}
+	return number;
+}
+
+}
+
+const size_t Expression::block_size_ = 256;
+
+/**
+ * Recursive descent parser, that emits the instructions in postfix order:
+ *
+ *   expression := term (('+' | '-') term)*
+ *   term       := unary (('*' | '/') unary)*
+ *   unary      := ('-' | '+') unary | power
+ *   power      := primary ('^' unary)?
+ *   primary    := number | constant | variable | function '(' args ')' |
+ *                 '(' expression ')'
+ */
+class Expression::Parser
+{
+public:
+	Parser(Expression &expression, const string &text, size_t variable_count) :
+		expression_(expression),
+		text_(text),
+		pos_(0),
+		variable_count_(variable_count)
+	{
+	}
+
+	bool parse()
+	{
+		if (!parse_expression())
+			return false;
+		skip_space();
+		if (pos_ < text_.size())
+			return fail("Unexpected '" + text_.substr(pos_, 1) + "'");
+		return true;
+	}
+
+	string error() const
+	{
+		return error_;
+	}
+
+private:
+	bool fail(const string &msg)
+	{
+		if (error_.empty())
+			error_ = msg + " at position " + std::to_string(pos_ + 1);
+		return false;
+	}
+
+	void skip_space()
+	{
+		while (pos_ < text_.size() && std::isspace((unsigned char)text_[pos_]))
+			++pos_;
+	}
+
+	bool accept(char c)
+	{
+		skip_space();
+		if (pos_ < text_.size() && text_[pos_] == c) {
+			++pos_;
+			return true;
+		}
+		return false;
+	}
+
+	bool parse_expression()
+	{
+		if (!parse_term())
+			return false;
+		while (true) {
+			if (accept('+')) {
+				if (!parse_term())
+					return false;
+				expression_.emit(OpCode::Add);
+			}
+			else if (accept('-')) {
+				if (!parse_term())
+					return false;
+				expression_.emit(OpCode::Subtract);
+			}
+			else {
+				return true;
+			}
+		}
+	}
+
+	bool parse_term()
+	{
+		if (!parse_unary())
+			return false;
+		while (true) {
+			if (accept('*')) {
+				if (!parse_unary())
+					return false;
+				expression_.emit(OpCode::Multiply);
+			}
+			else if (accept('/')) {
+				if (!parse_unary())
+					return false;
+				expression_.emit(OpCode::Divide);
+			}
+			else {
+				return true;
+			}
+		}
+	}
+
+	bool parse_unary()
+	{
+		if (accept('-')) {
+			if (!parse_unary())
+				return false;
+			expression_.emit(OpCode::Negate);
+			return true;
+		}
+		if (accept('+'))
+			return parse_unary();
+		return parse_power();
+	}
+
+	bool parse_power()
+	{
+		if (!parse_primary())
+			return false;
+		// Right associative, 2^-1 is valid
+		if (accept('^')) {
+			if (!parse_unary())
+				return false;
+			expression_.emit(OpCode::Power);
+		}
+		return true;
+	}
+
+	bool parse_number()
+	{
+		// Always with a decimal point, independent of the locale
+		std::istringstream stream(text_.substr(pos_));
+		stream.imbue(std::locale::classic());
+		double value;
+		stream >> value;
+		if (stream.fail())
+			return fail("Invalid number");
+		const std::streamoff length = stream.eof() ?
+			(std::streamoff)(text_.size() - pos_) : (std::streamoff)stream.tellg();
+		pos_ += (size_t)length;
+		expression_.emit(OpCode::Constant, 0, value);
+		return true;
+	}
+
+	bool parse_primary()
+	{
+		skip_space();
+		if (pos_ >= text_.size())
+			return fail("Unexpected end of formula");
+
+		const char c = text_[pos_];
+		if (std::isdigit((unsigned char)c) || c == '.')
+			return parse_number();
+
+		if (accept('(')) {
+			if (!parse_expression())
+				return false;
+			if (!accept(')'))
+				return fail("Missing ')'");
+			return true;
+		}
+
+		if (!std::isalpha((unsigned char)c))
+			return fail("Unexpected '" + string(1, c) + "'");
+
+		const size_t start = pos_;
+		while (pos_ < text_.size() && std::isalnum((unsigned char)text_[pos_]))
+			++pos_;
+		const string name = text_.substr(start, pos_ - start);
+
+		if (name.size() > 1 && name[0] == 'v' &&
+				std::all_of(name.begin() + 1, name.end(),
+					[](char d) { return std::isdigit((unsigned char)d); })) {
+			const size_t number = parse_variable_number(name.substr(1));
+			if (number < 1 || number > variable_count_) {
+				pos_ = start;
+				return fail("Unknown variable " + name);
+			}
+			expression_.emit(OpCode::Variable, number - 1);
+			return true;
+		}
+		if (name == "pi") {
+			expression_.emit(OpCode::Constant, 0, M_PI);
+			return true;
+		}
+		if (name == "e") {
+			expression_.emit(OpCode::Constant, 0, M_E);
+			return true;
+		}
+
+		OpCode op;
+		size_t arg_count = 1;
+		if (name == "abs")
+			op = OpCode::Abs;
+		else if (name == "sqrt")
+			op = OpCode::Sqrt;
+		else if (name == "exp")
+			op = OpCode::Exp;
+		else if (name == "log")
+			op = OpCode::Log;
+		else if (name == "log10")
+			op = OpCode::Log10;
+		else if (name == "sin")
+			op = OpCode::Sin;
+		else if (name == "cos")
+			op = OpCode::Cos;
+		else if (name == "tan")
+			op = OpCode::Tan;
+		else if (name == "min") {
+			op = OpCode::Min;
+			arg_count = 2;
+		}
+		else if (name == "max") {
+			op = OpCode::Max;
+			arg_count = 2;
+		}
+		else {
+			pos_ = start;
+			return fail("Unknown name " + name);
+		}
+
+		if (!accept('('))
+			return fail("Missing '(' after " + name);
+		for (size_t i = 0; i < arg_count; ++i) {
+			if (i > 0 && !accept(','))
+				return fail(name + " needs " + std::to_string(arg_count) +
+					" arguments");
+			if (!parse_expression())
+				return false;
+		}
+		if (!accept(')'))
+			return fail("Missing ')'");
+		expression_.emit(op);
+		return true;
+	}
+
+	Expression &expression_;
+	const string &text_;
+	size_t pos_;
+	size_t variable_count_;
+	string error_;
+
+};
+
+Expression::Expression() :
+	variable_count_(0),
+	stack_depth_(0),
+	is_valid_(false)
+{
+}
+
+bool Expression::compile(const string &formula, size_t variable_count)
+{
+	formula_ = formula;
+	variable_count_ = variable_count;
+	code_.clear();
+	stack_depth_ = 0;
+	error_.clear();
+
+	Parser parser(*this, formula_, variable_count_);
+	is_valid_ = parser.parse();
+	if (!is_valid_) {
+		error_ = parser.error();
+		code_.clear();
+		return false;
+	}
+
+	size_t depth = 0;
+	for (const auto &instruction : code_) {
+		if (arity(instruction.op) == 0)
+			++depth;
+		else if (arity(instruction.op) == 2)
+			--depth;
+		stack_depth_ = std::max(stack_depth_, depth);
+	}
+	return true;
+}
+
+bool Expression::is_valid() const
+{
+	return is_valid_;
+}
+
+string Expression::error() const
+{
+	return error_;
+}
+
+string Expression::formula() const
+{
+	return formula_;
+}
+
+size_t Expression::variable_count() const
+{
+	return variable_count_;
+}
+
+size_t Expression::max_variable(const string &formula)
+{
+	size_t max = 0;
+	for (size_t i = 0; i < formula.size(); ++i) {
+		// Only a "v" at the start of a name is a variable
+		if (formula[i] != 'v' ||
+				(i > 0 && std::isalnum((unsigned char)formula[i - 1])))
+			continue;
+		size_t end = i + 1;
+		while (end < formula.size() &&
+				std::isdigit((unsigned char)formula[end]))
+			++end;
+		if (end == i + 1 || (end < formula.size() &&
+				std::isalpha((unsigned char)formula[end])))
+			continue;
+		max = std::max(max,
+			parse_variable_number(formula.substr(i + 1, end - i - 1)));
+	}
+	return max;
+}
+
+size_t Expression::arity(OpCode op)
+{
+	switch (op) {
+	case OpCode::Constant:
+	case OpCode::Variable:
+		return 0;
+	case OpCode::Add:
+	case OpCode::Subtract:
+	case OpCode::Multiply:
+	case OpCode::Divide:
+	case OpCode::Power:
+	case OpCode::Min:
+	case OpCode::Max:
+		return 2;
+	default:
+		return 1;
+	}
+}
+
+void Expression::emit(OpCode op, size_t index, double value)
+{
+	// The operands of an instruction are the results of the preceding
+	// instructions, so constant operands are the last instructions.
+	const size_t size = code_.size();
+	const size_t op_arity = arity(op);
+	if (op_arity == 2 && size >= 2 && code_[size - 2].op == OpCode::Constant &&
+			code_[size - 1].op == OpCode::Constant) {
+		code_[size - 2].value =
+			apply(op, code_[size - 2].value, code_[size - 1].value);
+		code_.pop_back();
+	}
+	else if (op_arity == 1 && size >= 1 &&
+			code_[size - 1].op == OpCode::Constant) {
+		code_[size - 1].value = apply(op, code_[size - 1].value, 0.);
+	}
+	else {
+		code_.push_back(Instruction{ op, index, value });
+	}
+}
+
+double Expression::apply(OpCode op, double a, double b)
+{
+	switch (op) {
+	case OpCode::Negate:
+		return -a;
+	case OpCode::Add:
+		return a + b;
+	case OpCode::Subtract:
+		return a - b;
+	case OpCode::Multiply:
+		return a * b;
+	case OpCode::Divide:
+		return a / b;
+	case OpCode::Power:
+		return std::pow(a, b);
+	case OpCode::Min:
+		return std::min(a, b);
+	case OpCode::Max:
+		return std::max(a, b);
+	case OpCode::Abs:
+		return std::fabs(a);
+	case OpCode::Sqrt:
+		return std::sqrt(a);
+	case OpCode::Exp:
+		return std::exp(a);
+	case OpCode::Log:
+		return std::log(a);
+	case OpCode::Log10:
+		return std::log10(a);
+	case OpCode::Sin:
+		return std::sin(a);
+	case OpCode::Cos:
+		return std::cos(a);
+	case OpCode::Tan:
+		return std::tan(a);
+	default:
+		return a;
+	}
+}
+
+void Expression::evaluate(const vector<const double *> &variables,
+	size_t count, double *result) const
+{
+	if (!is_valid_)
+		return;
+
+	// The stack has a block of values per level
+	vector<double> stack(stack_depth_ * block_size_);
+	for (size_t offset = 0; offset < count; offset += block_size_) {
+		const size_t n = std::min(block_size_, count - offset);
+		size_t depth = 0;
+		for (const auto &instruction : code_) {
+			if (arity(instruction.op) == 0) {
+				double *dest = stack.data() + depth * block_size_;
+				if (instruction.op == OpCode::Constant) {
+					std::fill(dest, dest + n, instruction.value);
+				}
+				else {
+					const double *src = variables[instruction.index] + offset;
+					std::copy(src, src + n, dest);
+				}
+				++depth;
+				continue;
+			}
+
+			double *top = stack.data() + (depth - 1) * block_size_;
+			if (arity(instruction.op) == 1) {
+				if (instruction.op == OpCode::Negate) {
+					for (size_t i = 0; i < n; ++i)
+						top[i] = -top[i];
+				}
+				else {
+					for (size_t i = 0; i < n; ++i)
+						top[i] = apply(instruction.op, top[i], 0.);
+				}
+				continue;
+			}
+
+			// Binary operations store the result in the first operand
+			double *a = top - block_size_;
+			switch (instruction.op) {
+			case OpCode::Add:
+				for (size_t i = 0; i < n; ++i)
+					a[i] += top[i];
+				break;
+			case OpCode::Subtract:
+				for (size_t i = 0; i < n; ++i)
+					a[i] -= top[i];
+				break;
+			case OpCode::Multiply:
+				for (size_t i = 0; i < n; ++i)
+					a[i] *= top[i];
+				break;
+			case OpCode::Divide:
+				for (size_t i = 0; i < n; ++i)
+					a[i] /= top[i];
+				break;
+			default:
+				for (size_t i = 0; i < n; ++i)
+					a[i] = apply(instruction.op, a[i], top[i]);
+				break;
+			}
+			--depth;
+		}
+		std::copy(stack.data(), stack.data() + n, result + offset);
+	}
+}
+
+} // namespace data
+} // namespace sv
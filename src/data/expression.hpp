@@ -0,0 +1,133 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_EXPRESSION_HPP
+#define DATA_EXPRESSION_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+/**
+ * A formula over N variables (v1, v2, ...), e.g. "(v1 - v2) / 0.1 * 1000".
+ *
+ * The formula is compiled once into the bytecode of a stack machine, that
+ * evaluates every instruction over a whole block of samples at once. So the
+ * costs of the interpretation are paid per block and not per sample, and
+ * the inner loops are simple enough to be vectorized by the compiler.
+ *
+ * Supported are numbers, the constants pi and e, the variables v1 to vN,
+ * the operators + - * / ^ (power), parentheses and the functions abs,
+ * sqrt, exp, log, log10, sin, cos, tan, min and max. Subexpressions of
+ * constants are folded at compile time.
+ */
+class Expression
+{
+public:
+	Expression();
+
+	/**
+	 * Compile the formula for variable_count variables.
+	 *
+	 * @return false if the formula is invalid, see error().
+	 */
+	bool compile(const string &formula, size_t variable_count);
+
+	bool is_valid() const;
+	/** The description of the last compile error. */
+	string error() const;
+	string formula() const;
+	size_t variable_count() const;
+
+	/**
+	 * Return the highest variable number, that is used in formula, or 0 if
+	 * no variable is used. The formula isn't validated.
+	 */
+	static size_t max_variable(const string &formula);
+
+	/**
+	 * Evaluate the formula for count samples. variables[i] points to the
+	 * count values of the variable v(i+1).
+	 */
+	void evaluate(const vector<const double *> &variables, size_t count,
+		double *result) const;
+
+private:
+	enum class OpCode {
+		Constant,
+		Variable,
+		Negate,
+		Add,
+		Subtract,
+		Multiply,
+		Divide,
+		Power,
+		Min,
+		Max,
+		Abs,
+		Sqrt,
+		Exp,
+		Log,
+		Log10,
+		Sin,
+		Cos,
+		Tan,
+	};
+
+	struct Instruction
+	{
+		OpCode op;
+		/** The variable index for OpCode::Variable. */
+		size_t index;
+		/** The value for OpCode::Constant. */
+		double value;
+	};
+
+	class Parser;
+
+	/** Return the number of operands of op. */
+	static size_t arity(OpCode op);
+	/** Append an instruction and fold it, if all operands are constants. */
+	void emit(OpCode op, size_t index = 0, double value = 0.);
+	/** Apply op to a constant, see emit(). */
+	static double apply(OpCode op, double a, double b);
+
+	/** The number of samples, that are evaluated at once. */
+	static const size_t block_size_;
+
+	string formula_;
+	size_t variable_count_;
+	vector<Instruction> code_;
+	/** The maximum number of values on the stack. */
+	size_t stack_depth_;
+	bool is_valid_;
+	string error_;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_EXPRESSION_HPP
@@ -0,0 +1,127 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+#include "fft.hpp"
+
+using std::complex;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+FFT::FFT(size_t size) :
+	size_(size),
+	bit_reversed_(size),
+	twiddles_(size / 2),
+	buffer_(size)
+{
+	assert(is_power_of_two(size));
+
+	size_t bits = 0;
+	while (((size_t)1 << bits) < size_)
+		++bits;
+	for (size_t i = 0; i < size_; ++i) {
+		size_t reversed = 0;
+		for (size_t b = 0; b < bits; ++b) {
+			if (i & ((size_t)1 << b))
+				reversed |= (size_t)1 << (bits - 1 - b);
+		}
+		bit_reversed_[i] = reversed;
+	}
+
+	for (size_t i = 0; i < size_ / 2; ++i)
+		twiddles_[i] = std::polar(1., -2. * M_PI * (double)i / (double)size_);
+}
+
+size_t FFT::size() const
+{
+	return size_;
+}
+
+void FFT::transform(complex<double> *data) const
+{
+	for (size_t i = 0; i < size_; ++i) {
+		if (i < bit_reversed_[i])
+			std::swap(data[i], data[bit_reversed_[i]]);
+	}
+
+	for (size_t length = 2; length <= size_; length <<= 1) {
+		const size_t half = length / 2;
+		const size_t twiddle_stride = size_ / length;
+		for (size_t start = 0; start < size_; start += length) {
+			for (size_t k = 0; k < half; ++k) {
+				const complex<double> t =
+					twiddles_[k * twiddle_stride] * data[start + k + half];
+				data[start + k + half] = data[start + k] - t;
+				data[start + k] += t;
+			}
+		}
+	}
+}
+
+void FFT::transform_real(const double *values,
+	vector<complex<double>> &spectrum) const
+{
+	for (size_t i = 0; i < size_; ++i)
+		buffer_[i] = complex<double>(values[i], 0.);
+	transform(buffer_.data());
+	spectrum.assign(buffer_.begin(), buffer_.begin() + size_ / 2 + 1);
+}
+
+bool FFT::is_power_of_two(size_t size)
+{
+	return size > 0 && (size & (size - 1)) == 0;
+}
+
+vector<double> FFT::window(WindowFunction window_function, size_t size)
+{
+	vector<double> coefficients(size, 1.);
+	if (size < 2)
+		return coefficients;
+
+	const double n = (double)(size - 1);
+	for (size_t i = 0; i < size; ++i) {
+		const double x = 2. * M_PI * (double)i / n;
+		switch (window_function) {
+		case WindowFunction::Hann:
+			coefficients[i] = 0.5 - 0.5 * std::cos(x);
+			break;
+		case WindowFunction::Hamming:
+			coefficients[i] = 0.54 - 0.46 * std::cos(x);
+			break;
+		case WindowFunction::BlackmanHarris:
+			coefficients[i] = 0.35875 - 0.48829 * std::cos(x) +
+				0.14128 * std::cos(2. * x) - 0.01168 * std::cos(3. * x);
+			break;
+		case WindowFunction::Rectangular:
+		default:
+			break;
+		}
+	}
+	return coefficients;
+}
+
+} // namespace data
+} // namespace sv
@@ -0,0 +1,88 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_FFT_HPP
+#define DATA_FFT_HPP
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+using std::complex;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+enum class WindowFunction {
+	Rectangular,
+	Hann,
+	Hamming,
+	BlackmanHarris,
+};
+
+/**
+ * An iterative radix-2 fast Fourier transform of a fixed size.
+ *
+ * The bit reversal permutation and the twiddle factors are calculated once
+ * in the ctor, so transforming many blocks of the same size is cheap.
+ */
+class FFT
+{
+public:
+	/**
+	 * @param size The number of points, must be a power of two.
+	 */
+	explicit FFT(size_t size);
+
+	size_t size() const;
+
+	/**
+	 * Transform size() complex values in place (forward, not normalized).
+	 */
+	void transform(complex<double> *data) const;
+
+	/**
+	 * Transform size() real values. The first size() / 2 + 1 bins of the
+	 * spectrum are written to spectrum.
+	 */
+	void transform_real(const double *values,
+		vector<complex<double>> &spectrum) const;
+
+	/** Return true if size is a power of two (and not 0). */
+	static bool is_power_of_two(size_t size);
+
+	/**
+	 * Calculate the coefficients of the window function for a block of
+	 * size values.
+	 */
+	static vector<double> window(WindowFunction window_function, size_t size);
+
+private:
+	const size_t size_;
+	vector<size_t> bit_reversed_;
+	vector<complex<double>> twiddles_;
+	mutable vector<complex<double>> buffer_;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_FFT_HPP
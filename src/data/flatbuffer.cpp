@@ -0,0 +1,205 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "flatbuffer.hpp"
+
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+namespace {
+
+void pad_to(string &buffer, size_t alignment)
+{
+	while (buffer.size() % alignment != 0)
+		buffer.push_back('\0');
+}
+
+template<typename T>
+void append_pod(string &buffer, const T value)
+{
+	buffer.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template<typename T>
+void put_pod(string &buffer, size_t pos, const T value)
+{
+	std::memcpy(&buffer[pos], &value, sizeof(T));
+}
+
+/** Store the offset from pos to target (a uoffset_t) at pos. */
+void put_offset(string &buffer, size_t pos, size_t target)
+{
+	put_pod<uint32_t>(buffer, pos, (uint32_t)(target - pos));
+}
+
+}
+
+FlatObject::FlatObject(Kind kind) :
+	kind_(kind),
+	count_(0),
+	alignment_(1)
+{
+}
+
+shared_ptr<FlatObject> FlatObject::table()
+{
+	return shared_ptr<FlatObject>(new FlatObject(Kind::Table));
+}
+
+shared_ptr<FlatObject> FlatObject::string_object(const string &str)
+{
+	shared_ptr<FlatObject> object(new FlatObject(Kind::String));
+	object->data_ = str;
+	return object;
+}
+
+shared_ptr<FlatObject> FlatObject::vector_object(
+	const vector<shared_ptr<FlatObject>> &elements)
+{
+	shared_ptr<FlatObject> object(new FlatObject(Kind::Vector));
+	object->elements_ = elements;
+	return object;
+}
+
+shared_ptr<FlatObject> FlatObject::struct_vector(
+	const string &data, size_t count, size_t alignment)
+{
+	shared_ptr<FlatObject> object(new FlatObject(Kind::StructVector));
+	object->data_ = data;
+	object->count_ = count;
+	object->alignment_ = alignment < 4 ? 4 : alignment;
+	return object;
+}
+
+void FlatObject::set_object(size_t field, shared_ptr<FlatObject> object)
+{
+	Field &f = table_field(field);
+	f.scalar.clear();
+	f.object = object;
+}
+
+FlatObject::Field &FlatObject::table_field(size_t field)
+{
+	if (fields_.size() <= field)
+		fields_.resize(field + 1);
+	return fields_[field];
+}
+
+string FlatObject::finish() const
+{
+	// The buffer starts with the offset of the root table
+	string buffer(sizeof(uint32_t), '\0');
+	const size_t root = serialize(buffer);
+	put_offset(buffer, 0, root);
+	pad_to(buffer, 8);
+	return buffer;
+}
+
+size_t FlatObject::serialize(string &buffer) const
+{
+	size_t pos;
+	switch (kind_) {
+	case Kind::String:
+		pad_to(buffer, 4);
+		pos = buffer.size();
+		append_pod<uint32_t>(buffer, (uint32_t)data_.size());
+		buffer.append(data_);
+		buffer.push_back('\0');
+		return pos;
+
+	case Kind::StructVector:
+		// The structs follow the length, they must be aligned
+		pad_to(buffer, 4);
+		while ((buffer.size() + sizeof(uint32_t)) % alignment_ != 0)
+			append_pod<uint32_t>(buffer, 0);
+		pos = buffer.size();
+		append_pod<uint32_t>(buffer, (uint32_t)count_);
+		buffer.append(data_);
+		return pos;
+
+	case Kind::Vector:
+		pad_to(buffer, 4);
+		pos = buffer.size();
+		append_pod<uint32_t>(buffer, (uint32_t)elements_.size());
+		buffer.append(elements_.size() * sizeof(uint32_t), '\0');
+		for (size_t i = 0; i < elements_.size(); ++i) {
+			const size_t target = elements_[i]->serialize(buffer);
+			put_offset(buffer, pos + sizeof(uint32_t) * (i + 1), target);
+		}
+		return pos;
+
+	case Kind::Table:
+	default:
+		break;
+	}
+
+	// The vtable is written in front of the table: Its size, the size of
+	// the table and the offsets of the fields in the table (0 if not set).
+	pad_to(buffer, 2);
+	const size_t vtable = buffer.size();
+	const size_t vtable_size = sizeof(uint16_t) * (2 + fields_.size());
+	buffer.append(vtable_size, '\0');
+
+	pad_to(buffer, 4);
+	pos = buffer.size();
+	append_pod<int32_t>(buffer, (int32_t)(pos - vtable));
+	vector<size_t> field_pos(fields_.size(), 0);
+	for (size_t i = 0; i < fields_.size(); ++i) {
+		const Field &field = fields_[i];
+		if (field.object) {
+			pad_to(buffer, sizeof(uint32_t));
+			field_pos[i] = buffer.size();
+			append_pod<uint32_t>(buffer, 0);
+		}
+		else if (!field.scalar.empty()) {
+			pad_to(buffer, field.scalar.size());
+			field_pos[i] = buffer.size();
+			buffer.append(field.scalar);
+		}
+	}
+
+	put_pod<uint16_t>(buffer, vtable, (uint16_t)vtable_size);
+	put_pod<uint16_t>(buffer, vtable + 2, (uint16_t)(buffer.size() - pos));
+	for (size_t i = 0; i < fields_.size(); ++i) {
+		if (field_pos[i] > 0) {
+			put_pod<uint16_t>(buffer, vtable + sizeof(uint16_t) * (2 + i),
+				(uint16_t)(field_pos[i] - pos));
+		}
+	}
+
+	// The referenced objects follow the table
+	for (size_t i = 0; i < fields_.size(); ++i) {
+		if (fields_[i].object)
+			put_offset(buffer, field_pos[i], fields_[i].object->serialize(buffer));
+	}
+	return pos;
+}
+
+} // namespace data
+} // namespace sv
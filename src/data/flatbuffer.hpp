@@ -0,0 +1,118 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_FLATBUFFER_HPP
+#define DATA_FLATBUFFER_HPP
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+/**
+ * A minimal FlatBuffers serializer, e.g. for the metadata of Arrow IPC
+ * files, so no FlatBuffers compiler and library are needed.
+ *
+ * A tree of tables, strings and vectors is built and then serialized at
+ * once by finish(). Unlike the builder of the FlatBuffers library, the
+ * buffer is written front to back: A table is written before the objects
+ * it references, the offsets are patched afterwards. All scalars are
+ * aligned to their size, relative to the start of the buffer.
+ */
+class FlatObject
+{
+public:
+	static shared_ptr<FlatObject> table();
+	static shared_ptr<FlatObject> string_object(const string &str);
+	/** A vector of tables or strings. */
+	static shared_ptr<FlatObject> vector_object(
+		const vector<shared_ptr<FlatObject>> &elements);
+	/**
+	 * A vector of count structs, that are already serialized to data.
+	 *
+	 * @param alignment The alignment of the biggest member of the struct.
+	 */
+	static shared_ptr<FlatObject> struct_vector(
+		const string &data, size_t count, size_t alignment);
+
+	/** Set the scalar field with the given id of a table. */
+	template<typename T>
+	void set_scalar(size_t field, T value)
+	{
+		Field &f = table_field(field);
+		f.scalar.assign(reinterpret_cast<const char *>(&value), sizeof(T));
+		f.object = nullptr;
+	}
+
+	/** Set the table, string, vector or union field of a table. */
+	void set_object(size_t field, shared_ptr<FlatObject> object);
+
+	/**
+	 * Serialize the tree with this object as root. The size of the buffer
+	 * is a multiple of 8.
+	 */
+	string finish() const;
+
+private:
+	enum class Kind
+	{
+		Table,
+		String,
+		Vector,
+		StructVector
+	};
+
+	struct Field
+	{
+		/** The value of a scalar field, empty if not set. */
+		string scalar;
+		/** The object of an offset field. */
+		shared_ptr<FlatObject> object;
+	};
+
+	explicit FlatObject(Kind kind);
+
+	Field &table_field(size_t field);
+	/** Append the object and its children, return its position. */
+	size_t serialize(string &buffer) const;
+
+	const Kind kind_;
+	/** The fields of a table, indexed by their id. */
+	vector<Field> fields_;
+	/** The elements of a vector. */
+	vector<shared_ptr<FlatObject>> elements_;
+	/** The characters of a string or the data of a struct vector. */
+	string data_;
+	size_t count_;
+	size_t alignment_;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_FLATBUFFER_HPP
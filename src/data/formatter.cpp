@@ -0,0 +1,251 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include <QDateTime>
+
+#include "formatter.hpp"
+
+namespace sv {
+namespace data {
+
+namespace {
+
+// Up to 10^15 the scaled values and their fractions are exact in a double
+const int max_fast_decimal_places = 15;
+const double max_fast_scaled_value = 1e15;
+
+const double pow10_table[max_fast_decimal_places + 1] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7,
+	1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+};
+
+const char date_format[] = "yyyy.MM.dd hh:mm:ss";
+
+/**
+ * snprintf() uses the decimal point of the C locale, which is not
+ * necessarily '.', if the locale was changed with setlocale().
+ */
+void fix_decimal_point(char *buffer, size_t length)
+{
+	for (size_t i = 0; i < length; ++i) {
+		const char c = buffer[i];
+		if ((c < '0' || c > '9') && c != '-' && c != '+' && c != 'e' &&
+				c != 'n' && c != 'a' && c != 'i' && c != 'f')
+			buffer[i] = '.';
+	}
+}
+
+size_t snprintf_length(int length)
+{
+	if (length <= 0)
+		return 0;
+	return (size_t)length < Formatter::buffer_size ?
+		(size_t)length : Formatter::buffer_size - 1;
+}
+
+size_t format_fixed_slow(char *buffer, double value, int decimal_places)
+{
+	// Clamp the precision, so the result always fits into the buffer
+	const int precision = decimal_places < 30 ? decimal_places : 30;
+	const size_t length = snprintf_length(std::snprintf(
+		buffer, Formatter::buffer_size, "%.*f", precision, value));
+	fix_decimal_point(buffer, length);
+	return length;
+}
+
+} // namespace
+
+Formatter::Formatter() :
+	decimal_point_('.'),
+	group_separator_(','),
+	minus_sign_('-'),
+	use_group_separator_(false),
+	date_second_(-1)
+{
+}
+
+Formatter::Formatter(const QLocale &locale) :
+	decimal_point_(locale.decimalPoint()),
+	group_separator_(locale.groupSeparator()),
+	minus_sign_(locale.negativeSign()),
+	use_group_separator_(
+		!(locale.numberOptions() & QLocale::OmitGroupSeparator)),
+	date_second_(-1)
+{
+}
+
+size_t Formatter::format_fixed(char *buffer, double value, int decimal_places)
+{
+	if (decimal_places < 0)
+		decimal_places = 6;
+
+	const double abs_value = std::fabs(value);
+	if (!std::isfinite(value) || decimal_places > max_fast_decimal_places ||
+			abs_value * pow10_table[decimal_places] >= max_fast_scaled_value)
+		return format_fixed_slow(buffer, value, decimal_places);
+
+	const double scaled = abs_value * pow10_table[decimal_places];
+	const double integral = std::floor(scaled);
+	const double fraction = scaled - integral;
+	// The multiplication might have rounded the value to (or across) a tie.
+	// printf() rounds the exact binary value, so let it decide.
+	if (std::fabs(fraction - 0.5) <= scaled * 4e-16)
+		return format_fixed_slow(buffer, value, decimal_places);
+	uint64_t digits = (uint64_t)integral;
+	if (fraction > 0.5)
+		++digits;
+
+	// The digits in reverse order, with at least one digit before the point
+	char reversed[24];
+	size_t count = 0;
+	do {
+		reversed[count++] = (char)('0' + digits % 10);
+		digits /= 10;
+	} while (digits != 0 || count <= (size_t)decimal_places);
+
+	size_t length = 0;
+	if (std::signbit(value))
+		buffer[length++] = '-';
+	for (size_t i = count; i > (size_t)decimal_places; --i)
+		buffer[length++] = reversed[i - 1];
+	if (decimal_places > 0) {
+		buffer[length++] = '.';
+		for (size_t i = (size_t)decimal_places; i > 0; --i)
+			buffer[length++] = reversed[i - 1];
+	}
+	buffer[length] = '\0';
+	return length;
+}
+
+size_t Formatter::format_general(char *buffer, double value)
+{
+	const size_t length = snprintf_length(
+		std::snprintf(buffer, buffer_size, "%g", value));
+	fix_decimal_point(buffer, length);
+	return length;
+}
+
+void Formatter::append_fixed(string &str, double value, int decimal_places)
+{
+	char buffer[buffer_size];
+	str.append(buffer, format_fixed(buffer, value, decimal_places));
+}
+
+void Formatter::append_general(string &str, double value)
+{
+	char buffer[buffer_size];
+	str.append(buffer, format_general(buffer, value));
+}
+
+void Formatter::append_date_time(string &str, double timestamp)
+{
+	const long long msecs = (long long)(timestamp * 1000);
+	if (msecs < 0) {
+		// The modulo below doesn't work before the epoch, this is rare
+		str += QDateTime::fromMSecsSinceEpoch(msecs).
+			toString(QString(date_format) + ".zzz").toStdString();
+		return;
+	}
+
+	const long long second = msecs / 1000;
+	if (second != date_second_) {
+		date_second_ = second;
+		date_prefix_ = QDateTime::fromMSecsSinceEpoch(second * 1000).
+			toString(date_format).toStdString();
+		date_prefix_ += '.';
+	}
+	str += date_prefix_;
+
+	const int millis = (int)(msecs % 1000);
+	const char digits[3] = {
+		(char)('0' + millis / 100),
+		(char)('0' + millis / 10 % 10),
+		(char)('0' + millis % 10),
+	};
+	str.append(digits, 3);
+}
+
+QString Formatter::format_fixed(double value, int width,
+	int decimal_places) const
+{
+	char buffer[buffer_size];
+	const size_t length = format_fixed(buffer, value, decimal_places);
+	return localize(buffer, length, width);
+}
+
+QString Formatter::format_general(double value) const
+{
+	char buffer[buffer_size];
+	const size_t length = format_general(buffer, value);
+	return localize(buffer, length, 0);
+}
+
+QString Formatter::format_date_time(double timestamp)
+{
+	date_str_.clear();
+	append_date_time(date_str_, timestamp);
+	return QString::fromStdString(date_str_);
+}
+
+QString Formatter::localize(const char *buffer, size_t length,
+	int width) const
+{
+	// The integer digits are the digits in front of the point or exponent
+	size_t int_begin = 0;
+	while (int_begin < length && (buffer[int_begin] < '0' ||
+			buffer[int_begin] > '9'))
+		++int_begin;
+	size_t int_end = int_begin;
+	while (int_end < length && buffer[int_end] >= '0' &&
+			buffer[int_end] <= '9')
+		++int_end;
+
+	const size_t int_digits = int_end - int_begin;
+	const size_t separators = use_group_separator_ && int_digits > 3 ?
+		(int_digits - 1) / 3 : 0;
+	const int size = (int)(length + separators);
+	const int padding = width > size ? width - size : 0;
+
+	QString str;
+	str.reserve(padding + size);
+	str.fill(' ', padding);
+	for (size_t i = 0; i < length; ++i) {
+		const char c = buffer[i];
+		if (c == '.')
+			str.append(decimal_point_);
+		else if (c == '-')
+			str.append(minus_sign_);
+		else
+			str.append(QLatin1Char(c));
+
+		// Insert a separator after each group of 3 integer digits
+		if (separators > 0 && i >= int_begin && i + 1 < int_end &&
+				(int_end - i - 1) % 3 == 0)
+			str.append(group_separator_);
+	}
+	return str;
+}
+
+} // namespace data
+} // namespace sv
@@ -0,0 +1,116 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_FORMATTER_HPP
+#define DATA_FORMATTER_HPP
+
+#include <cstddef>
+#include <string>
+
+#include <QChar>
+#include <QLocale>
+#include <QString>
+
+using std::string;
+
+namespace sv {
+namespace data {
+
+/**
+ * Fast formatting of timestamps and numbers, shared by the exporters and the
+ * UI (data table, value displays and plot markers).
+ *
+ * Fixed point numbers are converted with integer arithmetic directly into a
+ * char buffer, instead of going through QString::arg(), QTextStream or
+ * snprintf(). The date prefix of a timestamp is only formatted once per
+ * second and the milliseconds are appended directly.
+ *
+ * The static functions always use the C locale. A Formatter instance uses
+ * (and caches) the decimal point, group separator and minus sign of a
+ * locale for the QString functions. An instance is not thread safe, because
+ * of the date cache.
+ */
+class Formatter
+{
+public:
+	/** Use the C locale, e.g. for exported files. */
+	Formatter();
+	/** Use the number format of the given locale, e.g. QLocale(). */
+	explicit Formatter(const QLocale &locale);
+
+	/** Enough for any fixed or general number, including the sign. */
+	static const size_t buffer_size = 352;
+
+	/**
+	 * Write a value with decimal_places to buffer, like "%.*f" does. A
+	 * negative decimal_places means 6, like in QString::number().
+	 *
+	 * @return The length of the string, without the terminating zero.
+	 */
+	static size_t format_fixed(char *buffer, double value, int decimal_places);
+
+	/**
+	 * Write a value with 6 significant digits to buffer, like "%g" does.
+	 *
+	 * @return The length of the string, without the terminating zero.
+	 */
+	static size_t format_general(char *buffer, double value);
+
+	static void append_fixed(string &str, double value, int decimal_places);
+	static void append_general(string &str, double value);
+
+	/**
+	 * Append the timestamp (seconds since the epoch) in local time with the
+	 * "yyyy.MM.dd hh:mm:ss.zzz" format, like util::format_time_date().
+	 */
+	void append_date_time(string &str, double timestamp);
+
+	/**
+	 * Same as QString("%L1").arg(value, width, 'f', decimal_places, ' ')
+	 * for the locale of this formatter.
+	 */
+	QString format_fixed(double value, int width, int decimal_places) const;
+
+	/**
+	 * Same as QString("%L1").arg(value) for the locale of this formatter.
+	 */
+	QString format_general(double value) const;
+
+	/** Same as util::format_time_date(). */
+	QString format_date_time(double timestamp);
+
+private:
+	/** Convert the C locale number in buffer to a localized QString. */
+	QString localize(const char *buffer, size_t length, int width) const;
+
+	QChar decimal_point_;
+	QChar group_separator_;
+	QChar minus_sign_;
+	bool use_group_separator_;
+	/** The second of date_prefix_, -1 if not set. */
+	long long date_second_;
+	string date_prefix_;
+	string date_str_;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_FORMATTER_HPP
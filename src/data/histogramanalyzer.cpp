@@ -0,0 +1,123 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "histogramanalyzer.hpp"
+#include "src/data/analogbasesignal.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/samplebus.hpp"
+#include "src/data/valuehistogram.hpp"
+
+using std::lock_guard;
+using std::mutex;
+
+namespace sv {
+namespace data {
+
+const size_t HistogramAnalyzer::read_block_size_ = 4096;
+
+HistogramAnalyzer::HistogramAnalyzer(shared_ptr<AnalogTimeSignal> signal,
+		size_t bin_count) :
+	QObject(),
+	signal_(signal),
+	next_signal_pos_(0),
+	block_values_(read_block_size_),
+	histogram_(bin_count)
+{
+	assert(signal_);
+
+	signal_->add_observer();
+	subscriptions_.push_back(signal_->subscribe_samples(
+		[this](size_t, size_t) { on_samples_appended(); },
+		[this]() { on_samples_cleared(); }, SampleExecutor::Context, this));
+}
+
+HistogramAnalyzer::~HistogramAnalyzer()
+{
+	signal_->remove_observer();
+}
+
+shared_ptr<AnalogTimeSignal> HistogramAnalyzer::signal() const
+{
+	return signal_;
+}
+
+size_t HistogramAnalyzer::bin_count() const
+{
+	return histogram_.bin_count();
+}
+
+void HistogramAnalyzer::histogram(ValueHistogram &histogram) const
+{
+	lock_guard<mutex> lock(mutex_);
+	histogram = histogram_;
+}
+
+void HistogramAnalyzer::on_samples_appended()
+{
+	bool updated = false;
+	while (true) {
+		// Dropped samples are simply not counted
+		next_signal_pos_ = std::max(next_signal_pos_,
+			signal_->first_sample_pos());
+
+		const size_t count = signal_->copy_samples(next_signal_pos_,
+			read_block_size_, false, nullptr, block_values_.data());
+		if (count == 0)
+			break;
+		next_signal_pos_ += count;
+
+		lock_guard<mutex> lock(mutex_);
+		histogram_.add(block_values_.data(), count);
+		updated = true;
+	}
+
+	if (updated)
+		Q_EMIT histogram_updated();
+}
+
+void HistogramAnalyzer::reset()
+{
+	next_signal_pos_ = std::max(signal_->sample_count(),
+		signal_->first_sample_pos());
+	{
+		lock_guard<mutex> lock(mutex_);
+		histogram_.clear();
+	}
+	Q_EMIT histogram_updated();
+}
+
+void HistogramAnalyzer::on_samples_cleared()
+{
+	next_signal_pos_ = 0;
+	{
+		lock_guard<mutex> lock(mutex_);
+		histogram_.clear();
+	}
+	Q_EMIT histogram_updated();
+}
+
+} // namespace data
+} // namespace sv
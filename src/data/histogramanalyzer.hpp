@@ -0,0 +1,96 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_HISTOGRAMANALYZER_HPP
+#define DATA_HISTOGRAMANALYZER_HPP
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <QObject>
+
+#include "src/data/samplebus.hpp"
+#include "src/data/valuehistogram.hpp"
+
+using std::shared_ptr;
+using std::unique_ptr;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+class AnalogTimeSignal;
+
+/**
+ * Counts the values of an analog signal in a ValueHistogram, incrementally
+ * from the appended samples. Only the new samples of a batch are read, so
+ * an update costs O(new samples), even after days of acquisition.
+ *
+ * The analyzer can be moved to a worker thread (see WorkerPool), the
+ * histogram can be read from any thread.
+ */
+class HistogramAnalyzer : public QObject
+{
+	Q_OBJECT
+
+public:
+	HistogramAnalyzer(shared_ptr<AnalogTimeSignal> signal, size_t bin_count);
+	~HistogramAnalyzer();
+
+	shared_ptr<AnalogTimeSignal> signal() const;
+	size_t bin_count() const;
+
+	/** Copy the current histogram. */
+	void histogram(ValueHistogram &histogram) const;
+
+public Q_SLOTS:
+	/**
+	 * Count the samples, that were appended since the last call. This is
+	 * also called for the samples, that are already in the signal.
+	 */
+	void on_samples_appended();
+	/** Start a new histogram with the samples from now on. */
+	void reset();
+
+private:
+	static const size_t read_block_size_;
+
+	shared_ptr<AnalogTimeSignal> signal_;
+	size_t next_signal_pos_;
+	vector<double> block_values_;
+
+	mutable std::mutex mutex_;
+	ValueHistogram histogram_;
+	vector<unique_ptr<SampleBusSubscription>> subscriptions_;
+
+private Q_SLOTS:
+	void on_samples_cleared();
+
+Q_SIGNALS:
+	/** New values were counted. */
+	void histogram_updated();
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_HISTOGRAMANALYZER_HPP
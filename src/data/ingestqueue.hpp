@@ -0,0 +1,181 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_INGESTQUEUE_HPP
+#define DATA_INGESTQUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+using std::unique_ptr;
+
+namespace sv {
+namespace data {
+
+/**
+ * A bounded lock-free queue, that passes elements from any number of
+ * producers to one consumer, e.g. sample batches from the datafeed callback
+ * of a device to the thread, that stores them in the signals.
+ *
+ * The queue never blocks. When it is full, try_push() fails and the
+ * rejection is counted, so the producer can decide how to handle the
+ * backpressure. Every cell carries a sequence number, that tells the
+ * producers and the consumer, whether the cell is free or filled in the
+ * current round (see Dmitry Vyukov's bounded MPMC queue).
+ */
+template<typename T>
+class IngestQueue
+{
+public:
+	/**
+	 * @param capacity_exp The queue holds 2^capacity_exp elements.
+	 */
+	explicit IngestQueue(unsigned int capacity_exp) :
+		capacity_((size_t)1 << capacity_exp),
+		mask_(capacity_ - 1),
+		cells_(new Cell[capacity_]),
+		enqueue_pos_(0),
+		dequeue_pos_(0),
+		pushed_count_(0),
+		rejected_count_(0),
+		high_water_(0)
+	{
+		for (size_t i = 0; i < capacity_; ++i)
+			cells_[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	IngestQueue(const IngestQueue &) = delete;
+	IngestQueue &operator=(const IngestQueue &) = delete;
+
+	size_t capacity() const { return capacity_; }
+
+	/** Return the number of queued elements. Only a snapshot. */
+	size_t size() const
+	{
+		const size_t dequeue = dequeue_pos_.load(std::memory_order_acquire);
+		const size_t enqueue = enqueue_pos_.load(std::memory_order_acquire);
+		return enqueue > dequeue ? enqueue - dequeue : 0;
+	}
+
+	bool empty() const { return size() == 0; }
+
+	/**
+	 * Append value to the queue. Returns false if the queue is full.
+	 */
+	bool try_push(const T &value)
+	{
+		size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+		Cell *cell;
+		while (true) {
+			cell = &cells_[pos & mask_];
+			const size_t sequence =
+				cell->sequence.load(std::memory_order_acquire);
+			const intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+			if (diff == 0) {
+				// The cell is free, try to claim it
+				if (enqueue_pos_.compare_exchange_weak(
+						pos, pos + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if (diff < 0) {
+				// The cell still holds an element of the previous round
+				rejected_count_.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+			else {
+				pos = enqueue_pos_.load(std::memory_order_relaxed);
+			}
+		}
+
+		cell->value = value;
+		cell->sequence.store(pos + 1, std::memory_order_release);
+		pushed_count_.fetch_add(1, std::memory_order_relaxed);
+
+		// Track the maximum fill level
+		const size_t fill =
+			pos + 1 - dequeue_pos_.load(std::memory_order_relaxed);
+		size_t high_water = high_water_.load(std::memory_order_relaxed);
+		while (fill > high_water && !high_water_.compare_exchange_weak(
+				high_water, fill, std::memory_order_relaxed)) {
+		}
+		return true;
+	}
+
+	/**
+	 * Remove the oldest element from the queue. Returns false if the queue
+	 * is empty. There must only be one consumer.
+	 */
+	bool try_pop(T &value)
+	{
+		const size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+		Cell &cell = cells_[pos & mask_];
+		const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+		if (sequence != pos + 1)
+			return false;
+
+		value = cell.value;
+		dequeue_pos_.store(pos + 1, std::memory_order_release);
+		// Free the cell for the next round
+		cell.sequence.store(pos + capacity_, std::memory_order_release);
+		return true;
+	}
+
+	/** Return the number of elements, that were pushed. */
+	uint64_t pushed_count() const
+	{
+		return pushed_count_.load(std::memory_order_relaxed);
+	}
+
+	/** Return the number of elements, that were rejected by a full queue. */
+	uint64_t rejected_count() const
+	{
+		return rejected_count_.load(std::memory_order_relaxed);
+	}
+
+	/** Return the maximum number of queued elements so far. */
+	size_t high_water() const
+	{
+		return high_water_.load(std::memory_order_relaxed);
+	}
+
+private:
+	struct Cell
+	{
+		std::atomic<size_t> sequence;
+		T value;
+	};
+
+	const size_t capacity_;
+	const size_t mask_;
+	unique_ptr<Cell[]> cells_;
+	/** The producers and the consumer work on different cache lines. */
+	alignas(64) std::atomic<size_t> enqueue_pos_;
+	alignas(64) std::atomic<size_t> dequeue_pos_;
+	alignas(64) std::atomic<uint64_t> pushed_count_;
+	std::atomic<uint64_t> rejected_count_;
+	std::atomic<size_t> high_water_;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_INGESTQUEUE_HPP
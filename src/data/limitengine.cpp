@@ -0,0 +1,443 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <QDebug>
+
+#include "limitengine.hpp"
+#include "src/data/analogbasesignal.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/samplebus.hpp"
+
+using std::lock_guard;
+using std::mutex;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+namespace {
+
+const double nan = std::numeric_limits<double>::quiet_NaN();
+
+}
+
+const size_t LimitEngine::read_block_size_ = 256;
+
+LimitEngine::LimitEngine(shared_ptr<AnalogTimeSignal> signal,
+		size_t max_step_count) :
+	QObject(),
+	signal_(signal),
+	max_step_count_(std::max(max_step_count, (size_t)1)),
+	next_signal_pos_(0),
+	block_timestamps_(read_block_size_),
+	block_values_(read_block_size_),
+	next_rule_id_(1),
+	first_step_pos_(0),
+	step_running_(false)
+{
+	assert(signal_);
+
+	// Only the samples from now on are checked
+	next_signal_pos_ = signal_->sample_count();
+
+	signal_->add_observer();
+	signal_->set_observer_history(this, 0.);
+	subscriptions_.push_back(signal_->subscribe_samples(
+		[this](size_t, size_t) { on_samples_appended(); },
+		[this]() { on_samples_cleared(); }, SampleExecutor::Context, this));
+}
+
+LimitEngine::~LimitEngine()
+{
+	signal_->clear_observer_history(this);
+	signal_->remove_observer();
+}
+
+shared_ptr<AnalogTimeSignal> LimitEngine::signal() const
+{
+	return signal_;
+}
+
+size_t LimitEngine::add_limit_rule(double low, double high,
+	const string &name)
+{
+	Rule rule{};
+	rule.name = name;
+	rule.type = LimitRuleType::Limits;
+	rule.low = std::min(low, high);
+	rule.high = std::max(low, high);
+	return add_rule(rule);
+}
+
+size_t LimitEngine::add_tolerance_rule(double nominal, double tolerance,
+	bool relative, const string &name)
+{
+	if (relative)
+		tolerance *= nominal;
+	tolerance = std::abs(tolerance);
+
+	Rule rule{};
+	rule.name = name;
+	rule.type = LimitRuleType::Tolerance;
+	rule.low = nominal - tolerance;
+	rule.high = nominal + tolerance;
+	return add_rule(rule);
+}
+
+size_t LimitEngine::add_mask_rule(vector<LimitMaskPoint> mask,
+	const string &name)
+{
+	if (mask.empty()) {
+		qWarning() << "LimitEngine::add_mask_rule(): The mask has no points";
+		return 0;
+	}
+
+	std::stable_sort(mask.begin(), mask.end(),
+		[](const LimitMaskPoint &a, const LimitMaskPoint &b) {
+			return a.time < b.time;
+		});
+	for (auto &point : mask) {
+		if (point.low > point.high)
+			std::swap(point.low, point.high);
+	}
+
+	Rule rule{};
+	rule.name = name;
+	rule.type = LimitRuleType::Mask;
+	rule.mask = mask;
+	return add_rule(rule);
+}
+
+size_t LimitEngine::add_rule(Rule rule)
+{
+	lock_guard<mutex> lock(mutex_);
+	rule.id = next_rule_id_++;
+	if (rule.name.empty())
+		rule.name = "Rule " + std::to_string(rule.id);
+	rules_.push_back(rule);
+	// A rule, that is added to a running step, checks its remaining samples
+	if (step_running_)
+		add_rule_result(rules_.back());
+	return rule.id;
+}
+
+void LimitEngine::add_rule_result(Rule &rule)
+{
+	LimitStepResult &step = steps_.back();
+	rule.result_index = step.rules.size();
+	step.rules.push_back(LimitRuleResult{ rule.id, rule.name, 0, 0,
+		nan, nan, nan, nan, false });
+}
+
+bool LimitEngine::remove_rule(size_t rule_id)
+{
+	lock_guard<mutex> lock(mutex_);
+	auto it = std::find_if(rules_.begin(), rules_.end(),
+		[rule_id](const Rule &rule) { return rule.id == rule_id; });
+	if (it == rules_.end())
+		return false;
+
+	// The result of the running step stays, with the samples so far
+	rules_.erase(it);
+	return true;
+}
+
+void LimitEngine::begin_step(const string &name)
+{
+	size_t finished_pos = 0;
+	bool finished = false;
+	{
+		lock_guard<mutex> lock(mutex_);
+		process_samples();
+		if (step_running_) {
+			finish_step();
+			finished_pos = first_step_pos_ + steps_.size() - 1;
+			finished = true;
+		}
+
+		steps_.push_back(LimitStepResult{ name, nan, nan, false, false,
+			vector<LimitRuleResult>() });
+		for (auto &rule : rules_)
+			add_rule_result(rule);
+		step_running_ = true;
+
+		if (steps_.size() > max_step_count_) {
+			steps_.pop_front();
+			++first_step_pos_;
+		}
+	}
+
+	if (finished)
+		Q_EMIT step_finished(finished_pos);
+	Q_EMIT results_changed();
+}
+
+LimitStepResult LimitEngine::end_step()
+{
+	LimitStepResult result{ "", nan, nan, false, false,
+		vector<LimitRuleResult>() };
+	size_t finished_pos;
+	{
+		lock_guard<mutex> lock(mutex_);
+		if (!step_running_)
+			return result;
+
+		process_samples();
+		finish_step();
+		result = steps_.back();
+		finished_pos = first_step_pos_ + steps_.size() - 1;
+	}
+
+	Q_EMIT step_finished(finished_pos);
+	Q_EMIT results_changed();
+	return result;
+}
+
+bool LimitEngine::is_step_running() const
+{
+	lock_guard<mutex> lock(mutex_);
+	return step_running_;
+}
+
+size_t LimitEngine::first_step_pos() const
+{
+	lock_guard<mutex> lock(mutex_);
+	return first_step_pos_;
+}
+
+size_t LimitEngine::step_count() const
+{
+	lock_guard<mutex> lock(mutex_);
+	return first_step_pos_ + steps_.size();
+}
+
+vector<LimitStepResult> LimitEngine::results(size_t first) const
+{
+	lock_guard<mutex> lock(mutex_);
+	first = std::max(first, first_step_pos_);
+	const size_t end = first_step_pos_ + steps_.size();
+	if (first >= end)
+		return vector<LimitStepResult>();
+
+	return vector<LimitStepResult>(
+		steps_.begin() + (first - first_step_pos_), steps_.end());
+}
+
+bool LimitEngine::passed() const
+{
+	lock_guard<mutex> lock(mutex_);
+	bool has_finished_step = false;
+	for (const auto &step : steps_) {
+		if (!step.finished)
+			continue;
+		if (!step.passed)
+			return false;
+		has_finished_step = true;
+	}
+	return has_finished_step;
+}
+
+string LimitEngine::report() const
+{
+	const vector<LimitStepResult> steps = results();
+
+	std::ostringstream report;
+	size_t finished_count = 0;
+	size_t passed_count = 0;
+	for (const auto &step : steps) {
+		if (step.finished) {
+			++finished_count;
+			if (step.passed)
+				++passed_count;
+		}
+		report << "Step \"" << step.name << "\": " <<
+			(!step.finished ? "RUNNING" : step.passed ? "PASS" : "FAIL") <<
+			"\n";
+		for (const auto &rule : step.rules) {
+			report << "  " << rule.name << ": " <<
+				(!step.finished ? "RUNNING" : rule.passed ? "PASS" : "FAIL") <<
+				", " <<
+				rule.sample_count << " samples, " <<
+				rule.failure_count << " failures";
+			if (rule.sample_count > 0)
+				report << ", min " << rule.min << ", max " << rule.max;
+			if (rule.failure_count > 0) {
+				report << ", first failure " << rule.first_failure_value <<
+					" at " << rule.first_failure_timestamp;
+			}
+			report << "\n";
+		}
+	}
+	report << passed_count << " of " << finished_count << " steps passed\n";
+	return report.str();
+}
+
+void LimitEngine::clear_results()
+{
+	{
+		lock_guard<mutex> lock(mutex_);
+		// The running step is kept
+		const size_t finished_count = step_running_ ?
+			steps_.size() - 1 : steps_.size();
+		steps_.erase(steps_.begin(), steps_.begin() + finished_count);
+		first_step_pos_ += finished_count;
+	}
+	Q_EMIT results_changed();
+}
+
+void LimitEngine::process_samples()
+{
+	// Skip samples, that were already dropped by the retention policy
+	if (next_signal_pos_ < signal_->first_sample_pos())
+		next_signal_pos_ = signal_->first_sample_pos();
+
+	// The samples between the steps are not checked
+	if (!step_running_) {
+		next_signal_pos_ = std::max(next_signal_pos_, signal_->sample_count());
+		return;
+	}
+
+	while (true) {
+		const size_t count = signal_->copy_samples(next_signal_pos_,
+			read_block_size_, false,
+			block_timestamps_.data(), block_values_.data());
+		if (count == 0)
+			break;
+
+		for (size_t i = 0; i < count; ++i) {
+			if (std::isnan(block_values_[i]))
+				continue;
+			evaluate(block_timestamps_[i], block_values_[i]);
+		}
+		next_signal_pos_ += count;
+	}
+}
+
+void LimitEngine::evaluate(double timestamp, double value)
+{
+	LimitStepResult &step = steps_.back();
+	if (std::isnan(step.start_timestamp))
+		step.start_timestamp = timestamp;
+	step.end_timestamp = timestamp;
+
+	double low;
+	double high;
+	for (const auto &rule : rules_) {
+		if (!get_limits(rule, timestamp, low, high))
+			continue;
+
+		LimitRuleResult &result = step.rules[rule.result_index];
+		if (result.sample_count == 0) {
+			result.min = value;
+			result.max = value;
+		}
+		else {
+			result.min = std::min(result.min, value);
+			result.max = std::max(result.max, value);
+		}
+		++result.sample_count;
+
+		if (value < low || value > high) {
+			if (result.failure_count == 0) {
+				result.first_failure_timestamp = timestamp;
+				result.first_failure_value = value;
+			}
+			++result.failure_count;
+		}
+	}
+}
+
+bool LimitEngine::get_limits(const Rule &rule, double timestamp,
+	double &low, double &high) const
+{
+	if (rule.type != LimitRuleType::Mask) {
+		low = rule.low;
+		high = rule.high;
+		return true;
+	}
+
+	const double time = timestamp - steps_.back().start_timestamp;
+	const vector<LimitMaskPoint> &mask = rule.mask;
+	if (time < mask.front().time || time > mask.back().time)
+		return false;
+
+	// The first point behind the time, the band is interpolated from the
+	// point before.
+	auto it = std::upper_bound(mask.begin(), mask.end(), time,
+		[](double t, const LimitMaskPoint &point) { return t < point.time; });
+	if (it == mask.end()) {
+		low = mask.back().low;
+		high = mask.back().high;
+		return true;
+	}
+	const LimitMaskPoint &p2 = *it;
+	const LimitMaskPoint &p1 = *(it - 1);
+	const double f = p2.time > p1.time ?
+		(time - p1.time) / (p2.time - p1.time) : 1.;
+	low = p1.low + f * (p2.low - p1.low);
+	high = p1.high + f * (p2.high - p1.high);
+	return true;
+}
+
+void LimitEngine::finish_step()
+{
+	LimitStepResult &step = steps_.back();
+	step.passed = !step.rules.empty();
+	for (auto &result : step.rules) {
+		result.passed = result.sample_count > 0 && result.failure_count == 0;
+		if (!result.passed)
+			step.passed = false;
+	}
+	step.finished = true;
+	step_running_ = false;
+}
+
+void LimitEngine::on_samples_appended()
+{
+	bool running;
+	{
+		lock_guard<mutex> lock(mutex_);
+		process_samples();
+		running = step_running_;
+	}
+
+	if (running)
+		Q_EMIT results_changed();
+}
+
+void LimitEngine::on_samples_cleared()
+{
+	lock_guard<mutex> lock(mutex_);
+	next_signal_pos_ = 0;
+}
+
+} // namespace data
+} // namespace sv
@@ -0,0 +1,271 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_LIMITENGINE_HPP
+#define DATA_LIMITENGINE_HPP
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <QObject>
+
+#include "src/data/samplebus.hpp"
+
+using std::deque;
+using std::shared_ptr;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+class AnalogTimeSignal;
+
+enum class LimitRuleType {
+	/** The value must be inside [low, high]. */
+	Limits,
+	/** The value must be inside nominal +/- tolerance. */
+	Tolerance,
+	/** The value must be inside a band, that changes over the step time. */
+	Mask,
+};
+
+/**
+ * A point of a mask rule. The band between two points is interpolated
+ * linearly.
+ */
+struct LimitMaskPoint
+{
+	/** The time in seconds since the first sample of the step. */
+	double time;
+	double low;
+	double high;
+};
+
+/**
+ * The result of one rule in one step.
+ */
+struct LimitRuleResult
+{
+	size_t rule_id;
+	string name;
+	/** The number of checked samples. */
+	size_t sample_count;
+	/** The number of samples outside the limits. */
+	size_t failure_count;
+	/** Min and max of the checked samples. NaN if no sample was checked. */
+	double min;
+	double max;
+	/** The first sample outside the limits. NaN if there is none. */
+	double first_failure_timestamp;
+	double first_failure_value;
+	/** At least one sample was checked and no sample failed. */
+	bool passed;
+};
+
+/**
+ * The result of a test step, see LimitEngine::begin_step().
+ */
+struct LimitStepResult
+{
+	string name;
+	/** The timestamps of the first/last checked sample, NaN if none. */
+	double start_timestamp;
+	double end_timestamp;
+	/** false while the step is running. */
+	bool finished;
+	/** All rules of the step have passed. */
+	bool passed;
+	vector<LimitRuleResult> rules;
+};
+
+/**
+ * Checks the samples of a signal against limit rules and aggregates the
+ * pass/fail results per test step, e.g. for a production test.
+ *
+ * Like the TriggerEngine, every batch of appended samples is evaluated in
+ * the thread of the engine (e.g. a worker of the WorkerPool), so a test
+ * script doesn't have to check every sample itself. Only the samples
+ * between begin_step() and end_step() are checked. begin_step() and
+ * end_step() can be called from any thread, both evaluate the samples,
+ * that are still pending, before the steps are switched. So the result of
+ * end_step() contains all samples, that were appended before the call.
+ *
+ * The steps are addressed by their absolute position, that stays stable
+ * when old steps are dropped from the buffer.
+ */
+class LimitEngine : public QObject
+{
+	Q_OBJECT
+
+public:
+	explicit LimitEngine(shared_ptr<AnalogTimeSignal> signal,
+		size_t max_step_count = default_max_step_count);
+	~LimitEngine();
+
+	shared_ptr<AnalogTimeSignal> signal() const;
+
+	/**
+	 * Check, that the value is inside [low, high].
+	 *
+	 * @return The id of the rule.
+	 */
+	size_t add_limit_rule(double low, double high, const string &name = "");
+
+	/**
+	 * Check, that the value is inside nominal +/- tolerance. A relative
+	 * tolerance is a fraction of the nominal value, e.g. 0.01 for 1%.
+	 *
+	 * @return The id of the rule.
+	 */
+	size_t add_tolerance_rule(double nominal, double tolerance, bool relative,
+		const string &name = "");
+
+	/**
+	 * Check, that the value is inside a band, that is interpolated between
+	 * the mask points, e.g. for the settling of a step response. The times
+	 * of the points are relative to the first sample of the step. Samples
+	 * before the first or after the last point are not checked.
+	 *
+	 * @return The id of the rule or 0 if the mask has no points.
+	 */
+	size_t add_mask_rule(vector<LimitMaskPoint> mask, const string &name = "");
+
+	/**
+	 * Remove a rule. The results of the finished steps are kept.
+	 *
+	 * @return false if there is no rule with the id.
+	 */
+	bool remove_rule(size_t rule_id);
+
+	/**
+	 * Begin a new test step with the samples, that are appended from now
+	 * on. A running step is finished first.
+	 */
+	void begin_step(const string &name);
+
+	/**
+	 * Finish the running step.
+	 *
+	 * @return The result of the step, an unfinished empty result if no step
+	 *         was running.
+	 */
+	LimitStepResult end_step();
+
+	/** Return true while a step is running. */
+	bool is_step_running() const;
+
+	/**
+	 * Return the absolute position of the oldest stored step and the
+	 * position behind the newest step (the number of all steps so far).
+	 */
+	size_t first_step_pos() const;
+	size_t step_count() const;
+
+	/**
+	 * Return the results of the steps from the absolute position first on,
+	 * including the running step.
+	 */
+	vector<LimitStepResult> results(size_t first = 0) const;
+
+	/**
+	 * Return true if at least one step is finished and all finished steps
+	 * have passed.
+	 */
+	bool passed() const;
+
+	/** Return the results of all stored steps as human readable text. */
+	string report() const;
+
+	/** Drop the results of all finished steps. */
+	void clear_results();
+
+	static const size_t default_max_step_count = 10000;
+
+private:
+	struct Rule
+	{
+		size_t id;
+		string name;
+		LimitRuleType type;
+		double low;
+		double high;
+		vector<LimitMaskPoint> mask;
+		/** The index of the result of the running step. */
+		size_t result_index;
+	};
+
+	size_t add_rule(Rule rule);
+	/** Add an empty result of the rule to the running step. */
+	void add_rule_result(Rule &rule);
+	/**
+	 * Evaluate the samples, that were appended since the last call. mutex_
+	 * must be locked.
+	 */
+	void process_samples();
+	/** Check a sample against all rules. mutex_ must be locked. */
+	void evaluate(double timestamp, double value);
+	/**
+	 * Return the limits of the rule at the timestamp in &low and &high.
+	 *
+	 * @return false if the rule doesn't check the timestamp.
+	 */
+	bool get_limits(const Rule &rule, double timestamp,
+		double &low, double &high) const;
+	/** Finish the running step. mutex_ must be locked. */
+	void finish_step();
+
+	static const size_t read_block_size_;
+
+	shared_ptr<AnalogTimeSignal> signal_;
+	const size_t max_step_count_;
+	size_t next_signal_pos_;
+	vector<double> block_timestamps_;
+	vector<double> block_values_;
+
+	mutable std::mutex mutex_;
+	vector<Rule> rules_;
+	size_t next_rule_id_;
+	/** The stored steps, the running step is the last one. */
+	deque<LimitStepResult> steps_;
+	size_t first_step_pos_;
+	bool step_running_;
+	vector<unique_ptr<SampleBusSubscription>> subscriptions_;
+
+private Q_SLOTS:
+	void on_samples_appended();
+	void on_samples_cleared();
+
+Q_SIGNALS:
+	/** The results of the steps have changed, e.g. by new samples. */
+	void results_changed();
+	/** The step at the absolute position step_pos was finished. */
+	void step_finished(size_t step_pos);
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_LIMITENGINE_HPP
@@ -0,0 +1,358 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "mergedtimeindex.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/analogtimesnapshot.hpp"
+
+using std::make_shared;
+using std::shared_ptr;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+const size_t MergedTimeIndex::npos = std::numeric_limits<size_t>::max();
+const size_t MergedTimeIndex::block_size_ = 1024;
+const double MergedTimeIndex::default_max_delay_ = 10.;
+
+MergedTimeIndex::MergedTimeIndex(
+		const vector<shared_ptr<AnalogTimeSignal>> &signals,
+		bool relative_time) :
+	signals_(signals),
+	relative_time_(relative_time),
+	max_delay_(default_max_delay_),
+	timeframe_(0.),
+	begin_pos_(0)
+{
+	for (const auto &signal : signals_) {
+		cursors_.push_back(Cursor{ signal, nullptr,
+			vector<double>(block_size_), 0, 0, 0, false,
+			signal->clear_epoch() });
+	}
+}
+
+MergedTimeIndex::MergedTimeIndex(const vector<AnalogTimeSnapshot> &snapshots,
+		bool relative_time) :
+	relative_time_(relative_time),
+	max_delay_(default_max_delay_),
+	timeframe_(0.),
+	begin_pos_(0)
+{
+	for (const auto &snapshot : snapshots) {
+		signals_.push_back(snapshot.signal());
+		cursors_.push_back(Cursor{ snapshot.signal(),
+			make_shared<AnalogTimeSnapshot>(snapshot),
+			vector<double>(block_size_), snapshot.first_sample_pos(), 0, 0,
+			false, snapshot.signal()->clear_epoch() });
+	}
+}
+
+MergedTimeIndex::~MergedTimeIndex()
+{
+}
+
+bool MergedTimeIndex::Cursor::fetch(bool relative_time)
+{
+	if (index < count)
+		return true;
+
+	size_t n;
+	size_t pos = block_pos + count;
+	if (snapshot) {
+		n = snapshot->copy_samples(
+			pos, block_size_, relative_time, timestamps.data(), nullptr);
+	}
+	else {
+		// Skip the samples, that were dropped by the retention policy
+		pos = std::max(pos, signal->first_sample_pos());
+		n = signal->copy_samples(
+			pos, block_size_, relative_time, timestamps.data(), nullptr);
+	}
+	if (n == 0)
+		return false;
+
+	block_pos = pos;
+	count = n;
+	index = 0;
+	return true;
+}
+
+double MergedTimeIndex::Cursor::current_timestamp() const
+{
+	return timestamps[index];
+}
+
+bool MergedTimeIndex::heap_compare(const HeapEntry &a, const HeapEntry &b)
+{
+	if (a.timestamp != b.timestamp)
+		return a.timestamp > b.timestamp;
+	return a.k > b.k;
+}
+
+size_t MergedTimeIndex::signal_count() const
+{
+	return signals_.size();
+}
+
+const vector<shared_ptr<AnalogTimeSignal>> &MergedTimeIndex::signals() const
+{
+	return signals_;
+}
+
+bool MergedTimeIndex::relative_time() const
+{
+	return relative_time_;
+}
+
+void MergedTimeIndex::set_max_delay(double max_delay)
+{
+	max_delay_ = max_delay;
+}
+
+double MergedTimeIndex::max_delay() const
+{
+	return max_delay_;
+}
+
+void MergedTimeIndex::set_timeframe(double timeframe)
+{
+	timeframe_ = std::max(0., timeframe);
+}
+
+double MergedTimeIndex::timeframe() const
+{
+	return timeframe_;
+}
+
+size_t MergedTimeIndex::update(size_t max_rows)
+{
+	// Snapshots don't get new samples, that could be older
+	for (const auto &cursor : cursors_) {
+		if (cursor.snapshot)
+			return flush(max_rows);
+	}
+
+	// Signals without samples are ignored, they would hold back the others
+	// forever. Only the published samples count.
+	double min_last = std::numeric_limits<double>::max();
+	double max_last = std::numeric_limits<double>::lowest();
+	bool found = false;
+	for (const auto &signal : signals_) {
+		if (signal->sample_count() == 0)
+			continue;
+		const double last = signal->get_last_sample(relative_time_).first;
+		min_last = std::min(min_last, last);
+		max_last = std::max(max_last, last);
+		found = true;
+	}
+	if (!found)
+		return 0;
+
+	return merge(std::max(min_last, max_last - max_delay_), max_rows);
+}
+
+size_t MergedTimeIndex::flush(size_t max_rows)
+{
+	return merge(std::numeric_limits<double>::infinity(), max_rows);
+}
+
+void MergedTimeIndex::push_heap(size_t k)
+{
+	cursors_[k].queued = true;
+	heap_.push_back(HeapEntry{ cursors_[k].current_timestamp(), k });
+	std::push_heap(heap_.begin(), heap_.end(), heap_compare);
+}
+
+bool MergedTimeIndex::joins_last_row(size_t k, double timestamp) const
+{
+	if (timestamps_.empty())
+		return false;
+	const double row_timestamp = timestamps_.back();
+	return timestamp >= row_timestamp &&
+		timestamp <= row_timestamp + timeframe_ &&
+		positions_[positions_.size() - signals_.size() + k] == npos;
+}
+
+size_t MergedTimeIndex::merge(double max_timestamp, size_t max_rows)
+{
+	// Queue the signals, that got new samples since the last merge
+	for (size_t k = 0; k < cursors_.size(); ++k) {
+		if (!cursors_[k].queued && cursors_[k].fetch(relative_time_))
+			push_heap(k);
+	}
+
+	const size_t n = signals_.size();
+	size_t rows = 0;
+	while (!heap_.empty()) {
+		const HeapEntry entry = heap_.front();
+		if (entry.timestamp > max_timestamp)
+			break;
+		const bool joins = joins_last_row(entry.k, entry.timestamp);
+		if (!joins && rows >= max_rows)
+			break;
+
+		std::pop_heap(heap_.begin(), heap_.end(), heap_compare);
+		heap_.pop_back();
+
+		if (!joins) {
+			timestamps_.push_back(entry.timestamp);
+			positions_.insert(positions_.end(), n, npos);
+			++rows;
+		}
+		Cursor &cursor = cursors_[entry.k];
+		positions_[positions_.size() - n + entry.k] =
+			cursor.block_pos + cursor.index;
+		++cursor.index;
+
+		if (cursor.fetch(relative_time_))
+			push_heap(entry.k);
+		else
+			cursor.queued = false;
+	}
+	return rows;
+}
+
+bool MergedTimeIndex::is_stale() const
+{
+	for (const auto &cursor : cursors_) {
+		if (cursor.snapshot && !cursor.snapshot->is_valid())
+			return true;
+		if (cursor.signal->clear_epoch() != cursor.clear_epoch)
+			return true;
+	}
+	return false;
+}
+
+size_t MergedTimeIndex::dropped_rows() const
+{
+	const size_t n = signals_.size();
+	vector<size_t> first_pos;
+	for (const auto &signal : signals_)
+		first_pos.push_back(signal->first_sample_pos());
+
+	size_t count = 0;
+	for (size_t row = 0; row < timestamps_.size(); ++row) {
+		for (size_t k = 0; k < n; ++k) {
+			const size_t pos = positions_[row * n + k];
+			if (pos != npos && pos >= first_pos[k])
+				return count;
+		}
+		++count;
+	}
+	return count;
+}
+
+void MergedTimeIndex::drop_front(size_t count)
+{
+	count = std::min(count, timestamps_.size());
+	timestamps_.erase(timestamps_.begin(), timestamps_.begin() + count);
+	positions_.erase(positions_.begin(),
+		positions_.begin() + count * signals_.size());
+	begin_pos_ += count;
+}
+
+size_t MergedTimeIndex::begin_pos() const
+{
+	return begin_pos_;
+}
+
+size_t MergedTimeIndex::end_pos() const
+{
+	return begin_pos_ + timestamps_.size();
+}
+
+size_t MergedTimeIndex::size() const
+{
+	return timestamps_.size();
+}
+
+bool MergedTimeIndex::empty() const
+{
+	return timestamps_.empty();
+}
+
+double MergedTimeIndex::timestamp(size_t pos) const
+{
+	return timestamps_[pos - begin_pos_];
+}
+
+size_t MergedTimeIndex::sample_pos(size_t pos, size_t k) const
+{
+	return positions_[(pos - begin_pos_) * signals_.size() + k];
+}
+
+size_t MergedTimeIndex::copy_values(size_t first, size_t last, size_t k,
+	double *values, uint8_t *valid) const
+{
+	if (last <= first)
+		return 0;
+	std::fill(valid, valid + (last - first), 0);
+
+	// The span of the samples of signal k in the rows
+	size_t span_first = npos;
+	size_t span_last = 0;
+	for (size_t row = first; row < last; ++row) {
+		const size_t pos = sample_pos(row, k);
+		if (pos == npos)
+			continue;
+		span_first = std::min(span_first, pos);
+		span_last = std::max(span_last, pos);
+	}
+	if (span_first == npos)
+		return 0;
+
+	const Cursor &cursor = cursors_[k];
+	size_t copied;
+	if (cursor.snapshot) {
+		span_values_.resize(span_last - span_first + 1);
+		copied = cursor.snapshot->copy_samples(span_first,
+			span_values_.size(), relative_time_, nullptr, span_values_.data());
+	}
+	else {
+		// Skip the samples, that were dropped by the retention policy
+		span_first = std::max(span_first, cursor.signal->first_sample_pos());
+		if (span_first > span_last)
+			return 0;
+		span_values_.resize(span_last - span_first + 1);
+		copied = cursor.signal->copy_samples(span_first,
+			span_values_.size(), relative_time_, nullptr, span_values_.data());
+	}
+
+	size_t count = 0;
+	for (size_t row = first; row < last; ++row) {
+		const size_t pos = sample_pos(row, k);
+		if (pos == npos || pos < span_first || pos - span_first >= copied)
+			continue;
+		values[row - first] = span_values_[pos - span_first];
+		valid[row - first] = 1;
+		++count;
+	}
+	return count;
+}
+
+} // namespace data
+} // namespace sv
@@ -0,0 +1,220 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_MERGEDTIMEINDEX_HPP
+#define DATA_MERGEDTIMEINDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+using std::deque;
+using std::shared_ptr;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+class AnalogTimeSignal;
+class AnalogTimeSnapshot;
+
+/**
+ * A row index over N signals: The sorted union of the timestamps of the
+ * signals, with the position of the sample of every signal at that
+ * timestamp. Samples of different signals with the same timestamp (or
+ * within timeframe() after the timestamp of the row) share a row, a signal
+ * without a sample in a row has no position (npos) there. Unlike
+ * SignalCombiner, nothing is interpolated and the values are not copied,
+ * they are read from the signals when needed.
+ *
+ * The index is an incremental k-way merge: The signals, that have unmerged
+ * samples, are kept in a min-heap by the timestamp of their next sample, so
+ * merging a sample costs O(log N). The heap is kept between the updates.
+ *
+ * Rows are only appended: A row is merged, when all signals have a sample
+ * at or after its timestamp (so no older sample can arrive any more), or
+ * when it is older than the newest sample by more than max_delay(), so a
+ * stalled signal doesn't hold back the others. flush() merges all samples,
+ * e.g. when no new samples are coming in. A sample, that arrives after
+ * newer rows were merged, gets an own row at the end.
+ *
+ * Rows, whose samples were all dropped from the signals by the retention
+ * policy, can be dropped with drop_front(). The rows are addressed by
+ * absolute positions like the samples of a signal.
+ *
+ * The index is not thread-safe.
+ */
+class MergedTimeIndex
+{
+public:
+	/** The position of a signal without a sample in a row. */
+	static const size_t npos;
+
+	/**
+	 * Index the samples of the signals, that are (and will be) pushed.
+	 */
+	explicit MergedTimeIndex(
+		const vector<shared_ptr<AnalogTimeSignal>> &signals,
+		bool relative_time = true);
+	/**
+	 * Index only the samples of the snapshots, e.g. for an export. The
+	 * snapshots are kept by the index.
+	 */
+	explicit MergedTimeIndex(const vector<AnalogTimeSnapshot> &snapshots,
+		bool relative_time = true);
+	~MergedTimeIndex();
+
+	MergedTimeIndex(const MergedTimeIndex &) = delete;
+	MergedTimeIndex &operator=(const MergedTimeIndex &) = delete;
+
+	size_t signal_count() const;
+	const vector<shared_ptr<AnalogTimeSignal>> &signals() const;
+	bool relative_time() const;
+
+	void set_max_delay(double max_delay);
+	double max_delay() const;
+
+	/**
+	 * Samples of different signals, that are not more than timeframe
+	 * seconds younger than the timestamp of a row, share the row. The
+	 * default is 0, only samples with the same timestamp share a row.
+	 */
+	void set_timeframe(double timeframe);
+	double timeframe() const;
+
+	/**
+	 * Merge the new samples of the signals, see above.
+	 *
+	 * @param max_rows Stop after this number of new rows.
+	 * @return The number of new rows.
+	 */
+	size_t update(size_t max_rows = npos);
+	/**
+	 * Merge all new samples, also if other signals could still deliver
+	 * older samples.
+	 *
+	 * @param max_rows Stop after this number of new rows.
+	 * @return The number of new rows.
+	 */
+	size_t flush(size_t max_rows = npos);
+	/**
+	 * Return true if a signal was cleared, the index must then be rebuilt.
+	 */
+	bool is_stale() const;
+
+	/**
+	 * Return the number of rows at the front, whose samples were all
+	 * dropped from the signals.
+	 */
+	size_t dropped_rows() const;
+	void drop_front(size_t count);
+
+	size_t begin_pos() const;
+	size_t end_pos() const;
+	size_t size() const;
+	bool empty() const;
+
+	/** Return the timestamp of the row at the absolute position pos. */
+	double timestamp(size_t pos) const;
+	/**
+	 * Return the position of the sample of signal k in the row at the
+	 * absolute position pos, or npos if signal k has no sample there.
+	 */
+	size_t sample_pos(size_t pos, size_t k) const;
+
+	/**
+	 * Copy the values of signal k in the rows [first, last) (absolute
+	 * positions) to values. The samples of a signal are in the order of
+	 * the rows, so the values are copied in one span from the signal, not
+	 * sample by sample. valid[i] is set to 0 for the rows, where signal k
+	 * has no sample or the sample was dropped, and to 1 otherwise.
+	 *
+	 * @return The number of valid values.
+	 */
+	size_t copy_values(size_t first, size_t last, size_t k,
+		double *values, uint8_t *valid) const;
+
+private:
+	struct Cursor
+	{
+		shared_ptr<AnalogTimeSignal> signal;
+		/** Limits the cursor to the samples of the snapshot, if set. */
+		shared_ptr<AnalogTimeSnapshot> snapshot;
+		vector<double> timestamps;
+		/** The position of the first sample of the block in the signal. */
+		size_t block_pos;
+		size_t count;
+		/** The index of the current sample in the block. */
+		size_t index;
+		/** True while the cursor is in the heap. */
+		bool queued;
+		/** The clear epoch of the signal, when the index was created. */
+		unsigned int clear_epoch;
+
+		/**
+		 * Make sure there is a current sample. Returns false if there are no
+		 * new samples in the signal.
+		 */
+		bool fetch(bool relative_time);
+		double current_timestamp() const;
+	};
+
+	struct HeapEntry
+	{
+		double timestamp;
+		size_t k;
+	};
+
+	/** Makes the heap a min-heap, equal timestamps in the signal order. */
+	static bool heap_compare(const HeapEntry &a, const HeapEntry &b);
+
+	/** Merge the samples up to the timestamp max_timestamp. */
+	size_t merge(double max_timestamp, size_t max_rows);
+	void push_heap(size_t k);
+	/**
+	 * Return true if the sample of signal k at timestamp can be added to
+	 * the last row.
+	 */
+	bool joins_last_row(size_t k, double timestamp) const;
+
+	/** The number of samples, that are read from a signal at once. */
+	static const size_t block_size_;
+	static const double default_max_delay_;
+
+	vector<shared_ptr<AnalogTimeSignal>> signals_;
+	const bool relative_time_;
+	vector<Cursor> cursors_;
+	vector<HeapEntry> heap_;
+	double max_delay_;
+	double timeframe_;
+	size_t begin_pos_;
+	deque<double> timestamps_;
+	/** The sample positions of the signals, signal_count() per row. */
+	deque<size_t> positions_;
+	/** The span of values of copy_values(). */
+	mutable vector<double> span_values_;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_MERGEDTIMEINDEX_HPP
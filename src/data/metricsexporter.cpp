@@ -0,0 +1,526 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <clocale>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <QByteArray>
+#include <QDebug>
+#include <QHostAddress>
+#include <QList>
+#include <QString>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+#include "metricsexporter.hpp"
+#include "src/session.hpp"
+#include "src/channels/basechannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/runningstatistics.hpp"
+#include "src/devices/acquisitionstatistics.hpp"
+#include "src/devices/basedevice.hpp"
+#include "src/devices/hardwaredevice.hpp"
+#include "src/util.hpp"
+
+using std::lock_guard;
+using std::unique_lock;
+
+namespace sv {
+namespace data {
+
+namespace {
+
+string escape_label(const string &str)
+{
+	string escaped;
+	for (const char c : str) {
+		if (c == '\n') {
+			escaped += "\\n";
+			continue;
+		}
+		if (c == '\\' || c == '"')
+			escaped += '\\';
+		escaped += c;
+	}
+	return escaped;
+}
+
+string format_labels(const vector<std::pair<string, string>> &labels)
+{
+	string formatted;
+	for (const auto &label : labels) {
+		if (label.second.empty())
+			continue;
+		formatted += formatted.empty() ? "{" : ",";
+		formatted += label.first + "=\"" + escape_label(label.second) + "\"";
+	}
+	return formatted.empty() ? formatted : formatted + "}";
+}
+
+string format_value(double value)
+{
+	if (std::isnan(value))
+		return "NaN";
+	if (std::isinf(value))
+		return value > 0 ? "+Inf" : "-Inf";
+
+	char value_str[32];
+	const int value_len = std::snprintf(
+		value_str, sizeof(value_str), "%.17g", value);
+	if (value_len <= 0 || value_len >= (int)sizeof(value_str))
+		return "NaN";
+	// snprintf() formats with the decimal point of the current locale
+	const struct lconv *locale_conv = std::localeconv();
+	if (locale_conv && locale_conv->decimal_point &&
+			locale_conv->decimal_point[0] != '.' &&
+			locale_conv->decimal_point[0] != '\0') {
+		std::replace(value_str, value_str + value_len,
+			locale_conv->decimal_point[0], '.');
+	}
+	return string(value_str, (size_t)value_len);
+}
+
+void append_header(string &body, const char *name, const char *type,
+	const char *help)
+{
+	body += string("# HELP ") + name + " " + help + "\n";
+	body += string("# TYPE ") + name + " " + type + "\n";
+}
+
+void append_sample(string &body, const string &name, const string &labels,
+	double value)
+{
+	body += name + labels + " " + format_value(value) + "\n";
+}
+
+}
+
+const int MetricsExporter::poll_interval_ = 100;
+const int MetricsExporter::read_timeout_ = 1000;
+const int MetricsExporter::write_timeout_ = 3000;
+const size_t MetricsExporter::max_request_size_ = 8192;
+
+MetricsExporter::MetricsExporter(Session &session) :
+	session_(session),
+	stop_(false),
+	running_(false),
+	listen_done_(false),
+	port_(0),
+	scrape_count_(0)
+{
+}
+
+MetricsExporter::~MetricsExporter()
+{
+	stop();
+}
+
+bool MetricsExporter::start(uint16_t port,
+	const vector<shared_ptr<AnalogTimeSignal>> &signals, const string &host)
+{
+	stop();
+
+	QHostAddress address;
+	if (!util::parse_listen_address(host, address)) {
+		qWarning() << "MetricsExporter: Invalid address" <<
+			QString::fromStdString(host);
+		return false;
+	}
+
+	signal_entries_.clear();
+	for (const auto &signal : signals) {
+		if (!signal)
+			continue;
+		const auto channel = signal->parent_channel();
+		const string labels = format_labels({
+			{ "device", channel && channel->parent_device() ?
+				channel->parent_device()->name() : "" },
+			{ "channel", channel ? channel->name() : "" },
+			{ "signal", signal->name() },
+			{ "quantity", signal->quantity_name().toStdString() },
+			{ "unit", signal->unit_name().toStdString() } });
+		signal_entries_.push_back(SignalEntry{ signal, labels });
+	}
+
+	scrape_count_ = 0;
+	stop_ = false;
+	listen_done_ = false;
+	running_ = true;
+	thread_ = std::thread(&MetricsExporter::thread_proc, this, address,
+		port);
+
+	// Wait until the thread listens, so that a used port is reported here
+	unique_lock<std::mutex> lock(mutex_);
+	cond_.wait(lock, [this]() { return listen_done_; });
+	lock.unlock();
+	if (!running_) {
+		thread_.join();
+		return false;
+	}
+	return true;
+}
+
+void MetricsExporter::stop()
+{
+	{
+		lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+	}
+	cond_.notify_all();
+	if (thread_.joinable())
+		thread_.join();
+	running_ = false;
+}
+
+bool MetricsExporter::is_running() const
+{
+	return running_;
+}
+
+uint16_t MetricsExporter::port() const
+{
+	return port_;
+}
+
+size_t MetricsExporter::scrape_count() const
+{
+	return scrape_count_;
+}
+
+void MetricsExporter::set_devices(
+	const vector<shared_ptr<devices::HardwareDevice>> &devices)
+{
+	vector<DeviceEntry> device_entries;
+	for (const auto &device : devices) {
+		if (!device)
+			continue;
+		device_entries.push_back(DeviceEntry{ device, format_labels({
+			{ "device", device->name() },
+			{ "id", device->id() } }) });
+	}
+
+	lock_guard<std::mutex> lock(devices_mutex_);
+	device_entries_.swap(device_entries);
+}
+
+string MetricsExporter::metrics() const
+{
+	vector<std::pair<string, devices::AcquisitionSummary>> summaries;
+	{
+		lock_guard<std::mutex> lock(devices_mutex_);
+		for (const auto &entry : device_entries_) {
+			summaries.push_back(std::make_pair(
+				entry.labels, entry.device->acquisition_summary()));
+		}
+	}
+
+	string body;
+	body.reserve(4096);
+
+	append_header(body, "smuview_memory_bytes", "gauge",
+		"Memory used by all signals.");
+	append_sample(body, "smuview_memory_bytes", "",
+		(double)session_.last_memory_size());
+	append_header(body, "smuview_spilled_bytes", "gauge",
+		"Bytes of all signals in spill files.");
+	append_sample(body, "smuview_spilled_bytes", "",
+		(double)session_.last_spilled_size());
+	append_header(body, "smuview_memory_budget_bytes", "gauge",
+		"Memory budget of the signals, 0 is unlimited.");
+	append_sample(body, "smuview_memory_budget_bytes", "",
+		(double)session_.memory_budget());
+
+	// Device metrics
+	typedef double (*SummaryGetter)(const devices::AcquisitionSummary &);
+	struct DeviceMetric
+	{
+		const char *name;
+		const char *type;
+		const char *help;
+		SummaryGetter getter;
+	};
+	static const DeviceMetric device_metrics[] = {
+		{ "smuview_device_samples_per_second", "gauge",
+			"Samples per second of the last second.",
+			[](const devices::AcquisitionSummary &s) {
+				return s.samples_per_second; } },
+		{ "smuview_device_packets_per_second", "gauge",
+			"Packets per second of the last second.",
+			[](const devices::AcquisitionSummary &s) {
+				return s.packets_per_second; } },
+		{ "smuview_device_samples_total", "counter",
+			"Received samples.",
+			[](const devices::AcquisitionSummary &s) {
+				return (double)s.sample_count; } },
+		{ "smuview_device_packets_total", "counter",
+			"Received packets.",
+			[](const devices::AcquisitionSummary &s) {
+				return (double)s.packet_count; } },
+		{ "smuview_device_dropped_packets_total", "counter",
+			"Packets lost by an overrun of the ingest queue.",
+			[](const devices::AcquisitionSummary &s) {
+				return (double)s.dropped_packet_count; } },
+		{ "smuview_device_dropped_samples_total", "counter",
+			"Samples lost by an overrun of the ingest queue.",
+			[](const devices::AcquisitionSummary &s) {
+				return (double)s.dropped_sample_count; } },
+		{ "smuview_device_out_of_order_packets_total", "counter",
+			"Packets with a timestamp before the previous packet.",
+			[](const devices::AcquisitionSummary &s) {
+				return (double)s.out_of_order_packet_count; } },
+		{ "smuview_device_allocations_total", "counter",
+			"Heap allocations while receiving and storing the packets.",
+			[](const devices::AcquisitionSummary &s) {
+				return (double)s.allocation_count; } },
+		{ "smuview_device_allocated_bytes_total", "counter",
+			"Heap bytes allocated while receiving and storing the packets.",
+			[](const devices::AcquisitionSummary &s) {
+				return (double)s.allocated_bytes; } },
+		{ "smuview_device_feed_seconds_total", "counter",
+			"Time spent in the datafeed callback.",
+			[](const devices::AcquisitionSummary &s) {
+				return s.feed_time; } },
+		{ "smuview_device_max_feed_seconds", "gauge",
+			"Longest datafeed callback.",
+			[](const devices::AcquisitionSummary &s) {
+				return s.max_feed_time; } },
+		{ "smuview_device_ingest_queue_depth", "gauge",
+			"Packets waiting to be stored.",
+			[](const devices::AcquisitionSummary &s) {
+				return (double)s.queue_depth; } },
+		{ "smuview_device_ingest_queue_high_water", "gauge",
+			"Maximum of the packets waiting to be stored.",
+			[](const devices::AcquisitionSummary &s) {
+				return (double)s.queue_high_water; } },
+	};
+	for (const auto &metric : device_metrics) {
+		if (summaries.empty())
+			break;
+		append_header(body, metric.name, metric.type, metric.help);
+		for (const auto &summary : summaries) {
+			append_sample(body, metric.name, summary.first,
+				metric.getter(summary.second));
+		}
+	}
+
+	if (!summaries.empty()) {
+		append_header(body, "smuview_device_latency_seconds", "histogram",
+			"Time from the datafeed callback until the samples were stored.");
+	}
+	for (const auto &summary : summaries) {
+		// The labels end with '}'
+		const string &labels = summary.first;
+		const string prefix = labels.empty() ?
+			"{" : labels.substr(0, labels.size() - 1) + ",";
+		uint64_t count = 0;
+		const auto &histogram = summary.second.latency_histogram;
+		for (size_t i = 0; i < histogram.size(); ++i) {
+			count += histogram[i];
+			const double limit =
+				devices::AcquisitionStatistics::latency_bucket_limit(i);
+			append_sample(body, "smuview_device_latency_seconds_bucket",
+				prefix + "le=\"" + format_value(limit) + "\"}", (double)count);
+		}
+		append_sample(body, "smuview_device_latency_seconds_count",
+			labels, (double)count);
+	}
+
+	// Signal metrics
+	if (!signal_entries_.empty()) {
+		append_header(body, "smuview_signal_samples_total", "counter",
+			"Samples pushed to the signal.");
+		for (const auto &entry : signal_entries_) {
+			append_sample(body, "smuview_signal_samples_total", entry.labels,
+				(double)entry.signal->sample_count());
+		}
+		append_header(body, "smuview_signal_memory_bytes", "gauge",
+			"Memory used by the signal.");
+		for (const auto &entry : signal_entries_) {
+			append_sample(body, "smuview_signal_memory_bytes", entry.labels,
+				(double)entry.signal->memory_size());
+		}
+	}
+
+	// The values are only exported for signals with samples
+	struct SignalValues
+	{
+		const SignalEntry *entry;
+		double timestamp;
+		double value;
+		double min;
+		double max;
+		AnalogStatistics statistics;
+	};
+	vector<SignalValues> values;
+	for (const auto &entry : signal_entries_) {
+		if (entry.signal->sample_count() == 0)
+			continue;
+		const auto sample = entry.signal->get_last_sample(false);
+		values.push_back(SignalValues{ &entry, sample.first, sample.second,
+			entry.signal->min_value(), entry.signal->max_value(),
+			entry.signal->statistics() });
+	}
+
+	struct ValueMetric
+	{
+		const char *name;
+		const char *help;
+		double (*getter)(const SignalValues &);
+	};
+	static const ValueMetric value_metrics[] = {
+		{ "smuview_signal_value", "Latest value of the signal.",
+			[](const SignalValues &v) { return v.value; } },
+		{ "smuview_signal_timestamp_seconds",
+			"Timestamp of the latest value since the epoch.",
+			[](const SignalValues &v) { return v.timestamp; } },
+		{ "smuview_signal_min", "Minimum of all values.",
+			[](const SignalValues &v) { return v.min; } },
+		{ "smuview_signal_max", "Maximum of all values.",
+			[](const SignalValues &v) { return v.max; } },
+		{ "smuview_signal_mean", "Running mean of all values.",
+			[](const SignalValues &v) { return v.statistics.mean; } },
+		{ "smuview_signal_stddev", "Running standard deviation of all values.",
+			[](const SignalValues &v) { return v.statistics.stddev; } },
+		{ "smuview_signal_rms", "Running root mean square of all values.",
+			[](const SignalValues &v) { return v.statistics.rms; } },
+	};
+	for (const auto &metric : value_metrics) {
+		if (values.empty())
+			break;
+		append_header(body, metric.name, "gauge", metric.help);
+		for (const auto &signal_values : values) {
+			append_sample(body, metric.name, signal_values.entry->labels,
+				metric.getter(signal_values));
+		}
+	}
+
+	append_header(body, "smuview_metrics_scrapes_total", "counter",
+		"Scrapes of this exporter.");
+	append_sample(body, "smuview_metrics_scrapes_total", "",
+		(double)scrape_count_);
+
+	return body;
+}
+
+void MetricsExporter::thread_proc(QHostAddress address, uint16_t port)
+{
+	// The server and the sockets are used with the blocking functions, this
+	// thread has no event loop.
+	QTcpServer server;
+	const bool listening = server.listen(address, port);
+	if (listening) {
+		port_ = server.serverPort();
+	}
+	else {
+		qWarning() << "MetricsExporter: Listening on" << address.toString() <<
+			"port" << port << "failed:" << server.errorString();
+		running_ = false;
+	}
+	{
+		lock_guard<std::mutex> lock(mutex_);
+		listen_done_ = true;
+	}
+	cond_.notify_all();
+	if (!listening)
+		return;
+
+	while (!stop_) {
+		if (!server.waitForNewConnection(poll_interval_))
+			continue;
+		QTcpSocket *socket = server.nextPendingConnection();
+		while (socket) {
+			handle_connection(*socket);
+			delete socket;
+			socket = server.nextPendingConnection();
+		}
+	}
+
+	server.close();
+	running_ = false;
+}
+
+void MetricsExporter::handle_connection(QTcpSocket &socket)
+{
+	// Read the request header, the body of a GET is empty
+	QByteArray request;
+	while (!request.contains("\r\n\r\n") && !request.contains("\n\n")) {
+		if ((size_t)request.size() > max_request_size_ ||
+				!socket.waitForReadyRead(read_timeout_)) {
+			socket.abort();
+			return;
+		}
+		request += socket.readAll();
+	}
+
+	const QList<QByteArray> request_line =
+		request.left(request.indexOf('\n')).trimmed().split(' ');
+	const QByteArray method = request_line.value(0);
+	QByteArray path = request_line.value(1);
+	if (path.contains('?'))
+		path = path.left(path.indexOf('?'));
+
+	QByteArray status;
+	QByteArray content_type = "text/plain; charset=utf-8";
+	string body;
+	if (method != "GET" && method != "HEAD") {
+		status = "405 Method Not Allowed";
+		body = "Only GET is supported.\n";
+	}
+	else if (path == "/metrics") {
+		status = "200 OK";
+		content_type = "text/plain; version=0.0.4; charset=utf-8";
+		++scrape_count_;
+		body = metrics();
+	}
+	else {
+		status = "404 Not Found";
+		body = "The metrics are at /metrics.\n";
+	}
+
+	QByteArray response = "HTTP/1.0 " + status + "\r\n" +
+		"Content-Type: " + content_type + "\r\n" +
+		"Content-Length: " + QByteArray::number((qulonglong)body.size()) +
+		"\r\nConnection: close\r\n\r\n";
+	if (method != "HEAD")
+		response.append(body.data(), (int)body.size());
+
+	socket.write(response);
+	while (socket.bytesToWrite() > 0) {
+		if (!socket.waitForBytesWritten(write_timeout_)) {
+			socket.abort();
+			return;
+		}
+	}
+	socket.disconnectFromHost();
+	if (socket.state() != QAbstractSocket::UnconnectedState)
+		socket.waitForDisconnected(write_timeout_);
+}
+
+} // namespace data
+} // namespace sv
@@ -0,0 +1,155 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_METRICSEXPORTER_HPP
+#define DATA_METRICSEXPORTER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <QHostAddress>
+
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+class QTcpSocket;
+
+namespace sv {
+
+class Session;
+
+namespace devices {
+class HardwareDevice;
+}
+
+namespace data {
+
+class AnalogTimeSignal;
+
+/**
+ * Exports the performance counters of the session and the latest values of
+ * signals over HTTP in the Prometheus text format (version 0.0.4), e.g. for
+ * `curl http://localhost:9464/metrics`.
+ *
+ * Per hardware device, the acquisition statistics (rates, overruns, queue
+ * depth, latency histogram) are exported, per signal the sample count,
+ * memory, the latest value and the min/max and running statistics of all
+ * values.
+ *
+ * A background thread answers the scrapes. A scrape only reads atomics and
+ * the lock-free read functions of the signals, it never takes a lock of the
+ * datafeed. The labels are built, when the devices and signals are set.
+ */
+class MetricsExporter
+{
+public:
+	explicit MetricsExporter(Session &session);
+	/** Stops the exporter. */
+	~MetricsExporter();
+
+	MetricsExporter(const MetricsExporter &) = delete;
+	MetricsExporter &operator=(const MetricsExporter &) = delete;
+
+	/**
+	 * Listen on the port, a running exporter is stopped. By default, only
+	 * local scrapers can connect. Exporting the values to the network must
+	 * be chosen with the host.
+	 *
+	 * @param port The TCP port, 0 chooses a free port, see port().
+	 * @param signals The signals, whose values are exported.
+	 * @param host The address to listen on, "*" for all interfaces, see
+	 *        util::parse_listen_address().
+	 *
+	 * @return false if the host is invalid or the port couldn't be opened.
+	 */
+	bool start(uint16_t port,
+		const vector<shared_ptr<AnalogTimeSignal>> &signals,
+		const string &host = "127.0.0.1");
+	void stop();
+	bool is_running() const;
+	/** Return the port, that the exporter listens on. */
+	uint16_t port() const;
+	/** Return the number of answered scrapes. */
+	size_t scrape_count() const;
+
+	/**
+	 * Set the hardware devices, whose acquisition statistics are exported.
+	 * The session keeps them up to date, when devices are added or removed.
+	 */
+	void set_devices(
+		const vector<shared_ptr<devices::HardwareDevice>> &devices);
+
+	/** Return the metrics in the Prometheus text format. */
+	string metrics() const;
+
+private:
+	struct DeviceEntry
+	{
+		shared_ptr<devices::HardwareDevice> device;
+		/** The formatted labels, e.g. `{device="Demo"}`. */
+		string labels;
+	};
+
+	struct SignalEntry
+	{
+		shared_ptr<AnalogTimeSignal> signal;
+		string labels;
+	};
+
+	void thread_proc(QHostAddress address, uint16_t port);
+	void handle_connection(QTcpSocket &socket);
+
+	/** The time in milliseconds, that the thread checks for a stop. */
+	static const int poll_interval_;
+	static const int read_timeout_;
+	static const int write_timeout_;
+	/** The maximum size of a request header. */
+	static const size_t max_request_size_;
+
+	Session &session_;
+	vector<SignalEntry> signal_entries_;
+	/** Guards device_entries_, it is never held by the datafeed. */
+	mutable std::mutex devices_mutex_;
+	vector<DeviceEntry> device_entries_;
+
+	std::thread thread_;
+	/** Guards stop_ and listen_done_ for the conditions. */
+	std::mutex mutex_;
+	std::condition_variable cond_;
+	std::atomic<bool> stop_;
+	std::atomic<bool> running_;
+	/** Set by the thread, when it has tried to listen. */
+	bool listen_done_;
+	std::atomic<uint16_t> port_;
+	std::atomic<size_t> scrape_count_;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_METRICSEXPORTER_HPP
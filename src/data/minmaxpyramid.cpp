@@ -0,0 +1,243 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "minmaxpyramid.hpp"
+#include "src/data/chunkedbuffer.hpp"
+#include "src/data/timebase.hpp"
+#include "src/data/valuebuffer.hpp"
+
+using std::unique_ptr;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+namespace {
+
+const double empty_min = std::numeric_limits<double>::max();
+const double empty_max = std::numeric_limits<double>::lowest();
+
+}
+
+MinMaxPyramid::MinMaxPyramid() :
+	end_pos_(0),
+	time_origin_(0.)
+{
+	for (size_t i = 0; i < level_count_; ++i) {
+		levels_.push_back(unique_ptr<ChunkedBuffer<Bucket>>(
+			new ChunkedBuffer<Bucket>(chunk_size_exp_)));
+		accumulators_.push_back(empty_accumulator());
+	}
+}
+
+MinMaxPyramid::Accumulator MinMaxPyramid::empty_accumulator()
+{
+	return Accumulator{ { empty_min, empty_max, 0., 0., 0., 0., 0., 0. },
+		0, 0., 0., 0., 0. };
+}
+
+MinMaxPyramid::Bucket MinMaxPyramid::sample_bucket(
+	double timestamp, double value) const
+{
+	return Bucket{ value, value, value, value * value, 0.,
+		timestamp - time_origin_.load(std::memory_order_relaxed), 0., 0. };
+}
+
+double MinMaxPyramid::trapezoid(double timestamp1, double value1,
+	double timestamp2, double value2)
+{
+	return (timestamp2 - timestamp1) * (value1 + value2) / 2.;
+}
+
+void MinMaxPyramid::add_to_bucket(Bucket &bucket, size_t &count,
+	const Bucket &other, size_t other_count)
+{
+	if (other_count == 0)
+		return;
+
+	if (other.min < bucket.min)
+		bucket.min = other.min;
+	if (other.max > bucket.max)
+		bucket.max = other.max;
+
+	// Merge the centered moments (Chan et al.), before the sums are added
+	if (count == 0) {
+		bucket.mean_time = other.mean_time;
+		bucket.time_deviations = other.time_deviations;
+		bucket.time_value_deviations = other.time_value_deviations;
+	}
+	else {
+		const double n = (double)(count + other_count);
+		const double d_time = other.mean_time - bucket.mean_time;
+		const double d_value = other.sum / (double)other_count -
+			bucket.sum / (double)count;
+		const double factor = (double)count * (double)other_count / n;
+		bucket.time_deviations +=
+			other.time_deviations + d_time * d_time * factor;
+		bucket.time_value_deviations +=
+			other.time_value_deviations + d_time * d_value * factor;
+		bucket.mean_time += d_time * (double)other_count / n;
+	}
+
+	bucket.sum += other.sum;
+	bucket.sum_squares += other.sum_squares;
+	bucket.integral += other.integral;
+	count += other_count;
+}
+
+void MinMaxPyramid::add_to_accumulator(
+	Accumulator &acc, const Accumulator &other)
+{
+	if (acc.count > 0) {
+		// Integrate the segment between the two buckets
+		acc.bucket.integral += trapezoid(acc.last_timestamp, acc.last_value,
+			other.first_timestamp, other.first_value);
+	}
+	else {
+		acc.first_timestamp = other.first_timestamp;
+		acc.first_value = other.first_value;
+	}
+	add_to_bucket(acc.bucket, acc.count, other.bucket, other.count);
+	acc.last_timestamp = other.last_timestamp;
+	acc.last_value = other.last_value;
+}
+
+void MinMaxPyramid::push_back(double timestamp, double value)
+{
+	if (end_pos_ == 0)
+		time_origin_.store(timestamp, std::memory_order_relaxed);
+	++end_pos_;
+
+	Accumulator sample{ sample_bucket(timestamp, value), 1,
+		timestamp, value, timestamp, value };
+	for (size_t level = 0; level < level_count_; ++level) {
+		Accumulator &acc = accumulators_[level];
+		add_to_accumulator(acc, sample);
+		if (acc.count < ((size_t)1 << (base_shift_ + level)))
+			break;
+
+		// The bucket is complete, publish it and pass it to the next level
+		levels_[level]->push_back(acc.bucket);
+		sample = acc;
+		acc = empty_accumulator();
+	}
+}
+
+void MinMaxPyramid::drop_front(size_t begin_pos)
+{
+	for (size_t level = 0; level < level_count_; ++level) {
+		ChunkedBuffer<Bucket> &buckets = *levels_[level];
+		// Keep the bucket, that is only partly dropped
+		const size_t begin_bucket = begin_pos >> (base_shift_ + level);
+		if (begin_bucket <= buckets.begin_pos())
+			continue;
+		buckets.drop_front(begin_bucket - buckets.begin_pos());
+	}
+}
+
+void MinMaxPyramid::clear()
+{
+	for (size_t level = 0; level < level_count_; ++level) {
+		levels_[level]->clear();
+		accumulators_[level] = empty_accumulator();
+	}
+	end_pos_ = 0;
+}
+
+size_t MinMaxPyramid::memory_size() const
+{
+	size_t size = 0;
+	for (const auto &level : levels_)
+		size += level->memory_size();
+	return size;
+}
+
+bool MinMaxPyramid::summarize(const TimeBase &time, const ValueBuffer &values,
+	size_t first, size_t last, AnalogSummary &summary) const
+{
+	if (first >= last)
+		return false;
+
+	Bucket result = empty_accumulator().bucket;
+	size_t count = 0;
+	size_t pos = first;
+	double prev_timestamp = 0.;
+	double prev_value = 0.;
+	while (pos < last) {
+		// Find the biggest complete bucket, that starts at pos and ends
+		// before last.
+		size_t level = 0;
+		bool found = false;
+		while (level < level_count_) {
+			const unsigned int shift = base_shift_ + (unsigned int)level;
+			const size_t size = (size_t)1 << shift;
+			if ((pos & (size - 1)) != 0 || pos + size > last)
+				break;
+			const size_t index = pos >> shift;
+			if (index < levels_[level]->begin_pos() ||
+					index >= levels_[level]->end_pos())
+				break;
+			found = true;
+			++level;
+		}
+
+		// Integrate the segment from the previous sample to pos
+		const double timestamp = time.timestamp(pos);
+		const double value = values[pos];
+		if (pos > first) {
+			result.integral +=
+				trapezoid(prev_timestamp, prev_value, timestamp, value);
+		}
+
+		if (found) {
+			--level;
+			const unsigned int shift = base_shift_ + (unsigned int)level;
+			const size_t size = (size_t)1 << shift;
+			add_to_bucket(result, count,
+				(*levels_[level])[pos >> shift], size);
+			pos += size;
+			prev_timestamp = time.timestamp(pos - 1);
+			prev_value = values[pos - 1];
+		}
+		else {
+			add_to_bucket(result, count, sample_bucket(timestamp, value), 1);
+			++pos;
+			prev_timestamp = timestamp;
+			prev_value = value;
+		}
+	}
+
+	summary.min = result.min;
+	summary.max = result.max;
+	summary.mean = result.sum / (double)count;
+	summary.rms = std::sqrt(result.sum_squares / (double)count);
+	summary.integral = result.integral;
+	summary.slope = result.time_deviations > 0. ?
+		result.time_value_deviations / result.time_deviations : 0.;
+	summary.sample_count = count;
+	return true;
+}
+
+} // namespace data
+} // namespace sv
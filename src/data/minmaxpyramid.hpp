@@ -0,0 +1,173 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_MINMAXPYRAMID_HPP
+#define DATA_MINMAXPYRAMID_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "src/data/chunkedbuffer.hpp"
+
+using std::unique_ptr;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+class TimeBase;
+class ValueBuffer;
+
+/**
+ * Min, max, mean, RMS, integral and slope of a range of samples.
+ */
+struct AnalogSummary
+{
+	double start_timestamp;
+	double end_timestamp;
+	double min;
+	double max;
+	double mean;
+	/** The root mean square of the values. */
+	double rms;
+	/** The integral over time (trapezoidal rule), in value * seconds. */
+	double integral;
+	/**
+	 * The slope of the least squares line through the samples, in value /
+	 * second. 0 if all samples have the same timestamp.
+	 */
+	double slope;
+	size_t sample_count;
+};
+
+/**
+ * A multi-resolution min/max/sum/integral index over the values of a signal.
+ *
+ * Level 0 combines 2^base_shift_ samples into one bucket, every following
+ * level combines two buckets of the previous level. The buckets are
+ * appended incrementally while samples are pushed, so the min/max/mean,
+ * the RMS, the integral and the regression slope of any position range can
+ * be calculated in O(log n).
+ *
+ * The buckets hold the centered moments of the timestamps, that are merged
+ * pairwise, so the slope stays accurate for short ranges of a long capture.
+ *
+ * Buckets are addressed by the absolute sample position, the same
+ * concurrency rules as for ChunkedBuffer apply: One (serialized) writer and
+ * any number of lock-free readers, that validate their reads against the
+ * sample buffers.
+ */
+class MinMaxPyramid
+{
+public:
+	MinMaxPyramid();
+
+	MinMaxPyramid(const MinMaxPyramid &) = delete;
+	MinMaxPyramid &operator=(const MinMaxPyramid &) = delete;
+
+	/**
+	 * Add the next sample. The pyramid must see every sample of the signal,
+	 * in the order of the sample positions.
+	 */
+	void push_back(double timestamp, double value);
+
+	/**
+	 * Release all buckets before the given absolute sample position.
+	 */
+	void drop_front(size_t begin_pos);
+	void clear();
+
+	/** Return the number of bytes of all levels. */
+	size_t memory_size() const;
+
+	/**
+	 * Calculate the summary of the samples in [first, last), without the
+	 * start and end timestamps. Samples, that are not (yet) covered by a
+	 * complete bucket, and the segments between two buckets are read from
+	 * time and values.
+	 *
+	 * @return false if the range is empty.
+	 */
+	bool summarize(const TimeBase &time, const ValueBuffer &values,
+		size_t first, size_t last, AnalogSummary &summary) const;
+
+private:
+	struct Bucket
+	{
+		double min;
+		double max;
+		double sum;
+		double sum_squares;
+		/** The integral between the first and the last sample of the bucket. */
+		double integral;
+		/** The mean timestamp, relative to time_origin_. */
+		double mean_time;
+		/** The sum of the squared deviations of the timestamps from the mean. */
+		double time_deviations;
+		/** The sum of the products of the time and value deviations. */
+		double time_value_deviations;
+	};
+
+	/**
+	 * A bucket under construction. The first and the last sample are needed
+	 * to integrate the segment to the neighbouring bucket.
+	 */
+	struct Accumulator
+	{
+		Bucket bucket;
+		size_t count;
+		double first_timestamp;
+		double first_value;
+		double last_timestamp;
+		double last_value;
+	};
+
+	static void add_to_bucket(Bucket &bucket, size_t &count,
+		const Bucket &other, size_t other_count);
+	static void add_to_accumulator(Accumulator &acc, const Accumulator &other);
+	static Accumulator empty_accumulator();
+	Bucket sample_bucket(double timestamp, double value) const;
+	static double trapezoid(double timestamp1, double value1,
+		double timestamp2, double value2);
+
+	/** Number of samples in a level 0 bucket as exponent of 2. */
+	static const unsigned int base_shift_ = 4;
+	/** Number of levels, enough for 2^(4+36) samples. */
+	static const size_t level_count_ = 36;
+	/** Small chunks, most levels only hold a few buckets. */
+	static const unsigned int chunk_size_exp_ = 8;
+
+	vector<unique_ptr<ChunkedBuffer<Bucket>>> levels_;
+	/** The open (incomplete) bucket of every level, only for the writer. */
+	vector<Accumulator> accumulators_;
+	size_t end_pos_;
+	/**
+	 * The timestamp of the first sample. The time moments are relative to it,
+	 * so they don't lose their precision with absolute timestamps.
+	 */
+	std::atomic<double> time_origin_;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_MINMAXPYRAMID_HPP
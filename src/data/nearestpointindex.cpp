@@ -0,0 +1,165 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include "nearestpointindex.hpp"
+
+using std::vector;
+
+namespace sv {
+namespace data {
+
+const size_t NearestPointIndex::buffer_size_ = 64;
+const size_t NearestPointIndex::leaf_size_ = 8;
+
+NearestPointIndex::NearestPointIndex() :
+	size_(0)
+{
+	buffer_.reserve(buffer_size_);
+}
+
+void NearestPointIndex::append(const double *x, const double *y,
+	size_t count)
+{
+	for (size_t i = 0; i < count; ++i) {
+		const size_t index = size_++;
+		if (!std::isfinite(x[i]) || !std::isfinite(y[i]))
+			continue;
+
+		buffer_.push_back(Point{ x[i], y[i], index });
+		if (buffer_.size() == buffer_size_)
+			flush_buffer();
+	}
+}
+
+void NearestPointIndex::clear()
+{
+	buffer_.clear();
+	trees_.clear();
+	size_ = 0;
+}
+
+size_t NearestPointIndex::size() const
+{
+	return size_;
+}
+
+bool NearestPointIndex::nearest(double x, double y,
+	size_t &index, double &distance_squared) const
+{
+	const Point *best = nullptr;
+	double best_distance = std::numeric_limits<double>::infinity();
+	scan(buffer_, 0, buffer_.size(), x, y, best, best_distance);
+	for (const auto &tree : trees_) {
+		if (!tree.empty())
+			search(tree, 0, tree.size(), true, x, y, best, best_distance);
+	}
+	if (best == nullptr)
+		return false;
+
+	index = best->index;
+	distance_squared = best_distance;
+	return true;
+}
+
+void NearestPointIndex::flush_buffer()
+{
+	// Like a binary counter: Merge the carry with the trees of the same
+	// size, until there is a free level.
+	vector<Point> carry;
+	carry.swap(buffer_);
+	buffer_.reserve(buffer_size_);
+	size_t level = 0;
+	while (level < trees_.size() && !trees_[level].empty()) {
+		carry.insert(carry.end(), trees_[level].begin(), trees_[level].end());
+		vector<Point>().swap(trees_[level]);
+		++level;
+	}
+	if (level == trees_.size())
+		trees_.emplace_back();
+	build(carry, 0, carry.size(), true);
+	trees_[level].swap(carry);
+}
+
+void NearestPointIndex::build(vector<Point> &tree, size_t first, size_t last,
+	bool split_x)
+{
+	if (last - first <= leaf_size_)
+		return;
+
+	// The median is the node, the halves are the subtrees
+	const size_t mid = first + (last - first) / 2;
+	std::nth_element(tree.begin() + first, tree.begin() + mid,
+		tree.begin() + last,
+		[split_x](const Point &a, const Point &b) {
+			return split_x ? a.x < b.x : a.y < b.y;
+		});
+	build(tree, first, mid, !split_x);
+	build(tree, mid + 1, last, !split_x);
+}
+
+void NearestPointIndex::search(const vector<Point> &tree,
+	size_t first, size_t last, bool split_x, double x, double y,
+	const Point *&best, double &best_distance)
+{
+	if (last - first <= leaf_size_) {
+		scan(tree, first, last, x, y, best, best_distance);
+		return;
+	}
+
+	const size_t mid = first + (last - first) / 2;
+	scan(tree, mid, mid + 1, x, y, best, best_distance);
+
+	// Search the half with the position first, the other half only if it
+	// can contain a closer point.
+	const double diff = split_x ? x - tree[mid].x : y - tree[mid].y;
+	if (diff < 0) {
+		search(tree, first, mid, !split_x, x, y, best, best_distance);
+		if (diff * diff < best_distance)
+			search(tree, mid + 1, last, !split_x, x, y, best, best_distance);
+	}
+	else {
+		search(tree, mid + 1, last, !split_x, x, y, best, best_distance);
+		if (diff * diff < best_distance)
+			search(tree, first, mid, !split_x, x, y, best, best_distance);
+	}
+}
+
+void NearestPointIndex::scan(const vector<Point> &points,
+	size_t first, size_t last, double x, double y,
+	const Point *&best, double &best_distance)
+{
+	for (size_t i = first; i < last; ++i) {
+		const double dx = points[i].x - x;
+		const double dy = points[i].y - y;
+		const double distance = dx * dx + dy * dy;
+		if (distance < best_distance) {
+			best_distance = distance;
+			best = &points[i];
+		}
+	}
+}
+
+} // namespace data
+} // namespace sv
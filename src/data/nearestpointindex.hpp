@@ -0,0 +1,99 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_NEARESTPOINTINDEX_HPP
+#define DATA_NEARESTPOINTINDEX_HPP
+
+#include <cstddef>
+#include <vector>
+
+using std::vector;
+
+namespace sv {
+namespace data {
+
+/**
+ * A spatial index over 2D points, that are appended incrementally, to find
+ * the point closest to a position (e.g. for plot markers of an XY curve).
+ *
+ * The points are stored in k-d trees of growing (power of two) sizes. New
+ * points are collected in a small buffer, a full buffer is merged with the
+ * trees of the same size into a new tree (the "logarithmic method"). So an
+ * append costs O(log^2 n) amortized and a query O(log^2 n), instead of a
+ * scan over all points. Non finite points are skipped.
+ */
+class NearestPointIndex
+{
+public:
+	NearestPointIndex();
+
+	/**
+	 * Append count points. The points get the consecutive indices after
+	 * the previously appended points.
+	 */
+	void append(const double *x, const double *y, size_t count);
+	void clear();
+
+	/** The number of appended points, including the skipped ones. */
+	size_t size() const;
+
+	/**
+	 * Find the point with the smallest euclidean distance to (x, y).
+	 *
+	 * @return false if the index contains no points.
+	 */
+	bool nearest(double x, double y,
+		size_t &index, double &distance_squared) const;
+
+private:
+	struct Point
+	{
+		double x;
+		double y;
+		size_t index;
+	};
+
+	/** Build the tree over the points in [first, last). */
+	static void build(vector<Point> &tree, size_t first, size_t last,
+		bool split_x);
+	static void search(const vector<Point> &tree, size_t first, size_t last,
+		bool split_x, double x, double y,
+		const Point *&best, double &best_distance);
+	static void scan(const vector<Point> &points, size_t first, size_t last,
+		double x, double y, const Point *&best, double &best_distance);
+
+	/** Merge the full buffer into the trees. */
+	void flush_buffer();
+
+	/** The number of points in buffer_, that are merged into a tree. */
+	static const size_t buffer_size_;
+	/** Subtrees with up to this number of points are scanned linearly. */
+	static const size_t leaf_size_;
+
+	vector<Point> buffer_;
+	/** trees_[k] is empty or contains buffer_size_ * 2^k points. */
+	vector<vector<Point>> trees_;
+	size_t size_;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_NEARESTPOINTINDEX_HPP
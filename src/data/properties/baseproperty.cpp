@@ -17,24 +17,36 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <chrono>
+#include <exception>
+#include <mutex>
 #include <string>
 
 #include <QDebug>
 
 #include "baseproperty.hpp"
+#include "src/executor.hpp"
 #include "src/devices/configurable.hpp"
 #include "src/devices/deviceutil.hpp"
 
+using std::lock_guard;
+using std::mutex;
 using std::string;
 
 namespace sv {
 namespace data {
 namespace properties {
 
+const int BaseProperty::default_cache_ttl_ = 1000;
+
 BaseProperty::BaseProperty(shared_ptr<devices::Configurable> configurable,
 		devices::ConfigKey config_key) :
 	configurable_(configurable),
-	config_key_(config_key)
+	config_key_(config_key),
+	has_cached_value_(false),
+	cache_ttl_(default_cache_ttl_),
+	is_refreshing_(false),
+	write_id_(0)
 {
 	data_type_ = devices::deviceutil::get_data_type_for_config_key(config_key_);
 	//quantity_ = data::Quantity::Unknown; // TODO
@@ -42,6 +54,11 @@ BaseProperty::BaseProperty(shared_ptr<devices::Configurable> configurable,
 	is_getable_ = configurable_->has_get_config(config_key_);
 	is_setable_ = configurable_->has_set_config(config_key_);
 	is_listable_ = configurable_->has_list_config(config_key_);
+
+	connect(this, &BaseProperty::value_refreshed,
+		this, &BaseProperty::on_value_refreshed, Qt::QueuedConnection);
+	connect(this, &BaseProperty::value_written,
+		this, &BaseProperty::on_value_written, Qt::QueuedConnection);
 }
 
 shared_ptr<devices::Configurable> BaseProperty::configurable() const
@@ -96,6 +113,151 @@ QString BaseProperty::display_name() const
 	return devices::deviceutil::format_config_key(config_key_);
 }
 
+QVariant BaseProperty::value() const
+{
+	const int ttl = cache_ttl_;
+	if (ttl == 0)
+		return read_value();
+
+	{
+		lock_guard<mutex> lock(cache_mutex_);
+		if (has_cached_value_) {
+			if (std::chrono::steady_clock::now() - cache_time_ >=
+					std::chrono::milliseconds(ttl))
+				refresh_value();
+			return cached_value_;
+		}
+	}
+
+	// There is nothing to return yet, so the first read has to block
+	QVariant qvar = read_value();
+	lock_guard<mutex> lock(cache_mutex_);
+	if (!has_cached_value_) {
+		cached_value_ = qvar;
+		cache_time_ = std::chrono::steady_clock::now();
+		has_cached_value_ = true;
+	}
+	return qvar;
+}
+
+void BaseProperty::refresh_value() const
+{
+	if (!is_getable_ || is_refreshing_.exchange(true))
+		return;
+
+	// The configurable owns the property, so it is kept alive by the task.
+	// The read waits for the device, so it runs in the I/O pool.
+	shared_ptr<devices::Configurable> configurable = configurable_;
+	BaseProperty *property = const_cast<BaseProperty *>(this);
+	Executor::run_io([configurable, property]() {
+		QVariant qvar;
+		try {
+			qvar = property->read_value();
+		}
+		catch (std::exception &e) {
+			qWarning() << "BaseProperty::refresh_value(): Failed to read " <<
+				property->display_name() << ": " << e.what();
+		}
+		Q_EMIT property->value_refreshed(qvar);
+	});
+}
+
+QVariant BaseProperty::poll_value()
+{
+	QVariant qvar;
+	try {
+		qvar = read_value();
+	}
+	catch (std::exception &e) {
+		qWarning() << "BaseProperty::poll_value(): Failed to read " <<
+			display_name() << ": " << e.what();
+	}
+	if (qvar.isValid())
+		Q_EMIT value_refreshed(qvar);
+	return qvar;
+}
+
+bool BaseProperty::cached_value(QVariant &qvar) const
+{
+	const int ttl = cache_ttl_;
+	if (ttl == 0)
+		return false;
+
+	lock_guard<mutex> lock(cache_mutex_);
+	if (!has_cached_value_ || std::chrono::steady_clock::now() - cache_time_ >=
+			std::chrono::milliseconds(ttl))
+		return false;
+	qvar = cached_value_;
+	return true;
+}
+
+void BaseProperty::written_value(const QVariant &qvar)
+{
+	++write_id_;
+	update_value(qvar);
+}
+
+int BaseProperty::cache_ttl() const
+{
+	return cache_ttl_;
+}
+
+void BaseProperty::set_cache_ttl(int cache_ttl)
+{
+	cache_ttl_ = cache_ttl;
+}
+
+void BaseProperty::update_value(const QVariant &qvar)
+{
+	{
+		lock_guard<mutex> lock(cache_mutex_);
+		cached_value_ = qvar;
+		cache_time_ = std::chrono::steady_clock::now();
+		has_cached_value_ = true;
+	}
+	Q_EMIT value_changed(qvar);
+}
+
+std::function<void(bool)> BaseProperty::write_done(const QVariant &qvar)
+{
+	const unsigned int write_id = ++write_id_;
+	return [this, qvar, write_id](bool ok) {
+		Q_EMIT value_written(qvar, ok, write_id);
+	};
+}
+
+void BaseProperty::on_value_written(const QVariant &qvar, bool ok,
+	unsigned int write_id)
+{
+	// A newer write is still pending and will be reported, the controls
+	// must not jump back to an older value.
+	if (write_id != write_id_)
+		return;
+
+	if (ok)
+		update_value(qvar);
+	else
+		refresh_value();
+}
+
+void BaseProperty::on_value_refreshed(const QVariant &qvar)
+{
+	is_refreshing_ = false;
+	if (!qvar.isValid())
+		return;
+
+	bool changed;
+	{
+		lock_guard<mutex> lock(cache_mutex_);
+		changed = !has_cached_value_ || cached_value_ != qvar;
+		cached_value_ = qvar;
+		cache_time_ = std::chrono::steady_clock::now();
+		has_cached_value_ = true;
+	}
+	if (changed)
+		Q_EMIT value_changed(qvar);
+}
+
 } // namespace properties
 } // namespace data
 } // namespace sv
@@ -20,7 +20,11 @@
 #ifndef DATA_PROPERTIES_BASEPROPERTY_HPP
 #define DATA_PROPERTIES_BASEPROPERTY_HPP
 
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 
 #include <glib.h>
@@ -62,11 +66,66 @@ public:
 	bool is_listable() const;
 	string name() const;
 	QString display_name() const;
-	virtual QVariant value() const = 0;
+	/**
+	 * Return the cached value of the property. Only the first call reads the
+	 * value from the device, later calls don't block. The cache is updated
+	 * by change_value() and by the meta packets of the device. A value, that
+	 * is older than cache_ttl(), is returned and refreshed in the background,
+	 * value_changed() is emitted, when the refreshed value differs.
+	 */
+	QVariant value() const;
+	/**
+	 * Read the value from the device. This blocks until the device has
+	 * answered and doesn't touch the cache.
+	 */
+	virtual QVariant read_value() const = 0;
+	/**
+	 * Refresh the cached value in a background thread. Does nothing, if a
+	 * refresh is already running.
+	 */
+	void refresh_value() const;
+	/**
+	 * Read the value from the device in the calling thread and update the
+	 * cache like refresh_value(). Used by the StateMonitor.
+	 *
+	 * @return The read value or an invalid QVariant, if the read failed.
+	 */
+	QVariant poll_value();
+	/**
+	 * Get the cached value without reading the device.
+	 *
+	 * @return false if there is no cached value or if it is older than
+	 *         cache_ttl().
+	 */
+	bool cached_value(QVariant &qvar) const;
+	/**
+	 * Cache a value, that has been written by the configurable, and emit
+	 * value_changed(). Pending older writes of this property are no longer
+	 * reported, see Configurable::set_configs().
+	 */
+	void written_value(const QVariant &qvar);
+	/** Return the time to live of a cached value in ms. */
+	int cache_ttl() const;
+	/**
+	 * Set the time to live of a cached value in ms. With 0, the value is
+	 * read from the device for every call of value().
+	 */
+	void set_cache_ttl(int cache_ttl);
 	virtual QString to_string(const QVariant &qvar) const = 0;
 	virtual QString to_string() const = 0;
 
 protected:
+	/** Store the value in the cache and emit value_changed(). */
+	void update_value(const QVariant &qvar);
+	/**
+	 * Return the done function for a Configurable::post_config() of the
+	 * value. When the latest write of the property has finished, the value
+	 * is cached and value_changed() is emitted in the thread of the
+	 * property. After a failed write, the value is refreshed from the
+	 * device.
+	 */
+	std::function<void(bool)> write_done(const QVariant &qvar);
+
 	shared_ptr<devices::Configurable> configurable_;
 	devices::ConfigKey config_key_;
 	data::DataType data_type_;
@@ -76,6 +135,23 @@ protected:
 	bool is_setable_;
 	bool is_listable_;
 
+private:
+	static const int default_cache_ttl_;
+
+	mutable std::mutex cache_mutex_;
+	mutable QVariant cached_value_;
+	mutable bool has_cached_value_;
+	mutable std::chrono::steady_clock::time_point cache_time_;
+	std::atomic<int> cache_ttl_;
+	mutable std::atomic<bool> is_refreshing_;
+	/** Identifies the latest write, older writes are not reported. */
+	std::atomic<unsigned int> write_id_;
+
+private Q_SLOTS:
+	void on_value_refreshed(const QVariant &qvar);
+	void on_value_written(const QVariant &qvar, bool ok,
+		unsigned int write_id);
+
 public Q_SLOTS:
 	/**
 	 * Load the list of available values for this property.
@@ -93,6 +169,13 @@ public Q_SLOTS:
 Q_SIGNALS:
 	void value_changed(const QVariant &qvar);
 	void list_changed();
+	/**
+	 * Emitted by the refresh thread, the cache is updated in the thread of
+	 * the property. An invalid value means the read has failed.
+	 */
+	void value_refreshed(const QVariant &qvar);
+	/** Emitted by the config worker, when a write has finished. */
+	void value_written(const QVariant &qvar, bool ok, unsigned int write_id);
 
 };
 
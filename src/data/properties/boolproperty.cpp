@@ -34,14 +34,20 @@ BoolProperty::BoolProperty(shared_ptr<devices::Configurable> configurable,
 {
 }
 
-QVariant BoolProperty::value() const
+QVariant BoolProperty::read_value() const
 {
-	return QVariant(bool_value());
+	return QVariant(configurable_->get_config<bool>(config_key_));
 }
 
 bool BoolProperty::bool_value() const
 {
-	return configurable_->get_config<bool>(config_key_);
+	return value().toBool();
+}
+
+void BoolProperty::write_value(bool value)
+{
+	configurable_->set_config(config_key_, value);
+	update_value(QVariant(value));
 }
 
 QString BoolProperty::to_string(bool value) const
@@ -67,13 +73,12 @@ bool BoolProperty::list_config()
 
 void BoolProperty::change_value(const QVariant &qvar)
 {
-	configurable_->set_config(config_key_, qvar.toBool());
-	Q_EMIT value_changed(qvar);
+	configurable_->post_config(config_key_, qvar.toBool(), write_done(qvar));
 }
 
 void BoolProperty::on_value_changed(Glib::VariantBase gvar)
 {
-	Q_EMIT value_changed(QVariant(g_variant_get_boolean(gvar.gobj())));
+	update_value(QVariant(g_variant_get_boolean(gvar.gobj())));
 }
 
 } // namespace properties
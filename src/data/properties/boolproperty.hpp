@@ -51,8 +51,13 @@ public:
 		devices::ConfigKey config_key);
 
 public:
-	QVariant value() const override;
+	QVariant read_value() const override;
 	bool bool_value() const;
+	/**
+	 * Write the value and wait for the device, unlike change_value(). For
+	 * timed writes, e.g. selecting the channels of a scan list.
+	 */
+	void write_value(bool value);
 	QString to_string(bool value) const;
 	QString to_string(const QVariant &qvar) const override;
 	QString to_string() const override;
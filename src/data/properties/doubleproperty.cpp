@@ -47,14 +47,32 @@ DoubleProperty::DoubleProperty(shared_ptr<devices::Configurable> configurable,
 	}
 }
 
-QVariant DoubleProperty::value() const
+QVariant DoubleProperty::read_value() const
 {
-	return QVariant(double_value());
+	return QVariant(configurable_->get_config<double>(config_key_));
 }
 
 double DoubleProperty::double_value() const
 {
-	return configurable_->get_config<double>(config_key_);
+	return value().toDouble();
+}
+
+void DoubleProperty::write_value(double value)
+{
+	configurable_->set_config(config_key_, value);
+	update_value(QVariant(value));
+}
+
+void DoubleProperty::post_value(double value,
+	std::function<void(bool)> done)
+{
+	auto cache_done = write_done(QVariant(value));
+	configurable_->post_config(config_key_, value,
+		[cache_done, done](bool ok) {
+			cache_done(ok);
+			if (done)
+				done(ok);
+		});
 }
 
 QString DoubleProperty::to_string(double value) const
@@ -122,13 +140,13 @@ bool DoubleProperty::list_config()
 
 void DoubleProperty::change_value(const QVariant &qvar)
 {
-	configurable_->set_config(config_key_, qvar.toDouble());
-	Q_EMIT value_changed(qvar);
+	configurable_->post_config(config_key_, qvar.toDouble(),
+		write_done(qvar));
 }
 
 void DoubleProperty::on_value_changed(Glib::VariantBase gvar)
 {
-	Q_EMIT value_changed(QVariant(g_variant_get_double(gvar.gobj())));
+	update_value(QVariant(g_variant_get_double(gvar.gobj())));
 }
 
 } // namespace properties
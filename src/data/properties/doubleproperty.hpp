@@ -20,6 +20,7 @@
 #ifndef DATA_PROPERTIES_DOUBLEPROPERTY_HPP
 #define DATA_PROPERTIES_DOUBLEPROPERTY_HPP
 
+#include <functional>
 #include <memory>
 
 #include <glib.h>
@@ -52,8 +53,20 @@ public:
 		devices::ConfigKey config_key);
 
 public:
-	QVariant value() const override;
+	QVariant read_value() const override;
 	double double_value() const;
+	/**
+	 * Write the value and wait for the device, unlike change_value(). For
+	 * timed writes, e.g. the steps of a sequence.
+	 */
+	void write_value(double value);
+	/**
+	 * Write the value in the config worker of the device without waiting
+	 * for it, like change_value(). done is called with the result in the
+	 * worker thread, the value is cached like in change_value(). done is not
+	 * called, when the write is superseded by a newer write of the property.
+	 */
+	void post_value(double value, std::function<void(bool)> done);
 	QString to_string(double value) const;
 	QString to_string(const QVariant &qvar) const override;
 	QString to_string() const override;
@@ -46,12 +46,7 @@ DoubleRangeProperty::DoubleRangeProperty(
 		DoubleRangeProperty::list_config();
 }
 
-QVariant DoubleRangeProperty::value() const
-{
-	return QVariant::fromValue(double_range_value());
-}
-
-double_range_t DoubleRangeProperty::double_range_value() const
+QVariant DoubleRangeProperty::read_value() const
 {
 	Glib::VariantContainerBase gvar =
 		configurable_->get_container_config(config_key_);
@@ -59,7 +54,7 @@ double_range_t DoubleRangeProperty::double_range_value() const
 	size_t child_cnt = gvar.get_n_children();
 	if (child_cnt != 2) {
 		throw std::runtime_error(QString(
-			"DoubleRangeProperty::double_range_value(): ").append(
+			"DoubleRangeProperty::read_value(): ").append(
 			"container should have 2 child, but has %1").arg(child_cnt).
 			toStdString());
 	}
@@ -72,7 +67,12 @@ double_range_t DoubleRangeProperty::double_range_value() const
 	double high =
 		Glib::VariantBase::cast_dynamic<Glib::Variant<double>>(gvar).get();
 
-	return make_pair(low, high);
+	return QVariant::fromValue(make_pair(low, high));
+}
+
+double_range_t DoubleRangeProperty::double_range_value() const
+{
+	return value().value<double_range_t>();
 }
 
 QString DoubleRangeProperty::to_string(data::double_range_t value) const
@@ -140,8 +140,8 @@ void DoubleRangeProperty::change_value(const QVariant &qvar)
 	gcontainer.push_back(gvar_low);
 	gcontainer.push_back(gvar_high);
 
-	configurable_->set_container_config(config_key_, gcontainer);
-	Q_EMIT value_changed(qvar);
+	configurable_->post_container_config(config_key_, gcontainer,
+		write_done(qvar));
 }
 
 void DoubleRangeProperty::on_value_changed(Glib::VariantBase gvar)
@@ -154,7 +154,7 @@ void DoubleRangeProperty::on_value_changed(Glib::VariantBase gvar)
 	double high =
 		Glib::VariantBase::cast_dynamic<Glib::Variant<double>>(gvar).get();
 
-	Q_EMIT value_changed(QVariant::fromValue(make_pair(low, high)));
+	update_value(QVariant::fromValue(make_pair(low, high)));
 }
 
 } // namespace properties
@@ -41,14 +41,14 @@ Int32Property::Int32Property(shared_ptr<devices::Configurable> configurable,
 		Int32Property::list_config();
 }
 
-QVariant Int32Property::value() const
+QVariant Int32Property::read_value() const
 {
-	return QVariant(int32_value());
+	return QVariant(configurable_->get_config<int32_t>(config_key_));
 }
 
 int32_t Int32Property::int32_value() const
 {
-	return configurable_->get_config<int32_t>(config_key_);
+	return value().toInt();
 }
 
 QString Int32Property::to_string(int32_t value) const
@@ -106,13 +106,12 @@ bool Int32Property::list_config()
 
 void Int32Property::change_value(const QVariant &qvar)
 {
-	configurable_->set_config(config_key_, qvar.toInt());
-	Q_EMIT value_changed(qvar);
+	configurable_->post_config(config_key_, qvar.toInt(), write_done(qvar));
 }
 
 void Int32Property::on_value_changed(Glib::VariantBase gvar)
 {
-	Q_EMIT value_changed(QVariant(g_variant_get_int32(gvar.gobj())));
+	update_value(QVariant(g_variant_get_int32(gvar.gobj())));
 }
 
 } // namespace properties
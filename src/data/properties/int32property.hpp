@@ -51,7 +51,7 @@ public:
 		devices::ConfigKey config_key);
 
 public:
-	QVariant value() const override;
+	QVariant read_value() const override;
 	int32_t int32_value() const;
 	int32_t min() const;
 	int32_t max() const;
@@ -51,15 +51,16 @@ MeasuredQuantityProperty::MeasuredQuantityProperty(
 		MeasuredQuantityProperty::list_config();
 }
 
-QVariant MeasuredQuantityProperty::value() const
+QVariant MeasuredQuantityProperty::read_value() const
 {
-	return QVariant::fromValue(measured_quantity_value());
+	return QVariant::fromValue(
+		configurable_->get_measured_quantity_config(config_key_));
 }
 
 data::measured_quantity_t
 MeasuredQuantityProperty::measured_quantity_value() const
 {
-	return configurable_->get_measured_quantity_config(config_key_);
+	return value().value<data::measured_quantity_t>();
 }
 
 QString MeasuredQuantityProperty::to_string(
@@ -112,13 +113,16 @@ bool MeasuredQuantityProperty::list_config()
 void MeasuredQuantityProperty::change_value(const QVariant &qvar)
 {
 	data::measured_quantity_t mq = qvar.value<data::measured_quantity_t>();
-	configurable_->set_measured_quantity_config(config_key_, mq);
-	Q_EMIT value_changed(qvar);
+	configurable_->post_measured_quantity_config(config_key_, mq,
+		write_done(qvar));
 }
 
 void MeasuredQuantityProperty::on_value_changed(Glib::VariantBase gvar)
 {
+	// The string of the meta packet is no measured quantity, so it isn't
+	// cached. The cached value is read from the device again.
 	Q_EMIT value_changed(QVariant(g_variant_get_string(gvar.gobj(), nullptr)));
+	refresh_value();
 }
 
 } // namespace properties
@@ -52,7 +52,7 @@ public:
 		devices::ConfigKey config_key);
 
 public:
-	QVariant value() const override;
+	QVariant read_value() const override;
 	data::measured_quantity_t measured_quantity_value() const;
 	vector<data::measured_quantity_t> list_values() const;
 	QString to_string(const data::measured_quantity_t &value) const;
@@ -50,18 +50,13 @@ RationalProperty::RationalProperty(
 		RationalProperty::list_config();
 }
 
-QVariant RationalProperty::value() const
-{
-	return QVariant::fromValue(rational_value());
-}
-
 /**
  * TODO: When glibmm >= 2.52 is more supported and tuple bug is fixed,
  *       use the template function and return tuple<uint64_t, uint64_t>:
  *
  *       return get_config<std::tuple<uint32_t, uint64_t>>(sigrok::ConfigKey);
  */
-data::rational_t RationalProperty::rational_value() const
+QVariant RationalProperty::read_value() const
 {
 	Glib::VariantContainerBase gvar =
 		configurable_->get_container_config(config_key_);
@@ -69,7 +64,7 @@ data::rational_t RationalProperty::rational_value() const
 	size_t child_cnt = gvar.get_n_children();
 	if (child_cnt != 2) {
 		throw std::runtime_error(QString(
-			"RationalProperty::rational_value(): ").append(
+			"RationalProperty::read_value(): ").append(
 			"container should have 2 child, but has %1").arg(child_cnt).
 			toStdString());
 	}
@@ -82,7 +77,12 @@ data::rational_t RationalProperty::rational_value() const
 	uint64_t q =
 		Glib::VariantBase::cast_dynamic<Glib::Variant<uint64_t>>(gvar).get();
 
-	return make_pair(p, q);
+	return QVariant::fromValue(make_pair(p, q));
+}
+
+data::rational_t RationalProperty::rational_value() const
+{
+	return value().value<data::rational_t>();
 }
 
 QString RationalProperty::to_string(data::rational_t value) const
@@ -152,8 +152,8 @@ void RationalProperty::change_value(const QVariant &qvar)
 	gcontainer.push_back(gvar_p);
 	gcontainer.push_back(gvar_q);
 
-	configurable_->set_container_config(config_key_, gcontainer);
-	Q_EMIT value_changed(qvar);
+	configurable_->post_container_config(config_key_, gcontainer,
+		write_done(qvar));
 }
 
 void RationalProperty::on_value_changed(Glib::VariantBase gvar)
@@ -166,7 +166,7 @@ void RationalProperty::on_value_changed(Glib::VariantBase gvar)
 	uint64_t q =
 		Glib::VariantBase::cast_dynamic<Glib::Variant<uint64_t>>(gvar).get();
 
-	Q_EMIT value_changed(QVariant::fromValue(make_pair(p, q)));
+	update_value(QVariant::fromValue(make_pair(p, q)));
 }
 
 } // namespace properties
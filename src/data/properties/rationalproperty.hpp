@@ -53,7 +53,7 @@ public:
 		devices::ConfigKey config_key);
 
 public:
-	QVariant value() const override;
+	QVariant read_value() const override;
 	data::rational_t rational_value() const;
 	QString to_string(data::rational_t value) const;
 	QString to_string(const QVariant &qvar) const override;
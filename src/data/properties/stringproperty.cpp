@@ -45,15 +45,15 @@ StringProperty::StringProperty(shared_ptr<devices::Configurable> configurable,
 	}
 }
 
-QVariant StringProperty::value() const
+QVariant StringProperty::read_value() const
 {
-	return QVariant(string_value());
+	return QVariant(QString::fromStdString(
+		configurable_->get_config<string>(config_key_)));
 }
 
 QString StringProperty::string_value() const
 {
-	return QString::fromStdString(
-		configurable_->get_config<string>(config_key_));
+	return value().toString();
 }
 
 QString StringProperty::to_string(const QVariant &qvar) const
@@ -94,14 +94,14 @@ void StringProperty::change_value(const QVariant &qvar)
 {
 	// We have to use Glib::ustring here, to get a variant type of 's'.
 	// std::string will create a variant type of 'ay'
-	configurable_->set_config<Glib::ustring>(
-		config_key_, Glib::ustring(qvar.toString().toStdString()));
-	Q_EMIT value_changed(qvar);
+	configurable_->post_config<Glib::ustring>(
+		config_key_, Glib::ustring(qvar.toString().toStdString()),
+		write_done(qvar));
 }
 
 void StringProperty::on_value_changed(Glib::VariantBase gvar)
 {
-	Q_EMIT value_changed(QVariant(g_variant_get_string(gvar.gobj(), nullptr)));
+	update_value(QVariant(g_variant_get_string(gvar.gobj(), nullptr)));
 }
 
 } // namespace properties
@@ -54,7 +54,7 @@ public:
 		devices::ConfigKey config_key);
 
 public:
-	QVariant value() const override;
+	QVariant read_value() const override;
 	QString string_value() const;
 	QStringList list_values() const;
 	QString to_string(const QVariant &qvar) const override;
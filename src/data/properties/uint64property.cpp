@@ -48,14 +48,15 @@ UInt64Property::UInt64Property(shared_ptr<devices::Configurable> configurable,
 		UInt64Property::list_config();
 }
 
-QVariant UInt64Property::value() const
+QVariant UInt64Property::read_value() const
 {
-	return QVariant((qulonglong)uint64_value());
+	return QVariant(
+		(qulonglong)configurable_->get_config<uint64_t>(config_key_));
 }
 
 uint64_t UInt64Property::uint64_value() const
 {
-	return configurable_->get_config<uint64_t>(config_key_);
+	return (uint64_t)value().toULongLong();
 }
 
 QString UInt64Property::to_string(uint64_t value) const
@@ -176,13 +177,13 @@ void UInt64Property::change_value(const QVariant &qvar)
 			new_qvar.setValue((qulonglong)20000);
 	}
 
-	configurable_->set_config(config_key_, (uint64_t)new_qvar.toULongLong());
-	Q_EMIT value_changed(new_qvar);
+	configurable_->post_config(config_key_, (uint64_t)new_qvar.toULongLong(),
+		write_done(new_qvar));
 }
 
 void UInt64Property::on_value_changed(Glib::VariantBase gvar)
 {
-	Q_EMIT value_changed(QVariant(
+	update_value(QVariant(
 		(qulonglong)g_variant_get_uint64(gvar.gobj())));
 }
 
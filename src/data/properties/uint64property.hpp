@@ -51,7 +51,7 @@ public:
 		devices::ConfigKey config_key);
 
 public:
-	QVariant value() const override;
+	QVariant read_value() const override;
 	uint64_t uint64_value() const;
 	QString to_string(uint64_t value) const;
 	QString to_string(const QVariant &qvar) const override;
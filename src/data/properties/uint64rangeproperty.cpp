@@ -49,18 +49,13 @@ UInt64RangeProperty::UInt64RangeProperty(
 		UInt64RangeProperty::list_config();
 }
 
-QVariant UInt64RangeProperty::value() const
-{
-	return QVariant::fromValue(uint64_range_value());
-}
-
 /**
  * TODO: When glibmm >= 2.52 is more supported and tuple bug is fixed,
  *       use the template function and return tuple<uint64_t, uint64_t>:
  *
  *       return get_config<std::tuple<uint64_t, uint64_t>>(sigrok::ConfigKey);
  */
-data::uint64_range_t UInt64RangeProperty::uint64_range_value() const
+QVariant UInt64RangeProperty::read_value() const
 {
 	Glib::VariantContainerBase gvar =
 		configurable_->get_container_config(config_key_);
@@ -68,7 +63,7 @@ data::uint64_range_t UInt64RangeProperty::uint64_range_value() const
 	size_t child_cnt = gvar.get_n_children();
 	if (child_cnt != 2) {
 		throw std::runtime_error(QString(
-			"UInt64RangeProperty::uint64_range_value(): ").append(
+			"UInt64RangeProperty::read_value(): ").append(
 			"container should have 2 child, but has %1").arg(child_cnt).
 			toStdString());
 	}
@@ -81,7 +76,12 @@ data::uint64_range_t UInt64RangeProperty::uint64_range_value() const
 	uint64_t high =
 		Glib::VariantBase::cast_dynamic<Glib::Variant<uint64_t>>(gvar).get();
 
-	return make_pair(low, high);
+	return QVariant::fromValue(make_pair(low, high));
+}
+
+data::uint64_range_t UInt64RangeProperty::uint64_range_value() const
+{
+	return value().value<data::uint64_range_t>();
 }
 
 QString UInt64RangeProperty::to_string(data::uint64_range_t value) const
@@ -148,8 +148,8 @@ void UInt64RangeProperty::change_value(const QVariant &qvar)
 	gcontainer.push_back(gvar_low);
 	gcontainer.push_back(gvar_high);
 
-	configurable_->set_container_config(config_key_, gcontainer);
-	Q_EMIT value_changed(qvar);
+	configurable_->post_container_config(config_key_, gcontainer,
+		write_done(qvar));
 }
 
 void UInt64RangeProperty::on_value_changed(Glib::VariantBase gvar)
@@ -162,7 +162,7 @@ void UInt64RangeProperty::on_value_changed(Glib::VariantBase gvar)
 	uint64_t high =
 		Glib::VariantBase::cast_dynamic<Glib::Variant<uint64_t>>(gvar).get();
 
-	Q_EMIT value_changed(QVariant::fromValue(make_pair(low, high)));
+	update_value(QVariant::fromValue(make_pair(low, high)));
 }
 
 } // namespace properties
@@ -52,7 +52,7 @@ public:
 		devices::ConfigKey config_key);
 
 public:
-	QVariant value() const override;
+	QVariant read_value() const override;
 	data::uint64_range_t uint64_range_value() const;
 	QString to_string(data::uint64_range_t value) const;
 	QString to_string(const QVariant &qvar) const override;
@@ -0,0 +1,327 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "remoteprotocol.hpp"
+
+namespace sv {
+namespace data {
+
+namespace {
+
+const uint8_t time_encoding_f64 = 0;
+const uint8_t time_encoding_f32_offsets = 1;
+const uint8_t time_encoding_stride = 2;
+
+/** f32 offsets have a resolution of better than 4 us below 60 s. */
+const double max_f32_offset_span = 60.;
+
+template<typename T>
+void append_le(string &buffer, T value)
+{
+	char data[sizeof(T)];
+	for (size_t i = 0; i < sizeof(T); ++i)
+		data[i] = (char)((value >> (8 * i)) & 0xff);
+	buffer.append(data, sizeof(T));
+}
+
+template<typename T>
+T read_le(const char *data)
+{
+	T value = 0;
+	for (size_t i = 0; i < sizeof(T); ++i)
+		value |= (T)(uint8_t)data[i] << (8 * i);
+	return value;
+}
+
+/** Return true if the timestamps are start + i * stride, exactly as f64. */
+bool is_equidistant(const double *timestamps, size_t count, double &stride)
+{
+	if (count < 2)
+		return false;
+	stride = (timestamps[count - 1] - timestamps[0]) / (double)(count - 1);
+	for (size_t i = 1; i < count; ++i) {
+		if (timestamps[0] + (double)i * stride != timestamps[i])
+			return false;
+	}
+	return true;
+}
+
+}
+
+RemoteMessage::RemoteMessage() :
+	message_pos_(0)
+{
+}
+
+void RemoteMessage::begin(RemoteMessageType type)
+{
+	message_pos_ = buffer_.size();
+	append_u32(0);
+	append_u32((uint32_t)type);
+}
+
+void RemoteMessage::end()
+{
+	const uint32_t size = (uint32_t)(buffer_.size() - message_pos_ - 4);
+	for (size_t i = 0; i < 4; ++i)
+		buffer_[message_pos_ + i] = (char)((size >> (8 * i)) & 0xff);
+}
+
+void RemoteMessage::append_u8(uint8_t value)
+{
+	buffer_.push_back((char)value);
+}
+
+void RemoteMessage::append_u32(uint32_t value)
+{
+	append_le<uint32_t>(buffer_, value);
+}
+
+void RemoteMessage::append_u64(uint64_t value)
+{
+	append_le<uint64_t>(buffer_, value);
+}
+
+void RemoteMessage::append_f32(float value)
+{
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	append_u32(bits);
+}
+
+void RemoteMessage::append_f64(double value)
+{
+	uint64_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	append_u64(bits);
+}
+
+void RemoteMessage::append_string(const string &str)
+{
+	append_u32((uint32_t)str.size());
+	buffer_.append(str);
+}
+
+void RemoteMessage::append_samples(uint32_t signal_id,
+	int digits, int decimal_places,
+	const double *timestamps, const double *values, size_t count)
+{
+	append_u32(signal_id);
+	append_u32((uint32_t)count);
+	append_u8((uint8_t)(int8_t)digits);
+	append_u8((uint8_t)(int8_t)decimal_places);
+
+	double stride = 0.;
+	if (is_equidistant(timestamps, count, stride)) {
+		append_u8(time_encoding_stride);
+		append_f64(timestamps[0]);
+		append_f64(stride);
+	}
+	else if (count > 0 &&
+			timestamps[count - 1] - timestamps[0] < max_f32_offset_span &&
+			timestamps[count - 1] >= timestamps[0]) {
+		append_u8(time_encoding_f32_offsets);
+		append_f64(timestamps[0]);
+		for (size_t i = 0; i < count; ++i)
+			append_f32((float)(timestamps[i] - timestamps[0]));
+	}
+	else {
+		append_u8(time_encoding_f64);
+		for (size_t i = 0; i < count; ++i)
+			append_f64(timestamps[i]);
+	}
+	for (size_t i = 0; i < count; ++i)
+		append_f64(values[i]);
+}
+
+const string &RemoteMessage::buffer() const
+{
+	return buffer_;
+}
+
+size_t RemoteMessage::size() const
+{
+	return buffer_.size();
+}
+
+bool RemoteMessage::empty() const
+{
+	return buffer_.empty();
+}
+
+void RemoteMessage::clear()
+{
+	buffer_.clear();
+	message_pos_ = 0;
+}
+
+RemoteMessageReader::RemoteMessageReader(const char *data, size_t size) :
+	data_(data),
+	size_(size),
+	pos_(0),
+	ok_(true)
+{
+}
+
+bool RemoteMessageReader::fits(size_t size)
+{
+	if (!ok_ || size > size_ - pos_) {
+		ok_ = false;
+		return false;
+	}
+	return true;
+}
+
+uint8_t RemoteMessageReader::read_u8()
+{
+	if (!fits(1))
+		return 0;
+	return (uint8_t)data_[pos_++];
+}
+
+uint32_t RemoteMessageReader::read_u32()
+{
+	if (!fits(4))
+		return 0;
+	const uint32_t value = read_le<uint32_t>(data_ + pos_);
+	pos_ += 4;
+	return value;
+}
+
+uint64_t RemoteMessageReader::read_u64()
+{
+	if (!fits(8))
+		return 0;
+	const uint64_t value = read_le<uint64_t>(data_ + pos_);
+	pos_ += 8;
+	return value;
+}
+
+float RemoteMessageReader::read_f32()
+{
+	const uint32_t bits = read_u32();
+	float value;
+	std::memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+double RemoteMessageReader::read_f64()
+{
+	const uint64_t bits = read_u64();
+	double value;
+	std::memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+string RemoteMessageReader::read_string()
+{
+	const uint32_t size = read_u32();
+	if (!fits(size))
+		return string();
+	string str(data_ + pos_, size);
+	pos_ += size;
+	return str;
+}
+
+bool RemoteMessageReader::read_samples(uint32_t &signal_id,
+	int &digits, int &decimal_places,
+	vector<double> &timestamps, vector<double> &values)
+{
+	signal_id = read_u32();
+	const uint32_t count = read_u32();
+	digits = (int8_t)read_u8();
+	decimal_places = (int8_t)read_u8();
+	const uint8_t time_encoding = read_u8();
+	// At least 8 bytes per value follow, don't trust a bigger count
+	if (!ok_ || count > (size_ - pos_) / 8) {
+		ok_ = false;
+		return false;
+	}
+
+	timestamps.resize(count);
+	values.resize(count);
+	switch (time_encoding) {
+	case time_encoding_stride:
+	{
+		const double start = read_f64();
+		const double stride = read_f64();
+		for (size_t i = 0; i < count; ++i)
+			timestamps[i] = start + (double)i * stride;
+		break;
+	}
+	case time_encoding_f32_offsets:
+	{
+		const double start = read_f64();
+		for (size_t i = 0; i < count; ++i)
+			timestamps[i] = start + (double)read_f32();
+		break;
+	}
+	case time_encoding_f64:
+		for (size_t i = 0; i < count; ++i)
+			timestamps[i] = read_f64();
+		break;
+	default:
+		ok_ = false;
+		return false;
+	}
+	for (size_t i = 0; i < count; ++i)
+		values[i] = read_f64();
+	return ok_;
+}
+
+bool RemoteMessageReader::ok() const
+{
+	return ok_;
+}
+
+bool RemoteMessageReader::at_end() const
+{
+	return ok_ && pos_ == size_;
+}
+
+bool next_remote_message(const string &buffer, size_t &pos,
+	uint32_t &type, size_t &payload_pos, size_t &payload_size, bool &error)
+{
+	error = false;
+	if (buffer.size() - pos < 8)
+		return false;
+	const uint32_t size = read_le<uint32_t>(buffer.data() + pos);
+	if (size < 4 || size > remote_max_message_size) {
+		error = true;
+		return false;
+	}
+	if (buffer.size() - pos - 4 < size)
+		return false;
+
+	type = read_le<uint32_t>(buffer.data() + pos + 4);
+	payload_pos = pos + 8;
+	payload_size = size - 4;
+	pos += 4 + size;
+	return true;
+}
+
+} // namespace data
+} // namespace sv
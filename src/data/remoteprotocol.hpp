@@ -0,0 +1,178 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_REMOTEPROTOCOL_HPP
+#define DATA_REMOTEPROTOCOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+/**
+ * The protocol between a RemoteServer and its RemoteClients.
+ *
+ * All messages are length-prefixed and little endian, like the binary
+ * format of the SignalStreamer: u32 size (without the size field), u32
+ * type, then the payload. Strings are u32 length + UTF-8.
+ *
+ * Server to client:
+ * - Hello: u32 protocol version.
+ * - Signal: u32 signal id, the device, channel group, channel and signal
+ *   names, u32 quantity, u64 quantity flags mask, u32 unit.
+ * - SignalRemoved: u32 signal id.
+ * - Samples: The samples, that were appended since the last samples message
+ *   of the signal, see RemoteMessage::append_samples().
+ * - Property: the device, configurable and property names and the value as
+ *   string. Only changed values are sent.
+ * - LodReply: u32 request id, u32 count, count times f64 start, f64 end,
+ *   f64 min, f64 max, f64 mean and u32 sample count.
+ * - PropertyWriteReply: u32 request id, u8 accepted, the error as string.
+ *
+ * Client to server:
+ * - LodRequest: u32 request id, u32 signal id, f64 start timestamp, f64 end
+ *   timestamp, u32 bin count. The server answers with the min/max/mean of
+ *   the bins, so only the resolution of a plot crosses the network.
+ * - PropertyWrite: u32 request id, the device, configurable and property
+ *   names and the new value as string. The client, that writes, gets the
+ *   control of the devices, see RemoteServer.
+ * - ReleaseControl: Release the control of the devices.
+ */
+enum class RemoteMessageType : uint32_t {
+	Hello = 1,
+	Signal = 2,
+	SignalRemoved = 3,
+	Samples = 4,
+	Property = 5,
+	LodRequest = 6,
+	LodReply = 7,
+	PropertyWrite = 8,
+	PropertyWriteReply = 9,
+	ReleaseControl = 10,
+};
+
+/** Changed, when the messages change incompatibly. */
+const uint32_t remote_protocol_version = 1;
+/** Messages above this size are a protocol error. */
+const size_t remote_max_message_size = 64 << 20;
+
+/**
+ * Builds one or more messages in a buffer.
+ */
+class RemoteMessage
+{
+public:
+	RemoteMessage();
+
+	/** Start a new message, the previous one must have been ended. */
+	void begin(RemoteMessageType type);
+	/** Set the size of the message, that was started by begin(). */
+	void end();
+
+	void append_u8(uint8_t value);
+	void append_u32(uint32_t value);
+	void append_u64(uint64_t value);
+	void append_f32(float value);
+	void append_f64(double value);
+	void append_string(const string &str);
+
+	/**
+	 * Append the payload of a samples message: u32 signal id, u32 count,
+	 * i8 digits, i8 decimal places, u8 time encoding, the timestamps and
+	 * count f64 values.
+	 *
+	 * The timestamps are stored as compact as possible without loss of a
+	 * sampling grid: As f64 start and f64 stride, if they are equidistant
+	 * (encoding 2), as f64 start and count f32 offsets, if the message
+	 * covers less than a minute (encoding 1), or as count f64 (encoding 0).
+	 */
+	void append_samples(uint32_t signal_id, int digits, int decimal_places,
+		const double *timestamps, const double *values, size_t count);
+
+	const string &buffer() const;
+	size_t size() const;
+	bool empty() const;
+	void clear();
+
+private:
+	string buffer_;
+	/** The position of the size field of the current message. */
+	size_t message_pos_;
+
+};
+
+/**
+ * Reads the payload of a message. All reads are bounds checked, a read
+ * beyond the end of the payload sets ok() to false and returns 0.
+ */
+class RemoteMessageReader
+{
+public:
+	RemoteMessageReader(const char *data, size_t size);
+
+	uint8_t read_u8();
+	uint32_t read_u32();
+	uint64_t read_u64();
+	float read_f32();
+	double read_f64();
+	string read_string();
+
+	/** Read the payload of a samples message. */
+	bool read_samples(uint32_t &signal_id, int &digits, int &decimal_places,
+		vector<double> &timestamps, vector<double> &values);
+
+	bool ok() const;
+	/** Return true if the whole payload was read without an error. */
+	bool at_end() const;
+
+private:
+	bool fits(size_t size);
+
+	const char *data_;
+	size_t size_;
+	size_t pos_;
+	bool ok_;
+
+};
+
+/**
+ * Take the next complete message from the front of the receive buffer.
+ *
+ * @param buffer The received bytes, starting at pos.
+ * @param pos The position of the next message, it is advanced behind the
+ *        message.
+ * @param type The type of the message.
+ * @param payload The position and the size of the payload in the buffer.
+ *
+ * @return false if the message is not complete yet. error is set, if the
+ *         message is too big.
+ */
+bool next_remote_message(const string &buffer, size_t &pos,
+	uint32_t &type, size_t &payload_pos, size_t &payload_size, bool &error);
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_REMOTEPROTOCOL_HPP
@@ -0,0 +1,700 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <QDebug>
+#include <QHostAddress>
+#include <QObject>
+#include <QString>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QVariant>
+
+#include "remoteserver.hpp"
+#include "src/session.hpp"
+#include "src/channels/basechannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/analogtimesnapshot.hpp"
+#include "src/data/basesignal.hpp"
+#include "src/data/datautil.hpp"
+#include "src/data/minmaxpyramid.hpp"
+#include "src/data/remoteprotocol.hpp"
+#include "src/data/signalregistry.hpp"
+#include "src/data/properties/baseproperty.hpp"
+#include "src/devices/basedevice.hpp"
+#include "src/devices/configurable.hpp"
+#include "src/devices/hardwaredevice.hpp"
+#include "src/util.hpp"
+
+using std::dynamic_pointer_cast;
+using std::lock_guard;
+using std::shared_ptr;
+using std::string;
+using std::unique_lock;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+namespace {
+
+/**
+ * Convert the value of a property write to the type of the property. The
+ * container types (ranges, rationals, measured quantities) are not
+ * supported.
+ */
+bool parse_property_value(DataType data_type, const string &value,
+	QVariant &qvar)
+{
+	const QString str = QString::fromStdString(value).trimmed();
+	bool ok = false;
+	switch (data_type) {
+	case DataType::Bool:
+		if (str.compare("true", Qt::CaseInsensitive) == 0 ||
+				str.compare("on", Qt::CaseInsensitive) == 0 || str == "1")
+			qvar = QVariant(true);
+		else if (str.compare("false", Qt::CaseInsensitive) == 0 ||
+				str.compare("off", Qt::CaseInsensitive) == 0 || str == "0")
+			qvar = QVariant(false);
+		return qvar.isValid();
+	case DataType::Double:
+		qvar = QVariant(str.toDouble(&ok));
+		return ok;
+	case DataType::Int32:
+		qvar = QVariant((qint32)str.toInt(&ok));
+		return ok;
+	case DataType::UInt64:
+		qvar = QVariant((quint64)str.toULongLong(&ok));
+		return ok;
+	case DataType::String:
+		qvar = QVariant(QString::fromStdString(value));
+		return true;
+	default:
+		return false;
+	}
+}
+
+}
+
+const double RemoteServer::default_send_interval_ = 0.1;
+const double RemoteServer::min_send_interval_ = 0.01;
+const size_t RemoteServer::max_batch_samples_ = 4096;
+const size_t RemoteServer::max_pending_bytes_ = 4 << 20;
+const uint32_t RemoteServer::max_lod_bin_count_ = 65536;
+const double RemoteServer::control_lease_ = 10.;
+
+RemoteServer::RemoteServer(Session &session) :
+	session_(session),
+	send_interval_(default_send_interval_),
+	remote_writes_allowed_(false),
+	control_owner_(nullptr),
+	serial_(0),
+	stop_(false),
+	running_(false),
+	listen_done_(false),
+	port_(0),
+	client_count_(0),
+	sent_sample_count_(0),
+	property_write_count_(0)
+{
+}
+
+RemoteServer::~RemoteServer()
+{
+	stop();
+	for (const auto &connection : property_connections_)
+		QObject::disconnect(connection);
+}
+
+void RemoteServer::set_send_interval(double send_interval)
+{
+	send_interval_ = std::max(send_interval, min_send_interval_);
+}
+
+double RemoteServer::send_interval() const
+{
+	return send_interval_;
+}
+
+void RemoteServer::set_remote_writes_allowed(bool allowed)
+{
+	remote_writes_allowed_ = allowed;
+}
+
+bool RemoteServer::remote_writes_allowed() const
+{
+	return remote_writes_allowed_;
+}
+
+bool RemoteServer::start(uint16_t port, const string &host)
+{
+	stop();
+
+	QHostAddress address;
+	if (!util::parse_listen_address(host, address)) {
+		qWarning() << "RemoteServer: Invalid address" <<
+			QString::fromStdString(host);
+		return false;
+	}
+
+	sent_sample_count_ = 0;
+	stop_ = false;
+	listen_done_ = false;
+	running_ = true;
+	thread_ = std::thread(&RemoteServer::thread_proc, this, address, port);
+
+	// Wait until the thread listens, so that a used port is reported here
+	unique_lock<std::mutex> lock(mutex_);
+	cond_.wait(lock, [this]() { return listen_done_; });
+	return running_;
+}
+
+void RemoteServer::stop()
+{
+	{
+		lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+	}
+	cond_.notify_all();
+	if (thread_.joinable())
+		thread_.join();
+	running_ = false;
+}
+
+bool RemoteServer::is_running() const
+{
+	return running_;
+}
+
+uint16_t RemoteServer::port() const
+{
+	return port_;
+}
+
+size_t RemoteServer::client_count() const
+{
+	return client_count_;
+}
+
+size_t RemoteServer::sent_sample_count() const
+{
+	return sent_sample_count_;
+}
+
+size_t RemoteServer::property_write_count() const
+{
+	return property_write_count_;
+}
+
+void RemoteServer::set_devices(
+	const vector<shared_ptr<devices::HardwareDevice>> &devices)
+{
+	for (const auto &connection : property_connections_)
+		QObject::disconnect(connection);
+	property_connections_.clear();
+
+	vector<shared_ptr<properties::BaseProperty>> properties;
+	vector<string> device_names;
+	for (const auto &device : devices) {
+		const string device_name = device->short_name().toStdString();
+		for (const auto &c_pair : device->configurable_map()) {
+			for (const auto &p_pair : c_pair.second->property_map()) {
+				auto property = p_pair.second;
+				if (!property || !property->is_getable())
+					continue;
+				properties.push_back(property);
+				device_names.push_back(device_name);
+				// The value is changed in the thread of the property
+				const properties::BaseProperty *property_ptr = property.get();
+				property_connections_.push_back(QObject::connect(
+					property.get(), &properties::BaseProperty::value_changed,
+					[this, property_ptr](const QVariant &qvar) {
+						update_property(property_ptr,
+							property_ptr->to_string(qvar).toStdString());
+					}));
+			}
+		}
+	}
+
+	lock_guard<std::mutex> lock(properties_mutex_);
+	map<const properties::BaseProperty *, PropertyValue> property_values;
+	for (size_t i = 0; i < properties.size(); ++i) {
+		const auto &property = properties[i];
+		auto it = property_values_.find(property.get());
+		if (it != property_values_.end()) {
+			property_values.insert(*it);
+			continue;
+		}
+		PropertyValue value;
+		value.device_name = device_names[i];
+		value.configurable_name = property->configurable()->name();
+		value.property_name = property->name();
+		value.serial = 0;
+		property_values.insert(std::make_pair(property.get(), value));
+		new_properties_.push_back(property);
+	}
+	property_values_.swap(property_values);
+	properties_.swap(properties);
+}
+
+void RemoteServer::update_property(const properties::BaseProperty *property,
+	const string &value)
+{
+	lock_guard<std::mutex> lock(properties_mutex_);
+	auto it = property_values_.find(property);
+	if (it == property_values_.end() || (it->second.serial > 0 &&
+			it->second.value == value))
+		return;
+	it->second.value = value;
+	it->second.serial = ++serial_;
+}
+
+void RemoteServer::read_initial_values()
+{
+	vector<shared_ptr<properties::BaseProperty>> new_properties;
+	{
+		lock_guard<std::mutex> lock(properties_mutex_);
+		new_properties.swap(new_properties_);
+	}
+	// Only the first read of a property goes to the device, that is the
+	// reason to do it here and not in the thread of the properties.
+	for (const auto &property : new_properties) {
+		{
+			// Skip the properties of removed devices
+			lock_guard<std::mutex> lock(properties_mutex_);
+			if (property_values_.count(property.get()) == 0)
+				continue;
+		}
+		const QVariant qvar = property->value();
+		if (qvar.isValid())
+			update_property(property.get(),
+				property->to_string(qvar).toStdString());
+		if (stop_)
+			return;
+	}
+}
+
+void RemoteServer::thread_proc(QHostAddress address, uint16_t port)
+{
+	// The server and the sockets are used with the blocking functions, this
+	// thread has no event loop.
+	QTcpServer server;
+	const bool listening = server.listen(address, port);
+	if (listening) {
+		port_ = server.serverPort();
+	}
+	else {
+		qWarning() << "RemoteServer: Listening on" << address.toString() <<
+			"port" << port << "failed:" << server.errorString();
+		running_ = false;
+	}
+	{
+		lock_guard<std::mutex> lock(mutex_);
+		listen_done_ = true;
+	}
+	cond_.notify_all();
+	if (!listening)
+		return;
+
+	const int send_interval_ms = (int)(send_interval_ * 1000);
+	RemoteMessage message;
+	while (!stop_) {
+		// Waiting for new clients is the send interval
+		if (server.waitForNewConnection(send_interval_ms))
+			accept_clients(server);
+
+		read_initial_values();
+
+		message.clear();
+		update_signals();
+		for (auto &client : clients_) {
+			if (!handle_requests(client, message))
+				continue;
+			append_new_samples(client, message);
+			append_changed_properties(client, message);
+			if (!send(client, message))
+				client.socket->abort();
+		}
+
+		// Remove the lost clients
+		for (auto it = clients_.begin(); it != clients_.end(); ) {
+			if (it->socket->state() != QAbstractSocket::ConnectedState) {
+				qWarning() << "RemoteServer: Client" <<
+					it->socket->peerAddress().toString() << "disconnected";
+				if (control_owner_ == it->socket)
+					control_owner_ = nullptr;
+				delete it->socket;
+				it = clients_.erase(it);
+			}
+			else {
+				++it;
+			}
+		}
+		client_count_ = clients_.size();
+	}
+
+	for (auto &client : clients_) {
+		client.socket->flush();
+		client.socket->disconnectFromHost();
+		delete client.socket;
+	}
+	clients_.clear();
+	control_owner_ = nullptr;
+	client_count_ = 0;
+	signals_.clear();
+	server.close();
+	running_ = false;
+}
+
+void RemoteServer::accept_clients(QTcpServer &server)
+{
+	QTcpSocket *socket = server.nextPendingConnection();
+	while (socket) {
+		qWarning() << "RemoteServer: Client" <<
+			socket->peerAddress().toString() << "connected";
+		socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+
+		Client client;
+		client.socket = socket;
+		client.property_serial = 0;
+
+		// The signals are announced to new clients here. update_signals()
+		// only announces the changes to all clients.
+		RemoteMessage message;
+		message.begin(RemoteMessageType::Hello);
+		message.append_u32(remote_protocol_version);
+		message.end();
+		for (const auto &entry : signals_) {
+			append_signal_message(message, entry);
+			if (entry.analog_signal) {
+				client.next_pos[entry.id] =
+					entry.analog_signal->snapshot().sample_count();
+			}
+		}
+		clients_.push_back(client);
+		if (!send(clients_.back(), message))
+			socket->abort();
+
+		socket = server.nextPendingConnection();
+	}
+	client_count_ = clients_.size();
+}
+
+void RemoteServer::update_signals()
+{
+	const auto registry_signals = session_.signal_registry()->signals();
+	const auto signal_registry = session_.signal_registry();
+
+	RemoteMessage message;
+	vector<SignalEntry> signals;
+	signals.reserve(registry_signals->size());
+	for (const auto &signal : *registry_signals) {
+		const uint32_t id = (uint32_t)signal_registry->id(signal);
+		if (id == 0)
+			continue;
+		auto it = std::find_if(signals_.begin(), signals_.end(),
+			[id](const SignalEntry &entry) { return entry.id == id; });
+		if (it != signals_.end()) {
+			signals.push_back(*it);
+			continue;
+		}
+
+		SignalEntry entry{ id, signal,
+			dynamic_pointer_cast<AnalogTimeSignal>(signal) };
+		append_signal_message(message, entry);
+		// The clients get the samples from now on
+		if (entry.analog_signal) {
+			const size_t pos = entry.analog_signal->snapshot().sample_count();
+			for (auto &client : clients_)
+				client.next_pos[id] = pos;
+		}
+		signals.push_back(entry);
+	}
+	for (const auto &entry : signals_) {
+		auto it = std::find_if(signals.begin(), signals.end(),
+			[&entry](const SignalEntry &e) { return e.id == entry.id; });
+		if (it != signals.end())
+			continue;
+		message.begin(RemoteMessageType::SignalRemoved);
+		message.append_u32(entry.id);
+		message.end();
+		for (auto &client : clients_)
+			client.next_pos.erase(entry.id);
+	}
+	signals_.swap(signals);
+
+	if (message.empty())
+		return;
+	for (auto &client : clients_) {
+		RemoteMessage client_message = message;
+		if (!send(client, client_message))
+			client.socket->abort();
+	}
+}
+
+void RemoteServer::append_signal_message(RemoteMessage &message,
+	const SignalEntry &entry) const
+{
+	const auto channel = entry.signal->parent_channel();
+	const auto device = channel ? channel->parent_device() : nullptr;
+	string channel_group;
+	if (channel && !channel->channel_group_names().empty())
+		channel_group = *channel->channel_group_names().begin();
+
+	message.begin(RemoteMessageType::Signal);
+	message.append_u32(entry.id);
+	message.append_string(device ? device->short_name().toStdString() : "");
+	message.append_string(channel_group);
+	message.append_string(channel ? channel->name() : "");
+	message.append_string(entry.signal->name());
+	message.append_u32((uint32_t)entry.signal->quantity());
+	message.append_u64(
+		get_quantity_flags_mask(entry.signal->quantity_flags()));
+	message.append_u32((uint32_t)entry.signal->unit());
+	message.end();
+}
+
+bool RemoteServer::handle_requests(Client &client, RemoteMessage &message)
+{
+	// Without an event loop, the socket is only read by the wait functions
+	client.socket->waitForReadyRead(0);
+	if (client.socket->bytesAvailable() > 0)
+		client.receive_buffer += client.socket->readAll().toStdString();
+
+	size_t pos = 0;
+	uint32_t type;
+	size_t payload_pos;
+	size_t payload_size;
+	bool error = false;
+	while (next_remote_message(client.receive_buffer, pos,
+			type, payload_pos, payload_size, error)) {
+		RemoteMessageReader reader(
+			client.receive_buffer.data() + payload_pos, payload_size);
+		if (type == (uint32_t)RemoteMessageType::ReleaseControl) {
+			if (control_owner_ == client.socket)
+				control_owner_ = nullptr;
+			continue;
+		}
+		if (type == (uint32_t)RemoteMessageType::PropertyWrite) {
+			const uint32_t request_id = reader.read_u32();
+			const string device_name = reader.read_string();
+			const string configurable_name = reader.read_string();
+			const string property_name = reader.read_string();
+			const string value = reader.read_string();
+			if (!reader.ok()) {
+				error = true;
+				break;
+			}
+			string write_error;
+			const bool accepted = write_property(client, device_name,
+				configurable_name, property_name, value, write_error);
+			message.begin(RemoteMessageType::PropertyWriteReply);
+			message.append_u32(request_id);
+			message.append_u8(accepted ? 1 : 0);
+			message.append_string(write_error);
+			message.end();
+			continue;
+		}
+		if (type != (uint32_t)RemoteMessageType::LodRequest)
+			continue;
+
+		const uint32_t request_id = reader.read_u32();
+		const uint32_t signal_id = reader.read_u32();
+		const double start = reader.read_f64();
+		const double end = reader.read_f64();
+		const uint32_t bin_count =
+			std::min(reader.read_u32(), max_lod_bin_count_);
+		if (!reader.ok()) {
+			error = true;
+			break;
+		}
+
+		vector<AnalogSummary> summaries;
+		auto it = std::find_if(signals_.begin(), signals_.end(),
+			[signal_id](const SignalEntry &e) { return e.id == signal_id; });
+		if (it != signals_.end() && it->analog_signal && bin_count > 0) {
+			summaries = it->analog_signal->get_summaries(
+				start, end, bin_count, false);
+		}
+
+		message.begin(RemoteMessageType::LodReply);
+		message.append_u32(request_id);
+		message.append_u32((uint32_t)summaries.size());
+		for (const auto &summary : summaries) {
+			message.append_f64(summary.start_timestamp);
+			message.append_f64(summary.end_timestamp);
+			message.append_f64(summary.min);
+			message.append_f64(summary.max);
+			message.append_f64(summary.mean);
+			message.append_u32((uint32_t)summary.sample_count);
+		}
+		message.end();
+	}
+	client.receive_buffer.erase(0, pos);
+
+	if (error) {
+		qWarning() << "RemoteServer: Invalid request from" <<
+			client.socket->peerAddress().toString();
+		client.socket->abort();
+		message.clear();
+		return false;
+	}
+	return true;
+}
+
+bool RemoteServer::write_property(const Client &client,
+	const string &device_name, const string &configurable_name,
+	const string &property_name, const string &value, string &error)
+{
+	// Without authentication, only local clients control the instruments
+	if (!remote_writes_allowed_ &&
+			!util::is_loopback_address(client.socket->peerAddress())) {
+		error = "Property writes are only allowed from this machine";
+		return false;
+	}
+
+	const auto now = std::chrono::steady_clock::now();
+	if (control_owner_ && control_owner_ != client.socket &&
+			std::chrono::duration<double>(now - control_time_).count() <
+				control_lease_) {
+		error = "Another client has the control";
+		return false;
+	}
+
+	shared_ptr<properties::BaseProperty> property;
+	{
+		lock_guard<std::mutex> lock(properties_mutex_);
+		for (const auto &p : properties_) {
+			const auto it = property_values_.find(p.get());
+			if (it != property_values_.end() &&
+					it->second.device_name == device_name &&
+					it->second.configurable_name == configurable_name &&
+					it->second.property_name == property_name) {
+				property = p;
+				break;
+			}
+		}
+	}
+	if (!property) {
+		error = "Unknown property";
+		return false;
+	}
+	if (!property->is_setable()) {
+		error = "The property can't be set";
+		return false;
+	}
+	QVariant qvar;
+	if (!parse_property_value(property->data_type(), value, qvar)) {
+		error = "Invalid value for the property type";
+		return false;
+	}
+
+	control_owner_ = client.socket;
+	control_time_ = now;
+	// The property posts the write to the config worker of the device. It
+	// is called in its own thread, the result is announced to all clients
+	// by value_changed().
+	QMetaObject::invokeMethod(property.get(), "change_value",
+		Qt::QueuedConnection, Q_ARG(QVariant, qvar));
+	++property_write_count_;
+	return true;
+}
+
+void RemoteServer::append_new_samples(Client &client, RemoteMessage &message)
+{
+	// A slow client gets its samples later, they stay in the signals
+	if ((size_t)client.socket->bytesToWrite() > max_pending_bytes_)
+		return;
+
+	vector<double> timestamps(max_batch_samples_);
+	vector<double> values(max_batch_samples_);
+	for (const auto &entry : signals_) {
+		if (!entry.analog_signal)
+			continue;
+		auto pos_it = client.next_pos.find(entry.id);
+		if (pos_it == client.next_pos.end())
+			continue;
+
+		size_t &next_pos = pos_it->second;
+		const auto snapshot = entry.analog_signal->snapshot();
+		next_pos = std::max(next_pos, snapshot.first_sample_pos());
+		while (next_pos < snapshot.sample_count()) {
+			const size_t count = std::min(max_batch_samples_,
+				snapshot.sample_count() - next_pos);
+			const size_t copied = snapshot.copy_samples(next_pos, count,
+				false, timestamps.data(), values.data());
+			if (copied == 0)
+				break;
+
+			message.begin(RemoteMessageType::Samples);
+			message.append_samples(entry.id, entry.analog_signal->digits(),
+				entry.analog_signal->decimal_places(),
+				timestamps.data(), values.data(), copied);
+			message.end();
+			next_pos += copied;
+			sent_sample_count_ += copied;
+		}
+	}
+}
+
+void RemoteServer::append_changed_properties(Client &client,
+	RemoteMessage &message)
+{
+	lock_guard<std::mutex> lock(properties_mutex_);
+	if (client.property_serial == serial_)
+		return;
+	for (const auto &value_pair : property_values_) {
+		const PropertyValue &value = value_pair.second;
+		if (value.serial == 0 || value.serial <= client.property_serial)
+			continue;
+		message.begin(RemoteMessageType::Property);
+		message.append_string(value.device_name);
+		message.append_string(value.configurable_name);
+		message.append_string(value.property_name);
+		message.append_string(value.value);
+		message.end();
+	}
+	client.property_serial = serial_;
+}
+
+bool RemoteServer::send(Client &client, RemoteMessage &message)
+{
+	if (message.empty())
+		return true;
+
+	const qint64 size = (qint64)message.size();
+	const qint64 written = client.socket->write(message.buffer().data(), size);
+	message.clear();
+	if (written != size)
+		return false;
+	// Without an event loop, the data is only sent by flush()
+	client.socket->flush();
+	return true;
+}
+
+} // namespace data
+} // namespace sv
@@ -0,0 +1,250 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_REMOTESERVER_HPP
+#define DATA_REMOTESERVER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <QHostAddress>
+#include <QMetaObject>
+
+using std::map;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+class QTcpServer;
+class QTcpSocket;
+
+namespace sv {
+
+class Session;
+
+namespace devices {
+class HardwareDevice;
+}
+
+namespace data {
+
+class AnalogTimeSignal;
+class BaseSignal;
+class RemoteMessage;
+
+namespace properties {
+class BaseProperty;
+}
+
+/**
+ * Publishes the signals and the properties of the session to RemoteClients
+ * over TCP, e.g. from a headless SmuView on a box next to the instruments
+ * to the GUIs on the desks. See RemoteMessageType for the protocol.
+ *
+ * All signals of the signal registry are published, including math
+ * channels and signals, that are added later. Every send interval, each
+ * client gets the samples, that were appended since its last update, and
+ * the properties, that have changed. The samples, that were in the signals
+ * before a client connected, are not sent, the client reads the history
+ * with LOD requests for the resolution it displays.
+ *
+ * A background thread serves all clients. Like the SignalStreamer, it only
+ * reads snapshots of the signals, so the acquisition never waits for the
+ * network. A slow client is skipped until its socket buffer has drained,
+ * it falls behind without slowing down the other clients.
+ *
+ * So the server is also a broker, that shares the instruments of one
+ * process with several clients, which then don't have to open them
+ * themselves. The property writes of the clients are arbitrated: The
+ * client, that writes, gets the control of the devices. Writes of other
+ * clients are rejected, until the control is released, the client
+ * disconnects or it didn't write for the control lease. The writes are
+ * posted to the config workers of the devices, the new values reach all
+ * clients as property changes.
+ *
+ * The server listens on the loopback interface by default. Even when it
+ * listens on other interfaces, only the clients on the same machine may
+ * write properties, unless remote writes are allowed explicitly, see
+ * set_remote_writes_allowed(). The protocol has no authentication.
+ */
+class RemoteServer
+{
+public:
+	explicit RemoteServer(Session &session);
+	/** Stops the server. */
+	~RemoteServer();
+
+	RemoteServer(const RemoteServer &) = delete;
+	RemoteServer &operator=(const RemoteServer &) = delete;
+
+	/**
+	 * Set the send interval in seconds, the default is 0.1 s. This is used
+	 * by the next start().
+	 */
+	void set_send_interval(double send_interval);
+	double send_interval() const;
+
+	/**
+	 * Allow the property writes of clients on other machines. By default,
+	 * only the writes of clients with a loopback address are accepted.
+	 */
+	void set_remote_writes_allowed(bool allowed);
+	bool remote_writes_allowed() const;
+
+	/**
+	 * Listen on the port, a running server is stopped. By default, only
+	 * clients on the same machine can connect. Serving the signals and
+	 * properties to the network must be chosen with the host.
+	 *
+	 * @param port The TCP port, 0 chooses a free port, see port().
+	 * @param host The address to listen on, "*" for all interfaces, see
+	 *        util::parse_listen_address().
+	 *
+	 * @return false if the host is invalid or the port couldn't be opened.
+	 */
+	bool start(uint16_t port, const string &host = "127.0.0.1");
+	void stop();
+	bool is_running() const;
+	/** Return the port, that the server listens on. */
+	uint16_t port() const;
+
+	size_t client_count() const;
+	/** Return the number of property writes of the clients. */
+	size_t property_write_count() const;
+	/** Return the number of samples, that were sent to all clients. */
+	size_t sent_sample_count() const;
+
+	/**
+	 * Set the hardware devices, whose properties are published. The
+	 * session keeps them up to date, when devices are added or removed.
+	 * Must be called from the thread of the properties.
+	 */
+	void set_devices(
+		const vector<shared_ptr<devices::HardwareDevice>> &devices);
+
+private:
+	struct SignalEntry
+	{
+		uint32_t id;
+		shared_ptr<BaseSignal> signal;
+		/** nullptr for signals without samples to stream. */
+		shared_ptr<AnalogTimeSignal> analog_signal;
+	};
+
+	struct PropertyValue
+	{
+		string device_name;
+		string configurable_name;
+		string property_name;
+		string value;
+		/** The value of serial_ at the last change. */
+		uint64_t serial;
+	};
+
+	struct Client
+	{
+		QTcpSocket *socket;
+		string receive_buffer;
+		/** The position of the next sample to send, per signal id. */
+		map<uint32_t, size_t> next_pos;
+		/** The properties with a higher serial have not been sent. */
+		uint64_t property_serial;
+	};
+
+	void thread_proc(QHostAddress address, uint16_t port);
+	void accept_clients(QTcpServer &server);
+	/** Sync signals_ with the registry and announce the changes. */
+	void update_signals();
+	void append_signal_message(RemoteMessage &message,
+		const SignalEntry &entry) const;
+	/** Read the initial values of new properties, in the server thread. */
+	void read_initial_values();
+	void update_property(const properties::BaseProperty *property,
+		const string &value);
+	/** Answer the requests of the client. */
+	bool handle_requests(Client &client, RemoteMessage &message);
+	/**
+	 * Post a property write of the client, if it has or gets the control.
+	 *
+	 * @return false if the write was rejected, the reason is in &error.
+	 */
+	bool write_property(const Client &client, const string &device_name,
+		const string &configurable_name, const string &property_name,
+		const string &value, string &error);
+	void append_new_samples(Client &client, RemoteMessage &message);
+	void append_changed_properties(Client &client, RemoteMessage &message);
+	bool send(Client &client, RemoteMessage &message);
+
+	static const double default_send_interval_;
+	static const double min_send_interval_;
+	static const size_t max_batch_samples_;
+	/** Skip a client, when more bytes are pending. */
+	static const size_t max_pending_bytes_;
+	/** The maximum number of LOD bins of a request. */
+	static const uint32_t max_lod_bin_count_;
+	/** The control is released, when the owner didn't write for so long. */
+	static const double control_lease_;
+
+	Session &session_;
+	double send_interval_;
+	std::atomic<bool> remote_writes_allowed_;
+
+	/** Only used by the server thread. */
+	vector<SignalEntry> signals_;
+	vector<Client> clients_;
+	/** The socket of the client, that has the control, or nullptr. */
+	const QTcpSocket *control_owner_;
+	std::chrono::steady_clock::time_point control_time_;
+
+	/** Guards the properties, they are changed by the device threads. */
+	mutable std::mutex properties_mutex_;
+	map<const properties::BaseProperty *, PropertyValue> property_values_;
+	vector<shared_ptr<properties::BaseProperty>> properties_;
+	vector<shared_ptr<properties::BaseProperty>> new_properties_;
+	vector<QMetaObject::Connection> property_connections_;
+	uint64_t serial_;
+
+	std::thread thread_;
+	/** Guards stop_ and listen_done_ for the conditions. */
+	std::mutex mutex_;
+	std::condition_variable cond_;
+	std::atomic<bool> stop_;
+	std::atomic<bool> running_;
+	/** Set by the thread, when it has tried to listen. */
+	bool listen_done_;
+	std::atomic<uint16_t> port_;
+	std::atomic<size_t> client_count_;
+	std::atomic<size_t> sent_sample_count_;
+	std::atomic<size_t> property_write_count_;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_REMOTESERVER_HPP
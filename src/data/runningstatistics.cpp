@@ -0,0 +1,113 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <cmath>
+
+#include "runningstatistics.hpp"
+
+namespace sv {
+namespace data {
+
+RunningStatistics::RunningStatistics() :
+	count_(0),
+	mean_(0.),
+	m2_(0.),
+	sequence_(0),
+	published_count_(0),
+	published_mean_(0.),
+	published_m2_(0.)
+{
+}
+
+void RunningStatistics::add(double value)
+{
+	// Ignore NaN and infinity (overflow), they would spoil all statistics
+	if (!std::isfinite(value))
+		return;
+
+	++count_;
+	const double delta = value - mean_;
+	mean_ += delta / (double)count_;
+	m2_ += delta * (value - mean_);
+}
+
+void RunningStatistics::publish()
+{
+	const unsigned int sequence = sequence_.load(std::memory_order_relaxed);
+	sequence_.store(sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	published_count_.store(count_, std::memory_order_relaxed);
+	published_mean_.store(mean_, std::memory_order_relaxed);
+	published_m2_.store(m2_, std::memory_order_relaxed);
+	sequence_.store(sequence + 2, std::memory_order_release);
+}
+
+void RunningStatistics::clear()
+{
+	count_ = 0;
+	mean_ = 0.;
+	m2_ = 0.;
+	publish();
+}
+
+AnalogStatistics RunningStatistics::statistics() const
+{
+	const RunningStatisticsState state = this->state();
+	const size_t count = state.count;
+	const double mean = state.mean;
+	const double m2 = state.m2;
+
+	AnalogStatistics statistics;
+	statistics.sample_count = count;
+	statistics.mean = mean;
+	statistics.variance = count > 0 && m2 > 0. ? m2 / (double)count : 0.;
+	statistics.stddev = std::sqrt(statistics.variance);
+	// The mean of the squares is variance + mean^2
+	statistics.rms = std::sqrt(statistics.variance + mean * mean);
+	return statistics;
+}
+
+RunningStatisticsState RunningStatistics::state() const
+{
+	RunningStatisticsState state;
+	while (true) {
+		const unsigned int sequence = sequence_.load(std::memory_order_acquire);
+		if (sequence & 1)
+			continue;
+		state.count = published_count_.load(std::memory_order_relaxed);
+		state.mean = published_mean_.load(std::memory_order_relaxed);
+		state.m2 = published_m2_.load(std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (sequence_.load(std::memory_order_relaxed) == sequence)
+			break;
+	}
+	return state;
+}
+
+void RunningStatistics::restore(const RunningStatisticsState &state)
+{
+	count_ = state.count;
+	mean_ = state.mean;
+	m2_ = state.m2;
+	publish();
+}
+
+} // namespace data
+} // namespace sv
@@ -0,0 +1,119 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_RUNNINGSTATISTICS_HPP
+#define DATA_RUNNINGSTATISTICS_HPP
+
+#include <atomic>
+#include <cstddef>
+
+namespace sv {
+namespace data {
+
+/**
+ * Mean, variance, standard deviation and RMS of a set of samples.
+ */
+struct AnalogStatistics
+{
+	size_t sample_count;
+	double mean;
+	/** The population variance. */
+	double variance;
+	double stddev;
+	double rms;
+};
+
+/**
+ * The raw state of RunningStatistics (Welford's algorithm), e.g. to store
+ * it in a checkpoint and to continue the statistics later.
+ */
+struct RunningStatisticsState
+{
+	size_t count;
+	double mean;
+	/** The sum of the squared deviations from the mean. */
+	double m2;
+};
+
+/**
+ * Running statistics over all values of a signal, calculated incrementally
+ * with Welford's algorithm. Only finite values are taken into account.
+ *
+ * The writer (serialized by the signal) adds values with add() and makes
+ * them visible to the readers with publish(). Readers get a consistent
+ * snapshot of the statistics without locking.
+ */
+class RunningStatistics
+{
+public:
+	RunningStatistics();
+
+	RunningStatistics(const RunningStatistics &) = delete;
+	RunningStatistics &operator=(const RunningStatistics &) = delete;
+
+	/**
+	 * Add a value. The statistics are not visible to the readers until
+	 * publish() is called.
+	 */
+	void add(double value);
+
+	/**
+	 * Publish the statistics of all added values to the readers.
+	 */
+	void publish();
+
+	/**
+	 * Reset the statistics and publish the reset.
+	 */
+	void clear();
+
+	/**
+	 * Return a consistent snapshot of the published statistics.
+	 */
+	AnalogStatistics statistics() const;
+
+	/**
+	 * Return a consistent snapshot of the published raw state.
+	 */
+	RunningStatisticsState state() const;
+
+	/**
+	 * Replace the statistics with the state and publish it. Like add(), this
+	 * must be serialized with the other writes.
+	 */
+	void restore(const RunningStatisticsState &state);
+
+private:
+	// Writer side state
+	size_t count_;
+	double mean_;
+	double m2_;
+
+	// Published state, guarded by the sequence counter (odd while writing)
+	std::atomic<unsigned int> sequence_;
+	std::atomic<size_t> published_count_;
+	std::atomic<double> published_mean_;
+	std::atomic<double> published_m2_;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_RUNNINGSTATISTICS_HPP
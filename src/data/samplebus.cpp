@@ -0,0 +1,295 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QObject>
+
+#include "samplebus.hpp"
+#include "src/session.hpp"
+#include "src/workerpool.hpp"
+
+using std::lock_guard;
+using std::make_shared;
+using std::mutex;
+using std::shared_ptr;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+SampleBus::Entry::Entry() :
+	executor(SampleExecutor::Inline),
+	worker_context(nullptr),
+	active(true),
+	delivery_count(0),
+	has_pending_range(false),
+	pending_first(0),
+	pending_last(0),
+	pending_cleared(false),
+	posted(false),
+	running(false),
+	running_first(0)
+{
+}
+
+SampleBus::Entry::~Entry()
+{
+	// The context lives in a worker thread
+	if (worker_context)
+		worker_context->deleteLater();
+}
+
+SampleBus::SampleBus() :
+	entries_(make_shared<const vector<shared_ptr<Entry>>>())
+{
+}
+
+unique_ptr<SampleBusSubscription> SampleBus::subscribe(
+	AppendedCallback appended, ClearedCallback cleared,
+	SampleExecutor executor, QObject *context)
+{
+	auto entry = make_shared<Entry>();
+	entry->appended = std::move(appended);
+	entry->cleared = std::move(cleared);
+
+	QObject *target = nullptr;
+	switch (executor) {
+	case SampleExecutor::Context:
+		target = context;
+		break;
+	case SampleExecutor::Worker:
+		if (Session::worker_pool) {
+			entry->worker_context = new QObject();
+			Session::worker_pool->move_to_worker(entry->worker_context);
+			target = entry->worker_context;
+		}
+		break;
+	case SampleExecutor::Gui:
+		target = QCoreApplication::instance();
+		break;
+	case SampleExecutor::Inline:
+	default:
+		break;
+	}
+	if (executor != SampleExecutor::Inline && !target) {
+		qWarning() << "SampleBus::subscribe(): No thread for the" <<
+			"subscriber, it is called inline";
+		executor = SampleExecutor::Inline;
+	}
+	entry->executor = executor;
+
+	if (executor != SampleExecutor::Inline) {
+		// The connection looks up the thread of the target for every
+		// delivery and calls it directly, if it's the publishing thread
+		entry->relay.reset(new SampleBusRelay());
+		weak_ptr<Entry> weak_entry = entry;
+		QObject::connect(entry->relay.get(), &SampleBusRelay::deliver,
+			target, [weak_entry]() {
+				auto locked_entry = weak_entry.lock();
+				if (locked_entry)
+					deliver_pending(*locked_entry);
+			});
+	}
+
+	{
+		lock_guard<mutex> lock(mutex_);
+		auto entries = make_shared<vector<shared_ptr<Entry>>>(
+			*std::atomic_load(&entries_));
+		entries->push_back(entry);
+		std::atomic_store(&entries_,
+			shared_ptr<const vector<shared_ptr<Entry>>>(entries));
+	}
+
+	return unique_ptr<SampleBusSubscription>(
+		new SampleBusSubscription(shared_from_this(), entry));
+}
+
+void SampleBus::publish_appended(size_t first, size_t last)
+{
+	const auto entries = std::atomic_load(&entries_);
+	for (const auto &entry : *entries) {
+		if (!entry->active.load(std::memory_order_acquire))
+			continue;
+		if (entry->executor == SampleExecutor::Inline) {
+			if (entry->appended)
+				entry->appended(first, last);
+			entry->delivery_count.fetch_add(1, std::memory_order_relaxed);
+		}
+		else {
+			post(*entry, false, first, last);
+		}
+	}
+}
+
+void SampleBus::publish_cleared()
+{
+	const auto entries = std::atomic_load(&entries_);
+	for (const auto &entry : *entries) {
+		if (!entry->active.load(std::memory_order_acquire))
+			continue;
+		if (entry->executor == SampleExecutor::Inline) {
+			if (entry->cleared)
+				entry->cleared();
+			entry->delivery_count.fetch_add(1, std::memory_order_relaxed);
+		}
+		else {
+			post(*entry, true, 0, 0);
+		}
+	}
+}
+
+size_t SampleBus::subscription_count() const
+{
+	return std::atomic_load(&entries_)->size();
+}
+
+size_t SampleBus::pending_pos() const
+{
+	size_t pos = std::numeric_limits<size_t>::max();
+	const auto entries = std::atomic_load(&entries_);
+	for (const auto &entry : *entries) {
+		lock_guard<mutex> lock(entry->pending_mutex);
+		if (entry->has_pending_range)
+			pos = std::min(pos, entry->pending_first);
+		if (entry->running)
+			pos = std::min(pos, entry->running_first);
+	}
+	return pos;
+}
+
+void SampleBus::post(Entry &entry, bool cleared, size_t first, size_t last)
+{
+	bool emit_delivery;
+	{
+		lock_guard<mutex> lock(entry.pending_mutex);
+		if (cleared) {
+			// The pending samples are gone
+			entry.pending_cleared = true;
+			entry.has_pending_range = false;
+		}
+		else if (entry.has_pending_range) {
+			entry.pending_first = std::min(entry.pending_first, first);
+			entry.pending_last = std::max(entry.pending_last, last);
+		}
+		else {
+			entry.pending_first = first;
+			entry.pending_last = last;
+			entry.has_pending_range = true;
+		}
+		emit_delivery = !entry.posted;
+		entry.posted = true;
+	}
+	if (emit_delivery)
+		Q_EMIT entry.relay->deliver();
+}
+
+void SampleBus::deliver_pending(Entry &entry)
+{
+	bool cleared;
+	bool has_range;
+	size_t first;
+	size_t last;
+	{
+		lock_guard<mutex> lock(entry.pending_mutex);
+		cleared = entry.pending_cleared;
+		has_range = entry.has_pending_range;
+		first = entry.pending_first;
+		last = entry.pending_last;
+		entry.pending_cleared = false;
+		entry.has_pending_range = false;
+		entry.posted = false;
+		// The samples are still needed, until the subscriber returns
+		entry.running = has_range;
+		entry.running_first = first;
+	}
+	if (entry.active.load(std::memory_order_acquire)) {
+		if (cleared && entry.cleared)
+			entry.cleared();
+		if (has_range && entry.appended)
+			entry.appended(first, last);
+		entry.delivery_count.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	if (has_range) {
+		lock_guard<mutex> lock(entry.pending_mutex);
+		entry.running = false;
+	}
+}
+
+void SampleBus::remove(const Entry *entry)
+{
+	lock_guard<mutex> lock(mutex_);
+	auto entries = make_shared<vector<shared_ptr<Entry>>>(
+		*std::atomic_load(&entries_));
+	entries->erase(std::remove_if(entries->begin(), entries->end(),
+		[entry](const shared_ptr<Entry> &e) { return e.get() == entry; }),
+		entries->end());
+	std::atomic_store(&entries_,
+		shared_ptr<const vector<shared_ptr<Entry>>>(entries));
+}
+
+SampleBusSubscription::SampleBusSubscription(weak_ptr<SampleBus> bus,
+		shared_ptr<SampleBus::Entry> entry) :
+	bus_(bus),
+	entry_(entry)
+{
+}
+
+SampleBusSubscription::~SampleBusSubscription()
+{
+	unsubscribe();
+}
+
+void SampleBusSubscription::unsubscribe()
+{
+	if (!entry_->active.exchange(false))
+		return;
+
+	auto bus = bus_.lock();
+	if (bus)
+		bus->remove(entry_.get());
+}
+
+bool SampleBusSubscription::is_active() const
+{
+	return entry_->active;
+}
+
+SampleExecutor SampleBusSubscription::executor() const
+{
+	return entry_->executor;
+}
+
+size_t SampleBusSubscription::delivery_count() const
+{
+	return entry_->delivery_count;
+}
+
+} // namespace data
+} // namespace sv
@@ -0,0 +1,205 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_SAMPLEBUS_HPP
+#define DATA_SAMPLEBUS_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <QObject>
+
+using std::shared_ptr;
+using std::unique_ptr;
+using std::vector;
+using std::weak_ptr;
+
+namespace sv {
+namespace data {
+
+/**
+ * Where a subscriber of a SampleBus is called.
+ */
+enum class SampleExecutor {
+	/** Directly in the thread, that publishes (the thread of the signal). */
+	Inline,
+	/** In the thread of a context object, e.g. a math channel in a worker. */
+	Context,
+	/** In a thread of the worker pool, see WorkerPool. */
+	Worker,
+	/** In the GUI thread. */
+	Gui,
+};
+
+class SampleBusSubscription;
+
+/**
+ * Emits deliver() to call a queued subscriber in the thread of its context.
+ */
+class SampleBusRelay : public QObject
+{
+	Q_OBJECT
+
+Q_SIGNALS:
+	void deliver();
+
+};
+
+/**
+ * Delivers the notifications about appended and cleared samples of a
+ * signal to typed callbacks, without the overhead of a Qt connection per
+ * subscriber and notification.
+ *
+ * The subscribers are stored in a copy on write list, so publishing only
+ * copies a shared pointer. An inline subscriber is called directly. For the
+ * other executors, the sample ranges are merged while a delivery is
+ * pending, so a busy subscriber gets one call with all new samples instead
+ * of a queue of events.
+ *
+ * The bus is used for the data path (math channels, analyzers, engines and
+ * script subscriptions). The Qt signals of the signals remain for the UI.
+ */
+class SampleBus : public std::enable_shared_from_this<SampleBus>
+{
+public:
+	/** Called with the absolute range [first, last) of new samples. */
+	using AppendedCallback = std::function<void(size_t first, size_t last)>;
+	using ClearedCallback = std::function<void()>;
+
+	SampleBus();
+
+	SampleBus(const SampleBus &) = delete;
+	SampleBus &operator=(const SampleBus &) = delete;
+
+	/**
+	 * Subscribe to the notifications. The subscription ends, when the
+	 * returned handle is destroyed. cleared may be empty.
+	 *
+	 * @param context The object, in whose thread a Context subscriber is
+	 *        called. The thread is looked up for every delivery, so the
+	 *        object may be moved to another thread later.
+	 */
+	unique_ptr<SampleBusSubscription> subscribe(AppendedCallback appended,
+		ClearedCallback cleared, SampleExecutor executor,
+		QObject *context = nullptr);
+
+	/** Publish the samples [first, last), see AppendedCallback. */
+	void publish_appended(size_t first, size_t last);
+	/** Publish, that all samples were cleared. */
+	void publish_cleared();
+
+	size_t subscription_count() const;
+
+	/**
+	 * Return the position of the first sample, that a queued subscriber
+	 * wasn't called with yet or is still processing, e.g. a math channel,
+	 * whose worker lags behind the signal. This is the max size_t value,
+	 * if no delivery is pending.
+	 */
+	size_t pending_pos() const;
+
+private:
+	struct Entry
+	{
+		Entry();
+		~Entry();
+
+		AppendedCallback appended;
+		ClearedCallback cleared;
+		SampleExecutor executor;
+		/** Emits the queued deliveries. Not used for Inline. */
+		unique_ptr<SampleBusRelay> relay;
+		/** The own context of a Worker subscriber. */
+		QObject *worker_context;
+		std::atomic<bool> active;
+		std::atomic<size_t> delivery_count;
+
+		/** Guards the pending delivery. */
+		std::mutex pending_mutex;
+		bool has_pending_range;
+		size_t pending_first;
+		size_t pending_last;
+		bool pending_cleared;
+		/** A delivery was emitted, that has not yet run. */
+		bool posted;
+		/** The subscriber is called with the range from running_first. */
+		bool running;
+		size_t running_first;
+	};
+
+	/**
+	 * Add the range or the clearing to the pending delivery of the entry
+	 * and emit the delivery, if none is pending.
+	 */
+	static void post(Entry &entry, bool cleared, size_t first, size_t last);
+	/** Run the pending delivery in the thread of the subscriber. */
+	static void deliver_pending(Entry &entry);
+
+	void remove(const Entry *entry);
+
+	/** Serializes the writers of entries_. */
+	std::mutex mutex_;
+	/** Replaced on every change, read with std::atomic_load(). */
+	shared_ptr<const vector<shared_ptr<Entry>>> entries_;
+
+	friend class SampleBusSubscription;
+
+};
+
+/**
+ * The handle of a SampleBus subscription. The subscriber isn't called any
+ * more, after unsubscribe() or the destructor returned, except for an
+ * inline call, that is already running in the thread of the signal.
+ */
+class SampleBusSubscription
+{
+public:
+	~SampleBusSubscription();
+
+	SampleBusSubscription(const SampleBusSubscription &) = delete;
+	SampleBusSubscription &operator=(const SampleBusSubscription &) = delete;
+
+	void unsubscribe();
+	bool is_active() const;
+	SampleExecutor executor() const;
+	/**
+	 * Return the number of calls of the subscriber. With merged ranges,
+	 * this can be less than the number of notifications.
+	 */
+	size_t delivery_count() const;
+
+private:
+	SampleBusSubscription(weak_ptr<SampleBus> bus,
+		shared_ptr<SampleBus::Entry> entry);
+
+	weak_ptr<SampleBus> bus_;
+	shared_ptr<SampleBus::Entry> entry_;
+
+	friend class SampleBus;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_SAMPLEBUS_HPP
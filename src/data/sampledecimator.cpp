@@ -0,0 +1,252 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+#include "sampledecimator.hpp"
+
+namespace sv {
+namespace data {
+
+const size_t SampleDecimator::max_output_count;
+
+SampleDecimator::SampleDecimator() :
+	mode_(DecimationMode::Off),
+	factor_(1),
+	tolerance_(0.)
+{
+	reset();
+}
+
+void SampleDecimator::set_mode(DecimationMode mode, size_t factor,
+	double tolerance)
+{
+	mode_ = mode;
+	factor_ = factor > 0 ? factor : 1;
+	tolerance_ = std::isfinite(tolerance) ? std::abs(tolerance) : 0.;
+	reset();
+}
+
+DecimationMode SampleDecimator::mode() const
+{
+	return mode_;
+}
+
+size_t SampleDecimator::factor() const
+{
+	return factor_;
+}
+
+double SampleDecimator::tolerance() const
+{
+	return tolerance_;
+}
+
+bool SampleDecimator::is_active() const
+{
+	// The historian modes already drop repeated values with a tolerance of 0
+	if (mode_ == DecimationMode::DeadBand ||
+			mode_ == DecimationMode::SwingingDoor)
+		return true;
+	return mode_ != DecimationMode::Off && factor_ > 1;
+}
+
+size_t SampleDecimator::add(double timestamp, double value,
+	double *timestamps, double *values)
+{
+	if (!is_active()) {
+		timestamps[0] = timestamp;
+		values[0] = value;
+		return 1;
+	}
+	if (mode_ == DecimationMode::DeadBand)
+		return add_dead_band(timestamp, value, timestamps, values);
+	if (mode_ == DecimationMode::SwingingDoor)
+		return add_swinging_door(timestamp, value, timestamps, values);
+
+	if (count_ == 0) {
+		first_timestamp_ = timestamp;
+		first_value_ = value;
+		min_timestamp_ = timestamp;
+		min_value_ = value;
+		max_timestamp_ = timestamp;
+		max_value_ = value;
+	}
+	else {
+		if (value < min_value_) {
+			min_timestamp_ = timestamp;
+			min_value_ = value;
+		}
+		if (value > max_value_) {
+			max_timestamp_ = timestamp;
+			max_value_ = value;
+		}
+	}
+	timestamp_sum_ += timestamp;
+	value_sum_ += value;
+	if (++count_ < factor_)
+		return 0;
+
+	size_t count = 1;
+	switch (mode_) {
+	case DecimationMode::Average:
+		timestamps[0] = timestamp_sum_ / (double)count_;
+		values[0] = value_sum_ / (double)count_;
+		break;
+	case DecimationMode::MinMax:
+		if (min_timestamp_ == max_timestamp_) {
+			// Constant values, min and max are the same sample
+			timestamps[0] = min_timestamp_;
+			values[0] = min_value_;
+		}
+		else if (min_timestamp_ < max_timestamp_) {
+			timestamps[0] = min_timestamp_;
+			values[0] = min_value_;
+			timestamps[1] = max_timestamp_;
+			values[1] = max_value_;
+			count = 2;
+		}
+		else {
+			timestamps[0] = max_timestamp_;
+			values[0] = max_value_;
+			timestamps[1] = min_timestamp_;
+			values[1] = min_value_;
+			count = 2;
+		}
+		break;
+	case DecimationMode::PickEveryN:
+	default:
+		timestamps[0] = first_timestamp_;
+		values[0] = first_value_;
+		break;
+	}
+
+	reset();
+	return count;
+}
+
+size_t SampleDecimator::add_dead_band(double timestamp, double value,
+	double *timestamps, double *values)
+{
+	// NaN (e.g. an overrange) is always stored and ends the band
+	const bool changed = !has_archived_ || std::isnan(value) ||
+		std::isnan(archived_value_) ||
+		std::abs(value - archived_value_) > tolerance_ ||
+		(factor_ > 1 && count_ + 1 >= factor_);
+	if (changed)
+		return archive(timestamp, value, timestamps, values);
+
+	++count_;
+	has_held_ = true;
+	held_timestamp_ = timestamp;
+	held_value_ = value;
+	return 0;
+}
+
+size_t SampleDecimator::add_swinging_door(double timestamp, double value,
+	double *timestamps, double *values)
+{
+	const double dt = timestamp - archived_timestamp_;
+	if (!has_archived_ || std::isnan(value) || std::isnan(archived_value_) ||
+			dt <= 0. || (factor_ > 1 && count_ + 1 >= factor_))
+		return archive(timestamp, value, timestamps, values);
+
+	// The doors are hinged at archived_value_ +- tolerance_ and close with
+	// every sample. All samples since the archived sample are within the
+	// tolerance of the segment to this sample, as long as its slope is
+	// still between the doors.
+	const double upper_slope =
+		std::max(upper_slope_, (value - archived_value_ - tolerance_) / dt);
+	const double lower_slope =
+		std::min(lower_slope_, (value - archived_value_ + tolerance_) / dt);
+	const double slope = (value - archived_value_) / dt;
+	if ((slope >= upper_slope && slope <= lower_slope) || !has_held_) {
+		++count_;
+		upper_slope_ = upper_slope;
+		lower_slope_ = lower_slope;
+		has_held_ = true;
+		held_timestamp_ = timestamp;
+		held_value_ = value;
+		return 0;
+	}
+
+	// The doors are closed: The held sample is the end of the segment and
+	// the start of the next one.
+	timestamps[0] = held_timestamp_;
+	values[0] = held_value_;
+	archived_timestamp_ = held_timestamp_;
+	archived_value_ = held_value_;
+	const double held_dt = timestamp - held_timestamp_;
+	upper_slope_ = (value - archived_value_ - tolerance_) / held_dt;
+	lower_slope_ = (value - archived_value_ + tolerance_) / held_dt;
+	count_ = 1;
+	held_timestamp_ = timestamp;
+	held_value_ = value;
+	return 1;
+}
+
+size_t SampleDecimator::archive(double timestamp, double value,
+	double *timestamps, double *values)
+{
+	size_t count = 0;
+	if (has_held_) {
+		timestamps[count] = held_timestamp_;
+		values[count] = held_value_;
+		++count;
+	}
+	timestamps[count] = timestamp;
+	values[count] = value;
+	++count;
+
+	has_archived_ = true;
+	archived_timestamp_ = timestamp;
+	archived_value_ = value;
+	has_held_ = false;
+	upper_slope_ = -std::numeric_limits<double>::infinity();
+	lower_slope_ = std::numeric_limits<double>::infinity();
+	count_ = 0;
+	return count;
+}
+
+void SampleDecimator::reset()
+{
+	count_ = 0;
+	first_timestamp_ = 0.;
+	first_value_ = 0.;
+	timestamp_sum_ = 0.;
+	value_sum_ = 0.;
+	min_timestamp_ = 0.;
+	min_value_ = 0.;
+	max_timestamp_ = 0.;
+	max_value_ = 0.;
+	has_archived_ = false;
+	archived_timestamp_ = 0.;
+	archived_value_ = 0.;
+	has_held_ = false;
+	held_timestamp_ = 0.;
+	held_value_ = 0.;
+	upper_slope_ = -std::numeric_limits<double>::infinity();
+	lower_slope_ = std::numeric_limits<double>::infinity();
+}
+
+} // namespace data
+} // namespace sv
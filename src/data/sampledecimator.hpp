@@ -0,0 +1,145 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_SAMPLEDECIMATOR_HPP
+#define DATA_SAMPLEDECIMATOR_HPP
+
+#include <cstddef>
+
+namespace sv {
+namespace data {
+
+/**
+ * How the samples of a signal are reduced, before they are stored.
+ */
+enum class DecimationMode {
+	/** Every sample is stored. */
+	Off,
+	/** Store the mean timestamp and value of every N samples. */
+	Average,
+	/**
+	 * Store the minimum and the maximum sample of every N samples, in the
+	 * order they were captured. Peaks are preserved.
+	 */
+	MinMax,
+	/** Store the first of every N samples. */
+	PickEveryN,
+	/**
+	 * Only store a sample, when it leaves the band of +-tolerance around
+	 * the last stored value. The last sample inside the band is stored,
+	 * too, so the signal is still flat when it is interpolated.
+	 */
+	DeadBand,
+	/**
+	 * Only store the samples, that are needed to reconstruct the signal by
+	 * linear interpolation within +-tolerance (swinging door compression).
+	 * Ramps are compressed as well as constant values.
+	 */
+	SwingingDoor,
+};
+
+/**
+ * Reduces a stream of samples by a fixed factor, so the full stream never
+ * has to be stored (e.g. 1 S/s of a device, that delivers 50 S/s), or by a
+ * tolerance like the compression of a process historian (DeadBand and
+ * SwingingDoor).
+ *
+ * A group of samples, that is not complete yet, is kept until the next
+ * samples arrive. The decimator is not thread safe, it is used under the
+ * write lock of the signal.
+ */
+class SampleDecimator
+{
+public:
+	/** The maximum number of samples, that add() returns for one sample. */
+	static const size_t max_output_count = 2;
+
+	SampleDecimator();
+
+	/**
+	 * Set the mode and the number of samples, that are reduced to one sample
+	 * (two for DecimationMode::MinMax). A factor of 0 or 1 disables the
+	 * decimation. The incomplete group is discarded.
+	 *
+	 * For DecimationMode::DeadBand and DecimationMode::SwingingDoor, the
+	 * factor is the maximum number of samples, that are reduced to one
+	 * stored sample (0 or 1 for no limit), and the tolerance is the
+	 * allowed deviation of the reconstructed signal.
+	 */
+	void set_mode(DecimationMode mode, size_t factor, double tolerance = 0.);
+	DecimationMode mode() const;
+	size_t factor() const;
+	double tolerance() const;
+	bool is_active() const;
+
+	/**
+	 * Add a sample and write the resulting samples to timestamps and values,
+	 * that must have room for max_output_count samples.
+	 *
+	 * @return The number of resulting samples.
+	 */
+	size_t add(double timestamp, double value,
+		double *timestamps, double *values);
+
+	/** Discard the incomplete group. */
+	void reset();
+
+private:
+	/** add() for DecimationMode::DeadBand. */
+	size_t add_dead_band(double timestamp, double value,
+		double *timestamps, double *values);
+	/** add() for DecimationMode::SwingingDoor. */
+	size_t add_swinging_door(double timestamp, double value,
+		double *timestamps, double *values);
+	/**
+	 * Store the held sample (if any) and the sample as new archived sample.
+	 */
+	size_t archive(double timestamp, double value,
+		double *timestamps, double *values);
+
+	DecimationMode mode_;
+	size_t factor_;
+	double tolerance_;
+	size_t count_;
+	double first_timestamp_;
+	double first_value_;
+	double timestamp_sum_;
+	double value_sum_;
+	double min_timestamp_;
+	double min_value_;
+	double max_timestamp_;
+	double max_value_;
+	/** The last stored sample of DeadBand and SwingingDoor. */
+	bool has_archived_;
+	double archived_timestamp_;
+	double archived_value_;
+	/** The last sample, that was not stored (yet). */
+	bool has_held_;
+	double held_timestamp_;
+	double held_value_;
+	/** The slopes of the upper and the lower door of SwingingDoor. */
+	double upper_slope_;
+	double lower_slope_;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_SAMPLEDECIMATOR_HPP
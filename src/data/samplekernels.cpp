@@ -0,0 +1,226 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+
+#include "samplekernels.hpp"
+
+namespace sv {
+namespace data {
+namespace samplekernels {
+
+namespace {
+
+template<typename T>
+void min_max_impl(const T *values, size_t count, double &min, double &max)
+{
+	const T inf = std::numeric_limits<T>::infinity();
+	const size_t lanes = 8;
+
+	// Independent lanes of selects without early exits, so they map to
+	// packed min/max instructions. Comparisons with NaN are false, so NaN
+	// values are skipped.
+	T lane_min[lanes];
+	T lane_max[lanes];
+	for (size_t j = 0; j < lanes; ++j) {
+		lane_min[j] = inf;
+		lane_max[j] = -inf;
+	}
+	size_t i = 0;
+	for (; i + lanes <= count; i += lanes) {
+		for (size_t j = 0; j < lanes; ++j) {
+			const T value = values[i + j];
+			lane_min[j] = value < lane_min[j] ? value : lane_min[j];
+			const T max_value = value != inf ? value : -inf;
+			lane_max[j] = max_value > lane_max[j] ? max_value : lane_max[j];
+		}
+	}
+	for (; i < count; ++i) {
+		const T value = values[i];
+		lane_min[0] = value < lane_min[0] ? value : lane_min[0];
+		const T max_value = value != inf ? value : -inf;
+		lane_max[0] = max_value > lane_max[0] ? max_value : lane_max[0];
+	}
+
+	for (size_t j = 0; j < lanes; ++j) {
+		if ((double)lane_min[j] < min)
+			min = (double)lane_min[j];
+		if ((double)lane_max[j] > max)
+			max = (double)lane_max[j];
+	}
+}
+
+template<typename T>
+void deinterleave_impl(const T *src, size_t count, size_t stride, T *dest)
+{
+	switch (stride) {
+	// The common channel counts get a loop with a constant stride
+	case 2:
+		for (size_t i = 0; i < count; ++i)
+			dest[i] = src[i * 2];
+		break;
+	case 3:
+		for (size_t i = 0; i < count; ++i)
+			dest[i] = src[i * 3];
+		break;
+	case 4:
+		for (size_t i = 0; i < count; ++i)
+			dest[i] = src[i * 4];
+		break;
+	default:
+		for (size_t i = 0; i < count; ++i)
+			dest[i] = src[i * stride];
+		break;
+	}
+}
+
+}
+
+void deinterleave(const float *src, size_t count, size_t stride, float *dest)
+{
+	deinterleave_impl(src, count, stride, dest);
+}
+
+void deinterleave(const double *src, size_t count, size_t stride,
+	double *dest)
+{
+	deinterleave_impl(src, count, stride, dest);
+}
+
+void widen(const float *src, size_t count, double *dest)
+{
+	for (size_t i = 0; i < count; ++i)
+		dest[i] = (double)src[i];
+}
+
+void min_max(const float *values, size_t count, double &min, double &max)
+{
+	min_max_impl(values, count, min, max);
+}
+
+void min_max(const double *values, size_t count, double &min, double &max)
+{
+	min_max_impl(values, count, min, max);
+}
+
+void polynomial(const double *coefficients, size_t coefficient_count,
+	const double *values, size_t count, double *dest)
+{
+	if (coefficient_count == 0) {
+		for (size_t i = 0; i < count; ++i)
+			dest[i] = 0.;
+		return;
+	}
+
+	// The block stays in the L1 cache while all coefficients are applied
+	const size_t block_size = 256;
+	double x[block_size];
+	double result[block_size];
+	const double highest = coefficients[coefficient_count - 1];
+	for (size_t pos = 0; pos < count; pos += block_size) {
+		const size_t n = std::min(count - pos, block_size);
+		for (size_t i = 0; i < n; ++i) {
+			x[i] = values[pos + i];
+			result[i] = highest;
+		}
+		for (size_t k = coefficient_count - 1; k > 0; --k) {
+			const double coefficient = coefficients[k - 1];
+			for (size_t i = 0; i < n; ++i)
+				result[i] = result[i] * x[i] + coefficient;
+		}
+		for (size_t i = 0; i < n; ++i)
+			dest[pos + i] = result[i];
+	}
+}
+
+void lookup_linear(const double *table, size_t table_size, double begin,
+	double step_inverse, const double *values, size_t count, double *dest)
+{
+	const double last_segment = (double)(table_size - 2);
+	for (size_t i = 0; i < count; ++i) {
+		const double position = (values[i] - begin) * step_inverse;
+		// Comparisons with NaN are false, so NaN is clamped to 0 for the
+		// index, but stays NaN in the fraction
+		double clamped = position >= 0. ? position : 0.;
+		clamped = clamped <= last_segment ? clamped : last_segment;
+		const size_t index = (size_t)clamped;
+		const double fraction = position - (double)index;
+		dest[i] = table[index] + fraction * (table[index + 1] - table[index]);
+	}
+}
+
+void power_sums(const double *v, const double *i, const double *w,
+	size_t count, double sums[5])
+{
+	const size_t lanes = 4;
+
+	// Independent lanes of sums, so the adds don't wait for each other and
+	// map to packed instructions. x - x is NaN for a non finite x, so the
+	// check is a compare and the skipped pairs are zeroed by selects.
+	double lane_w[lanes] = {};
+	double lane_v[lanes] = {};
+	double lane_vv[lanes] = {};
+	double lane_ii[lanes] = {};
+	double lane_vi[lanes] = {};
+	size_t k = 0;
+	for (; k + lanes <= count; k += lanes) {
+		for (size_t j = 0; j < lanes; ++j) {
+			const double vk = v[k + j];
+			const double ik = i[k + j];
+			const double wk = w[k + j];
+			const bool valid =
+				(vk - vk == 0.) & (ik - ik == 0.) & (wk - wk == 0.);
+			const double weight = valid ? wk : 0.;
+			const double voltage = valid ? vk : 0.;
+			const double current = valid ? ik : 0.;
+			const double wv = weight * voltage;
+			lane_w[j] += weight;
+			lane_v[j] += wv;
+			lane_vv[j] += wv * voltage;
+			lane_ii[j] += weight * current * current;
+			lane_vi[j] += wv * current;
+		}
+	}
+	for (; k < count; ++k) {
+		const double vk = v[k];
+		const double ik = i[k];
+		const double wk = w[k];
+		if (!(vk - vk == 0.) || !(ik - ik == 0.) || !(wk - wk == 0.))
+			continue;
+		const double wv = wk * vk;
+		lane_w[0] += wk;
+		lane_v[0] += wv;
+		lane_vv[0] += wv * vk;
+		lane_ii[0] += wk * ik * ik;
+		lane_vi[0] += wv * ik;
+	}
+	for (size_t j = 0; j < lanes; ++j) {
+		sums[0] += lane_w[j];
+		sums[1] += lane_v[j];
+		sums[2] += lane_vv[j];
+		sums[3] += lane_ii[j];
+		sums[4] += lane_vi[j];
+	}
+}
+
+} // namespace samplekernels
+} // namespace data
+} // namespace sv
@@ -0,0 +1,93 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_SAMPLEKERNELS_HPP
+#define DATA_SAMPLEKERNELS_HPP
+
+#include <cstddef>
+
+namespace sv {
+namespace data {
+namespace samplekernels {
+
+/**
+ * The kernels for the hot paths of the datafeed. They are written as simple
+ * branch free loops, so the compiler vectorizes them for the target (SSE2,
+ * AVX2, NEON, ...) without any platform specific code.
+ */
+
+/**
+ * Copy count samples, that are stride samples apart, from src to dest.
+ */
+void deinterleave(const float *src, size_t count, size_t stride, float *dest);
+void deinterleave(const double *src, size_t count, size_t stride,
+	double *dest);
+
+/**
+ * Convert count float samples from src to double.
+ */
+void widen(const float *src, size_t count, double *dest);
+
+/**
+ * Lower min and raise max to the minimum and maximum of count values. NaN
+ * values are ignored. Like for the signals, +infinity (overflow) is ignored
+ * for the maximum.
+ */
+void min_max(const float *values, size_t count, double &min, double &max);
+void min_max(const double *values, size_t count, double &min, double &max);
+
+/**
+ * Evaluate the polynomial with the coefficient_count coefficients (in
+ * ascending order, c0 + c1 * x + ...) for count values with the Horner
+ * scheme. The samples are evaluated in blocks, coefficient by coefficient,
+ * so the inner loop has no dependencies. dest may be values.
+ */
+void polynomial(const double *coefficients, size_t coefficient_count,
+	const double *values, size_t count, double *dest);
+
+/**
+ * Interpolate count values linearly in a table of table_size (at least 2)
+ * points, that are step apart, starting at begin. step_inverse is 1 / step.
+ * The index is calculated directly, without a search. Values outside of
+ * the table are extrapolated from the first or last segment, NaN stays NaN.
+ * dest may be values.
+ */
+void lookup_linear(const double *table, size_t table_size, double begin,
+	double step_inverse, const double *values, size_t count, double *dest);
+
+/**
+ * Add the weighted sums of count pairs of voltage and current samples to
+ * sums, e.g. to calculate the power of a cycle. The weights w are usually
+ * the sample intervals:
+ * - sums[0]: w
+ * - sums[1]: w * v
+ * - sums[2]: w * v^2
+ * - sums[3]: w * i^2
+ * - sums[4]: w * v * i
+ *
+ * Pairs with a non finite value or weight are skipped.
+ */
+void power_sums(const double *v, const double *i, const double *w,
+	size_t count, double sums[5]);
+
+} // namespace samplekernels
+} // namespace data
+} // namespace sv
+
+#endif // DATA_SAMPLEKERNELS_HPP
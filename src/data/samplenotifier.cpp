@@ -0,0 +1,133 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
+#include <QMetaObject>
+#include <QMetaType>
+#include <QTimer>
+
+#include "samplenotifier.hpp"
+
+namespace sv {
+namespace data {
+
+const int SampleNotifier::default_interval;
+const size_t SampleNotifier::default_batch_size;
+
+SampleNotifier::SampleNotifier(QObject *parent) :
+	QObject(parent),
+	interval_(default_interval),
+	batch_size_(default_batch_size),
+	pending_end_(0),
+	notified_end_(0),
+	flush_queued_(false),
+	batch_queued_(false),
+	last_flush_(std::chrono::steady_clock::now())
+{
+	// Needed for queued connections to receivers in other threads
+	qRegisterMetaType<size_t>("size_t");
+
+	timer_ = new QTimer(this);
+	timer_->setSingleShot(true);
+	connect(timer_, &QTimer::timeout, this, &SampleNotifier::flush);
+}
+
+void SampleNotifier::set_interval(int interval)
+{
+	interval_ = std::max(0, interval);
+}
+
+int SampleNotifier::interval() const
+{
+	return interval_;
+}
+
+void SampleNotifier::set_batch_size(size_t batch_size)
+{
+	batch_size_ = std::max((size_t)1, batch_size);
+}
+
+size_t SampleNotifier::batch_size() const
+{
+	return batch_size_;
+}
+
+void SampleNotifier::notify(size_t end_pos)
+{
+	pending_end_.store(end_pos);
+
+	if (!flush_queued_.exchange(true)) {
+		post_flush();
+		return;
+	}
+	// A flush is already pending, but don't wait for the timer if a whole
+	// batch is ready.
+	const size_t notified_end = notified_end_.load();
+	if (end_pos > notified_end && end_pos - notified_end >= batch_size_ &&
+			!batch_queued_.exchange(true))
+		post_flush();
+}
+
+void SampleNotifier::reset()
+{
+	pending_end_.store(0);
+	notified_end_.store(0);
+}
+
+void SampleNotifier::post_flush()
+{
+	QMetaObject::invokeMethod(this, "flush", Qt::QueuedConnection);
+}
+
+void SampleNotifier::flush()
+{
+	const auto now = std::chrono::steady_clock::now();
+	const size_t notified_end = notified_end_.load();
+	size_t end = pending_end_.load();
+	if (end > notified_end && end - notified_end < batch_size_) {
+		const auto elapsed = std::chrono::duration_cast<
+			std::chrono::milliseconds>(now - last_flush_).count();
+		if (elapsed < interval_) {
+			// Keep flush_queued_ set, the timer will flush later
+			if (!timer_->isActive())
+				timer_->start(interval_ - (int)elapsed);
+			return;
+		}
+	}
+
+	timer_->stop();
+	flush_queued_.store(false);
+	batch_queued_.store(false);
+	// Samples, that were published before the flags were reset, are
+	// included here. All later samples post a new flush.
+	end = pending_end_.load();
+	if (end <= notified_end)
+		return;
+
+	notified_end_.store(end);
+	last_flush_ = now;
+	Q_EMIT samples_appended(notified_end, end);
+}
+
+} // namespace data
+} // namespace sv
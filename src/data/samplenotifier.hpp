@@ -0,0 +1,112 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_SAMPLENOTIFIER_HPP
+#define DATA_SAMPLENOTIFIER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
+#include <QObject>
+
+class QTimer;
+
+namespace sv {
+namespace data {
+
+/**
+ * Coalesces the notifications about appended samples.
+ *
+ * The writer (e.g. the acquisition thread) calls notify() after every
+ * published sample or block of samples. This only stores the new end
+ * position and posts at most one event to the thread of the notifier.
+ * samples_appended() is then emitted at most once per interval() with the
+ * whole range of samples, that were appended since the last notification.
+ * If batch_size() samples are pending, the notification is emitted
+ * immediately.
+ */
+class SampleNotifier : public QObject
+{
+	Q_OBJECT
+
+public:
+	explicit SampleNotifier(QObject *parent = nullptr);
+
+	/**
+	 * Set the minimal interval between two notifications in milliseconds.
+	 * 0 emits one notification per event loop iteration.
+	 */
+	void set_interval(int interval);
+	int interval() const;
+
+	/**
+	 * Set the number of pending samples, that trigger a notification
+	 * before the interval has elapsed.
+	 */
+	void set_batch_size(size_t batch_size);
+	size_t batch_size() const;
+
+	/**
+	 * Notify that the samples up to end_pos (exclusive) were published.
+	 * Can be called from any thread, but only by one writer at a time.
+	 */
+	void notify(size_t end_pos);
+
+	/**
+	 * Reset the notified position, e.g. after the samples were cleared.
+	 */
+	void reset();
+
+	/** The default interval in milliseconds. */
+	static const int default_interval = 20;
+	/** The default batch size in samples. */
+	static const size_t default_batch_size = 4096;
+
+private:
+	void post_flush();
+
+	std::atomic<int> interval_;
+	std::atomic<size_t> batch_size_;
+	/** End of the published samples, set by the writer. */
+	std::atomic<size_t> pending_end_;
+	/** End of the samples, that were already notified. */
+	std::atomic<size_t> notified_end_;
+	/** A flush is posted or the timer is running. */
+	std::atomic<bool> flush_queued_;
+	/** An immediate flush for a full batch is posted. */
+	std::atomic<bool> batch_queued_;
+	std::chrono::steady_clock::time_point last_flush_;
+	QTimer *timer_;
+
+private Q_SLOTS:
+	void flush();
+
+Q_SIGNALS:
+	/**
+	 * The samples in the absolute range [first, last) were appended.
+	 */
+	void samples_appended(size_t first, size_t last);
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_SAMPLENOTIFIER_HPP
@@ -0,0 +1,373 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QString>
+
+#include "sessioncheckpoint.hpp"
+#include "src/channels/basechannel.hpp"
+#include "src/channels/hardwarechannel.hpp"
+#include "src/channels/mathchannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/basesignal.hpp"
+#include "src/data/capturefile.hpp"
+#include "src/data/signalregistry.hpp"
+#include "src/devices/basedevice.hpp"
+
+using std::dynamic_pointer_cast;
+using std::lock_guard;
+using std::make_pair;
+using std::shared_ptr;
+using std::static_pointer_cast;
+using std::string;
+using std::unique_lock;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+namespace {
+
+const size_t npos = std::numeric_limits<size_t>::max();
+
+}
+
+const double SessionCheckpoint::default_interval_ = 60.;
+const double SessionCheckpoint::min_interval_ = .1;
+
+SessionCheckpoint::SessionCheckpoint() :
+	interval_(default_interval_),
+	reader_open_(false),
+	stop_(false),
+	running_(false),
+	error_(false),
+	checkpoint_count_(0)
+{
+}
+
+SessionCheckpoint::~SessionCheckpoint()
+{
+	stop();
+}
+
+void SessionCheckpoint::set_interval(double interval)
+{
+	interval_ = std::max(interval, min_interval_);
+}
+
+double SessionCheckpoint::interval() const
+{
+	return interval_;
+}
+
+bool SessionCheckpoint::start(const string &file_name,
+	shared_ptr<SignalRegistry> registry, bool resume)
+{
+	stop();
+
+	lock_guard<std::mutex> lock(file_mutex_);
+	error_ = false;
+	checkpoint_count_ = 0;
+	registry_ = registry;
+	reader_.close();
+	reader_open_ = false;
+	restored_.clear();
+
+	const QString q_file_name = QString::fromStdString(file_name);
+	if (resume && QFile::exists(q_file_name)) {
+		if (!reader_.open(file_name)) {
+			qWarning() << "SessionCheckpoint::start():" << q_file_name <<
+				"is not a capture file";
+			return false;
+		}
+		// Cut off the record, that was written during a crash
+		const size_t valid_size = reader_.valid_size();
+		if ((qint64)valid_size < QFileInfo(q_file_name).size()) {
+			reader_.close();
+			if (!QFile::resize(q_file_name, (qint64)valid_size) ||
+					!reader_.open(file_name)) {
+				qWarning() << "SessionCheckpoint::start(): Can't repair" <<
+					q_file_name;
+				return false;
+			}
+		}
+		if (!writer_.open_append(file_name, reader_.next_signal_id(), true)) {
+			reader_.close();
+			return false;
+		}
+		reader_open_ = true;
+		restored_.assign(reader_.signal_infos().size(), false);
+		qDebug() << "SessionCheckpoint::start(): Resuming" <<
+			reader_.signal_infos().size() << "signals from" << q_file_name;
+	}
+	else if (!writer_.open(file_name, true)) {
+		return false;
+	}
+
+	stop_ = false;
+	running_ = true;
+	thread_ = std::thread(&SessionCheckpoint::thread_proc, this);
+	return true;
+}
+
+void SessionCheckpoint::stop()
+{
+	if (!thread_.joinable())
+		return;
+
+	{
+		lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+	}
+	stop_cond_.notify_one();
+	thread_.join();
+	running_ = false;
+
+	lock_guard<std::mutex> lock(file_mutex_);
+	reader_.close();
+	reader_open_ = false;
+	registry_ = nullptr;
+}
+
+bool SessionCheckpoint::is_running() const
+{
+	return running_;
+}
+
+bool SessionCheckpoint::has_error() const
+{
+	return error_;
+}
+
+size_t SessionCheckpoint::checkpoint_count() const
+{
+	return checkpoint_count_;
+}
+
+void SessionCheckpoint::restore_device(shared_ptr<devices::BaseDevice> device)
+{
+	lock_guard<std::mutex> lock(file_mutex_);
+	if (!reader_open_ || !device)
+		return;
+
+	const string device_name = device->name();
+	const auto &infos = reader_.signal_infos();
+	for (size_t i = 0; i < infos.size(); ++i) {
+		const auto &info = infos[i];
+		if (restored_[i] || info.device_name != device_name)
+			continue;
+		const auto channel_it = device->channel_map().find(info.channel_name);
+		if (channel_it == device->channel_map().end())
+			continue;
+		auto channel = channel_it->second;
+		// The math channels are restored, when they are added again
+		if (dynamic_pointer_cast<channels::MathChannel>(channel))
+			continue;
+
+		// Use the same signal, that the acquisition would select
+		shared_ptr<AnalogTimeSignal> signal;
+		const auto &signal_map = channel->signal_map();
+		const auto mq_it = signal_map.find(
+			make_pair(info.quantity, info.quantity_flags));
+		if (mq_it != signal_map.end()) {
+			for (const auto &base_signal : mq_it->second) {
+				if (base_signal->name() == info.name) {
+					signal = dynamic_pointer_cast<AnalogTimeSignal>(
+						base_signal);
+					break;
+				}
+			}
+		}
+		if (!signal) {
+			signal = static_pointer_cast<AnalogTimeSignal>(channel->add_signal(
+				info.quantity, info.quantity_flags, info.unit, info.name));
+			// See HardwareChannel::select_signal()
+			if (dynamic_pointer_cast<channels::HardwareChannel>(channel)) {
+				signal->set_value_storage(ValueStorage::Float32);
+				signal->set_compression(true);
+			}
+		}
+		if (!signal)
+			continue;
+		if (signal->sample_count() > 0) {
+			qWarning() << "SessionCheckpoint::restore_device(): Signal" <<
+				signal->display_name() << "already has samples";
+			continue;
+		}
+
+		restore_signal(i, signal, nullptr);
+	}
+	release_reader();
+}
+
+void SessionCheckpoint::restore_math_channel(
+	shared_ptr<channels::MathChannel> math_channel)
+{
+	lock_guard<std::mutex> lock(file_mutex_);
+	if (!reader_open_ || !math_channel || !math_channel->parent_device())
+		return;
+
+	auto signal = dynamic_pointer_cast<AnalogTimeSignal>(
+		math_channel->actual_signal());
+	if (!signal || signal->sample_count() > 0)
+		return;
+
+	const size_t index = find_signal(math_channel->parent_device()->name(),
+		math_channel->name(), signal->quantity(), signal->quantity_flags());
+	if (index == npos)
+		return;
+
+	restore_signal(index, signal, math_channel);
+	release_reader();
+}
+
+size_t SessionCheckpoint::find_signal(const string &device_name,
+	const string &channel_name, Quantity quantity,
+	const set<QuantityFlag> &quantity_flags) const
+{
+	// A signal, that was added again before it was restored, has an empty
+	// duplicate in the file, so prefer the signals with samples
+	size_t index = npos;
+	const auto &infos = reader_.signal_infos();
+	for (size_t i = 0; i < infos.size(); ++i) {
+		const auto &info = infos[i];
+		if (restored_[i] || info.device_name != device_name ||
+				info.channel_name != channel_name ||
+				info.quantity != quantity ||
+				info.quantity_flags != quantity_flags)
+			continue;
+		if (info.sample_count > 0)
+			return i;
+		if (index == npos)
+			index = i;
+	}
+	return index;
+}
+
+bool SessionCheckpoint::restore_signal(size_t index,
+	shared_ptr<AnalogTimeSignal> signal,
+	shared_ptr<channels::MathChannel> math_channel)
+{
+	restored_[index] = true;
+	const auto &info = reader_.signal_infos()[index];
+	const CaptureSignalState *state = reader_.signal_state(index);
+
+	// The samples are copied, so the reader can be closed afterwards. The
+	// statistics are restored at the position, that they belong to, and
+	// the samples behind it are added to them as usual.
+	const size_t state_pos = state ?
+		std::min(state->sample_count, info.sample_count) : info.sample_count;
+	if (!reader_.push_samples(index, signal, nullptr, 0, state_pos))
+		return false;
+	if (state)
+		signal->restore_statistics(state->statistics);
+
+	double last_timestamp = -std::numeric_limits<double>::infinity();
+	for (const auto &chunk_info : reader_.chunk_infos()) {
+		if (chunk_info.signal == index)
+			last_timestamp = std::max(last_timestamp, chunk_info.last_timestamp);
+	}
+
+	if (math_channel) {
+		// The samples behind the state are calculated again from the
+		// restored source signals, but are not written again
+		const double resume_timestamp = signal->sample_count() > 0 ?
+			signal->last_timestamp(false) :
+			-std::numeric_limits<double>::infinity();
+		math_channel->resume(
+			state ? state->channel_state : vector<double>(), resume_timestamp);
+	}
+	else if (!reader_.push_samples(index, signal, nullptr, state_pos)) {
+		return false;
+	}
+
+	qDebug() << "SessionCheckpoint: Restored" << signal->sample_count() <<
+		"samples of" << signal->display_name();
+	return writer_.resume_signal(
+		signal, info.id, info.sample_count, last_timestamp);
+}
+
+void SessionCheckpoint::release_reader()
+{
+	if (std::find(restored_.begin(), restored_.end(), false) !=
+			restored_.end())
+		return;
+
+	reader_.close();
+	reader_open_ = false;
+}
+
+void SessionCheckpoint::add_new_signals()
+{
+	if (!registry_)
+		return;
+
+	const auto signals = registry_->signals();
+	for (const auto &base_signal : *signals) {
+		auto signal = dynamic_pointer_cast<AnalogTimeSignal>(base_signal);
+		if (signal && !writer_.has_signal(signal))
+			writer_.add_signal(signal);
+	}
+}
+
+void SessionCheckpoint::thread_proc()
+{
+	const auto interval = std::chrono::duration_cast<
+		std::chrono::steady_clock::duration>(
+			std::chrono::duration<double>(interval_));
+
+	bool stopping = false;
+	while (!stopping) {
+		{
+			unique_lock<std::mutex> lock(mutex_);
+			stop_cond_.wait_for(lock, interval, [this]() {
+				return stop_.load();
+			});
+			stopping = stop_;
+		}
+
+		lock_guard<std::mutex> lock(file_mutex_);
+		add_new_signals();
+		// A checkpoint must survive a crash of the system
+		if (!writer_.write_checkpoint() || !writer_.sync()) {
+			qWarning() << "SessionCheckpoint: Writing the checkpoint failed";
+			error_ = true;
+			break;
+		}
+		++checkpoint_count_;
+	}
+
+	lock_guard<std::mutex> lock(file_mutex_);
+	writer_.close();
+	running_ = false;
+}
+
+} // namespace data
+} // namespace sv
@@ -0,0 +1,168 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_SESSIONCHECKPOINT_HPP
+#define DATA_SESSIONCHECKPOINT_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "src/data/capturefile.hpp"
+
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+
+namespace channels {
+class BaseChannel;
+class MathChannel;
+}
+
+namespace devices {
+class BaseDevice;
+}
+
+namespace data {
+
+class AnalogTimeSignal;
+class SignalRegistry;
+
+/**
+ * Periodic checkpoints of all signals of the session to a capture file, so
+ * a long running measurement survives a crash or a restart of SmuView.
+ *
+ * A background thread writes a checkpoint every interval, see
+ * CaptureWriter::write_checkpoint(): The new samples of every signal of the
+ * registry are appended together with the state of its running statistics
+ * and, for math channels, the state of the calculation (e.g. the
+ * accumulator of an integration). A checkpoint only appends the samples
+ * since the last one.
+ *
+ * When a checkpoint file is resumed, the signals of a device are restored
+ * from the file, when the device is opened (restore_device()), and those
+ * of a math channel, when the channel is added (restore_math_channel()).
+ * The acquisition then continues to append to the restored signals and the
+ * checkpoints continue to append to the file.
+ */
+class SessionCheckpoint
+{
+public:
+	SessionCheckpoint();
+	/** Stops the checkpoints. */
+	~SessionCheckpoint();
+
+	SessionCheckpoint(const SessionCheckpoint &) = delete;
+	SessionCheckpoint &operator=(const SessionCheckpoint &) = delete;
+
+	/**
+	 * Set the checkpoint interval in seconds, the default is 60 s. This is
+	 * used by the next start().
+	 */
+	void set_interval(double interval);
+	double interval() const;
+
+	/**
+	 * Open the checkpoint file and start the checkpoints of all signals of
+	 * the registry. A running checkpoint is stopped.
+	 *
+	 * @param resume Resume an existing checkpoint file. An incomplete
+	 *        record at the end of the file (from a crash) is cut off. If
+	 *        resume is false or the file doesn't exist, a new file is
+	 *        created.
+	 * @return false if the file couldn't be opened.
+	 */
+	bool start(const string &file_name, shared_ptr<SignalRegistry> registry,
+		bool resume = true);
+	/** Write a last checkpoint and close the file. */
+	void stop();
+	bool is_running() const;
+
+	/** Return true if writing the file failed, the checkpoints are stopped. */
+	bool has_error() const;
+	/** Return the number of written checkpoints. */
+	size_t checkpoint_count() const;
+
+	/**
+	 * Restore the signals of the (hardware or user) channels of the device
+	 * from the resumed file. This must be called after the channels of the
+	 * device were created and before the acquisition starts.
+	 */
+	void restore_device(shared_ptr<devices::BaseDevice> device);
+	/**
+	 * Restore the signal and the calculation state of the math channel. This
+	 * must be called after the signal of the channel was created and before
+	 * the channel calculates.
+	 */
+	void restore_math_channel(shared_ptr<channels::MathChannel> math_channel);
+
+private:
+	void thread_proc();
+	/** Add the signals of the registry, that are not in the file yet. */
+	void add_new_signals();
+	/**
+	 * Return the index of the first unused signal in the file, that matches
+	 * the channel and the measured quantity, npos if there is none.
+	 */
+	size_t find_signal(const string &device_name, const string &channel_name,
+		Quantity quantity, const set<QuantityFlag> &quantity_flags) const;
+	/**
+	 * Restore the samples and the state of the file signal to the (empty)
+	 * signal and continue it in the file.
+	 */
+	bool restore_signal(size_t index, shared_ptr<AnalogTimeSignal> signal,
+		shared_ptr<channels::MathChannel> math_channel);
+	/** Close the reader, when all signals of the file were restored. */
+	void release_reader();
+
+	static const double default_interval_;
+	static const double min_interval_;
+
+	double interval_;
+	shared_ptr<SignalRegistry> registry_;
+	/** Guards the writer and the reader. */
+	mutable std::mutex file_mutex_;
+	CaptureWriter writer_;
+	CaptureReader reader_;
+	bool reader_open_;
+	/** The signals of the file, that were already restored. */
+	vector<bool> restored_;
+
+	std::thread thread_;
+	/** Guards stop_ for the condition. */
+	std::mutex mutex_;
+	std::condition_variable stop_cond_;
+	std::atomic<bool> stop_;
+	std::atomic<bool> running_;
+	std::atomic<bool> error_;
+	std::atomic<size_t> checkpoint_count_;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_SESSIONCHECKPOINT_HPP
@@ -0,0 +1,247 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <QDebug>
+#include <QString>
+
+#include "sharedmemoryring.hpp"
+
+namespace sv {
+namespace data {
+
+namespace {
+
+/** The samples start behind the header at a cache line boundary. */
+const size_t header_size = 256;
+
+static_assert(sizeof(SharedMemoryRingHeader) <= header_size,
+	"The header doesn't fit");
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2,
+	"The header needs lock-free 64 bit atomics");
+
+size_t round_up_to_power_of_two(size_t value)
+{
+	size_t result = 1;
+	while (result < value)
+		result <<= 1;
+	return result;
+}
+
+void copy_string(char *dest, size_t dest_size, const string &src)
+{
+	const size_t size = std::min(src.size(), dest_size - 1);
+	memcpy(dest, src.data(), size);
+	dest[size] = '\0';
+}
+
+}
+
+SharedMemoryRing::SharedMemoryRing() :
+	capacity_(0),
+	write_pos_(0),
+	sequence_(0),
+	size_(0),
+	mapping_(nullptr),
+	header_(nullptr),
+	timestamps_(nullptr),
+	values_(nullptr)
+#ifdef _WIN32
+	, handle_(nullptr)
+#endif
+{
+}
+
+SharedMemoryRing::~SharedMemoryRing()
+{
+	close();
+}
+
+bool SharedMemoryRing::open(const string &name, size_t capacity,
+	size_t write_pos, double signal_start_timestamp,
+	const string &signal_name, const string &unit_name)
+{
+	close();
+
+	if (name.empty() || capacity == 0) {
+		qWarning() << "SharedMemoryRing::open(): No name or capacity";
+		return false;
+	}
+
+	const size_t ring_capacity = round_up_to_power_of_two(capacity);
+	const size_t size = header_size + 2 * ring_capacity * sizeof(double);
+
+#ifdef _WIN32
+	const uint64_t size64 = (uint64_t)size;
+	HANDLE handle = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr,
+		PAGE_READWRITE, (DWORD)(size64 >> 32), (DWORD)size64, name.c_str());
+	if (!handle) {
+		qWarning() << "SharedMemoryRing::open(): Can't create" <<
+			QString::fromStdString(name) << "error" << GetLastError();
+		return false;
+	}
+	void *mapping = MapViewOfFile(handle, FILE_MAP_ALL_ACCESS, 0, 0, size);
+	if (!mapping) {
+		qWarning() << "SharedMemoryRing::open(): Can't map" <<
+			QString::fromStdString(name) << "error" << GetLastError();
+		CloseHandle(handle);
+		return false;
+	}
+	handle_ = handle;
+	name_ = name;
+#else
+	// POSIX names start with a slash, like in Python's shared_memory
+	const string shm_name = name[0] == '/' ? name : "/" + name;
+	const int fd = shm_open(shm_name.c_str(), O_CREAT | O_RDWR, 0600);
+	if (fd < 0) {
+		qWarning() << "SharedMemoryRing::open(): Can't create" <<
+			QString::fromStdString(shm_name) << ":" << strerror(errno);
+		return false;
+	}
+	// Shrink a stale object of an earlier run first, so it is zeroed
+	if (ftruncate(fd, 0) != 0 || ftruncate(fd, (off_t)size) != 0) {
+		qWarning() << "SharedMemoryRing::open(): Can't resize" <<
+			QString::fromStdString(shm_name) << ":" << strerror(errno);
+		::close(fd);
+		shm_unlink(shm_name.c_str());
+		return false;
+	}
+	void *mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+		fd, 0);
+	::close(fd);
+	if (mapping == MAP_FAILED) {
+		qWarning() << "SharedMemoryRing::open(): Can't map" <<
+			QString::fromStdString(shm_name) << ":" << strerror(errno);
+		shm_unlink(shm_name.c_str());
+		return false;
+	}
+	name_ = shm_name;
+#endif
+
+	mapping_ = mapping;
+	size_ = size;
+	capacity_ = ring_capacity;
+	write_pos_ = write_pos;
+	sequence_ = 0;
+	header_ = new (mapping) SharedMemoryRingHeader;
+	timestamps_ = (double *)((char *)mapping + header_size);
+	values_ = timestamps_ + ring_capacity;
+
+	header_->version = version;
+	header_->capacity = ring_capacity;
+	header_->timestamps_offset = header_size;
+	header_->values_offset = header_size + ring_capacity * sizeof(double);
+	header_->signal_start_timestamp = signal_start_timestamp;
+	header_->sequence.store(0, std::memory_order_relaxed);
+	header_->write_pos.store(write_pos, std::memory_order_relaxed);
+	copy_string(header_->signal_name, sizeof(header_->signal_name),
+		signal_name);
+	copy_string(header_->unit_name, sizeof(header_->unit_name), unit_name);
+	// The magic is written last, a reader checks it first
+	std::atomic_thread_fence(std::memory_order_release);
+	header_->magic = magic;
+	return true;
+}
+
+void SharedMemoryRing::close()
+{
+	if (!mapping_)
+		return;
+
+#ifdef _WIN32
+	UnmapViewOfFile(mapping_);
+	CloseHandle((HANDLE)handle_);
+	handle_ = nullptr;
+#else
+	// Readers, that still map the object, keep their mapping
+	munmap(mapping_, size_);
+	shm_unlink(name_.c_str());
+#endif
+	mapping_ = nullptr;
+	header_ = nullptr;
+	timestamps_ = nullptr;
+	values_ = nullptr;
+	size_ = 0;
+	capacity_ = 0;
+	write_pos_ = 0;
+	name_.clear();
+}
+
+bool SharedMemoryRing::is_open() const
+{
+	return mapping_ != nullptr;
+}
+
+string SharedMemoryRing::name() const
+{
+	return name_;
+}
+
+size_t SharedMemoryRing::capacity() const
+{
+	return capacity_;
+}
+
+size_t SharedMemoryRing::write_pos() const
+{
+	return write_pos_;
+}
+
+void SharedMemoryRing::reset(size_t write_pos)
+{
+	if (!header_)
+		return;
+	begin_write();
+	end_write(write_pos);
+}
+
+void SharedMemoryRing::begin_write()
+{
+	// The sequence and the write position are only stored to the shared
+	// memory, never loaded. The fence orders the odd sequence before the
+	// writes of the samples.
+	header_->sequence.store(++sequence_, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+}
+
+void SharedMemoryRing::end_write(size_t write_pos)
+{
+	write_pos_ = write_pos;
+	header_->write_pos.store(write_pos, std::memory_order_release);
+	header_->sequence.store(++sequence_, std::memory_order_release);
+}
+
+} // namespace data
+} // namespace sv
@@ -0,0 +1,181 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_SHAREDMEMORYRING_HPP
+#define DATA_SHAREDMEMORYRING_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+using std::string;
+
+namespace sv {
+namespace data {
+
+/**
+ * The header at the start of a shared memory ring. The layout is fixed,
+ * so processes in other languages can map it (all values are in the
+ * native byte order):
+ *
+ *   offset  0: u32 magic ("SVRB")
+ *   offset  4: u32 version
+ *   offset  8: u64 capacity (a power of two)
+ *   offset 16: u64 offset of the f64 timestamps
+ *   offset 24: u64 offset of the f64 values
+ *   offset 32: f64 signal start timestamp
+ *   offset 40: u64 sequence
+ *   offset 48: u64 write position
+ *   offset 56: char[128] signal name (0 terminated)
+ *   offset 184: char[32] unit name (0 terminated)
+ */
+struct SharedMemoryRingHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint64_t capacity;
+	uint64_t timestamps_offset;
+	uint64_t values_offset;
+	double signal_start_timestamp;
+	std::atomic<uint64_t> sequence;
+	std::atomic<uint64_t> write_pos;
+	char signal_name[128];
+	char unit_name[32];
+};
+
+/**
+ * A ring of the latest samples of a signal in a named shared memory
+ * object (POSIX shm_open() or a named file mapping on Windows), so other
+ * processes on the same machine (e.g. a numpy analysis or a control loop)
+ * read new samples without a copy and without sockets or the Python
+ * bindings.
+ *
+ * The sample at the absolute signal position pos is stored in the slot
+ * pos % capacity of the timestamp and value arrays. The write position is
+ * the position behind the last written sample, so the slots of
+ * [write_pos - capacity, write_pos) are valid.
+ *
+ * The header is a seqlock: The writer makes the sequence odd, writes the
+ * samples, stores the new write position and makes the sequence even
+ * again. A reader loads an even sequence and the write position, copies
+ * the samples and loads the sequence again. If it is unchanged, the copy
+ * is consistent. Otherwise the samples are still valid, if they are not
+ * older than the new write position - capacity. A write position, that
+ * went back, means the signal was cleared.
+ *
+ * There is only one writer, the acquisition thread of the signal.
+ */
+class SharedMemoryRing
+{
+public:
+	SharedMemoryRing();
+	/** Unmaps and removes the shared memory object. */
+	~SharedMemoryRing();
+
+	SharedMemoryRing(const SharedMemoryRing &) = delete;
+	SharedMemoryRing &operator=(const SharedMemoryRing &) = delete;
+
+	/**
+	 * Create (or replace) the shared memory object. An open ring is closed.
+	 *
+	 * @param name The name of the object, e.g. "smuview_ch1".
+	 * @param capacity The number of samples, rounded up to a power of two.
+	 * @param write_pos The position of the first sample, that will be
+	 *        written.
+	 *
+	 * @return false if the object couldn't be created or mapped.
+	 */
+	bool open(const string &name, size_t capacity, size_t write_pos,
+		double signal_start_timestamp, const string &signal_name,
+		const string &unit_name);
+	void close();
+	bool is_open() const;
+
+	string name() const;
+	size_t capacity() const;
+	/**
+	 * Return the position behind the last written sample. This is kept
+	 * outside of the shared memory, so readers can't disturb the writer.
+	 */
+	size_t write_pos() const;
+
+	/**
+	 * Write the samples of the absolute positions [pos, pos + count) while
+	 * the sequence is odd and then publish the new write position. fill is
+	 * called with the slot arrays for every contiguous part of the range,
+	 * as fill(pos, count, timestamps, values), so the samples are written
+	 * directly into the ring.
+	 */
+	template<typename Fill>
+	void write(size_t pos, size_t count, Fill fill);
+
+	/** Restart at the write position, e.g. after the signal was cleared. */
+	void reset(size_t write_pos);
+
+	/** The version of the header layout. */
+	static const uint32_t version = 1;
+	/** "SVRB" in little endian. */
+	static const uint32_t magic = 0x42525653;
+
+private:
+	void begin_write();
+	void end_write(size_t write_pos);
+
+	string name_;
+	size_t capacity_;
+	size_t write_pos_;
+	uint64_t sequence_;
+	size_t size_;
+	void *mapping_;
+	SharedMemoryRingHeader *header_;
+	double *timestamps_;
+	double *values_;
+#ifdef _WIN32
+	void *handle_;
+#endif
+
+};
+
+template<typename Fill>
+void SharedMemoryRing::write(size_t pos, size_t count, Fill fill)
+{
+	if (!header_ || count == 0)
+		return;
+
+	// Only the last capacity samples fit into the ring
+	const size_t end = pos + count;
+	if (count > capacity_)
+		pos = end - capacity_;
+
+	begin_write();
+	while (pos < end) {
+		const size_t slot = pos & (capacity_ - 1);
+		const size_t n = std::min(end - pos, capacity_ - slot);
+		fill(pos, n, timestamps_ + slot, values_ + slot);
+		pos += n;
+	}
+	end_write(end);
+}
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_SHAREDMEMORYRING_HPP
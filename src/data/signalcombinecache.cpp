@@ -0,0 +1,395 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "signalcombinecache.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/chunkedbuffer.hpp"
+#include "src/data/signalcombiner.hpp"
+
+using std::lock_guard;
+using std::make_shared;
+using std::mutex;
+using std::shared_ptr;
+using std::unique_ptr;
+using std::vector;
+using std::weak_ptr;
+
+namespace sv {
+namespace data {
+
+const size_t SignalCombineCache::block_size_ = 1024;
+
+mutex SignalCombineCache::caches_mutex_;
+vector<weak_ptr<SignalCombineCache>> SignalCombineCache::caches_;
+
+shared_ptr<SignalCombineCache> SignalCombineCache::get(
+	const vector<shared_ptr<AnalogTimeSignal>> &signals)
+{
+	// The returned pointer shares the ownership of the cache and releases
+	// the rows, when the last copy is gone.
+	auto cache = acquire(signals, true);
+	return shared_ptr<SignalCombineCache>(cache.get(),
+		[cache](SignalCombineCache *) { cache->release_rows(); });
+}
+
+shared_ptr<SignalCombineCache> SignalCombineCache::acquire(
+	const vector<shared_ptr<AnalogTimeSignal>> &signals, bool retain_rows)
+{
+	lock_guard<mutex> lock(caches_mutex_);
+
+	// Forget the caches, that are not used anymore
+	caches_.erase(std::remove_if(caches_.begin(), caches_.end(),
+		[](const weak_ptr<SignalCombineCache> &cache) {
+			return cache.expired();
+		}), caches_.end());
+
+	for (const auto &weak_cache : caches_) {
+		auto cache = weak_cache.lock();
+		if (!cache || cache->signals() != signals)
+			continue;
+
+		// A trimmed cache misses the older rows, its cursors keep it
+		lock_guard<mutex> update_lock(cache->update_mutex_);
+		if (cache->is_trimmed_)
+			continue;
+		if (retain_rows)
+			++cache->row_user_count_;
+		return cache;
+	}
+
+	auto cache = make_shared<SignalCombineCache>(signals);
+	if (retain_rows)
+		cache->row_user_count_ = 1;
+	caches_.push_back(cache);
+	return cache;
+}
+
+void SignalCombineCache::release_rows()
+{
+	lock_guard<mutex> lock(update_mutex_);
+	--row_user_count_;
+}
+
+void SignalCombineCache::add_cursor(SignalCombineCursor *cursor)
+{
+	lock_guard<mutex> lock(update_mutex_);
+	cursors_.push_back(cursor);
+}
+
+void SignalCombineCache::remove_cursor(SignalCombineCursor *cursor)
+{
+	lock_guard<mutex> lock(update_mutex_);
+	cursors_.erase(std::remove(cursors_.begin(), cursors_.end(), cursor),
+		cursors_.end());
+}
+
+SignalCombineCache::SignalCombineCache(
+		const vector<shared_ptr<AnalogTimeSignal>> &signals) :
+	signals_(signals),
+	combiner_(signals),
+	block_timestamps_(block_size_),
+	signal_epoch_sum_(0),
+	clear_epoch_(0),
+	row_user_count_(0),
+	is_trimmed_(false)
+{
+	unsigned int epoch_sum = 0;
+	for (size_t k = 0; k < signals_.size(); ++k) {
+		signal_epochs_.push_back(signals_[k]->clear_epoch());
+		epoch_sum += signal_epochs_.back();
+		values_.push_back(
+			unique_ptr<ChunkedBuffer<double>>(new ChunkedBuffer<double>()));
+		block_values_.push_back(vector<double>(block_size_));
+	}
+	for (auto &block : block_values_)
+		block_value_ptrs_.push_back(block.data());
+	signal_epoch_sum_.store(epoch_sum, std::memory_order_release);
+}
+
+const vector<shared_ptr<AnalogTimeSignal>> &SignalCombineCache::signals() const
+{
+	return signals_;
+}
+
+size_t SignalCombineCache::update()
+{
+	lock_guard<mutex> lock(update_mutex_);
+
+	clear_rows();
+	size_t new_rows = 0;
+	while (true) {
+		const size_t count = combiner_.combine(block_size_,
+			block_timestamps_.data(), block_value_ptrs_.data());
+		if (count == 0)
+			break;
+
+		for (size_t i = 0; i < count; ++i)
+			timestamps_.push_back(block_timestamps_[i]);
+		// end_pos() is taken from the last column, so a row is published
+		// when all its values are stored.
+		for (size_t k = 0; k < values_.size(); ++k)
+			values_[k]->push_back(block_values_[k].data(), count);
+		new_rows += count;
+	}
+
+	drop_rows();
+	return new_rows;
+}
+
+void SignalCombineCache::drop_rows()
+{
+	double first_timestamp = std::numeric_limits<double>::lowest();
+	for (const auto &signal : signals_) {
+		if (signal->retained_sample_count() > 0)
+			first_timestamp = std::max(
+				first_timestamp, signal->first_timestamp(false));
+	}
+
+	const size_t begin = timestamps_.begin_pos();
+	size_t first = timestamps_.lower_bound(first_timestamp);
+
+	// Without a cache from get(), only the cursors read the rows
+	if (row_user_count_ == 0 && !cursors_.empty()) {
+		const unsigned int epoch = clear_epoch();
+		size_t cursor_pos = timestamps_.end_pos();
+		for (const auto *cursor : cursors_)
+			cursor_pos = std::min(cursor_pos, cursor->cache_pos(epoch));
+		if (cursor_pos > first) {
+			first = cursor_pos;
+			is_trimmed_ = true;
+		}
+	}
+	if (first <= begin)
+		return;
+
+	// begin_pos() is taken from the first column, so it is moved first and
+	// the readers can validate their reads with it.
+	const size_t count = first - begin;
+	for (auto &values : values_)
+		values->drop_front(count);
+	timestamps_.drop_front(count);
+}
+
+void SignalCombineCache::clear_rows()
+{
+	bool cleared = false;
+	unsigned int epoch_sum = 0;
+	for (size_t k = 0; k < signals_.size(); ++k) {
+		const unsigned int epoch = signals_[k]->clear_epoch();
+		if (epoch != signal_epochs_[k]) {
+			signal_epochs_[k] = epoch;
+			cleared = true;
+		}
+		epoch_sum += epoch;
+	}
+	if (!cleared)
+		return;
+	signal_epoch_sum_.store(epoch_sum, std::memory_order_release);
+
+	// Like drop_rows(), the first column is cleared first. The combiner
+	// starts again, so the rows of the samples, that were appended after
+	// the clear, are not lost.
+	for (auto &values : values_)
+		values->clear();
+	timestamps_.clear();
+	combiner_.reset();
+	clear_epoch_.fetch_add(1, std::memory_order_release);
+}
+
+bool SignalCombineCache::has_cleared_signal() const
+{
+	// The epochs only grow, so any clear changes the sum
+	unsigned int epoch_sum = 0;
+	for (const auto &signal : signals_)
+		epoch_sum += signal->clear_epoch();
+	return epoch_sum != signal_epoch_sum_.load(std::memory_order_acquire);
+}
+
+size_t SignalCombineCache::begin_pos() const
+{
+	if (values_.empty())
+		return 0;
+	return values_.front()->begin_pos();
+}
+
+size_t SignalCombineCache::end_pos() const
+{
+	if (values_.empty())
+		return 0;
+	return values_.back()->end_pos();
+}
+
+unsigned int SignalCombineCache::clear_epoch() const
+{
+	return clear_epoch_.load(std::memory_order_acquire);
+}
+
+size_t SignalCombineCache::size() const
+{
+	const size_t end = end_pos();
+	const size_t begin = begin_pos();
+	return end > begin ? end - begin : 0;
+}
+
+bool SignalCombineCache::value(size_t k, size_t pos, double &value) const
+{
+	if (k >= values_.size() || pos < begin_pos() || pos >= end_pos())
+		return false;
+
+	const ChunkedBuffer<double> &values = *values_[k];
+	const unsigned int generation = values.generation();
+	value = values[pos];
+	return pos >= begin_pos() && values.is_valid_read(pos, generation);
+}
+
+size_t SignalCombineCache::copy_values(size_t k, size_t pos, size_t count,
+	double *dest) const
+{
+	if (k >= values_.size())
+		return 0;
+
+	const ChunkedBuffer<double> &values = *values_[k];
+	const unsigned int generation = values.generation();
+	if (pos < begin_pos() || pos >= end_pos())
+		return 0;
+	const size_t n = std::min(count, end_pos() - pos);
+	values.copy(pos, n, dest);
+	if (pos < begin_pos() || !values.is_valid_read(pos, generation))
+		return 0;
+	return n;
+}
+
+bool SignalCombineCache::timestamp(size_t pos, double &timestamp) const
+{
+	if (pos < begin_pos() || pos >= end_pos())
+		return false;
+
+	const unsigned int generation = timestamps_.generation();
+	timestamp = timestamps_.timestamp(pos);
+	return pos >= begin_pos() && timestamps_.is_valid_read(pos, generation);
+}
+
+size_t SignalCombineCache::copy_timestamps(size_t pos, size_t count,
+	double *dest) const
+{
+	const unsigned int generation = timestamps_.generation();
+	if (pos < begin_pos() || pos >= end_pos())
+		return 0;
+	const size_t n = std::min(count, end_pos() - pos);
+	timestamps_.copy(pos, n, dest);
+	if (pos < begin_pos() || !timestamps_.is_valid_read(pos, generation))
+		return 0;
+	return n;
+}
+
+size_t SignalCombineCache::lower_bound(double timestamp) const
+{
+	// The timestamps of a row are stored before its values, so the range
+	// is limited to the published rows.
+	const size_t begin = begin_pos();
+	const size_t end = end_pos();
+	if (begin >= end)
+		return end;
+	const unsigned int generation = timestamps_.generation();
+	const size_t pos = timestamps_.lower_bound(timestamp, begin, end);
+	// The rows were dropped or cleared meanwhile
+	if (!timestamps_.is_valid_read(begin, generation))
+		return begin_pos();
+	return pos;
+}
+
+size_t SignalCombineCache::memory_size() const
+{
+	size_t size = timestamps_.memory_size();
+	for (const auto &values : values_)
+		size += values->memory_size();
+	return size;
+}
+
+SignalCombineCursor::SignalCombineCursor(
+		const vector<shared_ptr<AnalogTimeSignal>> &signals) :
+	cache_(SignalCombineCache::acquire(signals, false)),
+	pos_(0),
+	clear_epoch_(cache_->clear_epoch())
+{
+	cache_->add_cursor(this);
+}
+
+SignalCombineCursor::~SignalCombineCursor()
+{
+	cache_->remove_cursor(this);
+}
+
+shared_ptr<SignalCombineCache> SignalCombineCursor::cache() const
+{
+	return cache_;
+}
+
+size_t SignalCombineCursor::cache_pos(unsigned int clear_epoch) const
+{
+	// The epoch is stored after the position, see combine()
+	if (clear_epoch_.load(std::memory_order_acquire) != clear_epoch)
+		return 0;
+	return pos_.load(std::memory_order_acquire);
+}
+
+size_t SignalCombineCursor::combine(size_t max_count, double *timestamps,
+	double *const *values)
+{
+	if (pos_.load(std::memory_order_relaxed) >= cache_->end_pos() ||
+			cache_->has_cleared_signal())
+		cache_->update();
+
+	const size_t signal_count = cache_->signals().size();
+	while (true) {
+		const unsigned int epoch = cache_->clear_epoch();
+		if (epoch != clear_epoch_.load(std::memory_order_relaxed)) {
+			pos_.store(0, std::memory_order_release);
+			clear_epoch_.store(epoch, std::memory_order_release);
+		}
+
+		const size_t pos = std::max(
+			pos_.load(std::memory_order_relaxed), cache_->begin_pos());
+		const size_t end = cache_->end_pos();
+		if (pos >= end)
+			return 0;
+
+		// The rows can be dropped or cleared while they are copied, then
+		// the copy is repeated with the remaining rows.
+		const size_t count = std::min(max_count, end - pos);
+		bool is_valid =
+			cache_->copy_timestamps(pos, count, timestamps) == count;
+		for (size_t k = 0; is_valid && k < signal_count; ++k)
+			is_valid = cache_->copy_values(k, pos, count, values[k]) == count;
+		if (is_valid && cache_->clear_epoch() == epoch) {
+			pos_.store(pos + count, std::memory_order_release);
+			return count;
+		}
+	}
+}
+
+} // namespace data
+} // namespace sv
@@ -0,0 +1,257 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_SIGNALCOMBINECACHE_HPP
+#define DATA_SIGNALCOMBINECACHE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "src/data/chunkedbuffer.hpp"
+#include "src/data/signalcombiner.hpp"
+#include "src/data/timebase.hpp"
+
+using std::shared_ptr;
+using std::unique_ptr;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+class AnalogTimeSignal;
+class SignalCombineCursor;
+
+/**
+ * The combined samples of N signals (see SignalCombiner), stored once and
+ * shared by all users of the same signals, e.g. several XY plots of the
+ * same pair of signals.
+ *
+ * The rows are addressed by absolute positions like the samples of a
+ * signal. Rows, that are older than the first retained sample of any
+ * signal, are dropped, so the cache follows the retention of the signals.
+ * When a signal is cleared, all rows are cleared and the positions start
+ * at 0 again, see clear_epoch().
+ *
+ * Users, that only consume the rows in order (e.g. math channels), read
+ * them with a SignalCombineCursor instead of holding the cache. While no
+ * cache from get() is held, the rows behind the slowest cursor are dropped
+ * too, so the cache costs only the rows, that are not consumed yet. Such a
+ * trimmed cache is not handed out again, because it misses the older rows.
+ *
+ * Like ChunkedBuffer, there is one (serialized) writer and any number of
+ * lock-free readers: update() can be called from any thread and all read
+ * functions are lock-free.
+ */
+class SignalCombineCache
+{
+public:
+	/**
+	 * Return the cache for the signals. A new cache is created, if no cache
+	 * for the signals (in the same order) is in use. The rows are kept as
+	 * long as the signals retain their samples, while the returned cache
+	 * is held.
+	 */
+	static shared_ptr<SignalCombineCache> get(
+		const vector<shared_ptr<AnalogTimeSignal>> &signals);
+
+	explicit SignalCombineCache(
+		const vector<shared_ptr<AnalogTimeSignal>> &signals);
+
+	SignalCombineCache(const SignalCombineCache &) = delete;
+	SignalCombineCache &operator=(const SignalCombineCache &) = delete;
+
+	const vector<shared_ptr<AnalogTimeSignal>> &signals() const;
+
+	/**
+	 * Combine the new samples of the signals and drop the rows, whose
+	 * samples were dropped from the signals. If a signal was cleared, the
+	 * rows are cleared first.
+	 *
+	 * @return The number of new rows.
+	 */
+	size_t update();
+
+	/**
+	 * Return true if a signal was cleared since the last update(), so the
+	 * rows are outdated.
+	 */
+	bool has_cleared_signal() const;
+
+	size_t begin_pos() const;
+	size_t end_pos() const;
+	size_t size() const;
+
+	/**
+	 * Return the number of times, the rows were cleared, because a signal
+	 * was cleared. Like BaseSignal::clear_epoch(), for the users, that keep
+	 * positions of rows.
+	 */
+	unsigned int clear_epoch() const;
+
+	/**
+	 * Return the value of signal k in the row at the absolute position pos.
+	 *
+	 * @return false if the row is not (anymore) in the cache.
+	 */
+	bool value(size_t k, size_t pos, double &value) const;
+
+	/**
+	 * Copy the values of signal k of up to count rows, starting at the
+	 * absolute position pos, to dest.
+	 *
+	 * @return The number of copied values, 0 if the rows are not (anymore)
+	 *         in the cache.
+	 */
+	size_t copy_values(size_t k, size_t pos, size_t count,
+		double *dest) const;
+
+	/**
+	 * Return the (absolute) timestamp of the row at the absolute position
+	 * pos.
+	 *
+	 * @return false if the row is not (anymore) in the cache.
+	 */
+	bool timestamp(size_t pos, double &timestamp) const;
+
+	/**
+	 * Copy the timestamps of up to count rows, starting at the absolute
+	 * position pos, to dest.
+	 *
+	 * @return The number of copied timestamps, 0 if the rows are not
+	 *         (anymore) in the cache.
+	 */
+	size_t copy_timestamps(size_t pos, size_t count, double *dest) const;
+
+	/**
+	 * Return the absolute position of the first row with a timestamp not
+	 * less than timestamp, or end_pos() if all rows are older. This is
+	 * O(log n).
+	 */
+	size_t lower_bound(double timestamp) const;
+
+	/** Return the bytes on the heap. */
+	size_t memory_size() const;
+
+private:
+	/**
+	 * Return a cache for the signals, that is not trimmed. With retain_rows,
+	 * the rows are kept until release_rows() is called.
+	 */
+	static shared_ptr<SignalCombineCache> acquire(
+		const vector<shared_ptr<AnalogTimeSignal>> &signals,
+		bool retain_rows);
+	void release_rows();
+	void add_cursor(SignalCombineCursor *cursor);
+	void remove_cursor(SignalCombineCursor *cursor);
+
+	/**
+	 * Drop the rows, that are older than the samples of the signals, and
+	 * the consumed rows, when no cache from get() is held.
+	 */
+	void drop_rows();
+	/** Clear the rows, if a signal was cleared since the last update(). */
+	void clear_rows();
+
+	/** The number of rows, that are combined at once. */
+	static const size_t block_size_;
+
+	static std::mutex caches_mutex_;
+	static vector<std::weak_ptr<SignalCombineCache>> caches_;
+
+	const vector<shared_ptr<AnalogTimeSignal>> signals_;
+	/** Serializes update(). */
+	std::mutex update_mutex_;
+	SignalCombiner combiner_;
+	TimeBase timestamps_;
+	/** values_[k] contains the values of signal k. */
+	vector<unique_ptr<ChunkedBuffer<double>>> values_;
+	vector<double> block_timestamps_;
+	vector<vector<double>> block_values_;
+	vector<double *> block_value_ptrs_;
+	/** The clear epochs of the signals at the last update(). */
+	vector<unsigned int> signal_epochs_;
+	/** The sum of signal_epochs_, for the lock-free has_cleared_signal(). */
+	std::atomic<unsigned int> signal_epoch_sum_;
+	std::atomic<unsigned int> clear_epoch_;
+	/** The cursors, guarded by update_mutex_. */
+	vector<SignalCombineCursor *> cursors_;
+	/** The number of caches from get(), guarded by update_mutex_. */
+	size_t row_user_count_;
+	/** Consumed rows were dropped, guarded by update_mutex_. */
+	bool is_trimmed_;
+
+	friend class SignalCombineCursor;
+
+};
+
+/**
+ * Reads the rows of a SignalCombineCache in order, with the interface of
+ * SignalCombiner::combine(). All cursors (and XY plots, see
+ * SignalCombineCache::get()) of the same signals share the rows, so the
+ * signals are combined only once per batch of new samples.
+ *
+ * Rows, that were dropped from the cache before they were read, are
+ * skipped. When a signal is cleared, the cursor starts again with the first
+ * row. A cursor must only be used by one thread at a time.
+ */
+class SignalCombineCursor
+{
+public:
+	explicit SignalCombineCursor(
+		const vector<shared_ptr<AnalogTimeSignal>> &signals);
+	~SignalCombineCursor();
+
+	SignalCombineCursor(const SignalCombineCursor &) = delete;
+	SignalCombineCursor &operator=(const SignalCombineCursor &) = delete;
+
+	shared_ptr<SignalCombineCache> cache() const;
+
+	/**
+	 * Copy up to max_count of the next rows. The timestamps of the rows are
+	 * written to timestamps and the values of signal k to values[k]. The
+	 * cache is updated, when all rows were read. Call it again until it
+	 * returns 0, to read all samples, that are available.
+	 *
+	 * @return The number of rows.
+	 */
+	size_t combine(size_t max_count, double *timestamps,
+		double *const *values);
+
+private:
+	/**
+	 * Return the position of the next row for the rows of the clear epoch,
+	 * 0 if the cursor is still at the rows of an older epoch.
+	 */
+	size_t cache_pos(unsigned int clear_epoch) const;
+
+	shared_ptr<SignalCombineCache> cache_;
+	std::atomic<size_t> pos_;
+	std::atomic<unsigned int> clear_epoch_;
+
+	friend class SignalCombineCache;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_SIGNALCOMBINECACHE_HPP
@@ -0,0 +1,207 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "signalcombiner.hpp"
+#include "src/data/analogtimesignal.hpp"
+
+using std::vector;
+
+namespace sv {
+namespace data {
+
+const size_t SignalCombiner::block_size_ = 1024;
+
+SignalCombiner::SignalCombiner(
+		const vector<shared_ptr<AnalogTimeSignal>> &signals) :
+	cursors_(signals.size())
+{
+	for (size_t k = 0; k < signals.size(); ++k) {
+		assert(signals[k]);
+		Cursor &cursor = cursors_[k];
+		cursor.signal = signals[k];
+		cursor.timestamps.resize(block_size_);
+		cursor.values.resize(block_size_);
+		cursor.block_pos = 0;
+		cursor.count = 0;
+		cursor.index = 0;
+		cursor.has_prev = false;
+		cursor.prev_timestamp = 0.;
+		cursor.prev_value = 0.;
+		cursor.clear_epoch = cursor.signal->clear_epoch();
+	}
+}
+
+size_t SignalCombiner::signal_count() const
+{
+	return cursors_.size();
+}
+
+size_t SignalCombiner::signal_pos(size_t k) const
+{
+	return cursors_[k].block_pos + cursors_[k].index;
+}
+
+size_t SignalCombiner::combine(size_t max_count, double *timestamps,
+	double *const *values)
+{
+	const size_t signal_count = cursors_.size();
+	if (signal_count == 0)
+		return 0;
+
+	size_t row = 0;
+	while (row < max_count) {
+		for (auto &cursor : cursors_) {
+			if (!cursor.fetch())
+				return row;
+		}
+
+		double timestamp = cursors_[0].timestamps[cursors_[0].index];
+		for (size_t k = 1; k < signal_count; ++k)
+			timestamp = std::min(timestamp,
+				cursors_[k].timestamps[cursors_[k].index]);
+
+		// The other signals can only be interpolated, if they have a sample
+		// before the timestamp
+		bool can_combine = true;
+		for (const auto &cursor : cursors_) {
+			if (cursor.timestamps[cursor.index] != timestamp &&
+					(!cursor.has_prev || cursor.prev_timestamp > timestamp)) {
+				can_combine = false;
+				break;
+			}
+		}
+		if (can_combine) {
+			timestamps[row] = timestamp;
+			for (size_t k = 0; k < signal_count; ++k) {
+				const Cursor &cursor = cursors_[k];
+				if (cursor.timestamps[cursor.index] == timestamp)
+					values[k][row] = cursor.values[cursor.index];
+				else
+					values[k][row] = cursor.interpolate(timestamp);
+			}
+			++row;
+		}
+
+		for (auto &cursor : cursors_) {
+			if (cursor.timestamps[cursor.index] == timestamp)
+				cursor.advance();
+		}
+	}
+	return row;
+}
+
+void SignalCombiner::resample(const double *grid_timestamps, size_t count,
+	double *const *values)
+{
+	const double nan = std::numeric_limits<double>::quiet_NaN();
+	for (size_t k = 0; k < cursors_.size(); ++k) {
+		Cursor &cursor = cursors_[k];
+		for (size_t i = 0; i < count; ++i) {
+			const double timestamp = grid_timestamps[i];
+			// Move to the first sample at or after the grid timestamp
+			bool has_current = cursor.fetch();
+			while (has_current && cursor.timestamps[cursor.index] < timestamp) {
+				cursor.advance();
+				has_current = cursor.fetch();
+			}
+
+			if (has_current && cursor.timestamps[cursor.index] == timestamp)
+				values[k][i] = cursor.values[cursor.index];
+			else if (has_current && cursor.has_prev)
+				values[k][i] = cursor.interpolate(timestamp);
+			else if (!has_current && cursor.has_prev &&
+					cursor.prev_timestamp == timestamp)
+				values[k][i] = cursor.prev_value;
+			else
+				values[k][i] = nan;
+		}
+	}
+}
+
+void SignalCombiner::reset()
+{
+	for (auto &cursor : cursors_) {
+		cursor.block_pos = 0;
+		cursor.count = 0;
+		cursor.index = 0;
+		cursor.has_prev = false;
+		cursor.clear_epoch = cursor.signal->clear_epoch();
+	}
+}
+
+bool SignalCombiner::Cursor::fetch()
+{
+	const unsigned int epoch = signal->clear_epoch();
+	if (epoch != clear_epoch) {
+		clear_epoch = epoch;
+		block_pos = 0;
+		count = 0;
+		index = 0;
+		has_prev = false;
+	}
+	if (index < count)
+		return true;
+
+	size_t pos = block_pos + count;
+	// Skip samples, that were already dropped by the retention policy. The
+	// sample before them is gone, too.
+	const size_t first_pos = signal->first_sample_pos();
+	if (pos < first_pos) {
+		pos = first_pos;
+		has_prev = false;
+	}
+
+	const size_t copied = signal->copy_samples(pos, block_size_, false,
+		timestamps.data(), values.data());
+	block_pos = pos;
+	count = copied;
+	index = 0;
+
+	const double time_skew = signal->time_skew();
+	if (time_skew != 0.) {
+		for (size_t i = 0; i < copied; ++i)
+			timestamps[i] -= time_skew;
+	}
+	return copied > 0;
+}
+
+void SignalCombiner::Cursor::advance()
+{
+	prev_timestamp = timestamps[index];
+	prev_value = values[index];
+	has_prev = true;
+	++index;
+}
+
+double SignalCombiner::Cursor::interpolate(double timestamp) const
+{
+	const double ts_factor = (timestamp - prev_timestamp) /
+		(timestamps[index] - prev_timestamp);
+	return prev_value + ((values[index] - prev_value) * ts_factor);
+}
+
+} // namespace data
+} // namespace sv
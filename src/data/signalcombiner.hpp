@@ -0,0 +1,136 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_SIGNALCOMBINER_HPP
+#define DATA_SIGNALCOMBINER_HPP
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+using std::shared_ptr;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+class AnalogTimeSignal;
+
+/**
+ * Merges the samples of N signals onto the union of their timestamps, like
+ * AnalogTimeSignal::combine_signals() does for two signals. For every
+ * timestamp of any signal a row is emitted, with the values of the other
+ * signals linearly interpolated. Timestamps, that are older than the first
+ * sample of any signal, are skipped.
+ *
+ * The time skew of each signal (see AnalogTimeSignal::set_time_skew()) is
+ * taken off its timestamps, before they are merged.
+ *
+ * The combiner keeps one cursor per signal with a fixed size block buffer
+ * between the calls, so combining new samples doesn't allocate memory and
+ * the costs are linear in the number of new samples. The results are
+ * written to buffers of the caller. When a signal is cleared, its cursor
+ * starts again with the first sample, see BaseSignal::clear_epoch().
+ *
+ * A combiner must only be used by one thread at a time.
+ */
+class SignalCombiner
+{
+public:
+	explicit SignalCombiner(
+		const vector<shared_ptr<AnalogTimeSignal>> &signals);
+
+	SignalCombiner(const SignalCombiner &) = delete;
+	SignalCombiner &operator=(const SignalCombiner &) = delete;
+
+	size_t signal_count() const;
+
+	/** Return the position of the next sample of signal k to be merged. */
+	size_t signal_pos(size_t k) const;
+
+	/**
+	 * Merge up to max_count rows of the new samples. The timestamps of the
+	 * rows are written to timestamps and the values of signal k to
+	 * values[k]. Call it again until it returns 0, to merge all samples,
+	 * that are available.
+	 *
+	 * @return The number of rows.
+	 */
+	size_t combine(size_t max_count, double *timestamps,
+		double *const *values);
+	/**
+	 * Interpolate the values of all signals at the count ascending grid
+	 * timestamps and write the values of signal k to values[k]. The values
+	 * outside of the samples of a signal are NaN. The cursors only move
+	 * forward, so the next call must continue with later timestamps. Don't
+	 * mix it with combine().
+	 */
+	void resample(const double *grid_timestamps, size_t count,
+		double *const *values);
+
+	/**
+	 * Move all cursors back to the first sample of their signals, e.g.
+	 * after the merged rows were discarded.
+	 */
+	void reset();
+
+private:
+	struct Cursor
+	{
+		shared_ptr<AnalogTimeSignal> signal;
+		vector<double> timestamps;
+		vector<double> values;
+		/** The position of the first sample of the block in the signal. */
+		size_t block_pos;
+		size_t count;
+		/** The index of the current sample in the block. */
+		size_t index;
+		bool has_prev;
+		double prev_timestamp;
+		double prev_value;
+		/** The clear epoch of the signal, when the block was read. */
+		unsigned int clear_epoch;
+
+		/**
+		 * Make sure there is a current sample. Returns false if there are no
+		 * new samples in the signal. The timestamps of a new block are
+		 * corrected by the time skew of the signal. After a clear of the
+		 * signal, the cursor is reset to its first sample.
+		 */
+		bool fetch();
+		/** Move to the next sample, the current one becomes the previous. */
+		void advance();
+		/**
+		 * Interpolate the value at timestamp between the previous and the
+		 * current sample.
+		 */
+		double interpolate(double timestamp) const;
+	};
+
+	/** The number of samples, that are read from a signal at once. */
+	static const size_t block_size_;
+
+	vector<Cursor> cursors_;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_SIGNALCOMBINER_HPP
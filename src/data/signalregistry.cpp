@@ -0,0 +1,391 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <QObject>
+#include <QString>
+
+#include "signalregistry.hpp"
+#include "src/channels/basechannel.hpp"
+#include "src/data/basesignal.hpp"
+#include "src/data/datautil.hpp"
+#include "src/devices/basedevice.hpp"
+
+using std::lock_guard;
+using std::make_shared;
+using std::mutex;
+
+namespace sv {
+namespace data {
+
+namespace {
+
+const SignalRegistry::signal_list_t empty_list =
+	make_shared<const vector<shared_ptr<BaseSignal>>>();
+
+/**
+ * Split the text into lower case words. Words are separated by ASCII white
+ * space and punctuation, other UTF-8 bytes (e.g. of "°C") are part of the
+ * word.
+ */
+void split_words(const string &text, set<string> &words)
+{
+	string word;
+	for (const char c : text) {
+		const unsigned char uc = (unsigned char)c;
+		if (uc >= 0x80) {
+			word.push_back(c);
+		}
+		else if (std::isalnum(uc)) {
+			word.push_back((char)std::tolower(uc));
+		}
+		else if (!word.empty()) {
+			words.insert(word);
+			word.clear();
+		}
+	}
+	if (!word.empty())
+		words.insert(word);
+}
+
+}
+
+SignalRegistry::SignalRegistry() :
+	next_id_(1),
+	signals_(empty_list)
+{
+}
+
+SignalRegistry::~SignalRegistry()
+{
+}
+
+void SignalRegistry::add_device(shared_ptr<devices::BaseDevice> device)
+{
+	if (!device)
+		return;
+
+	// Connect before the scan, so that no channel is missed. Channels and
+	// signals, that are seen twice, are only registered once.
+	connect(device.get(), &devices::BaseDevice::channel_added,
+		this, [this](shared_ptr<channels::BaseChannel> channel) {
+			add_channel(channel);
+		}, Qt::DirectConnection);
+
+	for (const auto &ch_pair : device->channel_map())
+		add_channel(ch_pair.second);
+}
+
+void SignalRegistry::remove_device(shared_ptr<devices::BaseDevice> device)
+{
+	if (!device)
+		return;
+
+	disconnect(device.get(), nullptr, this, nullptr);
+	for (const auto &ch_pair : device->channel_map())
+		disconnect(ch_pair.second.get(), nullptr, this, nullptr);
+
+	vector<shared_ptr<BaseSignal>> removed;
+	{
+		lock_guard<mutex> lock(mutex_);
+		for (auto it = entries_.begin(); it != entries_.end(); ) {
+			if (it->second.device == device.get()) {
+				unindex_tokens(it->first, it->second);
+				ids_.erase(it->second.signal.get());
+				removed.push_back(it->second.signal);
+				it = entries_.erase(it);
+			}
+			else {
+				++it;
+			}
+		}
+		if (!removed.empty())
+			rebuild_lists();
+	}
+
+	for (const auto &signal : removed) {
+		disconnect(signal.get(), nullptr, this, nullptr);
+		Q_EMIT signal_unregistered(signal);
+	}
+}
+
+void SignalRegistry::add_channel(shared_ptr<channels::BaseChannel> channel)
+{
+	if (!channel)
+		return;
+
+	// A channel can be added twice when it is announced while the device is
+	// scanned. One connection is enough.
+	disconnect(channel.get(), nullptr, this, nullptr);
+	connect(channel.get(), &channels::BaseChannel::signal_added,
+		this, [this](shared_ptr<BaseSignal> signal) {
+			add_signal(signal);
+		}, Qt::DirectConnection);
+
+	for (const auto &signal : channel->signals())
+		add_signal(signal);
+}
+
+void SignalRegistry::add_signal(shared_ptr<BaseSignal> signal)
+{
+	if (!signal)
+		return;
+	auto channel = signal->parent_channel();
+	auto device = channel ? channel->parent_device() : nullptr;
+	set<string> tokens = build_tokens(signal);
+
+	{
+		lock_guard<mutex> lock(mutex_);
+		if (ids_.count(signal.get()) > 0)
+			return;
+
+		Entry entry;
+		entry.signal = signal;
+		entry.device = device.get();
+		entry.device_id = device ? device->id() : "";
+		entry.measured_quantity = signal->measured_quantity();
+		entry.tokens = std::move(tokens);
+
+		const uint64_t id = next_id_++;
+		index_tokens(id, entry);
+		entries_.insert(std::make_pair(id, std::move(entry)));
+		ids_.insert(std::make_pair(signal.get(), id));
+		rebuild_lists();
+	}
+
+	const BaseSignal *signal_ptr = signal.get();
+	connect(signal.get(), &BaseSignal::name_changed,
+		this, [this, signal_ptr](const std::string &) {
+			update_tokens(signal_ptr);
+		}, Qt::DirectConnection);
+
+	Q_EMIT signal_registered(signal);
+}
+
+void SignalRegistry::update_tokens(const BaseSignal *signal)
+{
+	shared_ptr<BaseSignal> shared_signal;
+	{
+		lock_guard<mutex> lock(mutex_);
+		const auto it = ids_.find(signal);
+		if (it == ids_.end())
+			return;
+		shared_signal = entries_.at(it->second).signal;
+	}
+
+	// Build the words without the lock, the names are not guarded by it
+	set<string> tokens = build_tokens(shared_signal);
+
+	lock_guard<mutex> lock(mutex_);
+	const auto id_it = ids_.find(signal);
+	if (id_it == ids_.end())
+		return;
+	Entry &entry = entries_.at(id_it->second);
+	unindex_tokens(id_it->second, entry);
+	entry.tokens = std::move(tokens);
+	index_tokens(id_it->second, entry);
+}
+
+set<string> SignalRegistry::build_tokens(const shared_ptr<BaseSignal> &signal)
+{
+	set<string> tokens;
+	auto channel = signal->parent_channel();
+	if (channel) {
+		split_words(channel->name(), tokens);
+		for (const auto &chg_name : channel->channel_group_names())
+			split_words(chg_name, tokens);
+		auto device = channel->parent_device();
+		if (device)
+			split_words(device->full_name().toStdString(), tokens);
+	}
+	split_words(signal->name(), tokens);
+	split_words(signal->quantity_name().toStdString(), tokens);
+	split_words(signal->quantity_flags_name().toStdString(), tokens);
+	split_words(signal->unit_name().toStdString(), tokens);
+	return tokens;
+}
+
+void SignalRegistry::index_tokens(uint64_t id, const Entry &entry)
+{
+	for (const auto &token : entry.tokens)
+		token_ids_[token].insert(id);
+}
+
+void SignalRegistry::unindex_tokens(uint64_t id, const Entry &entry)
+{
+	for (const auto &token : entry.tokens) {
+		const auto it = token_ids_.find(token);
+		if (it == token_ids_.end())
+			continue;
+		it->second.erase(id);
+		if (it->second.empty())
+			token_ids_.erase(it);
+	}
+}
+
+void SignalRegistry::rebuild_lists()
+{
+	vector<shared_ptr<BaseSignal>> all;
+	unordered_map<const devices::BaseDevice *, vector<shared_ptr<BaseSignal>>>
+		by_device;
+	map<MeasuredQuantity, vector<shared_ptr<BaseSignal>>> by_quantity;
+
+	all.reserve(entries_.size());
+	for (const auto &entry_pair : entries_) {
+		const Entry &entry = entry_pair.second;
+		all.push_back(entry.signal);
+		by_device[entry.device].push_back(entry.signal);
+		by_quantity[entry.measured_quantity].push_back(entry.signal);
+	}
+
+	signals_ = make_shared<const vector<shared_ptr<BaseSignal>>>(
+		std::move(all));
+	device_signals_.clear();
+	for (auto &list_pair : by_device) {
+		device_signals_[list_pair.first] =
+			make_shared<const vector<shared_ptr<BaseSignal>>>(
+				std::move(list_pair.second));
+	}
+	quantity_signals_.clear();
+	for (auto &list_pair : by_quantity) {
+		quantity_signals_[list_pair.first] =
+			make_shared<const vector<shared_ptr<BaseSignal>>>(
+				std::move(list_pair.second));
+	}
+}
+
+size_t SignalRegistry::signal_count() const
+{
+	lock_guard<mutex> lock(mutex_);
+	return entries_.size();
+}
+
+SignalRegistry::signal_list_t SignalRegistry::signals() const
+{
+	lock_guard<mutex> lock(mutex_);
+	return signals_;
+}
+
+SignalRegistry::signal_list_t SignalRegistry::device_signals(
+	const shared_ptr<devices::BaseDevice> &device) const
+{
+	lock_guard<mutex> lock(mutex_);
+	const auto it = device_signals_.find(device.get());
+	if (it == device_signals_.end())
+		return empty_list;
+	return it->second;
+}
+
+SignalRegistry::signal_list_t SignalRegistry::quantity_signals(
+	const MeasuredQuantity &measured_quantity) const
+{
+	lock_guard<mutex> lock(mutex_);
+	const auto it = quantity_signals_.find(measured_quantity);
+	if (it == quantity_signals_.end())
+		return empty_list;
+	return it->second;
+}
+
+SignalRegistry::signal_list_t SignalRegistry::search(
+	const string &query) const
+{
+	set<string> terms;
+	split_words(query, terms);
+	if (terms.empty())
+		return signals();
+
+	lock_guard<mutex> lock(mutex_);
+	set<uint64_t> result;
+	bool is_first_term = true;
+	for (const auto &term : terms) {
+		// All words, that start with the term, are in one range of the map
+		set<uint64_t> term_ids;
+		for (auto it = token_ids_.lower_bound(term); it != token_ids_.end() &&
+				it->first.compare(0, term.size(), term) == 0; ++it) {
+			term_ids.insert(it->second.begin(), it->second.end());
+		}
+
+		if (is_first_term) {
+			result = std::move(term_ids);
+			is_first_term = false;
+		}
+		else {
+			set<uint64_t> intersection;
+			std::set_intersection(result.begin(), result.end(),
+				term_ids.begin(), term_ids.end(),
+				std::inserter(intersection, intersection.end()));
+			result = std::move(intersection);
+		}
+		if (result.empty())
+			return empty_list;
+	}
+
+	// The ids are ascending, so the signals are in the registration order
+	vector<shared_ptr<BaseSignal>> list;
+	list.reserve(result.size());
+	for (const uint64_t id : result)
+		list.push_back(entries_.at(id).signal);
+	return make_shared<const vector<shared_ptr<BaseSignal>>>(std::move(list));
+}
+
+shared_ptr<BaseSignal> SignalRegistry::signal(uint64_t id) const
+{
+	lock_guard<mutex> lock(mutex_);
+	const auto it = entries_.find(id);
+	if (it == entries_.end())
+		return nullptr;
+	return it->second.signal;
+}
+
+uint64_t SignalRegistry::id(const shared_ptr<BaseSignal> &signal) const
+{
+	lock_guard<mutex> lock(mutex_);
+	const auto it = ids_.find(signal.get());
+	if (it == ids_.end())
+		return 0;
+	return it->second;
+}
+
+shared_ptr<BaseSignal> SignalRegistry::find_signal(const string &device_id,
+	const string &channel_name,
+	const MeasuredQuantity &measured_quantity) const
+{
+	signal_list_t list = quantity_signals(measured_quantity);
+	for (const auto &signal : *list) {
+		auto channel = signal->parent_channel();
+		if (!channel || channel->name() != channel_name)
+			continue;
+		auto device = channel->parent_device();
+		if (device && device->id() == device_id)
+			return signal;
+	}
+	return nullptr;
+}
+
+} // namespace data
+} // namespace sv
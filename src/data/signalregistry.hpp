@@ -0,0 +1,172 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_SIGNALREGISTRY_HPP
+#define DATA_SIGNALREGISTRY_HPP
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <QObject>
+
+#include "src/data/datautil.hpp"
+
+using std::map;
+using std::set;
+using std::shared_ptr;
+using std::string;
+using std::unordered_map;
+using std::vector;
+
+namespace sv {
+
+namespace channels {
+class BaseChannel;
+}
+
+namespace devices {
+class BaseDevice;
+}
+
+namespace data {
+
+class BaseSignal;
+
+/**
+ * An index of all signals of the session, by registry id, by device and by
+ * measured quantity. Lookups don't walk the device, channel and signal maps.
+ *
+ * The registry follows a registered device: Its channels and signals, and
+ * the ones that are added later, are registered too. signal_registered() is
+ * emitted for each new signal. signal_unregistered() is emitted for each
+ * signal of a removed device.
+ *
+ * Signals are added from the acquisition threads, so all functions are
+ * thread safe. The lists are returned as immutable snapshots. They are
+ * rebuilt when a signal is added or removed, which is rare, and are shared
+ * by the readers instead of being copied.
+ *
+ * For the quick search in large device trees, the registry also maintains
+ * an index of the lower case words of the device, channel and signal names,
+ * the quantity, the quantity flags and the unit of each signal.
+ */
+class SignalRegistry : public QObject
+{
+	Q_OBJECT
+
+public:
+	typedef shared_ptr<const vector<shared_ptr<BaseSignal>>> signal_list_t;
+
+	SignalRegistry();
+	~SignalRegistry();
+
+	/**
+	 * Register the signals of the device and follow the device for new
+	 * channels and signals.
+	 */
+	void add_device(shared_ptr<devices::BaseDevice> device);
+	/** Unregister all signals of the device. */
+	void remove_device(shared_ptr<devices::BaseDevice> device);
+
+	size_t signal_count() const;
+	/** Return all signals in the order of their registration. */
+	signal_list_t signals() const;
+	/** Return the signals of a device, an empty list for unknown devices. */
+	signal_list_t device_signals(
+		const shared_ptr<devices::BaseDevice> &device) const;
+	/** Return the signals of all devices with the measured quantity. */
+	signal_list_t quantity_signals(
+		const MeasuredQuantity &measured_quantity) const;
+
+	/** Return the signal with the registry id, nullptr if unknown. */
+	shared_ptr<BaseSignal> signal(uint64_t id) const;
+	/**
+	 * Return the registry id of the signal, 0 if it is not registered. The
+	 * ids are not reused.
+	 */
+	uint64_t id(const shared_ptr<BaseSignal> &signal) const;
+	/**
+	 * Return the first signal of the channel of a device with the measured
+	 * quantity, nullptr if there is none.
+	 */
+	shared_ptr<BaseSignal> find_signal(const string &device_id,
+		const string &channel_name,
+		const MeasuredQuantity &measured_quantity) const;
+
+	/**
+	 * Return the signals, that match all words of the query, in the order of
+	 * their registration. A word matches, if it is the start of a word of
+	 * the signal, case insensitive. An empty query matches all signals.
+	 */
+	signal_list_t search(const string &query) const;
+
+private:
+	struct Entry
+	{
+		shared_ptr<BaseSignal> signal;
+		const devices::BaseDevice *device;
+		string device_id;
+		MeasuredQuantity measured_quantity;
+		/** The words of the entry in token_ids_. */
+		set<string> tokens;
+	};
+
+	void add_channel(shared_ptr<channels::BaseChannel> channel);
+	void add_signal(shared_ptr<BaseSignal> signal);
+	/** Update the words of a renamed signal. */
+	void update_tokens(const BaseSignal *signal);
+	/** Build the words of the signal, mutex_ must not be locked. */
+	static set<string> build_tokens(const shared_ptr<BaseSignal> &signal);
+	/** Add/remove the words of the entry, mutex_ must be locked. */
+	void index_tokens(uint64_t id, const Entry &entry);
+	void unindex_tokens(uint64_t id, const Entry &entry);
+	/** Rebuild the snapshots after a change, mutex_ must be locked. */
+	void rebuild_lists();
+
+	mutable std::mutex mutex_;
+	uint64_t next_id_;
+	/** The entries by registry id, in the order of the registration. */
+	map<uint64_t, Entry> entries_;
+	unordered_map<const BaseSignal *, uint64_t> ids_;
+	signal_list_t signals_;
+	unordered_map<const devices::BaseDevice *, signal_list_t> device_signals_;
+	map<MeasuredQuantity, signal_list_t> quantity_signals_;
+	/**
+	 * The registry ids by word. The map is ordered, so all words with a
+	 * prefix are found in one range.
+	 */
+	map<string, set<uint64_t>> token_ids_;
+
+Q_SIGNALS:
+	/** Emitted in the thread, that added the signal. */
+	void signal_registered(shared_ptr<sv::data::BaseSignal> signal);
+	void signal_unregistered(shared_ptr<sv::data::BaseSignal> signal);
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_SIGNALREGISTRY_HPP
@@ -0,0 +1,486 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <clocale>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <QAbstractSocket>
+#include <QDebug>
+#include <QString>
+#include <QTcpSocket>
+#include <QUdpSocket>
+#include <QtEndian>
+
+#include "signalstreamer.hpp"
+#include "src/channels/basechannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/analogtimesnapshot.hpp"
+#include "src/devices/basedevice.hpp"
+
+using std::lock_guard;
+using std::shared_ptr;
+using std::string;
+using std::unique_lock;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+namespace {
+
+const uint32_t message_type_signal = 1;
+const uint32_t message_type_samples = 2;
+
+template<typename T>
+void append_pod(string &buffer, T value)
+{
+	char data[sizeof(T)];
+	qToLittleEndian<T>(value, (uchar *)data);
+	buffer.append(data, sizeof(T));
+}
+
+void append_pod(string &buffer, double value)
+{
+	uint64_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	append_pod<uint64_t>(buffer, bits);
+}
+
+void append_string(string &buffer, const string &str)
+{
+	append_pod<uint32_t>(buffer, (uint32_t)str.size());
+	buffer.append(str);
+}
+
+/**
+ * Escape the commas, equal signs and spaces of a line protocol tag.
+ */
+string escape_tag(const string &str)
+{
+	string escaped;
+	for (const char c : str) {
+		if (c == ',' || c == '=' || c == ' ')
+			escaped += '\\';
+		escaped += c;
+	}
+	return escaped;
+}
+
+}
+
+const double SignalStreamer::default_send_interval_ = .1;
+const double SignalStreamer::min_send_interval_ = .001;
+const double SignalStreamer::reconnect_interval_ = 1.;
+const double SignalStreamer::udp_signal_interval_ = 10.;
+const size_t SignalStreamer::default_max_batch_samples_ = 4096;
+const size_t SignalStreamer::max_datagram_size_ = 1400;
+const size_t SignalStreamer::max_pending_bytes_ = 1024 * 1024;
+const int SignalStreamer::connect_timeout_ = 3000;
+const int SignalStreamer::write_timeout_ = 5000;
+
+SignalStreamer::SignalStreamer() :
+	port_(0),
+	protocol_(StreamProtocol::Tcp),
+	format_(StreamFormat::Binary),
+	send_interval_(default_send_interval_),
+	max_batch_samples_(default_max_batch_samples_),
+	decimal_point_('.'),
+	stop_(false),
+	running_(false),
+	connected_(false),
+	sent_sample_count_(0),
+	dropped_sample_count_(0)
+{
+}
+
+SignalStreamer::~SignalStreamer()
+{
+	stop();
+}
+
+void SignalStreamer::set_send_interval(double send_interval)
+{
+	// Don't spin without a send interval
+	send_interval_ = std::max(send_interval, min_send_interval_);
+}
+
+double SignalStreamer::send_interval() const
+{
+	return send_interval_;
+}
+
+void SignalStreamer::set_max_batch_samples(size_t max_batch_samples)
+{
+	max_batch_samples_ = std::max(max_batch_samples, (size_t)1);
+}
+
+size_t SignalStreamer::max_batch_samples() const
+{
+	return max_batch_samples_;
+}
+
+bool SignalStreamer::start(const string &host, uint16_t port,
+	const vector<shared_ptr<AnalogTimeSignal>> &signals,
+	StreamProtocol protocol, StreamFormat format)
+{
+	stop();
+
+	if (host.empty() || signals.empty()) {
+		qWarning() << "SignalStreamer::start(): No host or no signals";
+		return false;
+	}
+
+	host_ = host;
+	port_ = port;
+	protocol_ = protocol;
+	format_ = format;
+	sent_sample_count_ = 0;
+	dropped_sample_count_ = 0;
+	connected_ = false;
+
+	entries_.clear();
+	for (const auto &signal : signals) {
+		if (!signal)
+			continue;
+		const auto channel = signal->parent_channel();
+		Entry entry{ signal, (uint32_t)entries_.size(),
+			signal->sample_count(), {}, "smuview" };
+		entry.names.push_back(channel && channel->parent_device() ?
+			channel->parent_device()->name() : "");
+		entry.names.push_back(channel ? channel->name() : "");
+		entry.names.push_back(signal->name());
+		entry.names.push_back(signal->quantity_name().toStdString());
+		entry.names.push_back(signal->unit_name().toStdString());
+
+		static const char *const tag_keys[] = {
+			"device", "channel", "signal", "quantity", "unit" };
+		for (size_t i = 0; i < entry.names.size(); ++i) {
+			// Empty tag values are not allowed
+			if (entry.names[i].empty())
+				continue;
+			entry.line_prefix += string(",") + tag_keys[i] + "=" +
+				escape_tag(entry.names[i]);
+		}
+		entry.line_prefix += " value=";
+		entries_.push_back(entry);
+	}
+
+	// snprintf() formats with the decimal point of the current locale
+	const struct lconv *locale_conv = std::localeconv();
+	decimal_point_ = '.';
+	if (locale_conv && locale_conv->decimal_point &&
+			locale_conv->decimal_point[0] != '\0') {
+		decimal_point_ = locale_conv->decimal_point[0];
+	}
+
+	stop_ = false;
+	running_ = true;
+	thread_ = std::thread(&SignalStreamer::thread_proc, this);
+	return true;
+}
+
+void SignalStreamer::stop()
+{
+	if (!thread_.joinable())
+		return;
+
+	{
+		lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+	}
+	stop_cond_.notify_one();
+	thread_.join();
+	running_ = false;
+}
+
+bool SignalStreamer::is_running() const
+{
+	return running_;
+}
+
+bool SignalStreamer::is_connected() const
+{
+	return connected_;
+}
+
+size_t SignalStreamer::sent_sample_count() const
+{
+	return sent_sample_count_;
+}
+
+size_t SignalStreamer::dropped_sample_count() const
+{
+	return dropped_sample_count_;
+}
+
+void SignalStreamer::thread_proc()
+{
+	const auto send_interval = std::chrono::duration_cast<
+		std::chrono::steady_clock::duration>(
+			std::chrono::duration<double>(send_interval_));
+
+	// The socket is used with the blocking functions, this thread has no
+	// event loop.
+	QTcpSocket tcp_socket;
+	QUdpSocket udp_socket;
+	QAbstractSocket &socket = protocol_ == StreamProtocol::Udp ?
+		static_cast<QAbstractSocket &>(udp_socket) :
+		static_cast<QAbstractSocket &>(tcp_socket);
+
+	auto last_connect = std::chrono::steady_clock::time_point();
+	auto last_signal_messages = std::chrono::steady_clock::time_point();
+	bool first_connect = true;
+	bool stopping = false;
+	while (!stopping) {
+		{
+			unique_lock<std::mutex> lock(mutex_);
+			stop_cond_.wait_for(lock, send_interval, [this]() {
+				return stop_.load();
+			});
+			stopping = stop_;
+		}
+
+		const auto now = std::chrono::steady_clock::now();
+		if (connected_ && socket.state() != QAbstractSocket::ConnectedState) {
+			qWarning() << "SignalStreamer: The connection to" <<
+				QString::fromStdString(host_) << "was lost";
+			socket.abort();
+			connected_ = false;
+		}
+		if (!connected_) {
+			if (stopping || (!first_connect && std::chrono::duration<double>(
+					now - last_connect).count() < reconnect_interval_)) {
+				// Keep the unsent samples for the next connection
+				continue;
+			}
+			first_connect = false;
+			last_connect = now;
+			if (!connect_socket(socket))
+				continue;
+			last_signal_messages = std::chrono::steady_clock::time_point();
+		}
+
+		// Resend the signal messages over UDP for late receivers
+		bool ok = true;
+		if (last_signal_messages == std::chrono::steady_clock::time_point() ||
+				(protocol_ == StreamProtocol::Udp &&
+				std::chrono::duration<double>(
+					now - last_signal_messages).count() >=
+					udp_signal_interval_)) {
+			last_signal_messages = now;
+			ok = send_signal_messages(socket);
+		}
+		ok = ok && send_new_samples(socket);
+		if (ok && stopping)
+			ok = wait_written(socket);
+		if (!ok) {
+			qWarning() << "SignalStreamer: Sending to" <<
+				QString::fromStdString(host_) << "failed:" <<
+				socket.errorString();
+			socket.abort();
+			buffer_.clear();
+			connected_ = false;
+		}
+	}
+
+	if (socket.state() == QAbstractSocket::ConnectedState) {
+		socket.disconnectFromHost();
+		if (socket.state() != QAbstractSocket::UnconnectedState)
+			socket.waitForDisconnected(write_timeout_);
+	}
+	socket.abort();
+	connected_ = false;
+	running_ = false;
+}
+
+bool SignalStreamer::connect_socket(QAbstractSocket &socket)
+{
+	socket.abort();
+	socket.connectToHost(QString::fromStdString(host_), port_);
+	if (!socket.waitForConnected(connect_timeout_)) {
+		qWarning() << "SignalStreamer: Connecting to" <<
+			QString::fromStdString(host_) << port_ << "failed:" <<
+			socket.errorString();
+		socket.abort();
+		return false;
+	}
+	connected_ = true;
+	return true;
+}
+
+bool SignalStreamer::send_signal_messages(QAbstractSocket &socket)
+{
+	if (format_ != StreamFormat::Binary)
+		return true;
+
+	for (const auto &entry : entries_) {
+		string payload;
+		append_pod<uint32_t>(payload, message_type_signal);
+		append_pod<uint32_t>(payload, entry.id);
+		for (const auto &name : entry.names)
+			append_string(payload, name);
+
+		append_pod<uint32_t>(buffer_, (uint32_t)payload.size());
+		buffer_ += payload;
+		if (!send_buffer(socket))
+			return false;
+	}
+	return true;
+}
+
+bool SignalStreamer::send_new_samples(QAbstractSocket &socket)
+{
+	size_t batch_size = max_batch_samples_;
+	if (protocol_ == StreamProtocol::Udp && format_ == StreamFormat::Binary) {
+		// 16 bytes header, 16 bytes per sample
+		batch_size = std::min(batch_size, (max_datagram_size_ - 16) / 16);
+	}
+
+	vector<double> timestamps(batch_size);
+	vector<double> values(batch_size);
+	for (auto &entry : entries_) {
+		const auto snapshot = entry.signal->snapshot();
+		if (entry.next_pos < snapshot.first_sample_pos()) {
+			dropped_sample_count_ +=
+				snapshot.first_sample_pos() - entry.next_pos;
+			entry.next_pos = snapshot.first_sample_pos();
+		}
+		while (entry.next_pos < snapshot.sample_count()) {
+			const size_t count = std::min(batch_size,
+				snapshot.sample_count() - entry.next_pos);
+			const size_t copied = snapshot.copy_samples(entry.next_pos, count,
+				false, timestamps.data(), values.data());
+			if (copied == 0)
+				break;
+
+			if (format_ == StreamFormat::Binary) {
+				append_binary_samples(
+					entry, timestamps.data(), values.data(), copied);
+			}
+			else {
+				for (size_t i = 0; i < copied; ++i) {
+					if (append_line(entry, timestamps[i], values[i]))
+						continue;
+					// The buffer is full, a line always fits into an empty one
+					if (!send_buffer(socket))
+						return false;
+					append_line(entry, timestamps[i], values[i]);
+				}
+			}
+			if (!send_buffer(socket))
+				return false;
+			entry.next_pos += copied;
+			sent_sample_count_ += copied;
+		}
+	}
+	return true;
+}
+
+void SignalStreamer::append_binary_samples(const Entry &entry,
+	const double *timestamps, const double *values, size_t count)
+{
+	append_pod<uint32_t>(buffer_, (uint32_t)(12 + 16 * count));
+	append_pod<uint32_t>(buffer_, message_type_samples);
+	append_pod<uint32_t>(buffer_, entry.id);
+	append_pod<uint32_t>(buffer_, (uint32_t)count);
+	for (size_t i = 0; i < count; ++i)
+		append_pod(buffer_, timestamps[i]);
+	for (size_t i = 0; i < count; ++i)
+		append_pod(buffer_, values[i]);
+}
+
+bool SignalStreamer::append_line(const Entry &entry,
+	double timestamp, double value)
+{
+	// The line protocol has no representation for non finite values
+	if (!std::isfinite(value))
+		return true;
+
+	char value_str[32];
+	int value_len = std::snprintf(
+		value_str, sizeof(value_str), "%.17g", value);
+	if (value_len <= 0 || value_len >= (int)sizeof(value_str))
+		return true;
+	if (decimal_point_ != '.')
+		std::replace(value_str, value_str + value_len, decimal_point_, '.');
+
+	char time_str[32];
+	const int time_len = std::snprintf(time_str, sizeof(time_str), " %lld\n",
+		(long long)std::llround(timestamp * 1e9));
+	if (time_len <= 0 || time_len >= (int)sizeof(time_str))
+		return true;
+
+	// Keep UDP lines in one datagram and TCP writes reasonably sized
+	const size_t limit = protocol_ == StreamProtocol::Udp ?
+		max_datagram_size_ : 64 * 1024;
+	const size_t size = entry.line_prefix.size() + (size_t)value_len +
+		(size_t)time_len;
+	if (!buffer_.empty() && buffer_.size() + size > limit)
+		return false;
+
+	buffer_ += entry.line_prefix;
+	buffer_.append(value_str, (size_t)value_len);
+	buffer_.append(time_str, (size_t)time_len);
+	return true;
+}
+
+bool SignalStreamer::send_buffer(QAbstractSocket &socket)
+{
+	if (buffer_.empty())
+		return true;
+
+	const qint64 size = (qint64)buffer_.size();
+	const qint64 written = socket.write(buffer_.data(), size);
+	buffer_.clear();
+	if (written != size)
+		return false;
+	if (protocol_ == StreamProtocol::Udp)
+		return true;
+
+	// Without an event loop, the data is only sent by flush() and the wait
+	// functions. Block, when the endpoint doesn't keep up.
+	socket.flush();
+	while ((size_t)socket.bytesToWrite() > max_pending_bytes_) {
+		if (!socket.waitForBytesWritten(write_timeout_))
+			return false;
+	}
+	return true;
+}
+
+bool SignalStreamer::wait_written(QAbstractSocket &socket)
+{
+	while (socket.bytesToWrite() > 0) {
+		if (!socket.waitForBytesWritten(write_timeout_))
+			return false;
+	}
+	return true;
+}
+
+} // namespace data
+} // namespace sv
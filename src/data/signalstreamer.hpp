@@ -0,0 +1,205 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_SIGNALSTREAMER_HPP
+#define DATA_SIGNALSTREAMER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+class QAbstractSocket;
+
+namespace sv {
+namespace data {
+
+class AnalogTimeSignal;
+
+/**
+ * The transport of a SignalStreamer.
+ */
+enum class StreamProtocol {
+	Tcp,
+	/** Unreliable, every write is one datagram. */
+	Udp
+};
+
+/**
+ * The format of the samples, that are sent by a SignalStreamer.
+ */
+enum class StreamFormat {
+	/**
+	 * Length-prefixed binary messages (little endian): A message starts
+	 * with its size (u32, without the size field) and its type (u32).
+	 *
+	 * A signal message (type 1) is sent for every signal after connecting
+	 * (and every 10 s over UDP): u32 signal id, then the device, channel,
+	 * signal, quantity and unit names as strings (u32 length + UTF-8).
+	 *
+	 * A samples message (type 2) holds a batch of samples of one signal:
+	 * u32 signal id, u32 count, count f64 timestamps (seconds since the
+	 * epoch) and count f64 values.
+	 */
+	Binary,
+	/**
+	 * InfluxDB line protocol, one line per sample:
+	 * `smuview,device=D,channel=C,signal=S,quantity=Q,unit=U value=V T`
+	 * with the timestamp T in nanoseconds since the epoch.
+	 */
+	LineProtocol
+};
+
+/**
+ * Streams the new samples of signals to a network endpoint, while they are
+ * acquiring.
+ *
+ * A background thread sends the samples, that were appended since the
+ * last send, every send interval in batches. The samples are read from
+ * snapshots of the signals, so the acquisition never waits for the
+ * network. This is also the backpressure: When the endpoint doesn't keep
+ * up, the unsent samples stay in the signals and the streamer falls
+ * behind, samples are only lost when they are dropped from the signals by
+ * the retention policy before they were sent (see dropped_sample_count()).
+ *
+ * A lost TCP connection is reconnected every reconnect interval. The
+ * streaming continues with the samples, that were not sent yet, samples
+ * in the socket buffer of the lost connection can be lost.
+ */
+class SignalStreamer
+{
+public:
+	SignalStreamer();
+	/** Stops the streaming. */
+	~SignalStreamer();
+
+	SignalStreamer(const SignalStreamer &) = delete;
+	SignalStreamer &operator=(const SignalStreamer &) = delete;
+
+	/**
+	 * Set the send interval in seconds, the default is 0.1 s. This is used
+	 * by the next start().
+	 */
+	void set_send_interval(double send_interval);
+	double send_interval() const;
+	/**
+	 * Set the maximum number of samples of a signal in one batch, the
+	 * default is 4096. Over UDP, a batch is also limited to one datagram.
+	 * This is used by the next start().
+	 */
+	void set_max_batch_samples(size_t max_batch_samples);
+	size_t max_batch_samples() const;
+
+	/**
+	 * Start streaming the new samples of the signals, a running stream is
+	 * stopped. The samples, that are already in the signals, are not
+	 * sent. Connecting is done by the background thread.
+	 *
+	 * @return false if there is no host or no signal.
+	 */
+	bool start(const string &host, uint16_t port,
+		const vector<shared_ptr<AnalogTimeSignal>> &signals,
+		StreamProtocol protocol = StreamProtocol::Tcp,
+		StreamFormat format = StreamFormat::Binary);
+	/** Send the remaining samples and close the connection. */
+	void stop();
+	bool is_running() const;
+	bool is_connected() const;
+
+	/** Return the number of sent samples of all signals. */
+	size_t sent_sample_count() const;
+	/** Return the number of samples, that were dropped before sending. */
+	size_t dropped_sample_count() const;
+
+private:
+	struct Entry
+	{
+		shared_ptr<AnalogTimeSignal> signal;
+		uint32_t id;
+		/** The position of the next sample, that is sent. */
+		size_t next_pos;
+		/** device, channel, signal, quantity and unit name */
+		vector<string> names;
+		/** The line protocol measurement and tags. */
+		string line_prefix;
+	};
+
+	void thread_proc();
+	bool connect_socket(QAbstractSocket &socket);
+	bool send_signal_messages(QAbstractSocket &socket);
+	/** Send the new samples of all signals. */
+	bool send_new_samples(QAbstractSocket &socket);
+	void append_binary_samples(const Entry &entry,
+		const double *timestamps, const double *values, size_t count);
+	/** Return false if the line doesn't fit into the buffer. */
+	bool append_line(const Entry &entry, double timestamp, double value);
+	/** Write the buffer to the socket, wait if too much is pending. */
+	bool send_buffer(QAbstractSocket &socket);
+	/** Wait until all pending bytes are written. */
+	bool wait_written(QAbstractSocket &socket);
+
+	static const double default_send_interval_;
+	static const double min_send_interval_;
+	static const double reconnect_interval_;
+	static const double udp_signal_interval_;
+	static const size_t default_max_batch_samples_;
+	/** The maximum size of a datagram, that is not fragmented. */
+	static const size_t max_datagram_size_;
+	/** Wait for the socket, when more bytes are pending. */
+	static const size_t max_pending_bytes_;
+	static const int connect_timeout_;
+	static const int write_timeout_;
+
+	string host_;
+	uint16_t port_;
+	StreamProtocol protocol_;
+	StreamFormat format_;
+	double send_interval_;
+	size_t max_batch_samples_;
+	vector<Entry> entries_;
+	string buffer_;
+	/** The decimal point of the C locale, which is used by snprintf(). */
+	char decimal_point_;
+
+	std::thread thread_;
+	/** Guards stop_ for the condition. */
+	std::mutex mutex_;
+	std::condition_variable stop_cond_;
+	std::atomic<bool> stop_;
+	std::atomic<bool> running_;
+	std::atomic<bool> connected_;
+	std::atomic<size_t> sent_sample_count_;
+	std::atomic<size_t> dropped_sample_count_;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_SIGNALSTREAMER_HPP
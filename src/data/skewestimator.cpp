@@ -0,0 +1,353 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <QDebug>
+
+#include "skewestimator.hpp"
+#include "src/data/analogbasesignal.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/fft.hpp"
+#include "src/data/samplebus.hpp"
+
+using std::complex;
+using std::lock_guard;
+using std::mutex;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+const size_t SkewEstimator::read_block_size_ = 256;
+
+SkewEstimator::SkewEstimator(shared_ptr<AnalogTimeSignal> reference,
+		shared_ptr<AnalogTimeSignal> signal, size_t block_size,
+		double resolution, double max_lag, double interval) :
+	QObject(),
+	reference_(reference),
+	signal_(signal),
+	block_size_(block_size),
+	resolution_(resolution),
+	max_lag_(std::min(max_lag, (double)(block_size / 2) * resolution)),
+	interval_(std::max(interval, 0.)),
+	fft_(2 * block_size),
+	window_(FFT::window(WindowFunction::Hann, block_size)),
+	apply_skew_(true),
+	min_correlation_(0.5),
+	next_end_timestamp_(-std::numeric_limits<double>::infinity()),
+	reference_values_(block_size),
+	signal_values_(block_size),
+	read_timestamps_(read_block_size_),
+	read_values_(read_block_size_),
+	bins_(2 * block_size),
+	skew_(std::numeric_limits<double>::quiet_NaN()),
+	correlation_(std::numeric_limits<double>::quiet_NaN()),
+	estimate_count_(0)
+{
+	assert(reference_);
+	assert(signal_);
+	assert(FFT::is_power_of_two(block_size));
+	assert(resolution > 0.);
+
+	// The blocks must stay in the signals until they are estimated
+	const double history = (double)block_size_ * resolution_ + interval_;
+	for (const auto &s : { reference_, signal_ }) {
+		s->add_observer();
+		s->set_observer_history(this, history);
+		subscriptions_.push_back(s->subscribe_samples(
+			[this](size_t, size_t) { on_samples_appended(); },
+			[this]() { on_samples_cleared(); }, SampleExecutor::Context, this));
+	}
+}
+
+SkewEstimator::~SkewEstimator()
+{
+	for (const auto &s : { reference_, signal_ }) {
+		s->clear_observer_history(this);
+		s->remove_observer();
+	}
+}
+
+shared_ptr<AnalogTimeSignal> SkewEstimator::reference() const
+{
+	return reference_;
+}
+
+shared_ptr<AnalogTimeSignal> SkewEstimator::signal() const
+{
+	return signal_;
+}
+
+size_t SkewEstimator::block_size() const
+{
+	return block_size_;
+}
+
+double SkewEstimator::resolution() const
+{
+	return resolution_;
+}
+
+double SkewEstimator::max_lag() const
+{
+	return max_lag_;
+}
+
+double SkewEstimator::interval() const
+{
+	return interval_;
+}
+
+void SkewEstimator::set_apply_skew(bool apply_skew)
+{
+	apply_skew_ = apply_skew;
+}
+
+bool SkewEstimator::apply_skew() const
+{
+	return apply_skew_;
+}
+
+void SkewEstimator::set_min_correlation(double min_correlation)
+{
+	min_correlation_ = min_correlation;
+}
+
+double SkewEstimator::min_correlation() const
+{
+	return min_correlation_;
+}
+
+double SkewEstimator::skew() const
+{
+	lock_guard<mutex> lock(mutex_);
+	return skew_;
+}
+
+double SkewEstimator::correlation() const
+{
+	lock_guard<mutex> lock(mutex_);
+	return correlation_;
+}
+
+size_t SkewEstimator::estimate_count() const
+{
+	lock_guard<mutex> lock(mutex_);
+	return estimate_count_;
+}
+
+bool SkewEstimator::resample(const AnalogTimeSignal &signal,
+	double start_timestamp, vector<double> &values)
+{
+	// Start with the sample before the grid, for the interpolation
+	size_t pos = signal.lower_index(start_timestamp, false);
+	if (pos > signal.first_sample_pos())
+		--pos;
+
+	size_t count = 0;
+	size_t index = 0;
+	bool has_prev = false;
+	double prev_timestamp = 0.;
+	double prev_value = 0.;
+	for (size_t i = 0; i < block_size_; ++i) {
+		const double timestamp = start_timestamp + (double)i * resolution_;
+		// Move to the first sample at or after the grid timestamp
+		while (true) {
+			if (index == count) {
+				count = signal.copy_samples(pos, read_block_size_, false,
+					read_timestamps_.data(), read_values_.data());
+				if (count == 0)
+					return false;
+				pos += count;
+				index = 0;
+			}
+			if (read_timestamps_[index] >= timestamp)
+				break;
+			prev_timestamp = read_timestamps_[index];
+			prev_value = read_values_[index];
+			has_prev = true;
+			++index;
+		}
+
+		if (read_timestamps_[index] == timestamp)
+			values[i] = read_values_[index];
+		else if (has_prev)
+			values[i] = prev_value + (read_values_[index] - prev_value) *
+				(timestamp - prev_timestamp) /
+				(read_timestamps_[index] - prev_timestamp);
+		else
+			return false;
+		if (!std::isfinite(values[i]))
+			return false;
+	}
+	return true;
+}
+
+bool SkewEstimator::estimate(double end_timestamp)
+{
+	const double start_timestamp =
+		end_timestamp - (double)(block_size_ - 1) * resolution_;
+	if (!resample(*reference_, start_timestamp, reference_values_) ||
+			!resample(*signal_, start_timestamp, signal_values_))
+		return false;
+
+	// Remove the means and taper the blocks, so the edges of the blocks
+	// don't correlate
+	double reference_mean = 0.;
+	double signal_mean = 0.;
+	for (size_t i = 0; i < block_size_; ++i) {
+		reference_mean += reference_values_[i];
+		signal_mean += signal_values_[i];
+	}
+	reference_mean /= (double)block_size_;
+	signal_mean /= (double)block_size_;
+	double reference_norm = 0.;
+	double signal_norm = 0.;
+	for (size_t i = 0; i < block_size_; ++i) {
+		const double reference_value =
+			(reference_values_[i] - reference_mean) * window_[i];
+		const double signal_value =
+			(signal_values_[i] - signal_mean) * window_[i];
+		reference_norm += reference_value * reference_value;
+		signal_norm += signal_value * signal_value;
+		// Both real blocks are transformed at once, as real and imaginary
+		// part of one complex block
+		bins_[i] = complex<double>(reference_value, signal_value);
+	}
+	if (reference_norm <= 0. || signal_norm <= 0.)
+		return false;
+	std::fill(bins_.begin() + block_size_, bins_.end(), complex<double>());
+
+	fft_.transform(bins_.data());
+
+	// Separate the spectra R and S of both blocks and calculate the cross
+	// spectrum conj(R) * S. It is conjugated again for the inverse FFT.
+	const size_t fft_size = bins_.size();
+	for (size_t k = 0; k <= fft_size / 2; ++k) {
+		const complex<double> bin = bins_[k];
+		const complex<double> mirror =
+			std::conj(bins_[(fft_size - k) % fft_size]);
+		const complex<double> reference_bin = (bin + mirror) * 0.5;
+		const complex<double> signal_bin =
+			(bin - mirror) * complex<double>(0., -0.5);
+		const complex<double> cross =
+			std::conj(std::conj(reference_bin) * signal_bin);
+		bins_[k] = cross;
+		// The cross spectrum of real blocks is hermitian
+		if (k > 0 && k < fft_size / 2)
+			bins_[fft_size - k] = std::conj(cross);
+	}
+
+	// Inverse FFT by conjugation, the correlation is real
+	fft_.transform(bins_.data());
+	const double scale = 1. /
+		((double)fft_size * std::sqrt(reference_norm * signal_norm));
+
+	// Positive lags are at the start, negative lags at the end
+	const size_t lag_count = (size_t)(max_lag_ / resolution_);
+	auto correlation_at = [&](long lag) {
+		const size_t index =
+			lag >= 0 ? (size_t)lag : fft_size - (size_t)(-lag);
+		return bins_[index].real() * scale;
+	};
+
+	long best = 0;
+	double best_correlation = correlation_at(0);
+	for (long lag = -(long)lag_count; lag <= (long)lag_count; ++lag) {
+		const double correlation = correlation_at(lag);
+		if (correlation > best_correlation) {
+			best = lag;
+			best_correlation = correlation;
+		}
+	}
+	if (best_correlation < min_correlation_)
+		return false;
+	// A peak at the border is probably outside of the lag range
+	if (lag_count > 0 && (best == -(long)lag_count || best == (long)lag_count))
+		return false;
+
+	// Fit a parabola through the peak and its neighbours
+	double fraction = 0.;
+	if (lag_count > 0) {
+		const double left = correlation_at(best - 1);
+		const double right = correlation_at(best + 1);
+		const double denominator = left - 2. * best_correlation + right;
+		if (denominator < 0.)
+			fraction = 0.5 * (left - right) / denominator;
+	}
+	const double skew = ((double)best + fraction) * resolution_;
+
+	if (apply_skew_)
+		signal_->set_time_skew(skew);
+
+	lock_guard<mutex> lock(mutex_);
+	skew_ = skew;
+	correlation_ = best_correlation;
+	++estimate_count_;
+	return true;
+}
+
+void SkewEstimator::on_samples_appended()
+{
+	if (reference_->sample_count() == 0 || signal_->sample_count() == 0)
+		return;
+
+	// Estimate the latest block, that is covered by both signals
+	const double end_timestamp = std::min(
+		reference_->last_timestamp(false), signal_->last_timestamp(false));
+	if (end_timestamp < next_end_timestamp_)
+		return;
+	const double start_timestamp =
+		end_timestamp - (double)(block_size_ - 1) * resolution_;
+	if (reference_->first_timestamp(false) > start_timestamp ||
+			signal_->first_timestamp(false) > start_timestamp)
+		return;
+
+	// Also wait an interval after a failed estimate, the next samples
+	// won't change the block much
+	next_end_timestamp_ = end_timestamp + interval_;
+	if (!estimate(end_timestamp))
+		return;
+
+	double skew;
+	double correlation;
+	{
+		lock_guard<mutex> lock(mutex_);
+		skew = skew_;
+		correlation = correlation_;
+	}
+	Q_EMIT skew_updated(skew, correlation);
+}
+
+void SkewEstimator::on_samples_cleared()
+{
+	next_end_timestamp_ = -std::numeric_limits<double>::infinity();
+}
+
+} // namespace data
+} // namespace sv
@@ -0,0 +1,170 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_SKEWESTIMATOR_HPP
+#define DATA_SKEWESTIMATOR_HPP
+
+#include <atomic>
+#include <complex>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <QObject>
+
+#include "src/data/fft.hpp"
+#include "src/data/samplebus.hpp"
+
+using std::complex;
+using std::shared_ptr;
+using std::unique_ptr;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+class AnalogTimeSignal;
+
+/**
+ * Continuously estimates the time skew of a signal against a reference
+ * signal, e.g. of two devices, that measure the same quantity, by the cross
+ * correlation of both signals over a sliding block.
+ *
+ * For every interval seconds of new samples, the last block_size samples
+ * of both signals are resampled onto a common grid with the given
+ * resolution. The correlation is calculated for all lags at once with a
+ * zero padded FFT of both blocks (O(n log n) instead of the O(n * lags) of
+ * estimate_time_offset()). The peak within max_lag is refined between
+ * the grid points.
+ *
+ * An accepted estimate is set as time skew of the signal (see
+ * AnalogTimeSignal::set_time_skew()), so it lines up with the reference,
+ * when both are combined. The skew is estimated from the stored timestamps,
+ * so the applied skew doesn't feed back into the estimation.
+ *
+ * The estimator can be moved to a worker thread (see WorkerPool), the
+ * results can be read from any thread.
+ */
+class SkewEstimator : public QObject
+{
+	Q_OBJECT
+
+public:
+	/**
+	 * @param block_size The number of grid points, must be a power of two.
+	 * @param resolution The distance of the grid points in seconds.
+	 * @param max_lag The maximum skew in seconds, less than half the block.
+	 * @param interval The seconds of new samples between two estimates.
+	 */
+	SkewEstimator(shared_ptr<AnalogTimeSignal> reference,
+		shared_ptr<AnalogTimeSignal> signal, size_t block_size,
+		double resolution, double max_lag, double interval);
+	~SkewEstimator();
+
+	shared_ptr<AnalogTimeSignal> reference() const;
+	shared_ptr<AnalogTimeSignal> signal() const;
+	size_t block_size() const;
+	double resolution() const;
+	double max_lag() const;
+	double interval() const;
+
+	/**
+	 * Set if an accepted estimate is set as time skew of the signal. This
+	 * is on by default.
+	 */
+	void set_apply_skew(bool apply_skew);
+	bool apply_skew() const;
+
+	/**
+	 * Set the minimum correlation coefficient for an estimate to be
+	 * accepted, 0.5 by default.
+	 */
+	void set_min_correlation(double min_correlation);
+	double min_correlation() const;
+
+	/**
+	 * Return the last accepted skew in seconds. A positive skew means, that
+	 * the signal is late. NaN if no estimate was accepted yet.
+	 */
+	double skew() const;
+	/** Return the correlation coefficient of the last accepted estimate. */
+	double correlation() const;
+	/** Return the number of accepted estimates. */
+	size_t estimate_count() const;
+
+private:
+	/**
+	 * Interpolate the samples of signal at the grid timestamps, starting at
+	 * start_timestamp, into values.
+	 *
+	 * @return false if the samples don't cover the grid or are not finite.
+	 */
+	bool resample(const AnalogTimeSignal &signal, double start_timestamp,
+		vector<double> &values);
+	/**
+	 * Estimate the skew from the blocks of both signals, that end at
+	 * end_timestamp.
+	 *
+	 * @return true if the estimate was accepted.
+	 */
+	bool estimate(double end_timestamp);
+
+	static const size_t read_block_size_;
+
+	shared_ptr<AnalogTimeSignal> reference_;
+	shared_ptr<AnalogTimeSignal> signal_;
+	const size_t block_size_;
+	const double resolution_;
+	const double max_lag_;
+	const double interval_;
+	/** The correlated blocks are zero padded to twice the block size. */
+	const FFT fft_;
+	const vector<double> window_;
+	std::atomic<bool> apply_skew_;
+	std::atomic<double> min_correlation_;
+
+	/** The end of the next block, that is estimated. */
+	double next_end_timestamp_;
+	vector<double> reference_values_;
+	vector<double> signal_values_;
+	vector<double> read_timestamps_;
+	vector<double> read_values_;
+	vector<complex<double>> bins_;
+
+	mutable std::mutex mutex_;
+	double skew_;
+	double correlation_;
+	size_t estimate_count_;
+	vector<unique_ptr<SampleBusSubscription>> subscriptions_;
+
+private Q_SLOTS:
+	void on_samples_appended();
+	void on_samples_cleared();
+
+Q_SIGNALS:
+	/** A new estimate was accepted. */
+	void skew_updated(double skew, double correlation);
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_SKEWESTIMATOR_HPP
@@ -0,0 +1,224 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <QDebug>
+
+#include "spectrumanalyzer.hpp"
+#include "src/data/analogbasesignal.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/fft.hpp"
+#include "src/data/samplebus.hpp"
+
+using std::lock_guard;
+using std::mutex;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+const size_t SpectrumAnalyzer::read_block_size_ = 256;
+
+SpectrumAnalyzer::SpectrumAnalyzer(shared_ptr<AnalogTimeSignal> signal,
+		size_t fft_size, WindowFunction window_function, double overlap,
+		size_t average_count) :
+	QObject(),
+	signal_(signal),
+	fft_size_(fft_size),
+	window_function_(window_function),
+	overlap_(overlap),
+	average_count_(std::max(average_count, (size_t)1)),
+	hop_size_(std::max((size_t)((1. - overlap) * (double)fft_size), (size_t)1)),
+	fft_(fft_size),
+	window_(FFT::window(window_function, fft_size)),
+	next_signal_pos_(0),
+	block_timestamps_(fft_size),
+	block_values_(fft_size),
+	block_fill_(0),
+	windowed_(fft_size),
+	average_power_(fft_size / 2 + 1, 0.),
+	averaged_count_(0),
+	block_count_(0)
+{
+	assert(signal_);
+	assert(overlap >= 0. && overlap < 1.);
+
+	double window_sum = 0.;
+	for (const double coefficient : window_)
+		window_sum += coefficient;
+	amplitude_scale_ = window_sum > 0. ? 2. / window_sum : 0.;
+
+	signal_->add_observer();
+	subscriptions_.push_back(signal_->subscribe_samples(
+		[this](size_t, size_t) { on_samples_appended(); },
+		[this]() { on_samples_cleared(); }, SampleExecutor::Context, this));
+}
+
+SpectrumAnalyzer::~SpectrumAnalyzer()
+{
+	signal_->remove_observer();
+}
+
+shared_ptr<AnalogTimeSignal> SpectrumAnalyzer::signal() const
+{
+	return signal_;
+}
+
+size_t SpectrumAnalyzer::fft_size() const
+{
+	return fft_size_;
+}
+
+WindowFunction SpectrumAnalyzer::window_function() const
+{
+	return window_function_;
+}
+
+double SpectrumAnalyzer::overlap() const
+{
+	return overlap_;
+}
+
+size_t SpectrumAnalyzer::average_count() const
+{
+	return average_count_;
+}
+
+bool SpectrumAnalyzer::spectrum(vector<double> &frequencies,
+	vector<double> &magnitudes) const
+{
+	lock_guard<mutex> lock(mutex_);
+	if (block_count_ == 0)
+		return false;
+
+	frequencies = frequencies_;
+	magnitudes = magnitudes_;
+	return true;
+}
+
+size_t SpectrumAnalyzer::block_count() const
+{
+	lock_guard<mutex> lock(mutex_);
+	return block_count_;
+}
+
+void SpectrumAnalyzer::process_block()
+{
+	const double duration = block_timestamps_[fft_size_ - 1] -
+		block_timestamps_[0];
+	if (!(duration > 0.))
+		return;
+	const double samplerate = (double)(fft_size_ - 1) / duration;
+
+	for (size_t i = 0; i < fft_size_; ++i)
+		windowed_[i] = block_values_[i] * window_[i];
+	fft_.transform_real(windowed_.data(), bins_);
+
+	// Linear average over the first blocks, then exponential
+	if (averaged_count_ < average_count_)
+		++averaged_count_;
+	const double weight = 1. / (double)averaged_count_;
+	const size_t bin_count = bins_.size();
+	for (size_t k = 0; k < bin_count; ++k) {
+		// DC and the Nyquist frequency only appear once in the spectrum
+		double amplitude = std::abs(bins_[k]) * amplitude_scale_;
+		if (k == 0 || k == fft_size_ / 2)
+			amplitude /= 2.;
+		average_power_[k] += (amplitude * amplitude - average_power_[k]) * weight;
+	}
+
+	lock_guard<mutex> lock(mutex_);
+	frequencies_.resize(bin_count);
+	magnitudes_.resize(bin_count);
+	for (size_t k = 0; k < bin_count; ++k) {
+		frequencies_[k] = (double)k * samplerate / (double)fft_size_;
+		magnitudes_[k] = std::sqrt(average_power_[k]);
+	}
+	++block_count_;
+}
+
+void SpectrumAnalyzer::reset_block()
+{
+	block_fill_ = 0;
+}
+
+void SpectrumAnalyzer::on_samples_appended()
+{
+	bool updated = false;
+	while (true) {
+		// A gap in the samples starts a new block
+		if (next_signal_pos_ < signal_->first_sample_pos()) {
+			next_signal_pos_ = signal_->first_sample_pos();
+			reset_block();
+		}
+
+		const size_t count = signal_->copy_samples(next_signal_pos_,
+			std::min(read_block_size_, fft_size_ - block_fill_), false,
+			block_timestamps_.data() + block_fill_,
+			block_values_.data() + block_fill_);
+		if (count == 0)
+			break;
+		next_signal_pos_ += count;
+
+		// Skip the samples with non finite values
+		size_t fill = block_fill_;
+		for (size_t i = block_fill_; i < block_fill_ + count; ++i) {
+			if (!std::isfinite(block_values_[i]))
+				continue;
+			block_timestamps_[fill] = block_timestamps_[i];
+			block_values_[fill] = block_values_[i];
+			++fill;
+		}
+		block_fill_ = fill;
+
+		if (block_fill_ < fft_size_)
+			continue;
+
+		process_block();
+		updated = true;
+
+		// Keep the overlapping samples for the next block
+		const size_t keep = fft_size_ - hop_size_;
+		std::copy(block_timestamps_.begin() + hop_size_,
+			block_timestamps_.end(), block_timestamps_.begin());
+		std::copy(block_values_.begin() + hop_size_,
+			block_values_.end(), block_values_.begin());
+		block_fill_ = keep;
+	}
+
+	if (updated)
+		Q_EMIT spectrum_updated();
+}
+
+void SpectrumAnalyzer::on_samples_cleared()
+{
+	next_signal_pos_ = 0;
+	reset_block();
+}
+
+} // namespace data
+} // namespace sv
@@ -0,0 +1,140 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_SPECTRUMANALYZER_HPP
+#define DATA_SPECTRUMANALYZER_HPP
+
+#include <complex>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <QObject>
+
+#include "src/data/fft.hpp"
+#include "src/data/samplebus.hpp"
+
+using std::complex;
+using std::shared_ptr;
+using std::unique_ptr;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+class AnalogTimeSignal;
+
+/**
+ * Calculates the amplitude spectrum of an analog signal with windowed FFTs
+ * over sliding blocks of fft_size samples.
+ *
+ * Consecutive blocks overlap, so only the new samples of a block must
+ * arrive before the next FFT. The spectra of the blocks are averaged
+ * (Welch's method): Linear over the first average_count blocks, then
+ * exponentially, so a block is only transformed once.
+ *
+ * The sample rate is estimated from the timestamps of each block, so the
+ * samples should be (roughly) equidistant.
+ *
+ * The analyzer can be moved to a worker thread (see WorkerPool), the
+ * spectrum can be read from any thread.
+ */
+class SpectrumAnalyzer : public QObject
+{
+	Q_OBJECT
+
+public:
+	/**
+	 * @param fft_size The block size, must be a power of two.
+	 * @param overlap The overlap of consecutive blocks, [0, 1).
+	 * @param average_count The number of averaged blocks, at least 1.
+	 */
+	SpectrumAnalyzer(shared_ptr<AnalogTimeSignal> signal, size_t fft_size,
+		WindowFunction window_function, double overlap, size_t average_count);
+	~SpectrumAnalyzer();
+
+	shared_ptr<AnalogTimeSignal> signal() const;
+	size_t fft_size() const;
+	WindowFunction window_function() const;
+	double overlap() const;
+	size_t average_count() const;
+
+	/**
+	 * Copy the latest spectrum. The frequencies are in Hz, the magnitudes
+	 * are the peak amplitudes in the unit of the signal.
+	 *
+	 * @return false if not enough samples for a spectrum have arrived yet.
+	 */
+	bool spectrum(vector<double> &frequencies,
+		vector<double> &magnitudes) const;
+
+	/** Return the number of blocks, that were transformed. */
+	size_t block_count() const;
+
+private:
+	/** Transform the block in block_values_ and average the spectrum. */
+	void process_block();
+	/** Drop the partial block, e.g. after the samples were cleared. */
+	void reset_block();
+
+	static const size_t read_block_size_;
+
+	shared_ptr<AnalogTimeSignal> signal_;
+	const size_t fft_size_;
+	const WindowFunction window_function_;
+	const double overlap_;
+	const size_t average_count_;
+	/** The number of new samples for the next block. */
+	const size_t hop_size_;
+	const FFT fft_;
+	const vector<double> window_;
+	/** Scales the magnitudes of the bins to peak amplitudes. */
+	double amplitude_scale_;
+
+	size_t next_signal_pos_;
+	vector<double> block_timestamps_;
+	vector<double> block_values_;
+	size_t block_fill_;
+	vector<double> windowed_;
+	vector<complex<double>> bins_;
+	/** The averaged squared amplitudes. */
+	vector<double> average_power_;
+	size_t averaged_count_;
+
+	mutable std::mutex mutex_;
+	vector<double> frequencies_;
+	vector<double> magnitudes_;
+	size_t block_count_;
+	vector<unique_ptr<SampleBusSubscription>> subscriptions_;
+
+private Q_SLOTS:
+	void on_samples_appended();
+	void on_samples_cleared();
+
+Q_SIGNALS:
+	/** A new spectrum is available. */
+	void spectrum_updated();
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_SPECTRUMANALYZER_HPP
@@ -0,0 +1,126 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <memory>
+#include <mutex>
+
+#include <QDebug>
+#include <QDir>
+#include <QTemporaryFile>
+
+#include "spillfile.hpp"
+
+using std::lock_guard;
+using std::mutex;
+
+namespace sv {
+namespace data {
+
+SpillFile::SpillFile() :
+	segment_used_(segment_size_),
+	allocated_size_(0)
+{
+}
+
+SpillFile::~SpillFile()
+{
+	if (!file_)
+		return;
+	for (unsigned char *segment : segments_)
+		file_->unmap(segment);
+	file_->close();
+}
+
+bool SpillFile::open()
+{
+	lock_guard<mutex> lock(mutex_);
+	if (file_)
+		return true;
+
+	unique_ptr<QTemporaryFile> file(new QTemporaryFile(
+		QDir::tempPath() + QDir::separator() + "smuview_XXXXXX.spill"));
+	if (!file->open()) {
+		qWarning() << "SpillFile::open(): Can't create temporary file: "
+			<< file->errorString();
+		return false;
+	}
+	file_ = std::move(file);
+	return true;
+}
+
+bool SpillFile::is_open() const
+{
+	lock_guard<mutex> lock(mutex_);
+	return file_ != nullptr;
+}
+
+void *SpillFile::allocate(size_t size)
+{
+	lock_guard<mutex> lock(mutex_);
+	if (!file_ || size > segment_size_)
+		return nullptr;
+
+	void *region = nullptr;
+	const auto free_it = free_regions_.find(size);
+	if (free_it != free_regions_.end() && !free_it->second.empty()) {
+		region = free_it->second.back();
+		free_it->second.pop_back();
+	}
+	else {
+		const size_t aligned_size = (size + alignment_ - 1) & ~(alignment_ - 1);
+		if (segment_used_ + aligned_size > segment_size_) {
+			// Extend the file by one segment and map it
+			const qint64 offset = (qint64)(segments_.size() * segment_size_);
+			if (!file_->resize(offset + (qint64)segment_size_)) {
+				qWarning() << "SpillFile::allocate(): Can't extend file: "
+					<< file_->errorString();
+				return nullptr;
+			}
+			unsigned char *segment = file_->map(offset, (qint64)segment_size_);
+			if (!segment) {
+				qWarning() << "SpillFile::allocate(): Can't map file: "
+					<< file_->errorString();
+				return nullptr;
+			}
+			segments_.push_back(segment);
+			segment_used_ = 0;
+		}
+		region = segments_.back() + segment_used_;
+		segment_used_ += aligned_size;
+	}
+
+	allocated_size_ += size;
+	return region;
+}
+
+void SpillFile::release(void *region, size_t size)
+{
+	lock_guard<mutex> lock(mutex_);
+	free_regions_[size].push_back(region);
+	allocated_size_ -= size;
+}
+
+size_t SpillFile::allocated_size() const
+{
+	lock_guard<mutex> lock(mutex_);
+	return allocated_size_;
+}
+
+} // namespace data
+} // namespace sv
@@ -0,0 +1,100 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_SPILLFILE_HPP
+#define DATA_SPILLFILE_HPP
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using std::map;
+using std::unique_ptr;
+using std::vector;
+
+class QTemporaryFile;
+
+namespace sv {
+namespace data {
+
+/**
+ * A temporary file, that holds the chunks of signal buffers, so long
+ * captures can outgrow the RAM.
+ *
+ * The file is mapped into memory in big segments and chunks are allocated
+ * in the mapping. The operating system writes cold (sealed) chunks back to
+ * the file and pages them in again on demand. Released regions are reused
+ * for chunks of the same size. The file is removed when the SpillFile is
+ * destroyed.
+ */
+class SpillFile
+{
+public:
+	SpillFile();
+	~SpillFile();
+
+	SpillFile(const SpillFile &) = delete;
+	SpillFile &operator=(const SpillFile &) = delete;
+
+	/**
+	 * Create the temporary file.
+	 *
+	 * @return false if the file couldn't be created.
+	 */
+	bool open();
+	bool is_open() const;
+
+	/**
+	 * Allocate a region of size bytes in the file.
+	 *
+	 * @return A pointer to the mapped region, nullptr if the file couldn't
+	 *         be extended or mapped (e.g. the disk is full).
+	 */
+	void *allocate(size_t size);
+
+	/**
+	 * Release a region, that was returned by allocate().
+	 */
+	void release(void *region, size_t size);
+
+	/** Return the number of bytes, that are currently allocated. */
+	size_t allocated_size() const;
+
+private:
+	/** Size of a mapped segment, 64 MiB. */
+	static const size_t segment_size_ = (size_t)1 << 26;
+	static const size_t alignment_ = 16;
+
+	mutable std::mutex mutex_;
+	unique_ptr<QTemporaryFile> file_;
+	vector<unsigned char *> segments_;
+	/** Used bytes in the last segment. */
+	size_t segment_used_;
+	/** Released regions by size. */
+	map<size_t, vector<void *>> free_regions_;
+	size_t allocated_size_;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_SPILLFILE_HPP
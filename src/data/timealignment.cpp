@@ -0,0 +1,161 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include <QDebug>
+
+#include "timealignment.hpp"
+#include "src/data/analogtimesignal.hpp"
+
+using std::vector;
+
+namespace sv {
+namespace data {
+
+namespace {
+
+/** Below this correlation coefficient, the offset is not trusted. */
+const double min_correlation = 0.5;
+/** Limits the work of a single estimation. */
+const size_t max_grid_size = 1 << 20;
+
+bool resample(const AnalogTimeSignal &signal, double start_timestamp,
+	double resolution, size_t count, vector<double> &values)
+{
+	values.resize(count);
+	for (size_t i = 0; i < count; ++i) {
+		if (!signal.get_value_at_timestamp(
+				start_timestamp + (double)i * resolution, values[i], false))
+			return false;
+	}
+	return true;
+}
+
+}
+
+bool estimate_time_offset(const AnalogTimeSignal &reference,
+	const AnalogTimeSignal &signal, double start_timestamp,
+	double end_timestamp, double max_lag, double resolution, double &offset)
+{
+	if (!(resolution > 0.) || !(max_lag >= 0.) ||
+			!(end_timestamp > start_timestamp))
+		return false;
+
+	const size_t count =
+		(size_t)((end_timestamp - start_timestamp) / resolution) + 1;
+	const size_t lag_count = (size_t)(max_lag / resolution);
+	if (count < 3 || count + 2 * lag_count > max_grid_size) {
+		qWarning() << "estimate_time_offset(): Invalid resolution" <<
+			resolution;
+		return false;
+	}
+
+	vector<double> reference_values;
+	vector<double> signal_values;
+	if (!resample(reference, start_timestamp, resolution, count,
+			reference_values) ||
+		!resample(signal, start_timestamp - (double)lag_count * resolution,
+			resolution, count + 2 * lag_count, signal_values)) {
+		qWarning() << "estimate_time_offset(): The signals don't cover" <<
+			"the time range";
+		return false;
+	}
+
+	double reference_mean = 0.;
+	for (const double value : reference_values)
+		reference_mean += value;
+	reference_mean /= (double)count;
+	double reference_norm = 0.;
+	for (double &value : reference_values) {
+		value -= reference_mean;
+		reference_norm += value * value;
+	}
+	if (reference_norm <= 0.)
+		return false;
+
+	// Center the signal first, so the running sums don't lose precision
+	double signal_mean = 0.;
+	for (const double value : signal_values)
+		signal_mean += value;
+	signal_mean /= (double)signal_values.size();
+	for (double &value : signal_values)
+		value -= signal_mean;
+
+	// The window of the signal moves with the lag, its mean and norm are
+	// updated with running sums.
+	double sum = 0.;
+	double square_sum = 0.;
+	for (size_t i = 0; i < count; ++i) {
+		sum += signal_values[i];
+		square_sum += signal_values[i] * signal_values[i];
+	}
+	vector<double> correlations(2 * lag_count + 1, 0.);
+	for (size_t lag = 0; lag <= 2 * lag_count; ++lag) {
+		if (lag > 0) {
+			const double old_value = signal_values[lag - 1];
+			const double new_value = signal_values[lag + count - 1];
+			sum += new_value - old_value;
+			square_sum += new_value * new_value - old_value * old_value;
+		}
+		const double norm = square_sum - sum * sum / (double)count;
+		if (norm <= 0.)
+			continue;
+		// The reference is centered, so the mean of the window cancels out
+		double product = 0.;
+		for (size_t i = 0; i < count; ++i)
+			product += reference_values[i] * signal_values[lag + i];
+		correlations[lag] = product / std::sqrt(reference_norm * norm);
+	}
+
+	size_t best = 0;
+	for (size_t lag = 1; lag < correlations.size(); ++lag) {
+		if (correlations[lag] > correlations[best])
+			best = lag;
+	}
+	if (correlations[best] < min_correlation) {
+		qWarning() << "estimate_time_offset(): The signals don't correlate" <<
+			"(" << correlations[best] << ")";
+		return false;
+	}
+
+	// A peak at the border is probably outside of the lag range
+	if (lag_count > 0 && (best == 0 || best == 2 * lag_count)) {
+		qWarning() << "estimate_time_offset(): The offset is not within" <<
+			"the maximum lag of" << max_lag << "s";
+		return false;
+	}
+
+	// Fit a parabola through the peak and its neighbours
+	double fraction = 0.;
+	if (best > 0 && best < 2 * lag_count) {
+		const double left = correlations[best - 1];
+		const double right = correlations[best + 1];
+		const double denominator = left - 2. * correlations[best] + right;
+		if (denominator < 0.)
+			fraction = 0.5 * (left - right) / denominator;
+	}
+	offset = ((double)best - (double)lag_count + fraction) * resolution;
+	return true;
+}
+
+} // namespace data
+} // namespace sv
@@ -0,0 +1,51 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_TIMEALIGNMENT_HPP
+#define DATA_TIMEALIGNMENT_HPP
+
+namespace sv {
+namespace data {
+
+class AnalogTimeSignal;
+
+/**
+ * Estimate the time offset of signal against reference by the cross
+ * correlation of both signals, e.g. the latency of a DMM against a PSU,
+ * that both measure the same voltage step.
+ *
+ * Both signals are resampled with the given resolution. The reference
+ * samples of [start_timestamp, end_timestamp] are compared with the
+ * signal samples shifted by -max_lag to +max_lag, the best match is refined
+ * between the grid points. The timestamps are absolute.
+ *
+ * @param offset The offset in seconds: signal(t + offset) matches
+ *        reference(t), so a positive offset means the signal is late.
+ *
+ * @return false if the signals don't cover the time range, are constant,
+ *         don't correlate well enough or the offset is beyond max_lag.
+ */
+bool estimate_time_offset(const AnalogTimeSignal &reference,
+	const AnalogTimeSignal &signal, double start_timestamp,
+	double end_timestamp, double max_lag, double resolution, double &offset);
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_TIMEALIGNMENT_HPP
@@ -0,0 +1,513 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "timebase.hpp"
+#include "src/data/chunkedbuffer.hpp"
+#include "src/data/compactbuffer.hpp"
+#include "src/data/spillfile.hpp"
+
+using std::lock_guard;
+using std::mutex;
+
+namespace sv {
+namespace data {
+
+namespace {
+
+const size_t npos = std::numeric_limits<size_t>::max();
+
+}
+
+TimeColumn::TimeColumn(bool compressed) :
+	member_count_(0)
+{
+	values_.set_compressed(compressed);
+}
+
+size_t TimeColumn::size() const
+{
+	return values_.size();
+}
+
+size_t TimeColumn::memory_size() const
+{
+	return values_.memory_size();
+}
+
+size_t TimeColumn::member_count() const
+{
+	return member_count_;
+}
+
+void TimeColumn::add_member(TimeBase *time_base)
+{
+	lock_guard<mutex> lock(mutex_);
+	members_.push_back(time_base);
+	member_count_ = members_.size();
+}
+
+void TimeColumn::remove_member(TimeBase *time_base)
+{
+	lock_guard<mutex> lock(mutex_);
+	members_.erase(std::remove(members_.begin(), members_.end(), time_base),
+		members_.end());
+	member_count_ = members_.size();
+	trim();
+}
+
+void TimeColumn::trim()
+{
+	size_t begin = values_.end_pos();
+	for (const auto &member : members_)
+		begin = std::min(begin, member->explicit_begin_.load());
+	if (begin > values_.begin_pos())
+		values_.drop_front(begin - values_.begin_pos());
+}
+
+const double TimeBase::stride_tolerance_ = 1e-3;
+
+TimeBase::TimeBase() :
+	runs_(8), // Runs are big, but there are only a few of them
+	explicit_values_(&explicit_),
+	explicit_begin_(npos),
+	begin_pos_(0),
+	end_pos_(0),
+	generation_(0)
+{
+}
+
+TimeBase::~TimeBase()
+{
+	if (column_)
+		column_->remove_member(this);
+}
+
+const CompactBuffer<double> &TimeBase::explicit_values() const
+{
+	return *explicit_values_.load(std::memory_order_acquire);
+}
+
+size_t TimeBase::begin_pos() const
+{
+	return begin_pos_.load(std::memory_order_acquire);
+}
+
+size_t TimeBase::end_pos() const
+{
+	return end_pos_.load(std::memory_order_acquire);
+}
+
+size_t TimeBase::size() const
+{
+	const size_t end = end_pos();
+	const size_t begin = begin_pos();
+	return end > begin ? end - begin : 0;
+}
+
+bool TimeBase::empty() const
+{
+	return size() == 0;
+}
+
+unsigned int TimeBase::generation() const
+{
+	return generation_.load(std::memory_order_acquire);
+}
+
+bool TimeBase::is_valid_read(size_t pos, unsigned int generation) const
+{
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return (generation & 1) == 0 && pos >= begin_pos() &&
+		generation_.load(std::memory_order_relaxed) == generation;
+}
+
+size_t TimeBase::run_count() const
+{
+	return runs_.size();
+}
+
+TimeBase::Run TimeBase::find_run(size_t pos, size_t &run_end) const
+{
+	size_t first = runs_.begin_pos();
+	size_t last = runs_.end_pos();
+	if (first >= last) {
+		run_end = pos;
+		return Run{ pos, 0, 0., 0., false };
+	}
+
+	// Fast path: Most reads are in the last (or only) run.
+	Run run = runs_[last - 1];
+	if (run.first_pos <= pos) {
+		run_end = end_pos();
+		return run;
+	}
+
+	// Binary search for the last run that starts at or before pos
+	--last;
+	while (last - first > 1) {
+		const size_t mid = first + (last - first) / 2;
+		if (runs_[mid].first_pos <= pos)
+			first = mid;
+		else
+			last = mid;
+	}
+	run_end = runs_[last].first_pos;
+	return runs_[first];
+}
+
+double TimeBase::timestamp(size_t pos) const
+{
+	size_t run_end;
+	const Run run = find_run(pos, run_end);
+	if (run.is_explicit)
+		return explicit_values()[run.explicit_pos + (pos - run.first_pos)];
+	return run.start + (double)(pos - run.first_pos) * run.stride;
+}
+
+double TimeBase::front() const
+{
+	return timestamp(begin_pos());
+}
+
+double TimeBase::back() const
+{
+	return timestamp(end_pos() - 1);
+}
+
+void TimeBase::copy(size_t pos, size_t count, double *dest) const
+{
+	while (count > 0) {
+		size_t run_end;
+		const Run run = find_run(pos, run_end);
+		const size_t n = run_end > pos ? std::min(count, run_end - pos) : count;
+		if (run.is_explicit) {
+			explicit_values().copy(
+				run.explicit_pos + (pos - run.first_pos), n, dest);
+		}
+		else {
+			for (size_t i = 0; i < n; ++i)
+				dest[i] = run.start + (double)(pos + i - run.first_pos) * run.stride;
+		}
+		dest += n;
+		pos += n;
+		count -= n;
+	}
+}
+
+void TimeBase::push_back(double timestamp)
+{
+	const size_t end = end_pos_.load(std::memory_order_relaxed);
+	if (!runs_.empty()) {
+		const Run &run = runs_.back();
+		if (!run.is_explicit) {
+			// Continue the stride run, if the timestamp fits
+			const double expected =
+				run.start + (double)(end - run.first_pos) * run.stride;
+			if (std::fabs(timestamp - expected) <=
+					std::fabs(run.stride) * stride_tolerance_) {
+				end_pos_.store(end + 1, std::memory_order_release);
+				return;
+			}
+		}
+	}
+
+	if (column_) {
+		push_to_column(timestamp, end);
+		end_pos_.store(end + 1, std::memory_order_release);
+		return;
+	}
+
+	if (runs_.empty() || !runs_.back().is_explicit)
+		runs_.push_back(Run{ end, explicit_.end_pos(), timestamp, 0., true });
+	explicit_.push_back(timestamp);
+	end_pos_.store(end + 1, std::memory_order_release);
+}
+
+void TimeBase::push_to_column(double timestamp, size_t end)
+{
+	lock_guard<mutex> lock(column_->mutex_);
+	CompactBuffer<double> &values = column_->values_;
+	const size_t column_end = values.end_pos();
+
+	size_t expected = npos;
+	if (!runs_.empty() && runs_.back().is_explicit) {
+		const Run &run = runs_.back();
+		expected = run.explicit_pos + (end - run.first_pos);
+	}
+
+	if (expected < column_end && values[expected] == timestamp) {
+		// Another time base already stored the timestamp, continue the run
+	}
+	else if (expected == column_end) {
+		values.push_back(timestamp);
+	}
+	else if (column_end > values.begin_pos() && values.back() == timestamp) {
+		// Start a new run at the last timestamp of another time base
+		runs_.push_back(Run{ end, column_end - 1, timestamp, 0., true });
+	}
+	else {
+		runs_.push_back(Run{ end, column_end, timestamp, 0., true });
+		values.push_back(timestamp);
+	}
+	update_explicit_begin();
+}
+
+void TimeBase::update_explicit_begin()
+{
+	if (runs_.empty()) {
+		explicit_begin_ = npos;
+		return;
+	}
+	const Run &run = runs_.front();
+	const size_t begin = begin_pos_.load(std::memory_order_relaxed);
+	size_t explicit_begin = run.explicit_pos;
+	if (run.is_explicit && begin > run.first_pos)
+		explicit_begin += begin - run.first_pos;
+	explicit_begin_ = explicit_begin;
+}
+
+void TimeBase::push_back(double start, double stride, size_t count)
+{
+	if (count == 0)
+		return;
+	if (count == 1) {
+		push_back(start);
+		return;
+	}
+
+	const size_t end = end_pos_.load(std::memory_order_relaxed);
+	bool continue_run = false;
+	if (!runs_.empty()) {
+		const Run &run = runs_.back();
+		if (!run.is_explicit && run.stride == stride) {
+			const double expected =
+				run.start + (double)(end - run.first_pos) * run.stride;
+			continue_run = std::fabs(start - expected) <=
+				std::fabs(stride) * stride_tolerance_;
+		}
+	}
+	if (!continue_run) {
+		// A following explicit run can start at the last timestamp of a
+		// shared column, see push_to_column().
+		size_t explicit_pos = explicit_values().end_pos();
+		if (column_ && explicit_pos > 0)
+			--explicit_pos;
+		runs_.push_back(Run{ end, explicit_pos, start, stride, false });
+		if (column_) {
+			lock_guard<mutex> lock(column_->mutex_);
+			update_explicit_begin();
+		}
+	}
+	end_pos_.store(end + count, std::memory_order_release);
+}
+
+size_t TimeBase::chunk_size() const
+{
+	return explicit_.chunk_size();
+}
+
+bool TimeBase::can_push_back_external() const
+{
+	return !column_ && explicit_.can_push_back_external();
+}
+
+bool TimeBase::push_back_external(const double *timestamps,
+	shared_ptr<const void> owner)
+{
+	if (!can_push_back_external())
+		return false;
+
+	const size_t end = end_pos_.load(std::memory_order_relaxed);
+	if (runs_.empty() || !runs_.back().is_explicit) {
+		runs_.push_back(
+			Run{ end, explicit_.end_pos(), timestamps[0], 0., true });
+	}
+	explicit_.push_back_external(timestamps, owner);
+	end_pos_.store(end + explicit_.chunk_size(), std::memory_order_release);
+	return true;
+}
+
+void TimeBase::drop_front(size_t count)
+{
+	const size_t end = end_pos_.load(std::memory_order_relaxed);
+	const size_t begin = std::min(
+		begin_pos_.load(std::memory_order_relaxed) + count, end);
+	begin_pos_.store(begin, std::memory_order_release);
+
+	// Drop all runs that end before the new begin. The last run is always
+	// kept, so following samples can continue it.
+	size_t dropped_runs = 0;
+	const size_t runs_begin = runs_.begin_pos();
+	while (runs_begin + dropped_runs + 1 < runs_.end_pos() &&
+			runs_[runs_begin + dropped_runs + 1].first_pos <= begin)
+		++dropped_runs;
+	runs_.drop_front(dropped_runs);
+
+	if (column_) {
+		lock_guard<mutex> lock(column_->mutex_);
+		update_explicit_begin();
+		column_->trim();
+		return;
+	}
+
+	if (runs_.empty())
+		return;
+	const Run &run = runs_.front();
+	size_t explicit_begin = run.explicit_pos;
+	if (run.is_explicit && begin > run.first_pos)
+		explicit_begin += begin - run.first_pos;
+	if (explicit_begin > explicit_.begin_pos())
+		explicit_.drop_front(explicit_begin - explicit_.begin_pos());
+}
+
+void TimeBase::clear()
+{
+	generation_.fetch_add(1, std::memory_order_acq_rel);
+	begin_pos_.store(0, std::memory_order_release);
+	end_pos_.store(0, std::memory_order_release);
+	runs_.clear();
+	if (column_) {
+		lock_guard<mutex> lock(column_->mutex_);
+		explicit_begin_ = npos;
+		column_->trim();
+	}
+	else {
+		explicit_.clear();
+	}
+	generation_.fetch_add(1, std::memory_order_release);
+}
+
+void TimeBase::set_spill_file(shared_ptr<SpillFile> spill_file)
+{
+	explicit_.set_spill_file(spill_file);
+}
+
+bool TimeBase::set_compressed(bool compressed)
+{
+	if (column_)
+		return true;
+	if (end_pos() > 0)
+		return compressed == explicit_.compressed();
+	return explicit_.set_compressed(compressed);
+}
+
+bool TimeBase::set_time_column(shared_ptr<TimeColumn> time_column)
+{
+	if (time_column == column_)
+		return true;
+	if (end_pos() > 0)
+		return false;
+
+	if (column_)
+		column_->remove_member(this);
+	column_ = time_column;
+	if (column_) {
+		column_->add_member(this);
+		explicit_values_.store(&column_->values_, std::memory_order_release);
+	}
+	else {
+		explicit_values_.store(&explicit_, std::memory_order_release);
+	}
+	return true;
+}
+
+shared_ptr<TimeColumn> TimeBase::time_column() const
+{
+	return column_;
+}
+
+size_t TimeBase::memory_size() const
+{
+	// Every member of a shared column is charged with its share
+	if (column_) {
+		return runs_.memory_size() +
+			column_->memory_size() / std::max((size_t)1, column_->member_count());
+	}
+	return runs_.memory_size() + explicit_.memory_size();
+}
+
+size_t TimeBase::spilled_size() const
+{
+	return explicit_.spilled_size();
+}
+
+size_t TimeBase::lower_bound(double timestamp, size_t first, size_t last) const
+{
+	if (first >= last)
+		return last;
+	if (this->timestamp(first) >= timestamp)
+		return first;
+
+	// Binary search for the last run with a timestamp < timestamp. The ranges
+	// of the first and the last run are clamped to [first, last).
+	size_t run_first = runs_.begin_pos();
+	size_t run_last = runs_.end_pos();
+	while (run_last - run_first > 1) {
+		const size_t mid = run_first + (run_last - run_first) / 2;
+		const Run run = runs_[mid];
+		if (run.first_pos < last &&
+				(run.first_pos <= first || run.start < timestamp))
+			run_first = mid;
+		else
+			run_last = mid;
+	}
+
+	const Run run = runs_[run_first];
+	size_t run_end = run_last < runs_.end_pos() ?
+		runs_[run_last].first_pos : end_pos();
+	const size_t lo = std::max(first, run.first_pos);
+	const size_t hi = std::min(last, run_end);
+	if (lo >= hi)
+		return hi;
+
+	if (run.is_explicit) {
+		const size_t offset = run.explicit_pos - run.first_pos;
+		return explicit_values().lower_bound(
+			timestamp, lo + offset, hi + offset) -
+			offset;
+	}
+	if (run.stride <= 0.)
+		return run.start < timestamp ? hi : lo;
+
+	// Calculate the position and correct rounding errors
+	const double steps = std::ceil((timestamp - run.start) / run.stride);
+	size_t pos = steps <= 0. ? run.first_pos : run.first_pos + (size_t)steps;
+	pos = std::max(lo, std::min(pos, hi));
+	while (pos > lo && this->timestamp(pos - 1) >= timestamp)
+		--pos;
+	while (pos < hi && this->timestamp(pos) < timestamp)
+		++pos;
+	return pos;
+}
+
+size_t TimeBase::lower_bound(double timestamp) const
+{
+	return lower_bound(timestamp, begin_pos(), end_pos());
+}
+
+} // namespace data
+} // namespace sv
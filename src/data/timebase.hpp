@@ -0,0 +1,257 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_TIMEBASE_HPP
+#define DATA_TIMEBASE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "src/data/chunkedbuffer.hpp"
+#include "src/data/compactbuffer.hpp"
+#include "src/data/spillfile.hpp"
+
+using std::shared_ptr;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+class TimeBase;
+
+/**
+ * Explicit timestamps, that are shared by the time bases of several
+ * signals, e.g. the channels of a device, that reports all channels in one
+ * frame. N signals then store one column of timestamps instead of N.
+ *
+ * A time base, that pushes a timestamp, that is already in the column at
+ * its next position, only references it. Diverging timestamps are simply
+ * appended, so sharing a column is always lossless. Timestamps are dropped
+ * from the column, when no time base needs them any more.
+ */
+class TimeColumn
+{
+public:
+	explicit TimeColumn(bool compressed = false);
+
+	TimeColumn(const TimeColumn &) = delete;
+	TimeColumn &operator=(const TimeColumn &) = delete;
+
+	size_t size() const;
+	/** Return the bytes on the heap. */
+	size_t memory_size() const;
+	/** Return the number of time bases, that use this column. */
+	size_t member_count() const;
+
+private:
+	void add_member(TimeBase *time_base);
+	void remove_member(TimeBase *time_base);
+	/**
+	 * Drop the timestamps, that are not needed by any member. mutex_ must be
+	 * locked.
+	 */
+	void trim();
+
+	/** Serializes the writes of the members to values_. */
+	std::mutex mutex_;
+	CompactBuffer<double> values_;
+	vector<TimeBase *> members_;
+	std::atomic<size_t> member_count_;
+
+	friend class TimeBase;
+
+};
+
+/**
+ * The timestamps of a signal, stored as runs.
+ *
+ * Samples with a fixed samplerate are stored as (start, stride) runs, the
+ * timestamp of a sample is calculated on demand. Only when the stride
+ * breaks (e.g. single samples from a polled device), the timestamps are
+ * stored explicitly.
+ *
+ * Like ChunkedBuffer, the timestamps are addressed by their absolute
+ * position and the same concurrency rules apply: One (serialized) writer
+ * and any number of lock-free readers, that have to validate their reads
+ * with is_valid_read().
+ */
+class TimeBase
+{
+public:
+	TimeBase();
+	~TimeBase();
+
+	TimeBase(const TimeBase &) = delete;
+	TimeBase &operator=(const TimeBase &) = delete;
+
+	size_t begin_pos() const;
+	size_t end_pos() const;
+	size_t size() const;
+	bool empty() const;
+	unsigned int generation() const;
+	bool is_valid_read(size_t pos, unsigned int generation) const;
+
+	/**
+	 * Return the number of runs, mainly for debugging/memory accounting.
+	 */
+	size_t run_count() const;
+
+	/**
+	 * Return the timestamp at the absolute position pos. The position must
+	 * have been checked against begin_pos() and end_pos().
+	 */
+	double timestamp(size_t pos) const;
+	double front() const;
+	double back() const;
+
+	/**
+	 * Copy count timestamps, starting at the absolute position pos, to dest.
+	 * The range must have been checked against begin_pos() and end_pos().
+	 */
+	void copy(size_t pos, size_t count, double *dest) const;
+
+	/**
+	 * Append a single timestamp.
+	 */
+	void push_back(double timestamp);
+
+	/**
+	 * Append count timestamps, starting at start with a distance of stride.
+	 * The samples are appended to the last run, if they continue it.
+	 */
+	void push_back(double start, double stride, size_t count);
+
+	/** Return the number of timestamps in an external chunk. */
+	size_t chunk_size() const;
+	/**
+	 * Return true if push_back_external() is possible. This needs own,
+	 * uncompressed explicit timestamps, that end at a chunk boundary.
+	 */
+	bool can_push_back_external() const;
+	/**
+	 * Append a chunk of chunk_size() explicit timestamps, that are stored
+	 * outside of the time base, without copying them, see
+	 * ChunkedBuffer::push_back_external().
+	 */
+	bool push_back_external(const double *timestamps,
+		shared_ptr<const void> owner);
+
+	void drop_front(size_t count);
+	void clear();
+
+	/**
+	 * Allocate the chunks of explicit timestamps in the spill file, see
+	 * ChunkedBuffer::set_spill_file(). The runs are small and stay in memory.
+	 */
+	void set_spill_file(shared_ptr<SpillFile> spill_file);
+
+	/**
+	 * Enable the lossless compression of the explicit timestamps, see
+	 * CompactBuffer. This is only possible, while the time base is empty.
+	 * With a shared time column, the column decides.
+	 *
+	 * @return true if the compression was changed.
+	 */
+	bool set_compressed(bool compressed);
+
+	/**
+	 * Store the explicit timestamps in a column, that is shared with other
+	 * time bases. This is only possible, while the time base is empty.
+	 *
+	 * @return true if the column was set.
+	 */
+	bool set_time_column(shared_ptr<TimeColumn> time_column);
+	shared_ptr<TimeColumn> time_column() const;
+
+	/** Return the bytes on the heap and in the spill file. */
+	size_t memory_size() const;
+	size_t spilled_size() const;
+
+	/**
+	 * Return the absolute position of the first timestamp in [first, last)
+	 * that is not less than timestamp. Returns last if all timestamps are
+	 * less than timestamp.
+	 */
+	size_t lower_bound(double timestamp, size_t first, size_t last) const;
+	size_t lower_bound(double timestamp) const;
+
+private:
+	struct Run
+	{
+		/** Absolute sample position of the first sample in this run. */
+		size_t first_pos;
+		/**
+		 * Position in explicit_ of the first timestamp of an explicit run.
+		 * For a stride run, this is where the next explicit run would start.
+		 */
+		size_t explicit_pos;
+		double start;
+		double stride;
+		bool is_explicit;
+	};
+
+	/**
+	 * Return the run that contains the absolute position pos and the
+	 * position behind the run in &run_end.
+	 */
+	Run find_run(size_t pos, size_t &run_end) const;
+
+	/** Return the own explicit timestamps or those of the column. */
+	const CompactBuffer<double> &explicit_values() const;
+
+	/** Append a timestamp to the shared column. */
+	void push_to_column(double timestamp, size_t end);
+
+	/**
+	 * Update explicit_begin_ after the runs were changed. Only needed with
+	 * a shared column.
+	 */
+	void update_explicit_begin();
+
+	/**
+	 * A stride run is continued, if the deviation of the new timestamp is
+	 * below this fraction of the stride.
+	 */
+	static const double stride_tolerance_;
+
+	ChunkedBuffer<Run> runs_;
+	CompactBuffer<double> explicit_;
+	shared_ptr<TimeColumn> column_;
+	/** Points to explicit_ or to the values of column_. */
+	std::atomic<CompactBuffer<double> *> explicit_values_;
+	/**
+	 * The first position in the column, that is still needed by this time
+	 * base. npos if no position is needed.
+	 */
+	std::atomic<size_t> explicit_begin_;
+	std::atomic<size_t> begin_pos_;
+	std::atomic<size_t> end_pos_;
+	std::atomic<unsigned int> generation_;
+
+	friend class TimeColumn;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_TIMEBASE_HPP
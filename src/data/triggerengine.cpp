@@ -0,0 +1,302 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <QDebug>
+
+#include "triggerengine.hpp"
+#include "src/data/analogbasesignal.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/samplebus.hpp"
+
+using std::lock_guard;
+using std::mutex;
+using std::unique_lock;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+const size_t TriggerEngine::read_block_size_ = 256;
+
+TriggerEngine::TriggerEngine(shared_ptr<AnalogTimeSignal> signal,
+		size_t max_event_count) :
+	QObject(),
+	signal_(signal),
+	max_event_count_(std::max(max_event_count, (size_t)1)),
+	next_signal_pos_(0),
+	block_timestamps_(read_block_size_),
+	block_values_(read_block_size_),
+	has_last_sample_(false),
+	last_timestamp_(0.),
+	next_trigger_id_(1),
+	first_event_pos_(0),
+	capture_full_rate_(false)
+{
+	assert(signal_);
+
+	// Only the samples from now on are checked
+	next_signal_pos_ = signal_->sample_count();
+
+	signal_->add_observer();
+	subscriptions_.push_back(signal_->subscribe_samples(
+		[this](size_t, size_t) { on_samples_appended(); },
+		[this]() { on_samples_cleared(); }, SampleExecutor::Context, this));
+}
+
+TriggerEngine::~TriggerEngine()
+{
+	signal_->remove_observer();
+}
+
+shared_ptr<AnalogTimeSignal> TriggerEngine::signal() const
+{
+	return signal_;
+}
+
+size_t TriggerEngine::add_edge_trigger(
+	TriggerEdge edge, double level, double hysteresis)
+{
+	Trigger trigger{};
+	trigger.type = TriggerEventType::RisingEdge;
+	trigger.edge = edge;
+	trigger.level = level;
+	trigger.hysteresis = std::abs(hysteresis);
+	return add_trigger(trigger);
+}
+
+size_t TriggerEngine::add_limit_trigger(
+	double low, double high, double hysteresis)
+{
+	Trigger trigger{};
+	trigger.type = TriggerEventType::LimitExceeded;
+	trigger.low = std::min(low, high);
+	trigger.high = std::max(low, high);
+	trigger.hysteresis = std::abs(hysteresis);
+	return add_trigger(trigger);
+}
+
+size_t TriggerEngine::add_dropout_trigger(double timeout)
+{
+	Trigger trigger{};
+	trigger.type = TriggerEventType::Dropout;
+	trigger.timeout = timeout;
+	return add_trigger(trigger);
+}
+
+size_t TriggerEngine::add_trigger(Trigger trigger)
+{
+	lock_guard<mutex> lock(mutex_);
+	trigger.id = next_trigger_id_++;
+	triggers_.push_back(trigger);
+	return trigger.id;
+}
+
+bool TriggerEngine::remove_trigger(size_t trigger_id)
+{
+	lock_guard<mutex> lock(mutex_);
+	auto it = std::find_if(triggers_.begin(), triggers_.end(),
+		[trigger_id](const Trigger &trigger) {
+			return trigger.id == trigger_id;
+		});
+	if (it == triggers_.end())
+		return false;
+
+	triggers_.erase(it);
+	return true;
+}
+
+size_t TriggerEngine::first_event_pos() const
+{
+	lock_guard<mutex> lock(mutex_);
+	return first_event_pos_;
+}
+
+size_t TriggerEngine::event_count() const
+{
+	lock_guard<mutex> lock(mutex_);
+	return first_event_pos_ + events_.size();
+}
+
+vector<TriggerEvent> TriggerEngine::events(size_t first) const
+{
+	lock_guard<mutex> lock(mutex_);
+	first = std::max(first, first_event_pos_);
+	const size_t end = first_event_pos_ + events_.size();
+	if (first >= end)
+		return vector<TriggerEvent>();
+
+	return vector<TriggerEvent>(
+		events_.begin() + (first - first_event_pos_), events_.end());
+}
+
+size_t TriggerEngine::wait_for_events(size_t count, int timeout) const
+{
+	unique_lock<mutex> lock(mutex_);
+	event_cond_.wait_for(lock, std::chrono::milliseconds(timeout),
+		[this, count]() {
+			return first_event_pos_ + events_.size() > count;
+		});
+	return first_event_pos_ + events_.size();
+}
+
+void TriggerEngine::clear_events()
+{
+	lock_guard<mutex> lock(mutex_);
+	first_event_pos_ += events_.size();
+	events_.clear();
+}
+
+void TriggerEngine::set_capture_full_rate(bool capture_full_rate)
+{
+	lock_guard<mutex> lock(mutex_);
+	capture_full_rate_ = capture_full_rate;
+}
+
+bool TriggerEngine::capture_full_rate() const
+{
+	lock_guard<mutex> lock(mutex_);
+	return capture_full_rate_;
+}
+
+void TriggerEngine::evaluate(size_t pos, double timestamp, double value)
+{
+	for (auto &trigger : triggers_) {
+		switch (trigger.type) {
+		case TriggerEventType::RisingEdge:
+		case TriggerEventType::FallingEdge:
+			if (trigger.edge != TriggerEdge::Falling) {
+				if (trigger.rising_armed && value >= trigger.level) {
+					add_event(trigger, TriggerEventType::RisingEdge,
+						pos, timestamp, value);
+					trigger.rising_armed = false;
+				}
+				else if (value < trigger.level - trigger.hysteresis) {
+					trigger.rising_armed = true;
+				}
+			}
+			if (trigger.edge != TriggerEdge::Rising) {
+				if (trigger.falling_armed && value <= trigger.level) {
+					add_event(trigger, TriggerEventType::FallingEdge,
+						pos, timestamp, value);
+					trigger.falling_armed = false;
+				}
+				else if (value > trigger.level + trigger.hysteresis) {
+					trigger.falling_armed = true;
+				}
+			}
+			break;
+		case TriggerEventType::LimitExceeded:
+		case TriggerEventType::LimitRecovered:
+			if (!trigger.outside &&
+					(value < trigger.low || value > trigger.high)) {
+				add_event(trigger, TriggerEventType::LimitExceeded,
+					pos, timestamp, value);
+				trigger.outside = true;
+			}
+			else if (trigger.outside &&
+					value >= trigger.low + trigger.hysteresis &&
+					value <= trigger.high - trigger.hysteresis) {
+				add_event(trigger, TriggerEventType::LimitRecovered,
+					pos, timestamp, value);
+				trigger.outside = false;
+			}
+			break;
+		case TriggerEventType::Dropout:
+			if (has_last_sample_ &&
+					timestamp - last_timestamp_ > trigger.timeout) {
+				add_event(trigger, TriggerEventType::Dropout,
+					pos, timestamp, timestamp - last_timestamp_);
+			}
+			break;
+		}
+	}
+
+	has_last_sample_ = true;
+	last_timestamp_ = timestamp;
+}
+
+void TriggerEngine::add_event(const Trigger &trigger, TriggerEventType type,
+	size_t pos, double timestamp, double value)
+{
+	events_.push_back(TriggerEvent{ trigger.id, type, pos, timestamp, value });
+	if (capture_full_rate_)
+		signal_->capture_full_rate(timestamp);
+	if (events_.size() > max_event_count_) {
+		events_.pop_front();
+		++first_event_pos_;
+	}
+}
+
+void TriggerEngine::on_samples_appended()
+{
+	size_t first_event = 0;
+	size_t event_end = 0;
+	{
+		lock_guard<mutex> lock(mutex_);
+		first_event = first_event_pos_ + events_.size();
+
+		size_t count;
+		while (true) {
+			// Skip samples, that were already dropped by the retention policy
+			if (next_signal_pos_ < signal_->first_sample_pos())
+				next_signal_pos_ = signal_->first_sample_pos();
+
+			count = signal_->copy_samples(next_signal_pos_, read_block_size_,
+				false, block_timestamps_.data(), block_values_.data());
+			if (count == 0)
+				break;
+
+			for (size_t i = 0; i < count; ++i) {
+				if (std::isnan(block_values_[i]))
+					continue;
+				evaluate(next_signal_pos_ + i,
+					block_timestamps_[i], block_values_[i]);
+			}
+			next_signal_pos_ += count;
+		}
+
+		event_end = first_event_pos_ + events_.size();
+	}
+
+	if (event_end > first_event) {
+		event_cond_.notify_all();
+		Q_EMIT events_triggered(
+			std::max(first_event, first_event_pos()), event_end);
+	}
+}
+
+void TriggerEngine::on_samples_cleared()
+{
+	lock_guard<mutex> lock(mutex_);
+	next_signal_pos_ = 0;
+	has_last_sample_ = false;
+}
+
+} // namespace data
+} // namespace sv
@@ -0,0 +1,215 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_TRIGGERENGINE_HPP
+#define DATA_TRIGGERENGINE_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <QObject>
+
+#include "src/data/samplebus.hpp"
+
+using std::deque;
+using std::shared_ptr;
+using std::unique_ptr;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+class AnalogTimeSignal;
+
+enum class TriggerEdge {
+	Rising,
+	Falling,
+	Any,
+};
+
+enum class TriggerEventType {
+	/** The value crossed the level upwards. */
+	RisingEdge,
+	/** The value crossed the level downwards. */
+	FallingEdge,
+	/** The value left the limits. */
+	LimitExceeded,
+	/** The value is back inside the limits (minus the hysteresis). */
+	LimitRecovered,
+	/** Two consecutive samples are further apart than the timeout. */
+	Dropout,
+};
+
+struct TriggerEvent
+{
+	/** The id of the trigger, see TriggerEngine::add_edge_trigger(). */
+	size_t trigger_id;
+	TriggerEventType type;
+	/** The position of the sample in the signal, that triggered. */
+	size_t sample_pos;
+	double timestamp;
+	/** The value of the sample, for a dropout the length of the gap. */
+	double value;
+};
+
+/**
+ * Evaluates trigger conditions over the samples of a signal.
+ *
+ * Every batch of appended samples is checked against all triggers, and the
+ * events are recorded in a bounded buffer. The buffer and the triggers can
+ * be accessed from any thread; the evaluation happens in the thread of the
+ * engine (e.g. a worker of the WorkerPool).
+ *
+ * Events are addressed by their absolute position, that stays stable when
+ * old events are dropped from the buffer.
+ */
+class TriggerEngine : public QObject
+{
+	Q_OBJECT
+
+public:
+	explicit TriggerEngine(shared_ptr<AnalogTimeSignal> signal,
+		size_t max_event_count = default_max_event_count);
+	~TriggerEngine();
+
+	shared_ptr<AnalogTimeSignal> signal() const;
+
+	/**
+	 * Trigger when the value crosses the level. After a trigger, the value
+	 * must go back behind the level by hysteresis, before the trigger is
+	 * armed again.
+	 *
+	 * @return The id of the trigger.
+	 */
+	size_t add_edge_trigger(TriggerEdge edge, double level, double hysteresis);
+
+	/**
+	 * Trigger when the value leaves [low, high] and when it is back inside
+	 * [low + hysteresis, high - hysteresis].
+	 *
+	 * @return The id of the trigger.
+	 */
+	size_t add_limit_trigger(double low, double high, double hysteresis);
+
+	/**
+	 * Trigger when the distance of two consecutive samples is greater than
+	 * timeout (in seconds). The event is emitted with the first sample
+	 * after the gap.
+	 *
+	 * @return The id of the trigger.
+	 */
+	size_t add_dropout_trigger(double timeout);
+
+	/** @return false if there is no trigger with the id. */
+	bool remove_trigger(size_t trigger_id);
+
+	/**
+	 * Return the absolute position of the oldest recorded event and the
+	 * position behind the newest event (the number of all events so far).
+	 */
+	size_t first_event_pos() const;
+	size_t event_count() const;
+
+	/**
+	 * Return the recorded events from the absolute position first on.
+	 */
+	vector<TriggerEvent> events(size_t first = 0) const;
+
+	/**
+	 * Wait until event_count() is greater than count or timeout (in
+	 * milliseconds) has passed.
+	 *
+	 * @return The event count.
+	 */
+	size_t wait_for_events(size_t count, int timeout) const;
+
+	/** Drop all recorded events. */
+	void clear_events();
+
+	/**
+	 * Promote the full rate samples around every event of this engine, see
+	 * AnalogTimeSignal::set_full_rate_capture().
+	 */
+	void set_capture_full_rate(bool capture_full_rate);
+	bool capture_full_rate() const;
+
+	static const size_t default_max_event_count = 100000;
+
+private:
+	struct Trigger
+	{
+		size_t id;
+		TriggerEventType type;
+		TriggerEdge edge;
+		double level;
+		double low;
+		double high;
+		double hysteresis;
+		double timeout;
+		bool rising_armed;
+		bool falling_armed;
+		bool outside;
+	};
+
+	size_t add_trigger(Trigger trigger);
+	/** Check a sample against all triggers. mutex_ must be locked. */
+	void evaluate(size_t pos, double timestamp, double value);
+	/** Record an event. mutex_ must be locked. */
+	void add_event(const Trigger &trigger, TriggerEventType type,
+		size_t pos, double timestamp, double value);
+
+	static const size_t read_block_size_;
+
+	shared_ptr<AnalogTimeSignal> signal_;
+	const size_t max_event_count_;
+	size_t next_signal_pos_;
+	vector<double> block_timestamps_;
+	vector<double> block_values_;
+	bool has_last_sample_;
+	double last_timestamp_;
+
+	mutable std::mutex mutex_;
+	mutable std::condition_variable event_cond_;
+	vector<Trigger> triggers_;
+	size_t next_trigger_id_;
+	deque<TriggerEvent> events_;
+	size_t first_event_pos_;
+	bool capture_full_rate_;
+	vector<unique_ptr<SampleBusSubscription>> subscriptions_;
+
+private Q_SLOTS:
+	void on_samples_appended();
+	void on_samples_cleared();
+
+Q_SIGNALS:
+	/**
+	 * The events in the absolute range [first, last) were recorded.
+	 */
+	void events_triggered(size_t first, size_t last);
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_TRIGGERENGINE_HPP
@@ -0,0 +1,397 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+
+#include "valuebuffer.hpp"
+#include "src/data/compactbuffer.hpp"
+#include "src/data/spillfile.hpp"
+
+namespace sv {
+namespace data {
+
+namespace {
+
+// Special int32 values for non finite values
+const int32_t int32_nan = std::numeric_limits<int32_t>::min();
+const int32_t int32_neg_inf = std::numeric_limits<int32_t>::min() + 1;
+const int32_t int32_pos_inf = std::numeric_limits<int32_t>::max();
+const int32_t int32_min = std::numeric_limits<int32_t>::min() + 2;
+const int32_t int32_max = std::numeric_limits<int32_t>::max() - 1;
+
+}
+
+ValueBuffer::ValueBuffer(ValueStorage storage) :
+	storage_(storage),
+	decimal_places_(0),
+	scale_factor_(1.),
+	generation_(0)
+{
+}
+
+ValueStorage ValueBuffer::storage() const
+{
+	return storage_.load(std::memory_order_acquire);
+}
+
+bool ValueBuffer::set_storage(ValueStorage storage)
+{
+	if (storage == this->storage())
+		return true;
+	if (end_pos() > 0)
+		return false;
+
+	generation_.fetch_add(1, std::memory_order_acq_rel);
+	storage_.store(storage, std::memory_order_release);
+	generation_.fetch_add(1, std::memory_order_release);
+	return true;
+}
+
+void ValueBuffer::set_decimal_places(int decimal_places)
+{
+	if (end_pos() > 0)
+		return;
+
+	// 10^9 is the biggest power of 10 in the int32 range
+	decimal_places = std::max(-9, std::min(decimal_places, 9));
+	decimal_places_ = decimal_places;
+	scale_factor_ = std::pow(10., decimal_places);
+}
+
+int ValueBuffer::decimal_places() const
+{
+	return decimal_places_;
+}
+
+bool ValueBuffer::set_compressed(bool compressed)
+{
+	if (compressed == this->compressed())
+		return true;
+	if (end_pos() > 0)
+		return false;
+
+	double_data_.set_compressed(compressed);
+	float_data_.set_compressed(compressed);
+	int32_data_.set_compressed(compressed);
+	return true;
+}
+
+bool ValueBuffer::compressed() const
+{
+	return double_data_.compressed();
+}
+
+size_t ValueBuffer::value_size() const
+{
+	switch (storage()) {
+	case ValueStorage::Float32:
+		return sizeof(float);
+	case ValueStorage::ScaledInt32:
+		return sizeof(int32_t);
+	case ValueStorage::Double:
+	default:
+		return sizeof(double);
+	}
+}
+
+size_t ValueBuffer::begin_pos() const
+{
+	switch (storage()) {
+	case ValueStorage::Float32:
+		return float_data_.begin_pos();
+	case ValueStorage::ScaledInt32:
+		return int32_data_.begin_pos();
+	case ValueStorage::Double:
+	default:
+		return double_data_.begin_pos();
+	}
+}
+
+size_t ValueBuffer::end_pos() const
+{
+	switch (storage()) {
+	case ValueStorage::Float32:
+		return float_data_.end_pos();
+	case ValueStorage::ScaledInt32:
+		return int32_data_.end_pos();
+	case ValueStorage::Double:
+	default:
+		return double_data_.end_pos();
+	}
+}
+
+size_t ValueBuffer::size() const
+{
+	const size_t end = end_pos();
+	const size_t begin = begin_pos();
+	return end > begin ? end - begin : 0;
+}
+
+bool ValueBuffer::empty() const
+{
+	return size() == 0;
+}
+
+unsigned int ValueBuffer::generation() const
+{
+	return generation_.load(std::memory_order_acquire);
+}
+
+bool ValueBuffer::is_valid_read(size_t pos, unsigned int generation) const
+{
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return (generation & 1) == 0 && pos >= begin_pos() &&
+		generation_.load(std::memory_order_relaxed) == generation;
+}
+
+double ValueBuffer::operator[](size_t pos) const
+{
+	switch (storage()) {
+	case ValueStorage::Float32:
+		return (double)float_data_[pos];
+	case ValueStorage::ScaledInt32:
+		return unscale(int32_data_[pos]);
+	case ValueStorage::Double:
+	default:
+		return double_data_[pos];
+	}
+}
+
+double ValueBuffer::front() const
+{
+	return (*this)[begin_pos()];
+}
+
+double ValueBuffer::back() const
+{
+	return (*this)[end_pos() - 1];
+}
+
+void ValueBuffer::copy(size_t pos, size_t count, double *dest) const
+{
+	switch (storage()) {
+	case ValueStorage::Float32:
+		float_data_.copy(pos, count, dest);
+		break;
+	case ValueStorage::ScaledInt32:
+		// Every int32 is exactly representable as double
+		int32_data_.copy(pos, count, dest);
+		for (size_t i = 0; i < count; ++i)
+			dest[i] = unscale((int32_t)dest[i]);
+		break;
+	case ValueStorage::Double:
+	default:
+		double_data_.copy(pos, count, dest);
+		break;
+	}
+}
+
+const double *ValueBuffer::span(size_t pos, size_t &count) const
+{
+	if (storage() != ValueStorage::Double)
+		return nullptr;
+	return double_data_.span(pos, count);
+}
+
+void ValueBuffer::hold() const
+{
+	// Only the double values are referenced in place
+	double_data_.hold();
+}
+
+void ValueBuffer::release_hold() const
+{
+	double_data_.release_hold();
+}
+
+double ValueBuffer::stored_value(double value) const
+{
+	switch (storage()) {
+	case ValueStorage::Float32:
+		return (double)(float)value;
+	case ValueStorage::ScaledInt32:
+		return unscale(scale(value));
+	case ValueStorage::Double:
+	default:
+		return value;
+	}
+}
+
+void ValueBuffer::push_back(double value)
+{
+	switch (storage()) {
+	case ValueStorage::Float32:
+		float_data_.push_back((float)value);
+		break;
+	case ValueStorage::ScaledInt32:
+		int32_data_.push_back(scale(value));
+		break;
+	case ValueStorage::Double:
+	default:
+		double_data_.push_back(value);
+		break;
+	}
+}
+
+void ValueBuffer::push_back(const float *values, size_t count)
+{
+	if (storage() == ValueStorage::Float32)
+		float_data_.push_back(values, count);
+	else
+		push_back_converted(values, count);
+}
+
+void ValueBuffer::push_back(const double *values, size_t count)
+{
+	if (storage() == ValueStorage::Double)
+		double_data_.push_back(values, count);
+	else
+		push_back_converted(values, count);
+}
+
+size_t ValueBuffer::chunk_size() const
+{
+	return double_data_.chunk_size();
+}
+
+bool ValueBuffer::can_push_back_external() const
+{
+	return storage() == ValueStorage::Double &&
+		double_data_.can_push_back_external();
+}
+
+bool ValueBuffer::push_back_external(const double *values,
+	shared_ptr<const void> owner)
+{
+	if (!can_push_back_external())
+		return false;
+	return double_data_.push_back_external(values, owner);
+}
+
+template<typename T>
+void ValueBuffer::push_back_converted(const T *values, size_t count)
+{
+	// Convert in small blocks on the stack, that are then copied at once
+	const size_t block_size = 256;
+	double double_block[block_size];
+	float float_block[block_size];
+	int32_t int32_block[block_size];
+	const ValueStorage storage = this->storage();
+	while (count > 0) {
+		const size_t n = std::min(count, block_size);
+		switch (storage) {
+		case ValueStorage::Float32:
+			for (size_t i = 0; i < n; ++i)
+				float_block[i] = (float)values[i];
+			float_data_.push_back(float_block, n);
+			break;
+		case ValueStorage::ScaledInt32:
+			for (size_t i = 0; i < n; ++i)
+				int32_block[i] = scale((double)values[i]);
+			int32_data_.push_back(int32_block, n);
+			break;
+		case ValueStorage::Double:
+		default:
+			for (size_t i = 0; i < n; ++i)
+				double_block[i] = (double)values[i];
+			double_data_.push_back(double_block, n);
+			break;
+		}
+		values += n;
+		count -= n;
+	}
+}
+
+void ValueBuffer::drop_front(size_t count)
+{
+	switch (storage()) {
+	case ValueStorage::Float32:
+		float_data_.drop_front(count);
+		break;
+	case ValueStorage::ScaledInt32:
+		int32_data_.drop_front(count);
+		break;
+	case ValueStorage::Double:
+	default:
+		double_data_.drop_front(count);
+		break;
+	}
+}
+
+void ValueBuffer::clear()
+{
+	generation_.fetch_add(1, std::memory_order_acq_rel);
+	double_data_.clear();
+	float_data_.clear();
+	int32_data_.clear();
+	generation_.fetch_add(1, std::memory_order_release);
+}
+
+void ValueBuffer::set_spill_file(shared_ptr<SpillFile> spill_file)
+{
+	double_data_.set_spill_file(spill_file);
+	float_data_.set_spill_file(spill_file);
+	int32_data_.set_spill_file(spill_file);
+}
+
+size_t ValueBuffer::memory_size() const
+{
+	return double_data_.memory_size() + float_data_.memory_size() +
+		int32_data_.memory_size();
+}
+
+size_t ValueBuffer::spilled_size() const
+{
+	return double_data_.spilled_size() + float_data_.spilled_size() +
+		int32_data_.spilled_size();
+}
+
+int32_t ValueBuffer::scale(double value) const
+{
+	if (std::isnan(value))
+		return int32_nan;
+	if (std::isinf(value))
+		return value > 0 ? int32_pos_inf : int32_neg_inf;
+
+	const double scaled = std::round(value * scale_factor_);
+	if (scaled < (double)int32_min)
+		return int32_min;
+	if (scaled > (double)int32_max)
+		return int32_max;
+	return (int32_t)scaled;
+}
+
+double ValueBuffer::unscale(int32_t value) const
+{
+	if (value == int32_nan)
+		return std::numeric_limits<double>::quiet_NaN();
+	if (value == int32_neg_inf)
+		return -std::numeric_limits<double>::infinity();
+	if (value == int32_pos_inf)
+		return std::numeric_limits<double>::infinity();
+	return (double)value / scale_factor_;
+}
+
+} // namespace data
+} // namespace sv
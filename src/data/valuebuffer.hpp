@@ -0,0 +1,187 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_VALUEBUFFER_HPP
+#define DATA_VALUEBUFFER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "src/data/compactbuffer.hpp"
+#include "src/data/spillfile.hpp"
+
+using std::shared_ptr;
+
+namespace sv {
+namespace data {
+
+/**
+ * The type, that is used to store the values of a signal.
+ */
+enum class ValueStorage {
+	/** 8 bytes per value, no loss of precision. */
+	Double,
+	/**
+	 * 4 bytes per value. Lossless for values from sigrok devices, because
+	 * they are delivered as float anyways.
+	 */
+	Float32,
+	/**
+	 * 4 bytes per value, stored as integer scaled by the number of decimal
+	 * places of the first sample. Values outside of the int32 range are
+	 * saturated.
+	 */
+	ScaledInt32,
+};
+
+/**
+ * The values of a signal, stored as double, float or scaled int32.
+ *
+ * The values are always read and written as double. Like ChunkedBuffer, the
+ * values are addressed by their absolute position and the same concurrency
+ * rules apply: One (serialized) writer and any number of lock-free readers,
+ * that have to validate their reads with is_valid_read().
+ */
+class ValueBuffer
+{
+public:
+	explicit ValueBuffer(ValueStorage storage = ValueStorage::Double);
+
+	ValueBuffer(const ValueBuffer &) = delete;
+	ValueBuffer &operator=(const ValueBuffer &) = delete;
+
+	ValueStorage storage() const;
+	/**
+	 * Change the storage type. This is only possible, while the buffer
+	 * is empty (end_pos() == 0).
+	 *
+	 * @return true if the storage type was changed.
+	 */
+	bool set_storage(ValueStorage storage);
+
+	/**
+	 * Set the number of decimal places for ValueStorage::ScaledInt32. This
+	 * is only possible, while the buffer is empty (end_pos() == 0).
+	 */
+	void set_decimal_places(int decimal_places);
+	int decimal_places() const;
+
+	/**
+	 * Enable the lossless compression of the values, see CompactBuffer.
+	 * This is only possible, while the buffer is empty (end_pos() == 0).
+	 *
+	 * @return true if the compression was changed.
+	 */
+	bool set_compressed(bool compressed);
+	bool compressed() const;
+
+	/** Return the number of bytes, that are used to store one value. */
+	size_t value_size() const;
+
+	size_t begin_pos() const;
+	size_t end_pos() const;
+	size_t size() const;
+	bool empty() const;
+	unsigned int generation() const;
+	bool is_valid_read(size_t pos, unsigned int generation) const;
+
+	/**
+	 * Return the value at the absolute position pos. The position must have
+	 * been checked against begin_pos() and end_pos().
+	 */
+	double operator[](size_t pos) const;
+	double front() const;
+	double back() const;
+
+	/**
+	 * Copy count values, starting at the absolute position pos, to dest.
+	 * The range must have been checked against begin_pos() and end_pos().
+	 */
+	void copy(size_t pos, size_t count, double *dest) const;
+
+	/**
+	 * Return a pointer to the values in place, see ChunkedBuffer::span().
+	 * Returns nullptr unless the values are stored as uncompressed doubles.
+	 */
+	const double *span(size_t pos, size_t &count) const;
+	/** See ChunkedBuffer::hold(). */
+	void hold() const;
+	void release_hold() const;
+
+	/**
+	 * Return the value as it is read back after push_back(), i.e. rounded
+	 * to float or to the decimal places, and saturated to the range of the
+	 * storage.
+	 */
+	double stored_value(double value) const;
+
+	void push_back(double value);
+	/**
+	 * Append count values. Values, that already have the type of the
+	 * storage, are copied directly into the chunks.
+	 */
+	void push_back(const float *values, size_t count);
+	void push_back(const double *values, size_t count);
+
+	/** Return the number of values in an external chunk. */
+	size_t chunk_size() const;
+	/**
+	 * Return true if push_back_external() is possible. External values are
+	 * only possible with the uncompressed double storage.
+	 */
+	bool can_push_back_external() const;
+	/**
+	 * Append a chunk of chunk_size() values, that are stored outside of the
+	 * buffer, without copying them, see ChunkedBuffer::push_back_external().
+	 */
+	bool push_back_external(const double *values,
+		shared_ptr<const void> owner);
+
+	void drop_front(size_t count);
+	void clear();
+
+	/** See ChunkedBuffer::set_spill_file(). */
+	void set_spill_file(shared_ptr<SpillFile> spill_file);
+	/** Return the bytes on the heap and in the spill file. */
+	size_t memory_size() const;
+	size_t spilled_size() const;
+
+private:
+	template<typename T>
+	void push_back_converted(const T *values, size_t count);
+
+	int32_t scale(double value) const;
+	double unscale(int32_t value) const;
+
+	std::atomic<ValueStorage> storage_;
+	std::atomic<int> decimal_places_;
+	std::atomic<double> scale_factor_;
+	std::atomic<unsigned int> generation_;
+	CompactBuffer<double> double_data_;
+	CompactBuffer<float> float_data_;
+	CompactBuffer<int32_t> int32_data_;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_VALUEBUFFER_HPP
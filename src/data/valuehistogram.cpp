@@ -0,0 +1,245 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "valuehistogram.hpp"
+
+using std::vector;
+
+namespace sv {
+namespace data {
+
+ValueHistogram::ValueHistogram(size_t bin_count) :
+	bin_count_(std::max<size_t>(2, bin_count + (bin_count & 1))),
+	bins_(bin_count_, 0),
+	max_count_(0),
+	value_count_(0),
+	has_range_(false),
+	range_min_(0.),
+	range_max_(0.),
+	min_(0.),
+	max_(0.),
+	mean_(0.),
+	m2_(0.)
+{
+}
+
+void ValueHistogram::add(const double *values, size_t count)
+{
+	if (!has_range_)
+		init_range(values, count);
+	if (!has_range_)
+		return;
+
+	for (size_t i = 0; i < count; ++i) {
+		const double value = values[i];
+		if (!std::isfinite(value))
+			continue;
+		if ((value < range_min_ || value > range_max_) && !grow(value))
+			continue;
+		add_value(value);
+	}
+}
+
+void ValueHistogram::clear()
+{
+	std::fill(bins_.begin(), bins_.end(), 0);
+	max_count_ = 0;
+	value_count_ = 0;
+	has_range_ = false;
+	mean_ = 0.;
+	m2_ = 0.;
+}
+
+size_t ValueHistogram::bin_count() const
+{
+	return bin_count_;
+}
+
+uint64_t ValueHistogram::value_count() const
+{
+	return value_count_;
+}
+
+bool ValueHistogram::empty() const
+{
+	return value_count_ == 0;
+}
+
+double ValueHistogram::range_min() const
+{
+	return range_min_;
+}
+
+double ValueHistogram::range_max() const
+{
+	return range_max_;
+}
+
+double ValueHistogram::bin_width() const
+{
+	return (range_max_ - range_min_) / (double)bin_count_;
+}
+
+double ValueHistogram::bin_start(size_t bin) const
+{
+	return range_min_ + (double)bin * bin_width();
+}
+
+const vector<uint64_t> &ValueHistogram::bins() const
+{
+	return bins_;
+}
+
+uint64_t ValueHistogram::max_count() const
+{
+	return max_count_;
+}
+
+bool ValueHistogram::used_bins(size_t &first, size_t &last) const
+{
+	if (value_count_ == 0)
+		return false;
+
+	first = 0;
+	while (bins_[first] == 0)
+		++first;
+	last = bin_count_ - 1;
+	while (bins_[last] == 0)
+		--last;
+	return true;
+}
+
+double ValueHistogram::min() const
+{
+	if (value_count_ == 0)
+		return std::numeric_limits<double>::quiet_NaN();
+	return min_;
+}
+
+double ValueHistogram::max() const
+{
+	if (value_count_ == 0)
+		return std::numeric_limits<double>::quiet_NaN();
+	return max_;
+}
+
+double ValueHistogram::mean() const
+{
+	if (value_count_ == 0)
+		return std::numeric_limits<double>::quiet_NaN();
+	return mean_;
+}
+
+double ValueHistogram::stddev() const
+{
+	if (value_count_ < 2)
+		return std::numeric_limits<double>::quiet_NaN();
+	return std::sqrt(m2_ / (double)(value_count_ - 1));
+}
+
+void ValueHistogram::init_range(const double *values, size_t count)
+{
+	double min = std::numeric_limits<double>::max();
+	double max = std::numeric_limits<double>::lowest();
+	for (size_t i = 0; i < count; ++i) {
+		if (!std::isfinite(values[i]))
+			continue;
+		min = std::min(min, values[i]);
+		max = std::max(max, values[i]);
+	}
+	if (min > max)
+		return;
+
+	// A single value still needs an extent
+	if (!(max - min > 0.)) {
+		const double extent = std::max(std::fabs(min) * 1e-3, 1e-12);
+		min -= extent;
+		max += extent;
+	}
+
+	range_min_ = min;
+	range_max_ = max;
+	has_range_ = true;
+}
+
+bool ValueHistogram::grow(double value)
+{
+	const size_t half = bin_count_ / 2;
+	while (value < range_min_ || value > range_max_) {
+		const double width = range_max_ - range_min_;
+		const bool grow_up = value > range_max_;
+		const double new_min = grow_up ? range_min_ : range_min_ - width;
+		const double new_max = grow_up ? range_max_ + width : range_max_;
+		if (!std::isfinite(new_max - new_min))
+			return false;
+
+		// Merge two bins into one. The old range is the lower (or upper)
+		// half of the new range.
+		if (grow_up) {
+			for (size_t bin = 0; bin < half; ++bin)
+				bins_[bin] = bins_[2 * bin] + bins_[2 * bin + 1];
+			std::fill(bins_.begin() + half, bins_.end(), 0);
+		}
+		else {
+			for (size_t bin = bin_count_; bin-- > half; ) {
+				const size_t old_bin = 2 * (bin - half);
+				bins_[bin] = bins_[old_bin] + bins_[old_bin + 1];
+			}
+			std::fill(bins_.begin(), bins_.begin() + half, 0);
+		}
+		range_min_ = new_min;
+		range_max_ = new_max;
+		max_count_ = *std::max_element(bins_.begin(), bins_.end());
+	}
+	return true;
+}
+
+void ValueHistogram::add_value(double value)
+{
+	const double f = (value - range_min_) / (range_max_ - range_min_) *
+		(double)bin_count_;
+	const size_t bin = std::min((size_t)f, bin_count_ - 1);
+
+	uint64_t &count = bins_[bin];
+	++count;
+	max_count_ = std::max(max_count_, count);
+
+	if (value_count_ == 0) {
+		min_ = value;
+		max_ = value;
+	}
+	else {
+		min_ = std::min(min_, value);
+		max_ = std::max(max_, value);
+	}
+	++value_count_;
+	const double delta = value - mean_;
+	mean_ += delta / (double)value_count_;
+	m2_ += delta * (value - mean_);
+}
+
+} // namespace data
+} // namespace sv
@@ -0,0 +1,112 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_VALUEHISTOGRAM_HPP
+#define DATA_VALUEHISTOGRAM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using std::vector;
+
+namespace sv {
+namespace data {
+
+/**
+ * A histogram of the values of a signal, e.g. for noise and stability
+ * measurements.
+ *
+ * Like DensityHistogram, the values are counted in a fixed number of bins,
+ * so adding values costs O(new values) and the memory doesn't depend on
+ * the number of values. The range is taken from the first values and is
+ * doubled (in the direction of the new value) when a value is outside of
+ * it, by merging two bins into one. The history is never rescanned. Non
+ * finite values are skipped.
+ *
+ * The mean and the standard deviation of the values are kept as running
+ * statistics, so they are exact independent of the bin width.
+ */
+class ValueHistogram
+{
+public:
+	/** The number of bins is rounded up to an even number. */
+	explicit ValueHistogram(size_t bin_count = 256);
+
+	void add(const double *values, size_t count);
+	void clear();
+
+	size_t bin_count() const;
+	/** Return the number of counted values. */
+	uint64_t value_count() const;
+	bool empty() const;
+
+	/** The range, that is covered by the bins. */
+	double range_min() const;
+	double range_max() const;
+	double bin_width() const;
+	/** Return the lower edge of the bin. */
+	double bin_start(size_t bin) const;
+
+	const vector<uint64_t> &bins() const;
+	uint64_t max_count() const;
+	/**
+	 * Return the first and the last bin with a count in &first and &last.
+	 *
+	 * @return false if the histogram is empty.
+	 */
+	bool used_bins(size_t &first, size_t &last) const;
+
+	/** The smallest and the biggest counted value. */
+	double min() const;
+	double max() const;
+	double mean() const;
+	/** The sample standard deviation of the counted values. */
+	double stddev() const;
+
+private:
+	/** Set the initial range from the values. */
+	void init_range(const double *values, size_t count);
+	/**
+	 * Double the range towards value until it contains value.
+	 *
+	 * @return false if the range would overflow.
+	 */
+	bool grow(double value);
+	void add_value(double value);
+
+	size_t bin_count_;
+	vector<uint64_t> bins_;
+	uint64_t max_count_;
+	uint64_t value_count_;
+	bool has_range_;
+	double range_min_;
+	double range_max_;
+	double min_;
+	double max_;
+	/** Running mean and sum of squared deviations (Welford). */
+	double mean_;
+	double m2_;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_VALUEHISTOGRAM_HPP
@@ -18,12 +18,18 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <condition_variable>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
 
 #include <glib.h>
 
@@ -35,6 +41,7 @@
 #include <QProgressDialog>
 
 #include "devicemanager.hpp"
+#include "src/settingsmanager.hpp"
 #include "src/util.hpp"
 #include "src/devices/basedevice.hpp"
 #include "src/devices/deviceutil.hpp"
@@ -43,14 +50,17 @@
 #include "src/devices/sourcesinkdevice.hpp"
 
 using std::bind;
+using std::lock_guard;
 using std::list;
 using std::map;
 using std::multimap;
 using std::pair;
 using std::placeholders::_1;
 using std::placeholders::_2;
+using std::set;
 using std::shared_ptr;
 using std::string;
+using std::unique_lock;
 using std::unique_ptr;
 using std::vector;
 
@@ -58,17 +68,123 @@ using Glib::VariantBase;
 
 namespace sv {
 
-DeviceManager::DeviceManager(shared_ptr<sigrok::Context> context,
-		const vector<string> &drivers, bool do_scan) :
-	context_(context)
+struct DeviceManager::ScanJob
 {
-	unique_ptr<QProgressDialog> progress(new QProgressDialog("",
-		QObject::tr("Cancel"), 0, (int)context->drivers().size() + 1));
-	progress->setWindowModality(Qt::WindowModal);
-	progress->setMinimumDuration(1);  // To show the dialog immediately
+	shared_ptr<sigrok::Driver> driver;
+	map<const sigrok::ConfigKey *, VariantBase> options;
+	/** Jobs with the same connection are not scanned at the same time. */
+	string connection;
+	bool user_spec;
+	/** Replace the devices of previous scans of the driver. */
+	bool replace_devices;
+	list<shared_ptr<devices::HardwareDevice>> found;
+};
+
+namespace {
+
+enum class ScanStatus {
+	Pending,
+	Running,
+	Done,
+	TimedOut,
+	/** Not scanned, because a scan of the connection timed out. */
+	Skipped
+};
+
+struct ScanTask
+{
+	shared_ptr<sigrok::Driver> driver;
+	map<const sigrok::ConfigKey *, VariantBase> options;
+	string connection;
+	ScanStatus status;
+	std::chrono::steady_clock::time_point start_time;
+	vector<shared_ptr<sigrok::HardwareDevice>> sr_devices;
+	string error;
+};
+
+/**
+ * The state of the scan threads. It is shared with the threads, because
+ * the threads of abandoned scans are detached and may outlive the caller.
+ */
+struct ScanState
+{
+	std::mutex mutex;
+	std::condition_variable cond;
+	vector<ScanTask> tasks;
+	/**
+	 * The connections of the running scans, including the timed out scans,
+	 * whose threads didn't return yet.
+	 */
+	set<string> busy_connections;
+	bool canceled = false;
+};
+
+void scan_thread_proc(shared_ptr<ScanState> state)
+{
+	unique_lock<std::mutex> lock(state->mutex);
+	while (!state->canceled) {
+		// Take the first pending task, whose connection is not busy
+		bool pending = false;
+		ScanTask *task = nullptr;
+		for (auto &t : state->tasks) {
+			if (t.status != ScanStatus::Pending)
+				continue;
+			pending = true;
+			if (t.connection.empty() ||
+					state->busy_connections.count(t.connection) == 0) {
+				task = &t;
+				break;
+			}
+		}
+		if (!pending)
+			break;
+		if (!task) {
+			state->cond.wait(lock);
+			continue;
+		}
+
+		task->status = ScanStatus::Running;
+		task->start_time = std::chrono::steady_clock::now();
+		if (!task->connection.empty())
+			state->busy_connections.insert(task->connection);
+		const auto driver = task->driver;
+		const auto options = task->options;
+		lock.unlock();
+
+		vector<shared_ptr<sigrok::HardwareDevice>> sr_devices;
+		string error;
+		try {
+			sr_devices = driver->scan(options);
+		}
+		catch (sigrok::Error &e) {
+			error = e.what();
+		}
+
+		lock.lock();
+		// The results of an abandoned scan are dropped, but the connection
+		// is only released now, that the driver doesn't probe it any more.
+		if (task->status == ScanStatus::Running) {
+			task->sr_devices = sr_devices;
+			task->error = error;
+			task->status = ScanStatus::Done;
+		}
+		if (!task->connection.empty())
+			state->busy_connections.erase(task->connection);
+		state->cond.notify_all();
+	}
+	state->cond.notify_all();
+}
+
+} // namespace
 
-	int entry_num = 1;
+const string DeviceManager::any_connection_ = "*";
+const unsigned int DeviceManager::scan_timeout_ = 20000;
 
+DeviceManager::DeviceManager(shared_ptr<sigrok::Context> context,
+		const vector<string> &drivers, bool do_scan) :
+	context_(context),
+	generation_(0)
+{
 	/*
 	 * Check the presence of optional user specs for device scans.
 	 * Determine the driver names and options (in generic format) when
@@ -86,29 +202,76 @@ DeviceManager::DeviceManager(shared_ptr<sigrok::Context> context,
 		}
 	}
 
+	const auto sr_drivers = context->drivers();
+
+	/*
+	 * Reconnect the devices of the scan cache first. These scans only probe
+	 * one connection each and are much faster than the auto detection, that
+	 * is skipped when all cached devices were found.
+	 */
+	const map<QString, string> cached_specs = do_scan ?
+		SettingsManager::restore_scan_specs() : map<QString, string>();
+	vector<ScanJob> reconnect_jobs;
+	set<string> reconnect_specs;
+	vector<QString> reconnect_ids;
+	for (const auto &cached_spec : cached_specs) {
+		vector<string> drv_opts = sv::util::split_string(
+			cached_spec.second, ":");
+		const string drv_name = drv_opts.front();
+		drv_opts.erase(drv_opts.begin());
+
+		// User specs take precedence over the cache
+		if (user_drvs_name_opts.count(drv_name) > 0)
+			continue;
+		auto sr_driver = sr_drivers.find(drv_name);
+		if (sr_driver == sr_drivers.end() ||
+				!devices::deviceutil::is_supported_driver(sr_driver->second))
+			continue;
+
+		reconnect_ids.push_back(cached_spec.first);
+		if (!reconnect_specs.insert(cached_spec.second).second)
+			continue;
+		string connection = scan_connection(drv_opts);
+		if (connection.empty())
+			connection = auto_scan_connection(sr_driver->second);
+		reconnect_jobs.push_back(ScanJob{ sr_driver->second,
+			driver_scan_options(drv_opts, sr_driver->second->scan_options()),
+			connection, false, false, {} });
+	}
+	run_scan_jobs(reconnect_jobs);
+
+	set<string> reconnected_drivers;
+	for (const auto &device : devices_)
+		reconnected_drivers.insert(
+			device->sr_hardware_device()->driver()->name());
+	bool all_reconnected = !reconnect_ids.empty();
+	for (const auto &id : reconnect_ids) {
+		if (!has_device(id))
+			all_reconnected = false;
+	}
+
+	vector<ScanJob> jobs;
+
 	/*
 	 * Scan for devices. No specific options apply here, this is
 	 * best effort auto detection.
 	 */
-	for (const auto &entry : context->drivers()) {
-		if (!do_scan)
+	for (const auto &entry : sr_drivers) {
+		if (!do_scan || all_reconnected)
 			break;
 
 		// Skip drivers we won't scan anyway
 		if (!devices::deviceutil::is_supported_driver(entry.second))
 			continue;
-
-		progress->setLabelText(QObject::tr("Scanning for %1...")
-			.arg(QString::fromStdString(entry.first)));
-
 		if (user_drvs_name_opts.count(entry.first) > 0)
 			continue;
-		driver_scan(entry.second, map<const sigrok::ConfigKey *, VariantBase>());
+		// A new scan would replace the reconnected devices
+		if (reconnected_drivers.count(entry.first) > 0)
+			continue;
 
-		progress->setValue(entry_num++);
-		QApplication::processEvents();
-		if (progress->wasCanceled())
-			break;
+		jobs.push_back(ScanJob{ entry.second,
+			map<const sigrok::ConfigKey *, VariantBase>(),
+			auto_scan_connection(entry.second), false, true, {} });
 	}
 
 	/*
@@ -119,22 +282,168 @@ DeviceManager::DeviceManager(shared_ptr<sigrok::Context> context,
 	 * prefer one out of multiple found devices, and have this
 	 * device pre-selected for new sessions upon user's request.
 	 */
-	user_spec_devices_.clear();
- 	if (!drivers.empty() && !user_drvs_name_opts.empty()) {
+	if (!drivers.empty() && !user_drvs_name_opts.empty()) {
 		for( auto it = user_drvs_name_opts.begin(), end = user_drvs_name_opts.end();
 			it != end;
  			it = user_drvs_name_opts.upper_bound(it->first)) {
 
-			auto user_drv_name = it->first;
-			auto user_drv_opts = it->second;
+			auto sr_driver = sr_drivers.find(it->first);
+			if (sr_driver == sr_drivers.end())
+				continue;
+			// The auto detection probes all USB devices
+			string connection = scan_connection(it->second);
+			if (connection.empty() ||
+					(do_scan && connection.compare(0, 3, "usb") == 0))
+				connection = auto_scan_connection(sr_driver->second);
+			jobs.push_back(ScanJob{ sr_driver->second,
+				driver_scan_options(it->second,
+					sr_driver->second->scan_options()),
+				connection, true, true, {} });
+		}
+	}
+
+	run_scan_jobs(jobs);
+
+	user_spec_devices_.clear();
+	for (const auto &job : jobs) {
+		if (job.user_spec && !job.found.empty())
+			user_spec_devices_.push_back(job.found.front());
+	}
+
+	// Forget the cached devices, that weren't found by the auto detection
+	if (do_scan && !all_reconnected) {
+		for (const auto &cached_spec : cached_specs) {
+			if (!has_device(cached_spec.first))
+				SettingsManager::remove_scan_spec(cached_spec.first);
+		}
+	}
+}
+
+void DeviceManager::run_scan_jobs(vector<ScanJob> &jobs)
+{
+	if (jobs.empty())
+		return;
+
+	unique_ptr<QProgressDialog> progress(new QProgressDialog(
+		QObject::tr("Scanning for devices..."), QObject::tr("Cancel"),
+		0, (int)jobs.size() + 1));
+	progress->setWindowModality(Qt::WindowModal);
+	progress->setMinimumDuration(1);  // To show the dialog immediately
+
+	/*
+	 * Most of the scan time is spent waiting for (serial) devices to
+	 * answer, so the scans run on a pool of threads. Jobs with the same
+	 * connection are never scanned at the same time, so two drivers never
+	 * probe the same port at the same time.
+	 */
+	auto state = std::make_shared<ScanState>();
+	for (const auto &job : jobs) {
+		state->tasks.push_back(ScanTask{ job.driver, job.options,
+			job.connection, ScanStatus::Pending, {}, {}, "" });
+	}
+
+	const size_t thread_count = std::min(jobs.size(),
+		std::max<size_t>(4, std::thread::hardware_concurrency()));
+	for (size_t i = 0; i < thread_count; ++i)
+		std::thread(scan_thread_proc, state).detach();
+
+	// Add the devices as their scans finish, while keeping the GUI alive
+	vector<bool> added(jobs.size(), false);
+	int done_count = 0;
+	bool finished = false;
+	while (!finished) {
+		vector<size_t> done_jobs;
+		{
+			unique_lock<std::mutex> lock(state->mutex);
+			state->cond.wait_for(lock, std::chrono::milliseconds(50));
+
+			const auto now = std::chrono::steady_clock::now();
+			finished = true;
+			for (size_t i = 0; i < jobs.size(); ++i) {
+				ScanTask &task = state->tasks[i];
+				if (task.status == ScanStatus::Running &&
+						now - task.start_time >
+						std::chrono::milliseconds(scan_timeout_)) {
+					// Abandon the scan and let the other scans go on. The
+					// connection stays busy until the driver returns, so
+					// the other jobs for it are not scanned at all.
+					task.status = ScanStatus::TimedOut;
+					if (!task.connection.empty()) {
+						for (auto &t : state->tasks) {
+							if (t.status == ScanStatus::Pending &&
+									t.connection == task.connection)
+								t.status = ScanStatus::Skipped;
+						}
+					}
+					std::thread(scan_thread_proc, state).detach();
+					state->cond.notify_all();
+				}
+
+				if (task.status == ScanStatus::Running ||
+						(task.status == ScanStatus::Pending && !state->canceled))
+					finished = false;
+				else if (task.status != ScanStatus::Pending && !added[i])
+					done_jobs.push_back(i);
+			}
+		}
+
+		for (const size_t index : done_jobs) {
+			ScanJob &job = jobs[index];
+			ScanTask &task = state->tasks[index];
+			added[index] = true;
+			if (task.status == ScanStatus::TimedOut) {
+				qWarning() << "DeviceManager: Scanning for" <<
+					QString::fromStdString(job.driver->name()) <<
+					"timed out after" << scan_timeout_ << "ms";
+			}
+			else if (task.status == ScanStatus::Skipped) {
+				qWarning() << "DeviceManager: Skipped scanning for" <<
+					QString::fromStdString(job.driver->name()) <<
+					"on" << QString::fromStdString(job.connection) <<
+					"after a timed out scan of the same connection";
+			}
+			else {
+				if (!task.error.empty()) {
+					qWarning() << "DeviceManager: Scanning for" <<
+						QString::fromStdString(job.driver->name()) <<
+						"failed:" << QString::fromStdString(task.error);
+				}
+				job.found = add_scanned_devices(job.driver, job.options,
+					task.sr_devices, job.replace_devices);
+				task.sr_devices.clear();
+			}
+			progress->setValue(++done_count);
+			progress->setLabelText(
+				QObject::tr("Scanning for devices (%1 found)...").
+				arg(devices_.size()));
+		}
 
-			list< shared_ptr<devices::HardwareDevice> > found =
-				driver_scan(user_drv_name, user_drv_opts);
-			if (!found.empty())
-				user_spec_devices_.push_back(found.front());
+		QApplication::processEvents();
+		if (progress->wasCanceled()) {
+			lock_guard<std::mutex> lock(state->mutex);
+			state->canceled = true;
+			state->cond.notify_all();
 		}
 	}
-	progress->setValue(entry_num++);
+
+	progress->setValue((int)jobs.size() + 1);
+}
+
+string DeviceManager::auto_scan_connection(
+	shared_ptr<sigrok::Driver> sr_driver)
+{
+	if (sr_driver->scan_options().count(sigrok::ConfigKey::CONN) > 0)
+		return any_connection_;
+	return "";
+}
+
+string DeviceManager::scan_connection(const vector<string> &user_spec)
+{
+	for (const auto &entry : user_spec) {
+		if (entry.compare(0, 5, "conn=") == 0)
+			return entry.substr(5);
+	}
+	return "";
 }
 
 const shared_ptr<sigrok::Context>& DeviceManager::context() const
@@ -153,6 +462,11 @@ DeviceManager::devices() const
 	return devices_;
 }
 
+unsigned int DeviceManager::generation() const
+{
+	return generation_;
+}
+
 /**
  * Get the device that was detected with user provided scan options.
  */
@@ -259,13 +573,42 @@ DeviceManager::driver_scan(
 	if (!devices::deviceutil::is_supported_driver(sr_driver))
 		return driver_devices;
 
+	// Do the scan
+	return add_scanned_devices(sr_driver, drvopts, sr_driver->scan(drvopts),
+		true);
+}
+
+list<shared_ptr<devices::HardwareDevice>>
+DeviceManager::run_driver_scan(
+	shared_ptr<sigrok::Driver> sr_driver,
+	const map<const sigrok::ConfigKey *, VariantBase> &drvopts)
+{
+	assert(sr_driver);
+
+	if (!devices::deviceutil::is_supported_driver(sr_driver))
+		return list<shared_ptr<devices::HardwareDevice>>();
+
+	vector<ScanJob> jobs;
+	jobs.push_back(ScanJob{ sr_driver, drvopts, "", true, true, {} });
+	run_scan_jobs(jobs);
+
+	return jobs.front().found;
+}
+
+list<shared_ptr<devices::HardwareDevice>>
+DeviceManager::add_scanned_devices(shared_ptr<sigrok::Driver> sr_driver,
+	const map<const sigrok::ConfigKey *, VariantBase> &drvopts,
+	const vector<shared_ptr<sigrok::HardwareDevice>> &sr_devices,
+	bool replace_devices)
+{
+	list< shared_ptr<devices::HardwareDevice> > driver_devices;
+
 	// Remove any device instances from this driver from the device
 	// list. They will not be valid after the scan.
-	devices_.remove_if([&](shared_ptr<devices::HardwareDevice> device) {
-		return device->sr_hardware_device()->driver() == sr_driver; });
-
-	// Do the scan
-	auto sr_devices = sr_driver->scan(drvopts);
+	if (replace_devices) {
+		devices_.remove_if([&](shared_ptr<devices::HardwareDevice> device) {
+			return device->sr_hardware_device()->driver() == sr_driver; });
+	}
 
 	// Add the scanned devices to the main list, set display names and sort.
 	for (const auto &sr_device : sr_devices) {
@@ -281,12 +624,69 @@ DeviceManager::driver_scan(
 
 	devices_.insert(devices_.end(), driver_devices.begin(),
 		driver_devices.end());
+	// The display names depend on the other devices
+	++generation_;
 	devices_.sort(bind(&DeviceManager::compare_devices, this, _1, _2));
 	driver_devices.sort(bind(&DeviceManager::compare_devices, this, _1, _2));
 
+	// Remember how to reconnect the devices on the next startup
+	for (const auto &device : driver_devices) {
+		const string spec = reconnect_spec(
+			sr_driver, drvopts, device->sr_hardware_device());
+		if (!spec.empty())
+			SettingsManager::save_scan_spec(device->settings_id(), spec);
+	}
+
 	return driver_devices;
 }
 
+string DeviceManager::reconnect_spec(shared_ptr<sigrok::Driver> sr_driver,
+	const map<const sigrok::ConfigKey *, VariantBase> &drvopts,
+	shared_ptr<sigrok::HardwareDevice> sr_device)
+{
+	string spec = sr_driver->name();
+
+	// Drivers without a conn option can only scan for all their devices
+	if (sr_driver->scan_options().count(sigrok::ConfigKey::CONN) == 0)
+		return spec;
+
+	string conn;
+	string serialcomm;
+	for (const auto &drvopt : drvopts) {
+		if (!drvopt.second.is_of_type(Glib::VARIANT_TYPE_STRING))
+			continue;
+		const string value = Glib::VariantBase::cast_dynamic<
+			Glib::Variant<Glib::ustring>>(drvopt.second).get().raw();
+		if (drvopt.first == sigrok::ConfigKey::CONN)
+			conn = value;
+		else if (drvopt.first == sigrok::ConfigKey::SERIALCOMM)
+			serialcomm = value;
+	}
+	if (conn.empty())
+		conn = sr_device->connection_id();
+
+	// The spec is split at ':'
+	if (conn.empty() || conn.find(':') != string::npos ||
+			serialcomm.find(':') != string::npos)
+		return "";
+
+	spec += ":conn=" + conn;
+	if (!serialcomm.empty())
+		spec += ":serialcomm=" + serialcomm;
+	return spec;
+}
+
+bool DeviceManager::has_device(const QString &settings_id) const
+{
+	const string id = SettingsManager::format_key(settings_id.toStdString());
+	for (const auto &device : devices_) {
+		if (SettingsManager::format_key(
+				device->settings_id().toStdString()) == id)
+			return true;
+	}
+	return false;
+}
+
 map<string, string> DeviceManager::get_device_info(
 	shared_ptr<devices::BaseDevice> device)
 {
@@ -21,6 +21,7 @@
 #ifndef DEVICEMANAGER_HPP
 #define DEVICEMANAGER_HPP
 
+#include <atomic>
 #include <list>
 #include <map>
 #include <memory>
@@ -28,6 +29,8 @@
 #include <string>
 #include <vector>
 
+#include <QString>
+
 using std::list;
 using std::map;
 using std::set;
@@ -43,6 +46,7 @@ namespace sigrok {
 class ConfigKey;
 class Context;
 class Driver;
+class HardwareDevice;
 }
 
 namespace sv {
@@ -66,6 +70,12 @@ public:
 	shared_ptr<sigrok::Context> context();
 
 	const list<shared_ptr<devices::HardwareDevice>> &devices() const;
+	/**
+	 * Return a counter, that is incremented whenever devices are added or
+	 * removed. Cached display names are rebuilt, when it has changed, see
+	 * HardwareDevice::display_name().
+	 */
+	unsigned int generation() const;
 	list<shared_ptr<devices::HardwareDevice>> user_spec_devices() const;
 
 	list<shared_ptr<devices::HardwareDevice>> driver_scan(
@@ -75,6 +85,15 @@ public:
 		shared_ptr<sigrok::Driver> sr_driver,
 		const map<const sigrok::ConfigKey *, Glib::VariantBase> &drvopts);
 
+	/**
+	 * Scan like driver_scan(), but in a scan thread with a progress dialog
+	 * and the scan timeout, so the GUI stays responsive. Must be called from
+	 * the GUI thread.
+	 */
+	list<shared_ptr<devices::HardwareDevice>> run_driver_scan(
+		shared_ptr<sigrok::Driver> sr_driver,
+		const map<const sigrok::ConfigKey *, Glib::VariantBase> &drvopts);
+
 	map<string, string> get_device_info(
 		const shared_ptr<devices::BaseDevice> device);
 
@@ -82,6 +101,51 @@ public:
 		const map<string, string> &search_info);
 
 private:
+	/** A driver scan of the startup, see run_scan_jobs(). */
+	struct ScanJob;
+
+	/**
+	 * Run the scans on a pool of scan threads and add the found devices as
+	 * the scans finish. A progress dialog is shown meanwhile, canceling it
+	 * skips the scans, that are not running yet. A scan, that doesn't finish
+	 * within scan_timeout_, is abandoned and its devices are dropped.
+	 */
+	void run_scan_jobs(vector<ScanJob> &jobs);
+
+	/**
+	 * Return the connection of an auto detecting scan: Drivers with a conn
+	 * option probe generic ports (e.g. all USB-TMC devices) and get
+	 * any_connection_, the other drivers only probe their own devices.
+	 */
+	static string auto_scan_connection(shared_ptr<sigrok::Driver> sr_driver);
+
+	/**
+	 * Add the devices of a driver scan to the device list and optionally
+	 * replace the devices of the previous scans of the driver.
+	 *
+	 * @return The added devices.
+	 */
+	list<shared_ptr<devices::HardwareDevice>> add_scanned_devices(
+		shared_ptr<sigrok::Driver> sr_driver,
+		const map<const sigrok::ConfigKey *, Glib::VariantBase> &drvopts,
+		const vector<shared_ptr<sigrok::HardwareDevice>> &sr_devices,
+		bool replace_devices);
+
+	/**
+	 * Return the driver spec, that reconnects a device on the next startup,
+	 * or "" if the device can't be reconnected directly. The spec has the
+	 * format of the -d option and is saved to the scan cache.
+	 */
+	static string reconnect_spec(shared_ptr<sigrok::Driver> sr_driver,
+		const map<const sigrok::ConfigKey *, Glib::VariantBase> &drvopts,
+		shared_ptr<sigrok::HardwareDevice> sr_device);
+
+	/** Return true if a device with the settings id was found. */
+	bool has_device(const QString &settings_id) const;
+
+	/** Return the value of the conn option of a user spec or "". */
+	static string scan_connection(const vector<string> &user_spec);
+
 	bool compare_devices(shared_ptr<devices::BaseDevice> a,
 		shared_ptr<devices::BaseDevice> b);
 
@@ -89,10 +153,16 @@ private:
 	driver_scan_options(const vector<string> &user_spec,
 		set<const sigrok::ConfigKey *> driver_opts);
 
+	/** The connection of scans, that may probe any port. */
+	static const string any_connection_;
+	/** The time in ms after a scan is abandoned. */
+	static const unsigned int scan_timeout_;
+
 protected:
 	shared_ptr<sigrok::Context> context_;
 	list<shared_ptr<devices::HardwareDevice>> devices_;
 	list<shared_ptr<devices::HardwareDevice>> user_spec_devices_;
+	std::atomic<unsigned int> generation_;
 
 };
 
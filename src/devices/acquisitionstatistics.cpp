@@ -0,0 +1,168 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "acquisitionstatistics.hpp"
+#include "src/session.hpp"
+
+using std::vector;
+
+namespace sv {
+namespace devices {
+
+const int64_t AcquisitionStatistics::rate_interval_ns_ = 1000000000;
+
+AcquisitionStatistics::AcquisitionStatistics()
+{
+	reset();
+}
+
+void AcquisitionStatistics::add_packet(size_t sample_count,
+	int64_t time_ns, int64_t feed_time_ns)
+{
+	packet_count_.fetch_add(1, std::memory_order_relaxed);
+	sample_count_.fetch_add(sample_count, std::memory_order_relaxed);
+	feed_time_ns_.fetch_add(feed_time_ns, std::memory_order_relaxed);
+	// Only the datafeed writes the maximum, so no CAS loop is needed
+	if (feed_time_ns > max_feed_time_ns_.load(std::memory_order_relaxed))
+		max_feed_time_ns_.store(feed_time_ns, std::memory_order_relaxed);
+
+	if (window_start_ns_ < 0)
+		window_start_ns_ = time_ns;
+	++window_packet_count_;
+	window_sample_count_ += sample_count;
+	const int64_t elapsed_ns = time_ns - window_start_ns_;
+	if (elapsed_ns >= rate_interval_ns_) {
+		const double elapsed = (double)elapsed_ns / 1e9;
+		packets_per_second_.store((double)window_packet_count_ / elapsed,
+			std::memory_order_relaxed);
+		samples_per_second_.store((double)window_sample_count_ / elapsed,
+			std::memory_order_relaxed);
+		rate_time_ns_.store(time_ns, std::memory_order_relaxed);
+		window_start_ns_ = time_ns;
+		window_packet_count_ = 0;
+		window_sample_count_ = 0;
+	}
+}
+
+void AcquisitionStatistics::add_dropped_packet(size_t sample_count)
+{
+	dropped_packet_count_.fetch_add(1, std::memory_order_relaxed);
+	dropped_sample_count_.fetch_add(sample_count, std::memory_order_relaxed);
+}
+
+void AcquisitionStatistics::add_out_of_order_packet()
+{
+	out_of_order_packet_count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void AcquisitionStatistics::add_allocations(uint64_t allocations,
+	uint64_t allocated_bytes)
+{
+	if (allocations == 0)
+		return;
+	allocation_count_.fetch_add(allocations, std::memory_order_relaxed);
+	allocated_bytes_.fetch_add(allocated_bytes, std::memory_order_relaxed);
+}
+
+void AcquisitionStatistics::add_latency(int64_t latency_ns)
+{
+	size_t bucket = 0;
+	for (int64_t limit_ns = 1000; latency_ns >= limit_ns &&
+			bucket < latency_bucket_count - 1; limit_ns *= 2)
+		++bucket;
+	latency_histogram_[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+AcquisitionSummary AcquisitionStatistics::summary() const
+{
+	AcquisitionSummary summary;
+	// The rates are stale, when no packet was received for some intervals
+	const int64_t rate_time_ns = rate_time_ns_.load(std::memory_order_relaxed);
+	if (rate_time_ns >= 0 &&
+			Session::session_time_ns() - rate_time_ns < 2 * rate_interval_ns_) {
+		summary.packets_per_second =
+			packets_per_second_.load(std::memory_order_relaxed);
+		summary.samples_per_second =
+			samples_per_second_.load(std::memory_order_relaxed);
+	}
+	else {
+		summary.packets_per_second = 0.;
+		summary.samples_per_second = 0.;
+	}
+	summary.packet_count = packet_count_.load(std::memory_order_relaxed);
+	summary.sample_count = sample_count_.load(std::memory_order_relaxed);
+	summary.dropped_packet_count =
+		dropped_packet_count_.load(std::memory_order_relaxed);
+	summary.dropped_sample_count =
+		dropped_sample_count_.load(std::memory_order_relaxed);
+	summary.out_of_order_packet_count =
+		out_of_order_packet_count_.load(std::memory_order_relaxed);
+	summary.allocation_count =
+		allocation_count_.load(std::memory_order_relaxed);
+	summary.allocated_bytes = allocated_bytes_.load(std::memory_order_relaxed);
+	summary.feed_time =
+		(double)feed_time_ns_.load(std::memory_order_relaxed) / 1e9;
+	summary.max_feed_time =
+		(double)max_feed_time_ns_.load(std::memory_order_relaxed) / 1e9;
+	summary.queue_depth = 0;
+	summary.queue_high_water = 0;
+	summary.latency_histogram.reserve(latency_bucket_count);
+	for (size_t i = 0; i < latency_bucket_count; ++i) {
+		summary.latency_histogram.push_back(
+			latency_histogram_[i].load(std::memory_order_relaxed));
+	}
+	return summary;
+}
+
+void AcquisitionStatistics::reset()
+{
+	packet_count_ = 0;
+	sample_count_ = 0;
+	dropped_packet_count_ = 0;
+	dropped_sample_count_ = 0;
+	out_of_order_packet_count_ = 0;
+	allocation_count_ = 0;
+	allocated_bytes_ = 0;
+	feed_time_ns_ = 0;
+	max_feed_time_ns_ = 0;
+	for (size_t i = 0; i < latency_bucket_count; ++i)
+		latency_histogram_[i] = 0;
+	packets_per_second_ = 0.;
+	samples_per_second_ = 0.;
+	rate_time_ns_ = -1;
+	window_start_ns_ = -1;
+	window_packet_count_ = 0;
+	window_sample_count_ = 0;
+}
+
+double AcquisitionStatistics::latency_bucket_limit(size_t bucket)
+{
+	if (bucket >= latency_bucket_count - 1)
+		return std::numeric_limits<double>::infinity();
+	return (double)((int64_t)1000 << bucket) / 1e9;
+}
+
+} // namespace devices
+} // namespace sv
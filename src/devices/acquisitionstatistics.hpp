@@ -0,0 +1,143 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEVICES_ACQUISITIONSTATISTICS_HPP
+#define DEVICES_ACQUISITIONSTATISTICS_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using std::vector;
+
+namespace sv {
+namespace devices {
+
+/**
+ * A snapshot of the acquisition statistics of a device.
+ */
+struct AcquisitionSummary
+{
+	/** The rates of the last second, 0 while the device doesn't send. */
+	double packets_per_second;
+	double samples_per_second;
+	uint64_t packet_count;
+	uint64_t sample_count;
+	/** The packets (and their samples), that were lost by an overrun. */
+	uint64_t dropped_packet_count;
+	uint64_t dropped_sample_count;
+	/** The packets with a timestamp before the previous packet. */
+	uint64_t out_of_order_packet_count;
+	/**
+	 * The heap allocations (and their bytes), while the packets were
+	 * received and stored, see AllocationCounter.
+	 */
+	uint64_t allocation_count;
+	uint64_t allocated_bytes;
+	/** The time in seconds, that was spent in the datafeed callback. */
+	double feed_time;
+	double max_feed_time;
+	/** The packets, that are waiting to be stored. */
+	size_t queue_depth;
+	size_t queue_high_water;
+	/**
+	 * The number of packets per latency from the datafeed callback until
+	 * the samples were stored, see AcquisitionStatistics::latency_bucket_limit().
+	 */
+	vector<uint64_t> latency_histogram;
+};
+
+/**
+ * The acquisition counters of a device. The datafeed and the ingest thread
+ * update the counters lock-free, any thread can read a summary() at any
+ * time.
+ */
+class AcquisitionStatistics
+{
+public:
+	AcquisitionStatistics();
+
+	AcquisitionStatistics(const AcquisitionStatistics &) = delete;
+	AcquisitionStatistics &operator=(const AcquisitionStatistics &) = delete;
+
+	/**
+	 * Count a packet, that was received by the datafeed callback at the
+	 * session time time_ns and handled in feed_time_ns. Must only be called
+	 * by the datafeed.
+	 */
+	void add_packet(size_t sample_count, int64_t time_ns, int64_t feed_time_ns);
+	void add_dropped_packet(size_t sample_count);
+	void add_out_of_order_packet();
+	/** Count the allocations of the datafeed or the ingest thread. */
+	void add_allocations(uint64_t allocations, uint64_t allocated_bytes);
+	/**
+	 * Count the time from receiving a packet until its samples were stored.
+	 */
+	void add_latency(int64_t latency_ns);
+
+	/**
+	 * Return the summary of all counters. Queue depth and high water are
+	 * not known here and left at 0.
+	 */
+	AcquisitionSummary summary() const;
+
+	/** Must not be called, while the device is acquiring. */
+	void reset();
+
+	/** The number of buckets of the latency histogram. */
+	static const size_t latency_bucket_count = 24;
+
+	/**
+	 * Return the upper limit in seconds of the latency bucket. Bucket 0
+	 * counts latencies below 1 us, every following bucket doubles the
+	 * limit. The last bucket counts all latencies above.
+	 */
+	static double latency_bucket_limit(size_t bucket);
+
+private:
+	/** The interval, in which the rates are calculated. */
+	static const int64_t rate_interval_ns_;
+
+	std::atomic<uint64_t> packet_count_;
+	std::atomic<uint64_t> sample_count_;
+	std::atomic<uint64_t> dropped_packet_count_;
+	std::atomic<uint64_t> dropped_sample_count_;
+	std::atomic<uint64_t> out_of_order_packet_count_;
+	std::atomic<uint64_t> allocation_count_;
+	std::atomic<uint64_t> allocated_bytes_;
+	std::atomic<int64_t> feed_time_ns_;
+	std::atomic<int64_t> max_feed_time_ns_;
+	std::atomic<uint64_t> latency_histogram_[latency_bucket_count];
+
+	/** The rates and the session time, when they were calculated. */
+	std::atomic<double> packets_per_second_;
+	std::atomic<double> samples_per_second_;
+	std::atomic<int64_t> rate_time_ns_;
+	/** Only used by the datafeed. */
+	int64_t window_start_ns_;
+	uint64_t window_packet_count_;
+	uint64_t window_sample_count_;
+
+};
+
+} // namespace devices
+} // namespace sv
+
+#endif // DEVICES_ACQUISITIONSTATISTICS_HPP
@@ -19,6 +19,7 @@
  */
 
 #include <cassert>
+#include <cmath>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -31,19 +32,38 @@
 
 #include <QDebug>
 #include <QString>
+#include <QThread>
 #include <QUuid>
 
 #include "basedevice.hpp"
 #include "src/session.hpp"
 #include "src/settingsmanager.hpp"
+#include "src/tracer.hpp"
 #include "src/util.hpp"
+#include "src/workerpool.hpp"
+#include "src/channels/acpowerchannel.hpp"
 #include "src/channels/basechannel.hpp"
+#include "src/channels/calibrationchannel.hpp"
+#include "src/channels/emachannel.hpp"
+#include "src/channels/expressionchannel.hpp"
 #include "src/channels/hardwarechannel.hpp"
 #include "src/channels/mathchannel.hpp"
+#include "src/channels/minmaxholdchannel.hpp"
+#include "src/channels/movingmedianchannel.hpp"
+#include "src/channels/pluginchannel.hpp"
+#include "src/channels/resamplechannel.hpp"
+#include "src/channels/rmschannel.hpp"
 #include "src/channels/userchannel.hpp"
+#include "src/data/analogtimesignal.hpp"
 #include "src/data/basesignal.hpp"
+#include "src/data/expression.hpp"
+#include "src/data/sessioncheckpoint.hpp"
+#include "src/data/properties/baseproperty.hpp"
 #include "src/devices/configurable.hpp"
 #include "src/devices/deviceutil.hpp"
+#include "src/devices/threadpolicy.hpp"
+#include "src/plugins/pluginmanager.hpp"
+#include "src/plugins/smuviewplugin.h"
 
 #define USER_CHANNEL_START_INDEX 1000
 #define CONFIGURABLE_START_INDEX 5000
@@ -71,7 +91,12 @@ BaseDevice::BaseDevice(const shared_ptr<sigrok::Context> sr_context,
 	is_open_(false),
 	next_channel_index_(USER_CHANNEL_START_INDEX),
 	next_configurable_index_(CONFIGURABLE_START_INDEX),
-	frame_began_(false)
+	aquisition_state_(AquisitionState::Stopped),
+	armed_start_timestamp_(0.),
+	timestamp_offset_(0.),
+	frame_began_(false),
+	thread_policy_generation_(0),
+	applied_thread_policy_generation_(0)
 {
 	// Set up a sigrok session per smuvierw device
 	sr_session_ = sv::Session::sr_context->create_session();
@@ -157,6 +182,9 @@ void BaseDevice::open()
 	this->init_configurables();
 	// Init all channels
 	this->init_channels();
+	// Continue the signals of a resumed checkpoint
+	if (Session::checkpoint)
+		Session::checkpoint->restore_device(shared_from_this());
 	// Init aquisition
 	this->init_acquisition();
 
@@ -214,6 +242,62 @@ void BaseDevice::pause_aquisition()
 	aquisition_state_ = AquisitionState::Paused;
 }
 
+void BaseDevice::arm_aquisition(double start_timestamp)
+{
+	armed_start_timestamp_ = start_timestamp;
+	aquisition_state_ = AquisitionState::Armed;
+}
+
+AquisitionState BaseDevice::aquisition_state()
+{
+	return aquisition_state_;
+}
+
+void BaseDevice::set_timestamp_offset(double timestamp_offset)
+{
+	timestamp_offset_ = timestamp_offset;
+}
+
+double BaseDevice::timestamp_offset() const
+{
+	return timestamp_offset_;
+}
+
+bool BaseDevice::is_recording()
+{
+	AquisitionState state = aquisition_state_.load(std::memory_order_relaxed);
+	if (state == AquisitionState::Armed &&
+			Session::timestamp() - timestamp_offset_ >=
+				armed_start_timestamp_) {
+		// Another thread may have paused the device in the meantime
+		aquisition_state_.compare_exchange_strong(state,
+			AquisitionState::Running);
+		state = aquisition_state_;
+	}
+	return state == AquisitionState::Running;
+}
+
+void BaseDevice::set_acquisition_thread_policy(const ThreadPolicy &policy)
+{
+	if (policy.cpu >= thread_policy_cpu_count()) {
+		qWarning() << "BaseDevice::set_acquisition_thread_policy(): CPU" <<
+			policy.cpu << "is not available";
+		return;
+	}
+
+	lock_guard<mutex> lock(aquisition_mutex_);
+	if (policy == thread_policy_)
+		return;
+	thread_policy_ = policy;
+	thread_policy_generation_.fetch_add(1, std::memory_order_relaxed);
+}
+
+ThreadPolicy BaseDevice::acquisition_thread_policy() const
+{
+	lock_guard<mutex> lock(aquisition_mutex_);
+	return thread_policy_;
+}
+
 string BaseDevice::name() const
 {
 	string sep;
@@ -292,24 +376,25 @@ QString BaseDevice::short_name() const
 	return name;
 }
 
-map<string, shared_ptr<devices::Configurable>>
+const map<string, shared_ptr<devices::Configurable>> &
 	BaseDevice::configurable_map() const
 {
 	return configurable_map_;
 }
 
-map<string, shared_ptr<channels::BaseChannel>> BaseDevice::channel_map() const
+const map<string, shared_ptr<channels::BaseChannel>> &
+	BaseDevice::channel_map() const
 {
 	return channel_map_;
 }
 
-map<string, vector<shared_ptr<channels::BaseChannel>>>
+const map<string, vector<shared_ptr<channels::BaseChannel>>> &
 	BaseDevice::channel_group_map() const
 {
 	return channel_group_map_;
 }
 
-map<shared_ptr<sigrok::Channel>, shared_ptr<channels::BaseChannel>>
+const map<shared_ptr<sigrok::Channel>, shared_ptr<channels::BaseChannel>> &
 	BaseDevice::sr_channel_map() const
 {
 	return sr_channel_map_;
@@ -328,6 +413,47 @@ vector<shared_ptr<data::BaseSignal>> BaseDevice::signals() const
 	return signals;
 }
 
+void BaseDevice::move_objects_to_thread(QThread *thread)
+{
+	// Math channels already live in the worker pool and stay there
+	QThread *current_thread = QThread::currentThread();
+	auto move = [current_thread, thread](QObject *object) {
+		if (object && object->thread() == current_thread)
+			object->moveToThread(thread);
+	};
+
+	lock_guard<recursive_mutex> lock(data_mutex_);
+	move(this);
+	for (const auto &c_pair : configurable_map_) {
+		for (const auto &p_pair : c_pair.second->property_map())
+			move(p_pair.second.get());
+		move(c_pair.second.get());
+	}
+	for (const auto &ch_pair : channel_map_) {
+		for (const auto &signal_pair : ch_pair.second->signal_map()) {
+			for (const auto &signal : signal_pair.second)
+				move(signal.get());
+		}
+		move(ch_pair.second.get());
+	}
+}
+
+size_t BaseDevice::memory_size() const
+{
+	size_t size = 0;
+	for (const auto &ch_pair : channel_map_)
+		size += ch_pair.second->memory_size();
+	return size;
+}
+
+size_t BaseDevice::spilled_size() const
+{
+	size_t size = 0;
+	for (const auto &ch_pair : channel_map_)
+		size += ch_pair.second->spilled_size();
+	return size;
+}
+
 unsigned int BaseDevice::next_channel_index()
 {
 	return next_channel_index_++;
@@ -367,7 +493,7 @@ shared_ptr<channels::BaseChannel> BaseDevice::add_sr_channel(
 	// NOTE: Channel names are unique per device.
 	shared_ptr<channels::BaseChannel> channel;
 	if (channel_map_.count(sr_channel->name()) > 0) {
-		channel = channel_map()[sr_channel->name()];
+		channel = channel_map_[sr_channel->name()];
 	}
 	else {
 		set<string> chg_names { channel_group_name };
@@ -397,6 +523,221 @@ void BaseDevice::add_math_channel(
 		math_channel->quantity(),
 		math_channel->quantity_flags(),
 		math_channel->unit());
+	if (Session::checkpoint)
+		Session::checkpoint->restore_math_channel(math_channel);
+
+	// Calculate the math channel in a worker thread. The signal of the math
+	// channel stays in this thread and notifies the GUI about the results.
+	// A channel, that is calculated from other math channels, goes to the
+	// worker of its first source channel, so the chain is evaluated in one
+	// go, while independent chains are calculated in parallel.
+	auto source_channels = math_channel->source_channels();
+	if (Session::worker_pool) {
+		if (source_channels.empty() ||
+				!Session::worker_pool->move_to_worker_of(
+					math_channel.get(), source_channels[0].get()))
+			Session::worker_pool->move_to_worker(math_channel.get());
+	}
+	for (const auto &source_channel : source_channels)
+		source_channel->add_dependent(math_channel);
+}
+
+shared_ptr<channels::MathChannel> BaseDevice::add_ema_channel(
+	shared_ptr<data::AnalogTimeSignal> signal, double time_constant,
+	const string &channel_name, const string &channel_group_name)
+{
+	auto quantity_flags = signal->quantity_flags();
+	quantity_flags.insert(data::QuantityFlag::Avg);
+	auto channel = make_shared<channels::EmaChannel>(
+		signal->quantity(), quantity_flags, signal->unit(),
+		signal, time_constant,
+		shared_from_this(), set<string> { channel_group_name }, channel_name,
+		signal->signal_start_timestamp());
+	add_math_channel(channel, channel_group_name);
+
+	return channel;
+}
+
+shared_ptr<channels::MathChannel> BaseDevice::add_moving_median_channel(
+	shared_ptr<data::AnalogTimeSignal> signal, uint window_sample_count,
+	const string &channel_name, const string &channel_group_name)
+{
+	auto channel = make_shared<channels::MovingMedianChannel>(
+		signal->quantity(), signal->quantity_flags(), signal->unit(),
+		signal, window_sample_count,
+		shared_from_this(), set<string> { channel_group_name }, channel_name,
+		signal->signal_start_timestamp());
+	add_math_channel(channel, channel_group_name);
+
+	return channel;
+}
+
+shared_ptr<channels::MathChannel> BaseDevice::add_min_max_hold_channel(
+	shared_ptr<data::AnalogTimeSignal> signal, channels::MinMaxHoldType type,
+	uint window_sample_count,
+	const string &channel_name, const string &channel_group_name)
+{
+	auto quantity_flags = signal->quantity_flags();
+	if (type == channels::MinMaxHoldType::Min)
+		quantity_flags.insert(data::QuantityFlag::Min);
+	else
+		quantity_flags.insert(data::QuantityFlag::Max);
+	if (window_sample_count == 0)
+		quantity_flags.insert(data::QuantityFlag::Hold);
+	auto channel = make_shared<channels::MinMaxHoldChannel>(
+		signal->quantity(), quantity_flags, signal->unit(),
+		signal, type, window_sample_count,
+		shared_from_this(), set<string> { channel_group_name }, channel_name,
+		signal->signal_start_timestamp());
+	add_math_channel(channel, channel_group_name);
+
+	return channel;
+}
+
+shared_ptr<channels::MathChannel> BaseDevice::add_rms_channel(
+	shared_ptr<data::AnalogTimeSignal> signal, uint window_sample_count,
+	const string &channel_name, const string &channel_group_name)
+{
+	auto quantity_flags = signal->quantity_flags();
+	quantity_flags.insert(data::QuantityFlag::RMS);
+	auto channel = make_shared<channels::RmsChannel>(
+		signal->quantity(), quantity_flags, signal->unit(),
+		signal, window_sample_count,
+		shared_from_this(), set<string> { channel_group_name }, channel_name,
+		signal->signal_start_timestamp());
+	add_math_channel(channel, channel_group_name);
+
+	return channel;
+}
+
+shared_ptr<channels::MathChannel> BaseDevice::add_resample_channel(
+	shared_ptr<data::AnalogTimeSignal> signal, double rate,
+	channels::ResampleMethod method,
+	const string &channel_name, const string &channel_group_name)
+{
+	if (!(rate > 0) || !std::isfinite(rate)) {
+		qWarning() << "BaseDevice::add_resample_channel(): Invalid rate" <<
+			rate;
+		return nullptr;
+	}
+	auto channel = make_shared<channels::ResampleChannel>(
+		signal->quantity(), signal->quantity_flags(), signal->unit(),
+		signal, rate, method,
+		shared_from_this(), set<string> { channel_group_name }, channel_name,
+		signal->signal_start_timestamp());
+	add_math_channel(channel, channel_group_name);
+
+	return channel;
+}
+
+shared_ptr<channels::MathChannel> BaseDevice::add_ac_power_channel(
+	shared_ptr<data::AnalogTimeSignal> voltage_signal,
+	shared_ptr<data::AnalogTimeSignal> current_signal,
+	channels::AcPowerValue value, uint cycle_count,
+	const string &channel_name, const string &channel_group_name)
+{
+	if (!voltage_signal || !current_signal) {
+		qWarning() << "BaseDevice::add_ac_power_channel(): No voltage or" <<
+			"current signal";
+		return nullptr;
+	}
+	data::Quantity quantity;
+	set<data::QuantityFlag> quantity_flags;
+	data::Unit unit;
+	channels::AcPowerChannel::value_quantity(value,
+		voltage_signal, current_signal, quantity, quantity_flags, unit);
+
+	double start_timestamp = voltage_signal->signal_start_timestamp();
+	if (current_signal->signal_start_timestamp() < start_timestamp)
+		start_timestamp = current_signal->signal_start_timestamp();
+
+	auto channel = make_shared<channels::AcPowerChannel>(
+		quantity, quantity_flags, unit,
+		voltage_signal, current_signal, value, cycle_count,
+		shared_from_this(), set<string> { channel_group_name }, channel_name,
+		start_timestamp);
+	add_math_channel(channel, channel_group_name);
+
+	return channel;
+}
+
+shared_ptr<channels::MathChannel> BaseDevice::add_calibration_channel(
+	shared_ptr<data::AnalogTimeSignal> signal,
+	shared_ptr<data::CalibrationCurve> curve,
+	data::Quantity quantity,
+	const set<data::QuantityFlag> &quantity_flags, data::Unit unit,
+	const string &channel_name, const string &channel_group_name)
+{
+	if (!signal || !curve) {
+		qWarning() << "BaseDevice::add_calibration_channel(): No signal or" <<
+			"calibration curve";
+		return nullptr;
+	}
+	auto channel = make_shared<channels::CalibrationChannel>(
+		quantity, quantity_flags, unit, signal, curve,
+		shared_from_this(), set<string> { channel_group_name }, channel_name,
+		signal->signal_start_timestamp());
+	add_math_channel(channel, channel_group_name);
+
+	return channel;
+}
+
+shared_ptr<channels::MathChannel> BaseDevice::add_expression_channel(
+	const vector<shared_ptr<data::AnalogTimeSignal>> &signals,
+	const string &expression, data::Quantity quantity,
+	const set<data::QuantityFlag> &quantity_flags, data::Unit unit,
+	const string &channel_name, const string &channel_group_name)
+{
+	if (signals.empty()) {
+		qWarning() << "BaseDevice::add_expression_channel(): No signals";
+		return nullptr;
+	}
+	data::Expression checked_expression;
+	if (!checked_expression.compile(expression, signals.size())) {
+		qWarning() << "BaseDevice::add_expression_channel(): " <<
+			QString::fromStdString(checked_expression.error());
+		return nullptr;
+	}
+
+	auto channel = make_shared<channels::ExpressionChannel>(
+		quantity, quantity_flags, unit,
+		signals, expression,
+		shared_from_this(), set<string> { channel_group_name }, channel_name,
+		signals[0]->signal_start_timestamp());
+	add_math_channel(channel, channel_group_name);
+
+	return channel;
+}
+
+shared_ptr<channels::MathChannel> BaseDevice::add_plugin_channel(
+	const vector<shared_ptr<data::AnalogTimeSignal>> &signals,
+	const string &processor_id, const string &args,
+	data::Quantity quantity,
+	const set<data::QuantityFlag> &quantity_flags, data::Unit unit,
+	const string &channel_name, const string &channel_group_name)
+{
+	if (signals.empty()) {
+		qWarning() << "BaseDevice::add_plugin_channel(): No signals";
+		return nullptr;
+	}
+	const sv_math_processor *processor =
+		plugins::PluginManager::find_math_processor(processor_id);
+	if (!processor) {
+		qWarning() << "BaseDevice::add_plugin_channel(): Unknown math processor" <<
+			QString::fromStdString(processor_id);
+		return nullptr;
+	}
+
+	auto channel = make_shared<channels::PluginChannel>(
+		quantity, quantity_flags, unit,
+		signals, processor, args,
+		shared_from_this(), set<string> { channel_group_name }, channel_name,
+		signals[0]->signal_start_timestamp());
+	if (!channel->is_valid())
+		return nullptr;
+	add_math_channel(channel, channel_group_name);
+
+	return channel;
 }
 
 shared_ptr<channels::UserChannel> BaseDevice::add_user_channel(
@@ -425,6 +766,8 @@ void BaseDevice::init_acquisition()
 void BaseDevice::data_feed_in(shared_ptr<sigrok::Device> sr_device,
 	shared_ptr<sigrok::Packet> sr_packet)
 {
+	SV_TRACE_SCOPE("BaseDevice::data_feed_in");
+
 	/*
 	qWarning() << "data_feed_in(): sr_packet->type()->id() = "
 		<< sr_packet->type()->id();
@@ -439,6 +782,10 @@ void BaseDevice::data_feed_in(shared_ptr<sigrok::Device> sr_device,
 	if (sr_device != sr_device_)
 		return;
 
+	if (thread_policy_generation_.load(std::memory_order_relaxed) !=
+			applied_thread_policy_generation_)
+		update_acquisition_thread_policy();
+
 	switch (sr_packet->type()->id()) {
 	case SR_DF_HEADER:
 		//qWarning() << "data_feed_in(): SR_DF_HEADER";
@@ -458,7 +805,7 @@ void BaseDevice::data_feed_in(shared_ptr<sigrok::Device> sr_device,
 
 	case SR_DF_LOGIC:
 		//qWarning() << "data_feed_in(): SR_DF_LOGIC";
-		if (aquisition_state_ != AquisitionState::Running)
+		if (!is_recording())
 			return;
 
 		try {
@@ -471,7 +818,7 @@ void BaseDevice::data_feed_in(shared_ptr<sigrok::Device> sr_device,
 
 	case SR_DF_ANALOG:
 		//qWarning() << "data_feed_in(): SR_DF_ANALOG";
-		if (aquisition_state_ != AquisitionState::Running)
+		if (!is_recording())
 			return;
 
 		try {
@@ -507,8 +854,28 @@ void BaseDevice::data_feed_in(shared_ptr<sigrok::Device> sr_device,
 	}
 }
 
+void BaseDevice::update_acquisition_thread_policy()
+{
+	ThreadPolicy policy;
+	{
+		lock_guard<mutex> lock(aquisition_mutex_);
+		policy = thread_policy_;
+		applied_thread_policy_generation_ = thread_policy_generation_;
+	}
+	if (!apply_thread_policy(policy)) {
+		qWarning() << "BaseDevice: The thread policy of" << short_name() <<
+			"was not fully applied";
+	}
+}
+
 void BaseDevice::aquisition_thread_proc()
 {
+	SV_TRACE_THREAD_NAME("Acquisition " + short_name().toStdString());
+
+	// Devices, that have never changed the policy, stay untouched
+	if (thread_policy_generation_.load(std::memory_order_relaxed) != 0)
+		update_acquisition_thread_policy();
+
 	try {
 		sr_session_->start();
 	}
@@ -517,7 +884,10 @@ void BaseDevice::aquisition_thread_proc()
 		return;
 	}
 
-	aquisition_state_ = AquisitionState::Running;
+	// Keep an aquisition, that was armed or paused in the meantime
+	AquisitionState stopped = AquisitionState::Stopped;
+	aquisition_state_.compare_exchange_strong(stopped,
+		AquisitionState::Running);
 	/*
 	// TODO: use std::chrono / std::time
 	// NOTE: ATM only the session start timestamp is used!
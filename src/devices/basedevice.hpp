@@ -21,20 +21,28 @@
 #ifndef DEVICES_BASEDEVICE_HPP
 #define DEVICES_BASEDEVICE_HPP
 
+#include <atomic>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <set>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include <QObject>
 #include <QString>
 
+class QThread;
+
+#include "src/data/datautil.hpp"
 #include "src/devices/deviceutil.hpp"
+#include "src/devices/threadpolicy.hpp"
 
 using std::map;
 using std::mutex;
 using std::recursive_mutex;
+using std::set;
 using std::shared_ptr;
 using std::string;
 using std::vector;
@@ -55,13 +63,18 @@ namespace sv {
 class DeviceManager;
 
 namespace channels {
+enum class AcPowerValue;
 class BaseChannel;
 class MathChannel;
+enum class MinMaxHoldType;
+enum class ResampleMethod;
 class UserChannel;
 }
 
 namespace data {
+class AnalogTimeSignal;
 class BaseSignal;
+class CalibrationCurve;
 }
 
 namespace devices {
@@ -71,7 +84,9 @@ class Configurable;
 enum class AquisitionState {
 	Stopped,
 	Running,
-	Paused
+	Paused,
+	/** Waiting for the start timestamp, see arm_aquisition(). */
+	Armed
 };
 
 class BaseDevice :
@@ -149,11 +164,35 @@ public:
 	 */
 	virtual void pause_aquisition();
 
+	/**
+	 * Discard the samples until the device time (see timestamp_offset())
+	 * reaches start_timestamp and then start the aquisition. Used to start
+	 * several devices at the same time of the common session clock, see
+	 * Session::start_synchronized().
+	 */
+	void arm_aquisition(double start_timestamp);
+
 	/**
 	 * Get the aquisition state.
 	 */
 	AquisitionState aquisition_state();
 
+	/**
+	 * Set the latency of the device in seconds, e.g. the measurement and
+	 * transmission time of a DMM. It is subtracted from the timestamps of
+	 * the following samples, so the samples of different devices line up
+	 * on the common session clock. See Session::calibrate_time_offset().
+	 */
+	void set_timestamp_offset(double timestamp_offset);
+	double timestamp_offset() const;
+
+	/**
+	 * Set the priority and the CPU of the aquisition thread. A running
+	 * thread applies the policy with its next packet.
+	 */
+	void set_acquisition_thread_policy(const ThreadPolicy &policy);
+	ThreadPolicy acquisition_thread_policy() const;
+
 	/**
 	 * Get the next index for a new channel.
 	 */
@@ -178,6 +217,103 @@ public:
 	void add_math_channel(shared_ptr<channels::MathChannel> math_channel,
 		const string &channel_group_name);
 
+	/**
+	 * Add a math channel with the exponential moving average of signal,
+	 * see channels::EmaChannel.
+	 */
+	shared_ptr<channels::MathChannel> add_ema_channel(
+		shared_ptr<data::AnalogTimeSignal> signal, double time_constant,
+		const string &channel_name, const string &channel_group_name);
+
+	/**
+	 * Add a math channel with the moving median of signal, see
+	 * channels::MovingMedianChannel.
+	 */
+	shared_ptr<channels::MathChannel> add_moving_median_channel(
+		shared_ptr<data::AnalogTimeSignal> signal, uint window_sample_count,
+		const string &channel_name, const string &channel_group_name);
+
+	/**
+	 * Add a math channel with the rolling minimum or maximum of signal, see
+	 * channels::MinMaxHoldChannel.
+	 */
+	shared_ptr<channels::MathChannel> add_min_max_hold_channel(
+		shared_ptr<data::AnalogTimeSignal> signal, channels::MinMaxHoldType type,
+		uint window_sample_count,
+		const string &channel_name, const string &channel_group_name);
+
+	/**
+	 * Add a math channel with the moving RMS of signal, see
+	 * channels::RmsChannel.
+	 */
+	shared_ptr<channels::MathChannel> add_rms_channel(
+		shared_ptr<data::AnalogTimeSignal> signal, uint window_sample_count,
+		const string &channel_name, const string &channel_group_name);
+
+	/**
+	 * Add a math channel with signal resampled onto a uniform grid with
+	 * rate Hz, see channels::ResampleChannel.
+	 *
+	 * @return The new channel or nullptr if the rate is invalid.
+	 */
+	shared_ptr<channels::MathChannel> add_resample_channel(
+		shared_ptr<data::AnalogTimeSignal> signal, double rate,
+		channels::ResampleMethod method,
+		const string &channel_name, const string &channel_group_name);
+
+	/**
+	 * Add a math channel with a result of the AC power analysis of the
+	 * voltage and current signals over windows of cycle_count cycles, see
+	 * channels::AcPowerChannel. The quantity and the unit of the channel
+	 * are set by value.
+	 *
+	 * @return The new channel or nullptr if a signal is missing.
+	 */
+	shared_ptr<channels::MathChannel> add_ac_power_channel(
+		shared_ptr<data::AnalogTimeSignal> voltage_signal,
+		shared_ptr<data::AnalogTimeSignal> current_signal,
+		channels::AcPowerValue value, uint cycle_count,
+		const string &channel_name, const string &channel_group_name);
+
+	/**
+	 * Add a math channel with signal linearised by a calibration curve,
+	 * see channels::CalibrationChannel.
+	 *
+	 * @return The new channel or nullptr if there is no curve.
+	 */
+	shared_ptr<channels::MathChannel> add_calibration_channel(
+		shared_ptr<data::AnalogTimeSignal> signal,
+		shared_ptr<data::CalibrationCurve> curve,
+		data::Quantity quantity,
+		const set<data::QuantityFlag> &quantity_flags, data::Unit unit,
+		const string &channel_name, const string &channel_group_name);
+
+	/**
+	 * Add a math channel, that calculates expression over signals (v1 to
+	 * vN), see channels::ExpressionChannel.
+	 *
+	 * @return The new channel or nullptr if the expression is invalid.
+	 */
+	shared_ptr<channels::MathChannel> add_expression_channel(
+		const vector<shared_ptr<data::AnalogTimeSignal>> &signals,
+		const string &expression, data::Quantity quantity,
+		const set<data::QuantityFlag> &quantity_flags, data::Unit unit,
+		const string &channel_name, const string &channel_group_name);
+
+	/**
+	 * Add a math channel, that is calculated by the math processor of a
+	 * native plugin over signals, see channels::PluginChannel.
+	 *
+	 * @return The new channel or nullptr if the processor doesn't exist or
+	 *         doesn't accept the signals or arguments.
+	 */
+	shared_ptr<channels::MathChannel> add_plugin_channel(
+		const vector<shared_ptr<data::AnalogTimeSignal>> &signals,
+		const string &processor_id, const string &args,
+		data::Quantity quantity,
+		const set<data::QuantityFlag> &quantity_flags, data::Unit unit,
+		const string &channel_name, const string &channel_group_name);
+
 	/**
 	 * Add a user channel to the device
 	 */
@@ -187,28 +323,44 @@ public:
 	/**
 	 * Returns a map with all configurables of this device
 	 */
-	map<string, shared_ptr<devices::Configurable>> configurable_map() const;
+	const map<string, shared_ptr<devices::Configurable>> &configurable_map() const;
 
 	/**
 	 * Returns a map with all channels of this device
 	 */
-	map<string, shared_ptr<channels::BaseChannel>> channel_map() const;
+	const map<string, shared_ptr<channels::BaseChannel>> &channel_map() const;
 
 	/**
 	 * Returns a map with all channel groups of this device
 	 */
-	map<string, vector<shared_ptr<channels::BaseChannel>>> channel_group_map() const;
+	const map<string, vector<shared_ptr<channels::BaseChannel>>> &
+		channel_group_map() const;
 
 	/**
 	 * Get the map between sigrok::Channel and sv::Channels::BaseChannel
 	 */
-	map<shared_ptr<sigrok::Channel>, shared_ptr<channels::BaseChannel>> sr_channel_map() const;
+	const map<shared_ptr<sigrok::Channel>, shared_ptr<channels::BaseChannel>> &
+		sr_channel_map() const;
 
 	/**
 	 * Returns all signals of this device
 	 */
 	vector<shared_ptr<data::BaseSignal>> signals() const;
 
+	/**
+	 * Move the device and its configurables, properties, channels and
+	 * signals, that live in the calling thread, to the thread. Used when the
+	 * device was opened in a worker thread.
+	 */
+	void move_objects_to_thread(QThread *thread);
+
+	/**
+	 * Return the number of bytes, that are used by all signals of this
+	 * device in memory (memory_size()) and in spill files (spilled_size()).
+	 */
+	size_t memory_size() const;
+	size_t spilled_size() const;
+
 
 protected:
 	/**
@@ -255,15 +407,28 @@ protected:
 
 	mutable mutex aquisition_mutex_; //!< Protects access to capture_state_. // TODO
 	mutable recursive_mutex data_mutex_; // TODO
-	AquisitionState aquisition_state_;
+	std::atomic<AquisitionState> aquisition_state_;
 	double aquisition_start_timestamp_;
+	/** The start of an armed aquisition, see arm_aquisition(). */
+	std::atomic<double> armed_start_timestamp_;
+	std::atomic<double> timestamp_offset_;
 
 	bool frame_began_;
 
 private:
 	void aquisition_thread_proc();
+	/** Apply a changed thread policy. Only called in the aquisition thread. */
+	void update_acquisition_thread_policy();
+	/**
+	 * Return true if the samples are recorded. An armed aquisition is
+	 * started here, when its start timestamp has been reached.
+	 */
+	bool is_recording();
 
 	std::thread aquisition_thread_;
+	ThreadPolicy thread_policy_; //!< Protected by aquisition_mutex_.
+	std::atomic<unsigned int> thread_policy_generation_;
+	unsigned int applied_thread_policy_generation_;
 
 Q_SIGNALS:
 	void aquisition_start_timestamp_changed(double timestamp);
@@ -18,9 +18,11 @@
  */
 
 #include <cassert>
+#include <functional>
 #include <type_traits>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <utility>
@@ -33,6 +35,7 @@
 
 #include <QDebug>
 #include <QString>
+#include <QVariant>
 
 #include "configurable.hpp"
 #include "src/data/datautil.hpp"
@@ -46,8 +49,13 @@
 #include "src/data/properties/stringproperty.hpp"
 #include "src/data/properties/uint64property.hpp"
 #include "src/data/properties/uint64rangeproperty.hpp"
+#include "src/settingsmanager.hpp"
+#include "src/tracer.hpp"
+#include "src/devices/configworker.hpp"
+#include "src/devices/statemonitor.hpp"
 
 using std::dynamic_pointer_cast;
+using std::lock_guard;
 using std::make_pair;
 using std::make_shared;
 using std::pair;
@@ -56,6 +64,9 @@ using std::string;
 using std::vector;
 using sv::devices::ConfigKey;
 
+Q_DECLARE_METATYPE(sv::data::measured_quantity_t)
+Q_DECLARE_METATYPE(sv::data::rational_t)
+
 namespace sv {
 namespace devices {
 
@@ -63,12 +74,18 @@ Configurable::Configurable(
 		const shared_ptr<sigrok::Configurable> sr_configurable,
 		unsigned int configurable_index,
 		const string &device_name, const DeviceType device_type,
-		const QString &device_settings_id):
+		const QString &device_settings_id,
+		const string &list_cache_id,
+		shared_ptr<ConfigWorker> config_worker,
+		shared_ptr<StateMonitor> state_monitor):
 	sr_configurable_(sr_configurable),
 	index_(configurable_index),
 	device_name_(device_name),
 	device_type_(device_type),
-	device_settings_id_(device_settings_id)
+	device_settings_id_(device_settings_id),
+	list_cache_id_(list_cache_id),
+	config_worker_(config_worker),
+	state_monitor_(state_monitor)
 {
 }
 
@@ -172,6 +189,8 @@ template double Configurable::get_config(devices::ConfigKey) const;
 template std::string Configurable::get_config(devices::ConfigKey) const;
 template<typename T> T Configurable::get_config(devices::ConfigKey config_key) const
 {
+	SV_TRACE_SCOPE("Configurable::get_config");
+
 	assert(sr_configurable_);
 
 	const sigrok::ConfigKey *sr_key =
@@ -187,8 +206,12 @@ template<typename T> T Configurable::get_config(devices::ConfigKey config_key) c
 	/*
 	try {
 	*/
-		return Glib::VariantBase::cast_dynamic<Glib::Variant<T>>(
-			sr_configurable_->config_get(sr_key)).get();
+		T value;
+		execute_io([&]() {
+			value = Glib::VariantBase::cast_dynamic<Glib::Variant<T>>(
+				sr_configurable_->config_get(sr_key)).get();
+		});
+		return value;
 	/*
 	}
 	catch (sigrok::Error &error) {
@@ -220,7 +243,8 @@ Glib::VariantContainerBase Configurable::get_container_config(
 	/*
 	try {
 	*/
-	Glib::VariantBase gvar = sr_configurable_->config_get(sr_key);
+	Glib::VariantBase gvar;
+	execute_io([&]() { gvar = sr_configurable_->config_get(sr_key); });
 	if (gvar.is_container()) {
 		Glib::VariantContainerBase gcontainer =
 			Glib::VariantBase::cast_dynamic<Glib::VariantContainerBase>(gvar);
@@ -281,25 +305,10 @@ template void Configurable::set_config(devices::ConfigKey, const Glib::ustring);
 template<typename T> void Configurable::set_config(
 	devices::ConfigKey config_key, const T value)
 {
-	assert(sr_configurable_);
-
-	const sigrok::ConfigKey *sr_key =
-		devices::deviceutil::get_sr_config_key(config_key);
-
-	if (!sr_configurable_->config_check(sr_key, sigrok::Capability::SET)) {
-		qWarning() << "Configurable::set_config(): No setable config key " <<
-			devices::deviceutil::format_config_key(config_key);
-		assert(false);
-	}
-
-	try {
-		sr_configurable_->config_set(sr_key, Glib::Variant<T>::create(value));
-	}
-	catch (sigrok::Error &error) {
-		qWarning() << "Configurable::set_config(): Failed to set config key " <<
-			devices::deviceutil::format_config_key(config_key) << ". " <<
-			error.what();
-	}
+	const Glib::VariantBase gvar = Glib::Variant<T>::create(value);
+	execute_io([&]() {
+		write_config(config_key, gvar, "Configurable::set_config()");
+	});
 }
 
 void Configurable::set_container_config(
@@ -322,8 +331,10 @@ void Configurable::set_container_config(
 			"Configurable::set_container_config(): Set config key " <<
 			devices::deviceutil::format_config_key(config_key) << " to " <<
 			childs;
-		sr_configurable_->config_set(
-			sr_key, Glib::VariantContainerBase::create_tuple(childs));
+		execute_io([&]() {
+			sr_configurable_->config_set(
+				sr_key, Glib::VariantContainerBase::create_tuple(childs));
+		});
 	}
 	catch (sigrok::Error &error) {
 		qWarning() <<
@@ -341,21 +352,279 @@ void Configurable::set_measured_quantity_config(devices::ConfigKey config_key,
 		devices::deviceutil::format_config_key(config_key) << " to " <<
 		data::datautil::format_measured_quantity(mq);
 
+	this->set_container_config(config_key, measured_quantity_childs(mq));
+}
+
+vector<Glib::VariantBase> Configurable::measured_quantity_childs(
+	const data::measured_quantity_t &mq)
+{
 	uint32_t sr_q_id = data::datautil::get_sr_quantity_id(mq.first);
 	Glib::VariantBase gvar_q = Glib::Variant<uint32_t>::create(sr_q_id);
 	uint64_t sr_qfs_id = data::datautil::get_sr_quantity_flags_id(mq.second);
 	Glib::VariantBase gvar_qfs = Glib::Variant<uint64_t>::create(sr_qfs_id);
 
-	qWarning() <<
-		"Configurable::set_measured_quantity_config(): Set config key " <<
-		devices::deviceutil::format_config_key(config_key) << " to " <<
-		sr_q_id << ", " << sr_qfs_id;
-
 	vector<Glib::VariantBase> gcontainer;
 	gcontainer.push_back(gvar_q);
 	gcontainer.push_back(gvar_qfs);
+	return gcontainer;
+}
+
+template void Configurable::post_config(devices::ConfigKey, const bool,
+	std::function<void(bool)>);
+template void Configurable::post_config(devices::ConfigKey, const int32_t,
+	std::function<void(bool)>);
+template void Configurable::post_config(devices::ConfigKey, const uint64_t,
+	std::function<void(bool)>);
+template void Configurable::post_config(devices::ConfigKey, const double,
+	std::function<void(bool)>);
+template void Configurable::post_config(devices::ConfigKey, const std::string,
+	std::function<void(bool)>);
+template void Configurable::post_config(devices::ConfigKey, const Glib::ustring,
+	std::function<void(bool)>);
+template<typename T> void Configurable::post_config(
+	devices::ConfigKey config_key, const T value,
+	std::function<void(bool)> done)
+{
+	post_write(config_key, Glib::Variant<T>::create(value), done);
+}
+
+void Configurable::post_container_config(devices::ConfigKey config_key,
+	const vector<Glib::VariantBase> &childs, std::function<void(bool)> done)
+{
+	post_write(config_key, Glib::VariantContainerBase::create_tuple(childs),
+		done);
+}
+
+void Configurable::post_measured_quantity_config(
+	devices::ConfigKey config_key, const data::measured_quantity_t mq,
+	std::function<void(bool)> done)
+{
+	post_container_config(config_key, measured_quantity_childs(mq), done);
+}
+
+void Configurable::post_write(devices::ConfigKey config_key,
+	const Glib::VariantBase &gvar, std::function<void(bool)> done)
+{
+	if (!config_worker_) {
+		const bool ok =
+			write_config(config_key, gvar, "Configurable::post_config()");
+		if (done)
+			done(ok);
+		return;
+	}
+
+	// The device stops the worker, before its configurables are destroyed
+	config_worker_->post(this, config_key, [this, config_key, gvar]() {
+			return write_config(config_key, gvar,
+				"Configurable::post_config()");
+		}, done);
+}
+
+void Configurable::execute_io(const std::function<void()> &job) const
+{
+	if (config_worker_)
+		config_worker_->execute(job);
+	else
+		job();
+}
+
+template void Configurable::queue_config(devices::ConfigKey, const bool);
+template void Configurable::queue_config(devices::ConfigKey, const int32_t);
+template void Configurable::queue_config(devices::ConfigKey, const uint64_t);
+template void Configurable::queue_config(devices::ConfigKey, const double);
+template void Configurable::queue_config(devices::ConfigKey, const std::string);
+template void Configurable::queue_config(devices::ConfigKey, const Glib::ustring);
+template<typename T> void Configurable::queue_config(
+	devices::ConfigKey config_key, const T value)
+{
+	Glib::VariantBase gvar = Glib::Variant<T>::create(value);
+
+	lock_guard<std::mutex> lock(queue_mutex_);
+	for (auto &queued_config : queued_configs_) {
+		if (queued_config.first == config_key) {
+			queued_config.second = gvar;
+			return;
+		}
+	}
+	queued_configs_.push_back(make_pair(config_key, gvar));
+}
+
+size_t Configurable::flush_configs()
+{
+	lock_guard<std::mutex> flush_lock(flush_mutex_);
+
+	// Take the queue, so new writes can be queued while flushing
+	vector<pair<devices::ConfigKey, Glib::VariantBase>> configs;
+	{
+		lock_guard<std::mutex> lock(queue_mutex_);
+		configs.swap(queued_configs_);
+	}
+
+	// The writes are done in one job, so no other I/O is interleaved
+	size_t count = 0;
+	execute_io([&]() {
+		for (const auto &config : configs) {
+			if (write_config(config.first, config.second,
+					"Configurable::flush_configs()"))
+				++count;
+		}
+	});
+	return count;
+}
 
-	this->set_container_config(config_key, gcontainer);
+size_t Configurable::queued_config_count() const
+{
+	lock_guard<std::mutex> lock(queue_mutex_);
+	return queued_configs_.size();
+}
+
+map<devices::ConfigKey, QVariant> Configurable::get_configs(
+	const vector<devices::ConfigKey> &config_keys)
+{
+	SV_TRACE_SCOPE("Configurable::get_configs");
+
+	map<devices::ConfigKey, QVariant> values;
+	vector<shared_ptr<data::properties::BaseProperty>> read_properties;
+	for (const auto &config_key : config_keys) {
+		auto property = get_property(config_key);
+		if (!property || !property->is_getable()) {
+			qWarning() << "Configurable::get_configs(): No getable config key " <<
+				devices::deviceutil::format_config_key(config_key);
+			continue;
+		}
+		QVariant qvar;
+		if (property->cached_value(qvar))
+			values[config_key] = qvar;
+		else
+			read_properties.push_back(property);
+	}
+	if (read_properties.empty())
+		return values;
+
+	// The reads of the properties are executed directly in the worker
+	execute_io([&]() {
+		for (const auto &property : read_properties) {
+			QVariant qvar = property->poll_value();
+			if (qvar.isValid())
+				values[property->config_key()] = qvar;
+		}
+	});
+	return values;
+}
+
+size_t Configurable::set_configs(
+	const vector<pair<devices::ConfigKey, QVariant>> &configs)
+{
+	SV_TRACE_SCOPE("Configurable::set_configs");
+
+	// The configs, that can be written, and their variants
+	vector<size_t> indices;
+	vector<Glib::VariantBase> gvars;
+	for (size_t i = 0; i < configs.size(); ++i) {
+		Glib::VariantBase gvar;
+		if (!has_set_config(configs[i].first) ||
+				!to_variant(configs[i].first, configs[i].second, gvar)) {
+			qWarning() << "Configurable::set_configs(): No setable config key " <<
+				devices::deviceutil::format_config_key(configs[i].first);
+			continue;
+		}
+		indices.push_back(i);
+		gvars.push_back(gvar);
+	}
+
+	vector<bool> written(indices.size(), false);
+	execute_io([&]() {
+		for (size_t i = 0; i < indices.size(); ++i) {
+			written[i] = write_config(configs[indices[i]].first, gvars[i],
+				"Configurable::set_configs()");
+		}
+	});
+
+	size_t count = 0;
+	for (size_t i = 0; i < indices.size(); ++i) {
+		if (!written[i])
+			continue;
+		const auto &config = configs[indices[i]];
+		auto property = get_property(config.first);
+		if (property)
+			property->written_value(config.second);
+		++count;
+	}
+	return count;
+}
+
+bool Configurable::to_variant(devices::ConfigKey config_key,
+	const QVariant &qvar, Glib::VariantBase &gvar)
+{
+	vector<Glib::VariantBase> childs;
+	switch (deviceutil::get_data_type_for_config_key(config_key)) {
+	case data::DataType::Bool:
+		gvar = Glib::Variant<bool>::create(qvar.toBool());
+		return true;
+	case data::DataType::Int32:
+		gvar = Glib::Variant<int32_t>::create(qvar.toInt());
+		return true;
+	case data::DataType::UInt64:
+		gvar = Glib::Variant<uint64_t>::create(qvar.toULongLong());
+		return true;
+	case data::DataType::Double:
+		gvar = Glib::Variant<double>::create(qvar.toDouble());
+		return true;
+	case data::DataType::String:
+		gvar = Glib::Variant<std::string>::create(
+			qvar.toString().toStdString());
+		return true;
+	case data::DataType::MQ:
+		gvar = Glib::VariantContainerBase::create_tuple(
+			measured_quantity_childs(qvar.value<data::measured_quantity_t>()));
+		return true;
+	case data::DataType::DoubleRange: {
+		const auto range = qvar.value<data::double_range_t>();
+		childs.push_back(Glib::Variant<double>::create(range.first));
+		childs.push_back(Glib::Variant<double>::create(range.second));
+		gvar = Glib::VariantContainerBase::create_tuple(childs);
+		return true;
+	}
+	case data::DataType::RationalPeriod:
+	case data::DataType::RationalVolt:
+	case data::DataType::UInt64Range: {
+		const auto rational = qvar.value<data::rational_t>();
+		childs.push_back(Glib::Variant<uint64_t>::create(rational.first));
+		childs.push_back(Glib::Variant<uint64_t>::create(rational.second));
+		gvar = Glib::VariantContainerBase::create_tuple(childs);
+		return true;
+	}
+	default:
+		return false;
+	}
+}
+
+bool Configurable::write_config(devices::ConfigKey config_key,
+	const Glib::VariantBase &gvar, const char *caller)
+{
+	SV_TRACE_SCOPE("Configurable::write_config");
+
+	assert(sr_configurable_);
+
+	if (!has_set_config(config_key)) {
+		qWarning() << caller << ": No setable config key " <<
+			devices::deviceutil::format_config_key(config_key);
+		assert(false);
+		return false;
+	}
+
+	const sigrok::ConfigKey *sr_key =
+		devices::deviceutil::get_sr_config_key(config_key);
+	try {
+		sr_configurable_->config_set(sr_key, gvar);
+	}
+	catch (sigrok::Error &error) {
+		qWarning() << caller << ": Failed to set config key " <<
+			devices::deviceutil::format_config_key(config_key) << ". " <<
+			error.what();
+		return false;
+	}
+	return true;
 }
 
 bool Configurable::has_list_config(devices::ConfigKey config_key) const
@@ -366,6 +635,8 @@ bool Configurable::has_list_config(devices::ConfigKey config_key) const
 bool Configurable::list_config(devices::ConfigKey config_key,
 	Glib::VariantContainerBase &gvar)
 {
+	SV_TRACE_SCOPE("Configurable::list_config");
+
 	assert(sr_configurable_);
 
 	const sigrok::ConfigKey *sr_key =
@@ -378,8 +649,22 @@ bool Configurable::list_config(devices::ConfigKey config_key,
 		return false;
 	}
 
+	const string cache_key = name() + ":" + sr_key->identifier();
+	if (!list_cache_id_.empty()) {
+		const string list =
+			SettingsManager::restore_list_config(list_cache_id_, cache_key);
+		GVariant *cached_gvar = list.empty() ? nullptr :
+			g_variant_parse(nullptr, list.c_str(), nullptr, nullptr, nullptr);
+		if (cached_gvar && g_variant_is_container(cached_gvar)) {
+			gvar = Glib::VariantContainerBase(cached_gvar, false);
+			return true;
+		}
+		if (cached_gvar)
+			g_variant_unref(cached_gvar);
+	}
+
 	try {
-		gvar = sr_configurable_->config_list(sr_key);
+		execute_io([&]() { gvar = sr_configurable_->config_list(sr_key); });
 	}
 	catch (sigrok::Error &error) {
 		qWarning() << "Configurable::list_config(): Failed to list config key " <<
@@ -387,6 +672,11 @@ bool Configurable::list_config(devices::ConfigKey config_key,
 		return false;
 	}
 
+	if (!list_cache_id_.empty() && gvar.gobj()) {
+		SettingsManager::save_list_config(list_cache_id_, cache_key,
+			gvar.print(true));
+	}
+
 	return true;
 }
 
@@ -426,6 +716,11 @@ QString Configurable::device_settings_id() const
 	return device_settings_id_;
 }
 
+shared_ptr<StateMonitor> Configurable::state_monitor() const
+{
+	return state_monitor_;
+}
+
 set<devices::ConfigKey> Configurable::getable_configs() const
 {
 	return getable_configs_;
@@ -441,7 +736,7 @@ set<devices::ConfigKey> Configurable::listable_configs() const
 	return listable_configs_;
 }
 
-map<devices::ConfigKey, shared_ptr<data::properties::BaseProperty>>
+const map<devices::ConfigKey, shared_ptr<data::properties::BaseProperty>> &
 	Configurable::property_map() const
 {
 	return property_map_;
@@ -475,6 +770,8 @@ void Configurable::feed_in_meta(shared_ptr<sigrok::Meta> sr_meta)
 		}
 
 		property_map_[config_key]->on_value_changed(entry.second);
+		if (state_monitor_)
+			state_monitor_->notify_meta(this, config_key);
 
 		// TODO: return QVariant from prop->on_value_changed(); and emit
 		//Q_EMIT config_changed(config_key, qvar);
@@ -22,6 +22,8 @@
 
 #include <map>
 #include <memory>
+#include <functional>
+#include <mutex>
 #include <set>
 #include <string>
 #include <tuple>
@@ -64,6 +66,9 @@ class BaseProperty;
 
 namespace devices {
 
+class ConfigWorker;
+class StateMonitor;
+
 class Configurable :
 	public QObject,
 	public std::enable_shared_from_this<Configurable>
@@ -74,7 +79,10 @@ private:
 	Configurable(const shared_ptr<sigrok::Configurable> sr_configurable,
 		unsigned int configurable_index,
 		const string &device_name, const DeviceType device_type,
-		const QString &device_settings_id);
+		const QString &device_settings_id,
+		const string &list_cache_id = "",
+		shared_ptr<ConfigWorker> config_worker = nullptr,
+		shared_ptr<StateMonitor> state_monitor = nullptr);
 
 public:
 	template<typename ...Arg>
@@ -142,7 +150,71 @@ public:
 	void set_measured_quantity_config(devices::ConfigKey config_key,
 		const data::measured_quantity_t mq);
 
+	/**
+	 * Write the config key in the config worker of the device without
+	 * waiting for it. A write of the same key, that is still waiting in the
+	 * worker, is superseded, see ConfigWorker::post(). done is called with
+	 * the result in the worker thread, it is not called for a superseded
+	 * write.
+	 */
+	template<typename T> void post_config(devices::ConfigKey config_key,
+		const T value, std::function<void(bool)> done = nullptr);
+	/** Container variant of post_config(), see set_container_config(). */
+	void post_container_config(devices::ConfigKey config_key,
+		const vector<Glib::VariantBase> &childs,
+		std::function<void(bool)> done = nullptr);
+	/** See set_measured_quantity_config() and post_config(). */
+	void post_measured_quantity_config(devices::ConfigKey config_key,
+		const data::measured_quantity_t mq,
+		std::function<void(bool)> done = nullptr);
+
+	/**
+	 * Queue a write of the config key, that is done by the next call of
+	 * flush_configs(). A key that is already queued keeps its position in
+	 * the queue, but gets the new value, so only the latest value of a key
+	 * is written to the device.
+	 */
+	template<typename T> void queue_config(devices::ConfigKey config_key, const T value);
+	/**
+	 * Write all queued config keys back to back, in the order they were
+	 * queued. This allows to set e.g. the voltage and current of several
+	 * channels of a power supply in one go.
+	 *
+	 * @return the number of config keys that have been written.
+	 */
+	size_t flush_configs();
+	/**
+	 * Get the number of config keys, that are queued for flush_configs().
+	 */
+	size_t queued_config_count() const;
+
+	/**
+	 * Get the values of several config keys at once. A key, that has a
+	 * cached property value younger than its cache_ttl(), is taken from the
+	 * cache. All other keys are read back to back in one job of the config
+	 * worker and their properties are updated. Keys that are not getable or
+	 * can't be read are missing in the returned map.
+	 */
+	map<devices::ConfigKey, QVariant> get_configs(
+		const vector<devices::ConfigKey> &config_keys);
+	/**
+	 * Write several config keys back to back in one job of the config
+	 * worker, like flush_configs(). The values have the QVariant types of
+	 * the properties. The cached values of the properties are updated for
+	 * all successful writes.
+	 *
+	 * @return the number of config keys that have been written.
+	 */
+	size_t set_configs(
+		const vector<pair<devices::ConfigKey, QVariant>> &configs);
+
 	bool has_list_config(devices::ConfigKey config_key) const;
+	/**
+	 * Get the list of available values of the config key. With a list cache
+	 * id, the list is cached across sessions for all devices with the same
+	 * id, see SettingsManager::save_list_config(). So a known device is not
+	 * queried again.
+	 */
 	bool list_config(devices::ConfigKey config_key, Glib::VariantContainerBase &gvar);
 
 	/**
@@ -170,11 +242,18 @@ public:
 	 */
 	QString device_settings_id() const;
 
+	/**
+	 * Get the state monitor of the device, that polls the watched
+	 * properties. nullptr for devices without a monitor.
+	 */
+	shared_ptr<StateMonitor> state_monitor() const;
+
 	set<devices::ConfigKey> getable_configs() const;
 	set<devices::ConfigKey> setable_configs() const;
 	set<devices::ConfigKey> listable_configs() const;
 
-	map<devices::ConfigKey, shared_ptr<data::properties::BaseProperty>> property_map() const;
+	const map<devices::ConfigKey, shared_ptr<data::properties::BaseProperty>> &
+		property_map() const;
 	shared_ptr<data::properties::BaseProperty> get_property(devices::ConfigKey config_key) const;
 
 	bool is_controllable() const;
@@ -182,17 +261,50 @@ public:
 	void feed_in_meta(shared_ptr<sigrok::Meta> sr_meta);
 
 private:
+	/**
+	 * Write the value to the config key. The key is checked against the
+	 * setable keys, that were read in init(), so no additional query of the
+	 * device capabilities is needed for every write.
+	 */
+	bool write_config(devices::ConfigKey config_key,
+		const Glib::VariantBase &gvar, const char *caller);
+	/** Post the write to the config worker, see post_config(). */
+	void post_write(devices::ConfigKey config_key,
+		const Glib::VariantBase &gvar, std::function<void(bool)> done);
+	/**
+	 * Execute the driver I/O in the config worker and wait for it. Without
+	 * a worker, the job is executed directly.
+	 */
+	void execute_io(const std::function<void()> &job) const;
+	static vector<Glib::VariantBase> measured_quantity_childs(
+		const data::measured_quantity_t &mq);
+	/**
+	 * Convert a QVariant of the data type of the config key to a variant for
+	 * the device. Returns false for an unsupported data type.
+	 */
+	static bool to_variant(devices::ConfigKey config_key, const QVariant &qvar,
+		Glib::VariantBase &gvar);
+
 	const shared_ptr<sigrok::Configurable> sr_configurable_;
 	unsigned int index_;
 	const string device_name_;
 	const DeviceType device_type_;
 	const QString device_settings_id_;
+	/** The model and firmware of the device, empty to disable the cache. */
+	const string list_cache_id_;
+	const shared_ptr<ConfigWorker> config_worker_;
+	const shared_ptr<StateMonitor> state_monitor_;
 
 	set<devices::ConfigKey> getable_configs_;
 	set<devices::ConfigKey> setable_configs_;
 	set<devices::ConfigKey> listable_configs_;
 	map<devices::ConfigKey, shared_ptr<data::properties::BaseProperty>> property_map_;
 
+	vector<pair<devices::ConfigKey, Glib::VariantBase>> queued_configs_;
+	mutable std::mutex queue_mutex_;
+	/** Serializes the flushes, so queued writes keep their order. */
+	std::mutex flush_mutex_;
+
 Q_SIGNALS:
 	void config_changed(
 		const devices::ConfigKey config_key, const QVariant &qvar);
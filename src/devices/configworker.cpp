@@ -0,0 +1,180 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "configworker.hpp"
+#include "src/devices/deviceutil.hpp"
+
+using std::chrono::steady_clock;
+using std::lock_guard;
+using std::mutex;
+using std::unique_lock;
+
+namespace sv {
+namespace devices {
+
+ConfigWorker::ConfigWorker() :
+	stop_(false),
+	max_write_rate_(0.),
+	min_write_interval_(steady_clock::duration::zero())
+{
+	thread_ = std::thread(&ConfigWorker::thread_proc, this);
+}
+
+ConfigWorker::~ConfigWorker()
+{
+	stop();
+}
+
+void ConfigWorker::post(const Configurable *configurable,
+	ConfigKey config_key, std::function<bool()> write,
+	std::function<void(bool)> done)
+{
+	auto run = [write, done]() {
+		const bool ok = write();
+		if (done)
+			done(ok);
+	};
+
+	{
+		lock_guard<mutex> lock(mutex_);
+		if (!stop_) {
+			for (auto &job : jobs_) {
+				if (job.is_posted_write && job.configurable == configurable &&
+						job.config_key == config_key) {
+					job.run = run;
+					return;
+				}
+			}
+			jobs_.push_back(Job{ configurable, config_key, true, run });
+			cond_.notify_one();
+			return;
+		}
+	}
+	run();
+}
+
+void ConfigWorker::execute(const std::function<void()> &job)
+{
+	if (is_worker_thread()) {
+		job();
+		return;
+	}
+
+	std::packaged_task<void()> task(job);
+	auto future = task.get_future();
+	{
+		lock_guard<mutex> lock(mutex_);
+		if (stop_) {
+			job();
+			return;
+		}
+		jobs_.push_back(Job{ nullptr, ConfigKey::Unknown, false,
+			[&task]() { task(); } });
+		cond_.notify_one();
+	}
+	// Rethrows the exception of the job
+	future.get();
+}
+
+size_t ConfigWorker::queued_count() const
+{
+	lock_guard<mutex> lock(mutex_);
+	return jobs_.size();
+}
+
+void ConfigWorker::set_max_write_rate(double max_rate)
+{
+	lock_guard<mutex> lock(mutex_);
+	if (max_rate > 0.) {
+		max_write_rate_ = max_rate;
+		min_write_interval_ =
+			std::chrono::duration_cast<steady_clock::duration>(
+				std::chrono::duration<double>(1. / max_rate));
+	}
+	else {
+		max_write_rate_ = 0.;
+		min_write_interval_ = steady_clock::duration::zero();
+	}
+	// A waiting write may be due now
+	cond_.notify_one();
+}
+
+double ConfigWorker::max_write_rate() const
+{
+	lock_guard<mutex> lock(mutex_);
+	return max_write_rate_;
+}
+
+void ConfigWorker::stop()
+{
+	{
+		lock_guard<mutex> lock(mutex_);
+		stop_ = true;
+	}
+	cond_.notify_one();
+	if (thread_.joinable() && !is_worker_thread())
+		thread_.join();
+}
+
+void ConfigWorker::thread_proc()
+{
+	unique_lock<mutex> lock(mutex_);
+	while (true) {
+		cond_.wait(lock, [this]() { return stop_ || !jobs_.empty(); });
+		// The remaining jobs are executed, before the thread ends
+		if (jobs_.empty())
+			break;
+
+		// While a rate limited write waits, it is superseded by new writes
+		if (jobs_.front().is_posted_write && !stop_ &&
+				min_write_interval_ > steady_clock::duration::zero()) {
+			const auto next_write_time =
+				last_write_time_ + min_write_interval_;
+			if (steady_clock::now() < next_write_time) {
+				cond_.wait_until(lock, next_write_time);
+				continue;
+			}
+		}
+
+		const bool is_posted_write = jobs_.front().is_posted_write;
+		Job job = std::move(jobs_.front());
+		jobs_.pop_front();
+		lock.unlock();
+		job.run();
+		lock.lock();
+		if (is_posted_write)
+			last_write_time_ = steady_clock::now();
+	}
+}
+
+bool ConfigWorker::is_worker_thread() const
+{
+	return std::this_thread::get_id() == thread_.get_id();
+}
+
+} // namespace devices
+} // namespace sv
@@ -0,0 +1,120 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEVICES_CONFIGWORKER_HPP
+#define DEVICES_CONFIGWORKER_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "src/devices/deviceutil.hpp"
+
+namespace sv {
+namespace devices {
+
+class Configurable;
+
+/**
+ * Serializes the config I/O of all configurables of a device in one worker
+ * thread, so a slow instrument doesn't block the thread, that changes a
+ * config key (e.g. the GUI thread while a knob is turned).
+ *
+ * Writes can be posted without waiting for them. A posted write, that is
+ * still queued, is superseded by the next write of the same config key: It
+ * gets the new value, but keeps its position in the queue. So only the
+ * latest value is sent to the device and the order of the keys is kept.
+ * Reads and synchronous writes are executed in the same queue, behind the
+ * posted writes.
+ *
+ * The rate of the posted writes can be limited. A write then waits in the
+ * queue until the interval since the previous write has passed, so fast
+ * changes (e.g. dragging a knob) are coalesced to one write per interval.
+ */
+class ConfigWorker
+{
+public:
+	ConfigWorker();
+	/** Calls stop(). */
+	~ConfigWorker();
+
+	ConfigWorker(const ConfigWorker &) = delete;
+	ConfigWorker &operator=(const ConfigWorker &) = delete;
+
+	/**
+	 * Queue a write of a config key. write is called in the worker thread
+	 * and returns true on success, then done is called with the result. If
+	 * a write of the same key of the same configurable is still queued, it
+	 * is replaced and its done function is never called.
+	 */
+	void post(const Configurable *configurable, ConfigKey config_key,
+		std::function<bool()> write, std::function<void(bool)> done);
+
+	/**
+	 * Execute the job in the worker thread and wait for it. An exception of
+	 * the job is rethrown in the calling thread. The job is executed
+	 * directly, when called from the worker thread or after stop().
+	 */
+	void execute(const std::function<void()> &job);
+
+	/** Return the number of queued jobs. */
+	size_t queued_count() const;
+
+	/**
+	 * Limit the posted writes to max_rate writes per second. 0 disables
+	 * the limit.
+	 */
+	void set_max_write_rate(double max_rate);
+	double max_write_rate() const;
+
+	/** Execute the remaining jobs and stop the worker thread. */
+	void stop();
+
+private:
+	struct Job
+	{
+		const Configurable *configurable;
+		ConfigKey config_key;
+		/** Only posted writes are replaced by later writes. */
+		bool is_posted_write;
+		std::function<void()> run;
+	};
+
+	void thread_proc();
+	bool is_worker_thread() const;
+
+	mutable std::mutex mutex_;
+	std::condition_variable cond_;
+	std::deque<Job> jobs_;
+	bool stop_;
+	double max_write_rate_;
+	std::chrono::steady_clock::duration min_write_interval_;
+	std::chrono::steady_clock::time_point last_write_time_;
+	std::thread thread_;
+
+};
+
+} // namespace devices
+} // namespace sv
+
+#endif // DEVICES_CONFIGWORKER_HPP
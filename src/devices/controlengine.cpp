@@ -0,0 +1,438 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <QDebug>
+#include <QString>
+
+#include "controlengine.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/properties/doubleproperty.hpp"
+#include "src/devices/sequenceengine.hpp"
+
+using std::chrono::steady_clock;
+using std::lock_guard;
+using std::make_shared;
+using std::string;
+using std::unique_lock;
+using std::vector;
+
+namespace sv {
+namespace devices {
+
+namespace {
+
+double seconds_between(steady_clock::time_point from,
+	steady_clock::time_point to)
+{
+	return std::chrono::duration<double>(to - from).count();
+}
+
+steady_clock::time_point time_after(steady_clock::time_point time,
+	double seconds)
+{
+	return time + std::chrono::duration_cast<steady_clock::duration>(
+		std::chrono::duration<double>(seconds));
+}
+
+}
+
+ControlEngine::ControlEngine(shared_ptr<data::AnalogTimeSignal> signal,
+		shared_ptr<data::properties::DoubleProperty> output) :
+	signal_(signal),
+	output_(output),
+	write_state_(make_shared<WriteState>()),
+	has_law_(false),
+	parameters_changed_(true),
+	integral_(0.),
+	last_input_(0.),
+	last_timestamp_(0.),
+	last_output_(0.),
+	has_last_input_(false),
+	iteration_count_(0),
+	held_count_(0),
+	max_interval_(0.),
+	posted_output_(std::numeric_limits<double>::quiet_NaN()),
+	stop_(false),
+	running_(false)
+{
+	parameters_.law = ControlLaw::Pid;
+	parameters_.kp = 0.;
+	parameters_.ki = 0.;
+	parameters_.kd = 0.;
+	parameters_.setpoint = 0.;
+	parameters_.output_min = output_->min();
+	parameters_.output_max = output_->max();
+	parameters_.min_interval = 0.;
+}
+
+ControlEngine::~ControlEngine()
+{
+	stop();
+}
+
+shared_ptr<data::AnalogTimeSignal> ControlEngine::signal() const
+{
+	return signal_;
+}
+
+shared_ptr<data::properties::DoubleProperty> ControlEngine::output() const
+{
+	return output_;
+}
+
+void ControlEngine::set_pid(double kp, double ki, double kd)
+{
+	lock_guard<std::mutex> lock(parameters_mutex_);
+	parameters_.law = ControlLaw::Pid;
+	parameters_.kp = kp;
+	parameters_.ki = ki;
+	parameters_.kd = kd;
+	has_law_ = true;
+	parameters_changed_ = true;
+}
+
+bool ControlEngine::set_expression(const string &formula)
+{
+	data::Expression expression;
+	if (!expression.compile(formula, 3)) {
+		qWarning() << "ControlEngine::set_expression(): " <<
+			QString::fromStdString(expression.error());
+		return false;
+	}
+
+	lock_guard<std::mutex> lock(parameters_mutex_);
+	parameters_.law = ControlLaw::Expression;
+	parameters_.expression = expression;
+	has_law_ = true;
+	parameters_changed_ = true;
+	return true;
+}
+
+ControlLaw ControlEngine::law() const
+{
+	lock_guard<std::mutex> lock(parameters_mutex_);
+	return parameters_.law;
+}
+
+void ControlEngine::set_setpoint(double setpoint)
+{
+	lock_guard<std::mutex> lock(parameters_mutex_);
+	parameters_.setpoint = setpoint;
+	parameters_changed_ = true;
+}
+
+double ControlEngine::setpoint() const
+{
+	lock_guard<std::mutex> lock(parameters_mutex_);
+	return parameters_.setpoint;
+}
+
+void ControlEngine::set_output_limits(double min, double max)
+{
+	if (!(min <= max)) {
+		qWarning() << "ControlEngine::set_output_limits(): Invalid limits " <<
+			min << " - " << max;
+		return;
+	}
+
+	lock_guard<std::mutex> lock(parameters_mutex_);
+	parameters_.output_min = min;
+	parameters_.output_max = max;
+	parameters_changed_ = true;
+}
+
+double ControlEngine::output_min() const
+{
+	lock_guard<std::mutex> lock(parameters_mutex_);
+	return parameters_.output_min;
+}
+
+double ControlEngine::output_max() const
+{
+	lock_guard<std::mutex> lock(parameters_mutex_);
+	return parameters_.output_max;
+}
+
+void ControlEngine::set_max_rate(double max_rate)
+{
+	lock_guard<std::mutex> lock(parameters_mutex_);
+	parameters_.min_interval = max_rate > 0. ? 1. / max_rate : 0.;
+	parameters_changed_ = true;
+}
+
+double ControlEngine::max_rate() const
+{
+	lock_guard<std::mutex> lock(parameters_mutex_);
+	return parameters_.min_interval > 0. ? 1. / parameters_.min_interval : 0.;
+}
+
+bool ControlEngine::start()
+{
+	stop();
+	{
+		lock_guard<std::mutex> lock(parameters_mutex_);
+		if (!has_law_) {
+			qWarning() << "ControlEngine::start(): No control law";
+			return false;
+		}
+	}
+
+	// Bumpless start: The loop continues with the current output
+	last_output_ = output_->double_value();
+	integral_ = last_output_;
+	has_last_input_ = false;
+	iteration_count_ = 0;
+	held_count_ = 0;
+	max_interval_ = 0.;
+	posted_output_ = std::numeric_limits<double>::quiet_NaN();
+	interval_statistics_.clear();
+	{
+		lock_guard<std::mutex> lock(write_state_->mutex);
+		++write_state_->run;
+		write_state_->write_count = 0;
+		write_state_->failed_write_count = 0;
+		write_state_->latency_sum = 0.;
+		write_state_->max_latency = 0.;
+	}
+	parameters_changed_ = true;
+
+	stop_ = false;
+	running_ = true;
+	thread_ = std::thread(&ControlEngine::thread_proc, this);
+	return true;
+}
+
+void ControlEngine::stop()
+{
+	if (!thread_.joinable())
+		return;
+
+	{
+		lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+	}
+	stop_cond_.notify_one();
+	thread_.join();
+	running_ = false;
+	log_summary();
+}
+
+bool ControlEngine::is_running() const
+{
+	return running_;
+}
+
+ControlSummary ControlEngine::summary() const
+{
+	ControlSummary summary;
+	summary.iteration_count = iteration_count_;
+	summary.held_count = held_count_;
+	summary.max_interval = max_interval_;
+	summary.last_output = posted_output_;
+
+	const data::AnalogStatistics intervals =
+		interval_statistics_.statistics();
+	summary.mean_interval = intervals.sample_count > 0 ? intervals.mean : 0.;
+	summary.interval_jitter =
+		intervals.sample_count > 0 ? intervals.stddev : 0.;
+
+	lock_guard<std::mutex> lock(write_state_->mutex);
+	summary.write_count = write_state_->write_count;
+	summary.failed_write_count = write_state_->failed_write_count;
+	summary.mean_latency = write_state_->write_count > 0 ?
+		write_state_->latency_sum / (double)write_state_->write_count : 0.;
+	summary.max_latency = write_state_->max_latency;
+	return summary;
+}
+
+double ControlEngine::evaluate(const Parameters &parameters,
+	double timestamp, double input)
+{
+	double output;
+	if (parameters.law == ControlLaw::Expression) {
+		const vector<const double *> variables {
+			&input, &parameters.setpoint, &last_output_ };
+		parameters.expression.evaluate(variables, 1, &output);
+	}
+	else {
+		// The time step is taken from the samples, not from the engine
+		// thread, so the law doesn't depend on the wake up latency.
+		const double dt = has_last_input_ ? timestamp - last_timestamp_ : 0.;
+		const double error = parameters.setpoint - input;
+		const double proportional = parameters.kp * error;
+		double derivative = 0.;
+		if (dt > 0.) {
+			integral_ += parameters.ki * error * dt;
+			derivative = -parameters.kd * (input - last_input_) / dt;
+		}
+		output = proportional + integral_ + derivative;
+
+		// Anti windup: The integral only takes the part of the output,
+		// that is within the limits.
+		if (output > parameters.output_max)
+			integral_ = parameters.output_max - proportional - derivative;
+		else if (output < parameters.output_min)
+			integral_ = parameters.output_min - proportional - derivative;
+	}
+	last_input_ = input;
+	last_timestamp_ = timestamp;
+	has_last_input_ = true;
+
+	if (!std::isfinite(output))
+		return std::numeric_limits<double>::quiet_NaN();
+	output = std::max(parameters.output_min,
+		std::min(output, parameters.output_max));
+	last_output_ = output;
+	return output;
+}
+
+void ControlEngine::post_output(double value, uint64_t run,
+	steady_clock::time_point sample_time)
+{
+	posted_output_ = value;
+	// The write state outlives the engine, if the worker is slow
+	auto write_state = write_state_;
+	output_->post_value(value, [write_state, run, sample_time](bool ok) {
+		const double latency =
+			seconds_between(sample_time, steady_clock::now());
+		lock_guard<std::mutex> lock(write_state->mutex);
+		if (write_state->run != run)
+			return;
+		if (!ok) {
+			++write_state->failed_write_count;
+			return;
+		}
+		++write_state->write_count;
+		write_state->latency_sum += latency;
+		write_state->max_latency = std::max(write_state->max_latency, latency);
+	});
+}
+
+bool ControlEngine::wait_until(steady_clock::time_point time)
+{
+	// Sleep until shortly before the time, then spin for the rest
+	{
+		unique_lock<std::mutex> lock(mutex_);
+		if (stop_cond_.wait_until(lock, time - SequenceEngine::spin_time(),
+				[this] { return stop_.load(); }))
+			return false;
+	}
+	while (steady_clock::now() < time) {
+		if (stop_)
+			return false;
+		std::this_thread::yield();
+	}
+	return true;
+}
+
+void ControlEngine::log_summary() const
+{
+	const ControlSummary summary = this->summary();
+	qDebug().nospace() << "ControlEngine: " <<
+		signal_->display_name() << ": " << summary.iteration_count <<
+		" iterations, " << summary.write_count << " writes (" <<
+		summary.failed_write_count << " failed, " << summary.held_count <<
+		" held), latency mean/max " << summary.mean_latency * 1000. <<
+		"/" << summary.max_latency * 1000. << " ms, interval " <<
+		summary.mean_interval * 1000. << " ms, jitter " <<
+		summary.interval_jitter * 1000. << " ms";
+}
+
+void ControlEngine::thread_proc()
+{
+	uint64_t run;
+	{
+		lock_guard<std::mutex> lock(write_state_->mutex);
+		run = write_state_->run;
+	}
+
+	size_t count = signal_->sample_count();
+	steady_clock::time_point last_iteration;
+	bool has_iteration = false;
+	Parameters parameters;
+	while (!stop_) {
+		// Wake up regularly to check for stop()
+		if (!signal_->wait_for_sample_count(count, 0.05))
+			continue;
+		steady_clock::time_point sample_time = steady_clock::now();
+
+		if (parameters_changed_.exchange(false)) {
+			lock_guard<std::mutex> lock(parameters_mutex_);
+			parameters = parameters_;
+		}
+
+		// Skip the samples until the interval has elapsed, the law gets
+		// the newest sample then.
+		if (has_iteration && parameters.min_interval > 0.) {
+			const auto next_iteration = time_after(last_iteration,
+				parameters.min_interval);
+			if (sample_time < next_iteration) {
+				if (!wait_until(next_iteration))
+					break;
+				sample_time = steady_clock::now();
+			}
+		}
+
+		count = signal_->sample_count();
+		double timestamp;
+		double value;
+		if (count == 0 ||
+				signal_->copy_samples(count - 1, 1, false,
+					&timestamp, &value) == 0 ||
+				!std::isfinite(value))
+			continue;
+
+		if (has_iteration) {
+			const double interval =
+				seconds_between(last_iteration, sample_time);
+			interval_statistics_.add(interval);
+			interval_statistics_.publish();
+			if (interval > max_interval_)
+				max_interval_ = interval;
+		}
+		last_iteration = sample_time;
+		has_iteration = true;
+		++iteration_count_;
+
+		const double output = evaluate(parameters, timestamp, value);
+		// Don't bother the device with outputs below its resolution
+		const double posted = posted_output_;
+		if (std::isnan(output) || (!std::isnan(posted) &&
+				std::fabs(output - posted) < output_->step() / 2.)) {
+			++held_count_;
+			continue;
+		}
+		post_output(output, run, sample_time);
+	}
+	running_ = false;
+}
+
+} // namespace devices
+} // namespace sv
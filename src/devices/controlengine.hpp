@@ -0,0 +1,247 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEVICES_CONTROLENGINE_HPP
+#define DEVICES_CONTROLENGINE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "src/data/expression.hpp"
+#include "src/data/runningstatistics.hpp"
+
+using std::shared_ptr;
+using std::string;
+
+namespace sv {
+
+namespace data {
+class AnalogTimeSignal;
+namespace properties {
+class DoubleProperty;
+}
+}
+
+namespace devices {
+
+enum class ControlLaw
+{
+	/** A PID controller, that drives the input signal to the setpoint. */
+	Pid,
+	/**
+	 * A formula over the input value (v1), the setpoint (v2) and the last
+	 * output (v3), e.g. "v2 / v1" for a constant power load.
+	 */
+	Expression,
+};
+
+/**
+ * A snapshot of the loop timing of a ControlEngine.
+ */
+struct ControlSummary
+{
+	/** The number of times, the control law was evaluated. */
+	uint64_t iteration_count;
+	/** The writes, that were done by the device. */
+	uint64_t write_count;
+	uint64_t failed_write_count;
+	/**
+	 * The outputs, that were not written, because they differ by less than
+	 * half a step of the output property from the last output or because
+	 * they are not finite.
+	 */
+	uint64_t held_count;
+	/**
+	 * The time in seconds from the new sample until the output was written
+	 * by the device.
+	 */
+	double mean_latency;
+	double max_latency;
+	/** The time in seconds between two iterations and its jitter (stddev). */
+	double mean_interval;
+	double interval_jitter;
+	double max_interval;
+	/** The last output, that was posted to the device. */
+	double last_output;
+};
+
+/**
+ * A closed control loop from an input signal to a setpoint of a device,
+ * e.g. a constant power or constant resistance load from the voltage of an
+ * electronic load, or a temperature, that is held by a power supply.
+ *
+ * The engine thread is woken up by the signal, every new sample is handled
+ * at once, without the poll or notification interval of a script. The
+ * control law is evaluated for the newest sample, the output is posted to
+ * the config worker of the device. A write, that isn't done when the next
+ * output is posted, is superseded, so a slow device always gets the newest
+ * output and the loop never falls behind.
+ *
+ * The loop can be limited to a max. rate. Samples, that come in faster,
+ * are skipped and the law is evaluated for the newest sample, when the
+ * interval has elapsed. The timing of the loop (latency from the sample to
+ * the write, interval and jitter) is collected in a ControlSummary and
+ * logged, when the loop is stopped.
+ */
+class ControlEngine
+{
+public:
+	ControlEngine(shared_ptr<data::AnalogTimeSignal> signal,
+		shared_ptr<data::properties::DoubleProperty> output);
+	~ControlEngine();
+
+	ControlEngine(const ControlEngine &) = delete;
+	ControlEngine &operator=(const ControlEngine &) = delete;
+
+	shared_ptr<data::AnalogTimeSignal> signal() const;
+	shared_ptr<data::properties::DoubleProperty> output() const;
+
+	/**
+	 * Use a PID law with the gains. The error is setpoint - input, so a
+	 * rising output must raise the input for positive gains. The
+	 * derivative is taken from the input, not from the error, so a
+	 * setpoint step doesn't kick the output.
+	 */
+	void set_pid(double kp, double ki, double kd);
+	/**
+	 * Use a formula over v1 (input), v2 (setpoint) and v3 (last output).
+	 *
+	 * @return false if the formula is invalid, the law is unchanged then.
+	 */
+	bool set_expression(const string &formula);
+	ControlLaw law() const;
+
+	/** The setpoint can be changed while the loop is running. */
+	void set_setpoint(double setpoint);
+	double setpoint() const;
+
+	/**
+	 * Clamp the output to [min, max]. The default are the limits of the
+	 * output property.
+	 */
+	void set_output_limits(double min, double max);
+	double output_min() const;
+	double output_max() const;
+
+	/**
+	 * Evaluate the law (and so write the output) max. max_rate times per
+	 * second. 0 (the default) evaluates the law for every sample.
+	 */
+	void set_max_rate(double max_rate);
+	double max_rate() const;
+
+	/**
+	 * Start the loop. The PID integral starts with the current value of the
+	 * output, so the loop takes over without a bump. Returns false if the
+	 * law isn't set.
+	 */
+	bool start();
+	/** Stop the loop and log its timing statistics. */
+	void stop();
+	bool is_running() const;
+
+	ControlSummary summary() const;
+
+private:
+	/**
+	 * The counters, that are updated by the done function of the writes.
+	 * They are shared with the done function, that may be called by the
+	 * config worker after the engine was stopped.
+	 */
+	struct WriteState
+	{
+		std::mutex mutex;
+		/** The done functions of older runs are not counted. */
+		uint64_t run = 0;
+		uint64_t write_count = 0;
+		uint64_t failed_write_count = 0;
+		double latency_sum = 0.;
+		double max_latency = 0.;
+	};
+
+	/** The parameters, that are taken over at every iteration. */
+	struct Parameters
+	{
+		ControlLaw law;
+		double kp;
+		double ki;
+		double kd;
+		data::Expression expression;
+		double setpoint;
+		double output_min;
+		double output_max;
+		double min_interval;
+	};
+
+	void thread_proc();
+	/**
+	 * Evaluate the law for the input at the timestamp (in s). Returns NaN
+	 * if there is no output.
+	 */
+	double evaluate(const Parameters &parameters, double timestamp,
+		double input);
+	void post_output(double value, uint64_t run,
+		std::chrono::steady_clock::time_point sample_time);
+	/** Wait until time. Returns false if the engine was stopped. */
+	bool wait_until(std::chrono::steady_clock::time_point time);
+	void log_summary() const;
+
+	shared_ptr<data::AnalogTimeSignal> signal_;
+	shared_ptr<data::properties::DoubleProperty> output_;
+	shared_ptr<WriteState> write_state_;
+
+	mutable std::mutex parameters_mutex_;
+	Parameters parameters_;
+	bool has_law_;
+	/** Set by the setters, the engine thread then copies the parameters. */
+	std::atomic<bool> parameters_changed_;
+
+	/** The state of the law, only used by the engine thread. */
+	double integral_;
+	double last_input_;
+	double last_timestamp_;
+	double last_output_;
+	bool has_last_input_;
+
+	/** The loop statistics, only written by the engine thread. */
+	data::RunningStatistics interval_statistics_;
+	std::atomic<uint64_t> iteration_count_;
+	std::atomic<uint64_t> held_count_;
+	std::atomic<double> max_interval_;
+	std::atomic<double> posted_output_;
+
+	std::thread thread_;
+	std::mutex mutex_;
+	std::condition_variable stop_cond_;
+	std::atomic<bool> stop_;
+	std::atomic<bool> running_;
+
+};
+
+} // namespace devices
+} // namespace sv
+
+#endif // DEVICES_CONTROLENGINE_HPP
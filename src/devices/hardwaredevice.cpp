@@ -20,6 +20,8 @@
 
 #include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <memory>
 #include <string>
 #include <thread>
 #include <utility>
@@ -27,7 +29,6 @@
 
 #include <glib.h>
 
-#include <QDateTime>
 #include <QDebug>
 #include <QString>
 #include <QStringList>
@@ -36,16 +37,25 @@
 
 #include "hardwaredevice.hpp"
 #include "src/devicemanager.hpp"
+#include "src/allocationcounter.hpp"
 #include "src/session.hpp"
 #include "src/channels/basechannel.hpp"
 #include "src/channels/hardwarechannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/datautil.hpp"
+#include "src/data/timebase.hpp"
 #include "src/data/properties/uint64property.hpp"
 #include "src/devices/basedevice.hpp"
 #include "src/devices/configurable.hpp"
+#include "src/devices/configworker.hpp"
 #include "src/devices/deviceutil.hpp"
+#include "src/devices/statemonitor.hpp"
+#include "src/tracer.hpp"
 
 using std::lock_guard;
 using std::make_pair;
+using std::unique_lock;
+using std::make_shared;
 using std::map;
 using std::shared_ptr;
 using std::static_pointer_cast;
@@ -56,10 +66,30 @@ using std::vector;
 namespace sv {
 namespace devices {
 
+const unsigned int HardwareDevice::ingest_queue_size_exp_ = 8;
+
 HardwareDevice::HardwareDevice(
 		const shared_ptr<sigrok::Context> sr_context,
 		shared_ptr<sigrok::HardwareDevice> sr_device) :
-	BaseDevice(sr_context, sr_device)
+	BaseDevice(sr_context, sr_device),
+	// The samples of hardware signals are compressed, see HardwareChannel
+	time_column_(make_shared<data::TimeColumn>(true)),
+	sr_mq_(nullptr),
+	mq_flags_mask_(0),
+	sr_unit_(nullptr),
+	sr_digits_(0),
+	analog_meaning_{ data::Quantity::Unknown, {}, data::MeasuredQuantity(),
+		data::Unit::Unknown, 7, -1, 0 },
+	ingest_queue_(ingest_queue_size_exp_),
+	free_batches_(ingest_queue_size_exp_),
+	ingest_running_(false),
+	ingest_waiting_(false),
+	ingest_dropping_(false),
+	last_packet_timestamp_(0.),
+	config_worker_(make_shared<ConfigWorker>()),
+	state_monitor_(make_shared<StateMonitor>()),
+	display_name_manager_(nullptr),
+	display_name_generation_(0)
 {
 	// Set options for different device types
 	// TODO: Multiple DeviceTypes per HardwareDevice
@@ -89,8 +119,34 @@ HardwareDevice::HardwareDevice(
 		assert("Unknown device");
 }
 
+HardwareDevice::~HardwareDevice()
+{
+	// The polls of the state monitor are executed by the config worker
+	state_monitor_->stop();
+	// Send the pending config writes, while the device is still open
+	config_worker_->stop();
+	// Stop the datafeed, before the ingest thread is stopped
+	if (sr_session_)
+		BaseDevice::close();
+	stop_ingest_thread();
+}
+
 QString HardwareDevice::display_name(
 	const DeviceManager &device_manager) const
+{
+	const unsigned int generation = device_manager.generation();
+	lock_guard<mutex> lock(display_name_mutex_);
+	if (display_name_manager_ != &device_manager ||
+			display_name_generation_ != generation) {
+		display_name_ = build_display_name(device_manager);
+		display_name_manager_ = &device_manager;
+		display_name_generation_ = generation;
+	}
+	return display_name_;
+}
+
+QString HardwareDevice::build_display_name(
+	const DeviceManager &device_manager) const
 {
 	const auto hw_dev = sr_hardware_device();
 
@@ -148,8 +204,36 @@ shared_ptr<sigrok::HardwareDevice> HardwareDevice::sr_hardware_device() const
 	return static_pointer_cast<sigrok::HardwareDevice>(sr_device_);
 }
 
+AcquisitionSummary HardwareDevice::acquisition_summary() const
+{
+	AcquisitionSummary summary = statistics_.summary();
+	summary.queue_depth = ingest_queue_.size();
+	summary.queue_high_water = ingest_queue_.high_water();
+	return summary;
+}
+
+void HardwareDevice::set_max_config_write_rate(double max_rate)
+{
+	config_worker_->set_max_write_rate(max_rate);
+}
+
+double HardwareDevice::max_config_write_rate() const
+{
+	return config_worker_->max_write_rate();
+}
+
+size_t HardwareDevice::queued_config_write_count() const
+{
+	return config_worker_->queued_count();
+}
+
 void HardwareDevice::init_configurables()
 {
+	// The lists of the config keys only depend on the model and firmware
+	const string list_cache_id = sr_hardware_device()->driver()->name() +
+		":" + sr_device_->vendor() + ":" + sr_device_->model() + ":" +
+		sr_device_->version();
+
 	// Init Configurables from Channel Groups
 	for (const auto &sr_cg_pair : sr_device_->channel_groups()) {
 		auto sr_cg = sr_cg_pair.second;
@@ -158,7 +242,8 @@ void HardwareDevice::init_configurables()
 
 		auto cg_c = Configurable::create(
 			sr_cg, next_configurable_index_++,
-			short_name().toStdString(), type_, settings_id());
+			short_name().toStdString(), type_, settings_id(),
+			list_cache_id, config_worker_, state_monitor_);
 		configurable_map_.insert(make_pair(sr_cg_pair.first, cg_c));
 	}
 
@@ -178,7 +263,8 @@ void HardwareDevice::init_configurables()
 	// Init Configurable from Device
 	auto d_c = Configurable::create(
 		sr_device_, next_configurable_index_++,
-		short_name().toStdString(), type_, settings_id());
+		short_name().toStdString(), type_, settings_id(), list_cache_id,
+		config_worker_, state_monitor_);
 	configurable_map_.insert(make_pair("", d_c));
 
 	// Sample rate for interleaved samples
@@ -211,6 +297,147 @@ void HardwareDevice::init_channels()
 			continue;
 		add_sr_channel(sr_channel, "");
 	}
+
+	// Resolve the channels of the datafeed once, see feed_in_analog()
+	lock_guard<recursive_mutex> lock(data_mutex_);
+	sr_channel_table_.clear();
+	for (const auto &sr_channel_pair : sr_channel_map_) {
+		const unsigned int index = sr_channel_pair.first->index();
+		if (index >= sr_channel_table_.size())
+			sr_channel_table_.resize(index + 1);
+		sr_channel_table_[index] =
+			static_pointer_cast<channels::HardwareChannel>(
+				sr_channel_pair.second);
+	}
+}
+
+void HardwareDevice::init_acquisition()
+{
+	// The ingest thread must run, before the datafeed delivers the first
+	// packet. It keeps running, when the device is closed and reopened.
+	if (!ingest_thread_.joinable()) {
+		ingest_running_ = true;
+		ingest_thread_ = std::thread(
+			&HardwareDevice::ingest_thread_proc, this);
+	}
+
+	BaseDevice::init_acquisition();
+}
+
+void HardwareDevice::stop_ingest_thread()
+{
+	if (!ingest_thread_.joinable())
+		return;
+
+	{
+		lock_guard<std::mutex> lock(ingest_mutex_);
+		ingest_running_ = false;
+	}
+	ingest_cond_.notify_one();
+	ingest_thread_.join();
+}
+
+void HardwareDevice::ingest_thread_proc()
+{
+	while (true) {
+		AnalogBatch *batch;
+		if (ingest_queue_.try_pop(batch)) {
+			const AllocationScope allocation_scope;
+			store_batch(*batch);
+			statistics_.add_allocations(allocation_scope.allocations(),
+				allocation_scope.allocated_bytes());
+			statistics_.add_latency(
+				Session::session_time_ns() - batch->received_ns);
+			free_batches_.try_push(batch);
+			continue;
+		}
+
+		// The queue is drained, before the thread exits
+		if (!ingest_running_) {
+			publish_frame();
+			break;
+		}
+
+		/*
+		 * The datafeed only notifies, when it sees ingest_waiting_, so
+		 * the datafeed doesn't have to lock ingest_mutex_ for every packet.
+		 * A notification, that slips between the check of the queue and the
+		 * wait, is caught up by the timeout.
+		 */
+		unique_lock<std::mutex> lock(ingest_mutex_);
+		ingest_waiting_ = true;
+		if (ingest_queue_.empty() && ingest_running_)
+			ingest_cond_.wait_for(lock, std::chrono::milliseconds(10));
+		ingest_waiting_ = false;
+	}
+}
+
+void HardwareDevice::store_batch(AnalogBatch &batch)
+{
+	// Samples outside of a frame are published right away
+	if (!batch.in_frame)
+		publish_frame();
+
+	const float *channel_data = batch.data.data();
+	const size_t stride = batch.channels.size();
+	for (const auto channel : batch.channels) {
+		// Skip the samples of unknown channels
+		if (channel == nullptr) {
+			++channel_data;
+			continue;
+		}
+		auto signal = channel->push_interleaved_samples(channel_data++,
+			batch.num_samples, stride, batch.timestamp, batch.samplerate,
+			batch.meaning, batch.time_column, !batch.in_frame);
+		if (batch.in_frame && std::find(frame_signals_.begin(),
+				frame_signals_.end(), signal) == frame_signals_.end())
+			frame_signals_.push_back(signal);
+		if (batch.in_frame && channel->frame_capture()) {
+			channel->capture_frame_samples(channel_data - 1,
+				batch.num_samples, stride, batch.timestamp, batch.samplerate,
+				batch.meaning);
+			if (std::find(frame_channels_.begin(), frame_channels_.end(),
+					channel) == frame_channels_.end())
+				frame_channels_.push_back(channel);
+		}
+	}
+
+	if (batch.ends_frame)
+		publish_frame();
+}
+
+void HardwareDevice::publish_frame()
+{
+	for (const auto &signal : frame_signals_)
+		signal->publish_samples();
+	frame_signals_.clear();
+	for (const auto &channel : frame_channels_)
+		channel->end_frame_capture();
+	frame_channels_.clear();
+}
+
+void HardwareDevice::queue_batch(AnalogBatch *batch)
+{
+	if (!ingest_queue_.try_push(batch))
+		free_batches_.try_push(batch);
+	if (ingest_waiting_)
+		ingest_cond_.notify_one();
+}
+
+HardwareDevice::AnalogBatch *HardwareDevice::acquire_batch()
+{
+	AnalogBatch *batch;
+	if (free_batches_.try_pop(batch))
+		return batch;
+	// The queues can hold all batches, so they never reject a batch
+	if (batches_.size() >= ingest_queue_.capacity())
+		return nullptr;
+
+	batches_.push_back(unique_ptr<AnalogBatch>(new AnalogBatch()));
+	batch = batches_.back().get();
+	// Meaning id 0 is invalid, so the first meaning is always copied
+	batch->meaning.id = 0;
+	return batch;
 }
 
 void HardwareDevice::feed_in_header()
@@ -238,14 +465,27 @@ void HardwareDevice::feed_in_meta(shared_ptr<sigrok::Meta> sr_meta)
 
 void HardwareDevice::feed_in_frame_begin()
 {
-	// TODO: use std::chrono / std::time
-	frame_start_timestamp_ = QDateTime::currentMSecsSinceEpoch() / (double)1000;
+	frame_start_timestamp_ = Session::timestamp() - timestamp_offset_;
 	frame_began_ = true;
 }
 
 void HardwareDevice::feed_in_frame_end()
 {
 	frame_began_ = false;
+
+	// The ingest thread publishes the samples of the frame with this
+	// (empty) batch. If it is dropped, the next frame end publishes them.
+	lock_guard<recursive_mutex> lock(data_mutex_);
+	AnalogBatch *batch = acquire_batch();
+	if (batch == nullptr)
+		return;
+	batch->num_samples = 0;
+	batch->channels.clear();
+	batch->time_column = nullptr;
+	batch->in_frame = true;
+	batch->ends_frame = true;
+	batch->received_ns = Session::session_time_ns();
+	queue_batch(batch);
 }
 
 void HardwareDevice::feed_in_logic(shared_ptr<sigrok::Logic> sr_logic)
@@ -253,49 +493,137 @@ void HardwareDevice::feed_in_logic(shared_ptr<sigrok::Logic> sr_logic)
 	(void)sr_logic;
 }
 
+const channels::AnalogMeaning &HardwareDevice::decode_analog_meaning(
+	shared_ptr<sigrok::Analog> sr_analog)
+{
+	/*
+	 * NOTE: Sometimes the mq is not set (e.g. for the demo driver in
+	 *       sigrok 6.0.0) and mq() just throws an exception, without a
+	 *       possibility to check if mq is set or not.
+	 */
+	const sigrok::Quantity *sr_mq = nullptr;
+	try {
+		sr_mq = sr_analog->mq();
+	}
+	catch(sigrok::Error &e) {
+		sr_mq = nullptr;
+	}
+	// NOTE: libsigrokcxx only hands out the flags as vector, the raw mask
+	//       of the meaning is not accessible.
+	const uint64_t mq_flags_mask =
+		data::datautil::get_quantity_flags_mask(sr_analog->mq_flags());
+	const sigrok::Unit *sr_unit = sr_analog->unit();
+	const int sr_digits = sr_analog->digits();
+
+	if (analog_meaning_.id != 0 && sr_mq == sr_mq_ &&
+			mq_flags_mask == mq_flags_mask_ && sr_unit == sr_unit_ &&
+			sr_digits == sr_digits_)
+		return analog_meaning_;
+
+	sr_mq_ = sr_mq;
+	mq_flags_mask_ = mq_flags_mask;
+	sr_unit_ = sr_unit;
+	sr_digits_ = sr_digits;
+
+	analog_meaning_.quantity = sr_mq_ ?
+		data::datautil::get_quantity(sr_mq_) : data::Quantity::Unknown;
+	analog_meaning_.quantity_flags =
+		data::datautil::get_quantity_flags_from_mask(mq_flags_mask_);
+	analog_meaning_.measured_quantity = data::MeasuredQuantity(
+		analog_meaning_.quantity, mq_flags_mask_);
+	analog_meaning_.unit = data::datautil::get_unit(sr_unit_);
+
+	/*
+	 * Number of significant digits after the decimal point if positive, or
+	 * number of non-significant digits before the decimal point if negative
+	 * (refers to the value we actually read on the wire).
+	 */
+	analog_meaning_.digits = 7;
+	analog_meaning_.decimal_places = -1;
+	if (sr_digits_ >= 0)
+		analog_meaning_.decimal_places = sr_digits_;
+	else
+		analog_meaning_.digits = -1 * sr_digits_; // TODO
+
+	// Skip the invalid id 0 on overflow
+	if (++analog_meaning_.id == 0)
+		++analog_meaning_.id;
+	return analog_meaning_;
+}
+
 void HardwareDevice::feed_in_analog(shared_ptr<sigrok::Analog> sr_analog)
 {
+	SV_TRACE_SCOPE("HardwareDevice::feed_in_analog");
+	const AllocationScope allocation_scope;
+
 	size_t num_samples = sr_analog->num_samples();
 	if (num_samples == 0)
 		return;
 
 	lock_guard<recursive_mutex> lock(data_mutex_);
 
-	uint64_t samplerate = 0;
+	const int64_t received_ns = Session::session_time_ns();
+	const size_t channel_count = sr_analog->channels().size();
+	AnalogBatch *batch = acquire_batch();
+	if (batch == nullptr) {
+		// The ingest thread can't keep up, drop the packet
+		statistics_.add_dropped_packet(num_samples * channel_count);
+		if (!ingest_dropping_) {
+			qWarning() << "HardwareDevice::feed_in_analog(): Ingest queue " <<
+				"is full, dropping samples of " << short_name();
+			ingest_dropping_ = true;
+		}
+		return;
+	}
+	ingest_dropping_ = false;
+
+	batch->samplerate = 0;
 	if (samplerate_prop_ != nullptr)
-		samplerate = samplerate_prop_->uint64_value();
+		batch->samplerate = samplerate_prop_->uint64_value();
 
 	const vector<shared_ptr<sigrok::Channel>> sr_channels = sr_analog->channels();
-
-	unique_ptr<float[]> data(new float[num_samples * sr_channels.size()]);
-	sr_analog->get_data_as_float(data.get());
-	float *channel_data = data.get();
-
+	const channels::AnalogMeaning &meaning = decode_analog_meaning(sr_analog);
+	// A recycled batch mostly has the same meaning already
+	if (batch->meaning.id != meaning.id)
+		batch->meaning = meaning;
+
+	const size_t buffer_size = num_samples * sr_channels.size();
+	if (batch->data.size() < buffer_size)
+		batch->data.resize(buffer_size);
+	sr_analog->get_data_as_float(batch->data.data());
+	batch->num_samples = num_samples;
+
+	// All channels of a packet (or a frame) are sampled at the same time,
+	// so they get the same timestamp and share the time column. The
+	// latency of the device is taken off, see set_timestamp_offset().
+	if (frame_began_)
+		batch->timestamp = frame_start_timestamp_;
+	else
+		batch->timestamp = Session::timestamp() - timestamp_offset_;
+	if (frame_began_ || sr_channels.size() > 1)
+		batch->time_column = time_column_;
+	else
+		batch->time_column = nullptr;
+	if (batch->timestamp < last_packet_timestamp_)
+		statistics_.add_out_of_order_packet();
+	last_packet_timestamp_ = batch->timestamp;
+	batch->received_ns = received_ns;
+	batch->in_frame = frame_began_;
+	batch->ends_frame = false;
+
+	batch->channels.clear();
 	for (const auto &sr_channel : sr_channels) {
-		/*
-		qWarning() << "HardwareDevice::feed_in_analog(): HardwareDevice = " <<
-			QString::fromStdString(sr_device_->model()) <<
-			", Channel.Id = " <<
-			QString::fromStdString(sr_channel->name()) <<
-			" channel_data = " << *channel_data;
-		*/
-
-		if (sr_channel_map_.count(sr_channel) == 0)
-			assert("Unknown channel");
-		auto channel = static_pointer_cast<channels::HardwareChannel>(
-			sr_channel_map_[sr_channel]);
-
-		// TODO: use std::chrono / std::time
-		double timestamp;
-		if (frame_began_)
-			timestamp = frame_start_timestamp_;
-		else
-			timestamp = QDateTime::currentMSecsSinceEpoch() / (double)1000;
-
-		//channel->push_sample_sr_analog(channel_data++, timestamp, sr_analog);
-		channel->push_interleaved_samples(channel_data++, num_samples,
-			sr_channels.size(), timestamp, samplerate, sr_analog);
+		const unsigned int index = sr_channel->index();
+		batch->channels.push_back(index < sr_channel_table_.size() ?
+			sr_channel_table_[index].get() : nullptr);
 	}
+
+	queue_batch(batch);
+
+	statistics_.add_packet(num_samples * channel_count, received_ns,
+		Session::session_time_ns() - received_ns);
+	statistics_.add_allocations(allocation_scope.allocations(),
+		allocation_scope.allocated_bytes());
 }
 
 } // namespace devices
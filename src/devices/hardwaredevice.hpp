@@ -21,15 +21,24 @@
 #ifndef DEVICES_HARDWAREDEVICE_HPP
 #define DEVICES_HARDWAREDEVICE_HPP
 
+#include <atomic>
+#include <condition_variable>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_set>
+#include <vector>
 
 #include <libsigrokcxx/libsigrokcxx.hpp>
 
 #include <QString>
 
+#include "src/allocationcounter.hpp"
+#include "src/channels/hardwarechannel.hpp"
+#include "src/data/ingestqueue.hpp"
+#include "src/devices/acquisitionstatistics.hpp"
 #include "src/devices/basedevice.hpp"
 
 using std::bad_alloc;
@@ -65,6 +74,8 @@ namespace channels {
 class BaseChannel;
 }
 namespace data {
+class AnalogTimeSignal;
+class TimeColumn;
 namespace properties {
 class UInt64Property;
 }
@@ -72,6 +83,8 @@ class UInt64Property;
 
 namespace devices {
 
+class ConfigWorker;
+class StateMonitor;
 class Configurable;
 
 class HardwareDevice : public BaseDevice
@@ -83,6 +96,8 @@ protected:
 		shared_ptr<sigrok::HardwareDevice> sr_device);
 
 public:
+	~HardwareDevice();
+
 	/**
 	 * Returns the sigrok hardware device
 	 */
@@ -90,6 +105,8 @@ public:
 
 	/**
 	 * Builds the display name. It only contains fields as required.
+	 * The name is cached and only rebuilt, when devices have been added to
+	 * or removed from the device manager.
 	 * @param device_manager a reference to the device manager is needed
 	 * so that other similarly titled devices can be detected.
 	 */
@@ -97,6 +114,22 @@ public:
 
 	void open() override;
 
+	/**
+	 * Return the acquisition statistics (rates, overruns, latencies, ...)
+	 * of this device. Can be called from any thread.
+	 */
+	AcquisitionSummary acquisition_summary() const;
+
+	/**
+	 * Limit the config writes of the controls to max_rate writes per
+	 * second. The writes, that come in faster, are coalesced and only the
+	 * latest value is written, see ConfigWorker. 0 disables the limit.
+	 */
+	void set_max_config_write_rate(double max_rate);
+	double max_config_write_rate() const;
+	/** Return the number of config writes, that are not written yet. */
+	size_t queued_config_write_count() const;
+
 protected:
 	/**
 	 * Init all configurables for this hardware device.
@@ -106,6 +139,10 @@ protected:
 	 * Init all sigrok channles for this hardware device
 	 */
 	void init_channels() override;
+	/**
+	 * Init acquisition and start the ingest thread.
+	 */
+	void init_acquisition() override;
 
 	void feed_in_header() override;
 	void feed_in_trigger() override;
@@ -116,9 +153,119 @@ protected:
 	void feed_in_analog(shared_ptr<sigrok::Analog> sr_analog) override;
 
 private:
+	/** Build the display name, see display_name(). */
+	QString build_display_name(const DeviceManager &device_manager) const;
+
+	/**
+	 * The decoded samples of one analog packet and everything, that is
+	 * needed to store them in the channels.
+	 */
+	struct AnalogBatch
+	{
+		/** The interleaved samples. Only grows, when a batch is recycled. */
+		ScratchVector<float> data;
+		size_t num_samples;
+		/**
+		 * The channels of the interleaved samples, nullptr for an unknown
+		 * channel. The channels are owned by sr_channel_table_.
+		 */
+		ScratchVector<channels::HardwareChannel *> channels;
+		double timestamp;
+		uint64_t samplerate;
+		/** The session time in ns, when the packet was received. */
+		int64_t received_ns;
+		channels::AnalogMeaning meaning;
+		shared_ptr<data::TimeColumn> time_column;
+		/**
+		 * The samples of a frame are published, when the batch, that ends
+		 * the frame, is stored. This batch has no samples.
+		 */
+		bool in_frame;
+		bool ends_frame;
+	};
+
+	/**
+	 * Return a free batch or nullptr, if all batches are in use.
+	 */
+	AnalogBatch *acquire_batch();
+	void ingest_thread_proc();
+	/** Store the samples of the batch in its channels. */
+	void store_batch(AnalogBatch &batch);
+	/** Publish the samples of the current frame in all signals at once. */
+	void publish_frame();
+	/** Queue the batch for the ingest thread. */
+	void queue_batch(AnalogBatch *batch);
+	void stop_ingest_thread();
+
+	/**
+	 * Return the decoded meaning of the packet. The meaning is only
+	 * re-resolved, when the raw sigrok meaning has changed.
+	 */
+	const channels::AnalogMeaning &decode_analog_meaning(
+		shared_ptr<sigrok::Analog> sr_analog);
+
 	double frame_start_timestamp_;
+	/**
+	 * The timestamps of all channels, that are delivered in one frame or in
+	 * one packet, are shared in this column.
+	 */
+	shared_ptr<data::TimeColumn> time_column_;
+	/**
+	 * The analog packets are decoded in the datafeed callback and then
+	 * stored by the ingest thread, so the sigrok session is never blocked by
+	 * compression, spilling or a signal, that is locked by a reader.
+	 */
+	static const unsigned int ingest_queue_size_exp_;
+	data::IngestQueue<AnalogBatch *> ingest_queue_;
+	/** The stored batches go back to the datafeed for reuse. */
+	data::IngestQueue<AnalogBatch *> free_batches_;
+	/** Owns all batches. Only grows in the datafeed. */
+	vector<unique_ptr<AnalogBatch>> batches_;
+	std::thread ingest_thread_;
+	std::mutex ingest_mutex_;
+	std::condition_variable ingest_cond_;
+	std::atomic<bool> ingest_running_;
+	/** Set by the ingest thread, while it is waiting for the next batch. */
+	std::atomic<bool> ingest_waiting_;
+	AcquisitionStatistics statistics_;
+	/** The timestamp of the previous packet, to detect out of order packets. */
+	double last_packet_timestamp_;
+	/** Only warn once, until the ingest thread has caught up again. */
+	bool ingest_dropping_;
+	/**
+	 * The signals, that got samples of the current frame. Only used by the
+	 * ingest thread.
+	 */
+	vector<shared_ptr<data::AnalogTimeSignal>> frame_signals_;
+	/**
+	 * The channels with frame capture, that got samples of the current
+	 * frame. Only used by the ingest thread.
+	 */
+	vector<channels::HardwareChannel *> frame_channels_;
+	/** The raw sigrok meaning of the last packet and its decoded form. */
+	const sigrok::Quantity *sr_mq_;
+	/** The decoded QuantityFlags as mask, see data::MeasuredQuantity. */
+	uint64_t mq_flags_mask_;
+	const sigrok::Unit *sr_unit_;
+	int sr_digits_;
+	channels::AnalogMeaning analog_meaning_;
 	uint64_t cur_samplerate_;
 	shared_ptr<data::properties::UInt64Property> samplerate_prop_;
+	/**
+	 * The channels mapped by their sigrok channel index, so the channels of
+	 * a packet are resolved without a map lookup. Gaps are nullptr.
+	 */
+	vector<shared_ptr<channels::HardwareChannel>> sr_channel_table_;
+	/** Serializes the config I/O of all configurables of this device. */
+	shared_ptr<ConfigWorker> config_worker_;
+	/** Polls the states, that are watched by the views. */
+	shared_ptr<StateMonitor> state_monitor_;
+
+	mutable std::mutex display_name_mutex_;
+	mutable QString display_name_;
+	/** The device manager and its generation of the cached display name. */
+	mutable const DeviceManager *display_name_manager_;
+	mutable unsigned int display_name_generation_;
 
 };
 
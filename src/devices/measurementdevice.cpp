@@ -51,9 +51,9 @@ void MeasurementDevice::init_configurables()
 		if (configurable->property_map().count(ConfigKey::Range) > 0 &&
 			configurable->property_map().count(ConfigKey::MeasuredQuantity) > 0) {
 
-			auto range_property = configurable->property_map()[ConfigKey::Range];
+			auto range_property = configurable->property_map().at(ConfigKey::Range);
 			auto mq_property =
-				configurable->property_map()[ConfigKey::MeasuredQuantity];
+				configurable->property_map().at(ConfigKey::MeasuredQuantity);
 			connect(
 				mq_property.get(), &data::properties::BaseProperty::value_changed,
 				range_property.get(), &data::properties::BaseProperty::list_config);
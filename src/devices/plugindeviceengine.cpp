@@ -0,0 +1,193 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <QDebug>
+#include <QString>
+
+#include "plugindeviceengine.hpp"
+#include "src/session.hpp"
+#include "src/channels/userchannel.hpp"
+#include "src/data/datautil.hpp"
+#include "src/devices/userdevice.hpp"
+#include "src/plugins/smuviewplugin.h"
+
+using std::lock_guard;
+using std::string;
+using std::unique_lock;
+using std::vector;
+
+namespace sv {
+namespace devices {
+
+PluginDeviceEngine::PluginDeviceEngine(shared_ptr<UserDevice> device,
+		const sv_virtual_device *virtual_device, const string &args) :
+	device_(device),
+	virtual_device_(virtual_device),
+	instance_(nullptr),
+	timestamps_(virtual_device->max_samples),
+	values_(virtual_device->channel_count,
+		vector<double>(virtual_device->max_samples)),
+	value_ptrs_(virtual_device->channel_count, nullptr),
+	stop_(false),
+	running_(false),
+	acquired_count_(0)
+{
+	instance_ = virtual_device_->create(args.c_str());
+	if (!instance_) {
+		qWarning() << "PluginDeviceEngine::PluginDeviceEngine(): Can't" <<
+			"create the virtual device" << virtual_device_->id <<
+			"with the arguments" << QString::fromStdString(args);
+		return;
+	}
+
+	for (unsigned int i = 0; i < virtual_device_->channel_count; ++i) {
+		const sv_virtual_channel &sv_channel = *virtual_device_->channels[i];
+		Channel channel;
+		channel.channel = device_->add_user_channel(sv_channel.name, "");
+		channel.quantity = data::datautil::get_quantity(sv_channel.quantity);
+		channel.quantity_flags =
+			data::datautil::get_quantity_flags(sv_channel.quantity_flags);
+		channel.unit = data::datautil::get_unit(sv_channel.unit);
+		channel.digits = sv_channel.digits;
+		channel.decimal_places = sv_channel.decimal_places;
+		channels_.push_back(channel);
+		value_ptrs_[i] = values_[i].data();
+	}
+}
+
+PluginDeviceEngine::~PluginDeviceEngine()
+{
+	stop();
+	if (instance_)
+		virtual_device_->destroy(instance_);
+}
+
+bool PluginDeviceEngine::is_valid() const
+{
+	return instance_ != nullptr;
+}
+
+shared_ptr<UserDevice> PluginDeviceEngine::device() const
+{
+	return device_;
+}
+
+string PluginDeviceEngine::virtual_device_id() const
+{
+	return virtual_device_->id;
+}
+
+void PluginDeviceEngine::start()
+{
+	// A failed acquisition must still be joined
+	stop();
+	if (!instance_)
+		return;
+
+	stop_ = false;
+	running_ = true;
+	thread_ = std::thread(&PluginDeviceEngine::thread_proc, this);
+}
+
+void PluginDeviceEngine::stop()
+{
+	if (!thread_.joinable())
+		return;
+
+	{
+		lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+	}
+	stop_cond_.notify_one();
+	thread_.join();
+	running_ = false;
+}
+
+bool PluginDeviceEngine::is_running() const
+{
+	return running_;
+}
+
+uint64_t PluginDeviceEngine::acquired_count() const
+{
+	return acquired_count_;
+}
+
+void PluginDeviceEngine::thread_proc()
+{
+	const auto interval =
+		std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+			std::chrono::duration<double>(1. / virtual_device_->acquire_rate));
+	const auto start_time = std::chrono::steady_clock::now();
+	const double start_timestamp = Session::timestamp();
+	auto next_time = start_time;
+	while (!stop_) {
+		const double time = std::chrono::duration<double>(
+			std::chrono::steady_clock::now() - start_time).count();
+		size_t count = 0;
+		if (virtual_device_->acquire(instance_, time, &count,
+				timestamps_.data(), value_ptrs_.data()) != 0) {
+			qWarning() << "PluginDeviceEngine::thread_proc(): The virtual" <<
+				"device" << virtual_device_->id << "has failed, the" <<
+				"acquisition stops";
+			break;
+		}
+		count = std::min(count, virtual_device_->max_samples);
+		if (count > 0) {
+			for (size_t i = 0; i < count; ++i)
+				timestamps_[i] += start_timestamp;
+			for (size_t i = 0; i < channels_.size(); ++i) {
+				const Channel &channel = channels_[i];
+				channel.channel->push_samples(values_[i].data(),
+					timestamps_.data(), count, channel.quantity,
+					channel.quantity_flags, channel.unit, channel.digits,
+					channel.decimal_places);
+			}
+			acquired_count_ += count;
+		}
+
+		// Skip the acquisition times, that were missed
+		next_time += interval;
+		const auto now = std::chrono::steady_clock::now();
+		if (next_time < now)
+			next_time += ((now - next_time) / interval + 1) * interval;
+
+		unique_lock<std::mutex> lock(mutex_);
+		if (stop_cond_.wait_until(lock, next_time,
+				[this] { return stop_.load(); }))
+			break;
+	}
+
+	running_ = false;
+}
+
+} // namespace devices
+} // namespace sv
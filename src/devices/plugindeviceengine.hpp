@@ -0,0 +1,119 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEVICES_PLUGINDEVICEENGINE_HPP
+#define DEVICES_PLUGINDEVICEENGINE_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "src/data/datautil.hpp"
+#include "src/plugins/smuviewplugin.h"
+
+using std::set;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+
+namespace channels {
+class UserChannel;
+}
+
+namespace devices {
+
+class UserDevice;
+
+/**
+ * Runs the virtual device of a native plugin (see plugins::PluginManager)
+ * on a user device. A user channel is added for every channel of the
+ * virtual device and the samples, that acquire() returns, are pushed to
+ * them in a dedicated thread.
+ *
+ * The acquisition times don't drift, when acquire() takes longer than its
+ * interval, the missed times are skipped.
+ */
+class PluginDeviceEngine
+{
+public:
+	/**
+	 * The instance of the virtual device is created with args, check it
+	 * with is_valid().
+	 */
+	PluginDeviceEngine(shared_ptr<UserDevice> device,
+		const sv_virtual_device *virtual_device, const string &args);
+	~PluginDeviceEngine();
+
+	PluginDeviceEngine(const PluginDeviceEngine &) = delete;
+	PluginDeviceEngine &operator=(const PluginDeviceEngine &) = delete;
+
+	/** Return false, if the instance couldn't be created. */
+	bool is_valid() const;
+	shared_ptr<UserDevice> device() const;
+	string virtual_device_id() const;
+
+	void start();
+	void stop();
+	/** Return false, when stopped or when acquire() has failed. */
+	bool is_running() const;
+	/** Return the number of acquired samples per channel. */
+	uint64_t acquired_count() const;
+
+private:
+	struct Channel
+	{
+		shared_ptr<channels::UserChannel> channel;
+		data::Quantity quantity;
+		set<data::QuantityFlag> quantity_flags;
+		data::Unit unit;
+		int digits;
+		int decimal_places;
+	};
+
+	void thread_proc();
+
+	shared_ptr<UserDevice> device_;
+	const sv_virtual_device *virtual_device_;
+	void *instance_;
+	vector<Channel> channels_;
+	vector<double> timestamps_;
+	vector<vector<double>> values_;
+	vector<double *> value_ptrs_;
+
+	std::thread thread_;
+	std::mutex mutex_;
+	std::condition_variable stop_cond_;
+	std::atomic<bool> stop_;
+	std::atomic<bool> running_;
+	std::atomic<uint64_t> acquired_count_;
+
+};
+
+} // namespace devices
+} // namespace sv
+
+#endif // DEVICES_PLUGINDEVICEENGINE_HPP
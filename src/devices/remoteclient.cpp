@@ -0,0 +1,509 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <QDebug>
+#include <QString>
+#include <QTcpSocket>
+#include <QThread>
+
+#include "remoteclient.hpp"
+#include "src/channels/userchannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/datautil.hpp"
+#include "src/data/minmaxpyramid.hpp"
+#include "src/data/remoteprotocol.hpp"
+#include "src/devices/userdevice.hpp"
+
+using std::dynamic_pointer_cast;
+using std::lock_guard;
+using std::shared_ptr;
+using std::string;
+using std::unique_lock;
+using std::vector;
+
+namespace sv {
+namespace devices {
+
+const int RemoteClient::poll_interval_ = 50;
+const double RemoteClient::reconnect_interval_ = 2.;
+const int RemoteClient::connect_timeout_ = 3000;
+
+RemoteClient::RemoteClient(shared_ptr<UserDevice> device) :
+	device_(device),
+	port_(0),
+	hello_received_(false),
+	next_request_id_(1),
+	stop_(false),
+	running_(false),
+	connected_(false),
+	received_sample_count_(0)
+{
+}
+
+RemoteClient::~RemoteClient()
+{
+	stop();
+}
+
+bool RemoteClient::start(const string &host, uint16_t port)
+{
+	stop();
+
+	if (host.empty()) {
+		qWarning() << "RemoteClient::start(): No host";
+		return false;
+	}
+
+	host_ = host;
+	port_ = port;
+	received_sample_count_ = 0;
+	stop_ = false;
+	running_ = true;
+	thread_ = std::thread(&RemoteClient::thread_proc, this);
+	return true;
+}
+
+void RemoteClient::stop()
+{
+	{
+		lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+	}
+	stop_cond_.notify_all();
+	if (thread_.joinable())
+		thread_.join();
+	running_ = false;
+	connected_ = false;
+	replies_cond_.notify_all();
+}
+
+bool RemoteClient::is_running() const
+{
+	return running_;
+}
+
+bool RemoteClient::is_connected() const
+{
+	return connected_;
+}
+
+shared_ptr<UserDevice> RemoteClient::device() const
+{
+	return device_;
+}
+
+size_t RemoteClient::received_sample_count() const
+{
+	return received_sample_count_;
+}
+
+map<string, string> RemoteClient::properties() const
+{
+	lock_guard<std::mutex> lock(properties_mutex_);
+	return properties_;
+}
+
+vector<data::AnalogSummary> RemoteClient::get_summaries(
+	shared_ptr<data::AnalogTimeSignal> signal,
+	double start_timestamp, double end_timestamp, size_t count,
+	double timeout)
+{
+	uint32_t signal_id = 0;
+	{
+		lock_guard<std::mutex> lock(signals_mutex_);
+		for (const auto &signal_pair : signals_) {
+			if (signal_pair.second.signal == signal) {
+				signal_id = signal_pair.first;
+				break;
+			}
+		}
+	}
+	if (signal_id == 0 || count == 0 || !connected_)
+		return vector<data::AnalogSummary>();
+
+	unique_lock<std::mutex> lock(requests_mutex_);
+	const uint32_t request_id = next_request_id_++;
+	data::RemoteMessage message;
+	message.begin(data::RemoteMessageType::LodRequest);
+	message.append_u32(request_id);
+	message.append_u32(signal_id);
+	message.append_f64(start_timestamp);
+	message.append_f64(end_timestamp);
+	message.append_u32((uint32_t)std::min(count, (size_t)UINT32_MAX));
+	message.end();
+	requests_ += message.buffer();
+
+	replies_cond_.wait_for(lock, std::chrono::duration<double>(timeout),
+		[this, request_id]() {
+			return replies_.count(request_id) > 0 || !running_;
+		});
+	vector<data::AnalogSummary> summaries;
+	auto it = replies_.find(request_id);
+	if (it != replies_.end()) {
+		summaries.swap(it->second);
+		replies_.erase(it);
+	}
+	return summaries;
+}
+
+bool RemoteClient::set_property(const string &device_name,
+	const string &configurable_name, const string &property_name,
+	const string &value, double timeout)
+{
+	if (!connected_)
+		return false;
+
+	unique_lock<std::mutex> lock(requests_mutex_);
+	const uint32_t request_id = next_request_id_++;
+	data::RemoteMessage message;
+	message.begin(data::RemoteMessageType::PropertyWrite);
+	message.append_u32(request_id);
+	message.append_string(device_name);
+	message.append_string(configurable_name);
+	message.append_string(property_name);
+	message.append_string(value);
+	message.end();
+	requests_ += message.buffer();
+
+	replies_cond_.wait_for(lock, std::chrono::duration<double>(timeout),
+		[this, request_id]() {
+			return write_replies_.count(request_id) > 0 || !running_;
+		});
+	auto it = write_replies_.find(request_id);
+	if (it == write_replies_.end()) {
+		qWarning() << "RemoteClient::set_property(): No answer for" <<
+			QString::fromStdString(property_name);
+		return false;
+	}
+	const std::pair<bool, string> reply = it->second;
+	write_replies_.erase(it);
+	if (!reply.first) {
+		qWarning() << "RemoteClient::set_property():" <<
+			QString::fromStdString(property_name) << "was rejected:" <<
+			QString::fromStdString(reply.second);
+	}
+	return reply.first;
+}
+
+void RemoteClient::release_control()
+{
+	data::RemoteMessage message;
+	message.begin(data::RemoteMessageType::ReleaseControl);
+	message.end();
+	lock_guard<std::mutex> lock(requests_mutex_);
+	requests_ += message.buffer();
+}
+
+void RemoteClient::thread_proc()
+{
+	// The socket is used with the blocking functions, this thread has no
+	// event loop.
+	QTcpSocket socket;
+	auto last_connect = std::chrono::steady_clock::time_point();
+	bool first_connect = true;
+	while (!stop_) {
+		if (!connected_) {
+			const auto now = std::chrono::steady_clock::now();
+			if (!first_connect && std::chrono::duration<double>(
+					now - last_connect).count() < reconnect_interval_) {
+				unique_lock<std::mutex> lock(mutex_);
+				stop_cond_.wait_for(lock,
+					std::chrono::milliseconds(poll_interval_),
+					[this]() { return stop_.load(); });
+				continue;
+			}
+			first_connect = false;
+			last_connect = now;
+			if (!connect_socket(socket))
+				continue;
+		}
+
+		bool ok = send_requests(socket);
+		if (ok && socket.waitForReadyRead(poll_interval_))
+			receive_buffer_ += socket.readAll().toStdString();
+		ok = ok && handle_messages();
+		if (!ok || socket.state() != QAbstractSocket::ConnectedState) {
+			qWarning() << "RemoteClient: The connection to" <<
+				QString::fromStdString(host_) << "was lost";
+			socket.abort();
+			connected_ = false;
+		}
+	}
+
+	socket.abort();
+	connected_ = false;
+	running_ = false;
+}
+
+bool RemoteClient::connect_socket(QTcpSocket &socket)
+{
+	socket.abort();
+	socket.connectToHost(QString::fromStdString(host_), port_);
+	if (!socket.waitForConnected(connect_timeout_)) {
+		qWarning() << "RemoteClient: Connecting to" <<
+			QString::fromStdString(host_) << port_ << "failed:" <<
+			socket.errorString();
+		socket.abort();
+		return false;
+	}
+	socket.setSocketOption(QAbstractSocket::LowDelayOption, 1);
+
+	receive_buffer_.clear();
+	hello_received_ = false;
+	{
+		// The requests of the lost connection are not answered anymore
+		lock_guard<std::mutex> lock(requests_mutex_);
+		requests_.clear();
+	}
+	connected_ = true;
+	return true;
+}
+
+bool RemoteClient::send_requests(QTcpSocket &socket)
+{
+	string requests;
+	{
+		lock_guard<std::mutex> lock(requests_mutex_);
+		requests.swap(requests_);
+	}
+	if (requests.empty())
+		return true;
+
+	const qint64 size = (qint64)requests.size();
+	if (socket.write(requests.data(), size) != size)
+		return false;
+	socket.flush();
+	return true;
+}
+
+bool RemoteClient::handle_messages()
+{
+	size_t pos = 0;
+	uint32_t type;
+	size_t payload_pos;
+	size_t payload_size;
+	bool error = false;
+	bool ok = true;
+	while (ok && data::next_remote_message(receive_buffer_, pos,
+			type, payload_pos, payload_size, error)) {
+		const char *payload = receive_buffer_.data() + payload_pos;
+		if (!hello_received_) {
+			data::RemoteMessageReader reader(payload, payload_size);
+			const uint32_t version = reader.read_u32();
+			if (type != (uint32_t)data::RemoteMessageType::Hello ||
+					version != data::remote_protocol_version) {
+				qWarning() << "RemoteClient: The server" <<
+					QString::fromStdString(host_) <<
+					"uses an unsupported protocol";
+				ok = false;
+			}
+			hello_received_ = true;
+			continue;
+		}
+
+		switch ((data::RemoteMessageType)type) {
+		case data::RemoteMessageType::Signal:
+			ok = handle_signal(payload, payload_size);
+			break;
+		case data::RemoteMessageType::SignalRemoved:
+		{
+			// The channel and its samples stay in the device
+			data::RemoteMessageReader reader(payload, payload_size);
+			const uint32_t signal_id = reader.read_u32();
+			lock_guard<std::mutex> lock(signals_mutex_);
+			signals_.erase(signal_id);
+			break;
+		}
+		case data::RemoteMessageType::Samples:
+			ok = handle_samples(payload, payload_size);
+			break;
+		case data::RemoteMessageType::Property:
+			ok = handle_property(payload, payload_size);
+			break;
+		case data::RemoteMessageType::LodReply:
+			ok = handle_lod_reply(payload, payload_size);
+			break;
+		case data::RemoteMessageType::PropertyWriteReply:
+			ok = handle_write_reply(payload, payload_size);
+			break;
+		default:
+			// Unknown messages of newer servers are skipped
+			break;
+		}
+	}
+	receive_buffer_.erase(0, pos);
+	return ok && !error;
+}
+
+bool RemoteClient::handle_signal(const char *data, size_t size)
+{
+	data::RemoteMessageReader reader(data, size);
+	const uint32_t signal_id = reader.read_u32();
+	const string device_name = reader.read_string();
+	reader.read_string(); // The remote channel group
+	const string channel_name = reader.read_string();
+	const string signal_name = reader.read_string();
+	const auto quantity = (data::Quantity)reader.read_u32();
+	const auto quantity_flags =
+		data::get_quantity_flags_from_mask(reader.read_u64());
+	const auto unit = (data::Unit)reader.read_u32();
+	if (!reader.ok())
+		return false;
+
+	lock_guard<std::mutex> lock(signals_mutex_);
+	if (signals_.count(signal_id) > 0)
+		return true;
+
+	// The channels and signals are created in this thread, like the
+	// signals of a hardware device in its aquisition thread, and then
+	// moved to the thread of the device.
+	const string name = device_name.empty() ?
+		channel_name : device_name + ": " + channel_name;
+	auto &channel = channels_[name];
+	if (!channel) {
+		channel = device_->add_user_channel(name, device_name);
+		channel->moveToThread(device_->thread());
+	}
+
+	// A reconnect to a restarted server gets new ids for the same signals
+	RemoteSignal remote_signal;
+	remote_signal.channel = channel;
+	const data::MeasuredQuantity measured_quantity(quantity,
+		data::get_quantity_flags_mask(quantity_flags));
+	for (const auto &signal : channel->signals()) {
+		if (signal->measured_quantity() == measured_quantity &&
+				signal->name() == signal_name) {
+			remote_signal.signal =
+				dynamic_pointer_cast<data::AnalogTimeSignal>(signal);
+			break;
+		}
+	}
+	if (!remote_signal.signal) {
+		remote_signal.signal = dynamic_pointer_cast<data::AnalogTimeSignal>(
+			channel->add_signal(quantity, quantity_flags, unit, signal_name));
+		if (!remote_signal.signal)
+			return true;
+		remote_signal.signal->moveToThread(device_->thread());
+	}
+	signals_.insert(std::make_pair(signal_id, remote_signal));
+	return true;
+}
+
+bool RemoteClient::handle_samples(const char *data, size_t size)
+{
+	data::RemoteMessageReader reader(data, size);
+	uint32_t signal_id;
+	int digits;
+	int decimal_places;
+	vector<double> timestamps;
+	vector<double> values;
+	if (!reader.read_samples(signal_id, digits, decimal_places,
+			timestamps, values))
+		return false;
+
+	shared_ptr<data::AnalogTimeSignal> signal;
+	{
+		lock_guard<std::mutex> lock(signals_mutex_);
+		auto it = signals_.find(signal_id);
+		if (it == signals_.end())
+			return true;
+		signal = it->second.signal;
+	}
+	signal->push_samples(timestamps.data(), values.data(), timestamps.size(),
+		digits, decimal_places);
+	received_sample_count_ += timestamps.size();
+	return true;
+}
+
+bool RemoteClient::handle_property(const char *data, size_t size)
+{
+	data::RemoteMessageReader reader(data, size);
+	const string device_name = reader.read_string();
+	const string configurable_name = reader.read_string();
+	const string property_name = reader.read_string();
+	const string value = reader.read_string();
+	if (!reader.ok())
+		return false;
+
+	lock_guard<std::mutex> lock(properties_mutex_);
+	properties_[device_name + "/" + configurable_name + "/" + property_name] =
+		value;
+	return true;
+}
+
+bool RemoteClient::handle_lod_reply(const char *data, size_t size)
+{
+	data::RemoteMessageReader reader(data, size);
+	const uint32_t request_id = reader.read_u32();
+	const uint32_t count = reader.read_u32();
+	// 44 bytes per summary
+	if (!reader.ok() || count > size / 44)
+		return false;
+
+	vector<data::AnalogSummary> summaries(count);
+	for (auto &summary : summaries) {
+		summary.start_timestamp = reader.read_f64();
+		summary.end_timestamp = reader.read_f64();
+		summary.min = reader.read_f64();
+		summary.max = reader.read_f64();
+		summary.mean = reader.read_f64();
+		summary.sample_count = reader.read_u32();
+		summary.rms = 0.;
+		summary.integral = 0.;
+		summary.slope = 0.;
+	}
+	if (!reader.ok())
+		return false;
+
+	{
+		lock_guard<std::mutex> lock(requests_mutex_);
+		replies_[request_id] = summaries;
+	}
+	replies_cond_.notify_all();
+	return true;
+}
+
+bool RemoteClient::handle_write_reply(const char *data, size_t size)
+{
+	data::RemoteMessageReader reader(data, size);
+	const uint32_t request_id = reader.read_u32();
+	const bool accepted = reader.read_u8() != 0;
+	const string error = reader.read_string();
+	if (!reader.ok())
+		return false;
+
+	{
+		lock_guard<std::mutex> lock(requests_mutex_);
+		write_replies_[request_id] = std::make_pair(accepted, error);
+	}
+	replies_cond_.notify_all();
+	return true;
+}
+
+} // namespace devices
+} // namespace sv
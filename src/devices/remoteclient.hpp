@@ -0,0 +1,200 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEVICES_REMOTECLIENT_HPP
+#define DEVICES_REMOTECLIENT_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "src/data/minmaxpyramid.hpp"
+
+using std::map;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+class QTcpSocket;
+
+namespace sv {
+
+namespace channels {
+class UserChannel;
+}
+
+namespace data {
+class AnalogTimeSignal;
+}
+
+namespace devices {
+
+class UserDevice;
+
+/**
+ * Mirrors the signals and properties of a RemoteServer in a user device,
+ * e.g. the instruments of a headless SmuView on the bench in the GUI on the
+ * desk.
+ *
+ * Every remote signal gets a user channel "<device>: <channel>" in the
+ * channel group of its remote device. The samples are pushed to the local
+ * signals, while they arrive, so the views, math channels and exports work
+ * like with a local device. The only way back to the instruments are the
+ * property writes of set_property(), that are arbitrated by the server.
+ *
+ * The history before the connection stays on the server. It can be read
+ * with get_summaries() in the resolution of a plot, so only the visible
+ * resolution crosses the network.
+ *
+ * A background thread receives the messages and reconnects a lost
+ * connection every reconnect interval.
+ */
+class RemoteClient
+{
+public:
+	explicit RemoteClient(shared_ptr<UserDevice> device);
+	/** Stops the client. */
+	~RemoteClient();
+
+	RemoteClient(const RemoteClient &) = delete;
+	RemoteClient &operator=(const RemoteClient &) = delete;
+
+	/**
+	 * Connect to the server, a running client is stopped. Connecting is done
+	 * by the background thread.
+	 *
+	 * @return false if there is no host.
+	 */
+	bool start(const string &host, uint16_t port);
+	void stop();
+	bool is_running() const;
+	bool is_connected() const;
+
+	shared_ptr<UserDevice> device() const;
+	/** Return the number of received samples of all signals. */
+	size_t received_sample_count() const;
+
+	/**
+	 * Return the latest values of the remote properties. The key is
+	 * "<device>/<configurable>/<property>".
+	 */
+	map<string, string> properties() const;
+
+	/**
+	 * Request the min/max/mean of count bins of the time range [start,
+	 * end] of a mirrored signal from the server, like
+	 * AnalogTimeSignal::get_summaries() with absolute timestamps. Only the
+	 * start and end timestamps, min, max, mean and sample count of the
+	 * summaries are set. Blocks until the answer arrives.
+	 *
+	 * @return The summaries of the bins with samples, no summaries if the
+	 *         signal is not mirrored or the server didn't answer in time.
+	 */
+	vector<data::AnalogSummary> get_summaries(
+		shared_ptr<data::AnalogTimeSignal> signal,
+		double start_timestamp, double end_timestamp, size_t count,
+		double timeout = 5.);
+
+	/**
+	 * Set a property of a remote device. The server arbitrates the writes
+	 * of its clients: This client gets the control of the devices, until it
+	 * releases it, see release_control(). Blocks until the server has
+	 * accepted or rejected the write. The written value is announced by
+	 * the server like every other property change, see properties().
+	 *
+	 * @return false if the write was rejected (e.g. another client has the
+	 *         control) or the server didn't answer in time.
+	 */
+	bool set_property(const string &device_name,
+		const string &configurable_name, const string &property_name,
+		const string &value, double timeout = 5.);
+	/** Release the control of the remote devices. */
+	void release_control();
+
+private:
+	struct RemoteSignal
+	{
+		shared_ptr<channels::UserChannel> channel;
+		shared_ptr<data::AnalogTimeSignal> signal;
+	};
+
+	void thread_proc();
+	bool connect_socket(QTcpSocket &socket);
+	/** Handle all complete messages in the receive buffer. */
+	bool handle_messages();
+	bool handle_signal(const char *data, size_t size);
+	bool handle_samples(const char *data, size_t size);
+	bool handle_property(const char *data, size_t size);
+	bool handle_lod_reply(const char *data, size_t size);
+	bool handle_write_reply(const char *data, size_t size);
+	/** Write the queued requests. */
+	bool send_requests(QTcpSocket &socket);
+
+	static const int poll_interval_;
+	static const double reconnect_interval_;
+	static const int connect_timeout_;
+
+	shared_ptr<UserDevice> device_;
+	string host_;
+	uint16_t port_;
+	string receive_buffer_;
+	bool hello_received_;
+
+	/** Guards signals_, they are added by the client thread. */
+	mutable std::mutex signals_mutex_;
+	/** The mirrored signals by their remote signal id. */
+	map<uint32_t, RemoteSignal> signals_;
+	/** The user channels by their name, they are kept on reconnects. */
+	map<string, shared_ptr<channels::UserChannel>> channels_;
+
+	mutable std::mutex properties_mutex_;
+	map<string, string> properties_;
+
+	/** Guards the requests and the replies. */
+	std::mutex requests_mutex_;
+	std::condition_variable replies_cond_;
+	string requests_;
+	uint32_t next_request_id_;
+	map<uint32_t, vector<data::AnalogSummary>> replies_;
+	/** The accepted flag and the error of the property writes. */
+	map<uint32_t, std::pair<bool, string>> write_replies_;
+
+	std::thread thread_;
+	/** Guards stop_ for the condition. */
+	std::mutex mutex_;
+	std::condition_variable stop_cond_;
+	std::atomic<bool> stop_;
+	std::atomic<bool> running_;
+	std::atomic<bool> connected_;
+	std::atomic<size_t> received_sample_count_;
+
+};
+
+} // namespace devices
+} // namespace sv
+
+#endif // DEVICES_REMOTECLIENT_HPP
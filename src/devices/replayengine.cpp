@@ -0,0 +1,242 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <QDebug>
+#include <QString>
+
+#include "replayengine.hpp"
+#include "src/session.hpp"
+#include "src/channels/userchannel.hpp"
+#include "src/data/csvreader.hpp"
+#include "src/data/datautil.hpp"
+#include "src/devices/userdevice.hpp"
+
+using std::lock_guard;
+using std::set;
+using std::string;
+using std::unique_lock;
+using std::vector;
+
+namespace sv {
+namespace devices {
+
+ReplayEngine::ReplayEngine(shared_ptr<UserDevice> device) :
+	device_(device),
+	stop_(false),
+	running_(false),
+	replayed_count_(0)
+{
+}
+
+ReplayEngine::~ReplayEngine()
+{
+	stop();
+}
+
+bool ReplayEngine::load_csv(const string &file_name, const string &separator)
+{
+	if (thread_.joinable()) {
+		qWarning() << "ReplayEngine::load_csv(): Replay is running";
+		return false;
+	}
+
+	data::CsvReader reader(separator);
+	if (!reader.open(file_name)) {
+		qWarning() << "ReplayEngine::load_csv(): Can't open " <<
+			QString::fromStdString(file_name);
+		return false;
+	}
+
+	// The four header lines: device, channel groups, channel and signal
+	vector<vector<string>> header;
+	while (header.size() < 4 && reader.read_record()) {
+		vector<string> names;
+		for (size_t i = 0; i < reader.field_count(); ++i)
+			names.push_back(reader.field(i));
+		header.push_back(names);
+	}
+	if (header.size() < 4) {
+		qWarning() << "ReplayEngine::load_csv(): Missing header in " <<
+			QString::fromStdString(file_name);
+		return false;
+	}
+
+	// Separate timestamps come in (time, value) pairs, combined timestamps
+	// in a single time column in front of the values.
+	const vector<string> &signal_names = header[3];
+	const bool combined = signal_names[0] == "Time";
+	vector<size_t> time_columns;
+	vector<size_t> value_columns;
+	for (size_t i = combined ? 1 : 0; i < signal_names.size();
+			i += combined ? 1 : 2) {
+		time_columns.push_back(combined ? 0 : i);
+		value_columns.push_back(combined ? i : i + 1);
+	}
+
+	const size_t first_channel = channels_.size();
+	for (size_t i = 0; i < value_columns.size(); ++i) {
+		const size_t column = value_columns[i];
+		if (column >= signal_names.size())
+			break;
+
+		// The channel names must be unique in the device
+		string name = signal_names[column];
+		const auto &channel_map = device_->channel_map();
+		for (int n = 2; channel_map.count(name) > 0; ++n)
+			name = signal_names[column] + " " + std::to_string(n);
+		const string &group_name =
+			column < header[0].size() ? header[0][column] : "";
+
+		channels_.push_back(device_->add_user_channel(name, group_name));
+		decimal_places_.push_back(0);
+	}
+
+	const size_t sample_begin = samples_.size();
+	while (reader.read_record()) {
+		for (size_t i = first_channel; i < channels_.size(); ++i) {
+			const size_t time_column = time_columns[i - first_channel];
+			const size_t value_column = value_columns[i - first_channel];
+			// Signals with less samples have empty fields
+			if (reader.field_empty(value_column))
+				continue;
+
+			Sample sample;
+			sample.channel = i;
+			if (!reader.field_double(time_column, sample.timestamp) ||
+					!reader.field_double(value_column, sample.value)) {
+				qWarning() << "ReplayEngine::load_csv(): Invalid sample in line" <<
+					reader.line_number() <<
+					"(only relative timestamps are supported)";
+				return false;
+			}
+			decimal_places_[i] = std::max(decimal_places_[i],
+				reader.field_decimal_places(value_column));
+			samples_.push_back(sample);
+		}
+	}
+
+	// Replay all signals in the order of their timestamps
+	std::stable_sort(samples_.begin() + sample_begin, samples_.end(),
+		[](const Sample &s1, const Sample &s2) {
+			return s1.timestamp < s2.timestamp;
+		});
+	std::inplace_merge(samples_.begin(), samples_.begin() + sample_begin,
+		samples_.end(),
+		[](const Sample &s1, const Sample &s2) {
+			return s1.timestamp < s2.timestamp;
+		});
+	return true;
+}
+
+void ReplayEngine::start(double speed, bool loop)
+{
+	// A finished replay must still be joined
+	stop();
+	if (samples_.empty())
+		return;
+
+	stop_ = false;
+	running_ = true;
+	replayed_count_ = 0;
+	thread_ = std::thread(&ReplayEngine::thread_proc, this, speed, loop);
+}
+
+void ReplayEngine::stop()
+{
+	if (!thread_.joinable())
+		return;
+
+	{
+		lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+	}
+	stop_cond_.notify_one();
+	thread_.join();
+	running_ = false;
+}
+
+bool ReplayEngine::is_running() const
+{
+	return running_;
+}
+
+size_t ReplayEngine::sample_count() const
+{
+	return samples_.size();
+}
+
+uint64_t ReplayEngine::replayed_count() const
+{
+	return replayed_count_;
+}
+
+double ReplayEngine::duration() const
+{
+	if (samples_.empty())
+		return 0.;
+	return samples_.back().timestamp - samples_.front().timestamp;
+}
+
+void ReplayEngine::thread_proc(double speed, bool loop)
+{
+	const set<data::QuantityFlag> quantity_flags;
+	const double first_timestamp = samples_.front().timestamp;
+	do {
+		const auto start_time = std::chrono::steady_clock::now();
+		const double start_timestamp = Session::timestamp();
+		for (const auto &sample : samples_) {
+			const double offset = sample.timestamp - first_timestamp;
+			if (speed > 0) {
+				const auto replay_time = start_time +
+					std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+						std::chrono::duration<double>(offset / speed));
+				unique_lock<std::mutex> lock(mutex_);
+				if (stop_cond_.wait_until(lock, replay_time,
+						[this] { return stop_.load(); }))
+					break;
+			}
+			else if (stop_) {
+				break;
+			}
+
+			channels_[sample.channel]->push_sample(sample.value,
+				start_timestamp + offset, data::Quantity::Unknown,
+				quantity_flags, data::Unit::Unknown, 7,
+				decimal_places_[sample.channel]);
+			++replayed_count_;
+		}
+	} while (loop && !stop_);
+
+	running_ = false;
+}
+
+} // namespace devices
+} // namespace sv
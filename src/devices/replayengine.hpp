@@ -0,0 +1,121 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEVICES_REPLAYENGINE_HPP
+#define DEVICES_REPLAYENGINE_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+
+namespace channels {
+class UserChannel;
+}
+
+namespace devices {
+
+class UserDevice;
+
+/**
+ * Replays a recorded capture through the channels of a user device, so the
+ * signals, math channels and plots get the same load as from a real device.
+ * This gives a reproducible load for profiling without hardware.
+ *
+ * The samples are replayed in the order of their timestamps in a dedicated
+ * thread, in real time, N times faster or as fast as possible. The replayed
+ * samples keep their recorded spacing, starting at the time of the replay.
+ */
+class ReplayEngine
+{
+public:
+	explicit ReplayEngine(shared_ptr<UserDevice> device);
+	~ReplayEngine();
+
+	ReplayEngine(const ReplayEngine &) = delete;
+	ReplayEngine &operator=(const ReplayEngine &) = delete;
+
+	/**
+	 * Load a CSV file, that was saved with relative timestamps by the
+	 * signal save dialog (separate or combined timestamps). A user channel
+	 * is added to the device for every signal in the file. An empty
+	 * separator is detected from the file, see data::CsvReader.
+	 *
+	 * @return false if the file couldn't be parsed.
+	 */
+	bool load_csv(const string &file_name, const string &separator = ",");
+
+	/**
+	 * (Re)start the replay from the first sample.
+	 *
+	 * @param speed The replay speed, 1 is real time. 0 replays as fast as
+	 * possible.
+	 * @param loop Restart the replay, when all samples were replayed.
+	 */
+	void start(double speed, bool loop = false);
+	void stop();
+	bool is_running() const;
+
+	/** Return the number of loaded samples of all signals. */
+	size_t sample_count() const;
+	/** Return the number of replayed samples. */
+	uint64_t replayed_count() const;
+	/** Return the recorded duration in seconds. */
+	double duration() const;
+
+private:
+	struct Sample
+	{
+		double timestamp;
+		size_t channel;
+		double value;
+	};
+
+	void thread_proc(double speed, bool loop);
+
+	shared_ptr<UserDevice> device_;
+	vector<shared_ptr<channels::UserChannel>> channels_;
+	vector<int> decimal_places_;
+	/** All samples, sorted by their timestamp. */
+	vector<Sample> samples_;
+
+	std::thread thread_;
+	std::mutex mutex_;
+	std::condition_variable stop_cond_;
+	std::atomic<bool> stop_;
+	std::atomic<bool> running_;
+	std::atomic<uint64_t> replayed_count_;
+
+};
+
+} // namespace devices
+} // namespace sv
+
+#endif // DEVICES_REPLAYENGINE_HPP
@@ -0,0 +1,218 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <QDebug>
+#include <QString>
+
+#include "scanlistengine.hpp"
+#include "src/channels/userchannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/datautil.hpp"
+#include "src/data/properties/baseproperty.hpp"
+#include "src/data/properties/boolproperty.hpp"
+#include "src/devices/configurable.hpp"
+#include "src/devices/deviceutil.hpp"
+#include "src/devices/userdevice.hpp"
+
+using std::dynamic_pointer_cast;
+using std::lock_guard;
+using std::string;
+using std::unique_lock;
+using std::vector;
+
+namespace sv {
+namespace devices {
+
+ScanListEngine::ScanListEngine(shared_ptr<UserDevice> device,
+		shared_ptr<data::AnalogTimeSignal> signal) :
+	device_(device),
+	signal_(signal),
+	stop_(false),
+	running_(false),
+	cycle_count_(0),
+	timeout_count_(0)
+{
+}
+
+ScanListEngine::~ScanListEngine()
+{
+	stop();
+}
+
+shared_ptr<channels::UserChannel> ScanListEngine::add_channel(
+	shared_ptr<Configurable> configurable, const string &name)
+{
+	if (running_ || !configurable)
+		return nullptr;
+
+	auto enabled = dynamic_pointer_cast<data::properties::BoolProperty>(
+		configurable->get_property(ConfigKey::Enabled));
+	if (!enabled || !enabled->is_setable()) {
+		qWarning() << "ScanListEngine::add_channel(): " <<
+			configurable->display_name() << " can't be enabled";
+		return nullptr;
+	}
+	if (device_->channel_map().count(name) > 0) {
+		qWarning() << "ScanListEngine::add_channel(): Channel " <<
+			QString::fromStdString(name) << " already exists";
+		return nullptr;
+	}
+
+	auto channel = device_->add_user_channel(name, "Scan List");
+	scan_channels_.push_back(ScanChannel{ enabled, channel });
+	return channel;
+}
+
+bool ScanListEngine::start(double settle_time, size_t samples,
+	uint64_t cycles, double timeout)
+{
+	// A finished scan must still be joined
+	stop();
+	if (scan_channels_.empty() || samples == 0)
+		return false;
+
+	stop_ = false;
+	running_ = true;
+	cycle_count_ = 0;
+	timeout_count_ = 0;
+	thread_ = std::thread(&ScanListEngine::thread_proc, this,
+		settle_time, samples, cycles, timeout);
+	return true;
+}
+
+void ScanListEngine::stop()
+{
+	if (!thread_.joinable())
+		return;
+
+	{
+		lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+	}
+	stop_cond_.notify_one();
+	thread_.join();
+	running_ = false;
+}
+
+bool ScanListEngine::is_running() const
+{
+	return running_;
+}
+
+size_t ScanListEngine::channel_count() const
+{
+	return scan_channels_.size();
+}
+
+uint64_t ScanListEngine::cycle_count() const
+{
+	return cycle_count_;
+}
+
+uint64_t ScanListEngine::timeout_count() const
+{
+	return timeout_count_;
+}
+
+bool ScanListEngine::wait(double duration)
+{
+	unique_lock<std::mutex> lock(mutex_);
+	return !stop_cond_.wait_for(lock, std::chrono::duration<double>(duration),
+		[this] { return stop_.load(); });
+}
+
+bool ScanListEngine::wait_for_samples(size_t start, size_t count,
+	double timeout)
+{
+	const auto deadline = std::chrono::steady_clock::now() +
+		std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+			std::chrono::duration<double>(timeout));
+	while (signal_->sample_count() < start + count) {
+		// Wake up regularly to check for stop()
+		if (stop_ || std::chrono::steady_clock::now() >= deadline)
+			return false;
+		signal_->wait_for_samples(1, 0.05);
+	}
+	return !stop_;
+}
+
+void ScanListEngine::thread_proc(double settle_time, size_t samples,
+	uint64_t cycles, double timeout)
+{
+	vector<double> timestamps(samples);
+	vector<double> values(samples);
+	const ScanChannel *selected = nullptr;
+	while (!stop_ && (cycles == 0 || cycle_count_ < cycles)) {
+		for (const auto &scan_channel : scan_channels_) {
+			// Break before make
+			if (selected != &scan_channel) {
+				if (selected)
+					selected->enabled->write_value(false);
+				scan_channel.enabled->write_value(true);
+				selected = &scan_channel;
+			}
+			if (!wait(settle_time))
+				break;
+
+			// Only samples, that were taken after the settle time, count
+			const size_t start = signal_->sample_count();
+			if (!wait_for_samples(start, samples, timeout)) {
+				if (stop_)
+					break;
+				qWarning() << "ScanListEngine: Timeout while measuring " <<
+					QString::fromStdString(scan_channel.channel->name());
+				++timeout_count_;
+				continue;
+			}
+			const size_t count = signal_->copy_samples(start, samples, false,
+				timestamps.data(), values.data());
+			if (count == 0)
+				continue;
+
+			double sum = 0.;
+			for (size_t i = 0; i < count; ++i)
+				sum += values[i];
+			scan_channel.channel->push_sample(sum / (double)count,
+				timestamps[count - 1], signal_->quantity(),
+				signal_->quantity_flags(), signal_->unit(), signal_->digits(),
+				signal_->decimal_places());
+		}
+		if (stop_)
+			break;
+		++cycle_count_;
+	}
+
+	// Leave the multiplexer open
+	if (selected)
+		selected->enabled->write_value(false);
+	running_ = false;
+}
+
+} // namespace devices
+} // namespace sv
@@ -0,0 +1,147 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEVICES_SCANLISTENGINE_HPP
+#define DEVICES_SCANLISTENGINE_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+
+namespace channels {
+class UserChannel;
+}
+
+namespace data {
+class AnalogTimeSignal;
+namespace properties {
+class BoolProperty;
+}
+}
+
+namespace devices {
+
+class Configurable;
+class UserDevice;
+
+/**
+ * Scans the channels of a (relay) multiplexer with one measurement signal,
+ * e.g. 40 thermocouples with one DMM.
+ *
+ * For every channel of the scan list, the channel is selected by enabling
+ * its configurable (the previous one is disabled first, break before make),
+ * the engine waits for the settle time and then for the next N samples of
+ * the measurement signal. The mean of the samples is pushed to the user
+ * channel of the scan list channel, with the timestamp of the last sample.
+ * The loop runs in a dedicated thread, the config writes are serialized by
+ * the config worker of the multiplexer.
+ */
+class ScanListEngine
+{
+public:
+	ScanListEngine(shared_ptr<UserDevice> device,
+		shared_ptr<data::AnalogTimeSignal> signal);
+	~ScanListEngine();
+
+	ScanListEngine(const ScanListEngine &) = delete;
+	ScanListEngine &operator=(const ScanListEngine &) = delete;
+
+	/**
+	 * Append a channel to the scan list. The channel is selected by the
+	 * Enabled config key of the configurable. A user channel with the name
+	 * is added to the device for the measured values. Channels can only be
+	 * added, while the engine is stopped.
+	 *
+	 * @return The user channel or nullptr, if the configurable can't be
+	 *         enabled or the engine is running.
+	 */
+	shared_ptr<channels::UserChannel> add_channel(
+		shared_ptr<Configurable> configurable, const string &name);
+
+	/**
+	 * (Re)start the scan with the first channel.
+	 *
+	 * @param settle_time The time in seconds after the channel was selected,
+	 *        before the samples are taken.
+	 * @param samples The number of samples, that are averaged per channel.
+	 * @param cycles The number of scans of the list, 0 scans until stop()
+	 *        is called.
+	 * @param timeout The max. time in seconds to wait for the samples of a
+	 *        channel. On timeout, the channel is skipped.
+	 * @return false if the scan list is empty.
+	 */
+	bool start(double settle_time, size_t samples, uint64_t cycles = 0,
+		double timeout = 10.);
+	void stop();
+	bool is_running() const;
+
+	/** Return the number of channels in the scan list. */
+	size_t channel_count() const;
+	/** Return the number of completed scans of the list. */
+	uint64_t cycle_count() const;
+	/** Return the number of channels, that timed out. */
+	uint64_t timeout_count() const;
+
+private:
+	struct ScanChannel
+	{
+		shared_ptr<data::properties::BoolProperty> enabled;
+		shared_ptr<channels::UserChannel> channel;
+	};
+
+	void thread_proc(double settle_time, size_t samples, uint64_t cycles,
+		double timeout);
+	/** Wait for the duration in seconds. Returns false if stopped. */
+	bool wait(double duration);
+	/**
+	 * Wait for count new samples after the position start. Returns false
+	 * if stopped or on timeout.
+	 */
+	bool wait_for_samples(size_t start, size_t count, double timeout);
+
+	shared_ptr<UserDevice> device_;
+	shared_ptr<data::AnalogTimeSignal> signal_;
+	vector<ScanChannel> scan_channels_;
+
+	std::thread thread_;
+	std::mutex mutex_;
+	std::condition_variable stop_cond_;
+	std::atomic<bool> stop_;
+	std::atomic<bool> running_;
+	std::atomic<uint64_t> cycle_count_;
+	std::atomic<uint64_t> timeout_count_;
+
+};
+
+} // namespace devices
+} // namespace sv
+
+#endif // DEVICES_SCANLISTENGINE_HPP
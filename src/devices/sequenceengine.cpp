@@ -0,0 +1,253 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <QDebug>
+#include <QVariant>
+
+#include "sequenceengine.hpp"
+#include "src/data/properties/doubleproperty.hpp"
+#include "src/devices/waveformsequence.hpp"
+
+using std::lock_guard;
+using std::unique_lock;
+using std::vector;
+
+namespace sv {
+namespace devices {
+
+namespace {
+
+using steady_clock = std::chrono::steady_clock;
+
+/** Return the time in seconds since start. */
+double seconds_since(steady_clock::time_point start, steady_clock::time_point time)
+{
+	return std::chrono::duration<double>(time - start).count();
+}
+
+}
+
+const std::chrono::microseconds SequenceEngine::spin_time_(2000);
+const size_t SequenceEngine::max_timing_count_ = 10000;
+
+SequenceEngine::SequenceEngine(
+		shared_ptr<data::properties::DoubleProperty> property) :
+	QObject(),
+	property_(property),
+	cycle_duration_(0.),
+	stop_(false),
+	running_(false),
+	max_lateness_(0.)
+{
+}
+
+SequenceEngine::~SequenceEngine()
+{
+	stop();
+}
+
+shared_ptr<data::properties::DoubleProperty> SequenceEngine::property() const
+{
+	return property_;
+}
+
+std::chrono::microseconds SequenceEngine::spin_time()
+{
+	return spin_time_;
+}
+
+bool SequenceEngine::start(const vector<SequenceStep> &steps, uint64_t cycles)
+{
+	// A finished sequence must still be joined
+	stop();
+
+	// Precompile the absolute offsets of the steps in a cycle
+	steps_.clear();
+	waveform_ = nullptr;
+	double offset = 0.;
+	for (size_t i = 0; i < steps.size(); ++i) {
+		if (!(steps[i].delay > 0.))
+			continue;
+		steps_.push_back(CompiledStep{ (int)i, steps[i].value, offset });
+		offset += steps[i].delay;
+	}
+	cycle_duration_ = offset;
+	if (steps_.empty() || !property_) {
+		qWarning() << "SequenceEngine::start(): No steps to output";
+		return false;
+	}
+
+	start_thread(cycles);
+	return true;
+}
+
+bool SequenceEngine::start(shared_ptr<WaveformSequence> waveform,
+	uint64_t cycles)
+{
+	// A finished sequence must still be joined
+	stop();
+
+	steps_.clear();
+	waveform_ = waveform;
+	if (!waveform_ || waveform_->sample_count() == 0 ||
+			!(waveform_->interval() > 0.) || !property_) {
+		qWarning() << "SequenceEngine::start(): No waveform to output";
+		waveform_ = nullptr;
+		return false;
+	}
+	cycle_duration_ = waveform_->duration();
+
+	start_thread(cycles);
+	return true;
+}
+
+void SequenceEngine::start_thread(uint64_t cycles)
+{
+	{
+		lock_guard<std::mutex> lock(mutex_);
+		timings_.clear();
+		max_lateness_ = 0.;
+	}
+	stop_ = false;
+	running_ = true;
+	thread_ = std::thread(&SequenceEngine::thread_proc, this, cycles);
+}
+
+void SequenceEngine::stop()
+{
+	if (!thread_.joinable())
+		return;
+
+	{
+		lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+	}
+	stop_cond_.notify_one();
+	thread_.join();
+	running_ = false;
+}
+
+bool SequenceEngine::is_running() const
+{
+	return running_;
+}
+
+vector<SequenceStepTiming> SequenceEngine::timings() const
+{
+	lock_guard<std::mutex> lock(mutex_);
+	return vector<SequenceStepTiming>(timings_.begin(), timings_.end());
+}
+
+double SequenceEngine::max_lateness() const
+{
+	lock_guard<std::mutex> lock(mutex_);
+	return max_lateness_;
+}
+
+bool SequenceEngine::wait_until(steady_clock::time_point time)
+{
+	// Sleep until shortly before the time, then spin for the rest
+	{
+		unique_lock<std::mutex> lock(mutex_);
+		if (stop_cond_.wait_until(lock, time - spin_time_,
+				[this] { return stop_.load(); }))
+			return false;
+	}
+	while (steady_clock::now() < time) {
+		if (stop_)
+			return false;
+		std::this_thread::yield();
+	}
+	return true;
+}
+
+void SequenceEngine::thread_proc(uint64_t cycles)
+{
+	// All steps are scheduled relative to the start, so the delays of the
+	// steps (and the time to set the values) don't accumulate.
+	const auto start_time = steady_clock::now();
+	for (uint64_t cycle = 0; cycles == 0 || cycle < cycles; ++cycle) {
+		for (size_t pos = 0; pos < step_count(); ++pos) {
+			const CompiledStep step = compiled_step(pos);
+			const double requested_time =
+				(double)cycle * cycle_duration_ + step.offset;
+			const auto time = start_time +
+				std::chrono::duration_cast<steady_clock::duration>(
+					std::chrono::duration<double>(requested_time));
+			if (!wait_until(time)) {
+				running_ = false;
+				return;
+			}
+
+			const auto actual = steady_clock::now();
+			property_->write_value(step.value);
+			const auto done = steady_clock::now();
+
+			const double actual_time = seconds_since(start_time, actual);
+			{
+				lock_guard<std::mutex> lock(mutex_);
+				timings_.push_back(SequenceStepTiming{ step.step, cycle,
+					requested_time, actual_time, seconds_since(actual, done) });
+				if (timings_.size() > max_timing_count_)
+					timings_.pop_front();
+				max_lateness_ =
+					std::max(max_lateness_, actual_time - requested_time);
+			}
+			Q_EMIT step_executed(step.step, requested_time, actual_time);
+		}
+	}
+
+	// Hold the last value for its delay
+	const auto end_time = start_time +
+		std::chrono::duration_cast<steady_clock::duration>(
+			std::chrono::duration<double>((double)cycles * cycle_duration_));
+	const bool completed = wait_until(end_time);
+	running_ = false;
+	if (completed)
+		Q_EMIT finished();
+}
+
+size_t SequenceEngine::step_count() const
+{
+	if (waveform_)
+		return waveform_->sample_count();
+	return steps_.size();
+}
+
+SequenceEngine::CompiledStep SequenceEngine::compiled_step(size_t pos) const
+{
+	if (waveform_) {
+		return CompiledStep{ (int)pos,
+			waveform_->value(pos), waveform_->time(pos) };
+	}
+	return steps_[pos];
+}
+
+} // namespace devices
+} // namespace sv
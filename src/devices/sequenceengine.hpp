@@ -0,0 +1,178 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEVICES_SEQUENCEENGINE_HPP
+#define DEVICES_SEQUENCEENGINE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <QObject>
+
+using std::deque;
+using std::shared_ptr;
+using std::vector;
+
+namespace sv {
+
+namespace data {
+namespace properties {
+class DoubleProperty;
+}
+}
+
+namespace devices {
+
+class WaveformSequence;
+
+/**
+ * One step of a sequence: The value is set and held for delay seconds.
+ */
+struct SequenceStep
+{
+	double value;
+	double delay;
+};
+
+/**
+ * The requested and the actual time of an executed step, in seconds since
+ * the start of the sequence.
+ */
+struct SequenceStepTiming
+{
+	/** The index of the step in the sequence. */
+	int step;
+	uint64_t cycle;
+	double requested_time;
+	double actual_time;
+	/** The time, that setting the value took. */
+	double duration;
+};
+
+/**
+ * Outputs a sequence of values to a property in a dedicated thread.
+ *
+ * The steps are compiled into absolute offsets from the start of the
+ * sequence and scheduled on the steady clock, so the delays don't add up
+ * errors: A late step (e.g. a slow device) doesn't shift the following
+ * steps. The thread sleeps until shortly before a step is due and then
+ * spins for the last spin_time(), because the sleep of the OS is not
+ * precise enough for ms accuracy. Steps without a delay are skipped, like
+ * the sequence table did before. A generated WaveformSequence is not
+ * compiled, its values are calculated when the step is due.
+ *
+ * The timings of the executed steps are recorded in a bounded buffer, so
+ * the actual step times can be compared to the requested ones.
+ */
+class SequenceEngine : public QObject
+{
+	Q_OBJECT
+
+public:
+	explicit SequenceEngine(
+		shared_ptr<sv::data::properties::DoubleProperty> property);
+	~SequenceEngine();
+
+	shared_ptr<sv::data::properties::DoubleProperty> property() const;
+
+	/**
+	 * (Re)start the sequence with the first step.
+	 *
+	 * @param cycles The number of times the sequence is output, 0 repeats
+	 *        it until stop() is called.
+	 * @return false if there is no step with a delay.
+	 */
+	bool start(const vector<SequenceStep> &steps, uint64_t cycles);
+	/**
+	 * (Re)start the generated sequence of a waveform. The values are
+	 * calculated on demand, while the sequence is output.
+	 *
+	 * @param cycles The number of times the sequence is output, 0 repeats
+	 *        it until stop() is called.
+	 * @return false if the waveform has no samples.
+	 */
+	bool start(shared_ptr<WaveformSequence> waveform, uint64_t cycles);
+	void stop();
+	bool is_running() const;
+
+	/** Return the timings of the last executed steps. */
+	vector<SequenceStepTiming> timings() const;
+	/** Return the biggest lateness of a step since the start in seconds. */
+	double max_lateness() const;
+
+	static std::chrono::microseconds spin_time();
+
+private:
+	struct CompiledStep
+	{
+		int step;
+		double value;
+		/** The offset from the start of the cycle in seconds. */
+		double offset;
+	};
+
+	/** Start the thread after steps_ or waveform_ have been set. */
+	void start_thread(uint64_t cycles);
+	void thread_proc(uint64_t cycles);
+	size_t step_count() const;
+	CompiledStep compiled_step(size_t pos) const;
+	/** Wait until time. Returns false if the engine was stopped. */
+	bool wait_until(std::chrono::steady_clock::time_point time);
+
+	static const std::chrono::microseconds spin_time_;
+	static const size_t max_timing_count_;
+
+	shared_ptr<sv::data::properties::DoubleProperty> property_;
+	vector<CompiledStep> steps_;
+	/** The generated sequence, that is output instead of steps_. */
+	shared_ptr<WaveformSequence> waveform_;
+	/** The duration of one cycle in seconds. */
+	double cycle_duration_;
+
+	std::thread thread_;
+	mutable std::mutex mutex_;
+	std::condition_variable stop_cond_;
+	std::atomic<bool> stop_;
+	std::atomic<bool> running_;
+	deque<SequenceStepTiming> timings_;
+	double max_lateness_;
+
+Q_SIGNALS:
+	/**
+	 * The step with the index step was executed. The times are in seconds
+	 * since the start of the sequence.
+	 */
+	void step_executed(int step, double requested_time, double actual_time);
+	/** All cycles were output. Not emitted, when the engine is stopped. */
+	void finished();
+
+};
+
+} // namespace devices
+} // namespace sv
+
+#endif // DEVICES_SEQUENCEENGINE_HPP
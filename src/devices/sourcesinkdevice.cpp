@@ -66,9 +66,9 @@ void SourceSinkDevice::init_configurables()
 		if (configurable->property_map().count(ConfigKey::Range) > 0 &&
 			configurable->property_map().count(ConfigKey::VoltageTarget) > 0) {
 
-			auto range_property = configurable->property_map()[ConfigKey::Range];
+			auto range_property = configurable->property_map().at(ConfigKey::Range);
 			auto volt_property =
-				configurable->property_map()[ConfigKey::VoltageTarget];
+				configurable->property_map().at(ConfigKey::VoltageTarget);
 			connect(
 				range_property.get(), &data::properties::BaseProperty::value_changed,
 				volt_property.get(), &data::properties::BaseProperty::list_config);
@@ -76,9 +76,9 @@ void SourceSinkDevice::init_configurables()
 		if (configurable->property_map().count(ConfigKey::Range) > 0 &&
 			configurable->property_map().count(ConfigKey::CurrentLimit) > 0) {
 
-			auto range_property = configurable->property_map()[ConfigKey::Range];
+			auto range_property = configurable->property_map().at(ConfigKey::Range);
 			auto current_property =
-				configurable->property_map()[ConfigKey::CurrentLimit];
+				configurable->property_map().at(ConfigKey::CurrentLimit);
 			connect(
 				range_property.get(), &data::properties::BaseProperty::value_changed,
 				current_property.get(), &data::properties::BaseProperty::list_config);
@@ -252,7 +252,7 @@ void SourceSinkDevice::init_channels()
 					data::Quantity::Energy,
 					set<data::QuantityFlag>(),
 					data::Unit::WattHour,
-					power_signal,
+					power_signal, channels::IntegrationMethod::Trapezoid,
 					shared_from_this(),
 					chg_names, "Wh" + ch_suffix,
 					aquisition_start_timestamp_);
@@ -266,7 +266,7 @@ void SourceSinkDevice::init_channels()
 					data::Quantity::ElectricCharge,
 					set<data::QuantityFlag>(),
 					data::Unit::AmpereHour,
-					current_signal,
+					current_signal, channels::IntegrationMethod::Trapezoid,
 					shared_from_this(),
 					chg_names, "Ah" + ch_suffix,
 					aquisition_start_timestamp_);
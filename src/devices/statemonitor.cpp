@@ -0,0 +1,163 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "statemonitor.hpp"
+#include "src/data/properties/baseproperty.hpp"
+#include "src/devices/configurable.hpp"
+#include "src/devices/deviceutil.hpp"
+
+using std::chrono::steady_clock;
+using std::lock_guard;
+using std::mutex;
+using std::unique_lock;
+
+namespace sv {
+namespace devices {
+
+const std::chrono::milliseconds StateMonitor::min_poll_interval_(500);
+const std::chrono::milliseconds StateMonitor::max_poll_interval_(8000);
+
+StateMonitor::StateMonitor() :
+	stop_(false)
+{
+	thread_ = std::thread(&StateMonitor::thread_proc, this);
+}
+
+StateMonitor::~StateMonitor()
+{
+	stop();
+}
+
+void StateMonitor::watch(shared_ptr<data::properties::BaseProperty> property)
+{
+	if (!property || !property->is_getable())
+		return;
+
+	const key_t key(property->configurable().get(), property->config_key());
+	lock_guard<mutex> lock(mutex_);
+	auto it = entries_.find(key);
+	if (it != entries_.end()) {
+		++it->second.watchers;
+		return;
+	}
+	// The views read the value, when they are created
+	entries_.insert(std::make_pair(key, Entry{ property, 1, min_poll_interval_,
+		steady_clock::now() + min_poll_interval_, QVariant(), false }));
+	cond_.notify_one();
+}
+
+void StateMonitor::unwatch(shared_ptr<data::properties::BaseProperty> property)
+{
+	if (!property)
+		return;
+
+	const key_t key(property->configurable().get(), property->config_key());
+	lock_guard<mutex> lock(mutex_);
+	auto it = entries_.find(key);
+	if (it != entries_.end() && --it->second.watchers == 0)
+		entries_.erase(it);
+}
+
+void StateMonitor::notify_meta(const Configurable *configurable,
+	ConfigKey config_key)
+{
+	lock_guard<mutex> lock(mutex_);
+	auto it = entries_.find(key_t(configurable, config_key));
+	if (it == entries_.end())
+		return;
+	it->second.interval = max_poll_interval_;
+	it->second.next_poll = steady_clock::now() + max_poll_interval_;
+	it->second.reported = true;
+}
+
+size_t StateMonitor::watched_count() const
+{
+	lock_guard<mutex> lock(mutex_);
+	return entries_.size();
+}
+
+void StateMonitor::stop()
+{
+	{
+		lock_guard<mutex> lock(mutex_);
+		stop_ = true;
+	}
+	cond_.notify_one();
+	if (thread_.joinable())
+		thread_.join();
+}
+
+void StateMonitor::thread_proc()
+{
+	unique_lock<mutex> lock(mutex_);
+	while (!stop_) {
+		if (entries_.empty()) {
+			cond_.wait(lock);
+			continue;
+		}
+
+		auto next = entries_.begin();
+		for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+			if (it->second.next_poll < next->second.next_poll)
+				next = it;
+		}
+		if (steady_clock::now() < next->second.next_poll) {
+			cond_.wait_until(lock, next->second.next_poll);
+			continue;
+		}
+
+		const key_t key = next->first;
+		auto property = next->second.property.lock();
+		next->second.next_poll = steady_clock::now() + next->second.interval;
+		if (!property)
+			continue;
+
+		lock.unlock();
+		const QVariant qvar = property->poll_value();
+		property.reset();
+		lock.lock();
+
+		auto it = entries_.find(key);
+		if (it == entries_.end())
+			continue;
+		Entry &entry = it->second;
+		if (entry.reported)
+			entry.interval = max_poll_interval_;
+		else if (qvar.isValid() && qvar != entry.last_value)
+			entry.interval = min_poll_interval_;
+		else
+			entry.interval = std::min<steady_clock::duration>(
+				entry.interval * 2, max_poll_interval_);
+		entry.reported = false;
+		entry.last_value = qvar;
+		// A meta packet during the poll may have deferred the next poll
+		entry.next_poll = std::max(entry.next_poll,
+			steady_clock::now() + entry.interval);
+	}
+}
+
+} // namespace devices
+} // namespace sv
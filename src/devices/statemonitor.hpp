@@ -0,0 +1,125 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEVICES_STATEMONITOR_HPP
+#define DEVICES_STATEMONITOR_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include <QVariant>
+
+#include "src/devices/deviceutil.hpp"
+
+using std::map;
+using std::pair;
+using std::shared_ptr;
+using std::weak_ptr;
+
+namespace sv {
+
+namespace data {
+namespace properties {
+class BaseProperty;
+}
+}
+
+namespace devices {
+
+class Configurable;
+
+/**
+ * Monitors the state of a device (e.g. regulation, OVP/OCP or the enabled
+ * state), that is shown by several views.
+ *
+ * The states are primarily updated by the meta packets of the driver. The
+ * watched properties are additionally polled in one shared poll thread per
+ * device, so views, that watch the same property, don't read it more than
+ * once. The poll is adaptive: The interval of a property is doubled up to
+ * max_poll_interval_ while its value doesn't change and is reset, when it
+ * changes. A property, that was reported by a meta packet, is only polled
+ * with the max. interval.
+ */
+class StateMonitor
+{
+public:
+	StateMonitor();
+	/** Calls stop(). */
+	~StateMonitor();
+
+	StateMonitor(const StateMonitor &) = delete;
+	StateMonitor &operator=(const StateMonitor &) = delete;
+
+	/**
+	 * Watch the property. Every watch() must be paired with an unwatch().
+	 * Properties, that are nullptr or not getable, are ignored.
+	 */
+	void watch(shared_ptr<data::properties::BaseProperty> property);
+	void unwatch(shared_ptr<data::properties::BaseProperty> property);
+
+	/**
+	 * A meta packet has reported the value of the config key, so the poll
+	 * of the key is deferred. Called from the datafeed.
+	 */
+	void notify_meta(const Configurable *configurable, ConfigKey config_key);
+
+	/** Return the number of watched properties. */
+	size_t watched_count() const;
+
+	/** Stop the poll thread. */
+	void stop();
+
+private:
+	struct Entry
+	{
+		weak_ptr<data::properties::BaseProperty> property;
+		/** The number of watch() calls for this property. */
+		size_t watchers;
+		std::chrono::steady_clock::duration interval;
+		std::chrono::steady_clock::time_point next_poll;
+		QVariant last_value;
+		/** Set by notify_meta(), until the next poll. */
+		bool reported;
+	};
+
+	typedef pair<const Configurable *, ConfigKey> key_t;
+
+	void thread_proc();
+
+	static const std::chrono::milliseconds min_poll_interval_;
+	static const std::chrono::milliseconds max_poll_interval_;
+
+	mutable std::mutex mutex_;
+	std::condition_variable cond_;
+	map<key_t, Entry> entries_;
+	bool stop_;
+	std::thread thread_;
+
+};
+
+} // namespace devices
+} // namespace sv
+
+#endif // DEVICES_STATEMONITOR_HPP
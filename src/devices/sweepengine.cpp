@@ -0,0 +1,355 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <QDebug>
+#include <QString>
+
+#include "sweepengine.hpp"
+#include "src/channels/userchannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/datautil.hpp"
+#include "src/data/properties/doubleproperty.hpp"
+#include "src/devices/sequenceengine.hpp"
+#include "src/devices/userdevice.hpp"
+
+using std::chrono::steady_clock;
+using std::lock_guard;
+using std::make_shared;
+using std::set;
+using std::string;
+using std::unique_lock;
+using std::vector;
+
+namespace sv {
+namespace devices {
+
+namespace {
+
+steady_clock::time_point time_after(steady_clock::time_point time,
+	double seconds)
+{
+	return time + std::chrono::duration_cast<steady_clock::duration>(
+		std::chrono::duration<double>(seconds));
+}
+
+data::Quantity quantity_for_unit(data::Unit unit)
+{
+	switch (unit) {
+	case data::Unit::Volt:
+		return data::Quantity::Voltage;
+	case data::Unit::Ampere:
+		return data::Quantity::Current;
+	case data::Unit::Watt:
+		return data::Quantity::Power;
+	case data::Unit::Ohm:
+		return data::Quantity::Resistance;
+	default:
+		return data::Quantity::Unknown;
+	}
+}
+
+}
+
+SweepEngine::SweepEngine(shared_ptr<UserDevice> device,
+		shared_ptr<data::properties::DoubleProperty> setpoint) :
+	device_(device),
+	setpoint_(setpoint),
+	write_state_(make_shared<WriteState>()),
+	stop_(false),
+	running_(false),
+	measured_count_(0),
+	timeout_count_(0)
+{
+	setpoint_channel_ = device_->add_user_channel("Setpoint", "Sweep");
+}
+
+SweepEngine::~SweepEngine()
+{
+	stop();
+}
+
+vector<double> SweepEngine::linear_points(double start, double stop,
+	size_t count)
+{
+	vector<double> points;
+	if (count == 1)
+		points.push_back(start);
+	for (size_t i = 0; count > 1 && i < count; ++i) {
+		points.push_back(
+			start + (stop - start) * (double)i / (double)(count - 1));
+	}
+	return points;
+}
+
+vector<double> SweepEngine::log_points(double start, double stop,
+	size_t count)
+{
+	vector<double> points;
+	if (start == 0. || stop == 0. || (start < 0.) != (stop < 0.)) {
+		qWarning() << "SweepEngine::log_points(): Invalid range " <<
+			start << " - " << stop;
+		return points;
+	}
+
+	const double factor = stop / start;
+	if (count == 1)
+		points.push_back(start);
+	for (size_t i = 0; count > 1 && i < count; ++i) {
+		points.push_back(
+			start * std::pow(factor, (double)i / (double)(count - 1)));
+	}
+	return points;
+}
+
+shared_ptr<data::properties::DoubleProperty> SweepEngine::setpoint() const
+{
+	return setpoint_;
+}
+
+shared_ptr<channels::UserChannel> SweepEngine::setpoint_channel() const
+{
+	return setpoint_channel_;
+}
+
+shared_ptr<channels::UserChannel> SweepEngine::add_signal(
+	shared_ptr<data::AnalogTimeSignal> signal, const string &name)
+{
+	if (running_ || !signal)
+		return nullptr;
+	if (device_->channel_map().count(name) > 0) {
+		qWarning() << "SweepEngine::add_signal(): Channel " <<
+			QString::fromStdString(name) << " already exists";
+		return nullptr;
+	}
+
+	auto channel = device_->add_user_channel(name, "Sweep");
+	sweep_signals_.push_back(SweepSignal{ signal, channel });
+	return channel;
+}
+
+bool SweepEngine::start(const vector<double> &points, double settle_time,
+	size_t samples, double timeout)
+{
+	// A finished sweep must still be joined
+	stop();
+	if (points.empty() || sweep_signals_.empty() || samples == 0)
+		return false;
+
+	stop_ = false;
+	running_ = true;
+	measured_count_ = 0;
+	timeout_count_ = 0;
+	thread_ = std::thread(&SweepEngine::thread_proc, this,
+		points, settle_time, samples, timeout);
+	return true;
+}
+
+void SweepEngine::stop()
+{
+	if (!thread_.joinable())
+		return;
+
+	{
+		lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+	}
+	stop_cond_.notify_one();
+	{
+		lock_guard<std::mutex> lock(write_state_->mutex);
+	}
+	write_state_->cond.notify_one();
+	thread_.join();
+	running_ = false;
+}
+
+bool SweepEngine::is_running() const
+{
+	return running_;
+}
+
+size_t SweepEngine::measured_count() const
+{
+	return measured_count_;
+}
+
+uint64_t SweepEngine::timeout_count() const
+{
+	return timeout_count_;
+}
+
+void SweepEngine::post_setpoint(double value)
+{
+	uint64_t id;
+	{
+		lock_guard<std::mutex> lock(write_state_->mutex);
+		id = ++write_state_->posted;
+	}
+	// The write state outlives the engine, if the worker is slow
+	auto write_state = write_state_;
+	setpoint_->post_value(value, [write_state, id](bool ok) {
+		{
+			lock_guard<std::mutex> lock(write_state->mutex);
+			write_state->done = id;
+			write_state->ok = ok;
+			write_state->time = steady_clock::now();
+		}
+		write_state->cond.notify_one();
+	});
+}
+
+bool SweepEngine::wait_for_write(double timeout,
+	steady_clock::time_point &time)
+{
+	unique_lock<std::mutex> lock(write_state_->mutex);
+	const bool done = write_state_->cond.wait_until(lock,
+		time_after(steady_clock::now(), timeout), [this] {
+			return stop_ || write_state_->done == write_state_->posted;
+		});
+	if (!done || stop_ || !write_state_->ok)
+		return false;
+
+	time = write_state_->time;
+	return true;
+}
+
+bool SweepEngine::wait_until(steady_clock::time_point time)
+{
+	// Sleep until shortly before the time, then spin for the rest
+	{
+		unique_lock<std::mutex> lock(mutex_);
+		if (stop_cond_.wait_until(lock, time - SequenceEngine::spin_time(),
+				[this] { return stop_.load(); }))
+			return false;
+	}
+	while (steady_clock::now() < time) {
+		if (stop_)
+			return false;
+		std::this_thread::yield();
+	}
+	return true;
+}
+
+bool SweepEngine::wait_for_samples(const vector<size_t> &starts, size_t count,
+	double timeout)
+{
+	const auto deadline = time_after(steady_clock::now(), timeout);
+	for (size_t i = 0; i < sweep_signals_.size(); ++i) {
+		const auto &signal = sweep_signals_[i].signal;
+		while (signal->sample_count() < starts[i] + count) {
+			// Wake up regularly to check for stop()
+			if (stop_ || steady_clock::now() >= deadline)
+				return false;
+			signal->wait_for_samples(1, 0.05);
+		}
+	}
+	return !stop_;
+}
+
+void SweepEngine::push_results(double value, const vector<size_t> &starts,
+	size_t samples)
+{
+	vector<double> timestamps(samples);
+	vector<double> values(samples);
+	vector<double> means;
+	double timestamp = 0.;
+	for (size_t i = 0; i < sweep_signals_.size(); ++i) {
+		const auto &signal = sweep_signals_[i].signal;
+		const size_t count = signal->copy_samples(starts[i], samples, false,
+			timestamps.data(), values.data());
+		if (count == 0)
+			return;
+
+		double sum = 0.;
+		for (size_t j = 0; j < count; ++j)
+			sum += values[j];
+		means.push_back(sum / (double)count);
+		// All results of a point get the same timestamp, for the XY plots
+		if (i == 0)
+			timestamp = timestamps[count - 1];
+	}
+
+	setpoint_channel_->push_sample(value, timestamp,
+		quantity_for_unit(setpoint_->unit()), set<data::QuantityFlag>(),
+		setpoint_->unit(), setpoint_->digits(), setpoint_->decimal_places());
+	for (size_t i = 0; i < sweep_signals_.size(); ++i) {
+		const auto &signal = sweep_signals_[i].signal;
+		sweep_signals_[i].channel->push_sample(means[i], timestamp,
+			signal->quantity(), signal->quantity_flags(), signal->unit(),
+			signal->digits(), signal->decimal_places());
+	}
+	++measured_count_;
+}
+
+void SweepEngine::thread_proc(vector<double> points, double settle_time,
+	size_t samples, double timeout)
+{
+	vector<size_t> starts(sweep_signals_.size());
+	post_setpoint(points[0]);
+	for (size_t pos = 0; pos < points.size() && !stop_; ++pos) {
+		steady_clock::time_point written;
+		if (!wait_for_write(timeout, written)) {
+			if (stop_)
+				break;
+			qWarning() << "SweepEngine: Setpoint " << points[pos] <<
+				" was not written";
+			++timeout_count_;
+			if (pos + 1 < points.size())
+				post_setpoint(points[pos + 1]);
+			continue;
+		}
+
+		// The settle time starts, when the device has the new setpoint
+		if (!wait_until(time_after(written, settle_time)))
+			break;
+
+		// Only samples, that were taken after the settle time, count
+		for (size_t i = 0; i < sweep_signals_.size(); ++i)
+			starts[i] = sweep_signals_[i].signal->sample_count();
+		const bool measured = wait_for_samples(starts, samples, timeout);
+		if (stop_)
+			break;
+
+		// Write the next setpoint, while the results are calculated
+		if (pos + 1 < points.size())
+			post_setpoint(points[pos + 1]);
+
+		if (!measured) {
+			qWarning() << "SweepEngine: Timeout while measuring setpoint " <<
+				points[pos];
+			++timeout_count_;
+			continue;
+		}
+		push_results(points[pos], starts, samples);
+	}
+	running_ = false;
+}
+
+} // namespace devices
+} // namespace sv
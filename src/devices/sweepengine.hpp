@@ -0,0 +1,190 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEVICES_SWEEPENGINE_HPP
+#define DEVICES_SWEEPENGINE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+
+namespace channels {
+class UserChannel;
+}
+
+namespace data {
+class AnalogTimeSignal;
+namespace properties {
+class DoubleProperty;
+}
+}
+
+namespace devices {
+
+class UserDevice;
+
+/**
+ * Sweeps a setpoint of a source/sink device (e.g. the voltage target of a
+ * power supply or the current of an electronic load) and measures signals
+ * at every point, "settle then sample".
+ *
+ * For every point, the engine waits until the setpoint was written, then
+ * for the settle time and then for the next N samples of every measurement
+ * signal. The mean of the samples is pushed to the user channel of the
+ * signal and the setpoint to the setpoint channel, all with the timestamp
+ * of the last sample. So every result channel has one sample per point
+ * with the same timestamps, ready for a XY plot.
+ *
+ * The writes are pipelined with the measurements: The next setpoint is
+ * posted to the config worker of the device as soon as the samples are
+ * taken, the means are calculated while the device is written. The settle
+ * time is timed on the steady clock like the steps of a SequenceEngine.
+ */
+class SweepEngine
+{
+public:
+	SweepEngine(shared_ptr<UserDevice> device,
+		shared_ptr<data::properties::DoubleProperty> setpoint);
+	~SweepEngine();
+
+	SweepEngine(const SweepEngine &) = delete;
+	SweepEngine &operator=(const SweepEngine &) = delete;
+
+	/** Return count linear spaced points from start to stop. */
+	static vector<double> linear_points(double start, double stop,
+		size_t count);
+	/**
+	 * Return count logarithmic spaced points from start to stop. Start and
+	 * stop must have the same sign and must not be 0.
+	 */
+	static vector<double> log_points(double start, double stop,
+		size_t count);
+
+	shared_ptr<data::properties::DoubleProperty> setpoint() const;
+	/** Return the user channel with the setpoints of the measured points. */
+	shared_ptr<channels::UserChannel> setpoint_channel() const;
+
+	/**
+	 * Add a signal, that is measured at every point. A user channel with
+	 * the name is added to the device for the measured values. Signals can
+	 * only be added, while the engine is stopped.
+	 *
+	 * @return The user channel or nullptr, if the engine is running or the
+	 *         name already exists.
+	 */
+	shared_ptr<channels::UserChannel> add_signal(
+		shared_ptr<data::AnalogTimeSignal> signal, const string &name);
+
+	/**
+	 * (Re)start the sweep with the first point.
+	 *
+	 * @param points The setpoints, e.g. from linear_points().
+	 * @param settle_time The time in seconds after the setpoint was
+	 *        written, before the samples are taken.
+	 * @param samples The number of samples, that are averaged per point.
+	 * @param timeout The max. time in seconds to wait for a write or for the
+	 *        samples of a point. On timeout, the point is skipped.
+	 * @return false if there are no points or no signals.
+	 */
+	bool start(const vector<double> &points, double settle_time,
+		size_t samples, double timeout = 10.);
+	void stop();
+	bool is_running() const;
+
+	/** Return the number of measured points since the start. */
+	size_t measured_count() const;
+	/** Return the number of points, that timed out. */
+	uint64_t timeout_count() const;
+
+private:
+	struct SweepSignal
+	{
+		shared_ptr<data::AnalogTimeSignal> signal;
+		shared_ptr<channels::UserChannel> channel;
+	};
+
+	/**
+	 * The result of the posted write. It is shared with the done function,
+	 * that may be called by the config worker after the engine was stopped.
+	 */
+	struct WriteState
+	{
+		std::mutex mutex;
+		std::condition_variable cond;
+		uint64_t posted = 0;
+		uint64_t done = 0;
+		bool ok = false;
+		std::chrono::steady_clock::time_point time;
+	};
+
+	void thread_proc(vector<double> points, double settle_time,
+		size_t samples, double timeout);
+	/** Post the write of the setpoint to the config worker. */
+	void post_setpoint(double value);
+	/**
+	 * Wait for the posted write and return the time it was done in &time.
+	 * Returns false if stopped, on timeout or if the write failed.
+	 */
+	bool wait_for_write(double timeout,
+		std::chrono::steady_clock::time_point &time);
+	/** Wait until time. Returns false if the engine was stopped. */
+	bool wait_until(std::chrono::steady_clock::time_point time);
+	/**
+	 * Wait for count new samples of every signal after the positions in
+	 * starts. Returns false if stopped or on timeout.
+	 */
+	bool wait_for_samples(const vector<size_t> &starts, size_t count,
+		double timeout);
+	/** Push the means of the samples of a point to the result channels. */
+	void push_results(double value, const vector<size_t> &starts,
+		size_t samples);
+
+	shared_ptr<UserDevice> device_;
+	shared_ptr<data::properties::DoubleProperty> setpoint_;
+	shared_ptr<channels::UserChannel> setpoint_channel_;
+	vector<SweepSignal> sweep_signals_;
+	shared_ptr<WriteState> write_state_;
+
+	std::thread thread_;
+	std::mutex mutex_;
+	std::condition_variable stop_cond_;
+	std::atomic<bool> stop_;
+	std::atomic<bool> running_;
+	std::atomic<size_t> measured_count_;
+	std::atomic<uint64_t> timeout_count_;
+
+};
+
+} // namespace devices
+} // namespace sv
+
+#endif // DEVICES_SWEEPENGINE_HPP
@@ -0,0 +1,190 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <avrt.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+#ifdef __linux__
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <QDebug>
+
+#include "threadpolicy.hpp"
+
+namespace sv {
+namespace devices {
+
+namespace {
+
+#ifdef _WIN32
+
+/** The MMCSS registration of the calling thread, to revert it later. */
+thread_local HANDLE mmcss_handle = nullptr;
+
+bool apply_priority(const ThreadPolicy &policy)
+{
+	if (policy.priority != ThreadPriority::RealTime && mmcss_handle) {
+		AvRevertMmThreadCharacteristics(mmcss_handle);
+		mmcss_handle = nullptr;
+	}
+
+	switch (policy.priority) {
+	case ThreadPriority::RealTime:
+		if (!mmcss_handle) {
+			DWORD task_index = 0;
+			mmcss_handle =
+				AvSetMmThreadCharacteristicsW(L"Pro Audio", &task_index);
+		}
+		if (mmcss_handle &&
+				AvSetMmThreadPriority(mmcss_handle, AVRT_PRIORITY_HIGH))
+			return true;
+		// Without the MMCSS service use the highest priority of the class
+		qWarning() << "apply_thread_policy(): MMCSS failed, error" <<
+			GetLastError();
+		return SetThreadPriority(GetCurrentThread(),
+			THREAD_PRIORITY_TIME_CRITICAL) != 0;
+	case ThreadPriority::High:
+		return SetThreadPriority(GetCurrentThread(),
+			THREAD_PRIORITY_HIGHEST) != 0;
+	case ThreadPriority::Normal:
+	default:
+		return SetThreadPriority(GetCurrentThread(),
+			THREAD_PRIORITY_NORMAL) != 0;
+	}
+}
+
+bool apply_cpu(int cpu)
+{
+	DWORD_PTR process_mask = 0;
+	DWORD_PTR system_mask = 0;
+	if (!GetProcessAffinityMask(GetCurrentProcess(),
+			&process_mask, &system_mask))
+		return false;
+
+	DWORD_PTR mask = process_mask;
+	if (cpu >= 0)
+		mask &= (DWORD_PTR)1 << cpu;
+	if (mask == 0) {
+		qWarning() << "apply_thread_policy(): CPU" << cpu << "is not available";
+		return false;
+	}
+	return SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+}
+
+#else
+
+bool apply_priority(const ThreadPolicy &policy)
+{
+	int sched_policy = SCHED_OTHER;
+	struct sched_param param;
+	std::memset(&param, 0, sizeof(param));
+	if (policy.priority == ThreadPriority::RealTime) {
+		sched_policy = SCHED_FIFO;
+		param.sched_priority = std::max(sched_get_priority_min(SCHED_FIFO),
+			std::min(policy.realtime_priority,
+				sched_get_priority_max(SCHED_FIFO)));
+	}
+	int ret = pthread_setschedparam(pthread_self(), sched_policy, &param);
+	if (ret != 0) {
+		qWarning() << "apply_thread_policy(): Can't set the scheduling:" <<
+			std::strerror(ret);
+		return false;
+	}
+
+#ifdef __linux__
+	// Within SCHED_OTHER, Linux only knows the nice value per thread
+	if (policy.priority != ThreadPriority::RealTime) {
+		const int nice = policy.priority == ThreadPriority::High ? -10 : 0;
+		const pid_t tid = (pid_t)syscall(SYS_gettid);
+		if (setpriority(PRIO_PROCESS, (id_t)tid, nice) != 0) {
+			qWarning() << "apply_thread_policy(): Can't set the nice value:" <<
+				std::strerror(errno);
+			return false;
+		}
+	}
+#endif
+	return true;
+}
+
+bool apply_cpu(int cpu)
+{
+#ifdef __linux__
+	cpu_set_t cpu_set;
+	CPU_ZERO(&cpu_set);
+	if (cpu >= 0) {
+		if (cpu >= CPU_SETSIZE) {
+			qWarning() << "apply_thread_policy(): CPU" << cpu <<
+				"is not available";
+			return false;
+		}
+		CPU_SET(cpu, &cpu_set);
+	}
+	else {
+		// All CPUs of the process
+		if (sched_getaffinity(0, sizeof(cpu_set), &cpu_set) != 0)
+			return false;
+	}
+	int ret = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+	if (ret != 0) {
+		qWarning() << "apply_thread_policy(): Can't pin the thread to CPU" <<
+			cpu << ":" << std::strerror(ret);
+		return false;
+	}
+	return true;
+#else
+	// macOS has no hard CPU affinity
+	if (cpu >= 0) {
+		qWarning() << "apply_thread_policy(): CPU pinning is not supported";
+		return false;
+	}
+	return true;
+#endif
+}
+
+#endif
+
+} // namespace
+
+bool apply_thread_policy(const ThreadPolicy &policy)
+{
+	// Apply both, even if one fails
+	const bool priority_ok = apply_priority(policy);
+	const bool cpu_ok = apply_cpu(policy.cpu);
+	return priority_ok && cpu_ok;
+}
+
+int thread_policy_cpu_count()
+{
+	return std::max(1, (int)std::thread::hardware_concurrency());
+}
+
+} // namespace devices
+} // namespace sv
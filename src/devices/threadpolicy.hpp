@@ -0,0 +1,104 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEVICES_THREADPOLICY_HPP
+#define DEVICES_THREADPOLICY_HPP
+
+namespace sv {
+namespace devices {
+
+enum class ThreadPriority
+{
+	/** The default priority of the OS. */
+	Normal,
+	/** A raised priority within the normal scheduling class. */
+	High,
+	/**
+	 * Real-time scheduling: SCHED_FIFO on Linux/macOS, the MMCSS "Pro Audio"
+	 * task on Windows.
+	 */
+	RealTime,
+};
+
+/**
+ * The scheduling of a thread: Its priority and the CPU it is pinned to.
+ *
+ * A raised or real-time priority usually needs privileges (CAP_SYS_NICE or
+ * an rtprio limit in /etc/security/limits.conf on Linux). Without them the
+ * policy is not applied and a warning is logged.
+ */
+struct ThreadPolicy
+{
+	ThreadPolicy() :
+		priority(ThreadPriority::Normal),
+		realtime_priority(default_realtime_priority),
+		cpu(-1)
+	{
+	}
+
+	ThreadPolicy(ThreadPriority priority, int realtime_priority, int cpu) :
+		priority(priority),
+		realtime_priority(realtime_priority),
+		cpu(cpu)
+	{
+	}
+
+	bool operator==(const ThreadPolicy &other) const
+	{
+		return priority == other.priority &&
+			realtime_priority == other.realtime_priority && cpu == other.cpu;
+	}
+
+	bool operator!=(const ThreadPolicy &other) const
+	{
+		return !(*this == other);
+	}
+
+	/**
+	 * A low real-time priority. It is above all normal threads, but below
+	 * the interrupt threads of the kernel, that serve the USB and serial
+	 * ports.
+	 */
+	static const int default_realtime_priority = 10;
+
+	ThreadPriority priority;
+	/**
+	 * The SCHED_FIFO priority (1 to 99) for ThreadPriority::RealTime. It is
+	 * clamped to the range of the OS and ignored on Windows.
+	 */
+	int realtime_priority;
+	/** The CPU, the thread is pinned to, or -1 for all CPUs. */
+	int cpu;
+};
+
+/**
+ * Apply the policy to the calling thread. MMCSS on Windows only works for
+ * the calling thread, so the policy can't be applied from outside.
+ *
+ * @return true if the priority and the CPU were set.
+ */
+bool apply_thread_policy(const ThreadPolicy &policy);
+
+/** Return the number of CPUs, that a thread can be pinned to. */
+int thread_policy_cpu_count();
+
+} // namespace devices
+} // namespace sv
+
+#endif // DEVICES_THREADPOLICY_HPP
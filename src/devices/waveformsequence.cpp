@@ -0,0 +1,116 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <cstddef>
+
+#include "waveformsequence.hpp"
+
+namespace sv {
+namespace devices {
+
+namespace {
+
+const double pi = std::acos(-1);
+
+}
+
+WaveformSequence::WaveformSequence(WaveformType type, double amplitude,
+		double offset, double frequency, double phi, double interval,
+		size_t sample_count) :
+	type_(type),
+	amplitude_(amplitude),
+	offset_(offset),
+	frequency_(frequency),
+	phi_(phi),
+	interval_(interval),
+	sample_count_(sample_count)
+{
+}
+
+WaveformType WaveformSequence::type() const
+{
+	return type_;
+}
+
+double WaveformSequence::amplitude() const
+{
+	return amplitude_;
+}
+
+double WaveformSequence::offset() const
+{
+	return offset_;
+}
+
+double WaveformSequence::frequency() const
+{
+	return frequency_;
+}
+
+double WaveformSequence::phi() const
+{
+	return phi_;
+}
+
+double WaveformSequence::interval() const
+{
+	return interval_;
+}
+
+size_t WaveformSequence::sample_count() const
+{
+	return sample_count_;
+}
+
+double WaveformSequence::value(size_t pos) const
+{
+	// Calculate the time from the position instead of summing up the
+	// intervals, so the rounding errors don't accumulate.
+	const double x = 2 * pi * frequency_ * time(pos) + phi_;
+	double value;
+	if (type_ == WaveformType::Sine)
+		value = std::sin(x);
+	else if (type_ == WaveformType::Square)
+		value = std::sin(x) < 0 ? -1 : 1;
+	else if (type_ == WaveformType::Triangle)
+		value = (std::asin(std::sin(x))) / (pi/2);
+	else if (type_ == WaveformType::Sawtooth)
+		// y = −arctan(cotan(x))
+		value = -1 * std::atan(1 / std::tan(x)) / (pi/2);
+	else if (type_ == WaveformType::SawtoothInv)
+		value = std::atan(1 / std::tan(x)) / (pi/2);
+	else
+		value = 0;
+
+	return (amplitude_ * value) + offset_;
+}
+
+double WaveformSequence::time(size_t pos) const
+{
+	return (double)pos * interval_;
+}
+
+double WaveformSequence::duration() const
+{
+	return (double)sample_count_ * interval_;
+}
+
+} // namespace devices
+} // namespace sv
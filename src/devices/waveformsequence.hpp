@@ -0,0 +1,93 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEVICES_WAVEFORMSEQUENCE_HPP
+#define DEVICES_WAVEFORMSEQUENCE_HPP
+
+#include <cstddef>
+
+namespace sv {
+namespace devices {
+
+enum class WaveformType {
+	Sine,
+	Square,
+	Triangle,
+	Sawtooth,
+	SawtoothInv,
+};
+
+/**
+ * A generated sequence of a waveform. The values are calculated on demand
+ * from the parameters of the waveform, so even long sequences with small
+ * intervals need no memory.
+ *
+ * The sample i is at the time i * interval, every sample is held for
+ * interval seconds.
+ */
+class WaveformSequence
+{
+public:
+	/**
+	 * @param amplitude The amplitude (half peak to peak) of the waveform.
+	 * @param offset The offset (center value) of the waveform.
+	 * @param frequency The frequency of the waveform in Hz.
+	 * @param phi The phase offset of the waveform in rad.
+	 * @param interval The time between two samples in seconds.
+	 * @param sample_count The number of samples of the sequence.
+	 */
+	WaveformSequence(WaveformType type, double amplitude, double offset,
+		double frequency, double phi, double interval, size_t sample_count);
+
+	WaveformType type() const;
+	double amplitude() const;
+	double offset() const;
+	double frequency() const;
+	double phi() const;
+	double interval() const;
+	size_t sample_count() const;
+
+	/**
+	 * Return the value of the sample at the position pos.
+	 */
+	double value(size_t pos) const;
+	/**
+	 * Return the time of the sample at the position pos in seconds.
+	 */
+	double time(size_t pos) const;
+	/**
+	 * Return the duration of the sequence in seconds.
+	 */
+	double duration() const;
+
+private:
+	const WaveformType type_;
+	const double amplitude_;
+	const double offset_;
+	const double frequency_;
+	const double phi_;
+	const double interval_;
+	const size_t sample_count_;
+
+};
+
+} // namespace devices
+} // namespace sv
+
+#endif // DEVICES_WAVEFORMSEQUENCE_HPP
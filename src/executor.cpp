@@ -0,0 +1,311 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <QDebug>
+#include <QThread>
+
+#include "executor.hpp"
+#include "src/tracer.hpp"
+
+using std::lock_guard;
+using std::string;
+using std::unique_lock;
+
+namespace sv {
+
+namespace {
+
+/** The pool and the index of the queue of the current thread. */
+thread_local const TaskPool *current_pool = nullptr;
+thread_local size_t current_queue = 0;
+
+}
+
+TaskPool::TaskPool(size_t thread_count, const string &name) :
+	name_(name),
+	next_queue_(0),
+	stop_(false),
+	pending_count_(0),
+	submitted_count_(0),
+	executed_count_(0),
+	stolen_count_(0),
+	busy_ns_(0)
+{
+	thread_count = std::max<size_t>(1, thread_count);
+	for (size_t i = 0; i < thread_count; ++i)
+		queues_.emplace_back(new Queue());
+	for (size_t i = 0; i < thread_count; ++i)
+		threads_.push_back(std::thread(&TaskPool::thread_proc, this, i));
+}
+
+TaskPool::~TaskPool()
+{
+	stop();
+}
+
+void TaskPool::stop()
+{
+	{
+		lock_guard<std::mutex> lock(wake_mutex_);
+		stop_ = true;
+	}
+	wake_cond_.notify_all();
+	for (auto &thread : threads_) {
+		if (thread.joinable())
+			thread.join();
+	}
+}
+
+void TaskPool::submit(Task task)
+{
+	const size_t index = current_pool == this ? current_queue :
+		next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+	{
+		// The task can only be taken, after it is counted
+		lock_guard<std::mutex> lock(queues_[index]->mutex);
+		queues_[index]->tasks.push_back(std::move(task));
+		++pending_count_;
+	}
+	++submitted_count_;
+	{
+		// Don't miss a thread, that has checked pending_count_ and is about
+		// to wait
+		lock_guard<std::mutex> lock(wake_mutex_);
+	}
+	wake_cond_.notify_one();
+}
+
+size_t TaskPool::thread_count() const
+{
+	return threads_.size();
+}
+
+bool TaskPool::is_pool_thread() const
+{
+	return current_pool == this;
+}
+
+TaskPoolStatistics TaskPool::statistics() const
+{
+	TaskPoolStatistics statistics;
+	statistics.thread_count = threads_.size();
+	statistics.pending_count = pending_count_;
+	statistics.submitted_count = submitted_count_;
+	statistics.executed_count = executed_count_;
+	statistics.stolen_count = stolen_count_;
+	statistics.busy_time = (double)busy_ns_ / 1e9;
+	return statistics;
+}
+
+void TaskPool::thread_proc(size_t index)
+{
+	current_pool = this;
+	current_queue = index;
+	SV_TRACE_THREAD_NAME(name_ + " " + std::to_string(index));
+
+	Task task;
+	while (true) {
+		if (take_task(index, task)) {
+			execute(task);
+			continue;
+		}
+
+		unique_lock<std::mutex> lock(wake_mutex_);
+		wake_cond_.wait(lock, [this]() {
+			return stop_ || pending_count_ > 0;
+		});
+		// The queued tasks are executed before the pool stops
+		if (stop_ && pending_count_ == 0)
+			return;
+	}
+}
+
+bool TaskPool::take_task(size_t index, Task &task)
+{
+	// The newest task of the own queue
+	{
+		Queue &queue = *queues_[index];
+		lock_guard<std::mutex> lock(queue.mutex);
+		if (!queue.tasks.empty()) {
+			task = std::move(queue.tasks.back());
+			queue.tasks.pop_back();
+			--pending_count_;
+			return true;
+		}
+	}
+
+	// The oldest task of another queue
+	for (size_t i = 1; i < queues_.size(); ++i) {
+		Queue &queue = *queues_[(index + i) % queues_.size()];
+		lock_guard<std::mutex> lock(queue.mutex);
+		if (!queue.tasks.empty()) {
+			task = std::move(queue.tasks.front());
+			queue.tasks.pop_front();
+			--pending_count_;
+			++stolen_count_;
+			return true;
+		}
+	}
+	return false;
+}
+
+void TaskPool::execute(Task &task)
+{
+	SV_TRACE_SCOPE("TaskPool::execute");
+
+	const auto start = std::chrono::steady_clock::now();
+	try {
+		task();
+	}
+	catch (std::exception &e) {
+		qWarning() << "TaskPool::execute(): Task failed in" <<
+			QString::fromStdString(name_) << ":" << e.what();
+	}
+	catch (...) {
+		qWarning() << "TaskPool::execute(): Task failed in" <<
+			QString::fromStdString(name_);
+	}
+	// Release the captures of the task in this thread
+	task = nullptr;
+
+	busy_ns_ += (uint64_t)std::chrono::duration_cast<
+		std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now() - start).count();
+	++executed_count_;
+}
+
+std::mutex Executor::mutex_;
+bool Executor::shut_down_ = false;
+std::atomic<TaskPool *> Executor::compute_(nullptr);
+std::atomic<TaskPool *> Executor::io_(nullptr);
+
+void Executor::init(size_t compute_thread_count, size_t io_thread_count)
+{
+	init_pools(compute_thread_count, io_thread_count);
+}
+
+void Executor::init_pools(size_t compute_thread_count, size_t io_thread_count)
+{
+	lock_guard<std::mutex> lock(mutex_);
+	if (compute_ || shut_down_)
+		return;
+
+	if (compute_thread_count == 0)
+		compute_thread_count = default_compute_thread_count();
+	if (io_thread_count == 0)
+		io_thread_count = default_io_thread_count();
+	io_ = new TaskPool(io_thread_count, "SmuView I/O");
+	compute_ = new TaskPool(compute_thread_count, "SmuView compute");
+	qWarning() << "Executor::init(): Started" << compute_thread_count <<
+		"compute threads and" << io_thread_count << "I/O threads";
+}
+
+void Executor::shutdown()
+{
+	vector<TaskPool *> pools;
+	{
+		lock_guard<std::mutex> lock(mutex_);
+		shut_down_ = true;
+		pools.push_back(compute_.exchange(nullptr));
+		pools.push_back(io_.exchange(nullptr));
+	}
+
+	// The remaining tasks may still submit tasks, they are executed
+	// directly from now on.
+	for (TaskPool *task_pool : pools) {
+		if (!task_pool)
+			continue;
+		task_pool->stop();
+		const TaskPoolStatistics statistics = task_pool->statistics();
+		qWarning() << "Executor::shutdown():" << statistics.executed_count <<
+			"tasks executed," << statistics.stolen_count << "stolen," <<
+			statistics.busy_time << "s busy on" << statistics.thread_count <<
+			"threads";
+		delete task_pool;
+	}
+}
+
+TaskPool *Executor::compute()
+{
+	if (!compute_)
+		init_pools(0, 0);
+	return compute_;
+}
+
+TaskPool *Executor::io()
+{
+	if (!io_)
+		init_pools(0, 0);
+	return io_;
+}
+
+void Executor::run(Task task)
+{
+	TaskPool *pool = compute();
+	if (pool)
+		pool->submit(std::move(task));
+	else
+		task();
+}
+
+void Executor::run_io(Task task)
+{
+	TaskPool *pool = io();
+	if (pool)
+		pool->submit(std::move(task));
+	else
+		task();
+}
+
+size_t Executor::compute_budget()
+{
+	return (size_t)std::max(1, QThread::idealThreadCount() - 1);
+}
+
+size_t Executor::default_compute_thread_count()
+{
+	return std::max<size_t>(1, compute_budget() / 2);
+}
+
+size_t Executor::default_worker_thread_count()
+{
+	const size_t budget = compute_budget();
+	const size_t compute_thread_count = default_compute_thread_count();
+	return budget > compute_thread_count ? budget - compute_thread_count : 1;
+}
+
+size_t Executor::default_io_thread_count()
+{
+	return std::max<size_t>(4, std::thread::hardware_concurrency());
+}
+
+} // namespace sv
@@ -0,0 +1,193 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EXECUTOR_HPP
+#define EXECUTOR_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+namespace sv {
+
+using Task = std::function<void()>;
+
+/**
+ * The counters of a TaskPool.
+ */
+struct TaskPoolStatistics
+{
+	size_t thread_count;
+	/** The number of tasks, that are queued and not yet started. */
+	size_t pending_count;
+	uint64_t submitted_count;
+	uint64_t executed_count;
+	/** The number of tasks, that were taken from another queue. */
+	uint64_t stolen_count;
+	/** The time, all threads spent executing tasks, in seconds. */
+	double busy_time;
+};
+
+/**
+ * A fixed pool of threads, that execute short tasks.
+ *
+ * Every thread has its own queue. A task, that is submitted from a thread
+ * of the pool, is added to the queue of that thread and executed last in,
+ * first out, so its data is likely still in the cache. Other tasks are
+ * distributed round robin. An idle thread steals the oldest task of the
+ * other queues.
+ *
+ * The queued tasks are still executed, when the pool is destroyed.
+ */
+class TaskPool
+{
+public:
+	/**
+	 * @param thread_count The number of threads, at least one.
+	 * @param name The name of the threads, followed by their index.
+	 */
+	TaskPool(size_t thread_count, const string &name);
+	/** Calls stop(). */
+	~TaskPool();
+
+	TaskPool(const TaskPool &) = delete;
+	TaskPool &operator=(const TaskPool &) = delete;
+
+	/**
+	 * Queue a task. Exceptions of the task are logged. Tasks must not be
+	 * submitted after stop().
+	 */
+	void submit(Task task);
+	/** Execute the queued tasks and stop the threads. */
+	void stop();
+	size_t thread_count() const;
+	/** Return true if called from a thread of this pool. */
+	bool is_pool_thread() const;
+	TaskPoolStatistics statistics() const;
+
+private:
+	struct Queue
+	{
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+	void thread_proc(size_t index);
+	/** Take a task from the own queue or steal it from another queue. */
+	bool take_task(size_t index, Task &task);
+	void execute(Task &task);
+
+	const string name_;
+	vector<unique_ptr<Queue>> queues_;
+	vector<std::thread> threads_;
+	std::atomic<size_t> next_queue_;
+
+	/** Guards stop_ for the waiting threads. */
+	std::mutex wake_mutex_;
+	std::condition_variable wake_cond_;
+	bool stop_;
+	std::atomic<size_t> pending_count_;
+
+	std::atomic<uint64_t> submitted_count_;
+	std::atomic<uint64_t> executed_count_;
+	std::atomic<uint64_t> stolen_count_;
+	std::atomic<uint64_t> busy_ns_;
+
+};
+
+/**
+ * The application wide executors. All thread pools are sized here.
+ *
+ * - compute(): Short CPU bound tasks, e.g. freeing the chunks of cleared
+ *   signals.
+ * - io(): Tasks, that mostly wait, like the refresh of device properties
+ *   or the enumeration of serial ports. Has more threads than the cores.
+ *
+ * The CPU bound threads are one less than the cores (see compute_budget())
+ * and are shared by compute() and the WorkerPool of the math channels, so
+ * the cores aren't oversubscribed.
+ *
+ * The executors are created by init() or on first use.
+ */
+class Executor
+{
+public:
+	/**
+	 * Create the executors. 0 uses the default thread counts.
+	 */
+	static void init(size_t compute_thread_count = 0,
+		size_t io_thread_count = 0);
+	/**
+	 * Execute the queued tasks, stop the threads and log the statistics.
+	 * Tasks, that are submitted later, are executed directly.
+	 */
+	static void shutdown();
+
+	/** Return nullptr after shutdown(). */
+	static TaskPool *compute();
+	/** Return nullptr after shutdown(). */
+	static TaskPool *io();
+
+	/** Submit a task to compute(). */
+	static void run(Task task);
+	/** Submit a task to io(). */
+	static void run_io(Task task);
+
+	/**
+	 * The number of threads for CPU bound work: one thread less than the
+	 * cores, but at least one.
+	 */
+	static size_t compute_budget();
+	/** Half of compute_budget(), but at least one thread. */
+	static size_t default_compute_thread_count();
+	/**
+	 * The rest of compute_budget() for the WorkerPool, but at least one
+	 * thread.
+	 */
+	static size_t default_worker_thread_count();
+	/** At least four threads. */
+	static size_t default_io_thread_count();
+
+private:
+	static void init_pools(size_t compute_thread_count,
+		size_t io_thread_count);
+
+	static std::mutex mutex_;
+	/** shutdown() was called, no new pools are created. */
+	static bool shut_down_;
+	static std::atomic<TaskPool *> compute_;
+	static std::atomic<TaskPool *> io_;
+
+};
+
+} // namespace sv
+
+#endif // EXECUTOR_HPP
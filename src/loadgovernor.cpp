@@ -0,0 +1,174 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QMetaObject>
+#include <QString>
+#include <QTimer>
+
+#include "loadgovernor.hpp"
+
+namespace sv {
+
+const int LoadGovernor::probe_interval_ = 100;
+const int LoadGovernor::max_level_ = 3;
+const double LoadGovernor::high_latency_ = 50.;
+const double LoadGovernor::low_latency_ = 10.;
+const int LoadGovernor::raise_probes_ = 3;
+const int LoadGovernor::lower_probes_ = 30;
+const double LoadGovernor::latency_weight_ = 0.3;
+
+LoadGovernor::LoadGovernor(QObject *parent) :
+	QObject(parent),
+	last_tick_time_(-1.),
+	probe_post_time_(-1.),
+	probe_delay_(0.),
+	latency_(0.),
+	level_(0),
+	high_probes_(0),
+	low_probes_(0)
+{
+	probe_timer_.setTimerType(Qt::PreciseTimer);
+	connect(&probe_timer_, &QTimer::timeout,
+		this, &LoadGovernor::on_probe_timer);
+	clock_.start();
+}
+
+void LoadGovernor::start()
+{
+	if (probe_timer_.isActive())
+		return;
+
+	last_tick_time_ = -1.;
+	probe_post_time_ = -1.;
+	probe_delay_ = 0.;
+	latency_ = 0.;
+	high_probes_ = 0;
+	low_probes_ = 0;
+	probe_timer_.start(probe_interval_);
+}
+
+void LoadGovernor::stop()
+{
+	probe_timer_.stop();
+	set_level(0);
+}
+
+bool LoadGovernor::is_running() const
+{
+	return probe_timer_.isActive();
+}
+
+int LoadGovernor::level() const
+{
+	return level_;
+}
+
+int LoadGovernor::max_level()
+{
+	return max_level_;
+}
+
+double LoadGovernor::latency() const
+{
+	return latency_;
+}
+
+int LoadGovernor::interval_factor() const
+{
+	return 1 << level_;
+}
+
+int LoadGovernor::column_step() const
+{
+	return level_ > 1 ? 1 << (level_ - 1) : 1;
+}
+
+void LoadGovernor::on_probe_timer()
+{
+	const double now = (double)clock_.nsecsElapsed() / 1e6;
+	const double lateness = last_tick_time_ >= 0. ?
+		std::max(0., now - last_tick_time_ - (double)probe_interval_) : 0.;
+	last_tick_time_ = now;
+
+	// A probe, that is still queued, is at least as late as it is old
+	const bool probe_pending = probe_post_time_ >= 0.;
+	const double delay = probe_pending ? now - probe_post_time_ : probe_delay_;
+	add_latency(std::max(lateness, delay));
+
+	// The probe is queued behind all signals, that are already posted to
+	// the GUI thread.
+	if (!probe_pending) {
+		probe_post_time_ = now;
+		QMetaObject::invokeMethod(this, "on_probe_delivered",
+			Qt::QueuedConnection);
+	}
+}
+
+void LoadGovernor::on_probe_delivered()
+{
+	if (probe_post_time_ < 0.)
+		return;
+	probe_delay_ = (double)clock_.nsecsElapsed() / 1e6 - probe_post_time_;
+	probe_post_time_ = -1.;
+}
+
+void LoadGovernor::add_latency(double latency)
+{
+	latency_ = (1. - latency_weight_) * latency_ + latency_weight_ * latency;
+
+	// The level is raised fast and lowered slowly, so the quality doesn't
+	// oscillate, when the restored quality causes the load again.
+	if (latency_ > high_latency_) {
+		low_probes_ = 0;
+		if (++high_probes_ >= raise_probes_) {
+			high_probes_ = 0;
+			set_level(level_ + 1);
+		}
+	}
+	else if (latency_ < low_latency_) {
+		high_probes_ = 0;
+		if (++low_probes_ >= lower_probes_) {
+			low_probes_ = 0;
+			set_level(level_ - 1);
+		}
+	}
+	else {
+		high_probes_ = 0;
+		low_probes_ = 0;
+	}
+}
+
+void LoadGovernor::set_level(int level)
+{
+	level = std::max(0, std::min(level, max_level_));
+	if (level == level_)
+		return;
+
+	qWarning().noquote() << QString("LoadGovernor: The event loop latency "
+		"is %1 ms, changing the load level from %2 to %3").
+		arg(latency_, 0, 'f', 0).arg(level_).arg(level);
+	level_ = level;
+	Q_EMIT level_changed(level_);
+}
+
+} // namespace sv
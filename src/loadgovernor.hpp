@@ -0,0 +1,115 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LOADGOVERNOR_HPP
+#define LOADGOVERNOR_HPP
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+
+namespace sv {
+
+/**
+ * Lowers the quality of the GUI updates, while the GUI thread falls behind,
+ * so that SmuView stays responsive instead of getting sluggish.
+ *
+ * A probe timer in the GUI thread measures the latency of the event loop:
+ * The lateness of the timer itself (the GUI thread was busy) and the delay
+ * of a queued probe call, that is posted behind all queued signals (the
+ * backlog of queued signals from the acquisition threads). When the smoothed
+ * latency stays above a high mark, the load level is raised one step, when
+ * it stays below a low mark for a longer time, it is lowered one step again.
+ *
+ * The level only affects the GUI side: The plot and panel schedulers, the
+ * data views and the envelope resolution of the curves follow
+ * level_changed(). The acquisition and the ingest threads are never
+ * throttled, so no samples are lost.
+ */
+class LoadGovernor : public QObject
+{
+	Q_OBJECT
+
+public:
+	/** Must be created in the GUI thread. */
+	explicit LoadGovernor(QObject *parent = nullptr);
+
+	void start();
+	/** Stop measuring and restore the full quality. */
+	void stop();
+	bool is_running() const;
+
+	/** Return the load level, from 0 (full quality) to max_level(). */
+	int level() const;
+	static int max_level();
+	/** Return the smoothed latency of the event loop in milliseconds. */
+	double latency() const;
+
+	/**
+	 * Return the factor for the update intervals of the plots, the panels
+	 * and the data views at the current level: 1, 2, 4, 8.
+	 */
+	int interval_factor() const;
+	/**
+	 * Return the number of pixel columns per envelope column of the curves
+	 * at the current level: 1, 1, 2, 4.
+	 */
+	int column_step() const;
+
+Q_SIGNALS:
+	void level_changed(int level);
+
+private:
+	void on_probe_timer();
+	void add_latency(double latency);
+	void set_level(int level);
+
+	/** The interval of the probe timer in milliseconds. */
+	static const int probe_interval_;
+	static const int max_level_;
+	/** The latencies in milliseconds, that raise or lower the level. */
+	static const double high_latency_;
+	static const double low_latency_;
+	/** The number of probes above/below the marks to change the level. */
+	static const int raise_probes_;
+	static const int lower_probes_;
+	/** The weight of a new latency in the average. */
+	static const double latency_weight_;
+
+	QTimer probe_timer_;
+	QElapsedTimer clock_;
+	/** The time of the last probe tick in milliseconds, < 0 if none. */
+	double last_tick_time_;
+	/** The time, the queued probe was posted, < 0 if none is pending. */
+	double probe_post_time_;
+	/** The delay of the last delivered probe in milliseconds. */
+	double probe_delay_;
+	double latency_;
+	int level_;
+	int high_probes_;
+	int low_probes_;
+
+private Q_SLOTS:
+	void on_probe_delivered();
+
+};
+
+} // namespace sv
+
+#endif // LOADGOVERNOR_HPP
@@ -55,6 +55,9 @@
 #include "src/ui/tabs/tabhelper.hpp"
 #include "src/ui/tabs/welcometab.hpp"
 #include "src/ui/views/devicesview.hpp"
+#include "src/ui/views/limitresultsview.hpp"
+#include "src/ui/views/performanceview.hpp"
+#include "src/ui/views/plotprofilerview.hpp"
 #include "src/ui/views/smuscripttreeview.hpp"
 
 using std::make_pair;
@@ -73,7 +76,10 @@ MainWindow::MainWindow(DeviceManager &device_manager,
 		shared_ptr<Session> session, QWidget *parent) :
 	QMainWindow(parent),
 	device_manager_(device_manager),
-	session_(session)
+	session_(session),
+	plot_profiler_view_(nullptr),
+	performance_dock_(nullptr),
+	limit_results_dock_(nullptr)
 {
 	qRegisterMetaType<util::Timestamp>("util::Timestamp");
 	qRegisterMetaType<uint64_t>("uint64_t");
@@ -192,6 +198,63 @@ ui::tabs::BaseTab *MainWindow::get_tab_from_tab_id(const string &id)
 	return tab_window_map_[id];
 }
 
+void MainWindow::show_plot_profiler()
+{
+	if (plot_profiler_view_)
+		return;
+
+	plot_profiler_view_ = new ui::views::PlotProfilerView(*session_);
+
+	QDockWidget* profiler_dock = new QDockWidget(plot_profiler_view_->title());
+	profiler_dock->setObjectName("plot_profiler_dock");
+	profiler_dock->setAllowedAreas(Qt::AllDockWidgetAreas);
+	profiler_dock->setContextMenuPolicy(Qt::PreventContextMenu);
+	profiler_dock->setFeatures(QDockWidget::DockWidgetMovable |
+		QDockWidget::DockWidgetFloatable);
+	profiler_dock->setWidget(plot_profiler_view_);
+	this->addDockWidget(Qt::BottomDockWidgetArea, profiler_dock);
+}
+
+void MainWindow::show_performance_view()
+{
+	if (performance_dock_) {
+		performance_dock_->show();
+		performance_dock_->raise();
+		return;
+	}
+
+	auto performance_view = new ui::views::PerformanceView(*session_);
+
+	performance_dock_ = new QDockWidget(performance_view->title());
+	performance_dock_->setObjectName("performance_dock");
+	performance_dock_->setAllowedAreas(Qt::AllDockWidgetAreas);
+	performance_dock_->setContextMenuPolicy(Qt::PreventContextMenu);
+	performance_dock_->setFeatures(QDockWidget::DockWidgetMovable |
+		QDockWidget::DockWidgetFloatable | QDockWidget::DockWidgetClosable);
+	performance_dock_->setWidget(performance_view);
+	this->addDockWidget(Qt::RightDockWidgetArea, performance_dock_);
+}
+
+void MainWindow::show_limit_results_view()
+{
+	if (limit_results_dock_) {
+		limit_results_dock_->show();
+		limit_results_dock_->raise();
+		return;
+	}
+
+	auto limit_results_view = new ui::views::LimitResultsView(*session_);
+
+	limit_results_dock_ = new QDockWidget(limit_results_view->title());
+	limit_results_dock_->setObjectName("limit_results_dock");
+	limit_results_dock_->setAllowedAreas(Qt::AllDockWidgetAreas);
+	limit_results_dock_->setContextMenuPolicy(Qt::PreventContextMenu);
+	limit_results_dock_->setFeatures(QDockWidget::DockWidgetMovable |
+		QDockWidget::DockWidgetFloatable | QDockWidget::DockWidgetClosable);
+	limit_results_dock_->setWidget(limit_results_view);
+	this->addDockWidget(Qt::RightDockWidgetArea, limit_results_dock_);
+}
+
 void MainWindow::setup_ui()
 {
 	QIcon mainIcon;
@@ -25,6 +25,7 @@
 #include <string>
 
 #include <QCloseEvent>
+#include <QDockWidget>
 #include <QMainWindow>
 #include <QSettings>
 
@@ -51,6 +52,8 @@ class WelcomeTab;
 }
 namespace views {
 class DevicesView;
+class PerformanceView;
+class PlotProfilerView;
 class SmuScriptTreeView;
 }
 }
@@ -73,6 +76,21 @@ public:
 	void change_tab_icon(const string &tab_id, const QIcon &icon);
 	void change_tab_title(const string &tab_id, const QString &title);
 	ui::tabs::BaseTab *get_tab_from_tab_id(const string &id);
+	/**
+	 * Show the frame statistics of all plots in a dock, see
+	 * ui::views::PlotProfilerView.
+	 */
+	void show_plot_profiler();
+	/**
+	 * Show the live metrics of the session in a dock, see
+	 * ui::views::PerformanceView.
+	 */
+	void show_performance_view();
+	/**
+	 * Show the pass/fail results of the limit engines in a dock, see
+	 * ui::views::LimitResultsView.
+	 */
+	void show_limit_results_view();
 
 private:
 	void setup_ui();
@@ -93,6 +111,9 @@ private:
 	QWidget *central_widget_;
 	ui::views::DevicesView *devices_view_;
 	ui::views::SmuScriptTreeView *smu_script_tree_view_;
+	ui::views::PlotProfilerView *plot_profiler_view_;
+	QDockWidget *performance_dock_;
+	QDockWidget *limit_results_dock_;
 	QTabWidget *tab_widget_;
 	/** tab_window_map_ is used to get the index of the tab in the QTabWidget */
 	map<string, ui::tabs::BaseTab *> tab_window_map_;
@@ -0,0 +1,213 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QLibrary>
+#include <QStandardPaths>
+#include <QString>
+#include <QStringList>
+
+#include "pluginmanager.hpp"
+#include "src/plugins/smuviewplugin.h"
+
+using std::make_pair;
+using std::make_shared;
+using std::map;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace plugins {
+
+vector<shared_ptr<QLibrary>> PluginManager::libraries_;
+vector<const sv_plugin *> PluginManager::plugins_;
+map<string, const sv_math_processor *> PluginManager::math_processors_;
+map<string, const sv_virtual_device *> PluginManager::virtual_devices_;
+
+QString PluginManager::default_plugin_dir()
+{
+	return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) +
+		"/plugins";
+}
+
+size_t PluginManager::load_plugins(const QStringList &dirs)
+{
+	size_t count = 0;
+	for (const auto &dir_name : dirs) {
+		const QDir dir(dir_name);
+		if (!dir.exists())
+			continue;
+
+		const auto entries = dir.entryInfoList(
+			QDir::Files | QDir::Readable, QDir::Name);
+		for (const auto &entry : entries) {
+			if (!QLibrary::isLibrary(entry.fileName()))
+				continue;
+			if (load_plugin(entry.absoluteFilePath()))
+				++count;
+		}
+	}
+	return count;
+}
+
+bool PluginManager::load_plugin(const QString &file_name)
+{
+	auto library = make_shared<QLibrary>(file_name);
+	if (!library->load()) {
+		qWarning() << "PluginManager::load_plugin(): Can't load" <<
+			file_name << ":" << library->errorString();
+		return false;
+	}
+
+	auto entry = (sv_plugin_entry_t)library->resolve(SV_PLUGIN_ENTRY);
+	if (!entry) {
+		qWarning() << "PluginManager::load_plugin():" << file_name <<
+			"has no" << SV_PLUGIN_ENTRY << "function";
+		library->unload();
+		return false;
+	}
+
+	const sv_plugin *plugin = entry();
+	if (!plugin || !plugin->name) {
+		qWarning() << "PluginManager::load_plugin():" << file_name <<
+			"has no valid descriptor";
+		library->unload();
+		return false;
+	}
+	if (plugin->api_version == 0 ||
+			plugin->api_version > SV_PLUGIN_API_VERSION) {
+		qWarning() << "PluginManager::load_plugin():" << file_name <<
+			"needs the plugin API version" << plugin->api_version;
+		library->unload();
+		return false;
+	}
+
+	for (unsigned int i = 0; i < plugin->math_processor_count; ++i) {
+		if (!plugin->math_processors || !plugin->math_processors[i] ||
+				!is_valid(*plugin->math_processors[i])) {
+			qWarning() << "PluginManager::load_plugin():" << file_name <<
+				"has an invalid math processor";
+			continue;
+		}
+		const sv_math_processor &processor = *plugin->math_processors[i];
+		if (!math_processors_.insert(
+				make_pair(string(processor.id), &processor)).second) {
+			qWarning() << "PluginManager::load_plugin(): The math processor" <<
+				processor.id << "is already registered";
+		}
+	}
+	for (unsigned int i = 0; i < plugin->virtual_device_count; ++i) {
+		if (!plugin->virtual_devices || !plugin->virtual_devices[i] ||
+				!is_valid(*plugin->virtual_devices[i])) {
+			qWarning() << "PluginManager::load_plugin():" << file_name <<
+				"has an invalid virtual device";
+			continue;
+		}
+		const sv_virtual_device &device = *plugin->virtual_devices[i];
+		if (!virtual_devices_.insert(
+				make_pair(string(device.id), &device)).second) {
+			qWarning() << "PluginManager::load_plugin(): The virtual device" <<
+				device.id << "is already registered";
+		}
+	}
+
+	qWarning() << "PluginManager::load_plugin(): Loaded" << plugin->name <<
+		"from" << file_name;
+
+	// The library must stay loaded, it is referenced by the registry
+	libraries_.push_back(library);
+	plugins_.push_back(plugin);
+	return true;
+}
+
+bool PluginManager::is_valid(const sv_math_processor &processor)
+{
+	return processor.id && processor.id[0] != '\0' && processor.create &&
+		processor.destroy && processor.process;
+}
+
+bool PluginManager::is_valid(const sv_virtual_device &device)
+{
+	if (!device.id || device.id[0] == '\0' || !device.create ||
+			!device.destroy || !device.acquire)
+		return false;
+	if (device.channel_count == 0 || !device.channels)
+		return false;
+	for (unsigned int i = 0; i < device.channel_count; ++i) {
+		if (!device.channels[i] || !device.channels[i]->name)
+			return false;
+	}
+	return device.acquire_rate > 0 && device.max_samples > 0;
+}
+
+vector<string> PluginManager::plugin_names()
+{
+	vector<string> names;
+	for (const auto &plugin : plugins_) {
+		string name = plugin->name;
+		if (plugin->version)
+			name += string(" ") + plugin->version;
+		names.push_back(name);
+	}
+	return names;
+}
+
+vector<string> PluginManager::math_processor_ids()
+{
+	vector<string> ids;
+	for (const auto &processor : math_processors_)
+		ids.push_back(processor.first);
+	return ids;
+}
+
+const sv_math_processor *PluginManager::find_math_processor(const string &id)
+{
+	const auto it = math_processors_.find(id);
+	if (it == math_processors_.end())
+		return nullptr;
+	return it->second;
+}
+
+vector<string> PluginManager::virtual_device_ids()
+{
+	vector<string> ids;
+	for (const auto &device : virtual_devices_)
+		ids.push_back(device.first);
+	return ids;
+}
+
+const sv_virtual_device *PluginManager::find_virtual_device(const string &id)
+{
+	const auto it = virtual_devices_.find(id);
+	if (it == virtual_devices_.end())
+		return nullptr;
+	return it->second;
+}
+
+} // namespace plugins
+} // namespace sv
@@ -0,0 +1,98 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PLUGINS_PLUGINMANAGER_HPP
+#define PLUGINS_PLUGINMANAGER_HPP
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <QString>
+#include <QStringList>
+
+#include "src/plugins/smuviewplugin.h"
+
+using std::map;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+class QLibrary;
+
+namespace sv {
+namespace plugins {
+
+/**
+ * Loads the native plugins (see smuviewplugin.h) and registers their math
+ * processors and virtual devices by their id.
+ *
+ * The plugins are loaded once at startup by load_plugins(), before the
+ * session is created. Afterwards the registry is only read, so it can be
+ * used from any thread without locking. The libraries are never unloaded,
+ * the processors may be in use until the exit.
+ */
+class PluginManager
+{
+
+public:
+	/**
+	 * Return the default plugin directory in the application data of the
+	 * user.
+	 */
+	static QString default_plugin_dir();
+
+	/**
+	 * Load all plugins in the directories. Directories, that don't exist,
+	 * are skipped. Plugins with an invalid descriptor or a newer API
+	 * version are skipped with a warning, as are processors and devices,
+	 * whose id is already registered.
+	 *
+	 * @return The number of loaded plugins.
+	 */
+	static size_t load_plugins(const QStringList &dirs);
+
+	/** Return "name version" of all loaded plugins. */
+	static vector<string> plugin_names();
+
+	static vector<string> math_processor_ids();
+	/** Return the math processor with the id or nullptr. */
+	static const sv_math_processor *find_math_processor(const string &id);
+
+	static vector<string> virtual_device_ids();
+	/** Return the virtual device with the id or nullptr. */
+	static const sv_virtual_device *find_virtual_device(const string &id);
+
+private:
+	static bool load_plugin(const QString &file_name);
+	static bool is_valid(const sv_math_processor &processor);
+	static bool is_valid(const sv_virtual_device &device);
+
+	static vector<shared_ptr<QLibrary>> libraries_;
+	static vector<const sv_plugin *> plugins_;
+	static map<string, const sv_math_processor *> math_processors_;
+	static map<string, const sv_virtual_device *> virtual_devices_;
+
+};
+
+} // namespace plugins
+} // namespace sv
+
+#endif // PLUGINS_PLUGINMANAGER_HPP
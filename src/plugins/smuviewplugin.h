@@ -0,0 +1,162 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PLUGINS_SMUVIEWPLUGIN_H
+#define PLUGINS_SMUVIEWPLUGIN_H
+
+/*
+ * The plugin ABI of SmuView.
+ *
+ * A plugin is a shared library, that exports the C function
+ * sv_plugin_descriptor(). SmuView loads all plugins of the plugin
+ * directories at startup and calls the function once. The returned
+ * descriptor and everything it points to must stay valid, until the
+ * library is unloaded at exit.
+ *
+ * Only C types are used, so plugins can be written in any language with a
+ * C interface and don't depend on the compiler, the C++ standard library or
+ * the Qt version of SmuView. Quantities, quantity flags and units are the
+ * values of enum sr_mq, enum sr_mqflag and enum sr_unit of libsigrok.
+ *
+ * The ABI is only extended by appending fields to the end of the structs
+ * and by increasing SV_PLUGIN_API_VERSION. SmuView loads all plugins with
+ * the same or a lower API version. Therefore the lists in the structs are
+ * arrays of pointers and never arrays of structs: The size of a struct may
+ * grow, but SmuView never indexes the structs of a plugin with its own
+ * struct size.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SV_PLUGIN_API_VERSION 1
+
+/** The name of the function, that every plugin must export. */
+#define SV_PLUGIN_ENTRY "sv_plugin_descriptor"
+
+#if defined(_WIN32)
+#define SV_PLUGIN_EXPORT __declspec(dllexport)
+#else
+#define SV_PLUGIN_EXPORT __attribute__((visibility("default")))
+#endif
+
+/**
+ * A processor for math channels, that calculates one result per sample of
+ * its input signals.
+ *
+ * The input signals are aligned like for an expression channel: All inputs
+ * have a value for every timestamp. An instance is only called from one
+ * thread at a time, but different instances may be called concurrently.
+ */
+struct sv_math_processor {
+	/** The unique id of the processor, e.g. "mylib.fir". */
+	const char *id;
+	const char *description;
+	/** The number of input signals or 0 for any number. */
+	unsigned int input_count;
+
+	/**
+	 * Create an instance for input_count signals. args are the arguments,
+	 * that the user has passed for the channel (never NULL).
+	 *
+	 * @return The instance or NULL if the arguments are invalid.
+	 */
+	void *(*create)(unsigned int input_count, const char *args);
+	void (*destroy)(void *instance);
+	/**
+	 * Calculate count results. inputs[i][k] is the value of input signal i
+	 * at timestamps[k], the timestamps are in seconds.
+	 *
+	 * @return 0 on success. Otherwise the channel stops calculating.
+	 */
+	int (*process)(void *instance, size_t count, const double *timestamps,
+		const double *const *inputs, double *results);
+};
+
+/** A channel of a virtual device. */
+struct sv_virtual_channel {
+	const char *name;
+	/** enum sr_mq */
+	uint32_t quantity;
+	/** Bit mask of enum sr_mqflag */
+	uint64_t quantity_flags;
+	/** enum sr_unit */
+	uint32_t unit;
+	int digits;
+	int decimal_places;
+};
+
+/**
+ * A virtual instrument, that produces the samples of its channels.
+ *
+ * SmuView creates a user device with a user channel for every channel and
+ * calls acquire() acquire_rate times per second in a dedicated thread.
+ */
+struct sv_virtual_device {
+	/** The unique id of the device, e.g. "mylib.siggen". */
+	const char *id;
+	const char *vendor;
+	const char *model;
+	const char *description;
+	unsigned int channel_count;
+	const struct sv_virtual_channel *const *channels;
+	/** The number of acquire() calls per second. */
+	double acquire_rate;
+	/** The maximum number of samples per channel and acquire() call. */
+	size_t max_samples;
+
+	/** See sv_math_processor.create(). */
+	void *(*create)(const char *args);
+	void (*destroy)(void *instance);
+	/**
+	 * Acquire up to max_samples samples for every channel. time is the time
+	 * in seconds since the start of the device. The timestamps of the
+	 * samples (in seconds since the start) are written to timestamps, the
+	 * values of channel i to values[i]. The number of samples per channel
+	 * is written to count, it may be 0.
+	 *
+	 * @return 0 on success. Otherwise the acquisition stops.
+	 */
+	int (*acquire)(void *instance, double time, size_t *count,
+		double *timestamps, double *const *values);
+};
+
+/** The descriptor of a plugin. */
+struct sv_plugin {
+	/** Must be SV_PLUGIN_API_VERSION. */
+	unsigned int api_version;
+	const char *name;
+	const char *version;
+	unsigned int math_processor_count;
+	const struct sv_math_processor *const *math_processors;
+	unsigned int virtual_device_count;
+	const struct sv_virtual_device *const *virtual_devices;
+};
+
+typedef const struct sv_plugin *(*sv_plugin_entry_t)(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PLUGINS_SMUVIEWPLUGIN_H */
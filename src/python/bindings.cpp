@@ -21,27 +21,66 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <tuple>
+#include <vector>
 #include <pybind11/embed.h>
 #include <pybind11/stl.h>
 
 #include "bindings.hpp"
 #include "config.h"
 #include "src/session.hpp"
+#include "src/channels/acpowerchannel.hpp"
 #include "src/channels/basechannel.hpp"
+#include "src/channels/calibrationchannel.hpp"
 #include "src/channels/hardwarechannel.hpp"
+#include "src/channels/mathchannel.hpp"
+#include "src/channels/minmaxholdchannel.hpp"
+#include "src/channels/periodicsampler.hpp"
+#include "src/channels/resamplechannel.hpp"
 #include "src/channels/userchannel.hpp"
 #include "src/data/analogbasesignal.hpp"
 #include "src/data/analogsamplesignal.hpp"
+#include "src/data/analogsegmentsignal.hpp"
 #include "src/data/analogtimesignal.hpp"
+#include "src/data/analogtimesnapshot.hpp"
 #include "src/data/basesignal.hpp"
+#include "src/data/calibrationcurve.hpp"
+#include "src/data/capturefile.hpp"
+#include "src/data/capturerecorder.hpp"
 #include "src/data/datautil.hpp"
+#include "src/data/limitengine.hpp"
+#include "src/data/metricsexporter.hpp"
+#include "src/data/minmaxpyramid.hpp"
+#include "src/data/remoteserver.hpp"
+#include "src/data/sampledecimator.hpp"
+#include "src/data/signalregistry.hpp"
+#include "src/data/signalstreamer.hpp"
+#include "src/data/skewestimator.hpp"
+#include "src/data/triggerengine.hpp"
+#include "src/data/valuebuffer.hpp"
+#include "src/devices/acquisitionstatistics.hpp"
 #include "src/devices/basedevice.hpp"
 #include "src/devices/configurable.hpp"
+#include "src/devices/controlengine.hpp"
 #include "src/devices/deviceutil.hpp"
 #include "src/devices/hardwaredevice.hpp"
+#include "src/devices/plugindeviceengine.hpp"
+#include "src/devices/remoteclient.hpp"
+#include "src/devices/replayengine.hpp"
+#include "src/devices/scanlistengine.hpp"
+#include "src/devices/sweepengine.hpp"
+#include "src/devices/threadpolicy.hpp"
 #include "src/devices/userdevice.hpp"
+#include "src/plugins/pluginmanager.hpp"
+#include "src/python/pyasync.hpp"
+#include "src/python/pyconfigurable.hpp"
+#include "src/python/pymathchannel.hpp"
+#include "src/python/pynumpy.hpp"
 #include "src/python/pystreambuf.hpp"
+#include "src/python/samplesubscription.hpp"
+#include "src/python/uibatch.hpp"
 #include "src/python/uiproxy.hpp"
+#include "src/ui/widgets/plot/plot.hpp"
 
 using std::set;
 
@@ -117,8 +156,49 @@ void init_Session(py::module &m)
 		"-------\n"
 		"Dict[str, BaseDevice]\n"
 		"    A Dict where the key is the device id and the value is the device object.");
+	py_session.def("signals",
+		[](const sv::Session &session) {
+			return *session.signal_registry()->signals();
+		},
+		"Return the signals of all connected devices, in the order they were "
+		"created.\n\n"
+		"Returns\n"
+		"-------\n"
+		"List[BaseSignal]\n"
+		"    All signals of the session.");
+	py_session.def("to_dataframe",
+		[](const sv::Session &,
+				const std::vector<std::shared_ptr<sv::data::AnalogTimeSignal>> &signals,
+				const std::string &mode, py::object grid, bool relative_time) {
+			return sv::python::signals_to_dataframe(signals, mode, grid, relative_time);
+		},
+		py::arg("signals"), py::arg("mode") = "combined", py::arg("grid") = py::none(),
+		py::arg("relative_time") = true,
+		"Return the samples of several signals as one table in a single call. The timestamps are "
+		"merged or resampled natively, this is much faster than reading the samples one by one.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"signals : List[AnalogTimeSignal]\n"
+		"    The signals, one column per signal.\n"
+		"mode : str\n"
+		"    `\"combined\"`: A row for every timestamp of any signal, the other signals are linearly "
+		"interpolated. Rows before the first or after the last sample of any signal are skipped. "
+		"`\"resampled\"`: All signals are linearly interpolated on the grid.\n"
+		"grid : None or float or numpy.ndarray\n"
+		"    The grid of the resampled mode: `None` for the sample interval of the fastest signal, "
+		"the interval in seconds (the grid points are multiples of the interval) or an array of "
+		"ascending timestamps. Values outside of the samples of a signal are NaN.\n"
+		"relative_time : bool\n"
+		"    When `True` (default), the timestamps (also of a grid array) are relative to the start "
+		"of the first signal.\n\n"
+		"Returns\n"
+		"-------\n"
+		"pandas.DataFrame or Dict[str, numpy.ndarray]\n"
+		"    The column `timestamp` and a column per signal, named like the signal. A dict of NumPy "
+		"arrays, if pandas isn't installed. `None` if the table can't be built.");
 	py_session.def("connect_device", &sv::Session::connect_device,
 		py::arg("conn_str"),
+		py::call_guard<py::gil_scoped_release>(),
 		"Connect a new device. For some devices (like DMMs) you may want to "
 		"wait a fixed time, until the first sample has arrived and an `AnalogSignal` "
 		"object has been created. Example:\n"
@@ -146,11 +226,363 @@ void init_Session(py::module &m)
 		"    The created user device object.");
 	py_session.def("remove_device", &sv::Session::remove_device,
 		py::arg("device"),
+		py::call_guard<py::gil_scoped_release>(),
 		"Close a device and remove it from the session. This will also delete all aquired data!\n\n"
 		"Parameters\n"
 		"-------\n"
 		"device : BaseDevice\n"
 		"    The device to remove.");
+	py_session.def("replay_csv_file", &sv::Session::replay_csv_file,
+		py::arg("file_name"), py::arg("speed") = 1., py::arg("loop") = false,
+		py::call_guard<py::gil_scoped_release>(),
+		"Replay a CSV file, that was saved with relative timestamps, through a new user device. "
+		"A user channel is created for every signal in the file and the samples are pushed in "
+		"the order of their timestamps, so math channels and plots get the same load as from a "
+		"real device.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"file_name : str\n"
+		"    The path of the CSV file.\n"
+		"speed : float\n"
+		"    The replay speed, `1` is real time. `0` replays as fast as possible.\n"
+		"loop : bool\n"
+		"    `True` to restart the replay, when all samples were replayed.\n\n"
+		"Returns\n"
+		"-------\n"
+		"ReplayEngine\n"
+		"    The replay engine object or `None` if the file couldn't be loaded.");
+	py_session.def("add_scan_list", &sv::Session::add_scan_list,
+		py::arg("signal"),
+		py::call_guard<py::gil_scoped_release>(),
+		"Create a scan list, that measures the channels of a multiplexer with one signal, "
+		"e.g. the signal of a DMM. The measured values are stored in the user channels of a "
+		"new user device.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"signal : AnalogTimeSignal\n"
+		"    The signal, that measures the selected channel.\n\n"
+		"Returns\n"
+		"-------\n"
+		"ScanListEngine\n"
+		"    The scan list engine object.");
+	py_session.def("add_sweep", &sv::Session::add_sweep,
+		py::arg("configurable"), py::arg("config_key"),
+		py::call_guard<py::gil_scoped_release>(),
+		"Create a sweep of a setpoint, e.g. the voltage target of a power supply. "
+		"The measured values are stored in the user channels of a new user device.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"configurable : Configurable\n"
+		"    The configurable with the setpoint.\n"
+		"config_key : ConfigKey\n"
+		"    The `ConfigKey` of the setpoint, e.g. `ConfigKey.VoltageTarget`.\n\n"
+		"Returns\n"
+		"-------\n"
+		"SweepEngine\n"
+		"    The sweep engine object or `None` if the config key is not a setable double value.");
+	py_session.def("add_control_loop", &sv::Session::add_control_loop,
+		py::arg("signal"), py::arg("configurable"), py::arg("config_key"),
+		py::call_guard<py::gil_scoped_release>(),
+		"Create a closed control loop from a signal to a setpoint, e.g. from the voltage to the current "
+		"of an electronic load for a constant power load. The loop runs natively and is woken up by "
+		"every new sample of the signal.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"signal : AnalogTimeSignal\n"
+		"    The input signal.\n"
+		"configurable : Configurable\n"
+		"    The configurable with the output setpoint.\n"
+		"config_key : ConfigKey\n"
+		"    The `ConfigKey` of the output, e.g. `ConfigKey.CurrentLimit`.\n\n"
+		"Returns\n"
+		"-------\n"
+		"ControlEngine\n"
+		"    The control engine object or `None` if the config key is not a setable double value.");
+	py_session.def("add_plugin_device", &sv::Session::add_plugin_device,
+		py::arg("virtual_device"), py::arg("args") = "",
+		py::call_guard<py::gil_scoped_release>(),
+		"Start the virtual device of a native plugin on a new user device. A user channel is "
+		"created for every channel of the virtual device.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"virtual_device : str\n"
+		"    The id of the virtual device, see `plugin_virtual_devices()`.\n"
+		"args : str\n"
+		"    The arguments, that are passed to the plugin.\n\n"
+		"Returns\n"
+		"-------\n"
+		"PluginDeviceEngine\n"
+		"    The engine of the device or `None` if the virtual device doesn't exist or doesn't "
+		"accept the arguments.");
+	py_session.def("plugins", [](sv::Session &session) {
+			(void)session;
+			return sv::plugins::PluginManager::plugin_names();
+		},
+		"Return the names and versions of the loaded native plugins.\n\n"
+		"Returns\n"
+		"-------\n"
+		"List[str]\n"
+		"    The plugins.");
+	py_session.def("plugin_math_processors", [](sv::Session &session) {
+			(void)session;
+			return sv::plugins::PluginManager::math_processor_ids();
+		},
+		"Return the ids of the math processors of the native plugins, see "
+		"`BaseDevice.add_plugin_channel()`.\n\n"
+		"Returns\n"
+		"-------\n"
+		"List[str]\n"
+		"    The ids of the math processors.");
+	py_session.def("plugin_virtual_devices", [](sv::Session &session) {
+			(void)session;
+			return sv::plugins::PluginManager::virtual_device_ids();
+		},
+		"Return the ids of the virtual devices of the native plugins, see "
+		"`add_plugin_device()`.\n\n"
+		"Returns\n"
+		"-------\n"
+		"List[str]\n"
+		"    The ids of the virtual devices.");
+	py_session.def("open_capture_file", &sv::Session::open_capture_file,
+		py::arg("file_name"),
+		py::call_guard<py::gil_scoped_release>(),
+		"Open a capture file, that was saved by the signal save dialog or a `CaptureWriter`, in a new "
+		"user device. A user channel is created for every recorded channel. The samples of "
+		"uncompressed files are not loaded into memory, but read from the file on demand.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"file_name : str\n"
+		"    The path of the capture file.\n\n"
+		"Returns\n"
+		"-------\n"
+		"UserDevice\n"
+		"    The user device object or `None` if the file couldn't be opened.");
+	py_session.def("record_capture_file", &sv::Session::record_capture_file,
+		py::arg("file_name"), py::arg("signals"), py::arg("write_interval") = 1.,
+		py::arg("compressed") = false,
+		"Record signals to a capture file in a background thread, while they are acquiring. The new "
+		"samples are appended every write interval, so a crash loses at most the samples of one "
+		"interval. The recording is stopped with the session.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"file_name : str\n"
+		"    The path of the capture file.\n"
+		"signals : List[AnalogTimeSignal]\n"
+		"    The signals to record.\n"
+		"write_interval : float\n"
+		"    The write interval in seconds.\n"
+		"compressed : bool\n"
+		"    `True` to compress the samples.\n\n"
+		"Returns\n"
+		"-------\n"
+		"CaptureRecorder\n"
+		"    The recorder object or `None` if the file couldn't be created.");
+	py_session.def("stream_signals", &sv::Session::stream_signals,
+		py::arg("host"), py::arg("port"), py::arg("signals"),
+		py::arg("protocol") = sv::data::StreamProtocol::Tcp,
+		py::arg("format") = sv::data::StreamFormat::Binary,
+		py::arg("send_interval") = .1,
+		"Stream the new samples of signals to a network endpoint in a background thread, while they "
+		"are acquiring. The samples are sent in batches every send interval. A lost TCP connection is "
+		"reconnected. The streaming is stopped with the session.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"host : str\n"
+		"    The host name or address of the endpoint.\n"
+		"port : int\n"
+		"    The port of the endpoint.\n"
+		"signals : List[AnalogTimeSignal]\n"
+		"    The signals to stream.\n"
+		"protocol : StreamProtocol\n"
+		"    The transport.\n"
+		"format : StreamFormat\n"
+		"    The format of the samples.\n"
+		"send_interval : float\n"
+		"    The send interval in seconds.\n\n"
+		"Returns\n"
+		"-------\n"
+		"SignalStreamer\n"
+		"    The streamer object or `None` if there is no host or no signal.");
+	py_session.def("export_metrics", &sv::Session::export_metrics,
+		py::arg("port"),
+		py::arg("signals") = std::vector<std::shared_ptr<sv::data::AnalogTimeSignal>>(),
+		py::arg("host") = "127.0.0.1",
+		py::call_guard<py::gil_scoped_release>(),
+		"Export the performance counters of the session (ingest rates, overruns, queue depths, "
+		"latencies, memory) and the latest values, min/max and running statistics of signals over "
+		"HTTP at `/metrics` in the Prometheus text format. A scrape never blocks the acquisition. The "
+		"exporter is stopped with the session.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"port : int\n"
+		"    The TCP port, `0` chooses a free port.\n"
+		"signals : List[AnalogTimeSignal]\n"
+		"    The signals, whose values are exported.\n"
+		"host : str\n"
+		"    The address to listen on. By default only local scrapers can connect, `\"*\"` exports "
+		"to all interfaces.\n\n"
+		"Returns\n"
+		"-------\n"
+		"MetricsExporter\n"
+		"    The exporter object or `None` if the port couldn't be opened.");
+	py_session.def("serve_remote", &sv::Session::serve_remote,
+		py::arg("port"), py::arg("send_interval") = .1,
+		py::arg("host") = "127.0.0.1",
+		py::call_guard<py::gil_scoped_release>(),
+		"Serve all signals of the session and the properties of its hardware devices to remote "
+		"SmuView clients (see `Session.connect_remote()`), e.g. to run the instruments on a headless "
+		"machine on the bench. The new samples are sent in batches every send interval, the history "
+		"is only sent in the resolution, that a client requests. The server is stopped with the "
+		"session.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"port : int\n"
+		"    The TCP port, `0` chooses a free port.\n"
+		"send_interval : float\n"
+		"    The send interval in seconds.\n"
+		"host : str\n"
+		"    The address to listen on. By default only clients on the same machine can connect, "
+		"`\"*\"` serves to all interfaces.\n\n"
+		"Returns\n"
+		"-------\n"
+		"RemoteServer\n"
+		"    The server object or `None` if the port couldn't be opened.");
+	py_session.def("connect_remote", &sv::Session::connect_remote,
+		py::arg("host"), py::arg("port"),
+		py::call_guard<py::gil_scoped_release>(),
+		"Mirror the signals of a remote SmuView server in a new user device. The signals get the "
+		"samples from the time of the connection on. A lost connection is reconnected. The client "
+		"is stopped with the session.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"host : str\n"
+		"    The host name or address of the server.\n"
+		"port : int\n"
+		"    The port of the server.\n\n"
+		"Returns\n"
+		"-------\n"
+		"RemoteClient\n"
+		"    The client object or `None` if there is no host.");
+	py_session.def("start_synchronized", &sv::Session::start_synchronized,
+		py::arg("devices") = std::vector<std::shared_ptr<sv::devices::BaseDevice>>(),
+		py::arg("delay") = .5,
+		"Start the aquisition of devices at the same time. The devices are armed and their samples "
+		"are discarded until the common start timestamp, so the signals of all devices begin "
+		"together on the same timebase.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"devices : List[BaseDevice]\n"
+		"    The devices to start, all devices if empty.\n"
+		"delay : float\n"
+		"    The time in seconds until the start.\n\n"
+		"Returns\n"
+		"-------\n"
+		"float\n"
+		"    The start timestamp.");
+	py_session.def("calibrate_time_offset", &sv::Session::calibrate_time_offset,
+		py::arg("reference"), py::arg("signal"), py::arg("duration") = 10.,
+		py::arg("max_lag") = 1., py::arg("resolution") = .001,
+		py::call_guard<py::gil_scoped_release>(),
+		"Estimate the latency of the device of a signal against the device of a reference signal "
+		"by cross-correlating the last samples of both signals, e.g. while both devices measure the "
+		"same voltage steps. The offset is added to the timestamp offset of the device (see "
+		"`BaseDevice.set_timestamp_offset()`), so its following samples line up with the reference.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"reference : AnalogTimeSignal\n"
+		"    The reference signal.\n"
+		"signal : AnalogTimeSignal\n"
+		"    The signal, whose device is calibrated.\n"
+		"duration : float\n"
+		"    The duration in seconds of the compared samples.\n"
+		"max_lag : float\n"
+		"    The maximum offset in seconds.\n"
+		"resolution : float\n"
+		"    The resolution of the estimation in seconds.\n\n"
+		"Returns\n"
+		"-------\n"
+		"float\n"
+		"    The estimated offset in seconds or `NaN` if the signals don't correlate.");
+	py_session.def("add_skew_estimator", &sv::Session::add_skew_estimator,
+		py::arg("reference"), py::arg("signal"), py::arg("block_size") = 4096,
+		py::arg("resolution") = .001, py::arg("max_lag") = .5, py::arg("interval") = 1.,
+		"Continuously estimate the time skew of a signal against a reference signal, e.g. of two devices, that "
+		"measure the same quantity. For every `interval` seconds of new samples, the last `block_size` grid points "
+		"of both signals are cross-correlated in a worker thread. An accepted estimate is set as time skew of the "
+		"signal (see `AnalogTimeSignal.set_time_skew()`), so both signals line up, when they are combined.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"reference : AnalogTimeSignal\n"
+		"    The reference signal.\n"
+		"signal : AnalogTimeSignal\n"
+		"    The signal, whose skew is estimated.\n"
+		"block_size : int\n"
+		"    The number of grid points of a block, must be a power of two.\n"
+		"resolution : float\n"
+		"    The distance of the grid points in seconds.\n"
+		"max_lag : float\n"
+		"    The maximum skew in seconds, limited to half the block.\n"
+		"interval : float\n"
+		"    The seconds of new samples between two estimates.\n\n"
+		"Returns\n"
+		"-------\n"
+		"SkewEstimator\n"
+		"    The estimator or `None` if the parameters are invalid.");
+	py_session.def("add_trigger_engine", &sv::Session::add_trigger_engine,
+		py::arg("signal"),
+		"Add a trigger engine for a signal. The engine checks all samples, that are appended from now on, "
+		"against its triggers and records the events.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"signal : AnalogTimeSignal\n"
+		"    The signal to check.\n\n"
+		"Returns\n"
+		"-------\n"
+		"TriggerEngine\n"
+		"    The trigger engine object.");
+	py_session.def("add_limit_engine", &sv::Session::add_limit_engine,
+		py::arg("signal"),
+		"Add a limit engine for a signal, e.g. for a production test. The engine checks the samples of "
+		"its test steps against its rules and aggregates the pass/fail results per step. The results are "
+		"also shown in the limit test results view.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"signal : AnalogTimeSignal\n"
+		"    The signal to check.\n\n"
+		"Returns\n"
+		"-------\n"
+		"LimitEngine\n"
+		"    The limit engine object.");
+	py_session.def("memory_size", &sv::Session::memory_size,
+		"Return the number of bytes, that are used by the signals of all devices in memory.\n\n"
+		"Returns\n"
+		"-------\n"
+		"int\n"
+		"    The size in bytes.");
+	py_session.def("set_memory_budget", &sv::Session::set_memory_budget,
+		py::arg("memory_budget"),
+		"Limit the memory, that is used by the signals of all devices. When the budget is exceeded, "
+		"the oldest samples of the signals with the lowest priority are evicted.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"memory_budget : int\n"
+		"    The budget in bytes. `0` means unlimited.");
+	py_session.def("set_memory_budget_spill", &sv::Session::set_memory_budget_spill,
+		py::arg("memory_budget_spill"),
+		"Spill signals to disk before evicting samples, when the memory budget is exceeded.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"memory_budget_spill : bool\n"
+		"    `True` to spill signals to disk first.");
+	py_session.def("set_auto_retention", &sv::Session::set_auto_retention,
+		py::arg("auto_retention"),
+		"Drop the samples of the signals, that no observer needs any more. When all observers of a "
+		"signal only need a limited history (e.g. plots in rolling mode, value panels, moving "
+		"averages or a capture recorder), the older samples are dropped every second.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"auto_retention : bool\n"
+		"    `True` to enable the automatic retention.");
 
 }
 
@@ -182,6 +614,41 @@ void init_Device(py::module &m)
 		"-------\n"
 		"Dict[str, Configurable]\n"
 		"    A Dict where the key is the id of the `Configurable` and the value is the `Configurable` object.");
+	py_base_device.def("set_acquisition_thread_policy",
+		[](sv::devices::BaseDevice &device, sv::devices::ThreadPriority priority,
+				int realtime_priority, int cpu) {
+			device.set_acquisition_thread_policy(sv::devices::ThreadPolicy(
+				priority, realtime_priority, cpu));
+		},
+		py::arg("priority"),
+		py::arg("realtime_priority") = sv::devices::ThreadPolicy::default_realtime_priority,
+		py::arg("cpu") = -1,
+		"Set the scheduling of the acquisition thread of the device. A running thread "
+		"applies it with its next packet. Raised priorities usually need privileges "
+		"(e.g. `CAP_SYS_NICE` or an rtprio limit on Linux), otherwise a warning is logged.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"priority : ThreadPriority\n"
+		"    The priority of the thread.\n"
+		"realtime_priority : int\n"
+		"    The `SCHED_FIFO` priority (1 to 99) for `ThreadPriority.RealTime`. Ignored on Windows.\n"
+		"cpu : int\n"
+		"    The CPU to pin the thread to, `-1` for all CPUs.");
+	py_base_device.def("set_timestamp_offset", &sv::devices::BaseDevice::set_timestamp_offset,
+		py::arg("offset"),
+		"Set the latency of the device. The offset is subtracted from the timestamps of the new "
+		"samples, so they line up with the samples of other devices. See "
+		"`Session.calibrate_time_offset()`.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"offset : float\n"
+		"    The offset in seconds.");
+	py_base_device.def("timestamp_offset", &sv::devices::BaseDevice::timestamp_offset,
+		"Return the latency of the device, that is subtracted from the timestamps.\n\n"
+		"Returns\n"
+		"-------\n"
+		"float\n"
+		"    The offset in seconds.");
 	py_base_device.def("add_user_channel", &sv::devices::BaseDevice::add_user_channel,
 		py::arg("channel_name"), py::arg("channel_group_name"),
 		"Add a new user channel to the device.\n\n"
@@ -195,12 +662,544 @@ void init_Device(py::module &m)
 		"-------\n"
 		"UserChannel\n"
 		"    The new user channel object.");
+	py_base_device.def("add_calibration_channel", &sv::devices::BaseDevice::add_calibration_channel,
+		py::arg("signal"), py::arg("curve"), py::arg("quantity"), py::arg("quantity_flags"),
+		py::arg("unit"), py::arg("channel_name"), py::arg("channel_group_name"),
+		"Add a new math channel, that linearises a signal with a calibration curve, e.g. the temperature of a "
+		"thermocouple from its voltage. The samples are calibrated natively in blocks.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"signal : AnalogTimeSignal\n"
+		"    The source signal.\n"
+		"curve : CalibrationCurve\n"
+		"    The calibration curve.\n"
+		"quantity : Quantity\n"
+		"    The quantity of the new signal.\n"
+		"quantity_flags : Set[QuantityFlag]\n"
+		"    The quantity flags of the new signal.\n"
+		"unit : Unit\n"
+		"    The unit of the new signal.\n"
+		"channel_name : str\n"
+		"    The name of the new math channel.\n"
+		"channel_group_name : str\n"
+		"    The name of the channel group where to create the math channel. Can be empty.\n\n"
+		"Returns\n"
+		"-------\n"
+		"CalibrationChannel\n"
+		"    The new math channel object or `None` if there is no curve.");
+	py_base_device.def("add_expression_channel", &sv::devices::BaseDevice::add_expression_channel,
+		py::arg("signals"), py::arg("expression"), py::arg("quantity"), py::arg("quantity_flags"),
+		py::arg("unit"), py::arg("channel_name"), py::arg("channel_group_name"),
+		"Add a new math channel, that calculates a formula over signals, e.g. `(v1 - v2) / 0.1 * 1000`. "
+		"The signals are named `v1` to `vN`. Supported are numbers, `pi`, `e`, the operators "
+		"`+ - * / ^`, parentheses and the functions `abs`, `sqrt`, `exp`, `log`, `log10`, `sin`, "
+		"`cos`, `tan`, `min` and `max`. The formula is evaluated natively over blocks of samples.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"signals : List[AnalogTimeSignal]\n"
+		"    The signals `v1` to `vN`.\n"
+		"expression : str\n"
+		"    The formula.\n"
+		"quantity : Quantity\n"
+		"    The quantity of the new signal.\n"
+		"quantity_flags : Set[QuantityFlag]\n"
+		"    The quantity flags of the new signal.\n"
+		"unit : Unit\n"
+		"    The unit of the new signal.\n"
+		"channel_name : str\n"
+		"    The name of the new math channel.\n"
+		"channel_group_name : str\n"
+		"    The name of the channel group where to create the math channel. Can be empty.\n\n"
+		"Returns\n"
+		"-------\n"
+		"MathChannel\n"
+		"    The new math channel object or `None` if the expression is invalid.");
+	py_base_device.def("add_plugin_channel", &sv::devices::BaseDevice::add_plugin_channel,
+		py::arg("signals"), py::arg("processor"), py::arg("args"), py::arg("quantity"),
+		py::arg("quantity_flags"), py::arg("unit"), py::arg("channel_name"), py::arg("channel_group_name"),
+		py::call_guard<py::gil_scoped_release>(),
+		"Add a new math channel, that is calculated by the math processor of a native plugin. The "
+		"signals are aligned like in `add_expression_channel()` and the processor is called natively "
+		"with blocks of samples.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"signals : List[AnalogTimeSignal]\n"
+		"    The input signals of the processor.\n"
+		"processor : str\n"
+		"    The id of the math processor, see `Session.plugin_math_processors()`.\n"
+		"args : str\n"
+		"    The arguments, that are passed to the processor.\n"
+		"quantity : Quantity\n"
+		"    The quantity of the new signal.\n"
+		"quantity_flags : Set[QuantityFlag]\n"
+		"    The quantity flags of the new signal.\n"
+		"unit : Unit\n"
+		"    The unit of the new signal.\n"
+		"channel_name : str\n"
+		"    The name of the new math channel.\n"
+		"channel_group_name : str\n"
+		"    The name of the channel group where to create the math channel. Can be empty.\n\n"
+		"Returns\n"
+		"-------\n"
+		"MathChannel\n"
+		"    The new math channel object or `None` if the processor doesn't exist or doesn't "
+		"accept the signals or arguments.");
+	py_base_device.def("add_math_channel", &sv::python::device_add_math_channel,
+		py::arg("signals"), py::arg("function"), py::arg("quantity"), py::arg("quantity_flags"),
+		py::arg("unit"), py::arg("channel_name"), py::arg("channel_group_name"),
+		"Add a new math channel, that is calculated by a Python function over signals. The signals "
+		"are aligned like in `add_expression_channel()` and the function is called with blocks of "
+		"samples as `function(timestamps, v1, ..., vN)`, where all arguments are NumPy arrays of the "
+		"same length. It must return an array with one value per timestamp. The function is called "
+		"from a worker thread. If it raises an exception or returns an array of the wrong size, the "
+		"channel stops calculating.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"signals : List[AnalogTimeSignal]\n"
+		"    The signals `v1` to `vN`.\n"
+		"function : Callable[..., numpy.ndarray]\n"
+		"    The function, that calculates a block of results.\n"
+		"quantity : Quantity\n"
+		"    The quantity of the new signal.\n"
+		"quantity_flags : Set[QuantityFlag]\n"
+		"    The quantity flags of the new signal.\n"
+		"unit : Unit\n"
+		"    The unit of the new signal.\n"
+		"channel_name : str\n"
+		"    The name of the new math channel.\n"
+		"channel_group_name : str\n"
+		"    The name of the channel group where to create the math channel. Can be empty.\n\n"
+		"Returns\n"
+		"-------\n"
+		"MathChannel\n"
+		"    The new math channel object or `None` if there are no signals.");
+	py_base_device.def("add_ema_channel", &sv::devices::BaseDevice::add_ema_channel,
+		py::arg("signal"), py::arg("time_constant"), py::arg("channel_name"), py::arg("channel_group_name"),
+		"Add a new math channel with the exponential moving average of a signal. The weight of a sample depends on the time since the previous sample, so irregular samples are weighted correctly.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"signal : AnalogTimeSignal\n"
+		"    The source signal.\n"
+		"time_constant : float\n"
+		"    The time constant in seconds.\n"
+		"channel_name : str\n"
+		"    The name of the new math channel.\n"
+		"channel_group_name : str\n"
+		"    The name of the channel group where to create the math channel. Can be empty.\n\n"
+		"Returns\n"
+		"-------\n"
+		"MathChannel\n"
+		"    The new math channel object.");
+	py_base_device.def("add_moving_median_channel", &sv::devices::BaseDevice::add_moving_median_channel,
+		py::arg("signal"), py::arg("window_sample_count"), py::arg("channel_name"), py::arg("channel_group_name"),
+		"Add a new math channel with the median of the last samples of a signal. NaN samples are skipped.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"signal : AnalogTimeSignal\n"
+		"    The source signal.\n"
+		"window_sample_count : int\n"
+		"    The number of samples in the window.\n"
+		"channel_name : str\n"
+		"    The name of the new math channel.\n"
+		"channel_group_name : str\n"
+		"    The name of the channel group where to create the math channel. Can be empty.\n\n"
+		"Returns\n"
+		"-------\n"
+		"MathChannel\n"
+		"    The new math channel object.");
+	py_base_device.def("add_min_max_hold_channel", &sv::devices::BaseDevice::add_min_max_hold_channel,
+		py::arg("signal"), py::arg("type"), py::arg("window_sample_count"), py::arg("channel_name"), py::arg("channel_group_name"),
+		"Add a new math channel with the minimum or maximum of the last samples of a signal. NaN samples are skipped.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"signal : AnalogTimeSignal\n"
+		"    The source signal.\n"
+		"type : MinMaxHoldType\n"
+		"    Hold the minimum or the maximum.\n"
+		"window_sample_count : int\n"
+		"    The number of samples in the window. `0` holds the extreme value of all samples.\n"
+		"channel_name : str\n"
+		"    The name of the new math channel.\n"
+		"channel_group_name : str\n"
+		"    The name of the channel group where to create the math channel. Can be empty.\n\n"
+		"Returns\n"
+		"-------\n"
+		"MathChannel\n"
+		"    The new math channel object.");
+	py_base_device.def("add_rms_channel", &sv::devices::BaseDevice::add_rms_channel,
+		py::arg("signal"), py::arg("window_sample_count"), py::arg("channel_name"), py::arg("channel_group_name"),
+		"Add a new math channel with the root mean square of the last samples of a signal.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"signal : AnalogTimeSignal\n"
+		"    The source signal.\n"
+		"window_sample_count : int\n"
+		"    The number of samples in the window.\n"
+		"channel_name : str\n"
+		"    The name of the new math channel.\n"
+		"channel_group_name : str\n"
+		"    The name of the channel group where to create the math channel. Can be empty.\n\n"
+		"Returns\n"
+		"-------\n"
+		"MathChannel\n"
+		"    The new math channel object.");
+
+	py_base_device.def("add_ac_power_channel", &sv::devices::BaseDevice::add_ac_power_channel,
+		py::arg("voltage_signal"), py::arg("current_signal"), py::arg("value"), py::arg("cycle_count"),
+		py::arg("channel_name"), py::arg("channel_group_name"),
+		"Add a new math channel with a result of the AC power analysis of a sampled voltage and current waveform. "
+		"The periods are detected by the rising zero crossings of the voltage and one result is calculated for every "
+		"window of `cycle_count` cycles, so the new signal has a low rate.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"voltage_signal : AnalogTimeSignal\n"
+		"    The voltage signal.\n"
+		"current_signal : AnalogTimeSignal\n"
+		"    The current signal.\n"
+		"value : AcPowerValue\n"
+		"    The result of the analysis. The quantity and the unit of the new signal are set by it.\n"
+		"cycle_count : int\n"
+		"    The number of cycles of a window, `1` gives one result per cycle.\n"
+		"channel_name : str\n"
+		"    The name of the new math channel.\n"
+		"channel_group_name : str\n"
+		"    The name of the channel group where to create the math channel. Can be empty.\n\n"
+		"Returns\n"
+		"-------\n"
+		"MathChannel\n"
+		"    The new math channel object or `None` if a signal is missing.");
+
+	py_base_device.def("add_resample_channel", &sv::devices::BaseDevice::add_resample_channel,
+		py::arg("signal"), py::arg("rate"), py::arg("method"), py::arg("channel_name"), py::arg("channel_group_name"),
+		"Add a new math channel with a signal resampled onto a uniform grid. The grid points are the multiples "
+		"of 1/rate seconds, so signals resampled with the same rate have the same timestamps. NaN samples are skipped.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"signal : AnalogTimeSignal\n"
+		"    The source signal.\n"
+		"rate : float\n"
+		"    The rate of the grid in Hz.\n"
+		"method : ResampleMethod\n"
+		"    The interpolation between the samples.\n"
+		"channel_name : str\n"
+		"    The name of the new math channel.\n"
+		"channel_group_name : str\n"
+		"    The name of the channel group where to create the math channel. Can be empty.\n\n"
+		"Returns\n"
+		"-------\n"
+		"MathChannel\n"
+		"    The new math channel object or `None` if the rate is invalid.");
 
 	py::class_<sv::devices::HardwareDevice, std::shared_ptr<sv::devices::HardwareDevice>> py_hardware_device(m, "HardwareDevice", py_base_device);
 	py_hardware_device.doc() = "An actual hardware device.";
+	py_hardware_device.def("acquisition_summary", &sv::devices::HardwareDevice::acquisition_summary,
+		"Return the acquisition statistics of the device, to detect overruns and lost data.\n\n"
+		"Returns\n"
+		"-------\n"
+		"AcquisitionSummary\n"
+		"    The acquisition statistics.");
+	py_hardware_device.def("set_max_config_write_rate", &sv::devices::HardwareDevice::set_max_config_write_rate,
+		py::arg("max_rate"),
+		"Limit the config writes of the controls (knobs, sliders, ...) of the device. Changes, that "
+		"come in faster, are coalesced and only the latest value is written. The synchronous "
+		"`Configurable.set_config()` is not limited.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"max_rate : float\n"
+		"    The maximum number of writes per second. `0` disables the limit.");
+	py_hardware_device.def("max_config_write_rate", &sv::devices::HardwareDevice::max_config_write_rate,
+		"Return the maximum number of config writes of the controls per second.\n\n"
+		"Returns\n"
+		"-------\n"
+		"float\n"
+		"    The maximum rate, `0` if the writes are not limited.");
+
+	py::class_<sv::devices::AcquisitionSummary> py_acquisition_summary(m, "AcquisitionSummary");
+	py_acquisition_summary.doc() = "The acquisition statistics of a hardware device.";
+	py_acquisition_summary.def_readonly("packets_per_second", &sv::devices::AcquisitionSummary::packets_per_second,
+		"The number of received packets per second.");
+	py_acquisition_summary.def_readonly("samples_per_second", &sv::devices::AcquisitionSummary::samples_per_second,
+		"The number of received samples (of all channels) per second.");
+	py_acquisition_summary.def_readonly("packet_count", &sv::devices::AcquisitionSummary::packet_count,
+		"The number of received packets.");
+	py_acquisition_summary.def_readonly("sample_count", &sv::devices::AcquisitionSummary::sample_count,
+		"The number of received samples of all channels.");
+	py_acquisition_summary.def_readonly("dropped_packet_count", &sv::devices::AcquisitionSummary::dropped_packet_count,
+		"The number of packets, that were dropped, because they couldn't be stored fast enough.");
+	py_acquisition_summary.def_readonly("dropped_sample_count", &sv::devices::AcquisitionSummary::dropped_sample_count,
+		"The number of samples of all channels, that were dropped.");
+	py_acquisition_summary.def_readonly("out_of_order_packet_count", &sv::devices::AcquisitionSummary::out_of_order_packet_count,
+		"The number of packets with a timestamp before the previous packet.");
+	py_acquisition_summary.def_readonly("feed_time", &sv::devices::AcquisitionSummary::feed_time,
+		"The total time in seconds, that was spent in the datafeed callback.");
+	py_acquisition_summary.def_readonly("max_feed_time", &sv::devices::AcquisitionSummary::max_feed_time,
+		"The maximum time in seconds, that was spent in the datafeed callback for one packet.");
+	py_acquisition_summary.def_readonly("queue_depth", &sv::devices::AcquisitionSummary::queue_depth,
+		"The number of packets, that are waiting to be stored.");
+	py_acquisition_summary.def_readonly("queue_high_water", &sv::devices::AcquisitionSummary::queue_high_water,
+		"The maximum number of packets, that were waiting to be stored at the same time.");
+	py_acquisition_summary.def_readonly("latency_histogram", &sv::devices::AcquisitionSummary::latency_histogram,
+		"The number of packets per latency from receiving the packet until the samples are stored. "
+		"Bucket 0 counts latencies below 1 us, every following bucket doubles the limit, the last bucket "
+		"counts all longer latencies.");
 
 	py::class_<sv::devices::UserDevice, std::shared_ptr<sv::devices::UserDevice>> py_user_device(m, "UserDevice", py_base_device);
 	py_user_device.doc() = "An user generated (virtual) device for storing custom data and showing a custom tab.";
+
+	py::class_<sv::devices::ReplayEngine, std::shared_ptr<sv::devices::ReplayEngine>> py_replay_engine(m, "ReplayEngine");
+	py_replay_engine.doc() = "Replays a recorded CSV file through the user channels of a user device.";
+	py_replay_engine.def("start", &sv::devices::ReplayEngine::start,
+		py::arg("speed"), py::arg("loop") = false,
+		"(Re)start the replay from the first sample.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"speed : float\n"
+		"    The replay speed, `1` is real time. `0` replays as fast as possible.\n"
+		"loop : bool\n"
+		"    `True` to restart the replay, when all samples were replayed.");
+	py_replay_engine.def("stop", &sv::devices::ReplayEngine::stop,
+		py::call_guard<py::gil_scoped_release>(),
+		"Stop the replay.");
+	py_replay_engine.def("is_running", &sv::devices::ReplayEngine::is_running,
+		"Return `True` while samples are replayed.");
+	py_replay_engine.def("sample_count", &sv::devices::ReplayEngine::sample_count,
+		"Return the number of loaded samples of all signals.");
+	py_replay_engine.def("replayed_count", &sv::devices::ReplayEngine::replayed_count,
+		"Return the number of replayed samples.");
+	py_replay_engine.def("duration", &sv::devices::ReplayEngine::duration,
+		"Return the recorded duration in seconds.");
+
+	py::class_<sv::devices::ScanListEngine, std::shared_ptr<sv::devices::ScanListEngine>> py_scan_list_engine(m, "ScanListEngine");
+	py_scan_list_engine.doc() = "Scans the channels of a multiplexer: Selects a channel, waits for the settle time, "
+		"averages N samples of the measurement signal and advances to the next channel.";
+	py_scan_list_engine.def("add_channel", &sv::devices::ScanListEngine::add_channel,
+		py::arg("configurable"), py::arg("name"),
+		py::call_guard<py::gil_scoped_release>(),
+		"Append a multiplexer channel to the scan list. The channel is selected with the "
+		"`ConfigKey.Enabled` config key of the configurable.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"configurable : Configurable\n"
+		"    The configurable (channel group) of the multiplexer channel.\n"
+		"name : str\n"
+		"    The name of the user channel for the measured values.\n\n"
+		"Returns\n"
+		"-------\n"
+		"UserChannel\n"
+		"    The user channel or `None` if the configurable can't be enabled or the scan is running.");
+	py_scan_list_engine.def("start", &sv::devices::ScanListEngine::start,
+		py::arg("settle_time"), py::arg("samples"), py::arg("cycles") = 0,
+		py::arg("timeout") = 10.,
+		"(Re)start the scan with the first channel.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"settle_time : float\n"
+		"    The time in seconds, after a channel was selected, before the samples are taken.\n"
+		"samples : int\n"
+		"    The number of samples, that are averaged per channel.\n"
+		"cycles : int\n"
+		"    The number of scans of the list, `0` scans until `stop()` is called.\n"
+		"timeout : float\n"
+		"    The max. time in seconds to wait for the samples of a channel.\n\n"
+		"Returns\n"
+		"-------\n"
+		"bool\n"
+		"    `False` if the scan list is empty.");
+	py_scan_list_engine.def("stop", &sv::devices::ScanListEngine::stop,
+		py::call_guard<py::gil_scoped_release>(),
+		"Stop the scan.");
+	py_scan_list_engine.def("is_running", &sv::devices::ScanListEngine::is_running,
+		"Return `True` while the scan is running.");
+	py_scan_list_engine.def("channel_count", &sv::devices::ScanListEngine::channel_count,
+		"Return the number of channels in the scan list.");
+	py_scan_list_engine.def("cycle_count", &sv::devices::ScanListEngine::cycle_count,
+		"Return the number of completed scans of the list.");
+	py_scan_list_engine.def("timeout_count", &sv::devices::ScanListEngine::timeout_count,
+		"Return the number of channels, that timed out.");
+
+	py::class_<sv::devices::SweepEngine, std::shared_ptr<sv::devices::SweepEngine>> py_sweep_engine(m, "SweepEngine");
+	py_sweep_engine.doc() = "Sweeps a setpoint and measures signals at every point: The setpoint is written, "
+		"the engine waits for the settle time and averages N samples of every signal. All results of a "
+		"point have the same timestamp, so they can be shown in a XY plot.";
+	py_sweep_engine.def_static("linear_points", &sv::devices::SweepEngine::linear_points,
+		py::arg("start"), py::arg("stop"), py::arg("count"),
+		"Return linear spaced setpoints.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"start : float\n"
+		"    The first setpoint.\n"
+		"stop : float\n"
+		"    The last setpoint.\n"
+		"count : int\n"
+		"    The number of setpoints.\n\n"
+		"Returns\n"
+		"-------\n"
+		"List[float]\n"
+		"    The setpoints.");
+	py_sweep_engine.def_static("log_points", &sv::devices::SweepEngine::log_points,
+		py::arg("start"), py::arg("stop"), py::arg("count"),
+		"Return logarithmic spaced setpoints. `start` and `stop` must have the same sign.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"start : float\n"
+		"    The first setpoint.\n"
+		"stop : float\n"
+		"    The last setpoint.\n"
+		"count : int\n"
+		"    The number of setpoints.\n\n"
+		"Returns\n"
+		"-------\n"
+		"List[float]\n"
+		"    The setpoints or an empty list for an invalid range.");
+	py_sweep_engine.def("setpoint_channel", &sv::devices::SweepEngine::setpoint_channel,
+		"Return the user channel with the setpoints of the measured points.\n\n"
+		"Returns\n"
+		"-------\n"
+		"UserChannel\n"
+		"    The setpoint channel.");
+	py_sweep_engine.def("add_signal", &sv::devices::SweepEngine::add_signal,
+		py::arg("signal"), py::arg("name"),
+		py::call_guard<py::gil_scoped_release>(),
+		"Add a signal, that is measured at every point.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"signal : AnalogTimeSignal\n"
+		"    The signal to measure.\n"
+		"name : str\n"
+		"    The name of the user channel for the measured values.\n\n"
+		"Returns\n"
+		"-------\n"
+		"UserChannel\n"
+		"    The user channel or `None` if the sweep is running or the name already exists.");
+	py_sweep_engine.def("start", &sv::devices::SweepEngine::start,
+		py::arg("points"), py::arg("settle_time"), py::arg("samples"),
+		py::arg("timeout") = 10.,
+		"(Re)start the sweep with the first setpoint.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"points : List[float]\n"
+		"    The setpoints, e.g. from `linear_points()`.\n"
+		"settle_time : float\n"
+		"    The time in seconds, after the setpoint was written, before the samples are taken.\n"
+		"samples : int\n"
+		"    The number of samples, that are averaged per point.\n"
+		"timeout : float\n"
+		"    The max. time in seconds to wait for a write or for the samples of a point.\n\n"
+		"Returns\n"
+		"-------\n"
+		"bool\n"
+		"    `False` if there are no points or no signals.");
+	py_sweep_engine.def("stop", &sv::devices::SweepEngine::stop,
+		py::call_guard<py::gil_scoped_release>(),
+		"Stop the sweep.");
+	py_sweep_engine.def("is_running", &sv::devices::SweepEngine::is_running,
+		"Return `True` while the sweep is running.");
+	py_sweep_engine.def("measured_count", &sv::devices::SweepEngine::measured_count,
+		"Return the number of measured points since the start.");
+	py_sweep_engine.def("timeout_count", &sv::devices::SweepEngine::timeout_count,
+		"Return the number of points, that timed out.");
+
+	py::class_<sv::devices::ControlEngine, std::shared_ptr<sv::devices::ControlEngine>> py_control_engine(m, "ControlEngine");
+	py_control_engine.doc() = "A closed control loop from an input signal to a setpoint of a device. The law is "
+		"evaluated for every new sample (or max. `max_rate` times per second) and the output is posted to "
+		"the device. A write, that isn't done, when the next output is posted, is superseded.";
+	py_control_engine.def("signal", &sv::devices::ControlEngine::signal,
+		"Return the input signal.");
+	py_control_engine.def("set_pid", &sv::devices::ControlEngine::set_pid,
+		py::arg("kp"), py::arg("ki"), py::arg("kd"),
+		"Use a PID law. The error is `setpoint - input`, the derivative is taken from the input.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"kp : float\n"
+		"    The proportional gain.\n"
+		"ki : float\n"
+		"    The integral gain in 1/s.\n"
+		"kd : float\n"
+		"    The derivative gain in s.");
+	py_control_engine.def("set_expression", &sv::devices::ControlEngine::set_expression,
+		py::arg("formula"),
+		"Use a formula over `v1` (input), `v2` (setpoint) and `v3` (last output), e.g. `v2 / v1` "
+		"for a constant power load or `v1 / v2` for a constant resistance load.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"formula : str\n"
+		"    The formula.\n\n"
+		"Returns\n"
+		"-------\n"
+		"bool\n"
+		"    `False` if the formula is invalid.");
+	py_control_engine.def("law", &sv::devices::ControlEngine::law,
+		"Return the control law.");
+	py_control_engine.def("set_setpoint", &sv::devices::ControlEngine::set_setpoint,
+		py::arg("setpoint"),
+		"Set the setpoint. It can be changed while the loop is running.");
+	py_control_engine.def("setpoint", &sv::devices::ControlEngine::setpoint,
+		"Return the setpoint.");
+	py_control_engine.def("set_output_limits", &sv::devices::ControlEngine::set_output_limits,
+		py::arg("min"), py::arg("max"),
+		"Clamp the output to `[min, max]`. The default are the limits of the output config key.");
+	py_control_engine.def("set_max_rate", &sv::devices::ControlEngine::set_max_rate,
+		py::arg("max_rate"),
+		"Evaluate the law max. `max_rate` times per second. `0` evaluates it for every sample.");
+	py_control_engine.def("max_rate", &sv::devices::ControlEngine::max_rate,
+		"Return the max. number of iterations per second.");
+	py_control_engine.def("start", &sv::devices::ControlEngine::start,
+		py::call_guard<py::gil_scoped_release>(),
+		"(Re)start the loop. The loop takes over the current output without a bump.\n\n"
+		"Returns\n"
+		"-------\n"
+		"bool\n"
+		"    `False` if no control law is set.");
+	py_control_engine.def("stop", &sv::devices::ControlEngine::stop,
+		py::call_guard<py::gil_scoped_release>(),
+		"Stop the loop and log its timing statistics.");
+	py_control_engine.def("is_running", &sv::devices::ControlEngine::is_running,
+		"Return `True` while the loop is running.");
+	py_control_engine.def("summary", &sv::devices::ControlEngine::summary,
+		"Return the timing statistics of the loop since the start.\n\n"
+		"Returns\n"
+		"-------\n"
+		"ControlSummary\n"
+		"    The loop statistics.");
+
+	py::class_<sv::devices::ControlSummary> py_control_summary(m, "ControlSummary");
+	py_control_summary.doc() = "The timing statistics of a control loop.";
+	py_control_summary.def_readonly("iteration_count", &sv::devices::ControlSummary::iteration_count,
+		"The number of times, the control law was evaluated.");
+	py_control_summary.def_readonly("write_count", &sv::devices::ControlSummary::write_count,
+		"The number of outputs, that were written by the device.");
+	py_control_summary.def_readonly("failed_write_count", &sv::devices::ControlSummary::failed_write_count,
+		"The number of failed writes.");
+	py_control_summary.def_readonly("held_count", &sv::devices::ControlSummary::held_count,
+		"The number of outputs, that were not written, because they differ by less than half a step from the "
+		"last output or are not finite.");
+	py_control_summary.def_readonly("mean_latency", &sv::devices::ControlSummary::mean_latency,
+		"The mean time in seconds from a new sample until the output was written by the device.");
+	py_control_summary.def_readonly("max_latency", &sv::devices::ControlSummary::max_latency,
+		"The maximum time in seconds from a new sample until the output was written by the device.");
+	py_control_summary.def_readonly("mean_interval", &sv::devices::ControlSummary::mean_interval,
+		"The mean time in seconds between two iterations.");
+	py_control_summary.def_readonly("interval_jitter", &sv::devices::ControlSummary::interval_jitter,
+		"The standard deviation of the time between two iterations in seconds.");
+	py_control_summary.def_readonly("max_interval", &sv::devices::ControlSummary::max_interval,
+		"The maximum time in seconds between two iterations.");
+	py_control_summary.def_readonly("last_output", &sv::devices::ControlSummary::last_output,
+		"The last output, that was posted to the device.");
+
+	py::class_<sv::devices::PluginDeviceEngine, std::shared_ptr<sv::devices::PluginDeviceEngine>> py_plugin_device_engine(m, "PluginDeviceEngine");
+	py_plugin_device_engine.doc() = "Runs the virtual device of a native plugin on a user device.";
+	py_plugin_device_engine.def("device", &sv::devices::PluginDeviceEngine::device,
+		"Return the user device with the channels of the virtual device.");
+	py_plugin_device_engine.def("start", &sv::devices::PluginDeviceEngine::start,
+		py::call_guard<py::gil_scoped_release>(),
+		"(Re)start the acquisition.");
+	py_plugin_device_engine.def("stop", &sv::devices::PluginDeviceEngine::stop,
+		py::call_guard<py::gil_scoped_release>(),
+		"Stop the acquisition.");
+	py_plugin_device_engine.def("is_running", &sv::devices::PluginDeviceEngine::is_running,
+		"Return `True` while the virtual device acquires samples.");
+	py_plugin_device_engine.def("acquired_count", &sv::devices::PluginDeviceEngine::acquired_count,
+		"Return the number of acquired samples per channel since the start.");
 }
 
 void init_Channel(py::module &m)
@@ -246,10 +1245,150 @@ void init_Channel(py::module &m)
 		"-------\n"
 		"List[BaseSignal]\n"
 		"    All signals of the channel.");
+	py_base_channel.def("set_decimation", &sv::channels::BaseChannel::set_decimation,
+		py::arg("mode"), py::arg("factor"), py::arg("tolerance") = 0.,
+		"Set the ingest decimation for all analog signals of the channel, including the signals, that are added later. "
+		"See `AnalogTimeSignal.set_decimation()`.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"mode : DecimationMode\n"
+		"    The decimation mode.\n"
+		"factor : int\n"
+		"    The number of samples, that are reduced to one sample. `0` or `1` disables the decimation.\n"
+		"tolerance : float\n"
+		"    The tolerance of `DecimationMode.DeadBand` and `DecimationMode.SwingingDoor`.");
 
 	py::class_<sv::channels::HardwareChannel, std::shared_ptr<sv::channels::HardwareChannel>> py_hardware_channel(m, "HardwareChannel", py_base_channel);
 	py_hardware_channel.doc() = "An actual hardware channel";
-
+	py_hardware_channel.def("set_frame_capture", &sv::channels::HardwareChannel::set_frame_capture,
+		py::arg("frame_capture"),
+		"Also store the samples, that the device delivers in frames (e.g. a scope), frame by frame in an "
+		"`AnalogSegmentSignal`. The frame signal is created with the first captured frame.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"frame_capture : bool\n"
+		"    `True` to capture the frames.");
+	py_hardware_channel.def("frame_capture", &sv::channels::HardwareChannel::frame_capture,
+		"Return whether the frames are captured.\n\n"
+		"Returns\n"
+		"-------\n"
+		"bool\n"
+		"    `True` if the frames are captured.");
+	py_hardware_channel.def("frame_signal", &sv::channels::HardwareChannel::frame_signal,
+		"Return the signal with the captured frames.\n\n"
+		"Returns\n"
+		"-------\n"
+		"AnalogSegmentSignal\n"
+		"    The frame signal or `None`, if no frame was captured yet.");
+
+	py::class_<sv::channels::MathChannel, std::shared_ptr<sv::channels::MathChannel>> py_math_channel(m, "MathChannel", py_base_channel);
+	py_math_channel.doc() = "A virtual channel, that is calculated from other signals.";
+	py_math_channel.def("set_lazy", &sv::channels::MathChannel::set_lazy,
+		py::arg("lazy"),
+		"Only calculate the channel, while its signal is observed, e.g. by a plot, a panel or another (not lazy) math channel. "
+		"When the signal is observed again, the retained samples of the source signals, that arrived in the meantime, are calculated at once.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"lazy : bool\n"
+		"    `True` to only calculate the channel while observed.");
+	py_math_channel.def("is_lazy", &sv::channels::MathChannel::is_lazy,
+		"Return whether the channel is only calculated while observed.\n\n"
+		"Returns\n"
+		"-------\n"
+		"bool\n"
+		"    `True` if the channel is lazy.");
+
+	py::class_<sv::data::CalibrationCurve, std::shared_ptr<sv::data::CalibrationCurve>> py_calibration_curve(m, "CalibrationCurve");
+	py_calibration_curve.doc() = "A calibration/linearisation curve, either a polynomial or a piecewise linear lookup table "
+		"with equidistant points.";
+	py_calibration_curve.def_static("polynomial", &sv::data::CalibrationCurve::polynomial,
+		py::arg("coefficients"),
+		"Create a polynomial `c0 + c1 * x + c2 * x^2 + ...`.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"coefficients : List[float]\n"
+		"    The coefficients in ascending order.\n\n"
+		"Returns\n"
+		"-------\n"
+		"CalibrationCurve\n"
+		"    The curve or `None` if the coefficients are invalid.");
+	py_calibration_curve.def_static("uniform_lookup_table", &sv::data::CalibrationCurve::uniform_lookup_table,
+		py::arg("begin"), py::arg("step"), py::arg("table"),
+		"Create a lookup table with equidistant points. Values outside of the table are extrapolated.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"begin : float\n"
+		"    The x value of the first point.\n"
+		"step : float\n"
+		"    The distance of the x values.\n"
+		"table : List[float]\n"
+		"    The y values of the points.\n\n"
+		"Returns\n"
+		"-------\n"
+		"CalibrationCurve\n"
+		"    The curve or `None` if the table is invalid.");
+	py_calibration_curve.def_static("lookup_table", &sv::data::CalibrationCurve::lookup_table,
+		py::arg("x"), py::arg("y"),
+		"Create a lookup table from points, e.g. a reference table. Points, that are not equidistant, are "
+		"resampled onto the smallest distance of the points.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"x : List[float]\n"
+		"    The strictly ascending x values.\n"
+		"y : List[float]\n"
+		"    The y values.\n\n"
+		"Returns\n"
+		"-------\n"
+		"CalibrationCurve\n"
+		"    The curve or `None` if the points are invalid.");
+	py_calibration_curve.def_static("load", &sv::data::CalibrationCurve::load,
+		py::arg("file_name"),
+		"Load a curve from a CSV file. A record `polynomial,c0,c1,...` is a polynomial, all other records are "
+		"`x,y` points of a lookup table. A header and lines starting with `#` are skipped.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"file_name : str\n"
+		"    The CSV file.\n\n"
+		"Returns\n"
+		"-------\n"
+		"CalibrationCurve\n"
+		"    The curve or `None` if the file is invalid.");
+	py_calibration_curve.def("type", &sv::data::CalibrationCurve::type,
+		"Return the type of the curve.");
+	py_calibration_curve.def("coefficients", &sv::data::CalibrationCurve::coefficients,
+		"Return the coefficients of a polynomial in ascending order.");
+	py_calibration_curve.def("table_begin", &sv::data::CalibrationCurve::table_begin,
+		"Return the x value of the first point of a lookup table.");
+	py_calibration_curve.def("table_step", &sv::data::CalibrationCurve::table_step,
+		"Return the distance of the x values of a lookup table.");
+	py_calibration_curve.def("table", &sv::data::CalibrationCurve::table,
+		"Return the y values of a lookup table.");
+	py_calibration_curve.def("apply",
+		[](const sv::data::CalibrationCurve &curve, double value) {
+			return curve.apply(value);
+		},
+		py::arg("value"),
+		"Apply the curve to a value.");
+	py_calibration_curve.def("apply",
+		[](const sv::data::CalibrationCurve &curve, std::vector<double> values) {
+			curve.apply(values.data(), values.size(), values.data());
+			return values;
+		},
+		py::arg("values"),
+		"Apply the curve to a list of values at once.");
+
+	py::class_<sv::channels::CalibrationChannel, std::shared_ptr<sv::channels::CalibrationChannel>> py_calibration_channel(m, "CalibrationChannel", py_math_channel);
+	py_calibration_channel.doc() = "A math channel, that linearises a signal with a calibration curve.";
+	py_calibration_channel.def("set_curve", &sv::channels::CalibrationChannel::set_curve,
+		py::arg("curve"),
+		"Replace the calibration curve, e.g. after a recalibration. The curve is used for the following samples.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"curve : CalibrationCurve\n"
+		"    The new curve.");
+	py_calibration_channel.def("curve", &sv::channels::CalibrationChannel::curve,
+		"Return the calibration curve.");
+
 	py::class_<sv::channels::UserChannel, std::shared_ptr<sv::channels::UserChannel>> py_user_channel(m, "UserChannel", py_base_channel);
 	py_user_channel.doc() = "An user generated channel for storing custom data.";
 	py_user_channel.def("push_sample", &sv::channels::UserChannel::push_sample,
@@ -273,6 +1412,134 @@ void init_Channel(py::module &m)
 		"    The total number of digits.\n"
 		"decimal_places : int\n"
 		"    The number of decimal places.");
+	py_user_channel.def("push_samples", &sv::python::user_channel_push_samples,
+		py::arg("values"), py::arg("timestamps"), py::arg("quantity"),
+		py::arg("quantity_flags"), py::arg("unit"), py::arg("digits"),
+		py::arg("decimal_places"),
+		"Push a block of samples with explicit timestamps to the channel. The samples are stored "
+		"without the GIL and published at once, which is much faster than pushing them one by one.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"values : numpy.ndarray or List[float]\n"
+		"    The one dimensional array of the sample values.\n"
+		"timestamps : numpy.ndarray or List[float]\n"
+		"    The one dimensional array of the absolute timestamps, with the same size as `values`.\n"
+		"quantity : Quantity\n"
+		"    The `Quantity` of the new signal.\n"
+		"quantity_flags : Set[QuantityFlag]\n"
+		"    The `QuantityFlag`s of the new signal.\n"
+		"unit : Unit\n"
+		"    The `Unit` of the new signal.\n"
+		"digits : int\n"
+		"    The total number of digits.\n"
+		"decimal_places : int\n"
+		"    The number of decimal places.");
+	py_user_channel.def("push_samples", &sv::python::user_channel_push_samples_at_rate,
+		py::arg("values"), py::arg("samplerate"), py::arg("timestamp"),
+		py::arg("quantity"), py::arg("quantity_flags"), py::arg("unit"),
+		py::arg("digits"), py::arg("decimal_places"),
+		"Push a block of samples with a fixed samplerate to the channel. The samples are stored "
+		"without the GIL and published at once.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"values : numpy.ndarray or List[float]\n"
+		"    The one dimensional array of the sample values.\n"
+		"samplerate : float\n"
+		"    The samplerate in Hz.\n"
+		"timestamp : float\n"
+		"    The absolute timestamp of the first sample.\n"
+		"quantity : Quantity\n"
+		"    The `Quantity` of the new signal.\n"
+		"quantity_flags : Set[QuantityFlag]\n"
+		"    The `QuantityFlag`s of the new signal.\n"
+		"unit : Unit\n"
+		"    The `Unit` of the new signal.\n"
+		"digits : int\n"
+		"    The total number of digits.\n"
+		"decimal_places : int\n"
+		"    The number of decimal places.");
+	py_user_channel.def("start_config_sampling", &sv::channels::UserChannel::start_config_sampling,
+		py::arg("configurable"), py::arg("config_key"), py::arg("interval"),
+		py::arg("quantity"), py::arg("quantity_flags"), py::arg("unit"),
+		py::arg("digits"), py::arg("decimal_places"),
+		"Read the value of a config key at a fixed rate in a native thread and push it to the channel. "
+		"A running sampling of the channel is replaced.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"configurable : Configurable\n"
+		"    The `Configurable` to read from.\n"
+		"config_key : ConfigKey\n"
+		"    The `ConfigKey` to read.\n"
+		"interval : float\n"
+		"    The sampling interval in seconds.\n"
+		"quantity : Quantity\n"
+		"    The `Quantity` of the new signal.\n"
+		"quantity_flags : Set[QuantityFlag]\n"
+		"    The `QuantityFlag`s of the new signal.\n"
+		"unit : Unit\n"
+		"    The `Unit` of the new signal.\n"
+		"digits : int\n"
+		"    The total number of digits.\n"
+		"decimal_places : int\n"
+		"    The number of decimal places.");
+	py_user_channel.def("start_signal_sampling", &sv::channels::UserChannel::start_signal_sampling,
+		py::arg("signal"), py::arg("interval"),
+		"Read the last value of a signal at a fixed rate in a native thread and push it to the channel. "
+		"A running sampling of the channel is replaced.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"signal : AnalogTimeSignal\n"
+		"    The signal to read from.\n"
+		"interval : float\n"
+		"    The sampling interval in seconds.");
+	py_user_channel.def("stop_sampling", &sv::channels::UserChannel::stop_sampling,
+		py::call_guard<py::gil_scoped_release>(),
+		"Stop the sampling of the channel.");
+	py_user_channel.def("sampler", &sv::channels::UserChannel::sampler,
+		"Return the sampler of the channel.\n\n"
+		"Returns\n"
+		"-------\n"
+		"PeriodicSampler\n"
+		"    The sampler or `None`, if the channel was never sampled.");
+
+	py::class_<sv::channels::PeriodicSampler, std::shared_ptr<sv::channels::PeriodicSampler>> py_periodic_sampler(m, "PeriodicSampler");
+	py_periodic_sampler.doc() = "Samples a config key or a signal at a fixed rate, see `UserChannel.start_config_sampling()`.";
+	py_periodic_sampler.def("is_running", &sv::channels::PeriodicSampler::is_running,
+		"Return if the sampler is running.\n\n"
+		"Returns\n"
+		"-------\n"
+		"bool\n"
+		"    `True` if the sampler is running.");
+	py_periodic_sampler.def("interval", &sv::channels::PeriodicSampler::interval,
+		"Return the sampling interval.\n\n"
+		"Returns\n"
+		"-------\n"
+		"float\n"
+		"    The interval in seconds.");
+	py_periodic_sampler.def("sample_count", &sv::channels::PeriodicSampler::sample_count,
+		"Return the number of samples, that were pushed to the channel.\n\n"
+		"Returns\n"
+		"-------\n"
+		"int\n"
+		"    The number of samples.");
+	py_periodic_sampler.def("missed_count", &sv::channels::PeriodicSampler::missed_count,
+		"Return the number of sampling times, that were skipped, because a read took too long.\n\n"
+		"Returns\n"
+		"-------\n"
+		"int\n"
+		"    The number of skipped sampling times.");
+	py_periodic_sampler.def("error_count", &sv::channels::PeriodicSampler::error_count,
+		"Return the number of reads, that failed.\n\n"
+		"Returns\n"
+		"-------\n"
+		"int\n"
+		"    The number of failed reads.");
+	py_periodic_sampler.def("max_jitter", &sv::channels::PeriodicSampler::max_jitter,
+		"Return the maximum delay between the scheduled sampling time and the read.\n\n"
+		"Returns\n"
+		"-------\n"
+		"float\n"
+		"    The delay in seconds.");
 }
 
 void init_Signal(py::module &m)
@@ -288,93 +1555,1147 @@ void init_Signal(py::module &m)
 		"Return the name of the signal.\n\n"
 		"Returns\n"
 		"-------\n"
-		"str\n"
-		"    The name of the signal.");
-	py_base_signal.def("set_name", &sv::data::BaseSignal::set_name,
-		"Set a custom name for the signal.\n\n"
+		"str\n"
+		"    The name of the signal.");
+	py_base_signal.def("set_name", &sv::data::BaseSignal::set_name,
+		"Set a custom name for the signal.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"custom_name : str\n"
+		"    A custom name for the signal. If empty, the signal name will be automatically generated.");
+	py_base_signal.def("memory_size", &sv::data::BaseSignal::memory_size,
+		"Return the number of bytes, that are used by the samples of the signal in memory.\n\n"
+		"Returns\n"
+		"-------\n"
+		"int\n"
+		"    The size in bytes.");
+	py_base_signal.def("spilled_size", &sv::data::BaseSignal::spilled_size,
+		"Return the number of bytes, that are used by the samples of the signal in the temporary file.\n\n"
+		"Returns\n"
+		"-------\n"
+		"int\n"
+		"    The size in bytes.");
+	py_base_signal.def("set_memory_priority", &sv::data::BaseSignal::set_memory_priority,
+		py::arg("memory_priority"),
+		"Set the priority of the signal for the memory budget. When the budget is exceeded, "
+		"the signals with the lowest priority are spilled or evicted first.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"memory_priority : int\n"
+		"    The priority. The default is `0`.");
+	py_base_signal.def("sample_count", &sv::data::BaseSignal::sample_count,
+		"Return the number of samples of the signal.\n\n"
+		"Returns\n"
+		"-------\n"
+		"int\n"
+		"    The number of samples.");
+
+	py::class_<sv::data::AnalogSummary> py_analog_summary(m, "AnalogSummary");
+	py_analog_summary.doc() = "Min, max, mean, RMS, integral and slope of a range of samples.";
+	py_analog_summary.def_readonly("start_timestamp", &sv::data::AnalogSummary::start_timestamp,
+		"The timestamp of the first sample in the range.");
+	py_analog_summary.def_readonly("end_timestamp", &sv::data::AnalogSummary::end_timestamp,
+		"The timestamp of the last sample in the range.");
+	py_analog_summary.def_readonly("min", &sv::data::AnalogSummary::min,
+		"The minimum value.");
+	py_analog_summary.def_readonly("max", &sv::data::AnalogSummary::max,
+		"The maximum value.");
+	py_analog_summary.def_readonly("mean", &sv::data::AnalogSummary::mean,
+		"The mean value.");
+	py_analog_summary.def_readonly("rms", &sv::data::AnalogSummary::rms,
+		"The root mean square of the values.");
+	py_analog_summary.def_readonly("integral", &sv::data::AnalogSummary::integral,
+		"The integral over time (trapezoidal rule) in value * seconds.");
+	py_analog_summary.def_readonly("slope", &sv::data::AnalogSummary::slope,
+		"The slope of the least squares line through the samples in value / second.");
+	py_analog_summary.def_readonly("sample_count", &sv::data::AnalogSummary::sample_count,
+		"The number of samples in the range.");
+
+	py::class_<sv::data::AnalogTimeSnapshot> py_analog_time_snapshot(m, "AnalogTimeSnapshot");
+	py_analog_time_snapshot.doc() = "An immutable view of the samples of an `AnalogTimeSignal`. No samples of the signal are dropped while the snapshot exists.";
+	py_analog_time_snapshot.def("first_sample_pos", &sv::data::AnalogTimeSnapshot::first_sample_pos,
+		"Return the position of the first sample in the snapshot.\n\n"
+		"Returns\n"
+		"-------\n"
+		"int\n"
+		"    The position of the first sample.");
+	py_analog_time_snapshot.def("sample_count", &sv::data::AnalogTimeSnapshot::sample_count,
+		"Return the position behind the last sample in the snapshot.\n\n"
+		"Returns\n"
+		"-------\n"
+		"int\n"
+		"    The position behind the last sample.");
+	py_analog_time_snapshot.def("is_valid", &sv::data::AnalogTimeSnapshot::is_valid,
+		"Return if the snapshot is still valid. A snapshot becomes invalid, when the signal is cleared.\n\n"
+		"Returns\n"
+		"-------\n"
+		"bool\n"
+		"    `False` if the signal was cleared.");
+	py_analog_time_snapshot.def("get_samples", &sv::data::AnalogTimeSnapshot::get_samples,
+		py::arg("pos"), py::arg("count"), py::arg("relative_time"),
+		"Return up to `count` samples of the snapshot, starting at the given position.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"pos : int\n"
+		"    The position/number of the first sample.\n"
+		"count : int\n"
+		"    The maximum number of samples to return.\n"
+		"relative_time : bool\n"
+		"    When `True`, the returned timestamps are relative to the start of the SmuView session.\n\n"
+		"Returns\n"
+		"-------\n"
+		"List[Tuple[float, float]]\n"
+		"    The samples, each with 1. timestamp in milliseconds and 2. the sample value.");
+	py_analog_time_snapshot.def("get_values", &sv::python::snapshot_values,
+		py::arg("pos"), py::arg("count"),
+		"Return up to `count` values of the snapshot, starting at the given position, as NumPy array. "
+		"If the values are stored contiguously in the signal, the array is a read only view of them "
+		"without a copy, that keeps the snapshot alive. Otherwise the values are copied.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"pos : int\n"
+		"    The position/number of the first sample.\n"
+		"count : int\n"
+		"    The maximum number of values to return.\n\n"
+		"Returns\n"
+		"-------\n"
+		"numpy.ndarray\n"
+		"    The values as `float64` array.");
+	py_analog_time_snapshot.def("get_sample_arrays", &sv::python::snapshot_sample_arrays,
+		py::arg("pos"), py::arg("count"), py::arg("relative_time"),
+		"Return up to `count` samples of the snapshot, starting at the given position, as NumPy arrays. "
+		"The values are returned like in `AnalogTimeSnapshot.get_values()`, the timestamps are always copied.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"pos : int\n"
+		"    The position/number of the first sample.\n"
+		"count : int\n"
+		"    The maximum number of samples to return.\n"
+		"relative_time : bool\n"
+		"    When `True`, the returned timestamps are relative to the start of the SmuView session.\n\n"
+		"Returns\n"
+		"-------\n"
+		"Tuple[numpy.ndarray, numpy.ndarray]\n"
+		"    1. The timestamps and 2. the values as `float64` arrays of the same size.");
+	py_analog_time_snapshot.def("to_numpy", &sv::python::snapshot_to_numpy,
+		py::arg("relative_time") = true,
+		"Return all samples of the snapshot as NumPy arrays, see `AnalogTimeSnapshot.get_sample_arrays()`.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"relative_time : bool\n"
+		"    When `True` (default), the returned timestamps are relative to the start of the SmuView session.\n\n"
+		"Returns\n"
+		"-------\n"
+		"Tuple[numpy.ndarray, numpy.ndarray]\n"
+		"    1. The timestamps and 2. the values as `float64` arrays of the same size.");
+	py_analog_time_snapshot.def("get_interval_summaries", &sv::data::AnalogTimeSnapshot::get_interval_summaries,
+		py::arg("start_timestamp"), py::arg("interval"), py::arg("first_bin"), py::arg("count"), py::arg("relative_time"),
+		"Return the mean, min and max of `count` consecutive intervals of the same length, e.g. per second averages of a long "
+		"capture. The bin i covers [`start_timestamp` + (`first_bin` + i) * `interval`, `start_timestamp` + (`first_bin` + i + 1) * `interval`). "
+		"The summaries are calculated from the min/max pyramid of the signal, without reading the samples.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"start_timestamp : float\n"
+		"    The start of the first interval (with `first_bin` = 0).\n"
+		"interval : float\n"
+		"    The length of the intervals in seconds.\n"
+		"first_bin : int\n"
+		"    The number of the first returned interval, to read a long time range in blocks.\n"
+		"count : int\n"
+		"    The number of intervals.\n"
+		"relative_time : bool\n"
+		"    When `True`, the timestamps are relative to the session start time.\n\n"
+		"Returns\n"
+		"-------\n"
+		"List[AnalogSummary]\n"
+		"    A summary for every interval. Intervals without samples have a `sample_count` of 0.");
+
+	py::class_<sv::data::AnalogTimeSignal, std::shared_ptr<sv::data::AnalogTimeSignal>> py_analog_time_signal(m, "AnalogTimeSignal", py_base_signal);
+	py_analog_time_signal.doc() = "A signal with time-value pairs.";
+	py_analog_time_signal.def("get_sample", &sv::data::AnalogTimeSignal::get_sample,
+		py::arg("pos"), py::arg("relative_time"),
+		"Return the sample at the given position.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"pos : int\n"
+		"    The position/number of the sample.\n"
+		"relative_time : bool\n"
+		"    When `True`, the returned timestamp is relative to the start of the SmuView session.\n\n"
+		"Returns\n"
+		"-------\n"
+		"Tuple[float, float]\n"
+		"    The sample with 1. timestamp in milliseconds and 2. the sample value.");
+	py_analog_time_signal.def("snapshot", &sv::data::AnalogTimeSignal::snapshot,
+		"Return a snapshot of all samples, that are currently in the signal. "
+		"The snapshot stays consistent while new samples are acquired.\n\n"
+		"Returns\n"
+		"-------\n"
+		"AnalogTimeSnapshot\n"
+		"    The snapshot.");
+	py_analog_time_signal.def("get_samples", &sv::data::AnalogTimeSignal::get_samples,
+		py::arg("pos"), py::arg("count"), py::arg("relative_time"),
+		"Return up to `count` samples, starting at the given position.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"pos : int\n"
+		"    The position/number of the first sample.\n"
+		"count : int\n"
+		"    The maximum number of samples to return.\n"
+		"relative_time : bool\n"
+		"    When `True`, the returned timestamps are relative to the start of the SmuView session.\n\n"
+		"Returns\n"
+		"-------\n"
+		"List[Tuple[float, float]]\n"
+		"    The samples, each with 1. timestamp in milliseconds and 2. the sample value.");
+	py_analog_time_signal.def("to_numpy", &sv::python::signal_to_numpy,
+		py::arg("relative_time") = true,
+		"Return all samples, that are currently in the signal, as NumPy arrays. This is much faster "
+		"than reading the samples one by one. To read the samples in blocks, use a `snapshot()` and "
+		"`AnalogTimeSnapshot.get_sample_arrays()`.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"relative_time : bool\n"
+		"    When `True` (default), the returned timestamps are relative to the start of the SmuView session.\n\n"
+		"Returns\n"
+		"-------\n"
+		"Tuple[numpy.ndarray, numpy.ndarray]\n"
+		"    1. The timestamps and 2. the values as `float64` arrays of the same size.");
+	py_analog_time_signal.def("on_samples", &sv::python::signal_on_samples,
+		py::arg("callback"), py::arg("min_batch") = 1, py::arg("max_latency") = 0.1,
+		"Call a function with the samples, that are appended to the signal from now on. The samples are "
+		"collected in C++ and delivered in batches by a background thread, that holds the GIL only while "
+		"the function is called. So the script doesn't have to poll the signal, it can e.g. wait in "
+		"`time.sleep()`. The delivery ends, when the returned subscription is stopped or deleted, or when "
+		"the function raises an exception.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"callback : Callable[[numpy.ndarray, numpy.ndarray], None]\n"
+		"    Called with 1. the timestamps (seconds since the epoch) and 2. the values of a batch as "
+		"`float64` arrays of the same size.\n"
+		"min_batch : int\n"
+		"    The function is called, when this number of samples is pending. Default is `1`.\n"
+		"max_latency : float\n"
+		"    Smaller batches are delivered, when the oldest pending sample has waited this time in "
+		"seconds. Default is `0.1`.\n\n"
+		"Returns\n"
+		"-------\n"
+		"SampleSubscription\n"
+		"    The subscription. Keep a reference to it, as long as the samples should be delivered.");
+	py_analog_time_signal.def("get_last_sample", &sv::data::AnalogTimeSignal::get_last_sample,
+		py::arg("relative_time"),
+		"Return the last sample of the signal.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"relative_time : bool\n"
+		"    When `True`, the returned timestamp is relative to the start of the SmuView session.\n\n"
+		"Returns\n"
+		"-------\n"
+		"Tuple[float, float]\n"
+		"    The sample with 1. timestamp in milliseconds and 2. the sample value.");
+	py_analog_time_signal.def("lower_index", &sv::data::AnalogTimeSignal::lower_index,
+		py::arg("timestamp"), py::arg("relative_time"),
+		"Return the position of the first sample with a timestamp not less than `timestamp`.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"timestamp : float\n"
+		"    The timestamp in seconds.\n"
+		"relative_time : bool\n"
+		"    When `True`, the timestamp is relative to the session start time.\n\n"
+		"Returns\n"
+		"-------\n"
+		"int\n"
+		"    The sample position. If all samples are older, the sample count is returned.");
+	py_analog_time_signal.def("index_range", &sv::data::AnalogTimeSignal::index_range,
+		py::arg("start_timestamp"), py::arg("end_timestamp"), py::arg("relative_time"),
+		"Return the position range of all samples with `start_timestamp <= timestamp <= end_timestamp`.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"start_timestamp : float\n"
+		"    The start timestamp in seconds.\n"
+		"end_timestamp : float\n"
+		"    The end timestamp in seconds.\n"
+		"relative_time : bool\n"
+		"    When `True`, the timestamps are relative to the session start time.\n\n"
+		"Returns\n"
+		"-------\n"
+		"Tuple[int, int]\n"
+		"    The position of the first sample and the position behind the last sample.");
+	py_analog_time_signal.def("get_summaries", &sv::data::AnalogTimeSignal::get_summaries,
+		py::arg("start_timestamp"), py::arg("end_timestamp"), py::arg("count"), py::arg("relative_time"),
+		"Divide the time range into `count` bins of equal length and return the min, max, mean and integral of every bin, that contains samples. "
+		"With `count` = 1, this returns the summary of the whole time range, e.g. between two markers.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"start_timestamp : float\n"
+		"    The start of the time range.\n"
+		"end_timestamp : float\n"
+		"    The end of the time range (inclusive).\n"
+		"count : int\n"
+		"    The number of bins.\n"
+		"relative_time : bool\n"
+		"    When `True`, the timestamps are relative to the session start time.\n\n"
+		"Returns\n"
+		"-------\n"
+		"List[AnalogSummary]\n"
+		"    The summaries of all bins, that contain samples.");
+	py_analog_time_signal.def("get_interval_summaries", &sv::data::AnalogTimeSignal::get_interval_summaries,
+		py::arg("start_timestamp"), py::arg("interval"), py::arg("first_bin"), py::arg("count"), py::arg("relative_time"),
+		"Return the mean, min and max of `count` consecutive intervals of the same length, e.g. per second averages of a long "
+		"capture. The bin i covers [`start_timestamp` + (`first_bin` + i) * `interval`, `start_timestamp` + (`first_bin` + i + 1) * `interval`). "
+		"The summaries are calculated from the min/max pyramid of the signal, without reading the samples.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"start_timestamp : float\n"
+		"    The start of the first interval (with `first_bin` = 0).\n"
+		"interval : float\n"
+		"    The length of the intervals in seconds.\n"
+		"first_bin : int\n"
+		"    The number of the first returned interval, to read a long time range in blocks.\n"
+		"count : int\n"
+		"    The number of intervals.\n"
+		"relative_time : bool\n"
+		"    When `True`, the timestamps are relative to the session start time.\n\n"
+		"Returns\n"
+		"-------\n"
+		"List[AnalogSummary]\n"
+		"    A summary for every interval. Intervals without samples have a `sample_count` of 0.");
+	py_analog_time_signal.def("first_sample_pos", &sv::data::AnalogTimeSignal::first_sample_pos,
+		"Return the position of the oldest sample, that is still stored in the signal.\n\n"
+		"Returns\n"
+		"-------\n"
+		"int\n"
+		"    The position of the oldest sample. This is 0 until samples are dropped by the retention policy.");
+	py_analog_time_signal.def("set_retention_max_samples", &sv::data::AnalogTimeSignal::set_retention_max_samples,
+		py::arg("max_samples"),
+		"Limit the number of samples stored in the signal. When the limit is exceeded, the oldest samples are dropped.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"max_samples : int\n"
+		"    The maximum number of samples. `0` means unlimited.");
+	py_analog_time_signal.def("set_retention_max_age", &sv::data::AnalogTimeSignal::set_retention_max_age,
+		py::arg("max_age"),
+		"Limit the age of the samples stored in the signal. Samples that are older than `max_age` (relative to the last sample) are dropped.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"max_age : float\n"
+		"    The maximum age in seconds. `0` means unlimited.");
+	py_analog_time_signal.def("mean_since", &sv::data::AnalogTimeSignal::mean_since,
+		py::arg("timestamp"), py::arg("relative_time") = false,
+		"Return the mean of all samples since the given timestamp, e.g. since a new output value was set. "
+		"The mean is calculated from the min/max pyramid of the signal, the samples are not read.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"timestamp : float\n"
+		"    The timestamp of the first sample in seconds, e.g. from `time.time()`.\n"
+		"relative_time : bool\n"
+		"    When `True`, the timestamp is relative to the start of the SmuView session.\n\n"
+		"Returns\n"
+		"-------\n"
+		"float\n"
+		"    The mean value or NaN if there are no samples since the timestamp.");
+	py_analog_time_signal.def("wait_for_samples", &sv::data::AnalogTimeSignal::wait_for_samples,
+		py::arg("count"), py::arg("timeout"),
+		py::call_guard<py::gil_scoped_release>(),
+		"Wait until the given number of samples were appended to the signal. The script is woken up by "
+		"the acquisition, the signal is not polled.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"count : int\n"
+		"    The number of new samples.\n"
+		"timeout : float\n"
+		"    The maximum time to wait in seconds.\n\n"
+		"Returns\n"
+		"-------\n"
+		"bool\n"
+		"    `False` if the timeout has elapsed.");
+	py_analog_time_signal.def("wait_stable", &sv::data::AnalogTimeSignal::wait_stable,
+		py::arg("tolerance"), py::arg("duration"), py::arg("timeout"),
+		py::call_guard<py::gil_scoped_release>(),
+		"Wait until the samples of the last `duration` seconds differ by no more than `tolerance` "
+		"(max - min). Only samples, that are appended after the call, are taken into account.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"tolerance : float\n"
+		"    The maximum difference of the values.\n"
+		"duration : float\n"
+		"    The time in seconds, the signal has to be stable.\n"
+		"timeout : float\n"
+		"    The maximum time to wait in seconds.\n\n"
+		"Returns\n"
+		"-------\n"
+		"bool\n"
+		"    `False` if the timeout has elapsed.");
+	py_analog_time_signal.def("wait_for_samples_async", &sv::python::wait_for_samples_async,
+		py::arg("count"), py::arg("timeout"),
+		"Like `wait_for_samples()`, but return an awaitable `asyncio.Future` with the result.");
+	py_analog_time_signal.def("wait_stable_async", &sv::python::wait_stable_async,
+		py::arg("tolerance"), py::arg("duration"), py::arg("timeout"),
+		"Like `wait_stable()`, but return an awaitable `asyncio.Future` with the result.");
+	py_analog_time_signal.def("mean_value", &sv::data::AnalogTimeSignal::mean_value,
+		"Return the mean of all finite sample values since the signal was started or cleared.\n\n"
+		"Returns\n"
+		"-------\n"
+		"float\n"
+		"    The mean value.");
+	py_analog_time_signal.def("rms_value", &sv::data::AnalogTimeSignal::rms_value,
+		"Return the RMS (root mean square) of all finite sample values since the signal was started or cleared.\n\n"
+		"Returns\n"
+		"-------\n"
+		"float\n"
+		"    The RMS value.");
+	py_analog_time_signal.def("stddev_value", &sv::data::AnalogTimeSignal::stddev_value,
+		"Return the (population) standard deviation of all finite sample values since the signal was started or cleared.\n\n"
+		"Returns\n"
+		"-------\n"
+		"float\n"
+		"    The standard deviation.");
+	py_analog_time_signal.def("set_spill_to_disk", &sv::data::AnalogTimeSignal::set_spill_to_disk,
+		py::arg("spill_to_disk"),
+		"Store the samples of the signal in a memory mapped temporary file, so long captures can outgrow the RAM. "
+		"Only samples, that are pushed after this call, are stored in the file.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"spill_to_disk : bool\n"
+		"    `True` to store the following samples in the temporary file.\n\n"
+		"Returns\n"
+		"-------\n"
+		"bool\n"
+		"    `False` if the temporary file couldn't be created.");
+	py_analog_time_signal.def("export_shared_memory", &sv::data::AnalogTimeSignal::export_shared_memory,
+		py::arg("name"), py::arg("capacity"),
+		"Write the samples of the signal, while they are acquired, also to a ring in a named shared memory "
+		"object, so other processes on the same machine can read them without a copy (e.g. with "
+		"`multiprocessing.shared_memory` and numpy). The sample at the position `pos` is in the slot "
+		"`pos % capacity`. The header (see `SharedMemoryRingHeader` in the sources) holds the capacity, "
+		"the offsets of the timestamp and value arrays, a sequence and the write position. A copy is "
+		"consistent, if the sequence was even and unchanged before and after the copy. An existing "
+		"export is replaced.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"name : str\n"
+		"    The name of the shared memory object.\n"
+		"capacity : int\n"
+		"    The number of samples in the ring, rounded up to a power of two.\n\n"
+		"Returns\n"
+		"-------\n"
+		"bool\n"
+		"    `False` if the shared memory object couldn't be created.");
+	py_analog_time_signal.def("stop_shared_memory_export", &sv::data::AnalogTimeSignal::stop_shared_memory_export,
+		"Stop the shared memory export and remove the shared memory object. Readers keep their mapping.");
+	py_analog_time_signal.def("shared_memory_name", &sv::data::AnalogTimeSignal::shared_memory_name,
+		"Return the name of the shared memory object or an empty string, if the signal is not exported.");
+	py_analog_time_signal.def("set_compression", &sv::data::AnalogTimeSignal::set_compression,
+		py::arg("compression"),
+		"Store the samples of the signal losslessly compressed. This is only possible as long as the signal is empty.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"compression : bool\n"
+		"    `True` to compress the samples.\n\n"
+		"Returns\n"
+		"-------\n"
+		"bool\n"
+		"    `False` if the signal already contains samples.");
+	py_analog_time_signal.def("set_decimation", &sv::data::AnalogTimeSignal::set_decimation,
+		py::arg("mode"), py::arg("factor"), py::arg("tolerance") = 0.,
+		"Reduce the pushed samples before they are stored, so the full stream never has to be stored. "
+		"Only the following samples are decimated.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"mode : DecimationMode\n"
+		"    The decimation mode.\n"
+		"factor : int\n"
+		"    The number of samples, that are reduced to one sample (two for `DecimationMode.MinMax`). `0` or `1` disables the decimation. "
+		"For `DecimationMode.DeadBand` and `DecimationMode.SwingingDoor` the maximum number of samples between "
+		"two stored samples, `0` or `1` for no limit.\n"
+		"tolerance : float\n"
+		"    The allowed deviation of the stored signal for `DecimationMode.DeadBand` and `DecimationMode.SwingingDoor`. "
+		"`get_value_at_timestamp()` interpolates across the gaps.");
+	py_analog_time_signal.def("decimation_mode", &sv::data::AnalogTimeSignal::decimation_mode,
+		"Return the decimation mode of the signal.\n\n"
+		"Returns\n"
+		"-------\n"
+		"DecimationMode\n"
+		"    The decimation mode.");
+	py_analog_time_signal.def("decimation_factor", &sv::data::AnalogTimeSignal::decimation_factor,
+		"Return the decimation factor of the signal.\n\n"
+		"Returns\n"
+		"-------\n"
+		"int\n"
+		"    The number of samples, that are reduced to one sample.");
+	py_analog_time_signal.def("set_full_rate_capture", &sv::data::AnalogTimeSignal::set_full_rate_capture,
+		py::arg("target"), py::arg("pre_trigger"), py::arg("post_trigger"),
+		"Keep the samples, that are reduced by the decimation, at full rate in a ring of the last seconds. "
+		"On `capture_full_rate()` (e.g. by a `TriggerEngine`), the full rate samples of the pre and post trigger "
+		"windows are pushed to the target signal, that stores them permanently.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"target : AnalogTimeSignal\n"
+		"    The signal for the full rate samples, e.g. of a `UserChannel`. `None` disables the capture.\n"
+		"pre_trigger : float\n"
+		"    The seconds before the trigger.\n"
+		"post_trigger : float\n"
+		"    The seconds after the trigger.");
+	py_analog_time_signal.def("full_rate_signal", &sv::data::AnalogTimeSignal::full_rate_signal,
+		"Return the target signal of the full rate capture.\n\n"
+		"Returns\n"
+		"-------\n"
+		"AnalogTimeSignal\n"
+		"    The target signal or `None`.");
+	py_analog_time_signal.def("capture_full_rate", &sv::data::AnalogTimeSignal::capture_full_rate,
+		py::arg("timestamp"),
+		py::call_guard<py::gil_scoped_release>(),
+		"Promote the full rate samples around the timestamp to the target signal. Overlapping windows are merged.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"timestamp : float\n"
+		"    The absolute timestamp of the trigger.\n\n"
+		"Returns\n"
+		"-------\n"
+		"bool\n"
+		"    `False` if no full rate capture is set.");
+	py_analog_time_signal.def("set_time_skew", &sv::data::AnalogTimeSignal::set_time_skew,
+		py::arg("time_skew"),
+		"Set the skew of the signal against other signals, e.g. as estimated by a `SkewEstimator`. The skew is "
+		"subtracted from the timestamps, when the signal is combined with other signals (e.g. in a math channel "
+		"or a XY plot), the stored timestamps are not changed.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"time_skew : float\n"
+		"    The skew in seconds, positive if the samples are late.");
+	py_analog_time_signal.def("time_skew", &sv::data::AnalogTimeSignal::time_skew,
+		"Return the skew of the signal against other signals in seconds.");
+	py_analog_time_signal.def("set_value_storage", &sv::data::AnalogTimeSignal::set_value_storage,
+		py::arg("storage"),
+		"Select the type, that is used to store the values of the signal. The type can only be changed as long as the signal contains no samples.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"storage : ValueStorage\n"
+		"    The storage type.\n\n"
+		"Returns\n"
+		"-------\n"
+		"bool\n"
+		"    `True` if the storage type was changed.");
+	py_analog_time_signal.def("push_sample",
+		[](sv::data::AnalogTimeSignal &signal, double sample, double timestamp,
+				int digits, int decimal_places) {
+			signal.push_sample(sample, timestamp, digits, decimal_places);
+		},
+		py::arg("sample"), py::arg("timestamp"),
+		py::arg("digits"), py::arg("decimal_places"),
+		"Push a new sample to the signal.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"sample : float\n"
+		"    The sample value.\n"
+		"timestamp : float\n"
+		"    The absolute timestamp in milliseconds.\n"
+		"digits : int\n"
+		"    The total number of digits.\n"
+		"decimal_places : int\n"
+		"    The number of decimal places.");
+
+	py::class_<sv::data::AnalogSampleSignal, std::shared_ptr<sv::data::AnalogSampleSignal>> py_analog_sample_signal(m, "AnalogSampleSignal", py_base_signal);
+	py_analog_sample_signal.doc() = "A signal with key-value pairs.";
+	py_analog_sample_signal.def("get_sample", &sv::data::AnalogSampleSignal::get_sample,
+		py::arg("pos"),
+		"Return the sample for the given position.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"pos : int\n"
+		"    The position/number of the sample.\n\n"
+		"Returns\n"
+		"-------\n"
+		"Tuple[int, float]\n"
+		"    The sample with 1. the key and 2. the sample value.");
+	py_analog_sample_signal.def("push_sample",
+		[](sv::data::AnalogSampleSignal &signal, double sample, uint32_t pos,
+				int digits, int decimal_places) {
+			signal.push_sample(sample, pos, digits, decimal_places);
+		},
+		py::arg("sample"), py::arg("pos"),
+		py::arg("digits"), py::arg("decimal_places"),
+		"Push a new sample to the signal.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"sample : float\n"
+		"    The sample value.\n"
+		"pos : int\n"
+		"    The key (position) of the new sample.\n"
+		"digits : int\n"
+		"    The total number of digits.\n"
+		"decimal_places : int\n"
+		"    The number of decimal places.");
+	py_analog_sample_signal.def("set_retention_max_samples", &sv::data::AnalogSampleSignal::set_retention_max_samples,
+		py::arg("max_samples"),
+		"Limit the number of samples stored in the signal. When the limit is exceeded, the oldest samples are dropped.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"max_samples : int\n"
+		"    The maximum number of samples. `0` means unlimited.");
+	py_analog_sample_signal.def("set_spill_to_disk", &sv::data::AnalogSampleSignal::set_spill_to_disk,
+		py::arg("spill_to_disk"),
+		"Store the samples of the signal in a memory mapped temporary file, so long captures can outgrow the RAM. "
+		"Only samples, that are pushed after this call, are stored in the file.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"spill_to_disk : bool\n"
+		"    `True` to store the following samples in the temporary file.\n\n"
+		"Returns\n"
+		"-------\n"
+		"bool\n"
+		"    `False` if the temporary file couldn't be created.");
+	py_analog_sample_signal.def("set_compression", &sv::data::AnalogSampleSignal::set_compression,
+		py::arg("compression"),
+		"Store the samples of the signal losslessly compressed. This is only possible as long as the signal is empty.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"compression : bool\n"
+		"    `True` to compress the samples.\n\n"
+		"Returns\n"
+		"-------\n"
+		"bool\n"
+		"    `False` if the signal already contains samples.");
+
+	py::class_<sv::data::AnalogFrame> py_analog_frame(m, "AnalogFrame");
+	py_analog_frame.doc() = "The header of a frame in an `AnalogSegmentSignal`.";
+	py_analog_frame.def_readonly("sample_count", &sv::data::AnalogFrame::sample_count,
+		"The number of samples in the frame.");
+	py_analog_frame.def_readonly("timestamp", &sv::data::AnalogFrame::timestamp,
+		"The absolute timestamp of the first sample.");
+	py_analog_frame.def_readonly("samplerate", &sv::data::AnalogFrame::samplerate,
+		"The samplerate of the frame in Hz.");
+
+	py::class_<sv::data::AnalogSegmentSignal, std::shared_ptr<sv::data::AnalogSegmentSignal>> py_analog_segment_signal(m, "AnalogSegmentSignal", py_base_signal);
+	py_analog_segment_signal.doc() = "A signal with whole acquisition frames, e.g. of a scope.";
+	py_analog_segment_signal.def("frame_count", &sv::data::AnalogSegmentSignal::frame_count,
+		"Return the number of frames, i.e. the position behind the newest frame.");
+	py_analog_segment_signal.def("first_frame_pos", &sv::data::AnalogSegmentSignal::first_frame_pos,
+		"Return the position of the oldest frame, that is still stored.");
+	py_analog_segment_signal.def("get_frame",
+		[](const sv::data::AnalogSegmentSignal &signal, size_t frame_pos) -> py::object {
+			sv::data::AnalogFrame frame;
+			if (!signal.get_frame(frame_pos, frame))
+				return py::none();
+			return py::cast(frame);
+		},
+		py::arg("frame_pos"),
+		"Return the header of a frame.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"frame_pos : int\n"
+		"    The position of the frame.\n\n"
+		"Returns\n"
+		"-------\n"
+		"AnalogFrame\n"
+		"    The frame header or `None`, if the frame was dropped or doesn't exist yet.");
+	py_analog_segment_signal.def("frame_values", &sv::python::segment_frame_values,
+		py::arg("frame_pos"),
+		"Return the values of a frame.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"frame_pos : int\n"
+		"    The position of the frame.\n\n"
+		"Returns\n"
+		"-------\n"
+		"numpy.ndarray\n"
+		"    The values or an empty array, if the frame was dropped or doesn't exist yet.");
+	py_analog_segment_signal.def("set_retention_max_frames", &sv::data::AnalogSegmentSignal::set_retention_max_frames,
+		py::arg("max_frames"),
+		"Limit the number of frames stored in the signal. When the limit is exceeded, the oldest frames are dropped.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"max_frames : int\n"
+		"    The maximum number of frames. `0` means unlimited.");
+
+	py::class_<sv::python::SampleSubscription> py_sample_subscription(m, "SampleSubscription");
+	py_sample_subscription.doc() = "Delivers the appended samples of a signal to a Python function, "
+		"see `AnalogTimeSignal.on_samples()`.";
+	py_sample_subscription.def("stop", &sv::python::SampleSubscription::stop,
+		"Stop the delivery. A running call of the function is finished first.");
+	py_sample_subscription.def("is_running", &sv::python::SampleSubscription::is_running,
+		"Return `True` while the samples are delivered.");
+	py_sample_subscription.def("delivered_sample_count", &sv::python::SampleSubscription::delivered_sample_count,
+		"Return the number of samples, that were passed to the function.");
+	py_sample_subscription.def("dropped_sample_count", &sv::python::SampleSubscription::dropped_sample_count,
+		"Return the number of samples, that were dropped from the signal by the retention policy, "
+		"before they could be delivered.");
+
+	py::class_<sv::data::TriggerEvent> py_trigger_event(m, "TriggerEvent");
+	py_trigger_event.doc() = "An event, that was recorded by a trigger engine.";
+	py_trigger_event.def_readonly("trigger_id", &sv::data::TriggerEvent::trigger_id,
+		"The id of the trigger.");
+	py_trigger_event.def_readonly("type", &sv::data::TriggerEvent::type,
+		"The `TriggerEventType` of the event.");
+	py_trigger_event.def_readonly("sample_pos", &sv::data::TriggerEvent::sample_pos,
+		"The position of the sample in the signal, that triggered.");
+	py_trigger_event.def_readonly("timestamp", &sv::data::TriggerEvent::timestamp,
+		"The timestamp of the sample, that triggered.");
+	py_trigger_event.def_readonly("value", &sv::data::TriggerEvent::value,
+		"The value of the sample, that triggered. For a dropout, the length of the gap in seconds.");
+
+	py::class_<sv::data::TriggerEngine, std::shared_ptr<sv::data::TriggerEngine>> py_trigger_engine(m, "TriggerEngine");
+	py_trigger_engine.doc() = "Checks the samples of a signal against triggers and records the events.";
+	py_trigger_engine.def("add_edge_trigger", &sv::data::TriggerEngine::add_edge_trigger,
+		py::arg("edge"), py::arg("level"), py::arg("hysteresis") = 0.,
+		"Trigger, when the value crosses a level. The trigger is armed again, when the value went back "
+		"behind the level by the hysteresis.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"edge : TriggerEdge\n"
+		"    The edge to trigger on.\n"
+		"level : float\n"
+		"    The trigger level.\n"
+		"hysteresis : float\n"
+		"    The hysteresis.\n\n"
+		"Returns\n"
+		"-------\n"
+		"int\n"
+		"    The id of the trigger.");
+	py_trigger_engine.def("add_limit_trigger", &sv::data::TriggerEngine::add_limit_trigger,
+		py::arg("low"), py::arg("high"), py::arg("hysteresis") = 0.,
+		"Trigger, when the value leaves the limits and when it is back inside the limits minus the hysteresis.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"low : float\n"
+		"    The lower limit.\n"
+		"high : float\n"
+		"    The upper limit.\n"
+		"hysteresis : float\n"
+		"    The hysteresis.\n\n"
+		"Returns\n"
+		"-------\n"
+		"int\n"
+		"    The id of the trigger.");
+	py_trigger_engine.def("add_dropout_trigger", &sv::data::TriggerEngine::add_dropout_trigger,
+		py::arg("timeout"),
+		"Trigger, when two consecutive samples are further apart than the timeout. "
+		"The event is recorded with the first sample after the gap.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"timeout : float\n"
+		"    The timeout in seconds.\n\n"
+		"Returns\n"
+		"-------\n"
+		"int\n"
+		"    The id of the trigger.");
+	py_trigger_engine.def("remove_trigger", &sv::data::TriggerEngine::remove_trigger,
+		py::arg("trigger_id"),
+		"Remove a trigger.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"trigger_id : int\n"
+		"    The id of the trigger.\n\n"
+		"Returns\n"
+		"-------\n"
+		"bool\n"
+		"    `False` if there is no trigger with the id.");
+	py_trigger_engine.def("first_event_pos", &sv::data::TriggerEngine::first_event_pos,
+		"Return the position of the oldest event, that is still in the buffer.");
+	py_trigger_engine.def("event_count", &sv::data::TriggerEngine::event_count,
+		"Return the number of all events so far, including the events, that were already dropped from the buffer.");
+	py_trigger_engine.def("events", &sv::data::TriggerEngine::events,
+		py::arg("first") = 0,
+		"Return the recorded events.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"first : int\n"
+		"    The position of the first event, e.g. the `event_count()` of a previous call.\n\n"
+		"Returns\n"
+		"-------\n"
+		"List[TriggerEvent]\n"
+		"    The events.");
+	py_trigger_engine.def("wait_for_events", &sv::data::TriggerEngine::wait_for_events,
+		py::arg("count"), py::arg("timeout"),
+		py::call_guard<py::gil_scoped_release>(),
+		"Wait until the `event_count()` is greater than count, without polling.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"count : int\n"
+		"    The event count to wait for, e.g. the `event_count()` of a previous call.\n"
+		"timeout : int\n"
+		"    The timeout in milliseconds.\n\n"
+		"Returns\n"
+		"-------\n"
+		"int\n"
+		"    The event count.");
+	py_trigger_engine.def("clear_events", &sv::data::TriggerEngine::clear_events,
+		"Drop all recorded events.");
+	py_trigger_engine.def("set_capture_full_rate", &sv::data::TriggerEngine::set_capture_full_rate,
+		py::arg("capture_full_rate"),
+		"Promote the full rate samples around every event to permanent storage, see "
+		"`AnalogTimeSignal.set_full_rate_capture()`.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"capture_full_rate : bool\n"
+		"    `True` to capture the full rate samples of the events.");
+
+	py::class_<sv::data::LimitRuleResult> py_limit_rule_result(m, "LimitRuleResult");
+	py_limit_rule_result.doc() = "The result of a limit rule in a test step.";
+	py_limit_rule_result.def_readonly("rule_id", &sv::data::LimitRuleResult::rule_id,
+		"The id of the rule.");
+	py_limit_rule_result.def_readonly("name", &sv::data::LimitRuleResult::name,
+		"The name of the rule.");
+	py_limit_rule_result.def_readonly("sample_count", &sv::data::LimitRuleResult::sample_count,
+		"The number of checked samples.");
+	py_limit_rule_result.def_readonly("failure_count", &sv::data::LimitRuleResult::failure_count,
+		"The number of samples outside the limits.");
+	py_limit_rule_result.def_readonly("min", &sv::data::LimitRuleResult::min,
+		"The min of the checked samples, `NaN` if no sample was checked.");
+	py_limit_rule_result.def_readonly("max", &sv::data::LimitRuleResult::max,
+		"The max of the checked samples, `NaN` if no sample was checked.");
+	py_limit_rule_result.def_readonly("first_failure_timestamp", &sv::data::LimitRuleResult::first_failure_timestamp,
+		"The timestamp of the first sample outside the limits, `NaN` if there is none.");
+	py_limit_rule_result.def_readonly("first_failure_value", &sv::data::LimitRuleResult::first_failure_value,
+		"The value of the first sample outside the limits, `NaN` if there is none.");
+	py_limit_rule_result.def_readonly("passed", &sv::data::LimitRuleResult::passed,
+		"`True` if at least one sample was checked and no sample failed.");
+
+	py::class_<sv::data::LimitStepResult> py_limit_step_result(m, "LimitStepResult");
+	py_limit_step_result.doc() = "The result of a test step of a limit engine.";
+	py_limit_step_result.def_readonly("name", &sv::data::LimitStepResult::name,
+		"The name of the step.");
+	py_limit_step_result.def_readonly("start_timestamp", &sv::data::LimitStepResult::start_timestamp,
+		"The timestamp of the first checked sample, `NaN` if there is none.");
+	py_limit_step_result.def_readonly("end_timestamp", &sv::data::LimitStepResult::end_timestamp,
+		"The timestamp of the last checked sample, `NaN` if there is none.");
+	py_limit_step_result.def_readonly("finished", &sv::data::LimitStepResult::finished,
+		"`False` while the step is running.");
+	py_limit_step_result.def_readonly("passed", &sv::data::LimitStepResult::passed,
+		"`True` if all rules of the step have passed.");
+	py_limit_step_result.def_readonly("rules", &sv::data::LimitStepResult::rules,
+		"The `LimitRuleResult`s of the rules.");
+
+	py::class_<sv::data::LimitEngine, std::shared_ptr<sv::data::LimitEngine>> py_limit_engine(m, "LimitEngine");
+	py_limit_engine.doc() = "Checks the samples of a signal against limit rules and aggregates the pass/fail "
+		"results per test step.";
+	py_limit_engine.def("add_limit_rule", &sv::data::LimitEngine::add_limit_rule,
+		py::arg("low"), py::arg("high"), py::arg("name") = "",
+		"Check, that the values are inside the limits.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"low : float\n"
+		"    The lower limit.\n"
+		"high : float\n"
+		"    The upper limit.\n"
+		"name : str\n"
+		"    The name of the rule in the results.\n\n"
+		"Returns\n"
+		"-------\n"
+		"int\n"
+		"    The id of the rule.");
+	py_limit_engine.def("add_tolerance_rule", &sv::data::LimitEngine::add_tolerance_rule,
+		py::arg("nominal"), py::arg("tolerance"), py::arg("relative") = false, py::arg("name") = "",
+		"Check, that the values are inside the nominal value +/- the tolerance.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"nominal : float\n"
+		"    The nominal value.\n"
+		"tolerance : float\n"
+		"    The tolerance.\n"
+		"relative : bool\n"
+		"    `True` if the tolerance is a fraction of the nominal value, e.g. `0.01` for 1%.\n"
+		"name : str\n"
+		"    The name of the rule in the results.\n\n"
+		"Returns\n"
+		"-------\n"
+		"int\n"
+		"    The id of the rule.");
+	py_limit_engine.def("add_mask_rule",
+		[](sv::data::LimitEngine &engine,
+				const std::vector<std::tuple<double, double, double>> &mask,
+				const std::string &name) {
+			std::vector<sv::data::LimitMaskPoint> points;
+			for (const auto &point : mask) {
+				points.push_back(sv::data::LimitMaskPoint{ std::get<0>(point),
+					std::get<1>(point), std::get<2>(point) });
+			}
+			return engine.add_mask_rule(points, name);
+		},
+		py::arg("mask"), py::arg("name") = "",
+		"Check, that the values are inside a band, that is interpolated linearly between the mask points, "
+		"e.g. for the settling of a step response. Samples before the first or after the last point are "
+		"not checked.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"mask : List[Tuple[float, float, float]]\n"
+		"    The mask points as (time, low, high). The time is in seconds since the first sample of the step.\n"
+		"name : str\n"
+		"    The name of the rule in the results.\n\n"
+		"Returns\n"
+		"-------\n"
+		"int\n"
+		"    The id of the rule or `0` if the mask has no points.");
+	py_limit_engine.def("remove_rule", &sv::data::LimitEngine::remove_rule,
+		py::arg("rule_id"),
+		"Remove a rule. The results of the finished steps are kept.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"rule_id : int\n"
+		"    The id of the rule.\n\n"
+		"Returns\n"
+		"-------\n"
+		"bool\n"
+		"    `False` if there is no rule with the id.");
+	py_limit_engine.def("begin_step", &sv::data::LimitEngine::begin_step,
+		py::arg("name"),
+		py::call_guard<py::gil_scoped_release>(),
+		"Begin a new test step with the samples, that are appended from now on. A running step is finished "
+		"first.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"name : str\n"
+		"    The name of the step.");
+	py_limit_engine.def("end_step", &sv::data::LimitEngine::end_step,
+		py::call_guard<py::gil_scoped_release>(),
+		"Finish the running step. All samples, that were appended before the call, are checked.\n\n"
+		"Returns\n"
+		"-------\n"
+		"LimitStepResult\n"
+		"    The result of the step. It isn't `finished`, if no step was running.");
+	py_limit_engine.def("is_step_running", &sv::data::LimitEngine::is_step_running,
+		"Return `True` while a step is running.");
+	py_limit_engine.def("first_step_pos", &sv::data::LimitEngine::first_step_pos,
+		"Return the position of the oldest step, that is still stored.");
+	py_limit_engine.def("step_count", &sv::data::LimitEngine::step_count,
+		"Return the number of all steps so far, including the steps, that were already dropped.");
+	py_limit_engine.def("results", &sv::data::LimitEngine::results,
+		py::arg("first") = 0,
+		"Return the results of the stored steps, including the running step.\n\n"
 		"Parameters\n"
 		"----------\n"
-		"custom_name : str\n"
-		"    A custom name for the signal. If empty, the signal name will be automatically generated.");
-	py_base_signal.def("sample_count", &sv::data::BaseSignal::sample_count,
-		"Return the number of samples of the signal.\n\n"
+		"first : int\n"
+		"    The position of the first step, e.g. the `step_count()` of a previous call.\n\n"
 		"Returns\n"
 		"-------\n"
-		"int\n"
-		"    The number of samples.");
+		"List[LimitStepResult]\n"
+		"    The results.");
+	py_limit_engine.def("passed", &sv::data::LimitEngine::passed,
+		"Return `True` if at least one step is finished and all finished steps have passed.");
+	py_limit_engine.def("report", &sv::data::LimitEngine::report,
+		"Return the results of all stored steps as human readable text.");
+	py_limit_engine.def("clear_results", &sv::data::LimitEngine::clear_results,
+		"Drop the results of all finished steps.");
 
-	py::class_<sv::data::AnalogTimeSignal, std::shared_ptr<sv::data::AnalogTimeSignal>> py_analog_time_signal(m, "AnalogTimeSignal", py_base_signal);
-	py_analog_time_signal.doc() = "A signal with time-value pairs.";
-	py_analog_time_signal.def("get_sample", &sv::data::AnalogTimeSignal::get_sample,
-		py::arg("pos"), py::arg("relative_time"),
-		"Return the sample at the given position.\n\n"
+	py::class_<sv::data::SkewEstimator, std::shared_ptr<sv::data::SkewEstimator>> py_skew_estimator(m, "SkewEstimator");
+	py_skew_estimator.doc() = "Continuously estimates the time skew of a signal against a reference signal by the "
+		"FFT based cross-correlation of the last block of both signals.";
+	py_skew_estimator.def("reference", &sv::data::SkewEstimator::reference,
+		"Return the reference signal.");
+	py_skew_estimator.def("signal", &sv::data::SkewEstimator::signal,
+		"Return the signal, whose skew is estimated.");
+	py_skew_estimator.def("set_apply_skew", &sv::data::SkewEstimator::set_apply_skew,
+		py::arg("apply_skew"),
+		"Set if an accepted estimate is set as time skew of the signal (see `AnalogTimeSignal.set_time_skew()`). "
+		"This is on by default.\n\n"
 		"Parameters\n"
 		"----------\n"
-		"pos : int\n"
-		"    The position/number of the sample.\n"
-		"relative_time : bool\n"
-		"    When `True`, the returned timestamp is relative to the start of the SmuView session.\n\n"
+		"apply_skew : bool\n"
+		"    `True` to apply the estimates.");
+	py_skew_estimator.def("apply_skew", &sv::data::SkewEstimator::apply_skew,
+		"Return `True` if the estimates are set as time skew of the signal.");
+	py_skew_estimator.def("set_min_correlation", &sv::data::SkewEstimator::set_min_correlation,
+		py::arg("min_correlation"),
+		"Set the minimum correlation coefficient for an estimate to be accepted, 0.5 by default.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"min_correlation : float\n"
+		"    The minimum correlation coefficient.");
+	py_skew_estimator.def("min_correlation", &sv::data::SkewEstimator::min_correlation,
+		"Return the minimum correlation coefficient for an estimate to be accepted.");
+	py_skew_estimator.def("skew", &sv::data::SkewEstimator::skew,
+		"Return the last accepted skew.\n\n"
 		"Returns\n"
 		"-------\n"
-		"Tuple[float, float]\n"
-		"    The sample with 1. timestamp in milliseconds and 2. the sample value.");
-	py_analog_time_signal.def("get_last_sample", &sv::data::AnalogTimeSignal::get_last_sample,
-		py::arg("relative_time"),
-		"Return the last sample of the signal.\n\n"
+		"float\n"
+		"    The skew in seconds, positive if the signal is late. `NaN` if no estimate was accepted yet.");
+	py_skew_estimator.def("correlation", &sv::data::SkewEstimator::correlation,
+		"Return the correlation coefficient of the last accepted estimate.");
+	py_skew_estimator.def("estimate_count", &sv::data::SkewEstimator::estimate_count,
+		"Return the number of accepted estimates.");
+
+	py::class_<sv::data::CaptureWriter> py_capture_writer(m, "CaptureWriter");
+	py_capture_writer.doc() = "Writes signals to a binary capture file, also while they are acquiring.";
+	py_capture_writer.def(py::init<>());
+	py_capture_writer.def("open", &sv::data::CaptureWriter::open,
+		py::arg("file_name"), py::arg("compressed") = false,
+		"Create the capture file.\n\n"
 		"Parameters\n"
 		"----------\n"
-		"relative_time : bool\n"
-		"    When `True`, the returned timestamp is relative to the start of the SmuView session.\n\n"
+		"file_name : str\n"
+		"    The path of the capture file.\n"
+		"compressed : bool\n"
+		"    `True` to compress the samples.\n\n"
 		"Returns\n"
 		"-------\n"
-		"Tuple[float, float]\n"
-		"    The sample with 1. timestamp in milliseconds and 2. the sample value.");
-	py_analog_time_signal.def("push_sample", &sv::data::AnalogTimeSignal::push_sample,
-		py::arg("sample"), py::arg("timestamp"), py::arg("unit_size"),
-		py::arg("digits"), py::arg("decimal_places"),
-		"Push a new sample to the signal.\n\n"
+		"bool\n"
+		"    `False` if the file couldn't be created.");
+	py_capture_writer.def("close", &sv::data::CaptureWriter::close,
+		"Close the capture file.");
+	py_capture_writer.def("add_signal", &sv::data::CaptureWriter::add_signal,
+		py::arg("signal"),
+		"Write the metadata of a signal. The samples are written by `write_new_samples()`.\n\n"
 		"Parameters\n"
 		"----------\n"
-		"sample : float or double\n"
-		"    The sample value.\n"
-		"timestamp : float\n"
-		"    The absolute timestamp in milliseconds.\n"
-		"unit_size : int\n"
-		"    The size of the floating point data type (float=4, double=8) for the `sample` argument.\n"
-		"digits : int\n"
-		"    The total number of digits.\n"
-		"decimal_places : int\n"
-		"    The number of decimal places.");
+		"signal : AnalogTimeSignal\n"
+		"    The signal to record.\n\n"
+		"Returns\n"
+		"-------\n"
+		"bool\n"
+		"    `False` if writing failed.");
+	py_capture_writer.def("write_new_samples", &sv::data::CaptureWriter::write_new_samples,
+		py::call_guard<py::gil_scoped_release>(),
+		"Append the samples of all signals, that were acquired since the last call. Call this "
+		"periodically to record signals, while they are acquiring.\n\n"
+		"Returns\n"
+		"-------\n"
+		"bool\n"
+		"    `False` if writing failed.");
+	py_capture_writer.def("written_sample_count", &sv::data::CaptureWriter::written_sample_count,
+		"Return the number of written samples of all signals.");
 
-	py::class_<sv::data::AnalogSampleSignal, std::shared_ptr<sv::data::AnalogSampleSignal>> py_analog_sample_signal(m, "AnalogSampleSignal", py_base_signal);
-	py_analog_sample_signal.doc() = "A signal with key-value pairs.";
-	py_analog_sample_signal.def("get_sample", &sv::data::AnalogSampleSignal::get_sample,
-		py::arg("pos"),
-		"Return the sample for the given position.\n\n"
+	py::class_<sv::data::CaptureRecorder, std::shared_ptr<sv::data::CaptureRecorder>> py_capture_recorder(m, "CaptureRecorder");
+	py_capture_recorder.doc() = "Records signals to a capture file in a background thread.";
+	py_capture_recorder.def("set_sync_policy", &sv::data::CaptureRecorder::set_sync_policy,
+		py::arg("sync_policy"), py::arg("sync_interval") = 10.,
+		"Set when the file is forced to the disk. This can be changed while recording.\n\n"
 		"Parameters\n"
 		"----------\n"
-		"pos : int\n"
-		"    The position/number of the sample.\n\n"
+		"sync_policy : CaptureSyncPolicy\n"
+		"    The sync policy.\n"
+		"sync_interval : float\n"
+		"    The sync interval in seconds for `CaptureSyncPolicy.Periodic`.");
+	py_capture_recorder.def("stop", &sv::data::CaptureRecorder::stop,
+		py::call_guard<py::gil_scoped_release>(),
+		"Write the remaining samples and close the file.");
+	py_capture_recorder.def("is_running", &sv::data::CaptureRecorder::is_running,
+		"Return `True` while the signals are recorded.");
+	py_capture_recorder.def("has_error", &sv::data::CaptureRecorder::has_error,
+		"Return `True` if writing the file failed.");
+	py_capture_recorder.def("written_sample_count", &sv::data::CaptureRecorder::written_sample_count,
+		"Return the number of written samples of all signals.");
+
+	py::class_<sv::data::SignalStreamer, std::shared_ptr<sv::data::SignalStreamer>> py_signal_streamer(m, "SignalStreamer");
+	py_signal_streamer.doc() = "Streams signals to a network endpoint in a background thread.";
+	py_signal_streamer.def("stop", &sv::data::SignalStreamer::stop,
+		py::call_guard<py::gil_scoped_release>(),
+		"Send the remaining samples and close the connection.");
+	py_signal_streamer.def("is_running", &sv::data::SignalStreamer::is_running,
+		"Return `True` while the signals are streamed.");
+	py_signal_streamer.def("is_connected", &sv::data::SignalStreamer::is_connected,
+		"Return `True` while the streamer is connected to the endpoint.");
+	py_signal_streamer.def("sent_sample_count", &sv::data::SignalStreamer::sent_sample_count,
+		"Return the number of sent samples of all signals.");
+	py_signal_streamer.def("dropped_sample_count", &sv::data::SignalStreamer::dropped_sample_count,
+		"Return the number of samples, that were dropped from the signals by the retention policy, "
+		"before they could be sent.");
+
+	py::class_<sv::data::MetricsExporter, std::shared_ptr<sv::data::MetricsExporter>> py_metrics_exporter(m, "MetricsExporter");
+	py_metrics_exporter.doc() = "Exports the performance counters and signal values for Prometheus.";
+	py_metrics_exporter.def("stop", &sv::data::MetricsExporter::stop,
+		py::call_guard<py::gil_scoped_release>(),
+		"Stop the exporter and close the port.");
+	py_metrics_exporter.def("is_running", &sv::data::MetricsExporter::is_running,
+		"Return `True` while the exporter answers scrapes.");
+	py_metrics_exporter.def("port", &sv::data::MetricsExporter::port,
+		"Return the TCP port, that the exporter listens on.");
+	py_metrics_exporter.def("scrape_count", &sv::data::MetricsExporter::scrape_count,
+		"Return the number of answered scrapes.");
+	py_metrics_exporter.def("metrics", &sv::data::MetricsExporter::metrics,
+		"Return the metrics in the Prometheus text format, like a scrape.");
+
+	py::class_<sv::data::RemoteServer, std::shared_ptr<sv::data::RemoteServer>> py_remote_server(m, "RemoteServer");
+	py_remote_server.doc() = "Serves the signals and properties of the session to remote SmuView clients.";
+	py_remote_server.def("stop", &sv::data::RemoteServer::stop,
+		py::call_guard<py::gil_scoped_release>(),
+		"Close the connections to the clients and the port.");
+	py_remote_server.def("is_running", &sv::data::RemoteServer::is_running,
+		"Return `True` while the server accepts clients.");
+	py_remote_server.def("port", &sv::data::RemoteServer::port,
+		"Return the TCP port, that the server listens on.");
+	py_remote_server.def("client_count", &sv::data::RemoteServer::client_count,
+		"Return the number of connected clients.");
+	py_remote_server.def("sent_sample_count", &sv::data::RemoteServer::sent_sample_count,
+		"Return the number of samples, that were sent to all clients.");
+	py_remote_server.def("property_write_count", &sv::data::RemoteServer::property_write_count,
+		"Return the number of accepted property writes of the clients.");
+	py_remote_server.def("set_remote_writes_allowed", &sv::data::RemoteServer::set_remote_writes_allowed,
+		py::arg("allowed"),
+		"Allow the property writes of clients on other machines. By default, only the writes of "
+		"clients on the same machine are accepted. The protocol has no authentication, so any "
+		"client, that reaches the port, can then change the instrument settings.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"allowed : bool\n"
+		"    `True` to accept the writes of all clients.");
+	py_remote_server.def("remote_writes_allowed", &sv::data::RemoteServer::remote_writes_allowed,
+		"Return `True` if the property writes of clients on other machines are accepted.");
+
+	py::class_<sv::devices::RemoteClient, std::shared_ptr<sv::devices::RemoteClient>> py_remote_client(m, "RemoteClient");
+	py_remote_client.doc() = "Mirrors the signals of a remote SmuView server in a user device.";
+	py_remote_client.def("stop", &sv::devices::RemoteClient::stop,
+		py::call_guard<py::gil_scoped_release>(),
+		"Close the connection to the server. The mirrored signals stay in the device.");
+	py_remote_client.def("is_connected", &sv::devices::RemoteClient::is_connected,
+		"Return `True` while the client is connected to the server.");
+	py_remote_client.def("device", &sv::devices::RemoteClient::device,
+		"Return the user device with the mirrored signals.");
+	py_remote_client.def("received_sample_count", &sv::devices::RemoteClient::received_sample_count,
+		"Return the number of received samples of all signals.");
+	py_remote_client.def("properties", &sv::devices::RemoteClient::properties,
+		"Return the latest values of the properties of the remote devices.\n\n"
 		"Returns\n"
 		"-------\n"
-		"Tuple[int, float]\n"
-		"    The sample with 1. the key and 2. the sample value.");
-	py_analog_sample_signal.def("push_sample", &sv::data::AnalogSampleSignal::push_sample,
-		py::arg("sample"), py::arg("pos"), py::arg("unit_size"),
-		py::arg("digits"), py::arg("decimal_places"),
-		"Push a new sample to the signal.\n\n"
+		"Dict[str, str]\n"
+		"    The values by `\"<device>/<configurable>/<property>\"`.");
+	py_remote_client.def("set_property", &sv::devices::RemoteClient::set_property,
+		py::arg("device_name"), py::arg("configurable_name"), py::arg("property_name"), py::arg("value"),
+		py::arg("timeout") = 5.,
+		py::call_guard<py::gil_scoped_release>(),
+		"Set a property of a remote device. The server arbitrates the writes of its clients: The "
+		"client, that writes, gets the control of the devices until it releases it, disconnects or "
+		"doesn't write for 10 s. Writes of other clients are rejected meanwhile.\n\n"
 		"Parameters\n"
 		"----------\n"
-		"sample : float or double\n"
-		"    The sample value.\n"
-		"pos : int\n"
-		"    The key (position) of the new sample.\n"
-		"unit_size : int\n"
-		"    The size of the floating point data type (float=4, double=8) for the `sample` argument.\n"
-		"digits : int\n"
-		"    The total number of digits.\n"
-		"decimal_places : int\n"
-		"    The number of decimal places.");
+		"device_name : str\n"
+		"    The short name of the remote device.\n"
+		"configurable_name : str\n"
+		"    The name of the configurable.\n"
+		"property_name : str\n"
+		"    The name of the property.\n"
+		"value : str\n"
+		"    The new value, e.g. `\"1.5\"` or `\"true\"`.\n"
+		"timeout : float\n"
+		"    The time in seconds to wait for the answer.\n\n"
+		"Returns\n"
+		"-------\n"
+		"bool\n"
+		"    `True` if the server has accepted the write.");
+	py_remote_client.def("release_control", &sv::devices::RemoteClient::release_control,
+		"Release the control of the remote devices, so other clients can set properties.");
+	py_remote_client.def("get_summaries", &sv::devices::RemoteClient::get_summaries,
+		py::arg("signal"), py::arg("start_timestamp"), py::arg("end_timestamp"), py::arg("count"),
+		py::arg("timeout") = 5.,
+		py::call_guard<py::gil_scoped_release>(),
+		"Request the min/max/mean of `count` bins of a time range of a mirrored signal from the "
+		"server, including the history before the connection. Only the resolution of the bins "
+		"crosses the network.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"signal : AnalogTimeSignal\n"
+		"    The mirrored signal.\n"
+		"start_timestamp : float\n"
+		"    The absolute start timestamp of the range.\n"
+		"end_timestamp : float\n"
+		"    The absolute end timestamp of the range.\n"
+		"count : int\n"
+		"    The number of bins.\n"
+		"timeout : float\n"
+		"    The time in seconds to wait for the answer.\n\n"
+		"Returns\n"
+		"-------\n"
+		"List[AnalogSummary]\n"
+		"    The summaries of the bins with samples. Only the timestamps, min, max, mean and sample "
+		"count are set. Empty if the server didn't answer in time.");
 }
 
 void init_Configurable(py::module &m)
@@ -394,6 +2715,7 @@ void init_Configurable(py::module &m)
 		"    The name of the configurable.");
 	py_configurable.def("set_config", &sv::devices::Configurable::set_config<bool>,
 		py::arg("config_key"), py::arg("value"),
+		py::call_guard<py::gil_scoped_release>(),
 		"Set a boolean value to the given config key.\n\n"
 		"Parameters\n"
 		"----------\n"
@@ -403,6 +2725,7 @@ void init_Configurable(py::module &m)
 		"    The bool value to set.");
 	py_configurable.def("set_config", &sv::devices::Configurable::set_config<int32_t>,
 		py::arg("config_key"), py::arg("value"),
+		py::call_guard<py::gil_scoped_release>(),
 		"Set an integer value to the given config key.\n\n"
 		"Parameters\n"
 		"----------\n"
@@ -412,6 +2735,7 @@ void init_Configurable(py::module &m)
 		"    The int value to set.");
 	py_configurable.def("set_config", &sv::devices::Configurable::set_config<uint64_t>,
 		py::arg("config_key"), py::arg("value"),
+		py::call_guard<py::gil_scoped_release>(),
 		"Set an unsigned integer value to the given config key.\n\n"
 		"Parameters\n"
 		"----------\n"
@@ -421,6 +2745,7 @@ void init_Configurable(py::module &m)
 		"    The (unsigned) int value to set.");
 	py_configurable.def("set_config", &sv::devices::Configurable::set_config<double>,
 		py::arg("config_key"), py::arg("value"),
+		py::call_guard<py::gil_scoped_release>(),
 		"Set a double value to the given config key.\n\n"
 		"Parameters\n"
 		"----------\n"
@@ -430,6 +2755,7 @@ void init_Configurable(py::module &m)
 		"    The float value to set.");
 	py_configurable.def("set_config", &sv::devices::Configurable::set_config<std::string>,
 		py::arg("config_key"), py::arg("value"),
+		py::call_guard<py::gil_scoped_release>(),
 		"Set a string value to the given config key.\n\n"
 		"Parameters\n"
 		"----------\n"
@@ -439,6 +2765,7 @@ void init_Configurable(py::module &m)
 		"    The string value to set.");
 	py_configurable.def("set_config", &sv::devices::Configurable::set_measured_quantity_config,
 		py::arg("config_key"), py::arg("value"),
+		py::call_guard<py::gil_scoped_release>(),
 		"Set a measured quantity value to the given config key.\n\n"
 		"Parameters\n"
 		"----------\n"
@@ -446,8 +2773,105 @@ void init_Configurable(py::module &m)
 		"    The `ConfigKey` to set.\n"
 		"value : Tuple[Quantity, Set[QuantityFlag]]\n"
 		"    The measured quantity value to set.");
+	py_configurable.def("queue_config", &sv::devices::Configurable::queue_config<bool>,
+		py::arg("config_key"), py::arg("value"),
+		"Queue a boolean value for the given config key. The value is written "
+		"by the next call of `flush_configs()`. If the config key is already "
+		"queued, only the new value will be written.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"config_key : ConfigKey\n"
+		"    The `ConfigKey` to set.\n"
+		"value : bool\n"
+		"    The bool value to queue.");
+	py_configurable.def("queue_config", &sv::devices::Configurable::queue_config<int32_t>,
+		py::arg("config_key"), py::arg("value"),
+		"Queue an integer value for the given config key. The value is written "
+		"by the next call of `flush_configs()`. If the config key is already "
+		"queued, only the new value will be written.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"config_key : ConfigKey\n"
+		"    The `ConfigKey` to set.\n"
+		"value : int\n"
+		"    The int value to queue.");
+	py_configurable.def("queue_config", &sv::devices::Configurable::queue_config<uint64_t>,
+		py::arg("config_key"), py::arg("value"),
+		"Queue an unsigned integer value for the given config key. The value is written "
+		"by the next call of `flush_configs()`. If the config key is already "
+		"queued, only the new value will be written.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"config_key : ConfigKey\n"
+		"    The `ConfigKey` to set.\n"
+		"value : int\n"
+		"    The (unsigned) int value to queue.");
+	py_configurable.def("queue_config", &sv::devices::Configurable::queue_config<double>,
+		py::arg("config_key"), py::arg("value"),
+		"Queue a double value for the given config key. The value is written "
+		"by the next call of `flush_configs()`. If the config key is already "
+		"queued, only the new value will be written.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"config_key : ConfigKey\n"
+		"    The `ConfigKey` to set.\n"
+		"value : float\n"
+		"    The float value to queue.");
+	py_configurable.def("queue_config", &sv::devices::Configurable::queue_config<std::string>,
+		py::arg("config_key"), py::arg("value"),
+		"Queue a string value for the given config key. The value is written "
+		"by the next call of `flush_configs()`. If the config key is already "
+		"queued, only the new value will be written.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"config_key : ConfigKey\n"
+		"    The `ConfigKey` to set.\n"
+		"value : str\n"
+		"    The string value to queue.");
+	py_configurable.def("flush_configs", &sv::devices::Configurable::flush_configs,
+		py::call_guard<py::gil_scoped_release>(),
+		"Write all queued config keys back to back, in the order they were "
+		"queued.\n\n"
+		"Returns\n"
+		"-------\n"
+		"int\n"
+		"    The number of config keys that have been written.");
+	py_configurable.def("queued_config_count", &sv::devices::Configurable::queued_config_count,
+		"Return the number of queued config keys.\n\n"
+		"Returns\n"
+		"-------\n"
+		"int\n"
+		"    The number of config keys that are waiting for `flush_configs()`.");
+	py_configurable.def("get_all", &sv::python::configurable_get_all,
+		py::arg("config_keys") = py::none(),
+		"Return the values of several config keys at once. Values, that have "
+		"been cached by SmuView recently, are returned without accessing the "
+		"device. All other config keys are read back to back.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"config_keys : Optional[List[ConfigKey]]\n"
+		"    The `ConfigKey`s to get. Default is all getable config keys.\n\n"
+		"Returns\n"
+		"-------\n"
+		"Dict[ConfigKey, object]\n"
+		"    The values of the config keys. Config keys that couldn't be "
+		"read are missing.");
+	py_configurable.def("set_many", &sv::python::configurable_set_many,
+		py::arg("configs"),
+		"Write several config keys back to back, in the order of the dict. "
+		"The values must have the types of the `get_*_config()` functions, "
+		"range and rational config keys take a tuple of two values.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"configs : Dict[ConfigKey, object]\n"
+		"    The `ConfigKey`s and their values.\n\n"
+		"Returns\n"
+		"-------\n"
+		"int\n"
+		"    The number of config keys that have been written.");
 	py_configurable.def("get_bool_config", &sv::devices::Configurable::get_config<bool>,
 		py::arg("config_key"),
+		py::call_guard<py::gil_scoped_release>(),
 		"Return a boolean value from the given config key.\n\n"
 		"Parameters\n"
 		"----------\n"
@@ -459,6 +2883,7 @@ void init_Configurable(py::module &m)
 		"    The bool value of the config key.");
 	py_configurable.def("get_int_config", &sv::devices::Configurable::get_config<int32_t>,
 		py::arg("config_key"),
+		py::call_guard<py::gil_scoped_release>(),
 		"Return an integer value from the given config key.\n\n"
 		"Parameters\n"
 		"----------\n"
@@ -470,6 +2895,7 @@ void init_Configurable(py::module &m)
 		"    The int value of the config key.");
 	py_configurable.def("get_uint_config", &sv::devices::Configurable::get_config<uint64_t>,
 		py::arg("config_key"),
+		py::call_guard<py::gil_scoped_release>(),
 		"Return an unsigned integer value from the given config key.\n\n"
 		"Parameters\n"
 		"----------\n"
@@ -481,6 +2907,7 @@ void init_Configurable(py::module &m)
 		"    The (unsigned) int value of the config key.");
 	py_configurable.def("get_double_config", &sv::devices::Configurable::get_config<double>,
 		py::arg("config_key"),
+		py::call_guard<py::gil_scoped_release>(),
 		"Return a double value from the given config key.\n\n"
 		"Parameters\n"
 		"----------\n"
@@ -492,6 +2919,7 @@ void init_Configurable(py::module &m)
 		"    The float value of the config key.");
 	py_configurable.def("get_string_config", &sv::devices::Configurable::get_config<std::string>,
 		py::arg("config_key"),
+		py::call_guard<py::gil_scoped_release>(),
 		"Return a string value from the given config key.\n\n"
 		"Parameters\n"
 		"----------\n"
@@ -503,6 +2931,7 @@ void init_Configurable(py::module &m)
 		"    The string value of the config key.");
 	py_configurable.def("get_measured_quantity_config", &sv::devices::Configurable::get_measured_quantity_config,
 		py::arg("config_key"),
+		py::call_guard<py::gil_scoped_release>(),
 		"Return a measured quantity value from the given config key.\n\n"
 		"Parameters\n"
 		"----------\n"
@@ -512,6 +2941,131 @@ void init_Configurable(py::module &m)
 		"-------\n"
 		"Tuple[Quantity, Set[QuantityFlag]]\n"
 		"    The measured quantity value of the config key.");
+	py_configurable.def("set_config_async", &sv::python::set_config_async<bool>,
+		py::arg("config_key"), py::arg("value"),
+		"Set a boolean value to the given config key in the background. Returns an awaitable `asyncio.Future`, "
+		"so a coroutine can control several devices at the same time.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"config_key : ConfigKey\n"
+		"    The `ConfigKey` to set.\n"
+		"value : bool\n"
+		"    The boolean value to set.\n\n"
+		"Returns\n"
+		"-------\n"
+		"asyncio.Future\n"
+		"    The future, that is done when the value was written.");
+	py_configurable.def("set_config_async", &sv::python::set_config_async<int32_t>,
+		py::arg("config_key"), py::arg("value"),
+		"Set a integer value to the given config key in the background. Returns an awaitable `asyncio.Future`, "
+		"so a coroutine can control several devices at the same time.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"config_key : ConfigKey\n"
+		"    The `ConfigKey` to set.\n"
+		"value : int\n"
+		"    The integer value to set.\n\n"
+		"Returns\n"
+		"-------\n"
+		"asyncio.Future\n"
+		"    The future, that is done when the value was written.");
+	py_configurable.def("set_config_async", &sv::python::set_config_async<uint64_t>,
+		py::arg("config_key"), py::arg("value"),
+		"Set a unsigned integer value to the given config key in the background. Returns an awaitable `asyncio.Future`, "
+		"so a coroutine can control several devices at the same time.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"config_key : ConfigKey\n"
+		"    The `ConfigKey` to set.\n"
+		"value : int\n"
+		"    The unsigned integer value to set.\n\n"
+		"Returns\n"
+		"-------\n"
+		"asyncio.Future\n"
+		"    The future, that is done when the value was written.");
+	py_configurable.def("set_config_async", &sv::python::set_config_async<double>,
+		py::arg("config_key"), py::arg("value"),
+		"Set a double value to the given config key in the background. Returns an awaitable `asyncio.Future`, "
+		"so a coroutine can control several devices at the same time.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"config_key : ConfigKey\n"
+		"    The `ConfigKey` to set.\n"
+		"value : float\n"
+		"    The double value to set.\n\n"
+		"Returns\n"
+		"-------\n"
+		"asyncio.Future\n"
+		"    The future, that is done when the value was written.");
+	py_configurable.def("set_config_async", &sv::python::set_config_async<std::string>,
+		py::arg("config_key"), py::arg("value"),
+		"Set a string value to the given config key in the background. Returns an awaitable `asyncio.Future`, "
+		"so a coroutine can control several devices at the same time.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"config_key : ConfigKey\n"
+		"    The `ConfigKey` to set.\n"
+		"value : str\n"
+		"    The string value to set.\n\n"
+		"Returns\n"
+		"-------\n"
+		"asyncio.Future\n"
+		"    The future, that is done when the value was written.");
+	py_configurable.def("get_bool_config_async", &sv::python::get_config_async<bool>,
+		py::arg("config_key"),
+		"Return a boolean value from the given config key in the background.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"config_key : ConfigKey\n"
+		"    The `ConfigKey` to get.\n\n"
+		"Returns\n"
+		"-------\n"
+		"asyncio.Future\n"
+		"    The future with the boolean value of the config key.");
+	py_configurable.def("get_int_config_async", &sv::python::get_config_async<int32_t>,
+		py::arg("config_key"),
+		"Return a integer value from the given config key in the background.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"config_key : ConfigKey\n"
+		"    The `ConfigKey` to get.\n\n"
+		"Returns\n"
+		"-------\n"
+		"asyncio.Future\n"
+		"    The future with the integer value of the config key.");
+	py_configurable.def("get_uint_config_async", &sv::python::get_config_async<uint64_t>,
+		py::arg("config_key"),
+		"Return a unsigned integer value from the given config key in the background.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"config_key : ConfigKey\n"
+		"    The `ConfigKey` to get.\n\n"
+		"Returns\n"
+		"-------\n"
+		"asyncio.Future\n"
+		"    The future with the unsigned integer value of the config key.");
+	py_configurable.def("get_double_config_async", &sv::python::get_config_async<double>,
+		py::arg("config_key"),
+		"Return a double value from the given config key in the background.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"config_key : ConfigKey\n"
+		"    The `ConfigKey` to get.\n\n"
+		"Returns\n"
+		"-------\n"
+		"asyncio.Future\n"
+		"    The future with the double value of the config key.");
+	py_configurable.def("get_string_config_async", &sv::python::get_config_async<std::string>,
+		py::arg("config_key"),
+		"Return a string value from the given config key in the background.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"config_key : ConfigKey\n"
+		"    The `ConfigKey` to get.\n\n"
+		"Returns\n"
+		"-------\n"
+		"asyncio.Future\n"
+		"    The future with the string value of the config key.");
 	py_configurable.def("getable_configs", &sv::devices::Configurable::getable_configs,
 		"Return all getable config keys.\n\n"
 		"Returns\n"
@@ -538,6 +3092,7 @@ void init_UI(py::module &m)
 	py_ui_proxy.doc() = "Helper class for accessing the UI.";
 	py_ui_proxy.def("add_device_tab", &sv::python::UiProxy::ui_add_device_tab,
 		py::arg("device"),
+		py::call_guard<py::gil_scoped_release>(),
 		"Add a device tab with standard view for a device to the UI.\n\n"
 		"Parameters\n"
 		"----------\n"
@@ -549,6 +3104,7 @@ void init_UI(py::module &m)
 		"    The id of the new tab or empty if the tab couldn't be added.");
 	py_ui_proxy.def("add_data_view", &sv::python::UiProxy::ui_add_data_view,
 		py::arg("tab_id"), py::arg("area"), py::arg("signal"),
+		py::call_guard<py::gil_scoped_release>(),
 		"Add a data view for a signal to the given tab.\n\n"
 		"Parameters\n"
 		"----------\n"
@@ -564,6 +3120,7 @@ void init_UI(py::module &m)
 		"    The id of the new view or empty if the view couldn't be added.");
 	py_ui_proxy.def("add_control_view", &sv::python::UiProxy::ui_add_control_view,
 		py::arg("tab_id"), py::arg("area"), py::arg("configurable"),
+		py::call_guard<py::gil_scoped_release>(),
 		"Add a control view for a configurable to the given tab.\n\n"
 		"Parameters\n"
 		"----------\n"
@@ -579,6 +3136,7 @@ void init_UI(py::module &m)
 		"    The id of the new view or empty if the view couldn't be added.");
 	py_ui_proxy.def("add_time_plot_view",  &sv::python::UiProxy::ui_add_time_plot_view,
 		py::arg("tab_id"), py::arg("area"),
+		py::call_guard<py::gil_scoped_release>(),
 		"Add a time plot view to the given tab. Use "
 		"[`UiProxy.set_channel_to_time_plot_view()`](UiProxy.set_channel_to_time_plot_view) "
 		"to set a channel to the plot view or use "
@@ -599,6 +3157,7 @@ void init_UI(py::module &m)
 		"    The id of the new view or empty if the view couldn't be added.");
 	py_ui_proxy.def("add_xy_plot_view", &sv::python::UiProxy::ui_add_xy_plot_view,
 		py::arg("tab_id"), py::arg("area"),
+		py::call_guard<py::gil_scoped_release>(),
 		"Add a x/y plot view for two signals to the given tab. Use "
 		"[`UiProxy.add_curve_to_xy_plot_view()`](UiProxy.add_curve_to_xy_plot_view) "
 		"to add a new curve (a set of two signals) to the plot view.\n\n"
@@ -615,6 +3174,7 @@ void init_UI(py::module &m)
 	py_ui_proxy.def("add_power_panel_view", &sv::python::UiProxy::ui_add_power_panel_view,
 		py::arg("tab_id"), py::arg("area"), py::arg("voltage_signal"),
 		py::arg("current_signal"),
+		py::call_guard<py::gil_scoped_release>(),
 		"Add a power panel view for a voltage and a current signal to the given tab.\n\n"
 		"Parameters\n"
 		"----------\n"
@@ -634,6 +3194,7 @@ void init_UI(py::module &m)
 		(std::string (sv::python::UiProxy::*) (const std::string &, Qt::DockWidgetArea, shared_ptr<sv::channels::BaseChannel>))
 			&sv::python::UiProxy::ui_add_value_panel_view,
 		py::arg("tab_id"), py::arg("area"), py::arg("channel"),
+		py::call_guard<py::gil_scoped_release>(),
 		"Add a value panel view for a channel to the given tab.\n\n"
 		"Parameters\n"
 		"----------\n"
@@ -651,6 +3212,7 @@ void init_UI(py::module &m)
 		(std::string (sv::python::UiProxy::*) (const std::string &, Qt::DockWidgetArea, shared_ptr<sv::data::AnalogTimeSignal>))
 			&sv::python::UiProxy::ui_add_value_panel_view,
 		py::arg("tab_id"), py::arg("area"), py::arg("signal"),
+		py::call_guard<py::gil_scoped_release>(),
 		"Add a value panel view for a signal to the given tab.\n\n"
 		"Parameters\n"
 		"----------\n"
@@ -691,6 +3253,7 @@ void init_UI(py::module &m)
 		"    The channel object.");
 	py_ui_proxy.def("add_curve_to_time_plot_view", &sv::python::UiProxy::ui_add_curve_to_time_plot_view,
 		py::arg("tab_id"), py::arg("view_id"), py::arg("signal"),
+		py::call_guard<py::gil_scoped_release>(),
 		"Add a signal to the given time plot view.\n\n"
 		"Parameters\n"
 		"----------\n"
@@ -707,6 +3270,7 @@ void init_UI(py::module &m)
 	py_ui_proxy.def("add_curve_to_xy_plot_view", &sv::python::UiProxy::ui_add_curve_to_xy_plot_view,
 		py::arg("tab_id"), py::arg("view_id"), py::arg("x_signal"),
 		py::arg("y_signal"),
+		py::call_guard<py::gil_scoped_release>(),
 		"Add x/y signals to the given x/y plot view.\n\n"
 		"Parameters\n"
 		"----------\n"
@@ -722,6 +3286,45 @@ void init_UI(py::module &m)
 		"-------\n"
 		"str\n"
 		"    The id of the new curve or empty if the curve couldn't be added.");
+	py_ui_proxy.def("add_array_curve_to_plot_view", &sv::python::UiProxy::ui_add_array_curve_to_plot_view,
+		py::arg("tab_id"), py::arg("view_id"), py::arg("x_values"),
+		py::arg("y_values"), py::arg("x_quantity"), py::arg("x_quantity_flags"),
+		py::arg("x_unit"), py::arg("y_quantity"), py::arg("y_quantity_flags"),
+		py::arg("y_unit"), py::arg("name") = "",
+		"Add a curve with precomputed samples, e.g. a fit or a spectrum, to the "
+		"given time or x/y plot view. The samples are not backed by a signal, "
+		"they are copied once into the curve and are not updated or saved.\n"
+		"When the x values are sorted, only the visible samples are drawn, so "
+		"also very big arrays stay fluent.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"tab_id : str\n"
+		"    The id of the tab.\n"
+		"view_id : str\n"
+		"    The id of the plot view.\n"
+		"x_values : numpy.ndarray or List[float]\n"
+		"    The one dimensional array of the x values.\n"
+		"y_values : numpy.ndarray or List[float]\n"
+		"    The one dimensional array of the y values, with the same size as "
+		"`x_values`.\n"
+		"x_quantity : Quantity\n"
+		"    The `Quantity` of the x values.\n"
+		"x_quantity_flags : Set[QuantityFlag]\n"
+		"    The `QuantityFlag`s of the x values.\n"
+		"x_unit : Unit\n"
+		"    The `Unit` of the x values.\n"
+		"y_quantity : Quantity\n"
+		"    The `Quantity` of the y values.\n"
+		"y_quantity_flags : Set[QuantityFlag]\n"
+		"    The `QuantityFlag`s of the y values.\n"
+		"y_unit : Unit\n"
+		"    The `Unit` of the y values.\n"
+		"name : str\n"
+		"    The name of the curve. If empty (default), the y quantity is used.\n\n"
+		"Returns\n"
+		"-------\n"
+		"str\n"
+		"    The id of the new curve or empty if the curve couldn't be added.");
 	py_ui_proxy.def("set_curve_name", &sv::python::UiProxy::ui_set_curve_name,
 		py::arg("tab_id"), py::arg("view_id"), py::arg("curve_id"),
 		py::arg("name"),
@@ -750,8 +3353,52 @@ void init_UI(py::module &m)
 		"    The id of the curve.\n"
 		"color : Tuple[int, int, int]\n"
 		"    The color for the curve as a Tuple with the RGB values.");
+	py_ui_proxy.def("set_plot_update_mode", &sv::python::UiProxy::ui_set_plot_update_mode,
+		py::arg("tab_id"), py::arg("view_id"), py::arg("update_mode"),
+		"Set the update mode of a time plot view.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"tab_id : str\n"
+		"    The id of the tab.\n"
+		"view_id : str\n"
+		"    The id of the plot view.\n"
+		"update_mode : PlotUpdateMode\n"
+		"    The new update mode.");
+	py_ui_proxy.def("get_plot_profile", &sv::python::UiProxy::ui_get_plot_profile,
+		py::arg("tab_id"), py::arg("view_id"), py::arg("reset") = false,
+		"Return the statistics of the frame profiler of a plot view. The frame values (e.g. "
+		"`mean_frame_time`) are taken over the last frames, the `total_` counts since the last reset. "
+		"All times are in milliseconds.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"tab_id : str\n"
+		"    The id of the tab.\n"
+		"view_id : str\n"
+		"    The id of the plot view.\n"
+		"reset : bool\n"
+		"    When `True`, the profiler is reset after reading.\n\n"
+		"Returns\n"
+		"-------\n"
+		"Dict[str, float]\n"
+		"    The statistics or `None` if the view doesn't exist.");
+	py_ui_proxy.def("execute_batch", &sv::python::UiProxy::ui_execute_batch,
+		py::arg("batch"),
+		py::call_guard<py::gil_scoped_release>(),
+		"Execute all commands of a `UiBatch` in one pass in the user interface. This is much faster than "
+		"calling the `UiProxy` methods one by one, which wait for the user interface every time. The batch "
+		"is empty afterwards and can be reused.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"batch : UiBatch\n"
+		"    The batch with the commands.\n\n"
+		"Returns\n"
+		"-------\n"
+		"Dict[str, str]\n"
+		"    The actual ids of the tabs, views and curves for the placeholder ids, that were returned by the "
+		"batch. An id is empty if the tab, view or curve couldn't be added.");
 	py_ui_proxy.def("show_message_box", &sv::python::UiProxy::ui_show_message_box,
 		py::arg("title"), py::arg("text"),
+		py::call_guard<py::gil_scoped_release>(),
 		"Show a (info) message box with the given window title and text. "
 		"Returns `True` when the Ok button was pressed.\n\n"
 		"Parameters\n"
@@ -835,6 +3482,64 @@ void init_UI(py::module &m)
 		"-------\n"
 		"int or None\n"
 		"    The user entered integer value or `None` when the Cancel button was pressed.");
+
+	py::class_<sv::python::UiBatch> py_ui_batch(m, "UiBatch");
+	py_ui_batch.doc() = "Records UI commands, that are executed in one pass by `UiProxy.execute_batch()`. "
+		"The methods have the same parameters as the `UiProxy` methods. Methods, that add a tab, a view or a "
+		"curve, return a placeholder id, that can be used as id in the following commands of the batch.";
+	py_ui_batch.def(py::init<>());
+	py_ui_batch.def("add_device_tab", &sv::python::UiBatch::add_device_tab,
+		py::arg("device"),
+		"Add a device tab, see `UiProxy.add_device_tab()`. Returns the placeholder id of the tab.");
+	py_ui_batch.def("add_data_view", &sv::python::UiBatch::add_data_view,
+		py::arg("tab_id"), py::arg("area"), py::arg("signal"),
+		"Add a data view, see `UiProxy.add_data_view()`. Returns the placeholder id of the view.");
+	py_ui_batch.def("add_control_view", &sv::python::UiBatch::add_control_view,
+		py::arg("tab_id"), py::arg("area"), py::arg("configurable"),
+		"Add a control view, see `UiProxy.add_control_view()`. Returns the placeholder id of the view.");
+	py_ui_batch.def("add_time_plot_view", &sv::python::UiBatch::add_time_plot_view,
+		py::arg("tab_id"), py::arg("area"),
+		"Add a time plot view, see `UiProxy.add_time_plot_view()`. Returns the placeholder id of the view.");
+	py_ui_batch.def("add_xy_plot_view", &sv::python::UiBatch::add_xy_plot_view,
+		py::arg("tab_id"), py::arg("area"),
+		"Add a x/y plot view, see `UiProxy.add_xy_plot_view()`. Returns the placeholder id of the view.");
+	py_ui_batch.def("add_power_panel_view", &sv::python::UiBatch::add_power_panel_view,
+		py::arg("tab_id"), py::arg("area"), py::arg("voltage_signal"), py::arg("current_signal"),
+		"Add a power panel view, see `UiProxy.add_power_panel_view()`. Returns the placeholder id of the view.");
+	py_ui_batch.def("add_value_panel_view",
+		(std::string (sv::python::UiBatch::*) (const std::string &, Qt::DockWidgetArea, shared_ptr<sv::channels::BaseChannel>))
+			&sv::python::UiBatch::add_value_panel_view,
+		py::arg("tab_id"), py::arg("area"), py::arg("channel"),
+		"Add a value panel view for a channel, see `UiProxy.add_value_panel_view()`. Returns the placeholder "
+		"id of the view.");
+	py_ui_batch.def("add_value_panel_view",
+		(std::string (sv::python::UiBatch::*) (const std::string &, Qt::DockWidgetArea, shared_ptr<sv::data::AnalogTimeSignal>))
+			&sv::python::UiBatch::add_value_panel_view,
+		py::arg("tab_id"), py::arg("area"), py::arg("signal"),
+		"Add a value panel view for a signal, see `UiProxy.add_value_panel_view()`. Returns the placeholder "
+		"id of the view.");
+	py_ui_batch.def("add_signal_to_data_view", &sv::python::UiBatch::add_signal_to_data_view,
+		py::arg("tab_id"), py::arg("view_id"), py::arg("signal"),
+		"Add a signal to a data view, see `UiProxy.add_signal_to_data_view()`.");
+	py_ui_batch.def("set_channel_to_time_plot_view", &sv::python::UiBatch::set_channel_to_time_plot_view,
+		py::arg("tab_id"), py::arg("view_id"), py::arg("channel"),
+		"Set a channel to a time plot view, see `UiProxy.set_channel_to_time_plot_view()`.");
+	py_ui_batch.def("add_curve_to_time_plot_view", &sv::python::UiBatch::add_curve_to_time_plot_view,
+		py::arg("tab_id"), py::arg("view_id"), py::arg("signal"),
+		"Add a curve to a time plot view, see `UiProxy.add_curve_to_time_plot_view()`. Returns the placeholder "
+		"id of the curve.");
+	py_ui_batch.def("add_curve_to_xy_plot_view", &sv::python::UiBatch::add_curve_to_xy_plot_view,
+		py::arg("tab_id"), py::arg("view_id"), py::arg("x_signal"), py::arg("y_signal"),
+		"Add a curve to a x/y plot view, see `UiProxy.add_curve_to_xy_plot_view()`. Returns the placeholder "
+		"id of the curve.");
+	py_ui_batch.def("set_curve_name", &sv::python::UiBatch::set_curve_name,
+		py::arg("tab_id"), py::arg("view_id"), py::arg("curve_id"), py::arg("name"),
+		"Set the name of a curve, see `UiProxy.set_curve_name()`.");
+	py_ui_batch.def("set_curve_color", &sv::python::UiBatch::set_curve_color,
+		py::arg("tab_id"), py::arg("view_id"), py::arg("curve_id"), py::arg("color"),
+		"Set the color of a curve, see `UiProxy.set_curve_color()`.");
+	py_ui_batch.def("size", &sv::python::UiBatch::size,
+		"Return the number of recorded commands.");
 }
 
 void init_StreamBuf(py::module &m)
@@ -918,6 +3623,53 @@ void init_Enums(py::module &m)
 	py_data_type.value("Unknown", sv::data::DataType::Unknown);
 	m.attr("__pdoc__")["DataType.Unknown"] = "Unknown";
 
+	py::enum_<sv::data::ValueStorage> py_value_storage(m, "ValueStorage",
+		"Enum of all available storage types for signal values.");
+	py_value_storage.value("Double", sv::data::ValueStorage::Double);
+	m.attr("__pdoc__")["ValueStorage.Double"] = "64 bit floating point values.";
+	py_value_storage.value("Float32", sv::data::ValueStorage::Float32);
+	m.attr("__pdoc__")["ValueStorage.Float32"] = "32 bit floating point values.";
+	py_value_storage.value("ScaledInt32", sv::data::ValueStorage::ScaledInt32);
+	m.attr("__pdoc__")["ValueStorage.ScaledInt32"] = "32 bit integer values, scaled by the decimal places of the first sample.";
+
+	py::enum_<sv::data::DecimationMode> py_decimation_mode(m, "DecimationMode",
+		"Enum of all available modes for the ingest decimation of signals.");
+	py_decimation_mode.value("Off", sv::data::DecimationMode::Off);
+	m.attr("__pdoc__")["DecimationMode.Off"] = "Every sample is stored.";
+	py_decimation_mode.value("Average", sv::data::DecimationMode::Average);
+	m.attr("__pdoc__")["DecimationMode.Average"] = "Store the mean of every N samples.";
+	py_decimation_mode.value("MinMax", sv::data::DecimationMode::MinMax);
+	m.attr("__pdoc__")["DecimationMode.MinMax"] = "Store the minimum and the maximum of every N samples.";
+	py_decimation_mode.value("PickEveryN", sv::data::DecimationMode::PickEveryN);
+	m.attr("__pdoc__")["DecimationMode.PickEveryN"] = "Store the first of every N samples.";
+	py_decimation_mode.value("DeadBand", sv::data::DecimationMode::DeadBand);
+	m.attr("__pdoc__")["DecimationMode.DeadBand"] = "Only store a sample, when it leaves the tolerance band around the last stored sample.";
+	py_decimation_mode.value("SwingingDoor", sv::data::DecimationMode::SwingingDoor);
+	m.attr("__pdoc__")["DecimationMode.SwingingDoor"] = "Only store the samples, that are needed to reconstruct the signal within the tolerance (swinging door compression).";
+
+	py::enum_<sv::data::CaptureSyncPolicy> py_capture_sync_policy(m, "CaptureSyncPolicy",
+		"Enum of all available policies for syncing a recorded capture file to the disk.");
+	py_capture_sync_policy.value("Never", sv::data::CaptureSyncPolicy::Never);
+	m.attr("__pdoc__")["CaptureSyncPolicy.Never"] = "Leave it to the operating system.";
+	py_capture_sync_policy.value("EveryWrite", sv::data::CaptureSyncPolicy::EveryWrite);
+	m.attr("__pdoc__")["CaptureSyncPolicy.EveryWrite"] = "Sync after every write.";
+	py_capture_sync_policy.value("Periodic", sv::data::CaptureSyncPolicy::Periodic);
+	m.attr("__pdoc__")["CaptureSyncPolicy.Periodic"] = "Sync at most every sync interval.";
+
+	py::enum_<sv::data::StreamProtocol> py_stream_protocol(m, "StreamProtocol",
+		"Enum of all available transports for streaming signals.");
+	py_stream_protocol.value("Tcp", sv::data::StreamProtocol::Tcp);
+	m.attr("__pdoc__")["StreamProtocol.Tcp"] = "A TCP connection, that is reconnected when it is lost.";
+	py_stream_protocol.value("Udp", sv::data::StreamProtocol::Udp);
+	m.attr("__pdoc__")["StreamProtocol.Udp"] = "UDP datagrams, every datagram holds complete messages.";
+
+	py::enum_<sv::data::StreamFormat> py_stream_format(m, "StreamFormat",
+		"Enum of all available formats for streaming signals.");
+	py_stream_format.value("Binary", sv::data::StreamFormat::Binary);
+	m.attr("__pdoc__")["StreamFormat.Binary"] = "Length-prefixed little endian binary messages.";
+	py_stream_format.value("LineProtocol", sv::data::StreamFormat::LineProtocol);
+	m.attr("__pdoc__")["StreamFormat.LineProtocol"] = "The InfluxDB line protocol.";
+
 	py::enum_<sv::devices::ConfigKey> py_config_key(m, "ConfigKey",
 		"Enum of all available config keys for controlling a device.");
 	py_config_key.value("Samplerate", sv::devices::ConfigKey::Samplerate);
@@ -1322,4 +4074,89 @@ void init_Enums(py::module &m)
 	//m.attr("__pdoc__")["DockArea.AllDockAreas"] = "Dock to all dock area.";
 	//py_dock_area.value("NoDockArea", Qt::DockWidgetArea::NoDockWidgetArea);
 	//m.attr("__pdoc__")["DockArea.NoDockArea"] = "Dock to no dock area.";
+
+	py::enum_<sv::channels::MinMaxHoldType> py_min_max_hold_type(m, "MinMaxHoldType",
+		"Enum of the extreme values of a min/max hold channel.");
+	py_min_max_hold_type.value("Min", sv::channels::MinMaxHoldType::Min);
+	m.attr("__pdoc__")["MinMaxHoldType.Min"] = "Hold the minimum.";
+	py_min_max_hold_type.value("Max", sv::channels::MinMaxHoldType::Max);
+	m.attr("__pdoc__")["MinMaxHoldType.Max"] = "Hold the maximum.";
+
+	py::enum_<sv::channels::AcPowerValue> py_ac_power_value(m, "AcPowerValue",
+		"Enum of the results of an AC power channel.");
+	py_ac_power_value.value("RealPower", sv::channels::AcPowerValue::RealPower);
+	m.attr("__pdoc__")["AcPowerValue.RealPower"] = "The active power P in W.";
+	py_ac_power_value.value("ApparentPower", sv::channels::AcPowerValue::ApparentPower);
+	m.attr("__pdoc__")["AcPowerValue.ApparentPower"] = "The apparent power S = Vrms * Irms in VA.";
+	py_ac_power_value.value("ReactivePower", sv::channels::AcPowerValue::ReactivePower);
+	m.attr("__pdoc__")["AcPowerValue.ReactivePower"] = "The reactive power sqrt(S^2 - P^2) in VA, without a sign.";
+	py_ac_power_value.value("PowerFactor", sv::channels::AcPowerValue::PowerFactor);
+	m.attr("__pdoc__")["AcPowerValue.PowerFactor"] = "The power factor P / S.";
+	py_ac_power_value.value("VoltageRms", sv::channels::AcPowerValue::VoltageRms);
+	m.attr("__pdoc__")["AcPowerValue.VoltageRms"] = "The RMS of the voltage.";
+	py_ac_power_value.value("CurrentRms", sv::channels::AcPowerValue::CurrentRms);
+	m.attr("__pdoc__")["AcPowerValue.CurrentRms"] = "The RMS of the current.";
+	py_ac_power_value.value("Frequency", sv::channels::AcPowerValue::Frequency);
+	m.attr("__pdoc__")["AcPowerValue.Frequency"] = "The frequency of the voltage in Hz.";
+
+	py::enum_<sv::devices::ControlLaw> py_control_law(m, "ControlLaw",
+		"Enum of the laws of a control loop.");
+	py_control_law.value("Pid", sv::devices::ControlLaw::Pid);
+	m.attr("__pdoc__")["ControlLaw.Pid"] = "A PID controller.";
+	py_control_law.value("Expression", sv::devices::ControlLaw::Expression);
+	m.attr("__pdoc__")["ControlLaw.Expression"] = "A formula over the input, the setpoint and the last output.";
+
+	py::enum_<sv::data::CalibrationType> py_calibration_type(m, "CalibrationType",
+		"Enum of the types of a calibration curve.");
+	py_calibration_type.value("Polynomial", sv::data::CalibrationType::Polynomial);
+	m.attr("__pdoc__")["CalibrationType.Polynomial"] = "A polynomial, evaluated with the Horner scheme.";
+	py_calibration_type.value("LookupTable", sv::data::CalibrationType::LookupTable);
+	m.attr("__pdoc__")["CalibrationType.LookupTable"] = "A piecewise linear table with equidistant points.";
+
+	py::enum_<sv::channels::ResampleMethod> py_resample_method(m, "ResampleMethod",
+		"Enum of the interpolation methods of a resample channel.");
+	py_resample_method.value("Linear", sv::channels::ResampleMethod::Linear);
+	m.attr("__pdoc__")["ResampleMethod.Linear"] = "Interpolate linearly between the two neighbouring samples.";
+	py_resample_method.value("ZeroOrderHold", sv::channels::ResampleMethod::ZeroOrderHold);
+	m.attr("__pdoc__")["ResampleMethod.ZeroOrderHold"] = "Hold the value of the previous sample.";
+
+	py::enum_<sv::ui::widgets::plot::PlotUpdateMode> py_plot_update_mode(m, "PlotUpdateMode",
+		"Enum of the update modes of a time plot.");
+	py_plot_update_mode.value("Additive", sv::ui::widgets::plot::PlotUpdateMode::Additive);
+	m.attr("__pdoc__")["PlotUpdateMode.Additive"] = "Extend the time axis, when the curves reach the end.";
+	py_plot_update_mode.value("Rolling", sv::ui::widgets::plot::PlotUpdateMode::Rolling);
+	m.attr("__pdoc__")["PlotUpdateMode.Rolling"] = "Scroll the time axis with the newest samples.";
+	py_plot_update_mode.value("Oscilloscope", sv::ui::widgets::plot::PlotUpdateMode::Oscilloscope);
+	m.attr("__pdoc__")["PlotUpdateMode.Oscilloscope"] = "Restart the time axis, when the curves reach the end.";
+
+	py::enum_<sv::data::TriggerEdge> py_trigger_edge(m, "TriggerEdge",
+		"Enum of the edges of an edge trigger.");
+	py_trigger_edge.value("Rising", sv::data::TriggerEdge::Rising);
+	m.attr("__pdoc__")["TriggerEdge.Rising"] = "Trigger on rising edges.";
+	py_trigger_edge.value("Falling", sv::data::TriggerEdge::Falling);
+	m.attr("__pdoc__")["TriggerEdge.Falling"] = "Trigger on falling edges.";
+	py_trigger_edge.value("Any", sv::data::TriggerEdge::Any);
+	m.attr("__pdoc__")["TriggerEdge.Any"] = "Trigger on rising and falling edges.";
+
+	py::enum_<sv::data::TriggerEventType> py_trigger_event_type(m, "TriggerEventType",
+		"Enum of the trigger event types.");
+	py_trigger_event_type.value("RisingEdge", sv::data::TriggerEventType::RisingEdge);
+	m.attr("__pdoc__")["TriggerEventType.RisingEdge"] = "The value crossed the level upwards.";
+	py_trigger_event_type.value("FallingEdge", sv::data::TriggerEventType::FallingEdge);
+	m.attr("__pdoc__")["TriggerEventType.FallingEdge"] = "The value crossed the level downwards.";
+	py_trigger_event_type.value("LimitExceeded", sv::data::TriggerEventType::LimitExceeded);
+	m.attr("__pdoc__")["TriggerEventType.LimitExceeded"] = "The value left the limits.";
+	py_trigger_event_type.value("LimitRecovered", sv::data::TriggerEventType::LimitRecovered);
+	m.attr("__pdoc__")["TriggerEventType.LimitRecovered"] = "The value is back inside the limits.";
+	py_trigger_event_type.value("Dropout", sv::data::TriggerEventType::Dropout);
+	m.attr("__pdoc__")["TriggerEventType.Dropout"] = "No sample arrived within the timeout.";
+
+	py::enum_<sv::devices::ThreadPriority> py_thread_priority(m, "ThreadPriority",
+		"Enum of the priorities of the acquisition threads.");
+	py_thread_priority.value("Normal", sv::devices::ThreadPriority::Normal);
+	m.attr("__pdoc__")["ThreadPriority.Normal"] = "The default priority of the OS.";
+	py_thread_priority.value("High", sv::devices::ThreadPriority::High);
+	m.attr("__pdoc__")["ThreadPriority.High"] = "A raised priority within the normal scheduling.";
+	py_thread_priority.value("RealTime", sv::devices::ThreadPriority::RealTime);
+	m.attr("__pdoc__")["ThreadPriority.RealTime"] = "Real-time scheduling (`SCHED_FIFO` on Linux, MMCSS on Windows).";
 }
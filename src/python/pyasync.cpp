@@ -0,0 +1,200 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <pybind11/pybind11.h>
+
+#include "pyasync.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/devices/configurable.hpp"
+#include "src/devices/deviceutil.hpp"
+
+using std::shared_ptr;
+using std::string;
+
+namespace py = pybind11;
+
+namespace sv {
+namespace python {
+
+namespace {
+
+/**
+ * The future of an operation. The Python objects are released with the GIL
+ * held, when the result is set.
+ */
+struct AsyncState
+{
+	py::object loop;
+	py::object future;
+};
+
+/** Called in the event loop. A cancelled future is left as it is. */
+void set_future_result(py::object future, py::object result)
+{
+	if (!future.attr("done")().cast<bool>())
+		future.attr("set_result")(result);
+}
+
+void set_future_exception(py::object future, py::object exception)
+{
+	if (!future.attr("done")().cast<bool>())
+		future.attr("set_exception")(exception);
+}
+
+/**
+ * Schedule the result or the exception in the event loop. Must be called
+ * with the GIL held.
+ */
+void finish_async(AsyncState &state, py::object result, bool is_exception)
+{
+	try {
+		state.loop.attr("call_soon_threadsafe")(
+			py::cpp_function(is_exception ?
+				&set_future_exception : &set_future_result),
+			state.future, result);
+	}
+	catch (py::error_already_set &ex) {
+		// The event loop is already closed, nobody waits for the result
+		(void)ex;
+	}
+	state.future = py::object();
+	state.loop = py::object();
+}
+
+void set_async_exception(AsyncState &state, const string &what)
+{
+	py::gil_scoped_acquire acquire;
+	finish_async(state,
+		py::reinterpret_borrow<py::object>(PyExc_RuntimeError)(what), true);
+}
+
+template<typename T>
+void async_thread_proc(shared_ptr<AsyncState> state,
+	std::function<T()> function)
+{
+	try {
+		T result = function();
+		if (!Py_IsInitialized())
+			return;
+		py::gil_scoped_acquire acquire;
+		finish_async(*state, py::cast(result), false);
+	}
+	catch (std::exception &ex) {
+		if (Py_IsInitialized())
+			set_async_exception(*state, ex.what());
+	}
+}
+
+template<>
+void async_thread_proc<void>(shared_ptr<AsyncState> state,
+	std::function<void()> function)
+{
+	try {
+		function();
+		if (!Py_IsInitialized())
+			return;
+		py::gil_scoped_acquire acquire;
+		finish_async(*state, py::none(), false);
+	}
+	catch (std::exception &ex) {
+		if (Py_IsInitialized())
+			set_async_exception(*state, ex.what());
+	}
+}
+
+/**
+ * Run the function in a new thread and return the future for its result.
+ * Must be called with the GIL held.
+ */
+template<typename T>
+py::object run_async(std::function<T()> function)
+{
+	auto state = std::make_shared<AsyncState>();
+	state->loop = py::module::import("asyncio").attr("get_event_loop")();
+	state->future = state->loop.attr("create_future")();
+	py::object future = state->future;
+
+	// Device operations are rare and can block for a long time, so every
+	// operation gets its own thread instead of waiting in a pool.
+	std::thread(&async_thread_proc<T>, state, function).detach();
+	return future;
+}
+
+}
+
+template py::object set_config_async(shared_ptr<devices::Configurable>,
+	devices::ConfigKey, bool);
+template py::object set_config_async(shared_ptr<devices::Configurable>,
+	devices::ConfigKey, int32_t);
+template py::object set_config_async(shared_ptr<devices::Configurable>,
+	devices::ConfigKey, uint64_t);
+template py::object set_config_async(shared_ptr<devices::Configurable>,
+	devices::ConfigKey, double);
+template py::object set_config_async(shared_ptr<devices::Configurable>,
+	devices::ConfigKey, string);
+template<typename T>
+py::object set_config_async(shared_ptr<devices::Configurable> configurable,
+	devices::ConfigKey config_key, T value)
+{
+	return run_async<void>(std::bind(&devices::Configurable::set_config<T>,
+		configurable, config_key, value));
+}
+
+template py::object get_config_async<bool>(
+	shared_ptr<devices::Configurable>, devices::ConfigKey);
+template py::object get_config_async<int32_t>(
+	shared_ptr<devices::Configurable>, devices::ConfigKey);
+template py::object get_config_async<uint64_t>(
+	shared_ptr<devices::Configurable>, devices::ConfigKey);
+template py::object get_config_async<double>(
+	shared_ptr<devices::Configurable>, devices::ConfigKey);
+template py::object get_config_async<string>(
+	shared_ptr<devices::Configurable>, devices::ConfigKey);
+template<typename T>
+py::object get_config_async(shared_ptr<devices::Configurable> configurable,
+	devices::ConfigKey config_key)
+{
+	return run_async<T>(std::bind(&devices::Configurable::get_config<T>,
+		configurable, config_key));
+}
+
+py::object wait_for_samples_async(shared_ptr<data::AnalogTimeSignal> signal,
+	size_t count, double timeout)
+{
+	return run_async<bool>(std::bind(&data::AnalogTimeSignal::wait_for_samples,
+		signal, count, timeout));
+}
+
+py::object wait_stable_async(shared_ptr<data::AnalogTimeSignal> signal,
+	double tolerance, double duration, double timeout)
+{
+	return run_async<bool>(std::bind(&data::AnalogTimeSignal::wait_stable,
+		signal, tolerance, duration, timeout));
+}
+
+} // namespace python
+} // namespace sv
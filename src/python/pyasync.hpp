@@ -0,0 +1,82 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PYTHON_PYASYNC_HPP
+#define PYTHON_PYASYNC_HPP
+
+#include <cstddef>
+#include <memory>
+
+#include <pybind11/pybind11.h>
+
+#include "src/devices/deviceutil.hpp"
+
+namespace py = pybind11;
+
+namespace sv {
+
+namespace data {
+class AnalogTimeSignal;
+}
+namespace devices {
+class Configurable;
+}
+
+namespace python {
+
+/*
+ * asyncio integration.
+ *
+ * The functions start a blocking operation in a background thread without
+ * the GIL and return an asyncio future of the event loop of the caller. The
+ * result (or the exception) is set in the event loop, when the operation
+ * has finished. So a coroutine can await several devices at the same time,
+ * without Python threads and without polling. All functions must be called
+ * with the GIL held.
+ */
+
+/** Write the config key in the background, see Configurable::set_config(). */
+template<typename T>
+py::object set_config_async(std::shared_ptr<devices::Configurable> configurable,
+	devices::ConfigKey config_key, T value);
+
+/** Read the config key in the background, see Configurable::get_config(). */
+template<typename T>
+py::object get_config_async(std::shared_ptr<devices::Configurable> configurable,
+	devices::ConfigKey config_key);
+
+/**
+ * Wait for new samples in the background, see
+ * AnalogTimeSignal::wait_for_samples().
+ */
+py::object wait_for_samples_async(
+	std::shared_ptr<data::AnalogTimeSignal> signal,
+	size_t count, double timeout);
+
+/**
+ * Wait for a stable signal in the background, see
+ * AnalogTimeSignal::wait_stable().
+ */
+py::object wait_stable_async(std::shared_ptr<data::AnalogTimeSignal> signal,
+	double tolerance, double duration, double timeout);
+
+} // namespace python
+} // namespace sv
+
+#endif // PYTHON_PYASYNC_HPP
@@ -0,0 +1,161 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include <QDebug>
+#include <QString>
+#include <QVariant>
+
+#include "pyconfigurable.hpp"
+#include "src/data/datautil.hpp"
+#include "src/devices/configurable.hpp"
+#include "src/devices/deviceutil.hpp"
+
+using std::make_pair;
+using std::map;
+using std::pair;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+Q_DECLARE_METATYPE(sv::data::measured_quantity_t)
+Q_DECLARE_METATYPE(sv::data::rational_t)
+
+namespace py = pybind11;
+
+namespace sv {
+namespace python {
+
+namespace {
+
+py::object to_python(devices::ConfigKey config_key, const QVariant &qvar)
+{
+	switch (devices::deviceutil::get_data_type_for_config_key(config_key)) {
+	case data::DataType::Bool:
+		return py::cast(qvar.toBool());
+	case data::DataType::Int32:
+		return py::cast((int32_t)qvar.toInt());
+	case data::DataType::UInt64:
+		return py::cast((uint64_t)qvar.toULongLong());
+	case data::DataType::Double:
+		return py::cast(qvar.toDouble());
+	case data::DataType::String:
+		return py::cast(qvar.toString().toStdString());
+	case data::DataType::MQ:
+		return py::cast(qvar.value<data::measured_quantity_t>());
+	case data::DataType::DoubleRange:
+		return py::cast(qvar.value<data::double_range_t>());
+	case data::DataType::RationalPeriod:
+	case data::DataType::RationalVolt:
+	case data::DataType::UInt64Range:
+		return py::cast(qvar.value<data::rational_t>());
+	default:
+		return py::none();
+	}
+}
+
+QVariant to_qvariant(devices::ConfigKey config_key, const py::handle &value)
+{
+	switch (devices::deviceutil::get_data_type_for_config_key(config_key)) {
+	case data::DataType::Bool:
+		return QVariant(value.cast<bool>());
+	case data::DataType::Int32:
+		return QVariant(value.cast<int32_t>());
+	case data::DataType::UInt64:
+		return QVariant((qulonglong)value.cast<uint64_t>());
+	case data::DataType::Double:
+		return QVariant(value.cast<double>());
+	case data::DataType::String:
+		return QVariant(QString::fromStdString(value.cast<string>()));
+	case data::DataType::MQ:
+		return QVariant::fromValue(value.cast<data::measured_quantity_t>());
+	case data::DataType::DoubleRange:
+		return QVariant::fromValue(value.cast<data::double_range_t>());
+	case data::DataType::RationalPeriod:
+	case data::DataType::RationalVolt:
+	case data::DataType::UInt64Range:
+		return QVariant::fromValue(value.cast<data::rational_t>());
+	default:
+		return QVariant();
+	}
+}
+
+} // namespace
+
+py::dict configurable_get_all(shared_ptr<devices::Configurable> configurable,
+	py::object config_keys)
+{
+	vector<devices::ConfigKey> keys;
+	if (config_keys.is_none()) {
+		for (const auto &config_key : configurable->getable_configs())
+			keys.push_back(config_key);
+	}
+	else {
+		for (const auto &config_key : config_keys)
+			keys.push_back(config_key.cast<devices::ConfigKey>());
+	}
+
+	map<devices::ConfigKey, QVariant> values;
+	{
+		py::gil_scoped_release release;
+		values = configurable->get_configs(keys);
+	}
+
+	py::dict result;
+	for (const auto &value : values)
+		result[py::cast(value.first)] = to_python(value.first, value.second);
+	return result;
+}
+
+size_t configurable_set_many(shared_ptr<devices::Configurable> configurable,
+	const py::dict &configs)
+{
+	vector<pair<devices::ConfigKey, QVariant>> qconfigs;
+	for (const auto &config : configs) {
+		const auto config_key = config.first.cast<devices::ConfigKey>();
+		QVariant qvar;
+		try {
+			qvar = to_qvariant(config_key, config.second);
+		}
+		catch (py::cast_error &) {
+		}
+		if (!qvar.isValid()) {
+			qWarning() << "configurable_set_many(): Invalid value for " <<
+				devices::deviceutil::format_config_key(config_key);
+			continue;
+		}
+		qconfigs.push_back(make_pair(config_key, qvar));
+	}
+
+	py::gil_scoped_release release;
+	return configurable->set_configs(qconfigs);
+}
+
+} // namespace python
+} // namespace sv
@@ -0,0 +1,61 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PYTHON_PYCONFIGURABLE_HPP
+#define PYTHON_PYCONFIGURABLE_HPP
+
+#include <cstddef>
+#include <memory>
+
+#include <pybind11/pybind11.h>
+
+namespace py = pybind11;
+
+namespace sv {
+
+namespace devices {
+class Configurable;
+}
+
+namespace python {
+
+/**
+ * Return the values of the config keys as dict of ConfigKey and value, see
+ * Configurable::get_configs(). With config_keys None, all getable keys are
+ * returned. The device is accessed without the GIL.
+ */
+py::dict configurable_get_all(
+	std::shared_ptr<devices::Configurable> configurable,
+	py::object config_keys);
+
+/**
+ * Write the dict of ConfigKey and value in one go, see
+ * Configurable::set_configs(). Values, that can't be converted to the data
+ * type of their key, are skipped. The device is accessed without the GIL.
+ *
+ * @return the number of config keys that have been written.
+ */
+size_t configurable_set_many(
+	std::shared_ptr<devices::Configurable> configurable,
+	const py::dict &configs);
+
+} // namespace python
+} // namespace sv
+
+#endif // PYTHON_PYCONFIGURABLE_HPP
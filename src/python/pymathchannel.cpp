@@ -0,0 +1,184 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <QDebug>
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+
+#include "pymathchannel.hpp"
+#include "src/channels/mathchannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/datautil.hpp"
+#include "src/data/signalcombinecache.hpp"
+#include "src/devices/basedevice.hpp"
+#include "src/python/pynumpy.hpp"
+
+using std::lock_guard;
+using std::make_shared;
+using std::mutex;
+using std::set;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace python {
+
+const size_t PyMathChannel::py_block_size_ = 4096;
+
+PyMathChannel::PyMathChannel(
+		data::Quantity quantity,
+		const set<data::QuantityFlag> &quantity_flags,
+		data::Unit unit,
+		const vector<shared_ptr<data::AnalogTimeSignal>> &signals,
+		py::function function,
+		shared_ptr<devices::BaseDevice> parent_device,
+		const set<string> &channel_group_names,
+		const string &channel_name,
+		double channel_start_timestamp) :
+	channels::MathChannel(quantity, quantity_flags, unit,
+		parent_device, channel_group_names, channel_name,
+		channel_start_timestamp),
+	signals_(signals),
+	combine_cursor_(signals),
+	function_(function),
+	failed_(false),
+	timestamps_(py_block_size_),
+	data_(signals.size(), vector<double>(py_block_size_)),
+	data_ptrs_(signals.size(), nullptr),
+	results_(py_block_size_)
+{
+	assert(!signals_.empty());
+
+	for (size_t i = 0; i < data_.size(); ++i)
+		data_ptrs_[i] = data_[i].data();
+
+	digits_ = 0;
+	decimal_places_ = 0;
+	for (const auto &signal : signals_) {
+		assert(signal);
+		digits_ = std::max(digits_, signal->digits());
+		decimal_places_ = std::max(decimal_places_, signal->decimal_places());
+
+		add_source_signal(signal);
+	}
+}
+
+PyMathChannel::~PyMathChannel()
+{
+	// The reference to the function must be released with the GIL held.
+	if (Py_IsInitialized()) {
+		py::gil_scoped_acquire acquire;
+		function_ = py::function();
+	}
+	else {
+		function_.release();
+	}
+}
+
+bool PyMathChannel::evaluate_block(size_t count)
+{
+	py::gil_scoped_acquire acquire;
+	try {
+		py::tuple args(signals_.size() + 1);
+		args[0] = py::array_t<double>(count, timestamps_.data());
+		for (size_t i = 0; i < data_.size(); ++i)
+			args[i + 1] = py::array_t<double>(count, data_[i].data());
+
+		py::object result = function_(*args);
+		auto values = double_array_t::ensure(result);
+		if (!values || values.ndim() != 1 || (size_t)values.size() != count) {
+			qWarning() << "PyMathChannel::evaluate_block(): " <<
+				QString::fromStdString(name()) <<
+				": The function must return an array with" << count <<
+				"values";
+			return false;
+		}
+		std::copy(values.data(), values.data() + count, results_.data());
+	}
+	catch (py::error_already_set &ex) {
+		// Like an unhandled exception in a thread, the traceback is printed
+		// and the calculation ends.
+		qWarning() << "PyMathChannel::evaluate_block(): " << ex.what();
+		ex.restore();
+		PyErr_Print();
+		return false;
+	}
+	return true;
+}
+
+void PyMathChannel::on_sample_appended()
+{
+	if (is_suspended())
+		return;
+
+	lock_guard<mutex> lock(sample_append_mutex_);
+
+	if (failed_ || !Py_IsInitialized())
+		return;
+
+	size_t count;
+	while ((count = combine_cursor_.combine(py_block_size_,
+			timestamps_.data(), data_ptrs_.data())) > 0) {
+		if (!evaluate_block(count)) {
+			failed_ = true;
+			return;
+		}
+		// The results are pushed without the GIL, the GUI and the other
+		// math channels must not wait for the interpreter.
+		push_samples(results_.data(), timestamps_.data(), count);
+	}
+}
+
+shared_ptr<channels::MathChannel> device_add_math_channel(
+	shared_ptr<devices::BaseDevice> device,
+	const vector<shared_ptr<data::AnalogTimeSignal>> &signals,
+	py::function function, data::Quantity quantity,
+	const set<data::QuantityFlag> &quantity_flags, data::Unit unit,
+	const string &channel_name, const string &channel_group_name)
+{
+	if (signals.empty()) {
+		qWarning() << "device_add_math_channel(): No signals";
+		return nullptr;
+	}
+
+	auto channel = make_shared<PyMathChannel>(
+		quantity, quantity_flags, unit,
+		signals, function,
+		device, set<string> { channel_group_name }, channel_name,
+		signals[0]->signal_start_timestamp());
+	{
+		// Adding the channel may wait for the GUI thread.
+		py::gil_scoped_release release;
+		device->add_math_channel(channel, channel_group_name);
+	}
+
+	return channel;
+}
+
+} // namespace python
+} // namespace sv
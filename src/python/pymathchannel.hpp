@@ -0,0 +1,132 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PYTHON_PYMATHCHANNEL_HPP
+#define PYTHON_PYMATHCHANNEL_HPP
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <QObject>
+#include <pybind11/pybind11.h>
+
+#include "src/channels/mathchannel.hpp"
+#include "src/data/datautil.hpp"
+#include "src/data/signalcombinecache.hpp"
+
+using std::mutex;
+using std::set;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace py = pybind11;
+
+namespace sv {
+
+namespace data {
+class AnalogTimeSignal;
+}
+
+namespace devices {
+class BaseDevice;
+}
+
+namespace python {
+
+/**
+ * A math channel, that is calculated by a Python function over N signals.
+ *
+ * Like the channels::ExpressionChannel, the signals are merged with a
+ * data::SignalCombiner. The function is called with the timestamps and the
+ * N aligned value blocks as NumPy arrays and must return an array with one
+ * result per timestamp. The function is called in the worker thread of the
+ * channel, which holds the GIL only during the call.
+ *
+ * If the function raises an exception or returns an array of the wrong
+ * size, the traceback/warning is printed and the channel stops calculating.
+ */
+class PyMathChannel : public channels::MathChannel
+{
+	Q_OBJECT
+
+public:
+	/** Must be called with the GIL held. */
+	PyMathChannel(
+		data::Quantity quantity,
+		const set<data::QuantityFlag> &quantity_flags,
+		data::Unit unit,
+		const vector<shared_ptr<data::AnalogTimeSignal>> &signals,
+		py::function function,
+		shared_ptr<devices::BaseDevice> parent_device,
+		const set<string> &channel_group_names,
+		const string &channel_name,
+		double channel_start_timestamp);
+	~PyMathChannel();
+
+private:
+	/**
+	 * Call the function for count combined samples and store the results in
+	 * results_. Acquires the GIL.
+	 *
+	 * @return false if the function failed.
+	 */
+	bool evaluate_block(size_t count);
+
+	/**
+	 * Number of combined samples per call of the function. Much bigger than
+	 * sample_block_size_, to keep the overhead of a Python call small.
+	 */
+	static const size_t py_block_size_;
+
+	vector<shared_ptr<data::AnalogTimeSignal>> signals_;
+	data::SignalCombineCursor combine_cursor_;
+	py::function function_;
+	bool failed_;
+	vector<double> timestamps_;
+	/** One block of combined values per signal. */
+	vector<vector<double>> data_;
+	vector<double *> data_ptrs_;
+	vector<double> results_;
+	mutex sample_append_mutex_;
+
+private Q_SLOTS:
+	void on_sample_appended() override;
+
+};
+
+/**
+ * Add a new PyMathChannel to the device. Returns nullptr, if there are no
+ * signals. Must be called with the GIL held.
+ */
+shared_ptr<channels::MathChannel> device_add_math_channel(
+	shared_ptr<devices::BaseDevice> device,
+	const vector<shared_ptr<data::AnalogTimeSignal>> &signals,
+	py::function function, data::Quantity quantity,
+	const set<data::QuantityFlag> &quantity_flags, data::Unit unit,
+	const string &channel_name, const string &channel_group_name);
+
+} // namespace python
+} // namespace sv
+
+#endif // PYTHON_PYMATHCHANNEL_HPP
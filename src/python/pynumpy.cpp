@@ -0,0 +1,391 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <QDebug>
+#include <QString>
+#include <pybind11/numpy.h>
+
+#include "pynumpy.hpp"
+#include "src/channels/userchannel.hpp"
+#include "src/data/analogsegmentsignal.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/analogtimesnapshot.hpp"
+#include "src/data/signalcombiner.hpp"
+
+using std::set;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+using namespace pybind11::literals; // for the ""_a
+namespace py = pybind11;
+
+namespace sv {
+namespace python {
+
+namespace {
+
+/** The maximum number of grid points of a resampled table. */
+const size_t max_grid_size = 100000000;
+/** The number of rows, that are combined at once. */
+const size_t combine_block_size = 4096;
+
+/** Hand the vector over to a NumPy array without copying it. */
+py::array_t<double> vector_to_array(vector<double> &&values)
+{
+	vector<double> *owned = new vector<double>(std::move(values));
+	py::capsule owner(owned, [](void *p) {
+		delete static_cast<vector<double> *>(p);
+	});
+	return py::array_t<double>(
+		(py::ssize_t)owned->size(), owned->data(), owner);
+}
+
+/** Combine all samples of the signals, see SignalCombiner::combine(). */
+void combine_columns(
+	const vector<shared_ptr<data::AnalogTimeSignal>> &signals,
+	vector<vector<double>> &columns)
+{
+	data::SignalCombiner combiner(signals);
+	vector<double *> values(signals.size());
+	size_t rows = 0;
+	while (true) {
+		for (auto &column : columns)
+			column.resize(rows + combine_block_size);
+		for (size_t k = 0; k < signals.size(); ++k)
+			values[k] = columns[k + 1].data() + rows;
+		const size_t count = combiner.combine(combine_block_size,
+			columns[0].data() + rows, values.data());
+		rows += count;
+		if (count == 0)
+			break;
+	}
+	for (auto &column : columns) {
+		column.resize(rows);
+		column.shrink_to_fit();
+	}
+}
+
+/**
+ * Create the grid timestamps with the interval, from the first to the last
+ * sample of all signals. An interval <= 0 means the sample interval of the
+ * fastest signal.
+ *
+ * @return false if there is no valid grid.
+ */
+bool make_grid(const vector<shared_ptr<data::AnalogTimeSignal>> &signals,
+	double interval, vector<double> &grid)
+{
+	double first = std::numeric_limits<double>::infinity();
+	double last = -std::numeric_limits<double>::infinity();
+	double fastest_interval = std::numeric_limits<double>::infinity();
+	for (const auto &signal : signals) {
+		const size_t count = signal->retained_sample_count();
+		if (count == 0)
+			continue;
+		const double signal_first = signal->first_timestamp(false);
+		const double signal_last = signal->last_timestamp(false);
+		first = std::min(first, signal_first);
+		last = std::max(last, signal_last);
+		if (count > 1 && signal_last > signal_first) {
+			fastest_interval = std::min(fastest_interval,
+				(signal_last - signal_first) / (double)(count - 1));
+		}
+	}
+	if (first > last)
+		return true;
+
+	if (!(interval > 0.))
+		interval = fastest_interval;
+	if (!std::isfinite(interval)) {
+		qWarning() << "signals_to_dataframe(): Can't derive a grid interval";
+		return false;
+	}
+
+	// The grid points are the multiples of the interval, like in the
+	// ResampleChannel
+	const double first_index = std::ceil(first / interval);
+	const double last_index = std::floor(last / interval);
+	if (last_index < first_index)
+		return true;
+	if (last_index - first_index >= (double)max_grid_size) {
+		qWarning() << "signals_to_dataframe(): The grid has more than" <<
+			max_grid_size << "points";
+		return false;
+	}
+	const size_t count = (size_t)(last_index - first_index) + 1;
+	grid.resize(count);
+	for (size_t i = 0; i < count; ++i)
+		grid[i] = (first_index + (double)i) * interval;
+	return true;
+}
+
+/** Return the names of the signals, duplicates get a number appended. */
+vector<string> column_names(
+	const vector<shared_ptr<data::AnalogTimeSignal>> &signals)
+{
+	vector<string> names;
+	set<string> used_names{ "timestamp" };
+	for (const auto &signal : signals) {
+		const string name = signal->display_name().toStdString();
+		string unique_name = name;
+		for (int i = 2; used_names.count(unique_name) > 0; ++i)
+			unique_name = name + " (" + std::to_string(i) + ")";
+		used_names.insert(unique_name);
+		names.push_back(unique_name);
+	}
+	return names;
+}
+
+} // namespace
+
+py::array_t<double> snapshot_values(const data::AnalogTimeSnapshot &snapshot,
+	size_t pos, size_t count)
+{
+	if (pos < snapshot.first_sample_pos() || pos >= snapshot.sample_count())
+		return py::array_t<double>(0);
+	count = std::min(count, snapshot.sample_count() - pos);
+
+	size_t span_count = count;
+	const double *span = snapshot.value_span(pos, span_count);
+	if (span && span_count == count) {
+		// The base object of the array is a copy of the snapshot, so the
+		// values in the signal stay alive as long as the array.
+		py::array_t<double> values(
+			(py::ssize_t)count, span, py::cast(snapshot));
+		values.attr("setflags")("write"_a = false);
+		return values;
+	}
+
+	py::array_t<double> values((py::ssize_t)count);
+	const size_t copied = snapshot.copy_samples(
+		pos, count, false, nullptr, values.mutable_data());
+	if (copied < count)
+		return py::array_t<double>((py::ssize_t)copied, values.data());
+	return values;
+}
+
+py::tuple snapshot_sample_arrays(const data::AnalogTimeSnapshot &snapshot,
+	size_t pos, size_t count, bool relative_time)
+{
+	py::array_t<double> values = snapshot_values(snapshot, pos, count);
+	count = (size_t)values.size();
+
+	py::array_t<double> timestamps((py::ssize_t)count);
+	if (count > 0 && snapshot.copy_samples(pos, count, relative_time,
+			timestamps.mutable_data(), nullptr) < count) {
+		// The signal was cleared meanwhile
+		return py::make_tuple(py::array_t<double>(0), py::array_t<double>(0));
+	}
+	return py::make_tuple(timestamps, values);
+}
+
+py::tuple snapshot_to_numpy(const data::AnalogTimeSnapshot &snapshot,
+	bool relative_time)
+{
+	return snapshot_sample_arrays(snapshot, snapshot.first_sample_pos(),
+		snapshot.size(), relative_time);
+}
+
+py::tuple signal_to_numpy(shared_ptr<data::AnalogTimeSignal> signal,
+	bool relative_time)
+{
+	return snapshot_to_numpy(signal->snapshot(), relative_time);
+}
+
+py::object signals_to_dataframe(
+	const vector<shared_ptr<data::AnalogTimeSignal>> &signals,
+	const string &mode, py::object grid, bool relative_time)
+{
+	if (signals.empty()) {
+		qWarning() << "signals_to_dataframe(): No signals";
+		return py::none();
+	}
+	for (const auto &signal : signals) {
+		if (!signal) {
+			qWarning() << "signals_to_dataframe(): Invalid signal";
+			return py::none();
+		}
+	}
+	if (mode != "combined" && mode != "resampled") {
+		qWarning() << "signals_to_dataframe(): Unknown mode" <<
+			QString::fromStdString(mode);
+		return py::none();
+	}
+
+	// The timestamps are relative to the start of the first signal
+	const double start_timestamp = relative_time ?
+		signals.front()->signal_start_timestamp() : 0.;
+
+	// The grid array is read with the GIL held, the signals without
+	double interval = 0.;
+	vector<double> grid_timestamps;
+	bool has_grid_timestamps = false;
+	if (mode == "resampled" && !grid.is_none()) {
+		if (py::isinstance<py::float_>(grid) ||
+				py::isinstance<py::int_>(grid)) {
+			interval = grid.cast<double>();
+			if (!(interval > 0.)) {
+				qWarning() << "signals_to_dataframe(): The grid interval "
+					"must be positive";
+				return py::none();
+			}
+		}
+		else {
+			double_array_t grid_array;
+			bool is_array = true;
+			try {
+				grid_array = grid.cast<double_array_t>();
+			}
+			catch (py::cast_error &) {
+				is_array = false;
+			}
+			if (!is_array || grid_array.ndim() != 1) {
+				qWarning() << "signals_to_dataframe(): The grid must be None, "
+					"a number or a one dimensional array";
+				return py::none();
+			}
+			grid_timestamps.assign(grid_array.data(),
+				grid_array.data() + grid_array.size());
+			for (auto &timestamp : grid_timestamps)
+				timestamp += start_timestamp;
+			if (!std::is_sorted(
+					grid_timestamps.begin(), grid_timestamps.end())) {
+				qWarning() << "signals_to_dataframe(): The grid timestamps "
+					"must be ascending";
+				return py::none();
+			}
+			has_grid_timestamps = true;
+		}
+	}
+
+	vector<vector<double>> columns(signals.size() + 1);
+	bool valid = true;
+	{
+		py::gil_scoped_release release;
+		if (mode == "combined") {
+			combine_columns(signals, columns);
+		}
+		else {
+			valid = has_grid_timestamps ||
+				make_grid(signals, interval, grid_timestamps);
+			if (valid) {
+				vector<double *> values(signals.size());
+				for (size_t k = 0; k < signals.size(); ++k) {
+					columns[k + 1].resize(grid_timestamps.size());
+					values[k] = columns[k + 1].data();
+				}
+				data::SignalCombiner combiner(signals);
+				combiner.resample(grid_timestamps.data(),
+					grid_timestamps.size(), values.data());
+				columns[0] = std::move(grid_timestamps);
+			}
+		}
+		if (relative_time) {
+			for (auto &timestamp : columns[0])
+				timestamp -= start_timestamp;
+		}
+	}
+	if (!valid)
+		return py::none();
+
+	const vector<string> names = column_names(signals);
+	py::dict table;
+	table["timestamp"] = vector_to_array(std::move(columns[0]));
+	for (size_t k = 0; k < signals.size(); ++k)
+		table[py::str(names[k])] = vector_to_array(std::move(columns[k + 1]));
+
+	try {
+		py::module pandas = py::module::import("pandas");
+		return pandas.attr("DataFrame")(table);
+	}
+	catch (py::error_already_set &) {
+		// Without pandas, the columns are returned as they are
+	}
+	return std::move(table);
+}
+
+void user_channel_push_samples(channels::UserChannel &channel,
+	double_array_t values, double_array_t timestamps,
+	data::Quantity quantity, set<data::QuantityFlag> quantity_flags,
+	data::Unit unit, int digits, int decimal_places)
+{
+	if (values.ndim() != 1 || timestamps.ndim() != 1 ||
+			values.size() != timestamps.size()) {
+		qWarning() << "user_channel_push_samples(): values and timestamps "
+			"must be one dimensional arrays of the same size";
+		return;
+	}
+
+	// The arrays are kept alive by the caller, no copy is needed
+	const double *values_data = values.data();
+	const double *timestamps_data = timestamps.data();
+	const size_t count = (size_t)values.size();
+	py::gil_scoped_release release;
+	channel.push_samples(values_data, timestamps_data, count,
+		quantity, quantity_flags, unit, digits, decimal_places);
+}
+
+void user_channel_push_samples_at_rate(channels::UserChannel &channel,
+	double_array_t values, double samplerate, double timestamp,
+	data::Quantity quantity, set<data::QuantityFlag> quantity_flags,
+	data::Unit unit, int digits, int decimal_places)
+{
+	if (values.ndim() != 1) {
+		qWarning() << "user_channel_push_samples_at_rate(): values must be "
+			"a one dimensional array";
+		return;
+	}
+
+	const double *values_data = values.data();
+	const size_t count = (size_t)values.size();
+	py::gil_scoped_release release;
+	channel.push_samples(values_data, count, timestamp, samplerate,
+		quantity, quantity_flags, unit, digits, decimal_places);
+}
+
+py::array_t<double> segment_frame_values(
+	const data::AnalogSegmentSignal &signal, size_t frame_pos)
+{
+	data::AnalogFrame frame;
+	if (!signal.get_frame(frame_pos, frame))
+		return py::array_t<double>(0);
+
+	py::array_t<double> values((py::ssize_t)frame.sample_count);
+	if (signal.copy_frame_values(frame_pos, 0, frame.sample_count,
+			values.mutable_data()) < frame.sample_count) {
+		// The frame was dropped meanwhile
+		return py::array_t<double>(0);
+	}
+	return values;
+}
+
+} // namespace python
+} // namespace sv
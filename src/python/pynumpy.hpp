@@ -0,0 +1,131 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PYTHON_PYNUMPY_HPP
+#define PYTHON_PYNUMPY_HPP
+
+#include <cstddef>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <pybind11/numpy.h>
+
+#include "src/data/datautil.hpp"
+
+namespace py = pybind11;
+
+namespace sv {
+
+namespace channels {
+class UserChannel;
+}
+
+namespace data {
+class AnalogSegmentSignal;
+class AnalogTimeSignal;
+class AnalogTimeSnapshot;
+}
+
+namespace python {
+
+/**
+ * Return up to count values of the snapshot, starting at the absolute
+ * position pos, as NumPy array.
+ *
+ * If the values are stored contiguously in the signal, the array is a read
+ * only view of them, that keeps a copy of the snapshot alive. Otherwise
+ * (the range spans several chunks or the values are compressed or not
+ * stored as double) the values are copied.
+ */
+py::array_t<double> snapshot_values(const data::AnalogTimeSnapshot &snapshot,
+	size_t pos, size_t count);
+
+/**
+ * Return up to count samples of the snapshot, starting at the absolute
+ * position pos, as tuple of a timestamp and a value array. The values are
+ * returned like in snapshot_values(), the timestamps are always copied.
+ */
+py::tuple snapshot_sample_arrays(const data::AnalogTimeSnapshot &snapshot,
+	size_t pos, size_t count, bool relative_time);
+
+/** Return all samples of the snapshot, see snapshot_sample_arrays(). */
+py::tuple snapshot_to_numpy(const data::AnalogTimeSnapshot &snapshot,
+	bool relative_time);
+
+/**
+ * Return all samples, that are currently in the signal, see
+ * snapshot_sample_arrays().
+ */
+py::tuple signal_to_numpy(std::shared_ptr<data::AnalogTimeSignal> signal,
+	bool relative_time);
+
+/**
+ * Return the samples of several signals as one table, as pandas DataFrame
+ * if pandas is available, otherwise as dict of NumPy arrays. The first
+ * column "timestamp" holds the timestamps, the other columns the values of
+ * the signals, named like the signals.
+ *
+ * With mode "combined", a row is emitted for every timestamp of any signal
+ * and the other signals are interpolated, see data::SignalCombiner. With
+ * mode "resampled", all signals are interpolated on a grid: None for the
+ * sample interval of the fastest signal, a number for the interval in
+ * seconds (the grid points are multiples of it) or an array of ascending
+ * timestamps. Values outside of the samples of a signal are NaN.
+ *
+ * The table is built with the GIL released.
+ *
+ * @return None if the table can't be built.
+ */
+py::object signals_to_dataframe(
+	const std::vector<std::shared_ptr<data::AnalogTimeSignal>> &signals,
+	const std::string &mode, py::object grid, bool relative_time);
+
+/** A C contiguous NumPy array of doubles, other arrays are converted. */
+typedef py::array_t<double, py::array::c_style | py::array::forcecast>
+	double_array_t;
+
+/**
+ * Push the values with the given timestamps to the user channel, see
+ * UserChannel::push_samples(). The samples are pushed with the GIL
+ * released.
+ */
+void user_channel_push_samples(channels::UserChannel &channel,
+	double_array_t values, double_array_t timestamps,
+	data::Quantity quantity, std::set<data::QuantityFlag> quantity_flags,
+	data::Unit unit, int digits, int decimal_places);
+
+/**
+ * Push the values with a fixed samplerate to the user channel, see
+ * UserChannel::push_samples(). The samples are pushed with the GIL
+ * released.
+ */
+void user_channel_push_samples_at_rate(channels::UserChannel &channel,
+	double_array_t values, double samplerate, double timestamp,
+	data::Quantity quantity, std::set<data::QuantityFlag> quantity_flags,
+	data::Unit unit, int digits, int decimal_places);
+
+py::array_t<double> segment_frame_values(
+	const data::AnalogSegmentSignal &signal, size_t frame_pos);
+
+} // namespace python
+} // namespace sv
+
+#endif // PYTHON_PYNUMPY_HPP
@@ -17,8 +17,10 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <map>
 #include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <Python.h>
@@ -29,10 +31,22 @@
 namespace sv {
 namespace python {
 
+namespace {
+
+/** The script of a script thread, empty for all other threads. */
+thread_local std::string thread_local_script;
+
+}
+
+std::string PyStreamBuf::default_script_;
+std::mutex PyStreamBuf::mutex_;
+const size_t PyStreamBuf::max_pending_size_ = 1 << 20;
+
 PyStreamBuf::PyStreamBuf(const std::string &encoding, const std::string &errors) :
 	py_closed(false),
 	py_encoding(encoding),
-	py_errors(errors)
+	py_errors(errors),
+	pending_signaled_(false)
 {
 }
 
@@ -43,15 +57,21 @@ PyStreamBuf::~PyStreamBuf()
 
 void PyStreamBuf::py_close()
 {
-	std::lock_guard<std::mutex> lock(mutex_);
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
 
-	// output anything that is left
-	if (!string_.empty()) {
-		Q_EMIT send_string(string_);
-		string_.erase(string_.begin(), string_.end());
-	}
+		// output anything that is left
+		for (const auto &script_string : strings_) {
+			if (!script_string.second.empty()) {
+				add_pending_line(script_string.first,
+					script_string.second.data(), script_string.second.size());
+			}
+		}
+		strings_.clear();
 
-	py_closed = true;
+		py_closed = true;
+	}
+	flush_pending();
 }
 
 int PyStreamBuf::py_fileno()
@@ -65,8 +85,12 @@ void PyStreamBuf::py_flush()
 {
 	std::lock_guard<std::mutex> lock(mutex_);
 
-	Q_EMIT send_string(string_);
-	string_.erase(string_.begin(), string_.end());
+	const std::string script = current_script();
+	auto it = strings_.find(script);
+	if (it == strings_.end())
+		return;
+	add_pending_line(script, it->second.data(), it->second.size());
+	strings_.erase(it);
 }
 
 bool PyStreamBuf::py_isatty()
@@ -153,19 +177,99 @@ int PyStreamBuf::py_write(const std::string &s)
 
 	std::lock_guard<std::mutex> lock(mutex_);
 
-	string_.append(s);
-	size_t pos = 0;
-	while (pos != std::string::npos) {
-		pos = string_.find('\n');
-		if (pos != std::string::npos) {
-			std::string tmp(string_.begin(), string_.begin() + pos);
-			Q_EMIT send_string(tmp);
-			string_.erase(string_.begin(), string_.begin() + pos + 1);
-		}
+	const std::string script = current_script();
+	std::string &string = strings_[script];
+	string.append(s);
+	size_t begin = 0;
+	size_t pos;
+	while ((pos = string.find('\n', begin)) != std::string::npos) {
+		add_pending_line(script, string.data() + begin, pos - begin);
+		begin = pos + 1;
 	}
+	string.erase(0, begin);
+	// Don't keep an entry for every script, that has ever run
+	if (string.empty())
+		strings_.erase(script);
 
 	return s.size();
 }
 
+void PyStreamBuf::set_thread_script(const std::string &script)
+{
+	thread_local_script = script;
+}
+
+std::string PyStreamBuf::thread_script()
+{
+	return thread_local_script;
+}
+
+void PyStreamBuf::set_default_script(const std::string &script)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	default_script_ = script;
+}
+
+void PyStreamBuf::flush_pending()
+{
+	std::lock_guard<std::mutex> flush_lock(flush_mutex_);
+	std::map<std::string, PendingOutput> pending;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		pending.swap(pending_);
+		pending_signaled_ = false;
+	}
+
+	for (auto &script_output : pending) {
+		PendingOutput &output = script_output.second;
+		if (output.dropped_lines > 0) {
+			output.text.insert(0, "[" + std::to_string(output.dropped_lines) +
+				" lines of output dropped]\n");
+		}
+		Q_EMIT send_string(script_output.first, output.text);
+	}
+}
+
+void PyStreamBuf::add_pending_line(const std::string &script,
+	const char *line, size_t length)
+{
+	auto it = pending_.find(script);
+	if (it == pending_.end()) {
+		it = pending_.insert(
+			std::make_pair(script, PendingOutput{ "", 0, 0 })).first;
+	}
+	PendingOutput &output = it->second;
+	if (output.line_count > 0)
+		output.text += '\n';
+	output.text.append(line, length);
+	++output.line_count;
+
+	// Drop the oldest lines down to the half, so this is not repeated for
+	// every new line. A single line, that is too long, is kept.
+	if (output.text.size() > max_pending_size_) {
+		size_t begin = 0;
+		while (output.text.size() - begin > max_pending_size_ / 2) {
+			const size_t pos = output.text.find('\n', begin);
+			if (pos == std::string::npos)
+				break;
+			begin = pos + 1;
+			--output.line_count;
+			++output.dropped_lines;
+		}
+		output.text.erase(0, begin);
+	}
+
+	if (!pending_signaled_) {
+		pending_signaled_ = true;
+		Q_EMIT output_pending();
+	}
+}
+
+std::string PyStreamBuf::current_script()
+{
+	return thread_local_script.empty() ?
+		default_script_ : thread_local_script;
+}
+
 } // namespace python
 } // namespace sv
@@ -20,6 +20,7 @@
 #ifndef PYTHON_PYSTREAMBUF_H
 #define PYTHON_PYSTREAMBUF_H
 
+#include <map>
 #include <mutex>
 #include <string>
 #include <vector>
@@ -31,6 +32,17 @@ namespace python {
 
 /**
  * Buffer that writes to C++ instead of Python.
+ *
+ * All scripts share one interpreter and so one sys.stdout/sys.stderr. The
+ * output is buffered and sent per script: A script thread registers its
+ * script with set_thread_script(), the output of all other threads (e.g.
+ * threads started by a script) goes to the default script.
+ *
+ * The complete lines are not sent at once, but collected until the GUI
+ * thread calls flush_pending(). output_pending() is only emitted for the
+ * first line after a flush, so a script, that prints in a tight loop,
+ * doesn't flood the event loop with one event per line. When the pending
+ * output grows above max_pending_size_, the oldest lines are dropped.
  */
 class PyStreamBuf : public QObject
 {
@@ -83,12 +95,54 @@ public:
 	 */
 	int py_write(const std::string &s);
 
+	/** Set the script, the output of the calling thread belongs to. */
+	static void set_thread_script(const std::string &script);
+	/**
+	 * Return the script of the calling thread, empty if the thread has no
+	 * script.
+	 */
+	static std::string thread_script();
+	/** Set the script for the output of threads without a script. */
+	static void set_default_script(const std::string &script);
+
+	/**
+	 * Send the pending lines of all scripts, one send_string() per script.
+	 * The lines are separated by '\n', without a trailing '\n'.
+	 */
+	void flush_pending();
+
 private:
-	std::string string_;
-	std::mutex mutex_;
+	struct PendingOutput
+	{
+		std::string text;
+		size_t line_count;
+		size_t dropped_lines;
+	};
+
+	/** Return the script of the calling thread, mutex_ must be locked. */
+	static std::string current_script();
+	/** Add a complete line to the pending output, mutex_ must be locked. */
+	void add_pending_line(const std::string &script, const char *line,
+		size_t length);
+
+	/** The pending output of a script is limited to this many bytes. */
+	static const size_t max_pending_size_;
+
+	/** The incomplete lines of the scripts. */
+	std::map<std::string, std::string> strings_;
+	/** The complete lines, that are not sent yet. */
+	std::map<std::string, PendingOutput> pending_;
+	/** True if output_pending() was emitted since the last flush. */
+	bool pending_signaled_;
+	/** Keeps the order of the lines, when two threads flush. */
+	std::mutex flush_mutex_;
+	static std::string default_script_;
+	static std::mutex mutex_;
 
 Q_SIGNALS:
-	void send_string(const std::string &text);
+	void send_string(const std::string &script, const std::string &text);
+	/** New output is pending, flush_pending() should be called soon. */
+	void output_pending();
 
 };
 
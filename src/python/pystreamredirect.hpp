@@ -31,7 +31,6 @@
 #include "src/python/pystreambuf.hpp"
 #include "src/python/smuscriptrunner.hpp"
 
-using std::shared_ptr;
 using std::string;
 
 namespace py = pybind11;
@@ -44,7 +43,7 @@ class __attribute__((visibility("hidden"))) PyStreamRedirect : public QObject
 	Q_OBJECT
 
 public:
-    explicit PyStreamRedirect(shared_ptr<SmuScriptRunner> script_runner) :
+    explicit PyStreamRedirect(SmuScriptRunner *script_runner) :
 		script_runner_(script_runner)
 	{
 		auto sys_module = py::module::import("sys");
@@ -60,7 +59,9 @@ public:
 		auto py_stdout_buf = py::cast(
 			stdout_buf_, py::return_value_policy::reference);
 		connect(stdout_buf_, &PyStreamBuf::send_string,
-			script_runner_.get(), &SmuScriptRunner::send_py_stdout);
+			script_runner_, &SmuScriptRunner::send_py_stdout);
+		connect(stdout_buf_, &PyStreamBuf::output_pending,
+			script_runner_, &SmuScriptRunner::on_output_pending);
 
 		stderr_buf_ = new PyStreamBuf(
 			py::str(py::getattr(old_stderr_, "encoding", default_encoding)),
@@ -68,7 +69,9 @@ public:
 		auto py_stderr_buf = py::cast(
 			stderr_buf_, py::return_value_policy::reference);
 		connect(stderr_buf_, &PyStreamBuf::send_string,
-			script_runner_.get(), &SmuScriptRunner::send_py_stderr);
+			script_runner_, &SmuScriptRunner::send_py_stderr);
+		connect(stderr_buf_, &PyStreamBuf::output_pending,
+			script_runner_, &SmuScriptRunner::on_output_pending);
 
 		sys_module.attr("stdout") = py_stdout_buf;
 		sys_module.attr("stderr") = py_stderr_buf;
@@ -87,13 +90,24 @@ public:
 		stderr_buf_->py_close();
 
 		disconnect(stdout_buf_, &PyStreamBuf::send_string,
-			script_runner_.get(), &SmuScriptRunner::send_py_stdout);
+			script_runner_, &SmuScriptRunner::send_py_stdout);
 		disconnect(stderr_buf_, &PyStreamBuf::send_string,
-			script_runner_.get(), &SmuScriptRunner::send_py_stderr);
+			script_runner_, &SmuScriptRunner::send_py_stderr);
+		disconnect(stdout_buf_, &PyStreamBuf::output_pending,
+			script_runner_, &SmuScriptRunner::on_output_pending);
+		disconnect(stderr_buf_, &PyStreamBuf::output_pending,
+			script_runner_, &SmuScriptRunner::on_output_pending);
+	}
+
+	/** Send the pending output of stdout and then of stderr. */
+	void flush()
+	{
+		stdout_buf_->flush_pending();
+		stderr_buf_->flush_pending();
 	}
 
 private:
-	shared_ptr<SmuScriptRunner> script_runner_;
+	SmuScriptRunner *script_runner_;
 	py::object old_stdout_;
 	py::object old_stderr_;
 	PyStreamBuf *stdout_buf_;
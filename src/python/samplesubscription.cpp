@@ -0,0 +1,234 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <QDebug>
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+
+#include "samplesubscription.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/analogtimesnapshot.hpp"
+#include "src/data/samplebus.hpp"
+#include "src/python/pynumpy.hpp"
+#include "src/python/pystreambuf.hpp"
+
+using std::lock_guard;
+using std::make_shared;
+using std::mutex;
+using std::shared_ptr;
+using std::unique_lock;
+using std::unique_ptr;
+
+namespace py = pybind11;
+
+namespace sv {
+namespace python {
+
+const size_t SampleSubscription::max_batch_samples_ = 1 << 16;
+
+SampleSubscription::SampleSubscription(
+		shared_ptr<data::AnalogTimeSignal> signal,
+		py::function callback, size_t min_batch, double max_latency) :
+	state_(make_shared<State>())
+{
+	state_->signal = signal;
+	state_->callback = callback;
+	state_->min_batch = std::max(min_batch, (size_t)1);
+	state_->max_latency = std::chrono::duration_cast<
+		std::chrono::steady_clock::duration>(
+			std::chrono::duration<double>(std::max(max_latency, 0.)));
+	state_->script = PyStreamBuf::thread_script();
+	state_->end_pos = signal->sample_count();
+	state_->cleared = false;
+	state_->stop = false;
+	state_->running = true;
+	state_->delivered_sample_count = 0;
+	state_->dropped_sample_count = 0;
+
+	// The notifications are coalesced by the signal and received inline in
+	// its thread. They only wake up the delivery thread.
+	shared_ptr<State> state = state_;
+	bus_subscription_ = signal->subscribe_samples(
+		[state](size_t, size_t last) {
+			{
+				lock_guard<mutex> lock(state->mutex);
+				state->end_pos = std::max(state->end_pos, last);
+			}
+			state->cond.notify_one();
+		},
+		[state]() {
+			{
+				lock_guard<mutex> lock(state->mutex);
+				state->end_pos = 0;
+				state->cleared = true;
+			}
+			state->cond.notify_one();
+		},
+		data::SampleExecutor::Inline);
+
+	thread_ = std::thread(&SampleSubscription::thread_proc,
+		state_, state_->end_pos);
+}
+
+SampleSubscription::~SampleSubscription()
+{
+	stop();
+	if (thread_.joinable()) {
+		// Deleted by the own function, the thread ends after the call
+		thread_.detach();
+	}
+}
+
+void SampleSubscription::stop()
+{
+	bus_subscription_->unsubscribe();
+	{
+		lock_guard<mutex> lock(state_->mutex);
+		state_->stop = true;
+	}
+	state_->cond.notify_one();
+
+	if (!thread_.joinable() || thread_.get_id() == std::this_thread::get_id())
+		return;
+	// The thread needs the GIL to finish a running call of the function
+	py::gil_scoped_release release;
+	thread_.join();
+}
+
+bool SampleSubscription::is_running() const
+{
+	return state_->running;
+}
+
+size_t SampleSubscription::delivered_sample_count() const
+{
+	return state_->delivered_sample_count;
+}
+
+size_t SampleSubscription::dropped_sample_count() const
+{
+	return state_->dropped_sample_count;
+}
+
+void SampleSubscription::thread_proc(shared_ptr<State> state, size_t next_pos)
+{
+	PyStreamBuf::set_thread_script(state->script);
+
+	while (true) {
+		size_t end_pos;
+		{
+			unique_lock<mutex> lock(state->mutex);
+			auto deadline = std::chrono::steady_clock::time_point::max();
+			while (!state->stop) {
+				if (state->cleared) {
+					state->cleared = false;
+					next_pos = state->signal->first_sample_pos();
+				}
+				const size_t pending =
+					state->end_pos > next_pos ? state->end_pos - next_pos : 0;
+				if (pending >= state->min_batch)
+					break;
+				if (pending == 0) {
+					state->cond.wait(lock);
+					continue;
+				}
+				// The latency is counted from the first notification of the
+				// pending samples.
+				const auto now = std::chrono::steady_clock::now();
+				if (deadline == std::chrono::steady_clock::time_point::max())
+					deadline = now + state->max_latency;
+				if (now >= deadline)
+					break;
+				state->cond.wait_until(lock, deadline);
+			}
+			if (state->stop)
+				break;
+			end_pos = state->end_pos;
+		}
+
+		if (!deliver(*state, next_pos, end_pos))
+			break;
+	}
+
+	// The function must be released with the GIL held, the subscription
+	// may already be deleted.
+	py::gil_scoped_acquire acquire;
+	state->callback = py::function();
+	state->running = false;
+}
+
+bool SampleSubscription::deliver(State &state, size_t &next_pos, size_t end_pos)
+{
+	// The snapshot keeps the samples from being dropped while delivering
+	const auto snapshot = state.signal->snapshot();
+	if (next_pos < snapshot.first_sample_pos()) {
+		state.dropped_sample_count += snapshot.first_sample_pos() - next_pos;
+		next_pos = snapshot.first_sample_pos();
+	}
+	end_pos = std::min(end_pos, snapshot.sample_count());
+
+	while (next_pos < end_pos) {
+		const size_t count = std::min(end_pos - next_pos, max_batch_samples_);
+
+		py::gil_scoped_acquire acquire;
+		{
+			lock_guard<mutex> lock(state.mutex);
+			if (state.stop)
+				return true;
+		}
+		try {
+			py::tuple arrays =
+				snapshot_sample_arrays(snapshot, next_pos, count, false);
+			const size_t copied = (size_t)py::len(arrays[0]);
+			if (copied == 0)
+				return true; // The signal was cleared meanwhile
+			state.callback(arrays[0], arrays[1]);
+			next_pos += copied;
+			state.delivered_sample_count += copied;
+		}
+		catch (py::error_already_set &ex) {
+			// Like an unhandled exception in a thread, the traceback is
+			// printed and the delivery ends.
+			qWarning() << "SampleSubscription::deliver(): " << ex.what();
+			ex.restore();
+			PyErr_Print();
+			return false;
+		}
+	}
+	return true;
+}
+
+unique_ptr<SampleSubscription> signal_on_samples(
+	shared_ptr<data::AnalogTimeSignal> signal, py::function callback,
+	size_t min_batch, double max_latency)
+{
+	return unique_ptr<SampleSubscription>(new SampleSubscription(
+		signal, callback, min_batch, max_latency));
+}
+
+} // namespace python
+} // namespace sv
@@ -0,0 +1,145 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PYTHON_SAMPLESUBSCRIPTION_HPP
+#define PYTHON_SAMPLESUBSCRIPTION_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <pybind11/pybind11.h>
+
+using std::shared_ptr;
+using std::unique_ptr;
+
+namespace py = pybind11;
+
+namespace sv {
+
+namespace data {
+class AnalogTimeSignal;
+class SampleBusSubscription;
+}
+
+namespace python {
+
+/**
+ * Calls a Python function with the samples, that are appended to a signal.
+ *
+ * The appended samples are collected in C++ and delivered in batches by a
+ * background thread: The function is called with the timestamps and the
+ * values as NumPy arrays, when min_batch samples are pending or when the
+ * oldest pending sample has waited max_latency seconds. The thread holds
+ * the GIL only while the function is called, so the script itself keeps
+ * running (e.g. in time.sleep()) and no polling is needed.
+ *
+ * Samples, that are dropped by the retention policy before they could be
+ * delivered, are skipped and counted, see dropped_sample_count().
+ */
+class SampleSubscription
+{
+public:
+	/**
+	 * Start the delivery of the samples, that are appended from now on.
+	 * Must be called with the GIL held.
+	 */
+	SampleSubscription(shared_ptr<data::AnalogTimeSignal> signal,
+		py::function callback, size_t min_batch, double max_latency);
+	/** Stops the delivery, must be called with the GIL held. */
+	~SampleSubscription();
+
+	SampleSubscription(const SampleSubscription &) = delete;
+	SampleSubscription &operator=(const SampleSubscription &) = delete;
+
+	/**
+	 * Stop the delivery. A running call of the function is finished first.
+	 * Must be called with the GIL held, the GIL is released while waiting.
+	 */
+	void stop();
+	bool is_running() const;
+
+	/** Return the number of samples, that were passed to the function. */
+	size_t delivered_sample_count() const;
+	/** Return the number of samples, that were dropped before delivery. */
+	size_t dropped_sample_count() const;
+
+private:
+	/**
+	 * The state of the delivery. It is shared with the bus subscription
+	 * and the thread, so it can outlive the subscription, e.g. when the
+	 * subscription is deleted by its own function.
+	 */
+	struct State
+	{
+		shared_ptr<data::AnalogTimeSignal> signal;
+		py::function callback;
+		size_t min_batch;
+		std::chrono::steady_clock::duration max_latency;
+		/** The script, that gets the output of the function. */
+		std::string script;
+
+		/** Guards end_pos, cleared and stop. */
+		std::mutex mutex;
+		std::condition_variable cond;
+		/** The end of the notified samples. */
+		size_t end_pos;
+		bool cleared;
+		bool stop;
+
+		std::atomic<bool> running;
+		std::atomic<size_t> delivered_sample_count;
+		std::atomic<size_t> dropped_sample_count;
+	};
+
+	static void thread_proc(shared_ptr<State> state, size_t next_pos);
+	/**
+	 * Deliver the samples [next_pos, end_pos) in batches of at most
+	 * max_batch_samples_ samples.
+	 *
+	 * @return false if the function raised an exception.
+	 */
+	static bool deliver(State &state, size_t &next_pos, size_t end_pos);
+
+	/** The maximum number of samples, that are passed in one call. */
+	static const size_t max_batch_samples_;
+
+	shared_ptr<State> state_;
+	std::thread thread_;
+	unique_ptr<data::SampleBusSubscription> bus_subscription_;
+
+};
+
+/**
+ * Return a new subscription for the appended samples of the signal, see
+ * SampleSubscription.
+ */
+std::unique_ptr<SampleSubscription> signal_on_samples(
+	shared_ptr<data::AnalogTimeSignal> signal, py::function callback,
+	size_t min_batch, double max_latency);
+
+} // namespace python
+} // namespace sv
+
+#endif // PYTHON_SAMPLESUBSCRIPTION_HPP
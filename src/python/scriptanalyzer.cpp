@@ -0,0 +1,677 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <QString>
+
+#include "scriptanalyzer.hpp"
+
+using std::lock_guard;
+using std::make_shared;
+using std::set;
+using std::shared_ptr;
+using std::string;
+using std::u16string;
+using std::unique_lock;
+using std::vector;
+
+namespace sv {
+namespace python {
+
+namespace {
+
+bool is_ident_start(char16_t c)
+{
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' ||
+		c >= 0x80;
+}
+
+bool is_digit(char16_t c)
+{
+	return c >= '0' && c <= '9';
+}
+
+bool is_ident_char(char16_t c)
+{
+	return is_ident_start(c) || is_digit(c);
+}
+
+bool is_space(char16_t c)
+{
+	return c == ' ' || c == '\t' || c == '\f' || c == '\r';
+}
+
+const set<u16string> &keywords()
+{
+	static const set<u16string> keywords {
+		u"and", u"as", u"assert", u"async", u"await", u"break", u"class",
+		u"continue", u"def", u"del", u"elif", u"else", u"except",
+		u"finally", u"for", u"from", u"global", u"if", u"import", u"in",
+		u"is", u"lambda", u"nonlocal", u"not", u"or", u"pass", u"raise",
+		u"return", u"try", u"while", u"with", u"yield" };
+	return keywords;
+}
+
+const set<u16string> &constants()
+{
+	static const set<u16string> constants {
+		u"True", u"False", u"None", u"bool", u"bytes", u"complex", u"dict",
+		u"float", u"int", u"list", u"object", u"set", u"str", u"tuple" };
+	return constants;
+}
+
+const set<u16string> &builtins()
+{
+	static const set<u16string> builtins {
+		u"abs", u"all", u"any", u"bin", u"chr", u"dir", u"divmod",
+		u"enumerate", u"filter", u"format", u"getattr", u"hasattr", u"hex",
+		u"id", u"input", u"isinstance", u"iter", u"len", u"map", u"max",
+		u"min", u"next", u"oct", u"open", u"ord", u"pow", u"print",
+		u"range", u"repr", u"reversed", u"round", u"setattr", u"sorted",
+		u"sum", u"super", u"type", u"zip" };
+	return builtins;
+}
+
+/** The statements, that need a colon and an indented block. */
+const set<u16string> &block_keywords()
+{
+	static const set<u16string> block_keywords {
+		u"class", u"def", u"elif", u"else", u"except", u"finally", u"for",
+		u"if", u"try", u"while", u"with" };
+	return block_keywords;
+}
+
+bool is_string_prefix(const u16string &word)
+{
+	if (word.size() > 2)
+		return false;
+	for (const char16_t c : word) {
+		if (c != 'r' && c != 'R' && c != 'b' && c != 'B' && c != 'u' &&
+				c != 'U' && c != 'f' && c != 'F')
+			return false;
+	}
+	return true;
+}
+
+string to_string(char16_t c)
+{
+	return string(1, (char)c);
+}
+
+/**
+ * A tokenizer for Python, that works line by line like the tokenizer of
+ * CPython. Only the tokens, that are highlighted or needed for the checks,
+ * are recognized.
+ */
+class Lexer
+{
+public:
+	Lexer(const u16string &text, ScriptAnalysis &analysis) :
+		text_(text),
+		analysis_(analysis),
+		line_(0),
+		line_begin_(0),
+		string_state_(StringState::None),
+		string_quote_(0),
+		string_line_(0),
+		string_column_(0),
+		in_logical_line_(false),
+		continuation_(false),
+		token_count_(0),
+		has_colon_(false),
+		ends_with_colon_(false),
+		last_token_line_(0),
+		last_token_column_(0),
+		last_token_length_(0),
+		after_def_(false),
+		after_class_(false),
+		expect_indent_(false),
+		colon_line_(0),
+		indents_{ 0 },
+		alt_indents_{ 0 }
+	{
+	}
+
+	void run()
+	{
+		analysis_.lines.clear();
+		analysis_.issues.clear();
+
+		size_t begin = 0;
+		while (true) {
+			size_t end = text_.find(u'\n', begin);
+			const bool last = end == u16string::npos;
+			if (last)
+				end = text_.size();
+			analysis_.lines.emplace_back();
+			line_begin_ = begin;
+			process_line(begin, end);
+			if (last)
+				break;
+			begin = end + 1;
+			++line_;
+		}
+		finish();
+	}
+
+private:
+	enum class StringState {
+		None,
+		Single,
+		Triple
+	};
+
+	struct Bracket
+	{
+		char16_t c;
+		int line;
+		int column;
+	};
+
+	int column(size_t pos) const
+	{
+		return (int)(pos - line_begin_);
+	}
+
+	void add_range(ScriptTokenType type, size_t begin, size_t end)
+	{
+		if (end > begin)
+			analysis_.lines.back().push_back(ScriptFormatRange{
+				column(begin), (int)(end - begin), type });
+	}
+
+	void add_issue(ScriptIssueSeverity severity, int line, int column,
+		int length, const string &message)
+	{
+		if (analysis_.issues.size() < ScriptAnalyzer::max_issue_count)
+			analysis_.issues.push_back(ScriptIssue{
+				severity, line, column, std::max(length, 1), message });
+	}
+
+	void add_error(int line, int column, int length, const string &message)
+	{
+		add_issue(ScriptIssueSeverity::Error, line, column, length, message);
+	}
+
+	void set_last_token(size_t begin, size_t end)
+	{
+		last_token_line_ = line_;
+		last_token_column_ = column(begin);
+		last_token_length_ = (int)(end - begin);
+		ends_with_colon_ = false;
+		++token_count_;
+	}
+
+	void process_line(size_t begin, size_t end)
+	{
+		size_t pos = begin;
+		const bool continued = continuation_;
+		continuation_ = false;
+
+		if (string_state_ != StringState::None) {
+			pos = scan_string_body(begin, end, begin);
+			if (string_state_ != StringState::None)
+				return;
+		}
+		else if (!in_logical_line_ && !continued) {
+			// The indentation of a new logical line
+			int indent = 0;
+			int alt_indent = 0;
+			while (pos < end && is_space(text_[pos])) {
+				if (text_[pos] == '\t')
+					indent = (indent / 8 + 1) * 8;
+				else if (text_[pos] == ' ')
+					++indent;
+				if (text_[pos] != '\r' && text_[pos] != '\f')
+					++alt_indent;
+				++pos;
+			}
+			// Blank lines and comment lines don't count
+			if (pos == end)
+				return;
+			if (text_[pos] != '#') {
+				check_indentation(indent, alt_indent, column(pos));
+				in_logical_line_ = true;
+				token_count_ = 0;
+			}
+		}
+
+		scan_tokens(pos, end);
+
+		if (string_state_ == StringState::None && brackets_.empty() &&
+				!continuation_ && in_logical_line_)
+			finish_logical_line();
+	}
+
+	void scan_tokens(size_t pos, size_t end)
+	{
+		while (pos < end) {
+			const char16_t c = text_[pos];
+			if (is_space(c)) {
+				++pos;
+			}
+			else if (c == '#') {
+				add_range(ScriptTokenType::Comment, pos, end);
+				pos = end;
+			}
+			else if (c == '\\') {
+				size_t next = pos + 1;
+				while (next < end && is_space(text_[next]))
+					++next;
+				if (next == end)
+					continuation_ = true;
+				else
+					add_error(line_, column(pos), 1, "unexpected character "
+						"after line continuation character");
+				pos = next;
+			}
+			else if (is_ident_start(c)) {
+				pos = scan_word(pos, end);
+			}
+			else if (is_digit(c) ||
+					(c == '.' && pos + 1 < end && is_digit(text_[pos + 1]))) {
+				pos = scan_number(pos, end);
+			}
+			else if (c == '"' || c == '\'') {
+				pos = scan_string(pos, pos, end);
+			}
+			else if (c == '@' && token_count_ == 0) {
+				size_t next = pos + 1;
+				while (next < end &&
+						(is_ident_char(text_[next]) || text_[next] == '.'))
+					++next;
+				add_range(ScriptTokenType::Decorator, pos, next);
+				set_last_token(pos, next);
+				pos = next;
+			}
+			else if (c == '(' || c == '[' || c == '{') {
+				brackets_.push_back(Bracket{ c, line_, column(pos) });
+				set_last_token(pos, pos + 1);
+				++pos;
+			}
+			else if (c == ')' || c == ']' || c == '}') {
+				close_bracket(c, pos);
+				set_last_token(pos, pos + 1);
+				++pos;
+			}
+			else if (c == ':' && pos + 1 < end && text_[pos + 1] == '=') {
+				set_last_token(pos, pos + 2);
+				pos += 2;
+			}
+			else if (c == ':') {
+				set_last_token(pos, pos + 1);
+				if (brackets_.empty()) {
+					has_colon_ = true;
+					ends_with_colon_ = true;
+					colon_line_ = line_;
+				}
+				++pos;
+			}
+			else {
+				set_last_token(pos, pos + 1);
+				++pos;
+			}
+		}
+	}
+
+	size_t scan_word(size_t pos, size_t end)
+	{
+		size_t next = pos + 1;
+		while (next < end && is_ident_char(text_[next]))
+			++next;
+		const u16string word = text_.substr(pos, next - pos);
+		if (next < end && (text_[next] == '"' || text_[next] == '\'') &&
+				is_string_prefix(word))
+			return scan_string(pos, next, end);
+
+		// The statement of "async def", "async for" and "async with"
+		if (token_count_ == 0 || (token_count_ == 1 && first_word_ == u"async"))
+			first_word_ = word;
+
+		size_t after = next;
+		while (after < end && is_space(text_[after]))
+			++after;
+		if (after_def_) {
+			add_range(ScriptTokenType::Function, pos, next);
+		}
+		else if (after_class_) {
+			add_range(ScriptTokenType::ClassName, pos, next);
+		}
+		else if (keywords().count(word)) {
+			add_range(ScriptTokenType::Keyword, pos, next);
+		}
+		else if (constants().count(word)) {
+			add_range(ScriptTokenType::Constant, pos, next);
+		}
+		else if (builtins().count(word)) {
+			add_range(ScriptTokenType::Builtin, pos, next);
+		}
+		else if (after < end && text_[after] == '(') {
+			add_range(ScriptTokenType::Function, pos, next);
+		}
+		after_def_ = word == u"def";
+		after_class_ = word == u"class";
+		set_last_token(pos, next);
+		return next;
+	}
+
+	size_t scan_number(size_t pos, size_t end)
+	{
+		const bool hex = text_[pos] == '0' && pos + 1 < end &&
+			(text_[pos + 1] == 'x' || text_[pos + 1] == 'X');
+		size_t next = pos + 1;
+		while (next < end) {
+			const char16_t c = text_[next];
+			const char16_t prev = text_[next - 1];
+			if (is_ident_char(c) || c == '.' || ((c == '+' || c == '-') &&
+					!hex && (prev == 'e' || prev == 'E')))
+				++next;
+			else
+				break;
+		}
+		add_range(ScriptTokenType::Number, pos, next);
+		set_last_token(pos, next);
+		return next;
+	}
+
+	/** Scan a string literal with its prefix, that starts at begin. */
+	size_t scan_string(size_t begin, size_t quote_pos, size_t end)
+	{
+		const char16_t quote = text_[quote_pos];
+		const bool triple = quote_pos + 2 < end &&
+			text_[quote_pos + 1] == quote && text_[quote_pos + 2] == quote;
+		string_state_ = triple ? StringState::Triple : StringState::Single;
+		string_quote_ = quote;
+		string_line_ = line_;
+		string_column_ = column(begin);
+		set_last_token(begin, quote_pos + 1);
+		return scan_string_body(quote_pos + (triple ? 3 : 1), end, begin);
+	}
+
+	/**
+	 * Scan the rest of a string from pos on. The string is highlighted from
+	 * range_begin.
+	 */
+	size_t scan_string_body(size_t pos, size_t end, size_t range_begin)
+	{
+		bool escaped_end = false;
+		bool closed = false;
+		while (pos < end) {
+			const char16_t c = text_[pos];
+			if (c == '\\') {
+				if (pos + 1 >= end) {
+					escaped_end = true;
+					pos = end;
+					break;
+				}
+				pos += 2;
+			}
+			else if (c == string_quote_ &&
+					string_state_ == StringState::Triple) {
+				if (pos + 2 < end && text_[pos + 1] == string_quote_ &&
+						text_[pos + 2] == string_quote_) {
+					pos += 3;
+					closed = true;
+					break;
+				}
+				++pos;
+			}
+			else if (c == string_quote_) {
+				++pos;
+				closed = true;
+				break;
+			}
+			else {
+				++pos;
+			}
+		}
+		pos = std::min(pos, end);
+		add_range(ScriptTokenType::String, range_begin, pos);
+		last_token_line_ = line_;
+		last_token_column_ = column(pos);
+		last_token_length_ = 0;
+
+		if (closed) {
+			string_state_ = StringState::None;
+		}
+		else if (string_state_ == StringState::Single && !escaped_end) {
+			add_error(string_line_, string_column_,
+				string_line_ == line_ ? column(end) - string_column_ : 1,
+				"unterminated string literal (detected at line " +
+				std::to_string(line_ + 1) + ")");
+			string_state_ = StringState::None;
+		}
+		return pos;
+	}
+
+	void close_bracket(char16_t c, size_t pos)
+	{
+		if (brackets_.empty()) {
+			add_error(line_, column(pos), 1, "unmatched '" + to_string(c) +
+				"'");
+			return;
+		}
+
+		const Bracket open = brackets_.back();
+		brackets_.pop_back();
+		const char16_t expected =
+			open.c == '(' ? ')' : (open.c == '[' ? ']' : '}');
+		if (c != expected) {
+			string message = "closing parenthesis '" + to_string(c) +
+				"' does not match opening parenthesis '" + to_string(open.c) +
+				"'";
+			if (open.line != line_)
+				message += " on line " + std::to_string(open.line + 1);
+			add_error(line_, column(pos), 1, message);
+		}
+	}
+
+	void check_indentation(int indent, int alt_indent, int length)
+	{
+		const bool expect_indent = expect_indent_;
+		expect_indent_ = false;
+
+		if (indent > indents_.back()) {
+			if (!expect_indent)
+				add_error(line_, 0, length, "unexpected indent");
+			else if (alt_indent <= alt_indents_.back())
+				add_tab_error(length);
+			// Continue with the indentation to not report every line
+			indents_.push_back(indent);
+			alt_indents_.push_back(alt_indent);
+			return;
+		}
+
+		if (expect_indent) {
+			add_error(line_, 0, length, "expected an indented block after "
+				"line " + std::to_string(colon_line_ + 1));
+		}
+		while (indent < indents_.back()) {
+			indents_.pop_back();
+			alt_indents_.pop_back();
+		}
+		if (indent != indents_.back()) {
+			add_error(line_, 0, length, "unindent does not match any outer "
+				"indentation level");
+			indents_.push_back(indent);
+			alt_indents_.push_back(alt_indent);
+		}
+		else if (alt_indent != alt_indents_.back()) {
+			add_tab_error(length);
+		}
+	}
+
+	void add_tab_error(int length)
+	{
+		add_error(line_, 0, length,
+			"inconsistent use of tabs and spaces in indentation");
+	}
+
+	void finish_logical_line()
+	{
+		expect_indent_ = ends_with_colon_;
+		if (!has_colon_ && block_keywords().count(first_word_)) {
+			add_error(last_token_line_,
+				last_token_column_ + last_token_length_, 1, "expected ':'");
+			// The block follows anyway
+			expect_indent_ = true;
+			colon_line_ = last_token_line_;
+		}
+
+		in_logical_line_ = false;
+		token_count_ = 0;
+		first_word_.clear();
+		has_colon_ = false;
+		ends_with_colon_ = false;
+		after_def_ = false;
+		after_class_ = false;
+	}
+
+	void finish()
+	{
+		if (string_state_ == StringState::Triple) {
+			add_error(string_line_, string_column_, 3,
+				"unterminated triple-quoted string literal (detected at "
+				"line " + std::to_string(line_ + 1) + ")");
+		}
+		if (!brackets_.empty()) {
+			const Bracket &open = brackets_.front();
+			add_error(open.line, open.column, 1,
+				"'" + to_string(open.c) + "' was never closed");
+		}
+		if (in_logical_line_ && string_state_ == StringState::None &&
+				brackets_.empty())
+			finish_logical_line();
+		if (expect_indent_) {
+			add_error(colon_line_, 0, 1, "expected an indented block after "
+				"line " + std::to_string(colon_line_ + 1));
+		}
+	}
+
+	const u16string &text_;
+	ScriptAnalysis &analysis_;
+	int line_;
+	size_t line_begin_;
+
+	StringState string_state_;
+	char16_t string_quote_;
+	int string_line_;
+	int string_column_;
+	vector<Bracket> brackets_;
+
+	/** The state of the current logical line. */
+	bool in_logical_line_;
+	bool continuation_;
+	/** The number of tokens in the logical line. */
+	int token_count_;
+	u16string first_word_;
+	bool has_colon_;
+	bool ends_with_colon_;
+	int last_token_line_;
+	int last_token_column_;
+	int last_token_length_;
+	bool after_def_;
+	bool after_class_;
+
+	/** The indentation levels with a tab size of 8 and of 1. */
+	bool expect_indent_;
+	int colon_line_;
+	vector<int> indents_;
+	vector<int> alt_indents_;
+
+};
+
+} // namespace
+
+const size_t ScriptAnalyzer::max_issue_count = 100;
+
+ScriptAnalyzer::ScriptAnalyzer(QObject *parent) :
+	QObject(parent),
+	stop_(false),
+	pending_(false),
+	pending_revision_(0)
+{
+	qRegisterMetaType<std::shared_ptr<const sv::python::ScriptAnalysis>>(
+		"std::shared_ptr<const sv::python::ScriptAnalysis>");
+
+	thread_ = std::thread(&ScriptAnalyzer::thread_proc, this);
+}
+
+ScriptAnalyzer::~ScriptAnalyzer()
+{
+	{
+		lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+	}
+	cond_.notify_one();
+	thread_.join();
+}
+
+void ScriptAnalyzer::analyze(uint64_t revision, const QString &text)
+{
+	{
+		lock_guard<std::mutex> lock(mutex_);
+		// The implicitly shared text is only copied, when it is changed
+		pending_text_ = text;
+		pending_revision_ = revision;
+		pending_ = true;
+	}
+	cond_.notify_one();
+}
+
+void ScriptAnalyzer::analyze_text(const u16string &text,
+	ScriptAnalysis &analysis)
+{
+	Lexer lexer(text, analysis);
+	lexer.run();
+}
+
+void ScriptAnalyzer::thread_proc()
+{
+	while (true) {
+		QString text;
+		uint64_t revision;
+		{
+			unique_lock<std::mutex> lock(mutex_);
+			cond_.wait(lock, [this]() { return stop_ || pending_; });
+			if (stop_)
+				return;
+			text.swap(pending_text_);
+			revision = pending_revision_;
+			pending_ = false;
+		}
+
+		auto analysis = make_shared<ScriptAnalysis>();
+		analysis->revision = revision;
+		analyze_text(text.toStdU16String(), *analysis);
+		Q_EMIT analysis_finished(analysis);
+	}
+}
+
+} // namespace python
+} // namespace sv
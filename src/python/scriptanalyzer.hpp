@@ -0,0 +1,169 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PYTHON_SCRIPTANALYZER_HPP
+#define PYTHON_SCRIPTANALYZER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <QObject>
+#include <QString>
+
+using std::shared_ptr;
+using std::string;
+using std::u16string;
+using std::vector;
+
+namespace sv {
+namespace python {
+
+enum class ScriptTokenType
+{
+	Keyword,
+	/** True, False, None and the builtin types. */
+	Constant,
+	/** A builtin function like print() or len(). */
+	Builtin,
+	/** A called or defined function. */
+	Function,
+	/** A defined class. */
+	ClassName,
+	Decorator,
+	Number,
+	String,
+	Comment
+};
+
+/**
+ * A highlighted range in a line of a script. The positions are in UTF-16
+ * code units, like the positions in a QTextBlock.
+ */
+struct ScriptFormatRange
+{
+	int start;
+	int length;
+	ScriptTokenType type;
+
+	bool operator==(const ScriptFormatRange &other) const
+	{
+		return start == other.start && length == other.length &&
+			type == other.type;
+	}
+	bool operator!=(const ScriptFormatRange &other) const
+	{
+		return !(*this == other);
+	}
+};
+
+enum class ScriptIssueSeverity
+{
+	Error,
+	Warning
+};
+
+/** A syntax problem of a script. line and column are 0 based. */
+struct ScriptIssue
+{
+	ScriptIssueSeverity severity;
+	int line;
+	int column;
+	int length;
+	string message;
+
+	bool operator==(const ScriptIssue &other) const
+	{
+		return severity == other.severity && line == other.line &&
+			column == other.column && length == other.length &&
+			message == other.message;
+	}
+	bool operator!=(const ScriptIssue &other) const
+	{
+		return !(*this == other);
+	}
+};
+
+/** The result of ScriptAnalyzer::analyze_text(). */
+struct ScriptAnalysis
+{
+	/** The revision of the text, that was passed to analyze(). */
+	uint64_t revision;
+	/** The highlighted ranges of every line of the text. */
+	vector<vector<ScriptFormatRange>> lines;
+	vector<ScriptIssue> issues;
+};
+
+/**
+ * Highlights and checks the syntax of SmuScripts in a background thread,
+ * so editing big scripts doesn't block the GUI thread.
+ *
+ * Only the latest text is analyzed: A text, that is passed to analyze()
+ * while the thread is busy, replaces any text, that is still waiting. The
+ * results are emitted with analysis_finished() from the background thread,
+ * so the receivers in the GUI thread get them queued.
+ *
+ * The syntax check is done by a tokenizer, not by the Python interpreter,
+ * so it doesn't compete with running scripts for the GIL. It finds the
+ * typical errors of an editor session: unterminated strings, unbalanced
+ * brackets, indentation errors and missing colons.
+ */
+class ScriptAnalyzer : public QObject
+{
+	Q_OBJECT
+
+public:
+	explicit ScriptAnalyzer(QObject *parent = nullptr);
+	~ScriptAnalyzer();
+
+	/** Analyze the text in the background thread. */
+	void analyze(uint64_t revision, const QString &text);
+
+	/** Analyze the text in the calling thread. */
+	static void analyze_text(const u16string &text, ScriptAnalysis &analysis);
+
+	/** The maximum number of reported issues. */
+	static const size_t max_issue_count;
+
+private:
+	void thread_proc();
+
+	std::thread thread_;
+	std::mutex mutex_;
+	std::condition_variable cond_;
+	bool stop_;
+	bool pending_;
+	uint64_t pending_revision_;
+	QString pending_text_;
+
+Q_SIGNALS:
+	void analysis_finished(
+		std::shared_ptr<const sv::python::ScriptAnalysis> analysis);
+
+};
+
+} // namespace python
+} // namespace sv
+
+#endif // PYTHON_SCRIPTANALYZER_HPP
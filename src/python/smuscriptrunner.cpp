@@ -17,9 +17,13 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <chrono>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include <pybind11/embed.h>
 #include <pybind11/stl.h>
@@ -30,14 +34,19 @@
 
 #include "smuscriptrunner.hpp"
 #include "src/session.hpp"
+#include "src/tracer.hpp"
 #include "src/python/bindings.hpp"
 #include "src/python/pystreambuf.hpp"
 #include "src/python/pystreamredirect.hpp"
 #include "src/python/uihelper.hpp"
 #include "src/python/uiproxy.hpp"
 
+using std::lock_guard;
 using std::make_shared;
+using std::mutex;
 using std::string;
+using std::unique_lock;
+using std::vector;
 
 using namespace pybind11::literals; // for the ""_a
 namespace py = pybind11;
@@ -45,94 +54,240 @@ namespace py = pybind11;
 namespace sv {
 namespace python {
 
+const int SmuScriptRunner::stop_timeout_ = 2000;
+const int SmuScriptRunner::output_interval_ = 16;
+
 SmuScriptRunner::SmuScriptRunner(Session &session) :
-	session_(session),
-	is_running_(false)
+	session_(session)
 {
 	ui_helper_ = make_shared<UiHelper>(session_);
+
+	output_timer_.setSingleShot(true);
+	output_timer_.setInterval(output_interval_);
+	connect(&output_timer_, &QTimer::timeout,
+		this, &SmuScriptRunner::flush_output);
 }
 
 SmuScriptRunner::~SmuScriptRunner()
 {
-	/*
-	if (script_thread_.joinable())
-		script_thread_.join();
-	*/
+	if (!gil_release_)
+		return;
+
+	for (const auto &file_name : running_scripts())
+		stop(file_name);
+
+	// The script threads are detached, the interpreter can only be
+	// finalized, when all of them have finished.
+	unique_lock<mutex> lock(mutex_);
+	if (!finished_cond_.wait_for(lock,
+			std::chrono::milliseconds(stop_timeout_),
+			[this]() { return scripts_.empty(); })) {
+		qWarning() << "SmuScriptRunner::~SmuScriptRunner(): Scripts are "
+			"still running, the Python interpreter is not finalized";
+		py_stream_redirect_.release();
+		gil_release_.release();
+		return;
+	}
+	lock.unlock();
+
+	gil_release_.reset();
+	py_stream_redirect_.reset();
+	py::finalize_interpreter();
 }
 
-void SmuScriptRunner::run(const string &file_name)
+bool SmuScriptRunner::run(const string &file_name)
 {
 	if (file_name.length() == 0) {
 		Q_EMIT script_error("SmuScriptRunner",
 			tr("No script file specified!").toStdString());
-		return;
+		return false;
 	}
 
     QFileInfo file_info(QString::fromStdString(file_name));
 	if (!file_info.exists() || !file_info.isFile()) {
 		Q_EMIT script_error("SmuScriptRunner",
 			tr("No valide script file specified!").toStdString());
-		return;
+		return false;
 	}
 
-	script_file_name_ = file_name;
-	script_thread_ = std::thread(&SmuScriptRunner::script_thread_proc, this);
-	script_thread_.detach();
+	if (!init_interpreter())
+		return false;
+
+	{
+		lock_guard<mutex> lock(mutex_);
+		if (scripts_.count(file_name) > 0) {
+			Q_EMIT script_error("SmuScriptRunner",
+				tr("The script is already running!").toStdString());
+			return false;
+		}
+		scripts_[file_name] = Script{ 0, false, ScriptState::Starting,
+			std::chrono::steady_clock::now() };
+	}
+
+	// Output of threads, that are started by a script, is shown for the
+	// latest script.
+	PyStreamBuf::set_default_script(file_name);
+	std::thread script_thread(
+		&SmuScriptRunner::script_thread_proc, this, file_name);
+	script_thread.detach();
+	return true;
 }
 
-void SmuScriptRunner::stop()
+void SmuScriptRunner::stop(const string &file_name)
 {
-	if (is_running_)
-		PyErr_SetInterrupt();
+	unsigned long thread_id;
+	{
+		lock_guard<mutex> lock(mutex_);
+		auto it = scripts_.find(file_name);
+		if (it == scripts_.end())
+			return;
+		it->second.stop_requested = true;
+		it->second.state = ScriptState::Stopping;
+		thread_id = it->second.thread_id;
+	}
+	if (thread_id == 0)
+		return; // The script checks stop_requested, before it starts
+
+	py::gil_scoped_acquire acquire;
+	PyThreadState_SetAsyncExc(thread_id, PyExc_KeyboardInterrupt);
 }
 
-bool SmuScriptRunner::is_running()
+bool SmuScriptRunner::is_running(const string &file_name) const
 {
-	return is_running_;
+	lock_guard<mutex> lock(mutex_);
+	return scripts_.count(file_name) > 0;
 }
 
-void SmuScriptRunner::script_thread_proc()
+bool SmuScriptRunner::is_running() const
 {
-	// TODO: mutex?
-
-	qWarning() << "SmuScriptRunner::script_thread_proc() executing " <<
-		QString::fromStdString(script_file_name_);
+	lock_guard<mutex> lock(mutex_);
+	return !scripts_.empty();
+}
 
-	is_running_ = true;
-	Q_EMIT script_started();
+vector<ScriptStatus> SmuScriptRunner::script_statuses() const
+{
+	const auto now = std::chrono::steady_clock::now();
+	lock_guard<mutex> lock(mutex_);
+	vector<ScriptStatus> statuses;
+	for (const auto &script : scripts_) {
+		statuses.push_back(ScriptStatus{ script.first, script.second.state,
+			std::chrono::duration<double>(
+				now - script.second.start_time).count() });
+	}
+	return statuses;
+}
 
-	py::scoped_interpreter guard{};
+void SmuScriptRunner::flush_output()
+{
+	if (py_stream_redirect_)
+		py_stream_redirect_->flush();
+}
 
-	py::module smuview_module = py::module::import("smuview");
+void SmuScriptRunner::on_output_pending()
+{
+	if (!output_timer_.isActive())
+		output_timer_.start();
+}
 
-	// Redirect python stdout + stderr
-	PyStreamRedirect py_stream_redirect{ shared_from_this() };
+vector<string> SmuScriptRunner::running_scripts() const
+{
+	lock_guard<mutex> lock(mutex_);
+	vector<string> file_names;
+	for (const auto &script : scripts_)
+		file_names.push_back(script.first);
+	return file_names;
+}
 
-	/*
-	 * NOTE: Setting Session and UiProxy as locals does not work!
-	 * When executing a script, the globals() inside a function are missing the
-	 * additional stuff like imported modules, function pointer and also
-	 * everyhthing provided by the locals dict. Setting Session and UiProxy in
-	 * addition to py::globals() as globals did the trick. See:
-	 * https://medium.com/just-me-me-programming-life/python-c-and-symbols-4628fb71a257
-	 */
-	UiProxy *ui_proxy = new UiProxy(session_, ui_helper_);
-	auto globals = py::dict(
-		**py::globals(),
-		"Session"_a=py::cast(session_, py::return_value_policy::reference),
-		"UiProxy"_a=py::cast(ui_proxy, py::return_value_policy::reference));
+bool SmuScriptRunner::init_interpreter()
+{
+	if (gil_release_)
+		return true;
 
+	py::initialize_interpreter();
 	try {
-		py::eval_file(script_file_name_, globals);
+		// The bindings are imported once for all scripts
+		py::module::import("smuview");
+		// Redirect python stdout + stderr
+		py_stream_redirect_.reset(new PyStreamRedirect(this));
 	}
 	catch (py::error_already_set &ex) {
-		Q_EMIT send_py_stderr(ex.what());
 		Q_EMIT script_error("SmuScriptRunner py::error_already_set", ex.what());
+		py_stream_redirect_.reset();
+		py::finalize_interpreter();
+		return false;
+	}
+
+	// Release the GIL of the GUI thread, so the script threads can run
+	gil_release_.reset(new py::gil_scoped_release());
+	return true;
+}
+
+void SmuScriptRunner::script_thread_proc(const string file_name)
+{
+	qWarning() << "SmuScriptRunner::script_thread_proc() executing " <<
+		QString::fromStdString(file_name);
+
+	Q_EMIT script_started(file_name);
+	SV_TRACE_THREAD_NAME("SmuScript " +
+		QFileInfo(QString::fromStdString(file_name)).fileName().toStdString());
+
+	{
+		py::gil_scoped_acquire acquire;
+		PyStreamBuf::set_thread_script(file_name);
+
+		bool stop_requested;
+		{
+			lock_guard<mutex> lock(mutex_);
+			Script &script = scripts_[file_name];
+			script.thread_id = PyThread_get_thread_ident();
+			stop_requested = script.stop_requested;
+			if (!stop_requested)
+				script.state = ScriptState::Running;
+		}
+
+		/*
+		 * NOTE: Setting Session and UiProxy as locals does not work!
+		 * When executing a script, the globals() inside a function are missing the
+		 * additional stuff like imported modules, function pointer and also
+		 * everyhthing provided by the locals dict. Setting Session and UiProxy in
+		 * addition to py::globals() as globals did the trick. See:
+		 * https://medium.com/just-me-me-programming-life/python-c-and-symbols-4628fb71a257
+		 */
+		try {
+			if (!stop_requested) {
+				UiProxy *ui_proxy = new UiProxy(session_, ui_helper_);
+				auto globals = py::dict(
+					**py::globals(),
+					"Session"_a=py::cast(session_, py::return_value_policy::reference),
+					"UiProxy"_a=py::cast(ui_proxy, py::return_value_policy::reference));
+				py::eval_file(file_name, globals);
+			}
+		}
+		catch (py::error_already_set &ex) {
+			// The error comes after the output of the script
+			flush_output();
+			Q_EMIT send_py_stderr(file_name, ex.what());
+			Q_EMIT script_error("SmuScriptRunner py::error_already_set", ex.what());
+		}
+
+		lock_guard<mutex> lock(mutex_);
+		// A stop(), that came too late, must not hit the next script
+		PyThreadState_SetAsyncExc(scripts_[file_name].thread_id, nullptr);
+		scripts_[file_name].thread_id = 0;
+		scripts_[file_name].state = ScriptState::Stopping;
 	}
 
 	qWarning() << "SmuScriptRunner::script_thread_proc() has finished!";
-	Q_EMIT script_finished();
-	is_running_ = false;
+	// The output must arrive before script_finished() (the tabs ignore the
+	// output of finished scripts)
+	flush_output();
+	Q_EMIT script_finished(file_name);
+
+	{
+		lock_guard<mutex> lock(mutex_);
+		scripts_.erase(file_name);
+	}
+	finished_cond_.notify_all();
 }
 
 } // namespace python
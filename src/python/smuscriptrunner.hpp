@@ -20,15 +20,27 @@
 #ifndef PYTHON_SMUSCRIPTRUNNER_HPP
 #define PYTHON_SMUSCRIPTRUNNER_HPP
 
+#include <chrono>
+#include <condition_variable>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
-#include <thread>
+#include <vector>
 
 #include <QObject>
 #include <QString>
+#include <QTimer>
 
+using std::map;
 using std::shared_ptr;
 using std::string;
+using std::unique_ptr;
+using std::vector;
+
+namespace pybind11 {
+class gil_scoped_release;
+}
 
 namespace sv {
 
@@ -36,8 +48,41 @@ class Session;
 
 namespace python {
 
+class PyStreamRedirect;
 class UiHelper;
 
+enum class ScriptState
+{
+	/** The thread is started, but the script is not executed yet. */
+	Starting,
+	Running,
+	/** The script was asked to stop or has finished. */
+	Stopping
+};
+
+/**
+ * The state of a script at the time of SmuScriptRunner::script_statuses().
+ */
+struct ScriptStatus
+{
+	string file_name;
+	ScriptState state;
+	/** The seconds since the script was started. */
+	double run_time;
+};
+
+/**
+ * Runs SmuScripts in their own threads.
+ *
+ * All scripts share one Python interpreter, that is started with the first
+ * script and kept until the runner is destroyed. So the interpreter startup
+ * and the imports of the modules are only paid once, and several scripts
+ * can run at the same time. Every script gets its own globals. A script is
+ * identified by its file name, a file can only run once at a time.
+ *
+ * The output of the scripts is batched by PyStreamBuf and sent at most once
+ * per output_interval_ via send_py_stdout()/send_py_stderr().
+ */
 class SmuScriptRunner :
 	public QObject,
 	public std::enable_shared_from_this<SmuScriptRunner>
@@ -48,25 +93,68 @@ public:
 	explicit SmuScriptRunner(Session &session);
 	~SmuScriptRunner();
 
-	void run(const std::string &file_name);
-	void stop();
-	bool is_running();
+	/**
+	 * Run the script in a new thread.
+	 *
+	 * @return false if the script couldn't be started, e.g. because it is
+	 *         already running.
+	 */
+	bool run(const std::string &file_name);
+	/**
+	 * Raise a KeyboardInterrupt in the script. The interrupt is handled,
+	 * when the script executes Python code the next time.
+	 */
+	void stop(const std::string &file_name);
+	bool is_running(const std::string &file_name) const;
+	/** Return true if any script is running. */
+	bool is_running() const;
+	/** Return the states of all running scripts. */
+	vector<ScriptStatus> script_statuses() const;
+	/** Send the pending output of all scripts now. */
+	void flush_output();
 
 private:
-	void script_thread_proc();
+	struct Script
+	{
+		/** The Python id of the script thread, 0 until it has started. */
+		unsigned long thread_id;
+		bool stop_requested;
+		ScriptState state;
+		std::chrono::steady_clock::time_point start_time;
+	};
+
+	vector<string> running_scripts() const;
+	/** Start the interpreter, must be called from the GUI thread. */
+	bool init_interpreter();
+	void script_thread_proc(const string file_name);
+
+	/** Milliseconds to wait for the scripts to stop in the destructor. */
+	static const int stop_timeout_;
+	/** Milliseconds between two sends of the batched output (one frame). */
+	static const int output_interval_;
 
 	Session &session_;
 	shared_ptr<UiHelper> ui_helper_;
-	string script_file_name_;
-	std::thread script_thread_;
-	bool is_running_;
+	/** Holds the GIL of the GUI thread released, while the interpreter runs. */
+	unique_ptr<pybind11::gil_scoped_release> gil_release_;
+	unique_ptr<PyStreamRedirect> py_stream_redirect_;
+	mutable std::mutex mutex_;
+	std::condition_variable finished_cond_;
+	map<string, Script> scripts_;
+	/** Started by the first pending output, flushes the output. */
+	QTimer output_timer_;
+
+	friend class PyStreamRedirect;
+
+private Q_SLOTS:
+	void on_output_pending();
 
 Q_SIGNALS:
 	void script_error(const std::string &sender, const std::string &msg);
-	void script_started();
-	void script_finished();
-	void send_py_stdout(const std::string &text);
-	void send_py_stderr(const std::string &text);
+	void script_started(const std::string &file_name);
+	void script_finished(const std::string &file_name);
+	void send_py_stdout(const std::string &file_name, const std::string &text);
+	void send_py_stderr(const std::string &file_name, const std::string &text);
 
 };
 
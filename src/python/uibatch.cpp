@@ -0,0 +1,227 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "uibatch.hpp"
+
+using std::make_shared;
+using std::shared_ptr;
+using std::string;
+using std::tuple;
+using std::vector;
+
+namespace sv {
+namespace python {
+
+std::atomic<size_t> UiBatch::next_id_(1);
+
+UiBatch::UiBatch() :
+	commands_(make_shared<vector<UiCommand>>())
+{
+}
+
+string UiBatch::add_device_tab(shared_ptr<devices::BaseDevice> device)
+{
+	UiCommand command;
+	command.type = UiCommand::Type::AddDeviceTab;
+	command.device = device;
+	return add_command(command);
+}
+
+string UiBatch::add_data_view(const string &tab_id, Qt::DockWidgetArea area,
+	shared_ptr<data::AnalogTimeSignal> signal)
+{
+	UiCommand command;
+	command.type = UiCommand::Type::AddDataView;
+	command.tab_id = tab_id;
+	command.area = area;
+	command.signal = signal;
+	return add_command(command);
+}
+
+string UiBatch::add_control_view(const string &tab_id,
+	Qt::DockWidgetArea area,
+	shared_ptr<devices::Configurable> configurable)
+{
+	UiCommand command;
+	command.type = UiCommand::Type::AddControlView;
+	command.tab_id = tab_id;
+	command.area = area;
+	command.configurable = configurable;
+	return add_command(command);
+}
+
+string UiBatch::add_time_plot_view(const string &tab_id,
+	Qt::DockWidgetArea area)
+{
+	UiCommand command;
+	command.type = UiCommand::Type::AddTimePlotView;
+	command.tab_id = tab_id;
+	command.area = area;
+	return add_command(command);
+}
+
+string UiBatch::add_xy_plot_view(const string &tab_id,
+	Qt::DockWidgetArea area)
+{
+	UiCommand command;
+	command.type = UiCommand::Type::AddXYPlotView;
+	command.tab_id = tab_id;
+	command.area = area;
+	return add_command(command);
+}
+
+string UiBatch::add_power_panel_view(const string &tab_id,
+	Qt::DockWidgetArea area,
+	shared_ptr<data::AnalogTimeSignal> voltage_signal,
+	shared_ptr<data::AnalogTimeSignal> current_signal)
+{
+	UiCommand command;
+	command.type = UiCommand::Type::AddPowerPanelView;
+	command.tab_id = tab_id;
+	command.area = area;
+	command.signal = voltage_signal;
+	command.signal2 = current_signal;
+	return add_command(command);
+}
+
+string UiBatch::add_value_panel_view(const string &tab_id,
+	Qt::DockWidgetArea area,
+	shared_ptr<channels::BaseChannel> channel)
+{
+	UiCommand command;
+	command.type = UiCommand::Type::AddValuePanelViewForChannel;
+	command.tab_id = tab_id;
+	command.area = area;
+	command.channel = channel;
+	return add_command(command);
+}
+
+string UiBatch::add_value_panel_view(const string &tab_id,
+	Qt::DockWidgetArea area,
+	shared_ptr<data::AnalogTimeSignal> signal)
+{
+	UiCommand command;
+	command.type = UiCommand::Type::AddValuePanelViewForSignal;
+	command.tab_id = tab_id;
+	command.area = area;
+	command.signal = signal;
+	return add_command(command);
+}
+
+void UiBatch::add_signal_to_data_view(const string &tab_id,
+	const string &view_id, shared_ptr<data::AnalogTimeSignal> signal)
+{
+	UiCommand command;
+	command.type = UiCommand::Type::AddSignalToDataView;
+	command.tab_id = tab_id;
+	command.view_id = view_id;
+	command.signal = signal;
+	add_command(command);
+}
+
+void UiBatch::set_channel_to_time_plot_view(const string &tab_id,
+	const string &view_id,
+	shared_ptr<channels::BaseChannel> channel)
+{
+	UiCommand command;
+	command.type = UiCommand::Type::SetChannelToTimePlotView;
+	command.tab_id = tab_id;
+	command.view_id = view_id;
+	command.channel = channel;
+	add_command(command);
+}
+
+string UiBatch::add_curve_to_time_plot_view(const string &tab_id,
+	const string &view_id,
+	shared_ptr<data::AnalogTimeSignal> signal)
+{
+	UiCommand command;
+	command.type = UiCommand::Type::AddCurveToTimePlotView;
+	command.tab_id = tab_id;
+	command.view_id = view_id;
+	command.signal = signal;
+	return add_command(command);
+}
+
+string UiBatch::add_curve_to_xy_plot_view(const string &tab_id,
+	const string &view_id,
+	shared_ptr<data::AnalogTimeSignal> x_signal,
+	shared_ptr<data::AnalogTimeSignal> y_signal)
+{
+	UiCommand command;
+	command.type = UiCommand::Type::AddCurveToXYPlotView;
+	command.tab_id = tab_id;
+	command.view_id = view_id;
+	command.signal = x_signal;
+	command.signal2 = y_signal;
+	return add_command(command);
+}
+
+void UiBatch::set_curve_name(const string &tab_id, const string &view_id,
+	const string &curve_id, const string &name)
+{
+	UiCommand command;
+	command.type = UiCommand::Type::SetCurveName;
+	command.tab_id = tab_id;
+	command.view_id = view_id;
+	command.curve_id = curve_id;
+	command.name = name;
+	add_command(command);
+}
+
+void UiBatch::set_curve_color(const string &tab_id, const string &view_id,
+	const string &curve_id, tuple<int, int, int> color)
+{
+	UiCommand command;
+	command.type = UiCommand::Type::SetCurveColor;
+	command.tab_id = tab_id;
+	command.view_id = view_id;
+	command.curve_id = curve_id;
+	command.color = color;
+	add_command(command);
+}
+
+size_t UiBatch::size() const
+{
+	return commands_->size();
+}
+
+shared_ptr<vector<UiCommand>> UiBatch::take_commands()
+{
+	auto commands = commands_;
+	commands_ = make_shared<vector<UiCommand>>();
+	return commands;
+}
+
+string UiBatch::add_command(UiCommand &command)
+{
+	command.id = "batch:" + std::to_string(next_id_++);
+	commands_->push_back(command);
+	return command.id;
+}
+
+} // namespace python
+} // namespace sv
@@ -0,0 +1,163 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PYTHON_UIBATCH_HPP
+#define PYTHON_UIBATCH_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <QDockWidget>
+
+using std::shared_ptr;
+using std::string;
+using std::tuple;
+using std::vector;
+
+namespace sv {
+
+namespace channels {
+class BaseChannel;
+}
+namespace data {
+class AnalogTimeSignal;
+}
+namespace devices {
+class BaseDevice;
+class Configurable;
+}
+
+namespace python {
+
+/**
+ * A command of a UiBatch. Only the members, that are needed by the type,
+ * are set.
+ */
+struct UiCommand
+{
+	enum class Type {
+		AddDeviceTab,
+		AddDataView,
+		AddControlView,
+		AddTimePlotView,
+		AddXYPlotView,
+		AddPowerPanelView,
+		AddValuePanelViewForChannel,
+		AddValuePanelViewForSignal,
+		AddSignalToDataView,
+		SetChannelToTimePlotView,
+		AddCurveToTimePlotView,
+		AddCurveToXYPlotView,
+		SetCurveName,
+		SetCurveColor
+	};
+
+	Type type;
+	/** The placeholder id of the created tab, view or curve. */
+	string id;
+	string tab_id;
+	string view_id;
+	string curve_id;
+	Qt::DockWidgetArea area = Qt::NoDockWidgetArea;
+	shared_ptr<devices::BaseDevice> device;
+	shared_ptr<devices::Configurable> configurable;
+	shared_ptr<channels::BaseChannel> channel;
+	shared_ptr<data::AnalogTimeSignal> signal;
+	/** The y signal of a x/y curve or the current signal of a power panel. */
+	shared_ptr<data::AnalogTimeSignal> signal2;
+	string name;
+	tuple<int, int, int> color;
+};
+
+/**
+ * Records UI commands, that are executed by UiProxy::ui_execute_batch() in
+ * one pass in the GUI thread, instead of one round trip per command.
+ *
+ * The commands, that create a tab, a view or a curve, return a placeholder
+ * id, that can be used as tab, view or curve id in the following commands
+ * of the batch. The placeholders are replaced by the actual ids, when the
+ * batch is executed.
+ */
+class UiBatch
+{
+public:
+	UiBatch();
+
+	string add_device_tab(shared_ptr<devices::BaseDevice> device);
+
+	string add_data_view(const string &tab_id, Qt::DockWidgetArea area,
+		shared_ptr<data::AnalogTimeSignal> signal);
+	string add_control_view(const string &tab_id, Qt::DockWidgetArea area,
+		shared_ptr<devices::Configurable> configurable);
+	string add_time_plot_view(const string &tab_id, Qt::DockWidgetArea area);
+	string add_xy_plot_view(const string &tab_id, Qt::DockWidgetArea area);
+	string add_power_panel_view(const string &tab_id,
+		Qt::DockWidgetArea area,
+		shared_ptr<data::AnalogTimeSignal> voltage_signal,
+		shared_ptr<data::AnalogTimeSignal> current_signal);
+	string add_value_panel_view(const string &tab_id,
+		Qt::DockWidgetArea area,
+		shared_ptr<channels::BaseChannel> channel);
+	string add_value_panel_view(const string &tab_id,
+		Qt::DockWidgetArea area,
+		shared_ptr<data::AnalogTimeSignal> signal);
+
+	void add_signal_to_data_view(const string &tab_id, const string &view_id,
+		shared_ptr<data::AnalogTimeSignal> signal);
+
+	void set_channel_to_time_plot_view(const string &tab_id,
+		const string &view_id,
+		shared_ptr<channels::BaseChannel> channel);
+	string add_curve_to_time_plot_view(const string &tab_id,
+		const string &view_id,
+		shared_ptr<data::AnalogTimeSignal> signal);
+	string add_curve_to_xy_plot_view(const string &tab_id,
+		const string &view_id,
+		shared_ptr<data::AnalogTimeSignal> x_signal,
+		shared_ptr<data::AnalogTimeSignal> y_signal);
+	void set_curve_name(const string &tab_id, const string &view_id,
+		const string &curve_id, const string &name);
+	void set_curve_color(const string &tab_id, const string &view_id,
+		const string &curve_id, tuple<int, int, int> color);
+
+	/** Return the number of recorded commands. */
+	size_t size() const;
+	/** Return the recorded commands and clear the batch. */
+	shared_ptr<vector<UiCommand>> take_commands();
+
+private:
+	/**
+	 * Append the command and return its placeholder id. The placeholders
+	 * are unique for all batches.
+	 */
+	string add_command(UiCommand &command);
+
+	shared_ptr<vector<UiCommand>> commands_;
+	static std::atomic<size_t> next_id_;
+
+};
+
+} // namespace python
+} // namespace sv
+
+#endif // PYTHON_UIBATCH_HPP
@@ -17,8 +17,10 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <QColor>
 #include <QDebug>
@@ -33,6 +35,7 @@
 #include "src/channels/basechannel.hpp"
 #include "src/data/analogtimesignal.hpp"
 #include "src/devices/configurable.hpp"
+#include "src/python/uibatch.hpp"
 #include "src/ui/tabs/basetab.hpp"
 #include "src/ui/tabs/devicetab.hpp"
 #include "src/ui/views/baseplotview.hpp"
@@ -43,9 +46,14 @@
 #include "src/ui/views/valuepanelview.hpp"
 #include "src/ui/views/viewhelper.hpp"
 #include "src/ui/views/xyplotview.hpp"
+#include "src/ui/widgets/plot/basecurvedata.hpp"
+#include "src/ui/widgets/plot/plot.hpp"
+#include "src/ui/widgets/plot/plotprofiler.hpp"
 
+using std::map;
 using std::shared_ptr;
 using std::string;
+using std::vector;
 
 namespace sv {
 namespace python {
@@ -57,77 +65,33 @@ UiHelper::UiHelper(Session &session) :
 
 void UiHelper::add_device_tab(shared_ptr<sv::devices::BaseDevice> device)
 {
-	if (!session_.main_window()) {
-		Q_EMIT tab_added("");
-		return;
-	}
-
-	auto tab = session_.main_window()->add_device_tab(device);
-	Q_EMIT tab_added(tab->id());
+	Q_EMIT tab_added(create_device_tab(device));
 }
 
 void UiHelper::add_data_view(const std::string &tab_id,
 	Qt::DockWidgetArea area,
 	shared_ptr<sv::data::AnalogTimeSignal> signal)
 {
-	auto tab = get_tab(tab_id);
-	if (!tab) {
-		Q_EMIT view_added("");
-		return;
-	}
-
-	auto view = new ui::views::DataView(session_);
-	view->add_signal(signal);
-	tab->add_view(view, area);
-	Q_EMIT view_added(view->id());
+	Q_EMIT view_added(create_data_view(tab_id, area, signal));
 }
 
 void UiHelper::add_control_view(const std::string &tab_id,
 	Qt::DockWidgetArea area,
 	shared_ptr<sv::devices::Configurable> configurable)
 {
-	auto tab = get_tab(tab_id);
-	if (!tab) {
-		Q_EMIT view_added("");
-		return;
-	}
-	auto view = ui::views::viewhelper::get_view_for_configurable(
-		session_, configurable);
-	if (!view) {
-		Q_EMIT view_added("");
-		return;
-	}
-
-	tab->add_view(view, area);
-	Q_EMIT view_added(view->id());
+	Q_EMIT view_added(create_control_view(tab_id, area, configurable));
 }
 
 void UiHelper::add_time_plot_view(const std::string &tab_id,
 	Qt::DockWidgetArea area)
 {
-	auto tab = get_tab(tab_id);
-	if (!tab) {
-		Q_EMIT view_added("");
-		return;
-	}
-
-	auto view = new ui::views::TimePlotView(session_);
-	tab->add_view(view, area);
-	Q_EMIT view_added(view->id());
+	Q_EMIT view_added(create_time_plot_view(tab_id, area));
 }
 
 void UiHelper::add_xy_plot_view(const std::string &tab_id,
 	Qt::DockWidgetArea area)
 {
-	auto tab = get_tab(tab_id);
-	if (!tab) {
-		Q_EMIT view_added("");
-		return;
-	}
-
-	auto view = new ui::views::XYPlotView(session_);
-	tab->add_view(view, area);
-	Q_EMIT view_added(view->id());
+	Q_EMIT view_added(create_xy_plot_view(tab_id, area));
 }
 
 void UiHelper::add_power_panel_view(const std::string &tab_id,
@@ -135,48 +99,22 @@ void UiHelper::add_power_panel_view(const std::string &tab_id,
 	shared_ptr<sv::data::AnalogTimeSignal> voltage_signal,
 	shared_ptr<sv::data::AnalogTimeSignal> current_signal)
 {
-	auto tab = get_tab(tab_id);
-	if (!tab) {
-		Q_EMIT view_added("");
-		return;
-	}
-
-	auto view = new ui::views::PowerPanelView(session_);
-	view->set_signals(voltage_signal, current_signal);
-	tab->add_view(view, area);
-	Q_EMIT view_added(view->id());
+	Q_EMIT view_added(create_power_panel_view(
+		tab_id, area, voltage_signal, current_signal));
 }
 
 void UiHelper::add_value_panel_view(const std::string &tab_id,
 	Qt::DockWidgetArea area,
 	shared_ptr<sv::channels::BaseChannel> channel)
 {
-	auto tab = get_tab(tab_id);
-	if (!tab) {
-		Q_EMIT view_added("");
-		return;
-	}
-
-	auto view = new ui::views::ValuePanelView(session_);
-	view->set_channel(channel);
-	tab->add_view(view, area);
-	Q_EMIT view_added(view->id());
+	Q_EMIT view_added(create_value_panel_view(tab_id, area, channel));
 }
 
 void UiHelper::add_value_panel_view(const std::string &tab_id,
 	Qt::DockWidgetArea area,
 	shared_ptr<sv::data::AnalogTimeSignal> signal)
 {
-	auto tab = get_tab(tab_id);
-	if (!tab) {
-		Q_EMIT view_added("");
-		return;
-	}
-
-	auto view = new ui::views::ValuePanelView(session_);
-	view->set_signal(signal);
-	tab->add_view(view, area);
-	Q_EMIT view_added(view->id());
+	Q_EMIT view_added(create_value_panel_view(tab_id, area, signal));
 }
 
 void UiHelper::add_signal_to_data_view(const std::string &tab_id,
@@ -207,14 +145,7 @@ void UiHelper::add_curve_to_time_plot_view(const std::string &tab_id,
 	const std::string &view_id,
 	shared_ptr<sv::data::AnalogTimeSignal> signal)
 {
-	auto plot_view = get_time_plot_view(tab_id, view_id);
-	if (!plot_view) {
-		Q_EMIT curve_added("");
-		return;
-	}
-
-	string id = plot_view->add_signal(signal);
-	Q_EMIT curve_added(id);
+	Q_EMIT curve_added(create_time_plot_curve(tab_id, view_id, signal));
 }
 
 void UiHelper::add_curve_to_xy_plot_view(const std::string &tab_id,
@@ -222,20 +153,22 @@ void UiHelper::add_curve_to_xy_plot_view(const std::string &tab_id,
 	shared_ptr<sv::data::AnalogTimeSignal> x_signal,
 	shared_ptr<sv::data::AnalogTimeSignal> y_signal)
 {
-	auto view = get_view(tab_id, view_id);
-	if (!view) {
-		Q_EMIT curve_added("");
-		return;
-	}
-	auto plot_view = qobject_cast<ui::views::XYPlotView *>(view);
+	Q_EMIT curve_added(
+		create_xy_plot_curve(tab_id, view_id, x_signal, y_signal));
+}
+
+void UiHelper::add_array_curve_to_plot_view(const std::string &tab_id,
+	const std::string &view_id,
+	sv::ui::widgets::plot::BaseCurveData *curve_data)
+{
+	auto plot_view = get_base_plot_view(tab_id, view_id);
 	if (!plot_view) {
-		qWarning() << "UiHelper::add_curve_to_xy_plot_view(): View is not a "
-			"xy plot view: " << QString::fromStdString(view_id);
+		delete curve_data;
 		Q_EMIT curve_added("");
 		return;
 	}
 
-	string id = plot_view->add_signals(x_signal, y_signal);
+	string id = plot_view->add_curve_data(curve_data);
 	Q_EMIT curve_added(id);
 }
 
@@ -270,6 +203,43 @@ void UiHelper::set_curve_color(const std::string &tab_id,
 	}
 }
 
+void UiHelper::set_plot_update_mode(const std::string &tab_id,
+	const std::string &view_id,
+	sv::ui::widgets::plot::PlotUpdateMode update_mode)
+{
+	auto plot_view = get_base_plot_view(tab_id, view_id);
+	if (!plot_view)
+		return;
+
+	plot_view->set_update_mode(update_mode);
+}
+
+void UiHelper::read_plot_profile(const std::string &tab_id,
+	const std::string &view_id, bool reset)
+{
+	QVariantMap qprofile;
+	auto plot_view = get_base_plot_view(tab_id, view_id);
+	if (plot_view) {
+		const auto profile = plot_view->profile(reset);
+		qprofile["frames"] = (qulonglong)profile.frames;
+		qprofile["mean_frame_time"] = profile.mean_frame_time;
+		qprofile["max_frame_time"] = profile.max_frame_time;
+		qprofile["mean_points"] = profile.mean_points;
+		qprofile["replots"] = (qulonglong)profile.replots;
+		qprofile["incremental_paints"] = (qulonglong)profile.incremental_paints;
+		qprofile["mean_lateness"] = profile.mean_lateness;
+		qprofile["max_lateness"] = profile.max_lateness;
+		qprofile["mean_replot_time"] = profile.mean_replot_time;
+		qprofile["mean_incremental_paint_time"] =
+			profile.mean_incremental_paint_time;
+		qprofile["total_frames"] = (qulonglong)profile.total_frames;
+		qprofile["total_replots"] = (qulonglong)profile.total_replots;
+		qprofile["total_incremental_paints"] =
+			(qulonglong)profile.total_incremental_paints;
+	}
+	Q_EMIT plot_profile_read(qprofile);
+}
+
 void UiHelper::show_message_box(const std::string &title,
 	const std::string &text)
 {
@@ -354,6 +324,209 @@ void UiHelper::show_int_input_dialog(const std::string &title,
 		Q_EMIT input_dialog_canceled();
 }
 
+void UiHelper::execute_batch(
+	shared_ptr<std::vector<sv::python::UiCommand>> commands)
+{
+	// The placeholder ids of the batch and the actual ids
+	map<string, string> ids;
+	const auto resolve = [&ids](const string &id) {
+		const auto it = ids.find(id);
+		return it != ids.end() ? it->second : id;
+	};
+
+	for (const auto &command : *commands) {
+		const string tab_id = resolve(command.tab_id);
+		const string view_id = resolve(command.view_id);
+		const string curve_id = resolve(command.curve_id);
+		string id;
+		switch (command.type) {
+		case UiCommand::Type::AddDeviceTab:
+			id = create_device_tab(command.device);
+			break;
+		case UiCommand::Type::AddDataView:
+			id = create_data_view(tab_id, command.area, command.signal);
+			break;
+		case UiCommand::Type::AddControlView:
+			id = create_control_view(tab_id, command.area, command.configurable);
+			break;
+		case UiCommand::Type::AddTimePlotView:
+			id = create_time_plot_view(tab_id, command.area);
+			break;
+		case UiCommand::Type::AddXYPlotView:
+			id = create_xy_plot_view(tab_id, command.area);
+			break;
+		case UiCommand::Type::AddPowerPanelView:
+			id = create_power_panel_view(
+				tab_id, command.area, command.signal, command.signal2);
+			break;
+		case UiCommand::Type::AddValuePanelViewForChannel:
+			id = create_value_panel_view(tab_id, command.area, command.channel);
+			break;
+		case UiCommand::Type::AddValuePanelViewForSignal:
+			id = create_value_panel_view(tab_id, command.area, command.signal);
+			break;
+		case UiCommand::Type::AddSignalToDataView:
+			add_signal_to_data_view(tab_id, view_id, command.signal);
+			break;
+		case UiCommand::Type::SetChannelToTimePlotView:
+			if (auto plot_view = get_time_plot_view(tab_id, view_id))
+				plot_view->set_channel(command.channel);
+			break;
+		case UiCommand::Type::AddCurveToTimePlotView:
+			id = create_time_plot_curve(tab_id, view_id, command.signal);
+			break;
+		case UiCommand::Type::AddCurveToXYPlotView:
+			id = create_xy_plot_curve(
+				tab_id, view_id, command.signal, command.signal2);
+			break;
+		case UiCommand::Type::SetCurveName:
+			set_curve_name(tab_id, view_id, curve_id, command.name);
+			break;
+		case UiCommand::Type::SetCurveColor:
+			set_curve_color(tab_id, view_id, curve_id, command.color);
+			break;
+		}
+		ids[command.id] = id;
+	}
+
+	Q_EMIT batch_executed(ids);
+}
+
+string UiHelper::create_device_tab(shared_ptr<sv::devices::BaseDevice> device)
+{
+	if (!session_.main_window())
+		return "";
+
+	auto tab = session_.main_window()->add_device_tab(device);
+	return tab->id();
+}
+
+string UiHelper::create_data_view(const string &tab_id,
+	Qt::DockWidgetArea area,
+	shared_ptr<sv::data::AnalogTimeSignal> signal)
+{
+	auto tab = get_tab(tab_id);
+	if (!tab)
+		return "";
+
+	auto view = new ui::views::DataView(session_);
+	view->add_signal(signal);
+	tab->add_view(view, area);
+	return view->id();
+}
+
+string UiHelper::create_control_view(const string &tab_id,
+	Qt::DockWidgetArea area,
+	shared_ptr<sv::devices::Configurable> configurable)
+{
+	auto tab = get_tab(tab_id);
+	if (!tab)
+		return "";
+	auto view = ui::views::viewhelper::get_view_for_configurable(
+		session_, configurable);
+	if (!view)
+		return "";
+
+	tab->add_view(view, area);
+	return view->id();
+}
+
+string UiHelper::create_time_plot_view(const string &tab_id,
+	Qt::DockWidgetArea area)
+{
+	auto tab = get_tab(tab_id);
+	if (!tab)
+		return "";
+
+	auto view = new ui::views::TimePlotView(session_);
+	tab->add_view(view, area);
+	return view->id();
+}
+
+string UiHelper::create_xy_plot_view(const string &tab_id,
+	Qt::DockWidgetArea area)
+{
+	auto tab = get_tab(tab_id);
+	if (!tab)
+		return "";
+
+	auto view = new ui::views::XYPlotView(session_);
+	tab->add_view(view, area);
+	return view->id();
+}
+
+string UiHelper::create_power_panel_view(const string &tab_id,
+	Qt::DockWidgetArea area,
+	shared_ptr<sv::data::AnalogTimeSignal> voltage_signal,
+	shared_ptr<sv::data::AnalogTimeSignal> current_signal)
+{
+	auto tab = get_tab(tab_id);
+	if (!tab)
+		return "";
+
+	auto view = new ui::views::PowerPanelView(session_);
+	view->set_signals(voltage_signal, current_signal);
+	tab->add_view(view, area);
+	return view->id();
+}
+
+string UiHelper::create_value_panel_view(const string &tab_id,
+	Qt::DockWidgetArea area,
+	shared_ptr<sv::channels::BaseChannel> channel)
+{
+	auto tab = get_tab(tab_id);
+	if (!tab)
+		return "";
+
+	auto view = new ui::views::ValuePanelView(session_);
+	view->set_channel(channel);
+	tab->add_view(view, area);
+	return view->id();
+}
+
+string UiHelper::create_value_panel_view(const string &tab_id,
+	Qt::DockWidgetArea area,
+	shared_ptr<sv::data::AnalogTimeSignal> signal)
+{
+	auto tab = get_tab(tab_id);
+	if (!tab)
+		return "";
+
+	auto view = new ui::views::ValuePanelView(session_);
+	view->set_signal(signal);
+	tab->add_view(view, area);
+	return view->id();
+}
+
+string UiHelper::create_time_plot_curve(const string &tab_id,
+	const string &view_id,
+	shared_ptr<sv::data::AnalogTimeSignal> signal)
+{
+	auto plot_view = get_time_plot_view(tab_id, view_id);
+	if (!plot_view)
+		return "";
+
+	return plot_view->add_signal(signal);
+}
+
+string UiHelper::create_xy_plot_curve(const string &tab_id,
+	const string &view_id,
+	shared_ptr<sv::data::AnalogTimeSignal> x_signal,
+	shared_ptr<sv::data::AnalogTimeSignal> y_signal)
+{
+	auto view = get_view(tab_id, view_id);
+	if (!view)
+		return "";
+	auto plot_view = qobject_cast<ui::views::XYPlotView *>(view);
+	if (!plot_view) {
+		qWarning() << "UiHelper::create_xy_plot_curve(): View is not a "
+			"xy plot view: " << QString::fromStdString(view_id);
+		return "";
+	}
+
+	return plot_view->add_signals(x_signal, y_signal);
+}
+
 ui::tabs::BaseTab *UiHelper::get_tab(const string &tab_id) const
 {
 	if (!session_.main_window()) {
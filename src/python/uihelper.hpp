@@ -20,9 +20,11 @@
 #ifndef PYTHON_UIHELPER_HPP
 #define PYTHON_UIHELPER_HPP
 
+#include <map>
 #include <memory>
 #include <string>
 #include <tuple>
+#include <vector>
 
 #include <QDockWidget>
 #include <QObject>
@@ -50,6 +52,12 @@ namespace ui {
 namespace tabs {
 class BaseTab;
 }
+namespace widgets {
+namespace plot {
+class BaseCurveData;
+enum class PlotUpdateMode;
+}
+}
 namespace views {
 class BasePlotView;
 class BaseView;
@@ -59,6 +67,8 @@ class TimePlotView;
 
 namespace python {
 
+struct UiCommand;
+
 class UiHelper : public QObject
 {
 	Q_OBJECT
@@ -98,10 +108,22 @@ public Q_SLOTS:
 		const std::string &view_id,
 		shared_ptr<sv::data::AnalogTimeSignal> x_signal,
 		shared_ptr<sv::data::AnalogTimeSignal> y_signal);
+	void add_array_curve_to_plot_view(const std::string &tab_id,
+		const std::string &view_id,
+		sv::ui::widgets::plot::BaseCurveData *curve_data);
 	void set_curve_name(const std::string &tab_id, const std::string &view_id,
 		const std::string &curve_id, const std::string &name);
 	void set_curve_color(const std::string &tab_id, const std::string &view_id,
 		const std::string &curve_id, std::tuple<int, int, int> color);
+	void set_plot_update_mode(const std::string &tab_id,
+		const std::string &view_id,
+		sv::ui::widgets::plot::PlotUpdateMode update_mode);
+	/**
+	 * Emit plot_profile_read() with the statistics of the frame profiler of
+	 * the plot view, an empty map if the view doesn't exist.
+	 */
+	void read_plot_profile(const std::string &tab_id,
+		const std::string &view_id, bool reset);
 
 	void show_message_box(const std::string &title, const std::string &text);
 	void show_string_input_dialog(const std::string &title,
@@ -112,9 +134,41 @@ public Q_SLOTS:
 	void show_int_input_dialog(const std::string &title,
 		const std::string &label, int value, int step, int min, int max);
 
+	/**
+	 * Execute the commands of a UiBatch in one pass and emit
+	 * batch_executed() with the actual ids of the placeholders.
+	 */
+	void execute_batch(
+		shared_ptr<std::vector<sv::python::UiCommand>> commands);
+
 private:
 	Session &session_;
 
+	/*
+	 * The create functions are shared by the slots and execute_batch(). They
+	 * return the id of the new tab, view or curve or an empty string.
+	 */
+	string create_device_tab(shared_ptr<sv::devices::BaseDevice> device);
+	string create_data_view(const string &tab_id, Qt::DockWidgetArea area,
+		shared_ptr<sv::data::AnalogTimeSignal> signal);
+	string create_control_view(const string &tab_id, Qt::DockWidgetArea area,
+		shared_ptr<sv::devices::Configurable> configurable);
+	string create_time_plot_view(const string &tab_id, Qt::DockWidgetArea area);
+	string create_xy_plot_view(const string &tab_id, Qt::DockWidgetArea area);
+	string create_power_panel_view(const string &tab_id,
+		Qt::DockWidgetArea area,
+		shared_ptr<sv::data::AnalogTimeSignal> voltage_signal,
+		shared_ptr<sv::data::AnalogTimeSignal> current_signal);
+	string create_value_panel_view(const string &tab_id,
+		Qt::DockWidgetArea area, shared_ptr<sv::channels::BaseChannel> channel);
+	string create_value_panel_view(const string &tab_id,
+		Qt::DockWidgetArea area, shared_ptr<sv::data::AnalogTimeSignal> signal);
+	string create_time_plot_curve(const string &tab_id, const string &view_id,
+		shared_ptr<sv::data::AnalogTimeSignal> signal);
+	string create_xy_plot_curve(const string &tab_id, const string &view_id,
+		shared_ptr<sv::data::AnalogTimeSignal> x_signal,
+		shared_ptr<sv::data::AnalogTimeSignal> y_signal);
+
 	ui::tabs::BaseTab *get_tab(const string &tab_id) const;
 	ui::views::BaseView *get_view(const string &tab_id,
 		const string &view_id) const;
@@ -131,6 +185,8 @@ Q_SIGNALS:
 	void message_box_canceled();
 	void input_dialog_finished(const QVariant &qvar_input);
 	void input_dialog_canceled();
+	void batch_executed(const std::map<std::string, std::string> &ids);
+	void plot_profile_read(const QVariantMap &profile);
 
 };
 
@@ -17,9 +17,13 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <tuple>
+#include <vector>
+#include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 
 #include <QDebug>
@@ -36,12 +40,20 @@
 #include "src/data/analogtimesignal.hpp"
 #include "src/devices/basedevice.hpp"
 #include "src/devices/configurable.hpp"
+#include "src/python/uibatch.hpp"
 #include "src/python/uihelper.hpp"
 #include "src/ui/tabs/basetab.hpp"
+#include "src/ui/widgets/plot/arraycurvedata.hpp"
+#include "src/ui/widgets/plot/basecurvedata.hpp"
+#include "src/ui/widgets/plot/plot.hpp"
 
+using std::make_shared;
+using std::map;
+using std::set;
 using std::shared_ptr;
 using std::string;
 using std::tuple;
+using std::vector;
 
 namespace py = pybind11;
 
@@ -54,6 +66,17 @@ UiProxy::UiProxy(Session &session, shared_ptr<UiHelper> ui_helper) :
 {
 	// For the colors tuple:
 	qRegisterMetaType<std::tuple<int, int, int>>("std::tuple<int, int, int>");
+	// For the curve data of array curves:
+	qRegisterMetaType<sv::ui::widgets::plot::BaseCurveData *>(
+		"sv::ui::widgets::plot::BaseCurveData *");
+	// For the commands and the ids of a batch:
+	qRegisterMetaType<shared_ptr<std::vector<sv::python::UiCommand>>>(
+		"shared_ptr<std::vector<sv::python::UiCommand>>");
+	qRegisterMetaType<std::map<std::string, std::string>>(
+		"std::map<std::string, std::string>");
+	// For the update mode of the plots:
+	qRegisterMetaType<sv::ui::widgets::plot::PlotUpdateMode>(
+		"sv::ui::widgets::plot::PlotUpdateMode");
 
 	connect(this, &UiProxy::add_device_tab,
 		ui_helper_.get(), &UiHelper::add_device_tab);
@@ -86,10 +109,19 @@ UiProxy::UiProxy(Session &session, shared_ptr<UiHelper> ui_helper) :
 		ui_helper_.get(), &UiHelper::add_curve_to_time_plot_view);
 	connect(this, &UiProxy::add_curve_to_xy_plot_view,
 		ui_helper_.get(), &UiHelper::add_curve_to_xy_plot_view);
+	connect(this, &UiProxy::add_array_curve_to_plot_view,
+		ui_helper_.get(), &UiHelper::add_array_curve_to_plot_view);
 	connect(this, &UiProxy::set_curve_name,
 		ui_helper_.get(), &UiHelper::set_curve_name);
 	connect(this, &UiProxy::set_curve_color,
 		ui_helper_.get(), &UiHelper::set_curve_color);
+	connect(this, &UiProxy::set_plot_update_mode,
+		ui_helper_.get(), &UiHelper::set_plot_update_mode);
+	connect(this, &UiProxy::read_plot_profile,
+		ui_helper_.get(), &UiHelper::read_plot_profile);
+
+	connect(this, &UiProxy::execute_batch,
+		ui_helper_.get(), &UiHelper::execute_batch);
 
 	connect(this, &UiProxy::show_message_box,
 		ui_helper_.get(), &UiHelper::show_message_box);
@@ -243,6 +275,45 @@ string UiProxy::ui_add_curve_to_xy_plot_view(const string &tab_id,
 	return id;
 }
 
+string UiProxy::ui_add_array_curve_to_plot_view(const string &tab_id,
+	const string &view_id,
+	py::array_t<double, py::array::c_style | py::array::forcecast> x_values,
+	py::array_t<double, py::array::c_style | py::array::forcecast> y_values,
+	data::Quantity x_quantity, set<data::QuantityFlag> x_quantity_flags,
+	data::Unit x_unit,
+	data::Quantity y_quantity, set<data::QuantityFlag> y_quantity_flags,
+	data::Unit y_unit, const string &name)
+{
+	if (x_values.ndim() != 1 || y_values.ndim() != 1 ||
+			x_values.size() != y_values.size()) {
+		qWarning() << "UiProxy::ui_add_array_curve_to_plot_view(): x and y "
+			"must be one dimensional arrays of the same size";
+		return "";
+	}
+
+	// One copy with the GIL held, the arrays are then read without Python
+	auto x = make_shared<vector<double>>(
+		x_values.data(), x_values.data() + x_values.size());
+	auto y = make_shared<vector<double>>(
+		y_values.data(), y_values.data() + y_values.size());
+	auto curve_data = new sv::ui::widgets::plot::ArrayCurveData(x, y,
+		QString::fromStdString(name), x_quantity, x_quantity_flags, x_unit,
+		y_quantity, y_quantity_flags, y_unit);
+	curve_data->moveToThread(ui_helper_->thread());
+
+	string id;
+	{
+		// Other Python threads can run, while the curve is added
+		py::gil_scoped_release release;
+		init_wait_for_curve_added(id);
+		Q_EMIT add_array_curve_to_plot_view(tab_id, view_id, curve_data);
+		event_loop_.exec();
+		finish_wait_for_signal();
+	}
+
+	return id;
+}
+
 void UiProxy::ui_set_curve_name(const string &tab_id, const string &view_id,
 	const string &curve_id, const string &name)
 {
@@ -255,6 +326,53 @@ void UiProxy::ui_set_curve_color(const string &tab_id, const string &view_id,
 	Q_EMIT set_curve_color(tab_id, view_id, curve_id, color);
 }
 
+void UiProxy::ui_set_plot_update_mode(const string &tab_id,
+	const string &view_id, ui::widgets::plot::PlotUpdateMode update_mode)
+{
+	Q_EMIT set_plot_update_mode(tab_id, view_id, update_mode);
+}
+
+py::object UiProxy::ui_get_plot_profile(const string &tab_id,
+	const string &view_id, bool reset)
+{
+	QVariantMap qprofile;
+	{
+		py::gil_scoped_release release;
+		init_wait_for_plot_profile(qprofile);
+		Q_EMIT read_plot_profile(tab_id, view_id, reset);
+		event_loop_.exec();
+		finish_wait_for_signal();
+	}
+
+	if (qprofile.isEmpty())
+		return py::cast<py::none>(Py_None);
+
+	py::dict profile;
+	for (auto it = qprofile.constBegin(); it != qprofile.constEnd(); ++it) {
+		const string key = it.key().toStdString();
+		if (it.value().type() == QVariant::Double)
+			profile[py::str(key)] = it.value().toDouble();
+		else
+			profile[py::str(key)] = it.value().toULongLong();
+	}
+	return profile;
+}
+
+map<string, string> UiProxy::ui_execute_batch(UiBatch &batch)
+{
+	map<string, string> ids;
+	if (batch.size() == 0)
+		return ids;
+
+	// One round trip for the whole batch, the timeout grows with the batch
+	const auto commands = batch.take_commands();
+	init_wait_for_batch_executed(ids, 1000 + 100 * (int)commands->size());
+	Q_EMIT execute_batch(commands);
+	event_loop_.exec();
+	finish_wait_for_signal();
+
+	return ids;
+}
 
 bool UiProxy::ui_show_message_box(const std::string &title,
 	const std::string &text)
@@ -273,10 +391,14 @@ py::object UiProxy::ui_show_string_input_dialog(const string &title,
 {
 	bool ok;
 	QVariant qvar;
-	init_wait_for_input_dialog(ok, qvar);
-	Q_EMIT show_string_input_dialog(title, label, value);
-	event_loop_.exec();
-	finish_wait_for_signal();
+	{
+		// Other Python threads can run, while the dialog is shown
+		py::gil_scoped_release release;
+		init_wait_for_input_dialog(ok, qvar);
+		Q_EMIT show_string_input_dialog(title, label, value);
+		event_loop_.exec();
+		finish_wait_for_signal();
+	}
 
 	if (!ok)
 		return py::cast<py::none>(Py_None);
@@ -289,11 +411,14 @@ py::object UiProxy::ui_show_double_input_dialog(const string &title,
 {
 	bool ok;
 	QVariant qvar;
-	init_wait_for_input_dialog(ok, qvar);
-	Q_EMIT show_double_input_dialog(
-		title, label, value, decimals, step, min, max);
-	event_loop_.exec();
-	finish_wait_for_signal();
+	{
+		py::gil_scoped_release release;
+		init_wait_for_input_dialog(ok, qvar);
+		Q_EMIT show_double_input_dialog(
+			title, label, value, decimals, step, min, max);
+		event_loop_.exec();
+		finish_wait_for_signal();
+	}
 
 	if (!ok)
 		return py::cast<py::none>(Py_None);
@@ -305,10 +430,13 @@ py::object UiProxy::ui_show_int_input_dialog(const string &title,
 {
 	bool ok;
 	QVariant qvar;
-	init_wait_for_input_dialog(ok, qvar);
-	Q_EMIT show_int_input_dialog(title, label, value, step, min, max);
-	event_loop_.exec();
-	finish_wait_for_signal();
+	{
+		py::gil_scoped_release release;
+		init_wait_for_input_dialog(ok, qvar);
+		Q_EMIT show_int_input_dialog(title, label, value, step, min, max);
+		event_loop_.exec();
+		finish_wait_for_signal();
+	}
 
 	if (!ok)
 		return py::cast<py::none>(Py_None);
@@ -413,6 +541,41 @@ void UiProxy::init_wait_for_input_dialog(bool &ok, QVariant &qvar, int timeout)
 	}
 }
 
+void UiProxy::init_wait_for_plot_profile(QVariantMap &profile, int timeout)
+{
+	event_loop_finished_conn_ =
+		connect(ui_helper_.get(), &UiHelper::plot_profile_read, this,
+			[this, &profile](const QVariantMap &qprofile) {
+				profile = qprofile;
+				event_loop_.quit();
+			});
+
+	if (timeout > 0) {
+		timer_.setSingleShot(true);
+		timer_conn_ = connect(&timer_, &QTimer::timeout,
+			&event_loop_, &QEventLoop::quit);
+		timer_.start(timeout);
+	}
+}
+
+void UiProxy::init_wait_for_batch_executed(map<string, string> &ids,
+	int timeout)
+{
+	event_loop_finished_conn_ =
+		connect(ui_helper_.get(), &UiHelper::batch_executed, this,
+			[this, &ids](const std::map<std::string, std::string> &batch_ids) {
+				ids = batch_ids;
+				event_loop_.quit();
+			});
+
+	if (timeout > 0) {
+		timer_.setSingleShot(true);
+		timer_conn_ = connect(&timer_, &QTimer::timeout,
+			&event_loop_, &QEventLoop::quit);
+		timer_.start(timeout);
+	}
+}
+
 void UiProxy::finish_wait_for_signal()
 {
 	if (event_loop_finished_conn_)
@@ -20,9 +20,13 @@
 #ifndef PYTHON_UIPROXY_HPP
 #define PYTHON_UIPROXY_HPP
 
+#include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <tuple>
+#include <vector>
+#include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 
 #include <QDockWidget>
@@ -32,6 +36,10 @@
 #include <QTimer>
 #include <QVariant>
 
+#include "src/data/datautil.hpp"
+
+using std::map;
+using std::set;
 using std::shared_ptr;
 using std::string;
 using std::tuple;
@@ -52,9 +60,19 @@ namespace devices {
 class BaseDevice;
 class Configurable;
 }
+namespace ui {
+namespace widgets {
+namespace plot {
+class BaseCurveData;
+enum class PlotUpdateMode;
+}
+}
+}
 
 namespace python {
 
+class UiBatch;
+struct UiCommand;
 class UiHelper;
 
 /**
@@ -102,11 +120,37 @@ public:
 		const string &view_id,
 		shared_ptr<data::AnalogTimeSignal> x_signal,
 		shared_ptr<data::AnalogTimeSignal> y_signal);
+	/**
+	 * Add a curve with precomputed samples (e.g. a fit or a spectrum) to a
+	 * time or x/y plot view. The samples are copied once into contiguous
+	 * arrays, that are shared by all copies of the curve.
+	 */
+	string ui_add_array_curve_to_plot_view(const string &tab_id,
+		const string &view_id,
+		py::array_t<double, py::array::c_style | py::array::forcecast> x_values,
+		py::array_t<double, py::array::c_style | py::array::forcecast> y_values,
+		data::Quantity x_quantity, set<data::QuantityFlag> x_quantity_flags,
+		data::Unit x_unit,
+		data::Quantity y_quantity, set<data::QuantityFlag> y_quantity_flags,
+		data::Unit y_unit, const string &name);
 	void ui_set_curve_name(const string &tab_id, const string &view_id,
 		const string &curve_id, const string &name);
 	void ui_set_curve_color(const string &tab_id, const string &view_id,
 		const string &curve_id, tuple<int, int, int> color);
 
+	/**
+	 * Execute the commands of the batch in one pass in the GUI thread. The
+	 * batch is empty afterwards.
+	 *
+	 * @return The actual ids of the placeholder ids of the batch.
+	 */
+	void ui_set_plot_update_mode(const string &tab_id, const string &view_id,
+		ui::widgets::plot::PlotUpdateMode update_mode);
+	py::object ui_get_plot_profile(const string &tab_id,
+		const string &view_id, bool reset);
+
+	map<string, string> ui_execute_batch(UiBatch &batch);
+
 	bool ui_show_message_box(const std::string &title, const std::string &text);
 	py::object ui_show_string_input_dialog(const string &title,
 		const string &label, const string &value);
@@ -122,6 +166,8 @@ private:
 	void init_wait_for_curve_added(string &id, int timeout = 1000);
 	void init_wait_for_message_box(bool &ok, int timeout = 0);
 	void init_wait_for_input_dialog(bool &ok, QVariant &qvar, int timeout = 0);
+	void init_wait_for_batch_executed(map<string, string> &ids, int timeout);
+	void init_wait_for_plot_profile(QVariantMap &profile, int timeout = 1000);
 	void finish_wait_for_signal();
 
 	Session &session_;
@@ -166,10 +212,20 @@ Q_SIGNALS:
 		const std::string &view_id,
 		shared_ptr<sv::data::AnalogTimeSignal> x_signal,
 		shared_ptr<sv::data::AnalogTimeSignal> y_signal);
+	void add_array_curve_to_plot_view(const std::string &tab_id,
+		const std::string &view_id,
+		sv::ui::widgets::plot::BaseCurveData *curve_data);
 	void set_curve_name(const std::string &tab_id, const std::string &view_id,
 		const std::string &curve_id, const std::string &name);
 	void set_curve_color(const std::string &tab_id, const std::string &view_id,
 		const std::string &curve_id, std::tuple<int, int, int> color);
+	void set_plot_update_mode(const std::string &tab_id,
+		const std::string &view_id,
+		sv::ui::widgets::plot::PlotUpdateMode update_mode);
+	void read_plot_profile(const std::string &tab_id,
+		const std::string &view_id, bool reset);
+
+	void execute_batch(shared_ptr<std::vector<sv::python::UiCommand>> commands);
 
 	void show_message_box(const std::string &title, const std::string &text);
 	void show_string_input_dialog(const std::string &title,
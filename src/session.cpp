@@ -17,30 +17,79 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
 #include <list>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
 #include <QDebug>
+#include <QThread>
+#include <QTimer>
 
 #include "session.hpp"
 #include "config.h"
 #include "src/devicemanager.hpp"
+#include "src/loadgovernor.hpp"
+#include "src/soaktest.hpp"
 #include "src/util.hpp"
+#include "src/watchdog.hpp"
+#include "src/workerpool.hpp"
+#include "src/channels/basechannel.hpp"
+#include "src/channels/userchannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/basesignal.hpp"
+#include "src/data/capturefile.hpp"
+#include "src/data/capturerecorder.hpp"
+#include "src/data/fft.hpp"
+#include "src/data/limitengine.hpp"
+#include "src/data/metricsexporter.hpp"
+#include "src/data/properties/doubleproperty.hpp"
+#include "src/data/remoteserver.hpp"
+#include "src/data/sessioncheckpoint.hpp"
+#include "src/data/signalregistry.hpp"
+#include "src/data/skewestimator.hpp"
+#include "src/data/signalstreamer.hpp"
+#include "src/data/timealignment.hpp"
+#include "src/data/triggerengine.hpp"
 #include "src/devices/basedevice.hpp"
+#include "src/devices/configurable.hpp"
+#include "src/devices/controlengine.hpp"
+#include "src/devices/deviceutil.hpp"
 #include "src/devices/hardwaredevice.hpp"
+#include "src/devices/plugindeviceengine.hpp"
+#include "src/devices/remoteclient.hpp"
+#include "src/devices/replayengine.hpp"
+#include "src/devices/scanlistengine.hpp"
+#include "src/devices/sweepengine.hpp"
 #include "src/devices/userdevice.hpp"
+#include "src/plugins/pluginmanager.hpp"
+#include "src/plugins/smuviewplugin.h"
 #include "src/python/smuscriptrunner.hpp"
+#include "src/ui/views/panelscheduler.hpp"
+#include "src/ui/widgets/plot/envelopecurve.hpp"
+#include "src/ui/widgets/plot/plotscheduler.hpp"
 
+using std::dynamic_pointer_cast;
 using std::list;
+using std::lock_guard;
 using std::make_pair;
 using std::make_shared;
 using std::map;
+using std::pair;
+using std::set;
 using std::shared_ptr;
+using std::static_pointer_cast;
 using std::string;
 using std::vector;
 
@@ -51,25 +100,126 @@ class Context;
 namespace sv {
 
 shared_ptr<sigrok::Context> Session::sr_context;
+WorkerPool *Session::worker_pool = nullptr;
+data::SessionCheckpoint *Session::checkpoint = nullptr;
 double Session::session_start_timestamp = .0;
-
-Session::Session(DeviceManager &device_manager) :
-	device_manager_(device_manager)
+std::chrono::steady_clock::time_point Session::session_start_time_ =
+	std::chrono::steady_clock::now();
+
+const int Session::memory_check_interval;
+const double Session::auto_retention_margin = 10.;
+
+Session::Session(DeviceManager &device_manager,
+		const string &checkpoint_file) :
+	device_manager_(device_manager),
+	signal_registry_(make_shared<data::SignalRegistry>()),
+	memory_budget_(0),
+	memory_budget_spill_(false),
+	auto_retention_(false),
+	last_memory_size_(0),
+	last_spilled_size_(0)
 {
+	// The devices, that are connected below, may already add math channels
+	worker_pool = new WorkerPool(0, this);
+
+	memory_timer_ = new QTimer(this);
+	connect(memory_timer_, &QTimer::timeout,
+		this, &Session::enforce_memory_budget);
+	// The budget can be set from other threads (e.g. scripts), so the timer
+	// always runs. The check returns immediately without a budget and
+	// without the automatic retention.
+	memory_timer_->start(memory_check_interval);
+
+	plot_scheduler_ = new ui::widgets::plot::PlotScheduler(this);
+	panel_scheduler_ = new ui::views::PanelScheduler(this);
+	watchdog_ = new Watchdog(this);
+
+	// The governor only slows down the GUI side, the acquisition always
+	// runs at full rate.
+	load_governor_ = new LoadGovernor(this);
+	connect(load_governor_, &LoadGovernor::level_changed, this, [this]() {
+		plot_scheduler_->set_interval_factor(load_governor_->interval_factor());
+		panel_scheduler_->set_interval_factor(
+			load_governor_->interval_factor());
+		ui::widgets::plot::EnvelopeCurve::set_column_step(
+			load_governor_->column_step());
+	});
+	load_governor_->start();
+
 	smu_script_runner_ = make_shared<python::SmuScriptRunner>(*this);
 	connect(smu_script_runner_.get(), &python::SmuScriptRunner::script_error,
 		this, &Session::error_handler);
 
+	// The devices restore their signals from the checkpoint, when they
+	// are opened
+	if (!checkpoint_file.empty())
+		start_checkpoint(checkpoint_file);
+
 	// Connect devices
-	for (const auto &device : device_manager.user_spec_devices()) {
-		this->add_device(device);
-	}
+	this->add_devices(device_manager.user_spec_devices());
 }
 
 Session::~Session()
 {
+	// Stopping the devices and engines blocks the GUI thread on purpose
+	watchdog_->stop();
+
+	for (auto &soak_test : soak_tests_)
+		soak_test->stop();
+	for (auto &replay_engine : replay_engines_)
+		replay_engine->stop();
+	for (auto &scan_list_engine : scan_list_engines_)
+		scan_list_engine->stop();
+	for (auto &sweep_engine : sweep_engines_)
+		sweep_engine->stop();
+	for (auto &control_engine : control_engines_)
+		control_engine->stop();
+	for (auto &plugin_device_engine : plugin_device_engines_)
+		plugin_device_engine->stop();
+
+	// Write the last samples, before the devices are closed
+	for (auto &capture_recorder : capture_recorders_)
+		capture_recorder->stop();
+	if (checkpoint_) {
+		checkpoint_->stop();
+		checkpoint = nullptr;
+	}
+	for (auto &signal_streamer : signal_streamers_)
+		signal_streamer->stop();
+	for (auto &metrics_exporter : metrics_exporters_)
+		metrics_exporter->stop();
+	for (auto &remote_server : remote_servers_)
+		remote_server->stop();
+	for (auto &remote_client : remote_clients_)
+		remote_client->stop();
+
 	for (auto &device_pair_ : device_map_)
 		device_pair_.second->close();
+
+	// The math channels are destroyed with the devices, after the workers
+	// have stopped.
+	worker_pool->stop();
+	worker_pool = nullptr;
+}
+
+void Session::init_session_start_timestamp()
+{
+	// Take both clocks close together, the steady clock has no epoch
+	session_start_time_ = std::chrono::steady_clock::now();
+	const auto wall_time = std::chrono::system_clock::now();
+	session_start_timestamp = std::chrono::duration<double>(
+		wall_time.time_since_epoch()).count();
+}
+
+int64_t Session::session_time_ns()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now() - session_start_time_).count();
+}
+
+double Session::timestamp()
+{
+	return session_start_timestamp + (double)session_time_ns() / 1e9;
 }
 
 DeviceManager &Session::device_manager()
@@ -82,11 +232,16 @@ const DeviceManager &Session::device_manager() const
 	return device_manager_;
 }
 
-map<string, shared_ptr<devices::BaseDevice>> Session::device_map() const
+const map<string, shared_ptr<devices::BaseDevice>> &Session::device_map() const
 {
 	return device_map_;
 }
 
+shared_ptr<data::SignalRegistry> Session::signal_registry() const
+{
+	return signal_registry_;
+}
+
 list<shared_ptr<devices::HardwareDevice>>
 	Session::connect_device(const string &conn_string)
 {
@@ -99,8 +254,7 @@ list<shared_ptr<devices::HardwareDevice>>
 	list<shared_ptr<devices::HardwareDevice>> devices =
 		device_manager_.driver_scan(driver_name, driver_opts);
 
-	for (auto &device : devices)
-		add_device(device);
+	add_devices(devices);
 
 	return devices;
 }
@@ -109,18 +263,83 @@ void Session::add_device(shared_ptr<devices::BaseDevice> device)
 {
 	assert(device);
 
+	if (open_device(device))
+		insert_device(device);
+}
+
+void Session::add_devices(
+	const list<shared_ptr<devices::HardwareDevice>> &devices)
+{
+	// Most of the time of open() is spent waiting for the device I/O of the
+	// configurables, so each driver gets its own thread.
+	map<string, vector<shared_ptr<devices::HardwareDevice>>> driver_devices;
+	for (const auto &device : devices) {
+		assert(device);
+		driver_devices[device->sr_hardware_device()->driver()->name()].
+			push_back(device);
+	}
+
+	set<shared_ptr<devices::HardwareDevice>> opened_devices;
+	if (driver_devices.size() <= 1) {
+		for (const auto &device : devices) {
+			if (open_device(device))
+				opened_devices.insert(device);
+		}
+	}
+	else {
+		std::mutex opened_mutex;
+		QThread *thread = this->thread();
+		vector<std::thread> open_threads;
+		for (const auto &driver_pair : driver_devices) {
+			const auto &group = driver_pair.second;
+			open_threads.push_back(std::thread([&group, &opened_devices,
+					&opened_mutex, thread]() {
+				for (const auto &device : group) {
+					if (!open_device(device))
+						continue;
+					// The device is published and used in the thread of
+					// the session
+					device->move_objects_to_thread(thread);
+					lock_guard<std::mutex> lock(opened_mutex);
+					opened_devices.insert(device);
+				}
+			}));
+		}
+		for (auto &open_thread : open_threads)
+			open_thread.join();
+	}
+
+	for (const auto &device : devices) {
+		if (opened_devices.count(device) > 0)
+			insert_device(device);
+	}
+}
+
+bool Session::open_device(shared_ptr<devices::BaseDevice> device)
+{
 	try {
 		device->open();
 	}
 	catch (const QString &e) {
 		qCritical() << e;
-		device.reset();
+		return false;
+	}
+	catch (const std::exception &e) {
+		qCritical() << "Session::open_device(): Can't open" <<
+			device->full_name() << ":" << e.what();
+		return false;
 	}
+	return true;
+}
 
+void Session::insert_device(shared_ptr<devices::BaseDevice> device)
+{
 	connect(device.get(), &devices::BaseDevice::device_error,
 		this, &Session::error_handler);
 
 	device_map_.insert(make_pair(device->id(), device));
+	signal_registry_->add_device(device);
+	update_device_exporters();
 
 	Q_EMIT device_added(device);
 }
@@ -138,6 +357,398 @@ shared_ptr<devices::UserDevice> Session::add_user_device()
 	return device;
 }
 
+shared_ptr<devices::ReplayEngine> Session::replay_csv_file(
+	const string &file_name, double speed, bool loop)
+{
+	auto replay_engine = make_shared<devices::ReplayEngine>(add_user_device());
+	if (!replay_engine->load_csv(file_name))
+		return nullptr;
+
+	replay_engine->start(speed, loop);
+	replay_engines_.push_back(replay_engine);
+	return replay_engine;
+}
+
+shared_ptr<devices::ScanListEngine> Session::add_scan_list(
+	shared_ptr<data::AnalogTimeSignal> signal)
+{
+	if (!signal)
+		return nullptr;
+
+	auto scan_list_engine = make_shared<devices::ScanListEngine>(
+		add_user_device(), signal);
+	scan_list_engines_.push_back(scan_list_engine);
+	return scan_list_engine;
+}
+
+shared_ptr<devices::SweepEngine> Session::add_sweep(
+	shared_ptr<devices::Configurable> configurable,
+	devices::ConfigKey config_key)
+{
+	if (!configurable)
+		return nullptr;
+	auto setpoint = dynamic_pointer_cast<data::properties::DoubleProperty>(
+		configurable->get_property(config_key));
+	if (!setpoint || !setpoint->is_setable()) {
+		qWarning() << "Session::add_sweep(): " <<
+			configurable->display_name() << " can't set " <<
+			devices::deviceutil::format_config_key(config_key);
+		return nullptr;
+	}
+
+	auto sweep_engine = make_shared<devices::SweepEngine>(
+		add_user_device(), setpoint);
+	sweep_engines_.push_back(sweep_engine);
+	return sweep_engine;
+}
+
+shared_ptr<devices::ControlEngine> Session::add_control_loop(
+	shared_ptr<data::AnalogTimeSignal> signal,
+	shared_ptr<devices::Configurable> configurable,
+	devices::ConfigKey config_key)
+{
+	if (!signal || !configurable)
+		return nullptr;
+	auto output = dynamic_pointer_cast<data::properties::DoubleProperty>(
+		configurable->get_property(config_key));
+	if (!output || !output->is_setable()) {
+		qWarning() << "Session::add_control_loop(): " <<
+			configurable->display_name() << " can't set " <<
+			devices::deviceutil::format_config_key(config_key);
+		return nullptr;
+	}
+
+	auto control_engine = make_shared<devices::ControlEngine>(signal, output);
+	control_engines_.push_back(control_engine);
+	return control_engine;
+}
+
+shared_ptr<devices::PluginDeviceEngine> Session::add_plugin_device(
+	const string &virtual_device_id, const string &args)
+{
+	const sv_virtual_device *virtual_device =
+		plugins::PluginManager::find_virtual_device(virtual_device_id);
+	if (!virtual_device) {
+		qWarning() << "Session::add_plugin_device(): Unknown virtual device" <<
+			QString::fromStdString(virtual_device_id);
+		return nullptr;
+	}
+
+	const string vendor = virtual_device->vendor ?
+		virtual_device->vendor : "SmuView";
+	const string model = virtual_device->model ?
+		virtual_device->model : virtual_device->id;
+	auto device = make_shared<devices::UserDevice>(
+		sr_context, vendor, model, SV_VERSION_STRING);
+	auto plugin_device_engine = make_shared<devices::PluginDeviceEngine>(
+		device, virtual_device, args);
+	if (!plugin_device_engine->is_valid())
+		return nullptr;
+
+	// The channels already exist, when the device is added
+	this->add_device(device);
+	plugin_device_engine->start();
+	plugin_device_engines_.push_back(plugin_device_engine);
+	return plugin_device_engine;
+}
+
+shared_ptr<devices::UserDevice> Session::open_capture_file(
+	const string &file_name)
+{
+	// The signals reference the mapped chunks and keep the reader open
+	auto reader = make_shared<data::CaptureReader>();
+	if (!reader->open(file_name))
+		return nullptr;
+
+	auto device = add_user_device();
+	// The signals of a recorded channel are added to the same user channel
+	map<pair<string, string>, shared_ptr<channels::UserChannel>> channels;
+	const auto &signal_infos = reader->signal_infos();
+	for (size_t i = 0; i < signal_infos.size(); ++i) {
+		const auto &info = signal_infos[i];
+		const auto key = make_pair(info.device_name, info.channel_name);
+		if (channels.count(key) == 0) {
+			// The channel names must be unique in the device
+			string name = info.channel_name;
+			const auto &channel_map = device->channel_map();
+			for (int n = 2; channel_map.count(name) > 0; ++n)
+				name = info.channel_name + " " + std::to_string(n);
+			channels[key] = device->add_user_channel(name, info.device_name);
+		}
+
+		auto signal = static_pointer_cast<data::AnalogTimeSignal>(
+			channels[key]->add_signal(info.quantity, info.quantity_flags,
+				info.unit, info.name));
+		if (!reader->push_samples(i, signal, reader)) {
+			qWarning() << "Session::open_capture_file(): Could not read all "
+				"samples of" << QString::fromStdString(info.name);
+		}
+	}
+
+	return device;
+}
+
+shared_ptr<SoakTest> Session::start_soak_test(const SoakConfig &config)
+{
+	auto soak_test = make_shared<SoakTest>(*this, config);
+	if (!soak_test->start())
+		return nullptr;
+
+	soak_tests_.push_back(soak_test);
+	return soak_test;
+}
+
+shared_ptr<data::CaptureRecorder> Session::record_capture_file(
+	const string &file_name,
+	const vector<shared_ptr<data::AnalogTimeSignal>> &signals,
+	double write_interval, bool compressed)
+{
+	auto capture_recorder = make_shared<data::CaptureRecorder>();
+	capture_recorder->set_write_interval(write_interval);
+	if (!capture_recorder->start(file_name, signals, compressed))
+		return nullptr;
+
+	capture_recorders_.push_back(capture_recorder);
+	return capture_recorder;
+}
+
+bool Session::start_checkpoint(const string &file_name, double interval,
+	bool resume)
+{
+	if (checkpoint_) {
+		checkpoint_->stop();
+		checkpoint = nullptr;
+		checkpoint_ = nullptr;
+	}
+
+	auto session_checkpoint = make_shared<data::SessionCheckpoint>();
+	session_checkpoint->set_interval(interval);
+	if (!session_checkpoint->start(file_name, signal_registry_, resume))
+		return false;
+
+	checkpoint_ = session_checkpoint;
+	checkpoint = checkpoint_.get();
+	return true;
+}
+
+shared_ptr<data::SessionCheckpoint> Session::session_checkpoint() const
+{
+	return checkpoint_;
+}
+
+shared_ptr<data::SignalStreamer> Session::stream_signals(
+	const string &host, uint16_t port,
+	const vector<shared_ptr<data::AnalogTimeSignal>> &signals,
+	data::StreamProtocol protocol, data::StreamFormat format,
+	double send_interval)
+{
+	auto signal_streamer = make_shared<data::SignalStreamer>();
+	signal_streamer->set_send_interval(send_interval);
+	if (!signal_streamer->start(host, port, signals, protocol, format))
+		return nullptr;
+
+	signal_streamers_.push_back(signal_streamer);
+	return signal_streamer;
+}
+
+shared_ptr<data::MetricsExporter> Session::export_metrics(uint16_t port,
+	const vector<shared_ptr<data::AnalogTimeSignal>> &signals,
+	const string &host)
+{
+	auto metrics_exporter = make_shared<data::MetricsExporter>(*this);
+	if (!metrics_exporter->start(port, signals, host))
+		return nullptr;
+
+	metrics_exporters_.push_back(metrics_exporter);
+	update_device_exporters();
+	return metrics_exporter;
+}
+
+shared_ptr<data::RemoteServer> Session::serve_remote(uint16_t port,
+	double send_interval, const string &host)
+{
+	auto remote_server = make_shared<data::RemoteServer>(*this);
+	remote_server->set_send_interval(send_interval);
+	if (!remote_server->start(port, host))
+		return nullptr;
+
+	remote_servers_.push_back(remote_server);
+	update_device_exporters();
+	return remote_server;
+}
+
+shared_ptr<devices::RemoteClient> Session::connect_remote(const string &host,
+	uint16_t port)
+{
+	if (host.empty()) {
+		qWarning() << "Session::connect_remote(): No host";
+		return nullptr;
+	}
+
+	string vendor = "SmuView";
+	string model = "Remote";
+	string version = host + ":" + std::to_string(port);
+	auto device = make_shared<devices::UserDevice>(
+		sr_context, vendor, model, version);
+	this->add_device(device);
+
+	auto remote_client = make_shared<devices::RemoteClient>(device);
+	if (!remote_client->start(host, port))
+		return nullptr;
+
+	remote_clients_.push_back(remote_client);
+	return remote_client;
+}
+
+void Session::update_device_exporters()
+{
+	if (metrics_exporters_.empty() && remote_servers_.empty())
+		return;
+
+	vector<shared_ptr<devices::HardwareDevice>> hardware_devices;
+	for (const auto &device_pair : device_map_) {
+		auto hardware_device = dynamic_pointer_cast<devices::HardwareDevice>(
+			device_pair.second);
+		if (hardware_device)
+			hardware_devices.push_back(hardware_device);
+	}
+	for (const auto &metrics_exporter : metrics_exporters_)
+		metrics_exporter->set_devices(hardware_devices);
+	for (const auto &remote_server : remote_servers_)
+		remote_server->set_devices(hardware_devices);
+}
+
+double Session::start_synchronized(
+	const vector<shared_ptr<devices::BaseDevice>> &devices, double delay)
+{
+	// All devices share the session clock, so one start timestamp is enough
+	const double start_timestamp = Session::timestamp() + std::max(delay, 0.);
+	if (devices.empty()) {
+		for (const auto &device_pair : device_map_)
+			device_pair.second->arm_aquisition(start_timestamp);
+	}
+	else {
+		for (const auto &device : devices)
+			device->arm_aquisition(start_timestamp);
+	}
+	return start_timestamp;
+}
+
+double Session::calibrate_time_offset(
+	shared_ptr<data::AnalogTimeSignal> reference,
+	shared_ptr<data::AnalogTimeSignal> signal,
+	double duration, double max_lag, double resolution)
+{
+	const double nan = std::numeric_limits<double>::quiet_NaN();
+	if (!reference || !signal)
+		return nan;
+	const auto channel = signal->parent_channel();
+	const auto device = channel ? channel->parent_device() : nullptr;
+	if (!device) {
+		qWarning() << "Session::calibrate_time_offset(): The signal has no" <<
+			"device";
+		return nan;
+	}
+
+	// The signal must cover the reference range shifted by max_lag
+	const double end_timestamp = std::min(reference->last_timestamp(false),
+		signal->last_timestamp(false) - max_lag);
+	const double start_timestamp = std::max(end_timestamp - duration,
+		std::max(reference->first_timestamp(false),
+			signal->first_timestamp(false) + max_lag));
+	double offset;
+	if (!data::estimate_time_offset(*reference, *signal, start_timestamp,
+			end_timestamp, max_lag, resolution, offset))
+		return nan;
+
+	device->set_timestamp_offset(device->timestamp_offset() + offset);
+	return offset;
+}
+
+shared_ptr<data::SkewEstimator> Session::add_skew_estimator(
+	shared_ptr<data::AnalogTimeSignal> reference,
+	shared_ptr<data::AnalogTimeSignal> signal,
+	size_t block_size, double resolution, double max_lag, double interval)
+{
+	if (!reference || !signal || reference == signal)
+		return nullptr;
+	if (block_size < 4 || !data::FFT::is_power_of_two(block_size)) {
+		qWarning() << "Session::add_skew_estimator(): The block size" <<
+			block_size << "is not a power of two";
+		return nullptr;
+	}
+	if (!(resolution > 0.) || !(max_lag >= 0.)) {
+		qWarning() << "Session::add_skew_estimator(): Invalid resolution" <<
+			resolution << "or maximum lag" << max_lag;
+		return nullptr;
+	}
+
+	// The estimator may be busy in its worker thread, when it is released
+	shared_ptr<data::SkewEstimator> skew_estimator(
+		new data::SkewEstimator(reference, signal, block_size, resolution,
+			max_lag, interval),
+		[](data::SkewEstimator *estimator) { estimator->deleteLater(); });
+
+	// This may be called from the SmuScript thread, that has no event loop
+	if (worker_pool)
+		worker_pool->move_to_worker(skew_estimator.get());
+	else
+		skew_estimator->moveToThread(this->thread());
+
+	// Estimate the samples, that are already in the signals
+	QMetaObject::invokeMethod(skew_estimator.get(), "on_samples_appended",
+		Qt::QueuedConnection);
+
+	skew_estimators_.push_back(skew_estimator);
+	return skew_estimator;
+}
+
+shared_ptr<data::TriggerEngine> Session::add_trigger_engine(
+	shared_ptr<data::AnalogTimeSignal> signal)
+{
+	// The engine may be busy in its worker thread, when it is released
+	shared_ptr<data::TriggerEngine> trigger_engine(
+		new data::TriggerEngine(signal),
+		[](data::TriggerEngine *engine) { engine->deleteLater(); });
+
+	// This may be called from the SmuScript thread, that has no event loop
+	if (worker_pool)
+		worker_pool->move_to_worker(trigger_engine.get());
+	else
+		trigger_engine->moveToThread(this->thread());
+
+	trigger_engines_.push_back(trigger_engine);
+	return trigger_engine;
+}
+
+shared_ptr<data::LimitEngine> Session::add_limit_engine(
+	shared_ptr<data::AnalogTimeSignal> signal)
+{
+	// The engine may be busy in its worker thread, when it is released
+	shared_ptr<data::LimitEngine> limit_engine(
+		new data::LimitEngine(signal),
+		[](data::LimitEngine *engine) { engine->deleteLater(); });
+
+	// This may be called from the SmuScript thread, that has no event loop
+	if (worker_pool)
+		worker_pool->move_to_worker(limit_engine.get());
+	else
+		limit_engine->moveToThread(this->thread());
+
+	{
+		lock_guard<std::mutex> lock(limit_engines_mutex_);
+		limit_engines_.push_back(limit_engine);
+	}
+	Q_EMIT limit_engines_changed();
+	return limit_engine;
+}
+
+vector<shared_ptr<data::LimitEngine>> Session::limit_engines() const
+{
+	lock_guard<std::mutex> lock(limit_engines_mutex_);
+	return limit_engines_;
+}
+
 void Session::remove_device(shared_ptr<devices::BaseDevice> device)
 {
 	if (device) {
@@ -147,6 +758,8 @@ void Session::remove_device(shared_ptr<devices::BaseDevice> device)
 			this, &Session::error_handler);
 
 		device_map_.erase(device->id());
+		signal_registry_->remove_device(device);
+		update_device_exporters();
 
 		Q_EMIT device_removed(device);
 	}
@@ -173,10 +786,168 @@ MainWindow *Session::main_window() const
 	return main_window_;
 }
 
+ui::widgets::plot::PlotScheduler *Session::plot_scheduler() const
+{
+	return plot_scheduler_;
+}
+
+ui::views::PanelScheduler *Session::panel_scheduler() const
+{
+	return panel_scheduler_;
+}
+
+Watchdog *Session::watchdog() const
+{
+	return watchdog_;
+}
+
+LoadGovernor *Session::load_governor() const
+{
+	return load_governor_;
+}
+
 void Session::error_handler(const std::string &sender, const std::string &msg)
 {
 	qCritical() << QString::fromStdString(sender) <<
 		" error: " << QString::fromStdString(msg);
 }
 
+size_t Session::memory_size() const
+{
+	size_t size = 0;
+	for (const auto &device_pair : device_map_)
+		size += device_pair.second->memory_size();
+	return size;
+}
+
+size_t Session::spilled_size() const
+{
+	size_t size = 0;
+	for (const auto &device_pair : device_map_)
+		size += device_pair.second->spilled_size();
+	return size;
+}
+
+size_t Session::last_memory_size() const
+{
+	return last_memory_size_;
+}
+
+size_t Session::last_spilled_size() const
+{
+	return last_spilled_size_;
+}
+
+void Session::set_memory_budget(size_t memory_budget)
+{
+	memory_budget_ = memory_budget;
+}
+
+size_t Session::memory_budget() const
+{
+	return memory_budget_;
+}
+
+void Session::set_memory_budget_spill(bool memory_budget_spill)
+{
+	memory_budget_spill_ = memory_budget_spill;
+}
+
+bool Session::memory_budget_spill() const
+{
+	return memory_budget_spill_;
+}
+
+void Session::set_auto_retention(bool auto_retention)
+{
+	auto_retention_ = auto_retention;
+}
+
+bool Session::auto_retention() const
+{
+	return auto_retention_;
+}
+
+void Session::apply_auto_retention()
+{
+	const auto signals = signal_registry_->signals();
+	for (const auto &signal : *signals) {
+		auto time_signal = dynamic_pointer_cast<data::AnalogTimeSignal>(signal);
+		if (!time_signal)
+			continue;
+		const double history = time_signal->required_history();
+		if (std::isinf(history))
+			continue;
+		// Math channels only need the new samples, but a lagging worker
+		// still needs the samples, that it wasn't called with yet.
+		time_signal->evict_samples_older_than(history + auto_retention_margin,
+			time_signal->pending_sample_pos());
+	}
+}
+
+void Session::enforce_memory_budget()
+{
+	if (auto_retention_)
+		apply_auto_retention();
+
+	size_t used = memory_size();
+	last_memory_size_ = used;
+	last_spilled_size_ = spilled_size();
+
+	const size_t memory_budget = memory_budget_;
+	if (memory_budget == 0)
+		return;
+	if (used <= memory_budget)
+		return;
+
+	const auto signals = signal_registry_->signals();
+	// Lowest priority first, then the biggest signals
+	vector<pair<shared_ptr<data::BaseSignal>, size_t>> candidates;
+	candidates.reserve(signals->size());
+	for (const auto &signal : *signals)
+		candidates.push_back(make_pair(signal, signal->memory_size()));
+	std::stable_sort(candidates.begin(), candidates.end(),
+		[](const pair<shared_ptr<data::BaseSignal>, size_t> &a,
+				const pair<shared_ptr<data::BaseSignal>, size_t> &b) {
+			if (a.first->memory_priority() != b.first->memory_priority())
+				return a.first->memory_priority() < b.first->memory_priority();
+			return a.second > b.second;
+		});
+
+	// Spilled signals stop growing in memory. Spill one more signal per
+	// check, the following samples show if that was enough.
+	if (memory_budget_spill_) {
+		for (const auto &candidate : candidates) {
+			if (candidate.first->spill_to_disk())
+				continue;
+			if (candidate.first->set_spill_to_disk(true)) {
+				qWarning() << "Session::enforce_memory_budget(): Spilling "
+					<< candidate.first->display_name();
+				return;
+			}
+		}
+	}
+
+	// Evict the oldest samples, until the budget is met
+	for (const auto &candidate : candidates) {
+		if (used <= memory_budget)
+			break;
+		const size_t size = candidate.second;
+		const size_t count = candidate.first->retained_sample_count();
+		if (size == 0 || count <= 1)
+			continue;
+
+		const size_t bytes_per_sample = std::max((size_t)1, size / count);
+		const size_t excess = used - memory_budget;
+		const size_t evict = std::min(count,
+			(excess + bytes_per_sample - 1) / bytes_per_sample);
+		const size_t evicted = candidate.first->evict_samples(evict);
+		if (evicted == 0)
+			continue;
+		qWarning() << "Session::enforce_memory_budget(): Evicted "
+			<< evicted << " samples of " << candidate.first->display_name();
+		used -= std::min(used, evicted * bytes_per_sample);
+	}
+}
+
 } // namespace sv
@@ -20,18 +20,27 @@
 #ifndef SESSION_HPP
 #define SESSION_HPP
 
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <list>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include <QObject>
 #include <QSettings>
 
+class QTimer;
+
 using std::list;
 using std::map;
 using std::shared_ptr;
 using std::string;
+using std::vector;
 
 namespace sigrok {
 class Context;
@@ -40,61 +49,477 @@ class Context;
 namespace sv {
 
 class DeviceManager;
+class LoadGovernor;
 class MainWindow;
+struct SoakConfig;
+class SoakTest;
+class Watchdog;
+class WorkerPool;
+
+namespace data {
+class AnalogTimeSignal;
+class CaptureRecorder;
+class LimitEngine;
+class MetricsExporter;
+class RemoteServer;
+class SessionCheckpoint;
+class SignalRegistry;
+class SignalStreamer;
+class SkewEstimator;
+class TriggerEngine;
+enum class StreamFormat;
+enum class StreamProtocol;
+}
 
 namespace devices {
 class BaseDevice;
+class Configurable;
+class ControlEngine;
 class HardwareDevice;
+class PluginDeviceEngine;
+class RemoteClient;
+class ReplayEngine;
+class ScanListEngine;
+class SweepEngine;
 class UserDevice;
+enum class ConfigKey;
 }
 
 namespace python {
 class SmuScriptRunner;
 }
 
+namespace ui {
+namespace views {
+class PanelScheduler;
+}
+namespace widgets {
+namespace plot {
+class PlotScheduler;
+}
+}
+}
+
 class Session : public QObject
 {
 	Q_OBJECT
 
 public:
 	static shared_ptr<sigrok::Context> sr_context;
-	// TODO: use std::chrono / std::time
+	/**
+	 * The worker threads for the math channels. Owned by the session,
+	 * nullptr without a session.
+	 */
+	static WorkerPool *worker_pool;
+	/**
+	 * The checkpoints of the session signals, that restore the signals of
+	 * the devices, when they are opened. Owned by the session, nullptr
+	 * without checkpoints.
+	 */
+	static data::SessionCheckpoint *checkpoint;
+	/** The wall time of the session start in seconds since the epoch. */
 	static double session_start_timestamp;
 
+	/**
+	 * Set session_start_timestamp to the current wall time and anchor the
+	 * steady clock of timestamp() to it.
+	 */
+	static void init_session_start_timestamp();
+
+	/**
+	 * Return the nanoseconds since the session start. The time is taken from
+	 * a steady clock, so it never jumps back (e.g. when the wall clock is
+	 * adjusted by NTP).
+	 */
+	static int64_t session_time_ns();
+
+	/**
+	 * Return the current time in seconds since the epoch for timestamping
+	 * samples. It is session_start_timestamp plus the steady session_time_ns(),
+	 * so consecutive timestamps are monotonic and have (at least) microsecond
+	 * resolution.
+	 */
+	static double timestamp();
+
 public:
-	explicit Session(DeviceManager &device_manager);
+	/**
+	 * @param checkpoint_file If set, the checkpoints are started (resumed)
+	 * before the devices are connected, see start_checkpoint().
+	 */
+	explicit Session(DeviceManager &device_manager,
+		const string &checkpoint_file = "");
 	~Session();
 
 	DeviceManager &device_manager();
 	const DeviceManager &device_manager() const;
 
-	map<string, shared_ptr<devices::BaseDevice>> device_map() const;
+	const map<string, shared_ptr<devices::BaseDevice>> &device_map() const;
+	/**
+	 * The index of the signals of all devices. Use it instead of walking the
+	 * devices, channels and signals.
+	 */
+	shared_ptr<data::SignalRegistry> signal_registry() const;
 	list<shared_ptr<devices::HardwareDevice>> connect_device(
 		const string &conn_string);
 	void add_device(shared_ptr<devices::BaseDevice> device);
+	/**
+	 * Open the devices concurrently and add them in their order. Devices of
+	 * the same driver are opened one after the other, because the drivers
+	 * share their state. Devices, that can't be opened, are not added.
+	 */
+	void add_devices(const list<shared_ptr<devices::HardwareDevice>> &devices);
 	shared_ptr<devices::UserDevice> add_user_device();
 	void remove_device(shared_ptr<devices::BaseDevice> device);
 
+	/**
+	 * Replay a CSV file, that was saved by the signal save dialog, through
+	 * a new user device. The replay is stopped with the session.
+	 *
+	 * @param speed The replay speed, 1 is real time. 0 replays as fast as
+	 * possible.
+	 *
+	 * @return The replay engine or nullptr if the file couldn't be loaded.
+	 */
+	shared_ptr<devices::ReplayEngine> replay_csv_file(
+		const string &file_name, double speed, bool loop = false);
+
+	/**
+	 * Create a scan list, that measures the channels of a multiplexer with
+	 * the signal. The measured values are stored in the user channels of a
+	 * new user device. The scan is stopped with the session.
+	 */
+	shared_ptr<devices::ScanListEngine> add_scan_list(
+		shared_ptr<data::AnalogTimeSignal> signal);
+
+	/**
+	 * Create a sweep of the setpoint config key of the configurable, e.g.
+	 * the voltage target of a power supply. The measured values are stored
+	 * in the user channels of a new user device. The sweep is stopped with
+	 * the session.
+	 *
+	 * @return The sweep engine or nullptr if the config key is not a
+	 *         setable double value.
+	 */
+	shared_ptr<devices::SweepEngine> add_sweep(
+		shared_ptr<devices::Configurable> configurable,
+		devices::ConfigKey config_key);
+
+	/**
+	 * Create a control loop from the signal to the config key of the
+	 * configurable, e.g. the current of an electronic load for a constant
+	 * power load. The loop is stopped with the session.
+	 *
+	 * @return The control engine or nullptr if the config key is not a
+	 *         setable double value.
+	 */
+	shared_ptr<devices::ControlEngine> add_control_loop(
+		shared_ptr<data::AnalogTimeSignal> signal,
+		shared_ptr<devices::Configurable> configurable,
+		devices::ConfigKey config_key);
+
+	/**
+	 * Start the virtual device of a native plugin with the arguments on a
+	 * new user device, see plugins::PluginManager. The acquisition is
+	 * stopped with the session.
+	 *
+	 * @return The engine of the device or nullptr if the virtual device
+	 *         doesn't exist or doesn't accept the arguments.
+	 */
+	shared_ptr<devices::PluginDeviceEngine> add_plugin_device(
+		const string &virtual_device_id, const string &args);
+
+	/**
+	 * Open a capture file, that was saved by the signal save dialog or a
+	 * CaptureWriter, in a new user device. A user channel is added for
+	 * every channel in the file and the signals get all samples at once.
+	 * The uncompressed chunks are not copied, the signals reference them in
+	 * the mapped file, that stays open as long as the signals exist.
+	 *
+	 * @return The device or nullptr if the file couldn't be opened.
+	 */
+	shared_ptr<devices::UserDevice> open_capture_file(const string &file_name);
+
+	/**
+	 * Record the signals to a capture file in a background thread, while
+	 * they are acquiring. The recording is stopped with the session.
+	 *
+	 * @param write_interval The new samples are written every
+	 * write_interval seconds.
+	 *
+	 * @return The recorder or nullptr if the file couldn't be created.
+	 */
+	shared_ptr<data::CaptureRecorder> record_capture_file(
+		const string &file_name,
+		const vector<shared_ptr<data::AnalogTimeSignal>> &signals,
+		double write_interval = 1., bool compressed = false);
+
+	/**
+	 * Write periodic checkpoints of all signals of the session to a capture
+	 * file, see SessionCheckpoint. If the file is resumed, the signals of
+	 * the devices and math channels, that are added from now on, are
+	 * restored from the file and continue where the checkpoint ended. The
+	 * checkpoints are stopped with the session.
+	 *
+	 * @param interval The checkpoints are written every interval seconds.
+	 *
+	 * @return false if the file couldn't be opened.
+	 */
+	bool start_checkpoint(const string &file_name, double interval = 60.,
+		bool resume = true);
+	shared_ptr<data::SessionCheckpoint> session_checkpoint() const;
+
+	/**
+	 * Stream the new samples of the signals to a network endpoint in a
+	 * background thread, see SignalStreamer. The streaming is stopped with
+	 * the session.
+	 *
+	 * @param send_interval The new samples are sent every send_interval
+	 * seconds.
+	 *
+	 * @return The streamer or nullptr if there is no host or no signal.
+	 */
+	shared_ptr<data::SignalStreamer> stream_signals(
+		const string &host, uint16_t port,
+		const vector<shared_ptr<data::AnalogTimeSignal>> &signals,
+		data::StreamProtocol protocol, data::StreamFormat format,
+		double send_interval = .1);
+
+	/**
+	 * Export the performance counters of the session and the values of the
+	 * signals over HTTP in the Prometheus text format, see MetricsExporter.
+	 * The exporter is stopped with the session.
+	 *
+	 * @param port The TCP port, 0 chooses a free port.
+	 * @param host The address to listen on, only local scrapers can
+	 * connect by default. "*" exports to all interfaces.
+	 *
+	 * @return The exporter or nullptr if the port couldn't be opened.
+	 */
+	shared_ptr<data::MetricsExporter> export_metrics(uint16_t port,
+		const vector<shared_ptr<data::AnalogTimeSignal>> &signals =
+			vector<shared_ptr<data::AnalogTimeSignal>>(),
+		const string &host = "127.0.0.1");
+
+	/**
+	 * Serve all signals and the properties of the hardware devices of the
+	 * session to remote SmuView clients, see RemoteServer. The server is
+	 * stopped with the session.
+	 *
+	 * @param port The TCP port, 0 chooses a free port.
+	 * @param send_interval The new samples are sent every send_interval
+	 * seconds.
+	 * @param host The address to listen on, only local clients can connect
+	 * by default. "*" serves to all interfaces.
+	 *
+	 * @return The server or nullptr if the port couldn't be opened.
+	 */
+	shared_ptr<data::RemoteServer> serve_remote(uint16_t port,
+		double send_interval = .1, const string &host = "127.0.0.1");
+
+	/**
+	 * Mirror the signals of a remote SmuView server in a new user device,
+	 * see RemoteClient. The client connects in the background and is
+	 * stopped with the session.
+	 *
+	 * @return The client or nullptr if there is no host.
+	 */
+	shared_ptr<devices::RemoteClient> connect_remote(const string &host,
+		uint16_t port);
+
+	/**
+	 * Arm the devices and start their aquisition at the same time of the
+	 * session clock, which timestamps the samples of all devices. The
+	 * samples before the start are discarded, so the signals of the
+	 * devices begin together. The latency of each device is taken into
+	 * account, see BaseDevice::set_timestamp_offset().
+	 *
+	 * @param devices The devices to start, all devices if empty.
+	 * @param delay The time in seconds until the start, so all devices are
+	 *        armed before.
+	 *
+	 * @return The start timestamp.
+	 */
+	double start_synchronized(
+		const vector<shared_ptr<devices::BaseDevice>> &devices,
+		double delay = .5);
+
+	/**
+	 * Calibrate the latency of the device of signal against the device of
+	 * reference, e.g. with both measuring the same voltage steps. The offset
+	 * is estimated from the last duration seconds of both signals (see
+	 * data::estimate_time_offset()) and added to the timestamp offset of the
+	 * device of signal, so its following samples line up with the
+	 * reference.
+	 *
+	 * @return The estimated offset in seconds or NaN if it couldn't be
+	 *         estimated.
+	 */
+	double calibrate_time_offset(
+		shared_ptr<data::AnalogTimeSignal> reference,
+		shared_ptr<data::AnalogTimeSignal> signal,
+		double duration = 10., double max_lag = 1.,
+		double resolution = .001);
+
+	/**
+	 * Continuously estimate the time skew of signal against reference in a
+	 * worker thread and set it as time skew of signal, so both line up,
+	 * when they are combined. See data::SkewEstimator.
+	 *
+	 * @return The estimator or nullptr if the parameters are invalid.
+	 */
+	shared_ptr<data::SkewEstimator> add_skew_estimator(
+		shared_ptr<data::AnalogTimeSignal> reference,
+		shared_ptr<data::AnalogTimeSignal> signal,
+		size_t block_size = 4096, double resolution = .001,
+		double max_lag = .5, double interval = 1.);
+
+	/**
+	 * Start a long running stress test with synthetic devices, math
+	 * channels, plots and exports, see SoakTest. The test is stopped with
+	 * the session, its devices stay in the session.
+	 *
+	 * @return The test or nullptr if it couldn't be started.
+	 */
+	shared_ptr<SoakTest> start_soak_test(const SoakConfig &config);
+
+	/**
+	 * Add a trigger engine for the signal. The engine checks the samples,
+	 * that are appended from now on, in a worker thread.
+	 */
+	shared_ptr<data::TriggerEngine> add_trigger_engine(
+		shared_ptr<data::AnalogTimeSignal> signal);
+
+	/**
+	 * Add a limit engine for the signal, e.g. for a production test. The
+	 * engine checks the samples of its test steps in a worker thread.
+	 */
+	shared_ptr<data::LimitEngine> add_limit_engine(
+		shared_ptr<data::AnalogTimeSignal> signal);
+	vector<shared_ptr<data::LimitEngine>> limit_engines() const;
+
 	shared_ptr<python::SmuScriptRunner> smu_script_runner();
 	void run_smu_script(const string &script_file);
 
 	void set_main_window(MainWindow *main_window);
 	MainWindow *main_window() const;
 
+	/** Return the scheduler, that redraws the plots of all views. */
+	ui::widgets::plot::PlotScheduler *plot_scheduler() const;
+	/** Return the scheduler, that updates the value panels of all views. */
+	ui::views::PanelScheduler *panel_scheduler() const;
+	/** Return the watchdog of the GUI thread, it is started by main(). */
+	Watchdog *watchdog() const;
+	/**
+	 * Return the load governor, that lowers the update rates of the plots,
+	 * panels and data views, while the GUI thread falls behind.
+	 */
+	LoadGovernor *load_governor() const;
+
+	/**
+	 * Return the number of bytes, that are used by the signals of all
+	 * devices in memory (memory_size()) and in spill files (spilled_size()).
+	 */
+	size_t memory_size() const;
+	size_t spilled_size() const;
+	/**
+	 * Return memory_size() and spilled_size() of the last memory check,
+	 * these can be called from any thread.
+	 */
+	size_t last_memory_size() const;
+	size_t last_spilled_size() const;
+
+	/**
+	 * Limit the memory, that is used by the signals of all devices. The
+	 * budget is checked periodically. When it is exceeded, the signals with
+	 * the lowest memory priority (and then the biggest signals) are spilled
+	 * to disk if memory_budget_spill() is set, otherwise (or if all signals
+	 * are already spilled) their oldest samples are evicted.
+	 *
+	 * @param memory_budget The budget in bytes. 0 means unlimited.
+	 */
+	void set_memory_budget(size_t memory_budget);
+	size_t memory_budget() const;
+	void set_memory_budget_spill(bool memory_budget_spill);
+	bool memory_budget_spill() const;
+
+	/**
+	 * Derive the retention of each time signal from its observers: When
+	 * every observer only needs a limited history (e.g. plots in rolling
+	 * mode, value panels, moving averages or a capture recorder, see
+	 * data::BaseSignal::set_observer_history()), the older samples are
+	 * dropped with each memory check. Signals, that aren't observed or that
+	 * are observed by views, that need all samples (e.g. a data table), are
+	 * kept, as well as the samples, that a queued subscriber (e.g. a math
+	 * channel) didn't process yet. The default is off.
+	 */
+	void set_auto_retention(bool auto_retention);
+	bool auto_retention() const;
+
+	/** The interval in milliseconds, in which the budget is checked. */
+	static const int memory_check_interval = 1000;
+	/**
+	 * The samples, that are kept by the automatic retention in addition to
+	 * the required history, in seconds.
+	 */
+	static const double auto_retention_margin;
+
 private:
 	DeviceManager &device_manager_;
 	map<string, shared_ptr<devices::BaseDevice>> device_map_;
+	shared_ptr<data::SignalRegistry> signal_registry_;
 	MainWindow *main_window_;
 	shared_ptr<python::SmuScriptRunner> smu_script_runner_;
+	vector<shared_ptr<devices::ReplayEngine>> replay_engines_;
+	vector<shared_ptr<devices::ScanListEngine>> scan_list_engines_;
+	vector<shared_ptr<devices::SweepEngine>> sweep_engines_;
+	vector<shared_ptr<devices::ControlEngine>> control_engines_;
+	vector<shared_ptr<devices::PluginDeviceEngine>> plugin_device_engines_;
+	vector<shared_ptr<data::CaptureRecorder>> capture_recorders_;
+	shared_ptr<data::SessionCheckpoint> checkpoint_;
+	vector<shared_ptr<data::SignalStreamer>> signal_streamers_;
+	vector<shared_ptr<data::MetricsExporter>> metrics_exporters_;
+	vector<shared_ptr<data::RemoteServer>> remote_servers_;
+	vector<shared_ptr<devices::RemoteClient>> remote_clients_;
+	vector<shared_ptr<data::SkewEstimator>> skew_estimators_;
+	vector<shared_ptr<data::TriggerEngine>> trigger_engines_;
+	vector<shared_ptr<data::LimitEngine>> limit_engines_;
+	mutable std::mutex limit_engines_mutex_;
+	vector<shared_ptr<SoakTest>> soak_tests_;
+	std::atomic<size_t> memory_budget_;
+	std::atomic<bool> memory_budget_spill_;
+	std::atomic<bool> auto_retention_;
+	std::atomic<size_t> last_memory_size_;
+	std::atomic<size_t> last_spilled_size_;
+	QTimer *memory_timer_;
+	ui::widgets::plot::PlotScheduler *plot_scheduler_;
+	ui::views::PanelScheduler *panel_scheduler_;
+	Watchdog *watchdog_;
+	LoadGovernor *load_governor_;
+
+	static std::chrono::steady_clock::time_point session_start_time_;
 
 	void free_unused_memory();
+	/** Drop the samples, that no observer needs, see set_auto_retention(). */
+	void apply_auto_retention();
+	/** Open the device and log the error, if it can't be opened. */
+	static bool open_device(shared_ptr<devices::BaseDevice> device);
+	/** Add an opened device to the session and announce it. */
+	void insert_device(shared_ptr<devices::BaseDevice> device);
+	/**
+	 * Hand the current hardware devices to the metrics exporters and the
+	 * remote servers.
+	 */
+	void update_device_exporters();
 
 private Q_SLOTS:
 	void error_handler(const std::string &sender, const std::string &msg);
+	void enforce_memory_budget();
 
 Q_SIGNALS:
 	void device_added(shared_ptr<sv::devices::BaseDevice> device);
 	void device_removed(shared_ptr<sv::devices::BaseDevice> device);
+	/** A limit engine was added, maybe from the SmuScript thread. */
+	void limit_engines_changed();
 
 };
 
@@ -18,6 +18,7 @@
  */
 
 #include <algorithm>
+#include <map>
 #include <memory>
 #include <string>
 
@@ -33,13 +34,34 @@
 #include "src/devices/configurable.hpp"
 #include "src/devices/deviceutil.hpp"
 
+using std::map;
 using std::shared_ptr;
 using std::string;
 using sv::devices::DeviceType;
 
 namespace sv {
 
+namespace {
+
+/**
+ * Return the value for the key in the map or nullptr. The maps are only
+ * searched and never copied, so restoring many curves and views stays cheap.
+ */
+template<typename Map>
+typename Map::mapped_type find_value(const Map &map,
+	const typename Map::key_type &key)
+{
+	const auto it = map.find(key);
+	if (it == map.end())
+		return nullptr;
+	return it->second;
+}
+
+}
+
 bool SettingsManager::restore_settings_ = true;
+const QString SettingsManager::list_cache_group_ = "ListConfigCache";
+const QString SettingsManager::scan_cache_group_ = "ScanCache";
 
 SettingsManager::SettingsManager()
 {
@@ -154,10 +176,7 @@ std::shared_ptr< sv::devices::BaseDevice > sv::SettingsManager::restore_device(
 	// If a device (key) is stored in the settings, it means, that this device
 	// differs from the device (origin_device) this tab belongs to.
 	string device_id = settings.value(device_key).toString().toStdString();
-	if (session.device_map().count(device_id) == 0)
-		return nullptr;
-
-	return session.device_map()[device_id];
+	return find_value(session.device_map(), device_id);
 }
 
 shared_ptr<devices::Configurable> SettingsManager::restore_configurable(
@@ -176,10 +195,7 @@ shared_ptr<devices::Configurable> SettingsManager::restore_configurable(
 		return nullptr;
 
 	string conf_id = settings.value(configurable_key).toString().toStdString();
-	if (device->configurable_map().count(conf_id) == 0)
-		return nullptr;
-
-	return device->configurable_map()[conf_id];
+	return find_value(device->configurable_map(), conf_id);
 }
 
 shared_ptr<data::properties::BaseProperty> SettingsManager::restore_property(
@@ -201,10 +217,7 @@ shared_ptr<data::properties::BaseProperty> SettingsManager::restore_property(
 	//auto sr_type = settings.value(property_key+"_sr_type").value<int>(); // TODO
 	auto sr_ck = settings.value(property_key+"_sr_ck").value<uint32_t>();
 	auto ck = devices::deviceutil::get_config_key(sr_ck);
-	if (configurable->property_map().count(ck) == 0)
-		return nullptr;
-
-	return configurable->property_map()[ck];
+	return find_value(configurable->property_map(), ck);
 }
 
 shared_ptr<channels::BaseChannel> SettingsManager::restore_channel(
@@ -223,10 +236,7 @@ shared_ptr<channels::BaseChannel> SettingsManager::restore_channel(
 		return nullptr;
 
 	string channel_id = settings.value(channel_key).toString().toStdString();
-	if (device->channel_map().count(channel_id) == 0)
-		return nullptr;
-
-	return device->channel_map()[channel_id];
+	return find_value(device->channel_map(), channel_id);
 }
 
 shared_ptr<data::BaseSignal> SettingsManager::restore_signal(
@@ -250,10 +260,73 @@ shared_ptr<data::BaseSignal> SettingsManager::restore_signal(
 	auto mq = make_pair(
 		data::datautil::get_quantity(sr_q),
 		data::datautil::get_quantity_flags(sr_qf));
-	if (channel->signal_map().count(mq) == 0)
+	const auto &signal_map = channel->signal_map();
+	const auto signal_it = signal_map.find(mq);
+	if (signal_it == signal_map.end() || signal_it->second.empty())
 		return nullptr;
 
-	return channel->signal_map()[mq][0];
+	return signal_it->second[0];
+}
+
+void SettingsManager::save_list_config(const string &model_id,
+	const string &key, const string &list)
+{
+	QSettings settings;
+	settings.beginGroup(list_cache_group_);
+	settings.beginGroup(QString::fromStdString(format_key(model_id)));
+	settings.setValue(QString::fromStdString(format_key(key)),
+		QString::fromStdString(list));
+	settings.endGroup();
+	settings.endGroup();
+}
+
+string SettingsManager::restore_list_config(const string &model_id,
+	const string &key)
+{
+	if (!restore_settings_)
+		return "";
+
+	QSettings settings;
+	settings.beginGroup(list_cache_group_);
+	settings.beginGroup(QString::fromStdString(format_key(model_id)));
+	const QString list =
+		settings.value(QString::fromStdString(format_key(key))).toString();
+	settings.endGroup();
+	settings.endGroup();
+	return list.toStdString();
+}
+
+void SettingsManager::save_scan_spec(const QString &settings_id,
+	const string &spec)
+{
+	QSettings settings;
+	settings.beginGroup(scan_cache_group_);
+	settings.setValue(QString::fromStdString(
+		format_key(settings_id.toStdString())), QString::fromStdString(spec));
+	settings.endGroup();
+}
+
+void SettingsManager::remove_scan_spec(const QString &settings_id)
+{
+	QSettings settings;
+	settings.beginGroup(scan_cache_group_);
+	settings.remove(QString::fromStdString(
+		format_key(settings_id.toStdString())));
+	settings.endGroup();
+}
+
+map<QString, string> SettingsManager::restore_scan_specs()
+{
+	map<QString, string> specs;
+	if (!restore_settings_)
+		return specs;
+
+	QSettings settings;
+	settings.beginGroup(scan_cache_group_);
+	for (const auto &key : settings.childKeys())
+		specs[key] = settings.value(key).toString().toStdString();
+	settings.endGroup();
+	return specs;
 }
 
 } // namespace sv
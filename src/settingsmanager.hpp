@@ -20,12 +20,14 @@
 #ifndef SETTINGSMANAGER_HPP
 #define SETTINGSMANAGER_HPP
 
+#include <map>
 #include <memory>
 #include <string>
 
 #include <QSettings>
 #include <QString>
 
+using std::map;
 using std::shared_ptr;
 using std::string;
 
@@ -219,8 +221,61 @@ public:
 		shared_ptr<sv::devices::BaseDevice> origin_device,
 		const QString &key_prefix = "");
 
+	/**
+	 * Save the list of available values of a config key to the list cache,
+	 * so it doesn't have to be queried again, when a device of the same
+	 * model with the same firmware is connected.
+	 *
+	 * @param[in] model_id The driver, model and firmware of the device.
+	 * @param[in] key The configurable and the config key.
+	 * @param[in] list The list in the GVariant text format.
+	 */
+	static void save_list_config(const string &model_id, const string &key,
+		const string &list);
+
+	/**
+	 * Restore a list of available values from the list cache, see
+	 * save_list_config(). Nothing is restored with the command line
+	 * option -c.
+	 *
+	 * @param[in] model_id The driver, model and firmware of the device.
+	 * @param[in] key The configurable and the config key.
+	 *
+	 * @return The list in the GVariant text format or an empty string.
+	 */
+	static string restore_list_config(const string &model_id,
+		const string &key);
+
+	/**
+	 * Save the driver spec, that reconnects a found device, to the scan
+	 * cache.
+	 *
+	 * @param[in] settings_id The settings id of the device.
+	 * @param[in] spec The driver spec in the format of the -d option.
+	 */
+	static void save_scan_spec(const QString &settings_id, const string &spec);
+
+	/**
+	 * Remove a device from the scan cache, see save_scan_spec().
+	 *
+	 * @param[in] settings_id The settings id of the device.
+	 */
+	static void remove_scan_spec(const QString &settings_id);
+
+	/**
+	 * Restore the scan cache, see save_scan_spec(). Nothing is restored
+	 * with the command line option -c.
+	 *
+	 * @return The driver specs, mapped by the formated settings ids.
+	 */
+	static map<QString, string> restore_scan_specs();
+
 private:
 	static bool restore_settings_;
+	/** The settings group of the list cache. */
+	static const QString list_cache_group_;
+	/** The settings group of the scan cache. */
+	static const QString scan_cache_group_;
 
 };
 
@@ -0,0 +1,724 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QString>
+
+#include "soaktest.hpp"
+#include "src/allocationcounter.hpp"
+#include "src/mainwindow.hpp"
+#include "src/session.hpp"
+#include "src/tracer.hpp"
+#include "src/util.hpp"
+#include "src/watchdog.hpp"
+#include "src/channels/minmaxholdchannel.hpp"
+#include "src/channels/userchannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/analogtimesnapshot.hpp"
+#include "src/data/csvexporter.hpp"
+#include "src/data/datautil.hpp"
+#include "src/data/signalregistry.hpp"
+#include "src/devices/userdevice.hpp"
+#include "src/ui/tabs/devicetab.hpp"
+#include "src/ui/views/timeplotview.hpp"
+
+using std::dynamic_pointer_cast;
+using std::lock_guard;
+using std::set;
+using std::string;
+using std::unique_lock;
+using std::vector;
+
+namespace sv {
+
+namespace {
+
+bool parse_size(const string &str, size_t &value)
+{
+	try {
+		size_t end;
+		const unsigned long long parsed = std::stoull(str, &end);
+		value = (size_t)parsed;
+		return end == str.size();
+	}
+	catch (const std::logic_error &) {
+		return false;
+	}
+}
+
+bool parse_double(const string &str, double &value)
+{
+	try {
+		size_t end;
+		value = std::stod(str, &end);
+		return end == str.size() && std::isfinite(value);
+	}
+	catch (const std::logic_error &) {
+		return false;
+	}
+}
+
+/** Only the generator thread raises the maximum, add_sample() resets it. */
+void update_max(std::atomic<int64_t> &max, int64_t value)
+{
+	int64_t current = max.load(std::memory_order_relaxed);
+	while (value > current &&
+		!max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+	}
+}
+
+/**
+ * Fill values with a sine wave with noise. Every channel gets its own
+ * frequency and amplitude, offset is the time of the first value since the
+ * start of the test.
+ */
+void generate(size_t channel, double offset, double samplerate,
+	std::mt19937 &random, vector<double> &values)
+{
+	std::uniform_real_distribution<double> noise(-.01, .01);
+	const double frequency = 1. + (double)(channel % 7);
+	const double amplitude = 1. + (double)(channel % 3);
+	const double omega = 2. * M_PI * frequency;
+	for (size_t i = 0; i < values.size(); ++i) {
+		const double t = offset + (double)i / samplerate;
+		values[i] = amplitude * std::sin(omega * t) + noise(random);
+	}
+}
+
+/** Return the resident memory of the process or 0 if unknown. */
+size_t resident_size()
+{
+#ifdef __linux__
+	std::ifstream statm("/proc/self/statm");
+	size_t pages = 0;
+	size_t resident_pages = 0;
+	if (statm >> pages >> resident_pages)
+		return resident_pages * (size_t)sysconf(_SC_PAGESIZE);
+#endif
+	return 0;
+}
+
+uint64_t allocation_count()
+{
+	if (AllocationCounter::has_global_counters())
+		return AllocationCounter::global_counts().allocations;
+	return AllocationCounter::domain_counts(AllocationDomain::Storage).
+		allocations + AllocationCounter::domain_counts(
+			AllocationDomain::Scratch).allocations;
+}
+
+/** Return the slope of the least squares line through (x, y) per x. */
+double fit_slope(const vector<double> &x, const vector<double> &y)
+{
+	const double n = (double)x.size();
+	double sum_x = 0.;
+	double sum_y = 0.;
+	for (size_t i = 0; i < x.size(); ++i) {
+		sum_x += x[i];
+		sum_y += y[i];
+	}
+	const double mean_x = sum_x / n;
+	const double mean_y = sum_y / n;
+	double sxx = 0.;
+	double sxy = 0.;
+	for (size_t i = 0; i < x.size(); ++i) {
+		sxx += (x[i] - mean_x) * (x[i] - mean_x);
+		sxy += (x[i] - mean_x) * (y[i] - mean_y);
+	}
+	return sxx > 0. ? sxy / sxx : 0.;
+}
+
+}
+
+const int SoakTest::tick_interval_ = 100;
+
+SoakConfig::SoakConfig() :
+	device_count(4),
+	channel_count(4),
+	samplerate(10000.),
+	packet_size(100),
+	math_channel_count(8),
+	plot_count(4),
+	plot_interval(300.),
+	export_interval(600.),
+	retention(60.),
+	duration(0.),
+	report_interval(60.),
+	seed(0)
+{
+}
+
+bool SoakConfig::parse(const string &spec)
+{
+	for (const auto &option : util::split_string(spec, ":")) {
+		if (option.empty())
+			continue;
+		const size_t pos = option.find('=');
+		if (pos == string::npos) {
+			qWarning() << "SoakConfig::parse(): Missing value of " <<
+				QString::fromStdString(option);
+			return false;
+		}
+		const string key = option.substr(0, pos);
+		const string value = option.substr(pos + 1);
+
+		bool ok;
+		size_t seed_value = 0;
+		if (key == "devices")
+			ok = parse_size(value, device_count) && device_count > 0;
+		else if (key == "channels")
+			ok = parse_size(value, channel_count) && channel_count > 0;
+		else if (key == "samplerate")
+			ok = parse_double(value, samplerate) && samplerate >= 1.;
+		else if (key == "packet_size")
+			ok = parse_size(value, packet_size) && packet_size > 0;
+		else if (key == "math_channels")
+			ok = parse_size(value, math_channel_count);
+		else if (key == "plots")
+			ok = parse_size(value, plot_count);
+		else if (key == "plot_interval")
+			ok = parse_double(value, plot_interval) && plot_interval > 0.;
+		else if (key == "export_interval")
+			ok = parse_double(value, export_interval) && export_interval >= 0.;
+		else if (key == "retention")
+			ok = parse_double(value, retention) && retention > 0.;
+		else if (key == "duration")
+			ok = parse_double(value, duration) && duration >= 0.;
+		else if (key == "report_interval")
+			ok = parse_double(value, report_interval) && report_interval > 0.;
+		else if (key == "report") {
+			report_file = value;
+			ok = true;
+		}
+		else if (key == "seed") {
+			ok = parse_size(value, seed_value);
+			seed = (unsigned int)seed_value;
+		}
+		else {
+			qWarning() << "SoakConfig::parse(): Unknown key " <<
+				QString::fromStdString(key);
+			return false;
+		}
+		if (!ok) {
+			qWarning() << "SoakConfig::parse(): Invalid value of " <<
+				QString::fromStdString(option);
+			return false;
+		}
+	}
+	// The timestamps of a fixed samplerate are stored as one run
+	samplerate = std::floor(samplerate);
+	return true;
+}
+
+SoakTest::SoakTest(Session &session, const SoakConfig &config,
+		QObject *parent) :
+	QObject(parent),
+	session_(session),
+	config_(config),
+	export_count_(0),
+	passed_(true),
+	start_timestamp_(0.),
+	last_tick_ns_(0),
+	last_plot_ns_(0),
+	last_export_ns_(0),
+	last_sample_ns_(0),
+	max_event_loop_latency_(0.),
+	last_sample_count_(0),
+	last_allocations_(0),
+	stop_(false),
+	running_(false),
+	sample_count_(0),
+	max_lateness_ns_(0),
+	max_push_time_ns_(0)
+{
+	connect(&tick_timer_, &QTimer::timeout, this, &SoakTest::on_tick);
+}
+
+SoakTest::~SoakTest()
+{
+	stop();
+}
+
+bool SoakTest::start()
+{
+	if (!devices_.empty()) {
+		qWarning() << "SoakTest::start(): The test was already started";
+		return false;
+	}
+
+	if (!config_.report_file.empty()) {
+		report_file_.open(config_.report_file);
+		if (!report_file_.is_open()) {
+			qWarning() << "SoakTest::start(): Can't create " <<
+				QString::fromStdString(config_.report_file);
+			return false;
+		}
+		report_file_ << "time,samples,samples_per_second,max_lateness_ms," <<
+			"max_push_ms,max_event_loop_ms,memory_mib,resident_mib," <<
+			"allocations,stalls,exports\n";
+	}
+
+	random_.seed(config_.seed != 0 ? config_.seed : std::random_device()());
+	clock_.start();
+	start_timestamp_ = Session::timestamp();
+	add_devices();
+	add_math_channels();
+	apply_retention();
+	reopen_plots();
+
+	last_allocations_ = allocation_count();
+	stop_ = false;
+	running_ = true;
+	generator_thread_ = std::thread(
+		&SoakTest::generator_thread_proc, this, (unsigned int)random_());
+	tick_timer_.start(tick_interval_);
+
+	qDebug() << "SoakTest::start():" << config_.device_count << "devices with" <<
+		config_.channel_count << "channels at" << config_.samplerate << "Hz," <<
+		config_.math_channel_count << "math channels," << config_.plot_count <<
+		"plots";
+	return true;
+}
+
+void SoakTest::stop()
+{
+	if (!generator_thread_.joinable())
+		return;
+
+	tick_timer_.stop();
+	{
+		lock_guard<std::mutex> lock(generator_mutex_);
+		stop_ = true;
+	}
+	stop_cond_.notify_one();
+	generator_thread_.join();
+	running_ = false;
+
+	if (exporter_) {
+		exporter_.reset();
+		QFile::remove(export_file_name_);
+	}
+
+	// The plots are left open, the main window may already be destroyed
+	add_sample(clock_.nsecsElapsed());
+	check_trends();
+	report_file_.close();
+}
+
+bool SoakTest::is_running() const
+{
+	return running_;
+}
+
+const SoakConfig &SoakTest::config() const
+{
+	return config_;
+}
+
+vector<SoakSample> SoakTest::samples() const
+{
+	lock_guard<std::mutex> lock(samples_mutex_);
+	return samples_;
+}
+
+bool SoakTest::passed() const
+{
+	return passed_;
+}
+
+void SoakTest::add_devices()
+{
+	const set<data::QuantityFlag> quantity_flags;
+	vector<double> values(config_.packet_size);
+	for (size_t d = 0; d < config_.device_count; ++d) {
+		auto device = session_.add_user_device();
+		devices_.push_back(device);
+		for (size_t c = 0; c < config_.channel_count; ++c) {
+			auto channel = device->add_user_channel(
+				"CH" + std::to_string(c + 1), "Soak");
+			generate(channels_.size(), 0., config_.samplerate, random_, values);
+			channel->push_samples(values.data(), values.size(),
+				start_timestamp_, config_.samplerate, data::Quantity::Voltage,
+				quantity_flags, data::Unit::Volt, 7, 6);
+			sample_count_ += values.size();
+			channels_.push_back(channel);
+		}
+	}
+}
+
+void SoakTest::add_math_channels()
+{
+	const set<data::QuantityFlag> quantity_flags;
+	for (size_t i = 0; i < config_.math_channel_count; ++i) {
+		// The math channels are added to the device of their signals
+		const size_t device_index = random_() % devices_.size();
+		auto device = devices_[device_index];
+		auto signal = [this, device_index]() {
+			const size_t channel = device_index * config_.channel_count +
+				random_() % config_.channel_count;
+			return dynamic_pointer_cast<data::AnalogTimeSignal>(
+				channels_[channel]->actual_signal());
+		};
+
+		const string name = "Math " + std::to_string(i + 1);
+		switch (random_() % 5) {
+		case 0:
+			device->add_ema_channel(signal(), .1, name, "Math");
+			break;
+		case 1:
+			device->add_moving_median_channel(signal(), 15, name, "Math");
+			break;
+		case 2:
+			device->add_min_max_hold_channel(signal(),
+				channels::MinMaxHoldType::Max, 100, name, "Math");
+			break;
+		case 3:
+			device->add_rms_channel(signal(), 100, name, "Math");
+			break;
+		default:
+			device->add_expression_channel(
+				vector<shared_ptr<data::AnalogTimeSignal>> { signal(), signal() },
+				"(v1 - v2) * 1000", data::Quantity::Voltage, quantity_flags,
+				data::Unit::Volt, name, "Math");
+			break;
+		}
+	}
+}
+
+void SoakTest::apply_retention()
+{
+	// The math channels create their signals with their first samples
+	const auto signal_registry = session_.signal_registry();
+	for (const auto &device : devices_) {
+		const auto device_signals = signal_registry->device_signals(device);
+		for (const auto &signal : *device_signals) {
+			auto analog_signal =
+				dynamic_pointer_cast<data::AnalogTimeSignal>(signal);
+			if (analog_signal &&
+					analog_signal->retention_max_age() != config_.retention)
+				analog_signal->set_retention_max_age(config_.retention);
+		}
+	}
+}
+
+void SoakTest::reopen_plots()
+{
+	MainWindow *main_window = session_.main_window();
+	if (!main_window || config_.plot_count == 0)
+		return;
+
+	close_plots();
+	vector<ui::tabs::DeviceTab *> tabs(devices_.size(), nullptr);
+	for (size_t i = 0; i < config_.plot_count; ++i) {
+		const size_t device_index = i % devices_.size();
+		if (!tabs[device_index]) {
+			tabs[device_index] =
+				main_window->add_device_tab(devices_[device_index]);
+			plot_tab_ids_.push_back(tabs[device_index]->id());
+		}
+
+		// One to three random signals of the device, also of math channels
+		const auto device_signals = session_.signal_registry()->device_signals(
+			devices_[device_index]);
+		auto *view = new ui::views::TimePlotView(session_);
+		const size_t curve_count = 1 + random_() % 3;
+		for (size_t c = 0; c < curve_count && !device_signals->empty(); ++c) {
+			auto signal = dynamic_pointer_cast<data::AnalogTimeSignal>(
+				(*device_signals)[random_() % device_signals->size()]);
+			if (signal)
+				view->add_signal(signal);
+		}
+		tabs[device_index]->add_view(view, Qt::TopDockWidgetArea);
+	}
+}
+
+void SoakTest::close_plots()
+{
+	MainWindow *main_window = session_.main_window();
+	if (!main_window)
+		return;
+
+	for (const auto &tab_id : plot_tab_ids_)
+		main_window->remove_tab(tab_id);
+	plot_tab_ids_.clear();
+}
+
+void SoakTest::update_export(qint64 now)
+{
+	if (exporter_ && !exporter_->is_running()) {
+		exporter_.reset();
+		QFile::remove(export_file_name_);
+		++export_count_;
+	}
+	// An export, that takes longer than the interval, delays the next one
+	if (exporter_ || config_.export_interval <= 0. ||
+			(double)(now - last_export_ns_) / 1e9 < config_.export_interval)
+		return;
+	last_export_ns_ = now;
+
+	vector<data::AnalogTimeSnapshot> snapshots;
+	const auto signal_registry = session_.signal_registry();
+	for (const auto &device : devices_) {
+		const auto device_signals = signal_registry->device_signals(device);
+		for (const auto &signal : *device_signals) {
+			auto analog_signal =
+				dynamic_pointer_cast<data::AnalogTimeSignal>(signal);
+			if (analog_signal)
+				snapshots.push_back(data::AnalogTimeSnapshot(analog_signal));
+		}
+	}
+	data::CsvExportOptions options;
+	options.separator = ",";
+	options.relative_time = true;
+	options.combined = false;
+	options.combined_timeframe = 0.;
+	options.aggregate_interval = 0.;
+
+	export_file_name_ = QDir::temp().filePath(QString("smuview-soak-%1.csv").
+		arg(QCoreApplication::applicationPid()));
+	exporter_.reset(new data::CsvExporter(snapshots, options));
+	if (!exporter_->start(export_file_name_)) {
+		qWarning() << "SoakTest::update_export(): Can't export to " <<
+			export_file_name_;
+		exporter_.reset();
+	}
+}
+
+void SoakTest::add_sample(qint64 now)
+{
+	apply_retention();
+
+	const double interval = std::max(1e-3,
+		(double)(now - last_sample_ns_) / 1e9);
+	const uint64_t sample_count = sample_count_;
+	const uint64_t allocations = allocation_count();
+
+	SoakSample sample;
+	sample.time = (double)now / 1e9;
+	sample.sample_count = sample_count;
+	sample.samples_per_second =
+		(double)(sample_count - last_sample_count_) / interval;
+	sample.max_lateness = (double)max_lateness_ns_.exchange(0) / 1e9;
+	sample.max_push_time = (double)max_push_time_ns_.exchange(0) / 1e9;
+	sample.max_event_loop_latency = max_event_loop_latency_;
+	sample.memory_size = session_.memory_size();
+	sample.resident_size = resident_size();
+	sample.allocations = allocations - last_allocations_;
+	sample.stall_count = session_.watchdog()->stall_count();
+	sample.export_count = export_count_;
+
+	last_sample_ns_ = now;
+	last_sample_count_ = sample_count;
+	last_allocations_ = allocations;
+	max_event_loop_latency_ = 0.;
+	{
+		lock_guard<std::mutex> lock(samples_mutex_);
+		samples_.push_back(sample);
+	}
+
+	const double mib = 1 << 20;
+	qDebug().noquote() << QString("SoakTest: %1 s, %2 samples/s, "
+		"lateness %3 ms, push %4 ms, event loop %5 ms, memory %6 MiB, "
+		"resident %7 MiB, %8 allocations, %9 stalls").
+		arg(sample.time, 0, 'f', 0).
+		arg(sample.samples_per_second, 0, 'f', 0).
+		arg(sample.max_lateness * 1e3, 0, 'f', 1).
+		arg(sample.max_push_time * 1e3, 0, 'f', 2).
+		arg(sample.max_event_loop_latency * 1e3, 0, 'f', 1).
+		arg((double)sample.memory_size / mib, 0, 'f', 1).
+		arg((double)sample.resident_size / mib, 0, 'f', 1).
+		arg(sample.allocations).
+		arg(sample.stall_count);
+
+	if (report_file_.is_open()) {
+		char line[256];
+		snprintf(line, sizeof(line),
+			"%.3f,%llu,%.1f,%.3f,%.3f,%.3f,%.3f,%.3f,%llu,%llu,%llu\n",
+			sample.time, (unsigned long long)sample.sample_count,
+			sample.samples_per_second, sample.max_lateness * 1e3,
+			sample.max_push_time * 1e3, sample.max_event_loop_latency * 1e3,
+			(double)sample.memory_size / mib,
+			(double)sample.resident_size / mib,
+			(unsigned long long)sample.allocations,
+			(unsigned long long)sample.stall_count,
+			(unsigned long long)sample.export_count);
+		report_file_ << line;
+		report_file_.flush();
+	}
+}
+
+void SoakTest::check_trends()
+{
+	// Skip the warm-up, until the signals have reached their retention
+	const double warm_up = config_.retention + config_.report_interval;
+	vector<SoakSample> trend;
+	for (const auto &sample : samples()) {
+		if (sample.time >= warm_up)
+			trend.push_back(sample);
+	}
+	if (trend.size() < 4) {
+		qDebug() << "SoakTest::check_trends(): The test was too short to " <<
+			"check the trends";
+		return;
+	}
+
+	vector<double> hours;
+	for (const auto &sample : trend)
+		hours.push_back(sample.time / 3600.);
+	const double span = hours.back() - hours.front();
+
+	/*
+	 * The change over the test is the slope of the fitted line times the
+	 * span, a change above the limit (absolute or relative to the mean)
+	 * fails the test.
+	 */
+	auto check = [this, &trend, &hours, span](const QString &name,
+			std::function<double(const SoakSample &)> value, double sign,
+			double min_change, double max_rel_change, const QString &unit) {
+		vector<double> values;
+		double mean = 0.;
+		for (const auto &sample : trend) {
+			values.push_back(value(sample));
+			mean += values.back();
+		}
+		mean /= (double)values.size();
+		const double slope = fit_slope(hours, values);
+		const double change = sign * slope * span;
+		if (change > std::max(min_change, max_rel_change * std::fabs(mean))) {
+			qWarning().noquote() << QString("SoakTest: %1 changes by "
+				"%2 %3/h (mean %4 %3)").arg(name).arg(slope, 0, 'f', 3).
+				arg(unit).arg(mean, 0, 'f', 3);
+			passed_ = false;
+		}
+	};
+
+	const double mib = 1 << 20;
+	check("The signal memory", [mib](const SoakSample &s) {
+			return (double)s.memory_size / mib;
+		}, 1., 1., .05, "MiB");
+	if (trend.front().resident_size > 0) {
+		check("The resident memory", [mib](const SoakSample &s) {
+				return (double)s.resident_size / mib;
+			}, 1., 8., .05, "MiB");
+	}
+	check("The throughput", [](const SoakSample &s) {
+			return s.samples_per_second;
+		}, -1., 0., .05, "samples/s");
+	check("The lateness of the generator", [](const SoakSample &s) {
+			return s.max_lateness * 1e3;
+		}, 1., 500., 1., "ms");
+
+	if (passed_) {
+		qDebug().noquote() << QString("SoakTest: No leak and no decay over "
+			"%1 h").arg(span, 0, 'f', 2);
+	}
+}
+
+void SoakTest::on_tick()
+{
+	const qint64 now = clock_.nsecsElapsed();
+	const double latency = std::max(0., (double)(now - last_tick_ns_) / 1e9 -
+		(double)tick_interval_ / 1e3);
+	max_event_loop_latency_ = std::max(max_event_loop_latency_, latency);
+	last_tick_ns_ = now;
+
+	// Closing and opening the plots catches the leaks of the views
+	if (config_.plot_count > 0 &&
+			(double)(now - last_plot_ns_) / 1e9 >= config_.plot_interval) {
+		reopen_plots();
+		last_plot_ns_ = now;
+	}
+	update_export(now);
+	if ((double)(now - last_sample_ns_) / 1e9 >= config_.report_interval)
+		add_sample(now);
+
+	if (config_.duration > 0. && (double)now / 1e9 >= config_.duration) {
+		stop();
+		Q_EMIT finished();
+	}
+}
+
+void SoakTest::generator_thread_proc(unsigned int seed)
+{
+	SV_TRACE_THREAD_NAME("SoakTest");
+
+	std::mt19937 random(seed);
+	const set<data::QuantityFlag> quantity_flags;
+	vector<double> values(config_.packet_size);
+	const double packet_time =
+		(double)config_.packet_size / config_.samplerate;
+	// The first packet was pushed by add_devices()
+	const auto start_time = std::chrono::steady_clock::now();
+	for (uint64_t packet = 1; ; ++packet) {
+		const double offset = (double)packet * packet_time;
+		const auto packet_time_point = start_time +
+			std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+				std::chrono::duration<double>(offset));
+		{
+			unique_lock<std::mutex> lock(generator_mutex_);
+			if (stop_cond_.wait_until(lock, packet_time_point,
+					[this] { return stop_.load(); }))
+				break;
+		}
+
+		// A slow data path delays the generator, it then catches up as fast
+		// as possible
+		update_max(max_lateness_ns_,
+			std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now() - packet_time_point).count());
+		for (size_t i = 0; i < channels_.size(); ++i) {
+			generate(i, offset, config_.samplerate, random, values);
+			const auto push_start = std::chrono::steady_clock::now();
+			channels_[i]->push_samples(values.data(), values.size(),
+				start_timestamp_ + offset, config_.samplerate,
+				data::Quantity::Voltage, quantity_flags, data::Unit::Volt, 7, 6);
+			update_max(max_push_time_ns_,
+				std::chrono::duration_cast<std::chrono::nanoseconds>(
+					std::chrono::steady_clock::now() - push_start).count());
+			sample_count_ += values.size();
+		}
+	}
+}
+
+} // namespace sv
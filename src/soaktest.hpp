@@ -0,0 +1,244 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SOAKTEST_HPP
+#define SOAKTEST_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+using std::shared_ptr;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+namespace sv {
+
+class Session;
+
+namespace channels {
+class UserChannel;
+}
+
+namespace data {
+class AnalogTimeSignal;
+class CsvExporter;
+}
+
+namespace devices {
+class UserDevice;
+}
+
+/**
+ * The configuration of a SoakTest.
+ */
+struct SoakConfig
+{
+	SoakConfig();
+
+	/**
+	 * Parse a spec like "devices=8:channels=4:samplerate=10000:duration=3600".
+	 * The keys are the names of the members, the key of report_file is
+	 * "report". Unset members keep their defaults.
+	 *
+	 * @return false if a key or value is invalid.
+	 */
+	bool parse(const string &spec);
+
+	/** The number of synthetic user devices. */
+	size_t device_count;
+	/** The number of channels of every device. */
+	size_t channel_count;
+	/** The samplerate of every channel in Hz. */
+	double samplerate;
+	/** The number of samples of every channel per packet. */
+	size_t packet_size;
+	/** The number of random math channels on the synthetic signals. */
+	size_t math_channel_count;
+	/** The number of plots, 0 for no plots. Needs a main window. */
+	size_t plot_count;
+	/** The plots are closed and opened again after this time in seconds. */
+	double plot_interval;
+	/** Export all signals to a CSV file after this time, 0 for no exports. */
+	double export_interval;
+	/** The signals keep the samples of this time in seconds. */
+	double retention;
+	/** The run time in seconds, 0 runs until stop() is called. */
+	double duration;
+	/** The trend is sampled after this time in seconds. */
+	double report_interval;
+	/** The trend is also written to this CSV file, if not empty. */
+	string report_file;
+	/** The seed of the random choices, 0 for a random seed. */
+	unsigned int seed;
+};
+
+/**
+ * A sample of the trend of a SoakTest, the rates and maximums are those of
+ * the report interval.
+ */
+struct SoakSample
+{
+	/** The time in seconds since the start of the test. */
+	double time;
+	/** The number of generated samples of all channels. */
+	uint64_t sample_count;
+	double samples_per_second;
+	/** How much the generator was behind its schedule, in seconds. */
+	double max_lateness;
+	/** The longest push of a packet into a channel, in seconds. */
+	double max_push_time;
+	/** The latency of the GUI event loop, in seconds. */
+	double max_event_loop_latency;
+	/** The bytes of all signals, see Session::memory_size(). */
+	size_t memory_size;
+	/** The resident memory of the process or 0 if unknown. */
+	size_t resident_size;
+	/**
+	 * All allocations with ENABLE_ALLOCATION_COUNTERS, else those of the
+	 * signal storage and the scratch buffers, see AllocationCounter.
+	 */
+	uint64_t allocations;
+	size_t stall_count;
+	size_t export_count;
+};
+
+/**
+ * A long running stress test with synthetic load, to find slow leaks and a
+ * decaying performance.
+ *
+ * The test adds user devices, whose channels get sine waves with noise at a
+ * high rate from a generator thread, random math channels on them, plots,
+ * that are closed and opened again, and periodic CSV exports to temporary
+ * files. The signals only keep the samples of the retention time, so the
+ * memory should stay constant after the warm-up.
+ *
+ * Every report interval the throughput, latencies, memory and allocations
+ * are sampled, logged and optionally written to a CSV file. At the end, the
+ * trends after the warm-up are fitted by least squares, a growing memory or
+ * a falling throughput fails the test.
+ */
+class SoakTest : public QObject
+{
+	Q_OBJECT
+
+public:
+	/** Must be created in the GUI thread. */
+	SoakTest(Session &session, const SoakConfig &config,
+		QObject *parent = nullptr);
+	~SoakTest();
+
+	/**
+	 * Add the devices, channels and math channels and start the load.
+	 *
+	 * @return false if the test was already started or the report file
+	 *         couldn't be created.
+	 */
+	bool start();
+	/** Stop the load and check the trends. The devices stay in the session. */
+	void stop();
+	bool is_running() const;
+
+	const SoakConfig &config() const;
+	/** Return the trend samples, the latest last. */
+	vector<SoakSample> samples() const;
+	/**
+	 * Return true if the trends, that were checked by stop(), show no leak
+	 * and no performance decay.
+	 */
+	bool passed() const;
+
+private:
+	/** Push the first samples, so that the channels have their signals. */
+	void add_devices();
+	void add_math_channels();
+	/** Set the retention of all signals of the devices, also new ones. */
+	void apply_retention();
+	void reopen_plots();
+	void close_plots();
+	void update_export(qint64 now);
+	void add_sample(qint64 now);
+	void check_trends();
+	void generator_thread_proc(unsigned int seed);
+
+	/** The interval of the control timer in milliseconds. */
+	static const int tick_interval_;
+
+	Session &session_;
+	const SoakConfig config_;
+	std::mt19937 random_;
+	vector<shared_ptr<devices::UserDevice>> devices_;
+	vector<shared_ptr<channels::UserChannel>> channels_;
+	vector<string> plot_tab_ids_;
+	unique_ptr<data::CsvExporter> exporter_;
+	QString export_file_name_;
+	size_t export_count_;
+	std::ofstream report_file_;
+	bool passed_;
+	/** The timestamp of the first samples. */
+	double start_timestamp_;
+
+	QTimer tick_timer_;
+	QElapsedTimer clock_;
+	qint64 last_tick_ns_;
+	qint64 last_plot_ns_;
+	qint64 last_export_ns_;
+	qint64 last_sample_ns_;
+	double max_event_loop_latency_;
+	uint64_t last_sample_count_;
+	uint64_t last_allocations_;
+	mutable std::mutex samples_mutex_;
+	vector<SoakSample> samples_;
+
+	std::thread generator_thread_;
+	std::mutex generator_mutex_;
+	std::condition_variable stop_cond_;
+	std::atomic<bool> stop_;
+	std::atomic<bool> running_;
+	std::atomic<uint64_t> sample_count_;
+	/** The maximums since the last sample in ns, reset by add_sample(). */
+	std::atomic<int64_t> max_lateness_ns_;
+	std::atomic<int64_t> max_push_time_ns_;
+
+Q_SIGNALS:
+	/** The duration of the test has passed, the test is stopped. */
+	void finished();
+
+private Q_SLOTS:
+	void on_tick();
+
+};
+
+} // namespace sv
+
+#endif // SOAKTEST_HPP
@@ -0,0 +1,228 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <ios>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "tracer.hpp"
+
+using std::make_shared;
+using std::string;
+
+namespace sv {
+
+namespace {
+
+unsigned int next_tid = 1;
+
+thread_local void *thread_buffer_ptr = nullptr;
+
+string escape_json(const string &str)
+{
+	string escaped;
+	escaped.reserve(str.size());
+	for (const char c : str) {
+		if (c == '"' || c == '\\')
+			escaped += '\\';
+		if ((unsigned char)c < 0x20)
+			continue;
+		escaped += c;
+	}
+	return escaped;
+}
+
+}
+
+const size_t Tracer::buffer_capacity_ = 1 << 17;
+
+std::atomic<bool> Tracer::recording_(false);
+std::atomic<bool> Tracer::scope_tracking_(false);
+std::atomic<unsigned int> Tracer::recording_id_(0);
+std::atomic<int64_t> Tracer::start_ns_(0);
+std::mutex Tracer::buffers_mutex_;
+vector<shared_ptr<Tracer::ThreadBuffer>> Tracer::buffers_;
+
+void Tracer::start()
+{
+	recording_.store(false, std::memory_order_relaxed);
+	// The thread buffers reset themselves, when they see the new id
+	recording_id_.fetch_add(1, std::memory_order_acq_rel);
+	start_ns_.store(now_ns(), std::memory_order_relaxed);
+	recording_.store(true, std::memory_order_release);
+}
+
+void Tracer::stop()
+{
+	recording_.store(false, std::memory_order_release);
+}
+
+void Tracer::set_thread_name(const string &name)
+{
+	ThreadBuffer *buffer = thread_buffer();
+	std::lock_guard<std::mutex> lock(buffers_mutex_);
+	buffer->name = name;
+}
+
+unsigned int Tracer::thread_id()
+{
+	return thread_buffer()->tid;
+}
+
+void Tracer::set_scope_tracking(bool scope_tracking)
+{
+	scope_tracking_.store(scope_tracking, std::memory_order_relaxed);
+}
+
+const char *Tracer::current_scope(unsigned int tid)
+{
+	std::lock_guard<std::mutex> lock(buffers_mutex_);
+	for (const auto &buffer : buffers_) {
+		if (buffer->tid == tid)
+			return buffer->current_scope.load(std::memory_order_relaxed);
+	}
+	return nullptr;
+}
+
+const char *Tracer::enter_scope(const char *name)
+{
+	return thread_buffer()->current_scope.exchange(
+		name, std::memory_order_relaxed);
+}
+
+void Tracer::leave_scope(const char *previous_scope)
+{
+	thread_buffer()->current_scope.store(
+		previous_scope, std::memory_order_relaxed);
+}
+
+size_t Tracer::event_count()
+{
+	const unsigned int id = recording_id_.load(std::memory_order_acquire);
+	size_t count = 0;
+	std::lock_guard<std::mutex> lock(buffers_mutex_);
+	for (const auto &buffer : buffers_) {
+		if (buffer->recording_id.load(std::memory_order_acquire) == id)
+			count += buffer->count.load(std::memory_order_acquire);
+	}
+	return count;
+}
+
+size_t Tracer::dropped_count()
+{
+	const unsigned int id = recording_id_.load(std::memory_order_acquire);
+	size_t count = 0;
+	std::lock_guard<std::mutex> lock(buffers_mutex_);
+	for (const auto &buffer : buffers_) {
+		if (buffer->recording_id.load(std::memory_order_acquire) == id)
+			count += buffer->dropped.load(std::memory_order_relaxed);
+	}
+	return count;
+}
+
+bool Tracer::save_chrome_trace(const string &file_name)
+{
+	std::ofstream file(file_name, std::ios::out | std::ios::trunc);
+	if (!file.is_open())
+		return false;
+
+	const unsigned int id = recording_id_.load(std::memory_order_acquire);
+	const int64_t start_ns = start_ns_.load(std::memory_order_relaxed);
+
+	// Timestamps and durations are in µs
+	file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+	file.precision(3);
+	file.setf(std::ios::fixed, std::ios::floatfield);
+	bool first = true;
+	std::lock_guard<std::mutex> lock(buffers_mutex_);
+	for (const auto &buffer : buffers_) {
+		const string thread_name = buffer->name.empty() ?
+			"Thread " + std::to_string(buffer->tid) : buffer->name;
+		file << (first ? "" : ",") << "\n{\"ph\":\"M\",\"pid\":1,\"tid\":" <<
+			buffer->tid << ",\"name\":\"thread_name\",\"args\":{\"name\":\"" <<
+			escape_json(thread_name) << "\"}}";
+		first = false;
+
+		if (buffer->recording_id.load(std::memory_order_acquire) != id)
+			continue;
+		const size_t count = buffer->count.load(std::memory_order_acquire);
+		for (size_t i = 0; i < count; ++i) {
+			const Event &event = buffer->events[i];
+			file << ",\n{\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->tid <<
+				",\"name\":\"" << event.name << "\",\"ts\":" <<
+				(double)(event.begin_ns - start_ns) / 1000. << ",\"dur\":" <<
+				(double)(event.end_ns - event.begin_ns) / 1000. << "}";
+		}
+	}
+	file << "\n]}\n";
+
+	return file.good();
+}
+
+void Tracer::add_event(const char *name, int64_t begin_ns, int64_t end_ns)
+{
+	if (!recording_.load(std::memory_order_acquire))
+		return;
+
+	ThreadBuffer *buffer = thread_buffer();
+	const unsigned int id = recording_id_.load(std::memory_order_acquire);
+	if (buffer->recording_id.load(std::memory_order_relaxed) != id) {
+		buffer->count.store(0, std::memory_order_relaxed);
+		buffer->dropped.store(0, std::memory_order_relaxed);
+		buffer->recording_id.store(id, std::memory_order_release);
+	}
+
+	const size_t count = buffer->count.load(std::memory_order_relaxed);
+	if (count >= buffer_capacity_) {
+		buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	if (buffer->events.empty())
+		buffer->events.resize(buffer_capacity_);
+	buffer->events[count] = { name, begin_ns, end_ns };
+	// Publish the event to save_chrome_trace()
+	buffer->count.store(count + 1, std::memory_order_release);
+}
+
+Tracer::ThreadBuffer *Tracer::thread_buffer()
+{
+	if (thread_buffer_ptr)
+		return static_cast<ThreadBuffer *>(thread_buffer_ptr);
+
+	auto buffer = make_shared<ThreadBuffer>();
+	buffer->recording_id.store(0, std::memory_order_relaxed);
+	buffer->count.store(0, std::memory_order_relaxed);
+	buffer->dropped.store(0, std::memory_order_relaxed);
+	buffer->current_scope.store(nullptr, std::memory_order_relaxed);
+
+	std::lock_guard<std::mutex> lock(buffers_mutex_);
+	buffer->tid = next_tid++;
+	// The buffers are kept until the end, so that the events of finished
+	// threads are still in the trace
+	buffers_.push_back(buffer);
+	thread_buffer_ptr = buffer.get();
+	return buffer.get();
+}
+
+} // namespace sv
@@ -0,0 +1,190 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRACER_HPP
+#define TRACER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+
+/**
+ * Records scoped trace events of the hot paths (datafeed, signals, math
+ * channels, plots, ...), that can be saved in the Chrome trace format and
+ * opened in Perfetto or chrome://tracing.
+ *
+ * Every thread writes its events to its own buffer, so recording needs no
+ * lock: While the tracer is stopped, a trace scope costs one relaxed load,
+ * while it is recording, two reads of the steady clock. A buffer has a fixed
+ * capacity, further events of the thread are dropped and counted. Without
+ * ENABLE_TRACING, the SV_TRACE_* macros compile to nothing.
+ *
+ * Independent of the recording, the innermost scope of every thread can be
+ * tracked, so that another thread (the Watchdog) can see where a thread is
+ * stuck.
+ */
+class Tracer
+{
+public:
+	/**
+	 * Start a new recording. The events of a previous recording are
+	 * discarded.
+	 */
+	static void start();
+	static void stop();
+	static bool is_recording()
+	{
+		return recording_.load(std::memory_order_relaxed);
+	}
+
+	/** Name the calling thread in the trace, e.g. "GUI". */
+	static void set_thread_name(const string &name);
+	/** Return the id of the calling thread in the trace. */
+	static unsigned int thread_id();
+
+	/** Track the innermost scope of every thread, see current_scope(). */
+	static void set_scope_tracking(bool scope_tracking);
+	static bool is_tracking_scopes()
+	{
+		return scope_tracking_.load(std::memory_order_relaxed);
+	}
+	/**
+	 * Return the name of the innermost scope of the thread with the id tid
+	 * or nullptr if the thread is in no scope (or scopes are not tracked).
+	 */
+	static const char *current_scope(unsigned int tid);
+	/** Make name the innermost scope and return the previous one. */
+	static const char *enter_scope(const char *name);
+	static void leave_scope(const char *previous_scope);
+
+	/** Return the number of recorded and of dropped events. */
+	static size_t event_count();
+	static size_t dropped_count();
+
+	/**
+	 * Save the events of the last recording in the Chrome trace (JSON)
+	 * format.
+	 *
+	 * @return false if the file couldn't be written.
+	 */
+	static bool save_chrome_trace(const string &file_name);
+
+	/** Add a complete event. name must be a string literal. */
+	static void add_event(const char *name, int64_t begin_ns, int64_t end_ns);
+
+	static int64_t now_ns()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+private:
+	struct Event
+	{
+		const char *name;
+		int64_t begin_ns;
+		int64_t end_ns;
+	};
+
+	/** The events of a thread, only the thread itself writes them. */
+	struct ThreadBuffer
+	{
+		unsigned int tid;
+		string name;
+		vector<Event> events;
+		/** The recording, the events belong to. */
+		std::atomic<unsigned int> recording_id;
+		std::atomic<size_t> count;
+		std::atomic<size_t> dropped;
+		std::atomic<const char *> current_scope;
+	};
+
+	static ThreadBuffer *thread_buffer();
+
+	/** The number of events per thread and recording. */
+	static const size_t buffer_capacity_;
+
+	static std::atomic<bool> recording_;
+	static std::atomic<bool> scope_tracking_;
+	static std::atomic<unsigned int> recording_id_;
+	static std::atomic<int64_t> start_ns_;
+	static std::mutex buffers_mutex_;
+	static vector<shared_ptr<ThreadBuffer>> buffers_;
+
+};
+
+/**
+ * Records the lifetime of the scope as a trace event, use SV_TRACE_SCOPE().
+ */
+class TraceScope
+{
+public:
+	explicit TraceScope(const char *name) :
+		name_(name),
+		tracked_(Tracer::is_tracking_scopes()),
+		previous_scope_(tracked_ ? Tracer::enter_scope(name) : nullptr),
+		begin_ns_(Tracer::is_recording() ? Tracer::now_ns() : 0)
+	{
+	}
+
+	~TraceScope()
+	{
+		if (begin_ns_ != 0)
+			Tracer::add_event(name_, begin_ns_, Tracer::now_ns());
+		if (tracked_)
+			Tracer::leave_scope(previous_scope_);
+	}
+
+	TraceScope(const TraceScope &) = delete;
+	TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+	const char *const name_;
+	const bool tracked_;
+	const char *const previous_scope_;
+	const int64_t begin_ns_;
+
+};
+
+} // namespace sv
+
+#ifdef ENABLE_TRACING
+#define SV_TRACE_CONCAT_(a, b) a##b
+#define SV_TRACE_CONCAT(a, b) SV_TRACE_CONCAT_(a, b)
+/** Trace the enclosing scope, name must be a string literal. */
+#define SV_TRACE_SCOPE(name) \
+	::sv::TraceScope SV_TRACE_CONCAT(sv_trace_scope_, __LINE__)(name)
+#define SV_TRACE_THREAD_NAME(name) ::sv::Tracer::set_thread_name(name)
+#else
+#define SV_TRACE_SCOPE(name) do {} while (false)
+#define SV_TRACE_THREAD_NAME(name) do {} while (false)
+#endif
+
+#endif // TRACER_HPP
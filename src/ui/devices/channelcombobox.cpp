@@ -99,7 +99,7 @@ void ChannelComboBox::fill_channels()
 	if (device_->channel_group_map().count(chg_str) == 0)
 		return;
 
-	auto ch_list = device_->channel_group_map()[chg_str];
+	const auto &ch_list = device_->channel_group_map().at(chg_str);
 	for (const auto &ch : ch_list) {
 		// Check if channel contains a signal with the filter quantity.
 		if (filter_active_) {
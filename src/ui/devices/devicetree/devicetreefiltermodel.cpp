@@ -0,0 +1,168 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <memory>
+
+#include <QMetaObject>
+#include <QModelIndex>
+#include <QSortFilterProxyModel>
+#include <QStandardItem>
+#include <QStandardItemModel>
+#include <QString>
+#include <QVariant>
+
+#include "devicetreefiltermodel.hpp"
+#include "src/session.hpp"
+#include "src/channels/basechannel.hpp"
+#include "src/data/basesignal.hpp"
+#include "src/data/signalregistry.hpp"
+#include "src/devices/basedevice.hpp"
+#include "src/ui/devices/devicetree/devicetreemodel.hpp"
+#include "src/ui/devices/devicetree/treeitem.hpp"
+
+using std::shared_ptr;
+
+Q_DECLARE_SMART_POINTER_METATYPE(std::shared_ptr)
+
+namespace sv {
+namespace ui {
+namespace devices {
+namespace devicetree {
+
+DeviceTreeFilterModel::DeviceTreeFilterModel(const Session &session,
+		QObject *parent) :
+	QSortFilterProxyModel(parent),
+	session_(session),
+	is_update_pending_(false)
+{
+	// Signals are registered from the acquisition threads. Only a queued
+	// update without arguments is posted, so no meta types are needed.
+	connect(session_.signal_registry().get(),
+		&sv::data::SignalRegistry::signal_registered,
+		this, [this](shared_ptr<sv::data::BaseSignal>) {
+			if (!is_update_pending_.exchange(true))
+				QMetaObject::invokeMethod(this, "on_signal_registered",
+					Qt::QueuedConnection);
+		}, Qt::DirectConnection);
+}
+
+void DeviceTreeFilterModel::set_filter_text(const QString &filter_text)
+{
+	const QString text = filter_text.trimmed();
+	if (text == filter_text_)
+		return;
+
+	filter_text_ = text;
+	update_matches();
+	invalidateFilter();
+}
+
+QString DeviceTreeFilterModel::filter_text() const
+{
+	return filter_text_;
+}
+
+bool DeviceTreeFilterModel::is_filter_active() const
+{
+	return !filter_text_.isEmpty();
+}
+
+void DeviceTreeFilterModel::update_matches()
+{
+	devices_.clear();
+	channels_.clear();
+	signals_.clear();
+	if (!is_filter_active())
+		return;
+
+	const auto matches =
+		session_.signal_registry()->search(filter_text_.toStdString());
+	for (const auto &signal : *matches) {
+		signals_.insert(signal.get());
+		auto channel = signal->parent_channel();
+		if (!channel)
+			continue;
+		channels_.insert(channel.get());
+		auto device = channel->parent_device();
+		if (device)
+			devices_.insert(device.get());
+	}
+}
+
+bool DeviceTreeFilterModel::is_channel_accepted(
+	const QModelIndex &source_index) const
+{
+	auto channel = source_index.data(DeviceTreeModel::DataRole).
+		value<shared_ptr<sv::channels::BaseChannel>>();
+	return channels_.count(channel.get()) > 0;
+}
+
+bool DeviceTreeFilterModel::filterAcceptsRow(int source_row,
+	const QModelIndex &source_parent) const
+{
+	if (!is_filter_active())
+		return true;
+
+	const auto *source_model =
+		static_cast<const QStandardItemModel *>(sourceModel());
+	const QModelIndex index = source_model->index(source_row, 0, source_parent);
+	const QStandardItem *item = source_model->itemFromIndex(index);
+	if (!item)
+		return false;
+
+	switch ((TreeItemType)item->type()) {
+	case TreeItemType::DeviceItem: {
+		auto device = index.data(DeviceTreeModel::DataRole).
+			value<shared_ptr<sv::devices::BaseDevice>>();
+		return devices_.count(device.get()) > 0;
+	}
+	case TreeItemType::ChannelGroupItem:
+		for (int row = 0; row < item->rowCount(); ++row) {
+			if (is_channel_accepted(item->child(row)->index()))
+				return true;
+		}
+		return false;
+	case TreeItemType::ChannelItem:
+		return is_channel_accepted(index);
+	case TreeItemType::SignalItem: {
+		auto signal = index.data(DeviceTreeModel::DataRole).
+			value<shared_ptr<sv::data::BaseSignal>>();
+		return signals_.count(signal.get()) > 0;
+	}
+	case TreeItemType::ConfigurableItem:
+	case TreeItemType::PropertyItem:
+	default:
+		return false;
+	}
+}
+
+void DeviceTreeFilterModel::on_signal_registered()
+{
+	is_update_pending_.store(false);
+	if (!is_filter_active())
+		return;
+
+	update_matches();
+	invalidateFilter();
+}
+
+} // namespace devicetree
+} // namespace devices
+} // namespace ui
+} // namespace sv
@@ -0,0 +1,101 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_DEVICES_DEVICETREE_DEVICETREEFILTERMODEL_HPP
+#define UI_DEVICES_DEVICETREE_DEVICETREEFILTERMODEL_HPP
+
+#include <atomic>
+#include <memory>
+#include <set>
+
+#include <QModelIndex>
+#include <QObject>
+#include <QSortFilterProxyModel>
+#include <QString>
+
+using std::set;
+using std::shared_ptr;
+
+namespace sv {
+
+class Session;
+
+namespace channels {
+class BaseChannel;
+}
+namespace data {
+class BaseSignal;
+}
+namespace devices {
+class BaseDevice;
+}
+
+namespace ui {
+namespace devices {
+namespace devicetree {
+
+/**
+ * Filters a DeviceTreeModel by the quick search of the signal registry.
+ *
+ * The filter text is looked up once in the search index of the registry
+ * and the matching signals, with their channels and devices, are kept in
+ * sets. The tree is then filtered by set lookups instead of comparing the
+ * texts of all items. While a filter is active, configurables and their
+ * properties are hidden.
+ */
+class DeviceTreeFilterModel : public QSortFilterProxyModel
+{
+	Q_OBJECT
+
+public:
+	explicit DeviceTreeFilterModel(const Session &session,
+		QObject *parent = nullptr);
+
+	void set_filter_text(const QString &filter_text);
+	QString filter_text() const;
+	bool is_filter_active() const;
+
+protected:
+	bool filterAcceptsRow(int source_row,
+		const QModelIndex &source_parent) const override;
+
+private:
+	/** Query the registry and rebuild the sets of accepted items. */
+	void update_matches();
+	bool is_channel_accepted(const QModelIndex &source_index) const;
+
+	const Session &session_;
+	QString filter_text_;
+	set<const sv::devices::BaseDevice *> devices_;
+	set<const sv::channels::BaseChannel *> channels_;
+	set<const sv::data::BaseSignal *> signals_;
+	/** Coalesces the updates for signals, that are registered at once. */
+	std::atomic<bool> is_update_pending_;
+
+private Q_SLOTS:
+	void on_signal_registered();
+
+};
+
+} // namespace devicetree
+} // namespace devices
+} // namespace ui
+} // namespace sv
+
+#endif // UI_DEVICES_DEVICETREE_DEVICETREEFILTERMODEL_HPP
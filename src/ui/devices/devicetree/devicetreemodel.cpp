@@ -17,12 +17,15 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <memory>
 #include <mutex>
 #include <set>
 #include <string>
 
 #include <QDebug>
+#include <QList>
+#include <QMetaType>
 #include <QStandardItem>
 #include <QStandardItemModel>
 #include <QString>
@@ -32,11 +35,14 @@
 #include "src/session.hpp"
 #include "src/data/properties/baseproperty.hpp"
 #include "src/data/basesignal.hpp"
+#include "src/devices/acquisitionstatistics.hpp"
 #include "src/devices/basedevice.hpp"
 #include "src/devices/configurable.hpp"
+#include "src/devices/hardwaredevice.hpp"
 #include "src/channels/basechannel.hpp"
 #include "src/ui/devices/devicetree/treeitem.hpp"
 
+using std::dynamic_pointer_cast;
 using std::set;
 using std::shared_ptr;
 using std::string;
@@ -80,12 +86,61 @@ void DeviceTreeModel::setup_model()
 		&session_, SIGNAL(device_removed(shared_ptr<sv::devices::BaseDevice>)),
 		this, SLOT(on_device_removed(shared_ptr<sv::devices::BaseDevice>)));
 
+	// Build the complete trees of all devices, before they are inserted
+	// with a single row insertion.
+	QList<QStandardItem *> device_items;
 	for (const auto &device_pair : session_.device_map()) {
 		shared_ptr<sv::devices::BaseDevice> device = device_pair.second;
-		add_device(device);
+		if (find_device(device))
+			continue;
+		device_items.append(create_device_item(device));
+	}
+	std::stable_sort(device_items.begin(), device_items.end(),
+		[](const QStandardItem *item1, const QStandardItem *item2) {
+			return DeviceTreeModel::is_sort_less(
+				item1->data(DeviceTreeModel::SortRole),
+				item2->data(DeviceTreeModel::SortRole));
+		});
+	invisibleRootItem()->appendRows(device_items);
+}
+
+bool DeviceTreeModel::is_sort_less(const QVariant &left, const QVariant &right)
+{
+	// Compare like QStandardItem::operator<(), used by sortChildren()
+	switch (left.userType()) {
+	case QMetaType::Int:
+		return left.toInt() < right.toInt();
+	case QMetaType::UInt:
+		return left.toUInt() < right.toUInt();
+	case QMetaType::LongLong:
+		return left.toLongLong() < right.toLongLong();
+	case QMetaType::ULongLong:
+		return left.toULongLong() < right.toULongLong();
+	case QMetaType::Double:
+		return left.toDouble() < right.toDouble();
+	default:
+		return left.toString().compare(right.toString()) < 0;
 	}
+}
 
-	invisibleRootItem()->sortChildren(0);
+void DeviceTreeModel::insert_item(QStandardItem *parent_item, TreeItem *item)
+{
+	// Insert the item at its sorted position behind all equal items, so the
+	// children of parent_item don't have to be sorted (and relayouted)
+	// again. If parent_item is not part of the model yet, no rows are
+	// inserted in the model.
+	const QVariant sort_data = item->data(DeviceTreeModel::SortRole);
+	int first = 0;
+	int last = parent_item->rowCount();
+	while (first < last) {
+		const int middle = first + (last - first) / 2;
+		if (is_sort_less(sort_data,
+				parent_item->child(middle)->data(DeviceTreeModel::SortRole)))
+			last = middle;
+		else
+			first = middle + 1;
+	}
+	parent_item->insertRow(first, item);
 }
 
 void DeviceTreeModel::add_device(shared_ptr<sv::devices::BaseDevice> device)
@@ -98,26 +153,38 @@ void DeviceTreeModel::add_device(shared_ptr<sv::devices::BaseDevice> device)
 
 	// Look for existing device
 	TreeItem *device_item = find_device(device);
-	if (!device_item) {
-		beginInsertRows(invisibleRootItem()->index(),
-			invisibleRootItem()->rowCount(), invisibleRootItem()->rowCount()+1);
-		device_item = new TreeItem(TreeItemType::DeviceItem);
-		device_item->setText(device->full_name());
-		device_item->setData(QVariant::fromValue(device), DeviceTreeModel::DataRole);
-		device_item->setData(device->full_name(), DeviceTreeModel::SortRole);
-		device_item->setCheckable(is_device_checkable_);
-		device_item->setEditable(false);
-		invisibleRootItem()->appendRow(device_item);
-		endInsertRows();
-
-		invisibleRootItem()->sortChildren(0);
-
-		connect(
-			device.get(),
-			SIGNAL(channel_added(shared_ptr<sv::channels::BaseChannel>)),
-			this, SLOT(on_channel_added(shared_ptr<sv::channels::BaseChannel>)));
+	if (device_item) {
+		add_device_children(device, device_item);
+		return;
 	}
 
+	// The tree of the new device is completed, before it is inserted
+	insert_item(invisibleRootItem(), create_device_item(device));
+}
+
+TreeItem *DeviceTreeModel::create_device_item(
+	shared_ptr<sv::devices::BaseDevice> device)
+{
+	TreeItem *device_item = new TreeItem(TreeItemType::DeviceItem);
+	device_item->setText(device->full_name());
+	device_item->setData(QVariant::fromValue(device), DeviceTreeModel::DataRole);
+	device_item->setData(device->full_name(), DeviceTreeModel::SortRole);
+	device_item->setCheckable(is_device_checkable_);
+	device_item->setEditable(false);
+
+	connect(
+		device.get(),
+		SIGNAL(channel_added(shared_ptr<sv::channels::BaseChannel>)),
+		this, SLOT(on_channel_added(shared_ptr<sv::channels::BaseChannel>)));
+
+	add_device_children(device, device_item);
+
+	return device_item;
+}
+
+void DeviceTreeModel::add_device_children(
+	shared_ptr<sv::devices::BaseDevice> device, TreeItem *device_item)
+{
 	// Channels and ChannelGroups
 	for (const auto &channel_pair : device->channel_map()) {
 		add_channel(channel_pair.second,
@@ -144,18 +211,13 @@ TreeItem *DeviceTreeModel::add_channel_group(const string &channel_group_name,
 	std::lock_guard<std::recursive_mutex> lock(mutex_);
 
 	QString chg_name_qstr = QString::fromStdString(channel_group_name);
-	beginInsertRows(device_item->index(),
-		device_item->rowCount(), device_item->rowCount()+1);
 	chg_item = new TreeItem(TreeItemType::ChannelGroupItem);
 	chg_item->setText(chg_name_qstr);
 	chg_item->setData(chg_name_qstr, DeviceTreeModel::DataRole);
 	chg_item->setData(chg_name_qstr, DeviceTreeModel::SortRole);
 	chg_item->setCheckable(is_channel_group_checkable_);
 	chg_item->setEditable(false);
-	device_item->appendRow(chg_item);
-	endInsertRows();
-
-	device_item->sortChildren(0);
+	insert_item(device_item, chg_item);
 
 	return chg_item;
 }
@@ -181,18 +243,13 @@ void DeviceTreeModel::add_channel(shared_ptr<channels::BaseChannel> channel,
 		set<string> chg_names { chg_name };
 		TreeItem *channel_item = find_channel(channel, chg_names, parent_item);
 		if (!channel_item) {
-			beginInsertRows(new_parent_item->index(),
-				new_parent_item->rowCount(), new_parent_item->rowCount()+1);
 			channel_item = new TreeItem(TreeItemType::ChannelItem);
 			channel_item->setText(QString::fromStdString(channel->name()));
 			channel_item->setData(QVariant::fromValue(channel), DeviceTreeModel::DataRole);
 			channel_item->setData(channel->index(), DeviceTreeModel::SortRole);
 			channel_item->setCheckable(is_channel_checkable_);
 			channel_item->setEditable(false);
-			new_parent_item->appendRow(channel_item);
-			endInsertRows();
-
-			new_parent_item->sortChildren(0);
+			insert_item(new_parent_item, channel_item);
 		}
 
 		// Signals
@@ -212,18 +269,13 @@ void DeviceTreeModel::add_signal(shared_ptr<sv::data::BaseSignal> signal,
 	// Look for existing signal
 	TreeItem *signal_item = find_signal(signal, parent_item);
 	if (!signal_item) {
-		beginInsertRows(parent_item->index(),
-			parent_item->rowCount(), parent_item->rowCount()+1);
 		signal_item = new TreeItem(TreeItemType::SignalItem);
 		signal_item->setText(signal->display_name());
 		signal_item->setData(QVariant::fromValue(signal), DeviceTreeModel::DataRole);
 		signal_item->setData(signal->display_name(), DeviceTreeModel::SortRole); // TODO: signal->index()
 		signal_item->setCheckable(is_signal_checkable_);
 		signal_item->setEditable(false);
-		parent_item->appendRow(signal_item);
-		endInsertRows();
-
-		parent_item->sortChildren(0);
+		insert_item(parent_item, signal_item);
 	}
 }
 
@@ -242,18 +294,13 @@ void DeviceTreeModel::add_configurable(
 			configurable->name(), device_item);
 
 		// Add configurable item
-		beginInsertRows(new_parent_item->index(),
-			new_parent_item->rowCount(), new_parent_item->rowCount()+1);
 		conf_item = new TreeItem(TreeItemType::ConfigurableItem);
 		conf_item->setText(configurable->display_name());
 		conf_item->setData(QVariant::fromValue(configurable), DeviceTreeModel::DataRole);
 		conf_item->setData(configurable->index(), DeviceTreeModel::SortRole);
 		conf_item->setCheckable(false);
 		conf_item->setEditable(false);
-		new_parent_item->appendRow(conf_item);
-		endInsertRows();
-
-		new_parent_item->sortChildren(0);
+		insert_item(new_parent_item, conf_item);
 	}
 
 	// ConfigKeys
@@ -274,19 +321,67 @@ void DeviceTreeModel::add_property(
 	// Look for existing property
 	TreeItem *property_item = find_property(property, configurable_item);
 	if (!property_item) {
-		beginInsertRows(configurable_item->index(),
-			configurable_item->rowCount(), configurable_item->rowCount()+1);
 		property_item = new TreeItem(TreeItemType::PropertyItem);
 		property_item->setText(property->display_name());
 		property_item->setData(QVariant::fromValue(property), DeviceTreeModel::DataRole);
 		property_item->setData(property->display_name(), DeviceTreeModel::SortRole);
 		property_item->setCheckable(is_signal_checkable_);
 		property_item->setEditable(false);
-		configurable_item->appendRow(property_item);
-		endInsertRows();
+		insert_item(configurable_item, property_item);
+	}
+}
 
-		configurable_item->sortChildren(0);
+QVariant DeviceTreeModel::data(const QModelIndex &index, int role) const
+{
+	if (role != Qt::ToolTipRole)
+		return QStandardItemModel::data(index, role);
+
+	const QStandardItem *item = itemFromIndex(index);
+	if (!item || item->type() != (int)TreeItemType::DeviceItem)
+		return QStandardItemModel::data(index, role);
+	auto hw_device = dynamic_pointer_cast<sv::devices::HardwareDevice>(
+		item->data(DeviceTreeModel::DataRole).
+			value<shared_ptr<sv::devices::BaseDevice>>());
+	if (!hw_device)
+		return QStandardItemModel::data(index, role);
+
+	// The statistics are read, when the tool tip is shown
+	const sv::devices::AcquisitionSummary summary =
+		hw_device->acquisition_summary();
+	QString tool_tip = hw_device->full_name();
+	tool_tip.append(tr("\nPackets: %1 (%2/s)").
+		arg(summary.packet_count).arg(summary.packets_per_second, 0, 'f', 1));
+	tool_tip.append(tr("\nSamples: %1 (%2/s)").
+		arg(summary.sample_count).arg(summary.samples_per_second, 0, 'f', 1));
+	tool_tip.append(tr("\nDropped packets: %1 (%2 samples)").
+		arg(summary.dropped_packet_count).arg(summary.dropped_sample_count));
+	tool_tip.append(tr("\nOut of order packets: %1").
+		arg(summary.out_of_order_packet_count));
+	tool_tip.append(tr("\nDatafeed time: %1 s (max. %2 ms per packet)").
+		arg(summary.feed_time, 0, 'f', 3).
+		arg(summary.max_feed_time * 1000., 0, 'f', 3));
+	tool_tip.append(tr("\nIngest queue: %1 packets (max. %2)").
+		arg(summary.queue_depth).arg(summary.queue_high_water));
+
+	// The latency, that 99% of the packets stay below
+	uint64_t latency_count = 0;
+	for (const auto count : summary.latency_histogram)
+		latency_count += count;
+	if (latency_count > 0) {
+		uint64_t count = 0;
+		size_t bucket = 0;
+		while (bucket < summary.latency_histogram.size() - 1) {
+			count += summary.latency_histogram[bucket];
+			if (count * 100 >= latency_count * 99)
+				break;
+			++bucket;
+		}
+		const double limit =
+			sv::devices::AcquisitionStatistics::latency_bucket_limit(bucket);
+		tool_tip.append(tr("\nLatency (99%): < %1 ms").
+			arg(limit * 1000., 0, 'f', 3));
 	}
+	return tool_tip;
 }
 
 TreeItem *DeviceTreeModel::find_device(
@@ -28,6 +28,7 @@
 
 #include <QStandardItem>
 #include <QStandardItemModel>
+#include <QVariant>
 
 using std::set;
 using std::shared_ptr;
@@ -71,13 +72,37 @@ public:
 
 	TreeItem *find_device(shared_ptr<sv::devices::BaseDevice> device) const;
 
+	/**
+	 * The tool tip of a hardware device shows its current acquisition
+	 * statistics.
+	 */
+	QVariant data(const QModelIndex &index,
+		int role = Qt::DisplayRole) const override;
+
 	const static int DataRole = Qt::UserRole + 1;
 	const static int SortRole = Qt::UserRole + 2;
 
 private:
 	void setup_model();
 
+	/**
+	 * Compare the sort data of two items like sortChildren() does.
+	 */
+	static bool is_sort_less(const QVariant &left, const QVariant &right);
+	/**
+	 * Insert the item into parent_item at its sorted position.
+	 */
+	void insert_item(QStandardItem *parent_item, TreeItem *item);
+
 	void add_device(shared_ptr<sv::devices::BaseDevice> device);
+	/**
+	 * Create the item of a new device with all its children. The item is
+	 * not inserted into the model, so the tree is built without any
+	 * notifications of the views.
+	 */
+	TreeItem *create_device_item(shared_ptr<sv::devices::BaseDevice> device);
+	void add_device_children(shared_ptr<sv::devices::BaseDevice> device,
+		TreeItem *device_item);
 	TreeItem *add_channel_group(
 		const string &channel_group_name, TreeItem *device_item);
 	void add_channel(shared_ptr<sv::channels::BaseChannel> channel,
@@ -21,6 +21,7 @@
 
 #include <QDebug>
 #include <QItemSelectionModel>
+#include <QLineEdit>
 #include <QList>
 #include <QModelIndex>
 #include <QModelIndexList>
@@ -32,6 +33,7 @@
 #include "src/channels/basechannel.hpp"
 #include "src/data/basesignal.hpp"
 #include "src/devices/basedevice.hpp"
+#include "src/ui/devices/devicetree/devicetreefiltermodel.hpp"
 #include "src/ui/devices/devicetree/devicetreemodel.hpp"
 #include "src/ui/devices/devicetree/treeitem.hpp"
 
@@ -72,20 +74,21 @@ void DeviceTreeView::select_device(shared_ptr<sv::devices::BaseDevice> device)
 
 void DeviceTreeView::select_item(TreeItem *item)
 {
-	selectionModel()->select(item->index(), QItemSelectionModel::Select);
+	selectionModel()->select(filter_model_->mapFromSource(item->index()),
+		QItemSelectionModel::Select);
 }
 
 TreeItem *DeviceTreeView::selected_item() const
 {
-	QModelIndex index = selectionModel()->currentIndex();
+	QModelIndex index =
+		filter_model_->mapToSource(selectionModel()->currentIndex());
 	if (!index.isValid())
 		return nullptr;
 
 	// We can't use item->internalPointer() here, because somehow it points
 	// to the parent item!?
 	// TODO: Use qobject_cast()?
-	return static_cast<TreeItem *>(static_cast<QStandardItemModel *>(model())->
-		itemFromIndex(index));
+	return static_cast<TreeItem *>(tree_model_->itemFromIndex(index));
 }
 
 void DeviceTreeView::check_channels(
@@ -192,6 +195,31 @@ void DeviceTreeView::expand_device(shared_ptr<sv::devices::BaseDevice> device)
 	this->expand_recursive(item);
 }
 
+QLineEdit *DeviceTreeView::create_filter_edit(QWidget *parent)
+{
+	QLineEdit *filter_edit = new QLineEdit(parent);
+	filter_edit->setPlaceholderText(tr("Filter"));
+	filter_edit->setToolTip(tr("Show the signals, whose device, channel, "
+		"name, quantity or unit start with all the words"));
+	filter_edit->setClearButtonEnabled(true);
+	connect(filter_edit, SIGNAL(textChanged(const QString &)),
+		this, SLOT(set_filter_text(const QString &)));
+	return filter_edit;
+}
+
+void DeviceTreeView::set_filter_text(const QString &filter_text)
+{
+	filter_model_->set_filter_text(filter_text);
+
+	// Show all matches, configurables are hidden by the filter anyway
+	if (filter_model_->is_filter_active())
+		this->expandAll();
+	else if (is_auto_expand_)
+		this->expand_recursive(tree_model_->invisibleRootItem());
+	else
+		this->collapseAll();
+}
+
 void DeviceTreeView::setup_ui()
 {
 	tree_model_ = new DeviceTreeModel(session_,
@@ -200,7 +228,10 @@ void DeviceTreeView::setup_ui()
 		is_configurable_checkable_, is_config_key_checkable_,
 		show_configurable_);
 
-    this->setModel(tree_model_);
+	filter_model_ = new DeviceTreeFilterModel(session_, this);
+	filter_model_->setSourceModel(tree_model_);
+
+	this->setModel(filter_model_);
 	this->setHeaderHidden(true);
 
 	if (is_auto_expand_)
@@ -220,7 +251,8 @@ void DeviceTreeView::expand_recursive(QStandardItem *item)
 	if (item->type() == (int)TreeItemType::ConfigurableItem)
 		return;
 
-	this->expand(tree_model_->indexFromItem(item));
+	this->expand(
+		filter_model_->mapFromSource(tree_model_->indexFromItem(item)));
 	for (int i=0; i<item->rowCount(); ++i) {
 		expand_recursive(item->child(i));
 	}
@@ -229,11 +261,16 @@ void DeviceTreeView::expand_recursive(QStandardItem *item)
 void DeviceTreeView::on_rows_inserted(const QModelIndex &model_index,
 	int first, int last)
 {
-	(void)first;
-	(void)last;
+	if (!is_auto_expand_)
+		return;
 
-	if (is_auto_expand_)
-		this->expand_recursive(tree_model_->itemFromIndex(model_index));
+	// Devices are inserted with their complete tree into the root item
+	if (!model_index.isValid()) {
+		for (int row = first; row <= last; ++row)
+			this->expand_recursive(tree_model_->invisibleRootItem()->child(row));
+		return;
+	}
+	this->expand_recursive(tree_model_->itemFromIndex(model_index));
 }
 
 } // namespace devicetree
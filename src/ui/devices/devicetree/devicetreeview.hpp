@@ -23,8 +23,10 @@
 #include <memory>
 #include <vector>
 
+#include <QLineEdit>
 #include <QModelIndex>
 #include <QStandardItem>
+#include <QString>
 #include <QTreeView>
 
 using std::shared_ptr;
@@ -48,6 +50,7 @@ namespace ui {
 namespace devices {
 namespace devicetree {
 
+class DeviceTreeFilterModel;
 class DeviceTreeModel;
 class TreeItem;
 
@@ -74,6 +77,19 @@ public:
 
 	void expand_device(shared_ptr<sv::devices::BaseDevice> device);
 
+	/**
+	 * Create a line edit, that sets the filter text of this tree. The line
+	 * edit is placed by the caller.
+	 */
+	QLineEdit *create_filter_edit(QWidget *parent = nullptr);
+
+public Q_SLOTS:
+	/**
+	 * Only show the signals, that match the filter text, with their
+	 * channels and devices, see SignalRegistry::search().
+	 */
+	void set_filter_text(const QString &filter_text);
+
 private:
 	void setup_ui();
 	void expand_recursive(QStandardItem *item);
@@ -88,6 +104,7 @@ private:
 	bool show_configurable_;
 	bool is_auto_expand_;
 	DeviceTreeModel *tree_model_;
+	DeviceTreeFilterModel *filter_model_;
 
 private Q_SLOTS:
 	void on_rows_inserted(const QModelIndex &model_index, int first, int last);
@@ -20,6 +20,8 @@
 #include <memory>
 
 #include <QDebug>
+#include <QLineEdit>
+#include <QString>
 #include <QVariant>
 #include <QVBoxLayout>
 #include <QWidget>
@@ -29,6 +31,7 @@
 #include "src/channels/basechannel.hpp"
 #include "src/data/basesignal.hpp"
 #include "src/data/datautil.hpp"
+#include "src/data/signalregistry.hpp"
 #include "src/devices/basedevice.hpp"
 #include "src/ui/devices/channelcombobox.hpp"
 #include "src/ui/devices/channelgroupcombobox.hpp"
@@ -46,7 +49,8 @@ namespace devices {
 SelectSignalWidget::SelectSignalWidget(
 		const Session &session, QWidget *parent) :
 	QWidget(parent),
-	session_(session)
+	session_(session),
+	filter_active_(false)
 {
 	setup_ui();
 	connect_signals();
@@ -58,6 +62,8 @@ void SelectSignalWidget::filter_quantity(sv::data::Quantity quantity)
 	//       signal/slots to work correctly!
 	signal_box_->filter_quantity(quantity);
 	channel_box_->filter_quantity(quantity);
+	filter_active_ = true;
+	filter_quantity_ = quantity;
 }
 
 void SelectSignalWidget::select_device(
@@ -66,6 +72,31 @@ void SelectSignalWidget::select_device(
 	device_box_->select_device(device);
 }
 
+void SelectSignalWidget::select_signal(
+	shared_ptr<sv::data::BaseSignal> signal)
+{
+	if (!signal)
+		return;
+	auto channel = signal->parent_channel();
+	if (!channel)
+		return;
+	auto device = channel->parent_device();
+	if (!device)
+		return;
+
+	// The boxes are filled by the change of the box above them
+	device_box_->select_device(device);
+	for (const auto &chg_name : channel->channel_group_names()) {
+		if (device->channel_group_map().count(chg_name) > 0) {
+			channel_group_box_->select_channel_group(
+				QString::fromStdString(chg_name));
+			break;
+		}
+	}
+	channel_box_->select_channel(channel);
+	signal_box_->select_signal(signal);
+}
+
 shared_ptr<sv::data::BaseSignal> SelectSignalWidget::selected_signal() const
 {
 	return signal_box_->selected_signal();
@@ -75,6 +106,13 @@ void SelectSignalWidget::setup_ui()
 {
 	QVBoxLayout *layout = new QVBoxLayout();
 
+	filter_edit_ = new QLineEdit();
+	filter_edit_->setPlaceholderText(tr("Search"));
+	filter_edit_->setToolTip(tr("Select the first signal, whose device, "
+		"channel, name, quantity or unit start with all the words"));
+	filter_edit_->setClearButtonEnabled(true);
+	layout->addWidget(filter_edit_);
+
 	device_box_ = new DeviceComboBox(session_);
 	layout->addWidget(device_box_);
 
@@ -95,6 +133,8 @@ void SelectSignalWidget::setup_ui()
 
 void SelectSignalWidget::connect_signals()
 {
+	connect(filter_edit_, SIGNAL(textChanged(const QString &)),
+		this, SLOT(on_filter_text_changed(const QString &)));
 	connect(device_box_, SIGNAL(currentIndexChanged(int)),
 		this, SLOT(on_device_changed()));
 	connect(channel_group_box_, SIGNAL(currentIndexChanged(int)),
@@ -120,6 +160,21 @@ void SelectSignalWidget::on_channel_changed()
 	signal_box_->change_channel(channel_box_->selected_channel());
 }
 
+void SelectSignalWidget::on_filter_text_changed(const QString &filter_text)
+{
+	if (filter_text.trimmed().isEmpty())
+		return;
+
+	const auto matches =
+		session_.signal_registry()->search(filter_text.toStdString());
+	for (const auto &signal : *matches) {
+		if (filter_active_ && signal->quantity() != filter_quantity_)
+			continue;
+		select_signal(signal);
+		return;
+	}
+}
+
 } // namespace devices
 } // namespace ui
 } // namespace sv
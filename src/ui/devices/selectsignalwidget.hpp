@@ -22,6 +22,8 @@
 
 #include <memory>
 
+#include <QLineEdit>
+#include <QString>
 #include <QWidget>
 
 #include "src/data/datautil.hpp"
@@ -58,11 +60,16 @@ public:
 
 	void filter_quantity(sv::data::Quantity quantity);
 	void select_device(shared_ptr<sv::devices::BaseDevice> device);
+	/** Select the device, channel group and channel of the signal too. */
+	void select_signal(shared_ptr<sv::data::BaseSignal> signal);
 	shared_ptr<sv::data::BaseSignal> selected_signal() const;
 
 private:
 	const Session &session_;
+	bool filter_active_;
+	sv::data::Quantity filter_quantity_;
 
+	QLineEdit *filter_edit_;
 	DeviceComboBox *device_box_;
 	ChannelGroupComboBox *channel_group_box_;
 	ChannelComboBox *channel_box_;
@@ -75,6 +82,7 @@ private Q_SLOTS:
 	void on_device_changed();
 	void on_channel_group_changed();
 	void on_channel_changed();
+	void on_filter_text_changed(const QString &filter_text);
 
 };
 
@@ -21,9 +21,12 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
+#include <QCheckBox>
 #include <QComboBox>
 #include <QDebug>
+#include <QDoubleSpinBox>
 #include <QFormLayout>
 #include <QGroupBox>
 #include <QHBoxLayout>
@@ -35,16 +38,24 @@
 #include <QWidget>
 
 #include "addmathchanneldialog.hpp"
+#include "src/channels/acpowerchannel.hpp"
 #include "src/channels/addscchannel.hpp"
 #include "src/channels/basechannel.hpp"
 #include "src/channels/dividechannel.hpp"
+#include "src/channels/emachannel.hpp"
+#include "src/channels/expressionchannel.hpp"
 #include "src/channels/integratechannel.hpp"
 #include "src/channels/mathchannel.hpp"
+#include "src/channels/minmaxholdchannel.hpp"
 #include "src/channels/movingavgchannel.hpp"
+#include "src/channels/movingmedianchannel.hpp"
 #include "src/channels/multiplysfchannel.hpp"
 #include "src/channels/multiplysschannel.hpp"
+#include "src/channels/resamplechannel.hpp"
+#include "src/channels/rmschannel.hpp"
 #include "src/data/analogtimesignal.hpp"
 #include "src/data/datautil.hpp"
+#include "src/data/expression.hpp"
 #include "src/devices/basedevice.hpp"
 #include "src/ui/data/quantitycombobox.hpp"
 #include "src/ui/data/quantityflagslist.hpp"
@@ -57,6 +68,7 @@ using std::make_shared;
 using std::set;
 using std::static_pointer_cast;
 using std::string;
+using std::vector;
 
 Q_DECLARE_SMART_POINTER_METATYPE(std::shared_ptr)
 
@@ -91,6 +103,10 @@ void AddMathChannelDialog::setup_ui()
 	QFormLayout *form_layout = new QFormLayout();
 	name_edit_ = new QLineEdit();
 	form_layout->addRow(tr("Name"), name_edit_);
+	lazy_box_ = new QCheckBox(tr("Calculate only while observed"));
+	lazy_box_->setToolTip(tr("The channel is only calculated, while it is "
+		"shown in a view or used by another channel"));
+	form_layout->addRow(QString(), lazy_box_);
 	main_layout->addLayout(form_layout);
 
 	// Measured Quantity
@@ -127,6 +143,13 @@ void AddMathChannelDialog::setup_ui()
 	this->setup_ui_add_signal_tab();
 	this->setup_ui_integrate_signal_tab();
 	this->setup_ui_movingavg_signal_tab();
+	this->setup_ui_ema_signal_tab();
+	this->setup_ui_movingmedian_signal_tab();
+	this->setup_ui_minmaxhold_signal_tab();
+	this->setup_ui_rms_signal_tab();
+	this->setup_ui_expression_tab();
+	this->setup_ui_resample_signal_tab();
+	this->setup_ui_ac_power_tab();
 	tab_widget_->setCurrentIndex(0);
 	main_layout->addWidget(tab_widget_);
 
@@ -257,6 +280,17 @@ void AddMathChannelDialog::setup_ui_integrate_signal_tab()
 	signal_group->setLayout(s_layout);
 	layout->addWidget(signal_group);
 
+	QFormLayout *m_layout = new QFormLayout();
+	// The items are in the order of channels::IntegrationMethod
+	i_method_box_ = new QComboBox();
+	i_method_box_->addItem(tr("Rectangle"));
+	i_method_box_->addItem(tr("Trapezoid"));
+	i_method_box_->addItem(tr("Simpson"));
+	i_method_box_->setCurrentIndex(
+		(int)channels::IntegrationMethod::Trapezoid);
+	m_layout->addRow(tr("Method"), i_method_box_);
+	layout->addLayout(m_layout);
+
 	widget->setLayout(layout);
 	tab_widget_->addTab(widget, title);
 }
@@ -278,14 +312,162 @@ void AddMathChannelDialog::setup_ui_movingavg_signal_tab()
 
 	QFormLayout *ac_layout = new QFormLayout();
 	ma_num_samples_box_ = new QSpinBox();
-	ma_num_samples_box_->setMinimum(1);
+	ma_num_samples_box_->setRange(0, 10000000);
+	ma_num_samples_box_->setSpecialValueText(tr("Unlimited"));
+	ma_num_samples_box_->setValue(10);
 	ac_layout->addRow(tr("Sample count"), ma_num_samples_box_);
+	ma_time_span_box_ = new QDoubleSpinBox();
+	ma_time_span_box_->setRange(0., 86400.);
+	ma_time_span_box_->setDecimals(3);
+	ma_time_span_box_->setSuffix(QString(" s"));
+	ma_time_span_box_->setSpecialValueText(tr("Unlimited"));
+	ac_layout->addRow(tr("Time span"), ma_time_span_box_);
+	layout->addLayout(ac_layout);
+
+	widget->setLayout(layout);
+	tab_widget_->addTab(widget, title);
+}
+
+void AddMathChannelDialog::setup_ui_ema_signal_tab()
+{
+	QString title(tr("EMA"));
+
+	QWidget *widget = new QWidget();
+	QVBoxLayout *layout = new QVBoxLayout();
+
+	QGroupBox *signal_group = new QGroupBox(tr("Signal"));
+	QVBoxLayout *s_layout = new QVBoxLayout();
+	ema_signal_ = new ui::devices::SelectSignalWidget(session_);
+	ema_signal_->select_device(device_);
+	s_layout->addWidget(ema_signal_);
+	signal_group->setLayout(s_layout);
+	layout->addWidget(signal_group);
+
+	QFormLayout *ac_layout = new QFormLayout();
+	ema_time_constant_box_ = new QDoubleSpinBox();
+	ema_time_constant_box_->setRange(0.001, 86400.);
+	ema_time_constant_box_->setDecimals(3);
+	ema_time_constant_box_->setSuffix(QString(" s"));
+	ema_time_constant_box_->setValue(1.);
+	ac_layout->addRow(tr("Time constant"), ema_time_constant_box_);
+	layout->addLayout(ac_layout);
+
+	widget->setLayout(layout);
+	tab_widget_->addTab(widget, title);
+}
+
+void AddMathChannelDialog::setup_ui_movingmedian_signal_tab()
+{
+	QString title(tr("Moving Median"));
+
+	QWidget *widget = new QWidget();
+	QVBoxLayout *layout = new QVBoxLayout();
+
+	QGroupBox *signal_group = new QGroupBox(tr("Signal"));
+	QVBoxLayout *s_layout = new QVBoxLayout();
+	mm_signal_ = new ui::devices::SelectSignalWidget(session_);
+	mm_signal_->select_device(device_);
+	s_layout->addWidget(mm_signal_);
+	signal_group->setLayout(s_layout);
+	layout->addWidget(signal_group);
+
+	QFormLayout *ac_layout = new QFormLayout();
+	mm_num_samples_box_ = new QSpinBox();
+	mm_num_samples_box_->setRange(1, 10000000);
+	mm_num_samples_box_->setValue(10);
+	ac_layout->addRow(tr("Sample count"), mm_num_samples_box_);
+	layout->addLayout(ac_layout);
+
+	widget->setLayout(layout);
+	tab_widget_->addTab(widget, title);
+}
+
+void AddMathChannelDialog::setup_ui_minmaxhold_signal_tab()
+{
+	QString title(tr("Min/Max Hold"));
+
+	QWidget *widget = new QWidget();
+	QVBoxLayout *layout = new QVBoxLayout();
+
+	QGroupBox *signal_group = new QGroupBox(tr("Signal"));
+	QVBoxLayout *s_layout = new QVBoxLayout();
+	mmh_signal_ = new ui::devices::SelectSignalWidget(session_);
+	mmh_signal_->select_device(device_);
+	s_layout->addWidget(mmh_signal_);
+	signal_group->setLayout(s_layout);
+	layout->addWidget(signal_group);
+
+	QFormLayout *ac_layout = new QFormLayout();
+	mmh_type_box_ = new QComboBox();
+	mmh_type_box_->addItem(tr("Minimum"));
+	mmh_type_box_->addItem(tr("Maximum"));
+	ac_layout->addRow(tr("Type"), mmh_type_box_);
+	mmh_num_samples_box_ = new QSpinBox();
+	mmh_num_samples_box_->setRange(0, 10000000);
+	mmh_num_samples_box_->setSpecialValueText(tr("Unlimited"));
+	mmh_num_samples_box_->setValue(10);
+	ac_layout->addRow(tr("Sample count"), mmh_num_samples_box_);
 	layout->addLayout(ac_layout);
 
 	widget->setLayout(layout);
 	tab_widget_->addTab(widget, title);
 }
 
+void AddMathChannelDialog::setup_ui_rms_signal_tab()
+{
+	QString title(tr("Moving RMS"));
+
+	QWidget *widget = new QWidget();
+	QVBoxLayout *layout = new QVBoxLayout();
+
+	QGroupBox *signal_group = new QGroupBox(tr("Signal"));
+	QVBoxLayout *s_layout = new QVBoxLayout();
+	rms_signal_ = new ui::devices::SelectSignalWidget(session_);
+	rms_signal_->select_device(device_);
+	s_layout->addWidget(rms_signal_);
+	signal_group->setLayout(s_layout);
+	layout->addWidget(signal_group);
+
+	QFormLayout *ac_layout = new QFormLayout();
+	rms_num_samples_box_ = new QSpinBox();
+	rms_num_samples_box_->setRange(1, 10000000);
+	rms_num_samples_box_->setValue(10);
+	ac_layout->addRow(tr("Sample count"), rms_num_samples_box_);
+	layout->addLayout(ac_layout);
+
+	widget->setLayout(layout);
+	tab_widget_->addTab(widget, title);
+}
+
+void AddMathChannelDialog::setup_ui_expression_tab()
+{
+	QString title(tr("Expression"));
+
+	QWidget *widget = new QWidget();
+	QVBoxLayout *layout = new QVBoxLayout();
+
+	QFormLayout *e_layout = new QFormLayout();
+	e_expression_edit_ = new QLineEdit();
+	e_expression_edit_->setPlaceholderText(QString("(v1 - v2) / 0.1 * 1000"));
+	e_layout->addRow(tr("Expression"), e_expression_edit_);
+	layout->addLayout(e_layout);
+
+	for (size_t i = 0; i < expression_signal_count_; ++i) {
+		QGroupBox *signal_group = new QGroupBox(
+			tr("Signal v%1").arg(i + 1));
+		QVBoxLayout *s_layout = new QVBoxLayout();
+		auto *signal_widget = new ui::devices::SelectSignalWidget(session_);
+		signal_widget->select_device(device_);
+		s_layout->addWidget(signal_widget);
+		signal_group->setLayout(s_layout);
+		layout->addWidget(signal_group);
+		e_signals_.push_back(signal_widget);
+	}
+
+	widget->setLayout(layout);
+	tab_widget_->addTab(widget, title);
+}
+
 shared_ptr<channels::MathChannel> AddMathChannelDialog::channel() const
 {
 	return channel_;
@@ -296,6 +478,94 @@ QString AddMathChannelDialog::channel_group_name() const
 	return channel_group_box_->selected_channel_group();
 }
 
+bool AddMathChannelDialog::lazy() const
+{
+	return lazy_box_->isChecked();
+}
+
+void AddMathChannelDialog::setup_ui_resample_signal_tab()
+{
+	QString title(tr("Resample"));
+
+	QWidget *widget = new QWidget();
+	QVBoxLayout *layout = new QVBoxLayout();
+
+	QGroupBox *signal_group = new QGroupBox(tr("Signal"));
+	QVBoxLayout *s_layout = new QVBoxLayout();
+	rs_signal_ = new ui::devices::SelectSignalWidget(session_);
+	rs_signal_->select_device(device_);
+	s_layout->addWidget(rs_signal_);
+	signal_group->setLayout(s_layout);
+	layout->addWidget(signal_group);
+
+	QFormLayout *r_layout = new QFormLayout();
+	rs_rate_box_ = new QDoubleSpinBox();
+	rs_rate_box_->setRange(0.001, 1000000.);
+	rs_rate_box_->setDecimals(3);
+	rs_rate_box_->setSuffix(QString(" Hz"));
+	rs_rate_box_->setValue(10.);
+	r_layout->addRow(tr("Rate"), rs_rate_box_);
+	// The items are in the order of channels::ResampleMethod
+	rs_method_box_ = new QComboBox();
+	rs_method_box_->addItem(tr("Linear"));
+	rs_method_box_->addItem(tr("Zero-order hold"));
+	r_layout->addRow(tr("Interpolation"), rs_method_box_);
+	layout->addLayout(r_layout);
+
+	widget->setLayout(layout);
+	tab_widget_->addTab(widget, title);
+}
+
+void AddMathChannelDialog::setup_ui_ac_power_tab()
+{
+	QString title(tr("AC Power"));
+
+	QWidget *widget = new QWidget();
+	QVBoxLayout *layout = new QVBoxLayout();
+
+	QHBoxLayout *signals_layout = new QHBoxLayout();
+	QGroupBox *voltage_group = new QGroupBox(tr("Voltage"));
+	QVBoxLayout *v_layout = new QVBoxLayout();
+	acp_voltage_signal_ = new ui::devices::SelectSignalWidget(session_);
+	acp_voltage_signal_->select_device(device_);
+	v_layout->addWidget(acp_voltage_signal_);
+	voltage_group->setLayout(v_layout);
+	signals_layout->addWidget(voltage_group);
+
+	QGroupBox *current_group = new QGroupBox(tr("Current"));
+	QVBoxLayout *c_layout = new QVBoxLayout();
+	acp_current_signal_ = new ui::devices::SelectSignalWidget(session_);
+	acp_current_signal_->select_device(device_);
+	c_layout->addWidget(acp_current_signal_);
+	current_group->setLayout(c_layout);
+	signals_layout->addWidget(current_group);
+	layout->addLayout(signals_layout);
+
+	QFormLayout *acp_layout = new QFormLayout();
+	// The items are in the order of channels::AcPowerValue
+	acp_value_box_ = new QComboBox();
+	acp_value_box_->addItem(tr("Real power"));
+	acp_value_box_->addItem(tr("Apparent power"));
+	acp_value_box_->addItem(tr("Reactive power"));
+	acp_value_box_->addItem(tr("Power factor"));
+	acp_value_box_->addItem(tr("Voltage RMS"));
+	acp_value_box_->addItem(tr("Current RMS"));
+	acp_value_box_->addItem(tr("Frequency"));
+	acp_layout->addRow(tr("Value"), acp_value_box_);
+	acp_cycle_count_box_ = new QSpinBox();
+	acp_cycle_count_box_->setRange(1, 100000);
+	acp_cycle_count_box_->setValue(10);
+	acp_cycle_count_box_->setToolTip(
+		tr("The number of cycles, that make one result"));
+	acp_layout->addRow(tr("Cycles per result"), acp_cycle_count_box_);
+	layout->addLayout(acp_layout);
+	connect(acp_value_box_, SIGNAL(currentIndexChanged(int)),
+		this, SLOT(on_ac_power_value_changed()));
+
+	widget->setLayout(layout);
+	tab_widget_->addTab(widget, title);
+}
+
 void AddMathChannelDialog::accept()
 {
 	if (name_edit_->text().size() == 0) {
@@ -461,10 +731,12 @@ void AddMathChannelDialog::accept()
 			}
 			auto signal = static_pointer_cast<sv::data::AnalogTimeSignal>(
 				i_s_signal_->selected_signal());
+			auto method = (channels::IntegrationMethod)
+				i_method_box_->currentIndex();
 
 			channel_ = make_shared<channels::IntegrateChannel>(
 				quantity, quantity_flags, unit,
-				signal,
+				signal, method,
 				device, channel_group_names, name_edit_->text().toStdString(),
 				signal->signal_start_timestamp());
 		}
@@ -481,14 +753,194 @@ void AddMathChannelDialog::accept()
 				ma_signal_->selected_signal());
 
 			uint num_samples = ma_num_samples_box_->value();
+			double time_span = ma_time_span_box_->value();
+			if (num_samples == 0 && time_span <= 0) {
+				QMessageBox::warning(this,
+					tr("Window missing"),
+					tr("Please limit the moving average by a sample count or a time span."),
+					QMessageBox::Ok);
+				return;
+			}
 
 			channel_ = make_shared<channels::MovingAvgChannel>(
+				quantity, quantity_flags, unit,
+				signal, num_samples, time_span,
+				device, channel_group_names, name_edit_->text().toStdString(),
+				signal->signal_start_timestamp());
+		}
+		break;
+	case 6: {
+			if (ema_signal_->selected_signal() == nullptr) {
+				QMessageBox::warning(this,
+					tr("Signal missing"),
+					tr("Please choose a signal for the exponential moving average."),
+					QMessageBox::Ok);
+				return;
+			}
+			auto signal = static_pointer_cast<sv::data::AnalogTimeSignal>(
+				ema_signal_->selected_signal());
+
+			channel_ = make_shared<channels::EmaChannel>(
+				quantity, quantity_flags, unit,
+				signal, ema_time_constant_box_->value(),
+				device, channel_group_names, name_edit_->text().toStdString(),
+				signal->signal_start_timestamp());
+		}
+		break;
+	case 7: {
+			if (mm_signal_->selected_signal() == nullptr) {
+				QMessageBox::warning(this,
+					tr("Signal missing"),
+					tr("Please choose a signal for the moving median."),
+					QMessageBox::Ok);
+				return;
+			}
+			auto signal = static_pointer_cast<sv::data::AnalogTimeSignal>(
+				mm_signal_->selected_signal());
+
+			uint num_samples = mm_num_samples_box_->value();
+
+			channel_ = make_shared<channels::MovingMedianChannel>(
 				quantity, quantity_flags, unit,
 				signal, num_samples,
 				device, channel_group_names, name_edit_->text().toStdString(),
 				signal->signal_start_timestamp());
 		}
 		break;
+	case 8: {
+			if (mmh_signal_->selected_signal() == nullptr) {
+				QMessageBox::warning(this,
+					tr("Signal missing"),
+					tr("Please choose a signal for the min/max hold."),
+					QMessageBox::Ok);
+				return;
+			}
+			auto signal = static_pointer_cast<sv::data::AnalogTimeSignal>(
+				mmh_signal_->selected_signal());
+
+			channels::MinMaxHoldType type = mmh_type_box_->currentIndex() == 0 ?
+				channels::MinMaxHoldType::Min : channels::MinMaxHoldType::Max;
+			uint num_samples = mmh_num_samples_box_->value();
+
+			channel_ = make_shared<channels::MinMaxHoldChannel>(
+				quantity, quantity_flags, unit,
+				signal, type, num_samples,
+				device, channel_group_names, name_edit_->text().toStdString(),
+				signal->signal_start_timestamp());
+		}
+		break;
+	case 9: {
+			if (rms_signal_->selected_signal() == nullptr) {
+				QMessageBox::warning(this,
+					tr("Signal missing"),
+					tr("Please choose a signal for the moving RMS."),
+					QMessageBox::Ok);
+				return;
+			}
+			auto signal = static_pointer_cast<sv::data::AnalogTimeSignal>(
+				rms_signal_->selected_signal());
+
+			uint num_samples = rms_num_samples_box_->value();
+
+			channel_ = make_shared<channels::RmsChannel>(
+				quantity, quantity_flags, unit,
+				signal, num_samples,
+				device, channel_group_names, name_edit_->text().toStdString(),
+				signal->signal_start_timestamp());
+		}
+		break;
+	case 10: {
+			const string formula = e_expression_edit_->text().toStdString();
+			const size_t signal_count =
+				sv::data::Expression::max_variable(formula);
+			if (signal_count == 0 || signal_count > e_signals_.size()) {
+				QMessageBox::warning(this,
+					tr("Signal missing"),
+					tr("Please use the signals v1 to v%1 in the expression.").
+						arg(e_signals_.size()),
+					QMessageBox::Ok);
+				return;
+			}
+
+			vector<shared_ptr<sv::data::AnalogTimeSignal>> signals;
+			for (size_t i = 0; i < signal_count; ++i) {
+				if (e_signals_[i]->selected_signal() == nullptr) {
+					QMessageBox::warning(this,
+						tr("Signal missing"),
+						tr("Please choose a signal for v%1.").arg(i + 1),
+						QMessageBox::Ok);
+					return;
+				}
+				signals.push_back(static_pointer_cast<sv::data::AnalogTimeSignal>(
+					e_signals_[i]->selected_signal()));
+			}
+
+			sv::data::Expression expression;
+			if (!expression.compile(formula, signal_count)) {
+				QMessageBox::warning(this,
+					tr("Invalid expression"),
+					QString::fromStdString(expression.error()),
+					QMessageBox::Ok);
+				return;
+			}
+
+			channel_ = make_shared<channels::ExpressionChannel>(
+				quantity, quantity_flags, unit,
+				signals, formula,
+				device, channel_group_names, name_edit_->text().toStdString(),
+				signals[0]->signal_start_timestamp());
+		}
+		break;
+	case 11: {
+			if (rs_signal_->selected_signal() == nullptr) {
+				QMessageBox::warning(this,
+					tr("Signal missing"),
+					tr("Please choose a signal for the resampling."),
+					QMessageBox::Ok);
+				return;
+			}
+			auto signal = static_pointer_cast<sv::data::AnalogTimeSignal>(
+				rs_signal_->selected_signal());
+			auto method = (channels::ResampleMethod)
+				rs_method_box_->currentIndex();
+
+			channel_ = make_shared<channels::ResampleChannel>(
+				quantity, quantity_flags, unit,
+				signal, rs_rate_box_->value(), method,
+				device, channel_group_names, name_edit_->text().toStdString(),
+				signal->signal_start_timestamp());
+		}
+		break;
+	case 12: {
+			if (acp_voltage_signal_->selected_signal() == nullptr ||
+					acp_current_signal_->selected_signal() == nullptr) {
+				QMessageBox::warning(this,
+					tr("Signal missing"),
+					tr("Please choose the voltage and the current signal for the AC power."),
+					QMessageBox::Ok);
+				return;
+			}
+			auto voltage_signal =
+				static_pointer_cast<sv::data::AnalogTimeSignal>(
+					acp_voltage_signal_->selected_signal());
+			auto current_signal =
+				static_pointer_cast<sv::data::AnalogTimeSignal>(
+					acp_current_signal_->selected_signal());
+			auto value = (channels::AcPowerValue)
+				acp_value_box_->currentIndex();
+
+			double start_timestamp = voltage_signal->signal_start_timestamp();
+			if (current_signal->signal_start_timestamp() < start_timestamp)
+				start_timestamp = current_signal->signal_start_timestamp();
+
+			channel_ = make_shared<channels::AcPowerChannel>(
+				quantity, quantity_flags, unit,
+				voltage_signal, current_signal, value,
+				acp_cycle_count_box_->value(),
+				device, channel_group_names, name_edit_->text().toStdString(),
+				start_timestamp);
+		}
+		break;
 	default:
 		break;
 	}
@@ -501,6 +953,24 @@ void AddMathChannelDialog::on_device_changed()
 	channel_group_box_->change_device(device_box_->selected_device());
 }
 
+void AddMathChannelDialog::on_ac_power_value_changed()
+{
+	// Preset the measured quantity, that fits the value
+	sv::data::Quantity quantity;
+	set<sv::data::QuantityFlag> quantity_flags;
+	sv::data::Unit unit;
+	channels::AcPowerChannel::value_quantity(
+		(channels::AcPowerValue)acp_value_box_->currentIndex(),
+		static_pointer_cast<sv::data::AnalogTimeSignal>(
+			acp_voltage_signal_->selected_signal()),
+		static_pointer_cast<sv::data::AnalogTimeSignal>(
+			acp_current_signal_->selected_signal()),
+		quantity, quantity_flags, unit);
+	quantity_box_->select_quantity(quantity);
+	quantity_flags_list_->select_quantity_flags(quantity_flags);
+	unit_box_->select_unit(unit);
+}
+
 } // namespace dialogs
 } // namespace ui
 } // namespace sv
@@ -21,9 +21,13 @@
 #define UI_DIALOGS_ADDMATHCHANNELDIALOG_HPP
 
 #include <memory>
+#include <vector>
 
+#include <QCheckBox>
+#include <QComboBox>
 #include <QDialog>
 #include <QDialogButtonBox>
+#include <QDoubleSpinBox>
 #include <QLineEdit>
 #include <QSpinBox>
 #include <QTabWidget>
@@ -31,6 +35,7 @@
 #include "src/session.hpp"
 
 using std::shared_ptr;
+using std::vector;
 
 namespace sv {
 
@@ -67,6 +72,7 @@ public:
 
 	shared_ptr<channels::MathChannel> channel() const;
 	QString channel_group_name() const;
+	bool lazy() const;
 
 private:
 	void setup_ui();
@@ -77,6 +83,16 @@ private:
 	void setup_ui_add_signal_tab();
 	void setup_ui_integrate_signal_tab();
 	void setup_ui_movingavg_signal_tab();
+	void setup_ui_ema_signal_tab();
+	void setup_ui_movingmedian_signal_tab();
+	void setup_ui_minmaxhold_signal_tab();
+	void setup_ui_rms_signal_tab();
+	void setup_ui_expression_tab();
+	void setup_ui_resample_signal_tab();
+	void setup_ui_ac_power_tab();
+
+	/** The number of signals, that can be selected for an expression. */
+	static const size_t expression_signal_count_ = 4;
 
 	const Session &session_;
 	shared_ptr<sv::devices::BaseDevice> device_;
@@ -84,6 +100,7 @@ private:
 
 	QTabWidget *tab_widget_;
 	QLineEdit *name_edit_;
+	QCheckBox *lazy_box_;
 	ui::data::QuantityComboBox *quantity_box_;
 	ui::data::QuantityFlagsList *quantity_flags_list_;
 	ui::data::UnitComboBox *unit_box_;
@@ -98,8 +115,28 @@ private:
 	ui::devices::SelectSignalWidget *a_sc_signal_;
 	QLineEdit *a_sc_constant_edit_;
 	ui::devices::SelectSignalWidget *i_s_signal_;
+	QComboBox *i_method_box_;
 	ui::devices::SelectSignalWidget *ma_signal_;
 	QSpinBox *ma_num_samples_box_;
+	QDoubleSpinBox *ma_time_span_box_;
+	ui::devices::SelectSignalWidget *ema_signal_;
+	QDoubleSpinBox *ema_time_constant_box_;
+	ui::devices::SelectSignalWidget *mm_signal_;
+	QSpinBox *mm_num_samples_box_;
+	ui::devices::SelectSignalWidget *mmh_signal_;
+	QComboBox *mmh_type_box_;
+	QSpinBox *mmh_num_samples_box_;
+	ui::devices::SelectSignalWidget *rms_signal_;
+	QSpinBox *rms_num_samples_box_;
+	QLineEdit *e_expression_edit_;
+	vector<ui::devices::SelectSignalWidget *> e_signals_;
+	ui::devices::SelectSignalWidget *rs_signal_;
+	QDoubleSpinBox *rs_rate_box_;
+	QComboBox *rs_method_box_;
+	ui::devices::SelectSignalWidget *acp_voltage_signal_;
+	ui::devices::SelectSignalWidget *acp_current_signal_;
+	QComboBox *acp_value_box_;
+	QSpinBox *acp_cycle_count_box_;
 	QDialogButtonBox *button_box_;
 
 public Q_SLOTS:
@@ -107,6 +144,7 @@ public Q_SLOTS:
 
 private Q_SLOTS:
 	void on_device_changed();
+	void on_ac_power_value_changed();
 
 };
 
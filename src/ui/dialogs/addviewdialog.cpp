@@ -29,6 +29,7 @@
 
 #include "addviewdialog.hpp"
 #include "src/channels/basechannel.hpp"
+#include "src/channels/hardwarechannel.hpp"
 #include "src/data/analogtimesignal.hpp"
 #include "src/data/properties/baseproperty.hpp"
 #include "src/data/properties/doubleproperty.hpp"
@@ -41,13 +42,18 @@
 #include "src/ui/devices/devicetree/devicetreeview.hpp"
 #include "src/ui/views/baseview.hpp"
 #include "src/ui/views/dataview.hpp"
+#include "src/ui/views/frameoverlayview.hpp"
+#include "src/ui/views/histogramview.hpp"
 #include "src/ui/views/powerpanelview.hpp"
 #include "src/ui/views/sequenceoutputview.hpp"
+#include "src/ui/views/spectrumview.hpp"
+#include "src/ui/views/statisticsview.hpp"
 #include "src/ui/views/timeplotview.hpp"
 #include "src/ui/views/valuepanelview.hpp"
 #include "src/ui/views/viewhelper.hpp"
 #include "src/ui/views/xyplotview.hpp"
 
+using std::dynamic_pointer_cast;
 using std::set;
 using std::static_pointer_cast;
 
@@ -88,6 +94,10 @@ void AddViewDialog::setup_ui()
 	this->setup_ui_xy_plot_tab();
 	this->setup_ui_data_table_tab();
 	this->setup_ui_power_panel_tab();
+	this->setup_ui_spectrum_tab();
+	this->setup_ui_histogram_tab();
+	this->setup_ui_statistics_tab();
+	this->setup_ui_frame_overlay_tab();
 	tab_widget_->setCurrentIndex(selected_tab_);
 	main_layout->addWidget(tab_widget_);
 
@@ -137,7 +147,7 @@ void AddViewDialog::setup_ui_panel_tab()
 	panel_channel_tree_ = new ui::devices::devicetree::DeviceTreeView(
 		session_, false, false, true, false, false, false, false, false);
 	panel_channel_tree_->expand_device(device_);
-
+	layout->addWidget(panel_channel_tree_->create_filter_edit());
 	layout->addWidget(panel_channel_tree_);
 
 	tab_widget_->addTab(panel_widget, title);
@@ -153,7 +163,7 @@ void AddViewDialog::setup_ui_time_plot_tab()
 	time_plot_channel_tree_ = new ui::devices::devicetree::DeviceTreeView(
 		session_, false, false, true, true, false, false, false, false);
 	time_plot_channel_tree_->expand_device(device_);
-
+	layout->addWidget(time_plot_channel_tree_->create_filter_edit());
 	layout->addWidget(time_plot_channel_tree_);
 
 	tab_widget_->addTab(plot_widget, title);
@@ -195,7 +205,7 @@ void AddViewDialog::setup_ui_data_table_tab()
 	data_table_signal_tree_ = new ui::devices::devicetree::DeviceTreeView(
 		session_, false, false, false, true, false, false, false, false);
 	data_table_signal_tree_->expand_device(device_);
-
+	layout->addWidget(data_table_signal_tree_->create_filter_edit());
 	layout->addWidget(data_table_signal_tree_);
 
 	tab_widget_->addTab(table_widget, title);
@@ -229,6 +239,74 @@ void AddViewDialog::setup_ui_power_panel_tab()
 	tab_widget_->addTab(pp_widget, title);
 }
 
+void AddViewDialog::setup_ui_spectrum_tab()
+{
+	QString title(tr("Spectrum"));
+	QWidget *spectrum_widget = new QWidget();
+	QVBoxLayout *layout = new QVBoxLayout();
+	spectrum_widget->setLayout(layout);
+
+	QGroupBox *signal_group = new QGroupBox(tr("Signal"));
+	QVBoxLayout *signal_layout = new QVBoxLayout();
+	spectrum_signal_widget_ = new ui::devices::SelectSignalWidget(session_);
+	spectrum_signal_widget_->select_device(device_);
+	signal_layout->addWidget(spectrum_signal_widget_);
+	signal_group->setLayout(signal_layout);
+	layout->addWidget(signal_group);
+
+	tab_widget_->addTab(spectrum_widget, title);
+}
+
+void AddViewDialog::setup_ui_histogram_tab()
+{
+	QString title(tr("Histogram"));
+	QWidget *histogram_widget = new QWidget();
+	QVBoxLayout *layout = new QVBoxLayout();
+	histogram_widget->setLayout(layout);
+
+	QGroupBox *signal_group = new QGroupBox(tr("Signal"));
+	QVBoxLayout *signal_layout = new QVBoxLayout();
+	histogram_signal_widget_ = new ui::devices::SelectSignalWidget(session_);
+	histogram_signal_widget_->select_device(device_);
+	signal_layout->addWidget(histogram_signal_widget_);
+	signal_group->setLayout(signal_layout);
+	layout->addWidget(signal_group);
+
+	tab_widget_->addTab(histogram_widget, title);
+}
+
+void AddViewDialog::setup_ui_statistics_tab()
+{
+	QString title(tr("Statistics"));
+	QWidget *statistics_widget = new QWidget();
+	QVBoxLayout *layout = new QVBoxLayout();
+	statistics_widget->setLayout(layout);
+
+	statistics_signal_tree_ = new ui::devices::devicetree::DeviceTreeView(
+		session_, false, false, false, true, false, false, false, false);
+	statistics_signal_tree_->expand_device(device_);
+	layout->addWidget(statistics_signal_tree_->create_filter_edit());
+	layout->addWidget(statistics_signal_tree_);
+
+	tab_widget_->addTab(statistics_widget, title);
+}
+
+void AddViewDialog::setup_ui_frame_overlay_tab()
+{
+	QString title(tr("Frames"));
+	QWidget *frame_overlay_widget = new QWidget();
+	QVBoxLayout *layout = new QVBoxLayout();
+	frame_overlay_widget->setLayout(layout);
+
+	frame_overlay_channel_tree_ = new ui::devices::devicetree::DeviceTreeView(
+		session_, false, false, true, false, false, false, false, false);
+	frame_overlay_channel_tree_->expand_device(device_);
+	layout->addWidget(frame_overlay_channel_tree_->create_filter_edit());
+	layout->addWidget(frame_overlay_channel_tree_);
+
+	tab_widget_->addTab(frame_overlay_widget, title);
+}
+
 vector<ui::views::BaseView *> AddViewDialog::views()
 {
 	return views_;
@@ -323,6 +401,57 @@ void AddViewDialog::accept()
 			}
 		}
 		break;
+	case 7:
+		// Add spectrum view
+		{
+			auto signal = spectrum_signal_widget_->selected_signal();
+			if (signal != nullptr) {
+				auto view = new ui::views::SpectrumView(session_);
+				view->set_signal(
+					static_pointer_cast<data::AnalogTimeSignal>(signal));
+				views_.push_back(view);
+			}
+		}
+		break;
+	case 8:
+		// Add histogram view
+		{
+			auto signal = histogram_signal_widget_->selected_signal();
+			if (signal != nullptr) {
+				auto view = new ui::views::HistogramView(session_);
+				view->set_signal(
+					static_pointer_cast<data::AnalogTimeSignal>(signal));
+				views_.push_back(view);
+			}
+		}
+		break;
+	case 9:
+		// Add statistics view
+		{
+			auto signals = statistics_signal_tree_->checked_signals();
+			if (!signals.empty()) {
+				auto view = new ui::views::StatisticsView(session_);
+				for (const auto &signal : signals) {
+					view->add_signal(
+						static_pointer_cast<data::AnalogTimeSignal>(signal));
+				}
+				views_.push_back(view);
+			}
+		}
+		break;
+	case 10:
+		// Add frame overlay view, only hardware channels deliver frames
+		for (const auto &channel :
+				frame_overlay_channel_tree_->checked_channels()) {
+			auto hw_channel =
+				dynamic_pointer_cast<channels::HardwareChannel>(channel);
+			if (!hw_channel)
+				continue;
+			auto view = new ui::views::FrameOverlayView(session_);
+			view->set_channel(hw_channel);
+			views_.push_back(view);
+		}
+		break;
 	default:
 		break;
 	}
@@ -74,6 +74,10 @@ private:
 	void setup_ui_xy_plot_tab();
 	void setup_ui_data_table_tab();
 	void setup_ui_power_panel_tab();
+	void setup_ui_spectrum_tab();
+	void setup_ui_histogram_tab();
+	void setup_ui_statistics_tab();
+	void setup_ui_frame_overlay_tab();
 
 	Session &session_;
 	const shared_ptr<sv::devices::BaseDevice> device_;
@@ -90,6 +94,10 @@ private:
 	ui::devices::devicetree::DeviceTreeView *data_table_signal_tree_;
 	ui::devices::SelectSignalWidget *ppanel_voltage_signal_widget_;
 	ui::devices::SelectSignalWidget *ppanel_current_signal_widget_;
+	ui::devices::SelectSignalWidget *spectrum_signal_widget_;
+	ui::devices::SelectSignalWidget *histogram_signal_widget_;
+	ui::devices::devicetree::DeviceTreeView *statistics_signal_tree_;
+	ui::devices::devicetree::DeviceTreeView *frame_overlay_channel_tree_;
 	QDialogButtonBox *button_box_;
 
 public Q_SLOTS:
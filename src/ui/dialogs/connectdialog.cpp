@@ -23,7 +23,6 @@
 #include <memory>
 #include <mutex>
 #include <string>
-#include <thread>
 
 #include <libsigrokcxx/libsigrokcxx.hpp>
 
@@ -34,13 +33,13 @@
 
 #include "connectdialog.hpp"
 #include "src/devicemanager.hpp"
+#include "src/executor.hpp"
 #include "src/devices/deviceutil.hpp"
 
 using std::list;
 using std::map;
 using std::shared_ptr;
 using std::string;
-using std::thread;
 
 using Glib::ustring;
 using Glib::Variant;
@@ -197,7 +196,7 @@ ConnectDialog::ConnectDialog(sv::DeviceManager &device_manager,
 
 ConnectDialog::~ConnectDialog() {
 	/*
-	 * NOTE: Wait until a potentially running populate_serials_thread_ thread
+	 * NOTE: Wait until a potentially running populate_serials_thread_proc()
 	 *       has finished, otherwise sv will crash.
 	 *       Waiting for the lock/mutex isn't strictly needed (empty d'tor is
 	 *       sufficient), but better safe than sorry. :)
@@ -254,9 +253,10 @@ void ConnectDialog::populate_serials_start(shared_ptr<Driver> driver)
 	serial_devices_.addItem(tr("Loading..."));
 	serial_config_->setDisabled(true);
 
-	populate_serials_thread_ =
-		std::thread(&ConnectDialog::populate_serials_thread_proc, this, driver);
-	populate_serials_thread_.detach();
+	// Enumerating the ports can take a while, it's done in the I/O pool
+	Executor::run_io([this, driver]() {
+		populate_serials_thread_proc(driver);
+	});
 }
 
 void ConnectDialog::populate_serials_finish(
@@ -360,7 +360,7 @@ void ConnectDialog::scan_pressed()
 	}
 
 	const list<shared_ptr<HardwareDevice>> devices =
-		device_manager_.driver_scan(driver, drvopts);
+		device_manager_.run_driver_scan(driver, drvopts);
 
 	for (const auto &device : devices) {
 		assert(device);
@@ -25,7 +25,6 @@
 #include <memory>
 #include <mutex>
 #include <string>
-#include <thread>
 
 #include <QCheckBox>
 #include <QComboBox>
@@ -106,7 +105,6 @@ private:
 	QRadioButton *radiobtn_tcp_;
 	QRadioButton *radiobtn_gpib_;
 
-	std::thread populate_serials_thread_;
 	std::mutex populate_serials_mtx_;
 	QWidget *serial_config_;
 	QComboBox serial_devices_;
@@ -19,7 +19,6 @@
 
 #include <cmath>
 #include <memory>
-#include <vector>
 
 #include <QChar>
 #include <QComboBox>
@@ -36,11 +35,12 @@
 #include "generatewaveformdialog.hpp"
 #include "src/data/properties/doubleproperty.hpp"
 #include "src/data/datautil.hpp"
+#include "src/devices/waveformsequence.hpp"
 
+using std::make_shared;
 using std::shared_ptr;
-using std::vector;
 
-Q_DECLARE_METATYPE(sv::ui::dialogs::WaveformType)
+Q_DECLARE_METATYPE(sv::devices::WaveformType)
 
 namespace sv {
 namespace ui {
@@ -90,15 +90,15 @@ void GenerateWaveformDialog::setup_ui()
 
 	waveform_box_ = new QComboBox();
 	waveform_box_->addItem(tr("Sine"),
-		QVariant::fromValue(WaveformType::Sine));
+		QVariant::fromValue(devices::WaveformType::Sine));
 	waveform_box_->addItem(tr("Square"),
-		QVariant::fromValue(WaveformType::Square));
+		QVariant::fromValue(devices::WaveformType::Square));
 	waveform_box_->addItem(tr("Triangle"),
-		QVariant::fromValue(WaveformType::Triangle));
+		QVariant::fromValue(devices::WaveformType::Triangle));
 	waveform_box_->addItem(tr("Sawtooth"),
-		QVariant::fromValue(WaveformType::Sawtooth));
+		QVariant::fromValue(devices::WaveformType::Sawtooth));
 	waveform_box_->addItem(tr("Sawtooth inverted"),
-		QVariant::fromValue(WaveformType::SawtoothInv));
+		QVariant::fromValue(devices::WaveformType::SawtoothInv));
 	connect(waveform_box_, SIGNAL(currentIndexChanged(int)),
 			this, SLOT(on_waveform_changed()));
 	layout->addRow(tr("Waveform"), waveform_box_);
@@ -199,7 +199,7 @@ void GenerateWaveformDialog::setup_ui()
 
 	sample_count_box_ = new QSpinBox();
 	sample_count_box_->setMinimum(0);
-	sample_count_box_->setMaximum(1000000);
+	sample_count_box_->setMaximum(100000000);
 	connect(sample_count_box_, SIGNAL(valueChanged(int)),
 		this, SLOT(on_sample_cnt_changed()));
 	samplesc_layout->addRow(tr("Number of samples"), sample_count_box_);
@@ -251,14 +251,10 @@ void GenerateWaveformDialog::setup_ui()
 	this->setLayout(layout);
 }
 
-vector<double> GenerateWaveformDialog::sequence_values() const
+shared_ptr<devices::WaveformSequence>
+	GenerateWaveformDialog::waveform_sequence() const
 {
-	return sequence_values_;
-}
-
-vector<double> GenerateWaveformDialog::sequence_delays() const
-{
-	return sequence_delays_;
+	return waveform_sequence_;
 }
 
 void GenerateWaveformDialog::accept()
@@ -279,43 +275,22 @@ void GenerateWaveformDialog::accept()
 		frequency = 1 / periode;
 	}
 	double phi = phi_rad_box_->value();
-	double omega = 2 * pi * frequency;
-
-	WaveformType w_type = waveform_box_->currentData().value<WaveformType>();
-	// NOTE: We must not rely on floating point types for loop termination.
-	//       Resolves clang-analyzer-security.FloatLoopCounter warnings.
-	double t = .0;
-	size_t const count = std::floor(periode / interval);
-	for (size_t i = 0; i < count; ++i) {
-		double x = omega * t + phi;
-		t += interval;
-		double value;
-		if (w_type == WaveformType::Sine)
-			value = std::sin(x);
-		else if (w_type == WaveformType::Square)
-			value = std::sin(x) < 0 ? -1 : 1;
-		else if (w_type == WaveformType::Triangle)
-			value = (std::asin(std::sin(x))) / (pi/2);
-		else if (w_type == WaveformType::Sawtooth)
-			// y = −arctan(cotan(x))
-			value = -1 * std::atan(1 / std::tan(x)) / (pi/2);
-		else if (w_type == WaveformType::SawtoothInv)
-			value = std::atan(1 / std::tan(x)) / (pi/2);
-		else
-			value = 0;
-
-		value = (amplitude * value) + offset;
-		sequence_values_.push_back(value);
-		sequence_delays_.push_back(interval);
-	}
+
+	devices::WaveformType w_type =
+		waveform_box_->currentData().value<devices::WaveformType>();
+	size_t const count = interval > 0 ? std::floor(periode / interval) : 0;
+	waveform_sequence_ = make_shared<devices::WaveformSequence>(
+		w_type, amplitude, offset, frequency, phi, interval, count);
 
 	QDialog::accept();
 }
 
 void GenerateWaveformDialog::on_waveform_changed()
 {
-	WaveformType w_type = waveform_box_->currentData().value<WaveformType>();
-	if (w_type == WaveformType::Sine || w_type == WaveformType::Triangle)
+	devices::WaveformType w_type =
+		waveform_box_->currentData().value<devices::WaveformType>();
+	if (w_type == devices::WaveformType::Sine ||
+			w_type == devices::WaveformType::Triangle)
 		phi_deg_box_->setValue(270);
 	else
 		phi_deg_box_->setValue(0);
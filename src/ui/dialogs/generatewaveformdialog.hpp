@@ -22,7 +22,6 @@
 
 #include <cmath>
 #include <memory>
-#include <vector>
 
 #include <QComboBox>
 #include <QDialog>
@@ -30,8 +29,9 @@
 #include <QDoubleSpinBox>
 #include <QSpinBox>
 
+#include "src/devices/waveformsequence.hpp"
+
 using std::shared_ptr;
-using std::vector;
 
 namespace sv {
 
@@ -44,14 +44,6 @@ class DoubleProperty;
 namespace ui {
 namespace dialogs {
 
-enum class WaveformType {
-	Sine,
-	Square,
-	Triangle,
-	Sawtooth,
-	SawtoothInv,
-};
-
 class GenerateWaveformDialog : public QDialog
 {
 	Q_OBJECT
@@ -63,8 +55,11 @@ public:
 		shared_ptr<sv::data::properties::DoubleProperty> property,
 		QWidget *parent = nullptr);
 
-	vector<double> sequence_values() const;
-	vector<double> sequence_delays() const;
+	/**
+	 * Return the generated sequence of one periode of the waveform. The
+	 * values are not materialized, but calculated on demand.
+	 */
+	shared_ptr<sv::devices::WaveformSequence> waveform_sequence() const;
 
 private:
 	void setup_ui();
@@ -76,8 +71,7 @@ private:
 	double step_;
 	int decimals_;
 	QString unit_;
-	vector<double> sequence_values_;
-	vector<double> sequence_delays_;
+	shared_ptr<sv::devices::WaveformSequence> waveform_sequence_;
 	QComboBox *waveform_box_;
 	QDoubleSpinBox *min_value_box_;
 	QDoubleSpinBox *max_value_box_;
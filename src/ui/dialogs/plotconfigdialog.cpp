@@ -22,6 +22,7 @@
 #include <set>
 
 #include <QApplication>
+#include <QCheckBox>
 #include <QColor>
 #include <QColorDialog>
 #include <QComboBox>
@@ -145,7 +146,7 @@ void PlotConfigDialog::setup_ui()
 		this->setup_ui_plot_mode_tab();
 	}
 	this->setup_ui_markers_tab();
-	//this->setup_ui_style_tab();
+	this->setup_ui_style_tab();
 	this->setup_ui_curve_colors_tab();
 	tab_widget_->setCurrentIndex(0);
 	main_layout->addWidget(tab_widget_);
@@ -191,6 +192,18 @@ void PlotConfigDialog::setup_ui_plot_mode_tab()
 	add_time_edit_->setText(QString("%1").arg(plot_->add_time(), 0, 'f'));
 	layout->addRow(tr("Add time"), add_time_edit_);
 
+	time_axis_synced_checkbox_ = new QCheckBox();
+	time_axis_synced_checkbox_->setChecked(plot_->time_axis_synced());
+	time_axis_synced_checkbox_->setToolTip(
+		tr("Share the time axis and the plot mode with all synced plots"));
+	layout->addRow(tr("Synchronize time axis"), time_axis_synced_checkbox_);
+
+	scroll_mode_checkbox_ = new QCheckBox();
+	scroll_mode_checkbox_->setChecked(plot_->scroll_mode());
+	scroll_mode_checkbox_->setToolTip(
+		tr("Scroll the canvas in rolling mode instead of redrawing it"));
+	layout->addRow(tr("Scroll canvas"), scroll_mode_checkbox_);
+
 	switch (plot_->update_mode()) {
 	case widgets::plot::PlotUpdateMode::Additive:
 		setup_ui_additive();
@@ -256,6 +269,21 @@ void PlotConfigDialog::setup_ui_style_tab()
 
 	// TODO: Plot background color? Axis position? What else?
 
+	opengl_canvas_checkbox_ = new QCheckBox();
+	opengl_canvas_checkbox_->setChecked(plot_->opengl_canvas());
+	if (!widgets::plot::Plot::has_opengl_canvas()) {
+		opengl_canvas_checkbox_->setDisabled(true);
+		opengl_canvas_checkbox_->setToolTip(
+			tr("Qwt was built without OpenGL support"));
+	}
+	layout->addRow(tr("Render with OpenGL"), opengl_canvas_checkbox_);
+
+	profiler_overlay_checkbox_ = new QCheckBox();
+	profiler_overlay_checkbox_->setChecked(plot_->profiler_overlay());
+	profiler_overlay_checkbox_->setToolTip(
+		tr("Show the frame times and drawn points of the plot"));
+	layout->addRow(tr("Show frame profiler"), profiler_overlay_checkbox_);
+
 	widget->setLayout(layout);
 	tab_widget_->addTab(widget, title);
 }
@@ -363,6 +391,9 @@ void PlotConfigDialog::on_update_mode_changed()
 void PlotConfigDialog::accept()
 {
 	if (plot_type_ == views::PlotType::TimePlot) {
+		// Sync first, so the new settings are applied to all synced plots
+		plot_->set_time_axis_synced(time_axis_synced_checkbox_->isChecked());
+		plot_->set_scroll_mode(scroll_mode_checkbox_->isChecked());
 		QVariant update_mode_var = plot_update_mode_combobox_->currentData();
 		sv::ui::widgets::plot::PlotUpdateMode update_mode =
 			update_mode_var.value<sv::ui::widgets::plot::PlotUpdateMode>();
@@ -378,6 +409,9 @@ void PlotConfigDialog::accept()
 	plot_->set_markers_label_alignment(
 		markers_box_pos_combobox_->currentData().toInt());
 
+	plot_->set_opengl_canvas(opengl_canvas_checkbox_->isChecked());
+	plot_->set_profiler_overlay(profiler_overlay_checkbox_->isChecked());
+
 	QSettings settings;
 	settings.beginGroup("DefaultCurveColors");
 	for (int i=0; i<color_table_->rowCount(); i++) {
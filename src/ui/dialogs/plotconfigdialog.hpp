@@ -23,6 +23,7 @@
 #include <map>
 
 #include <QAbstractItemModel>
+#include <QCheckBox>
 #include <QComboBox>
 #include <QDialog>
 #include <QDialogButtonBox>
@@ -87,7 +88,11 @@ private:
 	QComboBox *plot_update_mode_combobox_;
 	QLineEdit *time_span_edit_;
 	QLineEdit *add_time_edit_;
+	QCheckBox *time_axis_synced_checkbox_;
+	QCheckBox *scroll_mode_checkbox_;
 	QComboBox *markers_box_pos_combobox_;
+	QCheckBox *opengl_canvas_checkbox_;
+	QCheckBox *profiler_overlay_checkbox_;
 	QTableWidget *color_table_;
 	QDialogButtonBox *button_box_;
 
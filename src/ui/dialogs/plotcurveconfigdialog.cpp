@@ -17,25 +17,30 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <cassert>
 
 #include <QCheckBox>
 #include <QComboBox>
 #include <QBrush>
 #include <QDebug>
+#include <QDoubleSpinBox>
 #include <QFormLayout>
 #include <QIcon>
 #include <QLineEdit>
 #include <QPen>
 #include <QPushButton>
 #include <QSize>
+#include <QSpinBox>
 #include <QWidget>
 #include <qwt_plot_curve.h>
 #include <qwt_symbol.h>
 
 #include "plotcurveconfigdialog.hpp"
 #include "src/ui/widgets/plot/curve.hpp"
+#include "src/ui/widgets/plot/densitycurve.hpp"
 #include "src/ui/widgets/plot/plot.hpp"
+#include "src/ui/widgets/plot/xycurvedata.hpp"
 #include "src/ui/widgets/colorbutton.hpp"
 
 Q_DECLARE_METATYPE(Qt::PenStyle)
@@ -107,6 +112,61 @@ void PlotCurveConfigDialog::setup_ui()
 	}
 	main_layout->addRow(tr("Symbol type"), symbol_type_box_);
 
+	// Only XY curves can be drawn as density map
+	density_mode_checkbox_ = new QCheckBox();
+	density_mode_checkbox_->setChecked(curve_->density_mode());
+	density_mode_checkbox_->setToolTip(
+		tr("Draw the curve as a density map instead of lines"));
+	if (!dynamic_cast<widgets::plot::XYCurveData *>(curve_->curve_data()))
+		density_mode_checkbox_->setDisabled(true);
+	main_layout->addRow(tr("Density map"), density_mode_checkbox_);
+
+	// Only XY curves have a history window
+	widgets::plot::XYCurveData *xy_curve_data =
+		dynamic_cast<widgets::plot::XYCurveData *>(curve_->curve_data());
+	history_points_spinbox_ = new QSpinBox();
+	history_points_spinbox_->setRange(0, 100000000);
+	history_points_spinbox_->setSingleStep(1000);
+	history_points_spinbox_->setSpecialValueText(tr("Unlimited"));
+	history_points_spinbox_->setSuffix(tr(" points"));
+	history_points_spinbox_->setToolTip(
+		tr("Only show the last points of the curve"));
+	history_time_spinbox_ = new QDoubleSpinBox();
+	history_time_spinbox_->setRange(0., 1000000.);
+	history_time_spinbox_->setDecimals(1);
+	history_time_spinbox_->setSpecialValueText(tr("Unlimited"));
+	history_time_spinbox_->setSuffix(tr(" s"));
+	history_time_spinbox_->setToolTip(
+		tr("Only show the points of the last seconds"));
+	if (xy_curve_data) {
+		history_points_spinbox_->setValue(
+			(int)std::min(xy_curve_data->history_points(), (size_t)100000000));
+		history_time_spinbox_->setValue(xy_curve_data->history_time());
+	}
+	else {
+		history_points_spinbox_->setDisabled(true);
+		history_time_spinbox_->setDisabled(true);
+	}
+	main_layout->addRow(tr("History"), history_points_spinbox_);
+	main_layout->addRow(tr("History time"), history_time_spinbox_);
+
+	fading_checkbox_ = new QCheckBox();
+	fading_checkbox_->setChecked(curve_->fading());
+	fading_checkbox_->setToolTip(
+		tr("Draw the older points of the curve paler"));
+	main_layout->addRow(tr("Fade older points"), fading_checkbox_);
+
+	priority_box_ = new QComboBox();
+	priority_box_->addItem(tr("Low"), (int)widgets::plot::CurvePriority::Low);
+	priority_box_->addItem(
+		tr("Normal"), (int)widgets::plot::CurvePriority::Normal);
+	priority_box_->addItem(tr("High"), (int)widgets::plot::CurvePriority::High);
+	priority_box_->setCurrentIndex(
+		priority_box_->findData((int)curve_->priority()));
+	priority_box_->setToolTip(
+		tr("Low priority curves are drawn less often on a busy plot"));
+	main_layout->addRow(tr("Priority"), priority_box_);
+
 	button_box_ = new QDialogButtonBox(
 		QDialogButtonBox::Ok | QDialogButtonBox::Cancel, Qt::Horizontal);
 	QPushButton *remove_button = new QPushButton(
@@ -131,6 +191,21 @@ void PlotCurveConfigDialog::accept()
 	curve_->set_color(color_button_->color());
 	curve_->set_style(line_type_box_->currentData().value<Qt::PenStyle>());
 	curve_->set_symbol(symbol_type_box_->currentData().value<QwtSymbol::Style>());
+	curve_->set_density_mode(density_mode_checkbox_->isChecked());
+	widgets::plot::XYCurveData *xy_curve_data =
+		dynamic_cast<widgets::plot::XYCurveData *>(curve_->curve_data());
+	if (xy_curve_data) {
+		xy_curve_data->set_history_points(
+			(size_t)history_points_spinbox_->value());
+		xy_curve_data->set_history_time(history_time_spinbox_->value());
+		curve_->invalidate_bounds();
+	}
+	curve_->set_fading(fading_checkbox_->isChecked());
+	curve_->set_priority(
+		(widgets::plot::CurvePriority)priority_box_->currentData().toInt());
+	if (curve_->density_curve())
+		curve_->density_curve()->setVisible(visible_checkbox_->isChecked());
+	plot_->replot();
 
 	QDialog::accept();
 }
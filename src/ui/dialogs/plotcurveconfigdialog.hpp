@@ -24,7 +24,9 @@
 #include <QComboBox>
 #include <QDialog>
 #include <QDialogButtonBox>
+#include <QDoubleSpinBox>
 #include <QLineEdit>
+#include <QSpinBox>
 #include <QWidget>
 
 namespace sv {
@@ -58,6 +60,11 @@ private:
 	widgets::ColorButton *color_button_;
 	QComboBox *line_type_box_;
 	QComboBox *symbol_type_box_;
+	QCheckBox *density_mode_checkbox_;
+	QSpinBox *history_points_spinbox_;
+	QDoubleSpinBox *history_time_spinbox_;
+	QCheckBox *fading_checkbox_;
+	QComboBox *priority_box_;
 	QDialogButtonBox *button_box_;
 
 public Q_SLOTS:
@@ -0,0 +1,103 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QCheckBox>
+#include <QDialog>
+#include <QFormLayout>
+#include <QIcon>
+#include <QSizeF>
+#include <QSpinBox>
+#include <QVBoxLayout>
+#include <QWidget>
+
+#include "plotexportdialog.hpp"
+
+namespace sv {
+namespace ui {
+namespace dialogs {
+
+PlotExportDialog::PlotExportDialog(QWidget *parent) :
+	QDialog(parent)
+{
+	setup_ui();
+}
+
+void PlotExportDialog::setup_ui()
+{
+	QIcon main_icon;
+	main_icon.addFile(QStringLiteral(":/icons/smuview.ico"),
+		QSize(), QIcon::Normal, QIcon::Off);
+	this->setWindowIcon(main_icon);
+	this->setWindowTitle(tr("Export Plot"));
+	this->setMinimumWidth(250);
+
+	QVBoxLayout *main_layout = new QVBoxLayout();
+	QFormLayout *form_layout = new QFormLayout();
+
+	width_spinbox_ = new QSpinBox();
+	width_spinbox_->setRange(10, 2000);
+	width_spinbox_->setSuffix(" mm");
+	width_spinbox_->setValue(160);
+	form_layout->addRow(tr("Width"), width_spinbox_);
+
+	height_spinbox_ = new QSpinBox();
+	height_spinbox_->setRange(10, 2000);
+	height_spinbox_->setSuffix(" mm");
+	height_spinbox_->setValue(100);
+	form_layout->addRow(tr("Height"), height_spinbox_);
+
+	resolution_spinbox_ = new QSpinBox();
+	resolution_spinbox_->setRange(30, 2400);
+	resolution_spinbox_->setSuffix(" dpi");
+	resolution_spinbox_->setValue(300);
+	form_layout->addRow(tr("Resolution"), resolution_spinbox_);
+
+	full_range_checkbox_ = new QCheckBox();
+	full_range_checkbox_->setChecked(false);
+	form_layout->addRow(tr("All samples"), full_range_checkbox_);
+
+	main_layout->addLayout(form_layout);
+
+	button_box_ = new QDialogButtonBox(
+		QDialogButtonBox::Ok | QDialogButtonBox::Cancel, Qt::Horizontal);
+	main_layout->addWidget(button_box_);
+	connect(button_box_, SIGNAL(accepted()), this, SLOT(accept()));
+	connect(button_box_, SIGNAL(rejected()), this, SLOT(reject()));
+
+	this->setLayout(main_layout);
+}
+
+QSizeF PlotExportDialog::document_size() const
+{
+	return QSizeF(width_spinbox_->value(), height_spinbox_->value());
+}
+
+int PlotExportDialog::resolution() const
+{
+	return resolution_spinbox_->value();
+}
+
+bool PlotExportDialog::full_range() const
+{
+	return full_range_checkbox_->isChecked();
+}
+
+} // namespace dialogs
+} // namespace ui
+} // namespace sv
@@ -0,0 +1,63 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_DIALOGS_PLOTEXPORTDIALOG_HPP
+#define UI_DIALOGS_PLOTEXPORTDIALOG_HPP
+
+#include <QCheckBox>
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QSizeF>
+#include <QSpinBox>
+#include <QWidget>
+
+namespace sv {
+namespace ui {
+namespace dialogs {
+
+class PlotExportDialog : public QDialog
+{
+	Q_OBJECT
+
+public:
+	explicit PlotExportDialog(QWidget *parent = nullptr);
+
+	/** Return the size of the document in millimeters. */
+	QSizeF document_size() const;
+	/** Return the resolution in dots per inch. */
+	int resolution() const;
+	/** Return true if all samples should be exported. */
+	bool full_range() const;
+
+private:
+	void setup_ui();
+
+	QSpinBox *width_spinbox_;
+	QSpinBox *height_spinbox_;
+	QSpinBox *resolution_spinbox_;
+	QCheckBox *full_range_checkbox_;
+	QDialogButtonBox *button_box_;
+
+};
+
+} // namespace dialogs
+} // namespace ui
+} // namespace sv
+
+#endif // UI_DIALOGS_PLOTEXPORTDIALOG_HPP
@@ -66,6 +66,7 @@ void SelectSignalDialog::setup_ui()
 	device_tree_ = new devices::devicetree::DeviceTreeView(session_,
 		false, false, false, true, false, false, false, false);
 	device_tree_->expand_device(expanded_device_);
+	main_layout->addWidget(device_tree_->create_filter_edit());
 	main_layout->addWidget(device_tree_);
 
 	button_box_ = new QDialogButtonBox(
@@ -18,14 +18,12 @@
  */
 
 #include <cmath>
-#include <iostream>
-#include <fstream>
 #include <limits>
 #include <memory>
-#include <string>
 
 #include <QDebug>
 #include <QDir>
+#include <QDoubleSpinBox>
 #include <QFileDialog>
 #include <QFormLayout>
 #include <QHBoxLayout>
@@ -38,17 +36,20 @@
 
 #include "signalsavedialog.hpp"
 #include "src/settingsmanager.hpp"
-#include "src/util.hpp"
+#include "src/tracer.hpp"
 #include "src/channels/basechannel.hpp"
 #include "src/data/analogtimesignal.hpp"
+#include "src/data/analogtimesnapshot.hpp"
+#include "src/data/arrowexporter.hpp"
 #include "src/data/basesignal.hpp"
+#include "src/data/capturefile.hpp"
+#include "src/data/csvexporter.hpp"
+#include "src/data/csvmultifileexporter.hpp"
 #include "src/devices/basedevice.hpp"
 #include "src/devices/hardwaredevice.hpp"
 #include "src/ui/devices/devicetree/devicetreeview.hpp"
 
 using std::dynamic_pointer_cast;
-using std::ofstream;
-using std::string;
 
 Q_DECLARE_SMART_POINTER_METATYPE(std::shared_ptr)
 
@@ -95,6 +96,9 @@ void SignalSaveDialog::setup_ui()
 
 	QFormLayout *form_layout = new QFormLayout();
 
+	separate_files_ = new QCheckBox(tr("One CSV file per signal"));
+	form_layout->addRow("", separate_files_);
+
 	timestamps_combined_ = new QCheckBox(tr("Combine all timestamps"));
 	form_layout->addRow("", timestamps_combined_);
 
@@ -108,6 +112,17 @@ void SignalSaveDialog::setup_ui()
 	form_layout->addRow(tr("Combination time frame"),
 		timestamps_combined_timeframe_);
 
+	aggregate_ = new QCheckBox(tr("Export mean/min/max per interval"));
+	form_layout->addRow("", aggregate_);
+
+	aggregate_interval_ = new QDoubleSpinBox();
+	aggregate_interval_->setDecimals(3);
+	aggregate_interval_->setRange(0.001, 86400.);
+	aggregate_interval_->setValue(1.);
+	aggregate_interval_->setSuffix(" s");
+	aggregate_interval_->setDisabled(!aggregate_->isChecked());
+	form_layout->addRow(tr("Interval"), aggregate_interval_);
+
 	time_absolut_ = new QCheckBox(tr("Absolut time"));
 	form_layout->addRow("", time_absolut_);
 
@@ -115,258 +130,155 @@ void SignalSaveDialog::setup_ui()
 	separator_edit_->setText(",");
 	form_layout->addRow(tr("CSV separator"), separator_edit_);
 
+	capture_compressed_ = new QCheckBox(tr("Compress capture files"));
+	capture_compressed_->setChecked(true);
+	form_layout->addRow("", capture_compressed_);
+
 	main_layout->addLayout(form_layout);
 
 	button_box_ = new QDialogButtonBox(
 		QDialogButtonBox::Ok | QDialogButtonBox::Cancel, Qt::Horizontal);
 	main_layout->addWidget(button_box_);
 
+	connect(separate_files_, SIGNAL(stateChanged(int)),
+		this, SLOT(toggle_combined()));
 	connect(timestamps_combined_, SIGNAL(stateChanged(int)),
 		this, SLOT(toggle_combined()));
+	connect(aggregate_, SIGNAL(stateChanged(int)),
+		this, SLOT(toggle_aggregate()));
 	connect(button_box_, SIGNAL(accepted()), this, SLOT(accept()));
 	connect(button_box_, SIGNAL(rejected()), this, SLOT(reject()));
 
 	this->setLayout(main_layout);
 }
 
-void SignalSaveDialog::save(const QString &file_name)
+template<typename Exporter>
+bool SignalSaveDialog::run_export(Exporter &exporter, const QString &file_name)
 {
-	ofstream output_file;
-	string str_file_name = file_name.toStdString();
-	vector<size_t> sample_counts;
-
-	output_file.open(str_file_name);
-
-	auto signals = device_tree_->checked_signals();
-	bool relative_time = !time_absolut_->isChecked();
-	string sep = separator_edit_->text().toStdString();
-	size_t max_sample_count = 0;
-
-	// Header
-	string start_sep;
-	string device_header_line;
-	string chg_name_header_line;
-	string ch_name_header_line;
-	string signal_name_header_line;
-	for (const auto &signal : signals) {
-		// Only handle AnalogSignals
-		auto analog_signal =
-			dynamic_pointer_cast<sv::data::AnalogTimeSignal>(signal);
-		if (!analog_signal)
-			continue;
-
-		size_t sample_count = analog_signal->sample_count();
-		if (sample_count > max_sample_count)
-			max_sample_count = sample_count;
-		sample_counts.push_back(sample_count);
-
-		string name = analog_signal->name();
-		shared_ptr<sv::channels::BaseChannel> parent_channel =
-			analog_signal->parent_channel();
-
-		qWarning() << "SaveDialog::save(): signal.name() = " <<
-			QString::fromStdString(name);
-		qWarning() << "SaveDialog::save(): signal.parent_channel().name() = " <<
-			QString::fromStdString(parent_channel->name());
-		qWarning() << "SaveDialog::save(): signal.parent_channel().parent_device().name() = " <<
-			QString::fromStdString(parent_channel->parent_device()->name());
-
-		string chg_names;
-		string chg_sep;
-		for (const auto &chg_name : parent_channel->channel_group_names()) {
-			chg_names += chg_sep;
-			if (chg_name.empty())
-				chg_names += "\"\"";
-			else
-				chg_names += chg_name;
-			// TODO: Ugly workaround. Implement escaping or quotation characters?
-			chg_sep = sep == "," ? "; " : ", ";
-		}
-
-		device_header_line += start_sep;
-		device_header_line += parent_channel->parent_device()->name(); // Time
-		device_header_line += sep;
-		device_header_line += parent_channel->parent_device()->name(); // Value
-		chg_name_header_line += start_sep;
-		chg_name_header_line += chg_names; // Time
-		chg_name_header_line += sep;
-		chg_name_header_line += chg_names; // Value
-		ch_name_header_line += start_sep;
-		ch_name_header_line += parent_channel->name(); // Time
-		ch_name_header_line += sep;
-		ch_name_header_line += parent_channel->name(); // Value
-		signal_name_header_line += start_sep;
-		signal_name_header_line += "Time ";
-		signal_name_header_line += name; // Time
-		signal_name_header_line += sep;
-		signal_name_header_line += name; // Value
-
-		start_sep = sep;
+	QProgressDialog progress(tr("Saving signals ..."),
+		tr("Abort saving"), 0, 100, this);
+	progress.setWindowModality(Qt::WindowModal);
+	progress.setAutoReset(false);
+	connect(&exporter, &Exporter::progress_changed,
+		&progress, &QProgressDialog::setValue);
+	bool success = false;
+	connect(&exporter, &Exporter::finished,
+		&progress, [&progress, &success](bool export_success) {
+			success = export_success;
+			progress.accept();
+		});
+
+	if (!exporter.start(file_name)) {
+		QMessageBox::critical(this, tr("Save Signals"),
+			tr("The file %1 could not be opened.").arg(file_name),
+			QMessageBox::Ok);
+		return false;
 	}
-	output_file << device_header_line << std::endl;
-	output_file << chg_name_header_line << std::endl;
-	output_file << ch_name_header_line << std::endl;
-	output_file << signal_name_header_line << std::endl;
-
-	// Data
-	// TODO: we asume here, that the vector size is the same for all vectors....
-	for (size_t i = 0; i < max_sample_count; i++) {
-		start_sep = "";
-		QString line("");
-		int j = 0;
-		for (const auto &signal : signals) {
-			// Only handle AnalogSignals
-			auto analog_signal =
-				dynamic_pointer_cast<sv::data::AnalogTimeSignal>(signal);
-			if (!analog_signal)
-				continue;
-
-			QString time("");
-			QString value("");
-
-			size_t sample_count = sample_counts[j];
-			if (i < sample_count-1) {
-				// More samples for this signal
-				auto sample = analog_signal->get_sample(i, relative_time);
-				value = QString("%1").arg(sample.second);
-				if (relative_time)
-					time = QString("%1").arg(sample.first, 0, 'f', 4);
-				else
-					time = util::format_time_date(sample.first);
-			}
 
-			line.append(QString("%1%2%3%4").arg(
-				QString::fromStdString(start_sep), time,
-				QString::fromStdString(sep), value));
-			start_sep = sep;
-
-			++j;
-		}
-		output_file << line.toStdString() << std::endl;
+	// The export is running in the worker thread, while the progress
+	// dialog keeps the GUI responsive.
+	if (progress.exec() != QDialog::Accepted) {
+		exporter.cancel();
+		return false;
 	}
+	exporter.wait();
 
-	output_file.close();
+	if (!success) {
+		QMessageBox::critical(this, tr("Save Signals"),
+			tr("Writing the file %1 failed.").arg(file_name),
+			QMessageBox::Ok);
+	}
+	return success;
 }
 
-void SignalSaveDialog::save_combined(const QString &file_name)
+bool SignalSaveDialog::save(const QString &file_name, bool arrow)
 {
-	ofstream output_file;
-	string str_file_name = file_name.toStdString();
-	vector<size_t> sample_counts;
-	vector<size_t> sample_pos;
+	SV_TRACE_SCOPE("SignalSaveDialog::save");
 
-	output_file.open(str_file_name);
-
-	double combined_timeframe = .0;
-	int combined_timeframe_ms = timestamps_combined_timeframe_->value();
-	if (combined_timeframe_ms != 0)
-		combined_timeframe = ((double)combined_timeframe_ms) / 1000;
-
-	auto signals = device_tree_->checked_signals();
-	bool relative_time = !time_absolut_->isChecked();
-	string sep = separator_edit_->text().toStdString();
-
-	// Header
-	string device_header_line("Time"); // Time
-	string chg_name_header_line("Time"); // Time
-	string ch_name_header_line("Time"); // Time
-	string signal_name_header_line("Time"); // Time
-	for (const auto &signal : signals) {
+	// The snapshots keep the samples consistent during the export
+	vector<sv::data::AnalogTimeSnapshot> snapshots;
+	for (const auto &signal : device_tree_->checked_signals()) {
 		// Only handle AnalogSignals
 		auto analog_signal =
 			dynamic_pointer_cast<sv::data::AnalogTimeSignal>(signal);
 		if (!analog_signal)
 			continue;
+		snapshots.push_back(analog_signal->snapshot());
+	}
 
-		shared_ptr<sv::channels::BaseChannel> parent_channel =
-			analog_signal->parent_channel();
-
-		sample_counts.push_back(analog_signal->sample_count());
-		sample_pos.push_back(0);
-
-		string chg_names;
-		string chg_sep;
-		for (const auto &chg_name : parent_channel->channel_group_names()) {
-			chg_names += chg_sep;
-			if (chg_name.empty())
-				chg_names += "\"\"";
-			else
-				chg_names += chg_name;
-			// TODO: Ugly workaround. Implement escaping or quotation characters?
-			chg_sep = sep == "," ? "; " : ", ";
+	const bool relative_time = !time_absolut_->isChecked();
+	const bool separate_files = separate_files_->isChecked();
+	const bool combined =
+		!separate_files && timestamps_combined_->isChecked();
+	const double combined_timeframe =
+		((double)timestamps_combined_timeframe_->value()) / 1000;
+
+	if (arrow) {
+		if (aggregate_->isChecked()) {
+			QMessageBox::critical(this, tr("Save Signals"),
+				tr("The mean/min/max per interval can only be saved to CSV "
+					"files."),
+				QMessageBox::Ok);
+			return false;
 		}
+		if (separate_files) {
+			QMessageBox::critical(this, tr("Save Signals"),
+				tr("One file per signal can only be saved as CSV files."),
+				QMessageBox::Ok);
+			return false;
+		}
+		sv::data::ArrowExportOptions options;
+		options.relative_time = relative_time;
+		options.combined = combined;
+		options.combined_timeframe = combined_timeframe;
+		sv::data::ArrowExporter exporter(snapshots, options);
+		return run_export(exporter, file_name);
+	}
 
-		device_header_line += sep;
-		device_header_line += parent_channel->parent_device()->name(); // Value
-		chg_name_header_line += sep;
-		chg_name_header_line += chg_names; // Value
-		ch_name_header_line += sep;
-		ch_name_header_line += parent_channel->name(); // Value
-		signal_name_header_line += sep;
-		signal_name_header_line += analog_signal->name(); // Value
+	sv::data::CsvExportOptions options;
+	options.separator = separator_edit_->text().toStdString();
+	options.relative_time = relative_time;
+	options.combined = combined;
+	options.combined_timeframe = combined_timeframe;
+	// The aggregates are read from the min/max pyramids of the signals
+	options.aggregate_interval =
+		aggregate_->isChecked() ? aggregate_interval_->value() : 0.;
+	if (separate_files) {
+		// Every file is written in its own worker thread
+		sv::data::CsvMultiFileExporter exporter(snapshots, options);
+		return run_export(exporter, file_name);
 	}
-	output_file << device_header_line << std::endl;
-	output_file << chg_name_header_line << std::endl;
-	output_file << ch_name_header_line << std::endl;
-	output_file << signal_name_header_line << std::endl;
-
-	// Data
-	while (true) {
-		double next_timestamp = -1;
-		int i = 0;
-		for (const auto &signal : signals) {
-			// Only handle AnalogSignals
-			auto analog_signal =
-				dynamic_pointer_cast<sv::data::AnalogTimeSignal>(signal);
-			if (!analog_signal)
-				continue;
-
-			if (sample_pos[i] >= sample_counts[i]-1)
-				continue;
-
-			double timestamp =
-				analog_signal->get_sample(sample_pos[i], relative_time).first;
-			if (next_timestamp < 0 || timestamp < next_timestamp)
-				next_timestamp = timestamp;
-
-			++i;
-		}
+	sv::data::CsvExporter exporter(snapshots, options);
+	return run_export(exporter, file_name);
+}
 
-		if (next_timestamp < 0)
-			break;
-
-		// Timestamp
-		QString line;
-		if (relative_time)
-			line = QString("%1").arg(next_timestamp, 0, 'f', 4);
-		else
-			line = util::format_time_date(next_timestamp);
-
-		// Values
-		i = 0;
-		for (const auto &signal : signals) {
-			// Only handle AnalogSignals
-			auto analog_signal =
-				dynamic_pointer_cast<sv::data::AnalogTimeSignal>(signal);
-			if (!analog_signal)
-				continue;
-
-			line.append(QString::fromStdString(sep));
-
-			auto sample =
-				analog_signal->get_sample(sample_pos[i], relative_time);
-			double timestamp = sample.first;
-			if (timestamp + combined_timeframe >= next_timestamp) {
-				line.append(QString("%1").arg(sample.second, 0, 'g', -1));
-				++sample_pos[i];
-			}
+bool SignalSaveDialog::save_capture(const QString &file_name)
+{
+	SV_TRACE_SCOPE("SignalSaveDialog::save_capture");
 
-			++i;
-		}
-		output_file << line.toStdString() << std::endl;
+	sv::data::CaptureWriter writer;
+	if (!writer.open(file_name.toStdString(),
+			capture_compressed_->isChecked())) {
+		QMessageBox::critical(this, tr("Save Signals"),
+			tr("The file %1 could not be opened.").arg(file_name),
+			QMessageBox::Ok);
+		return false;
 	}
 
-	output_file.close();
+	for (const auto &signal : device_tree_->checked_signals()) {
+		// Only handle AnalogSignals
+		auto analog_signal =
+			dynamic_pointer_cast<sv::data::AnalogTimeSignal>(signal);
+		if (analog_signal)
+			writer.add_signal(analog_signal);
+	}
+	if (!writer.write_new_samples()) {
+		QMessageBox::critical(this, tr("Save Signals"),
+			tr("Writing the file %1 failed.").arg(file_name),
+			QMessageBox::Ok);
+		return false;
+	}
+	return true;
 }
 
 bool SignalSaveDialog::validate_combined_timeframe()
@@ -384,6 +296,7 @@ bool SignalSaveDialog::validate_combined_timeframe()
 	progress.setWindowModality(Qt::WindowModal);
 
 	double min_delta = combined_timeframe;
+	vector<double> timestamps(4096);
 	for (const auto &signal : device_tree_->checked_signals()) {
 		progress.setValue(act_signal++);
 		size_t count = signal->sample_count();
@@ -396,16 +309,30 @@ bool SignalSaveDialog::validate_combined_timeframe()
 		if (!analog_signal)
 			continue;
 
-		double ts1 = analog_signal->get_sample(0, false).first;
-		for (size_t i = 1; i<count; i++) {
-			const double ts2 = analog_signal->get_sample(i, false).first;
-			const double delta = ts2 - ts1;
-			if (delta < min_delta)
-				min_delta = delta;
-			ts1 = ts2;
+		const auto snapshot = analog_signal->snapshot();
+		if (snapshot.size() < 2)
+			continue;
 
+		// The timestamps are read in blocks, not sample by sample
+		size_t pos = snapshot.first_sample_pos();
+		size_t n = snapshot.copy_samples(
+			pos, timestamps.size(), false, timestamps.data(), nullptr);
+		double ts1 = n > 0 ? timestamps[0] : 0.;
+		size_t i = 1;
+		while (n > 0) {
+			for (; i < n; ++i) {
+				const double delta = timestamps[i] - ts1;
+				if (delta < min_delta)
+					min_delta = delta;
+				ts1 = timestamps[i];
+			}
 			if (progress.wasCanceled())
 				return false;
+
+			pos += n;
+			n = snapshot.copy_samples(
+				pos, timestamps.size(), false, timestamps.data(), nullptr);
+			i = 0;
 		}
 	}
 
@@ -429,11 +356,15 @@ void SignalSaveDialog::save_settings(QSettings &settings) const
 	settings.beginGroup("SignalSaveDialog");
 	settings.remove("");  // Remove all keys in this group
 
+	settings.setValue("separate_files", separate_files_->isChecked());
 	settings.setValue("timestamps_combined", timestamps_combined_->isChecked());
 	settings.setValue("timestamps_combined_timeframe",
 		timestamps_combined_timeframe_->value());
+	settings.setValue("aggregate", aggregate_->isChecked());
+	settings.setValue("aggregate_interval", aggregate_interval_->value());
 	settings.setValue("time_absolut", time_absolut_->isChecked());
 	settings.setValue("csv_separator", separator_edit_->text());
+	settings.setValue("capture_compressed", capture_compressed_->isChecked());
 	settings.setValue("file_dialog_path", file_dialog_path_);
 
 	settings.endGroup();
@@ -443,6 +374,9 @@ void SignalSaveDialog::restore_settings(QSettings &settings)
 {
 	settings.beginGroup("SignalSaveDialog");
 
+	if (settings.contains("separate_files")) {
+		separate_files_->setChecked(settings.value("separate_files").toBool());
+	}
 	if (settings.contains("timestamps_combined")) {
 		timestamps_combined_->setChecked(
 			settings.value("timestamps_combined").toBool());
@@ -451,12 +385,23 @@ void SignalSaveDialog::restore_settings(QSettings &settings)
 		timestamps_combined_timeframe_->setValue(
 			settings.value("timestamps_combined_timeframe").toInt());
 	}
+	if (settings.contains("aggregate")) {
+		aggregate_->setChecked(settings.value("aggregate").toBool());
+	}
+	if (settings.contains("aggregate_interval")) {
+		aggregate_interval_->setValue(
+			settings.value("aggregate_interval").toDouble());
+	}
 	if (settings.contains("time_absolut")) {
 		time_absolut_->setChecked(settings.value("time_absolut").toBool());
 	}
 	if (settings.contains("csv_separator")) {
 		separator_edit_->setText(settings.value("csv_separator").toString());
 	}
+	if (settings.contains("capture_compressed")) {
+		capture_compressed_->setChecked(
+			settings.value("capture_compressed").toBool());
+	}
 	if (settings.contains("file_dialog_path")) {
 		file_dialog_path_ =
 			settings.value("file_dialog_path", QDir::homePath()).toString();
@@ -468,20 +413,33 @@ void SignalSaveDialog::restore_settings(QSettings &settings)
 void SignalSaveDialog::accept()
 {
 	// Get file name
+	const QString capture_filter = tr("SmuView Capture Files (*.svcap)");
+	const QString arrow_filter = tr("Arrow IPC Files (*.arrow *.feather)");
+	QString selected_filter;
 	QString file_name = QFileDialog::getSaveFileName(this,
-		tr("Save CSV-File"), file_dialog_path_, tr("CSV Files (*.csv)"));
+		tr("Save Signals"), file_dialog_path_,
+		tr("CSV Files (*.csv)") + ";;" + arrow_filter + ";;" + capture_filter,
+		&selected_filter);
 	if (file_name.isEmpty())
 		return;
 
 	file_dialog_path_ = QDir().absoluteFilePath(file_name);
 
-	if (timestamps_combined_->isChecked()) {
-		if (!validate_combined_timeframe())
+	if (selected_filter == capture_filter ||
+			file_name.endsWith(".svcap", Qt::CaseInsensitive)) {
+		if (!save_capture(file_name))
 			return;
-		save_combined(file_name);
 	}
 	else {
-		save(file_name);
+		if (timestamps_combined_->isChecked() &&
+				!separate_files_->isChecked() && !aggregate_->isChecked() &&
+				!validate_combined_timeframe())
+			return;
+		const bool arrow = selected_filter == arrow_filter ||
+			file_name.endsWith(".arrow", Qt::CaseInsensitive) ||
+			file_name.endsWith(".feather", Qt::CaseInsensitive);
+		if (!save(file_name, arrow))
+			return;
 	}
 
 	QDialog::accept();
@@ -497,8 +455,16 @@ void SignalSaveDialog::done(int r)
 
 void SignalSaveDialog::toggle_combined()
 {
+	// A file with a single signal has only one time column anyway
+	const bool separate_files = separate_files_->isChecked();
+	timestamps_combined_->setDisabled(separate_files);
 	timestamps_combined_timeframe_->setDisabled(
-		!timestamps_combined_->isChecked());
+		separate_files || !timestamps_combined_->isChecked());
+}
+
+void SignalSaveDialog::toggle_aggregate()
+{
+	aggregate_interval_->setDisabled(!aggregate_->isChecked());
 }
 
 } // namespace dialogs
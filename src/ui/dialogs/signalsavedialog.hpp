@@ -26,6 +26,7 @@
 #include <QCheckBox>
 #include <QDialog>
 #include <QDialogButtonBox>
+#include <QDoubleSpinBox>
 #include <QLineEdit>
 #include <QSettings>
 #include <QSpinBox>
@@ -64,8 +65,25 @@ public:
 
 private:
 	void setup_ui();
-	void save(const QString &file_name);
-	void save_combined(const QString &file_name);
+	/**
+	 * Export the checked signals to a CSV file, to one CSV file per signal
+	 * or to an Arrow IPC file in worker threads, while a progress dialog is
+	 * shown.
+	 *
+	 * @return false if the export failed or was canceled.
+	 */
+	bool save(const QString &file_name, bool arrow);
+	/**
+	 * Run the export of a CsvExporter, CsvMultiFileExporter or
+	 * ArrowExporter, see save().
+	 */
+	template<typename Exporter>
+	bool run_export(Exporter &exporter, const QString &file_name);
+	/**
+	 * Save the checked signals to a binary capture file, that can be opened
+	 * again.
+	 */
+	bool save_capture(const QString &file_name);
 	bool validate_combined_timeframe();
 	void save_settings(QSettings &settings) const;
 	void restore_settings(QSettings &settings);
@@ -74,10 +92,14 @@ private:
 	const shared_ptr<sv::devices::BaseDevice> selected_device_;
 
 	ui::devices::devicetree::DeviceTreeView *device_tree_;
+	QCheckBox *separate_files_;
 	QCheckBox *timestamps_combined_;
 	QSpinBox *timestamps_combined_timeframe_;
+	QCheckBox *aggregate_;
+	QDoubleSpinBox *aggregate_interval_;
 	QCheckBox *time_absolut_;
 	QLineEdit *separator_edit_;
+	QCheckBox *capture_compressed_;
 	QDialogButtonBox *button_box_;
 	QString file_dialog_path_;
 
@@ -88,6 +110,7 @@ public Q_SLOTS:
 
 private Q_SLOTS:
 	void toggle_combined();
+	void toggle_aggregate();
 
 };
 
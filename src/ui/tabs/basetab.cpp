@@ -21,6 +21,7 @@
 
 #include <QDebug>
 #include <QMainWindow>
+#include <QShowEvent>
 #include <QSizePolicy>
 
 #include "basetab.hpp"
@@ -33,6 +34,7 @@ namespace tabs {
 
 BaseTab::BaseTab(Session &session, QWidget *parent) :
 	QMainWindow(parent),
+	views_initialized_(false),
 	session_(session)
 {
 	// Remove Qt::Window flag
@@ -62,9 +64,29 @@ string BaseTab::id() const
 
 views::BaseView *BaseTab::get_view_from_view_id(const string &id)
 {
+	init_views();
 	return view_id_map_[id];
 }
 
+void BaseTab::init_views()
+{
+	if (views_initialized_)
+		return;
+
+	// The views of the tab are added with add_view(), that calls init_views()
+	views_initialized_ = true;
+	setup_views();
+}
+
+bool BaseTab::is_views_initialized() const
+{
+	return views_initialized_;
+}
+
+void BaseTab::setup_views()
+{
+}
+
 TabDockWidget *BaseTab::create_dock_widget(views::BaseView *view,
 	QDockWidget::DockWidgetFeatures features)
 {
@@ -94,12 +116,21 @@ void BaseTab::closeEvent(QCloseEvent *event)
 	event->accept();
 }
 
+void BaseTab::showEvent(QShowEvent *event)
+{
+	init_views();
+	QMainWindow::showEvent(event);
+}
+
 void BaseTab::add_view(views::BaseView *view, Qt::DockWidgetArea area,
 	int features)
 {
 	if (!view)
 		return;
 
+	// The default views must be constructed before other views are added
+	init_views();
+
 	QDockWidget *dock = create_dock_widget(
 		view, (QDockWidget::DockWidgetFeatures)features);
 	this->addDockWidget(area, dock);
@@ -114,6 +145,8 @@ void BaseTab::add_view_ontop(views::BaseView *view,
 	if (!view)
 		return;
 
+	init_views();
+
 	QDockWidget *dock = create_dock_widget(
 		view, (QDockWidget::DockWidgetFeatures)features);
 	this->tabifyDockWidget(view_docks_map_[existing_view], dock);
@@ -27,6 +27,7 @@
 #include <QDockWidget>
 #include <QMainWindow>
 #include <QSettings>
+#include <QShowEvent>
 #include <QString>
 #include <QWidget>
 
@@ -69,12 +70,24 @@ public:
 	views::BaseView *get_view_from_view_id(const string &id);
 	virtual bool request_close() = 0;
 
+	/**
+	 * Construct the views of the tab, if this hasn't been done yet. The views
+	 * are constructed, when the tab is shown for the first time, or when a
+	 * view is added or requested before.
+	 */
+	void init_views();
+	bool is_views_initialized() const;
+
 private:
 	TabDockWidget *create_dock_widget(views::BaseView *view,
 		QDockWidget::DockWidgetFeatures features);
 
 	/** This event is handling the saving of the settings. */
 	void closeEvent(QCloseEvent *event) override;
+	/** Constructs the views, when the tab is shown for the first time. */
+	void showEvent(QShowEvent *event) override;
+
+	bool views_initialized_;
 
 protected:
 	Session &session_;
@@ -92,6 +105,11 @@ protected:
 
 	virtual void save_settings() const = 0;
 	virtual void restore_settings() = 0;
+	/**
+	 * Construct the views of the tab, see init_views(). Tabs, that construct
+	 * their views in the constructor, don't need to override this.
+	 */
+	virtual void setup_views();
 
 public Q_SLOTS:
 	/*
@@ -31,6 +31,8 @@
 
 #include "devicetab.hpp"
 #include "src/session.hpp"
+#include "src/settingsmanager.hpp"
+#include "src/channels/mathchannel.hpp"
 #include "src/channels/userchannel.hpp"
 #include "src/devices/basedevice.hpp"
 #include "src/devices/deviceutil.hpp"
@@ -90,6 +92,20 @@ void DeviceTab::clear_signals()
 {
 }
 
+void DeviceTab::setup_views()
+{
+	if (SettingsManager::restore_settings() &&
+			SettingsManager::has_device_settings(device_)) {
+		restore_settings();
+	}
+	else
+		setup_ui();
+}
+
+void DeviceTab::setup_ui()
+{
+}
+
 void DeviceTab::setup_toolbar()
 {
 	action_aquire_->setText(tr("Stop"));
@@ -195,7 +211,9 @@ void DeviceTab::restore_settings()
 	//       (view) must be set to the last size, in order to restore the
 	//       correct size of the dock widget. Calling/Setting only one of them
 	//       is not working!
-	if (settings.contains("geometry"))
+	//       The geometry of a tab, that is already shown, is set by the tab
+	//       widget, so only the state is restored then.
+	if (settings.contains("geometry") && !isVisible())
 		restoreGeometry(settings.value("geometry").toByteArray());
 	if (settings.contains("state"))
 		restoreState(settings.value("state").toByteArray());
@@ -205,6 +223,11 @@ void DeviceTab::restore_settings()
 
 void DeviceTab::save_settings() const
 {
+	// The views of a tab, that was never shown, haven't been constructed.
+	// Keep their settings.
+	if (!is_views_initialized())
+		return;
+
 	QSettings settings;
 
 	settings.beginGroup(device_->settings_id());
@@ -302,6 +325,8 @@ void DeviceTab::on_action_add_math_channel_triggered()
 	if (channel != nullptr) {
 		device_->add_math_channel(
 			channel, dlg.channel_group_name().toStdString());
+		if (dlg.lazy())
+			channel->set_lazy(true);
 	}
 }
 
@@ -61,6 +61,13 @@ public:
 protected:
 	void save_settings() const override;
 	void restore_settings() override;
+	/**
+	 * Restore the views from the settings or construct the default views
+	 * with setup_ui().
+	 */
+	void setup_views() override;
+	/** Construct the default views of the device. */
+	virtual void setup_ui();
 
 	shared_ptr<sv::devices::BaseDevice> device_;
 	util::TimeUnit time_unit_;
@@ -24,7 +24,6 @@
 
 #include "measurementtab.hpp"
 #include "src/util.hpp"
-#include "src/settingsmanager.hpp"
 #include "src/devices/basedevice.hpp"
 #include "src/devices/configurable.hpp"
 #include "src/devices/hardwaredevice.hpp"
@@ -43,12 +42,7 @@ MeasurementTab::MeasurementTab(Session &session,
 	DeviceTab(session, device, parent),
 	measurement_device_(device)
 {
-	if (SettingsManager::restore_settings() &&
-			SettingsManager::has_device_settings(device)) {
-		restore_settings();
-	}
-	else
-		setup_ui();
+	// The views are constructed, when the tab is shown for the first time
 }
 
 void MeasurementTab::setup_ui()
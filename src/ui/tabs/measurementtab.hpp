@@ -47,7 +47,7 @@ public:
 		QWidget *parent = nullptr);
 
 private:
-	void setup_ui();
+	void setup_ui() override;
 
 	// TODO: remove, generic solution in hw_device
 	shared_ptr<sv::devices::MeasurementDevice> measurement_device_;
@@ -95,6 +95,10 @@ void SmuScriptTab::connect_signals()
 		this, &SmuScriptTab::on_script_started);
 	connect(smu_script_view_, &views::SmuScriptView::script_finished,
 		this, &SmuScriptTab::on_script_finished);
+	connect(session_.smu_script_runner().get(), &python::SmuScriptRunner::send_py_stdout,
+		this, &SmuScriptTab::on_py_stdout);
+	connect(session_.smu_script_runner().get(), &python::SmuScriptRunner::send_py_stderr,
+		this, &SmuScriptTab::on_py_stderr);
 }
 
 void SmuScriptTab::run_script()
@@ -178,21 +182,30 @@ void SmuScriptTab::on_file_save_state_changed(bool is_unsaved)
 		session_.main_window()->change_tab_icon(id_, QIcon());
 }
 
-void SmuScriptTab::on_script_started()
+void SmuScriptTab::on_script_started(const std::string &file_name)
 {
-	// Redirect python output to SmuScriptOutputView
-	connect(session_.smu_script_runner().get(), &python::SmuScriptRunner::send_py_stdout,
-		smu_script_output_view_, &views::SmuScriptOutputView::append_out_text);
-	connect(session_.smu_script_runner().get(), &python::SmuScriptRunner::send_py_stderr,
-		smu_script_output_view_, &views::SmuScriptOutputView::append_err_text);
+	// Redirect the python output of this script to SmuScriptOutputView
+	running_file_name_ = file_name;
+}
+
+void SmuScriptTab::on_script_finished(const std::string &file_name)
+{
+	(void)file_name;
+	running_file_name_.clear();
+}
+
+void SmuScriptTab::on_py_stdout(const std::string &file_name,
+	const std::string &text)
+{
+	if (!running_file_name_.empty() && file_name == running_file_name_)
+		smu_script_output_view_->append_out_text(text);
 }
 
-void SmuScriptTab::on_script_finished()
+void SmuScriptTab::on_py_stderr(const std::string &file_name,
+	const std::string &text)
 {
-	disconnect(session_.smu_script_runner().get(), &python::SmuScriptRunner::send_py_stdout,
-		smu_script_output_view_, &views::SmuScriptOutputView::append_out_text);
-	disconnect(session_.smu_script_runner().get(), &python::SmuScriptRunner::send_py_stderr,
-		smu_script_output_view_, &views::SmuScriptOutputView::append_err_text);
+	if (!running_file_name_.empty() && file_name == running_file_name_)
+		smu_script_output_view_->append_err_text(text);
 }
 
 } // namespace tabs
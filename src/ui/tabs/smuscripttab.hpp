@@ -64,6 +64,8 @@ private:
 	void connect_signals();
 
 	string script_file_name_;
+	/** The file name of the running script, that was started from here. */
+	string running_file_name_;
 	views::SmuScriptView *smu_script_view_;
 	views::SmuScriptOutputView *smu_script_output_view_;
 
@@ -74,8 +76,10 @@ public Q_SLOTS:
 private Q_SLOTS:
 	void on_file_name_changed(const QString &file_name);
 	void on_file_save_state_changed(bool is_unsaved);
-	void on_script_started();
-	void on_script_finished();
+	void on_script_started(const std::string &file_name);
+	void on_script_finished(const std::string &file_name);
+	void on_py_stdout(const std::string &file_name, const std::string &text);
+	void on_py_stderr(const std::string &file_name, const std::string &text);
 
 };
 
@@ -25,7 +25,6 @@
 #include <libsigrokcxx/libsigrokcxx.hpp>
 
 #include "sourcesinktab.hpp"
-#include "src/settingsmanager.hpp"
 #include "src/channels/basechannel.hpp"
 #include "src/data/analogtimesignal.hpp"
 #include "src/data/basesignal.hpp"
@@ -47,12 +46,7 @@ SourceSinkTab::SourceSinkTab(Session &session,
 		shared_ptr<sv::devices::HardwareDevice> device, QWidget *parent) :
 	DeviceTab(session, device, parent)
 {
-	if (SettingsManager::restore_settings() &&
-			SettingsManager::has_device_settings(device)) {
-		restore_settings();
-	}
-	else
-		setup_ui();
+	// The views are constructed, when the tab is shown for the first time
 }
 
 void SourceSinkTab::setup_ui()
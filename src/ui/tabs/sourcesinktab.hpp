@@ -49,7 +49,7 @@ public:
 		QWidget *parent = nullptr);
 
 private:
-	void setup_ui();
+	void setup_ui() override;
 
 public Q_SLOTS:
 
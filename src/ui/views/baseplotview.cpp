@@ -20,23 +20,32 @@
 #include <memory>
 #include <string>
 
+#include <QDebug>
 #include <QImageWriter>
 #include <QFileDialog>
+#include <QMessageBox>
 #include <QSettings>
 #include <QString>
 #include <QToolButton>
 #include <QUuid>
 #include <QVBoxLayout>
-#include <qwt_plot_renderer.h>
+#include <qwt_interval.h>
+#include <qwt_plot.h>
 
 #include "baseplotview.hpp"
 #include "src/session.hpp"
 #include "src/devices/basedevice.hpp"
 #include "src/ui/dialogs/plotconfigdialog.hpp"
 #include "src/ui/dialogs/plotdiffmarkerdialog.hpp"
+#include "src/ui/dialogs/plotexportdialog.hpp"
+#include "src/ui/tabs/basetab.hpp"
 #include "src/ui/views/baseview.hpp"
+#include "src/ui/views/timeplotview.hpp"
+#include "src/ui/views/xyplotview.hpp"
 #include "src/ui/widgets/plot/curve.hpp"
 #include "src/ui/widgets/plot/plot.hpp"
+#include "src/ui/widgets/plot/plotexporter.hpp"
+#include "src/ui/widgets/plot/plotprofiler.hpp"
 #include "src/ui/widgets/plot/basecurvedata.hpp"
 
 using std::shared_ptr;
@@ -54,6 +63,7 @@ BasePlotView::BasePlotView(Session &session, QUuid uuid, QWidget *parent) :
 	action_zoom_best_fit_(new QAction(this)),
 	action_add_curve_(new QAction(this)),
 	action_save_(new QAction(this)),
+	action_freeze_(new QAction(this)),
 	action_config_plot_(new QAction(this))
 {
 	setup_ui();
@@ -69,7 +79,6 @@ void BasePlotView::setup_ui()
 
 	plot_ = new widgets::plot::Plot(session_);
 	plot_->set_update_mode(widgets::plot::PlotUpdateMode::Additive);
-	plot_->set_plot_interval(200); // 200ms
 
 	layout->addWidget(plot_);
 
@@ -118,6 +127,13 @@ void BasePlotView::setup_toolbar()
 	connect(action_save_, &QAction::triggered,
 		this, &BasePlotView::on_action_save_triggered);
 
+	action_freeze_->setText(tr("Snapshot and freeze"));
+	action_freeze_->setIcon(
+		QIcon::fromTheme("media-playback-pause",
+		QIcon(":/icons/media-playback-pause.png")));
+	connect(action_freeze_, &QAction::triggered,
+		this, &BasePlotView::on_action_freeze_triggered);
+
 	action_config_plot_->setText(tr("Configure Plot"));
 	action_config_plot_->setIcon(
 		QIcon::fromTheme("configure",
@@ -134,6 +150,7 @@ void BasePlotView::setup_toolbar()
 	toolbar_->addAction(action_add_curve_);
 	toolbar_->addSeparator();
 	toolbar_->addAction(action_save_);
+	toolbar_->addAction(action_freeze_);
 	toolbar_->addSeparator();
 	toolbar_->addAction(action_config_plot_);
 	this->addToolBar(Qt::TopToolBarArea, toolbar_);
@@ -170,6 +187,15 @@ void BasePlotView::connect_signals()
 }
 
 
+string BasePlotView::add_curve_data(
+	widgets::plot::BaseCurveData *curve_data)
+{
+	string id = plot_->add_curve(curve_data);
+	if (id.empty())
+		delete curve_data;
+	return id;
+}
+
 bool BasePlotView::set_curve_name(const string &curve_id, const QString &name)
 {
 	if (plot_->curve_map().count(curve_id) == 0)
@@ -189,6 +215,19 @@ bool BasePlotView::set_curve_color(const string &curve_id, const QColor &color)
 	return true;
 }
 
+void BasePlotView::set_update_mode(widgets::plot::PlotUpdateMode update_mode)
+{
+	plot_->set_update_mode(update_mode);
+}
+
+widgets::plot::PlotProfile BasePlotView::profile(bool reset)
+{
+	const auto profile = plot_->profiler().profile();
+	if (reset)
+		plot_->profiler().reset();
+	return profile;
+}
+
 void BasePlotView::save_settings(QSettings &settings,
 	shared_ptr<sv::devices::BaseDevice> origin_device) const
 {
@@ -246,11 +285,75 @@ void BasePlotView::on_action_save_triggered()
 	if (file_name.length() <= 0)
 		return;
 
-	// TODO
-	QSizeF size(300, 300);
-	int resolution = 90;
-	QwtPlotRenderer renderer;
-	renderer.renderDocument(plot_, file_name, size, resolution);
+	ui::dialogs::PlotExportDialog dlg;
+	if (dlg.exec() != QDialog::Accepted)
+		return;
+
+	auto *exporter = new widgets::plot::PlotExporter(session_, plot_);
+	if (dlg.full_range())
+		exporter->set_full_range();
+	connect(exporter, &widgets::plot::PlotExporter::finished,
+		this, &BasePlotView::on_plot_exported);
+	exporter->start(file_name, dlg.document_size(), dlg.resolution());
+}
+
+void BasePlotView::on_plot_exported(bool success, const QString &file_name)
+{
+	if (!success) {
+		QMessageBox::warning(this,
+			tr("Cannot save plot"), tr("Cannot save plot to %1!").arg(file_name),
+			QMessageBox::Ok);
+	}
+}
+
+void BasePlotView::on_action_freeze_triggered()
+{
+	// The view is docked into a tab
+	tabs::BaseTab *tab = nullptr;
+	for (QWidget *w = parentWidget(); w && !tab; w = w->parentWidget())
+		tab = qobject_cast<tabs::BaseTab *>(w);
+	if (!tab) {
+		qWarning() << "BasePlotView::on_action_freeze_triggered(): " <<
+			"No tab found for view " << QString::fromStdString(id_);
+		return;
+	}
+
+	BasePlotView *view;
+	if (plot_type_ == PlotType::XYPlot)
+		view = new XYPlotView(session_);
+	else
+		view = new TimePlotView(session_);
+
+	// The frozen curves only reference the current samples of the signals,
+	// the live plot continues.
+	for (const auto &curve_pair : plot_->curve_map()) {
+		const widgets::plot::Curve *curve = curve_pair.second;
+		widgets::plot::BaseCurveData *curve_data =
+			curve->curve_data()->freeze();
+		if (!curve_data)
+			continue;
+		auto *frozen_curve = new widgets::plot::Curve(curve_data,
+			curve->x_axis_id(), curve->y_axis_id(),
+			curve->name(), curve->color());
+		frozen_curve->set_style(curve->style());
+		frozen_curve->set_symbol(curve->symbol());
+		if (!view->plot_->add_curve(frozen_curve))
+			delete frozen_curve;
+	}
+
+	// Start with the range of the live plot
+	for (const int axis_id :
+			{ QwtPlot::xBottom, QwtPlot::yLeft, QwtPlot::yRight }) {
+		if (!plot_->axisEnabled(axis_id))
+			continue;
+		const QwtInterval interval = plot_->axisInterval(axis_id);
+		view->plot_->setAxisScale(
+			axis_id, interval.minValue(), interval.maxValue());
+	}
+	view->plot_->set_all_axis_locked(true);
+	view->plot_->replot();
+
+	tab->add_view(view, Qt::BottomDockWidgetArea);
 }
 
 void BasePlotView::on_action_config_plot_triggered()
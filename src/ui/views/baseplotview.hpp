@@ -57,6 +57,8 @@ namespace widgets {
 namespace plot {
 class BaseCurveData;
 class Plot;
+struct PlotProfile;
+enum class PlotUpdateMode;
 }
 }
 
@@ -75,10 +77,25 @@ public:
 	explicit BasePlotView(Session &session, QUuid uuid = QUuid(),
 		QWidget *parent = nullptr);
 
+	/**
+	 * Helper function to add a curve, that isn't created from the signal
+	 * selection of the view, e.g. the samples of a script. The view takes the
+	 * ownership of the curve data, also when the curve couldn't be added.
+	 *
+	 * @return the curve id or an empty string.
+	 */
+	string add_curve_data(widgets::plot::BaseCurveData *curve_data);
 	/** Helper function to change a curve name. */
 	bool set_curve_name(const string &curve_id, const QString &name);
 	/** Helper function to change a curve color. */
 	bool set_curve_color(const string &curve_id, const QColor &color);
+	/** Helper function to change the update mode of the plot. */
+	void set_update_mode(widgets::plot::PlotUpdateMode update_mode);
+	/**
+	 * Helper function to get the statistics of the frame profiler of the
+	 * plot. With reset, the profiler is reset after reading.
+	 */
+	widgets::plot::PlotProfile profile(bool reset);
 	void save_settings(QSettings &settings,
 		shared_ptr<sv::devices::BaseDevice> origin_device = nullptr) const override;
 	void restore_settings(QSettings &settings,
@@ -100,6 +117,7 @@ private:
 	QAction *const action_zoom_best_fit_;
 	QAction *const action_add_curve_;
 	QAction *const action_save_;
+	QAction *const action_freeze_;
 	QAction *const action_config_plot_;
 	QToolBar *toolbar_;
 
@@ -112,7 +130,9 @@ private Q_SLOTS:
 	void on_action_add_diff_marker_triggered();
 	void on_action_zoom_best_fit_triggered();
 	void on_action_save_triggered();
+	void on_action_freeze_triggered();
 	void on_action_config_plot_triggered();
+	void on_plot_exported(bool success, const QString &file_name);
 
 };
 
@@ -19,8 +19,12 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
+#include <QHideEvent>
+#include <QMainWindow>
 #include <QSettings>
+#include <QShowEvent>
 #include <QSize>
 #include <QString>
 #include <QUuid>
@@ -28,7 +32,10 @@
 
 #include "baseview.hpp"
 #include "src/session.hpp"
+#include "src/data/properties/baseproperty.hpp"
 #include "src/devices/basedevice.hpp"
+#include "src/devices/configurable.hpp"
+#include "src/devices/statemonitor.hpp"
 
 using std::shared_ptr;
 using std::string;
@@ -40,7 +47,9 @@ namespace views {
 BaseView::BaseView(Session &session, QUuid uuid, QWidget *parent) :
 	QMainWindow(parent),
 	session_(session),
-	size_(QSize(-1, -1))
+	size_(QSize(-1, -1)),
+	hibernated_(false),
+	watching_states_(true)
 {
 	// Every view gets its own unique id
 	uuid_ = uuid.isNull() ? QUuid::createUuid() : uuid;
@@ -53,6 +62,11 @@ BaseView::BaseView(Session &session, QUuid uuid, QWidget *parent) :
 	this->setCentralWidget(central_widget_);
 }
 
+BaseView::~BaseView()
+{
+	set_watching_states(false);
+}
+
 
 Session &BaseView::session()
 {
@@ -104,6 +118,69 @@ QSize BaseView::sizeHint() const
 	return QMainWindow::sizeHint();
 }
 
+bool BaseView::is_hibernated() const
+{
+	return hibernated_;
+}
+
+void BaseView::hibernate()
+{
+}
+
+void BaseView::wake()
+{
+}
+
+void BaseView::watch_state(shared_ptr<data::properties::BaseProperty> property)
+{
+	if (!property)
+		return;
+
+	watched_states_.push_back(property);
+	auto state_monitor = property->configurable()->state_monitor();
+	if (watching_states_ && state_monitor)
+		state_monitor->watch(property);
+}
+
+void BaseView::set_watching_states(bool watching)
+{
+	if (watching == watching_states_)
+		return;
+
+	watching_states_ = watching;
+	for (const auto &property : watched_states_) {
+		auto state_monitor = property->configurable()->state_monitor();
+		if (!state_monitor)
+			continue;
+		if (watching)
+			state_monitor->watch(property);
+		else
+			state_monitor->unwatch(property);
+	}
+}
+
+void BaseView::showEvent(QShowEvent *event)
+{
+	QMainWindow::showEvent(event);
+	if (hibernated_) {
+		hibernated_ = false;
+		set_watching_states(true);
+		wake();
+	}
+}
+
+void BaseView::hideEvent(QHideEvent *event)
+{
+	// Hide events are also sent to the children of a hidden widget, so the
+	// views of a hidden tab hibernate as well.
+	QMainWindow::hideEvent(event);
+	if (!hibernated_) {
+		hibernate();
+		set_watching_states(false);
+		hibernated_ = true;
+	}
+}
+
 } // namespace views
 } // namespace ui
 } // namespace sv
@@ -22,9 +22,12 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
+#include <QHideEvent>
 #include <QMainWindow>
 #include <QSettings>
+#include <QShowEvent>
 #include <QSize>
 #include <QString>
 #include <QUuid>
@@ -32,11 +35,18 @@
 
 using std::shared_ptr;
 using std::string;
+using std::vector;
 
 namespace sv {
 
 class Session;
 
+namespace data {
+namespace properties {
+class BaseProperty;
+}
+}
+
 namespace devices {
 class BaseDevice;
 }
@@ -62,6 +72,7 @@ class BaseView : public QMainWindow
 public:
 	explicit BaseView(Session &session, QUuid uuid = QUuid(),
 		QWidget *parent = nullptr);
+	~BaseView();
 
 	Session &session();
 	const Session &session() const;
@@ -78,7 +89,36 @@ public:
 	/** Return a size hint for restoring the correct view size from QSettings. */
 	QSize sizeHint() const override;
 
+	/**
+	 * Return true if the view is hidden, e.g. because its tab or its tabbed
+	 * dock widget isn't the current one.
+	 */
+	bool is_hibernated() const;
+
 protected:
+	/**
+	 * Called when the view gets hidden. Views with their own timers or
+	 * sample notifications stop them here. is_hibernated() returns true
+	 * after hibernate() and false before wake() is called.
+	 */
+	virtual void hibernate();
+	/**
+	 * Called when the hibernated view is shown again. The view restarts its
+	 * updates and syncs itself to the current state of its data.
+	 */
+	virtual void wake();
+
+	/**
+	 * Watch a state property (e.g. OVP active), that is displayed by the view,
+	 * with the StateMonitor of its device. The property is only watched,
+	 * while the view isn't hibernated. nullptr is ignored.
+	 */
+	void watch_state(
+		shared_ptr<sv::data::properties::BaseProperty> property);
+
+	void showEvent(QShowEvent *event) override;
+	void hideEvent(QHideEvent *event) override;
+
 	Session &session_;
 	QWidget *central_widget_;
 	QUuid uuid_;
@@ -86,6 +126,14 @@ protected:
 	/** The size for sizeHint(). */
 	QSize size_;
 
+private:
+	/** Watch or unwatch all state properties. */
+	void set_watching_states(bool watching);
+
+	bool hibernated_;
+	vector<shared_ptr<sv::data::properties::BaseProperty>> watched_states_;
+	bool watching_states_;
+
 Q_SIGNALS:
 	void title_changed();
 
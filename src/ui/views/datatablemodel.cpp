@@ -0,0 +1,146 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <climits>
+#include <memory>
+#include <vector>
+
+#include <QAbstractTableModel>
+#include <QModelIndex>
+#include <QString>
+#include <QVariant>
+
+#include "datatablemodel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/mergedtimeindex.hpp"
+
+using std::shared_ptr;
+using std::vector;
+
+namespace sv {
+namespace ui {
+namespace views {
+
+DataTableModel::DataTableModel(QObject *parent) :
+	QAbstractTableModel(parent),
+	index_(new data::MergedTimeIndex(signals_)),
+	row_count_(0),
+	sample_count_(0)
+{
+}
+
+DataTableModel::~DataTableModel()
+{
+}
+
+void DataTableModel::set_signals(
+	const vector<shared_ptr<sv::data::AnalogTimeSignal>> &signals)
+{
+	signals_ = signals;
+	reset_index();
+}
+
+void DataTableModel::reset_index()
+{
+	beginResetModel();
+	index_.reset(new data::MergedTimeIndex(signals_));
+	index_->flush();
+	row_count_ = (int)std::min(index_->size(), (size_t)INT_MAX);
+	endResetModel();
+}
+
+bool DataTableModel::refresh()
+{
+	if (index_->is_stale()) {
+		reset_index();
+		return true;
+	}
+
+	const size_t dropped = index_->dropped_rows();
+	if (dropped > 0) {
+		beginRemoveRows(QModelIndex(), 0, (int)dropped - 1);
+		index_->drop_front(dropped);
+		row_count_ -= (int)dropped;
+		endRemoveRows();
+	}
+
+	size_t sample_count = 0;
+	for (const auto &signal : signals_)
+		sample_count += signal->sample_count();
+	const size_t rows =
+		sample_count == sample_count_ ? index_->flush() : index_->update();
+	sample_count_ = sample_count;
+
+	// The views only get to see the new rows, after they are announced
+	const int new_row_count = (int)std::min(index_->size(), (size_t)INT_MAX);
+	if (rows == 0 || new_row_count == row_count_)
+		return false;
+	beginInsertRows(QModelIndex(), row_count_, new_row_count - 1);
+	row_count_ = new_row_count;
+	endInsertRows();
+	return true;
+}
+
+int DataTableModel::rowCount(const QModelIndex &parent) const
+{
+	return parent.isValid() ? 0 : row_count_;
+}
+
+int DataTableModel::columnCount(const QModelIndex &parent) const
+{
+	return parent.isValid() ? 0 : (int)signals_.size() + 1;
+}
+
+QVariant DataTableModel::data(const QModelIndex &index, int role) const
+{
+	if (role != Qt::DisplayRole || !index.isValid() ||
+			index.row() >= row_count_ || index.column() > (int)signals_.size())
+		return QVariant();
+
+	const size_t row = index_->begin_pos() + (size_t)index.row();
+	if (index.column() == 0)
+		return formatter_.format_fixed(index_->timestamp(row), 0, 3);
+
+	// The value is only read now, it might have been dropped in the meantime
+	const size_t k = (size_t)index.column() - 1;
+	const size_t pos = index_->sample_pos(row, k);
+	double value;
+	if (pos == data::MergedTimeIndex::npos ||
+			signals_[k]->copy_samples(pos, 1, false, nullptr, &value) == 0)
+		return QVariant();
+	return formatter_.format_fixed(value, 0, signals_[k]->decimal_places());
+}
+
+QVariant DataTableModel::headerData(int section, Qt::Orientation orientation,
+	int role) const
+{
+	if (role != Qt::DisplayRole || orientation != Qt::Horizontal)
+		return QAbstractTableModel::headerData(section, orientation, role);
+
+	if (section == 0)
+		return tr("Time [s]");
+	if (section <= (int)signals_.size())
+		return signals_[section - 1]->display_name();
+	return QVariant();
+}
+
+} // namespace views
+} // namespace ui
+} // namespace sv
@@ -0,0 +1,99 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_VIEWS_DATATABLEMODEL_HPP
+#define UI_VIEWS_DATATABLEMODEL_HPP
+
+#include <memory>
+#include <vector>
+
+#include <QAbstractTableModel>
+#include <QModelIndex>
+#include <QObject>
+#include <QVariant>
+
+#include "src/data/formatter.hpp"
+
+using std::shared_ptr;
+using std::unique_ptr;
+using std::vector;
+
+namespace sv {
+
+namespace data {
+class AnalogTimeSignal;
+class MergedTimeIndex;
+}
+
+namespace ui {
+namespace views {
+
+/**
+ * A table model with the timestamps in the first column and the values of
+ * the signals in the following columns. The rows come from a
+ * MergedTimeIndex, the values are read from the signals only for the rows,
+ * that are actually shown, so the table can be as long as the signals.
+ */
+class DataTableModel : public QAbstractTableModel
+{
+	Q_OBJECT
+
+public:
+	explicit DataTableModel(QObject *parent = nullptr);
+	~DataTableModel();
+
+	void set_signals(const vector<shared_ptr<sv::data::AnalogTimeSignal>> &signals);
+
+	/**
+	 * Merge the new samples of the signals into the table and remove the rows
+	 * of the samples, that were dropped from the signals. If no new samples
+	 * were pushed since the last refresh, the samples of stalled signals are
+	 * merged as well.
+	 *
+	 * @return true if rows were appended.
+	 */
+	bool refresh();
+
+	int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+	int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+	QVariant data(const QModelIndex &index,
+		int role = Qt::DisplayRole) const override;
+	QVariant headerData(int section, Qt::Orientation orientation,
+		int role = Qt::DisplayRole) const override;
+
+private:
+	/** Rebuild the index, all rows are merged again. */
+	void reset_index();
+
+	vector<shared_ptr<sv::data::AnalogTimeSignal>> signals_;
+	unique_ptr<sv::data::MergedTimeIndex> index_;
+	/** Formats like QString::number(), in the C locale. */
+	sv::data::Formatter formatter_;
+	/** The row count, that the views know of. */
+	int row_count_;
+	/** The sum of the sample counts of the signals at the last refresh. */
+	size_t sample_count_;
+
+};
+
+} // namespace views
+} // namespace ui
+} // namespace sv
+
+#endif // UI_VIEWS_DATATABLEMODEL_HPP
@@ -18,24 +18,23 @@
  */
 
 #include <memory>
-#include <mutex>
-#include <set>
 #include <string>
 
 #include <QAction>
 #include <QDebug>
-#include <QList>
+#include <QHeaderView>
 #include <QSettings>
-#include <QScrollBar>
-#include <QTableWidget>
-#include <QTableWidgetItem>
+#include <QTableView>
+#include <QTimer>
 #include <QToolBar>
 #include <QUuid>
 #include <QVBoxLayout>
 
 #include "dataview.hpp"
+#include "src/loadgovernor.hpp"
 #include "src/session.hpp"
 #include "src/settingsmanager.hpp"
+#include "src/tracer.hpp"
 #include "src/util.hpp"
 #include "src/channels/basechannel.hpp"
 #include "src/data/analogbasesignal.hpp"
@@ -44,6 +43,7 @@
 #include "src/devices/basedevice.hpp"
 #include "src/ui/dialogs/selectsignaldialog.hpp"
 #include "src/ui/views/baseview.hpp"
+#include "src/ui/views/datatablemodel.hpp"
 #include "src/ui/views/viewhelper.hpp"
 
 using std::shared_ptr;
@@ -53,6 +53,8 @@ namespace sv {
 namespace ui {
 namespace views {
 
+const int DataView::refresh_interval_ = 200;
+
 DataView::DataView(Session &session, QUuid uuid, QWidget *parent) :
 	BaseView(session, uuid, parent),
 	auto_scroll_(true),
@@ -63,6 +65,23 @@ DataView::DataView(Session &session, QUuid uuid, QWidget *parent) :
 
 	setup_ui();
 	setup_toolbar();
+
+	timer_ = new QTimer(this);
+	connect(timer_, &QTimer::timeout, this, &DataView::on_refresh);
+	timer_->start(refresh_interval());
+
+	// Coalesce more samples per refresh, while the GUI thread falls behind
+	connect(session_.load_governor(), &LoadGovernor::level_changed,
+		this, [this]() {
+			if (timer_->isActive())
+				timer_->start(refresh_interval());
+		});
+}
+
+DataView::~DataView()
+{
+	for (const auto &signal : signals_)
+		signal->remove_observer();
 }
 
 QString DataView::title() const
@@ -77,11 +96,12 @@ void DataView::setup_ui()
 {
 	QVBoxLayout *layout = new QVBoxLayout();
 
-	data_table_ = new QTableWidget();
-	data_table_->setColumnCount(1);
-	QTableWidgetItem *time_header_item = new QTableWidgetItem(tr("Time [s]"));
-	time_header_item->setTextAlignment(Qt::AlignVCenter);
-	data_table_->setHorizontalHeaderItem(0, time_header_item);
+	data_model_ = new DataTableModel(this);
+	data_table_ = new QTableView();
+	data_table_->setModel(data_model_);
+	// Fixed row heights, so the view doesn't have to measure all rows
+	data_table_->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+	data_table_->horizontalHeader()->setDefaultAlignment(Qt::AlignVCenter);
 	data_table_->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
 	layout->addWidget(data_table_);
 
@@ -149,85 +169,36 @@ void DataView::restore_settings(QSettings &settings,
 void DataView::add_signal(shared_ptr<sv::data::AnalogTimeSignal> signal)
 {
 	signals_.push_back(signal);
-	next_signal_pos_.push_back(0);
-	last_timestamp_.push_back(nullptr);
-	size_t pos = signals_.size();
-
-	QTableWidgetItem *value_header_item = new QTableWidgetItem(
-		signal->display_name());
-	value_header_item->setTextAlignment(Qt::AlignVCenter);
-	data_table_->insertColumn(pos);
-	data_table_->setHorizontalHeaderItem(pos, value_header_item);
-
-	this->populate_table();
-	connect(signal.get(), &data::AnalogBaseSignal::sample_appended,
-		this, &DataView::populate_table);
+	signal->add_observer();
+	data_model_->set_signals(signals_);
+	if (auto_scroll_)
+		data_table_->scrollToBottom();
 
 	Q_EMIT title_changed();
 }
 
-void DataView::populate_table()
+void DataView::hibernate()
 {
-	std::unique_lock<std::mutex> lock(populate_mutex_, std::try_to_lock);
-	if (!lock.owns_lock())
-		return;
-
-	for (size_t i=0; i<signals_.size(); ++i) {
-		size_t signal_size = signals_[i]->sample_count();
-		while (next_signal_pos_[i] < signal_size) {
-			auto sample = signals_[i]->get_sample(next_signal_pos_[i], true);
-			int row_count  = data_table_->rowCount();
+	timer_->stop();
+}
 
-			int last_row  = -1;
-			if (last_timestamp_[i])
-				last_row = data_table_->row(last_timestamp_[i]);
+void DataView::wake()
+{
+	// Merge the samples, that were appended while the view was hidden
+	on_refresh();
+	timer_->start(refresh_interval());
+}
 
-			bool new_row = false;
-			if (row_count <= last_row+1) {
-				data_table_->insertRow(last_row+1);
-				new_row = true;
-			}
-			else {
-				// Find position of new sample
-				while (last_row+1 < row_count) {
-					auto item = data_table_->item(last_row+1, 0);
-					double timestamp = item->data(0).toDouble();
-					if (timestamp > sample.first) {
-						data_table_->insertRow(last_row+1);
-						new_row = true;
-						break;
-					}
-					if (timestamp == sample.first) {
-						last_timestamp_[i] = item;
-						new_row = false;
-						break;
-					}
-					if (row_count == last_row+2) {
-						++last_row;
-						data_table_->insertRow(last_row+1);
-						new_row = true;
-						break;
-					}
-					last_row++;
-				}
-			}
+int DataView::refresh_interval() const
+{
+	return refresh_interval_ * session_.load_governor()->interval_factor();
+}
 
-			if (new_row) {
-				QTableWidgetItem *time_item = new QTableWidgetItem(
-					QString::number(sample.first, 'f', 3));
-				time_item->setData(0, QVariant(sample.first));
-				data_table_->setItem(last_row+1, 0, time_item);
-				last_timestamp_[i] = time_item;
-			}
-			QTableWidgetItem *value_item = new QTableWidgetItem(
-				QString::number(sample.second, 'f', signals_[i]->decimal_places()));
-			value_item->setData(0, QVariant(sample.second));
-			data_table_->setItem(last_row+1, (int)i+1, value_item);
+void DataView::on_refresh()
+{
+	SV_TRACE_SCOPE("DataView::on_refresh");
 
-			++next_signal_pos_[i];
-		}
-	}
-	if (auto_scroll_)
+	if (data_model_->refresh() && auto_scroll_)
 		data_table_->scrollToBottom();
 }
 
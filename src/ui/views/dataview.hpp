@@ -21,12 +21,12 @@
 #define UI_VIEWS_DATAVIEW_HPP
 
 #include <memory>
-#include <mutex>
 #include <vector>
 
 #include <QAction>
 #include <QSettings>
-#include <QTableWidget>
+#include <QTableView>
+#include <QTimer>
 #include <QToolBar>
 #include <QUuid>
 
@@ -49,6 +49,8 @@ class BaseDevice;
 namespace ui {
 namespace views {
 
+class DataTableModel;
+
 class DataView : public BaseView
 {
 	Q_OBJECT
@@ -56,6 +58,7 @@ class DataView : public BaseView
 public:
 	explicit DataView(Session& session, QUuid uuid = QUuid(),
 		QWidget* parent = nullptr);
+	~DataView();
 
 	QString title() const override;
 	void add_signal(shared_ptr<sv::data::AnalogTimeSignal> signal);
@@ -65,23 +68,31 @@ public:
 	void restore_settings(QSettings &settings,
 		shared_ptr<sv::devices::BaseDevice> origin_device = nullptr) override;
 
+protected:
+	void hibernate() override;
+	void wake() override;
+
 private:
 	vector<shared_ptr<sv::data::AnalogTimeSignal>> signals_;
-	vector<size_t> next_signal_pos_;
-	vector<QTableWidgetItem *> last_timestamp_;
 	bool auto_scroll_;
-	std::mutex populate_mutex_;
 
 	QAction *const action_auto_scroll_;
 	QAction *const action_add_signal_;
 	QToolBar *toolbar_;
-	QTableWidget *data_table_;
+	DataTableModel *data_model_;
+	QTableView *data_table_;
+	QTimer *timer_;
+
+	/** The new samples are merged into the table in this interval. */
+	static const int refresh_interval_;
 
 	void setup_ui();
 	void setup_toolbar();
+	/** Return the refresh interval, stretched by the load governor. */
+	int refresh_interval() const;
 
 private Q_SLOTS:
-	void populate_table();
+	void on_refresh();
 	void on_action_auto_scroll_triggered();
 	void on_action_add_signal_triggered();
 
@@ -17,11 +17,21 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include <QAction>
+#include <QActionGroup>
 #include <QDebug>
+#include <QDir>
+#include <QFileDialog>
+#include <QInputDialog>
+#include <QItemSelectionModel>
+#include <QMenu>
 #include <QMessageBox>
+#include <QModelIndex>
 #include <QSettings>
 #include <QToolBar>
 #include <QUuid>
@@ -31,9 +41,11 @@
 #include "src/devicemanager.hpp"
 #include "src/mainwindow.hpp"
 #include "src/session.hpp"
+#include "src/tracer.hpp"
 #include "src/util.hpp"
 #include "src/channels/basechannel.hpp"
 #include "src/data/basesignal.hpp"
+#include "src/data/sampledecimator.hpp"
 #include "src/devices/basedevice.hpp"
 #include "src/devices/hardwaredevice.hpp"
 #include "src/devices/userdevice.hpp"
@@ -45,7 +57,9 @@
 #include "src/ui/views/baseview.hpp"
 #include "src/ui/views/baseview.hpp"
 
+using std::pair;
 using std::shared_ptr;
+using std::vector;
 using sv::ui::devices::devicetree::DeviceTreeModel;
 using sv::ui::devices::devicetree::TreeItem;
 using sv::ui::devices::devicetree::TreeItemType;
@@ -60,7 +74,10 @@ DevicesView::DevicesView(Session &session, QUuid uuid, QWidget *parent) :
 	BaseView(session, uuid, parent),
 	action_add_device_(new QAction(this)),
 	action_add_userdevice_(new QAction(this)),
-	action_disconnect_device_(new QAction(this))
+	action_disconnect_device_(new QAction(this)),
+	action_record_trace_(new QAction(this)),
+	action_show_performance_(new QAction(this)),
+	action_show_limit_results_(new QAction(this))
 {
 	id_ = "devices:" + util::format_uuid(uuid_);
 
@@ -79,6 +96,8 @@ void DevicesView::setup_ui()
 	QVBoxLayout *layout = new QVBoxLayout();
 	device_tree_ = new devices::devicetree::DeviceTreeView(session(),
 		false, false, false, false, false, false, true, true);
+	device_tree_->setContextMenuPolicy(Qt::CustomContextMenu);
+	layout->addWidget(device_tree_->create_filter_edit());
 	layout->addWidget(device_tree_);
 	layout->setContentsMargins(2, 2, 2, 2);
 
@@ -108,16 +127,48 @@ void DevicesView::setup_toolbar()
 	connect(action_disconnect_device_, SIGNAL(triggered(bool)),
 		this, SLOT(on_action_disconnect_device_triggered()));
 
+	action_record_trace_->setText(tr("Record trace"));
+	action_record_trace_->setToolTip(
+		tr("Record trace events of the data path and the plots"));
+	action_record_trace_->setIcon(
+		QIcon::fromTheme("media-record",
+		QIcon(":/icons/media-playback-start.png")));
+	action_record_trace_->setCheckable(true);
+	connect(action_record_trace_, SIGNAL(triggered(bool)),
+		this, SLOT(on_action_record_trace_triggered()));
+
+	action_show_performance_->setText(tr("Show performance"));
+	action_show_performance_->setIcon(
+		QIcon::fromTheme("utilities-system-monitor",
+		QIcon(":/icons/chronometer.png")));
+	connect(action_show_performance_, SIGNAL(triggered(bool)),
+		this, SLOT(on_action_show_performance_triggered()));
+
+	action_show_limit_results_->setText(tr("Show limit test results"));
+	action_show_limit_results_->setIcon(
+		QIcon::fromTheme("dialog-ok-apply",
+		QIcon(":/icons/status-green.svg")));
+	connect(action_show_limit_results_, SIGNAL(triggered(bool)),
+		this, SLOT(on_action_show_limit_results_triggered()));
+
 	toolbar_ = new QToolBar("Device Tree Toolbar");
 	toolbar_->addAction(action_add_device_);
 	toolbar_->addAction(action_add_userdevice_);
 	toolbar_->addSeparator();
 	toolbar_->addAction(action_disconnect_device_);
+	toolbar_->addSeparator();
+	toolbar_->addAction(action_show_performance_);
+	toolbar_->addAction(action_show_limit_results_);
+#ifdef ENABLE_TRACING
+	toolbar_->addAction(action_record_trace_);
+#endif
 	this->addToolBar(Qt::TopToolBarArea, toolbar_);
 }
 
 void DevicesView::connect_signals()
 {
+	connect(device_tree_, SIGNAL(customContextMenuRequested(const QPoint &)),
+		this, SLOT(on_device_tree_context_menu_requested(const QPoint &)));
 }
 
 void DevicesView::save_settings(QSettings &settings,
@@ -208,6 +259,109 @@ void DevicesView::on_action_disconnect_device_triggered()
 	}
 }
 
+void DevicesView::on_action_record_trace_triggered()
+{
+	if (action_record_trace_->isChecked()) {
+		Tracer::start();
+		return;
+	}
+
+	Tracer::stop();
+	QString file_name = QFileDialog::getSaveFileName(this,
+		tr("Save Trace"), QDir::homePath(),
+		tr("Chrome Trace Files (*.json)"));
+	if (file_name.length() <= 0)
+		return;
+	if (!Tracer::save_chrome_trace(file_name.toStdString())) {
+		QMessageBox::warning(this,
+			tr("Cannot save trace"),
+			tr("Cannot save trace to %1!").arg(file_name),
+			QMessageBox::Ok);
+	}
+	else if (Tracer::dropped_count() > 0) {
+		QMessageBox::information(this,
+			tr("Trace saved"),
+			tr("%1 events didn't fit into the trace buffers and were dropped.").
+				arg(Tracer::dropped_count()),
+			QMessageBox::Ok);
+	}
+}
+
+void DevicesView::on_action_show_performance_triggered()
+{
+	session().main_window()->show_performance_view();
+}
+
+void DevicesView::on_action_show_limit_results_triggered()
+{
+	session().main_window()->show_limit_results_view();
+}
+
+void DevicesView::on_device_tree_context_menu_requested(const QPoint &pos)
+{
+	QModelIndex index = device_tree_->indexAt(pos);
+	if (!index.isValid())
+		return;
+	device_tree_->selectionModel()->setCurrentIndex(
+		index, QItemSelectionModel::ClearAndSelect);
+
+	TreeItem *item = device_tree_->selected_item();
+	if (!item || item->type() != (int)TreeItemType::ChannelItem)
+		return;
+	auto channel = item->data(DeviceTreeModel::DataRole).
+		value<shared_ptr<sv::channels::BaseChannel>>();
+	if (!channel)
+		return;
+
+	QMenu menu;
+	QMenu *decimation_menu = menu.addMenu(tr("Ingest decimation"));
+	QActionGroup *decimation_group = new QActionGroup(decimation_menu);
+	const vector<pair<sv::data::DecimationMode, QString>> modes {
+		{ sv::data::DecimationMode::Off, tr("Off") },
+		{ sv::data::DecimationMode::Average, tr("Average") },
+		{ sv::data::DecimationMode::MinMax, tr("Min/Max") },
+		{ sv::data::DecimationMode::PickEveryN, tr("Pick every N") },
+		{ sv::data::DecimationMode::DeadBand, tr("Dead band") },
+		{ sv::data::DecimationMode::SwingingDoor, tr("Swinging door") },
+	};
+	for (const auto &mode : modes) {
+		QAction *action = decimation_menu->addAction(mode.second);
+		action->setData((int)mode.first);
+		action->setCheckable(true);
+		action->setChecked(mode.first == channel->decimation_mode());
+		decimation_group->addAction(action);
+	}
+
+	QAction *action = menu.exec(device_tree_->viewport()->mapToGlobal(pos));
+	if (!action)
+		return;
+
+	auto mode = (sv::data::DecimationMode)action->data().toInt();
+	size_t factor = channel->decimation_factor();
+	double tolerance = channel->decimation_tolerance();
+	if (mode == sv::data::DecimationMode::DeadBand ||
+			mode == sv::data::DecimationMode::SwingingDoor) {
+		bool ok;
+		tolerance = QInputDialog::getDouble(this, tr("Ingest decimation"),
+			tr("Tolerance of the stored signal:"),
+			tolerance, 0., 1e12, 6, &ok);
+		if (!ok)
+			return;
+		// The historian modes don't limit the gaps between the samples
+		factor = 0;
+	}
+	else if (mode != sv::data::DecimationMode::Off) {
+		bool ok;
+		int new_factor = QInputDialog::getInt(this, tr("Ingest decimation"),
+			tr("Number of samples, that are reduced to one sample:"),
+			std::max(2, (int)factor), 2, 1000000, 1, &ok);
+		if (!ok)
+			return;
+		factor = (size_t)new_factor;
+	}
+	channel->set_decimation(mode, factor, tolerance);
+}
+
 } // namespace views
 } // namespace ui
 } // namespace sv
@@ -23,6 +23,7 @@
 #include <memory>
 
 #include <QAction>
+#include <QPoint>
 #include <QSettings>
 #include <QToolBar>
 #include <QUuid>
@@ -68,6 +69,9 @@ private:
 	QAction *const action_add_device_;
 	QAction *const action_add_userdevice_;
 	QAction *const action_disconnect_device_;
+	QAction *const action_record_trace_;
+	QAction *const action_show_performance_;
+	QAction *const action_show_limit_results_;
 	QToolBar *toolbar_;
 	devices::devicetree::DeviceTreeView  *device_tree_;
 
@@ -79,6 +83,10 @@ private Q_SLOTS:
 	void on_action_add_device_triggered();
 	void on_action_add_userdevice_triggered();
 	void on_action_disconnect_device_triggered();
+	void on_action_record_trace_triggered();
+	void on_action_show_performance_triggered();
+	void on_action_show_limit_results_triggered();
+	void on_device_tree_context_menu_requested(const QPoint &pos);
 
 };
 
@@ -0,0 +1,305 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <memory>
+
+#include <QColor>
+#include <QDebug>
+#include <QPen>
+#include <QSettings>
+#include <QString>
+#include <QUuid>
+#include <QVariant>
+#include <QVBoxLayout>
+#include <qwt_plot.h>
+#include <qwt_plot_canvas.h>
+#include <qwt_plot_curve.h>
+#include <qwt_plot_grid.h>
+
+#include "frameoverlayview.hpp"
+#include "src/session.hpp"
+#include "src/settingsmanager.hpp"
+#include "src/util.hpp"
+#include "src/channels/hardwarechannel.hpp"
+#include "src/data/analogsegmentsignal.hpp"
+#include "src/devices/basedevice.hpp"
+#include "src/ui/views/baseview.hpp"
+#include "src/ui/views/panelscheduler.hpp"
+
+using std::dynamic_pointer_cast;
+
+namespace sv {
+namespace ui {
+namespace views {
+
+const size_t FrameOverlayView::read_block_size_ = 4096;
+
+FrameOverlayView::FrameOverlayView(Session &session, QUuid uuid,
+		QWidget *parent) :
+	BaseView(session, uuid, parent),
+	channel_(nullptr),
+	signal_(nullptr),
+	time_axis_(false)
+{
+	id_ = "frameoverlay:" + util::format_uuid(uuid_);
+	values_.resize(read_block_size_);
+
+	setup_ui();
+	setup_toolbar();
+	init_curves();
+
+	session_.panel_scheduler()->add_panel(this, [this]() { on_update(); });
+}
+
+FrameOverlayView::~FrameOverlayView()
+{
+	session_.panel_scheduler()->remove_panel(this);
+	disconnect_signal();
+	if (channel_)
+		channel_->set_frame_capture(false);
+}
+
+QString FrameOverlayView::title() const
+{
+	QString title = tr("Frames");
+	if (channel_)
+		title = title.append(" ").append(channel_->display_name());
+
+	return title;
+}
+
+void FrameOverlayView::set_channel(
+	shared_ptr<sv::channels::HardwareChannel> channel)
+{
+	if (channel_) {
+		disconnect(channel_.get(), nullptr, this, nullptr);
+		channel_->set_frame_capture(false);
+	}
+	disconnect_signal();
+
+	channel_ = channel;
+	channel_->set_frame_capture(true);
+	connect(channel_.get(), &channels::HardwareChannel::frame_signal_added,
+		this, &FrameOverlayView::on_frame_signal_added);
+	// The frame signal is created by the first frame
+	set_signal(channel_->frame_signal());
+
+	Q_EMIT title_changed();
+}
+
+void FrameOverlayView::set_signal(
+	shared_ptr<sv::data::AnalogSegmentSignal> signal)
+{
+	disconnect_signal();
+	signal_ = signal;
+	if (!signal_)
+		return;
+
+	plot_->setAxisTitle(QwtPlot::yLeft, signal_->unit_name());
+	connect(signal_.get(), &data::AnalogSegmentSignal::samples_appended,
+		this, &FrameOverlayView::on_samples_changed);
+	connect(signal_.get(), &data::AnalogSegmentSignal::samples_cleared,
+		this, &FrameOverlayView::on_samples_changed);
+	session_.panel_scheduler()->set_changed(this);
+}
+
+void FrameOverlayView::disconnect_signal()
+{
+	if (signal_)
+		disconnect(signal_.get(), nullptr, this, nullptr);
+	signal_ = nullptr;
+}
+
+void FrameOverlayView::setup_ui()
+{
+	QVBoxLayout *layout = new QVBoxLayout();
+
+	plot_ = new QwtPlot();
+	plot_->setAxisTitle(QwtPlot::xBottom, tr("Sample"));
+	QwtPlotGrid *grid = new QwtPlotGrid();
+	grid->setMajorPen(QPen(Qt::gray, 0, Qt::DotLine));
+	grid->attach(plot_);
+	layout->addWidget(plot_);
+
+	this->central_widget_->setLayout(layout);
+}
+
+void FrameOverlayView::setup_toolbar()
+{
+	frame_count_box_ = new QComboBox();
+	for (uint count = 1; count <= 64; count *= 2)
+		frame_count_box_->addItem(QString::number(count), QVariant(count));
+	frame_count_box_->setCurrentIndex(
+		frame_count_box_->findData(QVariant(8u)));
+	frame_count_box_->setToolTip(tr("Number of overlaid frames"));
+	connect(frame_count_box_, SIGNAL(currentIndexChanged(int)),
+		this, SLOT(on_frame_count_changed()));
+
+	toolbar_ = new QToolBar("Frame Overlay Toolbar");
+	toolbar_->addWidget(frame_count_box_);
+	this->addToolBar(Qt::TopToolBarArea, toolbar_);
+}
+
+void FrameOverlayView::init_curves()
+{
+	for (auto curve : curves_) {
+		curve->detach();
+		delete curve;
+	}
+	curves_.clear();
+
+	// The older frames fade out
+	const size_t count = frame_count_box_->currentData().toUInt();
+	for (size_t i = 0; i < count; ++i) {
+		const int alpha = std::max(32, (int)(255 * (i + 1) / count));
+		QwtPlotCurve *curve = new QwtPlotCurve();
+		curve->setPen(QPen(QColor(0, 0, 255, alpha)));
+		curve->attach(plot_);
+		curves_.push_back(curve);
+	}
+}
+
+bool FrameOverlayView::read_frame(size_t frame_pos,
+	const sv::data::AnalogFrame &frame)
+{
+	points_.clear();
+	const double time_stride =
+		frame.samplerate > 0 ? 1. / (double)frame.samplerate : 1.;
+
+	// Draw at most the minimum and the maximum per pixel column
+	const size_t columns = (size_t)std::max(plot_->canvas()->width(), 1);
+	const size_t bucket_size = frame.sample_count > 2 * columns ?
+		(frame.sample_count + columns - 1) / columns : 1;
+	double min = std::numeric_limits<double>::infinity();
+	double max = -std::numeric_limits<double>::infinity();
+
+	size_t offset = 0;
+	while (offset < frame.sample_count) {
+		const size_t count = signal_->copy_frame_values(frame_pos, offset,
+			read_block_size_, values_.data());
+		if (count == 0)
+			return false;
+
+		for (size_t i = 0; i < count; ++i) {
+			const size_t pos = offset + i;
+			const double value = values_[i];
+			if (bucket_size == 1) {
+				points_.push_back(QPointF(pos * time_stride, value));
+				continue;
+			}
+			min = std::min(min, value);
+			max = std::max(max, value);
+			if ((pos + 1) % bucket_size == 0 || pos + 1 == frame.sample_count) {
+				const double x = (pos / bucket_size) * bucket_size * time_stride;
+				points_.push_back(QPointF(x, min));
+				points_.push_back(QPointF(x, max));
+				min = std::numeric_limits<double>::infinity();
+				max = -std::numeric_limits<double>::infinity();
+			}
+		}
+		offset += count;
+	}
+	return true;
+}
+
+void FrameOverlayView::on_update()
+{
+	if (!signal_)
+		return;
+
+	// The newest frame is drawn by the last curve
+	const size_t frame_end = signal_->frame_count();
+	const size_t frame_begin = std::max(signal_->first_frame_pos(),
+		frame_end > curves_.size() ? frame_end - curves_.size() : 0);
+	const size_t curve_offset = curves_.size() - (frame_end - frame_begin);
+	bool time_axis = false;
+	for (size_t i = 0; i < curves_.size(); ++i) {
+		data::AnalogFrame frame;
+		const size_t frame_pos = frame_begin + i - curve_offset;
+		if (i < curve_offset || !signal_->get_frame(frame_pos, frame) ||
+				!read_frame(frame_pos, frame)) {
+			curves_[i]->setSamples(QVector<QPointF>());
+			continue;
+		}
+		curves_[i]->setSamples(points_);
+		time_axis = frame.samplerate > 0;
+	}
+
+	if (time_axis != time_axis_) {
+		time_axis_ = time_axis;
+		plot_->setAxisTitle(QwtPlot::xBottom,
+			time_axis_ ? tr("Time [s]") : tr("Sample"));
+	}
+	plot_->replot();
+}
+
+void FrameOverlayView::save_settings(QSettings &settings,
+	shared_ptr<sv::devices::BaseDevice> origin_device) const
+{
+	BaseView::save_settings(settings, origin_device);
+
+	if (channel_)
+		SettingsManager::save_channel(channel_, settings, origin_device);
+	settings.setValue("frame_count", frame_count_box_->currentData());
+}
+
+void FrameOverlayView::restore_settings(QSettings &settings,
+	shared_ptr<sv::devices::BaseDevice> origin_device)
+{
+	BaseView::restore_settings(settings, origin_device);
+
+	if (settings.contains("frame_count")) {
+		int index = frame_count_box_->findData(settings.value("frame_count"));
+		if (index >= 0) {
+			frame_count_box_->blockSignals(true);
+			frame_count_box_->setCurrentIndex(index);
+			frame_count_box_->blockSignals(false);
+			init_curves();
+		}
+	}
+
+	auto channel = dynamic_pointer_cast<sv::channels::HardwareChannel>(
+		SettingsManager::restore_channel(session_, settings, origin_device));
+	if (channel)
+		set_channel(channel);
+}
+
+void FrameOverlayView::on_frame_signal_added()
+{
+	if (channel_ && !signal_)
+		set_signal(channel_->frame_signal());
+}
+
+void FrameOverlayView::on_frame_count_changed()
+{
+	init_curves();
+	session_.panel_scheduler()->set_changed(this);
+}
+
+void FrameOverlayView::on_samples_changed()
+{
+	session_.panel_scheduler()->set_changed(this);
+}
+
+} // namespace views
+} // namespace ui
+} // namespace sv
@@ -0,0 +1,129 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_VIEWS_FRAMEOVERLAYVIEW_HPP
+#define UI_VIEWS_FRAMEOVERLAYVIEW_HPP
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <QComboBox>
+#include <QPointF>
+#include <QSettings>
+#include <QToolBar>
+#include <QUuid>
+#include <QVector>
+
+#include "src/ui/views/baseview.hpp"
+
+using std::shared_ptr;
+using std::vector;
+
+class QwtPlot;
+class QwtPlotCurve;
+
+namespace sv {
+
+class Session;
+
+namespace channels {
+class HardwareChannel;
+}
+namespace data {
+class AnalogSegmentSignal;
+struct AnalogFrame;
+}
+namespace devices {
+class BaseDevice;
+}
+
+namespace ui {
+namespace views {
+
+/**
+ * Shows the last frames of a scope like channel on top of each other, like
+ * the persistence mode of a scope. The newest frame is drawn opaque, the
+ * older frames fade out. The x axis is the time since the begin of the
+ * frame.
+ *
+ * The view enables the frame capture of the channel, the frames are read
+ * from the data::AnalogSegmentSignal of the channel. Big frames are reduced
+ * to the minimum and the maximum per pixel column.
+ */
+class FrameOverlayView : public BaseView
+{
+	Q_OBJECT
+
+public:
+	explicit FrameOverlayView(Session& session, QUuid uuid = QUuid(),
+		QWidget* parent = nullptr);
+	~FrameOverlayView();
+
+	QString title() const override;
+	void set_channel(shared_ptr<sv::channels::HardwareChannel> channel);
+
+	void save_settings(QSettings &settings,
+		shared_ptr<sv::devices::BaseDevice> origin_device = nullptr) const override;
+	void restore_settings(QSettings &settings,
+		shared_ptr<sv::devices::BaseDevice> origin_device = nullptr) override;
+
+private:
+	shared_ptr<sv::channels::HardwareChannel> channel_;
+	shared_ptr<sv::data::AnalogSegmentSignal> signal_;
+	/** Reused buffer for reading the values of a frame. */
+	vector<double> values_;
+	QVector<QPointF> points_;
+
+	QComboBox *frame_count_box_;
+	QToolBar *toolbar_;
+	QwtPlot *plot_;
+	/** One curve per overlaid frame, the newest frame is the last curve. */
+	vector<QwtPlotCurve *> curves_;
+	bool time_axis_;
+
+	/** Values, that are read from the signal at once. */
+	static const size_t read_block_size_;
+
+	void setup_ui();
+	void setup_toolbar();
+	void set_signal(shared_ptr<sv::data::AnalogSegmentSignal> signal);
+	void disconnect_signal();
+	/** (Re)create the curves for the selected number of frames. */
+	void init_curves();
+	/**
+	 * Fill points_ with the values of the frame. Returns false if the frame
+	 * was dropped meanwhile.
+	 */
+	bool read_frame(size_t frame_pos, const sv::data::AnalogFrame &frame);
+	/** Draw the frames, called by the PanelScheduler. */
+	void on_update();
+
+private Q_SLOTS:
+	void on_frame_signal_added();
+	void on_frame_count_changed();
+	void on_samples_changed();
+
+};
+
+} // namespace views
+} // namespace ui
+} // namespace sv
+
+#endif // UI_VIEWS_FRAMEOVERLAYVIEW_HPP
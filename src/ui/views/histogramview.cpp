@@ -0,0 +1,264 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <memory>
+
+#include <QBrush>
+#include <QColor>
+#include <QDebug>
+#include <QPen>
+#include <QSettings>
+#include <QString>
+#include <QUuid>
+#include <QVariant>
+#include <QVBoxLayout>
+#include <QVector>
+#include <qwt_interval.h>
+#include <qwt_plot.h>
+#include <qwt_plot_grid.h>
+#include <qwt_plot_histogram.h>
+#include <qwt_samples.h>
+
+#include "histogramview.hpp"
+#include "src/session.hpp"
+#include "src/settingsmanager.hpp"
+#include "src/util.hpp"
+#include "src/workerpool.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/histogramanalyzer.hpp"
+#include "src/data/valuehistogram.hpp"
+#include "src/devices/basedevice.hpp"
+#include "src/ui/views/baseview.hpp"
+#include "src/ui/views/panelscheduler.hpp"
+
+using std::dynamic_pointer_cast;
+
+namespace sv {
+namespace ui {
+namespace views {
+
+HistogramView::HistogramView(Session &session, QUuid uuid, QWidget *parent) :
+	BaseView(session, uuid, parent),
+	signal_(nullptr),
+	analyzer_(nullptr),
+	action_reset_(new QAction(this))
+{
+	id_ = "histogram:" + util::format_uuid(uuid_);
+
+	setup_ui();
+	setup_toolbar();
+
+	session_.panel_scheduler()->add_panel(this, [this]() { on_update(); });
+}
+
+HistogramView::~HistogramView()
+{
+	session_.panel_scheduler()->remove_panel(this);
+	delete_analyzer();
+}
+
+QString HistogramView::title() const
+{
+	QString title = tr("Histogram");
+	if (signal_)
+		title = title.append(" ").append(signal_->display_name());
+
+	return title;
+}
+
+void HistogramView::set_signal(shared_ptr<sv::data::AnalogTimeSignal> signal)
+{
+	signal_ = signal;
+	plot_->setAxisTitle(QwtPlot::xBottom, signal_->unit_name());
+	init_analyzer();
+
+	Q_EMIT title_changed();
+}
+
+void HistogramView::setup_ui()
+{
+	QVBoxLayout *layout = new QVBoxLayout();
+
+	plot_ = new QwtPlot();
+	plot_->setAxisTitle(QwtPlot::yLeft, tr("Count"));
+	QwtPlotGrid *grid = new QwtPlotGrid();
+	grid->setMajorPen(QPen(Qt::gray, 0, Qt::DotLine));
+	grid->attach(plot_);
+	plot_histogram_ = new QwtPlotHistogram();
+	plot_histogram_->setStyle(QwtPlotHistogram::Columns);
+	plot_histogram_->setPen(QPen(Qt::blue));
+	plot_histogram_->setBrush(QBrush(QColor(0, 0, 255, 96)));
+	plot_histogram_->attach(plot_);
+	layout->addWidget(plot_);
+
+	statistics_label_ = new QLabel();
+	statistics_label_->setTextInteractionFlags(Qt::TextSelectableByMouse);
+	layout->addWidget(statistics_label_);
+
+	this->central_widget_->setLayout(layout);
+}
+
+void HistogramView::setup_toolbar()
+{
+	bin_count_box_ = new QComboBox();
+	for (uint count = 32; count <= 2048; count *= 2)
+		bin_count_box_->addItem(QString::number(count), QVariant(count));
+	bin_count_box_->setCurrentIndex(bin_count_box_->findData(QVariant(256u)));
+	bin_count_box_->setToolTip(tr("Number of bins"));
+	connect(bin_count_box_, SIGNAL(currentIndexChanged(int)),
+		this, SLOT(on_settings_changed()));
+
+	action_reset_->setText(tr("Reset histogram"));
+	action_reset_->setIcon(
+		QIcon::fromTheme("view-refresh",
+		QIcon(":/icons/view-refresh.png")));
+	connect(action_reset_, &QAction::triggered,
+		this, &HistogramView::on_action_reset_triggered);
+
+	toolbar_ = new QToolBar("Histogram Toolbar");
+	toolbar_->addWidget(bin_count_box_);
+	toolbar_->addSeparator();
+	toolbar_->addAction(action_reset_);
+	this->addToolBar(Qt::TopToolBarArea, toolbar_);
+}
+
+void HistogramView::init_analyzer()
+{
+	delete_analyzer();
+	if (!signal_)
+		return;
+
+	analyzer_ = new data::HistogramAnalyzer(signal_,
+		bin_count_box_->currentData().toUInt());
+	connect(analyzer_, &data::HistogramAnalyzer::histogram_updated,
+		this, &HistogramView::on_histogram_updated);
+
+	if (Session::worker_pool)
+		Session::worker_pool->move_to_worker(analyzer_);
+
+	// Count the samples, that are already in the signal
+	QMetaObject::invokeMethod(analyzer_, "on_samples_appended",
+		Qt::QueuedConnection);
+}
+
+void HistogramView::delete_analyzer()
+{
+	if (!analyzer_)
+		return;
+
+	// The analyzer may be busy in its worker thread
+	disconnect(analyzer_, nullptr, this, nullptr);
+	analyzer_->deleteLater();
+	analyzer_ = nullptr;
+}
+
+void HistogramView::on_update()
+{
+	if (!analyzer_)
+		return;
+
+	analyzer_->histogram(histogram_);
+
+	// Only draw the bins between the smallest and the biggest value, the
+	// range of the histogram can be up to twice as big.
+	QVector<QwtIntervalSample> samples;
+	size_t first;
+	size_t last;
+	if (histogram_.used_bins(first, last)) {
+		const auto &bins = histogram_.bins();
+		const double bin_width = histogram_.bin_width();
+		samples.reserve((int)(last - first + 1));
+		for (size_t bin = first; bin <= last; ++bin) {
+			const double start = histogram_.bin_start(bin);
+			samples.push_back(QwtIntervalSample((double)bins[bin],
+				QwtInterval(start, start + bin_width)));
+		}
+	}
+	plot_histogram_->setSamples(samples);
+	plot_->replot();
+
+	if (histogram_.empty()) {
+		statistics_label_->clear();
+		return;
+	}
+	const QString unit = signal_ ? signal_->unit_name() : QString();
+	const int precision = 6;
+	statistics_label_->setText(
+		tr("n = %1, mean = %2 %7, std. dev. = %3 %7, min = %4 %7, max = %5 %7, "
+			"bin width = %6 %7").
+		arg(histogram_.value_count()).
+		arg(histogram_.mean(), 0, 'g', precision).
+		arg(histogram_.stddev(), 0, 'g', precision).
+		arg(histogram_.min(), 0, 'g', precision).
+		arg(histogram_.max(), 0, 'g', precision).
+		arg(histogram_.bin_width(), 0, 'g', 3).
+		arg(unit));
+}
+
+void HistogramView::save_settings(QSettings &settings,
+	shared_ptr<sv::devices::BaseDevice> origin_device) const
+{
+	BaseView::save_settings(settings, origin_device);
+
+	if (signal_)
+		SettingsManager::save_signal(signal_, settings, origin_device);
+	settings.setValue("bin_count", bin_count_box_->currentData());
+}
+
+void HistogramView::restore_settings(QSettings &settings,
+	shared_ptr<sv::devices::BaseDevice> origin_device)
+{
+	BaseView::restore_settings(settings, origin_device);
+
+	if (settings.contains("bin_count")) {
+		int index = bin_count_box_->findData(settings.value("bin_count"));
+		if (index >= 0) {
+			bin_count_box_->blockSignals(true);
+			bin_count_box_->setCurrentIndex(index);
+			bin_count_box_->blockSignals(false);
+		}
+	}
+
+	auto signal = dynamic_pointer_cast<sv::data::AnalogTimeSignal>(
+		SettingsManager::restore_signal(session_, settings, origin_device));
+	if (signal)
+		set_signal(signal);
+}
+
+void HistogramView::on_settings_changed()
+{
+	init_analyzer();
+}
+
+void HistogramView::on_action_reset_triggered()
+{
+	if (analyzer_)
+		QMetaObject::invokeMethod(analyzer_, "reset", Qt::QueuedConnection);
+}
+
+void HistogramView::on_histogram_updated()
+{
+	session_.panel_scheduler()->set_changed(this);
+}
+
+} // namespace views
+} // namespace ui
+} // namespace sv
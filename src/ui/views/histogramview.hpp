@@ -0,0 +1,110 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_VIEWS_HISTOGRAMVIEW_HPP
+#define UI_VIEWS_HISTOGRAMVIEW_HPP
+
+#include <memory>
+
+#include <QAction>
+#include <QComboBox>
+#include <QLabel>
+#include <QSettings>
+#include <QToolBar>
+#include <QUuid>
+
+#include "src/data/valuehistogram.hpp"
+#include "src/ui/views/baseview.hpp"
+
+using std::shared_ptr;
+
+class QwtPlot;
+class QwtPlotHistogram;
+
+namespace sv {
+
+class Session;
+
+namespace data {
+class AnalogTimeSignal;
+class HistogramAnalyzer;
+}
+namespace devices {
+class BaseDevice;
+}
+
+namespace ui {
+namespace views {
+
+/**
+ * Shows the distribution of the values of a signal, e.g. for noise and
+ * stability measurements. The histogram is counted incrementally by a
+ * data::HistogramAnalyzer in a worker thread and redrawn with the ticks of
+ * the PanelScheduler.
+ */
+class HistogramView : public BaseView
+{
+	Q_OBJECT
+
+public:
+	explicit HistogramView(Session& session, QUuid uuid = QUuid(),
+		QWidget* parent = nullptr);
+	~HistogramView();
+
+	QString title() const override;
+	void set_signal(shared_ptr<sv::data::AnalogTimeSignal> signal);
+
+	void save_settings(QSettings &settings,
+		shared_ptr<sv::devices::BaseDevice> origin_device = nullptr) const override;
+	void restore_settings(QSettings &settings,
+		shared_ptr<sv::devices::BaseDevice> origin_device = nullptr) override;
+
+private:
+	shared_ptr<sv::data::AnalogTimeSignal> signal_;
+	sv::data::HistogramAnalyzer *analyzer_;
+	/** The copy of the histogram, that is drawn. */
+	sv::data::ValueHistogram histogram_;
+
+	QComboBox *bin_count_box_;
+	QAction *const action_reset_;
+	QToolBar *toolbar_;
+	QwtPlot *plot_;
+	QwtPlotHistogram *plot_histogram_;
+	QLabel *statistics_label_;
+
+	void setup_ui();
+	void setup_toolbar();
+	/** (Re)create the analyzer with the settings from the tool bar. */
+	void init_analyzer();
+	void delete_analyzer();
+	/** Draw the histogram, called by the PanelScheduler. */
+	void on_update();
+
+private Q_SLOTS:
+	void on_settings_changed();
+	void on_action_reset_triggered();
+	void on_histogram_updated();
+
+};
+
+} // namespace views
+} // namespace ui
+} // namespace sv
+
+#endif // UI_VIEWS_HISTOGRAMVIEW_HPP
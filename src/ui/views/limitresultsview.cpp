@@ -0,0 +1,185 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <QBrush>
+#include <QColor>
+#include <QHeaderView>
+#include <QLabel>
+#include <QString>
+#include <QStringList>
+#include <QTreeWidget>
+#include <QTreeWidgetItem>
+#include <QUuid>
+#include <QVBoxLayout>
+
+#include "limitresultsview.hpp"
+#include "src/session.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/limitengine.hpp"
+#include "src/ui/views/baseview.hpp"
+#include "src/ui/views/panelscheduler.hpp"
+
+using std::shared_ptr;
+using std::vector;
+
+namespace sv {
+namespace ui {
+namespace views {
+
+namespace {
+
+QString format_value(double value)
+{
+	return std::isnan(value) ? QString("-") : QString::number(value, 'g', 7);
+}
+
+}
+
+const size_t LimitResultsView::max_shown_steps_ = 100;
+
+LimitResultsView::LimitResultsView(Session &session, QUuid uuid,
+		QWidget *parent) :
+	BaseView(session, uuid, parent)
+{
+	// There is only one limit results view
+	id_ = "limitresults:";
+
+	setup_ui();
+
+	session_.panel_scheduler()->add_panel(this, [this]() { on_update(); });
+	connect(&session_, &Session::limit_engines_changed,
+		this, &LimitResultsView::on_limit_engines_changed);
+	on_limit_engines_changed();
+}
+
+LimitResultsView::~LimitResultsView()
+{
+	session_.panel_scheduler()->remove_panel(this);
+}
+
+QString LimitResultsView::title() const
+{
+	return tr("Limit Test Results");
+}
+
+void LimitResultsView::setup_ui()
+{
+	QVBoxLayout *layout = new QVBoxLayout();
+
+	summary_label_ = new QLabel();
+	summary_label_->setWordWrap(true);
+	layout->addWidget(summary_label_);
+
+	tree_ = new QTreeWidget();
+	tree_->setColumnCount(7);
+	tree_->setHeaderLabels(QStringList() << tr("Step / Rule") <<
+		tr("Result") << tr("Samples") << tr("Failures") << tr("Min") <<
+		tr("Max") << tr("First failure"));
+	tree_->setSelectionMode(QAbstractItemView::NoSelection);
+	tree_->header()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
+	layout->addWidget(tree_);
+
+	this->central_widget_->setLayout(layout);
+}
+
+void LimitResultsView::wake()
+{
+	// Show the results, that were added while the view was hidden
+	session_.panel_scheduler()->set_changed(this);
+}
+
+void LimitResultsView::set_result(QTreeWidgetItem *item, bool finished,
+	bool passed)
+{
+	if (!finished) {
+		item->setText(1, tr("Running"));
+		return;
+	}
+	item->setText(1, passed ? tr("Pass") : tr("Fail"));
+	item->setForeground(1, QBrush(passed ? QColor(0, 128, 0) : Qt::red));
+}
+
+void LimitResultsView::on_update()
+{
+	if (is_hibernated())
+		return;
+
+	// The tree is rebuilt, only the latest steps are shown
+	tree_->clear();
+	size_t finished_count = 0;
+	size_t passed_count = 0;
+	for (const auto &engine : session_.limit_engines()) {
+		QTreeWidgetItem *engine_item = new QTreeWidgetItem(tree_,
+			QStringList() << engine->signal()->display_name());
+		const size_t step_count = engine->step_count();
+		const size_t first_step = step_count > max_shown_steps_ ?
+			step_count - max_shown_steps_ : 0;
+		for (const auto &step : engine->results(first_step)) {
+			QTreeWidgetItem *step_item = new QTreeWidgetItem(engine_item,
+				QStringList() << QString::fromStdString(step.name));
+			set_result(step_item, step.finished, step.passed);
+			if (step.finished) {
+				++finished_count;
+				if (step.passed)
+					++passed_count;
+			}
+
+			for (const auto &rule : step.rules) {
+				QTreeWidgetItem *rule_item = new QTreeWidgetItem(step_item,
+					QStringList() << QString::fromStdString(rule.name));
+				set_result(rule_item, step.finished, rule.passed);
+				rule_item->setText(2, QString::number(rule.sample_count));
+				rule_item->setText(3, QString::number(rule.failure_count));
+				rule_item->setText(4, format_value(rule.min));
+				rule_item->setText(5, format_value(rule.max));
+				rule_item->setText(6, format_value(rule.first_failure_value));
+			}
+			// Only the failed steps are expanded
+			step_item->setExpanded(step.finished && !step.passed);
+		}
+		engine_item->setExpanded(true);
+	}
+
+	summary_label_->setText(tr("%1 of %2 steps passed").
+		arg(passed_count).arg(finished_count));
+	summary_label_->setStyleSheet(passed_count < finished_count ?
+		"QLabel { color: red; }" : "");
+}
+
+void LimitResultsView::on_limit_engines_changed()
+{
+	for (const auto &engine : session_.limit_engines()) {
+		if (connected_engines_.count(engine.get()) > 0)
+			continue;
+		connected_engines_.insert(engine.get());
+		connect(engine.get(), &data::LimitEngine::results_changed,
+			this, [this]() { session_.panel_scheduler()->set_changed(this); });
+	}
+	session_.panel_scheduler()->set_changed(this);
+}
+
+} // namespace views
+} // namespace ui
+} // namespace sv
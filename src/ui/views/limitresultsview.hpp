@@ -0,0 +1,90 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_VIEWS_LIMITRESULTSVIEW_HPP
+#define UI_VIEWS_LIMITRESULTSVIEW_HPP
+
+#include <cstddef>
+#include <memory>
+#include <set>
+
+#include <QLabel>
+#include <QString>
+#include <QTreeWidget>
+#include <QUuid>
+
+#include "src/ui/views/baseview.hpp"
+
+using std::set;
+using std::shared_ptr;
+
+namespace sv {
+
+class Session;
+
+namespace data {
+class LimitEngine;
+}
+
+namespace ui {
+namespace views {
+
+/**
+ * Shows the pass/fail results of the test steps of all limit engines of the
+ * session, see data::LimitEngine. The view is updated by the PanelScheduler,
+ * when an engine reports new results.
+ */
+class LimitResultsView : public BaseView
+{
+	Q_OBJECT
+
+public:
+	explicit LimitResultsView(Session &session, QUuid uuid = QUuid(),
+		QWidget *parent = nullptr);
+	~LimitResultsView();
+
+	QString title() const override;
+
+protected:
+	void wake() override;
+
+private:
+	void setup_ui();
+	/** Called by the PanelScheduler for new results. */
+	void on_update();
+	static void set_result(QTreeWidgetItem *item, bool finished, bool passed);
+
+	/** Only the latest steps of every engine are shown. */
+	static const size_t max_shown_steps_;
+
+	QLabel *summary_label_;
+	QTreeWidget *tree_;
+	/** The engines, whose results are already connected. */
+	set<data::LimitEngine *> connected_engines_;
+
+private Q_SLOTS:
+	void on_limit_engines_changed();
+
+};
+
+} // namespace views
+} // namespace ui
+} // namespace sv
+
+#endif // UI_VIEWS_LIMITRESULTSVIEW_HPP
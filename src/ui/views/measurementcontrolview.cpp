@@ -54,6 +54,10 @@ MeasurementControlView::MeasurementControlView(Session &session,
 	id_ = "measurementcontrol:" + util::format_uuid(uuid_);
 
 	setup_ui();
+
+	// The function and range can be changed at the front panel
+	watch_state(configurable_->get_property(ConfigKey::MeasuredQuantity));
+	watch_state(configurable_->get_property(ConfigKey::Range));
 }
 
 QString MeasurementControlView::title() const
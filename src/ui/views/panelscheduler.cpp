@@ -0,0 +1,140 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include <QTimerEvent>
+
+#include "panelscheduler.hpp"
+#include "src/tracer.hpp"
+
+using std::function;
+using std::vector;
+
+namespace sv {
+namespace ui {
+namespace views {
+
+const int PanelScheduler::tick_interval_ = 250;
+
+PanelScheduler::PanelScheduler(QObject *parent) :
+	QObject(parent),
+	interval_factor_(1),
+	timer_id_(-1)
+{
+}
+
+void PanelScheduler::add_panel(QObject *panel, function<void()> update)
+{
+	for (auto &state : panels_) {
+		if (state.panel == panel) {
+			state.update = update;
+			return;
+		}
+	}
+	panels_.push_back(PanelState{ panel, update, false });
+}
+
+void PanelScheduler::remove_panel(QObject *panel)
+{
+	panels_.erase(std::remove_if(panels_.begin(), panels_.end(),
+		[panel](const PanelState &state) { return state.panel == panel; }),
+		panels_.end());
+}
+
+size_t PanelScheduler::panel_count() const
+{
+	return panels_.size();
+}
+
+void PanelScheduler::set_changed(QObject *panel)
+{
+	for (auto &state : panels_) {
+		if (state.panel == panel) {
+			state.changed = true;
+			break;
+		}
+	}
+	if (timer_id_ < 0)
+		timer_id_ = startTimer(tick_interval());
+}
+
+void PanelScheduler::set_interval_factor(int factor)
+{
+	factor = std::max(1, factor);
+	if (factor == interval_factor_)
+		return;
+	interval_factor_ = factor;
+
+	// Restart a running clock with the new interval
+	if (timer_id_ >= 0) {
+		killTimer(timer_id_);
+		timer_id_ = startTimer(tick_interval());
+	}
+}
+
+int PanelScheduler::interval_factor() const
+{
+	return interval_factor_;
+}
+
+int PanelScheduler::tick_interval() const
+{
+	return tick_interval_ * interval_factor_;
+}
+
+void PanelScheduler::timerEvent(QTimerEvent *event)
+{
+	SV_TRACE_SCOPE("PanelScheduler::tick");
+
+	if (event->timerId() != timer_id_) {
+		QObject::timerEvent(event);
+		return;
+	}
+
+	// An update can add or remove panels, so the changed panels are
+	// collected first.
+	vector<QObject *> changed;
+	for (auto &state : panels_) {
+		if (state.changed) {
+			state.changed = false;
+			changed.push_back(state.panel);
+		}
+	}
+
+	// Stop ticking, until a panel changes again
+	if (changed.empty()) {
+		killTimer(timer_id_);
+		timer_id_ = -1;
+		return;
+	}
+
+	for (const auto &panel : changed) {
+		auto it = std::find_if(panels_.begin(), panels_.end(),
+			[panel](const PanelState &state) { return state.panel == panel; });
+		if (it != panels_.end())
+			it->update();
+	}
+}
+
+} // namespace views
+} // namespace ui
+} // namespace sv
@@ -0,0 +1,96 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_VIEWS_PANELSCHEDULER_HPP
+#define UI_VIEWS_PANELSCHEDULER_HPP
+
+#include <functional>
+#include <vector>
+
+#include <QObject>
+#include <QTimerEvent>
+
+using std::function;
+using std::vector;
+
+namespace sv {
+namespace ui {
+namespace views {
+
+/**
+ * Updates the value panels of a session from one clock in the GUI thread,
+ * instead of a polling timer per panel.
+ *
+ * A panel marks itself as changed, when its signals got new samples (see
+ * AnalogBaseSignal::samples_appended(), which is already coalesced). On the
+ * next tick, all changed panels are updated at once. The clock only ticks
+ * while panels are changed, so idle panels don't wake the GUI thread.
+ */
+class PanelScheduler : public QObject
+{
+	Q_OBJECT
+
+public:
+	explicit PanelScheduler(QObject *parent = nullptr);
+
+	/**
+	 * Register a panel with the function, that updates its displays.
+	 */
+	void add_panel(QObject *panel, function<void()> update);
+	void remove_panel(QObject *panel);
+	size_t panel_count() const;
+
+	/**
+	 * Mark the panel as changed, it is updated with the next tick.
+	 */
+	void set_changed(QObject *panel);
+
+	/**
+	 * Stretch the tick interval by this factor, e.g. while the GUI thread
+	 * falls behind, see LoadGovernor.
+	 */
+	void set_interval_factor(int factor);
+	int interval_factor() const;
+	/** Return the tick interval in milliseconds, including the factor. */
+	int tick_interval() const;
+
+protected:
+	void timerEvent(QTimerEvent *event) override;
+
+private:
+	struct PanelState
+	{
+		QObject *panel;
+		function<void()> update;
+		bool changed;
+	};
+
+	static const int tick_interval_;
+
+	vector<PanelState> panels_;
+	int interval_factor_;
+	int timer_id_;
+
+};
+
+} // namespace views
+} // namespace ui
+} // namespace sv
+
+#endif // UI_VIEWS_PANELSCHEDULER_HPP
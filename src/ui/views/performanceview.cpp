@@ -0,0 +1,546 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <QAbstractItemView>
+#include <QBrush>
+#include <QElapsedTimer>
+#include <QFont>
+#include <QHeaderView>
+#include <QLabel>
+#include <QString>
+#include <QStringList>
+#include <QTreeWidget>
+#include <QTreeWidgetItem>
+#include <QUuid>
+#include <QVBoxLayout>
+
+#include "performanceview.hpp"
+#include "src/allocationcounter.hpp"
+#include "src/loadgovernor.hpp"
+#include "src/session.hpp"
+#include "src/watchdog.hpp"
+#include "src/data/basesignal.hpp"
+#include "src/data/signalregistry.hpp"
+#include "src/devices/acquisitionstatistics.hpp"
+#include "src/devices/basedevice.hpp"
+#include "src/devices/hardwaredevice.hpp"
+#include "src/python/smuscriptrunner.hpp"
+#include "src/ui/views/baseview.hpp"
+#include "src/ui/views/plotprofilerview.hpp"
+#include "src/ui/widgets/plot/plot.hpp"
+#include "src/ui/widgets/plot/plotprofiler.hpp"
+#include "src/ui/widgets/plot/plotscheduler.hpp"
+
+using std::dynamic_pointer_cast;
+using std::make_pair;
+using std::pair;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace ui {
+namespace views {
+
+namespace {
+
+QString format_memory(size_t bytes)
+{
+	return QString("%1 MiB").arg((double)bytes / (1 << 20), 0, 'f', 1);
+}
+
+QString format_ms(double ms)
+{
+	return QString::number(ms, 'f', 2);
+}
+
+}
+
+const int PerformanceView::update_interval_ = 1000;
+const int PerformanceView::probe_interval_ = 20;
+const double PerformanceView::max_event_loop_latency_ = 100.;
+
+PerformanceView::PerformanceView(Session &session, QUuid uuid,
+		QWidget *parent) :
+	BaseView(session, uuid, parent),
+	last_probe_time_(-1),
+	probe_latency_sum_(0.),
+	probe_latency_max_(0.),
+	probe_count_(0),
+	last_stall_count_(0),
+	last_global_counts_(AllocationCounter::global_counts()),
+	last_global_counts_time_(0)
+{
+	// There is only one performance view
+	id_ = "performance:";
+
+	setup_ui();
+
+	connect(&update_timer_, &QTimer::timeout,
+		this, &PerformanceView::update_view);
+	probe_timer_.setTimerType(Qt::PreciseTimer);
+	connect(&probe_timer_, &QTimer::timeout,
+		this, &PerformanceView::on_probe_timeout);
+	probe_clock_.start();
+	update_timer_.start(update_interval_);
+	probe_timer_.start(probe_interval_);
+}
+
+QString PerformanceView::title() const
+{
+	return tr("Performance");
+}
+
+void PerformanceView::setup_ui()
+{
+	QVBoxLayout *layout = new QVBoxLayout();
+
+	bottleneck_label_ = new QLabel();
+	bottleneck_label_->setWordWrap(true);
+	layout->addWidget(bottleneck_label_);
+
+	tree_ = new QTreeWidget();
+	tree_->setColumnCount(2);
+	tree_->setHeaderLabels(QStringList() << tr("Metric") << tr("Value"));
+	tree_->setSelectionMode(QAbstractItemView::NoSelection);
+	tree_->header()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
+	layout->addWidget(tree_);
+
+	event_loop_item_ = new QTreeWidgetItem(tree_,
+		QStringList() << tr("GUI event loop"));
+	devices_item_ = new QTreeWidgetItem(tree_, QStringList() << tr("Devices"));
+	plots_item_ = new QTreeWidgetItem(tree_, QStringList() << tr("Plots"));
+	signals_item_ = new QTreeWidgetItem(tree_, QStringList() << tr("Signals"));
+	allocations_item_ = new QTreeWidgetItem(tree_,
+		QStringList() << tr("Allocations"));
+	scripts_item_ = new QTreeWidgetItem(tree_, QStringList() << tr("Scripts"));
+	tree_->expandAll();
+
+	this->central_widget_->setLayout(layout);
+}
+
+void PerformanceView::hibernate()
+{
+	update_timer_.stop();
+	probe_timer_.stop();
+}
+
+void PerformanceView::wake()
+{
+	last_probe_time_ = -1;
+	probe_timer_.start(probe_interval_);
+	update_timer_.start(update_interval_);
+}
+
+void PerformanceView::on_probe_timeout()
+{
+	const qint64 now = probe_clock_.nsecsElapsed();
+	if (last_probe_time_ >= 0) {
+		const double latency = std::max(0.,
+			(double)(now - last_probe_time_) / 1e6 - probe_interval_);
+		probe_latency_sum_ += latency;
+		probe_latency_max_ = std::max(probe_latency_max_, latency);
+		++probe_count_;
+	}
+	last_probe_time_ = now;
+}
+
+void PerformanceView::update_view()
+{
+	// Don't collect the metrics, while nobody looks at them
+	if (!this->isVisible())
+		return;
+
+	used_items_.clear();
+	bottlenecks_.clear();
+
+	update_event_loop();
+	update_devices();
+	update_plots();
+	update_signals();
+	update_allocations();
+	update_scripts();
+
+	for (int i = 0; i < tree_->topLevelItemCount(); ++i)
+		remove_unused_items(tree_->topLevelItem(i));
+
+	if (bottlenecks_.isEmpty()) {
+		bottleneck_label_->setText(tr("No bottleneck found."));
+		bottleneck_label_->setStyleSheet("");
+	}
+	else {
+		bottleneck_label_->setText(
+			tr("Bottleneck: %1").arg(bottlenecks_.join("; ")));
+		bottleneck_label_->setStyleSheet("QLabel { color: red; }");
+	}
+}
+
+void PerformanceView::update_event_loop()
+{
+	const double mean_latency = probe_count_ > 0 ?
+		probe_latency_sum_ / (double)probe_count_ : 0.;
+	const bool slow = probe_latency_max_ > max_event_loop_latency_;
+	set_metric(event_loop_item_, tr("Mean latency [ms]"),
+		format_ms(mean_latency));
+	set_metric(event_loop_item_, tr("Max. latency [ms]"),
+		format_ms(probe_latency_max_), slow);
+
+	// The stalls of the GUI thread, with the trace scope, in that they
+	// happened
+	const Watchdog *watchdog = session_.watchdog();
+	const size_t stall_count = watchdog->stall_count();
+	const bool new_stalls = stall_count > last_stall_count_;
+	last_stall_count_ = stall_count;
+	if (watchdog->is_running()) {
+		set_metric(event_loop_item_,
+			tr("Stalls > %1 ms").arg(watchdog->threshold()),
+			QString::number(stall_count), new_stalls);
+		const vector<Stall> stalls = watchdog->stalls();
+		if (!stalls.empty()) {
+			const Stall &stall = stalls.back();
+			const QString scope = stall.scope.empty() ?
+				tr("no trace scope") : QString::fromStdString(stall.scope);
+			set_metric(event_loop_item_, tr("Last stall"),
+				tr("%1 ms in %2").arg(stall.duration * 1e3, 0, 'f', 0).
+					arg(scope), new_stalls);
+			if (new_stalls) {
+				bottlenecks_ << tr("The GUI thread was blocked for %1 ms "
+					"in %2").arg(stall.duration * 1e3, 0, 'f', 0).arg(scope);
+			}
+		}
+	}
+
+	// The GUI updates are coarsened, while the load level is raised
+	const LoadGovernor *load_governor = session_.load_governor();
+	const bool degraded = load_governor->level() > 0;
+	if (load_governor->is_running()) {
+		set_metric(event_loop_item_, tr("Load level"),
+			tr("%1 of %2").arg(load_governor->level()).
+				arg(LoadGovernor::max_level()), degraded);
+		if (degraded) {
+			bottlenecks_ << tr("The GUI updates are slowed down by %1x").
+				arg(load_governor->interval_factor());
+		}
+	}
+
+	set_warning(event_loop_item_, slow || new_stalls || degraded);
+	if (slow && !new_stalls) {
+		bottlenecks_ << tr("The GUI event loop was blocked for %1 ms").
+			arg(probe_latency_max_, 0, 'f', 0);
+	}
+
+	probe_latency_sum_ = 0.;
+	probe_latency_max_ = 0.;
+	probe_count_ = 0;
+}
+
+void PerformanceView::update_devices()
+{
+	for (const auto &device_pair : session_.device_map()) {
+		auto hw_device = dynamic_pointer_cast<sv::devices::HardwareDevice>(
+			device_pair.second);
+		if (!hw_device)
+			continue;
+
+		const string id = hw_device->id();
+		const sv::devices::AcquisitionSummary summary =
+			hw_device->acquisition_summary();
+		const size_t config_writes = hw_device->queued_config_write_count();
+
+		// Only new overruns and a growing backlog point to a bottleneck
+		const bool has_last = last_summaries_.count(id) > 0;
+		const sv::devices::AcquisitionSummary last =
+			has_last ? last_summaries_[id] : summary;
+		const bool dropping =
+			summary.dropped_packet_count > last.dropped_packet_count;
+		const bool config_backlog = config_writes > 0 &&
+			last_config_write_counts_.count(id) > 0 &&
+			config_writes > last_config_write_counts_[id];
+		last_summaries_[id] = summary;
+		last_config_write_counts_[id] = config_writes;
+
+		// The allocations of the last interval, in the steady state there
+		// should be none
+		const uint64_t packets = summary.packet_count - last.packet_count;
+		const uint64_t samples = summary.sample_count - last.sample_count;
+		const uint64_t allocations =
+			summary.allocation_count - last.allocation_count;
+		const uint64_t allocated_bytes =
+			summary.allocated_bytes - last.allocated_bytes;
+
+		// The latency, that 99 % of the packets are below
+		uint64_t total = 0;
+		for (const auto count : summary.latency_histogram)
+			total += count;
+		size_t p99_bucket = 0;
+		uint64_t cumulated = 0;
+		for (; p99_bucket < summary.latency_histogram.size(); ++p99_bucket) {
+			cumulated += summary.latency_histogram[p99_bucket];
+			if ((double)cumulated >= 0.99 * (double)total)
+				break;
+		}
+		const double p99_latency = sv::devices::AcquisitionStatistics::
+			latency_bucket_limit(p99_bucket) * 1e3;
+
+		const QString name = hw_device->short_name();
+		QTreeWidgetItem *device_item = item(devices_item_, name);
+		set_metric(device_item, tr("Samples/s"),
+			QString::number(summary.samples_per_second, 'f', 0));
+		set_metric(device_item, tr("Packets/s"),
+			QString::number(summary.packets_per_second, 'f', 1));
+		set_metric(device_item, tr("Ingest queue"),
+			tr("%1 (max. %2)").arg(summary.queue_depth).
+				arg(summary.queue_high_water));
+		set_metric(device_item, tr("Dropped packets"),
+			QString::number(summary.dropped_packet_count), dropping);
+		set_metric(device_item, tr("Out of order packets"),
+			QString::number(summary.out_of_order_packet_count));
+		set_metric(device_item, tr("Max. feed time [ms]"),
+			format_ms(summary.max_feed_time * 1e3));
+		set_metric(device_item, tr("Latency (99 %) [ms]"), total == 0 ?
+			QString("-") : std::isinf(p99_latency) ?
+				QString("> %1").arg(format_ms(sv::devices::AcquisitionStatistics::
+					latency_bucket_limit(p99_bucket - 1) * 1e3)) :
+				QString("< %1").arg(format_ms(p99_latency)));
+		set_metric(device_item, tr("Allocations/packet"), packets == 0 ?
+			QString("-") :
+			QString::number((double)allocations / (double)packets, 'f', 2));
+		set_metric(device_item, tr("Allocated bytes/sample"), samples == 0 ?
+			QString("-") :
+			QString::number((double)allocated_bytes / (double)samples, 'f', 1));
+		set_metric(device_item, tr("Queued config writes"),
+			QString::number(config_writes), config_backlog);
+		set_warning(device_item, dropping || config_backlog);
+
+		if (dropping)
+			bottlenecks_ << tr("%1 drops packets").arg(name);
+		if (config_backlog)
+			bottlenecks_ << tr("%1 can't keep up with the config writes").
+				arg(name);
+	}
+}
+
+void PerformanceView::update_plots()
+{
+	auto *scheduler = session_.plot_scheduler();
+	const double frame_budget =
+		scheduler->budget() * (double)scheduler->tick_interval();
+	for (const auto &plot : scheduler->plots()) {
+		const widgets::plot::PlotProfile profile = plot->profiler().profile();
+		const bool slow = profile.frames > 0 &&
+			profile.mean_frame_time > frame_budget;
+
+		const QString name = PlotProfilerView::plot_title(plot);
+		QTreeWidgetItem *plot_item = item(plots_item_, name);
+		set_metric(plot_item, tr("Frame [ms]"),
+			format_ms(profile.mean_frame_time), slow);
+		set_metric(plot_item, tr("Max. frame [ms]"),
+			format_ms(profile.max_frame_time));
+		set_metric(plot_item, tr("Points/frame"),
+			QString::number(profile.mean_points, 'f', 0));
+		set_metric(plot_item, tr("Lateness [ms]"),
+			QString::number(profile.mean_lateness, 'f', 1));
+		set_warning(plot_item, slow);
+
+		if (slow) {
+			bottlenecks_ << tr("The plot %1 needs %2 ms per frame").
+				arg(name).arg(profile.mean_frame_time, 0, 'f', 1);
+		}
+	}
+}
+
+void PerformanceView::update_signals()
+{
+	// The biggest signals first
+	vector<pair<QString, shared_ptr<data::BaseSignal>>> named_signals;
+	const auto signal_registry = session_.signal_registry();
+	for (const auto &device_pair : session_.device_map()) {
+		const QString device_name = device_pair.second->short_name();
+		const auto device_signals =
+			signal_registry->device_signals(device_pair.second);
+		for (const auto &signal : *device_signals) {
+			named_signals.push_back(make_pair(
+				device_name + " / " + signal->display_name(), signal));
+		}
+	}
+	vector<pair<size_t, size_t>> sizes; // memory, spilled
+	vector<size_t> sample_counts;
+	for (const auto &signal : named_signals) {
+		sizes.push_back(make_pair(
+			signal.second->memory_size(), signal.second->spilled_size()));
+		sample_counts.push_back(signal.second->retained_sample_count());
+	}
+	vector<size_t> order(named_signals.size());
+	for (size_t i = 0; i < order.size(); ++i)
+		order[i] = i;
+	std::stable_sort(order.begin(), order.end(), [&sizes](size_t a, size_t b) {
+		return sizes[a].first > sizes[b].first;
+	});
+
+	size_t memory_size = 0;
+	for (int i = 0; i < (int)order.size(); ++i) {
+		const size_t index = order[i];
+		QTreeWidgetItem *signal_item = item(signals_item_,
+			named_signals[index].first);
+		if (signals_item_->indexOfChild(signal_item) != i) {
+			signals_item_->removeChild(signal_item);
+			signals_item_->insertChild(i, signal_item);
+		}
+		QString value = format_memory(sizes[index].first);
+		if (sizes[index].second > 0) {
+			value = tr("%1 (spilled %2)").arg(value).
+				arg(format_memory(sizes[index].second));
+		}
+		if (sample_counts[index] > 0) {
+			const double bytes_per_sample =
+				(double)(sizes[index].first + sizes[index].second) /
+				(double)sample_counts[index];
+			value = tr("%1, %2 B/sample").arg(value).
+				arg(bytes_per_sample, 0, 'f', 1);
+		}
+		signal_item->setText(1, value);
+		memory_size += sizes[index].first;
+	}
+
+	const size_t memory_budget = session_.memory_budget();
+	signals_item_->setText(1, memory_budget == 0 ? format_memory(memory_size) :
+		tr("%1 of %2").arg(format_memory(memory_size)).
+			arg(format_memory(memory_budget)));
+}
+
+void PerformanceView::update_allocations()
+{
+	if (AllocationCounter::has_global_counters()) {
+		const AllocationCounts counts = AllocationCounter::global_counts();
+		// The view isn't updated while it is hidden
+		const qint64 now = probe_clock_.nsecsElapsed();
+		const double interval = std::max(1e-3,
+			(double)(now - last_global_counts_time_) / 1e9);
+		set_metric(allocations_item_, tr("All allocations/s"),
+			QString::number((double)(counts.allocations -
+				last_global_counts_.allocations) / interval, 'f', 0));
+		set_metric(allocations_item_, tr("All allocated memory"),
+			tr("%1/s").arg(format_memory((size_t)((double)(
+				counts.allocated_bytes - last_global_counts_.allocated_bytes) /
+				interval))));
+		set_metric(allocations_item_, tr("Not freed allocations"),
+			QString::number(counts.allocations - counts.deallocations));
+		last_global_counts_ = counts;
+		last_global_counts_time_ = now;
+		allocations_item_->setText(1, tr("All counted"));
+	}
+	else {
+		allocations_item_->setText(1, tr("Storage and scratch buffers"));
+	}
+
+	const AllocationCounts storage =
+		AllocationCounter::domain_counts(AllocationDomain::Storage);
+	set_metric(allocations_item_, tr("Signal storage"),
+		tr("%1 chunks, %2").arg(storage.allocations - storage.deallocations).
+			arg(format_memory(storage.live_bytes)));
+	const AllocationCounts scratch =
+		AllocationCounter::domain_counts(AllocationDomain::Scratch);
+	set_metric(allocations_item_, tr("Scratch buffers"),
+		tr("%1 buffers, %2").arg(scratch.allocations - scratch.deallocations).
+			arg(format_memory(scratch.live_bytes)));
+}
+
+void PerformanceView::update_scripts()
+{
+	for (const auto &status : session_.smu_script_runner()->script_statuses()) {
+		QString state;
+		switch (status.state) {
+		case python::ScriptState::Starting:
+			state = tr("Starting");
+			break;
+		case python::ScriptState::Running:
+			state = tr("Running");
+			break;
+		case python::ScriptState::Stopping:
+		default:
+			state = tr("Stopping");
+			break;
+		}
+		QTreeWidgetItem *script_item = item(scripts_item_,
+			QString::fromStdString(status.file_name));
+		script_item->setText(1, tr("%1 for %2 s").arg(state).
+			arg(status.run_time, 0, 'f', 0));
+	}
+	scripts_item_->setText(1, QString::number(scripts_item_->childCount()));
+}
+
+QTreeWidgetItem *PerformanceView::item(QTreeWidgetItem *parent,
+	const QString &name)
+{
+	QTreeWidgetItem *child = nullptr;
+	for (int i = 0; i < parent->childCount(); ++i) {
+		if (parent->child(i)->text(0) == name) {
+			child = parent->child(i);
+			break;
+		}
+	}
+	if (!child) {
+		child = new QTreeWidgetItem(parent, QStringList() << name);
+		child->setTextAlignment(1, Qt::AlignRight | Qt::AlignVCenter);
+		child->setExpanded(true);
+	}
+	used_items_.insert(child);
+	return child;
+}
+
+void PerformanceView::set_metric(QTreeWidgetItem *parent, const QString &name,
+	const QString &value, bool warning)
+{
+	QTreeWidgetItem *metric_item = item(parent, name);
+	metric_item->setText(1, value);
+	set_warning(metric_item, warning);
+}
+
+void PerformanceView::remove_unused_items(QTreeWidgetItem *parent)
+{
+	for (int i = parent->childCount() - 1; i >= 0; --i) {
+		QTreeWidgetItem *child = parent->child(i);
+		if (used_items_.count(child) == 0)
+			delete parent->takeChild(i);
+		else
+			remove_unused_items(child);
+	}
+}
+
+void PerformanceView::set_warning(QTreeWidgetItem *item, bool warning)
+{
+	QFont font = item->font(0);
+	font.setBold(warning);
+	for (int column = 0; column < 2; ++column) {
+		item->setFont(column, font);
+		item->setForeground(column, warning ? QBrush(Qt::red) : QBrush());
+	}
+}
+
+} // namespace views
+} // namespace ui
+} // namespace sv
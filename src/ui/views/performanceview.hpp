@@ -0,0 +1,145 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_VIEWS_PERFORMANCEVIEW_HPP
+#define UI_VIEWS_PERFORMANCEVIEW_HPP
+
+#include <map>
+#include <set>
+#include <string>
+
+#include <QElapsedTimer>
+#include <QLabel>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include <QTreeWidget>
+#include <QTreeWidgetItem>
+#include <QUuid>
+
+#include "src/allocationcounter.hpp"
+#include "src/devices/acquisitionstatistics.hpp"
+#include "src/ui/views/baseview.hpp"
+
+using std::map;
+using std::set;
+using std::string;
+
+namespace sv {
+
+class Session;
+
+namespace ui {
+namespace views {
+
+/**
+ * Shows the live metrics of the whole session, to find the bottleneck of a
+ * misbehaving setup: The latency of the GUI event loop, the ingest rates,
+ * backlogs, overruns and allocations of the devices, the frame times of the
+ * plots, the memory of the signals, the heap allocations and the states of
+ * the scripts. Metrics, that point to a bottleneck, are highlighted and
+ * listed on top.
+ */
+class PerformanceView : public BaseView
+{
+	Q_OBJECT
+
+public:
+	explicit PerformanceView(Session &session, QUuid uuid = QUuid(),
+		QWidget *parent = nullptr);
+
+	QString title() const override;
+
+protected:
+	void hibernate() override;
+	void wake() override;
+
+private:
+	void setup_ui();
+
+	void update_event_loop();
+	void update_devices();
+	void update_plots();
+	void update_signals();
+	void update_allocations();
+	void update_scripts();
+
+	/**
+	 * Return the child of parent with the name, the child is created if
+	 * needed. Children, that are not requested in an update, are removed
+	 * at the end of the update.
+	 */
+	QTreeWidgetItem *item(QTreeWidgetItem *parent, const QString &name);
+	/** Set the value of the metric name of the parent item. */
+	void set_metric(QTreeWidgetItem *parent, const QString &name,
+		const QString &value, bool warning = false);
+	/** Remove the children, that were not used by the last update. */
+	void remove_unused_items(QTreeWidgetItem *parent);
+	static void set_warning(QTreeWidgetItem *item, bool warning);
+
+	QLabel *bottleneck_label_;
+	QTreeWidget *tree_;
+	QTreeWidgetItem *event_loop_item_;
+	QTreeWidgetItem *devices_item_;
+	QTreeWidgetItem *plots_item_;
+	QTreeWidgetItem *signals_item_;
+	QTreeWidgetItem *allocations_item_;
+	QTreeWidgetItem *scripts_item_;
+	set<QTreeWidgetItem *> used_items_;
+	/** The bottlenecks, that were found by the current update. */
+	QStringList bottlenecks_;
+
+	QTimer update_timer_;
+	/** Measures the latency of the event loop by its own lateness. */
+	QTimer probe_timer_;
+	QElapsedTimer probe_clock_;
+	qint64 last_probe_time_;
+	double probe_latency_sum_;
+	double probe_latency_max_;
+	size_t probe_count_;
+	/** The watchdog stall count of the previous update. */
+	size_t last_stall_count_;
+
+	/**
+	 * The acquisition summaries of the previous update, by device id. The
+	 * overruns and allocations are shown for the last update interval.
+	 */
+	map<string, sv::devices::AcquisitionSummary> last_summaries_;
+	map<string, size_t> last_config_write_counts_;
+	/** The global allocation counts of the previous update. */
+	AllocationCounts last_global_counts_;
+	qint64 last_global_counts_time_;
+
+	/** The view is updated in this interval in milliseconds. */
+	static const int update_interval_;
+	static const int probe_interval_;
+	/** An event loop latency above this is a bottleneck, in milliseconds. */
+	static const double max_event_loop_latency_;
+
+private Q_SLOTS:
+	void update_view();
+	void on_probe_timeout();
+
+};
+
+} // namespace views
+} // namespace ui
+} // namespace sv
+
+#endif // UI_VIEWS_PERFORMANCEVIEW_HPP
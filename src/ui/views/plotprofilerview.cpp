@@ -0,0 +1,176 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <vector>
+
+#include <QAbstractItemView>
+#include <QAction>
+#include <QHeaderView>
+#include <QIcon>
+#include <QString>
+#include <QStringList>
+#include <QTableWidget>
+#include <QTableWidgetItem>
+#include <QToolBar>
+#include <QUuid>
+#include <QVBoxLayout>
+#include <QWidget>
+
+#include "plotprofilerview.hpp"
+#include "src/session.hpp"
+#include "src/ui/views/baseview.hpp"
+#include "src/ui/widgets/plot/plot.hpp"
+#include "src/ui/widgets/plot/plotprofiler.hpp"
+#include "src/ui/widgets/plot/plotscheduler.hpp"
+
+using std::vector;
+
+namespace sv {
+namespace ui {
+namespace views {
+
+const int PlotProfilerView::update_interval_ = 1000;
+
+PlotProfilerView::PlotProfilerView(Session &session, QUuid uuid,
+		QWidget *parent) :
+	BaseView(session, uuid, parent),
+	action_reset_(new QAction(this))
+{
+	// There is only one profiler view
+	id_ = "plotprofiler:";
+
+	setup_ui();
+	setup_toolbar();
+
+	connect(&update_timer_, &QTimer::timeout,
+		this, &PlotProfilerView::update_table);
+	update_timer_.start(update_interval_);
+}
+
+QString PlotProfilerView::title() const
+{
+	return tr("Plot Profiler");
+}
+
+void PlotProfilerView::setup_ui()
+{
+	QVBoxLayout *layout = new QVBoxLayout();
+
+	table_ = new QTableWidget();
+	table_->setColumnCount(10);
+	table_->setHorizontalHeaderLabels(QStringList() << tr("Plot") <<
+		tr("Frame [ms]") << tr("Max. frame [ms]") << tr("Points/frame") <<
+		tr("Replots") << tr("Replot [ms]") << tr("Incremental") <<
+		tr("Incremental [ms]") << tr("Lateness [ms]") <<
+		tr("Max. lateness [ms]"));
+	table_->setToolTip(tr("The statistics over the last %1 frames of each "
+		"plot, the replot and incremental paint times are averaged since the "
+		"last reset").arg(widgets::plot::PlotProfiler::window_size()));
+	table_->setEditTriggers(QAbstractItemView::NoEditTriggers);
+	table_->setSelectionMode(QAbstractItemView::NoSelection);
+	table_->verticalHeader()->setVisible(false);
+	table_->horizontalHeader()->setSectionResizeMode(
+		QHeaderView::ResizeToContents);
+	layout->addWidget(table_);
+
+	this->central_widget_->setLayout(layout);
+}
+
+void PlotProfilerView::setup_toolbar()
+{
+	action_reset_->setText(tr("Reset statistics"));
+	action_reset_->setIcon(
+		QIcon::fromTheme("view-refresh",
+		QIcon(":/icons/view-refresh.png")));
+	connect(action_reset_, SIGNAL(triggered(bool)),
+		this, SLOT(on_action_reset_triggered()));
+
+	toolbar_ = new QToolBar("Plot Profiler Toolbar");
+	toolbar_->addAction(action_reset_);
+	this->addToolBar(Qt::TopToolBarArea, toolbar_);
+}
+
+QString PlotProfilerView::plot_title(const widgets::plot::Plot *plot)
+{
+	for (QWidget *widget = plot->parentWidget(); widget != nullptr;
+			widget = widget->parentWidget()) {
+		const BaseView *view = qobject_cast<const BaseView *>(widget);
+		if (view)
+			return view->title();
+	}
+	return plot->title().text();
+}
+
+void PlotProfilerView::hibernate()
+{
+	update_timer_.stop();
+}
+
+void PlotProfilerView::wake()
+{
+	update_table();
+	update_timer_.start(update_interval_);
+}
+
+void PlotProfilerView::update_table()
+{
+	// Don't collect the statistics, while nobody looks at them
+	if (!this->isVisible())
+		return;
+
+	const vector<widgets::plot::Plot *> plots =
+		session_.plot_scheduler()->plots();
+	table_->setRowCount((int)plots.size());
+	int row = 0;
+	for (const auto &plot : plots) {
+		const widgets::plot::PlotProfile profile = plot->profiler().profile();
+		const QStringList values = QStringList() << plot_title(plot) <<
+			QString::number(profile.mean_frame_time, 'f', 2) <<
+			QString::number(profile.max_frame_time, 'f', 2) <<
+			QString::number(profile.mean_points, 'f', 0) <<
+			QString::number(profile.replots) <<
+			QString::number(profile.mean_replot_time, 'f', 2) <<
+			QString::number(profile.incremental_paints) <<
+			QString::number(profile.mean_incremental_paint_time, 'f', 2) <<
+			QString::number(profile.mean_lateness, 'f', 1) <<
+			QString::number(profile.max_lateness, 'f', 1);
+		for (int column = 0; column < values.size(); ++column) {
+			QTableWidgetItem *item = table_->item(row, column);
+			if (!item) {
+				item = new QTableWidgetItem();
+				if (column > 0)
+					item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+				table_->setItem(row, column, item);
+			}
+			item->setText(values[column]);
+		}
+		++row;
+	}
+}
+
+void PlotProfilerView::on_action_reset_triggered()
+{
+	for (const auto &plot : session_.plot_scheduler()->plots())
+		plot->profiler().reset();
+	update_table();
+}
+
+} // namespace views
+} // namespace ui
+} // namespace sv
@@ -0,0 +1,91 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_VIEWS_PLOTPROFILERVIEW_HPP
+#define UI_VIEWS_PLOTPROFILERVIEW_HPP
+
+#include <memory>
+
+#include <QAction>
+#include <QString>
+#include <QTableWidget>
+#include <QTimer>
+#include <QToolBar>
+#include <QUuid>
+
+#include "src/ui/views/baseview.hpp"
+
+namespace sv {
+
+class Session;
+
+namespace ui {
+
+namespace widgets {
+namespace plot {
+class Plot;
+}
+}
+
+namespace views {
+
+/**
+ * Shows the aggregated frame statistics of all plots of the session (see
+ * PlotProfiler), to find out if the plots are the hotspot of the GUI thread.
+ */
+class PlotProfilerView : public BaseView
+{
+	Q_OBJECT
+
+public:
+	explicit PlotProfilerView(Session &session, QUuid uuid = QUuid(),
+		QWidget *parent = nullptr);
+
+	QString title() const override;
+
+	/** Return the title of the view, that contains the plot. */
+	static QString plot_title(const widgets::plot::Plot *plot);
+
+protected:
+	void hibernate() override;
+	void wake() override;
+
+private:
+	void setup_ui();
+	void setup_toolbar();
+
+	QAction *const action_reset_;
+	QToolBar *toolbar_;
+	QTableWidget *table_;
+	QTimer update_timer_;
+
+	/** The table is updated in this interval in milliseconds. */
+	static const int update_interval_;
+
+private Q_SLOTS:
+	void update_table();
+	void on_action_reset_triggered();
+
+};
+
+} // namespace views
+} // namespace ui
+} // namespace sv
+
+#endif // UI_VIEWS_PLOTPROFILERVIEW_HPP
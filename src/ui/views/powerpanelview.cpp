@@ -17,15 +17,14 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <limits>
 #include <memory>
 #include <set>
 #include <string>
 
 #include <QApplication>
-#include <QDateTime>
 #include <QDebug>
 #include <QSettings>
-#include <QTimer>
 #include <QUuid>
 #include <QVBoxLayout>
 
@@ -33,12 +32,15 @@
 #include "src/session.hpp"
 #include "src/settingsmanager.hpp"
 #include "src/util.hpp"
+#include "src/workerpool.hpp"
 #include "src/channels/basechannel.hpp"
 #include "src/data/analogbasesignal.hpp"
 #include "src/data/analogtimesignal.hpp"
 #include "src/data/datautil.hpp"
+#include "src/data/energyaccumulator.hpp"
 #include "src/devices/basedevice.hpp"
 #include "src/ui/views/baseview.hpp"
+#include "src/ui/views/panelscheduler.hpp"
 #include "src/ui/views/viewhelper.hpp"
 #include "src/ui/widgets/monofontdisplay.hpp"
 
@@ -55,16 +57,7 @@ PowerPanelView::PowerPanelView(Session &session, QUuid uuid, QWidget *parent) :
 	BaseView(session, uuid, parent),
 	voltage_signal_(nullptr),
 	current_signal_(nullptr),
-	voltage_min_(std::numeric_limits<double>::max()),
-	voltage_max_(std::numeric_limits<double>::lowest()),
-	current_min_(std::numeric_limits<double>::max()),
-	current_max_(std::numeric_limits<double>::lowest()),
-	resistance_min_(std::numeric_limits<double>::max()),
-	resistance_max_(std::numeric_limits<double>::lowest()),
-	power_min_(std::numeric_limits<double>::max()),
-	power_max_(std::numeric_limits<double>::lowest()),
-	actual_amp_hours_(0),
-	actual_watt_hours_(0),
+	accumulator_(nullptr),
 	action_reset_displays_(new QAction(this))
 {
 	id_ = "powerpanel:" + util::format_uuid(uuid_);
@@ -72,15 +65,19 @@ PowerPanelView::PowerPanelView(Session &session, QUuid uuid, QWidget *parent) :
 	setup_ui();
 	setup_toolbar();
 	connect_signals();
-	reset_displays();
 
-	timer_ = new QTimer(this);
-	init_timer();
+	session_.panel_scheduler()->add_panel(this, [this]() { on_update(); });
+	init_values();
 }
 
 PowerPanelView::~PowerPanelView()
 {
-	stop_timer();
+	session_.panel_scheduler()->remove_panel(this);
+	delete_accumulator();
+	if (voltage_signal_)
+		voltage_signal_->remove_observer();
+	if (current_signal_)
+		current_signal_->remove_observer();
 }
 
 QString PowerPanelView::title() const
@@ -101,11 +98,17 @@ void PowerPanelView::set_signals(
 	assert(current_signal);
 
 	disconnect_signals();
-	stop_timer();
+	if (voltage_signal_)
+		voltage_signal_->remove_observer();
+	if (current_signal_)
+		current_signal_->remove_observer();
 	voltage_signal_ = voltage_signal;
 	current_signal_ = current_signal;
-	init_timer();
+	voltage_signal_->add_observer();
+	current_signal_->add_observer();
+	create_accumulator();
 	init_displays();
+	init_values();
 	connect_signals();
 
 	Q_EMIT title_changed();
@@ -321,6 +324,54 @@ void PowerPanelView::connect_signals()
 		this, &PowerPanelView::on_digits_changed);
 	connect(current_signal_.get(), &data::AnalogBaseSignal::digits_changed,
 		this, &PowerPanelView::on_digits_changed);
+	// A hidden panel is connected, when it is shown again
+	if (!is_hibernated())
+		connect_sample_signals();
+}
+
+void PowerPanelView::connect_sample_signals()
+{
+	connect(voltage_signal_.get(), &data::AnalogBaseSignal::samples_appended,
+		this, &PowerPanelView::on_samples_appended);
+	connect(current_signal_.get(), &data::AnalogBaseSignal::samples_appended,
+		this, &PowerPanelView::on_samples_appended);
+	// The statistics are updated after the samples_appended() of the signals
+	if (accumulator_) {
+		connect(accumulator_, &data::EnergyAccumulator::statistics_updated,
+			this, &PowerPanelView::on_samples_appended);
+	}
+}
+
+void PowerPanelView::disconnect_sample_signals()
+{
+	disconnect(voltage_signal_.get(), &data::AnalogBaseSignal::samples_appended,
+		this, &PowerPanelView::on_samples_appended);
+	disconnect(current_signal_.get(), &data::AnalogBaseSignal::samples_appended,
+		this, &PowerPanelView::on_samples_appended);
+	if (accumulator_) {
+		disconnect(accumulator_, &data::EnergyAccumulator::statistics_updated,
+			this, &PowerPanelView::on_samples_appended);
+	}
+}
+
+void PowerPanelView::hibernate()
+{
+	if (!voltage_signal_ || !current_signal_)
+		return;
+
+	// The accumulator keeps integrating, only the updates of the hidden
+	// panel are stopped.
+	disconnect_sample_signals();
+}
+
+void PowerPanelView::wake()
+{
+	if (!voltage_signal_ || !current_signal_)
+		return;
+
+	connect_sample_signals();
+	// Show the values, that were appended while the panel was hidden
+	session_.panel_scheduler()->set_changed(this);
 }
 
 void PowerPanelView::disconnect_signals()
@@ -329,11 +380,17 @@ void PowerPanelView::disconnect_signals()
 		disconnect(
 			voltage_signal_.get(), &data::AnalogBaseSignal::digits_changed,
 			this, &PowerPanelView::on_digits_changed);
+		disconnect(
+			voltage_signal_.get(), &data::AnalogBaseSignal::samples_appended,
+			this, &PowerPanelView::on_samples_appended);
 	}
 	if (current_signal_) {
 		disconnect(
 			current_signal_.get(), &data::AnalogBaseSignal::digits_changed,
 			this, &PowerPanelView::on_digits_changed);
+		disconnect(
+			current_signal_.get(), &data::AnalogBaseSignal::samples_appended,
+			this, &PowerPanelView::on_samples_appended);
 	}
 }
 
@@ -386,35 +443,33 @@ void PowerPanelView::reset_displays()
 	watt_hour_display_->reset_value();
 }
 
-void PowerPanelView::init_timer()
+void PowerPanelView::init_values()
 {
-	start_time_ = QDateTime::currentMSecsSinceEpoch();
-	last_time_ = start_time_;
-
-	voltage_min_ = std::numeric_limits<double>::max();
-	voltage_max_ = std::numeric_limits<double>::lowest();
-	current_min_ = std::numeric_limits<double>::max();
-	current_max_ = std::numeric_limits<double>::lowest();
-	resistance_min_ = std::numeric_limits<double>::max();
-	resistance_max_ = std::numeric_limits<double>::lowest();
-	power_min_ = std::numeric_limits<double>::max();
-	power_max_ = std::numeric_limits<double>::lowest();
-	actual_amp_hours_ = 0;
-	actual_watt_hours_ = 0;
-
-	connect(timer_, &QTimer::timeout, this, &PowerPanelView::on_update);
-	timer_->start(250);
+	if (accumulator_)
+		accumulator_->reset();
+
+	reset_displays();
+	session_.panel_scheduler()->set_changed(this);
 }
 
-void PowerPanelView::stop_timer()
+void PowerPanelView::create_accumulator()
 {
-	if (!timer_->isActive())
-		return;
+	delete_accumulator();
 
-	timer_->stop();
-	disconnect(timer_, &QTimer::timeout, this, &PowerPanelView::on_update);
+	accumulator_ = new data::EnergyAccumulator(voltage_signal_, current_signal_);
+	if (Session::worker_pool)
+		Session::worker_pool->move_to_worker(accumulator_);
+}
 
-	reset_displays();
+void PowerPanelView::delete_accumulator()
+{
+	if (!accumulator_)
+		return;
+
+	// The accumulator may be busy in its worker thread
+	disconnect(accumulator_, nullptr, this, nullptr);
+	accumulator_->deleteLater();
+	accumulator_ = nullptr;
 }
 
 void PowerPanelView::on_update()
@@ -423,68 +478,43 @@ void PowerPanelView::on_update()
 			!current_signal_ || current_signal_->sample_count() == 0)
 		return;
 
-	qint64 now = QDateTime::currentMSecsSinceEpoch();
-	double elapsed_time = (double)(now - last_time_) / (double)3600000; // / 1h
-	last_time_ = now;
-
-	double voltage = 0.;
-	if (voltage_signal_) {
-		voltage = voltage_signal_->last_value();
-		if (voltage_min_ > voltage)
-			voltage_min_ = voltage;
-		if (voltage_max_ < voltage)
-			voltage_max_ = voltage;
-	}
-
-	double current = 0.;
-	if (current_signal_) {
-		current = current_signal_->last_value();
-		if (current_min_ > current)
-			current_min_ = current;
-		if (current_max_ < current)
-			current_max_ = current;
-	}
-
-	double resistance = current == 0. ?
+	const double voltage = voltage_signal_->last_value();
+	const double current = current_signal_->last_value();
+	const double resistance = current == 0. ?
 		std::numeric_limits<double>::max() : voltage / current;
-	if (resistance_min_ > resistance)
-		resistance_min_ = resistance;
-	if (resistance_max_ < resistance)
-		resistance_max_ = resistance;
-
-	double power = voltage * current;
-	if (power_min_ > power)
-		power_min_ = power;
-	if (power_max_ < power)
-		power_max_ = power;
-
-	actual_amp_hours_ = actual_amp_hours_ + (current * elapsed_time);
-	actual_watt_hours_ = actual_watt_hours_ + (power * elapsed_time);
+	const double power = voltage * current;
 
 	voltage_display_->set_value(voltage);
-	voltage_min_display_->set_value(voltage_min_);
-	voltage_max_display_->set_value(voltage_max_);
-
 	current_display_->set_value(current);
-	current_min_display_->set_value(current_min_);
-	current_max_display_->set_value(current_max_);
-
 	resistance_display_->set_value(resistance);
-	resistance_min_display_->set_value(resistance_min_);
-	resistance_max_display_->set_value(resistance_max_);
-
 	power_display_->set_value(power);
-	power_min_display_->set_value(power_min_);
-	power_max_display_->set_value(power_max_);
 
-	amp_hour_display_->set_value(actual_amp_hours_);
-	watt_hour_display_->set_value(actual_watt_hours_);
+	if (!accumulator_)
+		return;
+	const data::EnergyStatistics statistics = accumulator_->statistics();
+	if (statistics.sample_count == 0)
+		return;
+
+	voltage_min_display_->set_value(statistics.voltage_min);
+	voltage_max_display_->set_value(statistics.voltage_max);
+	current_min_display_->set_value(statistics.current_min);
+	current_max_display_->set_value(statistics.current_max);
+	resistance_min_display_->set_value(statistics.resistance_min);
+	resistance_max_display_->set_value(statistics.resistance_max);
+	power_min_display_->set_value(statistics.power_min);
+	power_max_display_->set_value(statistics.power_max);
+	amp_hour_display_->set_value(statistics.amp_hours);
+	watt_hour_display_->set_value(statistics.watt_hours);
+}
+
+void PowerPanelView::on_samples_appended()
+{
+	session_.panel_scheduler()->set_changed(this);
 }
 
 void PowerPanelView::on_action_reset_displays_triggered()
 {
-	stop_timer();
-	init_timer();
+	init_values();
 }
 
 void PowerPanelView::on_digits_changed()
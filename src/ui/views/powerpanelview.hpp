@@ -24,7 +24,6 @@
 
 #include <QAction>
 #include <QSettings>
-#include <QTimer>
 #include <QToolBar>
 #include <QUuid>
 
@@ -38,6 +37,7 @@ class Session;
 
 namespace data {
 class AnalogTimeSignal;
+class EnergyAccumulator;
 }
 namespace devices {
 class BaseDevice;
@@ -69,25 +69,16 @@ public:
 	void restore_settings(QSettings &settings,
 		shared_ptr<sv::devices::BaseDevice> origin_device = nullptr) override;
 
+protected:
+	void hibernate() override;
+	void wake() override;
+
 private:
 	shared_ptr<sv::data::AnalogTimeSignal> voltage_signal_;
 	shared_ptr<sv::data::AnalogTimeSignal> current_signal_;
 
-	QTimer *timer_;
-	qint64 start_time_;
-	qint64 last_time_;
-
-	// Min/max/actual values are stored here, so they can be reseted
-	double voltage_min_;
-	double voltage_max_;
-	double current_min_;
-	double current_max_;
-	double resistance_min_;
-	double resistance_max_;
-	double power_min_;
-	double power_max_;
-	double actual_amp_hours_;
-	double actual_watt_hours_;
+	/** Accumulates the min/max values and Ah/Wh from all samples. */
+	sv::data::EnergyAccumulator *accumulator_;
 
 	QAction *const action_reset_displays_;
 	QToolBar *toolbar_;
@@ -111,12 +102,19 @@ private:
 	void init_displays();
 	void connect_signals();
 	void disconnect_signals();
+	/** (Dis)connect the notifications of new samples and statistics. */
+	void connect_sample_signals();
+	void disconnect_sample_signals();
 	void reset_displays();
-	void init_timer();
-	void stop_timer();
+	/** Reset the min/max values, the integrals and the displays. */
+	void init_values();
+	void create_accumulator();
+	void delete_accumulator();
+	/** Called by the PanelScheduler for new samples. */
+	void on_update();
 
 private Q_SLOTS:
-	void on_update();
+	void on_samples_appended();
 	void on_action_reset_displays_triggered();
 	void on_digits_changed();
 
@@ -17,14 +17,18 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <cmath>
-#include <fstream>
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <QAction>
+#include <QByteArray>
 #include <QCheckBox>
+#include <QDataStream>
 #include <QDebug>
 #include <QDoubleSpinBox>
 #include <QFile>
@@ -32,18 +36,19 @@
 #include <QFormLayout>
 #include <QHBoxLayout>
 #include <QHeaderView>
+#include <QIODevice>
+#include <QItemSelectionModel>
 #include <QLabel>
 #include <QList>
 #include <QLocale>
 #include <QMessageBox>
 #include <QSettings>
 #include <QSpinBox>
+#include <QStackedWidget>
 #include <QString>
 #include <QStringList>
-#include <QTableWidget>
-#include <QTableWidgetItem>
+#include <QTableView>
 #include <QTextStream>
-#include <QTimer>
 #include <QToolBar>
 #include <QUuid>
 #include <QVariant>
@@ -53,14 +58,20 @@
 #include "src/session.hpp"
 #include "src/settingsmanager.hpp"
 #include "src/util.hpp"
+#include "src/data/csvreader.hpp"
 #include "src/data/properties/doubleproperty.hpp"
 #include "src/devices/basedevice.hpp"
+#include "src/devices/sequenceengine.hpp"
+#include "src/devices/waveformsequence.hpp"
 #include "src/ui/datatypes/doublespinbox.hpp"
 #include "src/ui/dialogs/generatewaveformdialog.hpp"
 #include "src/ui/views/baseview.hpp"
+#include "src/ui/views/sequencetablemodel.hpp"
 #include "src/ui/views/viewhelper.hpp"
+#include "src/ui/views/waveformtablemodel.hpp"
 
 using std::dynamic_pointer_cast;
+using std::make_shared;
 using std::shared_ptr;
 using std::string;
 using std::vector;
@@ -134,19 +145,17 @@ SequenceOutputView::SequenceOutputView(Session &session, QUuid uuid,
 	action_delete_all_(new QAction(this)),
 	action_load_from_file_(new QAction(this)),
 	action_generate_waveform_(new QAction(this)),
-	sequence_pos_(0)
+	engine_(nullptr)
 {
 	id_ = "sequenceoutput:" + util::format_uuid(uuid_);
 
 	setup_ui();
 	setup_toolbar();
-
-	timer_ = new QTimer(this);
 }
 
 SequenceOutputView::~SequenceOutputView()
 {
-	stop_timer();
+	delete_engine();
 }
 
 QString SequenceOutputView::title() const
@@ -162,9 +171,14 @@ void SequenceOutputView::set_property(
 {
 	assert(property);
 
-	stop_timer();
+	delete_engine();
 
 	property_ = property;
+	engine_ = new devices::SequenceEngine(property_);
+	connect(engine_, &devices::SequenceEngine::step_executed,
+		this, &SequenceOutputView::on_step_executed);
+	connect(engine_, &devices::SequenceEngine::finished,
+		this, &SequenceOutputView::on_sequence_finished);
 	sequence_table_->setItemDelegateForColumn(0,
 		new DoubleSpinBoxDelegate(property_->min(), property_->max(),
 			property_->step(), property_->decimal_places()));
@@ -195,24 +209,36 @@ void SequenceOutputView::setup_ui()
 	repeat_layout->addStretch(1);
 	layout->addItem(repeat_layout);
 
-	sequence_table_ = new QTableWidget();
-	sequence_table_->setColumnCount(2);
-	QTableWidgetItem *value_header_item = new QTableWidgetItem(tr("Value"));
-	sequence_table_->setHorizontalHeaderItem(0, value_header_item);
-	sequence_table_->horizontalHeader()->setSectionResizeMode(
-		0, QHeaderView::Stretch);
-	QTableWidgetItem *delay_header_item = new QTableWidgetItem(tr("Delay [s]"));
-	sequence_table_->setHorizontalHeaderItem(1, delay_header_item);
+	sequence_model_ = new SequenceTableModel(this);
+	sequence_table_ = new QTableView();
+	sequence_table_->setModel(sequence_model_);
 	sequence_table_->horizontalHeader()->setSectionResizeMode(
-		1, QHeaderView::Stretch);
+		QHeaderView::Stretch);
 	sequence_table_->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
-
+	// Fixed row heights, so the view doesn't have to measure every row
 	sequence_table_->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
 	sequence_table_->setItemDelegateForColumn(1,
 		new DoubleSpinBoxDelegate(0, 100000, 0.1, 3));
 
-	//sequence_table_->setRowCount(1);
-	layout->addWidget(sequence_table_);
+	waveform_model_ = new WaveformTableModel(this);
+	waveform_table_ = new QTableView();
+	waveform_table_->setModel(waveform_model_);
+	waveform_table_->setEditTriggers(QAbstractItemView::NoEditTriggers);
+	waveform_table_->setSelectionBehavior(QAbstractItemView::SelectRows);
+	waveform_table_->horizontalHeader()->setSectionResizeMode(
+		QHeaderView::Stretch);
+	waveform_table_->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
+	// Fixed row heights, so the view doesn't have to measure every row
+	waveform_table_->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+
+	table_stack_ = new QStackedWidget();
+	table_stack_->addWidget(sequence_table_);
+	table_stack_->addWidget(waveform_table_);
+	table_stack_->setCurrentWidget(sequence_table_);
+	layout->addWidget(table_stack_);
+
+	timing_label_ = new QLabel();
+	layout->addWidget(timing_label_);
 
 	this->central_widget_->setLayout(layout);
 }
@@ -288,20 +314,28 @@ void SequenceOutputView::save_settings(QSettings &settings,
 		QVariant(repeat_infinite_box_->checkState()));
 	settings.setValue("repeat_count", QVariant(repeat_count_box_->value()));
 
-	// Save sequence
-	int row_count = sequence_table_->rowCount();
-	settings.setValue("sequence_row_count", QVariant(row_count));
-	for (int pos=0; pos<row_count; pos++) {
-		QTableWidgetItem *value_item = sequence_table_->item(pos, 0);
-		QTableWidgetItem *delay_item = sequence_table_->item(pos, 1);
-		if (!value_item || !delay_item)
-			continue;
-
-		settings.beginGroup(QString("sequence_").append(QString::number(pos)));
-		settings.setValue("value", value_item->data(0));
-		settings.setValue("delay", delay_item->data(0));
+	// Save the generated sequence by its parameters
+	auto waveform = waveform_model_->waveform();
+	if (waveform) {
+		settings.beginGroup("waveform");
+		settings.setValue("type", QVariant((int)waveform->type()));
+		settings.setValue("amplitude", QVariant(waveform->amplitude()));
+		settings.setValue("offset", QVariant(waveform->offset()));
+		settings.setValue("frequency", QVariant(waveform->frequency()));
+		settings.setValue("phi", QVariant(waveform->phi()));
+		settings.setValue("interval", QVariant(waveform->interval()));
+		settings.setValue("sample_count",
+			QVariant((qulonglong)waveform->sample_count()));
 		settings.endGroup();
 	}
+
+	// Save the sequence as one block of (value, delay) pairs, a group per
+	// step would make saving large sequences very slow.
+	QByteArray steps_data;
+	QDataStream stream(&steps_data, QIODevice::WriteOnly);
+	for (const auto &step : sequence_model_->steps())
+		stream << step.value << step.delay;
+	settings.setValue("sequence_steps", QVariant(steps_data));
 }
 
 void SequenceOutputView::restore_settings(QSettings &settings,
@@ -323,41 +357,71 @@ void SequenceOutputView::restore_settings(QSettings &settings,
 		repeat_count_box_->setValue(settings.value("repeat_count").toInt());
 
 	// Restore sequence
-	int row_count = settings.value("sequence_row_count").toInt();
-	for (int pos=0; pos<row_count; pos++) {
-		settings.beginGroup(QString("sequence_").append(QString::number(pos)));
-		QVariant value = settings.value("value");
-		QVariant delay = settings.value("delay");
-		sequence_table_->insertRow(pos);
-		QTableWidgetItem *value_item = new QTableWidgetItem(QString::number(
-			value.toDouble(), 'f', 3));
-		value_item->setData(0, value);
-		sequence_table_->setItem(pos, 0, value_item);
-		QTableWidgetItem *delay_item = new QTableWidgetItem(QString::number(
-			delay.toDouble(), 'f', property_->decimal_places()));
-		delay_item->setData(0, delay);
-		sequence_table_->setItem(pos, 1, delay_item);
-		settings.endGroup();
+	vector<devices::SequenceStep> steps;
+	if (settings.contains("sequence_steps")) {
+		QByteArray steps_data = settings.value("sequence_steps").toByteArray();
+		QDataStream stream(&steps_data, QIODevice::ReadOnly);
+		steps.reserve((size_t)steps_data.size() / (2 * sizeof(double)));
+		while (!stream.atEnd()) {
+			devices::SequenceStep step{ .0, .0 };
+			stream >> step.value >> step.delay;
+			if (stream.status() != QDataStream::Ok)
+				break;
+			steps.push_back(step);
+		}
+	}
+	else {
+		// Settings of older versions have a group per step
+		int row_count = settings.value("sequence_row_count").toInt();
+		steps.reserve((size_t)std::max(row_count, 0));
+		for (int pos=0; pos<row_count; pos++) {
+			settings.beginGroup(
+				QString("sequence_").append(QString::number(pos)));
+			steps.push_back(devices::SequenceStep{
+				settings.value("value").toDouble(),
+				settings.value("delay").toDouble() });
+			settings.endGroup();
+		}
 	}
+	sequence_model_->set_steps(std::move(steps));
+
+	// Restore the generated sequence
+	settings.beginGroup("waveform");
+	if (settings.contains("sample_count")) {
+		set_waveform(make_shared<devices::WaveformSequence>(
+			(devices::WaveformType)settings.value("type").toInt(),
+			settings.value("amplitude").toDouble(),
+			settings.value("offset").toDouble(),
+			settings.value("frequency").toDouble(),
+			settings.value("phi").toDouble(),
+			settings.value("interval").toDouble(),
+			(size_t)settings.value("sample_count").toULongLong()));
+	}
+	settings.endGroup();
 }
 
-void SequenceOutputView::start_timer()
+void SequenceOutputView::start_sequence()
 {
-	if (timer_->isActive()) {
-		timer_->stop();
-		disconnect(timer_, &QTimer::timeout,
-			this, &SequenceOutputView::on_timer_update);
+	if (!engine_) {
+		stop_sequence();
+		return;
 	}
 
-	sequence_pos_ = 0;
-	sequence_reperat_count_ = 0;
-	if (sequence_table_->rowCount() == 0)
+	const uint64_t cycles = repeat_infinite_box_->isChecked() ?
+		0 : (uint64_t)repeat_count_box_->value();
+	auto waveform = waveform_model_->waveform();
+	if (waveform) {
+		if (!engine_->start(waveform, cycles)) {
+			stop_sequence();
+			return;
+		}
+	}
+	else if (!start_table_sequence(cycles)) {
+		stop_sequence();
 		return;
+	}
 
-	connect(timer_, &QTimer::timeout,
-		this, &SequenceOutputView::on_timer_update);
-	timer_->start();
-
+	timing_label_->clear();
 	action_run_->setText(tr("Stop"));
 	action_run_->setIcon(
 		QIcon::fromTheme("media-playback-stop",
@@ -365,7 +429,15 @@ void SequenceOutputView::start_timer()
 	action_run_->setChecked(true);
 }
 
-void SequenceOutputView::stop_timer()
+bool SequenceOutputView::start_table_sequence(uint64_t cycles)
+{
+	if (sequence_model_->step_count() == 0)
+		return false;
+
+	return engine_->start(sequence_model_->steps(), cycles);
+}
+
+void SequenceOutputView::stop_sequence()
 {
 	action_run_->setText(tr("Run"));
 	action_run_->setIcon(
@@ -373,14 +445,18 @@ void SequenceOutputView::stop_timer()
 		QIcon(":/icons/media-playback-start.png")));
 	action_run_->setChecked(false);
 
-	if (!timer_->isActive())
+	if (engine_)
+		engine_->stop();
+}
+
+void SequenceOutputView::delete_engine()
+{
+	if (!engine_)
 		return;
 
-	timer_->stop();
-	disconnect(timer_, &QTimer::timeout,
-		this, &SequenceOutputView::on_timer_update);
-	sequence_pos_ = 0;
-	sequence_reperat_count_ = 0;
+	stop_sequence();
+	delete engine_;
+	engine_ = nullptr;
 }
 
 void SequenceOutputView::insert_row(int row, double value, double delay)
@@ -391,63 +467,45 @@ void SequenceOutputView::insert_row(int row, double value, double delay)
 			QMessageBox::Ok);
 	}
 
-	sequence_table_->insertRow(row);
-	QTableWidgetItem *value_item = new QTableWidgetItem(
-		QString::number(value, 'f', 3));
-	value_item->setData(0, QVariant(value));
-	sequence_table_->setItem(row, 0, value_item);
-	QTableWidgetItem *delay_item = new QTableWidgetItem(
-		QString::number(delay, 'f', property_->decimal_places()));
-	delay_item->setData(0, QVariant(delay));
-	sequence_table_->setItem(row, 1, delay_item);
+	sequence_model_->insert_step(row, devices::SequenceStep{ value, delay });
 }
 
-void SequenceOutputView::on_timer_update()
+void SequenceOutputView::set_waveform(
+	shared_ptr<devices::WaveformSequence> waveform)
 {
-	if (!property_) {
-		stop_timer();
-		return;
-	}
+	stop_sequence();
 
-	bool found_value = sequence_pos_ > 0;
-	double value = .0;
-	int delay_ms = 0;
-	// Cycle through the row until a duration is found.
-	do {
-		if (sequence_table_->rowCount() == 0) {
-			stop_timer();
-			return;
-		}
-		if (sequence_pos_ >= sequence_table_->rowCount()) {
-			// Jump up to the first row
-			sequence_pos_ = 0;
-			if (!found_value) {
-				stop_timer();
-				return;
-			}
-			if (!repeat_infinite_box_->isChecked()) {
-				sequence_reperat_count_++;
-				if (sequence_reperat_count_ >= repeat_count_box_->value()) {
-					stop_timer();
-					return;
-				}
-			}
-		}
+	const int decimal_places = property_ ? property_->decimal_places() : 3;
+	waveform_model_->set_waveform(waveform, decimal_places);
+	if (waveform)
+		table_stack_->setCurrentWidget(waveform_table_);
+	else
+		table_stack_->setCurrentWidget(sequence_table_);
 
-		QTableWidgetItem *value_item = sequence_table_->item(sequence_pos_, 0);
-		if (value_item)
-			value = value_item->data(0).toDouble();
-		QTableWidgetItem *delay_item = sequence_table_->item(sequence_pos_, 1);
-		if (delay_item)
-			delay_ms = (int)std::round(delay_item->data(0).toDouble() * 1000);
+	// The rows of a generated sequence can't be edited
+	action_add_row_->setDisabled(waveform != nullptr);
+	action_delete_row_->setDisabled(waveform != nullptr);
+}
 
-		sequence_table_->selectRow(sequence_pos_);
-		sequence_pos_++;
-	}
-	while (delay_ms <= 0);
+void SequenceOutputView::on_step_executed(int step,
+	double requested_time, double actual_time)
+{
+	if (!engine_ || !engine_->is_running())
+		return;
+
+	if (waveform_model_->waveform())
+		waveform_table_->selectRow(step);
+	else
+		sequence_table_->selectRow(step);
+	timing_label_->setText(tr("Step at %1 s: %2 ms late (max. %3 ms)").
+		arg(requested_time, 0, 'f', 3).
+		arg((actual_time - requested_time) * 1000., 0, 'f', 3).
+		arg(engine_->max_lateness() * 1000., 0, 'f', 3));
+}
 
-	property_->change_value(value);
-	timer_->setInterval(delay_ms);
+void SequenceOutputView::on_sequence_finished()
+{
+	stop_sequence();
 }
 
 void SequenceOutputView::on_repeat_infinite_changed()
@@ -461,65 +519,79 @@ void SequenceOutputView::on_repeat_infinite_changed()
 void SequenceOutputView::on_action_run_triggered()
 {
 	if (action_run_->isChecked())
-		start_timer();
+		start_sequence();
 	else
-		stop_timer();
+		stop_sequence();
 }
 
 void SequenceOutputView::on_action_add_row()
 {
-	int row = sequence_table_->currentRow() + 1;
+	int row = sequence_table_->currentIndex().isValid() ?
+		sequence_table_->currentIndex().row() + 1 : 0;
 	insert_row(row, .0, .0);
 }
 
 void SequenceOutputView::on_action_delete_row()
 {
-	// NOTE: If the cells are empty, there is no item to be returned by
-	//       selectedItems() and selectedIndexes() is protected...
-	const auto items = sequence_table_->selectedItems();
-	for (const auto &item : items) {
-		sequence_table_->removeRow(item->row());
+	vector<int> rows;
+	const auto indexes = sequence_table_->selectionModel()->selectedIndexes();
+	for (const auto &index : indexes)
+		rows.push_back(index.row());
+	std::sort(rows.begin(), rows.end());
+	rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+	// Remove contiguous rows at once, from the back so the rows in front
+	// keep their positions
+	while (!rows.empty()) {
+		const int last = rows.back();
+		int first = last;
+		rows.pop_back();
+		while (!rows.empty() && rows.back() == first - 1) {
+			first = rows.back();
+			rows.pop_back();
+		}
+		sequence_model_->remove_steps(first, last - first + 1);
 	}
 }
 
 void SequenceOutputView::on_action_delete_all()
 {
-	sequence_table_->setRowCount(0);
+	set_waveform(nullptr);
+	sequence_model_->clear();
 }
 
 void SequenceOutputView::on_action_load_from_file_triggered()
 {
 	QString file_name = QFileDialog::getOpenFileName(this,
-		tr("Open Sequence-File"), QDir::homePath(), tr("CSV Files (*.csv)"));
+		tr("Open Sequence-File"), QDir::homePath(),
+		tr("CSV/TSV Files (*.csv *.tsv *.txt);;All Files (*)"));
 	if (file_name.length() <= 0)
 		return;
 
-	std::ifstream file(file_name.toStdString());
-	if (file.is_open()) {
-		string line;
-		int row = 0;
-		while (std::getline(file, line)) {
-			auto fields = sv::util::parse_csv_line(line);
-
-			// TODO: Define CSV file format somehow/somewhere...
-			// TODO: Parse header
-			if (fields.size() < 2)
-				continue;
-			bool ok;
-			// NOTE: QString::toDouble() to avoid locales and use the C locale
-			double value = QString::fromStdString(fields[0]).toDouble(&ok);
-			if (!ok)
-				continue;
-			// NOTE: QString::toDouble() to avoid locales and use the C locale
-			double delay = QString::fromStdString(fields[1]).toDouble(&ok);
-			if (!ok)
-				continue;
-
-			insert_row(row, value, delay);
-			row++;
-		}
+	// The separator (comma, semicolon or tab) is detected from the file
+	data::CsvReader reader("");
+	if (!reader.open(file_name.toStdString())) {
+		QMessageBox::warning(this, tr("Load sequence"),
+			tr("Can't open the file %1.").arg(file_name), QMessageBox::Ok);
+		return;
+	}
+
+	// The loaded rows replace a generated sequence
+	set_waveform(nullptr);
+
+	// TODO: Define CSV file format somehow/somewhere...
+	// Lines, that don't start with two numbers (e.g. a header), are skipped
+	vector<devices::SequenceStep> steps;
+	while (reader.read_record()) {
+		devices::SequenceStep step{ .0, .0 };
+		if (!reader.field_double(0, step.value) ||
+				!reader.field_double(1, step.delay))
+			continue;
+		steps.push_back(step);
 	}
-	file.close();
+	reader.close();
+
+	sequence_model_->set_steps(std::move(steps));
 }
 
 void SequenceOutputView::on_action_generate_waveform_triggered()
@@ -528,17 +600,16 @@ void SequenceOutputView::on_action_generate_waveform_triggered()
 		QMessageBox::warning(this, tr("No property assigned."),
 			tr("Please assign a property to this sequence output view first."),
 			QMessageBox::Ok);
+		return;
 	}
 
 	ui::dialogs::GenerateWaveformDialog dlg(property_);
 	if (!dlg.exec())
 		return;
 
-	vector<double> sequence_values = dlg.sequence_values();
-	vector<double> sequence_delays = dlg.sequence_delays();
-	for (size_t i=0; i<sequence_values.size(); ++i) {
-		insert_row(i, sequence_values[i], sequence_delays[i]);
-	}
+	// The values of the waveform are calculated on demand while it is
+	// output, so the table only shows a preview of the generated sequence.
+	set_waveform(dlg.waveform_sequence());
 }
 
 } // namespace views
@@ -20,6 +20,7 @@
 #ifndef UI_VIEWS_SEQUENCEOUTPUTVIEW_HPP
 #define UI_VIEWS_SEQUENCEOUTPUTVIEW_HPP
 
+#include <cstdint>
 #include <memory>
 
 #include <QAction>
@@ -30,8 +31,9 @@
 #include <QString>
 #include <QStringList>
 #include <QStyledItemDelegate>
-#include <QTableWidget>
-#include <QTimer>
+#include <QLabel>
+#include <QStackedWidget>
+#include <QTableView>
 #include <QToolBar>
 #include <QUuid>
 #include <QVariant>
@@ -51,11 +53,16 @@ class DoubleProperty;
 }
 namespace devices {
 class BaseDevice;
+class SequenceEngine;
+class WaveformSequence;
 }
 
 namespace ui {
 namespace views {
 
+class SequenceTableModel;
+class WaveformTableModel;
+
 class DoubleSpinBoxDelegate : public QStyledItemDelegate
 {
 	Q_OBJECT
@@ -109,22 +116,34 @@ private:
 	QAction *const action_load_from_file_;
 	QAction *const action_generate_waveform_;
 	QToolBar *toolbar_;
-	QTimer *timer_;
+	sv::devices::SequenceEngine *engine_;
 	QCheckBox *repeat_infinite_box_;
 	QSpinBox *repeat_count_box_;
-	QTableWidget *sequence_table_;
-	int sequence_pos_;
-	int sequence_reperat_count_;
+	QStackedWidget *table_stack_;
+	QTableView *sequence_table_;
+	SequenceTableModel *sequence_model_;
+	/** Shows a generated waveform, that is not inserted into the table. */
+	QTableView *waveform_table_;
+	WaveformTableModel *waveform_model_;
+	QLabel *timing_label_;
 
 	void setup_ui();
 	void setup_toolbar();
-	void start_timer();
-	void stop_timer();
+	void start_sequence();
+	/** Start the steps of the sequence table. */
+	bool start_table_sequence(uint64_t cycles);
+	void stop_sequence();
+	void delete_engine();
 	void insert_row(int row, double value, double delay);
-	QStringList parse_csv_line(QString line);
+	/**
+	 * Show the generated sequence instead of the sequence table. A nullptr
+	 * shows the sequence table again.
+	 */
+	void set_waveform(shared_ptr<sv::devices::WaveformSequence> waveform);
 
 private Q_SLOTS:
-	void on_timer_update();
+	void on_step_executed(int step, double requested_time, double actual_time);
+	void on_sequence_finished();
 	void on_repeat_infinite_changed();
 	void on_action_run_triggered();
 	void on_action_add_row();
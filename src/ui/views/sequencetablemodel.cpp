@@ -0,0 +1,157 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include <QAbstractTableModel>
+#include <QModelIndex>
+#include <QVariant>
+
+#include "sequencetablemodel.hpp"
+#include "src/devices/sequenceengine.hpp"
+
+using std::vector;
+
+namespace sv {
+namespace ui {
+namespace views {
+
+SequenceTableModel::SequenceTableModel(QObject *parent) :
+	QAbstractTableModel(parent)
+{
+}
+
+void SequenceTableModel::set_steps(vector<devices::SequenceStep> &&steps)
+{
+	beginResetModel();
+	steps_ = std::move(steps);
+	endResetModel();
+}
+
+const vector<devices::SequenceStep> &SequenceTableModel::steps() const
+{
+	return steps_;
+}
+
+size_t SequenceTableModel::step_count() const
+{
+	return steps_.size();
+}
+
+void SequenceTableModel::insert_step(int row,
+	const devices::SequenceStep &step)
+{
+	row = std::max(0, std::min(row, rowCount()));
+	beginInsertRows(QModelIndex(), row, row);
+	steps_.insert(steps_.begin() + row, step);
+	endInsertRows();
+}
+
+void SequenceTableModel::remove_steps(int row, int count)
+{
+	if (row < 0 || count <= 0 || row + count > rowCount())
+		return;
+
+	beginRemoveRows(QModelIndex(), row, row + count - 1);
+	steps_.erase(steps_.begin() + row, steps_.begin() + row + count);
+	endRemoveRows();
+}
+
+void SequenceTableModel::clear()
+{
+	beginResetModel();
+	steps_.clear();
+	steps_.shrink_to_fit();
+	endResetModel();
+}
+
+int SequenceTableModel::rowCount(const QModelIndex &parent) const
+{
+	if (parent.isValid())
+		return 0;
+	// The views can't handle more than INT_MAX rows
+	if (steps_.size() > (size_t)std::numeric_limits<int>::max())
+		return std::numeric_limits<int>::max();
+	return (int)steps_.size();
+}
+
+int SequenceTableModel::columnCount(const QModelIndex &parent) const
+{
+	return parent.isValid() ? 0 : 2;
+}
+
+QVariant SequenceTableModel::data(const QModelIndex &index, int role) const
+{
+	if ((role != Qt::DisplayRole && role != Qt::EditRole) ||
+			!index.isValid() || index.row() >= rowCount() ||
+			index.column() > 1)
+		return QVariant();
+
+	// The values are formatted by the DoubleSpinBoxDelegate of the column
+	const auto &step = steps_[(size_t)index.row()];
+	return QVariant(index.column() == 0 ? step.value : step.delay);
+}
+
+bool SequenceTableModel::setData(const QModelIndex &index,
+	const QVariant &value, int role)
+{
+	if (role != Qt::EditRole || !index.isValid() ||
+			index.row() >= rowCount() || index.column() > 1)
+		return false;
+
+	bool ok;
+	const double d = value.toDouble(&ok);
+	if (!ok)
+		return false;
+
+	auto &step = steps_[(size_t)index.row()];
+	if (index.column() == 0)
+		step.value = d;
+	else
+		step.delay = d;
+	Q_EMIT dataChanged(index, index);
+	return true;
+}
+
+Qt::ItemFlags SequenceTableModel::flags(const QModelIndex &index) const
+{
+	if (!index.isValid())
+		return Qt::NoItemFlags;
+	return QAbstractTableModel::flags(index) | Qt::ItemIsEditable;
+}
+
+QVariant SequenceTableModel::headerData(int section,
+	Qt::Orientation orientation, int role) const
+{
+	if (role != Qt::DisplayRole || orientation != Qt::Horizontal)
+		return QAbstractTableModel::headerData(section, orientation, role);
+
+	if (section == 0)
+		return tr("Value");
+	if (section == 1)
+		return tr("Delay [s]");
+	return QVariant();
+}
+
+} // namespace views
+} // namespace ui
+} // namespace sv
@@ -0,0 +1,79 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_VIEWS_SEQUENCETABLEMODEL_HPP
+#define UI_VIEWS_SEQUENCETABLEMODEL_HPP
+
+#include <vector>
+
+#include <QAbstractTableModel>
+#include <QModelIndex>
+#include <QObject>
+#include <QVariant>
+
+#include "src/devices/sequenceengine.hpp"
+
+using std::vector;
+
+namespace sv {
+namespace ui {
+namespace views {
+
+/**
+ * An editable table model with the values and delays of a sequence. The
+ * steps are stored in one compact array, that can be passed to the
+ * SequenceEngine as it is. The view only creates the rows, that are
+ * actually shown, so even sequences with millions of steps are loaded
+ * instantly.
+ */
+class SequenceTableModel : public QAbstractTableModel
+{
+	Q_OBJECT
+
+public:
+	explicit SequenceTableModel(QObject *parent = nullptr);
+
+	/** Replace all steps. */
+	void set_steps(vector<sv::devices::SequenceStep> &&steps);
+	const vector<sv::devices::SequenceStep> &steps() const;
+	size_t step_count() const;
+	void insert_step(int row, const sv::devices::SequenceStep &step);
+	void remove_steps(int row, int count);
+	void clear();
+
+	int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+	int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+	QVariant data(const QModelIndex &index,
+		int role = Qt::DisplayRole) const override;
+	bool setData(const QModelIndex &index, const QVariant &value,
+		int role = Qt::EditRole) override;
+	Qt::ItemFlags flags(const QModelIndex &index) const override;
+	QVariant headerData(int section, Qt::Orientation orientation,
+		int role = Qt::DisplayRole) const override;
+
+private:
+	vector<sv::devices::SequenceStep> steps_;
+
+};
+
+} // namespace views
+} // namespace ui
+} // namespace sv
+
+#endif // UI_VIEWS_SEQUENCETABLEMODEL_HPP
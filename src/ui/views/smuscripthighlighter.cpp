@@ -0,0 +1,124 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <vector>
+
+#include <QString>
+#include <QTextBlock>
+#include <QTextBlockUserData>
+#include <QTextDocument>
+
+#include <QStyleSyntaxHighlighter>
+#include <QSyntaxStyle>
+
+#include "smuscripthighlighter.hpp"
+#include "src/python/scriptanalyzer.hpp"
+
+using std::vector;
+
+namespace sv {
+namespace ui {
+namespace views {
+
+namespace {
+
+/** The highlighted ranges of a block. */
+class ScriptBlockData : public QTextBlockUserData
+{
+public:
+	vector<python::ScriptFormatRange> ranges;
+};
+
+QString format_name(python::ScriptTokenType type)
+{
+	switch (type) {
+	case python::ScriptTokenType::Keyword:
+		return "Keyword";
+	case python::ScriptTokenType::Constant:
+		return "PrimitiveType";
+	case python::ScriptTokenType::Builtin:
+	case python::ScriptTokenType::Function:
+		return "Function";
+	case python::ScriptTokenType::ClassName:
+		return "Type";
+	case python::ScriptTokenType::Decorator:
+		return "Preprocessor";
+	case python::ScriptTokenType::Number:
+		return "Number";
+	case python::ScriptTokenType::String:
+		return "String";
+	case python::ScriptTokenType::Comment:
+	default:
+		return "Comment";
+	}
+}
+
+}
+
+SmuScriptHighlighter::SmuScriptHighlighter(QTextDocument *document) :
+	QStyleSyntaxHighlighter(document)
+{
+	// For toggling comments in the editor
+	m_commentLineSequence = "#";
+	m_startCommentBlockSequence = "'''";
+	m_endCommentBlockSequence = m_startCommentBlockSequence;
+}
+
+bool SmuScriptHighlighter::apply(const python::ScriptAnalysis &analysis)
+{
+	QTextDocument *doc = document();
+	if (!doc || (uint64_t)doc->revision() != analysis.revision ||
+			(size_t)doc->blockCount() != analysis.lines.size())
+		return false;
+
+	size_t line = 0;
+	for (QTextBlock block = doc->begin(); block.isValid();
+			block = block.next(), ++line) {
+		auto data = static_cast<ScriptBlockData *>(block.userData());
+		if (data && data->ranges == analysis.lines[line])
+			continue;
+		if (!data) {
+			// The block takes the ownership
+			data = new ScriptBlockData();
+			block.setUserData(data);
+		}
+		data->ranges = analysis.lines[line];
+		rehighlightBlock(block);
+	}
+	return true;
+}
+
+void SmuScriptHighlighter::highlightBlock(const QString &text)
+{
+	(void)text;
+
+	auto data = static_cast<ScriptBlockData *>(currentBlockUserData());
+	if (!data || !syntaxStyle())
+		return;
+
+	// The ranges may be outdated, setFormat() clips them to the block
+	for (const auto &range : data->ranges)
+		setFormat(range.start, range.length,
+			syntaxStyle()->getFormat(format_name(range.type)));
+}
+
+} // namespace views
+} // namespace ui
+} // namespace sv
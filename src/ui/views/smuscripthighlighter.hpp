@@ -0,0 +1,70 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_VIEWS_SMUSCRIPTHIGHLIGHTER_HPP
+#define UI_VIEWS_SMUSCRIPTHIGHLIGHTER_HPP
+
+#include <QObject>
+#include <QString>
+#include <QTextDocument>
+
+#include <QStyleSyntaxHighlighter>
+
+namespace sv {
+
+namespace python {
+struct ScriptAnalysis;
+}
+
+namespace ui {
+namespace views {
+
+/**
+ * Highlights a SmuScript with the results of a python::ScriptAnalyzer.
+ *
+ * The script is tokenized in the background thread of the analyzer, the
+ * highlighter only applies the ranges. The ranges are stored in the user
+ * data of the text blocks, so they move with the blocks while the text is
+ * edited, until the next analysis arrives. Only the blocks with changed
+ * ranges are highlighted again.
+ */
+class SmuScriptHighlighter : public QStyleSyntaxHighlighter
+{
+	Q_OBJECT
+
+public:
+	explicit SmuScriptHighlighter(QTextDocument *document = nullptr);
+
+	/**
+	 * Apply the ranges of the analysis to the document.
+	 *
+	 * @return false if the analysis doesn't fit the document (anymore).
+	 */
+	bool apply(const python::ScriptAnalysis &analysis);
+
+protected:
+	void highlightBlock(const QString &text) override;
+
+};
+
+} // namespace views
+} // namespace ui
+} // namespace sv
+
+#endif // UI_VIEWS_SMUSCRIPTHIGHLIGHTER_HPP
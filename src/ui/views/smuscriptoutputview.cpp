@@ -45,6 +45,8 @@ namespace sv {
 namespace ui {
 namespace views {
 
+const int SmuScriptOutputView::max_line_count_ = 10000;
+
 SmuScriptOutputView::SmuScriptOutputView(Session &session,
 		QUuid uuid, QWidget *parent) :
 	BaseView(session, uuid, parent),
@@ -71,6 +73,9 @@ void SmuScriptOutputView::setup_ui()
 
 	output_edit_ = new QPlainTextEdit();
 	output_edit_->setReadOnly(true);
+	// The oldest lines are removed, so a long running script doesn't fill
+	// up the memory.
+	output_edit_->setMaximumBlockCount(max_line_count_);
 	// Same as QCodeEditor::initFont()
 	auto font = QFontDatabase::systemFont(QFontDatabase::FixedFont);
 	font.setFixedPitch(true);
@@ -61,6 +61,9 @@ public:
 		shared_ptr<sv::devices::BaseDevice> origin_device = nullptr) override;
 
 private:
+	/** The number of lines, that are kept in the output. */
+	static const int max_line_count_;
+
 	bool auto_scroll_;
 	QAction *const action_auto_scroll_;
 	QAction *const action_clear_output_;
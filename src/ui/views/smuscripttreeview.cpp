@@ -131,12 +131,9 @@ void SmuScriptTreeView::setup_toolbar()
 		QIcon::fromTheme("media-playback-start",
 		QIcon(":/icons/media-playback-start.png")));
 	action_run_script_->setCheckable(true);
+	action_run_script_->setChecked(false);
 	connect(action_run_script_, SIGNAL(triggered(bool)),
 		this, SLOT(on_action_run_script_triggered()));
-	if (session_.smu_script_runner()->is_running())
-		action_run_script_->setChecked(true);
-	else
-		action_run_script_->setChecked(false);
 
 	toolbar_ = new QToolBar("SmuScript Toolbar");
 	toolbar_->addAction(action_new_script_);
@@ -233,12 +230,16 @@ void SmuScriptTreeView::on_action_run_script_triggered()
 {
 	if (action_run_script_->isChecked()) {
 		QModelIndex index = file_system_tree_->selectionModel()->currentIndex();
-		if (index.isValid())
-			session_.smu_script_runner()->run(
-				file_system_model_->filePath(index).toStdString());
+		if (!index.isValid()) {
+			action_run_script_->setChecked(false);
+			return;
+		}
+		running_file_name_ = file_system_model_->filePath(index).toStdString();
+		if (!session_.smu_script_runner()->run(running_file_name_))
+			on_script_finished(running_file_name_);
 	}
 	else
-		session_.smu_script_runner()->stop();
+		session_.smu_script_runner()->stop(running_file_name_);
 }
 
 void SmuScriptTreeView::on_tree_double_clicked(const QModelIndex& index)
@@ -246,8 +247,11 @@ void SmuScriptTreeView::on_tree_double_clicked(const QModelIndex& index)
 	open_script_file(index);
 }
 
-void SmuScriptTreeView::on_script_started()
+void SmuScriptTreeView::on_script_started(const std::string &file_name)
 {
+	if (running_file_name_.empty() || file_name != running_file_name_)
+		return;
+
 	action_run_script_->setText(tr("Stop"));
 	action_run_script_->setIconText(tr("Stop"));
 	action_run_script_->setIcon(
@@ -256,8 +260,12 @@ void SmuScriptTreeView::on_script_started()
 	action_run_script_->setChecked(true);
 }
 
-void SmuScriptTreeView::on_script_finished()
+void SmuScriptTreeView::on_script_finished(const std::string &file_name)
 {
+	if (running_file_name_.empty() || file_name != running_file_name_)
+		return;
+
+	running_file_name_.clear();
 	action_run_script_->setText(tr("Run"));
 	action_run_script_->setIconText(tr("Run"));
 	action_run_script_->setIcon(
@@ -21,6 +21,7 @@
 #define UI_VIEWS_SMUSCRIPTTREEVIEW_HPP
 
 #include <memory>
+#include <string>
 
 #include <QAction>
 #include <QFileSystemModel>
@@ -34,6 +35,7 @@
 #include "src/ui/views/baseview.hpp"
 
 using std::shared_ptr;
+using std::string;
 
 namespace sv {
 
@@ -66,6 +68,8 @@ private:
 	QAction *const action_open_script_;
 	QAction *const action_run_script_;
 	QString script_dir_;
+	/** The file name of the script, that was started from here. */
+	string running_file_name_;
 	QToolBar *toolbar_;
 	QFileSystemModel *file_system_model_;
 	QTreeView *file_system_tree_;
@@ -81,8 +85,8 @@ private Q_SLOTS:
 	void on_action_open_script_triggered();
 	void on_action_run_script_triggered();
 	void on_tree_double_clicked(const QModelIndex& index);
-	void on_script_started();
-	void on_script_finished();
+	void on_script_started(const std::string &file_name);
+	void on_script_finished(const std::string &file_name);
 
 };
 
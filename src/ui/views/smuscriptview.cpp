@@ -17,8 +17,12 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <cstdint>
+#include <limits>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <QAction>
 #include <QDebug>
@@ -27,6 +31,8 @@
 #include <QMessageBox>
 #include <QSettings>
 #include <QString>
+#include <QTextBlock>
+#include <QTextDocument>
 #include <QTextOption>
 #include <QTextStream>
 #include <QToolBar>
@@ -36,23 +42,27 @@
 
 #include <QCodeEditor>
 #include <QPythonCompleter>
-#include <QPythonHighlighter>
 #include <findreplacedialog.h>
 
 #include "smuscriptview.hpp"
 #include "src/session.hpp"
 #include "src/util.hpp"
 #include "src/devices/basedevice.hpp"
+#include "src/python/scriptanalyzer.hpp"
 #include "src/python/smuscriptrunner.hpp"
 #include "src/ui/views/baseview.hpp"
+#include "src/ui/views/smuscripthighlighter.hpp"
 
 using std::shared_ptr;
 using std::string;
+using std::vector;
 
 namespace sv {
 namespace ui {
 namespace views {
 
+const int SmuScriptView::analyze_delay_ = 150;
+
 SmuScriptView::SmuScriptView(Session &session, QUuid uuid, QWidget *parent) :
 	BaseView(session, uuid, parent),
 	script_file_name_(""),
@@ -61,8 +71,9 @@ SmuScriptView::SmuScriptView(Session &session, QUuid uuid, QWidget *parent) :
 	action_save_as_(new QAction(this)),
 	action_run_(new QAction(this)),
 	action_find_(new QAction(this)),
-	text_changed_(false),
-	started_from_here_(false)
+	analyzer_(new python::ScriptAnalyzer(this)),
+	analyzed_revision_(std::numeric_limits<uint64_t>::max()),
+	text_changed_(false)
 {
 	// The uuid is ignored here to give all SmuScriptViews the same look, when
 	// restored from the settings.
@@ -130,7 +141,10 @@ void SmuScriptView::setup_ui()
 	editor_ = new QCodeEditor();
 	//editor_->setSyntaxStyle();
 	editor_->setCompleter(new QPythonCompleter);
-	editor_->setHighlighter(new QPythonHighlighter);
+	// The highlighting rules of QPythonHighlighter are evaluated in the GUI
+	// thread for every changed block, which blocks the GUI with big scripts
+	highlighter_ = new SmuScriptHighlighter();
+	editor_->setHighlighter(highlighter_);
 	editor_->setAutoIndentation(true);
 	editor_->setWordWrapMode(QTextOption::WordWrap);
 	// NOTE: The extra bottom margin will mess up the textChanged() signal!
@@ -139,6 +153,9 @@ void SmuScriptView::setup_ui()
 
 	this->central_widget_->setLayout(layout);
 
+	analyze_timer_.setSingleShot(true);
+	analyze_timer_.setInterval(analyze_delay_);
+
 	find_dialog_ = new FindReplaceDialog(this);
 	find_dialog_->setModal(false);
 	find_dialog_->setWindowFlags(Qt::Window | Qt::WindowMinimizeButtonHint |
@@ -183,7 +200,7 @@ void SmuScriptView::setup_toolbar()
 	action_run_->setChecked(false);
 	connect(action_run_, SIGNAL(triggered(bool)),
 		this, SLOT(on_action_run_triggered()));
-	if (session_.smu_script_runner()->is_running())
+	if (session_.smu_script_runner()->is_running(script_file_name_))
 		action_run_->setDisabled(true);
 
 	action_find_->setText(tr("&Find and Replace"));
@@ -210,6 +227,10 @@ void SmuScriptView::connect_signals()
 {
 	connect(editor_, &QCodeEditor::textChanged,
 		this, &SmuScriptView::on_text_changed);
+	connect(&analyze_timer_, &QTimer::timeout,
+		this, &SmuScriptView::on_analyze_timeout);
+	connect(analyzer_, &python::ScriptAnalyzer::analysis_finished,
+		this, &SmuScriptView::on_analysis_finished);
 
 	connect(session_.smu_script_runner().get(), &python::SmuScriptRunner::script_started,
 		this, &SmuScriptView::on_script_started);
@@ -316,6 +337,56 @@ void SmuScriptView::on_text_changed()
 {
 	text_changed_ = true;
 	Q_EMIT file_save_state_changed(true);
+
+	// Wait until the typing pauses
+	analyze_timer_.start();
+}
+
+void SmuScriptView::on_analyze_timeout()
+{
+	// Changing the highlighting also emits textChanged()
+	const uint64_t revision = (uint64_t)editor_->document()->revision();
+	if (revision == analyzed_revision_)
+		return;
+
+	analyzed_revision_ = revision;
+	analyzer_->analyze(revision, editor_->toPlainText());
+}
+
+void SmuScriptView::on_analysis_finished(
+	std::shared_ptr<const sv::python::ScriptAnalysis> analysis)
+{
+	// An outdated analysis is dropped, the analysis of the current text is
+	// already on the way
+	if (!highlighter_->apply(*analysis))
+		return;
+
+	show_issues(analysis->issues);
+}
+
+void SmuScriptView::show_issues(const vector<python::ScriptIssue> &issues)
+{
+	if (issues == issues_)
+		return;
+	issues_ = issues;
+
+	// The positions of the squiggles are 1 based lines and 0 based columns
+	editor_->clearSquiggle();
+	for (const auto &issue : issues_) {
+		const QTextBlock block =
+			editor_->document()->findBlockByNumber(issue.line);
+		if (!block.isValid())
+			continue;
+		const int block_length = block.length() - 1;
+		const int end = std::min(issue.column + issue.length, block_length);
+		const int start = std::max(0, std::min(issue.column, end - 1));
+		const auto level = issue.severity == python::ScriptIssueSeverity::Error ?
+			QCodeEditor::SeverityLevel::Error :
+			QCodeEditor::SeverityLevel::Warning;
+		editor_->squiggle(level, qMakePair(issue.line + 1, start),
+			qMakePair(issue.line + 1, std::max(start, end)),
+			QString::fromStdString(issue.message));
+	}
 }
 
 void SmuScriptView::on_action_run_triggered()
@@ -330,8 +401,9 @@ void SmuScriptView::on_action_run_triggered()
 			QIcon::fromTheme("media-playback-stop",
 			QIcon(":/icons/media-playback-stop.png")));
 
-		started_from_here_ = true;
-		session_.smu_script_runner()->run(script_file_name_);
+		running_file_name_ = script_file_name_;
+		if (!session_.smu_script_runner()->run(running_file_name_))
+			on_script_finished(running_file_name_);
 	}
 	else {
 		action_run_->setText(tr("Run"));
@@ -340,33 +412,34 @@ void SmuScriptView::on_action_run_triggered()
 			QIcon::fromTheme("media-playback-start",
 			QIcon(":/icons/media-playback-start.png")));
 
-		started_from_here_ = false;
-		session_.smu_script_runner()->stop();
+		session_.smu_script_runner()->stop(running_file_name_);
 	}
 }
 
-void SmuScriptView::on_script_started()
+void SmuScriptView::on_script_started(const std::string &file_name)
 {
-	if (started_from_here_)
-		Q_EMIT script_started();
-	else
+	// Other scripts can run at the same time
+	if (!running_file_name_.empty() && file_name == running_file_name_)
+		Q_EMIT script_started(file_name);
+	else if (file_name == script_file_name_)
 		action_run_->setDisabled(true);
 }
 
-void SmuScriptView::on_script_finished()
+void SmuScriptView::on_script_finished(const std::string &file_name)
 {
-	if (started_from_here_) {
+	if (!running_file_name_.empty() && file_name == running_file_name_) {
 		action_run_->setText(tr("Run"));
 		action_run_->setIconText(tr("Run"));
 		action_run_->setIcon(
 			QIcon::fromTheme("media-playback-start",
 			QIcon(":/icons/media-playback-start.png")));
 		action_run_->setChecked(false);
-		started_from_here_ = false;
+		action_run_->setDisabled(false);
+		running_file_name_.clear();
 
-		Q_EMIT script_finished();
+		Q_EMIT script_finished(file_name);
 	}
-	else
+	else if (file_name == script_file_name_)
 		action_run_->setDisabled(false);
 }
 
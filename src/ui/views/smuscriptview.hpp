@@ -20,21 +20,26 @@
 #ifndef UI_VIEWS_SMUSCRIPTVIEW_HPP
 #define UI_VIEWS_SMUSCRIPTVIEW_HPP
 
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <QAction>
 #include <QSettings>
+#include <QTimer>
 #include <QToolBar>
 #include <QUuid>
 
 #include <QCodeEditor>
 #include <findreplacedialog.h>
 
+#include "src/python/scriptanalyzer.hpp"
 #include "src/ui/views/baseview.hpp"
 
 using std::shared_ptr;
 using std::string;
+using std::vector;
 
 namespace sv {
 
@@ -47,6 +52,8 @@ class BaseDevice;
 namespace ui {
 namespace views {
 
+class SmuScriptHighlighter;
+
 class SmuScriptView : public BaseView
 {
 	Q_OBJECT
@@ -65,6 +72,9 @@ public:
 		shared_ptr<sv::devices::BaseDevice> origin_device = nullptr) override;
 
 private:
+	/** Milliseconds after the last change, until the script is analyzed. */
+	static const int analyze_delay_;
+
 	string script_file_name_;
 	QAction *const action_open_;
 	QAction *const action_save_;
@@ -74,13 +84,26 @@ private:
 	QToolBar *toolbar_;
 	QCodeEditor *editor_;
 	FindReplaceDialog *find_dialog_;
+	/**
+	 * The script is highlighted and checked in the background, a while
+	 * after the last change.
+	 */
+	python::ScriptAnalyzer *analyzer_;
+	SmuScriptHighlighter *highlighter_;
+	QTimer analyze_timer_;
+	/** The revision of the last analyzed text. */
+	uint64_t analyzed_revision_;
+	vector<python::ScriptIssue> issues_;
 	bool text_changed_;
-	bool started_from_here_;
+	/** The file name of the script, that was started from here. */
+	string running_file_name_;
 
 	void setup_ui();
 	void setup_toolbar();
 	void connect_signals();
 	bool save(QString file_name);
+	/** Show the syntax problems in the editor. */
+	void show_issues(const vector<python::ScriptIssue> &issues);
 
 public Q_SLOTS:
 	void run_script();
@@ -93,14 +116,17 @@ private Q_SLOTS:
 	void on_action_run_triggered();
 	void on_action_find_triggered();
 	void on_text_changed();
-	void on_script_started();
-	void on_script_finished();
+	void on_analyze_timeout();
+	void on_analysis_finished(
+		std::shared_ptr<const sv::python::ScriptAnalysis> analysis);
+	void on_script_started(const std::string &file_name);
+	void on_script_finished(const std::string &file_name);
 
 Q_SIGNALS:
 	void file_name_changed(const QString &file_name);
 	void file_save_state_changed(bool is_unsaved);
-	void script_started();
-	void script_finished();
+	void script_started(const std::string &file_name);
+	void script_finished(const std::string &file_name);
 
 };
 
@@ -59,6 +59,18 @@ SourceSinkControlView::SourceSinkControlView(Session &session,
 	id_ = "sourcesinkcontrol:" + util::format_uuid(uuid_);
 
 	setup_ui();
+
+	// The states of the device, that are shown by the LEDs
+	watch_state(configurable_->get_property(ConfigKey::Enabled));
+	watch_state(configurable_->get_property(ConfigKey::Regulation));
+	watch_state(configurable_->get_property(
+		ConfigKey::OverVoltageProtectionActive));
+	watch_state(configurable_->get_property(
+		ConfigKey::OverCurrentProtectionActive));
+	watch_state(configurable_->get_property(
+		ConfigKey::OverTemperatureProtectionActive));
+	watch_state(configurable_->get_property(
+		ConfigKey::UnderVoltageConditionActive));
 }
 
 QString SourceSinkControlView::title() const
@@ -0,0 +1,285 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <QDebug>
+#include <QPen>
+#include <QSettings>
+#include <QString>
+#include <QUuid>
+#include <QVariant>
+#include <QVBoxLayout>
+#include <qwt_plot.h>
+#include <qwt_plot_curve.h>
+#include <qwt_plot_grid.h>
+#include <qwt_scale_engine.h>
+#include <qwt_text.h>
+
+#include "spectrumview.hpp"
+#include "src/session.hpp"
+#include "src/settingsmanager.hpp"
+#include "src/util.hpp"
+#include "src/workerpool.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/fft.hpp"
+#include "src/data/spectrumanalyzer.hpp"
+#include "src/devices/basedevice.hpp"
+#include "src/ui/views/baseview.hpp"
+
+using std::dynamic_pointer_cast;
+using std::vector;
+
+namespace sv {
+namespace ui {
+namespace views {
+
+const double SpectrumView::overlap_ = 0.5;
+
+SpectrumView::SpectrumView(Session &session, QUuid uuid, QWidget *parent) :
+	BaseView(session, uuid, parent),
+	signal_(nullptr),
+	analyzer_(nullptr),
+	action_log_scale_(new QAction(this))
+{
+	id_ = "spectrum:" + util::format_uuid(uuid_);
+
+	setup_ui();
+	setup_toolbar();
+}
+
+SpectrumView::~SpectrumView()
+{
+	delete_analyzer();
+}
+
+QString SpectrumView::title() const
+{
+	QString title = tr("Spectrum");
+	if (signal_)
+		title = title.append(" ").append(signal_->display_name());
+
+	return title;
+}
+
+void SpectrumView::set_signal(shared_ptr<sv::data::AnalogTimeSignal> signal)
+{
+	signal_ = signal;
+	plot_->setAxisTitle(QwtPlot::yLeft, signal_->unit_name());
+	init_analyzer();
+
+	Q_EMIT title_changed();
+}
+
+void SpectrumView::setup_ui()
+{
+	QVBoxLayout *layout = new QVBoxLayout();
+
+	plot_ = new QwtPlot();
+	plot_->setAxisTitle(QwtPlot::xBottom, tr("Frequency [Hz]"));
+	QwtPlotGrid *grid = new QwtPlotGrid();
+	grid->setMajorPen(QPen(Qt::gray, 0, Qt::DotLine));
+	grid->attach(plot_);
+	curve_ = new QwtPlotCurve();
+	curve_->setPen(QPen(Qt::blue));
+	curve_->setRenderHint(QwtPlotItem::RenderAntialiased, true);
+	curve_->attach(plot_);
+	layout->addWidget(plot_);
+
+	this->central_widget_->setLayout(layout);
+}
+
+void SpectrumView::setup_toolbar()
+{
+	fft_size_box_ = new QComboBox();
+	for (size_t size = 256; size <= 65536; size *= 2)
+		fft_size_box_->addItem(QString::number(size), QVariant((uint)size));
+	fft_size_box_->setCurrentIndex(fft_size_box_->findData(QVariant(4096u)));
+	fft_size_box_->setToolTip(tr("FFT size"));
+	connect(fft_size_box_, SIGNAL(currentIndexChanged(int)),
+		this, SLOT(on_settings_changed()));
+
+	// The items are in the order of data::WindowFunction
+	window_box_ = new QComboBox();
+	window_box_->addItem(tr("Rectangular"));
+	window_box_->addItem(tr("Hann"));
+	window_box_->addItem(tr("Hamming"));
+	window_box_->addItem(tr("Blackman-Harris"));
+	window_box_->setCurrentIndex((int)data::WindowFunction::Hann);
+	window_box_->setToolTip(tr("Window function"));
+	connect(window_box_, SIGNAL(currentIndexChanged(int)),
+		this, SLOT(on_settings_changed()));
+
+	average_box_ = new QComboBox();
+	for (uint count = 1; count <= 64; count *= 2)
+		average_box_->addItem(QString::number(count), QVariant(count));
+	average_box_->setCurrentIndex(average_box_->findData(QVariant(4u)));
+	average_box_->setToolTip(tr("Averaged blocks"));
+	connect(average_box_, SIGNAL(currentIndexChanged(int)),
+		this, SLOT(on_settings_changed()));
+
+	action_log_scale_->setText(tr("Logarithmic scale"));
+	action_log_scale_->setIcon(
+		QIcon::fromTheme("office-chart-line",
+		QIcon(":/icons/office-chart-line.png")));
+	action_log_scale_->setCheckable(true);
+	action_log_scale_->setChecked(true);
+	connect(action_log_scale_, &QAction::triggered,
+		this, &SpectrumView::on_action_log_scale_triggered);
+	set_log_scale(true);
+
+	toolbar_ = new QToolBar("Spectrum Toolbar");
+	toolbar_->addWidget(fft_size_box_);
+	toolbar_->addWidget(window_box_);
+	toolbar_->addWidget(average_box_);
+	toolbar_->addSeparator();
+	toolbar_->addAction(action_log_scale_);
+	this->addToolBar(Qt::TopToolBarArea, toolbar_);
+}
+
+void SpectrumView::init_analyzer()
+{
+	delete_analyzer();
+	if (!signal_)
+		return;
+
+	analyzer_ = new data::SpectrumAnalyzer(signal_,
+		fft_size_box_->currentData().toUInt(),
+		(data::WindowFunction)window_box_->currentIndex(), overlap_,
+		average_box_->currentData().toUInt());
+	connect(analyzer_, &data::SpectrumAnalyzer::spectrum_updated,
+		this, &SpectrumView::on_spectrum_updated);
+
+	if (Session::worker_pool)
+		Session::worker_pool->move_to_worker(analyzer_);
+
+	// Calculate the samples, that are already in the signal
+	QMetaObject::invokeMethod(analyzer_, "on_samples_appended",
+		Qt::QueuedConnection);
+}
+
+void SpectrumView::delete_analyzer()
+{
+	if (!analyzer_)
+		return;
+
+	// The analyzer may be busy in its worker thread
+	disconnect(analyzer_, nullptr, this, nullptr);
+	analyzer_->deleteLater();
+	analyzer_ = nullptr;
+}
+
+void SpectrumView::set_log_scale(bool log_scale)
+{
+	if (log_scale)
+		plot_->setAxisScaleEngine(QwtPlot::yLeft, new QwtLogScaleEngine());
+	else
+		plot_->setAxisScaleEngine(QwtPlot::yLeft, new QwtLinearScaleEngine());
+	plot_->setAxisAutoScale(QwtPlot::yLeft, true);
+	plot_->replot();
+}
+
+void SpectrumView::save_settings(QSettings &settings,
+	shared_ptr<sv::devices::BaseDevice> origin_device) const
+{
+	BaseView::save_settings(settings, origin_device);
+
+	if (signal_)
+		SettingsManager::save_signal(signal_, settings, origin_device);
+	settings.setValue("fft_size", fft_size_box_->currentData());
+	settings.setValue("window_function", window_box_->currentIndex());
+	settings.setValue("average_count", average_box_->currentData());
+	settings.setValue("log_scale", action_log_scale_->isChecked());
+}
+
+void SpectrumView::restore_settings(QSettings &settings,
+	shared_ptr<sv::devices::BaseDevice> origin_device)
+{
+	BaseView::restore_settings(settings, origin_device);
+
+	// Don't recreate the analyzer for every setting
+	fft_size_box_->blockSignals(true);
+	window_box_->blockSignals(true);
+	average_box_->blockSignals(true);
+	if (settings.contains("fft_size")) {
+		int index = fft_size_box_->findData(settings.value("fft_size"));
+		if (index >= 0)
+			fft_size_box_->setCurrentIndex(index);
+	}
+	if (settings.contains("window_function")) {
+		int index = settings.value("window_function").toInt();
+		if (index >= 0 && index < window_box_->count())
+			window_box_->setCurrentIndex(index);
+	}
+	if (settings.contains("average_count")) {
+		int index = average_box_->findData(settings.value("average_count"));
+		if (index >= 0)
+			average_box_->setCurrentIndex(index);
+	}
+	fft_size_box_->blockSignals(false);
+	window_box_->blockSignals(false);
+	average_box_->blockSignals(false);
+	if (settings.contains("log_scale")) {
+		action_log_scale_->setChecked(settings.value("log_scale").toBool());
+		set_log_scale(action_log_scale_->isChecked());
+	}
+
+	auto signal = dynamic_pointer_cast<sv::data::AnalogTimeSignal>(
+		SettingsManager::restore_signal(session_, settings, origin_device));
+	if (signal)
+		set_signal(signal);
+}
+
+void SpectrumView::on_settings_changed()
+{
+	init_analyzer();
+}
+
+void SpectrumView::on_action_log_scale_triggered()
+{
+	set_log_scale(action_log_scale_->isChecked());
+}
+
+void SpectrumView::on_spectrum_updated()
+{
+	if (!analyzer_)
+		return;
+
+	vector<double> frequencies;
+	vector<double> magnitudes;
+	if (!analyzer_->spectrum(frequencies, magnitudes))
+		return;
+
+	// A logarithmic scale can't show zeros
+	if (action_log_scale_->isChecked()) {
+		for (auto &magnitude : magnitudes)
+			magnitude = std::max(magnitude, 1e-15);
+	}
+
+	curve_->setSamples(frequencies.data(), magnitudes.data(),
+		(int)frequencies.size());
+	plot_->setAxisScale(QwtPlot::xBottom, 0., frequencies.back());
+	plot_->replot();
+}
+
+} // namespace views
+} // namespace ui
+} // namespace sv
@@ -0,0 +1,108 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_VIEWS_SPECTRUMVIEW_HPP
+#define UI_VIEWS_SPECTRUMVIEW_HPP
+
+#include <memory>
+
+#include <QAction>
+#include <QComboBox>
+#include <QSettings>
+#include <QToolBar>
+#include <QUuid>
+
+#include "src/ui/views/baseview.hpp"
+
+using std::shared_ptr;
+
+class QwtPlot;
+class QwtPlotCurve;
+
+namespace sv {
+
+class Session;
+
+namespace data {
+class AnalogTimeSignal;
+class SpectrumAnalyzer;
+}
+namespace devices {
+class BaseDevice;
+}
+
+namespace ui {
+namespace views {
+
+/**
+ * Shows the amplitude spectrum of a signal, e.g. for ripple and noise
+ * measurements. The spectrum is calculated by a data::SpectrumAnalyzer in
+ * a worker thread.
+ */
+class SpectrumView : public BaseView
+{
+	Q_OBJECT
+
+public:
+	explicit SpectrumView(Session& session, QUuid uuid = QUuid(),
+		QWidget* parent = nullptr);
+	~SpectrumView();
+
+	QString title() const override;
+	void set_signal(shared_ptr<sv::data::AnalogTimeSignal> signal);
+
+	void save_settings(QSettings &settings,
+		shared_ptr<sv::devices::BaseDevice> origin_device = nullptr) const override;
+	void restore_settings(QSettings &settings,
+		shared_ptr<sv::devices::BaseDevice> origin_device = nullptr) override;
+
+private:
+	/** The overlap of consecutive FFT blocks. */
+	static const double overlap_;
+
+	shared_ptr<sv::data::AnalogTimeSignal> signal_;
+	sv::data::SpectrumAnalyzer *analyzer_;
+
+	QComboBox *fft_size_box_;
+	QComboBox *window_box_;
+	QComboBox *average_box_;
+	QAction *const action_log_scale_;
+	QToolBar *toolbar_;
+	QwtPlot *plot_;
+	QwtPlotCurve *curve_;
+
+	void setup_ui();
+	void setup_toolbar();
+	/** (Re)create the analyzer with the settings from the tool bar. */
+	void init_analyzer();
+	void delete_analyzer();
+	void set_log_scale(bool log_scale);
+
+private Q_SLOTS:
+	void on_settings_changed();
+	void on_action_log_scale_triggered();
+	void on_spectrum_updated();
+
+};
+
+} // namespace views
+} // namespace ui
+} // namespace sv
+
+#endif // UI_VIEWS_SPECTRUMVIEW_HPP
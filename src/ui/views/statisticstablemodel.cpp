@@ -0,0 +1,235 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include <QLocale>
+#include <QString>
+#include <QVariant>
+
+#include "statisticstablemodel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/formatter.hpp"
+#include "src/data/runningstatistics.hpp"
+
+namespace sv {
+namespace ui {
+namespace views {
+
+const double StatisticsTableModel::samplerate_interval_ = 1.;
+
+StatisticsTableModel::StatisticsTableModel(QObject *parent) :
+	QAbstractTableModel(parent),
+	formatter_(QLocale())
+{
+}
+
+void StatisticsTableModel::add_signal(
+	shared_ptr<sv::data::AnalogTimeSignal> signal)
+{
+	if (!signal)
+		return;
+
+	Row row;
+	row.signal = signal;
+	row.sample_count = 0;
+	row.rate_sample_count = 0;
+	row.rate_timestamp = std::numeric_limits<double>::quiet_NaN();
+	row.samplerate = std::numeric_limits<double>::quiet_NaN();
+	update_row(row, row.cells);
+
+	const int row_index = (int)rows_.size();
+	beginInsertRows(QModelIndex(), row_index, row_index);
+	rows_.push_back(row);
+	endInsertRows();
+}
+
+void StatisticsTableModel::remove_signal(int row)
+{
+	if (row < 0 || row >= (int)rows_.size())
+		return;
+
+	beginRemoveRows(QModelIndex(), row, row);
+	rows_.erase(rows_.begin() + row);
+	endRemoveRows();
+}
+
+shared_ptr<sv::data::AnalogTimeSignal> StatisticsTableModel::signal(
+	int row) const
+{
+	if (row < 0 || row >= (int)rows_.size())
+		return nullptr;
+	return rows_[row].signal;
+}
+
+size_t StatisticsTableModel::refresh()
+{
+	size_t changed_count = 0;
+	QString cells[ColumnCount];
+	for (size_t r = 0; r < rows_.size(); ++r) {
+		Row &row = rows_[r];
+		if (row.signal->sample_count() == row.sample_count)
+			continue;
+
+		update_row(row, cells);
+
+		// Report the runs of changed cells
+		int first_changed = -1;
+		for (int column = 0; column <= ColumnCount; ++column) {
+			const bool changed = column < ColumnCount &&
+				cells[column] != row.cells[column];
+			if (changed) {
+				row.cells[column] = cells[column];
+				++changed_count;
+				if (first_changed < 0)
+					first_changed = column;
+			}
+			else if (first_changed >= 0) {
+				Q_EMIT dataChanged(index((int)r, first_changed),
+					index((int)r, column - 1), { Qt::DisplayRole });
+				first_changed = -1;
+			}
+		}
+	}
+	return changed_count;
+}
+
+void StatisticsTableModel::update_row(Row &row, QString *cells)
+{
+	const auto &signal = row.signal;
+	const size_t sample_count = signal->sample_count();
+	const double last_timestamp = sample_count > 0 ?
+		signal->last_timestamp(false) : 0.;
+
+	// The signal was cleared
+	if (sample_count < row.sample_count) {
+		row.rate_timestamp = std::numeric_limits<double>::quiet_NaN();
+		row.samplerate = std::numeric_limits<double>::quiet_NaN();
+	}
+	row.sample_count = sample_count;
+
+	if (sample_count > 0) {
+		if (std::isnan(row.rate_timestamp)) {
+			row.rate_sample_count = sample_count;
+			row.rate_timestamp = last_timestamp;
+		}
+		else if (last_timestamp - row.rate_timestamp >= samplerate_interval_) {
+			row.samplerate = (double)(sample_count - row.rate_sample_count) /
+				(last_timestamp - row.rate_timestamp);
+			row.rate_sample_count = sample_count;
+			row.rate_timestamp = last_timestamp;
+		}
+	}
+
+	const int decimal_places = signal->decimal_places();
+	const auto statistics = signal->statistics();
+	const bool has_values = statistics.sample_count > 0;
+	cells[SignalColumn] = signal->display_name();
+	cells[UnitColumn] = signal->unit_name();
+	cells[LastColumn] = sample_count > 0 ?
+		format_value(signal->last_value(), decimal_places) : QString();
+	cells[MinColumn] = has_values ?
+		format_value(signal->min_value(), decimal_places) : QString();
+	cells[MaxColumn] = has_values ?
+		format_value(signal->max_value(), decimal_places) : QString();
+	cells[MeanColumn] = has_values ?
+		format_value(statistics.mean, -1) : QString();
+	cells[StddevColumn] = has_values ?
+		format_value(statistics.stddev, -1) : QString();
+	cells[RmsColumn] = has_values ?
+		format_value(statistics.rms, -1) : QString();
+	cells[SamplerateColumn] = format_value(row.samplerate, -1);
+}
+
+QString StatisticsTableModel::format_value(double value,
+	int decimal_places) const
+{
+	if (std::isnan(value))
+		return QString();
+	if (!std::isfinite(value))
+		return QString::number(value);
+	if (decimal_places < 0)
+		return formatter_.format_general(value);
+	return formatter_.format_fixed(value, 0, decimal_places);
+}
+
+int StatisticsTableModel::rowCount(const QModelIndex &parent) const
+{
+	if (parent.isValid())
+		return 0;
+	return (int)rows_.size();
+}
+
+int StatisticsTableModel::columnCount(const QModelIndex &parent) const
+{
+	if (parent.isValid())
+		return 0;
+	return ColumnCount;
+}
+
+QVariant StatisticsTableModel::data(const QModelIndex &index, int role) const
+{
+	if (!index.isValid() || index.row() >= (int)rows_.size() ||
+			index.column() >= ColumnCount)
+		return QVariant();
+
+	if (role == Qt::DisplayRole)
+		return rows_[index.row()].cells[index.column()];
+	if (role == Qt::TextAlignmentRole && index.column() > UnitColumn)
+		return QVariant(Qt::AlignRight | Qt::AlignVCenter);
+	return QVariant();
+}
+
+QVariant StatisticsTableModel::headerData(int section,
+	Qt::Orientation orientation, int role) const
+{
+	if (role != Qt::DisplayRole || orientation != Qt::Horizontal)
+		return QVariant();
+
+	switch (section) {
+	case SignalColumn:
+		return tr("Signal");
+	case UnitColumn:
+		return tr("Unit");
+	case LastColumn:
+		return tr("Last");
+	case MinColumn:
+		return tr("Min");
+	case MaxColumn:
+		return tr("Max");
+	case MeanColumn:
+		return tr("Mean");
+	case StddevColumn:
+		return tr("Std. dev.");
+	case RmsColumn:
+		return tr("RMS");
+	case SamplerateColumn:
+		return tr("Sample rate [Hz]");
+	default:
+		return QVariant();
+	}
+}
+
+} // namespace views
+} // namespace ui
+} // namespace sv
@@ -0,0 +1,126 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_VIEWS_STATISTICSTABLEMODEL_HPP
+#define UI_VIEWS_STATISTICSTABLEMODEL_HPP
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <QAbstractTableModel>
+#include <QModelIndex>
+#include <QObject>
+#include <QString>
+#include <QVariant>
+
+#include "src/data/formatter.hpp"
+
+using std::shared_ptr;
+using std::vector;
+
+namespace sv {
+
+namespace data {
+class AnalogTimeSignal;
+}
+
+namespace ui {
+namespace views {
+
+/**
+ * A table model with one row per signal and the last value, min, max, mean,
+ * standard deviation, RMS and sample rate of the signals in the columns.
+ *
+ * The values come from the running statistics of the signals, so a refresh
+ * doesn't read any samples. The cells are formatted on refresh() and only
+ * the cells, whose text has changed, are reported to the views.
+ */
+class StatisticsTableModel : public QAbstractTableModel
+{
+	Q_OBJECT
+
+public:
+	enum Column {
+		SignalColumn = 0,
+		UnitColumn,
+		LastColumn,
+		MinColumn,
+		MaxColumn,
+		MeanColumn,
+		StddevColumn,
+		RmsColumn,
+		SamplerateColumn,
+		ColumnCount
+	};
+
+	explicit StatisticsTableModel(QObject *parent = nullptr);
+
+	void add_signal(shared_ptr<sv::data::AnalogTimeSignal> signal);
+	void remove_signal(int row);
+	shared_ptr<sv::data::AnalogTimeSignal> signal(int row) const;
+
+	/**
+	 * Update the cells of the signals, that got new samples since the last
+	 * refresh.
+	 *
+	 * @return The number of changed cells.
+	 */
+	size_t refresh();
+
+	int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+	int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+	QVariant data(const QModelIndex &index,
+		int role = Qt::DisplayRole) const override;
+	QVariant headerData(int section, Qt::Orientation orientation,
+		int role = Qt::DisplayRole) const override;
+
+private:
+	struct Row
+	{
+		shared_ptr<sv::data::AnalogTimeSignal> signal;
+		/** The sample count at the last refresh. */
+		size_t sample_count;
+		/** The start of the current sample rate measurement. */
+		size_t rate_sample_count;
+		double rate_timestamp;
+		double samplerate;
+		QString cells[ColumnCount];
+	};
+
+	/** Calculate the cells of the row in &cells. */
+	void update_row(Row &row, QString *cells);
+	QString format_value(double value, int decimal_places) const;
+
+	/**
+	 * The sample rate is measured over at least this time span in seconds,
+	 * so the rate of slow devices doesn't jump with every sample.
+	 */
+	static const double samplerate_interval_;
+
+	vector<Row> rows_;
+	sv::data::Formatter formatter_;
+
+};
+
+} // namespace views
+} // namespace ui
+} // namespace sv
+
+#endif // UI_VIEWS_STATISTICSTABLEMODEL_HPP
@@ -0,0 +1,259 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <QAbstractItemView>
+#include <QAction>
+#include <QHeaderView>
+#include <QModelIndex>
+#include <QSettings>
+#include <QTableView>
+#include <QToolBar>
+#include <QUuid>
+#include <QVBoxLayout>
+
+#include "statisticsview.hpp"
+#include "src/session.hpp"
+#include "src/settingsmanager.hpp"
+#include "src/tracer.hpp"
+#include "src/util.hpp"
+#include "src/channels/basechannel.hpp"
+#include "src/data/analogbasesignal.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/devices/basedevice.hpp"
+#include "src/ui/dialogs/selectsignaldialog.hpp"
+#include "src/ui/views/baseview.hpp"
+#include "src/ui/views/panelscheduler.hpp"
+#include "src/ui/views/statisticstablemodel.hpp"
+
+using std::dynamic_pointer_cast;
+using std::shared_ptr;
+
+namespace sv {
+namespace ui {
+namespace views {
+
+StatisticsView::StatisticsView(Session &session, QUuid uuid,
+		QWidget *parent) :
+	BaseView(session, uuid, parent),
+	action_add_signal_(new QAction(this)),
+	action_remove_signal_(new QAction(this))
+{
+	id_ = "statistics:" + util::format_uuid(uuid_);
+
+	setup_ui();
+	setup_toolbar();
+
+	session_.panel_scheduler()->add_panel(this, [this]() { on_update(); });
+}
+
+StatisticsView::~StatisticsView()
+{
+	session_.panel_scheduler()->remove_panel(this);
+	for (const auto &signal : signals_)
+		signal->remove_observer();
+}
+
+QString StatisticsView::title() const
+{
+	QString title = tr("Statistics");
+	if (!signals_.empty())
+		title = title.append(" ").append(signals_.at(0)->display_name());
+	return title;
+}
+
+void StatisticsView::setup_ui()
+{
+	QVBoxLayout *layout = new QVBoxLayout();
+
+	statistics_model_ = new StatisticsTableModel(this);
+	statistics_table_ = new QTableView();
+	statistics_table_->setModel(statistics_model_);
+	statistics_table_->setSelectionBehavior(QAbstractItemView::SelectRows);
+	statistics_table_->verticalHeader()->setSectionResizeMode(
+		QHeaderView::Fixed);
+	statistics_table_->horizontalHeader()->setDefaultAlignment(
+		Qt::AlignVCenter);
+	statistics_table_->horizontalHeader()->setStretchLastSection(true);
+	layout->addWidget(statistics_table_);
+
+	this->central_widget_->setLayout(layout);
+}
+
+void StatisticsView::setup_toolbar()
+{
+	action_add_signal_->setText(tr("Add signal"));
+	action_add_signal_->setIcon(
+		QIcon::fromTheme("office-chart-line",
+		QIcon(":/icons/office-chart-line.png")));
+	connect(action_add_signal_, &QAction::triggered,
+		this, &StatisticsView::on_action_add_signal_triggered);
+
+	action_remove_signal_->setText(tr("Remove signal"));
+	action_remove_signal_->setIcon(
+		QIcon::fromTheme("edit-delete",
+		QIcon(":/icons/edit-delete.png")));
+	connect(action_remove_signal_, &QAction::triggered,
+		this, &StatisticsView::on_action_remove_signal_triggered);
+
+	toolbar_ = new QToolBar("Statistics View Toolbar");
+	toolbar_->addAction(action_add_signal_);
+	toolbar_->addAction(action_remove_signal_);
+	this->addToolBar(Qt::TopToolBarArea, toolbar_);
+}
+
+void StatisticsView::save_settings(QSettings &settings,
+	shared_ptr<sv::devices::BaseDevice> origin_device) const
+{
+	BaseView::save_settings(settings, origin_device);
+
+	size_t i = 0;
+	for (const auto &signal : signals_) {
+		settings.beginGroup(QString("signal%1").arg(i++));
+		SettingsManager::save_signal(signal, settings, origin_device);
+		settings.endGroup();
+	}
+}
+
+void StatisticsView::restore_settings(QSettings &settings,
+	shared_ptr<sv::devices::BaseDevice> origin_device)
+{
+	BaseView::restore_settings(settings, origin_device);
+
+	const auto groups = settings.childGroups();
+	for (const auto &group : groups) {
+		if (group.startsWith("signal")) {
+			settings.beginGroup(group);
+			auto signal = SettingsManager::restore_signal(
+				session_, settings, origin_device);
+			if (signal) {
+				add_signal(
+					dynamic_pointer_cast<sv::data::AnalogTimeSignal>(signal));
+			}
+			settings.endGroup();
+		}
+	}
+}
+
+void StatisticsView::add_signal(shared_ptr<sv::data::AnalogTimeSignal> signal)
+{
+	if (!signal || std::find(signals_.begin(), signals_.end(), signal) !=
+			signals_.end())
+		return;
+
+	signals_.push_back(signal);
+	signal->add_observer();
+	statistics_model_->add_signal(signal);
+	if (!is_hibernated())
+		connect_signal(signal);
+
+	Q_EMIT title_changed();
+}
+
+void StatisticsView::connect_signal(
+	shared_ptr<sv::data::AnalogTimeSignal> signal)
+{
+	connect(signal.get(), &data::AnalogBaseSignal::samples_appended,
+		this, &StatisticsView::on_samples_appended);
+	connect(signal.get(), &data::AnalogBaseSignal::samples_cleared,
+		this, &StatisticsView::on_samples_appended);
+}
+
+void StatisticsView::disconnect_signal(
+	shared_ptr<sv::data::AnalogTimeSignal> signal)
+{
+	disconnect(signal.get(), &data::AnalogBaseSignal::samples_appended,
+		this, &StatisticsView::on_samples_appended);
+	disconnect(signal.get(), &data::AnalogBaseSignal::samples_cleared,
+		this, &StatisticsView::on_samples_appended);
+}
+
+void StatisticsView::hibernate()
+{
+	for (const auto &signal : signals_)
+		disconnect_signal(signal);
+}
+
+void StatisticsView::wake()
+{
+	for (const auto &signal : signals_)
+		connect_signal(signal);
+	// Show the values, that were appended while the view was hidden
+	session_.panel_scheduler()->set_changed(this);
+}
+
+void StatisticsView::on_update()
+{
+	SV_TRACE_SCOPE("StatisticsView::on_update");
+
+	statistics_model_->refresh();
+}
+
+void StatisticsView::on_samples_appended()
+{
+	session_.panel_scheduler()->set_changed(this);
+}
+
+void StatisticsView::on_action_add_signal_triggered()
+{
+	shared_ptr<sv::devices::BaseDevice> selected_device;
+	if (!signals_.empty())
+		selected_device = signals_[0]->parent_channel()->parent_device();
+
+	ui::dialogs::SelectSignalDialog dlg(session(), selected_device);
+	if (!dlg.exec())
+		return;
+
+	for (const auto &signal : dlg.signals()) {
+		add_signal(dynamic_pointer_cast<sv::data::AnalogTimeSignal>(signal));
+	}
+}
+
+void StatisticsView::on_action_remove_signal_triggered()
+{
+	const auto rows = statistics_table_->selectionModel()->selectedRows();
+	if (rows.empty())
+		return;
+
+	// Remove from the bottom, so the row numbers stay valid
+	vector<int> row_numbers;
+	for (const auto &index : rows)
+		row_numbers.push_back(index.row());
+	std::sort(row_numbers.rbegin(), row_numbers.rend());
+	for (const int row : row_numbers) {
+		auto signal = statistics_model_->signal(row);
+		if (!signal)
+			continue;
+		disconnect_signal(signal);
+		signal->remove_observer();
+		signals_.erase(
+			std::remove(signals_.begin(), signals_.end(), signal),
+			signals_.end());
+		statistics_model_->remove_signal(row);
+	}
+
+	Q_EMIT title_changed();
+}
+
+} // namespace views
+} // namespace ui
+} // namespace sv
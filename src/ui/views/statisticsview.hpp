@@ -0,0 +1,106 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_VIEWS_STATISTICSVIEW_HPP
+#define UI_VIEWS_STATISTICSVIEW_HPP
+
+#include <memory>
+#include <vector>
+
+#include <QAction>
+#include <QSettings>
+#include <QTableView>
+#include <QToolBar>
+#include <QUuid>
+
+#include "src/ui/views/baseview.hpp"
+
+using std::shared_ptr;
+using std::vector;
+
+namespace sv {
+
+class Session;
+
+namespace data {
+class AnalogTimeSignal;
+}
+namespace devices {
+class BaseDevice;
+}
+
+namespace ui {
+namespace views {
+
+class StatisticsTableModel;
+
+/**
+ * Shows the last value, min, max, mean, standard deviation, RMS and sample
+ * rate of many signals in one table. The table is refreshed with the ticks
+ * of the PanelScheduler, when its signals got new samples.
+ */
+class StatisticsView : public BaseView
+{
+	Q_OBJECT
+
+public:
+	explicit StatisticsView(Session& session, QUuid uuid = QUuid(),
+		QWidget* parent = nullptr);
+	~StatisticsView();
+
+	QString title() const override;
+	void add_signal(shared_ptr<sv::data::AnalogTimeSignal> signal);
+
+	void save_settings(QSettings &settings,
+		shared_ptr<sv::devices::BaseDevice> origin_device = nullptr) const override;
+	void restore_settings(QSettings &settings,
+		shared_ptr<sv::devices::BaseDevice> origin_device = nullptr) override;
+
+protected:
+	void hibernate() override;
+	void wake() override;
+
+private:
+	vector<shared_ptr<sv::data::AnalogTimeSignal>> signals_;
+
+	QAction *const action_add_signal_;
+	QAction *const action_remove_signal_;
+	QToolBar *toolbar_;
+	StatisticsTableModel *statistics_model_;
+	QTableView *statistics_table_;
+
+	void setup_ui();
+	void setup_toolbar();
+	void connect_signal(shared_ptr<sv::data::AnalogTimeSignal> signal);
+	void disconnect_signal(shared_ptr<sv::data::AnalogTimeSignal> signal);
+	/** Refresh the table, called by the PanelScheduler. */
+	void on_update();
+
+private Q_SLOTS:
+	void on_samples_appended();
+	void on_action_add_signal_triggered();
+	void on_action_remove_signal_triggered();
+
+};
+
+} // namespace views
+} // namespace ui
+} // namespace sv
+
+#endif // UI_VIEWS_STATISTICSVIEW_HPP
@@ -18,16 +18,17 @@
  */
 
 #include <cassert>
+#include <cmath>
 #include <memory>
 #include <string>
 #include <utility>
 
 #include <QApplication>
+#include <QComboBox>
 #include <QDateTime>
 #include <QDebug>
 #include <QHBoxLayout>
 #include <QSettings>
-#include <QTimer>
 #include <QUuid>
 #include <QVariant>
 #include <QVBoxLayout>
@@ -37,12 +38,15 @@
 #include "src/settingsmanager.hpp"
 #include "src/util.hpp"
 #include "src/channels/basechannel.hpp"
+#include "src/data/analogbasesignal.hpp"
 #include "src/data/analogtimesignal.hpp"
 #include "src/data/basesignal.hpp"
 #include "src/devices/basedevice.hpp"
 #include "src/ui/views/baseview.hpp"
+#include "src/ui/views/panelscheduler.hpp"
 #include "src/ui/views/viewhelper.hpp"
 #include "src/ui/widgets/monofontdisplay.hpp"
+#include "src/ui/widgets/sparkline.hpp"
 
 using std::dynamic_pointer_cast;
 using std::shared_ptr;
@@ -51,6 +55,8 @@ namespace sv {
 namespace ui {
 namespace views {
 
+const size_t ValuePanelView::trend_columns_ = 120;
+
 ValuePanelView::ValuePanelView(Session &session, QUuid uuid, QWidget *parent) :
 	BaseView(session, uuid, parent),
 	channel_(nullptr),
@@ -65,13 +71,16 @@ ValuePanelView::ValuePanelView(Session &session, QUuid uuid, QWidget *parent) :
 	setup_toolbar();
 	reset_display();
 
-	timer_ = new QTimer(this);
-	init_timer();
+	session_.panel_scheduler()->add_panel(this, [this]() { on_update(); });
 }
 
 ValuePanelView::~ValuePanelView()
 {
-	stop_timer();
+	session_.panel_scheduler()->remove_panel(this);
+	if (signal_) {
+		signal_->clear_observer_history(this);
+		signal_->remove_observer();
+	}
 }
 
 QString ValuePanelView::title() const
@@ -148,6 +157,9 @@ void ValuePanelView::setup_ui()
 	panel_layout->addWidget(value_min_display_, 1, 0, 1, 1, Qt::AlignHCenter);
 	panel_layout->addWidget(value_max_display_, 1, 1, 1, 1, Qt::AlignHCenter);
 	layout->addLayout(panel_layout);
+	sparkline_ = new widgets::Sparkline();
+	sparkline_->setToolTip(tr("Trend (min/max and mean)"));
+	layout->addWidget(sparkline_);
 	layout->addStretch(1);
 
 	this->central_widget_->setLayout(layout);
@@ -162,8 +174,20 @@ void ValuePanelView::setup_toolbar()
 	connect(action_reset_display_, &QAction::triggered,
 		this, &ValuePanelView::on_action_reset_display_triggered);
 
+	trend_duration_box_ = new QComboBox();
+	for (const int minutes : { 1, 5, 15, 60 })
+		trend_duration_box_->addItem(tr("%1 min").arg(minutes),
+			QVariant(minutes * 60));
+	trend_duration_box_->setCurrentIndex(
+		trend_duration_box_->findData(QVariant(5 * 60)));
+	trend_duration_box_->setToolTip(tr("Duration of the trend"));
+	connect(trend_duration_box_, SIGNAL(currentIndexChanged(int)),
+		this, SLOT(on_trend_duration_changed()));
+
 	toolbar_ = new QToolBar("Panel Toolbar");
 	toolbar_->addAction(action_reset_display_);
+	toolbar_->addSeparator();
+	toolbar_->addWidget(trend_duration_box_);
 	this->addToolBar(Qt::TopToolBarArea, toolbar_);
 }
 
@@ -238,6 +262,19 @@ void ValuePanelView::connect_signals_signal()
 	if (!signal_)
 		return;
 
+	signal_->add_observer();
+	// The min/max values are accumulated, only the trend needs the history
+	signal_->set_observer_history(
+		this, trend_duration_box_->currentData().toDouble());
+
+	// A hidden panel is connected, when it is shown again
+	if (!is_hibernated()) {
+		connect(signal_.get(), &data::AnalogBaseSignal::samples_appended,
+			this, &ValuePanelView::on_samples_appended);
+		// Show the last value of the new signal
+		session_.panel_scheduler()->set_changed(this);
+	}
+
 	//connect(signal_.get(), SIGNAL(unit_changed(QString)),
 	//	value_display_, SLOT(set_unit(const String)));
 	connect(signal_.get(), &data::AnalogTimeSignal::digits_changed,
@@ -253,6 +290,12 @@ void ValuePanelView::disconnect_signals_signal()
 	if (!signal_)
 		return;
 
+	signal_->clear_observer_history(this);
+	signal_->remove_observer();
+
+	disconnect(signal_.get(), &data::AnalogBaseSignal::samples_appended,
+		this, &ValuePanelView::on_samples_appended);
+
 	//disconnect(signal_.get(), SIGNAL(unit_changed(QString)),
 	//	value_display_, SLOT(set_unit(QString)));
 	disconnect(signal_.get(), &data::AnalogTimeSignal::digits_changed,
@@ -263,6 +306,26 @@ void ValuePanelView::disconnect_signals_signal()
 		value_max_display_, &widgets::ValueDisplay::set_digits);
 }
 
+void ValuePanelView::hibernate()
+{
+	if (!signal_)
+		return;
+
+	disconnect(signal_.get(), &data::AnalogBaseSignal::samples_appended,
+		this, &ValuePanelView::on_samples_appended);
+}
+
+void ValuePanelView::wake()
+{
+	if (!signal_)
+		return;
+
+	connect(signal_.get(), &data::AnalogBaseSignal::samples_appended,
+		this, &ValuePanelView::on_samples_appended);
+	// Show the values, that were appended while the panel was hidden
+	session_.panel_scheduler()->set_changed(this);
+}
+
 void ValuePanelView::save_settings(QSettings &settings,
 	shared_ptr<sv::devices::BaseDevice> origin_device) const
 {
@@ -272,6 +335,7 @@ void ValuePanelView::save_settings(QSettings &settings,
 		SettingsManager::save_signal(signal_, settings, origin_device);
 	else
 		SettingsManager::save_channel(channel_, settings, origin_device);
+	settings.setValue("trend_duration", trend_duration_box_->currentData());
 }
 
 void ValuePanelView::restore_settings(QSettings &settings,
@@ -279,6 +343,20 @@ void ValuePanelView::restore_settings(QSettings &settings,
 {
 	BaseView::restore_settings(settings, origin_device);
 
+	if (settings.contains("trend_duration")) {
+		int index = trend_duration_box_->findData(
+			settings.value("trend_duration"));
+		if (index >= 0) {
+			trend_duration_box_->blockSignals(true);
+			trend_duration_box_->setCurrentIndex(index);
+			trend_duration_box_->blockSignals(false);
+			if (signal_) {
+				signal_->set_observer_history(
+					this, trend_duration_box_->currentData().toDouble());
+			}
+		}
+	}
+
 	auto signal = SettingsManager::restore_signal(
 		session_, settings, origin_device);
 	if (signal) {
@@ -300,24 +378,13 @@ void ValuePanelView::reset_display()
 	value_max_display_->reset_value();
 }
 
-void ValuePanelView::init_timer()
+void ValuePanelView::init_values()
 {
 	value_min_ = std::numeric_limits<double>::max();
 	value_max_ = std::numeric_limits<double>::lowest();
 
-	connect(timer_, &QTimer::timeout, this, &ValuePanelView::on_update);
-	timer_->start(250);
-}
-
-void ValuePanelView::stop_timer()
-{
-	if (!timer_->isActive())
-		return;
-
-	timer_->stop();
-	disconnect(timer_, &QTimer::timeout, this, &ValuePanelView::on_update);
-
 	reset_display();
+	session_.panel_scheduler()->set_changed(this);
 }
 
 void ValuePanelView::on_update()
@@ -337,6 +404,31 @@ void ValuePanelView::on_update()
 	value_display_->set_value(value);
 	value_min_display_->set_value(value_min_);
 	value_max_display_->set_value(value_max_);
+
+	update_trend();
+}
+
+void ValuePanelView::update_trend()
+{
+	if (!signal_ || signal_->sample_count() == 0) {
+		sparkline_->clear();
+		return;
+	}
+
+	// The bins are aligned to multiples of their length, so the min/max of
+	// a bin doesn't jitter, when the trend moves on.
+	const double duration = trend_duration_box_->currentData().toDouble();
+	const double bin_length = duration / (double)trend_columns_;
+	const double end = std::ceil(
+		signal_->last_timestamp(false) / bin_length) * bin_length;
+	const double start = end - duration;
+	sparkline_->set_trend(
+		signal_->get_summaries(start, end, trend_columns_, false), start, end);
+}
+
+void ValuePanelView::on_samples_appended()
+{
+	session_.panel_scheduler()->set_changed(this);
 }
 
 void ValuePanelView::on_signal_changed()
@@ -349,8 +441,10 @@ void ValuePanelView::on_signal_changed()
 
 	signal_ = dynamic_pointer_cast<sv::data::AnalogTimeSignal>(
 		channel_->actual_signal());
-	if (!signal_)
+	if (!signal_) {
+		sparkline_->clear();
 		return;
+	}
 	init_displays();
 
 	connect_signals_signal();
@@ -360,8 +454,16 @@ void ValuePanelView::on_signal_changed()
 
 void ValuePanelView::on_action_reset_display_triggered()
 {
-	stop_timer();
-	init_timer();
+	init_values();
+}
+
+void ValuePanelView::on_trend_duration_changed()
+{
+	if (signal_) {
+		signal_->set_observer_history(
+			this, trend_duration_box_->currentData().toDouble());
+	}
+	update_trend();
 }
 
 } // namespace views
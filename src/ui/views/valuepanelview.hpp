@@ -20,13 +20,14 @@
 #ifndef UI_VIEWS_VALUEPANELVIEW_HPP
 #define UI_VIEWS_VALUEPANELVIEW_HPP
 
+#include <cstddef>
 #include <memory>
 #include <set>
 
 #include <QAction>
+#include <QComboBox>
 #include <QSettings>
 #include <QString>
-#include <QTimer>
 #include <QToolBar>
 #include <QUuid>
 
@@ -53,6 +54,7 @@ class BaseDevice;
 namespace ui {
 
 namespace widgets {
+class Sparkline;
 class ValueDisplay;
 }
 
@@ -77,21 +79,28 @@ public:
 	void restore_settings(QSettings &settings,
 		shared_ptr<sv::devices::BaseDevice> origin_device = nullptr) override;
 
+protected:
+	void hibernate() override;
+	void wake() override;
+
 private:
 	shared_ptr<channels::BaseChannel> channel_;
 	shared_ptr<sv::data::AnalogTimeSignal> signal_;
 
-	QTimer *timer_;
-
 	// Min/max/actual values are stored here, so they can be reseted
 	double value_min_;
 	double value_max_;
 
 	QAction *const action_reset_display_;
+	QComboBox *trend_duration_box_;
 	QToolBar *toolbar_;
 	widgets::ValueDisplay *value_display_;
 	widgets::ValueDisplay *value_min_display_;
 	widgets::ValueDisplay *value_max_display_;
+	widgets::Sparkline *sparkline_;
+
+	/** The number of bins of the trend, independent of the sample count. */
+	static const size_t trend_columns_;
 
 	void setup_ui();
 	void setup_toolbar();
@@ -101,13 +110,18 @@ private:
 	void connect_signals_signal();
 	void disconnect_signals_signal();
 	void reset_display();
-	void init_timer();
-	void stop_timer();
+	/** Reset the min/max values and the displays. */
+	void init_values();
+	/** Called by the PanelScheduler for new samples. */
+	void on_update();
+	/** Draw the trend of the last minutes from the min/max pyramid. */
+	void update_trend();
 
 private Q_SLOTS:
-	void on_update();
+	void on_samples_appended();
 	void on_signal_changed();
 	void on_action_reset_display_triggered();
+	void on_trend_duration_changed();
 
 };
 
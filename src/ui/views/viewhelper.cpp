@@ -42,13 +42,17 @@
 #include "src/ui/views/dataview.hpp"
 #include "src/ui/views/baseview.hpp"
 #include "src/ui/views/democontrolview.hpp"
+#include "src/ui/views/frameoverlayview.hpp"
 #include "src/ui/views/genericcontrolview.hpp"
+#include "src/ui/views/histogramview.hpp"
 #include "src/ui/views/measurementcontrolview.hpp"
 #include "src/ui/views/powerpanelview.hpp"
 #include "src/ui/views/sequenceoutputview.hpp"
 #include "src/ui/views/smuscriptoutputview.hpp"
 #include "src/ui/views/smuscriptview.hpp"
 #include "src/ui/views/sourcesinkcontrolview.hpp"
+#include "src/ui/views/spectrumview.hpp"
+#include "src/ui/views/statisticsview.hpp"
 #include "src/ui/views/timeplotview.hpp"
 #include "src/ui/views/valuepanelview.hpp"
 #include "src/ui/views/xyplotview.hpp"
@@ -163,6 +167,18 @@ BaseView *get_view_from_settings(Session &session, QSettings &settings,
 	else if (type == "valuepanel") {
 		view = new ValuePanelView(session, uuid);
 	}
+	else if (type == "spectrum") {
+		view = new SpectrumView(session, uuid);
+	}
+	else if (type == "histogram") {
+		view = new HistogramView(session, uuid);
+	}
+	else if (type == "statistics") {
+		view = new StatisticsView(session, uuid);
+	}
+	else if (type == "frameoverlay") {
+		view = new FrameOverlayView(session, uuid);
+	}
 	else if (type == "sequenceoutput") {
 		view = new SequenceOutputView(session, uuid);
 	}
@@ -0,0 +1,99 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <limits>
+#include <memory>
+
+#include <QAbstractTableModel>
+#include <QModelIndex>
+#include <QString>
+#include <QVariant>
+
+#include "waveformtablemodel.hpp"
+#include "src/devices/waveformsequence.hpp"
+
+namespace sv {
+namespace ui {
+namespace views {
+
+WaveformTableModel::WaveformTableModel(QObject *parent) :
+	QAbstractTableModel(parent),
+	waveform_(nullptr),
+	decimal_places_(3)
+{
+}
+
+void WaveformTableModel::set_waveform(
+	shared_ptr<devices::WaveformSequence> waveform, int decimal_places)
+{
+	beginResetModel();
+	waveform_ = waveform;
+	decimal_places_ = decimal_places;
+	endResetModel();
+}
+
+shared_ptr<devices::WaveformSequence> WaveformTableModel::waveform() const
+{
+	return waveform_;
+}
+
+int WaveformTableModel::rowCount(const QModelIndex &parent) const
+{
+	if (parent.isValid() || !waveform_)
+		return 0;
+	// The views can't handle more than INT_MAX rows
+	if (waveform_->sample_count() > (size_t)std::numeric_limits<int>::max())
+		return std::numeric_limits<int>::max();
+	return (int)waveform_->sample_count();
+}
+
+int WaveformTableModel::columnCount(const QModelIndex &parent) const
+{
+	return parent.isValid() ? 0 : 2;
+}
+
+QVariant WaveformTableModel::data(const QModelIndex &index, int role) const
+{
+	if (role != Qt::DisplayRole || !index.isValid() ||
+			index.row() >= rowCount() || index.column() > 1)
+		return QVariant();
+
+	if (index.column() == 0) {
+		return QString("%L1").arg(
+			waveform_->value((size_t)index.row()), 0, 'f', decimal_places_);
+	}
+	return QString("%L1").arg(waveform_->interval(), 0, 'f', 3);
+}
+
+QVariant WaveformTableModel::headerData(int section,
+	Qt::Orientation orientation, int role) const
+{
+	if (role != Qt::DisplayRole || orientation != Qt::Horizontal)
+		return QAbstractTableModel::headerData(section, orientation, role);
+
+	if (section == 0)
+		return tr("Value");
+	if (section == 1)
+		return tr("Delay [s]");
+	return QVariant();
+}
+
+} // namespace views
+} // namespace ui
+} // namespace sv
@@ -0,0 +1,74 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_VIEWS_WAVEFORMTABLEMODEL_HPP
+#define UI_VIEWS_WAVEFORMTABLEMODEL_HPP
+
+#include <memory>
+
+#include <QAbstractTableModel>
+#include <QModelIndex>
+#include <QObject>
+#include <QVariant>
+
+using std::shared_ptr;
+
+namespace sv {
+
+namespace devices {
+class WaveformSequence;
+}
+
+namespace ui {
+namespace views {
+
+/**
+ * A read only table model with the values and delays of a generated
+ * WaveformSequence, like the sequence table. The values are calculated only
+ * for the rows, that are actually shown.
+ */
+class WaveformTableModel : public QAbstractTableModel
+{
+	Q_OBJECT
+
+public:
+	explicit WaveformTableModel(QObject *parent = nullptr);
+
+	void set_waveform(shared_ptr<sv::devices::WaveformSequence> waveform,
+		int decimal_places);
+	shared_ptr<sv::devices::WaveformSequence> waveform() const;
+
+	int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+	int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+	QVariant data(const QModelIndex &index,
+		int role = Qt::DisplayRole) const override;
+	QVariant headerData(int section, Qt::Orientation orientation,
+		int role = Qt::DisplayRole) const override;
+
+private:
+	shared_ptr<sv::devices::WaveformSequence> waveform_;
+	int decimal_places_;
+
+};
+
+} // namespace views
+} // namespace ui
+} // namespace sv
+
+#endif // UI_VIEWS_WAVEFORMTABLEMODEL_HPP
@@ -136,7 +136,9 @@ void LcdDisplay::update_unit_widget_dimensions()
 		str.append(" ").append(unit_suffix_);
 	}
 	QFontMetrics metrics = unit_label_->fontMetrics();
-	unit_label_->setFixedWidth(metrics.boundingRect(str).width());
+	// A fixed size doesn't trigger a relayout when the SI prefix is changing
+	unit_label_->setFixedSize(
+		metrics.boundingRect(str).width(), metrics.height());
 }
 
 void LcdDisplay::show_value(const QString &value)
@@ -123,8 +123,9 @@ void MonoFontDisplay::setup_ui()
 
 void MonoFontDisplay::update_value_widget_dimensions()
 {
-	// Set the widget to a fixed width, so it doesn't jump around when the
-	// length of the string is changing (e.g. minus sign).
+	// Set the widget to a fixed size, so it doesn't jump around when the
+	// length of the string is changing (e.g. minus sign). With a fixed
+	// size, setText() also doesn't trigger a relayout of the display.
 	// TODO: Displays are too small (not wide enough) for neg. values, esp. for
 	//       the power panel for W/Ah/Wh for the 6632B. B/c of the decimal
 	//       point?
@@ -135,9 +136,10 @@ void MonoFontDisplay::update_value_widget_dimensions()
 	}
 	QFontMetrics metrics = value_label_->fontMetrics();
 #if QT_VERSION >= QT_VERSION_CHECK(5, 11, 0)
-	value_label_->setFixedWidth(metrics.horizontalAdvance(str));
+	value_label_->setFixedSize(
+		metrics.horizontalAdvance(str), metrics.height());
 #else
-	value_label_->setFixedWidth(metrics.width(str));
+	value_label_->setFixedSize(metrics.width(str), metrics.height());
 #endif
 }
 
@@ -148,8 +150,8 @@ void MonoFontDisplay::update_extra_widget_dimensions()
 
 void MonoFontDisplay::update_unit_widget_dimensions()
 {
-	// Set the widget to a fixed width, so it doesn't jump around when the
-	// SI prefix is changing.
+	// Set the widget to a fixed size, so it doesn't jump around and doesn't
+	// trigger a relayout when the SI prefix is changing.
 	QString str;
 	if (auto_range_) {
 		// 'm' is the widest character for non monospace fonts
@@ -161,9 +163,10 @@ void MonoFontDisplay::update_unit_widget_dimensions()
 	}
 	QFontMetrics metrics = unit_label_->fontMetrics();
 #if QT_VERSION >= QT_VERSION_CHECK(5, 11, 0)
-	unit_label_->setFixedWidth(metrics.horizontalAdvance(str));
+	unit_label_->setFixedSize(
+		metrics.horizontalAdvance(str), metrics.height());
 #else
-	unit_label_->setFixedWidth(metrics.width(str));
+	unit_label_->setFixedSize(metrics.width(str), metrics.height());
 #endif
 }
 
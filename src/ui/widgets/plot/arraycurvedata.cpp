@@ -0,0 +1,322 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
+
+#include <QPointF>
+#include <QPolygonF>
+#include <QRectF>
+#include <QSettings>
+#include <QString>
+
+#include "arraycurvedata.hpp"
+#include "src/data/datautil.hpp"
+#include "src/data/nearestpointindex.hpp"
+#include "src/devices/basedevice.hpp"
+#include "src/ui/widgets/plot/basecurvedata.hpp"
+
+using std::lock_guard;
+using std::mutex;
+using std::set;
+using std::shared_ptr;
+using std::vector;
+
+namespace sv {
+namespace ui {
+namespace widgets {
+namespace plot {
+
+ArrayCurveData::ArrayCurveData(shared_ptr<const vector<double>> x_values,
+		shared_ptr<const vector<double>> y_values, const QString &name,
+		sv::data::Quantity x_quantity,
+		const set<sv::data::QuantityFlag> &x_quantity_flags,
+		sv::data::Unit x_unit,
+		sv::data::Quantity y_quantity,
+		const set<sv::data::QuantityFlag> &y_quantity_flags,
+		sv::data::Unit y_unit) :
+	BaseCurveData(CurveType::XYCurve),
+	x_values_(x_values),
+	y_values_(y_values),
+	x_(x_values->data()),
+	y_(y_values->data()),
+	size_(std::min(x_values->size(), y_values->size())),
+	sorted_(true),
+	name_(name),
+	x_quantity_(x_quantity),
+	x_quantity_flags_(x_quantity_flags),
+	x_unit_(x_unit),
+	y_quantity_(y_quantity),
+	y_quantity_flags_(y_quantity_flags),
+	y_unit_(y_unit)
+{
+	// The arrays never change, so the bounds are only calculated once
+	double x_min = std::numeric_limits<double>::max();
+	double x_max = std::numeric_limits<double>::lowest();
+	double y_min = std::numeric_limits<double>::max();
+	double y_max = std::numeric_limits<double>::lowest();
+	for (size_t i = 0; i < size_; ++i) {
+		if (i > 0 && !(x_[i] >= x_[i-1]))
+			sorted_ = false;
+		if (!std::isfinite(x_[i]) || !std::isfinite(y_[i]))
+			continue;
+		x_min = std::min(x_min, x_[i]);
+		x_max = std::max(x_max, x_[i]);
+		y_min = std::min(y_min, y_[i]);
+		y_max = std::max(y_max, y_[i]);
+	}
+	// top left, bottom right
+	if (x_min <= x_max)
+		bounding_rect_ = QRectF(QPointF(x_min, y_max), QPointF(x_max, y_min));
+}
+
+bool ArrayCurveData::is_equal(const BaseCurveData *other) const
+{
+	const ArrayCurveData *acd = dynamic_cast<const ArrayCurveData *>(other);
+	if (acd == nullptr)
+		return false;
+
+	return (x_values_ == acd->x_values()) && (y_values_ == acd->y_values());
+}
+
+BaseCurveData *ArrayCurveData::clone() const
+{
+	// The clone shares the arrays
+	ArrayCurveData *curve_data = new ArrayCurveData(x_values_, y_values_,
+		name_, x_quantity_, x_quantity_flags_, x_unit_,
+		y_quantity_, y_quantity_flags_, y_unit_);
+	curve_data->set_relative_time(relative_time_);
+	return curve_data;
+}
+
+BaseCurveData *ArrayCurveData::freeze() const
+{
+	return clone();
+}
+
+QPointF ArrayCurveData::sample(size_t i) const
+{
+	return QPointF(x_[i], y_[i]);
+}
+
+size_t ArrayCurveData::size() const
+{
+	return size_;
+}
+
+QRectF ArrayCurveData::boundingRect() const
+{
+	return bounding_rect_;
+}
+
+QPointF ArrayCurveData::closest_point(const QPointF &pos, double *dist) const
+{
+	if (size_ == 0)
+		return QPointF(0, 0);
+
+	size_t index;
+	if (sorted_) {
+		// Take the closer one of the two neighbours in x direction
+		index = std::lower_bound(x_, x_ + size_, pos.x()) - x_;
+		if (index >= size_ || (index > 0 &&
+				pos.x() - x_[index-1] < x_[index] - pos.x()))
+			--index;
+		if (dist)
+			*dist = std::hypot(x_[index] - pos.x(), y_[index] - pos.y());
+	}
+	else {
+		lock_guard<mutex> lock(point_index_mutex_);
+		if (point_index_.size() == 0)
+			point_index_.append(x_, y_, size_);
+		double dmin;
+		if (!point_index_.nearest(pos.x(), pos.y(), index, dmin))
+			return QPointF(0, 0);
+		if (dist)
+			*dist = std::sqrt(dmin);
+	}
+	return sample(index);
+}
+
+bool ArrayCurveData::envelope(double x_min, double x_max, size_t columns,
+	QPolygonF &points) const
+{
+	if (!sorted_ || columns == 0 || x_max <= x_min)
+		return false;
+
+	// Only decimate, if there are more samples than the envelope has points
+	const size_t first = std::lower_bound(x_, x_ + size_, x_min) - x_;
+	const size_t last = std::upper_bound(x_ + first, x_ + size_, x_max) - x_;
+	if (last - first <= 2 * columns)
+		return false;
+
+	points.clear();
+	points.reserve((int)(2 * columns + 2));
+
+	// Connect the envelope with the samples outside of the range
+	if (first > 0)
+		points.append(sample(first - 1));
+	const double column_width = (x_max - x_min) / (double)columns;
+	size_t i = first;
+	while (i < last) {
+		const size_t column = std::min(columns - 1,
+			(size_t)((x_[i] - x_min) / column_width));
+		const bool is_last_column = column == columns - 1;
+		const double column_end = x_min + (double)(column + 1) * column_width;
+		double min = y_[i];
+		double max = y_[i];
+		size_t j = i + 1;
+		for (; j < last && (is_last_column || x_[j] < column_end); ++j) {
+			// fmin()/fmax() skip NaN values
+			min = std::fmin(min, y_[j]);
+			max = std::fmax(max, y_[j]);
+		}
+
+		if (std::isnan(min)) {
+			// Nothing to draw in this column
+		}
+		else if (min == max) {
+			points.append(QPointF(x_[i], min));
+		}
+		else {
+			// Start with the extreme value, that is closer to the previous
+			// point, so there are less lines across the envelope.
+			const bool min_first = points.isEmpty() ||
+				points.last().y() < (min + max) / 2.;
+			points.append(QPointF(x_[i], min_first ? min : max));
+			points.append(QPointF(x_[j-1], min_first ? max : min));
+		}
+		i = j;
+	}
+	if (last < size_)
+		points.append(sample(last));
+
+	return true;
+}
+
+bool ArrayCurveData::visible_range(double x_min, double x_max,
+	size_t &first, size_t &last) const
+{
+	if (!sorted_ || size_ == 0)
+		return false;
+
+	// Add the samples before and after the range for the lines to the edges
+	const size_t begin = std::lower_bound(x_, x_ + size_, x_min) - x_;
+	const size_t end = std::upper_bound(x_ + begin, x_ + size_, x_max) - x_;
+	first = begin > 0 ? begin - 1 : 0;
+	last = std::max(first, std::min(end, size_ - 1));
+	return true;
+}
+
+QString ArrayCurveData::name() const
+{
+	if (name_.isEmpty())
+		return data::datautil::format_quantity(y_quantity_);
+	return name_;
+}
+
+string ArrayCurveData::id_prefix() const
+{
+	return "arraycurve";
+}
+
+sv::data::Quantity ArrayCurveData::x_quantity() const
+{
+	return x_quantity_;
+}
+
+set<sv::data::QuantityFlag> ArrayCurveData::x_quantity_flags() const
+{
+	return x_quantity_flags_;
+}
+
+sv::data::Unit ArrayCurveData::x_unit() const
+{
+	return x_unit_;
+}
+
+QString ArrayCurveData::x_unit_str() const
+{
+	return data::datautil::format_unit(x_unit(), x_quantity_flags());
+}
+
+QString ArrayCurveData::x_title() const
+{
+	// Don't use only the unit, so we can add AC/DC to axis label.
+	return QString("%1 [%2]").
+		arg(data::datautil::format_quantity(x_quantity()), x_unit_str());
+}
+
+sv::data::Quantity ArrayCurveData::y_quantity() const
+{
+	return y_quantity_;
+}
+
+set<sv::data::QuantityFlag> ArrayCurveData::y_quantity_flags() const
+{
+	return y_quantity_flags_;
+}
+
+sv::data::Unit ArrayCurveData::y_unit() const
+{
+	return y_unit_;
+}
+
+QString ArrayCurveData::y_unit_str() const
+{
+	return data::datautil::format_unit(y_unit(), y_quantity_flags());
+}
+
+QString ArrayCurveData::y_title() const
+{
+	// Don't use only the unit, so we can add AC/DC to axis label.
+	return QString("%1 [%2]").
+		arg(data::datautil::format_quantity(y_quantity()), y_unit_str());
+}
+
+shared_ptr<const vector<double>> ArrayCurveData::x_values() const
+{
+	return x_values_;
+}
+
+shared_ptr<const vector<double>> ArrayCurveData::y_values() const
+{
+	return y_values_;
+}
+
+bool ArrayCurveData::is_sorted() const
+{
+	return sorted_;
+}
+
+void ArrayCurveData::save_settings(QSettings &settings,
+	shared_ptr<sv::devices::BaseDevice> origin_device) const
+{
+	(void)settings;
+	(void)origin_device;
+}
+
+} // namespace plot
+} // namespace widgets
+} // namespace ui
+} // namespace sv
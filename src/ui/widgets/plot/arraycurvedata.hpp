@@ -0,0 +1,144 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_WIDGETS_PLOT_ARRAYCURVEDATA_HPP
+#define UI_WIDGETS_PLOT_ARRAYCURVEDATA_HPP
+
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <QPointF>
+#include <QPolygonF>
+#include <QRectF>
+#include <QSettings>
+#include <QString>
+
+#include "src/data/datautil.hpp"
+#include "src/data/nearestpointindex.hpp"
+#include "src/ui/widgets/plot/basecurvedata.hpp"
+
+using std::mutex;
+using std::set;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+
+namespace devices {
+class BaseDevice;
+}
+
+namespace ui {
+namespace widgets {
+namespace plot {
+
+/**
+ * Curve data for precomputed samples in two contiguous arrays, e.g. a fit
+ * or a spectrum calculated by a script, that are not backed by a signal.
+ *
+ * The arrays are immutable and shared with the clones of the curve data,
+ * so they can be read from the worker threads without locking. When the x
+ * values are sorted, only the visible samples are drawn and the envelope is
+ * calculated directly from the arrays.
+ */
+class ArrayCurveData : public BaseCurveData
+{
+	Q_OBJECT
+
+public:
+	ArrayCurveData(shared_ptr<const vector<double>> x_values,
+		shared_ptr<const vector<double>> y_values, const QString &name,
+		sv::data::Quantity x_quantity,
+		const set<sv::data::QuantityFlag> &x_quantity_flags,
+		sv::data::Unit x_unit,
+		sv::data::Quantity y_quantity,
+		const set<sv::data::QuantityFlag> &y_quantity_flags,
+		sv::data::Unit y_unit);
+
+	bool is_equal(const BaseCurveData *other) const override;
+	BaseCurveData *clone() const override;
+	/** The arrays are immutable, so a frozen curve is just a clone. */
+	BaseCurveData *freeze() const override;
+
+	QPointF sample(size_t i) const override;
+	size_t size() const override;
+	QRectF boundingRect() const override;
+
+	QPointF closest_point(const QPointF &pos, double *dist) const override;
+	bool envelope(double x_min, double x_max, size_t columns,
+		QPolygonF &points) const override;
+	bool visible_range(double x_min, double x_max,
+		size_t &first, size_t &last) const override;
+
+	QString name() const override;
+	string id_prefix() const override;
+	sv::data::Quantity x_quantity() const override;
+	set<sv::data::QuantityFlag> x_quantity_flags() const override;
+	sv::data::Unit x_unit() const override;
+	QString x_unit_str() const override;
+	QString x_title() const override;
+	sv::data::Quantity y_quantity() const override;
+	set<sv::data::QuantityFlag> y_quantity_flags() const override;
+	sv::data::Unit y_unit() const override;
+	QString y_unit_str() const override;
+	QString y_title() const override;
+
+	shared_ptr<const vector<double>> x_values() const;
+	shared_ptr<const vector<double>> y_values() const;
+	/** Return true if the x values are in ascending order. */
+	bool is_sorted() const;
+
+	/**
+	 * The samples are not saved, so the curve isn't restored with the plot.
+	 */
+	void save_settings(QSettings &settings,
+		shared_ptr<sv::devices::BaseDevice> origin_device) const override;
+
+private:
+	shared_ptr<const vector<double>> x_values_;
+	shared_ptr<const vector<double>> y_values_;
+	/** Raw pointers into the arrays for the per sample access. */
+	const double *x_;
+	const double *y_;
+	size_t size_;
+	bool sorted_;
+	QRectF bounding_rect_;
+	const QString name_;
+	const sv::data::Quantity x_quantity_;
+	const set<sv::data::QuantityFlag> x_quantity_flags_;
+	const sv::data::Unit x_unit_;
+	const sv::data::Quantity y_quantity_;
+	const set<sv::data::QuantityFlag> y_quantity_flags_;
+	const sv::data::Unit y_unit_;
+	/** Only built for unsorted x values, when a marker needs it. */
+	mutable sv::data::NearestPointIndex point_index_;
+	mutable mutex point_index_mutex_;
+
+};
+
+} // namespace plot
+} // namespace widgets
+} // namespace ui
+} // namespace sv
+
+#endif // UI_WIDGETS_PLOT_ARRAYCURVEDATA_HPP
@@ -0,0 +1,121 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QPainter>
+#include <QPalette>
+#include <QPixmap>
+#include <QPoint>
+#include <QRect>
+#include <QRectF>
+#include <QWidget>
+#include <qwt_plot_grid.h>
+#include <qwt_scale_div.h>
+#include <qwt_scale_map.h>
+
+#include "backgroundlayer.hpp"
+
+namespace sv {
+namespace ui {
+namespace widgets {
+namespace plot {
+
+BackgroundLayer::BackgroundLayer() :
+	valid_(false),
+	device_pixel_ratio_(1.),
+	y_p1_(0.),
+	y_p2_(0.),
+	y_s1_(0.),
+	y_s2_(0.),
+	palette_key_(0),
+	render_count_(0)
+{
+	grid_ = new QwtPlotGrid();
+	grid_->enableX(false);
+	grid_->enableXMin(false);
+	grid_->enableY(true);
+	grid_->enableYMin(false);
+}
+
+BackgroundLayer::~BackgroundLayer()
+{
+	delete grid_;
+}
+
+void BackgroundLayer::invalidate()
+{
+	valid_ = false;
+}
+
+bool BackgroundLayer::is_valid(const QWidget *canvas,
+	const QwtScaleMap &y_map, const QwtScaleDiv &y_div) const
+{
+	return valid_ && size_ == canvas->size() &&
+		device_pixel_ratio_ == canvas->devicePixelRatioF() &&
+		y_p1_ == y_map.p1() && y_p2_ == y_map.p2() &&
+		y_s1_ == y_map.s1() && y_s2_ == y_map.s2() && y_div_ == y_div &&
+		palette_key_ == canvas->palette().cacheKey();
+}
+
+void BackgroundLayer::draw(QPainter *painter, const QWidget *canvas,
+	const QwtScaleMap &x_map, const QwtScaleMap &y_map,
+	const QwtScaleDiv &y_div)
+{
+	if (!is_valid(canvas, y_map, y_div)) {
+		size_ = canvas->size();
+		device_pixel_ratio_ = canvas->devicePixelRatioF();
+		y_p1_ = y_map.p1();
+		y_p2_ = y_map.p2();
+		y_s1_ = y_map.s1();
+		y_s2_ = y_map.s2();
+		y_div_ = y_div;
+		palette_key_ = canvas->palette().cacheKey();
+
+		pixmap_ = QPixmap(size_ * device_pixel_ratio_);
+		pixmap_.setDevicePixelRatio(device_pixel_ratio_);
+		const QRect rect(QPoint(0, 0), size_);
+		QPainter pixmap_painter(&pixmap_);
+		pixmap_painter.fillRect(rect,
+			canvas->palette().brush(QPalette::Window));
+		draw_grid(&pixmap_painter, rect, x_map, y_map, y_div);
+		pixmap_painter.end();
+
+		valid_ = true;
+		++render_count_;
+	}
+
+	// The painter is clipped to the rounded border of the canvas
+	painter->drawPixmap(0, 0, pixmap_);
+}
+
+void BackgroundLayer::draw_grid(QPainter *painter, const QRectF &canvas_rect,
+	const QwtScaleMap &x_map, const QwtScaleMap &y_map,
+	const QwtScaleDiv &y_div) const
+{
+	grid_->setYDiv(y_div);
+	painter->save();
+	painter->setRenderHint(QPainter::Antialiasing,
+		grid_->testRenderHint(QwtPlotItem::RenderAntialiased));
+	grid_->draw(painter, x_map, y_map, canvas_rect);
+	painter->restore();
+}
+
+} // namespace plot
+} // namespace widgets
+} // namespace ui
+} // namespace sv
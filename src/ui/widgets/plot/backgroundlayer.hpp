@@ -0,0 +1,111 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_WIDGETS_PLOT_BACKGROUNDLAYER_HPP
+#define UI_WIDGETS_PLOT_BACKGROUNDLAYER_HPP
+
+#include <cstddef>
+
+#include <QPixmap>
+#include <QRectF>
+#include <QSize>
+#include <qwt_scale_div.h>
+
+class QPainter;
+class QPalette;
+class QWidget;
+class QwtPlotGrid;
+class QwtScaleMap;
+
+namespace sv {
+namespace ui {
+namespace widgets {
+namespace plot {
+
+/**
+ * The static bottom layer of a plot canvas: The background gradient and
+ * the grid lines of the y axis.
+ *
+ * The layer is rendered once into a pixmap, that is only rendered again,
+ * when the size of the canvas, the y scale or the palette changes, or when
+ * invalidate() is called, e.g. for a new grid pen. So a replot or the
+ * exposed strip of a scrolling time axis only copies the pixmap. The grid
+ * lines of the x axis move with the time axis and are drawn with the
+ * curves.
+ */
+class BackgroundLayer
+{
+public:
+	BackgroundLayer();
+	~BackgroundLayer();
+
+	BackgroundLayer(const BackgroundLayer &) = delete;
+	BackgroundLayer &operator=(const BackgroundLayer &) = delete;
+
+	/** The grid lines of the y axis, that are drawn into the layer. */
+	QwtPlotGrid *grid() const { return grid_; }
+
+	/** Render the layer again with the next draw(). */
+	void invalidate();
+
+	/**
+	 * Draw the layer to the canvas widget, the painter must paint on it.
+	 * The background is filled with the window brush of the palette of the
+	 * canvas.
+	 */
+	void draw(QPainter *painter, const QWidget *canvas,
+		const QwtScaleMap &x_map, const QwtScaleMap &y_map,
+		const QwtScaleDiv &y_div);
+	/**
+	 * Draw only the grid lines without the cache, e.g. when the plot is
+	 * exported or on an OpenGL canvas, which draws the background itself.
+	 */
+	void draw_grid(QPainter *painter, const QRectF &canvas_rect,
+		const QwtScaleMap &x_map, const QwtScaleMap &y_map,
+		const QwtScaleDiv &y_div) const;
+
+	/** Return how often the layer was rendered into the pixmap. */
+	size_t render_count() const { return render_count_; }
+
+private:
+	bool is_valid(const QWidget *canvas, const QwtScaleMap &y_map,
+		const QwtScaleDiv &y_div) const;
+
+	QwtPlotGrid *grid_;
+	QPixmap pixmap_;
+	bool valid_;
+	/** The key of the content of the pixmap. */
+	QSize size_;
+	qreal device_pixel_ratio_;
+	double y_p1_;
+	double y_p2_;
+	double y_s1_;
+	double y_s2_;
+	QwtScaleDiv y_div_;
+	qint64 palette_key_;
+	size_t render_count_;
+
+};
+
+} // namespace plot
+} // namespace widgets
+} // namespace ui
+} // namespace sv
+
+#endif // UI_WIDGETS_PLOT_BACKGROUNDLAYER_HPP
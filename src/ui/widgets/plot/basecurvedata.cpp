@@ -19,6 +19,7 @@
 
 #include <set>
 
+#include <QPolygonF>
 #include <QSettings>
 #include <QString>
 #include <QtGlobal>
@@ -56,6 +57,36 @@ bool BaseCurveData::is_relative_time() const
 	return relative_time_;
 }
 
+BaseCurveData *BaseCurveData::freeze() const
+{
+	return nullptr;
+}
+
+void BaseCurveData::set_required_history(double history)
+{
+	(void)history;
+}
+
+bool BaseCurveData::envelope(double x_min, double x_max, size_t columns,
+	QPolygonF &points) const
+{
+	(void)x_min;
+	(void)x_max;
+	(void)columns;
+	(void)points;
+	return false;
+}
+
+bool BaseCurveData::visible_range(double x_min, double x_max,
+	size_t &first, size_t &last) const
+{
+	(void)x_min;
+	(void)x_max;
+	(void)first;
+	(void)last;
+	return false;
+}
+
 } // namespace plot
 } // namespace widgets
 } // namespace ui
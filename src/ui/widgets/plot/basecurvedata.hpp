@@ -27,6 +27,7 @@
 #include <QColor>
 #include <QObject>
 #include <QPointF>
+#include <QPolygonF>
 #include <QRectF>
 #include <QSettings>
 #include <QString>
@@ -68,12 +69,52 @@ public:
 	bool is_relative_time() const;
 
 	virtual bool is_equal(const BaseCurveData *other) const = 0;
+	/**
+	 * Return a new curve data object for the same signal(s), e.g. to render
+	 * the curve in a second plot. The caller takes the ownership.
+	 */
+	virtual BaseCurveData *clone() const = 0;
+	/**
+	 * Return a new curve data object, that only contains the current
+	 * samples, e.g. to explore them while the signal(s) keep running. No
+	 * samples are copied. The caller takes the ownership.
+	 *
+	 * @return nullptr if the curve data can't be frozen.
+	 */
+	virtual BaseCurveData *freeze() const;
+	/**
+	 * Declare, that the plot only shows the samples of the last history
+	 * seconds, see data::BaseSignal::set_observer_history(). Infinity means
+	 * all samples. The default does nothing.
+	 */
+	virtual void set_required_history(double history);
 
 	virtual QPointF sample(size_t i) const = 0;
 	virtual size_t size() const = 0;
 	virtual QRectF boundingRect() const = 0;
 
 	virtual QPointF closest_point(const QPointF &pos, double *dist) const = 0;
+
+	/**
+	 * Return the min/max envelope of the samples in [x_min, x_max] with two
+	 * points per column in &points, to draw a curve with much more samples
+	 * than pixels, see EnvelopeCurve.
+	 *
+	 * @return false if the samples should be drawn as they are.
+	 */
+	virtual bool envelope(double x_min, double x_max, size_t columns,
+		QPolygonF &points) const;
+
+	/**
+	 * Return the indices [&first, &last] of the samples, that are needed to
+	 * draw the range [x_min, x_max], including the neighbouring samples
+	 * outside of the range, so offscreen samples don't have to be drawn.
+	 *
+	 * @return false if all samples have to be drawn.
+	 */
+	virtual bool visible_range(double x_min, double x_max,
+		size_t &first, size_t &last) const;
+
 	virtual sv::data::Quantity x_quantity() const = 0;
 	virtual set<sv::data::QuantityFlag> x_quantity_flags() const = 0;
 	virtual sv::data::Unit x_unit() const = 0;
@@ -26,12 +26,13 @@
 #include <QRandomGenerator>
 #endif
 #include <QPen>
+#include <QPointF>
 #include <QSettings>
 #include <QUuid>
 #include <QVariant>
 #include <qwt_plot_curve.h>
-#include <qwt_plot_directpainter.h>
 #include <qwt_plot_marker.h>
+#include <qwt_scale_map.h>
 #include <qwt_symbol.h>
 #include <qwt_text.h>
 
@@ -39,9 +40,13 @@
 #include "src/session.hpp"
 #include "src/settingsmanager.hpp"
 #include "src/util.hpp"
+#include "src/workerpool.hpp"
 #include "src/data/datautil.hpp"
 #include "src/devices/basedevice.hpp"
 #include "src/ui/widgets/plot/basecurvedata.hpp"
+#include "src/ui/widgets/plot/curvepreparer.hpp"
+#include "src/ui/widgets/plot/densitycurve.hpp"
+#include "src/ui/widgets/plot/envelopecurve.hpp"
 #include "src/ui/widgets/plot/timecurvedata.hpp"
 #include "src/ui/widgets/plot/xycurvedata.hpp"
 
@@ -57,8 +62,10 @@ namespace plot {
 Curve::Curve(BaseCurveData *curve_data, int x_axis_id, int y_axis_id,
 		const QString &custom_name, const QColor &custom_color) :
 	curve_data_(curve_data),
-	plot_direct_painter_(new QwtPlotDirectPainter()),
-	painted_points_(0)
+	density_curve_(nullptr),
+	painted_points_(0),
+	bounds_valid_(false),
+	priority_(CurvePriority::Normal)
 {
 	id_ = curve_data->id_prefix() + ":" +
 		util::format_uuid(QUuid::createUuid());
@@ -69,7 +76,12 @@ Curve::Curve(BaseCurveData *curve_data, int x_axis_id, int y_axis_id,
 	pen.setStyle(Qt::SolidLine);
 	pen.setCosmetic(false);
 
-	plot_curve_ = new QwtPlotCurve();
+	// The polylines of complete redraws are prepared in a worker thread
+	curve_preparer_ = new CurvePreparer(curve_data_);
+	if (Session::worker_pool)
+		Session::worker_pool->move_to_worker(curve_preparer_);
+
+	plot_curve_ = new EnvelopeCurve(curve_data_, curve_preparer_);
 	plot_curve_->setYAxis(y_axis_id);
 	plot_curve_->setXAxis(x_axis_id);
 	plot_curve_->setStyle(QwtPlotCurve::Lines);
@@ -77,7 +89,9 @@ Curve::Curve(BaseCurveData *curve_data, int x_axis_id, int y_axis_id,
 	// Set empty symbol, used in the PlotCurveConfigDialog.
 	plot_curve_->setSymbol(new QwtSymbol(QwtSymbol::NoSymbol));
 	plot_curve_->setRenderHint(QwtPlotItem::RenderAntialiased, true);
-	plot_curve_->setPaintAttribute(QwtPlotCurve::ClipPolygons, false);
+	// Only the visible samples are drawn (see EnvelopeCurve), so clipping
+	// the few remaining points at the edges is cheap.
+	plot_curve_->setPaintAttribute(QwtPlotCurve::ClipPolygons, true);
 	plot_curve_->setData(curve_data_);
 	//plot_curve_->setRawSamples(); // TODO: is this an option?
 	// Curves have the lowest z order, everything else will be painted ontop.
@@ -89,8 +103,11 @@ Curve::Curve(BaseCurveData *curve_data, int x_axis_id, int y_axis_id,
 
 Curve::~Curve()
 {
+	// The curve data is deleted with the plot curve
+	curve_preparer_->stop();
+	curve_preparer_->deleteLater();
+	delete density_curve_;
 	delete plot_curve_;
-	delete plot_direct_painter_;
 }
 
 
@@ -104,9 +121,23 @@ QwtPlotCurve *Curve::plot_curve() const
 	return plot_curve_;
 }
 
-QwtPlotDirectPainter *Curve::plot_direct_painter() const
+CurvePreparer *Curve::curve_preparer() const
+{
+	return curve_preparer_;
+}
+
+size_t Curve::take_drawn_points() const
+{
+	return plot_curve_->take_drawn_points();
+}
+
+bool Curve::prepare(const QwtScaleMap &x_map, const QwtScaleMap &y_map)
 {
-	return plot_direct_painter_;
+	if (!plot_curve_->is_preparable())
+		return false;
+	curve_preparer_->request(x_map, y_map,
+		plot_curve_->curve_column_step());
+	return true;
 }
 
 void Curve::set_name(const QString &custom_name)
@@ -120,6 +151,8 @@ void Curve::set_name(const QString &custom_name)
 		name_ = curve_data_->name();
 	}
 	plot_curve_->setTitle(name_);
+	if (density_curve_)
+		density_curve_->setTitle(name_);
 }
 
 QString Curve::name() const
@@ -145,6 +178,8 @@ int Curve::y_axis_id() const
 void Curve::set_painted_points(size_t painted_points)
 {
 	painted_points_ = painted_points;
+	if (painted_points_ > 0)
+		painted_first_sample_ = curve_data_->sample(0);
 }
 
 size_t Curve::painted_points() const
@@ -152,6 +187,40 @@ size_t Curve::painted_points() const
 	return painted_points_;
 }
 
+bool Curve::needs_replot() const
+{
+	const size_t size = curve_data_->size();
+	if (size < painted_points_)
+		return true;
+	if (painted_points_ == 0 || size == 0)
+		return false;
+	if (plot_curve_->fading() && size > painted_points_)
+		return true;
+	// The first sample has moved, when the front samples were dropped
+	return curve_data_->sample(0) != painted_first_sample_;
+}
+
+bool Curve::update_bounds()
+{
+	const QRectF bounds = curve_data_->boundingRect();
+	if (bounds_valid_ && bounds == bounds_)
+		return false;
+
+	bounds_ = bounds;
+	bounds_valid_ = true;
+	return true;
+}
+
+void Curve::invalidate_bounds()
+{
+	bounds_valid_ = false;
+}
+
+QRectF Curve::bounds() const
+{
+	return bounds_;
+}
+
 void Curve::set_color(const QColor &custom_color)
 {
 	if (custom_color.isValid()) {
@@ -167,6 +236,8 @@ void Curve::set_color(const QColor &custom_color)
 	QPen pen = plot_curve_->pen();
 	pen.setColor(color_);
 	plot_curve_->setPen(pen);
+	if (density_curve_)
+		density_curve_->set_color(color_);
 }
 
 QColor Curve::color() const
@@ -203,6 +274,80 @@ QwtSymbol::Style Curve::symbol() const
 	return plot_curve_->symbol()->style();
 }
 
+bool Curve::set_density_mode(bool density_mode)
+{
+	if (density_mode == (density_curve_ != nullptr))
+		return true;
+
+	if (!density_mode) {
+		delete density_curve_;
+		density_curve_ = nullptr;
+		plot_curve_->setStyle(QwtPlotCurve::Lines);
+		return true;
+	}
+
+	const XYCurveData *xy_curve_data =
+		dynamic_cast<const XYCurveData *>(curve_data_);
+	if (!xy_curve_data)
+		return false;
+
+	density_curve_ = new DensityCurve(xy_curve_data);
+	density_curve_->setTitle(name_);
+	density_curve_->setXAxis(x_axis_id());
+	density_curve_->setYAxis(y_axis_id());
+	density_curve_->setZ(plot_curve_->z());
+	density_curve_->setVisible(plot_curve_->isVisible());
+	density_curve_->set_color(color_);
+	density_curve_->update();
+	if (plot_curve_->plot())
+		density_curve_->attach(plot_curve_->plot());
+	// The plot curve stays for the legend, the symbols and the markers
+	plot_curve_->setStyle(QwtPlotCurve::NoCurve);
+	return true;
+}
+
+bool Curve::density_mode() const
+{
+	return density_curve_ != nullptr;
+}
+
+void Curve::set_fading(bool fading)
+{
+	plot_curve_->set_fading(fading);
+}
+
+bool Curve::fading() const
+{
+	return plot_curve_->fading();
+}
+
+DensityCurve *Curve::density_curve() const
+{
+	return density_curve_;
+}
+
+void Curve::set_full_resolution(bool full_resolution)
+{
+	plot_curve_->set_full_resolution(full_resolution);
+}
+
+void Curve::set_priority(CurvePriority priority)
+{
+	priority_ = priority;
+	if (priority_ != CurvePriority::Low)
+		plot_curve_->set_column_step_factor(1);
+}
+
+CurvePriority Curve::priority() const
+{
+	return priority_;
+}
+
+void Curve::set_column_step_factor(int factor)
+{
+	plot_curve_->set_column_step_factor(factor);
+}
+
 QwtPlotMarker *Curve::add_marker(const QString &name_postfix)
 {
 	QwtSymbol *symbol = new QwtSymbol(
@@ -248,6 +393,9 @@ void Curve::save_settings(QSettings &settings,
 	// Qt::PenSytle cannot be saved directly
 	settings.setValue("style", QVariant(QPen(style())));
 	settings.setValue("symbol", symbol());
+	settings.setValue("density_mode", density_mode());
+	settings.setValue("fading", fading());
+	settings.setValue("priority", (int)priority_);
 
 	settings.endGroup();
 }
@@ -291,6 +439,16 @@ Curve *Curve::init_from_settings(
 		curve->set_style(settings.value("style").value<QPen>().style());
 	if (settings.contains("symbol"))
 		curve->set_symbol(settings.value("symbol").value<QwtSymbol::Style>());
+	if (settings.contains("density_mode"))
+		curve->set_density_mode(settings.value("density_mode").toBool());
+	if (settings.contains("fading"))
+		curve->set_fading(settings.value("fading").toBool());
+	if (settings.contains("priority")) {
+		const int priority = settings.value("priority").toInt();
+		if (priority >= (int)CurvePriority::Low &&
+				priority <= (int)CurvePriority::High)
+			curve->set_priority((CurvePriority)priority);
+	}
 
 	settings.endGroup();
 
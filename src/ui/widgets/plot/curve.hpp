@@ -26,11 +26,13 @@
 
 #include <QColor>
 #include <QObject>
+#include <QPointF>
+#include <QRectF>
 #include <QSettings>
 #include <QString>
 #include <qwt_plot_curve.h>
-#include <qwt_plot_directpainter.h>
 #include <qwt_plot_marker.h>
+#include <qwt_scale_map.h>
 #include <qwt_symbol.h>
 
 #include "src/data/datautil.hpp"
@@ -52,6 +54,22 @@ namespace widgets {
 namespace plot {
 
 class BaseCurveData;
+class CurvePreparer;
+class DensityCurve;
+class EnvelopeCurve;
+
+/**
+ * The render priority of a curve, see PlotScheduler. When the plot budget is
+ * tight, the new samples of low priority curves are painted less often and
+ * their envelopes are decimated coarser. High priority curves are always
+ * painted at the full rate.
+ */
+enum class CurvePriority
+{
+	Low = 0,
+	Normal = 1,
+	High = 2,
+};
 
 class Curve : public QObject
 {
@@ -76,7 +94,17 @@ public:
 
 	BaseCurveData *curve_data() const;
 	QwtPlotCurve *plot_curve() const;
-	QwtPlotDirectPainter *plot_direct_painter() const;
+	CurvePreparer *curve_preparer() const;
+	/** Return the number of points drawn since the last call. */
+	size_t take_drawn_points() const;
+	/**
+	 * Prepare the polyline of the next complete redraw for the scale maps in
+	 * a worker thread, see CurvePreparer.
+	 *
+	 * @return false if the curve can't be prepared, e.g. because it is drawn
+	 *         with symbols.
+	 */
+	bool prepare(const QwtScaleMap &x_map, const QwtScaleMap &y_map);
 	void set_name(const QString &custom_name);
 	QString name() const;
 	string id() const;
@@ -84,24 +112,73 @@ public:
 	int y_axis_id() const;
 	void set_painted_points(size_t painted_points);
 	size_t painted_points() const;
+	/**
+	 * Return true if the new samples can't just be painted ontop, because
+	 * the painted samples were dropped (e.g. by the memory budget or the
+	 * history window of an XY curve) or because the curve is faded.
+	 */
+	bool needs_replot() const;
+	/**
+	 * Update the cached bounding rect of the curve data.
+	 *
+	 * @return true if the bounding rect has changed since the last call or
+	 *         since invalidate_bounds().
+	 */
+	bool update_bounds();
+	/** Force the next update_bounds() to report a change. */
+	void invalidate_bounds();
+	/** The bounding rect of the last update_bounds(). */
+	QRectF bounds() const;
 	void set_color(const QColor &custom_color);
 	QColor color() const;
 	void set_style(const Qt::PenStyle style);
 	Qt::PenStyle style() const;
 	void set_symbol(const QwtSymbol::Style style);
 	QwtSymbol::Style symbol() const;
+	/**
+	 * Draw the curve as a density map instead of lines, see DensityCurve.
+	 * This is only possible for XY curves.
+	 *
+	 * @return false if the curve can't be drawn as a density map.
+	 */
+	bool set_density_mode(bool density_mode);
+	bool density_mode() const;
+	/** Fade the older samples, see EnvelopeCurve::set_fading(). */
+	void set_fading(bool fading);
+	bool fading() const;
+	/** Return the density map or nullptr if the density mode is off. */
+	DensityCurve *density_curve() const;
+	/**
+	 * Always draw the envelope with one column per pixel, regardless of
+	 * EnvelopeCurve::set_column_step(), e.g. for an export.
+	 */
+	void set_full_resolution(bool full_resolution);
+	void set_priority(CurvePriority priority);
+	CurvePriority priority() const;
+	/**
+	 * Draw the envelope with factor times the column step of
+	 * EnvelopeCurve::set_column_step(). This is set by the PlotScheduler
+	 * for low priority curves, while the plot budget is tight.
+	 */
+	void set_column_step_factor(int factor);
 	QwtPlotMarker *add_marker(const QString &name_postfix);
 
 private:
 	BaseCurveData *curve_data_;
-	QwtPlotCurve *plot_curve_;
-	QwtPlotDirectPainter *plot_direct_painter_;
+	EnvelopeCurve *plot_curve_;
+	CurvePreparer *curve_preparer_;
+	DensityCurve *density_curve_;
 	bool has_custom_name_;
 	QString name_;
 	string id_;
 	size_t painted_points_;
+	/** The first sample, when the painted points were set. */
+	QPointF painted_first_sample_;
+	QRectF bounds_;
+	bool bounds_valid_;
 	bool has_custom_color_;
 	QColor color_;
+	CurvePriority priority_;
 
 };
 
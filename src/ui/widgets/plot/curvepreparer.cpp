@@ -0,0 +1,215 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <mutex>
+
+#include <QMetaObject>
+#include <QPointF>
+#include <QPolygonF>
+#include <qwt_scale_map.h>
+
+#include "curvepreparer.hpp"
+#include "src/ui/widgets/plot/basecurvedata.hpp"
+#include "src/ui/widgets/plot/envelopecurve.hpp"
+#include "src/ui/widgets/plot/scaletransform.hpp"
+
+namespace sv {
+namespace ui {
+namespace widgets {
+namespace plot {
+
+CurvePreparer::CurvePreparer(const BaseCurveData *curve_data) :
+	QObject(),
+	curve_data_(curve_data),
+	tile_cache_(curve_data),
+	requested_(false),
+	pending_(false),
+	running_(false),
+	stopped_(false),
+	request_column_step_(1),
+	result_valid_(false),
+	result_data_size_(0)
+{
+}
+
+void CurvePreparer::request(const QwtScaleMap &x_map, const QwtScaleMap &y_map,
+	int column_step)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (stopped_)
+		return;
+
+	request_x_map_ = x_map;
+	request_y_map_ = y_map;
+	request_column_step_ = column_step;
+	requested_ = true;
+	if (!pending_) {
+		pending_ = true;
+		QMetaObject::invokeMethod(this, "prepare", Qt::QueuedConnection);
+	}
+}
+
+bool CurvePreparer::is_pending() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return pending_;
+}
+
+bool CurvePreparer::result(const QwtScaleMap &x_map,
+	const QwtScaleMap &y_map, QPolygonF &points, size_t &data_size) const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (!result_valid_ || !is_same_map(x_map, result_x_map_) ||
+			!is_same_map(y_map, result_y_map_))
+		return false;
+
+	// The polygon is implicitly shared, so this doesn't copy the points
+	points = result_;
+	data_size = result_data_size_;
+	return true;
+}
+
+void CurvePreparer::stop()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	stopped_ = true;
+	running_cv_.wait(lock, [this] { return !running_; });
+}
+
+void CurvePreparer::prepare()
+{
+	QwtScaleMap x_map;
+	QwtScaleMap y_map;
+	int column_step;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (stopped_ || !requested_) {
+			pending_ = false;
+			return;
+		}
+		x_map = request_x_map_;
+		y_map = request_y_map_;
+		column_step = request_column_step_;
+		requested_ = false;
+		running_ = true;
+	}
+
+	// Samples, that are appended from now on, are drawn by the direct
+	// painter or the next redraw.
+	const size_t data_size = curve_data_->size();
+	const double x_min = std::fmin(x_map.s1(), x_map.s2());
+	const double x_max = std::fmax(x_map.s1(), x_map.s2());
+	const size_t columns = EnvelopeCurve::envelope_columns(
+		x_map.pDist(), column_step);
+
+	const ScaleTransform x_transform(x_map);
+	const ScaleTransform y_transform(y_map);
+
+	QPolygonF points;
+	size_t first;
+	size_t last;
+	bool valid = false;
+	bool scaled = false;
+	if (columns > 0 && tile_cache_.envelope(x_min, x_max, columns,
+			x_transform, y_transform, points)) {
+		valid = true;
+		scaled = true;
+	}
+	else if (columns > 0 &&
+			curve_data_->envelope(x_min, x_max, columns, points)) {
+		valid = true;
+	}
+	else if (curve_data_->visible_range(x_min, x_max, first, last)) {
+		points.clear();
+		if (last >= data_size && data_size > 0)
+			last = data_size - 1;
+		if (first <= last && last < data_size) {
+			points.reserve((int)(last - first + 1));
+			for (size_t i = first; i <= last; ++i)
+				points.append(curve_data_->sample(i));
+		}
+		valid = true;
+	}
+	if (valid) {
+		if (!scaled)
+			ScaleTransform::scale_points(points, x_transform, y_transform);
+		ScaleTransform::map_points(points, x_transform, y_transform);
+	}
+
+	bool prepare_again;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (valid) {
+			result_.swap(points);
+			result_x_map_ = x_map;
+			result_y_map_ = y_map;
+			result_data_size_ = data_size;
+			result_valid_ = true;
+		}
+		running_ = false;
+		prepare_again = requested_ && !stopped_;
+		if (!prepare_again)
+			pending_ = false;
+	}
+	running_cv_.notify_all();
+
+	if (prepare_again)
+		QMetaObject::invokeMethod(this, "prepare", Qt::QueuedConnection);
+	else
+		QMetaObject::invokeMethod(this, "prefetch", Qt::QueuedConnection);
+	Q_EMIT prepared();
+}
+
+void CurvePreparer::prefetch()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		// A new request has priority
+		if (stopped_ || requested_)
+			return;
+		running_ = true;
+	}
+
+	const bool prefetch_again = tile_cache_.prefetch();
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		running_ = false;
+	}
+	running_cv_.notify_all();
+
+	if (prefetch_again)
+		QMetaObject::invokeMethod(this, "prefetch", Qt::QueuedConnection);
+}
+
+bool CurvePreparer::is_same_map(const QwtScaleMap &map1,
+	const QwtScaleMap &map2)
+{
+	return map1.s1() == map2.s1() && map1.s2() == map2.s2() &&
+		map1.p1() == map2.p1() && map1.p2() == map2.p2() &&
+		(map1.transformation() == nullptr) ==
+			(map2.transformation() == nullptr);
+}
+
+} // namespace plot
+} // namespace widgets
+} // namespace ui
+} // namespace sv
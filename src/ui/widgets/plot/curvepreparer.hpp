@@ -0,0 +1,128 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_WIDGETS_PLOT_CURVEPREPARER_HPP
+#define UI_WIDGETS_PLOT_CURVEPREPARER_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+#include <QObject>
+#include <QPolygonF>
+#include <qwt_scale_map.h>
+
+#include "src/ui/widgets/plot/envelopetilecache.hpp"
+
+namespace sv {
+namespace ui {
+namespace widgets {
+namespace plot {
+
+class BaseCurveData;
+
+/**
+ * Prepares the polyline of a complete curve redraw in a worker thread: The
+ * samples are decimated to the envelope (or clamped to the visible range,
+ * see BaseCurveData) and transformed to canvas coordinates. The GUI thread
+ * then only has to paint the finished polyline, see EnvelopeCurve.
+ *
+ * Only one preparation is running at a time. A new request, while the
+ * preparation is running, replaces the older requests. prepared() is
+ * emitted after each preparation.
+ *
+ * Time curves are decimated in tiles, that are cached, see
+ * EnvelopeTileCache. When there is no new request, the tiles next to the
+ * visible range are prefetched, so panning doesn't have to wait for the
+ * decimation.
+ *
+ * The curve data is read concurrently to the GUI thread, so it must support
+ * lock-free reads. stop() must be called, before the curve data is deleted.
+ */
+class CurvePreparer : public QObject
+{
+	Q_OBJECT
+
+public:
+	explicit CurvePreparer(const BaseCurveData *curve_data);
+
+	/**
+	 * Request a preparation for the scale maps, the envelope is decimated
+	 * with column_step pixels per column, see EnvelopeCurve.
+	 */
+	void request(const QwtScaleMap &x_map, const QwtScaleMap &y_map,
+		int column_step);
+	/** Return true while a preparation is requested or running. */
+	bool is_pending() const;
+
+	/**
+	 * Return the polyline in &points, if it was prepared for the scale maps.
+	 * &data_size is the number of samples of the curve, when the preparation
+	 * started. The samples, that were appended later, are not part of the
+	 * polyline.
+	 *
+	 * @return false if there is no polyline for the scale maps.
+	 */
+	bool result(const QwtScaleMap &x_map, const QwtScaleMap &y_map,
+		QPolygonF &points, size_t &data_size) const;
+
+	/**
+	 * Wait for a running preparation and ignore all further requests. The
+	 * preparer can be deleted with deleteLater() afterwards.
+	 */
+	void stop();
+
+	/** Return true if both scale maps transform the same way. */
+	static bool is_same_map(const QwtScaleMap &map1, const QwtScaleMap &map2);
+
+private Q_SLOTS:
+	void prepare();
+	void prefetch();
+
+private:
+
+	const BaseCurveData *curve_data_;
+	/** Only used in the worker thread. */
+	EnvelopeTileCache tile_cache_;
+	mutable std::mutex mutex_;
+	std::condition_variable running_cv_;
+	bool requested_;
+	bool pending_;
+	bool running_;
+	bool stopped_;
+	QwtScaleMap request_x_map_;
+	QwtScaleMap request_y_map_;
+	int request_column_step_;
+	bool result_valid_;
+	QwtScaleMap result_x_map_;
+	QwtScaleMap result_y_map_;
+	QPolygonF result_;
+	size_t result_data_size_;
+
+Q_SIGNALS:
+	void prepared();
+
+};
+
+} // namespace plot
+} // namespace widgets
+} // namespace ui
+} // namespace sv
+
+#endif // UI_WIDGETS_PLOT_CURVEPREPARER_HPP
@@ -0,0 +1,162 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+
+#include <QColor>
+#include <QImage>
+#include <QPainter>
+#include <QRectF>
+#include <qwt_plot_item.h>
+#include <qwt_scale_map.h>
+
+#include "densitycurve.hpp"
+#include "src/data/densityhistogram.hpp"
+#include "src/data/signalcombinecache.hpp"
+#include "src/ui/widgets/plot/xycurvedata.hpp"
+
+namespace sv {
+namespace ui {
+namespace widgets {
+namespace plot {
+
+DensityCurve::DensityCurve(const XYCurveData *curve_data) :
+	QwtPlotItem(),
+	curve_data_(curve_data),
+	combine_cache_(curve_data->combine_cache()),
+	pos_(0),
+	color_(Qt::green),
+	image_valid_(false)
+{
+	setItemAttribute(QwtPlotItem::AutoScale, true);
+}
+
+int DensityCurve::rtti() const
+{
+	return QwtPlotItem::Rtti_PlotUserItem + 1;
+}
+
+bool DensityCurve::update()
+{
+	// Rows, that were dropped before they were counted, are lost
+	pos_ = std::max(pos_, curve_data_->begin_pos());
+	const size_t end_pos = curve_data_->end_pos();
+
+	const size_t block_size = 256;
+	double x_block[block_size];
+	double y_block[block_size];
+	bool added = false;
+	while (pos_ < end_pos) {
+		const size_t n = std::min(block_size, end_pos - pos_);
+		const size_t count = std::min(
+			combine_cache_->copy_values(0, pos_, n, x_block),
+			combine_cache_->copy_values(1, pos_, n, y_block));
+		if (count == 0)
+			break;
+		histogram_.add(x_block, y_block, count);
+		pos_ += count;
+		added = true;
+	}
+
+	if (added)
+		image_valid_ = false;
+	return added;
+}
+
+void DensityCurve::clear()
+{
+	histogram_.clear();
+	image_valid_ = false;
+}
+
+void DensityCurve::set_color(const QColor &color)
+{
+	color_ = color;
+	image_valid_ = false;
+	itemChanged();
+}
+
+QColor DensityCurve::color() const
+{
+	return color_;
+}
+
+QRectF DensityCurve::boundingRect() const
+{
+	if (histogram_.empty())
+		return QRectF(1.0, 1.0, -2.0, -2.0); // Invalid rect, like Qwt does
+	return QRectF(QPointF(histogram_.x_min(), histogram_.y_min()),
+		QPointF(histogram_.x_max(), histogram_.y_max()));
+}
+
+void DensityCurve::draw(QPainter *painter,
+	const QwtScaleMap &x_map, const QwtScaleMap &y_map,
+	const QRectF &canvas_rect) const
+{
+	(void)canvas_rect;
+
+	if (histogram_.empty())
+		return;
+	if (!image_valid_)
+		update_image();
+
+	const QRectF target = QwtScaleMap::transform(
+		x_map, y_map, boundingRect()).normalized();
+	painter->save();
+	// Show the bins as they are, without blurring them
+	painter->setRenderHint(QPainter::SmoothPixmapTransform, false);
+	painter->drawImage(target, image_);
+	painter->restore();
+}
+
+void DensityCurve::update_image() const
+{
+	const int columns = (int)histogram_.columns();
+	const int rows = (int)histogram_.rows();
+	if (image_.width() != columns || image_.height() != rows)
+		image_ = QImage(columns, rows, QImage::Format_ARGB32);
+	image_.fill(Qt::transparent);
+
+	// Logarithmic intensity, so the rarely visited bins are still visible
+	const double norm = std::log1p((double)histogram_.max_count());
+	const int red = color_.red();
+	const int green = color_.green();
+	const int blue = color_.blue();
+	for (int row = 0; row < rows; ++row) {
+		// Row 0 of the histogram is at the bottom of the image
+		QRgb *line = (QRgb *)image_.scanLine(rows - 1 - row);
+		for (int column = 0; column < columns; ++column) {
+			const uint32_t count = histogram_.count(column, row);
+			if (count == 0)
+				continue;
+			const int alpha = std::max(32, (int)std::lround(
+				255. * std::log1p((double)count) / norm));
+			line[column] = qRgba(red, green, blue, alpha);
+		}
+	}
+	image_valid_ = true;
+}
+
+} // namespace plot
+} // namespace widgets
+} // namespace ui
+} // namespace sv
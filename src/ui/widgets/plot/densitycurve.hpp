@@ -0,0 +1,103 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_WIDGETS_PLOT_DENSITYCURVE_HPP
+#define UI_WIDGETS_PLOT_DENSITYCURVE_HPP
+
+#include <cstddef>
+#include <memory>
+
+#include <QColor>
+#include <QImage>
+#include <QPainter>
+#include <QRectF>
+#include <qwt_plot_item.h>
+#include <qwt_scale_map.h>
+
+#include "src/data/densityhistogram.hpp"
+
+using std::shared_ptr;
+
+namespace sv {
+
+namespace data {
+class SignalCombineCache;
+}
+
+namespace ui {
+namespace widgets {
+namespace plot {
+
+class XYCurveData;
+
+/**
+ * Draws the points of an XY curve as a density map instead of lines, see
+ * DensityHistogram. For long sweeps with millions of overlapping segments
+ * this is much faster and shows, where the curve has been most of the time.
+ *
+ * The new points are added to the histogram with update(), the costs of a
+ * redraw only depend on the size of the histogram.
+ */
+class DensityCurve : public QwtPlotItem
+{
+public:
+	explicit DensityCurve(const XYCurveData *curve_data);
+
+	int rtti() const override;
+
+	/**
+	 * Add the points, that were appended to the curve data since the last
+	 * call, to the histogram.
+	 *
+	 * @return true if points were added.
+	 */
+	bool update();
+	/** Forget all counted points, the density map starts from the new points. */
+	void clear();
+
+	void set_color(const QColor &color);
+	QColor color() const;
+
+	QRectF boundingRect() const override;
+	void draw(QPainter *painter,
+		const QwtScaleMap &x_map, const QwtScaleMap &y_map,
+		const QRectF &canvas_rect) const override;
+
+private:
+	/** Render the histogram into image_. */
+	void update_image() const;
+
+	/** The rows of a frozen curve data end before the rows of the cache. */
+	const XYCurveData *curve_data_;
+	shared_ptr<sv::data::SignalCombineCache> combine_cache_;
+	/** The position of the next row of the combine cache to be added. */
+	size_t pos_;
+	sv::data::DensityHistogram histogram_;
+	QColor color_;
+	mutable QImage image_;
+	mutable bool image_valid_;
+
+};
+
+} // namespace plot
+} // namespace widgets
+} // namespace ui
+} // namespace sv
+
+#endif // UI_WIDGETS_PLOT_DENSITYCURVE_HPP
@@ -0,0 +1,341 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+
+#include <QColor>
+#include <QPaintEngine>
+#include <QPainter>
+#include <QPen>
+#include <QPointF>
+#include <QPolygonF>
+#include <QRectF>
+#include <QRegion>
+#include <qwt_painter.h>
+#include <qwt_plot_curve.h>
+#include <qwt_scale_map.h>
+#include <qwt_symbol.h>
+
+#include "envelopecurve.hpp"
+#include "src/ui/widgets/plot/basecurvedata.hpp"
+#include "src/ui/widgets/plot/curvepreparer.hpp"
+#include "src/ui/widgets/plot/scaletransform.hpp"
+
+namespace sv {
+namespace ui {
+namespace widgets {
+namespace plot {
+
+EnvelopeCurve::EnvelopeCurve(const BaseCurveData *curve_data,
+		const CurvePreparer *curve_preparer) :
+	QwtPlotCurve(),
+	curve_data_(curve_data),
+	curve_preparer_(curve_preparer),
+	drawn_points_(0),
+	full_resolution_(false),
+	column_step_factor_(1),
+	fading_(false),
+	stroke_valid_(false),
+	stroke_data_size_(0),
+	stroke_column_step_(1)
+{
+}
+
+const int EnvelopeCurve::max_stroke_size_ = 1 << 22;
+
+const int EnvelopeCurve::fade_steps_ = 16;
+
+const double EnvelopeCurve::fade_min_alpha_ = 0.1;
+
+std::atomic<int> EnvelopeCurve::column_step_(1);
+
+void EnvelopeCurve::set_column_step(int step)
+{
+	column_step_.store(std::max(1, step), std::memory_order_relaxed);
+}
+
+int EnvelopeCurve::column_step()
+{
+	return column_step_.load(std::memory_order_relaxed);
+}
+
+size_t EnvelopeCurve::envelope_columns(double width, int step)
+{
+	const size_t pixels = (size_t)std::lround(std::fabs(width));
+	const size_t pixel_step = (size_t)std::max(1, step);
+	return (pixels + pixel_step - 1) / pixel_step;
+}
+
+void EnvelopeCurve::set_full_resolution(bool full_resolution)
+{
+	full_resolution_ = full_resolution;
+}
+
+void EnvelopeCurve::set_column_step_factor(int factor)
+{
+	column_step_factor_ = std::max(1, factor);
+}
+
+int EnvelopeCurve::curve_column_step() const
+{
+	if (full_resolution_)
+		return 1;
+	return column_step() * column_step_factor_;
+}
+
+void EnvelopeCurve::set_fading(bool fading)
+{
+	fading_ = fading;
+}
+
+bool EnvelopeCurve::fading() const
+{
+	return fading_;
+}
+
+bool EnvelopeCurve::is_preparable() const
+{
+	// Symbols are drawn for every sample, the polyline only replaces lines
+	const bool has_symbol =
+		symbol() != nullptr && symbol()->style() != QwtSymbol::NoSymbol;
+	return curve_preparer_ != nullptr && !has_symbol &&
+		style() == QwtPlotCurve::Lines;
+}
+
+bool EnvelopeCurve::is_strokeable() const
+{
+	const bool has_symbol =
+		symbol() != nullptr && symbol()->style() != QwtSymbol::NoSymbol;
+	return !has_symbol && style() == QwtPlotCurve::Lines &&
+		!testCurveAttribute(QwtPlotCurve::Fitted);
+}
+
+size_t EnvelopeCurve::take_drawn_points() const
+{
+	const size_t drawn_points = drawn_points_;
+	drawn_points_ = 0;
+	return drawn_points;
+}
+
+void EnvelopeCurve::drawSeries(QPainter *painter,
+	const QwtScaleMap &x_map, const QwtScaleMap &y_map,
+	const QRectF &canvas_rect, int from, int to) const
+{
+	if (to < 0)
+		to = (int)dataSize() - 1;
+	const bool complete = from <= 0 && to >= (int)dataSize() - 1;
+	if (!complete) {
+		if (to >= from)
+			drawn_points_ += (size_t)(to - from + 1);
+		QwtPlotCurve::drawSeries(painter, x_map, y_map, canvas_rect, from, to);
+		return;
+	}
+
+	QPolygonF prepared;
+	size_t prepared_size;
+	if (is_preparable() && curve_preparer_->result(
+			x_map, y_map, prepared, prepared_size)) {
+		draw_polyline(painter, prepared);
+		drawn_points_ += (size_t)prepared.size();
+		// Draw the samples, that were appended during the preparation
+		if (prepared_size > 0 && prepared_size < dataSize()) {
+			drawn_points_ += dataSize() - prepared_size + 1;
+			QwtPlotCurve::drawSeries(painter, x_map, y_map, canvas_rect,
+				(int)prepared_size - 1, (int)dataSize() - 1);
+		}
+		return;
+	}
+
+	if (draw_stroke(painter, x_map, y_map))
+		return;
+	// Samples, that are appended from now on, are appended to the kept
+	// polyline with the next redraw.
+	const size_t data_size = curve_data_->size();
+
+	double x_min = std::fmin(x_map.s1(), x_map.s2());
+	double x_max = std::fmax(x_map.s1(), x_map.s2());
+	const int step = curve_column_step();
+	size_t columns = envelope_columns(x_map.pDist(), step);
+
+	// Only decimate the samples in the painted part of the canvas, e.g. the
+	// strip, that is exposed by scrolling the canvas.
+	const QRectF rect = paint_rect(painter, canvas_rect);
+	if (rect.isEmpty())
+		return;
+	if (rect.width() < canvas_rect.width()) {
+		const double x1 = x_map.invTransform(rect.left() - 1.);
+		const double x2 = x_map.invTransform(rect.right() + 1.);
+		x_min = std::max(x_min, std::fmin(x1, x2));
+		x_max = std::min(x_max, std::fmax(x1, x2));
+		columns = envelope_columns(rect.width(), step) + 2;
+	}
+
+	// Symbols are drawn for every sample, the envelope only replaces lines
+	const bool has_symbol =
+		symbol() != nullptr && symbol()->style() != QwtSymbol::NoSymbol;
+	if (!has_symbol && style() == QwtPlotCurve::Lines && columns > 0 &&
+			curve_data_->envelope(x_min, x_max, columns, envelope_)) {
+		ScaleTransform::transform_points(envelope_,
+			ScaleTransform(x_map), ScaleTransform(y_map));
+		draw_polyline(painter, envelope_);
+		drawn_points_ += (size_t)envelope_.size();
+		if (rect == canvas_rect)
+			keep_stroke(envelope_, data_size, x_map, y_map);
+		return;
+	}
+
+	// Skip the offscreen samples
+	size_t first;
+	size_t last;
+	if (curve_data_->visible_range(x_min, x_max, first, last)) {
+		from = (int)first;
+		to = (int)last;
+	}
+	if (to >= from)
+		drawn_points_ += (size_t)(to - from + 1);
+
+	// Transform the samples like the curve preparer, so the polyline can be
+	// kept for the next redraw.
+	if (is_strokeable() && rect == canvas_rect && to >= from &&
+			to - from < max_stroke_size_) {
+		QPolygonF points;
+		points.reserve(to - from + 1);
+		for (int i = from; i <= to; ++i)
+			points.append(curve_data_->sample((size_t)i));
+		ScaleTransform::transform_points(points,
+			ScaleTransform(x_map), ScaleTransform(y_map));
+		draw_polyline(painter, points);
+		keep_stroke(points, data_size, x_map, y_map);
+		return;
+	}
+	QwtPlotCurve::drawSeries(painter, x_map, y_map, canvas_rect, from, to);
+}
+
+bool EnvelopeCurve::draw_stroke(QPainter *painter,
+	const QwtScaleMap &x_map, const QwtScaleMap &y_map) const
+{
+	if (!stroke_valid_)
+		return false;
+
+	// Samples were dropped or cleared, when the first sample has changed
+	const size_t data_size = curve_data_->size();
+	if (!is_strokeable() || data_size < stroke_data_size_ ||
+			data_size == 0 || curve_data_->sample(0) != stroke_first_sample_ ||
+			stroke_column_step_ != curve_column_step() ||
+			!CurvePreparer::is_same_map(x_map, stroke_x_map_) ||
+			!CurvePreparer::is_same_map(y_map, stroke_y_map_)) {
+		stroke_valid_ = false;
+		stroke_.clear();
+		return false;
+	}
+
+	// Append the samples, that were appended since
+	if (data_size > stroke_data_size_) {
+		if ((size_t)stroke_.size() + data_size - stroke_data_size_ >
+				(size_t)max_stroke_size_) {
+			stroke_valid_ = false;
+			stroke_.clear();
+			return false;
+		}
+		QPolygonF points;
+		points.reserve((int)(data_size - stroke_data_size_));
+		for (size_t i = stroke_data_size_; i < data_size; ++i)
+			points.append(curve_data_->sample(i));
+		ScaleTransform::transform_points(points,
+			ScaleTransform(x_map), ScaleTransform(y_map));
+		stroke_ += points;
+		stroke_data_size_ = data_size;
+	}
+
+	draw_polyline(painter, stroke_);
+	drawn_points_ += (size_t)stroke_.size();
+	return true;
+}
+
+void EnvelopeCurve::keep_stroke(const QPolygonF &points, size_t data_size,
+	const QwtScaleMap &x_map, const QwtScaleMap &y_map) const
+{
+	if (data_size == 0 || points.size() > max_stroke_size_) {
+		stroke_valid_ = false;
+		stroke_.clear();
+		return;
+	}
+
+	// The polygon is implicitly shared, so this doesn't copy the points
+	stroke_ = points;
+	stroke_x_map_ = x_map;
+	stroke_y_map_ = y_map;
+	stroke_data_size_ = data_size;
+	stroke_first_sample_ = curve_data_->sample(0);
+	stroke_column_step_ = curve_column_step();
+	stroke_valid_ = true;
+}
+
+void EnvelopeCurve::draw_polyline(QPainter *painter,
+	const QPolygonF &points) const
+{
+	painter->setBrush(Qt::NoBrush);
+	if (!fading_ || points.size() < 2) {
+		painter->setPen(pen());
+		QwtPainter::drawPolyline(painter, points);
+		return;
+	}
+
+	// The parts overlap by one point, so the polyline has no gaps
+	QPen pen = this->pen();
+	QColor color = pen.color();
+	const double alpha = color.alphaF();
+	const int size = points.size();
+	const int steps = std::min(fade_steps_, size - 1);
+	for (int step = 0; step < steps; ++step) {
+		const int first = (int)((long long)(size - 1) * step / steps);
+		const int last = (int)((long long)(size - 1) * (step + 1) / steps);
+		color.setAlphaF(alpha * (fade_min_alpha_ +
+			(1. - fade_min_alpha_) * (step + 1) / steps));
+		pen.setColor(color);
+		painter->setPen(pen);
+		QwtPainter::drawPolyline(
+			painter, points.constData() + first, last - first + 1);
+	}
+}
+
+QRectF EnvelopeCurve::paint_rect(const QPainter *painter,
+	const QRectF &canvas_rect)
+{
+	QRectF rect = canvas_rect;
+	if (painter->hasClipping())
+		rect &= painter->clipBoundingRect();
+
+	// The region of a paint event is only set as system clip
+	const QPaintEngine *engine = painter->paintEngine();
+	if (engine && painter->transform().isIdentity()) {
+		const QRegion system_clip = engine->systemClip();
+		if (!system_clip.isEmpty())
+			rect &= QRectF(system_clip.boundingRect());
+	}
+	return rect;
+}
+
+} // namespace plot
+} // namespace widgets
+} // namespace ui
+} // namespace sv
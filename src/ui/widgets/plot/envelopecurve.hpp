@@ -0,0 +1,183 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_WIDGETS_PLOT_ENVELOPECURVE_HPP
+#define UI_WIDGETS_PLOT_ENVELOPECURVE_HPP
+
+#include <atomic>
+#include <cstddef>
+
+#include <QPainter>
+#include <QPointF>
+#include <QPolygonF>
+#include <QRectF>
+#include <qwt_plot_curve.h>
+#include <qwt_scale_map.h>
+
+namespace sv {
+namespace ui {
+namespace widgets {
+namespace plot {
+
+class BaseCurveData;
+class CurvePreparer;
+
+/**
+ * A plot curve, that draws the min/max envelope of its samples when there
+ * are more samples than pixels, see BaseCurveData::envelope(). So the
+ * costs of a complete redraw depend on the width of the plot and not on
+ * the number of samples.
+ *
+ * Otherwise only the samples in the visible x range are drawn (plus the
+ * neighbouring samples for the lines to the edges), so the samples, that
+ * are out of view (e.g. in the rolling mode) cost nothing. When only a part
+ * of the canvas is painted (clipped), the visible x range is narrowed to
+ * that part.
+ *
+ * Only a complete redraw is decimated and clamped. The new samples, that
+ * are drawn incrementally by the direct painter of the plot, are drawn as
+ * they are.
+ *
+ * With a curve preparer, the polyline of a complete redraw may already be
+ * prepared in a worker thread for the current scale maps, then it is only
+ * painted.
+ *
+ * The polyline of the last complete redraw is kept with its scale maps.
+ * A redraw with the same maps, e.g. after the color or the name of the
+ * curve was changed, only strokes the kept polyline again (plus the samples,
+ * that were appended since) instead of reading and transforming the samples.
+ *
+ * With fading, the polyline of a complete redraw is stroked in parts with
+ * a rising opacity, so the oldest samples are the palest, e.g. for the
+ * trace of an XY curve.
+ */
+class EnvelopeCurve : public QwtPlotCurve
+{
+public:
+	explicit EnvelopeCurve(const BaseCurveData *curve_data,
+		const CurvePreparer *curve_preparer = nullptr);
+
+	/**
+	 * Return true if a complete redraw can use a polyline, that was
+	 * prepared by the curve preparer.
+	 */
+	bool is_preparable() const;
+	/**
+	 * Return true if the curve is drawn as a plain polyline, that can be
+	 * kept for the next complete redraw.
+	 */
+	bool is_strokeable() const;
+	/**
+	 * Return the number of points drawn since the last call, for the
+	 * PlotProfiler.
+	 */
+	size_t take_drawn_points() const;
+
+	/**
+	 * Set the number of pixels per envelope column for all curves, e.g. to
+	 * draw coarser envelopes while the GUI thread falls behind, see
+	 * LoadGovernor. The default is 1.
+	 */
+	static void set_column_step(int step);
+	static int column_step();
+	/**
+	 * Return the number of envelope columns for the width in pixels with
+	 * the column step, also used by the CurvePreparer.
+	 */
+	static size_t envelope_columns(double width, int step = column_step());
+	/** Ignore the column step, e.g. for an export. */
+	void set_full_resolution(bool full_resolution);
+	/**
+	 * Multiply the column step for this curve, e.g. to draw the envelopes
+	 * of low priority curves coarser. The default is 1.
+	 */
+	void set_column_step_factor(int factor);
+	/** Return the column step of this curve, including the factor. */
+	int curve_column_step() const;
+	/** Fade the older samples of a complete redraw. The default is off. */
+	void set_fading(bool fading);
+	bool fading() const;
+
+protected:
+	void drawSeries(QPainter *painter,
+		const QwtScaleMap &x_map, const QwtScaleMap &y_map,
+		const QRectF &canvas_rect, int from, int to) const override;
+
+private:
+	/**
+	 * Return the part of the canvas, that is actually painted, from the clip
+	 * of the painter and the region of the paint event.
+	 */
+	static QRectF paint_rect(const QPainter *painter, const QRectF &canvas_rect);
+
+	/**
+	 * Stroke the kept polyline, if it was drawn with the same scale maps
+	 * and the samples weren't dropped or cleared since.
+	 *
+	 * @return false if the curve has to be drawn from the samples.
+	 */
+	bool draw_stroke(QPainter *painter,
+		const QwtScaleMap &x_map, const QwtScaleMap &y_map) const;
+	/**
+	 * Keep the polyline of a complete redraw, that contains the samples up
+	 * to data_size.
+	 */
+	void keep_stroke(const QPolygonF &points, size_t data_size,
+		const QwtScaleMap &x_map, const QwtScaleMap &y_map) const;
+	/**
+	 * Draw the points as polyline with the pen of the curve, faded if
+	 * fading is on.
+	 */
+	void draw_polyline(QPainter *painter, const QPolygonF &points) const;
+
+	/** The maximum number of points of a kept polyline. */
+	static const int max_stroke_size_;
+	/** The number of parts of a faded polyline. */
+	static const int fade_steps_;
+	/** The opacity of the oldest part of a faded polyline. */
+	static const double fade_min_alpha_;
+	static std::atomic<int> column_step_;
+
+	const BaseCurveData *curve_data_;
+	const CurvePreparer *curve_preparer_;
+	/** The points of the last envelope, reused to avoid allocations. */
+	mutable QPolygonF envelope_;
+	bool full_resolution_;
+	int column_step_factor_;
+	bool fading_;
+	mutable size_t drawn_points_;
+	/** The polyline of the last complete redraw in canvas coordinates. */
+	mutable QPolygonF stroke_;
+	mutable bool stroke_valid_;
+	mutable QwtScaleMap stroke_x_map_;
+	mutable QwtScaleMap stroke_y_map_;
+	/** The number of samples and the first sample, when stroke_ was kept. */
+	mutable size_t stroke_data_size_;
+	mutable QPointF stroke_first_sample_;
+	/** The column step, when stroke_ was kept. */
+	mutable int stroke_column_step_;
+
+};
+
+} // namespace plot
+} // namespace widgets
+} // namespace ui
+} // namespace sv
+
+#endif // UI_WIDGETS_PLOT_ENVELOPECURVE_HPP
@@ -0,0 +1,370 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <utility>
+
+#include <QPointF>
+#include <QPolygonF>
+
+#include "envelopetilecache.hpp"
+#include "src/ui/widgets/plot/basecurvedata.hpp"
+#include "src/ui/widgets/plot/scaletransform.hpp"
+
+namespace sv {
+namespace ui {
+namespace widgets {
+namespace plot {
+
+namespace {
+
+// Tile indices beyond this can't be represented exactly as double
+const double max_tile_index = 4503599627370496.; // 2^52
+
+bool is_same_value(double value1, double value2)
+{
+	return value1 == value2 || (std::isnan(value1) && std::isnan(value2));
+}
+
+}
+
+const size_t EnvelopeTileCache::max_tiles_ = 64;
+const size_t EnvelopeTileCache::level_history_size_ = 4;
+
+bool EnvelopeTileCache::TileKey::operator<(const TileKey &other) const
+{
+	if (level != other.level)
+		return level < other.level;
+	if (columns != other.columns)
+		return columns < other.columns;
+	return index < other.index;
+}
+
+EnvelopeTileCache::EnvelopeTileCache(const BaseCurveData *curve_data) :
+	curve_data_(curve_data),
+	use_count_(0),
+	last_center_(0.),
+	last_size_(0)
+{
+}
+
+bool EnvelopeTileCache::envelope(double x_min, double x_max, size_t columns,
+	const ScaleTransform &x_transform, const ScaleTransform &y_transform,
+	QPolygonF &points)
+{
+	// The tiles need monotonic x values
+	if (curve_data_->type() != CurveType::TimeCurve)
+		return false;
+	if (columns == 0 || !(x_max > x_min) || !std::isfinite(x_max - x_min))
+		return false;
+
+	double data_min;
+	double data_max;
+	if (!check_data(data_min, data_max))
+		return false;
+
+	// The visible range spans two or three tiles
+	const double x_width = x_max - x_min;
+	int exponent;
+	(void)std::frexp(x_width, &exponent);
+	const int level = exponent - 1;
+	const double tile_width = std::ldexp(1., level);
+	const double first_index = std::floor(x_min / tile_width);
+	const double last_index = std::floor(x_max / tile_width);
+	if (std::fabs(first_index) > max_tile_index ||
+			std::fabs(last_index) > max_tile_index)
+		return false;
+
+	// Round the columns up to a power of two, so the tiles can be reused,
+	// while zooming inside of a level.
+	const size_t min_columns =
+		(size_t)std::ceil((double)columns * tile_width / x_width);
+	size_t tile_columns = 1;
+	while (tile_columns < min_columns)
+		tile_columns <<= 1;
+
+	const bool same_level =
+		!level_history_.empty() && level_history_.front() == level;
+	remember_level(level);
+
+	points.clear();
+	const int64_t first = (int64_t)first_index;
+	const int64_t last = (int64_t)last_index;
+	for (int64_t index = first; index <= last; ++index) {
+		Tile temp_tile;
+		Tile &tile = get_tile(TileKey{ level, tile_columns, index },
+			data_min, data_max, temp_tile);
+		if (index == first && tile.has_before) {
+			points.append(QPointF(x_transform.scale(tile.before.x()),
+				y_transform.scale(tile.before.y())));
+		}
+		points += scaled_points(tile, x_transform, y_transform);
+		if (index == last && tile.has_after) {
+			points.append(QPointF(x_transform.scale(tile.after.x()),
+				y_transform.scale(tile.after.y())));
+		}
+	}
+
+	// Prefetch the neighbours, the one in the direction of the pan first
+	const double center = (x_min + x_max) / 2.;
+	const TileKey before_key{ level, tile_columns, first - 1 };
+	const TileKey after_key{ level, tile_columns, last + 1 };
+	prefetch_keys_.clear();
+	if (same_level && center < last_center_) {
+		prefetch_keys_.push_back(after_key);
+		prefetch_keys_.push_back(before_key);
+	}
+	else {
+		prefetch_keys_.push_back(before_key);
+		prefetch_keys_.push_back(after_key);
+	}
+	last_center_ = center;
+
+	return true;
+}
+
+bool EnvelopeTileCache::prefetch()
+{
+	while (!prefetch_keys_.empty()) {
+		const TileKey key = prefetch_keys_.back();
+		prefetch_keys_.pop_back();
+		if (tiles_.count(key) > 0)
+			continue;
+
+		double data_min;
+		double data_max;
+		if (!check_data(data_min, data_max)) {
+			prefetch_keys_.clear();
+			return false;
+		}
+		// Tiles outside of the samples wouldn't be cached
+		double start;
+		double end;
+		tile_range(key, start, end);
+		if (start < data_min || end >= data_max)
+			continue;
+
+		Tile temp_tile;
+		(void)get_tile(key, data_min, data_max, temp_tile);
+		break;
+	}
+	return !prefetch_keys_.empty();
+}
+
+void EnvelopeTileCache::clear()
+{
+	tiles_.clear();
+	prefetch_keys_.clear();
+}
+
+size_t EnvelopeTileCache::tile_count() const
+{
+	return tiles_.size();
+}
+
+bool EnvelopeTileCache::check_data(double &data_min, double &data_max)
+{
+	const size_t size = curve_data_->size();
+	if (size == 0) {
+		clear();
+		last_size_ = 0;
+		return false;
+	}
+
+	const QPointF first_sample = curve_data_->sample(0);
+	data_min = first_sample.x();
+	data_max = curve_data_->sample(size - 1).x();
+
+	if (last_size_ > 0) {
+		// The timestamps only run backwards, if the samples were cleared (or
+		// the curve was switched to relative time). Otherwise the first
+		// sample only changes, when samples were dropped.
+		const bool has_same_first = is_same_value(
+				first_sample.x(), last_first_sample_.x()) &&
+			is_same_value(first_sample.y(), last_first_sample_.y());
+		if (first_sample.x() < last_first_sample_.x() ||
+				(first_sample.x() == last_first_sample_.x() &&
+				(!has_same_first || size < last_size_))) {
+			clear();
+		}
+		else if (first_sample.x() > last_first_sample_.x()) {
+			for (auto it = tiles_.begin(); it != tiles_.end(); ) {
+				double start;
+				double end;
+				tile_range(it->first, start, end);
+				if (start < data_min)
+					it = tiles_.erase(it);
+				else
+					++it;
+			}
+		}
+	}
+	last_size_ = size;
+	last_first_sample_ = first_sample;
+
+	return true;
+}
+
+EnvelopeTileCache::Tile &EnvelopeTileCache::get_tile(
+	const TileKey &key, double data_min, double data_max, Tile &temp_tile)
+{
+	auto it = tiles_.find(key);
+	if (it != tiles_.end()) {
+		it->second.last_use = ++use_count_;
+		return it->second;
+	}
+
+	decimate_tile(key, temp_tile);
+	temp_tile.last_use = ++use_count_;
+
+	// Only complete tiles are cached. A sample, that is appended later, can
+	// only change the tile at the live edge.
+	double start;
+	double end;
+	tile_range(key, start, end);
+	if (start < data_min || end >= data_max)
+		return temp_tile;
+
+	it = tiles_.insert(std::make_pair(key, temp_tile)).first;
+	// The new tile is the most recently used one and is never evicted here.
+	evict();
+	return it->second;
+}
+
+void EnvelopeTileCache::decimate_tile(const TileKey &key, Tile &tile) const
+{
+	double start;
+	double end;
+	tile_range(key, start, end);
+
+	QPolygonF samples;
+	if (!curve_data_->envelope(start, end, key.columns, samples)) {
+		// There are only a few samples in the tile, take them as they are
+		samples.clear();
+		size_t first;
+		size_t last;
+		const size_t size = curve_data_->size();
+		if (size > 0 && curve_data_->visible_range(start, end, first, last)) {
+			if (last >= size)
+				last = size - 1;
+			for (size_t i = first; i <= last; ++i)
+				samples.append(curve_data_->sample(i));
+		}
+	}
+
+	// The envelope and the visible range include the neighbouring samples
+	// outside of the tile. They are only needed at the edges of the visible
+	// range.
+	tile.points.clear();
+	tile.scaled_points.clear();
+	tile.scale_key = -1;
+	tile.has_before = false;
+	tile.has_after = false;
+	for (const auto &point : samples) {
+		if (point.x() < start) {
+			tile.before = point;
+			tile.has_before = true;
+		}
+		else if (point.x() > end) {
+			if (!tile.has_after) {
+				tile.after = point;
+				tile.has_after = true;
+			}
+		}
+		else {
+			tile.points.append(point);
+		}
+	}
+}
+
+const QPolygonF &EnvelopeTileCache::scaled_points(Tile &tile,
+	const ScaleTransform &x_transform, const ScaleTransform &y_transform)
+{
+	if (x_transform.type() == ScaleTransform::Type::Linear &&
+			y_transform.type() == ScaleTransform::Type::Linear)
+		return tile.points;
+
+	// Custom transformations are not cached, they may have parameters
+	const int scale_key =
+		x_transform.is_cacheable() && y_transform.is_cacheable() ?
+		(int)x_transform.type() * 3 + (int)y_transform.type() : -1;
+	if (scale_key < 0 || scale_key != tile.scale_key) {
+		tile.scaled_points = tile.points;
+		ScaleTransform::scale_points(
+			tile.scaled_points, x_transform, y_transform);
+		tile.scale_key = scale_key;
+	}
+	return tile.scaled_points;
+}
+
+void EnvelopeTileCache::tile_range(const TileKey &key,
+	double &start, double &end)
+{
+	const double tile_width = std::ldexp(1., key.level);
+	start = (double)key.index * tile_width;
+	end = start + tile_width;
+}
+
+void EnvelopeTileCache::remember_level(int level)
+{
+	for (auto it = level_history_.begin(); it != level_history_.end(); ++it) {
+		if (*it == level) {
+			level_history_.erase(it);
+			break;
+		}
+	}
+	level_history_.push_front(level);
+	if (level_history_.size() > level_history_size_)
+		level_history_.pop_back();
+}
+
+void EnvelopeTileCache::evict()
+{
+	while (tiles_.size() > max_tiles_) {
+		// Evict the least recently used tile, but keep the tiles of the
+		// recently used zoom levels as long as possible.
+		auto victim = tiles_.end();
+		bool victim_in_history = true;
+		for (auto it = tiles_.begin(); it != tiles_.end(); ++it) {
+			bool in_history = false;
+			for (const int level : level_history_) {
+				if (level == it->first.level) {
+					in_history = true;
+					break;
+				}
+			}
+			if (victim == tiles_.end() ||
+					(victim_in_history && !in_history) ||
+					(victim_in_history == in_history &&
+					it->second.last_use < victim->second.last_use)) {
+				victim = it;
+				victim_in_history = in_history;
+			}
+		}
+		tiles_.erase(victim);
+	}
+}
+
+} // namespace plot
+} // namespace widgets
+} // namespace ui
+} // namespace sv
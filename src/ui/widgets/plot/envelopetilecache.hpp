@@ -0,0 +1,159 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_WIDGETS_PLOT_ENVELOPETILECACHE_HPP
+#define UI_WIDGETS_PLOT_ENVELOPETILECACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <vector>
+
+#include <QPointF>
+#include <QPolygonF>
+
+using std::deque;
+using std::map;
+using std::vector;
+
+namespace sv {
+namespace ui {
+namespace widgets {
+namespace plot {
+
+class BaseCurveData;
+class ScaleTransform;
+
+/**
+ * A cache of decimated tiles of a time curve, so panning and zooming back
+ * and forth doesn't decimate the same samples again and again.
+ *
+ * The x axis is divided into tiles, whose width is a power of two, so that
+ * the visible range spans two or three tiles. Each tile holds the envelope
+ * (or the samples, if there are only a few) of its range in data
+ * coordinates. Only complete tiles, that are inside the range of the
+ * samples, are cached, the tile at the live edge is decimated again.
+ *
+ * The tiles of the zoom levels, that were used recently, are kept over
+ * other tiles, so zooming back to a previous level is instant. The tiles
+ * next to the visible range can be prefetched, the tile in the direction
+ * of the last pan first.
+ *
+ * The scale part of the axis transformations (e.g. the log of a logarithmic
+ * axis, see ScaleTransform) is also cached with the tiles, so a log plot
+ * only has to map the cached points to the canvas like a linear plot.
+ *
+ * The cache is not thread-safe, see CurvePreparer.
+ */
+class EnvelopeTileCache
+{
+public:
+	explicit EnvelopeTileCache(const BaseCurveData *curve_data);
+
+	/**
+	 * Return the decimated samples, that are needed to draw the range
+	 * [x_min, x_max] with columns pixels, in &points. The points are already
+	 * scaled, see ScaleTransform::scale_points().
+	 *
+	 * @return false if the curve can't be tiled, e.g. because it is a XY
+	 *         curve.
+	 */
+	bool envelope(double x_min, double x_max, size_t columns,
+		const ScaleTransform &x_transform, const ScaleTransform &y_transform,
+		QPolygonF &points);
+
+	/**
+	 * Decimate the next tile, that could be needed next.
+	 *
+	 * @return false if there are no more tiles to prefetch.
+	 */
+	bool prefetch();
+
+	void clear();
+	size_t tile_count() const;
+
+private:
+	struct TileKey
+	{
+		int level;
+		size_t columns;
+		int64_t index;
+
+		bool operator<(const TileKey &other) const;
+	};
+
+	struct Tile
+	{
+		/** The points inside of the tile. */
+		QPolygonF points;
+		/** The last sample before the tile. */
+		bool has_before;
+		QPointF before;
+		/** The first sample after the tile. */
+		bool has_after;
+		QPointF after;
+		/** The scaled points of a curve with a non-linear axis. */
+		QPolygonF scaled_points;
+		/** The scale types of scaled_points, -1 if there are none. */
+		int scale_key;
+		uint64_t last_use;
+	};
+
+	/**
+	 * Drop the tiles of dropped samples and all tiles, if the samples were
+	 * cleared. Sets &data_min and &data_max to the x range of the samples.
+	 *
+	 * @return false if there are no samples.
+	 */
+	bool check_data(double &data_min, double &data_max);
+	/** Return the cached tile or the decimated tile in &temp_tile. */
+	Tile &get_tile(const TileKey &key, double data_min, double data_max,
+		Tile &temp_tile);
+	/** Return the points of the tile with the scale part applied. */
+	static const QPolygonF &scaled_points(Tile &tile,
+		const ScaleTransform &x_transform, const ScaleTransform &y_transform);
+	void decimate_tile(const TileKey &key, Tile &tile) const;
+	static void tile_range(const TileKey &key, double &start, double &end);
+	void remember_level(int level);
+	void evict();
+
+	/** The maximum number of cached tiles. */
+	static const size_t max_tiles_;
+	/** The number of zoom levels, whose tiles are kept over other tiles. */
+	static const size_t level_history_size_;
+
+	const BaseCurveData *curve_data_;
+	map<TileKey, Tile> tiles_;
+	uint64_t use_count_;
+	/** The recently used zoom levels, the current level first. */
+	deque<int> level_history_;
+	vector<TileKey> prefetch_keys_;
+	double last_center_;
+	size_t last_size_;
+	QPointF last_first_sample_;
+
+};
+
+} // namespace plot
+} // namespace widgets
+} // namespace ui
+} // namespace sv
+
+#endif // UI_WIDGETS_PLOT_ENVELOPETILECACHE_HPP
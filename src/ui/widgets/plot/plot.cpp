@@ -18,23 +18,32 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <limits>
 #include <memory>
 #include <string>
 #include <utility>
 
 #include <QtMath>
 #include <QBoxLayout>
+#include <QColor>
 #include <QDateTime>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QEvent>
 #include <QHBoxLayout>
+#include <QLabel>
+#include <QPainter>
+#include <QPalette>
 #include <QPen>
 #include <QPoint>
 #include <QPointF>
 #include <QPushButton>
+#include <QRect>
 #include <QRectF>
+#include <QRegion>
 #include <QSize>
 #include <QUuid>
 #include <QVariant>
@@ -42,14 +51,17 @@
 #include <qwt_scale_widget.h>
 #include <qwt_curve_fitter.h>
 #include <qwt_date_scale_engine.h>
+#include <qwt_global.h>
 #include <qwt_legend.h>
 #include <qwt_math.h>
 #include <qwt_painter.h>
 #include <qwt_picker_machine.h>
 #include <qwt_plot_canvas.h>
 #include <qwt_plot_curve.h>
-#include <qwt_plot_directpainter.h>
 #include <qwt_plot_grid.h>
+#if QWT_VERSION >= 0x060200
+#include <qwt_plot_opengl_canvas.h>
+#endif
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wdeprecated-declarations"
 // This header uses deprecated declarations, disable checks.
@@ -65,13 +77,23 @@
 
 #include "plot.hpp"
 #include "src/session.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/formatter.hpp"
+#include "src/data/minmaxpyramid.hpp"
 #include "src/devices/basedevice.hpp"
+#include "src/tracer.hpp"
 #include "src/ui/dialogs/plotcurveconfigdialog.hpp"
 #include "src/ui/widgets/plot/axislocklabel.hpp"
+#include "src/ui/widgets/plot/backgroundlayer.hpp"
 #include "src/ui/widgets/plot/basecurvedata.hpp"
 #include "src/ui/widgets/plot/curve.hpp"
+#include "src/ui/widgets/plot/curvepreparer.hpp"
+#include "src/ui/widgets/plot/densitycurve.hpp"
 #include "src/ui/widgets/plot/plotmagnifier.hpp"
 #include "src/ui/widgets/plot/plotscalepicker.hpp"
+#include "src/ui/widgets/plot/plotscheduler.hpp"
+#include "src/ui/widgets/plot/segmentpainter.hpp"
+#include "src/ui/widgets/plot/timeaxiscontroller.hpp"
 #include "src/ui/widgets/plot/timecurvedata.hpp"
 #include "src/ui/widgets/plot/xycurvedata.hpp"
 
@@ -84,6 +106,27 @@ namespace ui {
 namespace widgets {
 namespace plot {
 
+namespace {
+
+void setup_canvas_palette(QWidget *canvas)
+{
+	QPalette pal = canvas->palette();
+
+	QLinearGradient gradient;
+	gradient.setCoordinateMode(QGradient::StretchToDeviceMode);
+	gradient.setColorAt(0.0, QColor(0, 49, 110));
+	gradient.setColorAt(1.0, QColor(0, 87, 174));
+
+	pal.setBrush(QPalette::Window, QBrush(gradient));
+
+	// QPalette::WindowText is used for the curve color
+	pal.setColor(QPalette::WindowText, Qt::green);
+
+	canvas->setPalette(pal);
+}
+
+}
+
 class Canvas : public QwtPlotCanvas
 {
 public:
@@ -103,6 +146,9 @@ public:
 		 */
 		setPaintAttribute(QwtPlotCanvas::ImmediatePaint, true);
 		setBorderRadius(10);
+		// The background is drawn from the cached layer, see
+		// Plot::drawItems()
+		setAutoFillBackground(false);
 
 		if (QwtPainter::isX11GraphicsSystem()) {
 			/*
@@ -120,42 +166,45 @@ public:
 			}
 		}
 
-		setupPalette();
+		setup_canvas_palette(this);
 	}
+};
 
-private:
-	void setupPalette()
+#if QWT_VERSION >= 0x060200
+/**
+ * The OpenGL canvas renders the whole plot on each update, so there is no
+ * incremental drawing with the direct painter. The curves are rasterized on
+ * the GPU, which takes the load off the CPU when many plots are updated.
+ */
+class OpenGLCanvas : public QwtPlotOpenGLCanvas
+{
+public:
+	explicit OpenGLCanvas(QwtPlot *plot = nullptr) : QwtPlotOpenGLCanvas(plot)
 	{
-		QPalette pal = palette();
-
-		QLinearGradient gradient;
-		gradient.setCoordinateMode(QGradient::StretchToDeviceMode);
-		gradient.setColorAt(0.0, QColor(0, 49, 110));
-		gradient.setColorAt(1.0, QColor(0, 87, 174));
-
-		pal.setBrush(QPalette::Window, QBrush(gradient));
-
-		// QPalette::WindowText is used for the curve color
-		pal.setColor(QPalette::WindowText, Qt::green);
-
-		setPalette(pal);
+		setBorderRadius(10);
+		setup_canvas_palette(this);
 	}
 };
+#endif
 
 Plot::Plot(Session &session, QWidget *parent) : QwtPlot(parent),
 	session_(session),
-	plot_interval_(200),
-	timer_id_(-1),
+	plot_interval_(0),
 	time_span_(120.),
 	add_time_(30.),
 	active_marker_(nullptr),
 	markers_label_(nullptr),
 	markers_label_alignment_(Qt::AlignBottom | Qt::AlignHCenter),
 	marker_select_picker_(nullptr),
-	marker_move_picker_(nullptr)
+	marker_move_picker_(nullptr),
+	opengl_canvas_(false),
+	time_axis_controller_(nullptr),
+	synced_x_changed_(false),
+	scroll_mode_(false),
+	profiler_label_(nullptr)
 {
 	this->setAutoReplot(false);
-	this->setCanvas(new Canvas());
+	segment_painter_ = new SegmentPainter(this);
 
 	// This must be done, because when the QwtPlot widget is directly or
 	// indirectly in a (Main)Window, therefor the minimum size is way to big.
@@ -173,13 +222,16 @@ Plot::Plot(Session &session, QWidget *parent) : QwtPlot(parent),
 	connect(legend, SIGNAL(clicked(const QVariant &, int)),
 		this, SLOT(on_legend_clicked(const QVariant &, int)));
 
+	// The grid lines of the x axis move with the time axis, the lines of
+	// the y axis are drawn into the background layer.
 	QwtPlotGrid *grid = new QwtPlotGrid();
 	grid->setPen(Qt::gray, 0.0, Qt::DotLine);
 	grid->enableX(true);
 	grid->enableXMin(true);
-	grid->enableY(true);
+	grid->enableY(false);
 	grid->enableYMin(false);
 	grid->attach(this);
+	background_layer_.grid()->setPen(Qt::gray, 0.0, Qt::DotLine);
 
 	// Disable all x axis to have a known state for init_x_axis()
 	this->enableAxis(QwtPlot::xBottom, false);
@@ -191,20 +243,13 @@ Plot::Plot(Session &session, QWidget *parent) : QwtPlot(parent),
 	// Zooming and panning via the axes
 	(void)new PlotScalePicker(this);
 
-	// Panning via the canvas
-	plot_panner_ = new QwtPlotPanner(this->canvas());
-	connect(plot_panner_, SIGNAL(panned(int, int)),
-		this, SLOT(lock_all_axis()));
-
-	// Zooming via the canvas
-	plot_magnifier_ = new PlotMagnifier(this->canvas());
-	connect(plot_magnifier_, SIGNAL(magnified(double)),
-		this, SLOT(lock_all_axis()));
+	init_canvas();
 }
 
 Plot::~Plot()
 {
 	this->stop();
+	this->set_time_axis_synced(false);
 	for (auto &marker_pair : marker_curve_map_)
 		delete marker_pair.first;
 	for (auto &curve_pair : curve_map_)
@@ -213,22 +258,176 @@ Plot::~Plot()
 
 void Plot::start()
 {
-	timer_id_ = startTimer(plot_interval_);
+	session_.plot_scheduler()->add_plot(this);
 }
 
 void Plot::stop()
 {
 	//qWarning() << "Plot::stop() for " << curve_data_->name();
-	killTimer(timer_id_);
+	session_.plot_scheduler()->remove_plot(this);
+}
+
+bool Plot::needs_render() const
+{
+	if (!this->isVisible() || this->window()->isMinimized() ||
+			this->visibleRegion().isEmpty())
+		return false;
+
+	if (synced_x_changed_)
+		return true;
+	for (const auto &curve : curve_map_) {
+		if (curve.second->curve_data()->size() !=
+				curve.second->painted_points())
+			return true;
+	}
+	return false;
+}
+
+CurvePriority Plot::render_priority() const
+{
+	CurvePriority priority = CurvePriority::Low;
+	bool has_new_samples = false;
+	for (const auto &curve : curve_map_) {
+		if (!synced_x_changed_ && curve.second->curve_data()->size() ==
+				curve.second->painted_points())
+			continue;
+		has_new_samples = true;
+		if (curve.second->priority() > priority)
+			priority = curve.second->priority();
+	}
+	return has_new_samples ? priority : CurvePriority::Normal;
+}
+
+void Plot::render(CurvePriority min_priority)
+{
+	SV_TRACE_SCOPE("Plot::render");
+
+	update_intervals();
+	update_curves(min_priority);
+}
+
+void Plot::set_low_priority_column_step_factor(int factor)
+{
+	for (const auto &curve : curve_map_) {
+		if (curve.second->priority() == CurvePriority::Low)
+			curve.second->set_column_step_factor(factor);
+	}
+}
+
+bool Plot::has_opengl_canvas()
+{
+#if QWT_VERSION >= 0x060200
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool Plot::set_opengl_canvas(bool opengl_canvas)
+{
+	if (opengl_canvas == opengl_canvas_)
+		return true;
+	if (opengl_canvas && !has_opengl_canvas()) {
+		qWarning() << "Plot::set_opengl_canvas(): " <<
+			"Qwt was built without the OpenGL canvas!";
+		return false;
+	}
+
+	opengl_canvas_ = opengl_canvas;
+	init_canvas();
+	replot();
+	return true;
+}
+
+void Plot::init_canvas()
+{
+	// The old canvas is deleted by QwtPlot together with its panner,
+	// magnifier and pickers.
+#if QWT_VERSION >= 0x060200
+	if (opengl_canvas_)
+		this->setCanvas(new OpenGLCanvas());
+	else
+		this->setCanvas(new Canvas());
+#else
+	this->setCanvas(new Canvas());
+#endif
+
+	// Panning via the canvas
+	plot_panner_ = new QwtPlotPanner(this->canvas());
+	connect(plot_panner_, SIGNAL(panned(int, int)),
+		this, SLOT(lock_all_axis()));
+
+	// Zooming via the canvas
+	plot_magnifier_ = new PlotMagnifier(this->canvas());
+	connect(plot_magnifier_, SIGNAL(magnified(double)),
+		this, SLOT(lock_all_axis()));
+
+	marker_select_picker_ = nullptr;
+	marker_move_picker_ = nullptr;
+	if (!marker_curve_map_.empty())
+		init_marker_pickers();
+}
+
+void Plot::init_marker_pickers()
+{
+	if (!marker_select_picker_) {
+		// Use QwtPlot::xBottom and QwtPlot::yLeft as axis. We calculate the
+		// canvas positions for the markers in on_marker_selected()
+		marker_select_picker_ = new QwtPlotPicker(
+			QwtPlot::xBottom, QwtPlot::yLeft, QwtPlotPicker::NoRubberBand,
+			QwtPicker::AlwaysOff, this->canvas());
+		marker_select_picker_->setStateMachine(new QwtPickerClickPointMachine());
+		connect(marker_select_picker_, SIGNAL(selected(const QPointF &)),
+			this, SLOT(on_marker_selected(const QPointF)));
+	}
+	if (!marker_move_picker_) {
+		// Use QwtPlot::xBottom and QwtPlot::yLeft as axis. We calculate the
+		// canvas positions for the markers in on_marker_moved()
+		marker_move_picker_ = new QwtPlotPicker(
+			QwtPlot::xBottom, QwtPlot::yLeft,
+			QwtPlotPicker::NoRubberBand, QwtPicker::AlwaysOff, this->canvas());
+		marker_move_picker_->setStateMachine(new QwtPickerDragPointMachine());
+		connect(marker_move_picker_, SIGNAL(moved(QPointF)),
+			this, SLOT(on_marker_moved(QPointF)));
+	}
 }
 
 void Plot::replot()
 {
+	SV_TRACE_SCOPE("Plot::replot");
+
 	//qWarning() << "Plot::replot()";
-	for (const auto &curve : curve_map_)
-		curve.second->set_painted_points(0);
+	// The complete redraw paints all current samples, so the direct painter
+	// only has to paint the samples, that are appended from now on. The
+	// axes may have changed, so the intervals are checked again.
+	for (const auto &curve : curve_map_) {
+		curve.second->set_painted_points(curve.second->curve_data()->size());
+		curve.second->invalidate_bounds();
+	}
 
+	QElapsedTimer timer;
+	timer.start();
 	QwtPlot::replot();
+	profiler_.add_replot(
+		(double)timer.nsecsElapsed() / 1e6, take_drawn_points());
+}
+
+void Plot::drawItems(QPainter *painter, const QRectF &canvas_rect,
+	const QwtScaleMap maps[]) const
+{
+	// The plot exporter paints on other devices and the OpenGL canvas
+	// fills the background itself.
+	const QwtScaleDiv &y_div = axisScaleDiv(QwtPlot::yLeft);
+	if (!opengl_canvas_ && painter->device() == canvas()) {
+		background_layer_.draw(painter, canvas(), maps[QwtPlot::xBottom],
+			maps[QwtPlot::yLeft], y_div);
+	}
+	else {
+		background_layer_.draw_grid(painter, canvas_rect,
+			maps[QwtPlot::xBottom], maps[QwtPlot::yLeft], y_div);
+	}
+
+	QwtPlot::drawItems(painter, canvas_rect, maps);
 }
 
 string Plot::add_curve(BaseCurveData *curve_data)
@@ -247,7 +446,12 @@ string Plot::add_curve(BaseCurveData *curve_data)
 
 	Curve *curve = new Curve(curve_data, x_axis_id, y_axis_id);
 	curve->plot_curve()->attach(this);
+	if (curve->density_curve())
+		curve->density_curve()->attach(this);
 	curve_map_.insert(make_pair(curve->id(), curve));
+	connect(curve->curve_preparer(), &CurvePreparer::prepared,
+		this, &Plot::on_curve_prepared);
+	update_required_history();
 
 	QwtPlot::replot();
 	Q_EMIT curve_added();
@@ -271,7 +475,12 @@ bool Plot::add_curve(Curve *curve)
 		return false;
 
 	curve->plot_curve()->attach(this);
+	if (curve->density_curve())
+		curve->density_curve()->attach(this);
 	curve_map_.insert(make_pair(curve->id(), curve));
+	connect(curve->curve_preparer(), &CurvePreparer::prepared,
+		this, &Plot::on_curve_prepared);
+	update_required_history();
 
 	QwtPlot::replot();
 	Q_EMIT curve_added();
@@ -507,9 +716,84 @@ void Plot::on_axis_lock_clicked()
 	}
 }
 
+void Plot::set_update_mode(PlotUpdateMode update_mode)
+{
+	update_mode_ = update_mode;
+	if (time_axis_controller_)
+		time_axis_controller_->set_update_mode(update_mode);
+	update_required_history();
+}
+
+void Plot::set_add_time(double add_time)
+{
+	add_time_ = add_time;
+	if (time_axis_controller_)
+		time_axis_controller_->set_add_time(add_time);
+}
+
+void Plot::set_time_axis_synced(bool synced)
+{
+	if (synced == time_axis_synced())
+		return;
+
+	TimeAxisController *controller =
+		session_.plot_scheduler()->time_axis_controller();
+	if (synced) {
+		time_axis_controller_ = controller;
+		controller->add_plot(this);
+	}
+	else {
+		controller->remove_plot(this);
+		time_axis_controller_ = nullptr;
+	}
+}
+
+void Plot::set_synced_x_interval(double min, double max, bool shift_ticks)
+{
+	if (axis_lock_map_[QwtPlot::xBottom][AxisBoundary::LowerBoundary] &&
+			axis_lock_map_[QwtPlot::xBottom][AxisBoundary::UpperBoundary])
+		return;
+
+	if (!synced_x_changed_)
+		synced_old_x_interval_ = axisInterval(QwtPlot::xBottom);
+	if (shift_ticks && update_mode_ == PlotUpdateMode::Oscilloscope) {
+		shift_x_interval(min, max);
+		for (const auto &curve : curve_map_)
+			curve.second->set_painted_points(0);
+	}
+	else {
+		setAxisScale(QwtPlot::xBottom, min, max);
+	}
+	synced_x_changed_ = true;
+}
+
+bool Plot::time_curves_range(double &first, double &last) const
+{
+	bool has_samples = false;
+	for (const auto &curve : curve_map_) {
+		const BaseCurveData *curve_data = curve.second->curve_data();
+		if (curve_data->type() != CurveType::TimeCurve ||
+				curve_data->size() == 0)
+			continue;
+		const QRectF bounds = curve_data->boundingRect();
+		if (!has_samples) {
+			first = bounds.left();
+			last = bounds.right();
+			has_samples = true;
+			continue;
+		}
+		first = std::min(first, bounds.left());
+		last = std::max(last, bounds.right());
+	}
+	return has_samples;
+}
+
 void Plot::set_time_span(double time_span)
 {
 	time_span_ = time_span;
+	if (time_axis_controller_)
+		time_axis_controller_->set_time_span(time_span);
+	update_required_history();
 
 	// time_span_ is used in rolling mode and oscilloscope mode. Find the
 	// last/highest x value/timestamp and use it to calculate the new
@@ -548,26 +832,7 @@ void Plot::add_marker(sv::ui::widgets::plot::Curve *curve)
 	active_marker_ = marker;
 
 	// Add pickers for _all_ markers, no matter of the axis
-	if (!marker_select_picker_) {
-		// Use QwtPlot::xBottom and QwtPlot::yLeft as axis. We calculate the
-		// canvas positions for the markers in on_marker_selected()
-		marker_select_picker_ = new QwtPlotPicker(
-			QwtPlot::xBottom, QwtPlot::yLeft, QwtPlotPicker::NoRubberBand,
-			QwtPicker::AlwaysOff, this->canvas());
-		marker_select_picker_->setStateMachine(new QwtPickerClickPointMachine());
-		connect(marker_select_picker_, SIGNAL(selected(const QPointF &)),
-			this, SLOT(on_marker_selected(const QPointF)));
-	}
-	if (!marker_move_picker_) {
-		// Use QwtPlot::xBottom and QwtPlot::yLeft as axis. We calculate the
-		// canvas positions for the markers in on_marker_moved()
-		marker_move_picker_ = new QwtPlotPicker(
-			QwtPlot::xBottom, QwtPlot::yLeft,
-			QwtPlotPicker::NoRubberBand, QwtPicker::AlwaysOff, this->canvas());
-		marker_move_picker_->setStateMachine(new QwtPickerDragPointMachine());
-		connect(marker_move_picker_, SIGNAL(moved(QPointF)),
-			this, SLOT(on_marker_moved(QPointF)));
-	}
+	init_marker_pickers();
 	/*
 	 * TODO: Maybe we could use a QwtPickerTrackerMachine for mouse movement.
 	 * This way we can avoid the mouse click event (problems with QwtPlotPanner)
@@ -701,54 +966,225 @@ void Plot::on_legend_clicked(const QVariant &item_info, int index)
 	dlg.exec();
 }
 
-void Plot::update_curves()
+void Plot::update_curves(CurvePriority min_priority)
 {
+	SV_TRACE_SCOPE("Plot::update_curves");
+
 	for (const auto &curve : curve_map_) {
-		const size_t painted_points = curve.second->painted_points();
-		const size_t num_points = curve.second->curve_data()->size();
-		if (num_points > painted_points) {
-			//qWarning() << QString("Plot::updateCurve(): num_points = %1, painted_points = %2").
-			//	arg(num_points).arg(painted_points);
-			const bool clip = !canvas()->testAttribute(Qt::WA_PaintOnScreen);
-			if (clip) {
-				/*
-				 * NOTE:
-				 * Depending on the platform setting a clip might be an
-				 * important performance issue. F.e. for Qt Embedded this
-				 * reduces the part of the backing store that has to be copied
-				 * out - maybe to an unaccelerated frame buffer device.
-				 */
-
-				const QwtScaleMap x_map = canvasMap(curve.second->x_axis_id());
-				const QwtScaleMap y_map = canvasMap(curve.second->y_axis_id());
-				QRectF br = qwtBoundingRect(*curve.second->plot_curve()->data(),
-					(int)painted_points - 1, (int)num_points - 1);
-
-				curve.second->plot_direct_painter()->setClipRegion(
-					QwtScaleMap::transform(x_map, y_map, br).toRect());
+		// The samples were dropped (e.g. by the memory budget), so the
+		// painted positions have moved.
+		if (curve.second->needs_replot()) {
+			replot();
+			return;
+		}
+	}
+
+	// Density maps are updated with the new points and redrawn as a whole
+	bool density_changed = false;
+	for (const auto &curve : curve_map_) {
+		if (curve.second->density_curve() &&
+				curve.second->density_curve()->update())
+			density_changed = true;
+	}
+	if (density_changed) {
+		replot();
+		return;
+	}
+
+	if (opengl_canvas_) {
+		// The OpenGL canvas can't be painted directly, it is always repainted
+		// as a whole.
+		for (const auto &curve : curve_map_) {
+			if (curve.second->curve_data()->size() >
+					curve.second->painted_points()) {
+				replot();
+				break;
 			}
-			curve.second->plot_direct_painter()->drawSeries(
-				curve.second->plot_curve(), (int)painted_points - 1,
-				(int)num_points - 1);
-			curve.second->set_painted_points(num_points);
 		}
+		return;
+	}
+
+	// The new samples of all curves are painted in one pass
+	const bool clip = !canvas()->testAttribute(Qt::WA_PaintOnScreen);
+	QRegion clip_region;
+	for (const auto &curve : curve_map_) {
+		const size_t painted_points = curve.second->painted_points();
+		const size_t num_points = curve.second->curve_data()->size();
+		if (num_points <= painted_points)
+			continue;
+		// Painted with a later render
+		if (curve.second->priority() < min_priority)
+			continue;
+
+		//qWarning() << QString("Plot::updateCurve(): num_points = %1, painted_points = %2").
+		//	arg(num_points).arg(painted_points);
+		if (clip) {
+			/*
+			 * NOTE:
+			 * Depending on the platform setting a clip might be an
+			 * important performance issue. F.e. for Qt Embedded this
+			 * reduces the part of the backing store that has to be copied
+			 * out - maybe to an unaccelerated frame buffer device.
+			 */
 
-		//replot();
+			const QwtScaleMap x_map = canvasMap(curve.second->x_axis_id());
+			const QwtScaleMap y_map = canvasMap(curve.second->y_axis_id());
+			QRectF br = qwtBoundingRect(*curve.second->plot_curve()->data(),
+				(int)painted_points - 1, (int)num_points - 1);
+			clip_region |= QwtScaleMap::transform(x_map, y_map, br).toRect();
+		}
+		segment_painter_->add_segment(curve.second->plot_curve(),
+			(int)painted_points - 1, (int)num_points - 1);
+		curve.second->set_painted_points(num_points);
 	}
+	if (!segment_painter_->has_segments())
+		return;
+
+	QElapsedTimer timer;
+	timer.start();
+	segment_painter_->paint(clip_region);
+	profiler_.add_incremental_paint(
+		(double)timer.nsecsElapsed() / 1e6, take_drawn_points());
 }
 
 void Plot::update_intervals()
 {
-	bool intervals_changed = false;
+	// Wait for the last preparation, the intervals are checked again after
+	// the replot.
+	if (is_preparing())
+		return;
+
+	// The x interval of a synced time axis is set by the controller
+	bool intervals_changed = synced_x_changed_;
+	const QwtInterval old_x_interval = synced_x_changed_ ?
+		synced_old_x_interval_ : axisInterval(QwtPlot::xBottom);
+	const QwtInterval old_y_left_interval = axisInterval(QwtPlot::yLeft);
+	const QwtInterval old_y_right_interval = axisInterval(QwtPlot::yRight);
+	synced_x_changed_ = false;
 
 	for (const auto &curve : curve_map_) {
-		if (update_x_interval(curve.second))
+		// Nothing to do, if the curve hasn't changed since the last check
+		if (!curve.second->update_bounds())
+			continue;
+		const bool is_synced = time_axis_controller_ &&
+			curve.second->curve_data()->type() == CurveType::TimeCurve;
+		if (!is_synced && update_x_interval(curve.second))
 			intervals_changed = true;
 		if (update_y_interval(curve.second))
 			intervals_changed = true;
 	}
 
-	if (intervals_changed)
+	if (!intervals_changed)
+		return;
+	if (scroll_canvas(old_x_interval, old_y_left_interval,
+			old_y_right_interval))
+		return;
+
+	// Prepare the complete redraw in the worker threads, the plot is
+	// replotted when all curves are prepared (see on_curve_prepared()).
+	this->updateAxes();
+	bool preparing = false;
+	for (const auto &curve : curve_map_) {
+		if (curve.second->prepare(canvasMap(curve.second->x_axis_id()),
+				canvasMap(curve.second->y_axis_id())))
+			preparing = true;
+	}
+	if (!preparing)
+		replot();
+}
+
+bool Plot::scroll_canvas(const QwtInterval &old_x_interval,
+	const QwtInterval &old_y_left_interval,
+	const QwtInterval &old_y_right_interval)
+{
+	// The OpenGL canvas is always repainted as a whole and the markers label
+	// has a fixed position on the canvas.
+	if (!scroll_mode_ || opengl_canvas_ ||
+			update_mode_ != PlotUpdateMode::Rolling ||
+			!marker_curve_map_.empty())
+		return false;
+	if (axisInterval(QwtPlot::yLeft) != old_y_left_interval ||
+			axisInterval(QwtPlot::yRight) != old_y_right_interval)
+		return false;
+
+	const QwtInterval x_interval = axisInterval(QwtPlot::xBottom);
+	const double width = old_x_interval.width();
+	if (width <= 0. ||
+			std::fabs(x_interval.width() - width) > width * 1e-9)
+		return false;
+	const QwtScaleMap x_map = canvasMap(QwtPlot::xBottom);
+	if (x_map.transformation() != nullptr || x_map.pDist() <= 0.)
+		return false;
+
+	// Don't scroll the rounded corners of the canvas, they are redrawn
+	const QRect contents_rect = canvas()->contentsRect();
+	const int radius = (int)std::ceil(
+		static_cast<QwtPlotCanvas *>(canvas())->borderRadius());
+	const QRect scroll_rect = contents_rect.adjusted(radius, 0, -radius, 0);
+	const double pixels_per_unit = x_map.pDist() / width;
+	const int pixels = (int)std::lround(
+		(x_interval.minValue() - old_x_interval.minValue()) * pixels_per_unit);
+	if (pixels <= 0 || pixels >= scroll_rect.width())
+		return false;
+
+	// Snap the interval to whole pixels, so the moved content matches the
+	// new axis.
+	const double min = old_x_interval.minValue() + pixels / pixels_per_unit;
+	setAxisScale(QwtPlot::xBottom, min, min + width);
+	this->updateAxes();
+
+	// The exposed strip is painted later, its points are counted with the
+	// next paint.
+	QElapsedTimer timer;
+	timer.start();
+	canvas()->scroll(-pixels, 0, scroll_rect);
+	canvas()->update(QRect(contents_rect.left(), contents_rect.top(),
+		radius, contents_rect.height()));
+	canvas()->update(QRect(scroll_rect.right() + 1 - pixels,
+		contents_rect.top(), contents_rect.right() - scroll_rect.right() +
+		pixels, contents_rect.height()));
+
+	// The new samples are drawn by the repaint of their area, that is still
+	// pending. Painting them with the segment painter, would paint the
+	// pending area with the new samples only.
+	for (const auto &curve : curve_map_) {
+		const size_t painted_points = curve.second->painted_points();
+		const size_t num_points = curve.second->curve_data()->size();
+		if (num_points <= painted_points)
+			continue;
+		if (painted_points > 0) {
+			const QwtScaleMap curve_x_map =
+				canvasMap(curve.second->x_axis_id());
+			const QwtScaleMap curve_y_map =
+				canvasMap(curve.second->y_axis_id());
+			const QRectF br = qwtBoundingRect(
+				*curve.second->plot_curve()->data(),
+				(int)painted_points - 1, (int)num_points - 1);
+			canvas()->update(QwtScaleMap::transform(
+				curve_x_map, curve_y_map, br).toAlignedRect().
+				adjusted(-2, -2, 2, 2));
+		}
+		else {
+			canvas()->update(contents_rect);
+		}
+		curve.second->set_painted_points(num_points);
+	}
+	profiler_.add_incremental_paint((double)timer.nsecsElapsed() / 1e6, 0);
+	return true;
+}
+
+bool Plot::is_preparing() const
+{
+	for (const auto &curve : curve_map_) {
+		if (curve.second->curve_preparer()->is_pending())
+			return true;
+	}
+	return false;
+}
+
+void Plot::on_curve_prepared()
+{
+	if (!is_preparing())
 		replot();
 }
 
@@ -759,7 +1195,7 @@ bool Plot::update_x_interval(Curve *curve)
 		return false;
 
 	bool interval_changed = false;
-	QRectF boundaries = curve->curve_data()->boundingRect();
+	const QRectF boundaries = curve->bounds();
 	QwtInterval x_interval = this->axisInterval(QwtPlot::xBottom);
 	double min = x_interval.minValue();
 	double max = x_interval.maxValue();
@@ -804,53 +1240,48 @@ bool Plot::update_x_interval(Curve *curve)
 	// Handle the Rolling plot mode
 	else if (update_mode_ == PlotUpdateMode::Rolling) {
 		// TODO: axis locking. Lock/Unlock both upper and lower together!
-		if (boundaries.right() <= max)
+		if (!TimeAxisController::next_interval(update_mode_, time_span_,
+				add_time_, boundaries.left(), boundaries.right(), min, max))
 			return false;
 
-		if (boundaries.right() > max+time_span_)
-			min = boundaries.right();
-		else
-			min += add_time_;
-		max = min + time_span_;
-
 		interval_changed = true;
 		setAxisScale(QwtPlot::xBottom, min, max);
 	}
 	// Handle the Oscilloscope plot mode
 	else if (update_mode_ == PlotUpdateMode::Oscilloscope) {
 		// TODO: axis locking. Lock/Unlock both upper and lower together?
-		if (boundaries.right() <= max)
+		if (!TimeAxisController::next_interval(update_mode_, time_span_,
+				add_time_, boundaries.left(), boundaries.right(), min, max))
 			return false;
 
-		if (boundaries.right() > max+time_span_)
-			min = boundaries.right();
-		else
-			min += time_span_;
-		max = min + time_span_;
-
-		/*
-		 * NOTE:
-		 * To avoid, that the grid is jumping, we disable the autocalculation
-		 * of the ticks and shift them manually instead.
-		 */
-		QwtScaleDiv scaleDiv = axisScaleDiv(QwtPlot::xBottom);
-		scaleDiv.setInterval(min, max);
-		for (int i = 0; i < QwtScaleDiv::NTickTypes; i++) {
-			QList<double> ticks = scaleDiv.ticks(i);
-			for (int j = 0; j < ticks.size(); j++) {
-				ticks[j] += x_interval.width();
-			}
-			scaleDiv.setTicks(i, ticks);
-		}
-
 		interval_changed = true;
-		setAxisScaleDiv(QwtPlot::xBottom, scaleDiv);
+		shift_x_interval(min, max);
 		curve->set_painted_points(0);
 	}
 
 	return interval_changed;
 }
 
+void Plot::shift_x_interval(double min, double max)
+{
+	/*
+	 * NOTE:
+	 * To avoid, that the grid is jumping, we disable the autocalculation
+	 * of the ticks and shift them manually instead.
+	 */
+	const double width = this->axisInterval(QwtPlot::xBottom).width();
+	QwtScaleDiv scaleDiv = axisScaleDiv(QwtPlot::xBottom);
+	scaleDiv.setInterval(min, max);
+	for (int i = 0; i < QwtScaleDiv::NTickTypes; i++) {
+		QList<double> ticks = scaleDiv.ticks(i);
+		for (int j = 0; j < ticks.size(); j++) {
+			ticks[j] += width;
+		}
+		scaleDiv.setTicks(i, ticks);
+	}
+	setAxisScaleDiv(QwtPlot::xBottom, scaleDiv);
+}
+
 bool Plot::update_y_interval(const Curve *curve)
 {
 	int y_axis_id = curve->y_axis_id();
@@ -858,7 +1289,7 @@ bool Plot::update_y_interval(const Curve *curve)
 			axis_lock_map_[y_axis_id][AxisBoundary::UpperBoundary])
 		return false;
 
-	QRectF boundaries = curve->curve_data()->boundingRect();
+	const QRectF boundaries = curve->bounds();
 	QwtInterval y_interval = this->axisInterval(y_axis_id);
 	double min = y_interval.minValue();
 	double max = y_interval.maxValue();
@@ -904,6 +1335,8 @@ void Plot::update_markers_label()
 		markers_label_->attach(this);
 	}
 
+	// Formats like QString::arg(double)
+	const data::Formatter formatter;
 	QString table("<table>");
 
 	for (const auto &mc_pair : marker_curve_map_) {
@@ -911,10 +1344,10 @@ void Plot::update_markers_label()
 		table.append(QString("<td width=\"50\" align=\"left\">%1:</td>").
 			arg(mc_pair.first->title().text()));
 		table.append(QString("<td width=\"70\" align=\"right\">%2 %3</td>").
-			arg(mc_pair.first->yValue()).
+			arg(formatter.format_general(mc_pair.first->yValue())).
 			arg(mc_pair.second->curve_data()->y_unit_str()));
 		table.append(QString("<td width=\"70\" align=\"right\">%4 %5</td>").
-			arg(mc_pair.first->xValue()).
+			arg(formatter.format_general(mc_pair.first->xValue())).
 			arg(mc_pair.second->curve_data()->x_unit_str()));
 		table.append("</tr>");
 	}
@@ -944,10 +1377,41 @@ void Plot::update_markers_label()
 			marker_pair.first->title().text(),
 			marker_pair.second->title().text()));
 		table.append(QString("<td width=\"70\" align=\"right\">%1 %2</td>").
-			arg(d_y).arg(y_unit));
+			arg(formatter.format_general(d_y)).arg(y_unit));
 		table.append(QString("<td width=\"70\" align=\"right\">%1 %2</td>").
-			arg(d_x).arg(x_unit));
+			arg(formatter.format_general(d_x)).arg(x_unit));
 		table.append("</tr>");
+
+		// Statistics between two markers on the same time curve
+		Curve *curve = marker_curve_map_[marker_pair.first];
+		if (curve != marker_curve_map_[marker_pair.second] ||
+				curve->curve_data()->type() != CurveType::TimeCurve)
+			continue;
+		auto signal =
+			static_cast<TimeCurveData *>(curve->curve_data())->signal();
+		data::AnalogSummary summary;
+		if (!signal->get_range_summary(
+				std::min(marker_pair.first->xValue(),
+					marker_pair.second->xValue()),
+				std::max(marker_pair.first->xValue(),
+					marker_pair.second->xValue()),
+				curve->curve_data()->is_relative_time(), summary))
+			continue;
+		auto append_row = [&table, &formatter](const QString &name,
+				double value, const QString &unit) {
+			table.append("<tr>");
+			table.append(QString("<td width=\"50\" align=\"left\">%1</td>").
+				arg(name));
+			table.append(QString("<td width=\"70\" align=\"right\">%1 %2</td>").
+				arg(formatter.format_general(value)).arg(unit));
+			table.append("</tr>");
+		};
+		append_row(tr("Mean:"), summary.mean, y_unit);
+		append_row(tr("RMS:"), summary.rms, y_unit);
+		append_row(tr("Min:"), summary.min, y_unit);
+		append_row(tr("Max:"), summary.max, y_unit);
+		append_row(tr("Integral:"), summary.integral, y_unit + "s");
+		append_row(tr("Slope:"), summary.slope, y_unit + "/s");
 	}
 
 	table.append("</table>");
@@ -967,24 +1431,68 @@ void Plot::update_markers_label()
 	markers_label_->setText(text);
 }
 
-void Plot::timerEvent(QTimerEvent *event)
+void Plot::set_profiler_overlay(bool profiler_overlay)
 {
-	if (event->timerId() == timer_id_) {
-		update_intervals();
-		update_curves();
+	if (profiler_overlay == this->profiler_overlay())
+		return;
+
+	if (!profiler_overlay) {
+		delete profiler_label_;
+		profiler_label_ = nullptr;
 		return;
 	}
 
-	QwtPlot::timerEvent(event);
+	// The label is a child of the plot and not of the canvas, so it isn't
+	// painted with the curves and doesn't distort the measurement.
+	profiler_label_ = new QLabel(this);
+	profiler_label_->setAttribute(Qt::WA_TransparentForMouseEvents);
+	profiler_label_->setAutoFillBackground(true);
+	profiler_label_->setMargin(4);
+	QPalette palette = profiler_label_->palette();
+	palette.setColor(QPalette::Window, QColor(0, 0, 0, 160));
+	palette.setColor(QPalette::WindowText, Qt::white);
+	profiler_label_->setPalette(palette);
+	profiler_label_->show();
+	update_profiler_overlay();
 }
 
-void Plot::resizeEvent(QResizeEvent *event)
+void Plot::add_profiled_frame(double frame_time, double lateness)
 {
-	for (const auto &curve : curve_map_) {
-		curve.second->plot_direct_painter()->reset();
-	}
+	profiler_.add_frame(frame_time, lateness);
+	if (profiler_label_ && (!profiler_label_timer_.isValid() ||
+			profiler_label_timer_.elapsed() >= 500))
+		update_profiler_overlay();
+}
 
-	QwtPlot::resizeEvent(event);
+void Plot::update_profiler_overlay()
+{
+	profiler_label_timer_.start();
+	const PlotProfile profile = profiler_.profile();
+	profiler_label_->setText(QString(
+		"Frame: %1 ms (max %2 ms)\n"
+		"Points/frame: %3\n"
+		"Replots: %4 (%5 ms), incremental: %6 (%7 ms)\n"
+		"Lateness: %8 ms (max %9 ms)").
+		arg(profile.mean_frame_time, 0, 'f', 2).
+		arg(profile.max_frame_time, 0, 'f', 2).
+		arg(profile.mean_points, 0, 'f', 0).
+		arg(profile.replots).
+		arg(profile.mean_replot_time, 0, 'f', 2).
+		arg(profile.incremental_paints).
+		arg(profile.mean_incremental_paint_time, 0, 'f', 2).
+		arg(profile.mean_lateness, 0, 'f', 1).
+		arg(profile.max_lateness, 0, 'f', 1));
+	profiler_label_->adjustSize();
+	profiler_label_->move(canvas()->geometry().topLeft() + QPoint(12, 12));
+	profiler_label_->raise();
+}
+
+size_t Plot::take_drawn_points() const
+{
+	size_t points = 0;
+	for (const auto &curve : curve_map_)
+		points += curve.second->take_drawn_points();
+	return points;
 }
 
 void Plot::showEvent(QShowEvent *event)
@@ -1005,6 +1513,10 @@ void Plot::save_settings(QSettings &settings, bool save_curves,
 	settings.setValue("update_mode", (int)update_mode());
 	settings.setValue("time_span", time_span_);
 	settings.setValue("add_time", add_time_);
+	settings.setValue("opengl_canvas", opengl_canvas_);
+	settings.setValue("time_axis_synced", time_axis_synced());
+	settings.setValue("scroll_mode", scroll_mode_);
+	settings.setValue("profiler_overlay", profiler_overlay());
 
 	if (!save_curves)
 		return;
@@ -1023,6 +1535,15 @@ void Plot::restore_settings(QSettings &settings, bool restore_curves,
 		time_span_ = settings.value("time_span").toDouble();
 	if (settings.contains("add_time"))
 		add_time_ = settings.value("add_time").toDouble();
+	if (settings.contains("opengl_canvas") && has_opengl_canvas())
+		set_opengl_canvas(settings.value("opengl_canvas").toBool());
+	if (settings.contains("time_axis_synced"))
+		set_time_axis_synced(settings.value("time_axis_synced").toBool());
+	if (settings.contains("scroll_mode"))
+		scroll_mode_ = settings.value("scroll_mode").toBool();
+	if (settings.contains("profiler_overlay"))
+		set_profiler_overlay(settings.value("profiler_overlay").toBool());
+	update_required_history();
 
 	if (!restore_curves)
 		return;
@@ -1037,6 +1558,18 @@ void Plot::restore_settings(QSettings &settings, bool restore_curves,
 	}
 }
 
+void Plot::update_required_history()
+{
+	// In the rolling and the oscilloscope mode only the samples of the time
+	// span are shown.
+	double history = std::numeric_limits<double>::infinity();
+	if (update_mode_ == PlotUpdateMode::Rolling ||
+			update_mode_ == PlotUpdateMode::Oscilloscope)
+		history = time_span_;
+	for (const auto &curve : curve_map_)
+		curve.second->curve_data()->set_required_history(history);
+}
+
 Curve *Plot::get_curve_from_plot_curve(const QwtPlotCurve *plot_curve) const
 {
 	for (const auto &curve : curve_map_) {
@@ -26,6 +26,7 @@
 #include <string>
 #include <vector>
 
+#include <QElapsedTimer>
 #include <QSettings>
 #include <QString>
 #include <QVariant>
@@ -33,7 +34,6 @@
 #include <qwt_interval.h>
 #include <qwt_plot.h>
 #include <qwt_plot_curve.h>
-#include <qwt_plot_directpainter.h>
 #include <qwt_plot_marker.h>
 #include <qwt_plot_textlabel.h>
 #include <qwt_plot_panner.h>
@@ -43,12 +43,18 @@
 #include <qwt_system_clock.h>
 #include <qwt_text.h>
 
+#include "src/ui/widgets/plot/backgroundlayer.hpp"
+#include "src/ui/widgets/plot/curve.hpp"
+#include "src/ui/widgets/plot/plotprofiler.hpp"
+
 using std::map;
 using std::pair;
 using std::shared_ptr;
 using std::string;
 using std::vector;
 
+class QLabel;
+
 namespace sv {
 
 class Session;
@@ -64,6 +70,8 @@ namespace plot {
 class BaseCurveData;
 class Curve;
 class PlotMagnifier;
+class SegmentPainter;
+class TimeAxisController;
 
 enum class AxisBoundary {
 	LowerBoundary,
@@ -109,16 +117,85 @@ public:
 	bool is_axis_locked(int axis_id, AxisBoundary axis_boundary) { return axis_lock_map_[axis_id][axis_boundary]; }
 	void set_axis_locked(int axis_id, AxisBoundary axis_boundary, bool locked);
 	void set_all_axis_locked(bool locked);
+	/**
+	 * Set the minimum interval between two redraws in milliseconds. 0 lets
+	 * the plot scheduler decide.
+	 */
 	void set_plot_interval(int plot_interval) { plot_interval_ = plot_interval; }
-	void set_update_mode(PlotUpdateMode update_mode) { update_mode_ = update_mode; }
+	int plot_interval() const { return plot_interval_; }
+	void set_update_mode(PlotUpdateMode update_mode);
 	PlotUpdateMode update_mode() const { return update_mode_; };
 	void set_time_span(double time_span);
 	double time_span() const { return time_span_; }
-	void set_add_time(double add_time) { add_time_ = add_time; }
+	void set_add_time(double add_time);
 	double add_time() const { return add_time_; }
+	/**
+	 * Share the time axis and the plot mode settings with the other synced
+	 * plots of the session, see TimeAxisController.
+	 */
+	void set_time_axis_synced(bool synced);
+	bool time_axis_synced() const { return time_axis_controller_ != nullptr; }
+	/**
+	 * Set the x interval of a synced time axis. With shift_ticks, the ticks
+	 * are shifted by the width of the interval in oscilloscope mode.
+	 */
+	void set_synced_x_interval(double min, double max, bool shift_ticks);
+	/**
+	 * Return the range of the timestamps of all time curves.
+	 *
+	 * @return false if there are no time curves with samples.
+	 */
+	bool time_curves_range(double &first, double &last) const;
 	map<QwtPlotMarker *, Curve *> marker_curve_map() const { return marker_curve_map_; }
 	void set_markers_label_alignment(int alignment);
 	int markers_label_alignment() const { return markers_label_alignment_; }
+	/** Return true if Qwt was built with the OpenGL canvas. */
+	static bool has_opengl_canvas();
+	/**
+	 * Render the plot on an OpenGL canvas instead of the raster canvas.
+	 *
+	 * @return false if the OpenGL canvas is not available.
+	 */
+	bool set_opengl_canvas(bool opengl_canvas);
+	bool opengl_canvas() const { return opengl_canvas_; }
+	/**
+	 * In rolling mode, move the already drawn canvas content by the shift of
+	 * the time axis and only draw the exposed strip, instead of replotting
+	 * the whole canvas. The shift is rounded to whole pixels.
+	 */
+	void set_scroll_mode(bool scroll_mode) { scroll_mode_ = scroll_mode; }
+	bool scroll_mode() const { return scroll_mode_; }
+	/** Show the statistics of the frame profiler on top of the canvas. */
+	void set_profiler_overlay(bool profiler_overlay);
+	bool profiler_overlay() const { return profiler_label_ != nullptr; }
+	PlotProfiler &profiler() { return profiler_; }
+	const PlotProfiler &profiler() const { return profiler_; }
+	/**
+	 * Add a render by the plot scheduler to the profiler. The lateness is
+	 * the time in milliseconds, the plot was rendered after it was due.
+	 */
+	void add_profiled_frame(double frame_time, double lateness);
+	/**
+	 * Return true if the plot is visible and has new samples, that are not
+	 * drawn yet.
+	 */
+	bool needs_render() const;
+	/**
+	 * Return the highest priority of the curves with new samples, see
+	 * Curve::set_priority().
+	 */
+	CurvePriority render_priority() const;
+	/**
+	 * Draw the new samples and update the axis intervals. The new samples
+	 * of curves below min_priority are not painted yet, they are painted
+	 * by a later render or replot.
+	 */
+	void render(CurvePriority min_priority = CurvePriority::Low);
+	/**
+	 * Set the column step factor of the low priority curves, see
+	 * Curve::set_column_step_factor().
+	 */
+	void set_low_priority_column_step_factor(int factor);
 
 	void save_settings(QSettings &settings, bool save_curves,
 		shared_ptr<sv::devices::BaseDevice> origin_device) const;
@@ -137,33 +214,67 @@ public Q_SLOTS:
 	void on_marker_selected(const QPointF mouse_pos);
 	void on_marker_moved(const QPointF mouse_pos);
 	void on_legend_clicked(const QVariant &item_info, int index);
+	void on_curve_prepared();
 
 protected:
 	virtual void showEvent(QShowEvent *event) override;
-	virtual void resizeEvent(QResizeEvent *event) override;
-	virtual void timerEvent(QTimerEvent *event) override;
+	/**
+	 * Draw the cached background layer (see BackgroundLayer) and then the
+	 * plot items on top of it.
+	 */
+	virtual void drawItems(QPainter *painter, const QRectF &canvas_rect,
+		const QwtScaleMap maps[]) const override;
 
 private:
 	int init_x_axis(BaseCurveData *curve_data, int x_axis_id = -1);
 	int init_y_axis(BaseCurveData *curve_data, int y_axis_id = -1);
 	void init_axis(int axis_id, double min, double max, const QString &title,
 		bool auto_scale);
-	void update_curves();
+	/** Create the canvas and the panner, magnifier and pickers on it. */
+	void init_canvas();
+	void init_marker_pickers();
+	void update_curves(CurvePriority min_priority);
 	void update_intervals();
+	/**
+	 * Declare the history, that the curves need, for the automatic retention
+	 * of the session, see Session::set_auto_retention().
+	 */
+	void update_required_history();
+	/**
+	 * Scroll the canvas from the old to the current x interval, see
+	 * set_scroll_mode().
+	 *
+	 * @return false if the canvas can't be scrolled and must be replotted.
+	 */
+	bool scroll_canvas(const QwtInterval &old_x_interval,
+		const QwtInterval &old_y_left_interval,
+		const QwtInterval &old_y_right_interval);
+	/** Return true while the preparation of a curve is pending. */
+	bool is_preparing() const;
 	bool update_x_interval(Curve *curve);
+	/**
+	 * Set the x interval in oscilloscope mode by shifting the ticks, so the
+	 * grid doesn't jump.
+	 */
+	void shift_x_interval(double min, double max);
 	bool update_y_interval(const Curve *curve);
 	void update_markers_label();
+	void update_profiler_overlay();
+	/** Return the number of points drawn by all curves since the last call. */
+	size_t take_drawn_points() const;
 	Curve *get_curve_from_plot_curve(const QwtPlotCurve *plot_curve) const;
 
 	Session &session_;
 	map<string, Curve *> curve_map_;
 	map<int, map<AxisBoundary, bool>> axis_lock_map_; // map<axis_id, map<AxisBoundary, locked>>
 	int plot_interval_;
-	int timer_id_;
 	PlotUpdateMode update_mode_;
 	double time_span_;
 	double add_time_;
 
+	SegmentPainter *segment_painter_;
+	/** Changed while the canvas is painted. */
+	mutable BackgroundLayer background_layer_;
 	QwtPlotPanner *plot_panner_;
 	PlotMagnifier *plot_magnifier_;
 
@@ -174,6 +285,17 @@ private:
 	int markers_label_alignment_;
 	QwtPlotPicker *marker_select_picker_;
 	QwtPlotPicker *marker_move_picker_;
+	bool opengl_canvas_;
+	TimeAxisController *time_axis_controller_;
+	/** The synced time axis has changed since the last render. */
+	bool synced_x_changed_;
+	/** The x interval before the first change of the synced time axis. */
+	QwtInterval synced_old_x_interval_;
+	bool scroll_mode_;
+	PlotProfiler profiler_;
+	QLabel *profiler_label_;
+	/** Limits the updates of the profiler overlay. */
+	QElapsedTimer profiler_label_timer_;
 
 Q_SIGNALS:
 	void axis_lock_changed(int axis_id,
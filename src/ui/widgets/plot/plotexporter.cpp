@@ -0,0 +1,227 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <map>
+#include <utility>
+
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QMetaObject>
+#include <QPainter>
+#include <QPointF>
+#include <QRectF>
+#include <QSize>
+#include <QSizeF>
+#include <QString>
+#include <qwt_interval.h>
+#include <qwt_plot.h>
+#include <qwt_plot_renderer.h>
+#include <qwt_scale_engine.h>
+
+#include "plotexporter.hpp"
+#include "src/session.hpp"
+#include "src/workerpool.hpp"
+#include "src/ui/widgets/plot/basecurvedata.hpp"
+#include "src/ui/widgets/plot/curve.hpp"
+#include "src/ui/widgets/plot/plot.hpp"
+
+using std::map;
+using std::pair;
+
+namespace sv {
+namespace ui {
+namespace widgets {
+namespace plot {
+
+PlotExportJob::PlotExportJob(Plot *plot, const QString &file_name,
+		const QSizeF &size, int resolution) :
+	QObject(),
+	plot_(plot),
+	file_name_(file_name),
+	size_(size),
+	resolution_(resolution)
+{
+}
+
+void PlotExportJob::run()
+{
+	const QString format = QFileInfo(file_name_).suffix().toLower();
+	bool success;
+	if (format == "svg" || format == "pdf") {
+		// QwtPlotRenderer doesn't report errors for documents
+		QFile::remove(file_name_);
+		QwtPlotRenderer renderer;
+		renderer.renderDocument(plot_, file_name_, format, size_, resolution_);
+		success = QFileInfo::exists(file_name_);
+	}
+	else {
+		success = render_image();
+	}
+
+	Q_EMIT finished(success);
+}
+
+bool PlotExportJob::render_image() const
+{
+	const double mm_to_inch = 1. / 25.4;
+	const QSize image_size = (size_ * mm_to_inch * resolution_).toSize();
+	QImage image(image_size, QImage::Format_ARGB32);
+	if (image.isNull()) {
+		qWarning() << "PlotExportJob::render_image(): Could not allocate an "
+			"image with the size" << image_size;
+		return false;
+	}
+
+	const int dots_per_meter = qRound(resolution_ * mm_to_inch * 1000.);
+	image.setDotsPerMeterX(dots_per_meter);
+	image.setDotsPerMeterY(dots_per_meter);
+	image.fill(Qt::white);
+
+	QPainter painter(&image);
+	QwtPlotRenderer renderer;
+	renderer.render(plot_, &painter, QRectF(QPointF(0, 0), image_size));
+	painter.end();
+
+	return image.save(file_name_);
+}
+
+PlotExporter::PlotExporter(Session &session, const Plot *plot) :
+	QObject(),
+	plot_(new Plot(session)),
+	job_(nullptr)
+{
+	plot_->setTitle(plot->title());
+	plot_->resize(plot->size());
+
+	for (const auto &curve_pair : plot->curve_map()) {
+		const Curve *curve = curve_pair.second;
+		Curve *copy = new Curve(curve->curve_data()->clone(),
+			curve->x_axis_id(), curve->y_axis_id(),
+			curve->name(), curve->color());
+		copy->set_style(curve->style());
+		copy->set_symbol(curve->symbol());
+		// The export isn't coarsened, when the GUI thread is under load
+		copy->set_full_resolution(true);
+		copy->plot_curve()->setVisible(curve->plot_curve()->isVisible());
+		if (!plot_->add_curve(copy)) {
+			delete copy;
+			continue;
+		}
+		copy->set_density_mode(curve->density_mode());
+	}
+
+	// Take over the axes as they are. The live plot may have added axes,
+	// that the curves alone wouldn't have.
+	for (int axis_id = 0; axis_id < QwtPlot::axisCnt; ++axis_id) {
+		plot_->enableAxis(axis_id, plot->axisEnabled(axis_id));
+		if (!plot->axisEnabled(axis_id))
+			continue;
+		plot_->setAxisTitle(axis_id, plot->axisTitle(axis_id));
+		if (dynamic_cast<const QwtLogScaleEngine *>(
+				plot->axisScaleEngine(axis_id)))
+			plot_->setAxisScaleEngine(axis_id, new QwtLogScaleEngine());
+		const QwtInterval interval = plot->axisInterval(axis_id);
+		plot_->setAxisScale(axis_id, interval.minValue(), interval.maxValue());
+	}
+}
+
+PlotExporter::~PlotExporter()
+{
+	delete plot_;
+}
+
+void PlotExporter::set_full_range()
+{
+	map<int, pair<double, double>> axis_ranges;
+	auto add_range = [&axis_ranges](int axis_id, double min, double max) {
+		auto it = axis_ranges.find(axis_id);
+		if (it == axis_ranges.end()) {
+			axis_ranges.insert(std::make_pair(axis_id, std::make_pair(min, max)));
+			return;
+		}
+		it->second.first = std::min(it->second.first, min);
+		it->second.second = std::max(it->second.second, max);
+	};
+
+	for (const auto &curve_pair : plot_->curve_map()) {
+		Curve *curve = curve_pair.second;
+		if (curve->curve_data()->size() == 0)
+			continue;
+		curve->update_bounds();
+		// The bounding rect of a time curve has the max value at the top
+		const QRectF bounds = curve->bounds().normalized();
+		add_range(curve->x_axis_id(), bounds.left(), bounds.right());
+		add_range(curve->y_axis_id(), bounds.top(), bounds.bottom());
+	}
+
+	for (const auto &range : axis_ranges) {
+		// Don't collapse an axis to a single value
+		if (range.second.second <= range.second.first)
+			continue;
+		plot_->setAxisScale(range.first, range.second.first, range.second.second);
+	}
+}
+
+void PlotExporter::set_x_interval(double min, double max)
+{
+	if (plot_->axisEnabled(QwtPlot::xBottom))
+		plot_->setAxisScale(QwtPlot::xBottom, min, max);
+	if (plot_->axisEnabled(QwtPlot::xTop))
+		plot_->setAxisScale(QwtPlot::xTop, min, max);
+}
+
+void PlotExporter::start(const QString &file_name, const QSizeF &size,
+	int resolution)
+{
+	if (job_)
+		return;
+
+	// The scale divs must be calculated before the plot is rendered in the
+	// worker thread.
+	plot_->updateAxes();
+
+	file_name_ = file_name;
+	job_ = new PlotExportJob(plot_, file_name, size, resolution);
+	connect(job_, &PlotExportJob::finished,
+		this, &PlotExporter::on_job_finished);
+	if (Session::worker_pool) {
+		Session::worker_pool->move_to_worker(job_);
+		QMetaObject::invokeMethod(job_, "run", Qt::QueuedConnection);
+	}
+	else {
+		job_->run();
+	}
+}
+
+void PlotExporter::on_job_finished(bool success)
+{
+	job_->deleteLater();
+	job_ = nullptr;
+
+	Q_EMIT finished(success, file_name_);
+	this->deleteLater();
+}
+
+} // namespace plot
+} // namespace widgets
+} // namespace ui
+} // namespace sv
@@ -0,0 +1,117 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_WIDGETS_PLOT_PLOTEXPORTER_HPP
+#define UI_WIDGETS_PLOT_PLOTEXPORTER_HPP
+
+#include <QObject>
+#include <QSizeF>
+#include <QString>
+
+namespace sv {
+
+class Session;
+
+namespace ui {
+namespace widgets {
+namespace plot {
+
+class Plot;
+
+/**
+ * Renders a plot in a worker thread, see PlotExporter.
+ */
+class PlotExportJob : public QObject
+{
+	Q_OBJECT
+
+public:
+	PlotExportJob(Plot *plot, const QString &file_name,
+		const QSizeF &size, int resolution);
+
+public Q_SLOTS:
+	void run();
+
+private:
+	bool render_image() const;
+
+	Plot *plot_;
+	const QString file_name_;
+	const QSizeF size_;
+	const int resolution_;
+
+Q_SIGNALS:
+	void finished(bool success);
+
+};
+
+/**
+ * Exports a plot as SVG, PDF or image in any size and resolution.
+ *
+ * The exporter renders a hidden copy of the plot, with the same curves,
+ * styles and axes, so the live plot keeps updating while the (possibly
+ * huge) export is rendered in a worker thread. The curves are decimated
+ * to the output resolution by EnvelopeCurve, so a high resolution export
+ * also shows more details.
+ *
+ * The exporter deletes itself, when the export is finished.
+ */
+class PlotExporter : public QObject
+{
+	Q_OBJECT
+
+public:
+	PlotExporter(Session &session, const Plot *plot);
+	~PlotExporter();
+
+	/**
+	 * Scale the axes to the bounds of all samples instead of the intervals
+	 * of the live plot.
+	 */
+	void set_full_range();
+	/** Export the range [min, max] of the x axes. */
+	void set_x_interval(double min, double max);
+
+	/**
+	 * Start the export. The format is taken from the suffix of the file name.
+	 *
+	 * @param size The size of the document in millimeters.
+	 * @param resolution The resolution in dots per inch.
+	 */
+	void start(const QString &file_name, const QSizeF &size, int resolution);
+
+private Q_SLOTS:
+	void on_job_finished(bool success);
+
+private:
+	Plot *plot_;
+	PlotExportJob *job_;
+	QString file_name_;
+
+Q_SIGNALS:
+	void finished(bool success, const QString &file_name);
+
+};
+
+} // namespace plot
+} // namespace widgets
+} // namespace ui
+} // namespace sv
+
+#endif // UI_WIDGETS_PLOT_PLOTEXPORTER_HPP
@@ -0,0 +1,116 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "plotprofiler.hpp"
+
+using std::vector;
+
+namespace sv {
+namespace ui {
+namespace widgets {
+namespace plot {
+
+const size_t PlotProfiler::window_size_ = 120;
+
+PlotProfiler::PlotProfiler() :
+	frames_(window_size_)
+{
+	reset();
+}
+
+void PlotProfiler::add_frame(double frame_time, double lateness)
+{
+	pending_.frame_time = frame_time;
+	pending_.lateness = std::max(0., lateness);
+	frames_[next_frame_] = pending_;
+	next_frame_ = (next_frame_ + 1) % window_size_;
+	frame_count_ = std::min(frame_count_ + 1, window_size_);
+	++total_frames_;
+	pending_ = Frame{ 0., 0., 0, 0, 0 };
+}
+
+void PlotProfiler::add_replot(double time, size_t points)
+{
+	pending_.points += points;
+	++pending_.replots;
+	++total_replots_;
+	replot_time_ += time;
+}
+
+void PlotProfiler::add_incremental_paint(double time, size_t points)
+{
+	pending_.points += points;
+	++pending_.incremental_paints;
+	++total_incremental_paints_;
+	incremental_paint_time_ += time;
+}
+
+PlotProfile PlotProfiler::profile() const
+{
+	PlotProfile profile{ frame_count_, 0., 0., 0., 0, 0, 0., 0., 0., 0.,
+		total_frames_, total_replots_, total_incremental_paints_ };
+	for (size_t i = 0; i < frame_count_; ++i) {
+		const Frame &frame = frames_[i];
+		profile.mean_frame_time += frame.frame_time;
+		profile.max_frame_time = std::max(profile.max_frame_time, frame.frame_time);
+		profile.mean_points += (double)frame.points;
+		profile.replots += frame.replots;
+		profile.incremental_paints += frame.incremental_paints;
+		profile.mean_lateness += frame.lateness;
+		profile.max_lateness = std::max(profile.max_lateness, frame.lateness);
+	}
+	if (frame_count_ > 0) {
+		profile.mean_frame_time /= (double)frame_count_;
+		profile.mean_points /= (double)frame_count_;
+		profile.mean_lateness /= (double)frame_count_;
+	}
+	if (total_replots_ > 0)
+		profile.mean_replot_time = replot_time_ / (double)total_replots_;
+	if (total_incremental_paints_ > 0) {
+		profile.mean_incremental_paint_time =
+			incremental_paint_time_ / (double)total_incremental_paints_;
+	}
+	return profile;
+}
+
+void PlotProfiler::reset()
+{
+	next_frame_ = 0;
+	frame_count_ = 0;
+	pending_ = Frame{ 0., 0., 0, 0, 0 };
+	replot_time_ = 0.;
+	incremental_paint_time_ = 0.;
+	total_frames_ = 0;
+	total_replots_ = 0;
+	total_incremental_paints_ = 0;
+}
+
+size_t PlotProfiler::window_size()
+{
+	return window_size_;
+}
+
+} // namespace plot
+} // namespace widgets
+} // namespace ui
+} // namespace sv
@@ -0,0 +1,115 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_WIDGETS_PLOT_PLOTPROFILER_HPP
+#define UI_WIDGETS_PLOT_PLOTPROFILER_HPP
+
+#include <cstddef>
+#include <vector>
+
+using std::vector;
+
+namespace sv {
+namespace ui {
+namespace widgets {
+namespace plot {
+
+/**
+ * The aggregated statistics of a PlotProfiler. The frame values are taken
+ * over the last frames (see PlotProfiler::window_size()), the counts with
+ * the "total_" prefix since the last reset. All times are in milliseconds.
+ */
+struct PlotProfile
+{
+	size_t frames;
+	double mean_frame_time;
+	double max_frame_time;
+	double mean_points;
+	size_t replots;
+	size_t incremental_paints;
+	double mean_lateness;
+	double max_lateness;
+	double mean_replot_time;
+	double mean_incremental_paint_time;
+	size_t total_frames;
+	size_t total_replots;
+	size_t total_incremental_paints;
+};
+
+/**
+ * Collects the frame times of a plot, to find out if the plotting is the
+ * hotspot of the GUI thread.
+ *
+ * A frame is one render of the plot by the PlotScheduler. The replots and
+ * incremental paints (and their drawn points) are assigned to the next
+ * frame, so also the replots after an asynchronous curve preparation are
+ * counted. Recording is cheap (no allocations), so the profiler is always
+ * active.
+ */
+class PlotProfiler
+{
+public:
+	PlotProfiler();
+
+	/**
+	 * Add a frame with the time of the render and the time, the plot was
+	 * rendered after it was due.
+	 */
+	void add_frame(double frame_time, double lateness);
+	void add_replot(double time, size_t points);
+	void add_incremental_paint(double time, size_t points);
+
+	PlotProfile profile() const;
+	void reset();
+
+	/** Return the number of frames, that are aggregated in profile(). */
+	static size_t window_size();
+
+private:
+	struct Frame
+	{
+		double frame_time;
+		double lateness;
+		size_t points;
+		size_t replots;
+		size_t incremental_paints;
+	};
+
+	static const size_t window_size_;
+
+	/** Ring buffer of the last frames. */
+	vector<Frame> frames_;
+	size_t next_frame_;
+	size_t frame_count_;
+	/** The paints since the last frame. */
+	Frame pending_;
+	double replot_time_;
+	double incremental_paint_time_;
+	size_t total_frames_;
+	size_t total_replots_;
+	size_t total_incremental_paints_;
+
+};
+
+} // namespace plot
+} // namespace widgets
+} // namespace ui
+} // namespace sv
+
+#endif // UI_WIDGETS_PLOT_PLOTPROFILER_HPP
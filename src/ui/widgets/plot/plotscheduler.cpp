@@ -0,0 +1,246 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <QElapsedTimer>
+#include <QGuiApplication>
+#include <QScreen>
+#include <QTimerEvent>
+
+#include "plotscheduler.hpp"
+#include "src/tracer.hpp"
+#include "src/ui/widgets/plot/curve.hpp"
+#include "src/ui/widgets/plot/plot.hpp"
+#include "src/ui/widgets/plot/timeaxiscontroller.hpp"
+
+using std::vector;
+
+namespace sv {
+namespace ui {
+namespace widgets {
+namespace plot {
+
+const int PlotScheduler::default_tick_interval_ = 16;
+const double PlotScheduler::cost_weight_ = 0.2;
+const double PlotScheduler::tight_load_ = 0.8;
+const int PlotScheduler::low_priority_factor_ = 4;
+const int PlotScheduler::low_priority_column_step_ = 2;
+
+PlotScheduler::PlotScheduler(QObject *parent) :
+	QObject(parent),
+	budget_(0.5),
+	interval_factor_(1),
+	load_(0.),
+	tight_(false),
+	tick_interval_(default_tick_interval_),
+	timer_id_(-1),
+	last_tick_time_(-1.)
+{
+	// Tick with the refresh rate of the screen, more redraws would never be
+	// visible.
+	QScreen *screen = QGuiApplication::primaryScreen();
+	if (screen && screen->refreshRate() > 1.)
+		tick_interval_ = std::max(1, (int)std::lround(1000. / screen->refreshRate()));
+
+	clock_.start();
+}
+
+void PlotScheduler::add_plot(Plot *plot)
+{
+	for (const auto &state : plots_) {
+		if (state.plot == plot)
+			return;
+	}
+
+	plots_.push_back(PlotState{ plot, clock_.elapsed(), 0., clock_.elapsed() });
+	if (timer_id_ < 0)
+		start_timer();
+}
+
+void PlotScheduler::remove_plot(Plot *plot)
+{
+	plots_.erase(std::remove_if(plots_.begin(), plots_.end(),
+		[plot](const PlotState &state) { return state.plot == plot; }),
+		plots_.end());
+	if (plots_.empty())
+		stop_timer();
+}
+
+size_t PlotScheduler::plot_count() const
+{
+	return plots_.size();
+}
+
+vector<Plot *> PlotScheduler::plots() const
+{
+	vector<Plot *> plots;
+	for (const auto &state : plots_)
+		plots.push_back(state.plot);
+	return plots;
+}
+
+void PlotScheduler::set_budget(double budget)
+{
+	if (!(budget > 0.))
+		budget = 0.01;
+	budget_ = std::min(budget, 1.);
+}
+
+double PlotScheduler::budget() const
+{
+	return budget_;
+}
+
+void PlotScheduler::set_interval_factor(int factor)
+{
+	interval_factor_ = std::max(1, factor);
+}
+
+int PlotScheduler::interval_factor() const
+{
+	return interval_factor_;
+}
+
+double PlotScheduler::load() const
+{
+	return load_;
+}
+
+bool PlotScheduler::is_tight() const
+{
+	return tight_;
+}
+
+int PlotScheduler::tick_interval() const
+{
+	return tick_interval_;
+}
+
+TimeAxisController *PlotScheduler::time_axis_controller()
+{
+	return &time_axis_controller_;
+}
+
+void PlotScheduler::start_timer()
+{
+	timer_id_ = startTimer(tick_interval_, Qt::PreciseTimer);
+}
+
+void PlotScheduler::stop_timer()
+{
+	if (timer_id_ < 0)
+		return;
+	killTimer(timer_id_);
+	timer_id_ = -1;
+	last_tick_time_ = -1.;
+	load_ = 0.;
+	tight_ = false;
+}
+
+void PlotScheduler::timerEvent(QTimerEvent *event)
+{
+	SV_TRACE_SCOPE("PlotScheduler::tick");
+
+	if (event->timerId() != timer_id_) {
+		QObject::timerEvent(event);
+		return;
+	}
+
+	const qint64 now = clock_.elapsed();
+	const double tick_time = (double)clock_.nsecsElapsed() / 1e6;
+	const double tick_lateness = last_tick_time_ >= 0. ?
+		tick_time - last_tick_time_ - (double)tick_interval_ : 0.;
+	last_tick_time_ = tick_time;
+
+	// Calculate the shared time window once for all synced plots
+	time_axis_controller_.update();
+
+	// Collect the plots, that are due, the plots with the highest priority
+	// and then the longest waiting plots first. While the budget is tight,
+	// plots with only new low priority samples wait for their low interval.
+	struct DuePlot
+	{
+		PlotState *state;
+		CurvePriority priority;
+	};
+	vector<DuePlot> due_plots;
+	for (auto &state : plots_) {
+		if (state.due_time > now || !state.plot->needs_render())
+			continue;
+		const CurvePriority priority = state.plot->render_priority();
+		if (tight_ && priority == CurvePriority::Low &&
+				state.low_due_time > now)
+			continue;
+		due_plots.push_back(DuePlot{ &state, priority });
+	}
+	std::stable_sort(due_plots.begin(), due_plots.end(),
+		[](const DuePlot &a, const DuePlot &b) {
+			if (a.priority != b.priority)
+				return a.priority > b.priority;
+			return a.state->due_time < b.state->due_time;
+		});
+
+	const double tick_budget = budget_ * tick_interval_;
+	double tick_cost = 0.;
+	QElapsedTimer frame_timer;
+	for (const auto &due_plot : due_plots) {
+		PlotState &state = *due_plot.state;
+		Plot *plot = state.plot;
+		const bool high = due_plot.priority == CurvePriority::High;
+		if (tick_cost >= tick_budget && !high)
+			break;
+
+		// Defer the low priority samples, until their interval has passed
+		const bool paint_low = !tight_ || state.low_due_time <= now;
+		plot->set_low_priority_column_step_factor(
+			tight_ ? low_priority_column_step_ : 1);
+
+		frame_timer.start();
+		plot->render(paint_low ? CurvePriority::Low : CurvePriority::Normal);
+		const double cost = (double)frame_timer.nsecsElapsed() / 1e6;
+		plot->add_profiled_frame(cost, tick_lateness + tick_cost);
+		tick_cost += cost;
+
+		state.cost = state.cost > 0. ?
+			(1. - cost_weight_) * state.cost + cost_weight_ * cost : cost;
+		const double base_interval = std::max(
+			(double)(tick_interval_ * interval_factor_),
+			(double)plot->plot_interval());
+		const double interval = high ? base_interval :
+			std::max(state.cost * interval_factor_ / budget_, base_interval);
+		state.due_time = now + (qint64)interval;
+		if (paint_low) {
+			state.low_due_time = now + (qint64)(tight_ ?
+				interval * low_priority_factor_ : interval);
+		}
+	}
+
+	// The load decides, if the budget is tight for the next ticks
+	load_ = (1. - cost_weight_) * load_ +
+		cost_weight_ * tick_cost / tick_budget;
+	tight_ = load_ >= tight_load_;
+}
+
+} // namespace plot
+} // namespace widgets
+} // namespace ui
+} // namespace sv
@@ -0,0 +1,156 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_WIDGETS_PLOT_PLOTSCHEDULER_HPP
+#define UI_WIDGETS_PLOT_PLOTSCHEDULER_HPP
+
+#include <vector>
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimerEvent>
+
+#include "src/ui/widgets/plot/timeaxiscontroller.hpp"
+
+using std::vector;
+
+namespace sv {
+namespace ui {
+namespace widgets {
+namespace plot {
+
+class Plot;
+
+/**
+ * Redraws all plots of a session from one timer in the GUI thread, instead
+ * of a timer per plot.
+ *
+ * The scheduler ticks with the refresh rate of the screen. On each tick, the
+ * plots that are due, visible and have new samples are redrawn, the plot
+ * that has waited the longest first. Hidden plots (e.g. in a tabbed dock or
+ * a minimized window) and plots without new samples cost nothing, the
+ * scheduler stops ticking when no plot is registered.
+ *
+ * The interval of a plot adapts to its frame cost: A plot is redrawn at most
+ * every cost / budget milliseconds, so slow plots are redrawn less often.
+ * The redraws of one tick are limited to budget * tick interval, the
+ * remaining plots are redrawn on the next tick. So at most the budget
+ * fraction of the GUI thread is spent on plotting (plus the cost of one
+ * plot per tick, so that no plot is starved).
+ *
+ * Each plot is rendered with the priority of its curves, see
+ * Curve::set_priority(). Plots with high priority curves are rendered
+ * first, are not stretched by their cost and are not limited by the tick
+ * budget. When the budget is tight (the average load of the ticks is above
+ * tight_load_), the new samples of low priority curves are only painted
+ * every low_priority_factor_ intervals and their envelopes are decimated
+ * coarser.
+ *
+ * The shared time axis of synced plots is updated once at the start of
+ * each tick, see TimeAxisController.
+ *
+ * The renders are added to the profilers of the plots (see PlotProfiler),
+ * the lateness of a render is the delay of the timer tick plus the time
+ * spent on the plots, that were rendered before in the same tick.
+ */
+class PlotScheduler : public QObject
+{
+	Q_OBJECT
+
+public:
+	explicit PlotScheduler(QObject *parent = nullptr);
+
+	void add_plot(Plot *plot);
+	void remove_plot(Plot *plot);
+	size_t plot_count() const;
+	/** Return the registered plots, e.g. for the plot profiler view. */
+	vector<Plot *> plots() const;
+
+	/**
+	 * Set the fraction of the GUI thread time, that may be spent on
+	 * plotting. The budget is clamped to (0, 1].
+	 */
+	void set_budget(double budget);
+	double budget() const;
+	/**
+	 * Stretch the redraw intervals of all plots by this factor, e.g. while
+	 * the GUI thread falls behind, see LoadGovernor.
+	 */
+	void set_interval_factor(int factor);
+	int interval_factor() const;
+	/**
+	 * Return the average fraction of the tick budget, that is spent on
+	 * plotting.
+	 */
+	double load() const;
+	/** Return true if the budget is tight, see load(). */
+	bool is_tight() const;
+	/** Return the tick interval in milliseconds. */
+	int tick_interval() const;
+	TimeAxisController *time_axis_controller();
+
+protected:
+	void timerEvent(QTimerEvent *event) override;
+
+private:
+	struct PlotState
+	{
+		Plot *plot;
+		/** The time of the next redraw in milliseconds. */
+		qint64 due_time;
+		/** The average cost of a redraw in milliseconds. */
+		double cost;
+		/** The time of the next paint of the low priority curves. */
+		qint64 low_due_time;
+	};
+
+	void start_timer();
+	void stop_timer();
+
+	/** The interval, when the refresh rate of the screen is unknown. */
+	static const int default_tick_interval_;
+	/** The weight of a new frame cost in the average. */
+	static const double cost_weight_;
+	/** The load, above which the budget is tight. */
+	static const double tight_load_;
+	/** Stretch the interval of low priority curves, while tight. */
+	static const int low_priority_factor_;
+	/** The column step factor of low priority curves, while tight. */
+	static const int low_priority_column_step_;
+
+	vector<PlotState> plots_;
+	TimeAxisController time_axis_controller_;
+	double budget_;
+	int interval_factor_;
+	double load_;
+	bool tight_;
+	int tick_interval_;
+	int timer_id_;
+	QElapsedTimer clock_;
+	/** The time of the last tick in milliseconds, < 0 if not ticking. */
+	double last_tick_time_;
+
+};
+
+} // namespace plot
+} // namespace widgets
+} // namespace ui
+} // namespace sv
+
+#endif // UI_WIDGETS_PLOT_PLOTSCHEDULER_HPP
@@ -0,0 +1,156 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+
+#include <QPointF>
+#include <QPolygonF>
+#include <qwt_scale_map.h>
+#include <qwt_transform.h>
+
+#include "scaletransform.hpp"
+
+namespace sv {
+namespace ui {
+namespace widgets {
+namespace plot {
+
+namespace {
+
+inline double log_scale(double value)
+{
+	// Bound the value like QwtLogTransform::bounded(), but keep NaN as gap
+	if (value < QwtLogTransform::LogMin)
+		value = QwtLogTransform::LogMin;
+	else if (value > QwtLogTransform::LogMax)
+		value = QwtLogTransform::LogMax;
+	return std::log(value);
+}
+
+inline double &coordinate(QPointF &point, bool is_x)
+{
+	return is_x ? point.rx() : point.ry();
+}
+
+void scale_coordinates(QPolygonF &points, bool is_x,
+	const ScaleTransform &transform)
+{
+	QPointF *data = points.data();
+	const int size = points.size();
+	switch (transform.type()) {
+	case ScaleTransform::Type::Log:
+		for (int i = 0; i < size; ++i) {
+			double &value = coordinate(data[i], is_x);
+			value = log_scale(value);
+		}
+		break;
+	case ScaleTransform::Type::Custom:
+		for (int i = 0; i < size; ++i) {
+			double &value = coordinate(data[i], is_x);
+			value = transform.scale(value);
+		}
+		break;
+	case ScaleTransform::Type::Linear:
+	default:
+		break;
+	}
+}
+
+}
+
+ScaleTransform::ScaleTransform(const QwtScaleMap &map) :
+	type_(Type::Linear),
+	transformation_(map.transformation()),
+	p1_(map.p1()),
+	ts1_(0.),
+	factor_(1.)
+{
+	if (transformation_ != nullptr) {
+		if (dynamic_cast<const QwtLogTransform *>(transformation_))
+			type_ = Type::Log;
+		else if (!dynamic_cast<const QwtNullTransform *>(transformation_))
+			type_ = Type::Custom;
+	}
+
+	// Same as the conversion factor of QwtScaleMap
+	ts1_ = scale(map.s1());
+	const double ts2 = scale(map.s2());
+	factor_ = ts2 != ts1_ ? (map.p2() - map.p1()) / (ts2 - ts1_) : 1.;
+}
+
+ScaleTransform::Type ScaleTransform::type() const
+{
+	return type_;
+}
+
+bool ScaleTransform::is_cacheable() const
+{
+	return type_ != Type::Custom;
+}
+
+double ScaleTransform::scale(double value) const
+{
+	switch (type_) {
+	case Type::Log:
+		return log_scale(value);
+	case Type::Custom:
+		return transformation_->transform(value);
+	case Type::Linear:
+	default:
+		return value;
+	}
+}
+
+void ScaleTransform::scale_points(QPolygonF &points,
+	const ScaleTransform &x_transform, const ScaleTransform &y_transform)
+{
+	scale_coordinates(points, true, x_transform);
+	scale_coordinates(points, false, y_transform);
+}
+
+void ScaleTransform::map_points(QPolygonF &points,
+	const ScaleTransform &x_transform, const ScaleTransform &y_transform)
+{
+	// The start of the scale is subtracted first, so big absolute
+	// timestamps don't lose precision when zoomed in.
+	const double x_p1 = x_transform.p1_;
+	const double x_ts1 = x_transform.ts1_;
+	const double x_factor = x_transform.factor_;
+	const double y_p1 = y_transform.p1_;
+	const double y_ts1 = y_transform.ts1_;
+	const double y_factor = y_transform.factor_;
+	QPointF *data = points.data();
+	const int size = points.size();
+	for (int i = 0; i < size; ++i) {
+		data[i].rx() = x_p1 + (data[i].x() - x_ts1) * x_factor;
+		data[i].ry() = y_p1 + (data[i].y() - y_ts1) * y_factor;
+	}
+}
+
+void ScaleTransform::transform_points(QPolygonF &points,
+	const ScaleTransform &x_transform, const ScaleTransform &y_transform)
+{
+	scale_points(points, x_transform, y_transform);
+	map_points(points, x_transform, y_transform);
+}
+
+} // namespace plot
+} // namespace widgets
+} // namespace ui
+} // namespace sv
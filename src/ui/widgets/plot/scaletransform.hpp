@@ -0,0 +1,92 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_WIDGETS_PLOT_SCALETRANSFORM_HPP
+#define UI_WIDGETS_PLOT_SCALETRANSFORM_HPP
+
+#include <QPolygonF>
+#include <qwt_scale_map.h>
+
+class QwtTransform;
+
+namespace sv {
+namespace ui {
+namespace widgets {
+namespace plot {
+
+/**
+ * The transformation of a QwtScaleMap, split into two parts: The scale
+ * part (e.g. the log of a logarithmic axis) only depends on the type of the
+ * scale, so the scaled points can be cached, see EnvelopeTileCache. The
+ * linear part maps the scaled values to canvas coordinates and changes with
+ * every pan or zoom.
+ *
+ * Both parts are applied to a whole polyline at once in tight loops, instead
+ * of calling the virtual QwtTransform for every point like
+ * QwtScaleMap::transform() does.
+ */
+class ScaleTransform
+{
+public:
+	enum class Type {
+		Linear,
+		Log,
+		/** Any other QwtTransform, it is called for every point. */
+		Custom,
+	};
+
+	/**
+	 * The scale map (and its transformation) must exist as long as the
+	 * ScaleTransform is used.
+	 */
+	explicit ScaleTransform(const QwtScaleMap &map);
+
+	Type type() const;
+	/** Return true if the scale part can be cached with the points. */
+	bool is_cacheable() const;
+
+	/** Apply the scale part to a single value. */
+	double scale(double value) const;
+
+	/** Apply the scale parts of x and y to the points. */
+	static void scale_points(QPolygonF &points,
+		const ScaleTransform &x_transform, const ScaleTransform &y_transform);
+	/** Map the scaled points to canvas coordinates. */
+	static void map_points(QPolygonF &points,
+		const ScaleTransform &x_transform, const ScaleTransform &y_transform);
+	/** Scale and map the points, like QwtScaleMap::transform(). */
+	static void transform_points(QPolygonF &points,
+		const ScaleTransform &x_transform, const ScaleTransform &y_transform);
+
+private:
+	Type type_;
+	const QwtTransform *transformation_;
+	/** canvas = p1_ + (scale(value) - ts1_) * factor_ */
+	double p1_;
+	double ts1_;
+	double factor_;
+
+};
+
+} // namespace plot
+} // namespace widgets
+} // namespace ui
+} // namespace sv
+
+#endif // UI_WIDGETS_PLOT_SCALETRANSFORM_HPP
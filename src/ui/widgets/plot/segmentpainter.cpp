@@ -0,0 +1,99 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <vector>
+
+#include <QEvent>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QRegion>
+#include <QWidget>
+#include <qwt_plot.h>
+#include <qwt_plot_seriesitem.h>
+#include <qwt_scale_map.h>
+
+#include "segmentpainter.hpp"
+
+namespace sv {
+namespace ui {
+namespace widgets {
+namespace plot {
+
+SegmentPainter::SegmentPainter(QwtPlot *plot) :
+	QObject(plot),
+	plot_(plot)
+{
+}
+
+void SegmentPainter::add_segment(QwtPlotSeriesItem *series_item,
+	int from, int to)
+{
+	segments_.push_back(Segment{ series_item, from, to });
+}
+
+bool SegmentPainter::has_segments() const
+{
+	return !segments_.empty();
+}
+
+void SegmentPainter::paint(const QRegion &clip_region)
+{
+	if (segments_.empty())
+		return;
+
+	QWidget *canvas = plot_->canvas();
+	QRegion region = canvas->contentsRect();
+	if (!clip_region.isEmpty())
+		region &= clip_region;
+
+	// The segments are painted in eventFilter() during the repaint
+	canvas->installEventFilter(this);
+	canvas->repaint(region);
+	canvas->removeEventFilter(this);
+	segments_.clear();
+}
+
+bool SegmentPainter::eventFilter(QObject *object, QEvent *event)
+{
+	if (event->type() != QEvent::Paint || object != plot_->canvas() ||
+			segments_.empty())
+		return QObject::eventFilter(object, event);
+
+	QWidget *canvas = plot_->canvas();
+	QPainter painter(canvas);
+	painter.setClipRegion(static_cast<QPaintEvent *>(event)->region());
+	const QRectF canvas_rect = canvas->contentsRect();
+	for (const auto &segment : segments_) {
+		const QwtScaleMap x_map =
+			plot_->canvasMap(segment.series_item->xAxis());
+		const QwtScaleMap y_map =
+			plot_->canvasMap(segment.series_item->yAxis());
+		painter.setRenderHint(QPainter::Antialiasing,
+			segment.series_item->testRenderHint(
+				QwtPlotItem::RenderAntialiased));
+		segment.series_item->drawSeries(&painter, x_map, y_map, canvas_rect,
+			segment.from, segment.to);
+	}
+	return true;
+}
+
+} // namespace plot
+} // namespace widgets
+} // namespace ui
+} // namespace sv
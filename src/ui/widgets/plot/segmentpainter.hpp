@@ -0,0 +1,84 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_WIDGETS_PLOT_SEGMENTPAINTER_HPP
+#define UI_WIDGETS_PLOT_SEGMENTPAINTER_HPP
+
+#include <vector>
+
+#include <QEvent>
+#include <QObject>
+#include <QRegion>
+#include <qwt_plot.h>
+#include <qwt_plot_seriesitem.h>
+
+using std::vector;
+
+namespace sv {
+namespace ui {
+namespace widgets {
+namespace plot {
+
+/**
+ * Paints the new samples of several curves on top of the canvas in one
+ * paint pass, like QwtPlotDirectPainter does for a single curve.
+ *
+ * With Qt5, QwtPlotDirectPainter can't paint outside of a paint event, so
+ * every drawSeries() call repaints the canvas synchronously. With many
+ * curves, the segments are collected with add_segment() and painted by a
+ * single repaint of the united clip region with paint().
+ */
+class SegmentPainter : public QObject
+{
+	Q_OBJECT
+
+public:
+	explicit SegmentPainter(QwtPlot *plot);
+
+	/** Queue the samples [from, to] of the series item for paint(). */
+	void add_segment(QwtPlotSeriesItem *series_item, int from, int to);
+	bool has_segments() const;
+
+	/**
+	 * Paint all queued segments, clipped to the region. An empty region
+	 * paints the whole canvas.
+	 */
+	void paint(const QRegion &clip_region);
+
+	bool eventFilter(QObject *object, QEvent *event) override;
+
+private:
+	struct Segment
+	{
+		QwtPlotSeriesItem *series_item;
+		int from;
+		int to;
+	};
+
+	QwtPlot *plot_;
+	vector<Segment> segments_;
+
+};
+
+} // namespace plot
+} // namespace widgets
+} // namespace ui
+} // namespace sv
+
+#endif // UI_WIDGETS_PLOT_SEGMENTPAINTER_HPP
@@ -0,0 +1,209 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include <qwt_interval.h>
+#include <qwt_plot.h>
+
+#include "timeaxiscontroller.hpp"
+#include "src/ui/widgets/plot/plot.hpp"
+
+using std::vector;
+
+namespace sv {
+namespace ui {
+namespace widgets {
+namespace plot {
+
+TimeAxisController::TimeAxisController() :
+	update_mode_(PlotUpdateMode::Rolling),
+	time_span_(120.),
+	add_time_(30.),
+	has_interval_(false),
+	min_(0.),
+	max_(0.)
+{
+}
+
+void TimeAxisController::add_plot(Plot *plot)
+{
+	if (std::find(plots_.begin(), plots_.end(), plot) != plots_.end())
+		return;
+
+	if (plots_.empty()) {
+		update_mode_ = plot->update_mode();
+		time_span_ = plot->time_span();
+		add_time_ = plot->add_time();
+		const QwtInterval interval = plot->axisInterval(QwtPlot::xBottom);
+		min_ = interval.minValue();
+		max_ = interval.maxValue();
+		has_interval_ = true;
+	}
+	else {
+		plot->set_update_mode(update_mode_);
+		plot->set_add_time(add_time_);
+		plot->set_time_span(time_span_);
+		if (has_interval_)
+			plot->set_synced_x_interval(min_, max_, false);
+	}
+	plots_.push_back(plot);
+}
+
+void TimeAxisController::remove_plot(Plot *plot)
+{
+	plots_.erase(std::remove(plots_.begin(), plots_.end(), plot),
+		plots_.end());
+}
+
+size_t TimeAxisController::plot_count() const
+{
+	return plots_.size();
+}
+
+void TimeAxisController::set_update_mode(PlotUpdateMode update_mode)
+{
+	if (update_mode == update_mode_)
+		return;
+	update_mode_ = update_mode;
+	for (const auto &plot : plots_)
+		plot->set_update_mode(update_mode);
+}
+
+PlotUpdateMode TimeAxisController::update_mode() const
+{
+	return update_mode_;
+}
+
+void TimeAxisController::set_time_span(double time_span)
+{
+	if (time_span == time_span_)
+		return;
+	time_span_ = time_span;
+	for (const auto &plot : plots_)
+		plot->set_time_span(time_span);
+	// Start the new window at the newest sample of all plots
+	has_interval_ = false;
+}
+
+double TimeAxisController::time_span() const
+{
+	return time_span_;
+}
+
+void TimeAxisController::set_add_time(double add_time)
+{
+	if (add_time == add_time_)
+		return;
+	add_time_ = add_time;
+	for (const auto &plot : plots_)
+		plot->set_add_time(add_time);
+}
+
+double TimeAxisController::add_time() const
+{
+	return add_time_;
+}
+
+void TimeAxisController::update()
+{
+	if (plots_.empty())
+		return;
+
+	bool has_samples = false;
+	double first_timestamp = 0.;
+	double last_timestamp = 0.;
+	for (const auto &plot : plots_) {
+		double first;
+		double last;
+		if (!plot->time_curves_range(first, last))
+			continue;
+		if (!has_samples) {
+			first_timestamp = first;
+			last_timestamp = last;
+			has_samples = true;
+			continue;
+		}
+		first_timestamp = std::min(first_timestamp, first);
+		last_timestamp = std::max(last_timestamp, last);
+	}
+	if (!has_samples)
+		return;
+
+	if (!has_interval_) {
+		max_ = last_timestamp;
+		min_ = max_ - time_span_;
+		has_interval_ = true;
+		for (const auto &plot : plots_)
+			plot->set_synced_x_interval(min_, max_, false);
+		return;
+	}
+
+	if (!next_interval(update_mode_, time_span_, add_time_,
+			first_timestamp, last_timestamp, min_, max_))
+		return;
+	for (const auto &plot : plots_)
+		plot->set_synced_x_interval(min_, max_, true);
+}
+
+bool TimeAxisController::next_interval(PlotUpdateMode update_mode,
+	double time_span, double add_time,
+	double first_timestamp, double last_timestamp, double &min, double &max)
+{
+	switch (update_mode) {
+	case PlotUpdateMode::Additive:
+	{
+		bool interval_changed = false;
+		if (first_timestamp < min) {
+			min = 0;
+			interval_changed = true;
+		}
+		if (last_timestamp > max) {
+			max = last_timestamp + add_time;
+			interval_changed = true;
+		}
+		return interval_changed;
+	}
+	case PlotUpdateMode::Rolling:
+		if (last_timestamp <= max)
+			return false;
+		if (last_timestamp > max + time_span)
+			min = last_timestamp;
+		else
+			min += add_time;
+		max = min + time_span;
+		return true;
+	case PlotUpdateMode::Oscilloscope:
+		if (last_timestamp <= max)
+			return false;
+		if (last_timestamp > max + time_span)
+			min = last_timestamp;
+		else
+			min += time_span;
+		max = min + time_span;
+		return true;
+	}
+	return false;
+}
+
+} // namespace plot
+} // namespace widgets
+} // namespace ui
+} // namespace sv
@@ -0,0 +1,101 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_WIDGETS_PLOT_TIMEAXISCONTROLLER_HPP
+#define UI_WIDGETS_PLOT_TIMEAXISCONTROLLER_HPP
+
+#include <cstddef>
+#include <vector>
+
+using std::vector;
+
+namespace sv {
+namespace ui {
+namespace widgets {
+namespace plot {
+
+class Plot;
+enum class PlotUpdateMode;
+
+/**
+ * A time axis, that is shared by several plots.
+ *
+ * The controller calculates the x interval of all subscribed plots once per
+ * tick of the PlotScheduler, from the newest samples of all plots, and
+ * pushes it directly to the plots. So the plots show the same time window
+ * in the same frame, without calculating it on their own and without a
+ * signal connection between every pair of plots.
+ *
+ * The plot mode, the time span and the add time are shared, too: Changing
+ * them in one subscribed plot changes them in all subscribed plots.
+ */
+class TimeAxisController
+{
+public:
+	TimeAxisController();
+
+	/**
+	 * Subscribe the plot. The first plot passes its settings and its time
+	 * window to the controller, all following plots take them over.
+	 */
+	void add_plot(Plot *plot);
+	void remove_plot(Plot *plot);
+	size_t plot_count() const;
+
+	void set_update_mode(PlotUpdateMode update_mode);
+	PlotUpdateMode update_mode() const;
+	void set_time_span(double time_span);
+	double time_span() const;
+	void set_add_time(double add_time);
+	double add_time() const;
+
+	/**
+	 * Calculate the time window from the newest samples and push it to all
+	 * plots, if it has changed.
+	 */
+	void update();
+
+	/**
+	 * Calculate the next x interval [&min, &max] of a plot in the given
+	 * mode, when the samples span [first_timestamp, last_timestamp].
+	 *
+	 * @return true if the interval has changed.
+	 */
+	static bool next_interval(PlotUpdateMode update_mode, double time_span,
+		double add_time, double first_timestamp, double last_timestamp,
+		double &min, double &max);
+
+private:
+	vector<Plot *> plots_;
+	PlotUpdateMode update_mode_;
+	double time_span_;
+	double add_time_;
+	/** false if the window must be initialized from the newest samples. */
+	bool has_interval_;
+	double min_;
+	double max_;
+
+};
+
+} // namespace plot
+} // namespace widgets
+} // namespace ui
+} // namespace sv
+
+#endif // UI_WIDGETS_PLOT_TIMEAXISCONTROLLER_HPP
@@ -17,10 +17,14 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <cmath>
 #include <memory>
 #include <set>
+#include <vector>
 
 #include <QPointF>
+#include <QPolygonF>
 #include <QRectF>
 #include <QSettings>
 #include <QString>
@@ -29,13 +33,16 @@
 #include "src/session.hpp"
 #include "src/settingsmanager.hpp"
 #include "src/data/analogtimesignal.hpp"
+#include "src/data/analogtimesnapshot.hpp"
 #include "src/data/datautil.hpp"
 #include "src/devices/basedevice.hpp"
 #include "src/ui/widgets/plot/basecurvedata.hpp"
 
 using std::dynamic_pointer_cast;
+using std::make_shared;
 using std::set;
 using std::shared_ptr;
+using std::vector;
 
 namespace sv {
 namespace ui {
@@ -44,8 +51,36 @@ namespace plot {
 
 TimeCurveData::TimeCurveData(shared_ptr<sv::data::AnalogTimeSignal> signal) :
 	BaseCurveData(CurveType::TimeCurve),
-	signal_(signal)
+	signal_(signal),
+	snapshot_(nullptr),
+	snapshot_min_(0.),
+	snapshot_max_(0.)
 {
+	signal_->add_observer();
+}
+
+TimeCurveData::TimeCurveData(const sv::data::AnalogTimeSnapshot &snapshot) :
+	BaseCurveData(CurveType::TimeCurve),
+	signal_(snapshot.signal()),
+	snapshot_(make_shared<sv::data::AnalogTimeSnapshot>(snapshot)),
+	snapshot_min_(0.),
+	snapshot_max_(0.)
+{
+	signal_->add_observer();
+
+	// The value range is taken from the min/max pyramid in O(log n)
+	sv::data::AnalogSummary summary;
+	if (signal_->get_summary(snapshot_->first_sample_pos(),
+			snapshot_->sample_count(), false, summary)) {
+		snapshot_min_ = summary.min;
+		snapshot_max_ = summary.max;
+	}
+}
+
+TimeCurveData::~TimeCurveData()
+{
+	signal_->clear_observer_history(this);
+	signal_->remove_observer();
 }
 
 bool TimeCurveData::is_equal(const BaseCurveData *other) const
@@ -54,14 +89,69 @@ bool TimeCurveData::is_equal(const BaseCurveData *other) const
 	if (tcd == nullptr)
 		return false;
 
-	return signal_ == tcd->signal();
+	return signal_ == tcd->signal() && snapshot_ == tcd->snapshot_;
+}
+
+BaseCurveData *TimeCurveData::clone() const
+{
+	TimeCurveData *curve_data = new TimeCurveData(signal_);
+	curve_data->snapshot_ = snapshot_;
+	curve_data->snapshot_min_ = snapshot_min_;
+	curve_data->snapshot_max_ = snapshot_max_;
+	curve_data->set_relative_time(relative_time_);
+	return curve_data;
+}
+
+BaseCurveData *TimeCurveData::freeze() const
+{
+	if (snapshot_)
+		return clone();
+
+	TimeCurveData *curve_data = new TimeCurveData(signal_->snapshot());
+	curve_data->set_relative_time(relative_time_);
+	return curve_data;
+}
+
+bool TimeCurveData::is_frozen() const
+{
+	return snapshot_ != nullptr;
+}
+
+void TimeCurveData::set_required_history(double history)
+{
+	if (snapshot_ || std::isinf(history))
+		signal_->clear_observer_history(this);
+	else
+		signal_->set_observer_history(this, history);
+}
+
+size_t TimeCurveData::copy_samples(size_t pos, size_t count,
+	double *timestamps, double *values) const
+{
+	if (snapshot_) {
+		return snapshot_->copy_samples(
+			pos, count, relative_time_, timestamps, values);
+	}
+	return signal_->copy_samples(
+		pos, count, relative_time_, timestamps, values);
 }
 
 QPointF TimeCurveData::sample(size_t i) const
 {
+	if (snapshot_) {
+		double timestamp;
+		double value;
+		if (!snapshot_->read_sample(snapshot_->first_sample_pos() + i,
+				relative_time_, timestamp, value))
+			return QPointF(0, 0);
+		return QPointF(timestamp, value);
+	}
+
 	//signal_data_->lock();
 
-	auto sample = signal_->get_sample(i, relative_time_);
+	// Curve indices are relative to the oldest sample still in the signal.
+	auto sample = signal_->get_sample(
+		signal_->first_sample_pos() + i, relative_time_);
 	QPointF sample_point(sample.first, sample.second);
 
 	//signal_data_->.unlock();
@@ -71,8 +161,11 @@ QPointF TimeCurveData::sample(size_t i) const
 
 size_t TimeCurveData::size() const
 {
+	if (snapshot_)
+		return snapshot_->is_valid() ? snapshot_->size() : 0;
+
 	// TODO: Synchronize x/y sample data
-	return signal_->sample_count();
+	return signal_->retained_sample_count();
 }
 
 QRectF TimeCurveData::boundingRect() const
@@ -88,6 +181,21 @@ QRectF TimeCurveData::boundingRect() const
 		<< signal_->max_value();
 	*/
 
+	if (snapshot_) {
+		double first_timestamp;
+		double last_timestamp;
+		double value;
+		if (snapshot_->empty() ||
+				!snapshot_->read_sample(snapshot_->first_sample_pos(),
+					relative_time_, first_timestamp, value) ||
+				!snapshot_->read_sample(snapshot_->sample_count() - 1,
+					relative_time_, last_timestamp, value))
+			return QRectF(1.0, 1.0, -2.0, -2.0); // Invalid rect, like Qwt does
+
+		return QRectF(QPointF(first_timestamp, snapshot_max_),
+			QPointF(last_timestamp, snapshot_min_));
+	}
+
 	// top left, bottom right
 	return QRectF(
 		QPointF(signal_->first_timestamp(relative_time_), signal_->max_value()),
@@ -97,34 +205,116 @@ QRectF TimeCurveData::boundingRect() const
 QPointF TimeCurveData::closest_point(const QPointF &pos, double *dist) const
 {
 	(void)dist;
-	const double x_value = pos.x();
-	const int index_max = (int)size() - 1;
+	const size_t first_pos = snapshot_ ?
+		snapshot_->first_sample_pos() : signal_->first_sample_pos();
+	const size_t index_max = size();
 
 	// Corner cases
-	if (index_max < 0)
+	if (index_max == 0)
 		return QPointF(0, 0);
-	if (x_value <= sample(0).x())
-		return sample(0);
-	if (x_value >= sample(index_max).x())
-		return sample(index_max);
 
-	size_t index_min = 0;
-	size_t n = index_max;
+	size_t sample_pos = signal_->lower_index(pos.x(), relative_time_);
+	if (sample_pos < first_pos)
+		sample_pos = first_pos;
+	if (sample_pos >= first_pos + index_max)
+		sample_pos = first_pos + index_max - 1;
 
-	while (n > 0) {
-		const size_t half = n >> 1;
-		const size_t index_mid = index_min + half;
+	double timestamp;
+	double value;
+	if (copy_samples(sample_pos, 1, &timestamp, &value) != 1)
+		return QPointF(0, 0);
+	return QPointF(timestamp, value);
+}
 
-		if (x_value < sample(index_mid).x()) {
-			n = half;
+bool TimeCurveData::envelope(double x_min, double x_max, size_t columns,
+	QPolygonF &points) const
+{
+	if (snapshot_) {
+		// Samples, that were appended after the snapshot, are not part of
+		// the envelope.
+		double last_timestamp;
+		double value;
+		if (snapshot_->empty() ||
+				!snapshot_->read_sample(snapshot_->sample_count() - 1,
+					relative_time_, last_timestamp, value))
+			return false;
+		if (last_timestamp < x_max && last_timestamp > x_min) {
+			// Keep the width of the columns
+			columns = std::max((size_t)1, (size_t)((double)columns *
+				(last_timestamp - x_min) / (x_max - x_min)));
+			x_max = last_timestamp;
 		}
-		else {
-			index_min = index_mid + 1;
-			n -= half + 1;
+		else if (last_timestamp <= x_min)
+			return false;
+	}
+	if (columns == 0 || x_max <= x_min)
+		return false;
+
+	// Only decimate, if there are more samples than the envelope has points
+	auto range = signal_->index_range(x_min, x_max, relative_time_);
+	if (snapshot_) {
+		range.second = std::min(range.second, snapshot_->sample_count());
+		range.first = std::min(range.first, range.second);
+	}
+	if (range.second - range.first <= 2 * columns)
+		return false;
+
+	const vector<sv::data::AnalogSummary> summaries =
+		signal_->get_summaries(x_min, x_max, columns, relative_time_);
+	if (summaries.empty())
+		return false;
+
+	points.clear();
+	points.reserve((int)(2 * summaries.size() + 2));
+
+	// Connect the envelope with the samples outside of the range
+	double timestamp;
+	double value;
+	if (range.first > 0 &&
+			copy_samples(range.first - 1, 1, &timestamp, &value) == 1)
+		points.append(QPointF(timestamp, value));
+	for (const auto &summary : summaries) {
+		if (summary.min == summary.max) {
+			points.append(QPointF(summary.start_timestamp, summary.min));
+			continue;
 		}
+		// Start with the extreme value, that is closer to the previous
+		// point, so there are less lines across the envelope.
+		const bool min_first = points.isEmpty() ||
+			points.last().y() < (summary.min + summary.max) / 2.;
+		points.append(QPointF(summary.start_timestamp,
+			min_first ? summary.min : summary.max));
+		points.append(QPointF(summary.end_timestamp,
+			min_first ? summary.max : summary.min));
 	}
+	if (copy_samples(range.second, 1, &timestamp, &value) == 1)
+		points.append(QPointF(timestamp, value));
+
+	return true;
+}
+
+bool TimeCurveData::visible_range(double x_min, double x_max,
+	size_t &first, size_t &last) const
+{
+	const size_t begin_pos = snapshot_ ?
+		snapshot_->first_sample_pos() : signal_->first_sample_pos();
+	const size_t end_pos = snapshot_ ?
+		snapshot_->sample_count() : signal_->sample_count();
+	if (end_pos <= begin_pos || size() == 0)
+		return false;
 
-	return sample(index_min);
+	// Add the samples before and after the range for the lines to the edges
+	const auto range = signal_->index_range(x_min, x_max, relative_time_);
+	size_t first_pos = range.first > begin_pos ? range.first - 1 : begin_pos;
+	first_pos = std::min(first_pos, end_pos - 1);
+	size_t last_pos = std::min(range.second, end_pos - 1);
+	if (last_pos < first_pos)
+		last_pos = first_pos;
+
+	// Curve indices are relative to the oldest sample still in the signal.
+	first = first_pos - begin_pos;
+	last = last_pos - begin_pos;
+	return true;
 }
 
 QString TimeCurveData::name() const
@@ -198,6 +388,8 @@ shared_ptr<sv::data::AnalogTimeSignal> TimeCurveData::signal() const
 void TimeCurveData::save_settings(QSettings &settings,
 	shared_ptr<sv::devices::BaseDevice> origin_device) const
 {
+	if (snapshot_)
+		return;
 	SettingsManager::save_signal(signal_, settings, origin_device);
 }
 
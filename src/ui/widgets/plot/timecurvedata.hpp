@@ -25,6 +25,7 @@
 #include <string>
 
 #include <QPointF>
+#include <QPolygonF>
 #include <QRectF>
 #include <QSettings>
 #include <QString>
@@ -42,6 +43,7 @@ class Session;
 
 namespace data {
 class AnalogTimeSignal;
+class AnalogTimeSnapshot;
 }
 namespace devices {
 class BaseDevice;
@@ -57,14 +59,41 @@ class TimeCurveData : public BaseCurveData
 
 public:
 	explicit TimeCurveData(shared_ptr<sv::data::AnalogTimeSignal> signal);
+	/**
+	 * A frozen curve, that only contains the samples of the snapshot.
+	 */
+	explicit TimeCurveData(const sv::data::AnalogTimeSnapshot &snapshot);
+	~TimeCurveData();
 
 	bool is_equal(const BaseCurveData *other) const override;
+	BaseCurveData *clone() const override;
+	/**
+	 * The frozen curve is backed by a snapshot of the signal, see
+	 * AnalogTimeSnapshot, so the samples are not copied.
+	 */
+	BaseCurveData *freeze() const override;
+	bool is_frozen() const;
+	/** A frozen curve is pinned by its snapshot and declares nothing. */
+	void set_required_history(double history) override;
 
 	QPointF sample(size_t i) const override;
 	size_t size() const override;
 	QRectF boundingRect() const override;
 
 	QPointF closest_point(const QPointF &pos, double *dist) const override;
+	/**
+	 * The envelope is calculated from the min/max pyramid of the signal, so
+	 * the costs depend on the number of columns and not on the number of
+	 * samples.
+	 */
+	bool envelope(double x_min, double x_max, size_t columns,
+		QPolygonF &points) const override;
+	/**
+	 * The range is searched in O(log n), see
+	 * AnalogTimeSignal::index_range().
+	 */
+	bool visible_range(double x_min, double x_max,
+		size_t &first, size_t &last) const override;
 	QString name() const override;
 	string id_prefix() const override;
 	sv::data::Quantity x_quantity() const override;
@@ -80,6 +109,7 @@ public:
 
 	shared_ptr<sv::data::AnalogTimeSignal> signal() const;
 
+	/** Frozen curves are not saved, like the samples of the snapshot. */
 	void save_settings(QSettings &settings,
 		shared_ptr<sv::devices::BaseDevice> origin_device) const override;
 	static TimeCurveData *init_from_settings(
@@ -87,7 +117,16 @@ public:
 		shared_ptr<sv::devices::BaseDevice> origin_device);
 
 private:
+	/** Copy the samples of the signal or of the snapshot. */
+	size_t copy_samples(size_t pos, size_t count,
+		double *timestamps, double *values) const;
+
 	shared_ptr<sv::data::AnalogTimeSignal> signal_;
+	/** The samples of a frozen curve, nullptr for a live curve. */
+	shared_ptr<sv::data::AnalogTimeSnapshot> snapshot_;
+	/** The value range of the snapshot. */
+	double snapshot_min_;
+	double snapshot_max_;
 
 };
 
@@ -17,6 +17,9 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <memory>
 #include <mutex>
 #include <set>
@@ -27,13 +30,15 @@
 #include <QRectF>
 #include <QSettings>
 #include <QString>
-#include <qwt_math.h>
 
 #include "xycurvedata.hpp"
 #include "src/session.hpp"
 #include "src/settingsmanager.hpp"
 #include "src/data/analogtimesignal.hpp"
+#include "src/data/analogtimesnapshot.hpp"
 #include "src/data/datautil.hpp"
+#include "src/data/nearestpointindex.hpp"
+#include "src/data/signalcombinecache.hpp"
 #include "src/devices/basedevice.hpp"
 #include "src/ui/widgets/plot/basecurvedata.hpp"
 
@@ -54,21 +59,45 @@ XYCurveData::XYCurveData(shared_ptr<sv::data::AnalogTimeSignal> x_t_signal,
 	BaseCurveData(CurveType::XYCurve),
 	x_t_signal_(x_t_signal),
 	y_t_signal_(y_t_signal),
-	x_t_signal_pos_(0),
-	y_t_signal_pos_(0)
+	frozen_begin_(0),
+	frozen_end_(0),
+	history_points_(0),
+	history_time_(0.),
+	history_begin_(0),
+	declared_history_(-1.),
+	point_index_begin_(0)
 {
-	x_data_ = make_shared<vector<double>>();
-	y_data_ = make_shared<vector<double>>();
+	combine_cache_ = sv::data::SignalCombineCache::get({
+		x_t_signal_, y_t_signal_ });
+	point_index_epoch_ = combine_cache_->clear_epoch();
 
-	// Prefill data vectors
+	x_t_signal_->add_observer();
+	y_t_signal_->add_observer();
+
+	// Combine the existing samples
 	this->on_sample_appended();
 
-	connect(x_t_signal_.get(), SIGNAL(sample_appended()),
+	connect(x_t_signal_.get(), SIGNAL(samples_appended(size_t, size_t)),
+		this, SLOT(on_sample_appended()));
+	connect(y_t_signal_.get(), SIGNAL(samples_appended(size_t, size_t)),
+		this, SLOT(on_sample_appended()));
+	// The cache clears its rows with the next update
+	connect(x_t_signal_.get(), SIGNAL(samples_cleared()),
 		this, SLOT(on_sample_appended()));
-	connect(y_t_signal_.get(), SIGNAL(sample_appended()),
+	connect(y_t_signal_.get(), SIGNAL(samples_cleared()),
 		this, SLOT(on_sample_appended()));
 }
 
+XYCurveData::~XYCurveData()
+{
+	if (declared_history_ >= 0.) {
+		x_t_signal_->clear_observer_history(this);
+		y_t_signal_->clear_observer_history(this);
+	}
+	x_t_signal_->remove_observer();
+	y_t_signal_->remove_observer();
+}
+
 bool XYCurveData::is_equal(const BaseCurveData *other) const
 {
 	const XYCurveData *xycd = dynamic_cast<const XYCurveData *>(other);
@@ -76,22 +105,126 @@ bool XYCurveData::is_equal(const BaseCurveData *other) const
 		return false;
 
 	return (x_t_signal_ == xycd->x_t_signal()) &&
-		(y_t_signal_ == xycd->y_t_signal());
+		(y_t_signal_ == xycd->y_t_signal()) &&
+		(snapshots_ == xycd->snapshots_);
+}
+
+BaseCurveData *XYCurveData::clone() const
+{
+	XYCurveData *curve_data = new XYCurveData(x_t_signal_, y_t_signal_);
+	if (is_frozen()) {
+		curve_data->snapshots_ = snapshots_;
+		curve_data->frozen_begin_ = frozen_begin_;
+		curve_data->frozen_end_ = frozen_end_;
+		curve_data->frozen_rect_ = frozen_rect_;
+	}
+	else {
+		curve_data->set_history_points(history_points());
+		curve_data->set_history_time(history_time());
+	}
+	curve_data->set_relative_time(relative_time_);
+	return curve_data;
+}
+
+BaseCurveData *XYCurveData::freeze() const
+{
+	if (is_frozen())
+		return clone();
+
+	XYCurveData *curve_data = new XYCurveData(x_t_signal_, y_t_signal_);
+	// A frozen curve doesn't need the new rows
+	disconnect(x_t_signal_.get(), nullptr, curve_data, nullptr);
+	disconnect(y_t_signal_.get(), nullptr, curve_data, nullptr);
+
+	// The rows up to the end are combined from samples, that are part of
+	// the snapshots. The begin is taken after the signals are pinned.
+	curve_data->frozen_end_ = combine_cache_->end_pos();
+	curve_data->snapshots_.push_back(
+		make_shared<sv::data::AnalogTimeSnapshot>(x_t_signal_->snapshot()));
+	curve_data->snapshots_.push_back(
+		make_shared<sv::data::AnalogTimeSnapshot>(y_t_signal_->snapshot()));
+	curve_data->frozen_begin_ =
+		std::min(begin_pos(), curve_data->frozen_end_);
+
+	// The value ranges of the snapshots are taken from the min/max pyramids
+	// of the signals in O(log n). They may be a little bigger than the
+	// range of the combined rows. A history window only covers a part of
+	// the snapshots.
+	curve_data->frozen_rect_ = QRectF(1.0, 1.0, -2.0, -2.0); // Invalid rect
+	sv::data::AnalogSummary x_summary;
+	sv::data::AnalogSummary y_summary;
+	const auto &x_snapshot = curve_data->snapshots_[0];
+	const auto &y_snapshot = curve_data->snapshots_[1];
+	if (has_history_limit()) {
+		curve_data->frozen_rect_ = window_rect(
+			curve_data->frozen_begin_, curve_data->frozen_end_);
+	}
+	else if (x_t_signal_->get_summary(x_snapshot->first_sample_pos(),
+			x_snapshot->sample_count(), false, x_summary) &&
+		y_t_signal_->get_summary(y_snapshot->first_sample_pos(),
+			y_snapshot->sample_count(), false, y_summary)) {
+		// top left, bottom right
+		curve_data->frozen_rect_ = QRectF(
+			QPointF(x_summary.min, y_summary.max),
+			QPointF(x_summary.max, y_summary.min));
+	}
+
+	curve_data->set_relative_time(relative_time_);
+	return curve_data;
+}
+
+bool XYCurveData::is_frozen() const
+{
+	return !snapshots_.empty();
+}
+
+size_t XYCurveData::begin_pos() const
+{
+	if (is_frozen())
+		return frozen_begin_;
+	return std::max(combine_cache_->begin_pos(),
+		history_begin_.load(std::memory_order_acquire));
+}
+
+size_t XYCurveData::end_pos() const
+{
+	return is_frozen() ? frozen_end_ : combine_cache_->end_pos();
 }
 
 QPointF XYCurveData::sample(size_t i) const
 {
-	QPointF sample_point(x_data_->at(i), y_data_->at(i));
-	return sample_point;
+	// Curve indices are relative to the oldest row still in the cache
+	const size_t pos = begin_pos() + i;
+	double x;
+	double y;
+	if (!combine_cache_->value(0, pos, x) || !combine_cache_->value(1, pos, y))
+		return QPointF(0, 0);
+	return QPointF(x, y);
 }
 
 size_t XYCurveData::size() const
 {
-	return x_data_->size();
+	if (!is_frozen()) {
+		const size_t end = end_pos();
+		const size_t begin = begin_pos();
+		return end > begin ? end - begin : 0;
+	}
+
+	// The snapshots are only invalidated, when a signal is cleared
+	for (const auto &snapshot : snapshots_) {
+		if (!snapshot->is_valid())
+			return 0;
+	}
+	return frozen_end_ - frozen_begin_;
 }
 
 QRectF XYCurveData::boundingRect() const
 {
+	if (is_frozen())
+		return frozen_rect_;
+	if (has_history_limit())
+		return window_rect(begin_pos(), end_pos());
+
 	// top left, bottom right
 	return QRectF(
 		QPointF(x_t_signal_->min_value(), y_t_signal_->max_value()),
@@ -100,27 +233,162 @@ QRectF XYCurveData::boundingRect() const
 
 QPointF XYCurveData::closest_point(const QPointF &pos, double *dist) const
 {
-	const size_t num_samples = size();
-	if (num_samples == 0)
+	lock_guard<mutex> lock(point_index_mutex_);
+	update_point_index();
+
+	size_t index;
+	double dmin;
+	if (!point_index_.nearest(pos.x(), pos.y(), index, dmin))
 		return QPointF(0, 0); // TODO
 
-	size_t index = -1;
-	double dmin = 1.0e10;
-
-	for (size_t i=0; i < num_samples; i++) {
-		const QPointF s = sample(i);
-		const double cx = s.x() - pos.x();
-		const double cy = s.y() - pos.y();
-		const double d = qwtSqr(cx) + qwtSqr(cy);
-		if (d < dmin) {
-			index = i;
-			dmin = d;
-		}
-	}
 	if (dist)
 		*dist = qSqrt(dmin);
 
-	return sample(index);
+	// The point may have been dropped since the index was updated
+	const size_t point_pos = point_index_begin_ + index;
+	double x;
+	double y;
+	if (point_pos < begin_pos() || !combine_cache_->value(0, point_pos, x) ||
+			!combine_cache_->value(1, point_pos, y))
+		return sample(0);
+	return QPointF(x, y);
+}
+
+void XYCurveData::update_point_index() const
+{
+	// The index can't remove single points, so it is rebuilt once most of
+	// the indexed points were dropped from the cache.
+	const unsigned int epoch = combine_cache_->clear_epoch();
+	const size_t begin = begin_pos();
+	const size_t end = end_pos();
+	if (epoch != point_index_epoch_ || (begin > point_index_begin_ &&
+			(begin - point_index_begin_) * 2 > point_index_.size())) {
+		point_index_.clear();
+		point_index_begin_ = begin;
+		point_index_epoch_ = epoch;
+	}
+
+	const size_t block_size = 256;
+	double x_block[block_size];
+	double y_block[block_size];
+	while (true) {
+		const size_t pos = point_index_begin_ + point_index_.size();
+		if (pos >= end)
+			break;
+		const size_t n = std::min(block_size, end - pos);
+		const size_t count = std::min(
+			combine_cache_->copy_values(0, pos, n, x_block),
+			combine_cache_->copy_values(1, pos, n, y_block));
+		if (count == 0)
+			break;
+		point_index_.append(x_block, y_block, count);
+	}
+}
+
+void XYCurveData::set_history_points(size_t points)
+{
+	history_points_.store(points, std::memory_order_release);
+	update_history_window();
+}
+
+size_t XYCurveData::history_points() const
+{
+	return history_points_.load(std::memory_order_acquire);
+}
+
+void XYCurveData::set_history_time(double seconds)
+{
+	if (!std::isfinite(seconds) || seconds < 0.)
+		seconds = 0.;
+	history_time_.store(seconds, std::memory_order_release);
+	update_history_window();
+}
+
+double XYCurveData::history_time() const
+{
+	return history_time_.load(std::memory_order_acquire);
+}
+
+bool XYCurveData::has_history_limit() const
+{
+	return history_points() > 0 || history_time() > 0.;
+}
+
+void XYCurveData::update_history_window()
+{
+	if (is_frozen())
+		return;
+
+	const size_t end = combine_cache_->end_pos();
+	size_t begin = combine_cache_->begin_pos();
+	const size_t points = history_points();
+	const double time = history_time();
+	if (points > 0 && end > begin && end - begin > points)
+		begin = end - points;
+	double last_timestamp = 0.;
+	const bool has_rows = end > begin &&
+		combine_cache_->timestamp(end - 1, last_timestamp);
+	if (time > 0. && has_rows)
+		begin = std::max(begin, combine_cache_->lower_bound(
+			last_timestamp - time));
+	history_begin_.store(begin, std::memory_order_release);
+
+	// The signals only have to keep the samples of the window. The time
+	// span of a window of points depends on the samplerate, so twice the
+	// span is declared and only updated, when it doesn't fit any more.
+	double history = -1.;
+	if (time > 0.)
+		history = time;
+	double first_timestamp;
+	if (points > 0 && has_rows && end - begin >= points &&
+			combine_cache_->timestamp(begin, first_timestamp)) {
+		const double span = last_timestamp - first_timestamp;
+		if (declared_history_ >= span && declared_history_ <= 4. * span)
+			history = declared_history_;
+		else
+			history = 2. * span;
+		if (time > 0.)
+			history = std::min(history, time);
+	}
+	else if (points > 0) {
+		// The window isn't full yet
+		history = time > 0. ? time : -1.;
+	}
+	if (history == declared_history_)
+		return;
+
+	if (history < 0.) {
+		x_t_signal_->clear_observer_history(this);
+		y_t_signal_->clear_observer_history(this);
+	}
+	else {
+		x_t_signal_->set_observer_history(this, history);
+		y_t_signal_->set_observer_history(this, history);
+	}
+	declared_history_ = history;
+}
+
+QRectF XYCurveData::window_rect(size_t begin, size_t end) const
+{
+	// The combined values are interpolated between the samples, so the
+	// ranges of the samples in the time span of the rows are taken from
+	// the min/max pyramids of the signals in O(log n).
+	double first_timestamp;
+	double last_timestamp;
+	sv::data::AnalogSummary x_summary;
+	sv::data::AnalogSummary y_summary;
+	if (end <= begin || !combine_cache_->timestamp(begin, first_timestamp) ||
+			!combine_cache_->timestamp(end - 1, last_timestamp) ||
+			!x_t_signal_->get_range_summary(
+				first_timestamp, last_timestamp, false, x_summary) ||
+			!y_t_signal_->get_range_summary(
+				first_timestamp, last_timestamp, false, y_summary))
+		return QRectF(1.0, 1.0, -2.0, -2.0); // Invalid rect
+
+	// top left, bottom right
+	return QRectF(
+		QPointF(x_summary.min, y_summary.max),
+		QPointF(x_summary.max, y_summary.min));
 }
 
 QString XYCurveData::name() const
@@ -199,11 +467,22 @@ shared_ptr<sv::data::AnalogTimeSignal> XYCurveData::y_t_signal() const
 	return y_t_signal_;
 }
 
+shared_ptr<sv::data::SignalCombineCache> XYCurveData::combine_cache() const
+{
+	return combine_cache_;
+}
+
 void XYCurveData::save_settings(QSettings &settings,
 	shared_ptr<sv::devices::BaseDevice> origin_device) const
 {
+	if (is_frozen())
+		return;
 	SettingsManager::save_signal(x_t_signal_, settings, origin_device, "x_");
 	SettingsManager::save_signal(y_t_signal_, settings, origin_device, "y_");
+	if (history_points() > 0)
+		settings.setValue("history_points", (qulonglong)history_points());
+	if (history_time() > 0.)
+		settings.setValue("history_time", history_time());
 }
 
 XYCurveData *XYCurveData::init_from_settings(
@@ -217,20 +496,22 @@ XYCurveData *XYCurveData::init_from_settings(
 	if (!x_t_signal || !y_t_signal)
 		return nullptr;
 
-	return new XYCurveData(
+	XYCurveData *curve_data = new XYCurveData(
 		dynamic_pointer_cast<sv::data::AnalogTimeSignal>(x_t_signal),
 		dynamic_pointer_cast<sv::data::AnalogTimeSignal>(y_t_signal));
+	if (settings.contains("history_points"))
+		curve_data->set_history_points(
+			(size_t)settings.value("history_points").toULongLong());
+	if (settings.contains("history_time"))
+		curve_data->set_history_time(
+			settings.value("history_time").toDouble());
+	return curve_data;
 }
 
 void XYCurveData::on_sample_appended()
 {
-	lock_guard<mutex> lock(sample_append_mutex_);
-
-	shared_ptr<vector<double>> time = make_shared<vector<double>>();
-	sv::data::AnalogTimeSignal::combine_signals(
-		x_t_signal_, x_t_signal_pos_,
-		y_t_signal_, y_t_signal_pos_,
-		time, x_data_, y_data_);
+	combine_cache_->update();
+	update_history_window();
 }
 
 } // namespace plot
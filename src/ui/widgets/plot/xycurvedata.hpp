@@ -20,6 +20,7 @@
 #ifndef UI_WIDGETS_PLOT_XYCURVEDATA_HPP
 #define UI_WIDGETS_PLOT_XYCURVEDATA_HPP
 
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <set>
@@ -32,6 +33,7 @@
 #include <QString>
 
 #include "src/data/datautil.hpp"
+#include "src/data/nearestpointindex.hpp"
 #include "src/ui/widgets/plot/basecurvedata.hpp"
 
 using std::mutex;
@@ -46,6 +48,8 @@ class Session;
 
 namespace data {
 class AnalogTimeSignal;
+class AnalogTimeSnapshot;
+class SignalCombineCache;
 }
 namespace devices {
 class BaseDevice;
@@ -66,13 +70,27 @@ class XYCurveData : public BaseCurveData
 public:
 	XYCurveData(shared_ptr<sv::data::AnalogTimeSignal> x_t_signal,
 		shared_ptr<sv::data::AnalogTimeSignal> y_t_signal);
+	~XYCurveData();
 
 	bool is_equal(const BaseCurveData *other) const override;
+	BaseCurveData *clone() const override;
+	/**
+	 * The frozen curve keeps the current rows of the combine cache. Both
+	 * signals are pinned with a snapshot (see AnalogTimeSnapshot), so the
+	 * rows aren't dropped and no samples are copied.
+	 */
+	BaseCurveData *freeze() const override;
+	bool is_frozen() const;
 
 	QPointF sample(size_t i) const override;
 	size_t size() const override;
 	QRectF boundingRect() const override;
 
+	/**
+	 * The closest point is looked up in a spatial index in O(log^2 n). The
+	 * index is only built (and then updated) on demand, so curves without
+	 * markers don't need the memory.
+	 */
 	QPointF closest_point(const QPointF &pos, double *dist) const override;
 	QString name() const override;
 	string id_prefix() const override;
@@ -89,7 +107,31 @@ public:
 
 	shared_ptr<sv::data::AnalogTimeSignal> x_t_signal() const;
 	shared_ptr<sv::data::AnalogTimeSignal> y_t_signal() const;
-
+	shared_ptr<sv::data::SignalCombineCache> combine_cache() const;
+	/**
+	 * Return the absolute positions of the first row and behind the last
+	 * row of the combine cache, that belong to the curve.
+	 */
+	size_t begin_pos() const;
+	size_t end_pos() const;
+
+	/**
+	 * Limit the curve to the last points rows, e.g. for a long-running
+	 * load line monitoring. Older rows are not drawn and, with the automatic
+	 * retention of the session, are dropped from the signals, so memory and
+	 * render costs stay constant. 0 means no limit (the default).
+	 */
+	void set_history_points(size_t points);
+	size_t history_points() const;
+	/**
+	 * Limit the curve to the rows of the last seconds, see
+	 * set_history_points(). 0 means no limit (the default).
+	 */
+	void set_history_time(double seconds);
+	double history_time() const;
+	bool has_history_limit() const;
+
+	/** Frozen curves are not saved, like the rows of the snapshot. */
 	void save_settings(QSettings &settings,
 		shared_ptr<sv::devices::BaseDevice> origin_device) const override;
 	static XYCurveData *init_from_settings(
@@ -97,14 +139,50 @@ public:
 		shared_ptr<sv::devices::BaseDevice> origin_device);
 
 private:
+	/**
+	 * Append the new points to the spatial index, or rebuild it when most
+	 * of the indexed points were dropped. point_index_mutex_ must be locked.
+	 */
+	void update_point_index() const;
+	/**
+	 * Move the begin of the history window behind the rows, that are
+	 * older than the history limits, and declare the needed history to
+	 * the signals.
+	 */
+	void update_history_window();
+	/** Return the value ranges of both signals for the rows [begin, end). */
+	QRectF window_rect(size_t begin, size_t end) const;
+
 	shared_ptr<sv::data::AnalogTimeSignal> x_t_signal_;
 	shared_ptr<sv::data::AnalogTimeSignal> y_t_signal_;
-	size_t x_t_signal_pos_;
-	size_t y_t_signal_pos_;
-	// TODO: use some sort of AnalogSignal instead of 2 vectors?
-	shared_ptr<vector<double>> x_data_;
-	shared_ptr<vector<double>> y_data_;
-	mutex sample_append_mutex_;
+	/**
+	 * The combined samples of both signals, shared with the other curves of
+	 * the same signals.
+	 */
+	shared_ptr<sv::data::SignalCombineCache> combine_cache_;
+	/**
+	 * The snapshots of both signals of a frozen curve, that pin the rows
+	 * [frozen_begin_, frozen_end_). Empty for a live curve.
+	 */
+	vector<shared_ptr<sv::data::AnalogTimeSnapshot>> snapshots_;
+	size_t frozen_begin_;
+	size_t frozen_end_;
+	QRectF frozen_rect_;
+	std::atomic<size_t> history_points_;
+	std::atomic<double> history_time_;
+	/** The first row of the history window of a live curve. */
+	std::atomic<size_t> history_begin_;
+	/**
+	 * The history in seconds, that was declared to the signals with
+	 * set_observer_history(), or a negative value if none was declared.
+	 */
+	double declared_history_;
+	mutable sv::data::NearestPointIndex point_index_;
+	/** The position in the combine cache of the first indexed point. */
+	mutable size_t point_index_begin_;
+	/** The clear epoch of the combine cache of the indexed points. */
+	mutable unsigned int point_index_epoch_;
+	mutable mutex point_index_mutex_;
 
 private Q_SLOTS:
 	void on_sample_appended();
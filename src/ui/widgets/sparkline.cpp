@@ -0,0 +1,137 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <QColor>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QPalette>
+#include <QPen>
+#include <QPointF>
+#include <QPolygonF>
+#include <QSize>
+#include <QSizePolicy>
+
+#include "sparkline.hpp"
+#include "src/data/minmaxpyramid.hpp"
+
+using std::vector;
+
+namespace sv {
+namespace ui {
+namespace widgets {
+
+Sparkline::Sparkline(QWidget *parent) :
+	QWidget(parent),
+	start_timestamp_(0.),
+	end_timestamp_(0.)
+{
+	setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+}
+
+void Sparkline::set_trend(const vector<data::AnalogSummary> &summaries,
+	double start_timestamp, double end_timestamp)
+{
+	summaries_ = summaries;
+	start_timestamp_ = start_timestamp;
+	end_timestamp_ = end_timestamp;
+	update();
+}
+
+void Sparkline::clear()
+{
+	summaries_.clear();
+	update();
+}
+
+QSize Sparkline::sizeHint() const
+{
+	return QSize(240, 48);
+}
+
+QSize Sparkline::minimumSizeHint() const
+{
+	return QSize(60, 24);
+}
+
+void Sparkline::paintEvent(QPaintEvent *event)
+{
+	(void)event;
+
+	if (summaries_.empty() || !(end_timestamp_ > start_timestamp_))
+		return;
+
+	double min = std::numeric_limits<double>::max();
+	double max = std::numeric_limits<double>::lowest();
+	for (const auto &summary : summaries_) {
+		if (std::isfinite(summary.min))
+			min = std::min(min, summary.min);
+		if (std::isfinite(summary.max))
+			max = std::max(max, summary.max);
+	}
+	if (min > max)
+		return;
+	// Don't collapse a constant signal to the top of the widget
+	if (max - min <= 0.) {
+		min -= 1.;
+		max += 1.;
+	}
+
+	const QRectF r = QRectF(rect()).adjusted(1., 1., -1., -1.);
+	const double x_scale = r.width() / (end_timestamp_ - start_timestamp_);
+	const double y_scale = r.height() / (max - min);
+	auto x_pos = [&](double timestamp) {
+		return r.left() + (timestamp - start_timestamp_) * x_scale;
+	};
+	auto y_pos = [&](double value) {
+		return r.bottom() - (value - min) * y_scale;
+	};
+
+	QPainter painter(this);
+	painter.setRenderHint(QPainter::Antialiasing, true);
+
+	// The min/max envelope of the bins
+	QColor band_color = palette().color(QPalette::Highlight);
+	band_color.setAlpha(96);
+	painter.setPen(QPen(band_color, 1.));
+	QPolygonF means;
+	means.reserve((int)summaries_.size());
+	for (const auto &summary : summaries_) {
+		if (summary.sample_count == 0)
+			continue;
+		const double x = x_pos(
+			(summary.start_timestamp + summary.end_timestamp) / 2.);
+		if (std::isfinite(summary.min) && std::isfinite(summary.max))
+			painter.drawLine(QPointF(x, y_pos(summary.min)),
+				QPointF(x, y_pos(summary.max)));
+		if (std::isfinite(summary.mean))
+			means.append(QPointF(x, y_pos(summary.mean)));
+	}
+
+	painter.setPen(QPen(palette().color(QPalette::Highlight), 1.5));
+	painter.drawPolyline(means);
+}
+
+} // namespace widgets
+} // namespace ui
+} // namespace sv
@@ -0,0 +1,78 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_WIDGETS_SPARKLINE_HPP
+#define UI_WIDGETS_SPARKLINE_HPP
+
+#include <vector>
+
+#include <QPaintEvent>
+#include <QSize>
+#include <QWidget>
+
+#include "src/data/minmaxpyramid.hpp"
+
+using std::vector;
+
+namespace sv {
+namespace ui {
+namespace widgets {
+
+/**
+ * A small trend line of a signal without axes, e.g. below the values of a
+ * value panel.
+ *
+ * The trend is drawn from the min/max/mean summaries of equal time bins,
+ * see AnalogTimeSignal::get_summaries(). So the costs depend only on the
+ * number of bins and not on the number of samples: Every bin is drawn as
+ * a vertical min/max bar, the means are connected by a line.
+ */
+class Sparkline : public QWidget
+{
+	Q_OBJECT
+
+public:
+	explicit Sparkline(QWidget *parent = nullptr);
+
+	/**
+	 * Set the bins of the time range [start_timestamp, end_timestamp]. The
+	 * value range is scaled to the min/max of all bins.
+	 */
+	void set_trend(const vector<data::AnalogSummary> &summaries,
+		double start_timestamp, double end_timestamp);
+	void clear();
+
+	QSize sizeHint() const override;
+	QSize minimumSizeHint() const override;
+
+protected:
+	void paintEvent(QPaintEvent *event) override;
+
+private:
+	vector<data::AnalogSummary> summaries_;
+	double start_timestamp_;
+	double end_timestamp_;
+
+};
+
+} // namespace widgets
+} // namespace ui
+} // namespace sv
+
+#endif // UI_WIDGETS_SPARKLINE_HPP
@@ -17,6 +17,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cmath>
 #include <limits>
 
 #include <QFrame>
@@ -24,6 +25,7 @@
 
 #include "valuedisplay.hpp"
 #include "src/util.hpp"
+#include "src/data/formatter.hpp"
 
 namespace sv {
 namespace ui {
@@ -45,7 +47,12 @@ ValueDisplay::ValueDisplay(
 	unit_suffix_(unit_suffix),
 	unit_changed_(true),
 	small_(small),
-	value_(.0)
+	value_(.0),
+	si_prefix_(util::SIPrefix::none),
+	si_multiplier_(1.),
+	si_lower_multiplier_(1000.),
+	si_prefix_str_(""),
+	formatter_(QLocale())
 {
 }
 
@@ -62,6 +69,9 @@ void ValueDisplay::set_value(const double value)
 
 void ValueDisplay::set_extra_text(const QString &extra_text)
 {
+	if (extra_text == extra_text_)
+		return;
+
 	extra_text_ = extra_text;
 	extra_text_changed_ = true;
 	update_display();
@@ -69,6 +79,9 @@ void ValueDisplay::set_extra_text(const QString &extra_text)
 
 void ValueDisplay::set_unit(const QString &unit)
 {
+	if (unit == unit_)
+		return;
+
 	unit_ = unit;
 	unit_changed_ = true;
 	update_display();
@@ -76,6 +89,9 @@ void ValueDisplay::set_unit(const QString &unit)
 
 void ValueDisplay::set_unit_suffix(const QString &unit_suffix)
 {
+	if (unit_suffix == unit_suffix_)
+		return;
+
 	unit_suffix_ = unit_suffix;
 	unit_changed_ = true;
 	update_display();
@@ -83,6 +99,10 @@ void ValueDisplay::set_unit_suffix(const QString &unit_suffix)
 
 void ValueDisplay::set_digits(const int digits, const int decimal_places)
 {
+	// Changing the digits resizes the value widget, which is expensive
+	if (digits == digits_ && decimal_places == decimal_places_)
+		return;
+
 	digits_ = digits;
 	decimal_places_ = decimal_places;
 	digits_changed_ = true;
@@ -94,6 +114,7 @@ void ValueDisplay::reset_value()
 	QString init_value("");
 	for (int i=0; i<digits_; i++)
 		init_value.append("-");
+	shown_value_ = init_value;
 	show_value(init_value);
 }
 
@@ -113,14 +134,17 @@ void ValueDisplay::update_display()
 	}
 	else if (!auto_range_) {
 		// Use actual locale (%L) for formating
-		value_str = QString("%L1").
-			arg(value_, digits_, 'f', decimal_places_, QChar(' '));
+		value_str = formatter_.format_fixed(value_, digits_, decimal_places_);
 	}
 	else {
-		util::format_value_si(
-			value_, digits_, decimal_places_, value_str, si_prefix);
+		format_value_si(value_str, si_prefix);
+	}
+	// Most new samples don't change the formatted value, so the repaint of
+	// the value widget can be skipped.
+	if (value_str != shown_value_) {
+		shown_value_ = value_str;
+		show_value(value_str);
 	}
-	show_value(value_str);
 
 	if (digits_changed_) {
 		digits_changed_ = false;
@@ -147,6 +171,34 @@ void ValueDisplay::update_display()
 	}
 }
 
+void ValueDisplay::format_value_si(QString &value_str, QString &si_prefix_str)
+{
+	// Same conditions as in util::si_prefix_for_value(): The value is in
+	// the range of the prefix, if it is not above 999 with this prefix and
+	// above 999 with the next lower prefix.
+	const double abs_value = std::fabs(value_);
+	const bool in_range = value_ != 0 &&
+		(si_prefix_ == util::SIPrefix::yotta ||
+			abs_value * si_multiplier_ <= 999) &&
+		(si_prefix_ == util::SIPrefix::yocto ||
+			abs_value * si_lower_multiplier_ > 999);
+	if (!in_range) {
+		const util::SIPrefix si_prefix = util::si_prefix_for_value(value_);
+		if (si_prefix != si_prefix_) {
+			si_prefix_ = si_prefix;
+			si_multiplier_ = std::pow(10, -util::exponent(si_prefix_));
+			si_lower_multiplier_ =
+				std::pow(10, -util::exponent(si_prefix_) + 3);
+			si_prefix_str_ = util::format_si_prefix(si_prefix_);
+		}
+	}
+
+	// Use actual locale (%L) for formating.
+	value_str = formatter_.format_fixed(value_ * si_multiplier_,
+		digits_, decimal_places_);
+	si_prefix_str = si_prefix_str_;
+}
+
 } // namespace widgets
 } // namespace ui
 } // namespace sv
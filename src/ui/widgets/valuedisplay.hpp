@@ -23,6 +23,9 @@
 #include <QFrame>
 #include <QString>
 
+#include "src/util.hpp"
+#include "src/data/formatter.hpp"
+
 namespace sv {
 namespace ui {
 namespace widgets {
@@ -52,6 +55,28 @@ protected:
 	bool unit_changed_;
 	const bool small_;
 	double value_;
+	/** The formatted value, that is shown at the moment. */
+	QString shown_value_;
+
+	/**
+	 * The SI prefix of the last auto ranged value. The following values
+	 * usually have the same prefix, so this is only checked with the cached
+	 * multipliers instead of searching the prefix for every value.
+	 */
+	util::SIPrefix si_prefix_;
+	/** 10^-exponent(si_prefix_), scales the value to the prefix. */
+	double si_multiplier_;
+	/** The multiplier of the prefix, that is below si_prefix_. */
+	double si_lower_multiplier_;
+	QString si_prefix_str_;
+	/** Formats the values like QString("%L1").arg() in the actual locale. */
+	data::Formatter formatter_;
+
+	/**
+	 * Format an auto ranged value with the cached SI prefix, that is only
+	 * updated when the value leaves the range of the prefix.
+	 */
+	void format_value_si(QString &value_str, QString &si_prefix_str);
 
 	virtual void setup_ui() = 0;
 	virtual void update_value_widget_dimensions() = 0;
@@ -20,6 +20,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstdlib>
 #include <limits>
 #include <math.h>
 #include <sstream>
@@ -29,6 +30,8 @@
 
 #include <QDateTime>
 #include <QDebug>
+#include <QHostAddress>
+#include <QString>
 #include <QTextStream>
 #include <QUuid>
 
@@ -116,26 +119,38 @@ static QTextStream& operator<<(QTextStream& stream, const Timestamp& t)
 	return stream << QString::fromStdString(str);
 }
 
-void format_value_si(
-	const double value, const int digits, const int decimal_places,
-	QString &value_str, QString &si_prefix_str)
+SIPrefix si_prefix_for_value(const double value)
 {
-	SIPrefix si_prefix;
 	if (value == 0 || value == NAN ||
 			value == std::numeric_limits<double>::infinity() ||
 			value >= std::numeric_limits<double>::max() ||
 			value <= std::numeric_limits<double>::lowest()) {
-		si_prefix = SIPrefix::none;
+		return SIPrefix::none;
 	}
-	else {
-		int exp = exponent(SIPrefix::yotta);
-		si_prefix = SIPrefix::yocto;
-		while ((fabs(value) * pow(10, exp)) > 999 &&
-				si_prefix < SIPrefix::yotta) {
-			si_prefix = successor(si_prefix);
-			exp -= 3;
-		}
+
+	int exp = exponent(SIPrefix::yotta);
+	SIPrefix si_prefix = SIPrefix::yocto;
+	while ((fabs(value) * pow(10, exp)) > 999 &&
+			si_prefix < SIPrefix::yotta) {
+		si_prefix = successor(si_prefix);
+		exp -= 3;
 	}
+	return si_prefix;
+}
+
+QString format_si_prefix(SIPrefix prefix)
+{
+	QString si_prefix_str;
+	QTextStream si_prefix_stream(&si_prefix_str);
+	si_prefix_stream << prefix;
+	return si_prefix_str;
+}
+
+void format_value_si(
+	const double value, const int digits, const int decimal_places,
+	QString &value_str, QString &si_prefix_str)
+{
+	const SIPrefix si_prefix = si_prefix_for_value(value);
 	assert(si_prefix >= SIPrefix::yocto);
 	assert(si_prefix <= SIPrefix::yotta);
 
@@ -145,8 +160,7 @@ void format_value_si(
 	value_str = QString("%L1").
 		arg(value * multiplier, digits, 'f', decimal_places, QChar(' '));
 
-	QTextStream si_prefix_stream(&si_prefix_str);
-	si_prefix_stream << si_prefix;
+	si_prefix_str = format_si_prefix(si_prefix);
 }
 
 QString format_time_si(const Timestamp& v, SIPrefix prefix,
@@ -383,5 +397,56 @@ vector<string> parse_csv_line(const string &line)
 	return fields;
 }
 
+bool parse_listen_address(const string &host, QHostAddress &address)
+{
+	if (host.empty() || host == "localhost") {
+		address = QHostAddress(QHostAddress::LocalHost);
+		return true;
+	}
+	if (host == "*") {
+		address = QHostAddress(QHostAddress::Any);
+		return true;
+	}
+	return address.setAddress(QString::fromStdString(host));
+}
+
+bool is_loopback_address(const QHostAddress &address)
+{
+	bool is_ipv4 = false;
+	const quint32 ipv4 = address.toIPv4Address(&is_ipv4);
+	if (is_ipv4)
+		return (ipv4 >> 24) == 127;
+	return address == QHostAddress(QHostAddress::LocalHostIPv6);
+}
+
+bool parse_host_port(const string &text, string &host, int &port)
+{
+	// The port is behind the last colon, an IPv6 host must be in brackets
+	const size_t colon = text.rfind(':');
+	string host_str = host;
+	string port_str = text;
+	if (colon != string::npos) {
+		host_str = text.substr(0, colon);
+		if (host_str.size() >= 2 && host_str.front() == '[' &&
+				host_str.back() == ']')
+			host_str = host_str.substr(1, host_str.size() - 2);
+		else if (host_str.find(':') != string::npos)
+			return false;
+		if (host_str.empty())
+			return false;
+		port_str = text.substr(colon + 1);
+	}
+	if (port_str.empty() || port_str.size() > 5 ||
+			port_str.find_first_not_of("0123456789") != string::npos)
+		return false;
+	const int port_value = atoi(port_str.c_str());
+	if (port_value > 65535)
+		return false;
+
+	host = host_str;
+	port = port_value;
+	return true;
+}
+
 } // namespace util
 } // namespace sv
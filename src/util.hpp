@@ -38,6 +38,8 @@
 #include <QString>
 #include <QUuid>
 
+class QHostAddress;
+
 using std::map;
 using std::set;
 using std::string;
@@ -65,6 +67,15 @@ enum class SIPrefix {
 /// Returns the exponent that corresponds to a given prefix.
 int exponent(SIPrefix prefix);
 
+/**
+ * Returns the SI prefix, that 'format_value_si()' chooses for a given value.
+ * The value in front of the decimal point is then between 1 and 999.
+ */
+SIPrefix si_prefix_for_value(const double value);
+
+/// Returns the symbol of the given SI prefix, e.g. "k" for 'SIPrefix::kilo'.
+QString format_si_prefix(SIPrefix prefix);
+
 /// Timestamp type providing yoctosecond resolution.
 typedef boost::multiprecision::number<
 	boost::multiprecision::cpp_dec_float<24>,
@@ -230,6 +241,39 @@ uint get_decimal_places(double dp);
  */
 vector<string> parse_csv_line(const string &line);
 
+/**
+ * Parse the address, that a server listens on: An IPv4 or IPv6 address,
+ * "localhost" or "*" for all interfaces.
+ *
+ * @param[in] host The address to parse.
+ * @param[out] address The parsed address.
+ *
+ * @return False if the address is not valid.
+ */
+bool parse_listen_address(const string &host, QHostAddress &address);
+
+/**
+ * Check if the address is a loopback address (127.0.0.0/8 or ::1), also as
+ * an IPv4 mapped IPv6 address.
+ *
+ * @param[in] address The address to check.
+ *
+ * @return True if the address is a loopback address.
+ */
+bool is_loopback_address(const QHostAddress &address);
+
+/**
+ * Split a "[host:]port" argument, e.g. "5025", "0.0.0.0:5025" or
+ * "[::1]:5025". Without a host, host is not changed.
+ *
+ * @param[in] text The argument to split.
+ * @param[out] host The host.
+ * @param[out] port The port.
+ *
+ * @return False if the port is not valid.
+ */
+bool parse_host_port(const string &text, string &host, int &port);
+
 } // namespace util
 } // namespace sv
 
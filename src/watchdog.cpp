@@ -0,0 +1,230 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <QDebug>
+#include <QString>
+#include <QTimer>
+
+#include "watchdog.hpp"
+#include "src/session.hpp"
+#include "src/tracer.hpp"
+
+using std::lock_guard;
+using std::make_pair;
+using std::mutex;
+using std::unique_lock;
+
+namespace sv {
+
+const size_t Watchdog::max_stalls_ = 100;
+
+std::atomic<int> Watchdog::pending_signals_(0);
+
+Watchdog::Watchdog(QObject *parent) :
+	QObject(parent),
+	heartbeat_ns_(0),
+	gui_tid_(Tracer::thread_id()),
+	threshold_(250),
+	running_(false),
+	stop_(false),
+	stall_count_(0)
+{
+	heartbeat_timer_.setTimerType(Qt::PreciseTimer);
+	connect(&heartbeat_timer_, &QTimer::timeout, this, [this]() {
+		heartbeat_ns_.store(Tracer::now_ns(), std::memory_order_release);
+	});
+}
+
+Watchdog::~Watchdog()
+{
+	stop();
+}
+
+void Watchdog::start(int threshold)
+{
+	stop();
+
+	threshold_ = std::max(1, threshold);
+	// The heartbeat must be much faster than the threshold, so that its own
+	// interval doesn't count as stall.
+	heartbeat_timer_.start(std::max(1, threshold_ / 4));
+	// The watching begins with the first heartbeat, i.e. when the event
+	// loop runs. So the startup of the application is no stall.
+	heartbeat_ns_.store(0, std::memory_order_release);
+	Tracer::set_scope_tracking(true);
+
+	stop_ = false;
+	running_ = true;
+	watchdog_thread_ = std::thread(&Watchdog::watchdog_thread_proc, this);
+}
+
+void Watchdog::stop()
+{
+	{
+		lock_guard<mutex> lock(mutex_);
+		stop_ = true;
+	}
+	stop_cond_.notify_all();
+	if (watchdog_thread_.joinable())
+		watchdog_thread_.join();
+	heartbeat_timer_.stop();
+	running_ = false;
+}
+
+bool Watchdog::is_running() const
+{
+	return running_;
+}
+
+int Watchdog::threshold() const
+{
+	return threshold_;
+}
+
+size_t Watchdog::stall_count() const
+{
+	return stall_count_;
+}
+
+vector<Stall> Watchdog::stalls() const
+{
+	lock_guard<mutex> lock(mutex_);
+	return stalls_;
+}
+
+void Watchdog::signal_received()
+{
+	pending_signals_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Watchdog::signal_handled()
+{
+	pending_signals_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void Watchdog::watchdog_thread_proc()
+{
+	SV_TRACE_THREAD_NAME("Watchdog");
+
+	const int64_t threshold_ns = (int64_t)threshold_ * 1000000;
+	const auto poll_interval =
+		std::chrono::milliseconds(std::max(1, threshold_ / 4));
+
+	bool stalled = false;
+	bool signal_reported = false;
+	int64_t stall_begin_ns = 0;
+	// The number of samples per trace scope of the current stall
+	vector<pair<const char *, size_t>> scope_samples;
+
+	unique_lock<mutex> lock(mutex_);
+	while (!stop_) {
+		stop_cond_.wait_for(lock, poll_interval,
+			[this]() { return stop_.load(); });
+		if (stop_)
+			break;
+		lock.unlock();
+
+		const int64_t heartbeat_ns =
+			heartbeat_ns_.load(std::memory_order_acquire);
+		const int64_t age_ns = Tracer::now_ns() - heartbeat_ns;
+		if (heartbeat_ns > 0 && age_ns > threshold_ns) {
+			if (!stalled) {
+				stalled = true;
+				signal_reported = false;
+				stall_begin_ns = heartbeat_ns;
+				scope_samples.clear();
+			}
+
+			const char *scope = Tracer::current_scope(gui_tid_);
+			auto it = std::find_if(scope_samples.begin(), scope_samples.end(),
+				[scope](const pair<const char *, size_t> &sample) {
+					return sample.first == scope;
+				});
+			if (it == scope_samples.end())
+				scope_samples.push_back(make_pair(scope, 1));
+			else
+				++it->second;
+
+			// The event loop handles the signals, so e.g. a SIGTERM has to
+			// wait for the end of the stall.
+			if (!signal_reported &&
+					pending_signals_.load(std::memory_order_relaxed) > 0) {
+				signal_reported = true;
+				qWarning().noquote() << "Watchdog: A signal can't be handled, "
+					"while the GUI thread is blocked" <<
+					(scope ? QString("in %1").arg(scope) : QString());
+			}
+		}
+		else if (stalled) {
+			stalled = false;
+			finish_stall(stall_begin_ns, heartbeat_ns, scope_samples);
+		}
+
+		lock.lock();
+	}
+}
+
+void Watchdog::finish_stall(int64_t begin_ns, int64_t end_ns,
+	const vector<pair<const char *, size_t>> &scope_samples)
+{
+	const char *scope = nullptr;
+	size_t scope_count = 0;
+	size_t sample_count = 0;
+	for (const auto &sample : scope_samples) {
+		sample_count += sample.second;
+		if (sample.second > scope_count) {
+			scope = sample.first;
+			scope_count = sample.second;
+		}
+	}
+
+	const double duration = (double)(end_ns - begin_ns) / 1e9;
+	Stall stall;
+	stall.begin = Session::timestamp() -
+		(double)(Tracer::now_ns() - begin_ns) / 1e9;
+	stall.duration = duration;
+	stall.scope = scope ? scope : "";
+
+	qWarning().noquote() << QString("Watchdog: The GUI thread was blocked "
+		"for %1 ms").arg(duration * 1e3, 0, 'f', 0) <<
+		(scope ? QString("in %1 (%2 of %3 samples)").arg(scope).
+			arg(scope_count).arg(sample_count) : QString("in no trace scope"));
+
+	// Show the stall in the trace, e.g. next to the scopes of the GUI thread
+	Tracer::add_event("Watchdog::stall", begin_ns, end_ns);
+
+	lock_guard<mutex> lock(mutex_);
+	stalls_.push_back(stall);
+	if (stalls_.size() > max_stalls_)
+		stalls_.erase(stalls_.begin());
+	++stall_count_;
+}
+
+} // namespace sv
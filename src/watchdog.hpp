@@ -0,0 +1,126 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WATCHDOG_HPP
+#define WATCHDOG_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <QObject>
+#include <QTimer>
+
+using std::pair;
+using std::string;
+using std::vector;
+
+namespace sv {
+
+/**
+ * A stall of the GUI thread, that was detected by the Watchdog.
+ */
+struct Stall
+{
+	/** The time in seconds since the epoch, when the stall began. */
+	double begin;
+	/** The duration in seconds. */
+	double duration;
+	/**
+	 * The trace scope, that the GUI thread was in most of the time, or an
+	 * empty string, if it was in no trace scope.
+	 */
+	string scope;
+};
+
+/**
+ * Detects stalls of the GUI thread, e.g. by blocking calls like synchronous
+ * config reads.
+ *
+ * A timer in the GUI thread updates a heartbeat, that is checked by the
+ * watchdog thread. While the heartbeat is older than the threshold, the
+ * watchdog samples the innermost trace scope of the GUI thread (see
+ * Tracer::current_scope()). When the GUI thread is responsive again, the
+ * stall is logged together with the most sampled scope and added to a
+ * running trace recording.
+ */
+class Watchdog : public QObject
+{
+	Q_OBJECT
+
+public:
+	/** Must be created in the GUI thread. */
+	explicit Watchdog(QObject *parent = nullptr);
+	~Watchdog();
+
+	/**
+	 * Start watching the GUI thread.
+	 *
+	 * @param threshold Stalls above this time in milliseconds are recorded.
+	 */
+	void start(int threshold = 250);
+	void stop();
+	bool is_running() const;
+	int threshold() const;
+
+	size_t stall_count() const;
+	/** Return the last stalls, the latest last. */
+	vector<Stall> stalls() const;
+
+	/**
+	 * Count a UNIX signal, that was received, but not yet handled by the
+	 * event loop. Must be async-signal-safe, see SignalHandler.
+	 */
+	static void signal_received();
+	static void signal_handled();
+
+private:
+	void watchdog_thread_proc();
+	/** Log and store the stall, that has ended at end_ns. */
+	void finish_stall(int64_t begin_ns, int64_t end_ns,
+		const vector<pair<const char *, size_t>> &scope_samples);
+
+	/** The number of stored stalls. */
+	static const size_t max_stalls_;
+
+	QTimer heartbeat_timer_;
+	std::atomic<int64_t> heartbeat_ns_;
+	unsigned int gui_tid_;
+	std::atomic<int> threshold_;
+	std::atomic<bool> running_;
+	std::atomic<bool> stop_;
+	std::atomic<size_t> stall_count_;
+	mutable std::mutex mutex_;
+	std::condition_variable stop_cond_;
+	std::thread watchdog_thread_;
+	vector<Stall> stalls_;
+
+	static std::atomic<int> pending_signals_;
+
+};
+
+} // namespace sv
+
+#endif // WATCHDOG_HPP
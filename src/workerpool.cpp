@@ -0,0 +1,109 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+#include <QDebug>
+#include <QObject>
+#include <QThread>
+
+#include "workerpool.hpp"
+#include "src/executor.hpp"
+
+using std::lock_guard;
+using std::vector;
+
+namespace sv {
+
+WorkerPool::WorkerPool(int thread_count, QObject *parent) :
+	QObject(parent)
+{
+	if (thread_count <= 0)
+		thread_count = (int)Executor::default_worker_thread_count();
+
+	for (int i = 0; i < thread_count; ++i) {
+		QThread *thread = new QThread(this);
+		thread->setObjectName(QString("SmuView worker %1").arg(i));
+		thread->start();
+		threads_.push_back(thread);
+		object_counts_.push_back(0);
+	}
+	qWarning() << "WorkerPool::WorkerPool(): Started" << thread_count <<
+		"worker threads";
+}
+
+WorkerPool::~WorkerPool()
+{
+	stop();
+}
+
+int WorkerPool::thread_count() const
+{
+	return (int)threads_.size();
+}
+
+void WorkerPool::move_to_worker(QObject *object)
+{
+	lock_guard<std::mutex> lock(mutex_);
+
+	const auto min_it = std::min_element(
+		object_counts_.begin(), object_counts_.end());
+	move_to_thread(object, min_it - object_counts_.begin());
+}
+
+bool WorkerPool::move_to_worker_of(QObject *object, const QObject *other)
+{
+	lock_guard<std::mutex> lock(mutex_);
+
+	const auto it =
+		std::find(threads_.begin(), threads_.end(), other->thread());
+	if (it == threads_.end())
+		return false;
+
+	move_to_thread(object, it - threads_.begin());
+	return true;
+}
+
+void WorkerPool::move_to_thread(QObject *object, size_t index)
+{
+	if (!threads_[index]->isRunning())
+		return;
+
+	object->moveToThread(threads_[index]);
+	++object_counts_[index];
+
+	// The object is destroyed in any thread, so the connection is direct
+	connect(object, &QObject::destroyed, this, [this, index]() {
+		lock_guard<std::mutex> lock(mutex_);
+		--object_counts_[index];
+	}, Qt::DirectConnection);
+}
+
+void WorkerPool::stop()
+{
+	for (const auto &thread : threads_) {
+		thread->quit();
+		thread->wait();
+	}
+}
+
+} // namespace sv
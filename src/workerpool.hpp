@@ -0,0 +1,94 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WORKERPOOL_HPP
+#define WORKERPOOL_HPP
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+#include <QObject>
+
+class QThread;
+
+using std::vector;
+
+namespace sv {
+
+/**
+ * A fixed pool of worker threads with their own event loops.
+ *
+ * QObjects (e.g. math channels), that are moved to a worker, get their
+ * queued slots called in the worker thread, so their computations don't
+ * block the GUI thread. The GUI only consumes the finished results.
+ */
+class WorkerPool : public QObject
+{
+	Q_OBJECT
+
+public:
+	/**
+	 * @param thread_count The number of worker threads. 0 uses the share of
+	 * the compute budget, that the compute pool leaves (see
+	 * Executor::default_worker_thread_count()), so the GUI thread keeps a
+	 * core and the cores aren't oversubscribed.
+	 */
+	explicit WorkerPool(int thread_count = 0, QObject *parent = nullptr);
+	~WorkerPool();
+
+	int thread_count() const;
+
+	/**
+	 * Move the object to the worker with the fewest objects. The object must
+	 * not have a parent and this must be called from the thread, the object
+	 * currently lives in. The object can be deleted by any thread, once the
+	 * pool is stopped.
+	 */
+	void move_to_worker(QObject *object);
+
+	/**
+	 * Move the object to the worker, that the other object lives in, e.g.
+	 * to calculate dependent math channels together. The same rules as for
+	 * move_to_worker() apply.
+	 *
+	 * @return false if the other object doesn't live in a worker.
+	 */
+	bool move_to_worker_of(QObject *object, const QObject *other);
+
+	/**
+	 * Stop all worker threads. Objects, that were moved to a worker, don't
+	 * receive events anymore.
+	 */
+	void stop();
+
+private:
+	/** Move the object to the thread at index. mutex_ must be locked. */
+	void move_to_thread(QObject *object, size_t index);
+
+	vector<QThread *> threads_;
+	/** The number of (not yet destroyed) objects per thread. */
+	vector<size_t> object_counts_;
+	std::mutex mutex_;
+
+};
+
+} // namespace sv
+
+#endif // WORKERPOOL_HPP
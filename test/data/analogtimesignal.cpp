@@ -0,0 +1,231 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/datautil.hpp"
+#include "src/data/signalcombinecache.hpp"
+
+using std::make_shared;
+using std::set;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+using sv::data::AnalogTimeSignal;
+using sv::data::Quantity;
+using sv::data::QuantityFlag;
+using sv::data::SignalCombineCursor;
+using sv::data::Unit;
+using sv::data::ValueStorage;
+
+namespace {
+
+shared_ptr<AnalogTimeSignal> create_signal(const string &name,
+	double start_timestamp, const vector<double> &timestamps,
+	const vector<double> &values)
+{
+	auto signal = make_shared<AnalogTimeSignal>(Quantity::Voltage,
+		set<QuantityFlag>(), Unit::Volt, nullptr, start_timestamp, name);
+	signal->push_samples(timestamps.data(), values.data(), timestamps.size(),
+		7, 3);
+	return signal;
+}
+
+/**
+ * The example of AnalogTimeSignal::combine_signals(): The signals overlap
+ * from 5 to 9, the combined rows start with the first sample of s2.
+ */
+struct CombineFixture
+{
+	CombineFixture() :
+		s1(create_signal("s1", 0., { 1, 3, 5, 7, 9 }, { 1, 2, 3, 4, 5 })),
+		s2(create_signal("s2", 0., { 6, 8, 10 }, { 10, 9, 8 }))
+	{
+	}
+
+	shared_ptr<AnalogTimeSignal> s1;
+	shared_ptr<AnalogTimeSignal> s2;
+};
+
+const vector<double> combined_timestamps{ 6, 7, 8, 9 };
+const vector<double> combined_s1{ 3.5, 4, 4.5, 5 };
+const vector<double> combined_s2{ 10, 9.5, 9, 8.5 };
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(AnalogTimeSignalTest)
+
+BOOST_AUTO_TEST_CASE(get_value_at_timestamp)
+{
+	auto signal = create_signal("s", 100.,
+		{ 101, 102, 104 }, { 1, 2, -2 });
+	double value = 0.;
+
+	// Exactly matching timestamps
+	BOOST_CHECK(signal->get_value_at_timestamp(101, value, false));
+	BOOST_CHECK_EQUAL(value, 1.);
+	BOOST_CHECK(signal->get_value_at_timestamp(104, value, false));
+	BOOST_CHECK_EQUAL(value, -2.);
+
+	// Linear interpolation between the samples
+	BOOST_CHECK(signal->get_value_at_timestamp(101.5, value, false));
+	BOOST_CHECK_CLOSE(value, 1.5, 1e-9);
+	BOOST_CHECK(signal->get_value_at_timestamp(103, value, false));
+	BOOST_CHECK_SMALL(value, 1e-12);
+
+	// Relative to the start timestamp of the signal
+	BOOST_CHECK(signal->get_value_at_timestamp(3.5, value, true));
+	BOOST_CHECK_CLOSE(value, -1., 1e-9);
+
+	// Outside of the samples, value isn't touched
+	value = 42.;
+	BOOST_CHECK(!signal->get_value_at_timestamp(100.5, value, false));
+	BOOST_CHECK(!signal->get_value_at_timestamp(104.5, value, false));
+	BOOST_CHECK_EQUAL(value, 42.);
+
+	signal->clear();
+	BOOST_CHECK(!signal->get_value_at_timestamp(102, value, false));
+}
+
+BOOST_FIXTURE_TEST_CASE(combine_signals, CombineFixture)
+{
+	size_t pos1 = 0;
+	size_t pos2 = 0;
+	auto time = make_shared<vector<double>>();
+	auto data1 = make_shared<vector<double>>();
+	auto data2 = make_shared<vector<double>>();
+	AnalogTimeSignal::combine_signals(s1, pos1, s2, pos2, time, data1, data2);
+
+	BOOST_CHECK_EQUAL_COLLECTIONS(time->begin(), time->end(),
+		combined_timestamps.begin(), combined_timestamps.end());
+	BOOST_CHECK_EQUAL_COLLECTIONS(data1->begin(), data1->end(),
+		combined_s1.begin(), combined_s1.end());
+	BOOST_CHECK_EQUAL_COLLECTIONS(data2->begin(), data2->end(),
+		combined_s2.begin(), combined_s2.end());
+	BOOST_CHECK_EQUAL(pos1, 5);
+	BOOST_CHECK_EQUAL(pos2, 2);
+
+	// Only the new samples are combined, with the last samples as start
+	const double t1 = 11;
+	const double v1 = 6;
+	const double t2 = 12;
+	const double v2 = 7;
+	s1->push_samples(&t1, &v1, 1, 7, 3);
+	s2->push_samples(&t2, &v2, 1, 7, 3);
+	time->clear();
+	data1->clear();
+	data2->clear();
+	AnalogTimeSignal::combine_signals(s1, pos1, s2, pos2, time, data1, data2);
+
+	const vector<double> new_timestamps{ 10, 11 };
+	const vector<double> new_s1{ 5.5, 6 };
+	const vector<double> new_s2{ 8, 7.5 };
+	BOOST_CHECK_EQUAL_COLLECTIONS(time->begin(), time->end(),
+		new_timestamps.begin(), new_timestamps.end());
+	BOOST_CHECK_EQUAL_COLLECTIONS(data1->begin(), data1->end(),
+		new_s1.begin(), new_s1.end());
+	BOOST_CHECK_EQUAL_COLLECTIONS(data2->begin(), data2->end(),
+		new_s2.begin(), new_s2.end());
+}
+
+BOOST_FIXTURE_TEST_CASE(combine_time_skew, CombineFixture)
+{
+	// Shift s2 by one second, so its samples meet the samples of s1
+	s2->set_time_skew(1.);
+
+	size_t pos1 = 0;
+	size_t pos2 = 0;
+	auto time = make_shared<vector<double>>();
+	auto data1 = make_shared<vector<double>>();
+	auto data2 = make_shared<vector<double>>();
+	AnalogTimeSignal::combine_signals(s1, pos1, s2, pos2, time, data1, data2);
+
+	const vector<double> timestamps{ 5, 7, 9 };
+	const vector<double> values1{ 3, 4, 5 };
+	const vector<double> values2{ 10, 9, 8 };
+	BOOST_CHECK_EQUAL_COLLECTIONS(time->begin(), time->end(),
+		timestamps.begin(), timestamps.end());
+	BOOST_CHECK_EQUAL_COLLECTIONS(data1->begin(), data1->end(),
+		values1.begin(), values1.end());
+	BOOST_CHECK_EQUAL_COLLECTIONS(data2->begin(), data2->end(),
+		values2.begin(), values2.end());
+}
+
+BOOST_FIXTURE_TEST_CASE(combine_cursor, CombineFixture)
+{
+	// The math channels read the combined rows with a cursor
+	SignalCombineCursor cursor({ s1, s2 });
+	vector<double> timestamps(16);
+	vector<double> values1(16);
+	vector<double> values2(16);
+	double *const values[] = { values1.data(), values2.data() };
+
+	const size_t count = cursor.combine(timestamps.size(),
+		timestamps.data(), values);
+	BOOST_REQUIRE_EQUAL(count, combined_timestamps.size());
+	BOOST_CHECK_EQUAL_COLLECTIONS(timestamps.begin(),
+		timestamps.begin() + count,
+		combined_timestamps.begin(), combined_timestamps.end());
+	BOOST_CHECK_EQUAL_COLLECTIONS(values1.begin(), values1.begin() + count,
+		combined_s1.begin(), combined_s1.end());
+	BOOST_CHECK_EQUAL_COLLECTIONS(values2.begin(), values2.begin() + count,
+		combined_s2.begin(), combined_s2.end());
+	BOOST_CHECK_EQUAL(
+		cursor.combine(timestamps.size(), timestamps.data(), values), 0);
+
+	// After a clear, the cursor starts again with the first row
+	s1->clear();
+	s2->clear();
+	const vector<double> ts{ 1, 2 };
+	const vector<double> v{ 1, 3 };
+	s1->push_samples(ts.data(), v.data(), ts.size(), 7, 3);
+	s2->push_samples(ts.data(), v.data(), ts.size(), 7, 3);
+	BOOST_CHECK_EQUAL(
+		cursor.combine(timestamps.size(), timestamps.data(), values), 2);
+	BOOST_CHECK_EQUAL(timestamps[0], 1.);
+	BOOST_CHECK_EQUAL(values2[1], 3.);
+}
+
+BOOST_AUTO_TEST_CASE(scaled_int32_summaries)
+{
+	auto signal = make_shared<AnalogTimeSignal>(Quantity::Voltage,
+		set<QuantityFlag>(), Unit::Volt, nullptr, 0., "s");
+	BOOST_CHECK(signal->set_value_storage(ValueStorage::ScaledInt32));
+	const vector<double> timestamps{ 1, 2 };
+	const vector<double> values{ 1.23456, -2.71828 };
+	signal->push_samples(timestamps.data(), values.data(), timestamps.size(),
+		7, 3);
+
+	// Min and max are the rounded values, that are read back
+	double value = 0.;
+	BOOST_CHECK(signal->get_value_at_timestamp(1, value, false));
+	BOOST_CHECK_EQUAL(signal->max_value(), value);
+	BOOST_CHECK_CLOSE(signal->max_value(), 1.235, 1e-9);
+	BOOST_CHECK(signal->get_value_at_timestamp(2, value, false));
+	BOOST_CHECK_EQUAL(signal->min_value(), value);
+	BOOST_CHECK_CLOSE(signal->min_value(), -2.718, 1e-9);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
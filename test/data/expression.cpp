@@ -0,0 +1,111 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "src/data/expression.hpp"
+
+using std::vector;
+using sv::data::Expression;
+
+BOOST_AUTO_TEST_SUITE(ExpressionTest)
+
+BOOST_AUTO_TEST_CASE(evaluate_variables)
+{
+	Expression expression;
+	BOOST_REQUIRE(expression.compile("(v1 - v2) / 0.1 * 1000", 2));
+	BOOST_CHECK(expression.is_valid());
+	BOOST_CHECK_EQUAL(expression.variable_count(), 2);
+
+	// More samples than fit into one block of the stack machine
+	const size_t count = 1000;
+	vector<double> v1(count);
+	vector<double> v2(count);
+	for (size_t i = 0; i < count; ++i) {
+		v1[i] = 1. + i * 0.001;
+		v2[i] = 1.;
+	}
+	vector<double> result(count);
+	expression.evaluate({ v1.data(), v2.data() }, count, result.data());
+
+	for (size_t i = 0; i < count; ++i)
+		BOOST_CHECK_SMALL(result[i] - i * 10., 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE(precedence_and_functions)
+{
+	const double v = 2.;
+	const vector<const double *> variables{ &v };
+	double result;
+
+	Expression expression;
+	BOOST_REQUIRE(expression.compile("1 + v1 * 3 ^ 2", 1));
+	expression.evaluate(variables, 1, &result);
+	BOOST_CHECK_EQUAL(result, 19.);
+
+	BOOST_REQUIRE(expression.compile("2 ^ 3 ^ 2", 1));
+	expression.evaluate(variables, 1, &result);
+	BOOST_CHECK_EQUAL(result, 512.);
+
+	BOOST_REQUIRE(expression.compile("-v1 ^ 2", 1));
+	expression.evaluate(variables, 1, &result);
+	BOOST_CHECK_EQUAL(result, -4.);
+
+	BOOST_REQUIRE(expression.compile(
+		"max(abs(-3), sqrt(v1 * 8)) + min(v1, 1)", 1));
+	expression.evaluate(variables, 1, &result);
+	BOOST_CHECK_EQUAL(result, 5.);
+
+	BOOST_REQUIRE(expression.compile("cos(pi) + log(e)", 1));
+	expression.evaluate(variables, 1, &result);
+	BOOST_CHECK_SMALL(result, 1e-12);
+}
+
+BOOST_AUTO_TEST_CASE(invalid_formulas)
+{
+	Expression expression;
+	BOOST_CHECK(!expression.compile("v1 +", 1));
+	BOOST_CHECK(!expression.is_valid());
+	BOOST_CHECK(!expression.error().empty());
+
+	// The variable is out of range
+	BOOST_CHECK(!expression.compile("v1 * v3", 2));
+	BOOST_CHECK(!expression.compile("foo(v1)", 1));
+	BOOST_CHECK(!expression.compile("(v1", 1));
+	// The number doesn't even fit into a size_t
+	BOOST_CHECK(!expression.compile("v99999999999999999999", 1));
+
+	BOOST_CHECK(expression.compile("v1", 1));
+	BOOST_CHECK(expression.error().empty());
+}
+
+BOOST_AUTO_TEST_CASE(max_variable)
+{
+	BOOST_CHECK_EQUAL(Expression::max_variable("v1 * v3 + 2"), 3);
+	BOOST_CHECK_EQUAL(Expression::max_variable("pi * 2"), 0);
+	BOOST_CHECK_EQUAL(Expression::max_variable("v99999999999999999999"),
+		std::numeric_limits<size_t>::max());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,43 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2021 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <QCoreApplication>
+
+/**
+ * The signals use queued notifications and timers, so there must be an
+ * application object for the whole test run.
+ */
+struct QtApplication
+{
+	QtApplication() :
+		argc(1),
+		argv{ const_cast<char *>("smuview-test"), nullptr },
+		app(argc, argv)
+	{
+	}
+
+	int argc;
+	char *argv[2];
+	QCoreApplication app;
+};
+
+BOOST_GLOBAL_FIXTURE(QtApplication);